@@ -31,6 +31,7 @@ ForallOptimizationInfo::ForallOptimizationInfo():
   infoGathered(false),
   autoLocalAccessChecked(false),
   hasAlignedFollowers(false),
+  offsetsStayLocal(false),
   cloneType(NOT_CLONE)
 {
 }
@@ -68,6 +69,7 @@ ForallStmt::ForallStmt(BlockStmt* body):
 
   optInfo.autoLocalAccessChecked = false;
   optInfo.hasAlignedFollowers = false;
+  optInfo.offsetsStayLocal = false;
 
   gForallStmts.add(this);
 }
@@ -1180,6 +1180,9 @@ static bool keepFnForSeparateCompilation(FnSymbol* fn) {
   return false;
 }
 
+static void
+visitVirtualMethodsOfUsedClasses(Vec<FnSymbol*>& fns, Vec<TypeSymbol*>& types);
+
 // Visit and mark functions (and types) which are reachable from
 // externally visible symbols.
 static void
@@ -1200,10 +1203,12 @@ visitVisibleFunctions(Vec<FnSymbol*>& fns, Vec<TypeSymbol*>& types)
     pruneVisit(fn, fns, types);
 
   // Mark VFT entries as visible.
-  for (int i = 0; i < virtualMethodTable.n; i++)
-    if (virtualMethodTable.v[i].key)
-      for (int j = 0; j < virtualMethodTable.v[i].value->n; j++)
-        pruneVisit(virtualMethodTable.v[i].value->v[j], fns, types);
+  if (!fPruneVirtualMethods) {
+    for (int i = 0; i < virtualMethodTable.n; i++)
+      if (virtualMethodTable.v[i].key)
+        for (int j = 0; j < virtualMethodTable.v[i].value->n; j++)
+          pruneVisit(virtualMethodTable.v[i].value->v[j], fns, types);
+  }
 
   // Mark things to consider always visible:
   //  * exported symbols
@@ -1230,6 +1235,40 @@ visitVisibleFunctions(Vec<FnSymbol*>& fns, Vec<TypeSymbol*>& types)
     if (mod->deinitFn)
       pruneVisitFn(mod->deinitFn, fns, types);
   }
+
+  if (fPruneVirtualMethods)
+    visitVirtualMethodsOfUsedClasses(fns, types);
+}
+
+// With --prune-virtual-methods, the VFT entries of a class are only marked
+// visible once the class itself is used by something visible. A class that
+// no visible function mentions can't have instances, so none of its
+// methods can be reached through dynamic dispatch. Subclasses mention
+// their parent through the 'super' field, so a used class keeps its
+// ancestors' entries too. Visiting the entries can make more classes used,
+// so this repeats until nothing changes.
+//
+// The keys of the VFT can point to types removed by an earlier prune, so
+// the table is only looked up with types that are still alive.
+static void
+visitVirtualMethodsOfUsedClasses(Vec<FnSymbol*>& fns, Vec<TypeSymbol*>& types)
+{
+  std::set<TypeSymbol*> visited;
+  bool changed = true;
+
+  while (changed) {
+    changed = false;
+    forv_Vec(TypeSymbol, ts, gTypeSymbols) {
+      if (types.set_in(ts) && visited.count(ts) == 0) {
+        visited.insert(ts);
+        if (Vec<FnSymbol*>* vfns = virtualMethodTable.get(ts->type)) {
+          forv_Vec(FnSymbol, vfn, *vfns)
+            pruneVisit(vfn, fns, types);
+          changed = true;
+        }
+      }
+    }
+  }
 }
 
 
@@ -1463,6 +1502,10 @@ prune() {
       fn->defPoint->remove();
   }
 
+  // Later passes walk the overrides of a method, so drop the removed ones
+  if (fPruneVirtualMethods)
+    trimVirtualMapsToLiveFns();
+
   pruneUnusedTypes(types);
 
   removeVoidMoves();
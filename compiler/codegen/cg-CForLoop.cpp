@@ -224,6 +224,12 @@ static llvm::MDNode* generateLoopMetadata(LoopStmt* loop,
       addLoopParallelAccess(args, thisLoopParallelAccess, accessGroup);
     }
 
+    // An order-independent loop over finitely many indices terminates, and
+    // telling LLVM so allows it to compute trip counts for `<=` tests
+    // without proving the index can't overflow.
+    args.push_back(llvm::MDNode::get(ctx,
+                     constructLLVMMetadata("llvm.loop.mustprogress")));
+
     // When using the Region Vectorizer, emit rv.loop.vectorize.enable metadata
     if(fRegionVectorizer) {
       args.push_back(constructLLVMMetadata("rv.loop.vectorize.enable", true));
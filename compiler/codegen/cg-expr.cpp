@@ -5550,12 +5550,29 @@ DEFINE_PRIM(GPU_ARG) {
     args.push_back(codegenSizeof(call->get(2)->typeInfo()->getValType()));
     args.push_back(call->get(4)->codegen());
 
+    // the name of the function the wrapper calls, as in GPU_REDUCE_WRAPPER
+    VarSymbol* finalFnSym = toVarSymbol(toSymExpr(call->get(5))->symbol());
+    INT_ASSERT(isCStringImmediate(finalFnSym));
+    TypeSymbol* redTypeSym = toTypeSymbol(toSymExpr(call->get(6))->symbol());
+    INT_ASSERT(redTypeSym);
+
+    std::string finalFn = finalFnSym->immediate->string_value();
+    finalFn += "_";
+    finalFn += redTypeSym->cname;
+    args.push_back(new_CStringSymbol(finalFn.c_str())->codegen());
+
   } else if (kind & GpuArgKind::HOST_REGISTER) {
     fnName = "chpl_gpu_arg_host_register";
     args.push_back(codegenSizeof(call->get(2)->typeInfo()->getValType()));
 
+  } else if (kind & GpuArgKind::PREFETCH) {
+    // passed the same way, the runtime just also gets to see the pointer
+    fnName = "chpl_gpu_arg_prefetch";
+    args.push_back(codegenSizeof(call->get(2)->typeInfo()->getValType()));
+
   } else {
     fnName = "chpl_gpu_arg_pass";
+    args.push_back(codegenSizeof(call->get(2)->typeInfo()->getValType()));
   }
 
   ret = codegenCallExprWithArgs(fnName, args);
@@ -7202,6 +7219,17 @@ void CallExpr::codegenInvokeTaskFun(const char* name) {
   taskBundle   = codegenValue(get(1));
   bundleSize   = codegenValue(get(2));
 
+  // The bundle header is filled in by the tasking layer, except for
+  // these, which must always be set since the bundle isn't zeroed.
+  codegenCall("chpl_task_setLightweightInBundle",
+              codegenCast("chpl_task_bundle_p", taskBundle),
+              fn->hasFlag(FLAG_LIGHTWEIGHT_TASK) ? gTrue->codegen()
+                                                 : gFalse->codegen());
+  codegenCall("chpl_task_setArgsInPlaceInBundle",
+              codegenCast("chpl_task_bundle_p", taskBundle),
+              fn->hasFlag(FLAG_TASK_ARGS_IN_PLACE) ? gTrue->codegen()
+                                                   : gFalse->codegen());
+
   // We would like to remove this conditional and always do the true branch,
   // but wanted to limit the impact of this near the release date.
   GenRet outerLocale = codegenCallExpr("chpl_task_getRequestedSubloc");
@@ -68,6 +68,7 @@ class ALACandidate {
     void addOffset(Expr* e);
 
     inline bool hasOffset() const { return hasOffset_; }
+    inline void ignoreOffset() { hasOffset_ = false; }
 
     Symbol* getCallBase() const;
 
@@ -123,6 +124,11 @@ class ForallOptimizationInfo {
     bool autoLocalAccessChecked;
     bool hasAlignedFollowers;
 
+    // set for the interior loop of a forall split for offset accesses: the
+    // iterator only yields indices whose offset neighbors are on the same
+    // locale
+    bool offsetsStayLocal;
+
     ForallAutoLocalAccessCloneType cloneType;
 
     ForallOptimizationInfo();
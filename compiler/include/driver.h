@@ -45,6 +45,7 @@ extern bool fNoGlobalConstOpt;
 extern bool fNoFastFollowers;
 extern bool fNoInlineIterators;
 extern bool fNoLoopInvariantCodeMotion;
+extern bool fHoistRemoteLoads;
 extern bool fNoInterproceduralAliasAnalysis;
 extern bool fNoInline;
 extern bool fNoLiveAnalysis;
@@ -61,33 +62,51 @@ extern bool fMungeUserIdents;
 extern bool fEnableTaskTracking;
 extern bool fEnableMemInterleaving;
 extern bool fLLVMWideOpt;
+extern bool fLLVMPackedWidePointers;
 
 extern bool fAutoLocalAccess;
 extern bool fDynamicAutoLocalAccess;
 extern bool fOffsetAutoLocalAccess;
+extern bool fSplitOffsetAutoLocalAccess;
+extern bool fUncheckedAutoLocalAccess;
 extern bool fReportAutoLocalAccess;
 
 extern bool fAutoAggregation;
 extern bool fReportAutoAggregation;
 
+extern bool fInspectorExecutor;
+extern bool fReportInspectorExecutor;
+
+extern bool fBulkTransferLoops;
+
 extern bool fArrayViewElision;
 extern bool fReportArrayViewElision;
 
 extern bool fNoRemoteValueForwarding;
 extern bool fNoInferConstRefs;
 extern bool fNoRemoteSerialization;
+extern bool fRemoteValueForwardRecords;
 extern bool fNoRemoveCopyCalls;
+extern bool fElideYieldCopies;
 extern bool fNoScalarReplacement;
 extern bool fNoTupleCopyOpt;
+extern bool fSpecializeRectangularAccess;
+extern bool fFlattenAggregateArgs;
 extern bool fNoOptimizeRangeIteration;
 extern bool fNoOptimizeLoopIterators;
 extern bool fNoVectorize;
 extern bool fForceVectorize;
 extern std::string fVectorLib;
+extern bool fProfileGenerate;
+extern std::string fProfileUseFile;
 extern bool fNoPrivatization;
 extern bool fNoOptimizeOnClauses;
+extern bool fLightweightTasks;
+extern bool fTaskArgsInPlace;
 extern bool fNoRemoveEmptyRecords;
 extern bool fNoInferLocalFields;
+extern bool fNarrowLocalWideRefs;
+extern bool fReportWideNarrowing;
 extern bool fRemoveUnreachableBlocks;
 extern bool fReplaceArrayAccessesWithRefTemps;
 extern int  optimize_on_clause_limit;
@@ -166,6 +185,7 @@ extern const char* CHPL_GPU_ARCH;
 extern bool  printPasses;
 extern FILE* printPassesFile;
 extern bool  printPassesMemory;
+extern std::string printPassesJson;
 
 extern char fExplainCall[256];
 extern int  explainCallID;
@@ -275,8 +295,11 @@ extern bool fReportBlocking;
 extern bool fReportOptimizedLoopIterators;
 extern bool fReportInlinedIterators;
 extern bool fReportVectorizedLoops;
+extern bool fReportVectorization;
 extern bool fReportOptimizedOn;
+extern bool fReportTaskArgsInPlace;
 extern bool fReportPromotion;
+extern bool fReportInstantiations;
 extern bool fReportScalarReplace;
 extern bool fReportGpu;
 extern bool fReportContextAdj;
@@ -304,6 +327,9 @@ const int gpuArchNameLen = 256;
 extern char fGpuArch[gpuArchNameLen+1];
 extern bool fGpuPtxasEnforceOpt;
 extern bool fGpuSpecialization;
+extern bool fGpuStageSharedMemory;
+extern bool fGpuFuseKernels;
+extern bool fReportGpuSharedStaging;
 extern const char* gGpuSdkPath;
 extern std::set<std::string> gpuArches;
 
@@ -327,6 +353,9 @@ bool isEditionApplicable(std::string first, std::string last, BaseAST* loc);
 //        (in the future, we may want to make < 0 mean "#cores")
 //  >0 == make -j <val>
 extern int fParMake;
+extern int fCodegenThreads;
+extern int fFrontendThreads;
+extern std::string fCodegenCacheDir;
 
 // Set to true if we want to enable incremental compilation.
 extern bool fIncrementalCompilation;
@@ -357,6 +386,8 @@ extern size_t fDynoBreakOnHash;
 extern bool   fDynoBreakOnHashSet;
 
 extern bool fResolveConcreteFns;
+extern bool fPrefilterCandidates;
+extern bool fPruneVirtualMethods;
 extern bool fIdBasedMunging;
 
 extern bool fNoIOGenSerialization;
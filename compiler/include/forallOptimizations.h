@@ -51,6 +51,11 @@ class AggregationCandidateInfo {
     Symbol *srcAggregator;   // remote rhs
     Symbol *dstAggregator;   // remote lhs
 
+    // for a commutative update rather than an assignment, the update's name:
+    // "+=" and the other op= forms, "min", "max", or "add" for atomics. The
+    // rhs is then the value to combine into the lhs
+    const char *updateOp;
+
     AggregationCandidateInfo(CallExpr *candidate, ForallStmt *forall);
 
     void addAggregators();
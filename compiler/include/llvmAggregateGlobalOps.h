@@ -25,6 +25,7 @@
 
 #include "llvmUtil.h"
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/IR/PassManager.h"
 #include "llvm/Pass.h"
 
@@ -32,11 +33,16 @@
 struct AggregateGlobalOpsOpt final {
   const llvm::DataLayout *DL = nullptr;
   unsigned globalSpace = 100;
+  // allocas whose address is never captured, so that no global
+  // pointer can refer to them
+  llvm::DenseMap<const llvm::Value*, bool> privateAllocas;
 
   AggregateGlobalOpsOpt();
   explicit AggregateGlobalOpsOpt(unsigned _globalSpace);
 
   bool run(llvm::Function& F);
+  bool mergeStraightLineBlocks(llvm::Function& F);
+  bool isPrivateLocalAccess(llvm::Instruction* I);
   llvm::Instruction* tryAggregating(llvm::Instruction *I,
                                     llvm::Value* StartPtr,
                                     bool DebugThis);
@@ -132,11 +132,16 @@ struct GlobalToWideInfo {
   unsigned wideSpace;
 
   unsigned globalPtrBits;
-  // this optimization currently assumes wide pointers are
-  // stored in a 128-bit struct representation that contains
+  // By default wide pointers are stored in a 128-bit struct
+  // representation that contains
   //  locale-id
   //      node
   //  addr
+  // With packedWidePointers they are instead a 64-bit integer with the
+  // node in the high 16 bits and the address in the low 48 bits. That
+  // drops the rest of the locale id, so it is only for locale models
+  // whose locale id is just the node.
+  bool packedWidePointers;
 
   llvm::Type* localeIdType;
   llvm::Type* nodeIdType;
@@ -171,6 +176,7 @@ struct GlobalToWideInfo {
 
   GlobalToWideInfo()
     : globalSpace(0), wideSpace(0), globalPtrBits(0),
+      packedWidePointers(false),
       localeIdType(NULL), nodeIdType(NULL), gTypes(), specialFunctions(),
       getFn(NULL), getFnType(NULL),
       putFn(NULL), putFnType(NULL),
@@ -100,7 +100,10 @@ enum GpuArgKind {
                   // using the previous bit)
                   // otherwise, the variable is passed directly
   REDUCE = 1<<2,  // this is a reduction temp
-  HOST_REGISTER = 1<<3
+  HOST_REGISTER = 1<<3,
+  PREFETCH = 1<<4 // this is a pointer to array data, which the runtime may
+                  // prefetch to the device before the launch (with unified
+                  // memory)
 };
 
 
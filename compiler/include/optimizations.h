@@ -78,6 +78,10 @@ void liveVariableAnalysis(FnSymbol* fn,
 
 void remoteValueForwarding();
 
+void bulkTransferLoops();
+
+void specializeRectangularAccess();
+
 void inferConstRefs();
 
 void computeNoAliasSets();
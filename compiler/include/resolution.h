@@ -217,6 +217,7 @@ FnSymbol* instantiateWithoutCall(FnSymbol* fn, SymbolMap& subs);
 FnSymbol* instantiateSignature(FnSymbol* fn, SymbolMap& subs,
                                VisibilityInfo* info);
 void      instantiateBody(FnSymbol* fn);
+void      reportInstantiations();
 
 // generics support
 void checkInfiniteWhereInstantiation(FnSymbol* fn);
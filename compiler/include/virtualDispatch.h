@@ -50,4 +50,8 @@ void insertDynamicDispatchCalls();
 
 bool isSubType(Type* sub, Type* super);
 
+// Remove the functions that are no longer in the tree from the roots,
+// parents and children maps
+void trimVirtualMapsToLiveFns();
+
 #endif
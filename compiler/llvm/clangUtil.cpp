@@ -52,6 +52,7 @@
 #include "clang/Lex/Preprocessor.h"
 
 #include "llvm/ADT/APFloat.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/Analysis/TargetTransformInfo.h"
 #include "llvm/Bitcode/BitcodeWriter.h"
@@ -78,10 +79,13 @@
 #else
 #include "llvm/Support/Host.h"
 #endif
+#include "llvm/CodeGen/ParallelCG.h"
 #include "llvm/Support/CodeGen.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/SHA1.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Transforms/IPO.h"
@@ -91,6 +95,7 @@
 #include "llvm/Transforms/IPO/PassManagerBuilder.h"
 #endif
 #include "llvm/Transforms/Utils/Cloning.h"
+#include "llvm/Transforms/Utils/SplitModule.h"
 
 #include "llvm/MC/TargetRegistry.h"
 #include "llvm/Passes/OptimizationLevel.h"
@@ -115,6 +120,7 @@ using LlvmOptimizationLevel = llvm::OptimizationLevel;
 #include "passes.h"
 #include "stmt.h"
 #include "stringutil.h"
+#include "version.h"
 #include "symbol.h"
 #include "type.h"
 #include "version.h"
@@ -150,7 +156,7 @@ void cleanupExternC(void) {
 
 #define GLOBAL_PTR_SPACE 100
 #define WIDE_PTR_SPACE 101
-#define GLOBAL_PTR_SIZE 128
+#define GLOBAL_PTR_SIZE (fLLVMPackedWidePointers ? 64 : 128)
 #define GLOBAL_PTR_ABI_ALIGN 64
 #define GLOBAL_PTR_PREF_ALIGN 64
 
@@ -2533,6 +2539,32 @@ static void registerDumpIrExtensions(PassBuilder& PB);
 namespace llvm {
 extern cl::opt<bool> PrintPipelinePasses;
 }
+
+// With --profile-generate, the IR is instrumented to count its edges, and
+// the profile runtime picks the file name (see chpl-pgo.h). With
+// --profile-use, the merged profile guides LLVM's inlining, block layout
+// and the rest of its pipeline.
+static chpl::optional<PGOOptions> getPGOOptions() {
+  PGOOptions::PGOAction action;
+  std::string file;
+
+  if (fProfileGenerate) {
+    action = PGOOptions::IRInstr;
+  } else if (!fProfileUseFile.empty()) {
+    action = PGOOptions::IRUse;
+    file = fProfileUseFile;
+  } else {
+    return chpl::optional<PGOOptions>();
+  }
+
+#if HAVE_LLVM_VER >= 170
+  return PGOOptions(file, "", "", /* MemoryProfile */ "",
+                    llvm::vfs::getRealFileSystem(), action);
+#else
+  return PGOOptions(file, "", "", action);
+#endif
+}
+
 static PassBuilder constructPassBuilder(
   llvm::TargetMachine* targetMachine,
   PassInstrumentationCallbacks* PIC,
@@ -2543,7 +2575,7 @@ static PassBuilder constructPassBuilder(
   // this must always be set so that `--print-before` (and similar commands) will
   // still work with their nice pass name
   llvm::PrintPipelinePasses = true;
-  chpl::optional<PGOOptions> PGOOpt;
+  chpl::optional<PGOOptions> PGOOpt = getPGOOptions();
   PassBuilder PB(targetMachine, createPipelineOptions(forFunction), PGOOpt, PIC);
   llvm::PrintPipelinePasses = false;
   return PB;
@@ -4751,6 +4783,7 @@ void adjustLayoutForGlobalToWide()
   info->globalToWideInfo.globalSpace = GLOBAL_PTR_SPACE;
   info->globalToWideInfo.wideSpace = WIDE_PTR_SPACE;
   info->globalToWideInfo.globalPtrBits = GLOBAL_PTR_SIZE;
+  info->globalToWideInfo.packedWidePointers = fLLVMPackedWidePointers;
 
   // Always set the module layout. This works around an apparent bug in
   // clang or LLVM (trivial/deitz/test_array_low.chpl would print out the
@@ -4778,6 +4811,8 @@ void checkAdjustedDataLayout() {
 }
 
 static void handlePrintAsm(std::string dotOFile);
+static int numModulePartitions();
+static std::string getModulePartitionFilename(int i);
 static void makeLLVMStaticLibrary(std::string moduleFilename,
                                   const char* tmpbinname,
                                   std::vector<std::string> dotOFiles);
@@ -5172,6 +5207,10 @@ void makeBinaryLLVM(void) {
 
     splitStringWhitespace(CHPL_TARGET_SYSTEM_PROGRAM_LINK_ARGS, clangLDArgs);
 
+    // Instrumented code needs LLVM's profile runtime
+    if (fProfileGenerate)
+      clangLDArgs.push_back("-fprofile-generate");
+
     // Grab extra dependencies for multilocale libraries if needed.
     if (fClientServerLibrary) {
       std::string cmd = std::string(CHPL_HOME);
@@ -5228,6 +5267,10 @@ void makeBinaryLLVM(void) {
       }
     }
 
+    for (int i = 1; i < numModulePartitions(); i++) {
+      dotOFiles.push_back(getModulePartitionFilename(i));
+    }
+
     if (usingGpuLocaleModel() &&
         getGpuCodegenType() == GpuCodegenType::GPU_CG_AMD_HIP) {
       setPATH(curPath);
@@ -5349,6 +5392,212 @@ void makeBinaryLLVM(void) {
   }
 }
 
+// With --codegen-threads, the object code for the module is split across
+// this many files; the first one is moduleFilename. With a codegen cache,
+// the parts are kept small so that an edit invalidates little of it.
+static const int numCachedModulePartitions = 64;
+
+static int numModulePartitions() {
+  if (gCodegenGPU)
+    return 1;
+  if (!fCodegenCacheDir.empty())
+    return std::max(fCodegenThreads, numCachedModulePartitions);
+  return std::max(fCodegenThreads, 1);
+}
+
+static std::string getModulePartitionFilename(int i) {
+  if (i == 0)
+    return gGenInfo->llvmGenFilenames.moduleFilename;
+  return genIntermediateFilename(astr("chpl__module-", istr(i), ".o"));
+}
+
+static std::unique_ptr<llvm::TargetMachine> cloneTargetMachine() {
+  llvm::TargetMachine* tm = gGenInfo->targetMachine;
+  const llvm::Target& target = tm->getTarget();
+#if LLVM_VERSION_MAJOR >= 21
+  return std::unique_ptr<llvm::TargetMachine>(
+    target.createTargetMachine(tm->getTargetTriple(),
+                               tm->getTargetCPU(),
+                               tm->getTargetFeatureString(),
+                               tm->Options,
+                               tm->getRelocationModel(),
+                               tm->getCodeModel(),
+                               tm->getOptLevel()));
+#else
+  return std::unique_ptr<llvm::TargetMachine>(
+    target.createTargetMachine(tm->getTargetTriple().getTriple(),
+                               tm->getTargetCPU(),
+                               tm->getTargetFeatureString(),
+                               tm->Options,
+                               tm->getRelocationModel(),
+                               tm->getCodeModel(),
+                               tm->getOptLevel()));
+#endif
+}
+
+//
+// The IR has been optimized as a whole by now, so splitting it loses
+// nothing but the chance for the back end to see across the parts.
+// splitCodeGen() puts each part in its own context and generates code for
+// them on a thread each, which are linked together like any other .o.
+//
+static void llvmEmitObjectFilesInParallel() {
+#if HAVE_LLVM_VER >= 180
+  llvm::CodeGenFileType fileType = llvm::CodeGenFileType::ObjectFile;
+#else
+  llvm::CodeGenFileType fileType = llvm::CGFT_ObjectFile;
+#endif
+  int n = numModulePartitions();
+  std::vector<std::unique_ptr<llvm::raw_fd_ostream>> files;
+  std::vector<llvm::raw_pwrite_stream*> streams;
+
+  for (int i = 0; i < n; i++) {
+    std::string filename = getModulePartitionFilename(i);
+    std::error_code error;
+    files.emplace_back(new llvm::raw_fd_ostream(filename, error,
+                                                llvm::sys::fs::OF_None));
+    if (error || files.back()->has_error())
+      USR_FATAL("Could not open output file %s", filename.c_str());
+    streams.push_back(files.back().get());
+  }
+
+  llvm::splitCodeGen(*gGenInfo->module, streams, {}, cloneTargetMachine,
+                     fileType);
+
+  for (int i = 0; i < n; i++) {
+    files[i]->close();
+    handlePrintAsm(getModulePartitionFilename(i));
+  }
+}
+
+//
+// With --codegen-cache-dir, the module is split the same way, but each
+// part's object is looked up by a hash of its bitcode and of everything
+// else that affects the generated code. Parts that are found are copied
+// out of the cache; the rest are generated in parallel and added to it.
+// SplitModule assigns globals to parts by their names, so editing one
+// function changes only the parts holding it and its callers that
+// inlined it.
+//
+static std::string getCodegenCacheConfig() {
+  llvm::TargetMachine* tm = gGenInfo->targetMachine;
+  char version[128];
+  get_version(version, sizeof(version));
+
+  std::string ret = version;
+  ret += " " LLVM_VERSION_STRING " ";
+  ret += tm->getTargetTriple().str() + " ";
+  ret += tm->getTargetCPU().str() + " ";
+  ret += tm->getTargetFeatureString().str() + " ";
+  ret += istr((int) tm->getOptLevel());
+  ret += istr((int) tm->getRelocationModel());
+  ret += "\n";
+  return ret;
+}
+
+static bool emitObjectFileForBitcode(llvm::StringRef bitcode,
+                                     const std::string& filename) {
+  llvm::LLVMContext context;
+  auto module = llvm::parseBitcodeFile(
+      llvm::MemoryBufferRef(bitcode, filename), context);
+  if (!module) {
+    llvm::consumeError(module.takeError());
+    return false;
+  }
+
+  std::error_code error;
+  llvm::raw_fd_ostream outputOfile(filename, error, llvm::sys::fs::OF_None);
+  if (error || outputOfile.has_error())
+    return false;
+
+#if HAVE_LLVM_VER >= 180
+  llvm::CodeGenFileType fileType = llvm::CodeGenFileType::ObjectFile;
+#else
+  llvm::CodeGenFileType fileType = llvm::CGFT_ObjectFile;
+#endif
+
+  std::unique_ptr<llvm::TargetMachine> tm = cloneTargetMachine();
+  llvm::legacy::PassManager emitPM;
+  emitPM.add(createTargetTransformInfoWrapperPass(tm->getTargetIRAnalysis()));
+  if (tm->addPassesToEmitFile(emitPM, outputOfile, nullptr, fileType,
+                              /* disableVerify */ !developer))
+    return false;
+  emitPM.run(**module);
+  outputOfile.close();
+  return !outputOfile.has_error();
+}
+
+static void llvmEmitObjectFilesCached() {
+  int n = numModulePartitions();
+  std::vector<llvm::SmallString<0>> bitcodes(n);
+  int part = 0;
+
+  llvm::SplitModule(*gGenInfo->module, n,
+                    [&](std::unique_ptr<llvm::Module> mPart) {
+                      llvm::raw_svector_ostream os(bitcodes[part++]);
+                      llvm::WriteBitcodeToFile(*mPart, os);
+                    });
+
+  std::error_code error = llvm::sys::fs::create_directories(fCodegenCacheDir);
+  if (error)
+    USR_FATAL("Could not create codegen cache directory %s",
+              fCodegenCacheDir.c_str());
+
+  std::string config = getCodegenCacheConfig();
+  std::vector<uint8_t> failed(n, false);
+  int numHits = 0;
+
+#if HAVE_LLVM_VER >= 190
+  llvm::DefaultThreadPool pool(
+#else
+  llvm::ThreadPool pool(
+#endif
+      llvm::hardware_concurrency(std::max(fCodegenThreads, 1)));
+
+  for (int i = 0; i < part; i++) {
+    std::string key = config + bitcodes[i].str().str();
+    std::string hash = llvm::toHex(
+        llvm::SHA1::hash(llvm::arrayRefFromStringRef(key)));
+    llvm::SmallString<256> cached(fCodegenCacheDir);
+    llvm::sys::path::append(cached, hash + ".o");
+    std::string filename = getModulePartitionFilename(i);
+
+    if (llvm::sys::fs::exists(cached) &&
+        !llvm::sys::fs::copy_file(cached, filename)) {
+      numHits++;
+      continue;
+    }
+
+    std::string cachedName = cached.str().str();
+    pool.async([&bitcodes, &failed, i, filename, cachedName] {
+      if (!emitObjectFileForBitcode(bitcodes[i], filename)) {
+        failed[i] = true;
+        return;
+      }
+      // copy under a temporary name, then rename, so that concurrent
+      // builds sharing the cache never see a partial object
+      llvm::SmallString<256> tmp;
+      llvm::sys::fs::createUniquePath(cachedName + "-%%%%%%%%.tmp", tmp,
+                                      /* MakeAbsolute */ false);
+      // a failed copy may still have left part of the file behind
+      if (llvm::sys::fs::copy_file(filename, tmp) ||
+          llvm::sys::fs::rename(tmp, cachedName))
+        llvm::sys::fs::remove(tmp);
+    });
+  }
+  pool.wait();
+
+  for (int i = 0; i < part; i++) {
+    if (failed[i])
+      USR_FATAL("Could not generate code for %s",
+                getModulePartitionFilename(i).c_str());
+    handlePrintAsm(getModulePartitionFilename(i));
+  }
+
+  if (printSystemCommands)
+    printf("# codegen cache: reused %d of %d objects\n", numHits, part);
+}
+
 // Generate .o file from a completed LLVM Module
 static void llvmEmitObjectFile(void) {
   GenInfo* info = gGenInfo;
@@ -5373,7 +5622,11 @@ static void llvmEmitObjectFile(void) {
 
     bool disableVerify = !developer;
 
-    if (gCodegenGPU == false) {
+    if (!fCodegenCacheDir.empty() && gCodegenGPU == false) {
+      llvmEmitObjectFilesCached();
+    } else if (numModulePartitions() > 1) {
+      llvmEmitObjectFilesInParallel();
+    } else if (gCodegenGPU == false) {
       llvm::raw_fd_ostream outputOfile(filenames->moduleFilename, error, flags);
       if (error || outputOfile.has_error())
         USR_FATAL("Could not open output file %s", filenames->moduleFilename.c_str());
@@ -42,6 +42,16 @@
 // to load/store to inline the memcpy for example, or the
 // code generator might have started with loads and stores.
 
+// Before looking for sequences, a block ending in an unconditional branch
+// to a block that only it branches to is merged with that block when both
+// have global loads or stores, so that straight-line code split across
+// blocks still gets aggregated. While scanning for loads or stores to
+// merge, loads and stores of allocas whose address is never captured
+// are skipped over, since no global pointer can refer to them. Anything
+// else that may write memory, including fences and atomics, ends the
+// sequence, so the aggregated operations are never moved across an
+// ordering point.
+
 // This code was based upon the LLVM optimization MemCpyOptimizer.cpp
 // TODO: MemCpyOptimizer has evolved quite a bit since then,
 // so look at making a new version of this pass.
@@ -65,10 +75,14 @@
 #include "llvm/IR/Verifier.h"
 
 #include "llvm/Analysis/CallGraph.h"
+#include "llvm/Analysis/CaptureTracking.h"
 #include "llvm/Analysis/LazyCallGraph.h"
 #include "llvm/Analysis/ValueTracking.h"
+#include "llvm/Transforms/Utils/BasicBlockUtils.h"
 #include "llvm/Transforms/Utils/ValueMapper.h"
 
+#include <algorithm>
+
 #include <cstdio>
 #include <list>
 #include <string>
@@ -116,6 +130,16 @@ bool isMergeableGlobalLoadOrStore(Instruction* I,
   }
   return false;
 }
+static
+bool hasMergeableGlobalLoadOrStore(BasicBlock* BB, unsigned globalSpace)
+{
+  for (Instruction& I : *BB) {
+    if( isMergeableGlobalLoadOrStore(&I, globalSpace, true, true) ) {
+      return true;
+    }
+  }
+  return false;
+}
 static inline
 Value* getLoadStorePointer(Instruction* I)
 {
@@ -144,6 +168,9 @@ Instruction* postponeDependentInstructions(
   // memopsUses stores uses of toAggregate
   SmallPtrSet<Instruction*, 8> memopsUses;
   Instruction *LastMemopUse = NULL;
+  // Once something that accesses memory is postponed, everything after it
+  // that accesses memory has to be too, to keep them in order.
+  bool postponedMemoryAccess = false;
 
   // Gather any instructions using the result of a load
   for (BasicBlock::iterator BI = First->getIterator();
@@ -166,7 +193,14 @@ Instruction* postponeDependentInstructions(
       }
     }
 
-    if( isUseOfMemop ) memopsUses.insert(insn);
+    if( postponedMemoryAccess && !toAggregate.count(insn) &&
+        insn->mayReadOrWriteMemory() )
+      isUseOfMemop = true;
+
+    if( isUseOfMemop ) {
+      memopsUses.insert(insn);
+      if( insn->mayReadOrWriteMemory() ) postponedMemoryAccess = true;
+    }
 
     if( insn == Last ) break;
   }
@@ -388,7 +422,7 @@ bool LegacyAggregateGlobalOpsOptPass::runOnFunction(Function &F) {
 void
 LegacyAggregateGlobalOpsOptPass::getAnalysisUsage(AnalysisUsage &AU) const {
   // TODO -- update these better
-  AU.setPreservesCFG();
+  // (the CFG isn't preserved since straight-line blocks may be merged)
   /*AU.addRequired<DominatorTree>();
   AU.addRequired<MemoryDependenceAnalysis>();
   AU.addRequired<AliasAnalysis>();
@@ -420,6 +454,62 @@ PreservedAnalyses AggregateGlobalOpsOptPass::run(Function &F,
   return preserved;
 }
 
+// Is I a simple load or store of an alloca that no global pointer can
+// refer to? Such accesses can't interfere with global loads or stores.
+bool AggregateGlobalOpsOpt::isPrivateLocalAccess(Instruction* I) {
+  if (LoadInst* load = dyn_cast<LoadInst>(I)) {
+    if (!load->isSimple()) return false;
+  } else if (StoreInst* store = dyn_cast<StoreInst>(I)) {
+    if (!store->isSimple()) return false;
+  } else {
+    return false;
+  }
+
+  Value* ptr = getLoadStorePointer(I);
+  if (ptr->getType()->getPointerAddressSpace() == globalSpace)
+    return false;
+
+  const Value* obj = getUnderlyingObject(ptr);
+  if (!isa<AllocaInst>(obj))
+    return false;
+
+  auto it = privateAllocas.find(obj);
+  if (it != privateAllocas.end())
+    return it->second;
+
+#if HAVE_LLVM_VER >= 200
+  bool isPrivate = !PointerMayBeCaptured(obj, /* ReturnCaptures */ true);
+#else
+  bool isPrivate = !PointerMayBeCaptured(obj, /* ReturnCaptures */ true,
+                                         /* StoreCaptures */ true);
+#endif
+  privateAllocas[obj] = isPrivate;
+  return isPrivate;
+}
+
+// Merge a block into its predecessor when the predecessor unconditionally
+// branches to it, it has no other predecessors, and both have global
+// loads or stores.  That lets tryAggregating see straight-line code as one
+// sequence.
+bool AggregateGlobalOpsOpt::mergeStraightLineBlocks(Function& F) {
+  bool changed = false;
+
+  for (Function::iterator BB = F.begin(), BBE = F.end(); BB != BBE; ++BB) {
+    if (!hasMergeableGlobalLoadOrStore(&*BB, globalSpace))
+      continue;
+
+    while (BasicBlock* Succ = BB->getSingleSuccessor()) {
+      if (Succ == &*BB || Succ->getSinglePredecessor() != &*BB ||
+          !hasMergeableGlobalLoadOrStore(Succ, globalSpace) ||
+          !MergeBlockIntoPredecessor(Succ))
+        break;
+      changed = true;
+    }
+  }
+
+  return changed;
+}
+
 /// tryAggregating - When scanning forward over instructions, we look for
 /// other loads or stores that could be aggregated with this one.
 /// Returns the last instruction added (if one was added) since we might have
@@ -458,6 +548,9 @@ Instruction *AggregateGlobalOpsOpt::tryAggregating(Instruction *StartInst, Value
     Instruction* insn = &insnRef;
     if( isMergeableGlobalLoadOrStore(insn, globalSpace, isLoad, isStore) ) {
       // OK!
+    } else if( isPrivateLocalAccess(insn) ) {
+      // Nothing global can see it.
+      continue;
     } else {
       // If the instruction is readnone, ignore it, otherwise bail out.  We
       // don't even allow readonly here because we don't want something like:
@@ -624,10 +717,18 @@ Instruction *AggregateGlobalOpsOpt::tryAggregating(Instruction *StartInst, Value
                        Range.End-Range.Start, Alignment);
 
     // If storing, do the stores we had into our alloca'd region.
+    // They go in program order, since merging ranges may have reordered
+    // them and overlapping stores have to leave the last one's value.
     if( isStore ) {
+      SmallVector<Instruction*, 16> orderedStores(Range.TheStores.begin(),
+                                                  Range.TheStores.end());
+      std::stable_sort(orderedStores.begin(), orderedStores.end(),
+                       [&bbPos](Instruction* a, Instruction* b) {
+                         return bbPos.lookup(a) < bbPos.lookup(b);
+                       });
       for (SmallVector<Instruction*, 16>::const_iterator
-           SI = Range.TheStores.begin(),
-           SE = Range.TheStores.end(); SI != SE; ++SI) {
+           SI = orderedStores.begin(),
+           SE = orderedStores.end(); SI != SE; ++SI) {
         StoreInst* oldStore = cast<StoreInst>(*SI);
 
         int64_t offset = 0;
@@ -774,6 +875,11 @@ bool AggregateGlobalOpsOpt::run(Function &F) {
   //MD = &getAnalysis<MemoryDependenceAnalysis>();
   DL = & F.getParent()->getDataLayout();
   //TLI = &getAnalysis<TargetLibraryInfo>();
+  privateAllocas.clear();
+
+  if( mergeStraightLineBlocks(F) ) {
+    ChangedFn = true;
+  }
 
   // Walk all instruction in the function.
   for (Function::iterator BB = F.begin(), BBE = F.end(); BB != BBE; ++BB) {
@@ -46,6 +46,8 @@
 #include "llvm/ADT/SmallSet.h"
 #include "llvm/ADT/Statistic.h"
 
+#include "llvm/Analysis/ValueTracking.h"
+
 #include "llvm/IR/Attributes.h"
 #if HAVE_LLVM_VER >= 170
 #include "llvm/IR/AttributeMask.h"
@@ -55,6 +57,7 @@
 #include "llvm/IR/InstIterator.h"
 #include "llvm/IR/Intrinsics.h"
 #include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/PatternMatch.h"
 #include "llvm/IR/Verifier.h"
 
 #include "llvm/Pass.h"
@@ -80,6 +83,11 @@ namespace {
   unsigned wideLocaleGEP[] = {0};
   unsigned wideNodeGEP[] = {0,0};
   unsigned wideAddrGEP[] = {1};
+  unsigned localeNodeGEP[] = {0};
+
+  // A packed wide pointer is an integer with the node above this many
+  // bits of address.
+  static const unsigned packedAddrBits = 48;
 
   static const bool debugAllPassOne = false;
   static const bool debugAllPassTwo = false;
@@ -222,7 +230,27 @@ namespace {
     return ConstantInt::get(ty, val);
   }
 
+  Constant* getPackedAddrMask(Type* wideTy) {
+    return ConstantInt::get(wideTy, (UINT64_C(1) << packedAddrBits) - 1);
+  }
+
   Instruction* createRaddr(GlobalToWideInfo* info, Value* widePtr, Instruction* insertBefore) {
+    if (info->packedWidePointers) {
+      // Mask off the node and convert what's left to a pointer
+      Type* wideTy = widePtr->getType();
+      assert(wideTy->isIntegerTy());
+
+      Instruction* bits = BinaryOperator::Create(Instruction::And, widePtr,
+                                                 getPackedAddrMask(wideTy),
+                                                 "", getInsertPosition(insertBefore));
+      trackLLVMValue(bits);
+      Instruction* ret = new IntToPtrInst(bits,
+                                          getPointerType(wideTy->getContext()),
+                                          "", getInsertPosition(insertBefore));
+      trackLLVMValue(ret);
+      return ret;
+    }
+
     // Assuming widePtr is a struct wide-pointer, extract the address
     assert(widePtr->getType()->isStructTy());
 
@@ -231,7 +259,19 @@ namespace {
     trackLLVMValue(ret);
     return ret;
   }
+  Instruction* createRnode(GlobalToWideInfo* info, Value* widePtr, Instruction* insertBefore);
+
   Instruction* createRlocale(GlobalToWideInfo* info, Value* widePtr, Instruction* insertBefore) {
+    if (info->packedWidePointers) {
+      // The locale id is just the node
+      Instruction* node = createRnode(info, widePtr, insertBefore);
+      Instruction* ret = InsertValueInst::Create(UndefValue::get(info->localeIdType),
+                                                 node, localeNodeGEP, "",
+                                                 getInsertPosition(insertBefore));
+      trackLLVMValue(ret);
+      return ret;
+    }
+
     // Assuming widePtr is a struct wide-pointer, extract the address
     assert(widePtr->getType()->isStructTy());
 
@@ -241,6 +281,20 @@ namespace {
     return ret;
   }
   Instruction* createRnode(GlobalToWideInfo* info, Value* widePtr, Instruction* insertBefore) {
+    if (info->packedWidePointers) {
+      Type* wideTy = widePtr->getType();
+      assert(wideTy->isIntegerTy());
+
+      Instruction* shift = BinaryOperator::Create(Instruction::LShr, widePtr,
+                                                  ConstantInt::get(wideTy, packedAddrBits),
+                                                  "", getInsertPosition(insertBefore));
+      trackLLVMValue(shift);
+      Instruction* ret = new TruncInst(shift, info->nodeIdType,
+                                       "", getInsertPosition(insertBefore));
+      trackLLVMValue(ret);
+      return ret;
+    }
+
     // Assuming widePtr is a struct wide-pointer, extract the address
     assert(widePtr->getType()->isStructTy());
 
@@ -254,6 +308,33 @@ namespace {
                         Type* widePtrType,
                         Instruction* insertBefore) {
 
+    if (info->packedWidePointers) {
+      // (node << packedAddrBits) | (addr & mask)
+      assert(widePtrType->isIntegerTy());
+
+      Instruction* node = ExtractValueInst::Create(localeId, localeNodeGEP, "",
+                                                   getInsertPosition(insertBefore));
+      trackLLVMValue(node);
+      Instruction* wideNode = new ZExtInst(node, widePtrType, "",
+                                           getInsertPosition(insertBefore));
+      trackLLVMValue(wideNode);
+      Instruction* high = BinaryOperator::Create(Instruction::Shl, wideNode,
+                                                 ConstantInt::get(widePtrType, packedAddrBits),
+                                                 "", getInsertPosition(insertBefore));
+      trackLLVMValue(high);
+      Instruction* addrBits = new PtrToIntInst(addr, widePtrType, "",
+                                               getInsertPosition(insertBefore));
+      trackLLVMValue(addrBits);
+      Instruction* low = BinaryOperator::Create(Instruction::And, addrBits,
+                                                getPackedAddrMask(widePtrType),
+                                                "", getInsertPosition(insertBefore));
+      trackLLVMValue(low);
+      Instruction* ret = BinaryOperator::Create(Instruction::Or, high, low, "",
+                                                getInsertPosition(insertBefore));
+      trackLLVMValue(ret);
+      return ret;
+    }
+
     Constant* undefWidePtr = UndefValue::get(widePtrType);
 
     Instruction* locSet = InsertValueInst::Create(undefWidePtr, localeId,
@@ -268,6 +349,12 @@ namespace {
   }
 
   Value* createWideBitCast(GlobalToWideInfo* info, Value* widePtr, Type* widePtrType, Instruction* insertBefore) {
+    // Packed wide pointers all have the same type.
+    if (info->packedWidePointers) {
+      assert(widePtr->getType() == widePtrType);
+      return widePtr;
+    }
+
     // The destination type should be a wide pointer.
     assert(widePtrType->isStructTy());
 
@@ -306,6 +393,84 @@ namespace {
     return ptrSet;
   }
 
+  bool isGetLocaleIDCall(Value* v) {
+    if (CallInst* call = dyn_cast<CallInst>(v)) {
+      Function* fn = call->getCalledFunction();
+      return fn != nullptr && fn->getName() == "chpl_gen_getLocaleID";
+    }
+    return false;
+  }
+
+  // Is node the one this code is running on? That is known when it was
+  // loaded from chpl_nodeID or taken from chpl_gen_getLocaleID(), possibly
+  // after going in and out of a locale id.
+  bool isHereNode(Value* node) {
+    for (int depth = 0; depth < 8; depth++) {
+      if (ExtractValueInst* ev = dyn_cast<ExtractValueInst>(node)) {
+        Value* agg = ev->getAggregateOperand();
+        if (isGetLocaleIDCall(agg) &&
+            ev->getIndices() == ArrayRef<unsigned>(localeNodeGEP)) {
+          return true;
+        }
+        node = FindInsertedValue(agg, ev->getIndices());
+        if (node == nullptr) return false;
+      } else if (isa<ZExtInst>(node) || isa<SExtInst>(node) ||
+                 isa<TruncInst>(node)) {
+        node = cast<CastInst>(node)->getOperand(0);
+      } else if (LoadInst* load = dyn_cast<LoadInst>(node)) {
+        Value* ptr = load->getPointerOperand()->stripPointerCasts();
+        GlobalVariable* gv = dyn_cast<GlobalVariable>(ptr);
+        return gv != nullptr && gv->getName() == "chpl_nodeID";
+      } else {
+        return false;
+      }
+    }
+    return false;
+  }
+
+  bool isHereLocale(Value* localeId) {
+    if (isGetLocaleIDCall(localeId)) return true;
+    Value* node = FindInsertedValue(localeId, localeNodeGEP);
+    return node != nullptr && isHereNode(node);
+  }
+
+  // Does widePtr point to memory on the node this code is running on?
+  // This looks for where it (or the global pointer it came from) was
+  // made, so that a pointer made from `here` can be used directly.
+  bool isHereWidePtr(GlobalToWideInfo* info, Value* widePtr) {
+    using namespace llvm::PatternMatch;
+
+    for (int depth = 0; depth < 8; depth++) {
+      CallInst* call = dyn_cast<CallInst>(widePtr);
+      Function* fn = call ? call->getCalledFunction() : nullptr;
+      if (fn && starts_with(fn->getName(), GLOBAL_FN_GLOBAL_TO_WIDE)) {
+        // g2w(w2g(wide)) or g2w(make(locale, addr))
+        CallInst* inner = dyn_cast<CallInst>(call->getArgOperand(0));
+        Function* innerFn = inner ? inner->getCalledFunction() : nullptr;
+        if (innerFn == nullptr) {
+          return false;
+        } else if (starts_with(innerFn->getName(), GLOBAL_FN_WIDE_TO_GLOBAL)) {
+          widePtr = inner->getArgOperand(0);
+        } else if (starts_with(innerFn->getName(), GLOBAL_FN_GLOBAL_MAKE)) {
+          return isHereLocale(inner->getArgOperand(0));
+        } else {
+          return false;
+        }
+      } else if (info->packedWidePointers) {
+        Value* node = nullptr;
+        return match(widePtr,
+                     m_c_Or(m_Shl(m_ZExt(m_Value(node)),
+                                  m_SpecificInt(packedAddrBits)),
+                            m_Value())) &&
+               isHereNode(node);
+      } else {
+        Value* localeId = FindInsertedValue(widePtr, wideLocaleGEP);
+        return localeId != nullptr && isHereLocale(localeId);
+      }
+    }
+    return false;
+  }
+
   // Creates a store/load pattern with bitcasts to implement complex
   // type conversions (converting a wide pointer type to an integer type, say).
   // TODO: how to ensure proper alignment?
@@ -539,7 +704,7 @@ namespace {
             auto newVecType = convertTypeGlobalToWide(&M, info, vecVal->getType());
             auto newVecVal = createStoreLoadCast(vecVal, newVecType, insn);
 
-            auto newInsertVal = createStoreLoadCast(insertVal, IntegerType::getInt128Ty(M.getContext()), insn);
+            auto newInsertVal = createStoreLoadCast(insertVal, IntegerType::get(M.getContext(), info->globalPtrBits), insn);
 
             auto newInsn = InsertElementInst::Create(newVecVal, newInsertVal, idx, "", getInsertPosition(insn));
             trackLLVMValue(newInsn);
@@ -761,44 +926,61 @@ namespace {
             // call to 'get'
             Type* glLoadedTy = oldLoad->getType();
             Type* wLoadedTy = convertTypeGlobalToWide(&M, info, glLoadedTy);
-            // Create a call to 'get'
-            // first, alloca a temporary to 'get' into
-            Value* alloc = makeAlloca(wLoadedTy, "", oldLoad);
-            Value* castAlloc = new BitCastInst(alloc, voidPtrTy, "", getInsertPosition(oldLoad));
-            Value* node = createRnode(info, wAddr, oldLoad);
-            Value* raddr = createRaddr(info, wAddr, oldLoad);
-            Value* castRaddr = new BitCastInst(raddr, voidPtrTy, "", getInsertPosition(oldLoad));
-            Value* size = createSizeof(info, wLoadedTy);
-            trackLLVMValue(castAlloc);
-            trackLLVMValue(castRaddr);
-            {
-              // Convert size if necessary
-              IRBuilder<> irBuilder(oldLoad);
-              size = irBuilder.CreateZExtOrTrunc(size, sizeTy);
-              trackLLVMValue(size);
-            }
+            Instruction* loadedWide = nullptr;
+            if (isHereWidePtr(info, wAddr)) {
+              // The address is on this node, so just load from it
+              Value* raddr = createRaddr(info, wAddr, oldLoad);
+              Value* localAddr = CastInst::CreatePointerCast(raddr,
+                                                             getPointerType(wLoadedTy),
+                                                             "", getInsertPosition(oldLoad));
+              trackLLVMValue(localAddr);
+              loadedWide = new LoadInst(wLoadedTy, localAddr, "",
+                                        oldLoad->isVolatile(),
+                                        oldLoad->getAlign(),
+                                        oldLoad->getOrdering(),
+                                        oldLoad->getSyncScopeID(),
+                                        getInsertPosition(oldLoad));
+              trackLLVMValue(loadedWide);
+            } else {
+              // Create a call to 'get'
+              // first, alloca a temporary to 'get' into
+              Value* alloc = makeAlloca(wLoadedTy, "", oldLoad);
+              Value* castAlloc = new BitCastInst(alloc, voidPtrTy, "", getInsertPosition(oldLoad));
+              Value* node = createRnode(info, wAddr, oldLoad);
+              Value* raddr = createRaddr(info, wAddr, oldLoad);
+              Value* castRaddr = new BitCastInst(raddr, voidPtrTy, "", getInsertPosition(oldLoad));
+              Value* size = createSizeof(info, wLoadedTy);
+              trackLLVMValue(castAlloc);
+              trackLLVMValue(castRaddr);
+              {
+                // Convert size if necessary
+                IRBuilder<> irBuilder(oldLoad);
+                size = irBuilder.CreateZExtOrTrunc(size, sizeTy);
+                trackLLVMValue(size);
+              }
 
-            Value* args[5];
-            args[0] = castAlloc;
-            args[1] = node;
-            args[2] = castRaddr;
-            args[3] = size;
-            args[4] = createLoadStoreControl(M, info, oldLoad->getOrdering(),
-                                             oldLoad->getSyncScopeID()
-                                             );
-
-            Value* call = CallInst::Create(getFnType, getFn, args, "", getInsertPosition(oldLoad));
-            trackLLVMValue(call);
-            if (call == nullptr) assert(false && "failure creating call");
-
-            // Now load from the alloc'd area.
-            Instruction* loadedWide = new LoadInst(wLoadedTy, alloc, "",
-                                       oldLoad->isVolatile(),
-                                       oldLoad->getAlign(),
-                                       oldLoad->getOrdering(),
-                                       oldLoad->getSyncScopeID(),
-                                       getInsertPosition(oldLoad));
-            trackLLVMValue(loadedWide);
+              Value* args[5];
+              args[0] = castAlloc;
+              args[1] = node;
+              args[2] = castRaddr;
+              args[3] = size;
+              args[4] = createLoadStoreControl(M, info, oldLoad->getOrdering(),
+                                               oldLoad->getSyncScopeID()
+                                               );
+
+              Value* call = CallInst::Create(getFnType, getFn, args, "", getInsertPosition(oldLoad));
+              trackLLVMValue(call);
+              if (call == nullptr) assert(false && "failure creating call");
+
+              // Now load from the alloc'd area.
+              loadedWide = new LoadInst(wLoadedTy, alloc, "",
+                                        oldLoad->isVolatile(),
+                                        oldLoad->getAlign(),
+                                        oldLoad->getOrdering(),
+                                        oldLoad->getSyncScopeID(),
+                                        getInsertPosition(oldLoad));
+              trackLLVMValue(loadedWide);
+            }
 
             // now convert loadedWide back into a global type,
             // if necessary.
@@ -823,47 +1005,64 @@ namespace {
             Value* wValueOp = callGlobalToWideFn(glValueOp, oldStore);
             Value* wAddr = callGlobalToWideFn(glAddrOp, oldStore);
 
-            // Create a call to 'put'
-            // first, alloca a temporary to 'put' from
-            Value* alloc = makeAlloca(wStoredTy, "", oldStore);
-            Value* castAlloc = new BitCastInst(alloc, voidPtrTy, "", getInsertPosition(oldStore));
-            trackLLVMValue(castAlloc);
-
-            // Now store to the alloc'd area
-            Instruction* st = new StoreInst(wValueOp, alloc,
-                                            oldStore->isVolatile(),
-                                            oldStore->getAlign(),
-                                            oldStore->getOrdering(),
-                                            oldStore->getSyncScopeID(),
-                                            getInsertPosition(oldStore));
-            if (st == nullptr) assert(false && "failure creating store");
-            trackLLVMValue(st);
-
-            Value* node = createRnode(info, wAddr, oldStore);
-            Value* raddr = createRaddr(info, wAddr, oldStore);
-            Value* castRaddr = new BitCastInst(raddr, voidPtrTy, "", getInsertPosition(oldStore));
-            Value* size = createSizeof(info, wStoredTy);
-            trackLLVMValue(castRaddr);
-            {
-              // Convert size if necessary
-              IRBuilder<> irBuilder(oldStore);
-              size = irBuilder.CreateZExtOrTrunc(size, sizeTy);
-              trackLLVMValue(size);
-            }
+            if (isHereWidePtr(info, wAddr)) {
+              // The address is on this node, so just store to it
+              Value* raddr = createRaddr(info, wAddr, oldStore);
+              Value* localAddr = CastInst::CreatePointerCast(raddr,
+                                                             getPointerType(wStoredTy),
+                                                             "", getInsertPosition(oldStore));
+              trackLLVMValue(localAddr);
+              Instruction* st = new StoreInst(wValueOp, localAddr,
+                                              oldStore->isVolatile(),
+                                              oldStore->getAlign(),
+                                              oldStore->getOrdering(),
+                                              oldStore->getSyncScopeID(),
+                                              getInsertPosition(oldStore));
+              trackLLVMValue(st);
+              myReplaceInstWithInst(oldStore, st);
+            } else {
+              // Create a call to 'put'
+              // first, alloca a temporary to 'put' from
+              Value* alloc = makeAlloca(wStoredTy, "", oldStore);
+              Value* castAlloc = new BitCastInst(alloc, voidPtrTy, "", getInsertPosition(oldStore));
+              trackLLVMValue(castAlloc);
+
+              // Now store to the alloc'd area
+              Instruction* st = new StoreInst(wValueOp, alloc,
+                                              oldStore->isVolatile(),
+                                              oldStore->getAlign(),
+                                              oldStore->getOrdering(),
+                                              oldStore->getSyncScopeID(),
+                                              getInsertPosition(oldStore));
+              if (st == nullptr) assert(false && "failure creating store");
+              trackLLVMValue(st);
+
+              Value* node = createRnode(info, wAddr, oldStore);
+              Value* raddr = createRaddr(info, wAddr, oldStore);
+              Value* castRaddr = new BitCastInst(raddr, voidPtrTy, "", getInsertPosition(oldStore));
+              Value* size = createSizeof(info, wStoredTy);
+              trackLLVMValue(castRaddr);
+              {
+                // Convert size if necessary
+                IRBuilder<> irBuilder(oldStore);
+                size = irBuilder.CreateZExtOrTrunc(size, sizeTy);
+                trackLLVMValue(size);
+              }
 
-            // Now put from the alloc'd area
-            Value* args[5];
-            args[0] = node;
-            args[1] = castRaddr;
-            args[2] = castAlloc;
-            args[3] = size;
-            args[4] = createLoadStoreControl(M, info, oldStore->getOrdering(),
-                                             oldStore->getSyncScopeID()
-                                             );
-
-            Instruction* put = CallInst::Create(putFnType, putFn, args, "", getInsertPosition(oldStore));
-            trackLLVMValue(put);
-            myReplaceInstWithInst(oldStore, put);
+              // Now put from the alloc'd area
+              Value* args[5];
+              args[0] = node;
+              args[1] = castRaddr;
+              args[2] = castAlloc;
+              args[3] = size;
+              args[4] = createLoadStoreControl(M, info, oldStore->getOrdering(),
+                                               oldStore->getSyncScopeID()
+                                               );
+
+              Instruction* put = CallInst::Create(putFnType, putFn, args, "", getInsertPosition(oldStore));
+              trackLLVMValue(put);
+              myReplaceInstWithInst(oldStore, put);
+            }
           }
           break; }
         case Instruction::PtrToInt: {
@@ -1103,8 +1302,8 @@ namespace {
           assert(0 && "BlockAddress shouldn't involve a global pointer");
         }
         if (isa<ConstantPointerNull>(C)) {
-          if( newType->isStructTy() ) {
-            // Null global pointer -> null wide struct.
+          if( newType->isStructTy() || newType->isIntegerTy() ) {
+            // Null global pointer -> null wide struct or packed pointer.
             return Constant::getNullValue(newType);
           } else {
             // Null global pointer -> null wide pointer.
@@ -1477,6 +1676,13 @@ bool GlobalToWide::run(Module &M) {
 
         bool ok = (dl.getTypeSizeInBits(testGlobalTy) == info->globalPtrBits) &&
                   (dl.getTypeSizeInBits(testWideTy) == info->globalPtrBits);
+        if (info->packedWidePointers) {
+          // the locale id must be nothing but the node
+          StructType* locTy = dyn_cast<StructType>(info->localeIdType);
+          ok = ok && info->globalPtrBits == 64 &&
+               locTy && locTy->getNumElements() == 1 &&
+               locTy->getElementType(0) == info->nodeIdType;
+        }
         if (!ok) {
           printf("Error: llvmGlobalToWide pass doesn't match DataLayout\n");
           printf("module DataLayout is %s\n",
@@ -2315,6 +2521,13 @@ static
 Type* createWidePointerToType(Module* module, GlobalToWideInfo* i, Type* eltTy)
 {
   LLVMContext& context = module->getContext();
+
+  // A packed wide pointer is just an integer
+  if (i->packedWidePointers) {
+    assert(eltTy == nullptr && "packed wide pointers need opaque pointers");
+    return IntegerType::get(context, i->globalPtrBits);
+  }
+
   // Get the wide pointer struct containing {locale, address}
   Type* fields[2];
   fields[0] = i->localeIdType;
@@ -22,6 +22,7 @@
 
 #include "baseAST.h"
 #include "driver.h"
+#include "global-ast-vecs.h"
 
 #include <cstdlib>
 #include <cstring>
@@ -80,9 +81,20 @@ void PhaseTracker::StartPhase(const char* name, int passId, SubPhase subPhase) {
     PhaseData(mTimer.elapsedUsecs(), mMemoryTracker.usedBytes())
   );
 
+  // The counts at the start of a pass are those at the end of the last one
+  if (subPhase == kPrimary) phase->mAstCounts = CountAsts();
+
   mPhases.push_back(phase);
 }
 
+std::vector<int> PhaseTracker::CountAsts() {
+  std::vector<int> counts;
+#define count_gvec(type) counts.push_back(g##type##s.n)
+  foreach_ast(count_gvec);
+#undef count_gvec
+  return counts;
+}
+
 void PhaseTracker::Stop() {
   mTimer.stop();
   mMemoryTracker.stop();
@@ -235,6 +247,7 @@ void PhaseTracker::PassesCollect(std::vector<Pass>& passes) const {
 
       // Check if it's time to push an completed pass
       if (i > 0 && mPhases[i]->mSubPhase == PhaseTracker::kPrimary) {
+        pass.mAstCounts = mPhases[i]->mAstCounts;
         passes.push_back(pass);
         pass.Reset();
       }
@@ -257,10 +270,57 @@ void PhaseTracker::PassesCollect(std::vector<Pass>& passes) const {
       }
     }
 
+    pass.mAstCounts = CountAsts();
     passes.push_back(pass);
   }
 }
 
+void PhaseTracker::ReportJson(const char* filename) const {
+  static const char* astNames[] = {
+#define name_ast(type) #type
+#define name_sep ,
+    foreach_ast_sep(name_ast, name_sep)
+#undef name_sep
+#undef name_ast
+  };
+  std::vector<Pass> passes;
+  auto total = PhaseData(mTimer.elapsedUsecs(), mMemoryTracker.usedBytes());
+  FILE* fp = fopen(filename, "w");
+
+  if (fp == nullptr) {
+    USR_WARN("Error opening pass report file: %s.", filename);
+    return;
+  }
+
+  PassesCollect(passes);
+
+  fprintf(fp, "{\n");
+  fprintf(fp, "  \"totalSeconds\": %.6f,\n", total.timeInUsecs / 1e6);
+  fprintf(fp, "  \"totalMemoryBytes\": %" PRId64 ",\n", total.memory);
+  fprintf(fp, "  \"passes\": [");
+
+  for (size_t i = 0; i < passes.size(); i++) {
+    const Pass& p = passes[i];
+
+    fprintf(fp, "%s\n    {\"id\": %d, \"name\": \"%s\"",
+            i > 0 ? "," : "", p.mPassId, p.mName ? p.mName : "");
+    fprintf(fp, ", \"seconds\": %.6f, \"mainSeconds\": %.6f",
+            p.TotalTime() / 1e6, p.mPrimary.timeInUsecs / 1e6);
+    fprintf(fp, ", \"memoryBytes\": %" PRId64, p.TotalMemory());
+    fprintf(fp, ", \"asts\": %d, \"astsByType\": {", p.NumAsts());
+
+    for (size_t j = 0; j < p.mAstCounts.size(); j++) {
+      fprintf(fp, "%s\"%s\": %d",
+              j > 0 ? ", " : "", astNames[j], p.mAstCounts[j]);
+    }
+
+    fprintf(fp, "}}");
+  }
+
+  fprintf(fp, "\n  ]\n}\n");
+  fclose(fp);
+}
+
 static void PassesReport(const std::vector<Pass>& passes, PhaseData total) {
   if (PhaseTracker::shouldReportPasses())
     PassesReport(PhaseTracker::passesOutputFile(), passes, total);
@@ -384,6 +444,7 @@ void Pass::Reset() {
   mPrimary  = PhaseData();
   mVerify   = PhaseData();
   mCleanAst = PhaseData();
+  mAstCounts.clear();
 }
 
 unsigned long Pass::TotalTime() const {
@@ -394,6 +455,12 @@ MemoryTracker::MemoryInBytes Pass::TotalMemory() const {
   return mPrimary.memory + mVerify.memory + mCleanAst.memory;
 }
 
+int Pass::NumAsts() const {
+  int num = 0;
+  for (int count: mAstCounts) num += count;
+  return num;
+}
+
 bool Pass::CompareByTime(Pass const& ref) const {
   if (TotalTime() > ref.TotalTime())
     return true;
@@ -431,6 +498,7 @@ void Pass::Header(FILE* fp) {
 
     fprintf(fp, "   Memory   %%  ");
     fprintf(fp, "   Accum    %%  ");
+    fprintf(fp, "     ASTs");
   }
 
   fprintf(fp, "\n");
@@ -454,6 +522,7 @@ void Pass::Header(FILE* fp) {
 
     fprintf(fp, "  ------- -----");
     fprintf(fp, "  ------- -----");
+    fprintf(fp, "  ---------");
   }
 
   fprintf(fp, "\n");
@@ -491,6 +560,7 @@ void Pass::Print(FILE* fp, PhaseData accum, PhaseData total) const {
     fprintf(fp, "  %12.3f  %12.3f  %12.3f", primaryMem, verifyMem, cleanMem);
     fprintf(fp, "  %7.3f %5.1f", MemoryTracker::toMB(passMemory), passMemoryFrac);
     fprintf(fp, "  %7.3f %5.1f", MemoryTracker::toMB(accum.memory), accumMemoryFrac);
+    fprintf(fp, "  %9d", NumAsts());
   }
   fprintf(fp, "\n");
 }
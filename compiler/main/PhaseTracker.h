@@ -137,6 +137,10 @@ public:
 
   void ReportRollup() const;
 
+  // Write the time, memory and live AST node counts of each pass to
+  // 'filename' as JSON, for tracking them across builds.
+  void ReportJson(const char* filename) const;
+
   static bool shouldReportPasses();
   static auto& passesOutputFile() {
     return printPassesFile != nullptr ? printPassesFile : stderr;
@@ -147,6 +151,8 @@ private:
 
   void StartPhase(const char* phaseName, int passId, SubPhase subPhase);
 
+  static std::vector<int> CountAsts();
+
   Timer               mTimer;
   MemoryTracker       mMemoryTracker;
   int                 mPhaseId;
@@ -176,6 +182,7 @@ public:
   int                    mPassId;
   PhaseTracker::SubPhase mSubPhase;
   PhaseData              mStart; // Elapsed from main()
+  std::vector<int>       mAstCounts; // Live nodes by type, for kPrimary
 
 private:
   Phase();
@@ -199,6 +206,7 @@ public:
   void                         Reset();
   unsigned long                TotalTime() const;
   MemoryTracker::MemoryInBytes TotalMemory() const;
+  int                          NumAsts() const;
 
   void Print(FILE* fp, PhaseData accum, PhaseData total) const;
 
@@ -208,6 +216,9 @@ public:
   PhaseData mPrimary;
   PhaseData mVerify;
   PhaseData mCleanAst;
+
+  // Live nodes by type at the end of the pass, in foreach_ast order
+  std::vector<int> mAstCounts;
 };
 
 #endif
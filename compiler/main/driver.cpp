@@ -53,6 +53,8 @@
 
 #include "chpl/util/assertions.h"
 
+#include <fstream>
+#include <iostream>
 #include <string>
 #include <map>
 #include <regex>
@@ -181,16 +183,22 @@ bool fNoCopyPropagation = false;
 bool fNoDeadCodeElimination = false;
 bool fNoScalarReplacement = false;
 bool fNoTupleCopyOpt = false;
+bool fSpecializeRectangularAccess = false;
+bool fFlattenAggregateArgs = false;
 bool fNoRemoteValueForwarding = false;
 bool fNoInferConstRefs = false;
 bool fNoRemoteSerialization = false;
+bool fRemoteValueForwardRecords = false;
 bool fNoRemoveCopyCalls = false;
+bool fElideYieldCopies = false;
 bool fNoOptimizeRangeIteration = false;
 bool fNoOptimizeLoopIterators = false;
 bool fNoVectorize = false; // adjusted in postVectorize
 static bool fYesVectorize = false;
 bool fForceVectorize = false;
 std::string fVectorLib;
+bool fProfileGenerate = false;
+std::string fProfileUseFile;
 bool fNoGlobalConstOpt = false;
 bool fNoFastFollowers = false;
 bool fNoInlineIterators = false;
@@ -205,6 +213,8 @@ bool fIgnoreNilabilityErrors = false;
 bool fOverloadSetsChecks = true;
 bool fNoStackChecks = false;
 bool fNoInferLocalFields = false;
+bool fNarrowLocalWideRefs = false;
+bool fReportWideNarrowing = false;
 bool fReplaceArrayAccessesWithRefTemps = false;
 bool fUserSetStackChecks = false;
 bool fNoCastChecks = false;
@@ -215,20 +225,29 @@ bool fEnableMemInterleaving = false;
 bool fAutoLocalAccess = true;
 bool fDynamicAutoLocalAccess = true;
 bool fOffsetAutoLocalAccess = true;
+bool fSplitOffsetAutoLocalAccess = false;
+bool fUncheckedAutoLocalAccess = false;
 bool fReportAutoLocalAccess= false;
 
 bool fAutoAggregation = false;
 bool fReportAutoAggregation= false;
 
+bool fInspectorExecutor = false;
+bool fReportInspectorExecutor = false;
+
+bool fBulkTransferLoops = false;
+
 bool fArrayViewElision = true;
 bool fReportArrayViewElision = false;
 
 bool  printPasses       = false;
 FILE* printPassesFile   = nullptr;
 bool  printPassesMemory = false;
+std::string printPassesJson;
 
 // flag for llvmWideOpt
 bool fLLVMWideOpt = false;
+bool fLLVMPackedWidePointers = false;
 
 // warnings for various implicit numeric conversions
 bool fWarnIntUint = false;
@@ -253,14 +272,20 @@ static bool fNoWarnDomainLiteral = true;
 static bool fNoWarnTupleIteration = true;
 
 bool fNoLoopInvariantCodeMotion = false;
+bool fHoistRemoteLoads = false;
 bool fNoInterproceduralAliasAnalysis = true;
 bool fNoChecks = false;
 bool fNoInline = false;
 bool fNoPrivatization = false;
 bool fNoOptimizeOnClauses = false;
+bool fLightweightTasks = false;
+bool fTaskArgsInPlace = false;
 bool fNoRemoveEmptyRecords = true;
 bool fRemoveUnreachableBlocks = true;
 int fParMake = 0;
+int fCodegenThreads = 1;
+int fFrontendThreads = 1;
+std::string fCodegenCacheDir;
 bool fIncrementalCompilation = false;
 bool fNoOptimizeForallUnordered = false;
 
@@ -311,9 +336,12 @@ bool fReportBlocking = false;
 bool fReportOptimizedLoopIterators = false;
 bool fReportInlinedIterators = false;
 bool fReportVectorizedLoops = false;
+bool fReportVectorization = false;
 bool fReportOptimizedOn = false;
+bool fReportTaskArgsInPlace = false;
 bool fReportOptimizeForallUnordered = false;
 bool fReportPromotion = false;
+bool fReportInstantiations = false;
 bool fReportScalarReplace = false;
 bool fReportGpu = false;
 bool fReportContextAdj = false;
@@ -404,8 +432,12 @@ size_t fDynoBreakOnHash = 0;
 bool   fDynoBreakOnHashSet = false;
 bool fDynoNoBreakError = false;
 static std::string fDynoTimingPath;
+static std::string fDynoQueryProfilePath;
+static std::string fDynoCacheDir;
 
 bool fResolveConcreteFns = false;
+bool fPrefilterCandidates = false;
+bool fPruneVirtualMethods = false;
 bool fIdBasedMunging = false;
 
 bool fNoIOGenSerialization = false;
@@ -423,6 +455,9 @@ int fGPUBlockSize = 0;
 char fGpuArch[gpuArchNameLen+1] = "";
 bool fGpuPtxasEnforceOpt;
 bool fGpuSpecialization = false;
+bool fGpuStageSharedMemory = false;
+bool fGpuFuseKernels = false;
+bool fReportGpuSharedStaging = false;
 const char* gGpuSdkPath = NULL;
 std::set<std::string> gpuArches;
 
@@ -753,6 +788,13 @@ static void setLLVMRemarksFilters(const ArgumentDescription* desc, const char* a
   llvmRemarksFilters = std::string(arg);
 }
 
+static void setReportVectorization(const ArgumentDescription* desc, const char* arg) {
+  if (llvmRemarksFilters.empty())
+    llvmRemarksFilters = "loop-vectorize";
+  else
+    llvmRemarksFilters = "(" + llvmRemarksFilters + ")|loop-vectorize";
+}
+
 static void setLLVMRemarksFunctions(const ArgumentDescription* desc, const char* arg) {
   std::vector<std::string> fNames;
   splitString(std::string(arg), fNames, ",");
@@ -1429,8 +1471,11 @@ static ArgumentDescription arg_desc[] = {
  {"inline", ' ', NULL, "Enable [disable] function inlining", "n", &fNoInline, NULL, NULL},
  {"inline-iterators", ' ', NULL, "Enable [disable] iterator inlining", "n", &fNoInlineIterators, "CHPL_DISABLE_INLINE_ITERATORS", NULL},
  {"inline-iterators-yield-limit", ' ', "<limit>", "Limit number of yields permitted in inlined iterators", "I", &inline_iter_yield_limit, "CHPL_INLINE_ITER_YIELD_LIMIT", NULL},
+ {"lightweight-tasks", ' ', NULL, "Enable [disable] running non-blocking begin tasks without their own stack", "N", &fLightweightTasks, "CHPL_LIGHTWEIGHT_TASKS", NULL},
+ {"task-args-in-place", ' ', NULL, "Enable [disable] letting cobegin tasks use their argument bundles on the parent's stack", "N", &fTaskArgsInPlace, "CHPL_TASK_ARGS_IN_PLACE", NULL},
  {"live-analysis", ' ', NULL, "Enable [disable] live variable analysis", "n", &fNoLiveAnalysis, "CHPL_DISABLE_LIVE_ANALYSIS", NULL},
  {"loop-invariant-code-motion", ' ', NULL, "Enable [disable] loop invariant code motion", "n", &fNoLoopInvariantCodeMotion, NULL, NULL},
+ {"hoist-remote-loads", ' ', NULL, "Enable [disable] hoisting loads through references out of loops in on statements", "N", &fHoistRemoteLoads, "CHPL_HOIST_REMOTE_LOADS", NULL},
  {"optimize-forall-unordered-ops", ' ', NULL, "Enable [disable] optimization of foralls to unordered operations", "n", &fNoOptimizeForallUnordered, "CHPL_DISABLE_OPTIMIZE_FORALL_UNORDERED_OPS", NULL},
  {"optimize-range-iteration", ' ', NULL, "Enable [disable] optimization of iteration over anonymous ranges", "n", &fNoOptimizeRangeIteration, "CHPL_DISABLE_OPTIMIZE_RANGE_ITERATION", NULL},
  {"optimize-loop-iterators", ' ', NULL, "Enable [disable] optimization of iterators composed of a single loop", "n", &fNoOptimizeLoopIterators, "CHPL_DISABLE_OPTIMIZE_LOOP_ITERATORS", NULL},
@@ -1439,22 +1484,31 @@ static ArgumentDescription arg_desc[] = {
  {"privatization", ' ', NULL, "Enable [disable] privatization of distributed arrays and domains", "n", &fNoPrivatization, "CHPL_DISABLE_PRIVATIZATION", NULL},
  {"remote-value-forwarding", ' ', NULL, "Enable [disable] remote value forwarding", "n", &fNoRemoteValueForwarding, "CHPL_DISABLE_REMOTE_VALUE_FORWARDING", NULL},
  {"remote-serialization", ' ', NULL, "Enable [disable] serialization for remote consts", "n", &fNoRemoteSerialization, "CHPL_DISABLE_REMOTE_SERIALIZATION", NULL},
+ {"remote-value-forward-records", ' ', NULL, "Enable [disable] remote value forwarding of records an on statement doesn't modify", "N", &fRemoteValueForwardRecords, "CHPL_REMOTE_VALUE_FORWARD_RECORDS", NULL},
+ {"elide-yield-copies", ' ', NULL, "Enable [disable] moving variables into yields at their last mention instead of copying them", "N", &fElideYieldCopies, "CHPL_ELIDE_YIELD_COPIES", NULL},
  {"remove-copy-calls", ' ', NULL, "Enable [disable] remove copy calls", "n", &fNoRemoveCopyCalls, "CHPL_DISABLE_REMOVE_COPY_CALLS", NULL},
  {"scalar-replacement", ' ', NULL, "Enable [disable] scalar replacement", "n", &fNoScalarReplacement, "CHPL_DISABLE_SCALAR_REPLACEMENT", NULL},
  {"scalar-replace-limit", ' ', "<limit>", "Limit on the size of tuples being replaced during scalar replacement", "I", &scalar_replace_limit, "CHPL_SCALAR_REPLACE_TUPLE_LIMIT", NULL},
+ {"flatten-aggregate-args", ' ', NULL, "Enable [disable] passing small tuples and records as one argument per field", "N", &fFlattenAggregateArgs, "CHPL_FLATTEN_AGGREGATE_ARGS", NULL},
+ {"specialize-rectangular-access", ' ', NULL, "Enable [disable] folding known strides into default rectangular array accesses", "N", &fSpecializeRectangularAccess, "CHPL_SPECIALIZE_RECTANGULAR_ACCESS", NULL},
  {"tuple-copy-opt", ' ', NULL, "Enable [disable] tuple (memcpy) optimization", "n", &fNoTupleCopyOpt, "CHPL_DISABLE_TUPLE_COPY_OPT", NULL},
  {"tuple-copy-limit", ' ', "<limit>", "Limit on the size of tuples considered for optimization", "I", &tuple_copy_limit, "CHPL_TUPLE_COPY_LIMIT", NULL},
  {"infer-local-fields", ' ', NULL, "Enable [disable] analysis to infer local fields in classes and records", "n", &fNoInferLocalFields, "CHPL_DISABLE_INFER_LOCAL_FIELDS", NULL},
+ {"narrow-local-wide-refs", ' ', NULL, "Enable [disable] narrowing wide references that are known to be local", "N", &fNarrowLocalWideRefs, "CHPL_NARROW_LOCAL_WIDE_REFS", NULL},
  {"vectorize", ' ', NULL, "Enable [disable] generation of vectorization hints", "n", &fNoVectorize, "CHPL_DISABLE_VECTORIZATION", setVectorize},
  {"vector-library", ' ', "<lib>", "Select a vectorization library to use", "S", NULL, "CHPL_VECTORIZATION_LIBRARY", setVectorLib},
 
  {"auto-local-access", ' ', NULL, "Enable [disable] using local access automatically", "N", &fAutoLocalAccess, "CHPL_DISABLE_AUTO_LOCAL_ACCESS", NULL},
  {"dynamic-auto-local-access", ' ', NULL, "Enable [disable] using local access automatically (dynamic only)", "N", &fDynamicAutoLocalAccess, "CHPL_DISABLE_DYNAMIC_AUTO_LOCAL_ACCESS", NULL},
  {"offset-auto-local-access", ' ', NULL, "Enable [disable] using local access automatically with offset indices", "N", &fOffsetAutoLocalAccess, "CHPL_DISABLE_OFFSET_AUTO_LOCAL_ACCESS", NULL},
+ {"split-offset-auto-local-access", ' ', NULL, "Enable [disable] splitting foralls with offset accesses into interior and boundary loops", "N", &fSplitOffsetAutoLocalAccess, "CHPL_SPLIT_OFFSET_AUTO_LOCAL_ACCESS", NULL},
+ {"unchecked-auto-local-access", ' ', NULL, "Enable [disable] removing bounds checks from automatic local accesses to indices of the loop domain", "N", &fUncheckedAutoLocalAccess, "CHPL_UNCHECKED_AUTO_LOCAL_ACCESS", NULL},
 
  {"auto-aggregation", ' ', NULL, "Enable [disable] automatically aggregating remote accesses in foralls", "N", &fAutoAggregation, "CHPL_AUTO_AGGREGATION", NULL},
+ {"inspector-executor", ' ', NULL, "Enable [disable] reusing communication schedules for repeated irregular gathers in foralls", "N", &fInspectorExecutor, "CHPL_INSPECTOR_EXECUTOR", NULL},
 
  {"array-view-elision", ' ', NULL, "Enable [disable] array view elision", "N", &fArrayViewElision, "CHPL_DISABLE_ARRAY_VIEW_ELISION", NULL},
+ {"bulk-transfer-loops", ' ', NULL, "Enable [disable] turning element-wise array copy loops into slice assignments", "N", &fBulkTransferLoops, "CHPL_BULK_TRANSFER_LOOPS", NULL},
 
  {"", ' ', NULL, "Run-time Semantic Check Options", NULL, NULL, NULL, NULL},
  {"checks", ' ', NULL, "Enable [disable] all following run-time checks", "n", &fNoChecks, "CHPL_CHECKS", setChecks},
@@ -1480,11 +1534,16 @@ static ArgumentDescription arg_desc[] = {
  {"lib-linkage", 'l', "<library>", "C library linkage", "P", &libraryFilename, "CHPL_LIB_NAME", handleLibrary},
  {"lib-search-path", 'L', "<directory>", "C library search path", "P", &libraryFilename, "CHPL_LIB_PATH", handleLibPath},
  {"optimize", 'O', NULL, "[Don't] Optimize generated code", "N", &optimizeCCode, "CHPL_OPTIMIZE", NULL},
+ {"profile-generate", ' ', NULL, "Instrument the generated code to write an execution profile", "F", &fProfileGenerate, "CHPL_PROFILE_GENERATE", NULL},
+ {"profile-use", ' ', "<file>", "Optimize the generated code using an execution profile", "P", &fProfileUseFile, "CHPL_PROFILE_USE", NULL},
  {"specialize", ' ', NULL, "[Don't] Specialize generated code for CHPL_TARGET_CPU", "N", &specializeCCode, "CHPL_SPECIALIZE", NULL},
  {"output", 'o', "<filename>", "Name output executable", "P", &executableFilename, "CHPL_EXE_NAME", NULL},
  {"static", ' ', NULL, "Generate a statically linked binary", "F", &fLinkStyle, NULL, NULL},
 
  {"", ' ', NULL, "LLVM Code Generation Options", NULL, NULL, NULL, NULL},
+ {"codegen-cache-dir", ' ', "<directory>", "Reuse object code for unchanged parts of the LLVM module from <directory>", "P", &fCodegenCacheDir, "CHPL_CODEGEN_CACHE_DIR", NULL},
+ {"codegen-threads", ' ', "<n>", "Split the LLVM module into <n> parts and generate code for them in parallel", "I", &fCodegenThreads, "CHPL_CODEGEN_THREADS", NULL},
+ {"llvm-packed-wide-pointers", ' ', NULL, "Enable [disable] packing wide pointers into 64 bits for --llvm-wide-opt", "N", &fLLVMPackedWidePointers, "CHPL_LLVM_PACKED_WIDE_POINTERS", NULL},
  {"llvm-wide-opt", ' ', NULL, "Enable [disable] LLVM wide pointer optimizations", "N", &fLLVMWideOpt, "CHPL_LLVM_WIDE_OPTS", NULL},
  {"mllvm", ' ', "<flags>", "LLVM flags (can be specified multiple times)", "S", NULL, "CHPL_MLLVM", setLLVMFlags},
 
@@ -1497,6 +1556,7 @@ static ArgumentDescription arg_desc[] = {
  {"print-passes", ' ', NULL, "[Don't] print compiler passes", "N", &printPasses, "CHPL_PRINT_PASSES", NULL},
  {"print-passes-file", ' ', "<filename>", "Print compiler passes to <filename>", "S", NULL, "CHPL_PRINT_PASSES_FILE", setPrintPassesFile},
  {"print-passes-memory", ' ', NULL, "[Don't] print memory usage after each compiler pass", "N", &printPassesMemory, "CHPL_PRINT_PASSES_MEMORY", NULL},
+ {"print-passes-json", ' ', "<filename>", "Write time, memory and AST counts for each compiler pass to <filename> as JSON", "P", &printPassesJson, "CHPL_PRINT_PASSES_JSON", NULL},
 
  {"", ' ', NULL, "Miscellaneous Options", NULL, NULL, NULL, NULL},
  {"detailed-errors", ' ', NULL, "Enable [disable] detailed error messages", "N", &fDetailedErrors, "CHPL_DETAILED_ERRORS", NULL},
@@ -1588,14 +1648,20 @@ static ArgumentDescription arg_desc[] = {
  {"report-optimized-loop-iterators", ' ', NULL, "Print stats on optimized single loop iterators", "F", &fReportOptimizedLoopIterators, NULL, NULL},
  {"report-inlined-iterators", ' ', NULL, "Print stats on inlined iterators", "F", &fReportInlinedIterators, NULL, NULL},
  {"report-vectorized-loops", ' ', NULL, "Show which loops have vectorization hints", "F", &fReportVectorizedLoops, NULL, NULL},
+ {"report-vectorization", ' ', NULL, "Show LLVM's remarks on which loops were vectorized", "F", &fReportVectorization, NULL, setReportVectorization},
+ {"report-task-args-in-place", ' ', NULL, "Print information about which task argument bundles can be used without copying them", "F", &fReportTaskArgsInPlace, NULL, NULL},
  {"report-optimized-on", ' ', NULL, "Print information about on clauses that have been optimized for potential fast remote fork operation", "F", &fReportOptimizedOn, NULL, NULL},
  {"report-auto-local-access", ' ', NULL, "Enable compiler logs for auto local access optimization", "N", &fReportAutoLocalAccess, "CHPL_REPORT_AUTO_LOCAL_ACCESS", NULL},
  {"report-auto-aggregation", ' ', NULL, "Enable compiler logs for automatic aggregation", "N", &fReportAutoAggregation, "CHPL_REPORT_AUTO_AGGREGATION", NULL},
+ {"report-inspector-executor", ' ', NULL, "Enable compiler logs for the inspector-executor optimization", "N", &fReportInspectorExecutor, "CHPL_REPORT_INSPECTOR_EXECUTOR", NULL},
  {"report-array-view-elision", ' ', NULL, "Enable compiler logs for array view elision", "N", &fReportArrayViewElision, "CHPL_REPORT_ARRAY_VIEW_ELISION", NULL},
  {"report-optimized-forall-unordered-ops", ' ', NULL, "Show which statements in foralls have been converted to unordered operations", "F", &fReportOptimizeForallUnordered, NULL, NULL},
  {"report-promotion", ' ', NULL, "Print information about scalar promotion", "F", &fReportPromotion, NULL, NULL},
+ {"report-instantiations", ' ', NULL, "Print how many generic instantiations were made, by module kind and function", "F", &fReportInstantiations, NULL, NULL},
  {"report-scalar-replace", ' ', NULL, "Print scalar replacement stats", "F", &fReportScalarReplace, NULL, NULL},
+ {"report-wide-narrowing", ' ', NULL, "Print how many wide references were narrowed in each module", "F", &fReportWideNarrowing, NULL, NULL},
  {"report-gpu", ' ', NULL, "Print information about what loops are and are not GPU eligible", "F", &fReportGpu, NULL, NULL},
+ {"report-gpu-shared-staging", ' ', NULL, "Print which GPU kernel reads are staged in shared memory, and why others aren't", "F", &fReportGpuSharedStaging, NULL, NULL},
  {"report-context-adjustments", ' ', NULL, "Print debugging information while handling iterator contexts", "F", &fReportContextAdj, NULL, NULL},
 
  {"", ' ', NULL, "Developer Flags -- Miscellaneous", NULL, NULL, NULL, NULL},
@@ -1635,6 +1701,8 @@ static ArgumentDescription arg_desc[] = {
  {"gpu-arch", ' ', "<cuda-architecture>", "CUDA architecture to use", "S16", &fGpuArch, "_CHPL_GPU_ARCH", setChplEnv},
  {"gpu-ptxas-enforce-optimization", ' ', NULL, "Modify generated .ptxas file to enable optimizations", "F", &fGpuPtxasEnforceOpt, NULL, NULL},
  {"gpu-specialization", ' ', NULL, "Enable [disable] an optimization that clones functions into copies assumed to run on a GPU locale.", "N", &fGpuSpecialization, "CHPL_GPU_SPECIALIZATION", NULL},
+ {"gpu-fuse-kernels", ' ', NULL, "Enable [disable] fusing adjacent gpuizable loops over the same indices", "N", &fGpuFuseKernels, "CHPL_GPU_FUSE_KERNELS", NULL},
+ {"gpu-stage-shared-memory", ' ', NULL, "Enable [disable] staging neighboring reads of read-only arrays in GPU shared memory", "N", &fGpuStageSharedMemory, "CHPL_GPU_STAGE_SHARED_MEMORY", NULL},
  {"builtin-runtime", ' ', NULL, "[Don't] add a copy of the Chapel runtime to your compiled program", "N", &fBuiltinRuntime, NULL, NULL},
  {"library", ' ', NULL, "Generate a Chapel library file", "F", &fLibraryCompile, NULL, NULL},
  {"library-dir", ' ', "<directory>", "Save generated library helper files in directory", "P", &libDir, "CHPL_LIB_SAVE_DIR", verifySaveLibDir},
@@ -1684,16 +1752,21 @@ static ArgumentDescription arg_desc[] = {
  {"dyno-scope-resolve", ' ', NULL, "Enable [disable] using dyno for scope resolution", "N", &fDynoScopeResolve, "CHPL_DYNO_SCOPE_RESOLVE", NULL},
  {"dyno-scope-production", ' ', NULL, "Enable [disable] using both dyno and production scope resolution", "N", &fDynoScopeProduction, "CHPL_DYNO_SCOPE_PRODUCTION", NULL},
  {"dyno-scope-bundled", ' ', NULL, "Enable [disable] using dyno to scope resolve bundled modules", "N", &fDynoScopeBundled, "CHPL_DYNO_SCOPE_BUNDLED", NULL},
+ {"frontend-threads", ' ', "<n>", "Use <n> threads to parse the source files and module search path, and for the read-only checks of normalize", "I", &fFrontendThreads, "CHPL_FRONTEND_THREADS", NULL},
  {"dyno-debug-trace", ' ', NULL, "Enable [disable] debug-trace output when using dyno compiler library", "N", &fDynoDebugTrace, "CHPL_DYNO_DEBUG_TRACE", NULL},
  {"dyno-timing", ' ', NULL, "Enable [disable] timing output when using dyno compiler library", "P", &fDynoTimingPath, "CHPL_DYNO_TIMING", NULL},
+ {"dyno-query-profile", ' ', "<path>", "Write a profile of dyno queries to <path> as folded stacks", "P", &fDynoQueryProfilePath, "CHPL_DYNO_QUERY_PROFILE", NULL},
  {"dyno-debug-print-parsed-files", ' ', NULL, "Enable [disable] printing all files that were parsed by Dyno", "N", &fDynoDebugPrintParsedFiles, "CHPL_DYNO_DEBUG_PRINT_PARSED_FILES", NULL},
  {"dyno-break-on-hash", ' ' , NULL, "Break when query with given hash value is executed when using dyno compiler library", "X", &fDynoBreakOnHash, "CHPL_DYNO_BREAK_ON_HASH", setDynoBreakOnHash},
  {"dyno-gen-lib", ' ', "<path>", "Specify files named on the command line should be saved into a .dyno library", "P", NULL, NULL, addDynoGenLib},
+ {"dyno-cache-dir", ' ', "<directory>", "Save parsed files in <directory> to reuse them in later compilations", "P", &fDynoCacheDir, "CHPL_DYNO_CACHE_DIR", NULL},
  {"dyno-gen-std", ' ', NULL, "Generate a .dyno library file for the standard library", "F", &fDynoGenStdLib, NULL, setDynoGenStdLib},
  {"dyno-verify-serialization", ' ', NULL, "Enable [disable] verification of serialization", "N", &fDynoVerifySerialization, NULL, NULL},
  {"dyno-warn-unimplemented", ' ', NULL, "Enable [disable] warnings for unimplemented features in dyno resolver", "N", &fDynoWarnUnimplemented, NULL, setDynoWarnUnimplemented},
  {"dyno-break-error", ' ', NULL, "Enable breakpoint for user errors from the frontend", "n", &fDynoNoBreakError, NULL, NULL},
  {"resolve-concrete-fns", ' ', NULL, "Enable [disable] resolving concrete functions",  "N", &fResolveConcreteFns, NULL, NULL},
+ {"prefilter-candidates", ' ', NULL, "Enable [disable] skipping resolution candidates whose arity can't match the call", "N", &fPrefilterCandidates, "CHPL_PREFILTER_CANDIDATES", NULL},
+ {"prune-virtual-methods", ' ', NULL, "Enable [disable] pruning the virtual methods of classes that are never used", "N", &fPruneVirtualMethods, "CHPL_PRUNE_VIRTUAL_METHODS", NULL},
 
  {"io-gen-serialization", ' ', NULL, "Enable [disable] generation of IO serialization methods", "n", &fNoIOGenSerialization, "CHPL_IO_GEN_SERIALIZATION", NULL},
  {"io-serialize-writeThis", ' ', NULL, "Enable [disable] use of 'writeThis' as default for 'serialize' methods", "n", &fNoIOSerializeWriteThis, "CHPL_IO_SERIALIZE_WRITETHIS", NULL},
@@ -2065,7 +2138,10 @@ static void checkMultiLocaleLibraryConstraints() {
 static void postLocal() {
   if (!fUserSetLocal) fLocal = !strcmp(CHPL_COMM, "none");
 
-  if (fLocal) fAutoAggregation = false;
+  if (fLocal) {
+    fAutoAggregation = false;
+    fInspectorExecutor = false;
+  }
 }
 
 static void postVectorize() {
@@ -2089,6 +2165,24 @@ static void postVectorize() {
   }
 }
 
+// The LLVM back end adds the profile passes to its own pipeline; the C
+// back end just passes the request on to the C compiler.
+static void postProfile() {
+  if (fLlvmCodegen)
+    return;
+
+  std::string flags;
+  if (fProfileGenerate)
+    flags = "-fprofile-generate";
+  else if (!fProfileUseFile.empty())
+    flags = "-fprofile-use=" + fProfileUseFile;
+  else
+    return;
+
+  setCCFlags(NULL, flags.c_str());
+  setLDFlags(NULL, flags.c_str());
+}
+
 static void checkClientServerLibrary() {
   if (isMultiLocaleLibrary()) {
     // If we're compiling a "regular old" multi-locale library, gently warn...
@@ -2374,6 +2468,29 @@ static void checkIncrementalAndOptimized() {
              "due to the use of separate compilation in the back-end.");
 }
 
+static void checkProfileFlags() {
+  if (fProfileGenerate && !fProfileUseFile.empty()) {
+    USR_FATAL("--profile-generate and --profile-use cannot be used together");
+  }
+  if (!fProfileUseFile.empty() && !pathExists(fProfileUseFile)) {
+    USR_FATAL("profile file '%s' does not exist", fProfileUseFile.c_str());
+  }
+}
+
+// A packed wide pointer has room for the node id but not for a sublocale,
+// so only the flat locale model can use it.
+static void checkPackedWidePointers() {
+  if (!fLLVMPackedWidePointers) return;
+
+  if (!fLLVMWideOpt) {
+    USR_FATAL("--llvm-packed-wide-pointers requires --llvm-wide-opt");
+  }
+  if (strcmp(CHPL_LOCALE_MODEL, "flat") != 0) {
+    USR_FATAL("--llvm-packed-wide-pointers is only supported with "
+              "CHPL_LOCALE_MODEL=flat");
+  }
+}
+
 static void checkGenLibNotLLVM() {
   if (!gDynoGenLibOutput.empty() && !fLlvmCodegen) {
     USR_FATAL("--dyno-gen-lib only works with the LLVM backend");
@@ -2501,6 +2618,8 @@ static void postprocess_args() {
 
   postVectorize();
 
+  postProfile();
+
   postTaskTracking();
 
   checkClientServerLibrary();
@@ -2549,6 +2668,9 @@ static void validateSettings() {
 
   checkGenLibNotLLVM();
 
+  checkProfileFlags();
+  checkPackedWidePointers();
+
   checkUnsupportedConfigs();
 
   checkRuntimeBuilt();
@@ -2637,6 +2759,8 @@ static void dynoConfigureContext(std::string chpl_module_path) {
     config.disableErrorBreakpoints = true;
   }
 
+  config.queryCacheDir = fDynoCacheDir;
+
   // Replace the current gContext with one using the new configuration.
   auto oldContext = gContext;
   gContext = new chpl::Context(*oldContext, std::move(config));
@@ -2794,6 +2918,10 @@ int main(int argc, char* argv[]) {
       (fDriverCompilationPhase || fDriverDoMonolithic)) {
     gContext->beginQueryTimingTrace(fDynoTimingPath);
   }
+  if (!fDynoQueryProfilePath.empty() &&
+      (fDriverCompilationPhase || fDriverDoMonolithic)) {
+    gContext->setQueryProfileFlag(true);
+  }
 
   if (!fDriverDoMonolithic && !driverInSubInvocation) {
     // Trigger initial driver mode invocation.
@@ -2836,6 +2964,18 @@ int main(int argc, char* argv[]) {
       (fDriverCompilationPhase || fDriverDoMonolithic)) {
     gContext->endQueryTimingTrace();
   }
+  if (!fDynoQueryProfilePath.empty() &&
+      (fDriverCompilationPhase || fDriverDoMonolithic)) {
+    gContext->setQueryProfileFlag(false);
+    std::ofstream profile(fDynoQueryProfilePath);
+    if (!profile) {
+      USR_WARN("could not open %s to write the query profile",
+               fDynoQueryProfilePath.c_str());
+    } else {
+      gContext->queryProfileFoldedStacks(profile);
+    }
+    gContext->queryProfileReport(std::cout);
+  }
 
   tracker.StartPhase("driverCleanup");
 
@@ -2913,6 +3053,13 @@ int main(int argc, char* argv[]) {
     }
   }
 
+  // In driver mode only the compilation phase writes the JSON, since each
+  // invocation would otherwise replace it.
+  if (!printPassesJson.empty() &&
+      (fDriverDoMonolithic || fDriverCompilationPhase)) {
+    tracker.ReportJson(printPassesJson.c_str());
+  }
+
   if (printPassesFile != nullptr) {
     fclose(printPassesFile);
   }
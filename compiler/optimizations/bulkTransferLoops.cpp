@@ -0,0 +1,328 @@
+/*
+ * Copyright 2020-2026 Hewlett Packard Enterprise Development LP
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "optimizations.h"
+
+#include "astutil.h"
+#include "driver.h"
+#include "expr.h"
+#include "ForLoop.h"
+#include "stmt.h"
+#include "wellknown.h"
+
+#include "global-ast-vecs.h"
+
+#include <vector>
+
+// Bulk-transfer loop recognition turns element-wise copy loops into slice
+// assignments, so that they get the strided bulk transfers (or the local
+// memcpy) that slice assignment already uses instead of a GET or a PUT per
+// element. It runs before normalization, on loops like
+//
+//   for j in lo..hi do A[i, j] = B[k, j];
+//
+// where the body is a single assignment between two array accesses, the loop
+// index appears as exactly one index of each, and the other indices are
+// variables or literals. The loop becomes
+//
+//   if chpl__bulkTransferLoopStatic(A, B, lo..hi) {
+//     if chpl__bulkTransferLoopDynamic(A, B, lo..hi) then
+//       A[i, lo..hi] = B[k, lo..hi];
+//     else
+//       for j in lo..hi do A[i, j] = B[k, j];
+//   } else {
+//     for j in lo..hi do A[i, j] = B[k, j];
+//   }
+//
+// The static check is a param function in the module code. It is true only
+// when both sides are arrays that support slicing by the iterand, so for
+// anything else the conditional is folded away before the slice is resolved.
+// The dynamic check makes sure the arrays don't overlap, since a serial loop
+// may observe its own writes where a bulk transfer wouldn't.
+//
+// Since both the checks and the loop evaluate the iterand and the indices,
+// only variables and literals are accepted there.
+//
+// This optimization is off by default. It can be enabled with
+// `--bulk-transfer-loops`.
+
+static bool isSimpleActual(Expr* e) {
+  if (SymExpr* se = toSymExpr(e)) {
+    return !isFnSymbol(se->symbol());
+  }
+  return isUnresolvedSymExpr(e);
+}
+
+// Recover the range a loop iterates over from its `_getIterator` call,
+// undoing tryToReplaceWithDirectRangeIterator. Returns NULL if it isn't
+// made only of variables and literals.
+static Expr* getIterandRange(Expr* iterand) {
+  if (isSimpleActual(iterand)) {
+    return iterand->copy();
+  }
+
+  CallExpr* call = toCallExpr(iterand);
+  if (call == NULL) {
+    return NULL;
+  }
+  for_actuals(actual, call) {
+    if (!isSimpleActual(actual)) {
+      return NULL;
+    }
+  }
+
+  if (call->isNamed("chpl_direct_range_iter") && call->numActuals() == 2) {
+    return new CallExpr("chpl_build_bounded_range",
+                        call->get(1)->copy(), call->get(2)->copy());
+  } else if (call->isNamed("chpl_direct_strided_range_iter") &&
+             call->numActuals() == 3) {
+    return new CallExpr("chpl_by",
+                        new CallExpr("chpl_build_bounded_range",
+                                     call->get(1)->copy(),
+                                     call->get(2)->copy()),
+                        call->get(3)->copy());
+  } else if (call->isNamed("chpl_direct_counted_range_iter") &&
+             call->numActuals() == 2) {
+    return new CallExpr("#",
+                        new CallExpr("chpl_build_low_bounded_range",
+                                     call->get(1)->copy()),
+                        call->get(2)->copy());
+  }
+
+  return NULL;
+}
+
+// Is `call` an access to an array variable whose indices are variables or
+// literals, with `idx` as exactly one of them?
+static bool isAccessWithIndex(CallExpr* call, Symbol* idx) {
+  if (call == NULL || call->numActuals() == 0 ||
+      !isSimpleActual(call->baseExpr) || !isSymExpr(call->baseExpr)) {
+    return false;
+  }
+
+  int numIdx = 0;
+  for_actuals(actual, call) {
+    if (isNamedExpr(actual) || !isSimpleActual(actual)) {
+      return false;
+    }
+    if (SymExpr* se = toSymExpr(actual)) {
+      if (se->symbol() == idx) {
+        numIdx++;
+      }
+    }
+  }
+
+  return numIdx == 1;
+}
+
+// Build `call` with `range` in place of the loop index
+static CallExpr* buildSlice(CallExpr* call, Symbol* idx, Expr* range) {
+  CallExpr* slice = call->copy();
+  for_actuals(actual, slice) {
+    SymExpr* se = toSymExpr(actual);
+    if (se != NULL && se->symbol() == idx) {
+      se->replace(range->copy());
+      break;
+    }
+  }
+  return slice;
+}
+
+// Find the single statement of the loop body written by the user
+static CallExpr* getOnlyUserStmt(ForLoop* loop, Symbol* idx) {
+  CallExpr* ret = NULL;
+
+  for_alist(stmt, loop->body) {
+    if (DefExpr* def = toDefExpr(stmt)) {
+      if (def->sym == idx || isLabelSymbol(def->sym)) {
+        continue;
+      }
+      return NULL;
+    }
+
+    if (CallExpr* call = toCallExpr(stmt)) {
+      if (call->isPrimitive(PRIM_END_OF_STATEMENT)) {
+        continue;
+      }
+      if (call->isPrimitive(PRIM_MOVE) && toSymExpr(call->get(1)) &&
+          toSymExpr(call->get(1))->symbol() == idx) {
+        continue;
+      }
+    }
+
+    // `for ... { A[i, j] = B[k, j]; }`
+    if (BlockStmt* inner = toBlockStmt(stmt)) {
+      if (inner->isRealBlockStmt() && ret == NULL) {
+        CallExpr* only = NULL;
+        for_alist(innerStmt, inner->body) {
+          CallExpr* innerCall = toCallExpr(innerStmt);
+          if (innerCall == NULL) {
+            return NULL;
+          }
+          if (innerCall->isPrimitive(PRIM_END_OF_STATEMENT)) {
+            continue;
+          }
+          if (only != NULL) {
+            return NULL;
+          }
+          only = innerCall;
+        }
+        if (only == NULL) {
+          return NULL;
+        }
+        ret = only;
+        continue;
+      }
+      return NULL;
+    }
+
+    if (ret != NULL || !isCallExpr(stmt)) {
+      return NULL;
+    }
+    ret = toCallExpr(stmt);
+  }
+
+  return ret;
+}
+
+static void tryBulkTransferLoop(ForLoop* loop) {
+  if (loop->isCoforallLoop() || loop->isLoweredForallLoop() ||
+      loop->isForExpr() || loop->zipperedGet() ||
+      loop->isOrderIndependent()) {
+    return;
+  }
+
+  BlockStmt* outer = toBlockStmt(loop->parentExpr);
+  if (outer == NULL || !outer->isRealBlockStmt()) {
+    return;
+  }
+
+  // find `move _iterator, _getIterator(iterand)`
+  Symbol* iterSym = loop->iteratorGet()->symbol();
+  Expr* iterand = NULL;
+  for_alist(stmt, outer->body) {
+    if (CallExpr* move = toCallExpr(stmt)) {
+      if (move->isPrimitive(PRIM_MOVE) && toSymExpr(move->get(1)) &&
+          toSymExpr(move->get(1))->symbol() == iterSym) {
+        CallExpr* getIter = toCallExpr(move->get(2));
+        if (getIter != NULL && getIter->isNamed("_getIterator") &&
+            getIter->numActuals() == 1) {
+          iterand = getIter->get(1);
+        }
+        break;
+      }
+    }
+  }
+  if (iterand == NULL) {
+    return;
+  }
+
+  // the index is `move j, _indexOfInterest` at the head of the body
+  Symbol* idx = NULL;
+  for_alist(stmt, loop->body) {
+    if (CallExpr* move = toCallExpr(stmt)) {
+      if (move->isPrimitive(PRIM_MOVE)) {
+        SymExpr* rhs = toSymExpr(move->get(2));
+        if (rhs != NULL && rhs->symbol() == loop->indexGet()->symbol()) {
+          idx = toSymExpr(move->get(1))->symbol();
+        }
+        break;
+      }
+    }
+  }
+  if (idx == NULL) {
+    return;
+  }
+
+  CallExpr* assign = getOnlyUserStmt(loop, idx);
+  if (assign == NULL || !assign->isNamedAstr(astrSassign)) {
+    return;
+  }
+
+  CallExpr* lhs = toCallExpr(assign->get(1));
+  CallExpr* rhs = toCallExpr(assign->get(2));
+  if (!isAccessWithIndex(lhs, idx) || !isAccessWithIndex(rhs, idx)) {
+    return;
+  }
+
+  Symbol* lhsBase = toSymExpr(lhs->baseExpr)->symbol();
+  Symbol* rhsBase = toSymExpr(rhs->baseExpr)->symbol();
+
+  // we avoid touching const lhs so that const checking errors point at the
+  // user's loop; the same array on both sides may overlap with itself
+  if (lhsBase == rhsBase || lhsBase->isConstant()) {
+    return;
+  }
+
+  // the index may only be used in the two accesses
+  std::vector<SymExpr*> idxUses;
+  collectSymExprsFor(loop, idx, idxUses);
+  if (idxUses.size() != 3) {
+    return;
+  }
+
+  Expr* range = getIterandRange(iterand);
+  if (range == NULL) {
+    return;
+  }
+
+  SET_LINENO(loop);
+
+  CallExpr* staticCheck = new CallExpr("chpl__bulkTransferLoopStatic",
+                                       new SymExpr(lhsBase),
+                                       new SymExpr(rhsBase),
+                                       range);
+  CallExpr* dynamicCheck = new CallExpr("chpl__bulkTransferLoopDynamic",
+                                        new SymExpr(lhsBase),
+                                        new SymExpr(rhsBase),
+                                        range->copy());
+
+  CallExpr* sliceAssign = new CallExpr("=",
+                                       buildSlice(lhs, idx, range),
+                                       buildSlice(rhs, idx, range));
+
+  BlockStmt* bulkBlock = new BlockStmt(sliceAssign);
+  BlockStmt* dynamicElse = new BlockStmt(outer->copy());
+  CondStmt* dynamicCond = new CondStmt(dynamicCheck, bulkBlock, dynamicElse);
+
+  BlockStmt* staticElse = new BlockStmt();
+  CondStmt* staticCond = new CondStmt(staticCheck,
+                                      new BlockStmt(dynamicCond),
+                                      staticElse);
+
+  outer->insertBefore(staticCond);
+  staticElse->insertAtTail(outer->remove());
+}
+
+void bulkTransferLoops() {
+  if (!fBulkTransferLoops) return;
+
+  std::vector<ForLoop*> loops;
+  forv_Vec(BlockStmt, block, gBlockStmts) {
+    if (ForLoop* loop = toForLoop(block)) {
+      if (loop->inTree() && loop->getModule()->modTag == MOD_USER) {
+        loops.push_back(loop);
+      }
+    }
+  }
+
+  for_vector(ForLoop, loop, loops) {
+    tryBulkTransferLoop(loop);
+  }
+}
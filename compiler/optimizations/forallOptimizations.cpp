@@ -47,7 +47,14 @@
 //                           accesses that can be proven to be local
 //
 // - automatic aggregation: Use aggregation instead of regular assignments for
-//                          applicable last statements within `forall` bodies
+//                          applicable last statements within `forall` bodies.
+//                          Commutative updates (`A[idx[i]] += x`,
+//                          `A[j] = min(A[j], x)`, `A[j].add(x)`) are buffered
+//                          by destination the same way
+//
+// - inspector-executor: For `y[i] = x[col[i]]` run repeatedly with the same
+//                       `col`, build the communication schedule for the
+//                       gather once and reuse it
 
 static int curLogDepth = 0;
 static bool LOG_ALA(int depth, const char *msg, BaseAST *node);
@@ -56,6 +63,9 @@ static void LOGLN_ALA(BaseAST *node);
 static bool LOG_AA(int depth, const char *msg, BaseAST *node);
 static void LOGLN_AA(BaseAST *node);
 
+static bool LOG_IE(int depth, const char *msg, BaseAST *node);
+static void LOGLN_IE(BaseAST *node);
+
 // we store all the locations where we have added these primitives. When we
 // report finalizing an optimization (either positively or negatively) we remove
 // those locations from the set. Towards the end of resolution, if there are
@@ -101,6 +111,7 @@ static void constructCondStmtFromLoops(Expr *condExpr,
                                        ForallStmt *unoptimized);
 
 static void generateOptimizedLoops(ForallStmt *forall);
+static void splitLoopForOffsets(ForallStmt *forall);
 static void autoLocalAccess(ForallStmt *forall);
 static CallExpr *revertAccess(CallExpr *call);
 static CallExpr *confirmAccess(CallExpr *call);
@@ -110,9 +121,17 @@ static void symbolicFastFollowerAnalysis(ForallStmt *forall);
 static bool canBeLocalAccess(CallExpr *call);
 static bool isLocalAccess(CallExpr *call);
 static const char *getForallCloneTypeStr(Symbol *aggMarker);
-static CallExpr *getAggGenCallForChild(Expr *child, bool srcAggregation);
+static CallExpr *getAggGenCallForChild(Expr *child, bool srcAggregation,
+                                       const char *updateOp);
 static bool assignmentSuitableForAggregation(CallExpr *call, ForallStmt *forall);
+static const char *getUpdateOpForAggregation(CallExpr *call,
+                                             ForallStmt *forall,
+                                             CallExpr **lhs, Expr **value);
 static void insertAggCandidate(CallExpr *call, ForallStmt *forall);
+static void insertAggUpdateCandidate(CallExpr *call, const char *updateOp,
+                                     CallExpr *lhs, Expr *value,
+                                     ForallStmt *forall);
+static const char *getMaybeAggAssignUpdateOp(CallExpr *call);
 static bool handleYieldedArrayElementsInAssignment(CallExpr *call,
                                                    ForallStmt *forall);
 static void findAndUpdateMaybeAggAssign(CallExpr *call, bool confirmed);
@@ -122,9 +141,12 @@ static void removeAggregatorFromFunction(Symbol *aggregator, FnSymbol *parent);
 static void removeAggregationFromRecursiveForallHelp(BlockStmt *block);
 static void autoAggregation(ForallStmt *forall);
 
+static void inspectorExecutor(ForallStmt *forall);
+
 void doPreNormalizeArrayOptimizations() {
   const bool anyAnalysisNeeded = fAutoLocalAccess ||
                                  fAutoAggregation ||
+                                 fInspectorExecutor ||
                                  !fNoFastFollowers;
 
   if (anyAnalysisNeeded) {
@@ -133,6 +155,12 @@ void doPreNormalizeArrayOptimizations() {
         symbolicFastFollowerAnalysis(forall);
       }
 
+      // this runs before ALA, so that the gathered values can be accessed
+      // locally in the executor
+      if (fInspectorExecutor) {
+        inspectorExecutor(forall);
+      }
+
       if (fAutoLocalAccess) {
         autoLocalAccess(forall);
       }
@@ -194,11 +222,12 @@ Expr *preFoldMaybeLocalThis(CallExpr *call) {
   // PRIM_MAYBE_LOCAL_THIS looks like
   //
   //  (call "may be local access" arrSymbol, idxSym0, ... ,idxSymN,
-  //                              paramControlFlag, paramStaticallyDetermined)
+  //                              paramControlFlag, paramStaticallyDetermined,
+  //                              paramInLoopDomain)
   //
-  // we need to check the second argument from last to determine whether we
+  // we need to check the third argument from last to determine whether we
   // are confirming this to be a local access or not
-  if (SymExpr *controlSE = toSymExpr(call->get(call->argList.length-1))) {
+  if (SymExpr *controlSE = toSymExpr(call->get(call->argList.length-2))) {
     if (controlSE->symbol() == gTrue) {
       confirmed = true;
     }
@@ -554,6 +583,15 @@ static void LOGLN_AA(BaseAST *node) {
   LOGLN_help(node, fAutoAggregation && fReportAutoAggregation);
 }
 
+static bool LOG_IE(int depth, const char *msg, BaseAST *node) {
+  return LOG_help(depth, msg, node, NOT_CLONE,
+                  fInspectorExecutor && fReportInspectorExecutor);
+}
+
+static void LOGLN_IE(BaseAST *node) {
+  LOGLN_help(node, fInspectorExecutor && fReportInspectorExecutor);
+}
+
 static bool LOG_ALA(int depth, const char *msg, BaseAST *node,
                     bool forallDetails) {
   ForallAutoLocalAccessCloneType cloneType = NOT_CLONE;
@@ -1356,6 +1394,10 @@ static CallExpr* replaceCandidate(ALACandidate& candidate,
   // accurate logging
   repl->insertAtTail(new SymExpr(doStatic?gTrue:gFalse));
 
+  // mark if the index is one of the loop domain's. If the checks pass, those
+  // are known to be in the array's domain, so we don't need bounds checks
+  repl->insertAtTail(new SymExpr(candidate.hasOffset()?gFalse:gTrue));
+
   call->replace(repl);
 
   return repl;
@@ -1537,6 +1579,92 @@ static void generateOptimizedLoops(ForallStmt *forall) {
   }
 }
 
+// Offset accesses like `A[i+1]` are only local under a Block-like
+// distribution if `i+1` is on the same locale as `i`, which is true for all
+// but a strip of indices along each locale's boundary. With
+// --split-offset-auto-local-access, we turn
+//
+//   forall i in D { ... A[i+1] ... }
+//
+// into
+//
+//   if chpl__ala_splitCheck(D, offsets...) {
+//     forall i in chpl__ala_interiorIndices(D, offsets...) { ... A[i+1] ... }
+//     forall i in chpl__ala_boundaryIndices(D, offsets...) { ... A[i+1] ... }
+//   }
+//   else {
+//     forall i in D { ... A[i+1] ... }
+//   }
+//
+// `offsets` has a tuple per offset access. The interior iterator yields the
+// indices of each locale's part of `D` that are at least as far from its edges
+// as the largest offset in each dimension, on that locale, so the interior loop
+// is analyzed as if the offsets weren't there. The boundary loop yields the
+// rest and isn't optimized. The else branch is analyzed as usual, and is
+// used when `D` isn't distributed in a way the split supports.
+static void splitLoopForOffsets(ForallStmt *forall) {
+  if (forall->iteratedExpressions().length != 1) return;
+
+  std::vector<CallExpr *> allCallExprs;
+  collectCallExprs(forall->loopBody(), allCallExprs);
+
+  std::vector<Expr *> halos;
+  for_vector(CallExpr, call, allCallExprs) {
+    ALACandidate candidate(call, forall, /*checkArgs=*/true);
+    if (!candidate.isRejected() && candidate.hasOffset()) {
+      SET_LINENO(call);
+      CallExpr *halo = new CallExpr("_build_tuple");
+      for (auto e: candidate.offsetExprs()) {
+        halo->insertAtTail(e->copy());
+      }
+      halos.push_back(halo);
+    }
+  }
+
+  if (halos.size() == 0) return;
+
+  LOG_ALA(1, "Splitting forall into interior and boundary loops", forall);
+
+  SET_LINENO(forall);
+
+  Expr *loopDomain = forall->optInfo.getLoopDomainExpr();
+  INT_ASSERT(loopDomain);
+
+  ForallStmt *interior = cloneLoop(forall);
+  ForallStmt *boundary = cloneLoop(forall);
+
+  CallExpr *splitCheck = new CallExpr("chpl__ala_splitCheck", loopDomain);
+  CallExpr *interiorIter = new CallExpr("chpl__ala_interiorIndices",
+                                        loopDomain->copy());
+  CallExpr *boundaryIter = new CallExpr("chpl__ala_boundaryIndices",
+                                        loopDomain->copy());
+  for_vector(Expr, halo, halos) {
+    splitCheck->insertAtTail(halo);
+    interiorIter->insertAtTail(halo->copy());
+    boundaryIter->insertAtTail(halo->copy());
+  }
+
+  BlockStmt *thenBlock = new BlockStmt();
+  BlockStmt *elseBlock = new BlockStmt();
+  CondStmt *cond = new CondStmt(splitCheck, thenBlock, elseBlock);
+
+  forall->insertAfter(cond);
+  elseBlock->insertAtTail(forall->remove());
+  thenBlock->insertAtTail(interior);
+  thenBlock->insertAtTail(boundary);
+
+  // gather the info while the interior loop still iterates the loop domain, so
+  // that its accesses are checked against that, then switch to the iterator
+  interior->optInfo.autoLocalAccessChecked = false;
+  gatherForallInfo(interior);
+  interior->optInfo.offsetsStayLocal = true;
+  interior->iteratedExpressions().get(1)->replace(interiorIter);
+
+  // the boundary loop is left alone
+  boundary->optInfo.autoLocalAccessChecked = true;
+  boundary->iteratedExpressions().get(1)->replace(boundaryIter);
+}
+
 static void autoLocalAccess(ForallStmt *forall) {
 
   if (forall->optInfo.autoLocalAccessChecked) {
@@ -1547,7 +1675,10 @@ static void autoLocalAccess(ForallStmt *forall) {
   LOGLN_ALA(forall);
   LOG_ALA(0, "Start analyzing forall", forall);
 
-  gatherForallInfo(forall);
+  // the interior loop of a split forall has this already
+  if (!forall->optInfo.infoGathered) {
+    gatherForallInfo(forall);
+  }
 
   if (!loopHasValidInductionVariables(forall)) {
     LOG_ALA(1, "Can't optimize this forall: invalid induction variables", forall);
@@ -1561,6 +1692,12 @@ static void autoLocalAccess(ForallStmt *forall) {
 
   Symbol *loopDomain = canDetermineLoopDomainStatically(forall);
   bool staticLoopDomain = loopDomain != NULL;
+
+  if (fSplitOffsetAutoLocalAccess && fOffsetAutoLocalAccess &&
+      staticLoopDomain && !forall->optInfo.offsetsStayLocal) {
+    splitLoopForOffsets(forall);
+  }
+
   if (staticLoopDomain) {
     LOG_ALA(1, "Found loop domain", loopDomain);
     LOG_ALA(1, "Will attempt static and dynamic optimizations", forall);
@@ -1593,7 +1730,12 @@ static void autoLocalAccess(ForallStmt *forall) {
 
 
     LOG_ALA(2, "Start analyzing call", call);
-    if (candidate.hasOffset()) {
+    if (candidate.hasOffset() && forall->optInfo.offsetsStayLocal) {
+      LOG_ALA(3, "Call has offset(s), but they stay local in the interior loop",
+              call);
+      candidate.ignoreOffset();
+    }
+    else if (candidate.hasOffset()) {
       LOG_ALA(3, "Call has offset(s), this will require dynamic check", call);
     }
 
@@ -1698,9 +1840,10 @@ static CallExpr *revertAccess(CallExpr *call) {
   CallExpr *repl = new CallExpr(new UnresolvedSymExpr("this"),
                                 gMethodToken);
 
-  // Don't take the last two args; they are the static control symbol, and flag
-  // that tells whether this is a statically-determined access
-  for (int i = 1 ; i < call->argList.length-1 ; i++) {
+  // Don't take the last three args; they are the static control symbol, and
+  // flags that tell whether this is a statically-determined access and whether
+  // the index is in the loop domain
+  for (int i = 1 ; i < call->argList.length-2 ; i++) {
     Symbol *argSym = toSymExpr(call->get(i))->symbol();
     repl->insertAtTail(new SymExpr(argSym));
   }
@@ -1709,7 +1852,7 @@ static CallExpr *revertAccess(CallExpr *call) {
 }
 
 static CallExpr *confirmAccess(CallExpr *call) {
-  if (toSymExpr(call->get(call->argList.length))->symbol() == gTrue) {
+  if (toSymExpr(call->get(call->argList.length-1))->symbol() == gTrue) {
     LOG_ALA(0, "Static check successful. Using localAccess", call,
             /*forallDetails=*/true);
   }
@@ -1717,12 +1860,22 @@ static CallExpr *confirmAccess(CallExpr *call) {
     LOG_ALA(0, "Static check successful. Using localAccess with dynamic check", call);
   }
 
-  CallExpr *repl = new CallExpr(new UnresolvedSymExpr("localAccess"),
+  // An index of the loop domain is in the array's domain once the checks have
+  // passed, so its bounds check can't fail. Accesses with offsets keep theirs.
+  const char* accessName = "localAccess";
+  if (fUncheckedAutoLocalAccess && !fNoBoundsChecks &&
+      toSymExpr(call->get(call->argList.length))->symbol() == gTrue) {
+    LOG_ALA(0, "Index is in the array's domain. Removing bounds check", call);
+    accessName = "chpl__uncheckedLocalAccess";
+  }
+
+  CallExpr *repl = new CallExpr(new UnresolvedSymExpr(accessName),
                                 gMethodToken);
 
-  // Don't take the last two args; they are the static control symbol, and flag
-  // that tells whether this is a statically-determined access
-  for (int i = 1 ; i < call->argList.length-1 ; i++) {
+  // Don't take the last three args; they are the static control symbol, and
+  // flags that tell whether this is a statically-determined access and whether
+  // the index is in the loop domain
+  for (int i = 1 ; i < call->argList.length-2 ; i++) {
     Symbol *argSym = toSymExpr(call->get(i))->symbol();
     repl->insertAtTail(new SymExpr(argSym));
   }
@@ -1812,7 +1965,18 @@ static void autoAggregation(ForallStmt *forall) {
     for_vector(Expr, lastStmt, lastStmts) {
       if (CallExpr *lastCall = toCallExpr(lastStmt)) {
         bool reportedLoc = false;
-        if (lastCall->isNamedAstr(astrSassign)) {
+        CallExpr *updateLhs = NULL;
+        Expr *updateValue = NULL;
+        if (const char *updateOp = getUpdateOpForAggregation(lastCall, forall,
+                                                             &updateLhs,
+                                                             &updateValue)) {
+          reportedLoc = LOG_AA(1, "Found an update aggregation candidate",
+                               lastCall);
+
+          insertAggUpdateCandidate(lastCall, updateOp, updateLhs, updateValue,
+                                   forall);
+        }
+        else if (lastCall->isNamedAstr(astrSassign)) {
           // no need to do anything if it is array access
           if (assignmentSuitableForAggregation(lastCall, forall)) {
             reportedLoc = LOG_AA(1, "Found an aggregation candidate", lastCall);
@@ -1850,22 +2014,41 @@ AggregationCandidateInfo::AggregationCandidateInfo(CallExpr *candidate,
   lhsLogicalChild(NULL),
   rhsLogicalChild(NULL),
   srcAggregator(NULL),
-  dstAggregator(NULL) { }
+  dstAggregator(NULL),
+  updateOp(NULL) { }
 
-static CondStmt *createAggCond(CallExpr *noOptAssign, Symbol *aggregator, SymExpr *aggMarkerSE) {
+// builds the unaggregated form of an assignment or update
+static CallExpr *buildAssignOrUpdate(Expr *lhs, Expr *rhs,
+                                     const char *updateOp) {
+  if (updateOp == NULL) {
+    return new CallExpr("=", lhs, rhs);
+  }
+  else if (strcmp(updateOp, "min") == 0 || strcmp(updateOp, "max") == 0) {
+    return new CallExpr("=", lhs, new CallExpr(updateOp, lhs->copy(), rhs));
+  }
+  else if (strcmp(updateOp, "add") == 0) {
+    return new CallExpr(buildDotExpr(lhs, "add"), rhs);
+  }
+  else {
+    return new CallExpr(updateOp, lhs, rhs);
+  }
+}
+
+static CondStmt *createAggCond(CallExpr *noOptAssign,
+                               SymExpr *lhsSE, SymExpr *rhsSE,
+                               Symbol *aggregator, SymExpr *aggMarkerSE,
+                               const char *updateOp) {
   INT_ASSERT(aggregator);
   INT_ASSERT(aggMarkerSE);
 
   // the candidate assignment must have been normalized, so, we expect symexpr
   // on both sides
-  SymExpr *lhsSE = toSymExpr(noOptAssign->get(1));
-  SymExpr *rhsSE = toSymExpr(noOptAssign->get(2));
   INT_ASSERT(lhsSE != NULL && rhsSE != NULL);
 
   SET_LINENO(noOptAssign);
 
   // generate the aggregated call
-  Expr *callBase = buildDotExpr(aggregator, "copy");
+  Expr *callBase = buildDotExpr(aggregator, updateOp ? "update" : "copy");
   CallExpr *aggCall = new CallExpr(callBase, lhsSE->copy(), rhsSE->copy());
 
   // create the conditional with regular assignment on the then block
@@ -1888,9 +2071,10 @@ static CondStmt *createAggCond(CallExpr *noOptAssign, Symbol *aggregator, SymExp
 // remove it when we use it, but we can also leave some untouched. This
 // function removes that argument if the primitive still has 3 arguments
 void AggregationCandidateInfo::removeSideEffectsFromPrimitive() {
-  INT_ASSERT(this->candidate->isNamedAstr(astrSassign));
+  INT_ASSERT(this->updateOp != NULL ||
+             this->candidate->isNamedAstr(astrSassign));
 
-  if (CallExpr *childCall = toCallExpr(this->candidate->get(1))) {
+  if (CallExpr *childCall = toCallExpr(this->lhsLogicalChild)) {
     if (childCall->isPrimitive(PRIM_MAYBE_LOCAL_ARR_ELEM)) {
       if (childCall->numActuals() == 4) {
         childCall->get(2)->remove();
@@ -1898,7 +2082,7 @@ void AggregationCandidateInfo::removeSideEffectsFromPrimitive() {
     }
   }
 
-  if (CallExpr *childCall = toCallExpr(this->candidate->get(2))) {
+  if (CallExpr *childCall = toCallExpr(this->rhsLogicalChild)) {
     if (childCall->isPrimitive(PRIM_MAYBE_LOCAL_ARR_ELEM)) {
       if (childCall->numActuals() == 4) {
         childCall->get(2)->remove();
@@ -1928,7 +2112,8 @@ void AggregationCandidateInfo::addAggregators() {
   if (srcAggregator == NULL &&
       (lhsLocalityInfo == PENDING || lhsLocalityInfo == LOCAL) &&
       rhsLogicalChild != NULL) {
-    if (CallExpr *genCall = getAggGenCallForChild(rhsLogicalChild, true)) {
+    if (CallExpr *genCall = getAggGenCallForChild(rhsLogicalChild, true,
+                                                  NULL)) {
       SET_LINENO(this->forall);
 
       UnresolvedSymExpr *aggTmp = new UnresolvedSymExpr("chpl_src_auto_agg");
@@ -1945,11 +2130,13 @@ void AggregationCandidateInfo::addAggregators() {
     }
   }
 
-  // we have a rhs that waits analysis or local
+  // we have a rhs that waits analysis or local. For updates, the rhs is a
+  // value that travels with the update, so it is always local
   if (dstAggregator == NULL &&
       (rhsLocalityInfo == PENDING || rhsLocalityInfo == LOCAL) &&
       lhsLogicalChild != NULL) {
-    if (CallExpr *genCall = getAggGenCallForChild(lhsLogicalChild, false)) {
+    if (CallExpr *genCall = getAggGenCallForChild(lhsLogicalChild, false,
+                                                  updateOp)) {
       SET_LINENO(this->forall);
 
       UnresolvedSymExpr *aggTmp = new UnresolvedSymExpr("chpl_dst_auto_agg");
@@ -1960,7 +2147,9 @@ void AggregationCandidateInfo::addAggregators() {
       aggregator->addFlag(FLAG_COMPILER_ADDED_AGGREGATOR);
       forall->shadowVariables().insertAtTail(aggregator->defPoint);
 
-      LOG_AA(2, "Potential destination aggregation", this->candidate);
+      LOG_AA(2, updateOp ? "Potential destination update aggregation" :
+                           "Potential destination aggregation",
+             this->candidate);
 
       this->dstAggregator = aggregator;
     }
@@ -1978,26 +2167,36 @@ static const char *getForallCloneTypeStr(Symbol *aggMarker) {
   return "";
 }
 
-static CallExpr *getAggGenCallForChild(Expr *child, bool srcAggregation) {
+// `updateOp` is only given for destination aggregation of an update, in which
+// case the update's name is passed to the generator as a param
+static CallExpr *getAggGenCallForChild(Expr *child, bool srcAggregation,
+                                       const char *updateOp) {
   SET_LINENO(child);
 
+  CallExpr *genCall = NULL;
+
   if (CallExpr *childCall = toCallExpr(child)) {
     const char *aggFnName = srcAggregation ? "chpl_srcAggregatorFor" :
-                                             "chpl_dstAggregatorFor";
+                            updateOp ? "chpl_dstUpdateAggregatorFor" :
+                                       "chpl_dstAggregatorFor";
     if (canBeLocalAccess(childCall)) {
       if (SymExpr *arrSymExpr = toSymExpr(childCall->get(1))) {
-        return new CallExpr(aggFnName, new SymExpr(arrSymExpr->symbol()));
+        genCall = new CallExpr(aggFnName, new SymExpr(arrSymExpr->symbol()));
       }
     }
     else if (childCall->isPrimitive(PRIM_MAYBE_LOCAL_ARR_ELEM)) {
-      return new CallExpr(aggFnName, childCall->get(2)->remove());
+      genCall = new CallExpr(aggFnName, childCall->get(2)->remove());
     }
     else if (SymExpr *arrSymExpr = toSymExpr(childCall->baseExpr)) {
-      return new CallExpr(aggFnName, new SymExpr(arrSymExpr->symbol()));
+      genCall = new CallExpr(aggFnName, new SymExpr(arrSymExpr->symbol()));
     }
   }
 
-  return NULL;
+  if (genCall != NULL && updateOp != NULL) {
+    genCall->insertAtTail(new SymExpr(new_StringSymbol(updateOp)));
+  }
+
+  return genCall;
 }
 
 // currently we want both sides to be calls, but we need to relax these to
@@ -2035,13 +2234,149 @@ static bool assignmentSuitableForAggregation(CallExpr *call, ForallStmt *forall)
   return false;
 }
 
+// do the two expressions access the same thing? This is only used to match
+// `x` in `x = min(x, y)`, so we only need to support what array accesses look
+// like before normalization
+static bool accessesMatch(Expr *a, Expr *b) {
+  if (SymExpr *aSE = toSymExpr(a)) {
+    SymExpr *bSE = toSymExpr(b);
+    return bSE != NULL && aSE->symbol() == bSE->symbol();
+  }
+  if (UnresolvedSymExpr *aUSE = toUnresolvedSymExpr(a)) {
+    UnresolvedSymExpr *bUSE = toUnresolvedSymExpr(b);
+    return bUSE != NULL && aUSE->unresolved == bUSE->unresolved;
+  }
+  if (CallExpr *aCall = toCallExpr(a)) {
+    CallExpr *bCall = toCallExpr(b);
+    if (bCall == NULL || aCall->primitive != bCall->primitive ||
+        aCall->numActuals() != bCall->numActuals()) {
+      return false;
+    }
+
+    int numArgs = aCall->numActuals();
+    if (aCall->isPrimitive(PRIM_MAYBE_LOCAL_THIS)) {
+      // the last three are the static check symbol and flags that are
+      // specific to each access
+      numArgs -= 3;
+    }
+    else if (aCall->primitive != NULL) {
+      return false;
+    }
+    else if (!accessesMatch(aCall->baseExpr, bCall->baseExpr)) {
+      return false;
+    }
+
+    for (int i = 1 ; i <= numArgs ; i++) {
+      if (!accessesMatch(aCall->get(i), bCall->get(i))) {
+        return false;
+      }
+    }
+    return true;
+  }
+  return false;
+}
+
+// Is `call` a commutative update of an array element that we can buffer per
+// destination? We support
+//
+//   A[idx[i]] op= x;            // +=, *=, &=, |=, ^=
+//   A[idx[i]] = min(A[idx[i]], x);   // or max, either argument order
+//   A[idx[i]].add(x);           // atomic elements
+//
+// If so, returns the name of the update, and sets `lhs` to the updated
+// element and `value` to the value combined into it.
+static const char *getUpdateOpForAggregation(CallExpr *call,
+                                             ForallStmt *forall,
+                                             CallExpr **lhs, Expr **value) {
+  const char *updateOp = NULL;
+  CallExpr *lhsCall = NULL;
+  Expr *valueExpr = NULL;
+
+  static const char *opAssignNames[] = { "+=", "*=", "&=", "|=", "^=" };
+
+  for (const char *name : opAssignNames) {
+    if (call->isNamed(name) && call->numActuals() == 2) {
+      updateOp = astr(name);
+      lhsCall = toCallExpr(call->get(1));
+      valueExpr = call->get(2);
+    }
+  }
+
+  if (updateOp == NULL && call->isNamedAstr(astrSassign)) {
+    CallExpr *rhsCall = toCallExpr(call->get(2));
+    if (rhsCall != NULL && rhsCall->numActuals() == 2 &&
+        (rhsCall->isNamed("min") || rhsCall->isNamed("max"))) {
+      lhsCall = toCallExpr(call->get(1));
+      if (lhsCall != NULL) {
+        if (accessesMatch(lhsCall, rhsCall->get(1))) {
+          valueExpr = rhsCall->get(2);
+        }
+        else if (accessesMatch(lhsCall, rhsCall->get(2))) {
+          valueExpr = rhsCall->get(1);
+        }
+      }
+      if (valueExpr != NULL) {
+        updateOp = astr(rhsCall->isNamed("min") ? "min" : "max");
+      }
+    }
+  }
+  else if (updateOp == NULL && toCallExpr(call->baseExpr) != NULL) {
+    CallExpr *dotCall = toCallExpr(call->baseExpr);
+    if (dotCall->isNamedAstr(astrSdot) && call->numActuals() == 1) {
+      if (SymExpr *memberSE = toSymExpr(dotCall->get(2))) {
+        if (VarSymbol *memberSym = toVarSymbol(memberSE->symbol())) {
+          if (memberSym->immediate != NULL &&
+              strcmp(memberSym->immediate->string_value(), "add") == 0) {
+            updateOp = astr("add");
+            lhsCall = toCallExpr(dotCall->get(1));
+            valueExpr = call->get(1);
+          }
+        }
+      }
+    }
+  }
+
+  if (updateOp == NULL || lhsCall == NULL) {
+    return NULL;
+  }
+
+  // a local lhs doesn't need aggregation, and the lhs must look like an
+  // access to an array that is defined outside the loop
+  if (canBeLocalAccess(lhsCall) ||
+      lhsCall->isPrimitive(PRIM_MAYBE_LOCAL_ARR_ELEM) ||
+      ALACandidate(lhsCall, forall).isRejected()) {
+    return NULL;
+  }
+
+  *lhs = lhsCall;
+  *value = valueExpr;
+  return updateOp;
+}
+
+// returns the update name if `call` is an update, NULL if it is an assignment
+static const char *getMaybeAggAssignUpdateOp(CallExpr *call) {
+  INT_ASSERT(call->isPrimitive(PRIM_MAYBE_AGGREGATE_ASSIGN));
+
+  if (call->numActuals() == 8) {
+    return get_string(call->get(8));
+  }
+  return NULL;
+}
+
 Expr *preFoldMaybeAggregateAssign(CallExpr *call) {
   INT_ASSERT(call->isPrimitive(PRIM_MAYBE_AGGREGATE_ASSIGN));
 
+  const char *updateOp = getMaybeAggAssignUpdateOp(call);
+  if (updateOp != NULL) {
+    call->get(8)->remove();
+  }
+
   Expr *rhs = call->get(2)->remove();
   Expr *lhs = call->get(1)->remove();
 
-  CallExpr *assign = new CallExpr("=", lhs, rhs);
+  SymExpr *lhsSE = toSymExpr(lhs);
+  SymExpr *rhsSE = toSymExpr(rhs);
+  CallExpr *assign = buildAssignOrUpdate(lhs, rhs, updateOp);
 
   SymExpr *srcAggregatorSE = toSymExpr(call->get(2)->remove());
   INT_ASSERT(srcAggregatorSE);
@@ -2089,7 +2424,8 @@ Expr *preFoldMaybeAggregateAssign(CallExpr *call) {
     }
 
     if (aggregator != NULL) {
-      replacement = createAggCond(assign, aggregator, aggMarkerSE);
+      replacement = createAggCond(assign, lhsSE, rhsSE, aggregator,
+                                  aggMarkerSE, updateOp);
     }
   }
 
@@ -2116,7 +2452,13 @@ Expr *preFoldMaybeAggregateAssign(CallExpr *call) {
     if (dstAggregator != gNil) {
       removeAggregatorFromFunction(dstAggregator, parentFn);
     }
-    replacement = assign;
+    // updates other than op= have nested calls that need normalization
+    if (updateOp != NULL) {
+      replacement = new BlockStmt(assign, BLOCK_SCOPELESS);
+    }
+    else {
+      replacement = assign;
+    }
   }
 
   if (fReportAutoAggregation) {
@@ -2146,8 +2488,8 @@ void adjustPrimsInFastFollowerBody(BlockStmt *body) {
 
 void AggregationCandidateInfo::transformCandidate() {
   SET_LINENO(this->candidate);
-  Expr *rhs = this->candidate->get(2)->remove();
-  Expr *lhs = this->candidate->get(1)->remove();
+  Expr *rhs = this->rhsLogicalChild->remove();
+  Expr *lhs = this->lhsLogicalChild->remove();
   CallExpr *repl = new CallExpr(PRIM_MAYBE_AGGREGATE_ASSIGN,
                                 lhs,
                                 rhs);
@@ -2179,6 +2521,10 @@ void AggregationCandidateInfo::transformCandidate() {
 
   repl->insertAtTail(new SymExpr(aggMarker));
 
+  if (this->updateOp != NULL) {
+    repl->insertAtTail(new SymExpr(new_CStringSymbol(this->updateOp)));
+  }
+
   this->candidate->replace(repl);
 }
 
@@ -2219,6 +2565,25 @@ static void insertAggCandidate(CallExpr *call, ForallStmt *forall) {
   info->transformCandidate();
 }
 
+// Updates only support destination aggregation: the value is computed by the
+// task, and the update is applied where the element lives.
+static void insertAggUpdateCandidate(CallExpr *call, const char *updateOp,
+                                     CallExpr *lhs, Expr *value,
+                                     ForallStmt *forall) {
+  AggregationCandidateInfo *info = new AggregationCandidateInfo(call, forall);
+
+  info->updateOp = updateOp;
+  info->lhsLogicalChild = lhs;
+  info->rhsLocalityInfo = LOCAL;
+  info->rhsLogicalChild = value;
+
+  info->addAggregators();
+
+  info->removeSideEffectsFromPrimitive();
+
+  info->transformCandidate();
+}
+
 static Expr *getAlignedIterandForTheYieldedSym(Symbol *sym, ForallStmt *forall,
                                                bool *onlyIfFastFollower) {
   AList &iterExprs = forall->iteratedExpressions();
@@ -2392,8 +2757,8 @@ static void removeAggregatorFromFunction(Symbol *aggregator, FnSymbol *parent) {
         break;
       }
 
-      // is `aggregator` receiver of a `copy` call?
-      if (parentCall->isNamed("copy")) {
+      // is `aggregator` receiver of a `copy` or `update` call?
+      if (parentCall->isNamed("copy") || parentCall->isNamed("update")) {
         // this check should be enough to make sure that this is an aggregated
         // copy call. The following asserts make sure of that:
         INT_ASSERT(toSymExpr(parentCall->get(2))->symbol() == aggregator);
@@ -2489,6 +2854,11 @@ static void findAndUpdateMaybeAggAssign(CallExpr *call, bool confirmed) {
         lhsOfMaybeAggAssign = (lhsSE->symbol() == tmpSym);
         rhsOfMaybeAggAssign = (rhsSE->symbol() == tmpSym);
 
+        // the value of an update is local no matter where it was read from
+        if (getMaybeAggAssignUpdateOp(maybeAggAssign) != NULL) {
+          rhsOfMaybeAggAssign = false;
+        }
+
         if (lhsOfMaybeAggAssign || rhsOfMaybeAggAssign) {
           // at most one can be true
           INT_ASSERT(lhsOfMaybeAggAssign != rhsOfMaybeAggAssign);
@@ -2523,13 +2893,9 @@ static void removeAggregationFromRecursiveForallHelp(BlockStmt *block) {
 
       if (aggMarkerSym->hasFlag(FLAG_AGG_MARKER)) {
 
-        CallExpr *assignCall = toCallExpr(condStmt->thenStmt->getFirstExpr()->parentExpr);
-        INT_ASSERT(assignCall);
-        INT_ASSERT(assignCall->isNamedAstr(astrSassign));
-
         CallExpr *aggCall = toCallExpr(condStmt->elseStmt->getFirstExpr()->parentExpr);
         INT_ASSERT(aggCall);
-        INT_ASSERT(aggCall->isNamed("copy"));
+        INT_ASSERT(aggCall->isNamed("copy") || aggCall->isNamed("update"));
 
         SymExpr *aggregatorSE = toSymExpr(aggCall->get(1));
         INT_ASSERT(aggregatorSE);
@@ -2537,7 +2903,11 @@ static void removeAggregationFromRecursiveForallHelp(BlockStmt *block) {
         Symbol *aggSym = aggregatorSE->symbol();
         INT_ASSERT(aggSym->hasFlag(FLAG_COMPILER_ADDED_AGGREGATOR));
 
-        condStmt->insertBefore(assignCall->remove());
+        // the then block has the assignment, or the update along with the
+        // temps it was normalized into
+        for_alist(expr, condStmt->thenStmt->body) {
+          condStmt->insertBefore(expr->remove());
+        }
         condStmt->remove();
         aggMarkerSym->defPoint->remove();
         aggSym->defPoint->remove();
@@ -2572,3 +2942,160 @@ static bool isLocalAccess(CallExpr *call) {
 
   return false;
 }
+
+//
+// Normalize support for --inspector-executor
+//
+// Iterative codes often run a gather like
+//
+//   forall i in D do y[i] = x[col[i]];
+//
+// many times with the same `col`. Which elements of `x` each locale needs, and
+// from where, only depends on `col`. So we turn the loop into
+//
+//   const chpl_ie_gathered = chpl__inspectorExecutorGather(chpl_ie_site,
+//                                                          x, col, D);
+//   forall i in D do y[i] = chpl_ie_gathered[i];
+//
+// `chpl_ie_site` is a module-level variable, one per loop, where the module
+// code keeps the schedule built by the inspector. On each execution, the
+// schedule is rebuilt only if `col` was modified since it was built; then the
+// executor moves the needed elements of `x` with one bulk transfer per pair
+// of locales. `chpl_ie_gathered` is distributed like `D`, so ALA can make
+// the loop body local.
+//
+
+// is `e` the loop index `idxSym`?
+static bool isLoopIndex(Expr *e, Symbol *idxSym) {
+  if (SymExpr *se = toSymExpr(e)) {
+    return se->symbol() == idxSym;
+  }
+  return false;
+}
+
+// is `call` an access like `arr[idxSym]` to an array defined outside the loop?
+static bool isOuterAccessWithIndex(CallExpr *call, Expr *idx,
+                                   ForallStmt *forall) {
+  return call != NULL && call->numActuals() == 1 &&
+         toSymExpr(call->baseExpr) != NULL &&
+         !ALACandidate(call, forall).isRejected() &&
+         idx == call->get(1);
+}
+
+// the symbol must only be used in the access we are transforming
+static bool symUsedOnceInBody(Symbol *sym, ForallStmt *forall) {
+  std::vector<SymExpr *> symExprs;
+  collectSymExprsFor(forall->loopBody(), sym, symExprs);
+  return symExprs.size() == 1;
+}
+
+static void inspectorExecutor(ForallStmt *forall) {
+  if (forall->getModule()->modTag != MOD_USER) {
+    return;
+  }
+
+  AList &iterExprs = forall->iteratedExpressions();
+  AList &indexVars = forall->inductionVariables();
+
+  if (forall->zippered() || iterExprs.length != 1 || indexVars.length != 1) {
+    return;
+  }
+
+  SymExpr *iterSE = toSymExpr(iterExprs.get(1));
+  DefExpr *idxDef = toDefExpr(indexVars.get(1));
+  if (iterSE == NULL || idxDef == NULL ||
+      idxDef->sym->hasFlag(FLAG_INDEX_OF_INTEREST)) {
+    return;
+  }
+  Symbol *idxSym = idxDef->sym;
+
+  LOG_IE(0, "Start analyzing forall for inspector-executor", forall);
+
+  std::vector<Expr *> lastStmts = getLastStmtsForForallUnorderedOps(forall);
+
+  // we only transform loops whose whole body is the gather, so that nothing
+  // else in the loop can modify `x` or `col` through an alias
+  CallExpr *assign = NULL;
+  if (lastStmts.size() == 1) {
+    assign = toCallExpr(lastStmts[0]);
+    for_alist(stmt, forall->loopBody()->body) {
+      CallExpr *stmtCall = toCallExpr(stmt);
+      if (stmt != assign &&
+          (stmtCall == NULL || !stmtCall->isPrimitive(PRIM_END_OF_STATEMENT))) {
+        assign = NULL;
+        break;
+      }
+    }
+  }
+
+  CallExpr *lhsCall = NULL;   // y[i]
+  CallExpr *rhsCall = NULL;   // x[col[i]]
+  CallExpr *colCall = NULL;   // col[i]
+
+  if (assign != NULL && assign->isNamedAstr(astrSassign)) {
+    lhsCall = toCallExpr(assign->get(1));
+    rhsCall = toCallExpr(assign->get(2));
+    if (rhsCall != NULL && rhsCall->numActuals() == 1) {
+      colCall = toCallExpr(rhsCall->get(1));
+    }
+  }
+
+  if (lhsCall == NULL || rhsCall == NULL || colCall == NULL ||
+      !isLoopIndex(lhsCall->get(1), idxSym) ||
+      !isLoopIndex(colCall->get(1), idxSym) ||
+      !isOuterAccessWithIndex(lhsCall, lhsCall->get(1), forall) ||
+      !isOuterAccessWithIndex(colCall, colCall->get(1), forall) ||
+      !isOuterAccessWithIndex(rhsCall, colCall, forall)) {
+    LOG_IE(1, "Loop body is not a gather through an index array", forall);
+    LOG_IE(0, "End analyzing forall for inspector-executor", forall);
+    LOGLN_IE(forall);
+    return;
+  }
+
+  Symbol *ySym = toSymExpr(lhsCall->baseExpr)->symbol();
+  Symbol *xSym = toSymExpr(rhsCall->baseExpr)->symbol();
+  Symbol *colSym = toSymExpr(colCall->baseExpr)->symbol();
+
+  // if the loop itself could write to `x` or `col`, the schedule or the
+  // gathered values may not be valid for the whole loop
+  if (ySym == xSym || ySym == colSym || xSym == colSym ||
+      !symUsedOnceInBody(xSym, forall) ||
+      !symUsedOnceInBody(colSym, forall)) {
+    LOG_IE(1, "Index or source array may be modified in the loop", forall);
+    LOG_IE(0, "End analyzing forall for inspector-executor", forall);
+    LOGLN_IE(forall);
+    return;
+  }
+
+  // shadow variables refer back to the outer symbols that the module code sees
+  if (ShadowVarSymbol *svar = toShadowVarSymbol(xSym)) {
+    xSym = svar->outerVarSym();
+  }
+  if (ShadowVarSymbol *svar = toShadowVarSymbol(colSym)) {
+    colSym = svar->outerVarSym();
+  }
+
+  SET_LINENO(forall);
+
+  // the schedule outlives this execution of the loop, so it is kept at module
+  // scope; the module code creates it lazily
+  VarSymbol *siteSym = new VarSymbol("chpl_ie_site");
+  forall->getModule()->block->insertAtHead(
+      new DefExpr(siteSym, new CallExpr("chpl__inspectorExecutorSite")));
+
+  VarSymbol *gatheredSym = new VarSymbol("chpl_ie_gathered");
+  gatheredSym->addFlag(FLAG_CONST);
+  CallExpr *gatherCall = new CallExpr("chpl__inspectorExecutorGather",
+                                      new SymExpr(siteSym),
+                                      new SymExpr(xSym),
+                                      new SymExpr(colSym),
+                                      iterSE->copy());
+  forall->insertBefore(new DefExpr(gatheredSym, gatherCall));
+
+  rhsCall->replace(new CallExpr(new SymExpr(gatheredSym),
+                                new SymExpr(idxSym)));
+
+  LOG_IE(1, "Gather will reuse its communication schedule", assign);
+  LOG_IE(0, "End analyzing forall for inspector-executor", forall);
+  LOGLN_IE(forall);
+}
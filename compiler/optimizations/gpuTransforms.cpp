@@ -1052,6 +1052,7 @@ class KernelArg {
     CallExpr* generatePrimGpuBlockReduce(Symbol* blockSize) const;
     std::string generateDevFnName() const;
     std::string reduceKindFnName() const;
+    std::string finalReduceFnName() const;
 
   private:
     bool isReduce() const { return kind_&GpuArgKind::REDUCE; }
@@ -1098,6 +1099,12 @@ class GpuKernel {
   Symbol*    localGlobalThreadIdx_;
   BlockStmt* userBody_; // where the loop's body goes
   BlockStmt* postBody_; // executed by all GPU threads (even if oob) at the end
+  VarSymbol* blockStart_;  // blockIdxX * blockDimX
+  VarSymbol* blockDimX_;
+  VarSymbol* threadIdxX_;
+  Symbol*    startOffset_; // lower bound of the first index, in the kernel
+  Symbol*    localUpperBound_;
+  CondStmt*  oobCond_;     // guards userBody_ when there's no itersPerThread
 
   int nReductionBufs_ = 0;
   int nHostRegisteredVars_ = 0;
@@ -1141,6 +1148,7 @@ class GpuKernel {
   void generateCyclicLoopOverIPT(Symbol* upperBound);
   void generateOobCondNoIPT(Symbol* upperBound);
   void generatePostBody();
+  void stageReadOnlyArrays();
   void markGPUSubCalls(FnSymbol* fn);
   Symbol* addUserVarKernelArgument(Symbol* symInLoop);
   Symbol* maybeAddCompilerGeneratedKernelArgument(Symbol* symInLoop,
@@ -1166,11 +1174,20 @@ GpuKernel::GpuKernel(GpuizableLoop &gpuLoop, DefExpr* insertionPoint)
   , localGlobalThreadIdx_(nullptr)
   , userBody_(nullptr)
   , postBody_(nullptr)
+  , blockStart_(nullptr)
+  , blockDimX_(nullptr)
+  , threadIdxX_(nullptr)
+  , startOffset_(nullptr)
+  , localUpperBound_(nullptr)
+  , oobCond_(nullptr)
 {
   processGpuPrimitivesBlock();
   buildStubOutlinedFunction(insertionPoint);
   normalizeOutlinedFunction();
   populateBody();
+  if (fGpuStageSharedMemory && !lateGpuizationFailure_) {
+    stageReadOnlyArrays();
+  }
   if(!lateGpuizationFailure_) {
     finalize();
   }
@@ -1327,9 +1344,7 @@ FnSymbol* KernelArg::generateFinalReductionWrapper() {
   ret->insertFormalAtTail(outData);
   ret->insertFormalAtTail(outIdx);
 
-  std::string fnToCall = "chpl_gpu_";
-  fnToCall += this->reduceKindFnName();
-  fnToCall += "_reduce";
+  std::string fnToCall = this->finalReduceFnName();
 
   CallExpr* finalReduce = new CallExpr(PRIM_GPU_REDUCE_WRAPPER);
   finalReduce->insertAtTail(new_CStringSymbol(fnToCall.c_str()));
@@ -1381,6 +1396,12 @@ KernelArg::KernelArg(Symbol* symInLoop, GpuKernel* kernel, bool isCompilerGenera
     // class: must be on GPU memory
     // scalar: can be passed as an argument directly
     this->kind_ = GpuArgKind::ADDROF;
+
+    // array data: with unified memory, it can help to have it migrated to
+    // the device before the kernel touches it
+    if (symValType->symbol->hasFlag(FLAG_DATA_CLASS)) {
+      this->kind_ |= GpuArgKind::PREFETCH;
+    }
   }
   else if (symInLoop->isRef()) {
     // ref: we assume that it is not on GPU memory to be safe, so offload it,
@@ -1418,6 +1439,11 @@ KernelArg::KernelArg(Symbol* symInLoop, GpuKernel* kernel, bool isCompilerGenera
   }
 }
 
+// the runtime function that finishes the reduction, without the type suffix
+std::string KernelArg::finalReduceFnName() const {
+  return "chpl_gpu_" + this->reduceKindFnName() + "_reduce";
+}
+
 std::string KernelArg::reduceKindFnName() const {
   switch (this->redInfo_.kind) {
     case ReductionKind::SUM:
@@ -1466,6 +1492,11 @@ CallExpr* KernelArg::generatePrimGpuArg(Symbol* cfg) const {
 
   if (this->isReduce()) {
     ret->insertAtTail(this->redInfo_.wrapper);
+
+    // also tell the runtime what the wrapper calls, so that it can finish
+    // the reductions it knows about together instead
+    ret->insertAtTail(new_CStringSymbol(this->finalReduceFnName().c_str()));
+    ret->insertAtTail(new SymExpr(this->getType()->symbol));
   }
 
   return ret;
@@ -1584,6 +1615,10 @@ void GpuKernel::generateIndexComputation() {
     PRIM_ADD, tempVar, varThreadIdxX));
   fn_->insertAtTail(c2);
 
+  blockStart_ = tempVar;
+  blockDimX_ = varBlockDimX;
+  threadIdxX_ = varThreadIdxX;
+
   if (hasItersPerThread() && blockIPT()) {
     localItersPerThread_ = maybeAddCompilerGeneratedKernelArgument(
                                itersPerThread_, "chpl_itersPerThread");
@@ -1616,6 +1651,7 @@ void GpuKernel::generateIndexComputation() {
     fn_->insertAtTail(new CallExpr(PRIM_MOVE, index, new CallExpr(
       PRIM_ADD, addend, startOffset)));
 
+    if (i == 0) startOffset_ = startOffset;
     kernelIndices_.push_back(index);
     copyMap_.put(loopIndex, index);
   }
@@ -1626,6 +1662,7 @@ void GpuKernel::generateIndexComputation() {
 void GpuKernel::generateOobCond() {
   Symbol* localUpperBound = maybeAddCompilerGeneratedKernelArgument(
                               gpuLoop.upperBound(), "chpl_upperBound");
+  this->localUpperBound_ = localUpperBound;
   this->userBody_ = new BlockStmt();
 
   if (hasItersPerThread()) {
@@ -1657,7 +1694,8 @@ void GpuKernel::generateOobCondNoIPT(Symbol* localUpperBound) {
                                       localUpperBound);
   fn_->insertAtTail(new CallExpr(PRIM_MOVE, isInBounds, comparison));
 
-  fn_->insertAtTail(new CondStmt(new SymExpr(isInBounds), this->userBody_));
+  this->oobCond_ = new CondStmt(new SymExpr(isInBounds), this->userBody_);
+  fn_->insertAtTail(this->oobCond_);
 }
 
 Expr* GpuKernel::generateIptLoopHelp(Symbol* upperBound0, Symbol* increment) {
@@ -1752,6 +1790,439 @@ void GpuKernel::generatePostBody() {
   fn_->insertAtTail(this->postBody_);
 }
 
+// ----------------------------------------------------------------------------
+// Shared-memory staging of read-only arrays
+// ----------------------------------------------------------------------------
+
+// With --gpu-stage-shared-memory, a kernel whose threads read a neighborhood
+// of an array around their own index, as in
+//
+//   foreach i in 1..n-2 do B[i] = A[i-1] + A[i] + A[i+1];
+//
+// has each thread block load the part of 'A' it reads into shared memory
+// first, so that every element comes from global memory once per block
+// rather than once per reading thread:
+//
+//   blockLo = t0 + lowerBound
+//   blockHi = min(blockLo + blockDimX - 1, upperBound)
+//   tile = __primitive('gpu allocShared', (blockSize + halo) * eltSize)
+//   for (t = threadIdxX; t < blockDimX + halo; t += blockDimX)
+//     if some in-bounds thread reads A[blockLo + cmin + t] then
+//       tile[t] = A[blockLo + cmin + t]
+//   __primitive('gpu syncThreads')
+//   if (chpl_is_in_bounds) {
+//     ... A[index + c] becomes tile[index - blockLo + c - cmin] ...
+//   }
+//
+// where cmin is the smallest offset read and halo is the distance from it to
+// the largest. This is limited to
+//   - kernels with a single int(64) index, no itersPerThread and a
+//     compile-time block size,
+//   - reads in the straight-line code that starts the loop body, before
+//     anything the thread writes or calls, whose index is the loop index
+//     plus or minus a literal and whose results are only read, and
+//   - arrays of integers and reals reached from a kernel argument through
+//     field accesses only.
+// Since the loop is order independent, reads that precede the thread's own
+// writes can't observe other iterations' writes either, so loading them
+// early doesn't change what they see.
+
+static const int64_t kMaxStagingHalo = 64;
+static const int64_t kMaxStagingBytes = 48 * 1024;
+
+struct StagedRead {
+  CallExpr* get;    // PRIM_ARRAY_GET in the kernel body
+  int64_t   offset; // the index read, relative to the kernel index
+};
+
+struct StagingCandidate {
+  Symbol*                 base;     // the ddata the reads go through
+  Symbol*                 root;     // kernel argument 'base' is reached from
+  std::vector<CallExpr*>  baseDefs; // moves computing 'base', root first
+  std::vector<StagedRead> reads;
+  const char*             whyNot;
+};
+
+static int64_t stagingElementSize(Type* t) {
+  for (int i = INT_SIZE_8; i < INT_SIZE_NUM; i++) {
+    if (t == dtInt[i] || t == dtUInt[i]) {
+      return int64_t(1) << i;
+    }
+  }
+  if (t == dtReal[FLOAT_SIZE_32]) return 4;
+  if (t == dtReal[FLOAT_SIZE_64]) return 8;
+  return 0;
+}
+
+static bool isStagingLiteral(Symbol* sym, int64_t* val) {
+  VarSymbol* var = toVarSymbol(sym);
+  if (var == nullptr || var->immediate == nullptr ||
+      var->immediate->const_kind != NUM_KIND_INT) {
+    return false;
+  }
+  *val = var->immediate->int_value();
+  return true;
+}
+
+// the result of an array access may only be loaded from
+static bool isOnlyLoadedFrom(Symbol* ref) {
+  for_SymbolUses(use, ref) {
+    CallExpr* parent = toCallExpr(use->parentExpr);
+    if (parent == nullptr) return false;
+    if (parent->isPrimitive(PRIM_DEREF)) continue;
+    if (parent->isPrimitive(PRIM_MOVE) && use == parent->get(2) &&
+        !toSymExpr(parent->get(1))->symbol()->isRef()) {
+      continue;
+    }
+    return false;
+  }
+  return true;
+}
+
+static void reportStaging(CForLoop* loop, const StagingCandidate& cand,
+                          int64_t halo) {
+  if (!fReportGpuSharedStaging) return;
+  if (!developer && loop->getModule()->modTag != MOD_USER) return;
+
+  if (cand.whyNot != nullptr) {
+    printf("%s: not staged in shared memory: '%s' (%s)\n",
+           loop->stringLoc(), cand.root->name, cand.whyNot);
+  } else {
+    printf("%s: staged in shared memory: '%s' (%d reads, halo %d)\n",
+           loop->stringLoc(), cand.root->name, (int)cand.reads.size(),
+           (int)halo);
+  }
+}
+
+static bool hasNoDefs(Symbol* sym) {
+  for_SymbolDefs(def, sym) {
+    return false;
+  }
+  return true;
+}
+
+// Find the arrays read at several offsets from the kernel index in the
+// straight-line code that starts the body.
+static std::vector<StagingCandidate> findStagingCandidates(FnSymbol* kernel,
+                                                           BlockStmt* body,
+                                                           Symbol* index) {
+  std::map<Symbol*, int64_t> offsetOf;
+  std::map<Symbol*, CallExpr*> invariantDef;
+  std::map<Symbol*, Symbol*> rootOf;
+  std::vector<StagingCandidate> ret;
+
+  offsetOf[index] = 0;
+
+  auto isInvariant = [&](Symbol* sym) {
+    if (ArgSymbol* formal = toArgSymbol(sym)) {
+      return formal->defPoint->parentSymbol == kernel && hasNoDefs(formal);
+    }
+    return invariantDef.count(sym) != 0;
+  };
+
+  bool stop = false;
+  for_alist(stmt, body->body) {
+    if (isDefExpr(stmt)) continue;
+
+    CallExpr* move = toCallExpr(stmt);
+    if (move == nullptr || !move->isPrimitive(PRIM_MOVE)) break;
+
+    Symbol* lhs = toSymExpr(move->get(1))->symbol();
+    if (lhs->defPoint->parentExpr != body || lhs->getSingleDef() == nullptr) {
+      break;
+    }
+
+    if (SymExpr* rhs = toSymExpr(move->get(2))) {
+      if (offsetOf.count(rhs->symbol()) && lhs->type == index->type) {
+        offsetOf[lhs] = offsetOf[rhs->symbol()];
+      }
+      continue;
+    }
+
+    CallExpr* rhs = toCallExpr(move->get(2));
+    if (rhs == nullptr || !rhs->isPrimitive()) break;
+
+    SymExpr* arg1 = rhs->numActuals() >= 1 ? toSymExpr(rhs->get(1)) : nullptr;
+    SymExpr* arg2 = rhs->numActuals() >= 2 ? toSymExpr(rhs->get(2)) : nullptr;
+    int64_t literal = 0;
+
+    switch (rhs->primitive->tag) {
+    case PRIM_ADD:
+    case PRIM_SUBTRACT:
+      if (arg1 && offsetOf.count(arg1->symbol()) &&
+          arg2 && isStagingLiteral(arg2->symbol(), &literal) &&
+          lhs->type == index->type) {
+        int64_t sign = rhs->isPrimitive(PRIM_ADD) ? 1 : -1;
+        offsetOf[lhs] = offsetOf[arg1->symbol()] + sign * literal;
+      } else if (rhs->isPrimitive(PRIM_ADD) && arg2 &&
+                 offsetOf.count(arg2->symbol()) &&
+                 arg1 && isStagingLiteral(arg1->symbol(), &literal) &&
+                 lhs->type == index->type) {
+        offsetOf[lhs] = offsetOf[arg2->symbol()] + literal;
+      }
+      break;
+
+    case PRIM_CAST:
+      // only casts that don't change the value
+      if (arg2 && offsetOf.count(arg2->symbol()) &&
+          lhs->type == index->type) {
+        offsetOf[lhs] = offsetOf[arg2->symbol()];
+      }
+      break;
+
+    case PRIM_GET_MEMBER_VALUE:
+      if (arg1 && isInvariant(arg1->symbol()) && !lhs->isRef()) {
+        invariantDef[lhs] = move;
+        rootOf[lhs] = rootOf.count(arg1->symbol()) ? rootOf[arg1->symbol()]
+                                                   : arg1->symbol();
+      }
+      break;
+
+    case PRIM_ARRAY_GET:
+      if (arg1 && arg2 && isInvariant(arg1->symbol()) &&
+          offsetOf.count(arg2->symbol()) && lhs->isRef()) {
+        Symbol* base = arg1->symbol();
+        StagingCandidate* cand = nullptr;
+        for (auto& c : ret) {
+          if (c.base == base) cand = &c;
+        }
+        if (cand == nullptr) {
+          StagingCandidate newCand;
+          newCand.base = base;
+          newCand.root = rootOf.count(base) ? rootOf[base] : base;
+          newCand.whyNot = nullptr;
+          for (Symbol* sym = base; invariantDef.count(sym); ) {
+            CallExpr* def = invariantDef[sym];
+            newCand.baseDefs.insert(newCand.baseDefs.begin(), def);
+            sym = toSymExpr(toCallExpr(def->get(2))->get(1))->symbol();
+          }
+          ret.push_back(newCand);
+          cand = &ret.back();
+        }
+        cand->reads.push_back({rhs, offsetOf[arg2->symbol()]});
+      }
+      break;
+
+    case PRIM_MULT:
+    case PRIM_DIV:
+    case PRIM_UNARY_MINUS:
+    case PRIM_DEREF:
+    case PRIM_GET_MEMBER:
+    case PRIM_LESS:
+    case PRIM_LESSOREQUAL:
+    case PRIM_GREATER:
+    case PRIM_GREATEROREQUAL:
+    case PRIM_EQUAL:
+    case PRIM_NOTEQUAL:
+      // reads nothing the thread could have written yet
+      break;
+
+    default:
+      stop = true;
+      break;
+    }
+
+    if (stop) break;
+  }
+
+  return ret;
+}
+
+void GpuKernel::stageReadOnlyArrays() {
+  if (hasItersPerThread() || kernelIndices_.size() != 1 ||
+      oobCond_ == nullptr) {
+    return;
+  }
+
+  Symbol* index = kernelIndices_[0];
+  std::vector<StagingCandidate> cands =
+    findStagingCandidates(fn_, userBody_, index);
+
+  int64_t blockSize = 0;
+  bool knownBlockSize = isStagingLiteral(blockSize_, &blockSize) &&
+                        blockSize > 0;
+  bool int64Bounds = index->type == dtInt[INT_SIZE_64] &&
+                     startOffset_->type == dtInt[INT_SIZE_64] &&
+                     localUpperBound_->type == dtInt[INT_SIZE_64];
+
+  SET_LINENO(oobCond_);
+  BlockStmt* staging = new BlockStmt();
+  VarSymbol* blockLo = nullptr;
+  VarSymbol* blockHi = nullptr;
+  bool anyStaged = false;
+
+  for (auto& cand : cands) {
+    int64_t cmin = 0, cmax = 0;
+    std::set<int64_t> offsets;
+    for (auto& read : cand.reads) {
+      offsets.insert(read.offset);
+    }
+
+    // only report arrays that would have benefited
+    if (offsets.size() < 2) continue;
+
+    cmin = *offsets.begin();
+    cmax = *offsets.rbegin();
+    int64_t halo = cmax - cmin;
+
+    Type* eltType = nullptr;
+    if (cand.base->type->symbol->hasFlag(FLAG_DATA_CLASS)) {
+      eltType = getDataClassType(cand.base->type->symbol)->type;
+    }
+    int64_t eltSize = eltType ? stagingElementSize(eltType) : 0;
+
+    if (!knownBlockSize) {
+      cand.whyNot = "block size is not known at compile time";
+    } else if (!int64Bounds) {
+      cand.whyNot = "loop index is not an int(64)";
+    } else if (eltSize == 0) {
+      cand.whyNot = "element type is not an integer or real";
+    } else if (halo > kMaxStagingHalo) {
+      cand.whyNot = "offsets are too far apart";
+    } else if ((blockSize + halo) * eltSize > kMaxStagingBytes) {
+      cand.whyNot = "too large for shared memory";
+    } else {
+      for (auto& read : cand.reads) {
+        CallExpr* move = toCallExpr(read.get->parentExpr);
+        if (!isOnlyLoadedFrom(toSymExpr(move->get(1))->symbol())) {
+          cand.whyNot = "an element read is also written through";
+        }
+      }
+    }
+
+    reportStaging(gpuLoop.loop(), cand, halo);
+    if (cand.whyNot != nullptr) continue;
+
+    if (blockLo == nullptr) {
+      blockLo = insertNewVarAndDef(staging, "chpl_shared_blockLo",
+                                   dtInt[INT_SIZE_64]);
+      staging->insertAtTail("'move'(%S,'+'(%S,%S))",
+                            blockLo, blockStart_, startOffset_);
+      VarSymbol* blockLast = insertNewVarAndDef(staging,
+                                                "chpl_shared_blockLast",
+                                                dtInt[INT_SIZE_64]);
+      staging->insertAtTail("'move'(%S,'+'(%S,%S))",
+                            blockLast, blockLo, blockDimX_);
+      staging->insertAtTail("'move'(%S,'-'(%S,%S))",
+                            blockLast, blockLast, new_IntSymbol(1));
+      blockHi = insertNewVarAndDef(staging, "chpl_shared_blockHi",
+                                   dtInt[INT_SIZE_64]);
+      staging->insertAtTail("'move'(%S,%S)", blockHi, blockLast);
+      VarSymbol* clip = insertNewVarAndDef(staging, "chpl_shared_clip",
+                                           dtBool);
+      staging->insertAtTail("'move'(%S,'<'(%S,%S))",
+                            clip, localUpperBound_, blockLast);
+      BlockStmt* clipBlock = new BlockStmt();
+      clipBlock->insertAtTail("'move'(%S,%S)", blockHi, localUpperBound_);
+      staging->insertAtTail(new CondStmt(new SymExpr(clip), clipBlock));
+    }
+
+    // recompute the array's data before the bounds check, so that all the
+    // threads of the block can take part in loading it
+    SymbolMap baseMap;
+    for_vector(CallExpr, def, cand.baseDefs) {
+      Symbol* lhs = toSymExpr(def->get(1))->symbol();
+      VarSymbol* newLhs = insertNewVarAndDef(staging, lhs->name, lhs->type);
+      baseMap.put(lhs, newLhs);
+      staging->insertAtTail(def->copy(&baseMap));
+    }
+    Symbol* base = baseMap.get(cand.base) ? baseMap.get(cand.base)
+                                          : cand.base;
+
+    VarSymbol* tile = insertNewVarAndDef(staging, "chpl_shared_tile",
+                                         cand.base->type);
+    int64_t bytes = (blockSize + halo) * eltSize;
+    staging->insertAtTail(new CallExpr(PRIM_MOVE, tile,
+                            new CallExpr(PRIM_CAST, cand.base->type->symbol,
+                              new CallExpr(PRIM_GPU_ALLOC_SHARED,
+                                           new_IntSymbol(bytes)))));
+
+    // the threads of the block load the tile cooperatively
+    VarSymbol* t = insertNewVarAndDef(staging, "chpl_shared_t",
+                                      dtInt[INT_SIZE_64]);
+    staging->insertAtTail(new CallExpr(PRIM_MOVE, t,
+                            new CallExpr(PRIM_CAST,
+                                         dtInt[INT_SIZE_64]->symbol,
+                                         threadIdxX_)));
+    VarSymbol* tileLen = insertNewVarAndDef(staging, "chpl_shared_len",
+                                            dtInt[INT_SIZE_64]);
+    staging->insertAtTail("'move'(%S,'+'(%S,%S))",
+                          tileLen, blockDimX_, new_IntSymbol(halo));
+    VarSymbol* whileVar = insertNewVarAndDef(staging, "chpl_shared_more",
+                                             dtBool);
+    Expr* whileExpr = new_Expr("'move'(%S,'<'(%S,%S))",
+                               whileVar, t, tileLen);
+    staging->insertAtTail(whileExpr);
+
+    BlockStmt* loadBody = new BlockStmt();
+    VarSymbol* j = insertNewVarAndDef(loadBody, "chpl_shared_j",
+                                      dtInt[INT_SIZE_64]);
+    loadBody->insertAtTail("'move'(%S,'+'(%S,%S))", j, blockLo, t);
+    loadBody->insertAtTail("'move'(%S,'+'(%S,%S))",
+                           j, j, new_IntSymbol(cmin));
+
+    // is j read by some thread in bounds?
+    VarSymbol* need = insertNewVarAndDef(loadBody, "chpl_shared_need",
+                                         dtBool);
+    loadBody->insertAtTail("'move'(%S,%S)", need, gFalse);
+    VarSymbol* reader = insertNewVarAndDef(loadBody, "chpl_shared_reader",
+                                           dtInt[INT_SIZE_64]);
+    VarSymbol* above = insertNewVarAndDef(loadBody, "chpl_shared_above",
+                                          dtBool);
+    VarSymbol* below = insertNewVarAndDef(loadBody, "chpl_shared_below",
+                                          dtBool);
+    for (int64_t c : offsets) {
+      loadBody->insertAtTail("'move'(%S,'-'(%S,%S))",
+                             reader, j, new_IntSymbol(c));
+      loadBody->insertAtTail("'move'(%S,'>='(%S,%S))",
+                             above, reader, blockLo);
+      loadBody->insertAtTail("'move'(%S,'<='(%S,%S))",
+                             below, reader, blockHi);
+      loadBody->insertAtTail("'move'(%S,'&'(%S,%S))", above, above, below);
+      loadBody->insertAtTail("'move'(%S,'|'(%S,%S))", need, need, above);
+    }
+
+    BlockStmt* loadBlock = new BlockStmt();
+    CallExpr* firstRead = toCallExpr(cand.reads[0].get->parentExpr);
+    VarSymbol* eltRef = insertNewVarAndDef(loadBlock, "chpl_shared_ref",
+                            toSymExpr(firstRead->get(1))->symbol()->type);
+    loadBlock->insertAtTail(new CallExpr(PRIM_MOVE, eltRef,
+                              new CallExpr(PRIM_ARRAY_GET, base, j)));
+    VarSymbol* elt = insertNewVarAndDef(loadBlock, "chpl_shared_elt",
+                                        eltType);
+    loadBlock->insertAtTail(new CallExpr(PRIM_MOVE, elt,
+                              new CallExpr(PRIM_DEREF, eltRef)));
+    loadBlock->insertAtTail(new CallExpr(PRIM_ARRAY_SET, tile, t, elt));
+    loadBody->insertAtTail(new CondStmt(new SymExpr(need), loadBlock));
+
+    loadBody->insertAtTail("'move'(%S,'+'(%S,%S))", t, t, blockDimX_);
+    loadBody->insertAtTail(whileExpr->copy());
+    staging->insertAtTail(new WhileDoStmt(new SymExpr(whileVar), loadBody));
+
+    // read the tile instead
+    for (auto& read : cand.reads) {
+      Expr* stmt = read.get->getStmtExpr();
+      VarSymbol* tileIdx = new VarSymbol("chpl_shared_idx",
+                                         dtInt[INT_SIZE_64]);
+      stmt->insertBefore(new DefExpr(tileIdx));
+      stmt->insertBefore("'move'(%S,'-'(%S,%S))", tileIdx, index, blockLo);
+      stmt->insertBefore("'move'(%S,'+'(%S,%S))", tileIdx, tileIdx,
+                         new_IntSymbol(read.offset - cmin));
+      read.get->get(1)->replace(new SymExpr(tile));
+      read.get->get(2)->replace(new SymExpr(tileIdx));
+    }
+
+    anyStaged = true;
+  }
+
+  if (!anyStaged) return;
+
+  // every thread of the block reaches this, in bounds or not
+  staging->insertAtTail(new CallExpr(PRIM_GPU_SYNC_THREADS));
+  oobCond_->insertBefore(staging);
+  staging->flattenAndRemove();
+}
+
 // Returns the GPU primitives block within 'body', or null if none.
 // Note: this searches inside nested loops - needed for multi-dim arrays, ex:
 //   var A: [1..n,1..n] int;
@@ -2357,6 +2828,359 @@ static void outlineGpuKernelsInFn(FnSymbol *fn) {
   }
 }
 
+// ----------------------------------------------------------------------------
+// Fusion of adjacent gpuizable loops
+// ----------------------------------------------------------------------------
+
+// With --gpu-fuse-kernels, a gpuizable loop that follows another one over
+// the same indices is merged into it, so that they become a single kernel:
+//
+//   for (i = lo; i <= hi; i += 1) { B[i] = A[i] * 2; }
+//   for (j = lo; j <= hi; j += 1) { C[j] = B[j] + 1; }
+//
+// becomes
+//
+//   for (i = lo; i <= hi; i += 1) { B[i] = A[i] * 2; C[i] = B[i] + 1; }
+//
+// This is only done when each loop touches memory element-wise: arrays are
+// only accessed at the loop's own index, through '_ddata' (so views that
+// preserve indices, like slices, still see the same element at the same
+// index), nothing declared outside the loop is written, and no functions are
+// called. Then iteration i of the second loop can only depend on iteration i
+// of the first one, which the fused loop runs right before it. Statements
+// between the loops are allowed if they only compute new values from ones
+// the first loop can't change; they are moved ahead of it.
+//
+// Intermediate arrays are kept: whether they are dead after the loops isn't
+// known here, and their allocation is managed by module code.
+
+// Does 'loop' only access arrays at its own index and write nothing but its
+// own variables and those elements?
+static bool isElementwiseLoop(CForLoop* loop, Symbol* idx) {
+  std::vector<CallExpr*> calls;
+  for_alist(stmt, loop->body) {
+    collectCallExprs(stmt, calls);
+  }
+
+  std::set<Symbol*> idxCopies;
+  std::set<Symbol*> elemRefs;
+  idxCopies.insert(idx);
+
+  // find the copies of the index and the references to elements at it
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for_vector(CallExpr, call, calls) {
+      if (!call->isPrimitive(PRIM_MOVE)) continue;
+      Symbol* lhs = toSymExpr(call->get(1))->symbol();
+      if (!isDefinedInTheLoop(lhs, loop) || lhs->getSingleDef() == nullptr ||
+          idxCopies.count(lhs) || elemRefs.count(lhs)) {
+        continue;
+      }
+
+      Expr* rhs = call->get(2);
+      CallExpr* rhsCall = toCallExpr(rhs);
+      if (rhsCall && rhsCall->isPrimitive(PRIM_CAST)) {
+        rhs = rhsCall->get(2);
+        rhsCall = nullptr;
+      }
+
+      if (SymExpr* rhsSe = toSymExpr(rhs)) {
+        if (idxCopies.count(rhsSe->symbol()) && lhs->type == idx->type) {
+          idxCopies.insert(lhs);
+          changed = true;
+        }
+      } else if (rhsCall && rhsCall->isPrimitive(PRIM_ARRAY_GET) &&
+                 lhs->isRef()) {
+        SymExpr* index = toSymExpr(rhsCall->get(2));
+        if (index && idxCopies.count(index->symbol())) {
+          elemRefs.insert(lhs);
+          changed = true;
+        }
+      }
+    }
+  }
+
+  for_vector(CallExpr, call, calls) {
+    if (!call->isPrimitive()) return false;  // a call to a function
+
+    switch (call->primitive->tag) {
+    case PRIM_MOVE:
+    case PRIM_ASSIGN:
+    case PRIM_ADD_ASSIGN:
+    case PRIM_SUBTRACT_ASSIGN:
+    case PRIM_MULT_ASSIGN:
+    case PRIM_DIV_ASSIGN: {
+      SymExpr* lhsSe = toSymExpr(call->get(1));
+      if (lhsSe == nullptr) return false;
+      Symbol* lhs = lhsSe->symbol();
+      if (lhs->isRef() && !call->isPrimitive(PRIM_MOVE)) {
+        // writes through a reference must be to an element at the index
+        if (elemRefs.count(lhs) == 0) return false;
+      } else if (!isDefinedInTheLoop(lhs, loop)) {
+        return false;
+      }
+      break;
+    }
+
+    case PRIM_ARRAY_GET:
+    case PRIM_ARRAY_SET:
+    case PRIM_ARRAY_SET_FIRST: {
+      SymExpr* base = toSymExpr(call->get(1));
+      SymExpr* index = toSymExpr(call->get(2));
+      if (base == nullptr || index == nullptr ||
+          !base->symbol()->getValType()->symbol->hasFlag(FLAG_DATA_CLASS) ||
+          idxCopies.count(index->symbol()) == 0) {
+        return false;
+      }
+      break;
+    }
+
+    case PRIM_ADD:
+    case PRIM_SUBTRACT:
+    case PRIM_MULT:
+    case PRIM_DIV:
+    case PRIM_MOD:
+    case PRIM_UNARY_MINUS:
+    case PRIM_UNARY_PLUS:
+    case PRIM_UNARY_NOT:
+    case PRIM_UNARY_LNOT:
+    case PRIM_LSH:
+    case PRIM_RSH:
+    case PRIM_AND:
+    case PRIM_OR:
+    case PRIM_XOR:
+    case PRIM_EQUAL:
+    case PRIM_NOTEQUAL:
+    case PRIM_LESS:
+    case PRIM_LESSOREQUAL:
+    case PRIM_GREATER:
+    case PRIM_GREATEROREQUAL:
+    case PRIM_CAST:
+    case PRIM_DEREF:
+    case PRIM_GET_MEMBER:
+    case PRIM_GET_MEMBER_VALUE:
+    case PRIM_END_OF_STATEMENT:
+      break;
+
+    default:
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// Do 'a' and 'b' have the same value where both loops start? 'a' and 'b' may
+// be different symbols computed the same way.
+static bool isSameLoopValue(Symbol* a, Symbol* b, int depth = 0);
+
+static bool isSameLoopExpr(Expr* a, Expr* b, int depth) {
+  if (SymExpr* seA = toSymExpr(a)) {
+    SymExpr* seB = toSymExpr(b);
+    return seB && isSameLoopValue(seA->symbol(), seB->symbol(), depth);
+  }
+
+  CallExpr* callA = toCallExpr(a);
+  CallExpr* callB = toCallExpr(b);
+  if (callA == nullptr || callB == nullptr ||
+      !callA->isPrimitive() || callA->primitive != callB->primitive ||
+      callA->numActuals() != callB->numActuals()) {
+    return false;
+  }
+
+  switch (callA->primitive->tag) {
+  case PRIM_ADD:
+  case PRIM_SUBTRACT:
+  case PRIM_MULT:
+  case PRIM_CAST:
+  case PRIM_GET_MEMBER_VALUE:
+    break;
+  default:
+    return false;
+  }
+
+  for (int i = 1; i <= callA->numActuals(); i++) {
+    if (!isSameLoopExpr(callA->get(i), callB->get(i), depth)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool isSameLoopValue(Symbol* a, Symbol* b, int depth) {
+  if (a == b) return true;
+  if (depth > 4) return false;
+
+  SymExpr* defA = a->getSingleDef();
+  SymExpr* defB = b->getSingleDef();
+  if (defA == nullptr || defB == nullptr) return false;
+
+  CallExpr* moveA = toCallExpr(defA->parentExpr);
+  CallExpr* moveB = toCallExpr(defB->parentExpr);
+  if (moveA == nullptr || !moveA->isPrimitive(PRIM_MOVE) ||
+      moveB == nullptr || !moveB->isPrimitive(PRIM_MOVE)) {
+    return false;
+  }
+
+  return isSameLoopExpr(moveA->get(2), moveB->get(2), depth + 1);
+}
+
+// Can 'stmt', found between two loops, be moved ahead of the first one?
+// 'defs' has the variables declared between them so far.
+static bool isHoistableAcrossLoop(Expr* stmt, std::set<Symbol*>& defs) {
+  if (DefExpr* def = toDefExpr(stmt)) {
+    if (!isVarSymbol(def->sym)) return false;
+    defs.insert(def->sym);
+    return true;
+  }
+
+  CallExpr* move = toCallExpr(stmt);
+  if (move == nullptr || !move->isPrimitive(PRIM_MOVE) ||
+      defs.count(toSymExpr(move->get(1))->symbol()) == 0) {
+    return false;
+  }
+
+  if (isSymExpr(move->get(2))) return true;
+
+  CallExpr* rhs = toCallExpr(move->get(2));
+  if (rhs == nullptr || !rhs->isPrimitive()) return false;
+
+  switch (rhs->primitive->tag) {
+  case PRIM_ADD:
+  case PRIM_SUBTRACT:
+  case PRIM_MULT:
+  case PRIM_CAST:
+  case PRIM_LESS:
+  case PRIM_LESSOREQUAL:
+  case PRIM_EQUAL:
+  case PRIM_NOTEQUAL:
+    break;
+  case PRIM_GET_MEMBER_VALUE:
+    // not through a reference, which might be into an array
+    if (rhs->get(1)->isRef()) return false;
+    break;
+  default:
+    return false;
+  }
+
+  for_actuals(actual, rhs) {
+    if (!isSymExpr(actual)) return false;
+  }
+  return true;
+}
+
+// Find the loop that 'loop' can be fused with, collecting the statements
+// between them in 'between'.
+static CForLoop* findLoopToFuseWith(CForLoop* loop,
+                                    std::vector<Expr*>& between) {
+  std::set<Symbol*> defs;
+
+  for (Expr* stmt = loop->next; stmt != nullptr; stmt = stmt->next) {
+    if (CForLoop* next = toCForLoop(stmt)) {
+      return next;
+    }
+
+    // the next loop may be at the start of the following block
+    BlockStmt* block = toBlockStmt(stmt);
+    if (block != nullptr && block->isRealBlockStmt() && !block->isLoopStmt() &&
+        block->blockInfoGet() == nullptr) {
+      for_alist(inner, block->body) {
+        if (CForLoop* next = toCForLoop(inner)) {
+          return next;
+        }
+        if (!isHoistableAcrossLoop(inner, defs)) {
+          return nullptr;
+        }
+        between.push_back(inner);
+      }
+      return nullptr;
+    }
+
+    if (!isHoistableAcrossLoop(stmt, defs)) {
+      return nullptr;
+    }
+    between.push_back(stmt);
+  }
+
+  return nullptr;
+}
+
+static bool isSameLoopHeader(CForLoop* first, Symbol* firstIdx,
+                             CForLoop* second, Symbol* secondIdx) {
+  BlockStmt* incrA = first->incrBlockGet();
+  BlockStmt* incrB = second->incrBlockGet();
+  if (incrA->body.length != 1 || incrB->body.length != 1) return false;
+
+  CallExpr* incA = toCallExpr(incrA->body.head);
+  CallExpr* incB = toCallExpr(incrB->body.head);
+  if (incA == nullptr || incB == nullptr ||
+      !incA->isPrimitive(PRIM_ADD_ASSIGN) ||
+      !incB->isPrimitive(PRIM_ADD_ASSIGN)) {
+    return false;
+  }
+
+  return toSymExpr(incA->get(1))->symbol() == firstIdx &&
+         toSymExpr(incB->get(1))->symbol() == secondIdx &&
+         isSameLoopExpr(incA->get(2), incB->get(2), 0);
+}
+
+static bool tryFuseGpuizableLoops(CForLoop* first) {
+  std::vector<Expr*> between;
+  CForLoop* second = findLoopToFuseWith(first, between);
+  if (second == nullptr) return false;
+
+  GpuizableLoop firstLoop(first);
+  if (!firstLoop.isEligible() || firstLoop.loopIndices().size() != 1) {
+    return false;
+  }
+  Symbol* firstIdx = firstLoop.loopIndices()[0];
+  if (!isElementwiseLoop(first, firstIdx)) return false;
+
+  // the checks above rule out attributes, whose primitives are not
+  // element-wise, so building this doesn't consume any of this loop's
+  GpuizableLoop secondLoop(second);
+  if (!secondLoop.isEligible() || secondLoop.loopIndices().size() != 1) {
+    return false;
+  }
+  Symbol* secondIdx = secondLoop.loopIndices()[0];
+  if (!isElementwiseLoop(second, secondIdx) ||
+      !isSameLoopHeader(first, firstIdx, second, secondIdx) ||
+      !isSameLoopValue(firstLoop.lowerBounds()[0],
+                       secondLoop.lowerBounds()[0]) ||
+      !isSameLoopValue(firstLoop.upperBound(), secondLoop.upperBound())) {
+    return false;
+  }
+
+  SET_LINENO(first);
+
+  for_vector(Expr, stmt, between) {
+    first->insertBefore(stmt->remove());
+  }
+
+  SymbolMap map;
+  map.put(secondIdx, firstIdx);
+  for_alist(stmt, second->body) {
+    first->insertAtTail(stmt->remove());
+    update_symbols(stmt, &map);
+  }
+  second->remove();
+
+  return true;
+}
+
+static void fuseGpuizableLoopsInFn(FnSymbol* fn) {
+  std::vector<CForLoop*> loops;
+  collectCForLoopStmtsPreorder(fn, loops);
+
+  for_vector(CForLoop, loop, loops) {
+    if (!loop->inTree()) continue;
+    while (tryFuseGpuizableLoops(loop)) {
+      // keep fusing the loops that follow
+    }
+  }
+}
+
 // We need to strip any GPU specific primitives that remain
 static void cleanupForeachLoopsGuaranteedToRunOnCpu(FnSymbol *fn) {
   std::vector<CForLoop*> asts;
@@ -2383,6 +3207,10 @@ static void doGpuTransforms() {
       // will be run on the CPU:
       cleanupForeachLoopsGuaranteedToRunOnCpu(fn);
     } else {
+      if (fGpuFuseKernels) {
+        fuseGpuizableLoopsInFn(fn);
+      }
+
       outlineGpuKernelsInFn(fn);
 
       // All eligible loops in the function will have been outlined into
@@ -819,6 +819,53 @@ static bool computeAliases(FnSymbol* fn, std::map<Symbol*, std::set<Symbol*> >&
   return false;
 }
 
+/*
+ * In an on statement, references usually point to memory on another locale,
+ * so loads through them are remote reads. Normally anything passed in by ref
+ * is assumed to be changed elsewhere, which keeps those loads in the loop.
+ * But if the loop doesn't call anything, contains no fences, and writes only
+ * to non-ref locals of the function, nothing in the loop can change the
+ * memory a reference points to. Any other task that changed it would need
+ * synchronization, which canPerformCodeMotion has already ruled out. Then
+ * loads through references are invariant and can be hoisted. After
+ * insertWideReferences they become one GET before the loop, for a field or
+ * for a whole record.
+ */
+static bool loopOnlyWritesLocals(Loop* loop, FnSymbol* fn,
+                                 symToVecSymExprMap& localDefMap) {
+  if (!fHoistRemoteLoads || !fn->hasFlag(FLAG_ON)) {
+    return false;
+  }
+
+  for_vector(BasicBlock, block, *loop->getBlocks()) {
+    for_vector(Expr, expr, block->exprs) {
+      std::vector<CallExpr*> calls;
+      collectCallExprs(expr, calls);
+      for_vector(CallExpr, call, calls) {
+        if (call->primitive == NULL ||
+            !(isLoopInvariantPrimitive(call->primitive) ||
+              call->isPrimitive(PRIM_CAST) ||
+              call->isPrimitive(PRIM_ARRAY_GET))) {
+          return false;
+        }
+      }
+    }
+  }
+
+  symToVecSymExprMap::iterator it;
+  for (it = localDefMap.begin(); it != localDefMap.end(); it++) {
+    if (it->second == NULL || it->second->size() == 0) {
+      continue;
+    }
+    VarSymbol* var = toVarSymbol(it->first);
+    if (var == NULL || var->isRef() || var->defPoint->parentSymbol != fn) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
 /*
  * The basic algorithm will be to find all of the constants, and then find things that
  * have no definitions in the loop. We also need to consider a symbols aliases when we're
@@ -830,7 +877,7 @@ static bool computeAliases(FnSymbol* fn, std::map<Symbol*, std::set<Symbol*> >&
  */
 static void computeLoopInvariants(std::vector<SymExpr*>& loopInvariants,
     std::set<Symbol*>& defsInLoop, Loop* loop, symToVecSymExprMap& localDefMap,
-    std::map<Symbol*, std::set<Symbol*> >& aliases) {
+    std::map<Symbol*, std::set<Symbol*> >& aliases, bool refsAreInvariant) {
 
   // collect all of the symExprs, defExprs, and callExprs in the loop
   startTimer(collectSymExprAndDefTimer);
@@ -979,6 +1026,11 @@ static void computeLoopInvariants(std::vector<SymExpr*>& loopInvariants,
           mightHaveBeenDeffedElseWhere = true;
         }
       }
+      // nothing in the loop can write through a reference, or call
+      // something that might; see loopOnlyWritesLocals
+      if (refsAreInvariant && callsInLoop.size() == 0) {
+        mightHaveBeenDeffedElseWhere = false;
+      }
     }
     //if there were no defs of the symbol, it is invariant
     if(actualDefs.count(symExpr) == 0 && !mightHaveBeenDeffedElseWhere) {
@@ -1263,7 +1315,8 @@ static void licmFn(FnSymbol* fn) {
     if (tooManyAliases) {
       return;
     }
-    computeLoopInvariants(loopInvariants, defsInLoop, curLoop, localDefMap, aliases);
+    bool refsAreInvariant = loopOnlyWritesLocals(curLoop, fn, localDefMap);
+    computeLoopInvariants(loopInvariants, defsInLoop, curLoop, localDefMap, aliases, refsAreInvariant);
     stopTimer(computeLoopInvariantsTimer);
 
     //For each invariant, only move it if its def, dominates all uses and all exits
@@ -1298,6 +1351,69 @@ static void licmFn(FnSymbol* fn) {
   }
 }
 
+/*
+ * Vectorizable C for loops come from foreach loops and the leaf loops of the
+ * standard iterators. Their test compares the index with a bound that is
+ * often reached through a reference, like the high bound of a range, and the
+ * generic analysis above must assume anything in the body may change it. A
+ * bound read again on each iteration keeps LLVM from computing a trip count,
+ * and so from vectorizing. If the bound is a const, or a reference to
+ * something immutable, it can't change while the loop runs. In that case
+ * read it once into a temp before the loop.
+ */
+static Symbol* getUnchangingLoopBound(Expr* e) {
+  SymExpr* se = toSymExpr(e);
+
+  if (CallExpr* deref = toCallExpr(e)) {
+    if (deref->isPrimitive(PRIM_DEREF)) {
+      se = toSymExpr(deref->get(1));
+    }
+  }
+
+  if (se == NULL || isModuleSymbol(se->symbol()->defPoint->parentSymbol)) {
+    return NULL;
+  }
+
+  Symbol* sym = se->symbol();
+  if (sym->isImmediate() || sym->isConstValWillNotChange() ||
+      sym->hasFlag(FLAG_REF_TO_IMMUTABLE)) {
+    return sym;
+  }
+  return NULL;
+}
+
+static void hoistCForLoopBound(CForLoop* loop) {
+  BlockStmt* testBlock = loop->testBlockGet();
+  if (testBlock == NULL || testBlock->body.length != 1) {
+    return;
+  }
+
+  CallExpr* test = toCallExpr(testBlock->body.only());
+  if (test == NULL || !isRelationalOperator(test) ||
+      test->numActuals() != 2 || !isSymExpr(test->get(1))) {
+    return;
+  }
+
+  Expr* boundExpr = test->get(2);
+  Symbol* bound = getUnchangingLoopBound(boundExpr);
+  if (bound == NULL || bound->isImmediate() ||
+      (isSymExpr(boundExpr) && !bound->isRef())) {
+    // values that aren't in memory are already cheap to re-read
+    return;
+  }
+
+  SET_LINENO(loop);
+
+  VarSymbol* tmp = newTemp("chpl_loopBound", bound->getValType());
+  Expr* value = isSymExpr(boundExpr) ?
+                new CallExpr(PRIM_DEREF, new SymExpr(bound)) :
+                boundExpr->copy();
+
+  loop->insertBefore(new DefExpr(tmp));
+  loop->insertBefore(new CallExpr(PRIM_MOVE, tmp, value));
+  boundExpr->replace(new SymExpr(tmp));
+}
+
 static void loopInvariantCodeMotionImpl(void) {
   if(fNoLoopInvariantCodeMotion) {
     return;
@@ -1305,6 +1421,16 @@ static void loopInvariantCodeMotionImpl(void) {
 
   startTimer(overallTimer);
 
+  if (!fNoVectorize) {
+    forv_Vec(BlockStmt, block, gBlockStmts) {
+      if (CForLoop* loop = toCForLoop(block)) {
+        if (loop->inTree() && loop->isVectorizable()) {
+          hoistCForLoopBound(loop);
+        }
+      }
+    }
+  }
+
   //TODO use stl routine here
   forv_Vec(FnSymbol, fn, gFnSymbols) {
     licmFn(fn);
@@ -1360,6 +1486,10 @@ void loopInvariantCodeMotion(void) {
   // optimize certain statements in foralls to unordered
   optimizeForallUnorderedOps();
 
+  // fold the parts of array offset computations known from the module
+  // code, so that LICM has less to hoist
+  specializeRectangularAccess();
+
   loopInvariantCodeMotionImpl();
 
   // We run gpuTransforms after LICM since we can benefit from invariant
@@ -912,7 +912,7 @@ static CondStmt *getAggregationCondStmt(Expr *stmt) {
   //    (call = ....);   <-this must be `stmt
   // }
   // else {
-  //    (call copy aggregator ....)
+  //    (call copy aggregator ....)    // or `update` for an aggregated update
   // }
   //
   // In that scenario, the immediate parent of `stmt` is the then block, and its
@@ -1034,8 +1034,15 @@ void optimizeForallUnorderedOps() {
         std::vector<Expr*> lastStmts;
         getLastStmts(loop, lastStmts);
         for_vector(Expr, lastStmt, lastStmts) {
+          // an aggregated atomic update is handled like an aggregated
+          // assignment
           if (isOptimizableAtomicStmt(lastStmt, loop)) {
-            atomicsToOptimize.push_back(lastStmt);
+            if (CondStmt *aggCond = getAggregationCondStmt(lastStmt)) {
+              aggCondsToTransform.push_back(aggCond);
+            }
+            else {
+              atomicsToOptimize.push_back(lastStmt);
+            }
           }
           else if (isOptimizableAssignStmt(lastStmt, loop)) {
             if (CondStmt *aggCond = getAggregationCondStmt(lastStmt)) {
@@ -36,6 +36,9 @@
 
 #include "global-ast-vecs.h"
 
+#include <map>
+#include <set>
+#include <string>
 #include <vector>
 
 int classifyPrimitive(CallExpr *call, bool inLocal);
@@ -405,47 +408,89 @@ inLocalBlock(CallExpr *call) {
   return false;
 }
 
-static int
-markFastSafeFn(FnSymbol *fn, int recurse, std::set<FnSymbol*>& visited) {
-
-  // First, handle functions we've already visited.
-  if (visited.count(fn) != 0) {
-    if (fn->hasFlag(FLAG_FAST_ON))
-      return FAST_AND_LOCAL;
-    if (fn->hasFlag(FLAG_LOCAL_FN))
-      return LOCAL_NOT_FAST;
-    return NOT_FAST_NOT_LOCAL;
+//
+// What markFastSafeFn found out about a function. Each function is
+// classified once and the result is reused by all of its callers, so the
+// pass is linear in the size of the call graph.
+//
+struct FastOnSummary {
+  int is;               // NOT_FAST_NOT_LOCAL, LOCAL_NOT_FAST or FAST_AND_LOCAL
+
+  // the function was not local only because the call depth limit was
+  // reached, at `depth`; it may be local if analyzed with a larger limit
+  bool hitLimit;
+  int depth;
+
+  // for --report-optimized-on: why the function isn't fast (or local),
+  // where, and the callee responsible, if any
+  std::string reason;
+  BaseAST* where;
+  FnSymbol* callee;
+
+  FastOnSummary() : is(FAST_AND_LOCAL), hitLimit(false), depth(0),
+                    where(NULL), callee(NULL) { }
+};
+
+static std::map<FnSymbol*, FastOnSummary> fastOnSummaries;
+static std::set<FnSymbol*> fastOnInProgress;
+
+static int markFastSafeFn(FnSymbol *fn, int recurse);
+
+// record the first reason the function is not fast
+static void setNotFast(FastOnSummary& summary, const std::string& reason,
+                       BaseAST* where, FnSymbol* callee = NULL) {
+  if (summary.is == FAST_AND_LOCAL) {
+    summary.is = LOCAL_NOT_FAST;
+    summary.reason = reason;
+    summary.where = where;
+    summary.callee = callee;
   }
+}
 
-  // Now, add fn to the set of visited functions,
-  // since we will categorize it now.
-  visited.insert(fn);
+// record why the function is not local, this overrides any reason it is not
+// fast
+static FastOnSummary& setNotLocal(FastOnSummary& summary,
+                                  const std::string& reason,
+                                  BaseAST* where, FnSymbol* callee = NULL) {
+  summary.is = NOT_FAST_NOT_LOCAL;
+  summary.reason = reason;
+  summary.where = where;
+  summary.callee = callee;
+  return summary;
+}
+
+static std::string calleeStr(FnSymbol* fn) {
+  return std::string("'") + fn->name + "'";
+}
+
+static FastOnSummary
+classifyFastSafeFn(FnSymbol *fn, int recurse) {
+  FastOnSummary summary;
 
-  // Next, classify extern functions
+  // First, classify extern functions
   if (fn->hasFlag(FLAG_EXTERN)) {
     if (fn->hasFlag(FLAG_FAST_ON_SAFE_EXTERN)) {
       // Make sure the FAST_ON and LOCAL_FN flags are set.
       fn->addFlag(FLAG_FAST_ON);
       fn->addFlag(FLAG_LOCAL_FN);
-      return FAST_AND_LOCAL;
     } else if(fn->hasFlag(FLAG_LOCAL_FN)) {
-      return LOCAL_NOT_FAST;
+      setNotFast(summary, "is an extern function not marked fast-on safe",
+                 fn);
     } else {
       // Other extern functions are not fast or local.
-      return NOT_FAST_NOT_LOCAL;
+      setNotLocal(summary, "is an extern function not marked local", fn);
     }
+    return summary;
   }
 
   // Next, go through function bodies.
-  // We will set maybefast=false if we see something in the function
+  // We will call setNotFast if we see something in the function
   //  that is local but not suitable for a signal handler
   //  (mostly allocation or locking).
-  // We will return NOT_FAST_NOT_LOCAL immediately if we see something
+  // We will return immediately if we see something
   // in the function that is not local.
-  bool maybefast = true;
-
   if (fn->hasFlag(FLAG_NON_BLOCKING))
-    maybefast = false;
+    setNotFast(summary, "is a non-blocking on", fn);
 
   std::vector<CallExpr*> calls;
 
@@ -459,47 +504,69 @@ markFastSafeFn(FnSymbol *fn, int recurse, std::set<FnSymbol*>& visited) {
 
       if (!isLocal(is)) {
         // FAST_NOT_LOCAL or NOT_FAST_NOT_LOCAL
-        return NOT_FAST_NOT_LOCAL;
+        return setNotLocal(summary, std::string("primitive '") +
+                           call->primitive->name + "' may communicate", call);
       }
 
       // is == FAST_AND_LOCAL requires no action
       if (is == LOCAL_NOT_FAST) {
-        maybefast = false;
+        setNotFast(summary, std::string("primitive '") +
+                   call->primitive->name + "' may allocate or block", call);
       }
 
+    } else if (!call->isResolved()) {
+      // No unresolved function calls allowed
+      return setNotLocal(summary, "has an unresolved call", call);
+
     } else {
-      if (recurse<=0 || !call->isResolved()) {
-        // didn't resolve or past too much recursion.
-        // No function calls allowed
-        return NOT_FAST_NOT_LOCAL;
-
-      } else {
-        // Handle nested 'on' statements
-        if (call->resolvedFunction()->hasFlag(FLAG_ON_BLOCK)) {
-          if (inLocal) {
-            maybefast = false;
-          } else {
-            return NOT_FAST_NOT_LOCAL;
-          }
+      FnSymbol* callee = call->resolvedFunction();
+
+      if (recurse <= 0) {
+        // too much recursion
+        setNotLocal(summary, "reached the call depth limit at a call to " +
+                    calleeStr(callee), call);
+        summary.hitLimit = true;
+        summary.depth = recurse;
+        return summary;
+      }
+
+      // Handle nested 'on' statements
+      if (callee->hasFlag(FLAG_ON_BLOCK)) {
+        if (inLocal) {
+          setNotFast(summary, "has a nested on statement", call);
+        } else {
+          return setNotLocal(summary, "has a nested on statement", call);
         }
+      }
 
-        // is the call to a fast/local function?
-        int is = markFastSafeFn(call->resolvedFunction(),
-                                recurse - 1,
-                                visited);
+      // is the call to a fast/local function?
+      int is = markFastSafeFn(callee, recurse - 1);
 
-        // Remove NOT_LOCAL parts if it's in a local block
-        is = setLocal(is, inLocal);
+      // Remove NOT_LOCAL parts if it's in a local block
+      is = setLocal(is, inLocal);
 
-        if (!isLocal(is)) {
-          return NOT_FAST_NOT_LOCAL;
+      if (!isLocal(is)) {
+        std::map<FnSymbol*, FastOnSummary>::iterator it =
+          fastOnSummaries.find(callee);
+        if (it == fastOnSummaries.end()) {
+          // still being classified
+          return setNotLocal(summary, "has a recursive call to " +
+                             calleeStr(callee), call);
         }
-
-        if (is == LOCAL_NOT_FAST) {
-          maybefast = false;
+        setNotLocal(summary, "calls " + calleeStr(callee) +
+                    ", which is not local", call, callee);
+        if (it->second.hitLimit) {
+          summary.hitLimit = true;
+          summary.depth = recurse;
         }
-        // otherwise, possibly still fast.
+        return summary;
       }
+
+      if (is == LOCAL_NOT_FAST) {
+        setNotFast(summary, "calls " + calleeStr(callee) +
+                   ", which is not fast", call, callee);
+      }
+      // otherwise, possibly still fast.
     }
   }
 
@@ -509,25 +576,73 @@ markFastSafeFn(FnSymbol *fn, int recurse, std::set<FnSymbol*>& visited) {
   for_vector(Expr, stmt, stmts) {
     if (BlockStmt* block = toBlockStmt(stmt)) {
       if (block->isLoopStmt()) {
-        maybefast = false;
+        setNotFast(summary, "has a loop", block);
         break;
       }
     }
   }
 
   // At this point we've considered all of the function body
-  // so if maybefast is still true, we can consider this function fast.
+  // so if the function is still fast, we can mark it that way.
 
   // We only get to this point if the function is local
   // (otherwise we would return above)
   fn->addFlag(FLAG_LOCAL_FN);
 
-  if (maybefast) {
+  if (summary.is == FAST_AND_LOCAL) {
     fn->addFlag(FLAG_FAST_ON);
+  }
 
-    return FAST_AND_LOCAL;
-  } else {
-    return LOCAL_NOT_FAST;
+  return summary;
+}
+
+static int
+markFastSafeFn(FnSymbol *fn, int recurse) {
+
+  // First, handle functions we've already classified. A result that was
+  // limited by the call depth is only reused for the same or a smaller depth.
+  std::map<FnSymbol*, FastOnSummary>::iterator it = fastOnSummaries.find(fn);
+  if (it != fastOnSummaries.end() &&
+      (!it->second.hitLimit || recurse <= it->second.depth)) {
+    return it->second.is;
+  }
+
+  // A recursive call. We can't know the answer yet, so be conservative.
+  if (fastOnInProgress.count(fn) != 0) {
+    return NOT_FAST_NOT_LOCAL;
+  }
+
+  fastOnInProgress.insert(fn);
+  FastOnSummary summary = classifyFastSafeFn(fn, recurse);
+  fastOnInProgress.erase(fn);
+
+  fastOnSummaries[fn] = summary;
+  return summary.is;
+}
+
+// for --report-optimized-on, explain why `fn` isn't fast, following the
+// chain of callees responsible
+static void reportNotFast(FnSymbol* fn, ModuleSymbol* mod) {
+  printf("Did not optimize on clause (%s) in module %s (%s:%d)\n",
+         fn->cname, mod->name, fn->fname(), fn->linenum());
+
+  std::set<FnSymbol*> reported;
+  FnSymbol* cur = fn;
+  while (cur != NULL && reported.count(cur) == 0) {
+    reported.insert(cur);
+
+    std::map<FnSymbol*, FastOnSummary>::iterator it =
+      fastOnSummaries.find(cur);
+    if (it == fastOnSummaries.end() || it->second.reason.empty()) {
+      break;
+    }
+
+    const FastOnSummary& summary = it->second;
+    BaseAST* where = summary.where ? summary.where : cur;
+    printf("  %s %s (%s:%d)\n", cur == fn ? "on body" : cur->name,
+           summary.reason.c_str(), where->fname(), where->linenum());
+
+    cur = summary.callee;
   }
 }
 
@@ -623,13 +738,19 @@ optimizeOnClauses(void) {
   compute_call_sites();
 
   forv_Vec(FnSymbol, fn, gFnSymbols) {
-    std::set<FnSymbol*> visited;
-
-    int is = markFastSafeFn(fn, optimize_on_clause_limit, visited);
+    int is = markFastSafeFn(fn, optimize_on_clause_limit);
 
     bool fastFork = isFast(is);
     bool removeRmemFences = isLocal(is);
 
+    // A begin body that is safe to run in an AM handler cannot block,
+    // so the tasking layer may run it to completion on a worker's stack.
+    bool lightweight = fLightweightTasks && isFast(is) &&
+                       fn->hasFlag(FLAG_BEGIN_BLOCK);
+
+    if (lightweight)
+      fn->addFlag(FLAG_LIGHTWEIGHT_TASK);
+
     if (!fn->hasFlag(FLAG_ON_BLOCK))
       fastFork = false;
 
@@ -651,7 +772,7 @@ optimizeOnClauses(void) {
       removeRmemFences = removeUnnecessaryFences(fn);
     }
 
-    if ( (fastFork || removeRmemFences) && fReportOptimizedOn) {
+    if ( (fastFork || removeRmemFences || lightweight) && fReportOptimizedOn) {
       ModuleSymbol *mod = toModuleSymbol(fn->defPoint->parentSymbol);
       INT_ASSERT(mod);
       if (developer ||
@@ -663,9 +784,26 @@ optimizeOnClauses(void) {
           printf("Optimized rmem fence (%s) in module %s (%s:%d)\n",
                fn->cname, mod->name, fn->fname(), fn->linenum());
         }
+        if (lightweight) {
+          printf("Lightweight begin task (%s) in module %s (%s:%d)\n",
+               fn->cname, mod->name, fn->fname(), fn->linenum());
+        }
+        if (developer) printf("(id %i)\n", fn->id);
+      }
+    }
+    else if (fn->hasFlag(FLAG_ON_BLOCK) && fReportOptimizedOn) {
+      ModuleSymbol *mod = toModuleSymbol(fn->defPoint->parentSymbol);
+      INT_ASSERT(mod);
+      if (developer ||
+          ((mod->modTag != MOD_INTERNAL) && (mod->modTag != MOD_STANDARD))) {
+        reportNotFast(fn, mod);
         if (developer) printf("(id %i)\n", fn->id);
       }
     }
   }
+
+  fastOnSummaries.clear();
+  fastOnInProgress.clear();
+
   addRunningTaskModifiers();
 }
@@ -208,6 +208,11 @@ static bool canForwardValue(Map<Symbol*, Vec<SymExpr*>*>& defMap,
 
 static bool isSufficientlyConst(ArgSymbol* arg);
 
+static bool isUnmodifiedRecordArg(Map<Symbol*, Vec<SymExpr*>*>& defMap,
+                                  Map<Symbol*, Vec<SymExpr*>*>& useMap,
+                                  FnSymbol*                     fn,
+                                  ArgSymbol*                    arg);
+
 static CallExpr* findDestroyCallForArg(ArgSymbol* arg);
 
 static void defaultForwarding(Map<Symbol*, Vec<SymExpr*>*>& useMap,
@@ -329,10 +334,11 @@ static bool canForwardValue(Map<Symbol*, Vec<SymExpr*>*>& defMap,
         // never written to, we can simply RVF the class pointer.
         retval = true;
       } else {
-        retval = arg->hasFlag(FLAG_REF_TO_IMMUTABLE);
+        retval = arg->hasFlag(FLAG_REF_TO_IMMUTABLE) ||
+                 isUnmodifiedRecordArg(defMap, useMap, fn, arg);
       }
     } else {
-      retval = false;
+      retval = isUnmodifiedRecordArg(defMap, useMap, fn, arg);
     }
   } else {
     retval = false;
@@ -341,6 +347,101 @@ static bool canForwardValue(Map<Symbol*, Vec<SymExpr*>*>& defMap,
   return retval;
 }
 
+// Copying a record with one of these inside would change what the on-body
+// sees: sync and atomic fields must be shared, and the contents of an array
+// or domain field live in a class instance that a 'const' wrapper doesn't
+// protect, so reading the record field by field doesn't show they are
+// unmodified.
+static bool isUnsafeToCopyField(Type* t) {
+  Type* vt = t->getValType();
+
+  if (isRecordWrappedType(vt) ||
+      isOrContainsSyncType(vt) || isOrContainsAtomicType(vt)) {
+    return true;
+  }
+
+  if (isRecord(vt)) {
+    AggregateType* at = toAggregateType(vt);
+    for_fields(field, at) {
+      if (isUnsafeToCopyField(field->type)) {
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+// Can other code see 'sym' while an on statement it is passed to runs?
+// It can't if it's a local that is never aliased and never handed to a task
+// that could still be running.
+static bool isUnaliasedLocal(Symbol* sym) {
+  VarSymbol* var = toVarSymbol(sym);
+
+  if (var == NULL || var->isRef() || isGlobal(var) ||
+      var->hasFlag(FLAG_COFORALL_INDEX_VAR)) {
+    return false;
+  }
+
+  for_SymbolSymExprs(se, var) {
+    if (CallExpr* call = toCallExpr(se->parentExpr)) {
+      if (call->isPrimitive(PRIM_ADDR_OF) ||
+          call->isPrimitive(PRIM_SET_REFERENCE)) {
+        return false;
+      }
+      if (FnSymbol* callee = call->resolvedFunction()) {
+        if (needsCapture(callee)) {
+          return false;
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
+//
+// Can the record 'arg', passed by reference to the on-function 'fn', be
+// forwarded by value even though it isn't known to refer to something
+// immutable?  It can if nothing modifies it while the on-body runs:
+//
+//  - the on-body only reads it, possibly field by field (isSafeToDeref),
+//  - the on statement is blocking, so the task that passed it is waiting,
+//  - each actual is a local that no other task can see, and
+//  - the on-body can't reach it through another formal, since every other
+//    reference formal either refers to something immutable or is only read.
+//
+static bool isUnmodifiedRecordArg(Map<Symbol*, Vec<SymExpr*>*>& defMap,
+                                  Map<Symbol*, Vec<SymExpr*>*>& useMap,
+                                  FnSymbol*                     fn,
+                                  ArgSymbol*                    arg) {
+  Type* vt = arg->getValType();
+
+  if (!fRemoteValueForwardRecords ||
+      fn->hasFlag(FLAG_NON_BLOCKING) ||
+      !isRecord(vt) || isUnsafeToCopyField(vt)) {
+    return false;
+  }
+
+  for_formals(formal, fn) {
+    if (formal->isRef() &&
+        !formal->hasFlag(FLAG_REF_TO_IMMUTABLE) &&
+        !isSafeToDeref(defMap, useMap, NULL, formal)) {
+      return false;
+    }
+  }
+
+  forv_Vec(CallExpr, call, *fn->calledBy) {
+    SymExpr* actual = toSymExpr(formal_to_actual(call, arg));
+
+    if (actual == NULL || !isUnaliasedLocal(actual->symbol())) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
 static bool isSufficientlyConst(ArgSymbol* arg) {
   bool  retval     = false;
 
@@ -1210,6 +1311,32 @@ static bool isSafeToDeref(Map<Symbol*, Vec<SymExpr*>*>& defMap,
                              newRef->symbol(),
                              visited);
 
+    } else if ((call->isPrimitive(PRIM_GET_MEMBER_VALUE) ||
+                call->isPrimitive(PRIM_GET_SVEC_MEMBER_VALUE)) &&
+               use == call->get(1)) {
+      // reading one field leaves the rest alone
+      retval = true;
+
+    } else if ((call->isPrimitive(PRIM_GET_MEMBER) ||
+                call->isPrimitive(PRIM_GET_SVEC_MEMBER)) &&
+               use == call->get(1)) {
+      // a reference to a field is fine as long as that reference is
+      CallExpr* move = toCallExpr(call->parentExpr);
+
+      if (move != NULL && move->isPrimitive(PRIM_MOVE)) {
+        SymExpr* fieldRef = toSymExpr(move->get(1));
+
+        INT_ASSERT(fieldRef);
+
+        retval = isSafeToDeref(defMap,
+                               useMap,
+                               field,
+                               fieldRef->symbol(),
+                               visited);
+      } else {
+        retval = false;
+      }
+
     } else if (call->isPrimitive(PRIM_SET_MEMBER) == true &&
                field                              != NULL) {
       SymExpr* se = toSymExpr(call->get(2));
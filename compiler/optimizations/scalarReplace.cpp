@@ -34,9 +34,12 @@
 #include "stringutil.h"
 #include "symbol.h"
 #include "view.h"
+#include "virtualDispatch.h"
 
 #include "global-ast-vecs.h"
 
+#include <vector>
+
 static const bool debugScalarReplacement = false;
 
 // statistics
@@ -573,8 +576,204 @@ debugScalarReplacementFailure(Symbol* var) {
 }
 
 
+//
+// Aggregate argument flattening
+//
+// Formals of small tuple or record types whose fields are all numbers,
+// bools or enums are passed as one scalar formal per field, so that the
+// back end sees the fields in registers rather than a stack temporary
+// whose address is passed.  This is only done when every reference to
+// the function is a direct call and the formal is only read field by
+// field; callers read the fields out of the actual before the call.
+//
+// This optimization is off by default. It can be enabled with
+// `--flatten-aggregate-args`.
+//
+
+static int faFormals = 0;
+static int faFunctions = 0;
+
+static bool isFlattenableAggregate(Type* t) {
+  AggregateType* at = toAggregateType(t);
+  if (at == NULL || isRecord(at) == false ||
+      at->symbol->hasFlag(FLAG_EXTERN) ||
+      at->fields.length == 0 ||
+      at->fields.length > scalar_replace_limit) {
+    return false;
+  }
+  for_fields(field, at) {
+    Type* ft = field->type;
+    if (field->isRef() ||
+        !(is_arithmetic_type(ft) || isBoolType(ft) || isEnumType(ft))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Is every reference to fn the callee of a call?
+static bool isOnlyCalledDirectly(FnSymbol* fn) {
+  if (fn->hasFlag(FLAG_EXTERN) || fn->hasFlag(FLAG_EXPORT) ||
+      fn->hasFlag(FLAG_NO_FN_BODY) || fn->hasFlag(FLAG_NO_CODEGEN) ||
+      virtualMethodMap.get(fn) != 0 || fn == chpl_gen_main) {
+    return false;
+  }
+  bool called = false;
+  for_SymbolSymExprs(se, fn) {
+    CallExpr* call = toCallExpr(se->parentExpr);
+    if (call == NULL || call->baseExpr != se) {
+      return false;
+    }
+    called = true;
+  }
+  return called;
+}
+
+// Is the formal only read field by field?  Reads through a ref to a
+// field are accepted when the ref is only dereferenced.
+static bool isOnlyReadByField(ArgSymbol* formal) {
+  if (formal->hasFlag(FLAG_RETARG)) {
+    return false;
+  }
+  bool any = false;
+  for_SymbolSymExprs(se, formal) {
+    CallExpr* call = toCallExpr(se->parentExpr);
+    if (call == NULL || call->get(1) != se) {
+      return false;
+    }
+    if (call->isPrimitive(PRIM_GET_MEMBER_VALUE)) {
+      any = true;
+      continue;
+    }
+    if (!call->isPrimitive(PRIM_GET_MEMBER)) {
+      return false;
+    }
+    CallExpr* move = toCallExpr(call->parentExpr);
+    if (move == NULL || !move->isPrimitive(PRIM_MOVE)) {
+      return false;
+    }
+    Symbol* ref = toSymExpr(move->get(1))->symbol();
+    if (!ref->isRef() || ref->getSingleDef() == NULL) {
+      return false;
+    }
+    for_SymbolUses(use, ref) {
+      CallExpr* deref = toCallExpr(use->parentExpr);
+      if (deref == NULL || !deref->isPrimitive(PRIM_DEREF)) {
+        return false;
+      }
+    }
+    any = true;
+  }
+  return any;
+}
+
+static void flattenFormal(FnSymbol* fn, ArgSymbol* formal,
+                          std::vector<CallExpr*>& calls) {
+  AggregateType* at = toAggregateType(formal->getValType());
+  int idx = 0;
+  for_formals(f, fn) {
+    if (f == formal) break;
+    idx++;
+  }
+
+  SymbolMap fieldMap;
+  for_fields(field, at) {
+    SET_LINENO(formal);
+    ArgSymbol* arg = new ArgSymbol(INTENT_CONST_IN,
+                                   astr(formal->name, "_", field->name),
+                                   field->type);
+    formal->defPoint->insertBefore(new DefExpr(arg));
+    fieldMap.put(field, arg);
+  }
+
+  std::vector<SymExpr*> uses;
+  for_SymbolSymExprs(se, formal) {
+    uses.push_back(se);
+  }
+  for_vector(SymExpr, se, uses) {
+    CallExpr* call = toCallExpr(se->parentExpr);
+    SET_LINENO(call);
+    Symbol* arg = fieldMap.get(toSymExpr(call->get(2))->symbol());
+    if (call->isPrimitive(PRIM_GET_MEMBER_VALUE)) {
+      call->replace(new SymExpr(arg));
+    } else {
+      call->replace(new CallExpr(PRIM_SET_REFERENCE, arg));
+    }
+  }
+  formal->defPoint->remove();
+
+  for_vector(CallExpr, call, calls) {
+    SET_LINENO(call);
+    Expr* actual = call->get(idx + 1);
+    Symbol* base = toSymExpr(actual)->symbol();
+    for_fields(field, at) {
+      VarSymbol* tmp = newTemp(astr(base->name, "_", field->name),
+                               field->type);
+      call->getStmtExpr()->insertBefore(new DefExpr(tmp));
+      call->getStmtExpr()->insertBefore(
+        new CallExpr(PRIM_MOVE, tmp,
+                     new CallExpr(PRIM_GET_MEMBER_VALUE, base, field)));
+      actual->insertBefore(new SymExpr(tmp));
+    }
+    actual->remove();
+  }
+}
+
+static void flattenAggregateArgs() {
+  forv_Vec(FnSymbol, fn, gFnSymbols) {
+    if (!fn->inTree() || !isOnlyCalledDirectly(fn)) {
+      continue;
+    }
+
+    std::vector<ArgSymbol*> formals;
+    for_formals(formal, fn) {
+      if (formal != fn->_this &&
+          isFlattenableAggregate(formal->getValType()) &&
+          isOnlyReadByField(formal)) {
+        formals.push_back(formal);
+      }
+    }
+    if (formals.empty()) {
+      continue;
+    }
+
+    std::vector<CallExpr*> calls;
+    for_SymbolSymExprs(se, fn) {
+      calls.push_back(toCallExpr(se->parentExpr));
+    }
+
+    // the actuals have to be variables we can read the fields of
+    bool simple = true;
+    for_vector(CallExpr, call, calls) {
+      for_vector(ArgSymbol, formal, formals) {
+        int idx = 1;
+        for_formals(f, fn) {
+          if (f == formal) break;
+          idx++;
+        }
+        if (!isSymExpr(call->get(idx))) {
+          simple = false;
+        }
+      }
+    }
+    if (!simple) {
+      continue;
+    }
+
+    for_vector(ArgSymbol, formal, formals) {
+      flattenFormal(fn, formal, calls);
+      faFormals++;
+    }
+    faFunctions++;
+  }
+}
+
 void
 scalarReplace() {
+  if (fFlattenAggregateArgs) {
+    flattenAggregateArgs();
+  }
+
   if (!fNoScalarReplacement) {
 
     //
@@ -695,6 +894,10 @@ scalarReplace() {
     if (fReportScalarReplace) {
       printf("\tReplaced %d of %d records\n", srRecordReplaced, srRecord);
       printf("\tReplaced %d of %d classes\n", srClassReplaced, srClass);
+      if (fFlattenAggregateArgs) {
+        printf("\tFlattened %d aggregate formals in %d functions\n",
+               faFormals, faFunctions);
+      }
     }
   }
 }
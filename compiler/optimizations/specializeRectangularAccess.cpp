@@ -0,0 +1,167 @@
+/*
+ * Copyright 2020-2026 Hewlett Packard Enterprise Development LP
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "optimizations.h"
+
+#include "astutil.h"
+#include "driver.h"
+#include "expr.h"
+#include "stmt.h"
+#include "stringutil.h"
+#include "symbol.h"
+
+#include "global-ast-vecs.h"
+
+#include <vector>
+
+// DefaultRectangular arrays find an element's offset in their data as the
+// sum of each index times the corresponding `blk` component, and since the
+// data is stored row-major the last component of `blk` is always 1. The
+// compiler can't see that from the module code, so the innermost (and for
+// 1-D arrays the only) multiplication is done on every access, along with
+// a load of `blk` from the array. This replaces reads of the last `blk`
+// component with 1, which leaves unit-stride accesses as plain pointer
+// arithmetic on `shiftedData` and lets LICM hoist what remains of the
+// offset computation out of loops.
+//
+// This optimization is off by default. It can be enabled with
+// `--specialize-rectangular-access`.
+
+static bool isRectangularArrayClass(Type* t) {
+  AggregateType* at = toAggregateType(t->getValType());
+  return at != NULL && isClass(at) &&
+         startsWith(at->symbol->name, "DefaultRectangularArr");
+}
+
+static Symbol* newOne(Type* t) {
+  for (int i = INT_SIZE_8; i < INT_SIZE_NUM; i++) {
+    if (dtInt[i] == t) {
+      return new_IntSymbol(1, (IF1_int_type) i);
+    }
+    if (dtUInt[i] == t) {
+      return new_UIntSymbol(1, (IF1_int_type) i);
+    }
+  }
+  return NULL;
+}
+
+// Is `call` an access to the last component of the tuple `tup`?
+static bool isLastComponent(CallExpr* call, AggregateType* tup) {
+  Symbol* last = tup->fields.tail ? toDefExpr(tup->fields.tail)->sym : NULL;
+  if (last == NULL || call->numActuals() != 2) {
+    return false;
+  }
+  if (call->isPrimitive(PRIM_GET_MEMBER_VALUE) ||
+      call->isPrimitive(PRIM_GET_MEMBER)) {
+    SymExpr* field = toSymExpr(call->get(2));
+    return field != NULL && field->symbol() == last;
+  }
+  if (call->isPrimitive(PRIM_GET_SVEC_MEMBER_VALUE) ||
+      call->isPrimitive(PRIM_GET_SVEC_MEMBER)) {
+    int64_t idx = 0;
+    return get_int(call->get(2), &idx) && idx == tup->fields.length - 1;
+  }
+  return false;
+}
+
+// Replace value reads of the last component of the tuple held in `tup`
+static void replaceLastComponentReads(Symbol* tup, AggregateType* tupType,
+                                      Type* eltType) {
+  std::vector<Expr*> reads;
+  for_SymbolUses(use, tup) {
+    CallExpr* call = toCallExpr(use->parentExpr);
+    if (call == NULL || call->get(1) != use ||
+        !isLastComponent(call, tupType)) {
+      continue;
+    }
+    if (call->isPrimitive(PRIM_GET_MEMBER_VALUE) ||
+        call->isPrimitive(PRIM_GET_SVEC_MEMBER_VALUE)) {
+      reads.push_back(call);
+      continue;
+    }
+
+    // a ref to the component that is only dereferenced
+    CallExpr* move = toCallExpr(call->parentExpr);
+    if (move == NULL || !move->isPrimitive(PRIM_MOVE)) {
+      continue;
+    }
+    Symbol* ref = toSymExpr(move->get(1))->symbol();
+    if (ref->getSingleDef() == NULL) {
+      continue;
+    }
+    bool onlyDerefs = true;
+    for_SymbolUses(refUse, ref) {
+      CallExpr* deref = toCallExpr(refUse->parentExpr);
+      if (deref == NULL || !deref->isPrimitive(PRIM_DEREF)) {
+        onlyDerefs = false;
+      }
+    }
+    if (onlyDerefs) {
+      for_SymbolUses(refUse, ref) {
+        reads.push_back(refUse->parentExpr);
+      }
+    }
+  }
+
+  for_vector(Expr, read, reads) {
+    SET_LINENO(read);
+    read->replace(new SymExpr(newOne(eltType)));
+  }
+}
+
+void specializeRectangularAccess() {
+  if (!fSpecializeRectangularAccess) return;
+
+  forv_Vec(CallExpr, call, gCallExprs) {
+    if (!call->inTree() ||
+        !(call->isPrimitive(PRIM_GET_MEMBER_VALUE) ||
+          call->isPrimitive(PRIM_GET_MEMBER)) ||
+        !isRectangularArrayClass(call->get(1)->typeInfo())) {
+      continue;
+    }
+
+    SymExpr* fieldSe = toSymExpr(call->get(2));
+    if (fieldSe == NULL || strcmp(fieldSe->symbol()->name, "blk") != 0) {
+      continue;
+    }
+
+    AggregateType* tupType = toAggregateType(fieldSe->symbol()->type);
+    if (tupType == NULL || !tupType->symbol->hasFlag(FLAG_STAR_TUPLE) ||
+        tupType->fields.length == 0) {
+      continue;
+    }
+    Type* eltType = toDefExpr(tupType->fields.head)->sym->type;
+    if (newOne(eltType) == NULL) {
+      continue;
+    }
+
+    // `move tup, get member(arr, blk)`, where tup isn't written again
+    CallExpr* move = toCallExpr(call->parentExpr);
+    if (move == NULL || !move->isPrimitive(PRIM_MOVE)) {
+      continue;
+    }
+    Symbol* tup = toSymExpr(move->get(1))->symbol();
+    if (tup->getSingleDef() == NULL) {
+      continue;
+    }
+
+    replaceLastComponentReads(tup, tupType, eltType);
+  }
+}
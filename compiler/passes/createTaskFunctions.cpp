@@ -702,6 +702,21 @@ bool isAtomicFunctionWithOrderArgument(FnSymbol* fnSymbol, ArgSymbol** order = N
   return false;
 }
 
+// Atomic loads only need the acquire half of the remote-memory fence and
+// atomic stores only need the release half. A load does not publish this
+// task's writes to anyone and a store does not make anyone else's writes
+// visible to this task, so for them the other half would only write back
+// or discard cached data that is unrelated to the atomic.
+static bool atomicFunctionNeedsRemoteRelease(FnSymbol* fnSymbol) {
+  return !(fnSymbol->name == astr("read") ||
+           fnSymbol->name == astr("waitFor"));
+}
+
+static bool atomicFunctionNeedsRemoteAcquire(FnSymbol* fnSymbol) {
+  return !(fnSymbol->name == astr("write") ||
+           fnSymbol->name == astr("clear"));
+}
+
 /********************** createTaskFunctions **********************/
 
 //
@@ -726,8 +741,8 @@ void createTaskFunctions(void) {
     //  -- or do it with a flag on the network atomic impl fns
     //  for each method in an atomics type that has an order= argument,
     //   and which does not start/end with chpl_rmem_consist_maybe_release,
-    //   add chpl_rmem_consist_maybe_release(order)
-    //   add chpl_rmem_consist_maybe_acquire(order)
+    //   add chpl_rmem_consist_maybe_release(order) (except for loads)
+    //   add chpl_rmem_consist_maybe_acquire(order) (except for stores)
     //  only do this when the remote data cache is enabled.
     // Go through TypeSymbols looking for flag ATOMIC_TYPE
     forv_Vec(ModuleSymbol, module, gModuleSymbols) {
@@ -743,10 +758,12 @@ void createTaskFunctions(void) {
           // already there).
           if( isAtomicFunctionWithOrderArgument(fnSymbol, &order) ) {
             SET_LINENO(fnSymbol);
-            fnSymbol->insertAtHead(
-                new CallExpr("chpl_rmem_consist_maybe_release", order));
-            fnSymbol->insertBeforeEpilogue(
-                new CallExpr("chpl_rmem_consist_maybe_acquire", order));
+            if (atomicFunctionNeedsRemoteRelease(fnSymbol))
+              fnSymbol->insertAtHead(
+                  new CallExpr("chpl_rmem_consist_maybe_release", order));
+            if (atomicFunctionNeedsRemoteAcquire(fnSymbol))
+              fnSymbol->insertBeforeEpilogue(
+                  new CallExpr("chpl_rmem_consist_maybe_acquire", order));
           }
         }
       }
@@ -256,6 +256,11 @@ static std::set<Symbol*> fieldsToMakeWide;
 // A map from a symbol to the BaseASTs that caused it to be wide
 static std::map<Symbol*, std::set<BaseAST*> > causes;
 
+// While narrowing known-local wides, insertLocalTemp() only localizes these,
+// and counts the (narrowed, total) uses it sees per module.
+static std::set<Symbol*>* knownLocalWides = nullptr;
+static std::map<ModuleSymbol*, std::pair<int, int> > narrowingCounts;
+
 // Various mini-passes to manipulate the AST into something functional
 static void convertNilToObject();
 static void buildWideClasses();
@@ -1731,18 +1736,29 @@ static void derefWideRefsToWideClasses()
 // addr field into a non-wide of otherwise the same type. Then, replace its
 // use with the non-wide version.
 //
-static void insertLocalTemp(Expr* expr) {
+// Returns false if it left 'expr' as it was.
+//
+static bool insertLocalTemp(Expr* expr) {
   SymExpr* se = toSymExpr(expr);
   Expr* stmt = expr->getStmtExpr();
   INT_ASSERT(se && stmt);
+  if (knownLocalWides != nullptr) {
+    std::pair<int, int>& counts = narrowingCounts[stmt->getModule()];
+    counts.second++;
+    if (knownLocalWides->count(se->symbol()) == 0) {
+      return false;
+    }
+    counts.first++;
+  }
   SET_LINENO(se);
   VarSymbol* var = newTemp(astr("local_", se->symbol()->name), getNarrowType(se));
-  if (!fNoLocalChecks) {
+  if (!fNoLocalChecks && knownLocalWides == nullptr) {
     stmt->insertBefore(new CallExpr(PRIM_LOCAL_CHECK, se->copy(), buildCStringLiteral("cannot access remote data in local block")));
   }
   stmt->insertBefore(new DefExpr(var));
   stmt->insertBefore(new CallExpr(PRIM_MOVE, var, se->copy()));
   se->replace(new SymExpr(var));
+  return true;
 }
 
 
@@ -1791,7 +1807,9 @@ static void localizeCall(CallExpr* call) {
             INT_ASSERT(lhs && stmt);
 
             SET_LINENO(stmt);
-            insertLocalTemp(rhs->get(1));
+            if (!insertLocalTemp(rhs->get(1))) {
+              break;
+            }
             VarSymbol* localVar = NULL;
             if (rhs->isPrimitive(PRIM_ARRAY_GET))
               localVar = newTemp(astr("local_", lhs->symbol()->name),
@@ -1829,8 +1847,8 @@ static void localizeCall(CallExpr* call) {
       }
       break;
     case PRIM_DYNAMIC_CAST:
-      if (call->get(2)->typeInfo()->symbol->hasFlag(FLAG_WIDE_CLASS)) {
-        insertLocalTemp(call->get(2));
+      if (call->get(2)->typeInfo()->symbol->hasFlag(FLAG_WIDE_CLASS) &&
+          insertLocalTemp(call->get(2))) {
         if (isFullyWide(call->get(1))) {
           Symbol* se = toSymExpr(call->get(1))->symbol();
           QualifiedType qt = getNarrowType(call->get(1));
@@ -1934,6 +1952,215 @@ static void handleLocalBlocks() {
 }
 
 
+//
+// With --narrow-local-wide-refs, wide references whose value is known to be
+// on the current locale are given narrow temporaries where they'd otherwise
+// communicate, like in a local block but without the runtime check.
+//
+// A symbol is known to be local when it is a wide class or wide reference
+// variable with a single def, and that def moves into it
+//   - a narrow class or reference, since narrow things are always local,
+//   - a symbol already known to be local, or a cast of one,
+//   - the address of a variable declared in a function, or of a field of
+//     something local,
+//   - the value of a class field of a record declared in the function when
+//     the record is only ever accessed through its fields, and every value
+//     stored to that field is local, or
+//   - the result of a call to a function whose return symbol is local.
+// Since such a symbol never changes after its def, the facts hold at all of
+// its uses. They are found by iterating to a fixed point, so that they flow
+// through chains of moves, returns and record fields.
+//
+// With --report-wide-narrowing, also print for each module how many of the
+// uses of wide references that would communicate were narrowed.
+//
+
+static bool isKnownLocal(Symbol* sym, const std::set<Symbol*>& local) {
+  return local.count(sym) != 0;
+}
+
+// Is the value moved from 'src' into the wide 'dst' local?
+static bool isLocalMoveSource(Symbol* dst, Symbol* src,
+                              const std::set<Symbol*>& local) {
+  if (dst->isWideRef()) {
+    // a reference copy
+    return src->isRefOrWideRef() &&
+           (!src->isWideRef() || isKnownLocal(src, local));
+  }
+
+  if (src->isRefOrWideRef()) {
+    // a dereference of a reference to a narrow class on this locale
+    return !valIsWideClass(src) &&
+           (!src->isWideRef() || isKnownLocal(src, local));
+  }
+
+  return isObj(src) && (!isFullyWide(src) || isKnownLocal(src, local));
+}
+
+static bool isFunctionLocalVar(Symbol* sym) {
+  return isVarSymbol(sym) && !sym->isRefOrWideRef() &&
+         !sym->hasFlag(FLAG_HEAP) &&
+         isFnSymbol(sym->defPoint->parentSymbol);
+}
+
+// Is every value stored in 'field' of the function-local record 'rec'
+// local? 'rec' may only be accessed through its fields.
+static bool isLocalRecordField(Symbol* rec, Symbol* field,
+                               const std::set<Symbol*>& local) {
+  if (!isFunctionLocalVar(rec) || !isRecord(rec->type) ||
+      canWidenRecord(rec)) {
+    return false;
+  }
+
+  bool anyStore = false;
+  for_SymbolSymExprs(se, rec) {
+    CallExpr* call = toCallExpr(se->parentExpr);
+    if (call == nullptr || se != call->get(1)) return false;
+
+    if (call->isPrimitive(PRIM_GET_MEMBER_VALUE)) {
+      continue;
+    } else if (call->isPrimitive(PRIM_SET_MEMBER)) {
+      if (toSymExpr(call->get(2))->symbol() != field) continue;
+      Symbol* val = toSymExpr(call->get(3))->symbol();
+      if (!isObj(val) || (isFullyWide(val) && !isKnownLocal(val, local))) {
+        return false;
+      }
+      anyStore = true;
+    } else {
+      return false;
+    }
+  }
+
+  return anyStore;
+}
+
+static bool isLocalDef(Symbol* sym, const std::set<Symbol*>& local) {
+  SymExpr* def = sym->getSingleDef();
+  if (def == nullptr) return false;
+
+  CallExpr* move = toCallExpr(def->parentExpr);
+  if (move == nullptr || !move->isPrimitive(PRIM_MOVE) ||
+      def != move->get(1)) {
+    return false;
+  }
+
+  if (SymExpr* rhs = toSymExpr(move->get(2))) {
+    return isLocalMoveSource(sym, rhs->symbol(), local);
+  }
+
+  CallExpr* rhs = toCallExpr(move->get(2));
+  if (rhs == nullptr) return false;
+
+  if (FnSymbol* fn = rhs->resolvedFunction()) {
+    Symbol* ret = fn->getReturnSymbol();
+    return ret != nullptr && !fn->hasFlag(FLAG_EXTERN) &&
+           ret->defPoint->parentSymbol == fn &&
+           isLocalMoveSource(sym, ret, local);
+  }
+
+  if (!rhs->isPrimitive()) return false;
+
+  switch (rhs->primitive->tag) {
+  case PRIM_CAST:
+    if (SymExpr* src = toSymExpr(rhs->get(2))) {
+      return !sym->isWideRef() && isLocalMoveSource(sym, src->symbol(), local);
+    }
+    return false;
+
+  case PRIM_ADDR_OF:
+  case PRIM_SET_REFERENCE: {
+    Symbol* src = toSymExpr(rhs->get(1))->symbol();
+    if (src->isRefOrWideRef()) {
+      return isLocalMoveSource(sym, src, local);
+    }
+    return sym->isWideRef() && isFunctionLocalVar(src);
+  }
+
+  case PRIM_GET_MEMBER: {
+    if (!sym->isWideRef()) return false;
+    Symbol* base = toSymExpr(rhs->get(1))->symbol();
+    if (base->isRefOrWideRef()) {
+      return !base->isWideRef() || isKnownLocal(base, local);
+    }
+    if (isObj(base)) {
+      return !isFullyWide(base) || isKnownLocal(base, local);
+    }
+    return isFunctionLocalVar(base);
+  }
+
+  case PRIM_GET_MEMBER_VALUE: {
+    if (sym->isWideRef()) return false;
+    Symbol* base = toSymExpr(rhs->get(1))->symbol();
+    Symbol* field = toSymExpr(rhs->get(2))->symbol();
+    return isLocalRecordField(base, field, local);
+  }
+
+  default:
+    return false;
+  }
+}
+
+static std::set<Symbol*> findKnownLocalWides() {
+  std::vector<Symbol*> candidates;
+  forv_Vec(VarSymbol, var, gVarSymbols) {
+    if (!var->inTree() || !isFullyWide(var) || var->hasFlag(FLAG_HEAP) ||
+        !isFnSymbol(var->defPoint->parentSymbol)) {
+      continue;
+    }
+    if (var->isWideRef() || var->type->symbol->hasFlag(FLAG_WIDE_CLASS)) {
+      candidates.push_back(var);
+    }
+  }
+
+  std::set<Symbol*> local;
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (Symbol* sym : candidates) {
+      if (!isKnownLocal(sym, local) && isLocalDef(sym, local)) {
+        local.insert(sym);
+        changed = true;
+      }
+    }
+  }
+
+  return local;
+}
+
+static void narrowKnownLocalWides() {
+  std::set<Symbol*> local = findKnownLocalWides();
+
+  // localizeCall() adds calls, so don't walk gCallExprs while it runs
+  std::vector<CallExpr*> calls;
+  forv_Vec(CallExpr, call, gCallExprs) {
+    if (call->inTree() && call->primitive) {
+      calls.push_back(call);
+    }
+  }
+
+  knownLocalWides = &local;
+  for_vector(CallExpr, call, calls) {
+    localizeCall(call);
+  }
+  knownLocalWides = nullptr;
+
+  if (fReportWideNarrowing) {
+    std::map<std::string, std::pair<int, int> > byName;
+    for (auto& elem : narrowingCounts) {
+      byName[elem.first->name] = elem.second;
+    }
+    for (auto& elem : byName) {
+      int narrowed = elem.second.first;
+      int total = elem.second.second;
+      printf("wide narrowing: %s: %d of %d wide references narrowed "
+             "(%.1f%%)\n", elem.first.c_str(), narrowed, total,
+             100.0 * narrowed / total);
+    }
+  }
+  narrowingCounts.clear();
+}
+
+
 // Add symbols bearing the FLAG_HEAP flag to a list of heapVars.
 static void getHeapVars(std::vector<Symbol*>& heapVars)
 {
@@ -2637,6 +2864,10 @@ insertWideReferences(void) {
 
   handleLocalBlocks();
 
+  if (fNarrowLocalWideRefs) {
+    narrowKnownLocalWides();
+  }
+
   heapAllocateGlobalsTail(heapAllocateGlobals, heapVars);
 
   // NWR
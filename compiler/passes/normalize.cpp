@@ -37,6 +37,7 @@
 #include "initializerRules.h"
 #include "library.h"
 #include "LoopExpr.h"
+#include "optimizations.h"
 #include "forallOptimizations.h"
 #include "scopeResolve.h"
 #include "splitInit.h"
@@ -49,8 +50,10 @@
 
 #include "global-ast-vecs.h"
 
+#include <atomic>
 #include <cctype>
 #include <set>
+#include <thread>
 #include <vector>
 
 bool normalized = false;
@@ -178,6 +181,9 @@ void normalize() {
 
   insertModuleInit();
 
+  // before arrayViewElision, which then sees the slice assignments
+  bulkTransferLoops();
+
   arrayViewElision();
 
   doPreNormalizeArrayOptimizations();
@@ -899,7 +905,25 @@ static void normalizeBase(BaseAST* base, bool addEndOfStatements) {
 *                                                                             *
 ************************************** | *************************************/
 
-static Symbol* theDefinedSymbol(BaseAST* ast);
+// The errors are collected rather than reported right away, so that the
+// functions can be checked on several threads and the errors still come
+// out in the same order.
+struct UseBeforeDefError {
+  BaseAST*    ast;
+  std::string msg;
+  bool        isNote; // USR_PRINT rather than USR_FATAL_CONT
+};
+
+typedef std::vector<UseBeforeDefError> UseBeforeDefErrors;
+
+static Symbol* theDefinedSymbol(BaseAST* ast, UseBeforeDefErrors& errors);
+
+static void addError(UseBeforeDefErrors& errors, BaseAST* ast,
+                     bool isNote, const char* fmt, const char* name) {
+  char buf[1024];
+  snprintf(buf, sizeof(buf), fmt, name);
+  errors.push_back({ast, buf, isNote});
+}
 
 static bool isInsideTaskWithClause(Expr* expr) {
   if (CallExpr* blockInfo = findBlockInfo(expr)) {
@@ -908,7 +932,7 @@ static bool isInsideTaskWithClause(Expr* expr) {
   return false;
 }
 
-void checkUseBeforeDefs(FnSymbol* fn) {
+static void findUseBeforeDefs(FnSymbol* fn, UseBeforeDefErrors& errors) {
   if (fn->hasFlag(FLAG_RESOLVED_EARLY)) return;
   if (fn->defPoint->parentSymbol) {
     ModuleSymbol*         mod = fn->getModule();
@@ -923,7 +947,7 @@ void checkUseBeforeDefs(FnSymbol* fn) {
     collect_asts_postorder(fn, asts);
 
     for_vector(BaseAST, ast, asts) {
-      if (Symbol* sym = theDefinedSymbol(ast)) {
+      if (Symbol* sym = theDefinedSymbol(ast, errors)) {
         defined.insert(sym);
 
       } else if (SymExpr* se = toSymExpr(ast)) {
@@ -942,7 +966,7 @@ void checkUseBeforeDefs(FnSymbol* fn) {
           SymExpr* prev = toSymExpr(se->prev);
 
           if (prev == NULL || prev->symbol() != gModuleToken) {
-            USR_FATAL_CONT(se, "modules (like '%s' here) cannot be called like procedures", sym->name);
+            addError(errors, se, false, "modules (like '%s' here) cannot be called like procedures", sym->name);
           }
 
         } else if (isLcnSymbol(sym) == true) {
@@ -960,8 +984,8 @@ void checkUseBeforeDefs(FnSymbol* fn) {
                 if (undefined.find(sym) == undefined.end()) {
                   if (se->parentSymbol->hasFlag(FLAG_RESOLVED_EARLY) &&
                       mod->initFn == parent) continue;
-                  USR_FATAL_CONT(se, "'%s' used before defined", sym->name);
-                  USR_PRINT(sym->defPoint, "defined here");
+                  addError(errors, se, false, "'%s' used before defined", sym->name);
+                  addError(errors, sym->defPoint, true, "defined here", NULL);
                   undefined.insert(sym);
                 }
               }
@@ -986,13 +1010,13 @@ void checkUseBeforeDefs(FnSymbol* fn) {
               // Check if this is a task intent variable in a with-clause
               // If so, use the same error message as forall loops
               if (isInsideTaskWithClause(use)) {
-                USR_FATAL_CONT(use,
-                               "could not find the outer variable for '%s'",
-                               name);
+                addError(errors, use, false,
+                         "could not find the outer variable for '%s'",
+                         name);
               } else {
-                USR_FATAL_CONT(use,
-                               "'%s' undeclared (first use this function)",
-                               name);
+                addError(errors, use, false,
+                         "'%s' undeclared (first use this function)",
+                         name);
               }
 
               undeclared.insert(name);
@@ -1004,24 +1028,76 @@ void checkUseBeforeDefs(FnSymbol* fn) {
   }
 }
 
+static void reportUseBeforeDefs(const UseBeforeDefErrors& errors) {
+  for (const UseBeforeDefError& error: errors) {
+    if (error.isNote) {
+      USR_PRINT(error.ast, "%s", error.msg.c_str());
+    } else {
+      USR_FATAL_CONT(error.ast, "%s", error.msg.c_str());
+    }
+  }
+}
+
+void checkUseBeforeDefs(FnSymbol* fn) {
+  UseBeforeDefErrors errors;
+
+  findUseBeforeDefs(fn, errors);
+  reportUseBeforeDefs(errors);
+}
+
+//
+// The check only reads the AST, so with --frontend-threads it runs over
+// the functions on a pool of threads. Each thread claims the next function
+// from a shared counter and keeps the errors for it, and they're reported
+// afterwards in the order of gFnSymbols. This is the only part of the
+// early passes that runs in parallel: the rest create AST nodes, which
+// register themselves in the global AST vectors and take ids from a
+// global counter.
+//
 static void checkUseBeforeDefs() {
-  forv_Vec(FnSymbol, fn, gFnSymbols) {
-    checkUseBeforeDefs(fn);
+  int numFns = gFnSymbols.n;
+  int numThreads = std::min(fFrontendThreads, numFns);
+
+  if (numThreads <= 1) {
+    forv_Vec(FnSymbol, fn, gFnSymbols) {
+      checkUseBeforeDefs(fn);
+    }
+  } else {
+    std::vector<UseBeforeDefErrors> errors(numFns);
+    std::vector<std::thread> threads;
+    std::atomic<int> next(0);
+
+    for (int t = 0; t < numThreads; t++) {
+      threads.emplace_back([&]() {
+        for (int i = next++; i < numFns; i = next++) {
+          findUseBeforeDefs(gFnSymbols.v[i], errors[i]);
+        }
+      });
+    }
+    for (std::thread& thread: threads) {
+      thread.join();
+    }
+
+    for (const UseBeforeDefErrors& fnErrors: errors) {
+      reportUseBeforeDefs(fnErrors);
+    }
   }
   USR_STOP();
 }
 
 // guard against "var a:int = a;"
-static void checkSelfDef(CallExpr* call, Symbol* sym) {
+static void checkSelfDef(CallExpr* call, Symbol* sym,
+                         UseBeforeDefErrors& errors) {
   if (call->numActuals() >= 2)
     if (SymExpr* se2 = toSymExpr(call->get(2)))
       if (se2->symbol() == sym)
-        USR_FATAL_CONT(se2, "'%s' is used to define itself", sym->name);
+        addError(errors, se2, false, "'%s' is used to define itself",
+                 sym->name);
 }
 
 // If the AST node defines a symbol, then return that symbol.
 // Otherwise return NULL. Also check for self-defs.
-static Symbol* theDefinedSymbol(BaseAST* ast) {
+static Symbol* theDefinedSymbol(BaseAST* ast, UseBeforeDefErrors& errors) {
   Symbol* retval = NULL;
 
   // A symbol is "defined" if it is the LHS of a move, an assign,
@@ -1045,7 +1121,7 @@ static Symbol* theDefinedSymbol(BaseAST* ast) {
           call->isPrimitive(PRIM_INIT_VAR_SPLIT_DECL)) {
         if (call->get(1) == se) {
           retval = se->symbol();
-          checkSelfDef(call, se->symbol());
+          checkSelfDef(call, se->symbol(), errors);
         }
       }
       // Allow for init() for a task-private variable, which occurs in
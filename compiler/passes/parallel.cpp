@@ -1408,6 +1408,60 @@ CallExpr* createConditionalForDirectOn(CallExpr* call, FnSymbol* fn)
   return call;
 }
 
+//
+// The argument bundle is built in a temp on the spawning function's stack,
+// and the tasking layer normally copies it, since the task may outlive the
+// spawner's frame. That copy isn't needed if the spawner waits for the task
+// before the temp can go away or be rebuilt. This is true of cobegin tasks:
+// each call has its own temp, and the cobegin waits for them all before it
+// exits. Coforall tasks are called from a loop, so each iteration would
+// overwrite the bundle of the task before it. Begin tasks may be waited on by
+// a sync in a caller, after this frame is gone.
+//
+// The wrapper must also not read the bundle after the task body is done,
+// since the spawner may have moved on by then; it does that only to destroy
+// copied arguments.
+//
+static const char* taskArgsInPlaceRejectReason(FnSymbol* fn,
+                                               BundleArgsFnData &baData) {
+  if (!fn->hasFlag(FLAG_COBEGIN_OR_COFORALL) || fn->hasFlag(FLAG_ON) ||
+      fn->hasFlag(FLAG_NON_BLOCKING))
+    return "spawner doesn't wait for the task";
+
+  for (uint8_t needsDestroy : baData.needsDestroy) {
+    if (needsDestroy)
+      return "arguments are destroyed after the task body";
+  }
+
+  forv_Vec(CallExpr, call, *fn->calledBy) {
+    for (Expr* expr = call->parentExpr; expr != NULL; expr = expr->parentExpr) {
+      if (isLoopStmt(expr))
+        return "spawned in a loop";
+    }
+  }
+
+  return NULL;
+}
+
+static void markTaskArgsInPlace(FnSymbol* fn, BundleArgsFnData &baData) {
+  const char* reason = taskArgsInPlaceRejectReason(fn, baData);
+
+  if (reason == NULL)
+    fn->addFlag(FLAG_TASK_ARGS_IN_PLACE);
+
+  if (fReportTaskArgsInPlace) {
+    ModuleSymbol* mod = fn->getModule();
+    if (developer || mod->modTag == MOD_USER) {
+      if (reason == NULL)
+        printf("Task arguments used in place (%s) in module %s (%s:%d)\n",
+               fn->cname, mod->name, fn->fname(), fn->linenum());
+      else
+        printf("Task arguments copied (%s) in module %s (%s:%d): %s\n",
+               fn->cname, mod->name, fn->fname(), fn->linenum(), reason);
+    }
+  }
+}
+
 // For each "nested" function created to represent remote execution,
 // bundle args so they can be passed through a fork function.
 //
@@ -1438,6 +1492,9 @@ static void passArgsToNestedFns() {
         bundleArgs(call, baData);
       }
 
+      if (fTaskArgsInPlace && !fn->hasFlag(FLAG_ON))
+        markTaskArgsInPlace(fn, baData);
+
       if (fn->hasFlag(FLAG_ON)) {
         // Now we can remove the dummy locale arg from the on_fn
         DefExpr*              localeArg = toDefExpr(fn->formals.get(1));
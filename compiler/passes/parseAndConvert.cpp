@@ -264,6 +264,12 @@ static void loadAndConvertModules(UastConverter& c) {
       checkCanLoadCommandLineFile(path.c_str());
     }
   }
+  if (fFrontendThreads > 1) {
+    // parse the command-line files and the modules they might use
+    chpl::parsing::prefetchParses(gContext, commandLinePaths,
+                                  fFrontendThreads);
+    chpl::parsing::prefetchModuleSearchPath(gContext, fFrontendThreads);
+  }
   if (fDynoGenLib) {
     if (fDynoGenStdLib) {
       // gather the standard/internal module paths for --dyno-gen-std
@@ -742,8 +742,9 @@ static void gatherIgnoredVariablesForYield(
     VarSymbol* var = toVarSymbol(foundSe->symbol());
 
     if (var &&
-        var->hasEitherFlag(FLAG_INSERT_AUTO_DESTROY_FOR_EXPLICIT_NEW,
-                           FLAG_EXPR_TEMP))
+        (var->hasEitherFlag(FLAG_INSERT_AUTO_DESTROY_FOR_EXPLICIT_NEW,
+                            FLAG_EXPR_TEMP) ||
+         var->hasFlag(FLAG_YIELD_MOVED)))
       ignoredVariables.insert(var);
   }
 }
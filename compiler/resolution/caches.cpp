@@ -24,9 +24,14 @@
 #include "ResolutionCandidate.h"
 #include "stmt.h"
 #include "stringutil.h"
+#include "symbol.h"
+#include "type.h"
 #include "visibleFunctions.h"
 #include "view.h"
 
+#include <algorithm>
+#include <unordered_map>
+
 
 /************************************* | **************************************
 *                                                                             *
@@ -101,6 +106,99 @@ static bool isCacheEntryMatch(SymbolMap* s1, SymbolMap* s2) {
 }
 
 
+/************************************* | **************************************
+*                                                                             *
+* The shape of a function's formals, for mayMatchShape().  These mirror the   *
+* checks in ResolutionCandidate::computeAlignment(), but only look at counts, *
+* so they give up on anything that depends on names or types.                 *
+*                                                                             *
+************************************** | *************************************/
+
+static std::unordered_map<FnSymbol*, CandidateShape> candidateShapeCache;
+
+static bool isSkippableOperatorFormal(FnSymbol* fn, ArgSymbol* formal) {
+  return fn->hasFlag(FLAG_OPERATOR) &&
+         (formal->typeInfo() == dtMethodToken ||
+          formal->hasFlag(FLAG_ARG_THIS));
+}
+
+static const CandidateShape& getCandidateShape(FnSymbol* fn) {
+  auto it = candidateShapeCache.find(fn);
+
+  if (it != candidateShapeCache.end() &&
+      it->second.numFormals == fn->numFormals()) {
+    return it->second;
+  }
+
+  CandidateShape& shape = candidateShapeCache[fn];
+
+  shape.numFormals       = fn->numFormals();
+  shape.numRequired      = 0;
+  shape.anyArity         = fn->hasFlag(FLAG_INIT_TUPLE);
+  shape.needsMethodToken = false;
+
+  for_formals(formal, fn) {
+    if (formal->variableExpr != NULL) {
+      shape.anyArity = true;
+    } else if (formal->defaultExpr == NULL &&
+               !isSkippableOperatorFormal(fn, formal)) {
+      shape.numRequired++;
+    }
+  }
+
+  if (shape.numFormals > 0 && !fn->hasFlag(FLAG_OPERATOR) &&
+      fn->getFormal(1)->type == dtMethodToken) {
+    shape.needsMethodToken = true;
+  }
+
+  return shape;
+}
+
+bool mayMatchShape(CallInfo& info, FnSymbol* fn) {
+  // named actuals can go anywhere
+  for (int i = 0; i < info.actualNames.n; i++) {
+    if (info.actualNames.v[i] != NULL) {
+      return true;
+    }
+  }
+
+  const CandidateShape& shape = getCandidateShape(fn);
+
+  if (shape.anyArity) {
+    return true;
+  }
+
+  int numActuals = info.actuals.n;
+  int numMethodTokens = 0;
+  for (int i = 0; i < numActuals; i++) {
+    if (info.actuals.v[i]->type == dtMethodToken) {
+      numMethodTokens++;
+    }
+  }
+
+  if (numActuals < shape.numRequired) {
+    return false;
+  }
+
+  if (fn->hasFlag(FLAG_OPERATOR)) {
+    // a method token actual and the one after it can be skipped
+    int numSkippable = std::min(numActuals, 2 * numMethodTokens);
+    return numActuals - numSkippable <= shape.numFormals;
+  }
+
+  if (numActuals > shape.numFormals) {
+    return false;
+  }
+
+  return !shape.needsMethodToken ||
+         (numActuals > 0 && info.actuals.v[0]->type == dtMethodToken);
+}
+
+void freeCandidateShapeCache() {
+  candidateShapeCache.clear();
+}
+
+
 /************************************* | **************************************
 *                                                                             *
 *                                                                             *
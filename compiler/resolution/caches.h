@@ -136,6 +136,33 @@ void genericsCacheSummary(VisibilityInfo& visInfo);
 void genericsCacheSummary(int id);
 void genericsCacheSummary(BaseAST* ast);
 
+//
+// CandidateShapeCache: FnSymbol -> the shape of its formals
+//
+//   mayMatchShape(info, fn): false if fn can't be applicable to the call
+//                            described by info because the number of
+//                            actuals, or the lack of a method token,
+//                            doesn't fit its formals
+//
+//   freeCandidateShapeCache(): frees memory associated with the cache
+//
+// It lets candidate filtering skip most of the overloads of a name
+// like '+' or 'init=' before building a ResolutionCandidate for them.
+//
+class CandidateShape {
+public:
+  int  numFormals;          // when computed, to notice added formals
+  int  numRequired;         // formals without defaults that need an actual
+  bool anyArity;            // varargs; no limit on the number of actuals
+  bool needsMethodToken;    // first formal is a method token
+};
+
+class CallInfo;
+
+bool      mayMatchShape(CallInfo& info, FnSymbol* fn);
+
+void      freeCandidateShapeCache();
+
 // GenericsCacheInfo interface
 void createCacheInfoIfNeeded(FnSymbol* fn);
 void clearCacheInfoIfEmpty(FnSymbol* fn);
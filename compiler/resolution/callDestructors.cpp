@@ -1208,6 +1208,61 @@ static void lowerAutoDestroyRuntimeType(CallExpr* call) {
 //
 // Note that for parallel iterators, yields can occur in task
 // functions (that aren't iterators themselves).
+// Can the yield take ownership of var instead of a copy of it?  That's
+// the case when the yield is var's last mention, in the block var is
+// declared in, and nothing could still refer to it afterwards.  Then
+// addAutoDestroyCalls leaves var alone after the yield.
+static bool canMoveIntoYield(CallExpr* yield, SymExpr* foundSe) {
+  VarSymbol* var = toVarSymbol(foundSe->symbol());
+  if (var == NULL || var->isRef() ||
+      var->defPoint->parentSymbol != yield->parentSymbol ||
+      var->defPoint->parentExpr != yield->parentExpr ||
+      var->hasFlag(FLAG_NO_AUTO_DESTROY)) {
+    return false;
+  }
+
+  Expr* stmt = foundSe->getStmtExpr();
+  if (stmt->parentExpr != yield->parentExpr) {
+    return false;
+  }
+
+  // var isn't mentioned again from where it's read for the yield on
+  for (Expr* e = stmt->next; e != NULL; e = e->next) {
+    std::vector<SymExpr*> mentions;
+    collectSymExprsFor(e, var, mentions);
+    if (!mentions.empty()) {
+      return false;
+    }
+  }
+
+  // and no reference to it was taken
+  for_SymbolSymExprs(se, var) {
+    if (se == foundSe) {
+      continue;
+    }
+    CallExpr* call = toCallExpr(se->parentExpr);
+    if (call == NULL) {
+      return false;
+    }
+    if (call->isPrimitive(PRIM_ADDR_OF) ||
+        call->isPrimitive(PRIM_SET_REFERENCE)) {
+      return false;
+    }
+    if (call->isPrimitive(PRIM_MOVE) || call->isPrimitive(PRIM_ASSIGN)) {
+      if (call->get(1) != se && call->get(1)->isRef()) {
+        return false;
+      }
+    } else if (FnSymbol* fn = call->resolvedFunction()) {
+      if (fn->retTag == RET_REF || fn->retType->symbol->hasFlag(FLAG_REF) ||
+          fn->hasFlag(FLAG_BEGIN)) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
 bool InsertCopiesForYields::shouldProcess(CallExpr* call) {
   return call->isPrimitive(PRIM_YIELD) && call->parentSymbol != NULL;
 }
@@ -1231,6 +1286,8 @@ void InsertCopiesForYields::process(CallExpr* call) {
   // and the yielded value is not an expression temporary
   //  (e.g. for yield someCall(), the result of someCall() doesn't need copy)
   // then we need to copy initialize into the yielded value.
+  // With --elide-yield-copies, a variable whose last mention is the yield
+  // is moved into the yielded value instead.
   if (typeNeedsCopyInitDeinit(yieldedSym->getValType()) &&
       iteratorRetTag == RET_VALUE) {
 
@@ -1246,6 +1303,11 @@ void InsertCopiesForYields::process(CallExpr* call) {
     // necessary here? Could this use doesValueReturnRequireCopy?
     if (foundSe->symbol()->hasFlag(FLAG_INSERT_AUTO_DESTROY) &&
         !foundSe->symbol()->hasFlag(FLAG_EXPR_TEMP)) {
+      if (fElideYieldCopies && canMoveIntoYield(call, foundSe)) {
+        foundSe->symbol()->addFlag(FLAG_YIELD_MOVED);
+        return;
+      }
+
       // Add an auto-copy here.
       SET_LINENO(call);
       Type* type = foundSe->symbol()->getValType();
@@ -5722,11 +5722,19 @@ static void filterCandidate(CallInfo&                  info,
                             VisibilityInfo&            visInfo,
                             FnSymbol*                  fn,
                             Vec<ResolutionCandidate*>& candidates) {
+  bool explain = fExplainVerbose &&
+                 ((explainCallLine && explainCallMatch(info.call)) ||
+                  info.call->id == explainCallID);
+
+  // Skip candidates that can't take this many actuals, except when
+  // explaining, so that their rejection is still shown.
+  if (fPrefilterCandidates && !explain && !mayMatchShape(info, fn)) {
+    return;
+  }
+
   ResolutionCandidate* candidate = new ResolutionCandidate(fn);
 
-  if (fExplainVerbose &&
-      ((explainCallLine && explainCallMatch(info.call)) ||
-       info.call->id == explainCallID)) {
+  if (explain) {
     USR_PRINT(fn, "Considering function: %s", toString(fn));
 
     if (info.call->id == breakOnResolveID) {
@@ -12101,8 +12109,11 @@ void resolve() {
 
   finalizeForallOptimizationsResolution();
 
+  reportInstantiations();
+
   freeCache(genericsCache);
   freeCache(promotionsCache);
+  freeCandidateShapeCache();
 
   visibleFunctionsClear();
 
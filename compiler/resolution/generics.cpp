@@ -41,7 +41,13 @@
 
 #include <inttypes.h>
 
+#include <algorithm>
 #include <cstdlib>
+#include <map>
+#include <vector>
+
+// new instantiations of each root function, for --report-instantiations
+static std::map<FnSymbol*, int> instantiationCounts;
 
 static int             explainInstantiationLine   = -2;
 static ModuleSymbol*   explainInstantiationModule = NULL;
@@ -498,6 +504,10 @@ FnSymbol* instantiateSignature(FnSymbol*  fn,
         }
       }
 
+      if (fReportInstantiations) {
+        instantiationCounts[root]++;
+      }
+
       // We could not find any cached version. So, add the just-created
       // instantiation to the cache.
       addCache(genericsCache, root, newFn, &allSubs);
@@ -631,6 +641,49 @@ static bool fixupDefaultInitCopy(FnSymbol* fn,
 //
 // determine root function in the case of partial instantiation
 //
+// Print the number of instantiations made in user code and in the
+// internal and standard modules, and which functions in the latter were
+// instantiated the most.  These are the ones that get redone on every
+// compile.
+void reportInstantiations() {
+  const size_t numToList = 20;
+  int numUser = 0;
+  int numLibrary = 0;
+  std::vector<std::pair<int, FnSymbol*> > library;
+
+  if (!fReportInstantiations) return;
+
+  for (auto& elem : instantiationCounts) {
+    FnSymbol* fn = elem.first;
+    if (fn->getModule()->modTag == MOD_USER) {
+      numUser += elem.second;
+    } else {
+      numLibrary += elem.second;
+      library.push_back(std::make_pair(elem.second, fn));
+    }
+  }
+
+  std::sort(library.begin(), library.end(),
+            [](const std::pair<int, FnSymbol*>& a,
+               const std::pair<int, FnSymbol*>& b) {
+              if (a.first != b.first) return a.first > b.first;
+              return a.second->id < b.second->id;
+            });
+
+  printf("Instantiations: %d in user modules, %d in library modules "
+         "(of %d generic functions)\n",
+         numUser, numLibrary, (int) library.size());
+
+  for (size_t i = 0; i < library.size() && i < numToList; i++) {
+    FnSymbol* fn = library[i].second;
+    printf("  %6d  %s in module %s (%s:%d)\n",
+           library[i].first, fn->name, fn->getModule()->name,
+           fn->fname(), fn->linenum());
+  }
+
+  instantiationCounts.clear();
+}
+
 FnSymbol* determineRootFunc(FnSymbol* fn) {
   FnSymbol* root = fn;
 
@@ -985,7 +985,7 @@ static Expr* preFoldPrimOp(CallExpr* call) {
   case PRIM_MAYBE_AGGREGATE_ASSIGN: {
     Expr *aggReplacement = preFoldMaybeAggregateAssign(call);
     call->insertAfter(aggReplacement);
-    if (isCondStmt(aggReplacement)) {
+    if (isCondStmt(aggReplacement) || isBlockStmt(aggReplacement)) {
       normalize(aggReplacement);
     }
 
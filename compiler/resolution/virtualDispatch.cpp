@@ -992,6 +992,20 @@ static void filterVirtualChildren() {
   }
 }
 
+// The maps can still hold functions freed after an earlier pass, so this
+// only compares pointers against the functions that are alive.
+void trimVirtualMapsToLiveFns() {
+  std::set<FnSymbol*> liveFns;
+
+  for_alive_in_Vec(FnSymbol, fn, gFnSymbols) {
+    liveFns.insert(fn);
+  }
+
+  trimVirtualMap(liveFns, virtualChildrenMap);
+  trimVirtualMap(liveFns, virtualParentsMap);
+  trimVirtualMap(liveFns, virtualRootsMap);
+}
+
 // map from this type -> name -> fns
 typedef std::map<const char*, std::vector<FnSymbol*> > NameToFns;
 typedef std::map<AggregateType*, NameToFns > TypeToNameToFns;
@@ -30,7 +30,9 @@
 #include <chrono>
 #include <cstdint>
 #include <cstring>
+#include <mutex>
 #include <tuple>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -46,26 +48,110 @@ class ErrorBase;
 namespace detail {
 
 /**
-  Helper type that represents a string and a length.
-  An alternative strategy for storing null bytes in unique'd strings
-  would be to store the length before the allocation -- but
-  then we'd have to allocate such a special buffer in order to query it.
+  The table of unique'd strings.
+
+  It is split into shards by hash, each with its own lock, so strings can
+  be unique'd from more than one thread. Each shard is an open-addressing
+  table with linear probing. The hash of each string is stored next to it,
+  so a probe only compares the strings themselves when the hashes match,
+  and growing a shard doesn't need to rehash any string.
+
+  Strings are never removed one at a time; garbage collection rebuilds
+  the shards with 'keepOnly'.
  */
-struct StringAndLength {
-  const char* str;
-  size_t len;
-};
+class UniqueStringsTable {
+ public:
+  struct Entry {
+    const char* str = nullptr; // nullptr for an empty slot
+    size_t len = 0;
+    size_t hash = 0;
+  };
+
+  class Shard {
+    friend class UniqueStringsTable;
+
+    std::vector<Entry> entries_; // empty, or a power of 2 in size
+    size_t count_ = 0;
+
+    void grow();
+
+   public:
+    /** Lock this before using the shard from more than one thread. */
+    std::mutex mutex;
+
+    /** Return the stored string equal to 'str', or nullptr if none is. */
+    const char* find(const char* str, size_t len, size_t hash) const {
+      if (entries_.empty()) return nullptr;
+      size_t mask = entries_.size() - 1;
+      for (size_t i = (hash >> SHARD_BITS) & mask; ; i = (i + 1) & mask) {
+        const Entry& e = entries_[i];
+        if (e.str == nullptr) return nullptr;
+        if (e.hash == hash && e.len == len && 0 == memcmp(e.str, str, len)) {
+          return e.str;
+        }
+      }
+    }
 
-struct UniqueStrEqual final {
-  bool operator()(StringAndLength lhs, StringAndLength rhs) const {
-    if (lhs.len != rhs.len) return false;
-    return 0 == memcmp(lhs.str, rhs.str, lhs.len);
+    /** Add an entry for a string that isn't already stored. */
+    void insert(const Entry& entry);
+  };
+
+ private:
+  static const int SHARD_BITS = 4;
+  static const size_t NUM_SHARDS = 1 << SHARD_BITS;
+
+  Shard shards_[NUM_SHARDS];
+
+ public:
+  static size_t hashString(const char* str, size_t len) {
+    return chpl::hash(str, len);
   }
-};
 
-struct UniqueStrHash final {
-  size_t operator()(StringAndLength key) const {
-    return chpl::hash(key.str, key.len);
+  Shard& shardFor(size_t hash) {
+    return shards_[hash & (NUM_SHARDS - 1)];
+  }
+
+  /** Add an entry for a string that isn't already stored, without
+      locking. */
+  void insert(const Entry& entry) {
+    shardFor(entry.hash).insert(entry);
+  }
+
+  size_t size() const {
+    size_t ret = 0;
+    for (const auto& shard : shards_) ret += shard.count_;
+    return ret;
+  }
+
+  /** Call 'f' on each entry, in no particular order. */
+  template <typename F>
+  void forEach(F&& f) const {
+    for (const auto& shard : shards_) {
+      for (const auto& e : shard.entries_) {
+        if (e.str != nullptr) f(e);
+      }
+    }
+  }
+
+  /** Remove the entries for which 'keep' returns false. */
+  template <typename F>
+  void keepOnly(F&& keep) {
+    for (auto& shard : shards_) {
+      std::vector<Entry> old;
+      old.swap(shard.entries_);
+      shard.count_ = 0;
+      for (const auto& e : old) {
+        if (e.str != nullptr && keep(e)) shard.insert(e);
+      }
+    }
+  }
+
+  /** Swap the contents (but not the locks) of two tables. */
+  void swap(UniqueStringsTable& other) {
+    for (size_t i = 0; i < NUM_SHARDS; i++) {
+      shards_[i].entries_.swap(other.shards_[i].entries_);
+      std::swap(shards_[i].count_, other.shards_[i].count_);
+    }
   }
 };
 
@@ -101,6 +187,27 @@ template<typename ResultType, typename... ArgTs> class QueryMap;
 class QueryTracerBase;
 template<typename ResultType, typename... ArgTs> class QueryTracer;
 
+// For the query profile, the time spent in queries is attributed to
+// the stack of queries that were running. Each node is a query reached
+// through a particular stack of queries; the parent of a node is the
+// query that was running when it was called. Node 0 is the root.
+struct QueryProfileNode {
+  QueryMapBase* base = nullptr;
+  size_t parent = 0;
+  size_t calls = 0;
+  // time in the query itself, not counting nested queries
+  QueryTimingDuration self = QueryTimingDuration::zero();
+  // time in the query, including nested queries
+  QueryTimingDuration total = QueryTimingDuration::zero();
+  std::unordered_map<QueryMapBase*, size_t> children;
+};
+
+// A query being profiled that hasn't finished yet
+struct QueryProfileFrame {
+  size_t node = 0;
+  QueryTimingDuration childTime = QueryTimingDuration::zero();
+};
+
 template<typename TUP, size_t... I>
 static inline bool queryArgsEqualsImpl(const TUP& lhs, const TUP& rhs, std::index_sequence<I...>)
 {
@@ -412,14 +519,35 @@ class QueryMapBase {
 
     // Time spent inside Context::queryBeginGetResult
     QueryTimingStat systemGetResult;
+
+    // Number of times a saved result was used instead of running
+    // the query (only counted when profiling)
+    size_t savedResultUses = 0;
     // Other per-query timings can be added here as needed
   } timings;
 
    QueryMapBase(const char* queryName, bool isInputQuery)
      : queryName(queryName), isInputQuery(isInputQuery) {
    }
+   // No result in the map was last checked before this revision, as of
+   // the last call to clearOldResults (which can then skip the map if
+   // there's nothing older to remove). -1 if unknown.
+   RevisionNumber oldestLastChecked = -1;
+
    virtual ~QueryMapBase() = 0; // this is an abstract base class
-   virtual void clearOldResults(RevisionNumber currentRevisionNumber) = 0;
+   // Remove the results that were last checked before 'oldestToKeep',
+   // along with the replaced results in oldResults. If 'markKept' is set,
+   // mark the UniqueStrings in results kept from earlier revisions, since
+   // they weren't marked while running this revision. Returns the number
+   // of results removed.
+   virtual size_t clearOldResults(Context* context,
+                                  RevisionNumber currentRevisionNumber,
+                                  RevisionNumber oldestToKeep,
+                                  bool markKept) = 0;
+   virtual size_t numResults() const = 0;
+   // The memory used by the map and its results, not counting any
+   // memory that the results themselves point to.
+   virtual size_t approxBytes() const = 0;
 };
 
 template<typename ResultType,
@@ -448,16 +576,43 @@ class QueryMap final : public QueryMapBase {
   }
   ~QueryMap() = default;
 
-  void clearOldResults(RevisionNumber currentRevisionNumber) override {
+  size_t numResults() const override {
+    return map.size();
+  }
+
+  size_t approxBytes() const override {
+    return map.size() * (sizeof(TheResultType) + sizeof(void*)) +
+           map.bucket_count() * sizeof(void*) +
+           oldResults.capacity() * sizeof(ResultType);
+  }
+
+  size_t clearOldResults(Context* context,
+                         RevisionNumber currentRevisionNumber,
+                         RevisionNumber oldestToKeep,
+                         bool markKept) override {
+    if (!markKept && oldResults.empty() &&
+        oldestLastChecked >= oldestToKeep) {
+      // nothing here is old enough to remove
+      return 0;
+    }
+
     // Performance: Would it be better to move everything to a new map
     // rather than modify it in place as is done here?
     std::vector<ResultType> keptOldResults;
+    RevisionNumber oldest = -1;
+    size_t nRemoved = 0;
 
     auto iter = map.begin();
     while (iter != map.end()) {
       const TheResultType& result = *iter;
-      if (result.lastChecked == currentRevisionNumber) {
+      if (result.lastChecked >= oldestToKeep) {
         // Keep the result
+        if (oldest == -1 || result.lastChecked < oldest) {
+          oldest = result.lastChecked;
+        }
+        if (markKept && result.lastChecked < currentRevisionNumber) {
+          result.markUniqueStringsInResult(context);
+        }
 
         // if we're keeping around old data for the sake of error messages,
         // save it here.
@@ -470,10 +625,13 @@ class QueryMap final : public QueryMapBase {
       } else {
         // Remove the result
         iter = map.erase(iter);
+        nRemoved++;
       }
     }
 
     std::swap(keptOldResults, oldResults);
+    oldestLastChecked = (oldest == -1) ? oldestToKeep : oldest;
+    return nRemoved;
   }
 
   template <typename F>
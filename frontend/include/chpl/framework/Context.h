@@ -110,6 +110,17 @@ class Context {
     /** If 'true', the tmpDir will not be deleted. */
     bool keepTmpDir = false;
 
+    /**
+      Directory in which to persist query results across Contexts
+      (and processes). If it is "", nothing is persisted.
+
+      Currently, this stores the uAST for each top-level file parsed
+      without errors as a library file named by a hash of the file's
+      path and contents, so that a later Context can load it rather
+      than parsing the file again.
+     */
+    std::string queryCacheDir;
+
     /** Tool name (for use when creating the tmpDir in /tmp if needed) */
     std::string toolName = "chpl";
 
@@ -312,8 +323,7 @@ class Context {
   bool detailedErrors = true;
 
   // map that supports uniqueCString / UniqueString
-  using UniqueStringsTableType = std::unordered_set<chpl::detail::StringAndLength, chpl::detail::UniqueStrHash, chpl::detail::UniqueStrEqual>;
-  UniqueStringsTableType uniqueStringsTable;
+  chpl::detail::UniqueStringsTable uniqueStringsTable;
 
   // Map from a query function pointer to appropriate QueryMap object.
   // Maps to an 'owned' heap-allocated thing to manage having subclasses
@@ -346,6 +356,7 @@ class Context {
   bool enableDebugTrace = false;
   bool enableQueryTiming = false;
   bool enableQueryTimingTrace = false;
+  bool enableQueryProfile = false;
   bool currentTerminalSupportsColor_ = terminalSupportsColor(getenv("TERM"));
   bool breakSet = false;
   size_t breakOnHash = 0;
@@ -379,6 +390,10 @@ class Context {
 
   owned<std::ostream> queryTimingTraceOutput = nullptr;
 
+  // for the query profile, see setQueryProfileFlag
+  std::vector<querydetail::QueryProfileNode> queryProfileNodes;
+  std::vector<querydetail::QueryProfileFrame> queryProfileStack;
+
   std::string tmpDir_;
   bool tmpDirExists_ = false;
   bool tmpDirAnchorCreated_ = false;
@@ -849,13 +864,22 @@ class Context {
   }
 
   /**
-    This function runs garbage collection. It will collect UniqueStrings
-    if the last call to advanceToNextRevision passed prepareToGC=true.
+    This function runs garbage collection. It removes the query results
+    that have not been used in the last 'keepRevisions' revisions
+    (including the current one), so the default removes everything not
+    used in the current revision. A long-running tool that revisits the
+    same files can pass a larger number to keep results that are
+    likely to be needed again, while still bounding the memory used
+    by stale ones. Query maps that don't hold anything that old are
+    not visited.
+
+    It will also collect UniqueStrings if the last call to
+    advanceToNextRevision passed prepareToGC=true.
 
     It is an implementation error to call this function while a query
     is running.
    */
-  void collectGarbage();
+  void collectGarbage(int keepRevisions = 1);
 
   /**
     Note an error for the currently running query and report it
@@ -1005,6 +1029,32 @@ class Context {
   /** End query timing trace, closes out stream */
   void endQueryTimingTrace();
 
+  /** Enables/disables the query profile. While it is enabled, the time
+      spent running each query is split into the time in the query
+      itself and the time in the queries it calls, and recorded by the
+      stack of queries that were running. Uses of saved results are
+      counted too. Like query timing, this is only available when
+      CHPL_QUERY_TIMING_AND_TRACE_ENABLED is set (the default in debug
+      builds).
+
+      To see the results, call queryProfileReport or
+      queryProfileFoldedStacks. */
+  void setQueryProfileFlag(bool enable) {
+    enableQueryProfile = enable;
+  }
+
+  /** Output a table with, for each query: the number of times it ran,
+      the number of times a saved result was used instead, the time
+      spent in the query itself and in total, and the number of results
+      stored along with an estimate of their memory. */
+  void queryProfileReport(std::ostream& os);
+
+  /** Output the query profile as folded stacks, one line for each
+      stack of queries: the query names, separated by ';', followed by
+      the time in microseconds spent in the innermost query itself. The
+      output can be given to flamegraph.pl or speedscope. */
+  void queryProfileFoldedStacks(std::ostream& os);
+
   typedef enum {
     NOT_CHECKED_NOT_CHANGED = 0,
     REUSED = 1,
@@ -1123,7 +1173,10 @@ class Context {
   void finishQueryStopwatch(querydetail::QueryMapBase* base,
                             size_t depth,
                             const std::string& args,
-                            querydetail::QueryTimingDuration elapsed);
+                            querydetail::QueryTimingDuration elapsed,
+                            bool endProfileFrame);
+
+  void beginQueryProfileFrame(querydetail::QueryMapBase* base);
 
   template<typename... ArgTs>
   struct ReportOnExit {
@@ -1134,32 +1187,39 @@ class Context {
     bool enableQueryTiming = false;
     size_t depth = 0;
     bool enableQueryTimingTrace = false;
+    bool enableQueryProfile = false;
 
     explicit ReportOnExit(Context *ctx = nullptr,
                           querydetail::QueryMapBase *base_ = nullptr,
                           const std::tuple<ArgTs...> *tup = nullptr,
                           bool enableQueryTiming_ = false, size_t dep = 0,
-                          bool enableQueryTimingTrace_ = false)
+                          bool enableQueryTimingTrace_ = false,
+                          bool enableQueryProfile_ = false)
         : context(ctx), base(base_), tupleOfArgs(tup),
           enableQueryTiming(enableQueryTiming_), depth(dep),
-          enableQueryTimingTrace(enableQueryTimingTrace_) {}
+          enableQueryTimingTrace(enableQueryTimingTrace_),
+          enableQueryProfile(enableQueryProfile_) {}
 
     ReportOnExit(const ReportOnExit& rhs) = delete;
     ReportOnExit(ReportOnExit&& rhs) = default;
     ReportOnExit& operator=(const ReportOnExit& rhs) = delete;
     ReportOnExit& operator=(ReportOnExit&& rhs) = default;
 
-    bool enabled() { return enableQueryTiming || enableQueryTimingTrace; }
+    bool enabled() {
+      return enableQueryTiming || enableQueryTimingTrace || enableQueryProfile;
+    }
 
     void operator()(Stopwatch& stopwatch) {
       // Return if the map is empty (to allow for default-construction).
       if (base == nullptr) return;
-      bool enabled = enableQueryTiming || enableQueryTimingTrace;
-      if (enabled) {
+      if (enabled()) {
         auto elapsed = stopwatch.elapsed();
         std::ostringstream oss;
-        if (tupleOfArgs) querydetail::queryArgsPrint(oss, *tupleOfArgs);
-        context->finishQueryStopwatch(base, depth, oss.str(), elapsed);
+        if (tupleOfArgs && enableQueryTimingTrace) {
+          querydetail::queryArgsPrint(oss, *tupleOfArgs);
+        }
+        context->finishQueryStopwatch(base, depth, oss.str(), elapsed,
+                                      enableQueryProfile);
       }
     };
   };
@@ -1173,8 +1233,11 @@ class Context {
                            const std::tuple<ArgTs...>& tupleOfArgs) {
     ReportOnExit<ArgTs...> s {
       this, base, &tupleOfArgs, enableQueryTiming, queryStack.size(),
-      enableQueryTimingTrace
+      enableQueryTimingTrace, enableQueryProfile
     };
+    if (enableQueryProfile) {
+      beginQueryProfileFrame(base);
+    }
     return querydetail::makeQueryTimingStopwatch(s.enabled(), std::move(s));
   }
   /// \endcond
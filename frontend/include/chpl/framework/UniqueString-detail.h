@@ -29,6 +29,7 @@
 #include "chpl/util/string-escapes.h"
 #include "chpl/framework/stringify-functions.h"
 #include "chpl/util/assertions.h"
+#include "chpl/util/hash.h"
 
 #include <cstring>
 #include <functional>
@@ -272,8 +273,9 @@ struct PODUniqueString {
     return !(*this == other);
   }
   size_t hash() const {
-    std::hash<size_t> hasher;
-    return hasher((size_t) i.v);
+    // the string is stored once, so its address (or its inlined
+    // contents) identifies it; scramble that so all of the bits vary
+    return hash_mix((uint64_t) (uintptr_t) i.v);
   }
   void mark(Context* context) const {
     i.mark(context);
@@ -317,8 +317,7 @@ class UniqueString final {
   int compare(const char* other) const;
 
   size_t hash() const {
-    std::hash<size_t> hasher;
-    return hasher((size_t) s.i.v);
+    return s.hash();
   }
   void swap(UniqueString& other) {
     UniqueString oldThis = *this;
@@ -282,6 +282,10 @@ Context::queryUseSaved(
   const void* queryFuncV = (const void*) queryFunction;
   bool useSaved = queryCanUseSavedResultAndPushIfNot(queryFuncV, r);
 
+  if (enableQueryProfile && useSaved) {
+    r->parentQueryMap->timings.savedResultUses++;
+  }
+
   if (enableDebugTrace) {
     if (useSaved) {
       //printf("QUERY END       %s (...) REUSING BASED ON DEPS %p\n",
@@ -113,14 +113,16 @@ class LibraryFile {
       uint32_t symbolEntryOffset = 0;
       uint32_t astOffset = 0;
       uint32_t locationOffset = 0;
+      // where the code-generated names start within the symbol table;
+      // they are only decoded by loadSymbolCnamesQuery
+      uint32_t cnamesOffset = 0;
       UniqueString symbolPath;
-      std::vector<UniqueString> cnames;
       bool operator==(const SymbolInfo& other) const {
         return symbolEntryOffset == other.symbolEntryOffset &&
                astOffset == other.astOffset &&
                locationOffset == other.locationOffset &&
-               symbolPath == other.symbolPath &&
-               cnames == other.cnames;
+               cnamesOffset == other.cnamesOffset &&
+               symbolPath == other.symbolPath;
       }
       bool operator!=(const SymbolInfo& other) const {
         return !(*this == other);
@@ -153,6 +155,9 @@ class LibraryFile {
     const unsigned char* genCodeSectionData = nullptr;
     size_t genCodeSectionLen = 0;
 
+    const unsigned char* scopeSectionData = nullptr;
+    size_t scopeSectionLen = 0;
+
     // To support deserializing UniqueStrings
     int nStrings = 0;
     const uint32_t* stringOffsetsTable = nullptr;
@@ -176,6 +181,8 @@ class LibraryFile {
              locationSectionLen == other.locationSectionLen &&
              genCodeSectionData == other.genCodeSectionData &&
              genCodeSectionLen == other.genCodeSectionLen &&
+             scopeSectionData == other.scopeSectionData &&
+             scopeSectionLen == other.scopeSectionLen &&
              nStrings == other.nStrings &&
              stringOffsetsTable == other.stringOffsetsTable &&
              llvmIrData == other.llvmIrData &&
@@ -212,6 +219,51 @@ class LibraryFile {
     void mark(Context* context) const;
   };
 
+  /** Helper type to be returned by loadScopeDecls. Stores the names
+      declared directly within a Module or aggregate type, as gathered
+      by the scope resolver when the library was written. */
+  struct ScopeDecls {
+    struct Decl {
+      ID id;
+      uint16_t flags = 0; // IdAndFlags::Flags
+      bool operator==(const Decl& other) const {
+        return id == other.id && flags == other.flags;
+      }
+      bool operator!=(const Decl& other) const {
+        return !(*this == other);
+      }
+    };
+
+    unsigned int flags = 0; // Scope::ScopeFlags
+    std::vector<std::pair<UniqueString, std::vector<Decl>>> declared;
+
+    bool operator==(const ScopeDecls& other) const {
+      return flags == other.flags && declared == other.declared;
+    }
+    bool operator!=(const ScopeDecls& other) const {
+      return !(*this == other);
+    }
+  };
+
+  /** Helper type to be returned by loadScopesQuery */
+  struct ScopeMaps {
+    // key: the symbol path of the Module or aggregate type
+    std::unordered_map<UniqueString, ScopeDecls> scopes;
+
+    bool operator==(const ScopeMaps& other) const {
+      return scopes == other.scopes;
+    }
+    bool operator!=(const ScopeMaps& other) const {
+      return !(*this == other);
+    }
+    void clear() { scopes.clear(); }
+    void swap(ScopeMaps& other) { scopes.swap(other.scopes); }
+    static bool update(ScopeMaps& keep, ScopeMaps& addin) {
+      return defaultUpdate(keep, addin);
+    }
+    void mark(Context* context) const;
+  };
+
 
  private:
   struct ModuleInfo {
@@ -291,12 +343,35 @@ class LibraryFile {
                                                  const LibraryFile* f,
                                                  UniqueString sourceFilePath);
 
+  // decodes the code-generated names of each symbol in the symbol table
+  // returns 'true' if everything is OK, 'false' if there were errors.
+  bool readSymbolCnames(Context* context,
+                        std::vector<std::vector<UniqueString>>& cnames,
+                        const ModuleSection* m) const;
+
+  // computes the code-generated names for each symbol table entry
+  // of the module. These are only needed for summaries, so they are
+  // skipped over when the symbol table is first read.
+  static const std::vector<std::vector<UniqueString>>&
+  loadSymbolCnamesQuery(Context* context,
+                        const LibraryFile* f,
+                        int moduleIndex);
+
   // read the file paths stored in the locations section
   // returns 'true' if everything is OK, 'false' if there were errors.
   bool readLocationPaths(Context* context,
                          std::vector<UniqueString>& paths,
                          const ModuleSection* m) const;
 
+  // computes the file paths stored in the locations section of the module.
+  // The location section is only decoded once a location is requested,
+  // and this way the paths are decoded once rather than for every
+  // location group.
+  static const std::vector<UniqueString>&
+  loadLocationPathsQuery(Context* context,
+                         const LibraryFile* f,
+                         int moduleIndex);
+
   // populate 'map' with Locations by reading a serialized LocationGroup
   // 'symbolTableSymbolAst' needs to be the corresponding uAST for the
   // symbol represented by the location group.
@@ -339,6 +414,18 @@ class LibraryFile {
                      int symbolTableEntryIndex,
                      const uast::AstNode* symbolTableEntryAst);
 
+  // read the scopes stored in the scope section.
+  // returns 'true' if everything is OK, 'false' if there were errors.
+  bool readScopes(Context* context,
+                  ScopeMaps& result,
+                  const ModuleSection* m) const;
+
+  // Computes the declarations for the scopes saved in the module's
+  // scope section
+  static const ScopeMaps& loadScopesQuery(Context* context,
+                                          const LibraryFile* f,
+                                          int moduleIndex);
+
   static owned<llvm::Module>
   loadLlvmModuleImpl(Context* context, const LibraryFile* f, int moduleIndex);
 
@@ -405,6 +492,16 @@ class LibraryFile {
                 int symbolTableEntryIndex,
                 const uast::AstNode* symbolTableEntryAst) const;
 
+  /**
+    Returns the names declared directly within the Module or aggregate
+    type with the passed ID, as they were gathered when this LibraryFile
+    was written. This allows the scope resolver to skip gathering them
+    from the uAST again.
+
+    Returns nullptr if they were not recorded or if an error occurred.
+   */
+  const ScopeDecls* loadScopeDecls(Context* context, ID id) const;
+
 #ifdef HAVE_LLVM
   /**
     Load LLVM IR from a this LibraryFile for a particular module path.
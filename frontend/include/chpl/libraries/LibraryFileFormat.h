@@ -41,10 +41,11 @@ static const uint64_t UAST_SECTION_MAGIC =     0x5453411e5ec110e0;
 static const uint32_t LONG_STRINGS_TABLE_MAGIC =       0x52545301;
 static const uint64_t LOCATION_SECTION_MAGIC = 0x434F4C075ec110e0;
 static const uint64_t GEN_CODE_SECTION_MAGIC = 0x4e4547075ec110e0;
+static const uint64_t SCOPE_SECTION_MAGIC =    0x504353075ec110e0;
 
 // current file format version numbers
 static const uint32_t FORMAT_VERSION_MAJOR =  0;
-static const uint32_t FORMAT_VERSION_MINOR =  1;
+static const uint32_t FORMAT_VERSION_MINOR =  2;
 
 // number of bytes in a file hash -- currently using SHA-256
 static const int HASH_SIZE = 256/8;
@@ -91,6 +92,7 @@ struct ModuleHeader {
   Region longStringsTable;
   Region locationSection;
   Region genCodeSection;
+  Region scopeSection;
   // TODO: add other sections
 
   // followed by a variable-byte length & string storing the module ID
@@ -140,6 +142,20 @@ struct GenCodeSectionHeader {
   // followed by the LLVM IR bc data
 };
 
+struct ScopeSectionHeader {
+  uint64_t magic;
+  uint32_t nScopes;
+  uint32_t unused;
+  // followed by nScopes serialized scopes, each storing
+  //  * a variable-byte length & string storing the scope's symbol path
+  //  * a variable-byte integer storing the Scope flags
+  //  * a variable-byte number of declared names, each followed by
+  //    - a variable-byte length & string storing the name
+  //    - a variable-byte number of declarations, each storing the symbol
+  //      path, post-order ID and number of child IDs of the declaration's
+  //      ID followed by its IdAndFlags flags
+};
+
 
 
 } // end namespace libraries
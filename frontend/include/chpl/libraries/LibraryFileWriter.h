@@ -180,6 +180,13 @@ class LibraryFileWriter {
                       Serializer& ser,
                       const std::string& gen);
 
+  /** Write the scope section, storing the declarations gathered by
+      the scope resolver for the modules and aggregate types in the
+      symbol table. Returns the module-relative offset of the section. */
+  Region writeScopes(uint64_t moduleSectionStart,
+                     Serializer& ser,
+                     LibraryFileSerializationHelper& reg);
+
  public:
   /**
     Construct a LibraryFileWriter to output to 'outputFilePath' */
@@ -193,6 +200,14 @@ class LibraryFileWriter {
     */
   void setSourcePaths(std::vector<UniqueString> paths);
 
+  /**
+    Like 'setSourcePaths' for a single source file whose top-level
+    modules were already parsed, so that it isn't parsed again. This
+    can be used while the parse of that file is still running.
+    */
+  void setSourceModules(UniqueString path,
+                        const std::vector<const uast::Module*>& mods);
+
   /**
     Set the buffer storing the generated LLVM IR byte code
     for the top-level module with the passed name.
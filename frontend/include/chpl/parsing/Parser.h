@@ -20,6 +20,7 @@
 #ifndef CHPL_PARSING_PARSER_H
 #define CHPL_PARSING_PARSER_H
 
+#include "chpl/framework/ErrorBase.h"
 #include "chpl/framework/ErrorMessage.h"
 #include "chpl/framework/Location.h"
 #include "chpl/uast/AstNode.h"
@@ -39,9 +40,15 @@ class Parser final {
  private:
   Context* context_;
   UniqueString parentSymbolPath_;
+  bool useArena_ = true;
 
   Parser(Context* context, UniqueString parentSymbolPath);
 
+  void parseStringToBuilder(const char* path, const char* str,
+                            uast::Builder* builder,
+                            std::vector<owned<ErrorBase>>* deferredErrors,
+                            ParserStats* parseStats);
+
  public:
   /** Construct a parser for parsing a top-level module */
   static Parser createForTopLevelModule(Context* context);
@@ -60,6 +67,15 @@ class Parser final {
   */
   Context* context() { return context_; }
 
+  /**
+   Set whether the nodes parsed are allocated from an arena of their
+   Builder's (the default) or one at a time from the heap. An arena is
+   kept alive by any one of its nodes, so the heap is better when only
+   a few of the nodes are expected to be kept, as when reparsing a file
+   whose earlier uAST will mostly be reused.
+  */
+  void setUseArena(bool useArena) { useArena_ = useArena; }
+
   /**
    Parse a file at a particular path.
   */
@@ -71,6 +87,29 @@ class Parser final {
   */
   uast::BuilderResult parseString(const char* path, const char* str,
                                   ParserStats* parseStats=nullptr);
+
+  /**
+   The uAST built by parseStringDeferred, along with the errors found
+   while parsing, which have not been reported yet.
+  */
+  struct DeferredParse {
+    owned<uast::Builder> builder;
+    std::vector<owned<ErrorBase>> errors;
+  };
+
+  /**
+   Like parseString, but stop before reporting errors or computing the
+   BuilderResult, since both of those use the Context. What's left
+   doesn't, so parses of different strings can run on other threads at
+   the same time. Pass the result to finishParse on the Context's thread.
+  */
+  DeferredParse parseStringDeferred(const char* path, const char* str);
+
+  /**
+   Report the errors from parseStringDeferred and compute its
+   BuilderResult.
+  */
+  uast::BuilderResult finishParse(DeferredParse parse);
 };
 
 } // end namespace parsing
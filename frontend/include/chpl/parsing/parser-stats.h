@@ -20,6 +20,9 @@
 #ifndef CHPL_PARSING_PARSER_STATS_H
 #define CHPL_PARSING_PARSER_STATS_H
 
+#include <chrono>
+#include <string>
+
 namespace chpl {
 
 namespace parsing {
@@ -52,6 +55,11 @@ struct ParserStats {
 
   bool tokenCountingOn = false;
 
+  // to report how quickly the tokens were lexed and parsed
+  std::chrono::steady_clock::time_point fileStartTime;
+  double fileSeconds = 0.0;
+  double totSeconds = 0.0;
+
   void clearHist(int h[]);
 
   void clearLine();
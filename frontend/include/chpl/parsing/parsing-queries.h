@@ -76,6 +76,17 @@ void setFileText(Context* context, UniqueString path, std::string text);
  */
 bool hasFileText(Context* context, const std::string& path);
 
+/**
+ Read the files at the given paths using up to 'numThreads' threads and
+ store their contents for the fileText query, so that parsing them later
+ doesn't wait on each read in turn. Only the reading happens in parallel;
+ the context is only used from the calling thread. Paths whose contents
+ are already stored, or that can't be read, are skipped.
+ */
+void prefetchFileTexts(Context* context,
+                       const std::vector<UniqueString>& paths,
+                       int numThreads);
+
 /**
   This query reads a file (with the fileText query) and then parses it.
 
@@ -98,6 +109,22 @@ const uast::BuilderResult&
 parseFileToBuilderResultAndCheck(Context* context, UniqueString path,
                                  UniqueString parentSymbolPath);
 
+/**
+  Parse the files at the given paths as toplevel modules using up to
+  'numThreads' threads, so that later calls to parseFileToBuilderResult
+  for them find the result already computed. The lexing and parsing
+  happen in parallel; reporting errors and computing each BuilderResult
+  (which uses the context) happen on the calling thread afterwards.
+
+  Errors found while parsing aren't reported here. They are reported
+  when the file's parse is used, as if it had been parsed then. Files
+  that are already parsed, that can't be read, or that come from a
+  library file or the parse cache are skipped.
+ */
+void prefetchParses(Context* context,
+                    const std::vector<UniqueString>& paths,
+                    int numThreads);
+
 std::vector<const uast::AstNode*>
 introspectParsedTopLevelExpressions(Context* context);
 
@@ -234,6 +261,14 @@ const std::vector<UniqueString>& moduleSearchPath(Context* context);
 void setModuleSearchPath(Context* context,
                          std::vector<UniqueString> searchPath);
 
+/**
+  Parse the .chpl files directly within the directories of the module
+  search path with prefetchParses, since a module found by a 'use' or
+  'import' will be one of them. Files that end up not being used only
+  cost the time to parse them.
+ */
+void prefetchModuleSearchPath(Context* context, int numThreads);
+
 /**
   Return a list of paths to be prepended to the internal module path. This is
   likely to be empty unless using --prepend-internal-module-dir when compiling
@@ -584,6 +584,11 @@ class CallInfo {
   // Performance TODO: use SmallVector here?
   std::vector<CallInfoActual> actuals_; // types/params/names of actuals
 
+  // CallInfos are not modified once constructed, and each query lookup
+  // with one as an argument hashes it, so the hash is computed once
+  // (0 means not yet computed). Not compared.
+  mutable size_t hash_ = 0;
+
  public:
   using CallInfoActualIterable = Iterable<std::vector<CallInfoActual>>;
 
@@ -782,9 +787,12 @@ class CallInfo {
     }
   }
   size_t hash() const {
-    return chpl::hash(name_, calledType_, isMethodCall_, isOpCall_,
-                      hasQuestionArg_, isParenless_,
-                      actuals_);
+    if (hash_ == 0) {
+      hash_ = chpl::hash(name_, calledType_, isMethodCall_, isOpCall_,
+                         hasQuestionArg_, isParenless_,
+                         actuals_);
+    }
+    return hash_;
   }
   static bool update(CallInfo& keep,
                      CallInfo& addin) {
@@ -799,6 +807,7 @@ class CallInfo {
     std::swap(hasQuestionArg_, other.hasQuestionArg_);
     std::swap(isParenless_, other.isParenless_);
     actuals_.swap(other.actuals_);
+    std::swap(hash_, other.hash_);
   }
 
   void stringify(std::ostream& ss, chpl::StringifyKind stringKind) const;
@@ -195,6 +195,15 @@ class IdAndFlags {
                       /* isType */ false);
   }
 
+  /** Create an IdAndFlags with flags already computed, e.g. by
+      reading them back from a library file. */
+  static IdAndFlags createWithFlags(ID id, Flags flags) {
+    IdAndFlags ret;
+    ret.id_ = std::move(id);
+    ret.flags_ = flags;
+    return ret;
+  }
+
   static IdAndFlags createForBuiltinFunction() {
     return IdAndFlags(ID(),
                       /* isPublic */ true,
@@ -225,6 +234,7 @@ class IdAndFlags {
   }
 
   const ID& id() const { return id_; }
+  Flags flags() const { return flags_; }
   bool isPublic() const {
     return (flags_ & PUBLIC) != 0;
   }
@@ -672,6 +682,12 @@ class Scope {
   Scope(Context* context, const uast::AstNode* ast, const Scope* parentScope,
         bool autoUsesModules);
 
+  /** Construct a Scope for a particular AST node and with a particular
+      parent, using declarations and flags that were already gathered
+      (e.g. when a library file was written) */
+  Scope(const uast::AstNode* ast, const Scope* parentScope,
+        ScopeFlags flags, DeclMap declared);
+
   /** Add a builtin type with the provided name. This needs to
       be called to populate the root scope with builtins. */
   void addBuiltinType(UniqueString name);
@@ -709,6 +725,9 @@ class Scope {
 
   const DeclMap& declared() const { return declared_; }
 
+  /** Returns the flags computed for this Scope */
+  ScopeFlags flags() const { return flags_; }
+
   /** Returns 'true' if this Scope directly contains use or import statements
       including the automatic 'use' for the standard library. */
   bool containsUseImport() const {
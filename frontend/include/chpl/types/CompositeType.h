@@ -101,6 +101,9 @@ class CompositeType : public Type {
   const CompositeType* instantiatedFrom_ = nullptr;
   // If so, what types/params should we use?
   SubstitutionsMap subs_;
+  // The hash of subs_, so that comparing types with different
+  // substitutions doesn't need to compare the maps.
+  size_t subsHash_ = 0;
 
   Linkage linkage_ = uast::Decl::DEFAULT_LINKAGE;
 
@@ -112,6 +115,7 @@ class CompositeType : public Type {
     : Type(tag), id_(id), name_(name),
       instantiatedFrom_(instantiatedFrom),
       subs_(std::move(subs)),
+      subsHash_(hashUnorderedMap(subs_)),
       linkage_(linkage) {
 
     // check instantiated only from same type of object
@@ -132,6 +136,7 @@ class CompositeType : public Type {
     return id_ == other->id_ &&
            name_ == other->name_ &&
            instantiatedFrom_ == other->instantiatedFrom_ &&
+           subsHash_ == other->subsHash_ &&
            subs_ == other->subs_ &&
            linkage_ == other->linkage_;
   }
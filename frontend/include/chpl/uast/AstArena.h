@@ -0,0 +1,109 @@
+/*
+ * Copyright 2021-2026 Hewlett Packard Enterprise Development LP
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CHPL_UAST_ASTARENA_H
+#define CHPL_UAST_ASTARENA_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace chpl {
+namespace uast {
+namespace detail {
+
+/**
+  A bump allocator for uAST nodes.
+
+  Each Builder can have an arena, which the Parser makes the place new
+  nodes come from (with an AstArena::Use) while it parses into that
+  Builder. The nodes are then carved out of the arena instead of being
+  allocated one at a time. The arena counts the nodes still alive in
+  it, plus one for its Builder, and frees its memory when that count
+  reaches zero. That means a node can safely outlive its Builder and its
+  BuilderResult, be moved somewhere else, or be freed on another thread.
+  Its destructor still runs as usual, but freeing it only lowers the
+  count.
+
+  Nodes created while no Use is active on the thread are allocated from
+  the heap as before.
+ */
+class AstArena {
+ private:
+  std::vector<char*> chunks_;
+  char* next_ = nullptr;
+  size_t left_ = 0;
+  std::atomic<size_t> refs_;
+
+  AstArena() : refs_(1) { }
+  ~AstArena();
+
+ public:
+  AstArena(const AstArena&) = delete;
+  AstArena& operator=(const AstArena&) = delete;
+
+  /** Creates an arena. The caller holds its first reference. */
+  static AstArena* create() {
+    return new AstArena();
+  }
+
+  /** Returns the arena new nodes on this thread are allocated from,
+      or nullptr. */
+  static AstArena* current();
+
+  /** Allocates 'size' bytes that stay valid until the arena is freed,
+      and counts them as a live node. */
+  void* allocate(size_t size);
+
+  /** Keeps the arena alive until a matching call to 'release'. */
+  void retain() {
+    refs_++;
+  }
+
+  /** Drops a reference, such as the one held by a node allocated with
+      'allocate' when that node is freed. */
+  void release() {
+    if (--refs_ == 0) delete this;
+  }
+
+  /**
+    Makes 'arena' (or the heap, for nullptr) where new nodes on this
+    thread are allocated until the Use is destroyed. A Use holds no
+    reference, so the arena must outlive it. Uses are only made as local
+    variables, so they always end on their own thread and in the
+    reverse order they were made in.
+   */
+  class Use {
+   private:
+    AstArena* saved_;
+
+   public:
+    explicit Use(AstArena* arena);
+    ~Use();
+    Use(const Use&) = delete;
+    Use& operator=(const Use&) = delete;
+  };
+};
+
+
+} // end namespace detail
+} // end namespace uast
+} // end namespace chpl
+
+#endif
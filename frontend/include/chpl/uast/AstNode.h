@@ -202,6 +202,11 @@ class AstNode {
  public:
   virtual ~AstNode() = 0; // this is an abstract base class
 
+  // Nodes are allocated from the current Builder's arena, if there is
+  // one (see detail::AstArena).
+  static void* operator new(size_t size);
+  static void operator delete(void* ptr);
+
   // Magic constant to indicate no such child exists.
   static constexpr int NO_CHILD = -1;
 
@@ -23,6 +23,7 @@
 #include "chpl/framework/UniqueString.h"
 #include "chpl/framework/mark-functions.h"
 #include "chpl/framework/update-functions.h"
+#include "chpl/uast/AstArena.h"
 #include "chpl/uast/AstNode.h"
 #include "chpl/uast/BuilderResult.h"
 #include "chpl/uast/Variable.h"
@@ -66,6 +67,10 @@ class Builder final {
   // maps from a uAST pointer to a location
   using AstLocMap = std::unordered_map<const AstNode*, Location>;
 
+  // the nodes parsed into this Builder are allocated from this arena,
+  // if there is one (see arena())
+  detail::AstArena* arena_ = nullptr;
+
   Context* context_ = nullptr;
   UniqueString startingSymbolPath_;
   BuilderResult br;
@@ -142,8 +147,19 @@ class Builder final {
                                           UniqueString parentSymbolPath,
                                           const libraries::LibraryFile* lib);
 
+  ~Builder();
+  Builder(const Builder&) = delete;
+  Builder& operator=(const Builder&) = delete;
+
   Context* context() const { return context_; }
 
+  /**
+    Return the arena that nodes built for this Builder can be allocated
+    from, creating it if needed. Nodes only come from it while an
+    AstArena::Use for it is active, as the Parser does while parsing.
+   */
+  detail::AstArena* arena();
+
   /**
     Save a toplevel expression in to the builder.
     This is called by the parser.
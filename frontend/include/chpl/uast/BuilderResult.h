@@ -20,6 +20,7 @@
 #ifndef CHPL_UAST_BUILDERRESULT_H
 #define CHPL_UAST_BUILDERRESULT_H
 
+#include "chpl/framework/Location.h"
 #include "chpl/framework/UniqueString.h"
 #include "chpl/framework/mark-functions.h"
 #include "chpl/framework/update-functions.h"
@@ -96,6 +97,71 @@ namespace parsing {
 namespace uast {
 
 
+/**
+  A map from ID to Location that stores each Location in 16 bytes
+  rather than the 24 of a Location. The locations in a BuilderResult
+  nearly all share one path and span few lines, so the path is stored
+  as an index into a small table and the last line as a distance from
+  the first. Locations that can't be stored that way are kept as-is
+  on the side.
+ */
+class LocationMap final {
+ private:
+  struct Entry {
+    int firstLine;
+    int firstColumn;
+    int lastColumn;
+    uint16_t lastLineDelta;
+    // index into paths_, or OVERFLOW_PATH_IDX in which case
+    // firstLine is an index into overflow_
+    uint16_t pathIdx;
+
+    bool operator==(const Entry& other) const {
+      return firstLine == other.firstLine &&
+             firstColumn == other.firstColumn &&
+             lastColumn == other.lastColumn &&
+             lastLineDelta == other.lastLineDelta &&
+             pathIdx == other.pathIdx;
+    }
+    bool operator!=(const Entry& other) const {
+      return !(*this == other);
+    }
+  };
+
+  static const uint16_t OVERFLOW_PATH_IDX = 0xffff;
+
+  llvm::DenseMap<ID, Entry> map_;
+  std::vector<UniqueString> paths_;
+  std::vector<Location> overflow_;
+
+ public:
+  /** Set the location for 'id', replacing any earlier one */
+  void set(const ID& id, const Location& loc);
+
+  /** If 'id' has a location, set 'loc' to it and return 'true'.
+      Otherwise, return 'false'. */
+  bool find(const ID& id, Location& loc) const;
+
+  size_t size() const { return map_.size(); }
+
+  bool operator==(const LocationMap& other) const {
+    return map_ == other.map_ &&
+           paths_ == other.paths_ &&
+           overflow_ == other.overflow_;
+  }
+  bool operator!=(const LocationMap& other) const {
+    return !(*this == other);
+  }
+
+  void swap(LocationMap& other) {
+    map_.swap(other.map_);
+    paths_.swap(other.paths_);
+    overflow_.swap(other.overflow_);
+  }
+
+  void mark(Context* context) const;
+};
+
 /**
   This type records the result of building some AST.
  */
@@ -124,13 +190,13 @@ class BuilderResult final {
   llvm::DenseMap<ID, ID> idToParentId_;
 
   // Goes from ID to Location, applies to all AST nodes except Comment
-  llvm::DenseMap<ID, Location> idToLocation_;
+  LocationMap idToLocation_;
 
   // Expand maps for locations of things that are not captured by AST.
   // The key is the ID of the relevant AST, and value is the location
   // of interest.
   #define LOCATION_MAP(ast__, location__) \
-    llvm::DenseMap<ID, Location> CHPL_ID_LOC_MAP(ast__, location__);
+    LocationMap CHPL_ID_LOC_MAP(ast__, location__);
   #include "all-location-maps.h"
   #undef LOCATION_MAP
 
@@ -376,6 +376,7 @@ PRAGMA(NIL_FROM_THIS, ypr, "nil from this", ncm)
 // Tells resolution to use this function's line number even if that function
 // has COMPILER_GENERATED.
 PRAGMA(LINE_NUMBER_OK, ypr, "lineno ok", ncm)
+PRAGMA(LIGHTWEIGHT_TASK, npr, "lightweight task", "with BEGIN_BLOCK, the task body cannot block and may be run to completion without a stack of its own")
 
 PRAGMA(LLVM_READNONE, ypr, "llvm readnone", ncm)
 PRAGMA(LLVM_RETURN_NOALIAS, ypr, "llvm return noalias", ncm)
@@ -598,6 +599,7 @@ PRAGMA(CG_INTERIM_INST, npr, "cg interim instantiation", ncm)
 PRAGMA(SYNC, ypr, "sync", ncm)
 
 PRAGMA(SYNTACTIC_DISTRIBUTION, ypr, "syntactic distribution", ncm)
+PRAGMA(TASK_ARGS_IN_PLACE, npr, "task args in place", "the spawning function waits for the task before its argument bundle goes away, so the tasking layer may use the bundle without copying it")
 PRAGMA(TASK_FN_FROM_ITERATOR_FN, npr, "task fn from iterator fn", ncm)
 PRAGMA(TASK_SPAWN_IMPL_FN, ypr, "task spawn impl fn", ncm)
 PRAGMA(TASK_COMPLETE_IMPL_FN, ypr, "task complete impl fn", ncm)
@@ -646,6 +648,7 @@ PRAGMA(WRAPPER, npr, "wrapper", "wrapper function")
 PRAGMA(WRAPPER_NEEDS_START_FENCE, npr, "wrapper needs start fence", "add PRIM_START_RMEM_FENCE to the start of the wrapper function")
 PRAGMA(WRAPPER_NEEDS_FINISH_FENCE, npr, "wrapper needs finish fence", "add PRIM_FINISH_RMEM_FENCE to the end of the wrapper function")
 PRAGMA(WRAP_WRITTEN_FORMAL, npr, "wrap written formal", "formal argument for wrapper for out/inout intent")
+PRAGMA(YIELD_MOVED, npr, "yield moved", "variable is moved into the value of a yield rather than copied")
 PRAGMA(YIELD_WITHIN_ON, npr, "yield within on", "iterator that yields within an on")
 
 
@@ -22,6 +22,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <functional>
 #include <map>
 #include <unordered_map>
@@ -48,39 +49,71 @@ struct hasher {
 
 } // end namespace detail
 
+// Constants from wyhash
+constexpr uint64_t HASH_SECRET_0 = 0xa0761d6478bd642f;
+constexpr uint64_t HASH_SECRET_1 = 0xe7037ed1a0b428db;
+constexpr uint64_t HASH_SECRET_2 = 0x8ebc6af09c88c6e3;
+
+// Multiply two 64-bit values and fold the 128-bit product, as in wyhash.
+// Each output bit depends on every input bit of both arguments.
+inline uint64_t hash_mum(uint64_t a, uint64_t b) {
+#ifdef __SIZEOF_INT128__
+  __uint128_t r = (__uint128_t) a * b;
+  return (uint64_t) r ^ (uint64_t) (r >> 64);
+#else
+  uint64_t ha = a >> 32, la = (uint32_t) a;
+  uint64_t hb = b >> 32, lb = (uint32_t) b;
+  uint64_t hh = ha * hb, hl = ha * lb, lh = la * hb, ll = la * lb;
+  uint64_t mid = (ll >> 32) + (uint32_t) hl + (uint32_t) lh;
+  uint64_t lo = (mid << 32) | (uint32_t) ll;
+  uint64_t hi = hh + (hl >> 32) + (lh >> 32) + (mid >> 32);
+  return lo ^ hi;
+#endif
+}
+
+// Scramble a value that may have few varying bits (like a pointer
+// or a small integer) so that it can be used as a hash
+inline size_t hash_mix(uint64_t x) {
+  return (size_t) hash_mum(x ^ HASH_SECRET_0, HASH_SECRET_1);
+}
+
 // Combine two hash functions
 inline size_t hash_combine(size_t hash, size_t other) {
-  return hash ^ (other + 0x9e3779b9 + (hash << 6) + (hash >> 2));
+  // unlike XOR or addition, this is not symmetric, so the order of
+  // the combined hashes matters
+  return (size_t) hash_mum((uint64_t) hash ^ HASH_SECRET_0,
+                           (uint64_t) other ^ HASH_SECRET_1);
 }
 
-constexpr uint64_t FNV_offset_basis = 0xcbf29ce484222325;
-constexpr uint64_t FNV_prime        = 0x100000001b3;
-
-// FNV-1a hash function for null-terminated C strings
-inline size_t hash(const char* s)
+// Hash function for strings with length. This follows wyhash, reading
+// 8 bytes at a time.
+inline size_t hash(const char* s, size_t len)
 {
-  uint64_t seed = FNV_offset_basis;
-  for(char c; (c = *s) != '\0'; ++s)
-    seed = (seed ^ static_cast<unsigned char>(c)) * FNV_prime;
-  return (size_t) seed;
+  uint64_t seed = HASH_SECRET_2 ^ len;
+  size_t i = 0;
+  for (; i + 8 <= len; i += 8) {
+    uint64_t v;
+    memcpy(&v, s + i, 8);
+    seed = hash_mum(v ^ HASH_SECRET_0, seed ^ HASH_SECRET_1);
+  }
+  uint64_t tail = 0;
+  if (i < len) {
+    memcpy(&tail, s + i, len - i);
+  }
+  seed = hash_mum(tail ^ HASH_SECRET_0, seed ^ HASH_SECRET_1);
+  return (size_t) hash_mum(seed ^ HASH_SECRET_2, len ^ HASH_SECRET_1);
 }
 
-// FNV-1a hash function for strings with length
-inline size_t hash(const char* s, size_t len)
+// Hash function for null-terminated C strings
+inline size_t hash(const char* s)
 {
-  uint64_t seed = FNV_offset_basis;
-  for(size_t i = 0; i < len; i++)
-    seed = (seed ^ static_cast<unsigned char>(s[i])) * FNV_prime;
-  return (size_t) seed;
+  return hash(s, strlen(s));
 }
 
-// FNV-1a hash function for C++ std::string
+// Hash function for C++ std::string
 inline size_t hash(const std::string& s)
 {
-  uint64_t seed = FNV_offset_basis;
-  for(char c : s)
-    seed = (seed ^ static_cast<unsigned char>(c)) * FNV_prime;
-  return (size_t) seed;
+  return hash(s.data(), s.size());
 }
 
 // Default hash function for one argument
@@ -140,11 +173,15 @@ inline size_t hashSet(const std::set<T>& key) {
   return ret;
 }
 
+// The entries are combined by addition, so the result doesn't depend on
+// the iteration order and the entries don't need to be sorted.
 template <typename K, typename V>
 inline size_t hashUnorderedMap(const std::unordered_map<K, V>& key) {
-  std::vector<std::pair<K, V>> sorted(key.begin(), key.end());
-  std::sort(sorted.begin(), sorted.end(), FirstElementComparator<K, V>());
-  return hashVector(sorted);
+  size_t ret = 0;
+  for (const auto& pair : key) {
+    ret += hash_combine(hash(pair.first), hash(pair.second));
+  }
+  return hash_combine(ret, key.size());
 }
 
 template<typename T>
@@ -32,6 +32,7 @@
 #include "llvm/Config/llvm-config.h"
 #include "llvm/Support/FileSystem.h"
 
+#include <algorithm>
 #include <chrono>
 #include <fstream>
 #include <iomanip>
@@ -54,6 +55,29 @@ namespace chpl {
 #include "chpl/framework/all-global-strings.h"
 #undef X
     }
+
+    void UniqueStringsTable::Shard::grow() {
+      std::vector<Entry> old;
+      old.swap(entries_);
+      entries_.resize(old.empty() ? 64 : old.size() * 2);
+      size_t mask = entries_.size() - 1;
+      for (const auto& e : old) {
+        if (e.str == nullptr) continue;
+        size_t i = (e.hash >> SHARD_BITS) & mask;
+        while (entries_[i].str != nullptr) i = (i + 1) & mask;
+        entries_[i] = e;
+      }
+    }
+
+    void UniqueStringsTable::Shard::insert(const Entry& entry) {
+      // keep the load at or below 1/2 so that probes stay short
+      if (2 * (count_ + 1) > entries_.size()) grow();
+      size_t mask = entries_.size() - 1;
+      size_t i = (entry.hash >> SHARD_BITS) & mask;
+      while (entries_[i].str != nullptr) i = (i + 1) & mask;
+      entries_[i] = entry;
+      count_++;
+    }
   } // namespace detail
 
 
@@ -64,6 +88,7 @@ void Context::Configuration::swap(Context::Configuration& other) {
   std::swap(chplEnvOverrides, other.chplEnvOverrides);
   std::swap(tmpDir, other.tmpDir);
   std::swap(keepTmpDir, other.keepTmpDir);
+  std::swap(queryCacheDir, other.queryCacheDir);
   std::swap(toolName, other.toolName);
   std::swap(includeComments, other.includeComments);
   std::swap(disableErrorBreakpoints, other.disableErrorBreakpoints);
@@ -72,13 +97,14 @@ void Context::Configuration::swap(Context::Configuration& other) {
 void Context::setupGlobalStrings() {
   if (this == &detail::rootContext) {
     detail::initGlobalStrings();
-    for (auto& v : uniqueStringsTable) {
-      doNotCollectUniqueCString(v.str);
-    }
+    uniqueStringsTable.forEach([this](const detail::UniqueStringsTable::Entry& e) {
+      doNotCollectUniqueCString(e.str);
+    });
   } else {
-    for (const auto& v : detail::rootContext.uniqueStringsTable) {
-      uniqueStringsTable.insert(v);
-    }
+    detail::rootContext.uniqueStringsTable.forEach(
+      [this](const detail::UniqueStringsTable::Entry& e) {
+        uniqueStringsTable.insert(e);
+      });
   }
 }
 
@@ -88,7 +114,7 @@ void Context::swap(Context& other) {
   std::swap(computedChplEnv, other.computedChplEnv);
   std::swap(chplEnv, other.chplEnv);
   std::swap(detailedErrors, other.detailedErrors);
-  std::swap(uniqueStringsTable, other.uniqueStringsTable);
+  uniqueStringsTable.swap(other.uniqueStringsTable);
   std::swap(queryDB, other.queryDB);
   std::swap(modNameToFilepath, other.modNameToFilepath);
   std::swap(queryStack, other.queryStack);
@@ -331,8 +357,8 @@ Context::~Context() {
   errorCollectionStack.clear();
 
   // free all the unique'd strings
-  for (auto& item: uniqueStringsTable) {
-    char* buf = (char*) item.str;
+  uniqueStringsTable.forEach([this](const detail::UniqueStringsTable::Entry& e) {
+    char* buf = (char*) e.str;
     buf -= UNIQUED_STRING_METADATA_BYTES;
     char doNotCollect = buf[UNIQUED_STRING_METADATA_LEN + 1];
     // Root context  : Free all strings
@@ -340,7 +366,7 @@ Context::~Context() {
     if (this == &detail::rootContext || !doNotCollect) {
       free(buf);
     }
-  }
+  });
 
   // delete the tmp dir
   cleanupTmpDirIfNeeded();
@@ -397,10 +423,10 @@ char* Context::setupStringMetadata(char* buf, size_t len) {
 
 // allocates new storage for the string if it was not found
 const char* Context::getOrCreateUniqueString(const char* str, size_t len) {
-  chpl::detail::StringAndLength key = {str, len};
-  auto search = this->uniqueStringsTable.find(key);
-  if (search != this->uniqueStringsTable.end()) {
-    const char* ret = search->str;
+  size_t hash = detail::UniqueStringsTable::hashString(str, len);
+  auto& shard = this->uniqueStringsTable.shardFor(hash);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  if (const char* ret = shard.find(str, len, hash)) {
     // update the GC mark
     this->markUniqueCString(ret);
     return ret;
@@ -415,8 +441,7 @@ const char* Context::getOrCreateUniqueString(const char* str, size_t len) {
   // null terminate
   s[len] = 0x0;
   // Add it to the table
-  chpl::detail::StringAndLength ret = {s, len};
-  this->uniqueStringsTable.insert(search, ret);
+  shard.insert({s, len, hash});
   return s;
 }
 
@@ -502,10 +527,10 @@ const char* Context::uniqueCStringConcatLen(const char* s1, size_t len1,
   s[len] = '\0';
 
   // Check for it in the table
-  chpl::detail::StringAndLength key = {s, len};
-  auto search = this->uniqueStringsTable.find(key);
-  if (search != this->uniqueStringsTable.end()) {
-    const char* ret = search->str;
+  size_t hash = detail::UniqueStringsTable::hashString(s, len);
+  auto& shard = this->uniqueStringsTable.shardFor(hash);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  if (const char* ret = shard.find(s, len, hash)) {
     // update the GC mark
     this->markUniqueCString(ret);
     free(buf);
@@ -513,8 +538,7 @@ const char* Context::uniqueCStringConcatLen(const char* s1, size_t len1,
   }
 
   // Add it to the table
-  chpl::detail::StringAndLength ret = {s, len};
-  this->uniqueStringsTable.insert(search, ret);
+  shard.insert({s, len, hash});
   return s;
 }
 
@@ -849,22 +873,41 @@ void Context::setBreakOnHash(size_t hashVal) {
   breakOnHash = hashVal;
 }
 
-void Context::collectGarbage() {
+void Context::collectGarbage(int keepRevisions) {
   // if there are no parent queries, collect some garbage
   CHPL_ASSERT(queryStack.size() == 0);
+  CHPL_ASSERT(keepRevisions >= 1);
 
   if (enableDebugTrace) {
     printf("%i COLLECTING GARBAGE\n", queryTraceDepth);
   }
 
-  // clear out the saved old results
+  bool collectStrings =
+    this->lastPrepareToGCRevisionNumber == this->currentRevisionNumber;
+
+  // Results kept from earlier revisions only depend on results that were
+  // checked in the same revision or later, so nothing that is kept
+  // refers to something removed here.
+  RevisionNumber oldestToKeep = this->currentRevisionNumber - keepRevisions + 1;
+
+  // clear out the results that are too old and the saved old results
   // warning: this loop proceeds in a nondeterministic order
+  size_t nResultsRemoved = 0;
   for (auto& dbEntry: queryDB) {
     QueryMapBase* queryMapBase = dbEntry.second.get();
-    queryMapBase->clearOldResults(this->currentRevisionNumber);
+    nResultsRemoved +=
+      queryMapBase->clearOldResults(this, this->currentRevisionNumber,
+                                    oldestToKeep,
+                                    /* markKept */ collectStrings &&
+                                                   keepRevisions > 1);
   }
 
-  if (this->lastPrepareToGCRevisionNumber == this->currentRevisionNumber) {
+  if (enableDebugTrace) {
+    printf("%i COLLECTED %i query results\n", queryTraceDepth,
+           (int) nResultsRemoved);
+  }
+
+  if (collectStrings) {
     // remove UniqueStrings that have not been marked
 
     size_t nUniqueStringsBefore = uniqueStringsTable.size();
@@ -872,10 +915,9 @@ void Context::collectGarbage() {
     // Performance: Would it be better to modify the table in-place
     // rather than creating a new table as is done here?
     char gcMark = this->gcCounter & 0xff;
-    UniqueStringsTableType newTable;
     std::vector<char*> toFree;
     // warning: this loop proceeds in a nondeterministic order
-    for (auto& e: uniqueStringsTable) {
+    uniqueStringsTable.keepOnly([&](const detail::UniqueStringsTable::Entry& e) {
       const char* key = e.str;
       char* buf = (char*)key;
       buf -= UNIQUED_STRING_METADATA_BYTES; // find start of allocation
@@ -883,21 +925,21 @@ void Context::collectGarbage() {
       buf += UNIQUED_STRING_METADATA_LEN; // pass the length
       // buf[1] is the doNotCollectMark
       if (buf[1] || buf[0] == gcMark) {
-        newTable.insert(e);
         if (enableDebugTrace) {
           printf("%i COPYING OVER UNIQUESTRING %s\n", queryTraceDepth, key);
         }
+        return true;
       } else {
         toFree.push_back(allocation);
         if (enableDebugTrace) {
           printf("%i WILL FREE UNIQUESTRING %s\n", queryTraceDepth, key);
         }
+        return false;
       }
-    }
+    });
     for (char* allocation: toFree) {
       free(allocation);
     }
-    uniqueStringsTable.swap(newTable);
 
     if (enableDebugTrace) {
       size_t nUniqueStringsAfter = uniqueStringsTable.size();
@@ -1372,7 +1414,8 @@ void Context::queryTimingReport(std::ostream& os) {
 void Context::finishQueryStopwatch(querydetail::QueryMapBase* base,
                                    size_t depth,
                                    const std::string& args,
-                                   querydetail::QueryTimingDuration elapsed) {
+                                   querydetail::QueryTimingDuration elapsed,
+                                   bool endProfileFrame) {
   if (enableQueryTiming) {
     base->timings.query.update(elapsed);
   }
@@ -1387,6 +1430,132 @@ void Context::finishQueryStopwatch(querydetail::QueryMapBase* base,
         << nMicroseconds << ' '
         << args << '\n';
   }
+  if (endProfileFrame) {
+    CHPL_ASSERT(!queryProfileStack.empty());
+    QueryProfileFrame frame = queryProfileStack.back();
+    queryProfileStack.pop_back();
+
+    QueryProfileNode& node = queryProfileNodes[frame.node];
+    CHPL_ASSERT(node.base == base);
+    node.calls++;
+    node.self += elapsed - frame.childTime;
+    node.total += elapsed;
+    if (!queryProfileStack.empty()) {
+      queryProfileStack.back().childTime += elapsed;
+    }
+  }
+}
+
+void Context::beginQueryProfileFrame(querydetail::QueryMapBase* base) {
+  if (queryProfileNodes.empty()) {
+    // add the root
+    queryProfileNodes.emplace_back();
+  }
+
+  size_t parent = 0;
+  if (!queryProfileStack.empty()) {
+    parent = queryProfileStack.back().node;
+  }
+
+  size_t node = queryProfileNodes.size();
+  auto pair = queryProfileNodes[parent].children.emplace(base, node);
+  if (pair.second) {
+    QueryProfileNode n;
+    n.base = base;
+    n.parent = parent;
+    queryProfileNodes.push_back(std::move(n));
+  } else {
+    node = pair.first->second;
+  }
+
+  QueryProfileFrame frame;
+  frame.node = node;
+  queryProfileStack.push_back(frame);
+}
+
+void Context::queryProfileReport(std::ostream& os) {
+  auto ms = [](QueryTimingDuration d) {
+    return std::chrono::duration<double, std::milli>(d).count();
+  };
+
+  struct Totals {
+    size_t calls = 0;
+    QueryTimingDuration self = QueryTimingDuration::zero();
+    QueryTimingDuration total = QueryTimingDuration::zero();
+  };
+  std::unordered_map<QueryMapBase*, Totals> totals;
+  for (const auto& node : queryProfileNodes) {
+    if (node.base == nullptr) continue;
+    // only count the time of the outermost call of a recursive query
+    bool recursive = false;
+    for (size_t p = node.parent; p != 0; p = queryProfileNodes[p].parent) {
+      if (queryProfileNodes[p].base == node.base) {
+        recursive = true;
+        break;
+      }
+    }
+    Totals& t = totals[node.base];
+    t.calls += node.calls;
+    t.self += node.self;
+    if (!recursive) {
+      t.total += node.total;
+    }
+  }
+
+  // sort by self time
+  std::vector<QueryMapBase*> bases;
+  for (const auto& it : queryDB) {
+    bases.push_back(it.second.get());
+  }
+  std::sort(bases.begin(), bases.end(),
+            [&](QueryMapBase* a, QueryMapBase* b) {
+    return totals[a].self > totals[b].self;
+  });
+
+  std::ios state(nullptr);
+  state.copyfmt(os);
+
+  os << "query profile\n";
+
+  auto w1 = 40;
+  auto w2 = 15;
+
+  os << std::setw(w1) << "name" << std::setw(w2) << "runs"
+     << std::setw(w2) << "saved uses" << std::setw(w2) << "self (ms)"
+     << std::setw(w2) << "total (ms)" << std::setw(w2) << "results"
+     << std::setw(w2) << "approx KB" << "\n";
+
+  for (QueryMapBase* base : bases) {
+    const Totals& t = totals[base];
+    os << std::setw(w1) << base->queryName
+       << std::setw(w2) << t.calls
+       << std::setw(w2) << base->timings.savedResultUses
+       << std::setw(w2) << std::fixed << std::setprecision(3) << ms(t.self)
+       << std::setw(w2) << ms(t.total)
+       << std::setw(w2) << base->numResults()
+       << std::setw(w2) << base->approxBytes() / 1024 << "\n";
+  }
+
+  os.copyfmt(state);
+}
+
+void Context::queryProfileFoldedStacks(std::ostream& os) {
+  std::vector<const char*> names;
+  for (const auto& node : queryProfileNodes) {
+    auto micros =
+      std::chrono::duration_cast<std::chrono::microseconds>(node.self).count();
+    if (node.base == nullptr || micros <= 0) continue;
+
+    names.clear();
+    for (const QueryProfileNode* n = &node; n->base != nullptr;
+         n = &queryProfileNodes[n->parent]) {
+      names.push_back(n->base->queryName);
+    }
+    for (size_t i = names.size(); i > 0; i--) {
+      os << names[i-1] << (i > 1 ? ";" : " ");
+    }
+    os << micros << "\n";
+  }
 }
 
 // TODO should these be ifdef'd away if !QUERY_TIMING_ENABLED? Or just warn?
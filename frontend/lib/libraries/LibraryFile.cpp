@@ -137,6 +137,18 @@ void LibraryFile::LocationMaps::mark(Context* context) const {
   #undef LOCATION_MAP
 }
 
+void LibraryFile::ScopeMaps::mark(Context* context) const {
+  for (const auto& p : scopes) {
+    p.first.mark(context);
+    for (const auto& nameAndDecls : p.second.declared) {
+      nameAndDecls.first.mark(context);
+      for (const auto& d : nameAndDecls.second) {
+        d.id.mark(context);
+      }
+    }
+  }
+}
+
 
 LibraryFile::~LibraryFile() {
   if (mappedFile) delete mappedFile;
@@ -304,6 +316,8 @@ bool LibraryFile::readModuleSection(Context* context,
   uint64_t locSectionLen = locations.end - locations.start;
   Region genCodeSection = modHdr->genCodeSection;
   uint64_t genCodeSectionLen = genCodeSection.end - genCodeSection.start;
+  Region scopeSection = modHdr->scopeSection;
+  uint64_t scopeSectionLen = scopeSection.end - scopeSection.start;
   if (modHdr->magic != MODULE_SECTION_MAGIC ||
       r.start > fileLen || r.end > fileLen || r.start >= r.end ||
       r.start + symTable.start + sizeof(SymbolTableHeader) > r.end ||
@@ -315,7 +329,9 @@ bool LibraryFile::readModuleSection(Context* context,
       r.start + locations.start + sizeof(LocationSectionHeader) > r.end ||
       r.start + locations.end > r.end ||
       r.start + genCodeSection.start + sizeof(LocationSectionHeader) > r.end ||
-      r.start + genCodeSection.end > r.end) {
+      r.start + genCodeSection.end > r.end ||
+      r.start + scopeSection.start + sizeof(ScopeSectionHeader) > r.end ||
+      r.start + scopeSection.end > r.end) {
     invalidFileError(context);
     return false;
   }
@@ -364,6 +380,14 @@ bool LibraryFile::readModuleSection(Context* context,
     return false;
   }
 
+  const ScopeSectionHeader* scopeHeader =
+    (const ScopeSectionHeader*) (fileData + r.start + scopeSection.start);
+  if (scopeHeader->magic != SCOPE_SECTION_MAGIC ||
+      scopeHeader->nScopes > MAX_NUM_SYMBOLS) {
+    invalidFileError(context);
+    return false;
+  }
+
   mod.symbolTableData = (const unsigned char*) symTableHeader;
   mod.symbolTableLen = symTableSectionLen;
 
@@ -379,6 +403,9 @@ bool LibraryFile::readModuleSection(Context* context,
   mod.genCodeSectionData = (const unsigned char*) genHeader;
   mod.genCodeSectionLen = genCodeSectionLen;
 
+  mod.scopeSectionData = (const unsigned char*) scopeHeader;
+  mod.scopeSectionLen = scopeSectionLen;
+
   mod.nStrings = strTableHeader->nLongStrings;
   // string offsets start just after the header
   mod.stringOffsetsTable = (const uint32_t*) (strTableHeader+1);
@@ -399,7 +426,6 @@ bool LibraryFile::readModuleSection(Context* context,
   uint32_t n = symTableHeader->nEntries;
   std::string lastSymId;
   std::string lastCname;
-  std::vector<UniqueString> cnames;
 
   for (uint32_t i = 0; i < n; i++) {
     uint64_t pos = des.position();
@@ -432,10 +458,10 @@ bool LibraryFile::readModuleSection(Context* context,
       des.readData(&lastSymId[nCommonPrefix], nSuffix);
     }
 
-    // consider the code-generated versions
+    // consider the code-generated versions. These are skipped over
+    // here and decoded by readSymbolCnames if they are needed.
+    uint64_t cnamesPos = des.position();
     unsigned nGenerated = des.readVUint();
-    cnames.clear();
-    // read the data from each code-generated version
     for (unsigned int j = 0; j < nGenerated; j++) {
       des.readByte(); // isInstantiation
 
@@ -458,8 +484,6 @@ bool LibraryFile::readModuleSection(Context* context,
       lastCname.resize(nCommonPrefix+nSuffix);
       // read the string data
       des.readData(&lastCname[nCommonPrefix], nSuffix);
-      // note the cname
-      cnames.push_back(UniqueString::get(context, lastCname));
     }
 
     // record the information
@@ -467,6 +491,7 @@ bool LibraryFile::readModuleSection(Context* context,
     info.symbolEntryOffset = pos;
     info.astOffset = entry.astEntry;
     info.locationOffset = entry.locationEntry;
+    info.cnamesOffset = cnamesPos;
     {
       std::string fullSymPath = moduleSymPath.str();
       if (!lastSymId.empty()) {
@@ -474,7 +499,6 @@ bool LibraryFile::readModuleSection(Context* context,
       }
       info.symbolPath = UniqueString::get(context, fullSymPath);
     }
-    info.cnames = cnames;
     mod.symbols.push_back(info);
     mod.offsetToSymIdx[info.astOffset] = i;
 
@@ -762,10 +786,17 @@ void LibraryFile::summarize(Context* context, std::ostream& s) const {
 
       s << "     ### symbols\n";
 
+      const auto& cnames = loadSymbolCnamesQuery(context, this, i);
+      size_t symIdx = 0;
       for (const auto& symInfo : mod->symbols) {
         UniqueString symPath = symInfo.symbolPath;
         s << "         " << symPath.str();
-        for (auto cname : symInfo.cnames) {
+        if (symIdx >= cnames.size()) {
+          s << "\n";
+          symIdx++;
+          continue;
+        }
+        for (auto cname : cnames[symIdx++]) {
           s << " " << cname;;
 #ifdef HAVE_LLVM
           if (!cname.isEmpty() && llvmMod->getFunction(cname.str())) {
@@ -833,6 +864,75 @@ LibraryFile::loadModuleAst(Context* context,
   return nullptr;
 }
 
+bool LibraryFile::readSymbolCnames(
+                        Context* context,
+                        std::vector<std::vector<UniqueString>>& cnames,
+                        const ModuleSection* m) const {
+  auto helper = setupHelper(context, m);
+  std::string lastCname;
+
+  for (const auto& symInfo : m->symbols) {
+    // the names are prefix-compressed against the previous symbol's,
+    // so they have to be decoded in order
+    Deserializer des(context,
+                     m->symbolTableData,
+                     m->symbolTableData + symInfo.cnamesOffset,
+                     m->symbolTableData + m->symbolTableLen,
+                     helper);
+
+    std::vector<UniqueString> symCnames;
+    unsigned nGenerated = des.readVUint();
+    for (unsigned int j = 0; j < nGenerated; j++) {
+      des.readByte(); // isInstantiation
+
+      unsigned int nCommonPrefix = des.readVUint();
+      if (lastCname.size() > nCommonPrefix) {
+        lastCname.erase(nCommonPrefix, lastCname.size()-nCommonPrefix);
+      }
+      unsigned int nSuffix = des.readVUint();
+
+      if (!des.checkStringLength(nCommonPrefix+nSuffix) ||
+          !des.checkStringLengthAvailable(nSuffix)) {
+        invalidFileError(context);
+        return false;
+      }
+
+      lastCname.resize(nCommonPrefix+nSuffix);
+      des.readData(&lastCname[nCommonPrefix], nSuffix);
+      symCnames.push_back(UniqueString::get(context, lastCname));
+    }
+
+    if (!des.ok()) {
+      invalidFileError(context);
+      return false;
+    }
+
+    cnames.push_back(std::move(symCnames));
+  }
+
+  return true;
+}
+
+const std::vector<std::vector<UniqueString>>&
+LibraryFile::loadSymbolCnamesQuery(Context* context,
+                                   const LibraryFile* f,
+                                   int moduleIndex) {
+  QUERY_BEGIN(loadSymbolCnamesQuery, context, f, moduleIndex);
+
+  std::vector<std::vector<UniqueString>> result;
+
+  const ModuleSection* m = f->loadModuleSection(context, moduleIndex);
+  if (m != nullptr) {
+    bool ok = f->readSymbolCnames(context, result, m);
+    if (!ok) {
+      // do not return a partial result on failure
+      result.clear();
+    }
+  }
+
+  return QUERY_END(result);
+}
+
 bool LibraryFile::readLocationPaths(Context* context,
                                     std::vector<UniqueString>& paths,
                                     const ModuleSection* m) const {
@@ -866,6 +966,26 @@ bool LibraryFile::readLocationPaths(Context* context,
   return true;
 }
 
+const std::vector<UniqueString>&
+LibraryFile::loadLocationPathsQuery(Context* context,
+                                    const LibraryFile* f,
+                                    int moduleIndex) {
+  QUERY_BEGIN(loadLocationPathsQuery, context, f, moduleIndex);
+
+  std::vector<UniqueString> result;
+
+  const ModuleSection* m = f->loadModuleSection(context, moduleIndex);
+  if (m != nullptr) {
+    bool ok = f->readLocationPaths(context, result, m);
+    if (!ok) {
+      // do not return a partial result on failure
+      result.clear();
+    }
+  }
+
+  return QUERY_END(result);
+}
+
 bool LibraryFile::readLocationGroup(
                         Context* context,
                         LocationMaps& maps,
@@ -984,9 +1104,11 @@ bool LibraryFile::doLoadLocations(Context* context,
     return false;
   }
 
-  std::vector<UniqueString> paths;
-  bool ok = readLocationPaths(context, paths, m);
-  if (!ok) {
+  const std::vector<UniqueString>& paths =
+    loadLocationPathsQuery(context, this, moduleIndex);
+  if (paths.empty() && ((const LocationSectionHeader*)
+                        m->locationSectionData)->nFilePaths != 0) {
+    // should have already raised an error
     return false;
   }
 
@@ -1003,7 +1125,8 @@ bool LibraryFile::doLoadLocations(Context* context,
                    m->locationSectionData + locationGroupOffset,
                    m->locationSectionData + m->locationSectionLen,
                    helper);
-  ok = readLocationGroup(context, result, des, symbolTableEntryAst, paths, br);
+  bool ok = readLocationGroup(context, result, des, symbolTableEntryAst,
+                              paths, br);
   if (!ok) {
     return false;
   }
@@ -1052,6 +1175,104 @@ LibraryFile::loadLocations(Context* context,
                             symbolTableEntryIndex, symbolTableEntryAst);
 }
 
+bool LibraryFile::readScopes(Context* context,
+                             ScopeMaps& result,
+                             const ModuleSection* m) const {
+  const ScopeSectionHeader* scopeHdr =
+    (const ScopeSectionHeader*) m->scopeSectionData;
+
+  auto helper = setupHelper(context, m);
+  Deserializer des(context,
+                   m->scopeSectionData,
+                   m->scopeSectionData + sizeof(ScopeSectionHeader),
+                   m->scopeSectionData + m->scopeSectionLen,
+                   helper);
+
+  uint32_t n = scopeHdr->nScopes;
+  for (uint32_t i = 0; i < n; i++) {
+    ScopeDecls decls;
+    auto scopePath = UniqueString::get(context, des.read<std::string>());
+    decls.flags = des.readVUint();
+
+    unsigned int nNames = des.readVUint();
+    for (unsigned int j = 0; j < nNames && des.ok(); j++) {
+      auto name = UniqueString::get(context, des.read<std::string>());
+      std::vector<ScopeDecls::Decl> ids;
+
+      unsigned int nIds = des.readVUint();
+      for (unsigned int k = 0; k < nIds && des.ok(); k++) {
+        ScopeDecls::Decl d;
+        auto symPath = UniqueString::get(context, des.read<std::string>());
+        int postOrderId = des.readVInt();
+        int numChildIds = des.readVInt();
+        d.id = ID(symPath, postOrderId, numChildIds);
+        d.flags = des.readVUint();
+        ids.push_back(std::move(d));
+      }
+
+      if (ids.empty()) {
+        invalidFileError(context);
+        return false;
+      }
+
+      decls.declared.push_back(std::make_pair(name, std::move(ids)));
+    }
+
+    if (!des.ok()) {
+      invalidFileError(context);
+      return false;
+    }
+
+    result.scopes[scopePath] = std::move(decls);
+  }
+
+  return true;
+}
+
+const LibraryFile::ScopeMaps&
+LibraryFile::loadScopesQuery(Context* context,
+                             const LibraryFile* f,
+                             int moduleIndex) {
+  QUERY_BEGIN(loadScopesQuery, context, f, moduleIndex);
+
+  ScopeMaps result;
+
+  const ModuleSection* m = f->loadModuleSection(context, moduleIndex);
+  if (m != nullptr) {
+    bool ok = f->readScopes(context, result, m);
+    if (!ok) {
+      // do not return a partial result on failure
+      result.clear();
+    }
+  }
+
+  return QUERY_END(result);
+}
+
+const LibraryFile::ScopeDecls*
+LibraryFile::loadScopeDecls(Context* context, ID id) const {
+  if (id.isEmpty() || id.postOrderId() != -1) {
+    return nullptr;
+  }
+
+  // the scope is stored in the section of its top-level module
+  std::string symPath = id.symbolPath().str();
+  auto topName = UniqueString::get(context,
+                                   symPath.substr(0, symPath.find('.')));
+  auto search = moduleSymPathToIdx.find(topName);
+  if (search == moduleSymPathToIdx.end()) {
+    return nullptr;
+  }
+
+  const ScopeMaps& maps = loadScopesQuery(context, this, search->second);
+  auto it = maps.scopes.find(id.symbolPath());
+  if (it == maps.scopes.end()) {
+    return nullptr;
+  }
+
+  return &it->second;
+}
+
 #ifdef HAVE_LLVM
 owned<llvm::Module>
 LibraryFile::loadLlvmModuleImpl(Context* context,
@@ -21,10 +21,13 @@
 
 #include "chpl/libraries/LibraryFileFormat.h"
 #include "chpl/parsing/parsing-queries.h"
+#include "chpl/resolution/scope-queries.h"
 #include "chpl/uast/all-uast.h"
 #include "chpl/util/filesystem.h"
 #include "chpl/util/version-info.h"
 
+#include <algorithm>
+
 namespace chpl {
 namespace libraries {
 
@@ -180,6 +183,10 @@ Region LibraryFileWriter::writeModuleSection(const ModInfo& info) {
   padToAlign();
   header.genCodeSection = writeGenCode(moduleSectionStart, ser, genCode);
 
+  padToAlign();
+  header.scopeSection = writeScopes(moduleSectionStart, ser, reg);
+  // note: implementation of writeScopes assumes it runs after writeSymbolTable
+
   // update the module header with the saved locations by writing the
   // header again.
   auto savePos = fileStream.tellp();
@@ -726,11 +733,85 @@ Region LibraryFileWriter::writeGenCode(uint64_t moduleSectionStart,
                     genSectionEnd - moduleSectionStart);
 }
 
+Region LibraryFileWriter::writeScopes(uint64_t moduleSectionStart,
+                                      Serializer& ser,
+                                      LibraryFileSerializationHelper& reg) {
+  uint64_t scopeSectionStart = fileStream.tellp();
+
+  // save the scopes for modules and aggregate types in the symbol table,
+  // since those are the ones that can be found from other modules
+  std::vector<const resolution::Scope*> scopes;
+  for (auto ast : reg.symbolTableVec) {
+    if (ast->isModule() || ast->isAggregateDecl()) {
+      const resolution::Scope* s = resolution::scopeForId(context, ast->id());
+      if (s != nullptr && s->id() == ast->id()) {
+        scopes.push_back(s);
+      }
+    }
+  }
+
+  ScopeSectionHeader header;
+  memset(&header, 0, sizeof(header));
+  header.magic = SCOPE_SECTION_MAGIC;
+  header.nScopes = scopes.size();
+
+  // write the header
+  ser.writeData(&header, sizeof(header));
+
+  auto noExclude = resolution::IdAndFlags::FlagSet::empty();
+  for (auto s : scopes) {
+    ser.write<std::string>(s->id().symbolPath().str());
+    ser.writeVUint(s->flags());
+
+    // sort the names so that the file contents are deterministic
+    std::vector<std::pair<std::string, UniqueString>> names;
+    for (const auto& pair : s->declared()) {
+      names.push_back(std::make_pair(pair.first.str(), pair.first));
+    }
+    std::sort(names.begin(), names.end());
+
+    ser.writeVUint(names.size());
+    for (const auto& name : names) {
+      resolution::MatchingIdsWithName ids;
+      s->declared().at(name.second).gatherMatches(ids, 0, noExclude);
+
+      ser.write<std::string>(name.first);
+      ser.writeVUint(ids.numIds());
+      for (int i = 0; i < ids.numIds(); i++) {
+        const resolution::IdAndFlags& idv = ids.idAndFlags(i);
+        ser.write<std::string>(idv.id().symbolPath().str());
+        ser.writeVInt(idv.id().postOrderId());
+        ser.writeVInt(idv.id().numContainedChildren());
+        ser.writeVUint(idv.flags());
+      }
+    }
+  }
+
+  uint64_t scopeSectionEnd = fileStream.tellp();
+  return makeRegion(scopeSectionStart - moduleSectionStart,
+                    scopeSectionEnd - moduleSectionStart);
+}
+
 void LibraryFileWriter::setSourcePaths(std::vector<UniqueString> paths) {
   inputFiles = paths;
   modules = gatherTopLevelModules(context, inputFiles);
 }
 
+void LibraryFileWriter::setSourceModules(
+                          UniqueString path,
+                          const std::vector<const uast::Module*>& mods) {
+  path = cleanLocalPath(context, path);
+  inputFiles = {path};
+  modules.clear();
+  for (auto mod : mods) {
+    ModInfo info;
+    info.moduleName = mod->name();
+    info.moduleAst = mod;
+    info.fromSourcePath = path;
+    modules.push_back(std::move(info));
+  }
+}
+
 void LibraryFileWriter::setGeneratedCode(
                          UniqueString modName,
                          std::string buffer,
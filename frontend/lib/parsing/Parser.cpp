@@ -77,14 +77,18 @@ static void updateParseResult(ParserContext* parserContext) {
 }
 
 
-BuilderResult Parser::parseFile(const char* path, ParserStats* parseStats) {
-  owned<Builder> builder;
-  if (parentSymbolPath_.isEmpty()) {
-    builder = Builder::createForTopLevelModule(this->context(), path);
+static owned<Builder> makeBuilder(Context* context, const char* path,
+                                  UniqueString parentSymbolPath) {
+  if (parentSymbolPath.isEmpty()) {
+    return Builder::createForTopLevelModule(context, path);
   } else {
-    builder = Builder::createForIncludedModule(this->context(), path,
-                                               parentSymbolPath_);
+    return Builder::createForIncludedModule(context, path, parentSymbolPath);
   }
+}
+
+BuilderResult Parser::parseFile(const char* path, ParserStats* parseStats) {
+  owned<Builder> builder = makeBuilder(context_, path, parentSymbolPath_);
+  uast::detail::AstArena::Use use(useArena_ ? builder->arena() : nullptr);
   std::string fileError;
 
   FILE* fp = openfile(path, "r", fileError);
@@ -172,13 +176,31 @@ BuilderResult Parser::parseFile(const char* path, ParserStats* parseStats) {
 
 BuilderResult Parser::parseString(const char* path, const char* str,
                                   ParserStats* parseStats) {
-  owned<Builder> builder;
-  if (parentSymbolPath_.isEmpty()) {
-    builder = Builder::createForTopLevelModule(this->context(), path);
-  } else {
-    builder = Builder::createForIncludedModule(this->context(), path,
-                                               parentSymbolPath_);
+  owned<Builder> builder = makeBuilder(context_, path, parentSymbolPath_);
+  parseStringToBuilder(path, str, builder.get(), nullptr, parseStats);
+  return builder->result();
+}
+
+Parser::DeferredParse Parser::parseStringDeferred(const char* path,
+                                                  const char* str) {
+  DeferredParse ret;
+  ret.builder = makeBuilder(context_, path, parentSymbolPath_);
+  parseStringToBuilder(path, str, ret.builder.get(), &ret.errors, nullptr);
+  return ret;
+}
+
+BuilderResult Parser::finishParse(DeferredParse parse) {
+  for (auto& error : parse.errors) {
+    context_->report(std::move(error));
   }
+  return parse.builder->result();
+}
+
+void Parser::parseStringToBuilder(const char* path, const char* str,
+                                  Builder* builder,
+                                  std::vector<owned<ErrorBase>>* deferredErrors,
+                                  ParserStats* parseStats) {
+  uast::detail::AstArena::Use use(useArena_ ? builder->arena() : nullptr);
 
   // Set the (global) parser debug state
   if (DEBUG_PARSER)
@@ -192,7 +214,8 @@ BuilderResult Parser::parseString(const char* path, const char* str,
   // State for the parser
   yychpl_pstate* parser = yychpl_pstate_new();
   int           parserStatus = YYPUSH_MORE;
-  ParserContext parserContext(path, builder.get(), parseStats);
+  ParserContext parserContext(path, builder, parseStats);
+  parserContext.deferredErrors = deferredErrors;
 
   yychpl_lex_init_extra(&parserContext, &parserContext.scanner);
 
@@ -247,8 +270,6 @@ BuilderResult Parser::parseString(const char* path, const char* str,
   yychpl_lex_destroy(parserContext.scanner);
 
   updateParseResult(&parserContext);
-
-  return builder->result();
 }
 
 
@@ -95,6 +95,10 @@ struct ParserContext {
   // an easier-to-use copy of Context::Configuration::includeComments
   bool includeComments;
 
+  // when set, errors are saved here instead of being reported, so that
+  // parsing doesn't use the Context (see Parser::parseStringDeferred)
+  std::vector<owned<ErrorBase>>* deferredErrors;
+
   ParserExprList* parenlessMarker;
 
   ParserContext(const char* filename, Builder* builder,
@@ -127,6 +131,7 @@ struct ParserContext {
       builder->context()->configuration().includeComments;
     this->parenlessMarker         = new ParserExprList();
     this->parseStats              = parseStats;
+    this->deferredErrors          = nullptr;
   }
   ~ParserContext() {
     delete this->parenlessMarker;
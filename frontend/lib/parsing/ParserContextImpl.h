@@ -643,7 +643,11 @@ void ParserContext::resetCurlyBracesLoc() {
 
 
 ErroneousExpression* ParserContext::report(YYLTYPE loc, owned<ErrorBase> error) {
-  context()->report(std::move(error));
+  if (deferredErrors != nullptr) {
+    deferredErrors->push_back(std::move(error));
+  } else {
+    context()->report(std::move(error));
+  }
   return ErroneousExpression::build(builder, convertLocation(loc)).release();
 }
 
@@ -87,16 +87,12 @@ static void syntax(yyscan_t scanner, int nLines, int nCols,
 //  * '@' for an attribute identifier as in @chpldoc.nodoc
 //  * everything else is considered a normal identifier
 static int processIdentifier(yyscan_t scanner, char specialInitialChar) {
-  YYSTYPE* val = yyget_lval(scanner);
   int tokenType = TIDENT;
   if (specialInitialChar == '?')      tokenType = TQUERIEDIDENT;
   else if (specialInitialChar == '@') tokenType = TATTRIBUTEIDENT;
   int retval = processToken(scanner, tokenType);
-  // note: processToken calls updateLocation.
-
-  const char* pch = yyget_text(scanner);
-  ParserContext* context = yyget_extra(scanner);
-  val->uniqueStr = PODUniqueString::get(context->context(), pch);
+  // note: processToken calls updateLocation and also stores the
+  // identifier's text in the token's uniqueStr.
 
   return retval;
 }
@@ -104,16 +100,17 @@ static int processIdentifier(yyscan_t scanner, char specialInitialChar) {
 static int processToken(yyscan_t scanner, int t) {
   YYSTYPE* val = yyget_lval(scanner);
 
+  // flex already knows the token length, so use it rather than strlen
   const char* pch = yyget_text(scanner);
+  int len = yyget_leng(scanner);
 
   ParserContext* context = yyget_extra(scanner);
   if (context->parseStats)
     context->parseStats->countToken(pch);
   YYLTYPE* loc = yyget_lloc(scanner);
-  updateLocation(loc, 0, strlen(pch));
-
+  updateLocation(loc, 0, len);
 
-  val->uniqueStr = PODUniqueString::get(context->context(), pch);
+  val->uniqueStr = PODUniqueString::get(context->context(), pch, len);
 
   // If the stack has a value then we must be in externmode.
   // Return to INITIAL
@@ -658,9 +655,8 @@ static SizedStr eatExternCode(yyscan_t scanner) {
 ************************************* | ************************************/
 
 static void processWhitespace(yyscan_t scanner) {
-  const char* pch = yyget_text(scanner);
   YYLTYPE* loc = yyget_lloc(scanner);
-  updateLocation(loc, 0, strlen(pch));
+  updateLocation(loc, 0, yyget_leng(scanner));
 }
 
 /************************************ | *************************************
@@ -68,6 +68,7 @@ void ParserStats::clearFile() {
 
 void ParserStats::clearGlob() {
   totTokens = 0;
+  totSeconds = 0.0;
   clearHist(totTokenHist);
   maxTokensPerLineTot = 0;
 }
@@ -89,6 +90,9 @@ void ParserStats::printFileSummary() {
     fprintf(stderr, "MAX TOKENS/LINE = %d\n"
                     "AVG TOKENS/CODE LINE = %.2f\n",
             maxTokensPerLineInFile, (double) fileTokens / codeLines);
+    if (fileSeconds > 0.0) {
+      fprintf(stderr, "TOKENS/SEC = %.0f\n", fileTokens / fileSeconds);
+    }
     fprintf(stderr, "HISTOGRAM:\n");
     for (j = 0; j <= maxTokensPerLineInFile; j++) {
       fprintf(stderr, "%3d: %3d\n", j, fileTokenHist[j]);
@@ -114,6 +118,7 @@ void ParserStats::startCountingFileTokens(const char* filename) {
   }
 
   tokenCountingOn = true;
+  fileStartTime = std::chrono::steady_clock::now();
 
   if (countTokens) {
     clearFile();
@@ -127,6 +132,10 @@ void ParserStats::startCountingFileTokens(const char* filename) {
 
 void ParserStats::stopCountingFileTokens() {
   tokenCountingOn = false;
+  std::chrono::duration<double> elapsed =
+    std::chrono::steady_clock::now() - fileStartTime;
+  fileSeconds = elapsed.count();
+  totSeconds += fileSeconds;
 
   if (printTokens) {
     if (!line.empty()) {
@@ -149,6 +158,9 @@ void ParserStats::finishCountingTokens() {
       fprintf(stderr, "GRAND TOTAL = ");
     }
     fprintf(stderr, "%d\n", totTokens);
+    if (printTokens && totSeconds > 0.0) {
+      fprintf(stderr, "TOKENS/SEC = %.0f\n", totTokens / totSeconds);
+    }
   }
 }
 
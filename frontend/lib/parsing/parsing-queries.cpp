@@ -24,6 +24,7 @@
 #include "chpl/framework/compiler-configuration.h"
 #include "chpl/framework/query-impl.h"
 #include "chpl/libraries/LibraryFile.h"
+#include "chpl/libraries/LibraryFileWriter.h"
 #include "chpl/parsing/Parser.h"
 #include "chpl/resolution/scope-queries.h" // for moduleInitializationOrder
 #include "chpl/resolution/resolution-queries.h"
@@ -45,11 +46,15 @@
 
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdio>
 #include <regex>
 #include <set>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <unordered_map>
 #include <utility>
@@ -123,6 +128,198 @@ bool hasFileText(Context* context, const std::string& path) {
   return context->hasCurrentResultForQuery(fileTextQuery, tupleOfArgs);
 }
 
+void prefetchFileTexts(Context* context,
+                       const std::vector<UniqueString>& paths,
+                       int numThreads) {
+  std::vector<std::string> toRead;
+  for (auto path : paths) {
+    if (!path.startsWith(FALLBACK_INTERNAL_PREFIX) &&
+        !hasFileText(context, path.str())) {
+      toRead.push_back(path.str());
+    }
+  }
+  if (toRead.empty()) return;
+
+  // The workers only read files; everything that touches the context
+  // happens on this thread, afterwards.
+  std::vector<std::string> texts(toRead.size());
+  std::vector<char> ok(toRead.size(), 0);
+  std::atomic<size_t> next(0);
+  auto work = [&]() {
+    std::string error;
+    for (size_t i = next++; i < toRead.size(); i = next++) {
+      ok[i] = readFile(toRead[i].c_str(), texts[i], error);
+    }
+  };
+
+  size_t nThreads = std::min(toRead.size(), (size_t) std::max(numThreads, 1));
+  std::vector<std::thread> threads;
+  for (size_t t = 1; t < nThreads; t++) {
+    threads.emplace_back(work);
+  }
+  work();
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  // Files that couldn't be read are left for the fileText query, so that
+  // it reports the error when the file is actually needed.
+  for (size_t i = 0; i < toRead.size(); i++) {
+    if (ok[i]) {
+      setFileText(context, toRead[i], std::move(texts[i]));
+    }
+  }
+}
+
+// The persistent parse cache. When Configuration::queryCacheDir is set,
+// each top-level file that parses without errors is saved as a library
+// file in that directory, named by a hash of its path and contents. A
+// later Context parsing the same file contents loads the uAST from that
+// library file instead of parsing it again. Since the name depends on
+// the file contents, the fileText dependency is enough to notice when
+// an entry no longer applies.
+
+static bool useParseCache(Context* context, UniqueString path,
+                          UniqueString parentSymbolPath) {
+  // The library file paths are cleaned by LibraryFileWriter, so only
+  // use the cache for paths where that makes no difference.
+  return !context->configuration().queryCacheDir.empty() &&
+         parentSymbolPath.isEmpty() &&
+         cleanLocalPath(path.str()) == path.str();
+}
+
+static const UniqueString&
+parseCachePathQuery(Context* context, UniqueString path) {
+  QUERY_BEGIN(parseCachePathQuery, context, path);
+
+  UniqueString result;
+
+  const FileContents& contents = fileText(context, path);
+  if (contents.error() == nullptr) {
+    std::string key = getVersion();
+    key += '\0';
+    key += path.str();
+    key += '\0';
+    key += contents.text();
+    llvm::SmallString<256> cachePath(context->configuration().queryCacheDir);
+    llvm::sys::path::append(cachePath, fileHashToHex(hashString(key)));
+    cachePath += ".dyno";
+    result = UniqueString::get(context, cachePath.str());
+  }
+
+  return QUERY_END(result);
+}
+
+// Returns the path of the library file caching the parse of 'path', or
+// an empty string if there is no usable one.
+static const UniqueString&
+loadParseCacheQuery(Context* context, UniqueString path) {
+  QUERY_BEGIN(loadParseCacheQuery, context, path);
+
+  UniqueString result;
+
+  UniqueString cachePath = parseCachePathQuery(context, path);
+  if (!cachePath.isEmpty() && fileExists(cachePath.c_str())) {
+    // a damaged cache entry should not be reported as an error
+    auto loaded = context->runAndCaptureErrors([&](Context* ctx) {
+      const libraries::LibraryFile* lib =
+        libraries::LibraryFile::load(ctx, cachePath);
+      if (lib == nullptr) return false;
+      const BuilderResult& br = lib->loadSourceAst(ctx, path);
+      if (br.numTopLevelExpressions() == 0) return false;
+      // map the modules back to the source path, as parsing would
+      for (auto ast : br.topLevelExpressions()) {
+        if (auto mod = ast->toModule()) {
+          ctx->setFilePathForModuleId(mod->id(), path);
+        }
+      }
+      return true;
+    });
+    if (loaded.ranWithoutErrors() && loaded.result()) {
+      result = cachePath;
+    }
+  }
+
+  return QUERY_END(result);
+}
+
+static const BuilderResult&
+parseFileToBuilderResultQuery(Context* context, UniqueString path,
+                              UniqueString parentSymbolPath);
+
+static const bool& saveParseCacheQuery(Context* context, UniqueString path) {
+  QUERY_BEGIN(saveParseCacheQuery, context, path);
+
+  bool result = false;
+
+  UniqueString cachePath = parseCachePathQuery(context, path);
+  if (!cachePath.isEmpty() &&
+      !makeDir(context->configuration().queryCacheDir, /*makeParents*/ true)) {
+    // Write to a temporary file and rename it, so that another process
+    // using the same cache never sees a partially written file.
+    std::string tmpPath = cachePath.str() + ".tmp" +
+                          std::to_string(llvm::sys::Process::getProcessId());
+    // failing to save the cache should not be reported as an error
+    // This runs while 'parse' may still be running for the file, so
+    // save the modules from the finished parse rather than calling
+    // 'parse' again through setSourcePaths.
+    const BuilderResult& br =
+      parseFileToBuilderResultQuery(context, path, UniqueString());
+    std::vector<const Module*> mods;
+    for (auto ast : br.topLevelExpressions()) {
+      if (auto mod = ast->toModule()) {
+        mods.push_back(mod);
+      }
+    }
+    auto written = context->runAndCaptureErrors([&](Context* ctx) {
+      libraries::LibraryFileWriter writer(ctx, tmpPath);
+      writer.setSourceModules(path, mods);
+      return writer.writeAllSections();
+    });
+    if (written.ranWithoutErrors() && written.result()) {
+      result = !llvm::sys::fs::rename(tmpPath, cachePath.str());
+    }
+    if (!result) {
+      llvm::sys::fs::remove(tmpPath);
+    }
+  }
+
+  return QUERY_END(result);
+}
+
+static const BuilderResult&
+parseFileUsingCache(Context* context, UniqueString path) {
+  UniqueString cachePath = loadParseCacheQuery(context, path);
+  if (!cachePath.isEmpty()) {
+    auto lib = libraries::LibraryFile::load(context, cachePath);
+    return lib->loadSourceAst(context, path);
+  }
+
+  auto parsed = context->runAndDetectErrors([&](Context* ctx) {
+    return &parseFileToBuilderResultQuery(ctx, path, UniqueString());
+  });
+
+  // Saving finds the file's locations, which comes back to this
+  // function, so don't try to save it while it is being saved.
+  if (parsed.ranWithoutErrors() &&
+      !context->isQueryRunning(saveParseCacheQuery, std::make_tuple(path))) {
+    saveParseCacheQuery(context, path);
+  }
+
+  return *parsed.result();
+}
+
+// A parse done by prefetchParses, waiting for parseFileToBuilderResultQuery
+// to finish it. Only set while prefetchParses runs that query.
+struct PrefetchedParse {
+  Context* context;
+  UniqueString path;
+  const char* text;
+  bool useArena;
+  Parser::DeferredParse parse;
+};
+static PrefetchedParse* finishingParse = nullptr;
+
 static Parser helpMakeParser(Context* context,
                              UniqueString parentSymbolPath) {
   if (parentSymbolPath.isEmpty()) {
@@ -132,6 +329,20 @@ static Parser helpMakeParser(Context* context,
   }
 }
 
+// Is this file being parsed again, in a later revision? Most of the
+// earlier uAST will be kept then, and the few new nodes that replace
+// parts of it shouldn't keep a whole arena alive.
+static bool isReparse(Context* context, UniqueString path,
+                      UniqueString parentSymbolPath) {
+  auto results = context->querySavedResults(parseFileToBuilderResultQuery);
+  if (results == nullptr) return false;
+  using Entry = std::decay_t<decltype(*results)>::value_type;
+  auto it = results->find(Entry(nullptr,
+                                std::make_tuple(path, parentSymbolPath)));
+  // the entry for a parse that never finished has no result yet
+  return it != results->end() && it->lastChanged != -1;
+}
+
 static const BuilderResult&
 parseFileToBuilderResultQuery(Context* context, UniqueString path,
                               UniqueString parentSymbolPath) {
@@ -147,9 +358,17 @@ parseFileToBuilderResultQuery(Context* context, UniqueString path,
   if (error == nullptr) {
     // if there was no error reading the file, proceed to parse
     auto parser = helpMakeParser(context, parentSymbolPath);
+    parser.setUseArena(!isReparse(context, path, parentSymbolPath));
     const char* pathc = path.c_str();
     const char* textc = text.c_str();
-    BuilderResult tmpResult = parser.parseString(pathc, textc);
+    bool prefetched = finishingParse != nullptr &&
+                      finishingParse->context == context &&
+                      finishingParse->path == path &&
+                      finishingParse->text == textc &&
+                      parentSymbolPath.isEmpty();
+    BuilderResult tmpResult =
+      prefetched ? parser.finishParse(std::move(finishingParse->parse))
+                 : parser.parseString(pathc, textc);
     result.swap(tmpResult);
     BuilderResult::updateFilePaths(context, result);
   }
@@ -164,11 +383,71 @@ parseFileToBuilderResult(Context* context, UniqueString path,
   if (context->pathIsInLibrary(path, libPath)) {
     auto lib = libraries::LibraryFile::load(context, libPath);
     return lib->loadSourceAst(context, path);
+  } else if (useParseCache(context, path, parentSymbolPath)) {
+    return parseFileUsingCache(context, path);
   } else {
     return parseFileToBuilderResultQuery(context, path, parentSymbolPath);
   }
 }
 
+void prefetchParses(Context* context,
+                    const std::vector<UniqueString>& paths,
+                    int numThreads) {
+  prefetchFileTexts(context, paths, numThreads);
+
+  std::vector<PrefetchedParse> todo;
+  for (auto path : paths) {
+    UniqueString libPath;
+    auto args = std::make_tuple(path, UniqueString());
+    if (path.startsWith(FALLBACK_INTERNAL_PREFIX) ||
+        !hasFileText(context, path.str()) ||
+        context->pathIsInLibrary(path, libPath) ||
+        useParseCache(context, path, UniqueString()) ||
+        context->hasCurrentResultForQuery(parseFileToBuilderResultQuery,
+                                          args)) {
+      continue;
+    }
+    const FileContents& contents = fileText(context, path);
+    if (contents.error() == nullptr) {
+      todo.push_back({context, path, contents.text().c_str(),
+                      !isReparse(context, path, UniqueString()), {}});
+    }
+  }
+  if (todo.empty()) return;
+
+  // The workers only lex and parse; reporting the errors and computing
+  // the BuilderResult use the context, so those happen on this thread.
+  std::atomic<size_t> next(0);
+  auto work = [&]() {
+    auto parser = Parser::createForTopLevelModule(context);
+    for (size_t i = next++; i < todo.size(); i = next++) {
+      parser.setUseArena(todo[i].useArena);
+      todo[i].parse = parser.parseStringDeferred(todo[i].path.c_str(),
+                                                 todo[i].text);
+    }
+  };
+
+  size_t nThreads = std::min(todo.size(), (size_t) std::max(numThreads, 1));
+  std::vector<std::thread> threads;
+  for (size_t t = 1; t < nThreads; t++) {
+    threads.emplace_back(work);
+  }
+  work();
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  // Not every file will be used, so hide the errors for now; they are
+  // reported when the parse is used without error collection.
+  for (auto& p : todo) {
+    finishingParse = &p;
+    context->runAndCaptureErrors([&](Context* ctx) {
+      return &parseFileToBuilderResultQuery(ctx, p.path, UniqueString());
+    });
+    finishingParse = nullptr;
+  }
+}
+
 // TODO: can't make this a query because can't store the uast::BuilderResult&
 //       as a query result. Might be some template specialization magic we
 //       can do to support this use case, but for now, this will just end up
@@ -1024,6 +1303,27 @@ static std::string getExistingFileInDirectory(Context* context,
   return "";
 }
 
+void prefetchModuleSearchPath(Context* context, int numThreads) {
+  std::vector<UniqueString> paths;
+  for (auto dir : moduleSearchPath(context)) {
+    std::string dirPathClean = cleanDirPath(dir.str());
+    for (const auto& fname : filesInDirWithCleanedPath(context, dirPathClean)) {
+      if (fname.size() > 5 &&
+          fname.compare(fname.size() - 5, 5, ".chpl") == 0) {
+        // compute the path the same way as getExistingFileInDirectory
+        std::string path = dirPathClean;
+        if (!path.empty()) {
+          path += "/";
+        }
+        path += fname;
+        paths.push_back(UniqueString::get(context,
+                                          cleanLocalPath(std::move(path))));
+      }
+    }
+  }
+  prefetchParses(context, paths, numThreads);
+}
+
 static std::string constructFallbackInternalPath(const char* modName) {
   return std::string(FALLBACK_INTERNAL_PREFIX) + modName + ".chpl";
 }
@@ -1274,13 +1574,51 @@ const Module* getIncludedSubmodule(Context* context,
   return getIncludedSubmoduleQuery(context, includeModuleId);
 }
 
+// The uAST for a symbol: its own node, followed by the nodes it contains
+// in postorder ID order. astForIdQuery, and so the per-ID queries built
+// on it, go through this one rather than through the parse of the whole
+// file. After an edit, this
+// query reruns for each symbol, but its result only changes if the
+// symbol's uAST changed, since BuilderResult::update keeps the nodes of
+// unchanged symbols. So the per-ID queries for the other symbols, and
+// the queries that depend on them, can be reused without rerunning.
+static const std::vector<const AstNode*>&
+astsForSymbolIdQuery(Context* context, ID symbolId) {
+  QUERY_BEGIN(astsForSymbolIdQuery, context, symbolId);
+
+  std::vector<const AstNode*> result;
+  const BuilderResult* r = parseFileContainingIdToBuilderResult(context,
+                                                                symbolId);
+  if (r != nullptr) {
+    if (const AstNode* sym = r->idToAst(symbolId)) {
+      int n = sym->id().numContainedChildren();
+      result.reserve(n + 1);
+      result.push_back(sym);
+      for (int i = 0; i < n; i++) {
+        result.push_back(r->idToAst(ID(symbolId.symbolPath(), i, 0)));
+      }
+    }
+  }
+
+  return QUERY_END(result);
+}
+
 static const AstNode* const& astForIdQuery(Context* context, ID id) {
   QUERY_BEGIN(astForIdQuery, context, id);
 
   const AstNode* result = nullptr;
-  const BuilderResult* r = parseFileContainingIdToBuilderResult(context, id);
-  if (r != nullptr) {
-    result = r->idToAst(id);
+  if (id.isFabricatedId()) {
+    const BuilderResult* r = parseFileContainingIdToBuilderResult(context, id);
+    if (r != nullptr) {
+      result = r->idToAst(id);
+    }
+  } else {
+    ID symbolId(id.symbolPath(), -1, 0);
+    const auto& asts = astsForSymbolIdQuery(context, symbolId);
+    size_t i = id.postOrderId() + 1;
+    if (i < asts.size()) {
+      result = asts[i];
+    }
   }
 
   return QUERY_END(result);
@@ -24,6 +24,7 @@
 #include "chpl/framework/ErrorMessage.h"
 #include "chpl/framework/global-strings.h"
 #include "chpl/framework/query-impl.h"
+#include "chpl/libraries/LibraryFile.h"
 #include "chpl/parsing/parsing-queries.h"
 #include "chpl/types/RecordType.h"
 #include "chpl/uast/all-uast.h"
@@ -495,6 +496,49 @@ static void populateScopeWithBuiltins(Context* context, Scope* scope) {
   populateScopeWithBuiltinKeywords(context, scope);
 }
 
+// If 'ast' is a Module or aggregate type loaded from a library file that
+// saved its declarations, construct its Scope from those rather than
+// gathering them from the uAST again. Returns nullptr otherwise.
+static Scope* constructScopeFromLibrary(Context* context,
+                                        const uast::AstNode* ast,
+                                        const Scope* parentScope) {
+  if (!ast->isModule() && !ast->isAggregateDecl()) {
+    return nullptr;
+  }
+
+  std::string symPath = ast->id().symbolPath().str();
+  ID topId = ID(UniqueString::get(context,
+                                  symPath.substr(0, symPath.find('.'))));
+  UniqueString libPath;
+  if (!context->moduleIsInLibrary(topId, libPath)) {
+    return nullptr;
+  }
+
+  auto lib = libraries::LibraryFile::load(context, libPath);
+  if (lib == nullptr) {
+    return nullptr;
+  }
+
+  auto decls = lib->loadScopeDecls(context, ast->id());
+  if (decls == nullptr) {
+    return nullptr;
+  }
+
+  DeclMap declared;
+  for (const auto& nameAndDecls : decls->declared) {
+    const auto& ids = nameAndDecls.second;
+    OwnedIdsWithName idvs(IdAndFlags::createWithFlags(ids[0].id,
+                                                      ids[0].flags));
+    for (size_t i = 1; i < ids.size(); i++) {
+      idvs.appendIdAndFlags(IdAndFlags::createWithFlags(ids[i].id,
+                                                        ids[i].flags));
+    }
+    declared.emplace(nameAndDecls.first, std::move(idvs));
+  }
+
+  return new Scope(ast, parentScope, decls->flags, std::move(declared));
+}
+
 // This query always constructs a scope
 // (don't call it if the scope does not need to exist)
 static const owned<Scope>& constructScopeQuery(Context* context, ID id) {
@@ -529,7 +573,10 @@ static const owned<Scope>& constructScopeQuery(Context* context, ID id) {
         }
       }
 
-      result = new Scope(context, ast, parentScope, autoUsesModules);
+      result = constructScopeFromLibrary(context, ast, parentScope);
+      if (result == nullptr) {
+        result = new Scope(context, ast, parentScope, autoUsesModules);
+      }
     }
   }
 
@@ -732,12 +779,74 @@ struct LookupHelper {
 
   LookupResult doLookupInExternBlocks(const Scope* scope, UniqueString name);
 
+  bool canUseNegativeCache(const Scope* scope,
+                           UniqueString name,
+                           LookupConfig config,
+                           bool trace);
+
   LookupResult doLookupInScope(const Scope* scope,
                                UniqueString name,
                                LookupConfig config,
                                std::vector<const MethodLookupHelper*>* receiversForTertiaryLookup = nullptr);
 };
 
+// Is nothing found by a lookup for 'name' in 'scope', a module scope,
+// with 'config'? The second element notes if the lookup came across an
+// extern block, which callers need to know even when nothing was found.
+//
+// Many lookups that find nothing pass through the same module scope
+// (e.g. a lookup from each function in a module for a name declared
+// further out), so remembering the negative results saves repeating the
+// traversal of the module's uses and imports for each of them.
+static const std::pair<bool, bool>&
+moduleLookupIsEmptyQuery(Context* context,
+                         const Scope* scope,
+                         UniqueString name,
+                         LookupConfig config) {
+  QUERY_BEGIN(moduleLookupIsEmptyQuery, context, scope, name, config);
+
+  CheckedScopes checkedScopes;
+  MatchingIdsWithName vec;
+  bool foundExternBlock = false;
+  auto helper = LookupHelper(context,
+                             /* resolving */ nullptr,
+                             /* receiverScopeHelper */ nullptr,
+                             checkedScopes, vec, foundExternBlock,
+                             /* prevNumResults */ 0,
+                             /* traceCurPath */ nullptr,
+                             /* traceResult */ nullptr,
+                             /* shadowedResults */ nullptr,
+                             /* traceShadowedResults */ nullptr,
+                             /* allowCached */ true);
+  auto got = helper.doLookupInScope(scope, name, config);
+
+  auto result = std::make_pair(!got, foundExternBlock);
+  return QUERY_END(result);
+}
+
+// The negative results are only recorded for lookups that don't depend
+// on where they started: no receiver, tracing, shadow warnings or
+// visibility statements being resolved.
+bool LookupHelper::canUseNegativeCache(const Scope* scope,
+                                       UniqueString name,
+                                       LookupConfig config,
+                                       bool trace) {
+  bool checkDecls = (config & LOOKUP_DECLS) != 0;
+  bool checkUseImport = (config & LOOKUP_IMPORT_AND_USE) != 0;
+  bool skipPrivateVisibilities = (config & LOOKUP_SKIP_PRIVATE_VIS) != 0;
+
+  // these lookups are already answered by ModulePublicSymbols
+  bool publicOnly = checkDecls && checkUseImport && skipPrivateVisibilities;
+
+  return allowCached && !trace && !publicOnly &&
+         isModule(scope->tag()) &&
+         resolving == nullptr &&
+         receiverScopeHelper == nullptr &&
+         shadowedResults == nullptr &&
+         !context->isQueryRunning(moduleLookupIsEmptyQuery,
+                                  std::make_tuple(scope, name, config));
+}
+
 bool LookupHelper::shouldStopLookup(const LookupResult& got, bool onlyInnermost, bool stopNonFn) {
   int itemsBefore = prevNumResults;
   prevNumResults = result.numIds();
@@ -1422,6 +1531,18 @@ LookupResult LookupHelper::doLookupInScope(const Scope* scope,
     flagsInMap.addDisjunction(curFilter);
   }
 
+  // skip the rest if this lookup is known to find nothing here
+  if ((receiversForTertiaryLookup == nullptr ||
+       receiversForTertiaryLookup->empty()) &&
+      canUseNegativeCache(scope, name, config, trace)) {
+    const auto& isEmpty = moduleLookupIsEmptyQuery(context, scope,
+                                                   name, config);
+    if (isEmpty.first) {
+      foundExternBlock |= isEmpty.second;
+      return LookupResult::empty();
+    }
+  }
+
   // if the scope has an extern block, note that fact.
   if (scope->containsExternBlock()) {
     foundExternBlock = true;
@@ -364,6 +364,18 @@ Scope::Scope(Context* context,
   flags_ = flags;
 }
 
+Scope::Scope(const uast::AstNode* ast, const Scope* parentScope,
+             ScopeFlags flags, DeclMap declared)
+  : parentScope_(parentScope),
+    tag_(ast->tag()),
+    flags_(flags),
+    id_(ast->id()),
+    declared_(std::move(declared)) {
+  if (auto decl = ast->toNamedDecl()) {
+    name_ = decl->name();
+  }
+}
+
 void Scope::addBuiltinVar(UniqueString name) {
   // Just refer to empty ID since builtin type declarations don't
   // actually exist in the AST.
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2021-2026 Hewlett Packard Enterprise Development LP
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "chpl/uast/AstArena.h"
+
+#include <new>
+
+namespace chpl {
+namespace uast {
+namespace detail {
+
+
+static const size_t CHUNK_SIZE = 64 * 1024;
+static const size_t ALIGN = alignof(std::max_align_t);
+
+static thread_local AstArena* currentArena = nullptr;
+
+AstArena* AstArena::current() {
+  return currentArena;
+}
+
+AstArena::~AstArena() {
+  for (char* chunk : chunks_) {
+    ::operator delete(chunk);
+  }
+}
+
+void* AstArena::allocate(size_t size) {
+  size = (size + ALIGN - 1) & ~(ALIGN - 1);
+
+  char* ret = nullptr;
+  if (size > CHUNK_SIZE / 4) {
+    // a large allocation gets a chunk of its own
+    ret = (char*) ::operator new(size);
+    chunks_.push_back(ret);
+  } else {
+    if (size > left_) {
+      next_ = (char*) ::operator new(CHUNK_SIZE);
+      chunks_.push_back(next_);
+      left_ = CHUNK_SIZE;
+    }
+    ret = next_;
+    next_ += size;
+    left_ -= size;
+  }
+
+  refs_++;
+  return ret;
+}
+
+AstArena::Use::Use(AstArena* arena) : saved_(currentArena) {
+  currentArena = arena;
+}
+
+AstArena::Use::~Use() {
+  currentArena = saved_;
+}
+
+
+} // end namespace detail
+} // end namespace uast
+} // end namespace chpl
@@ -19,6 +19,7 @@
 
 #include "chpl/uast/all-uast.h"
 #include "chpl/uast/AstNode.h"
+#include "chpl/uast/AstArena.h"
 
 
 #include "chpl/parsing/parsing-queries.h"
@@ -65,6 +66,33 @@ std::string AstNode::dumpChildLabelInner(int i) const {
   return "";
 }
 
+// Each node is preceded by the arena it came from, or nullptr if it came
+// from the heap. This is kept a full alignment unit so that the node
+// itself stays aligned.
+static const size_t NODE_HEADER_SIZE = alignof(std::max_align_t);
+
+void* AstNode::operator new(size_t size) {
+  detail::AstArena* arena = detail::AstArena::current();
+  char* buf = nullptr;
+  if (arena != nullptr) {
+    buf = (char*) arena->allocate(NODE_HEADER_SIZE + size);
+  } else {
+    buf = (char*) ::operator new(NODE_HEADER_SIZE + size);
+  }
+  *(detail::AstArena**) buf = arena;
+  return buf + NODE_HEADER_SIZE;
+}
+
+void AstNode::operator delete(void* ptr) {
+  if (ptr == nullptr) return;
+  char* buf = (char*) ptr - NODE_HEADER_SIZE;
+  if (detail::AstArena* arena = *(detail::AstArena**) buf) {
+    arena->release();
+  } else {
+    ::operator delete(buf);
+  }
+}
+
 AstNode::~AstNode() {
 }
 
@@ -134,6 +134,19 @@ owned<Builder> Builder::createForGeneratedCode(Context* context,
   return toOwned(b);
 }
 
+Builder::~Builder() {
+  if (arena_ != nullptr) {
+    arena_->release();
+  }
+}
+
+detail::AstArena* Builder::arena() {
+  if (arena_ == nullptr) {
+    arena_ = detail::AstArena::create();
+  }
+  return arena_;
+}
+
 owned<Builder> Builder::createForLibraryFileModule(
                                         Context* context,
                                         UniqueString filePath,
@@ -223,6 +236,9 @@ void Builder::noteSymbolTableSymbols(SymbolTableVec vec) {
 }
 
 BuilderResult Builder::result() {
+  // an implicit module is allocated like the rest of the parsed nodes
+  detail::AstArena::Use use(arena_);
+
   if (isGenerated() == false) {
     this->createImplicitModuleIfNeeded();
   }
@@ -579,7 +595,7 @@ void Builder::doAssignIDs(AstNode* ast, UniqueString symbolPath, int& i,
     auto search = notedLocations_.find(ast);
     if (search != notedLocations_.end()) {
       CHPL_ASSERT(!search->second.isEmpty());
-      br.idToLocation_[ast->id()] = search->second;
+      br.idToLocation_.set(ast->id(), search->second);
 
       // Also map additional locations to ID.
       #define LOCATION_MAP(ast__, location__) \
@@ -588,7 +604,7 @@ void Builder::doAssignIDs(AstNode* ast, UniqueString symbolPath, int& i,
           auto it = m1.find(x); \
           if (it != m1.end()) { \
             auto& m2 = br.CHPL_ID_LOC_MAP(ast__, location__); \
-            m2[x->id()] = it->second; \
+            m2.set(x->id(), it->second); \
           } \
         }
       #include "chpl/uast/all-location-maps.h"
@@ -78,6 +78,64 @@ bool BuilderResult::isSymbolTableSymbol(ID id) const {
   return libraryFileSymbols_.count(id) > 0;
 }
 
+void LocationMap::set(const ID& id, const Location& loc) {
+  Entry e;
+  e.firstLine = loc.firstLine();
+  e.firstColumn = loc.firstColumn();
+  e.lastColumn = loc.lastColumn();
+  e.lastLineDelta = 0;
+  e.pathIdx = OVERFLOW_PATH_IDX;
+
+  // nearly always, the path is the most recent one
+  UniqueString path = loc.path();
+  size_t pathIdx = paths_.size();
+  for (size_t i = paths_.size(); i > 0; i--) {
+    if (paths_[i-1] == path) {
+      pathIdx = i-1;
+      break;
+    }
+  }
+  if (pathIdx == paths_.size() && pathIdx < OVERFLOW_PATH_IDX) {
+    paths_.push_back(path);
+  }
+
+  long delta = (long) loc.lastLine() - (long) loc.firstLine();
+  if (pathIdx < OVERFLOW_PATH_IDX && 0 <= delta && delta < 0x10000) {
+    e.lastLineDelta = (uint16_t) delta;
+    e.pathIdx = (uint16_t) pathIdx;
+  } else {
+    e.firstLine = (int) overflow_.size();
+    overflow_.push_back(loc);
+  }
+
+  map_[id] = e;
+}
+
+bool LocationMap::find(const ID& id, Location& loc) const {
+  auto search = map_.find(id);
+  if (search == map_.end()) {
+    return false;
+  }
+
+  const Entry& e = search->second;
+  if (e.pathIdx == OVERFLOW_PATH_IDX) {
+    loc = overflow_[e.firstLine];
+  } else {
+    loc = Location(paths_[e.pathIdx], e.firstLine, e.firstColumn,
+                   e.firstLine + e.lastLineDelta, e.lastColumn);
+  }
+  return true;
+}
+
+void LocationMap::mark(Context* context) const {
+  for (const auto& path : paths_) {
+    path.mark(context);
+  }
+  for (const auto& loc : overflow_) {
+    loc.mark(context);
+  }
+}
+
 void BuilderResult::swap(BuilderResult& other) {
   filePath_.swap(other.filePath_);
   topLevelExpressions_.swap(other.topLevelExpressions_);
@@ -152,10 +210,7 @@ void BuilderResult::mark(Context* context) const {
   // ID (pair.first) will be marked by markAstList above
 
   // mark UniqueStrings in the Locations
-  for (const auto& pair : idToLocation_) {
-    //pair.first.mark(context); // redundant
-    pair.second.mark(context);
-  }
+  idToLocation_.mark(context);
 
   for (const auto& pair : idToParentId_) {
     // pair.first.mark(context); // redundant
@@ -171,7 +226,7 @@ void BuilderResult::mark(Context* context) const {
   // IDs since they should already be marked as explained above.
   #define LOCATION_MAP(ast__, location__) { \
     auto& m = CHPL_ID_LOC_MAP(ast__, location__); \
-    for (const auto& p : m) p.second.mark(context); \
+    m.mark(context); \
   }
   #include "chpl/uast/all-location-maps.h"
   #undef LOCATION_MAP
@@ -303,9 +358,9 @@ Location BuilderResult::idToLocation(Context* context,
   }
 
   // Look in astToLocation
-  auto search = idToLocation_.find(id);
-  if (search != idToLocation_.end()) {
-    return search->second;
+  Location loc;
+  if (idToLocation_.find(id, loc)) {
+    return loc;
   }
   return Location(path);
 }
@@ -343,8 +398,8 @@ ID BuilderResult::idToParentId(ID id) const {
                                             LocationMapTag::location__); \
     } \
     auto& m = CHPL_ID_LOC_MAP(ast__, location__); \
-    auto it = m.find(id); \
-    return (it != m.end()) ? it->second : Location(path); \
+    Location loc; \
+    return m.find(id, loc) ? loc : Location(path); \
   }
 #include "chpl/uast/all-location-maps.h"
 #undef LOCATION_MAP
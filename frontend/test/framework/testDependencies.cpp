@@ -517,6 +517,84 @@ static void test6b() {
   assert(nQuerySevenRuns == 1);
 }
 
+int nSquareRuns = 0;
+
+static const int& squareQuery(Context* context, int x) {
+  QUERY_BEGIN(squareQuery, context, x);
+
+  int result = x * x;
+  nSquareRuns++;
+
+  return QUERY_END(result);
+}
+
+static const UniqueString& nameQuery(Context* context, int x) {
+  QUERY_BEGIN(nameQuery, context, x);
+
+  std::string str = "name number " + std::to_string(x);
+  UniqueString result = UniqueString::get(context, str);
+
+  return QUERY_END(result);
+}
+
+// Check that collectGarbage keeps results used in the last
+// 'keepRevisions' revisions and removes the rest.
+static void test7() {
+  Context ctx;
+  Context* context = &ctx;
+  nSquareRuns = 0;
+
+  // revision 1 computes both
+  assert(squareQuery(context, 1) == 1);
+  assert(squareQuery(context, 2) == 4);
+  assert(nSquareRuns == 2);
+
+  // revision 2 only uses 1; 2 is still recent enough to keep
+  context->advanceToNextRevision(false);
+  assert(squareQuery(context, 1) == 1);
+  context->collectGarbage(2);
+  assert(nSquareRuns == 2);
+
+  // revision 3 only uses 1, so collecting removes 2
+  context->advanceToNextRevision(false);
+  assert(squareQuery(context, 1) == 1);
+  context->collectGarbage(2);
+
+  context->advanceToNextRevision(false);
+  assert(squareQuery(context, 1) == 1);
+  assert(nSquareRuns == 2);
+  assert(squareQuery(context, 2) == 4);
+  assert(nSquareRuns == 3);
+
+  // the default only keeps what was used in this revision
+  context->advanceToNextRevision(false);
+  assert(squareQuery(context, 2) == 4);
+  context->collectGarbage();
+  context->advanceToNextRevision(false);
+  assert(squareQuery(context, 2) == 4);
+  assert(nSquareRuns == 3);
+  assert(squareQuery(context, 1) == 1);
+  assert(nSquareRuns == 4);
+}
+
+// Check that UniqueStrings in results kept from earlier revisions
+// survive collecting UniqueStrings.
+static void test8() {
+  Context ctx;
+  Context* context = &ctx;
+
+  const char* name = nameQuery(context, 5).c_str();
+
+  context->advanceToNextRevision(true);
+  std::ignore = nameQuery(context, 6);
+  context->collectGarbage(2);
+
+  context->advanceToNextRevision(false);
+  UniqueString again = UniqueString::get(context, "name number 5");
+  assert(again.c_str() == name);
+  assert(nameQuery(context, 5).c_str() == name);
+}
+
 int main() {
   test0();
   test1();
@@ -526,6 +604,8 @@ int main() {
   test5();
   test6a();
   test6b();
+  test7();
+  test8();
 
   return 0;
 }
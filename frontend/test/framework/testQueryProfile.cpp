@@ -0,0 +1,94 @@
+/*
+ * Copyright 2021-2026 Hewlett Packard Enterprise Development LP
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "test-common.h"
+
+#include "chpl/framework/Context.h"
+#include "chpl/framework/query-impl.h"
+
+#include <chrono>
+#include <sstream>
+
+using namespace chpl;
+
+static void spin() {
+  auto start = std::chrono::steady_clock::now();
+  while (std::chrono::steady_clock::now() - start <
+         std::chrono::milliseconds(2)) {
+  }
+}
+
+static const int& profInner(Context* context, int x) {
+  QUERY_BEGIN(profInner, context, x);
+  spin();
+  int result = x + 1;
+  return QUERY_END(result);
+}
+
+static const int& profOuter(Context* context, int x) {
+  QUERY_BEGIN(profOuter, context, x);
+  spin();
+  int result = profInner(context, x) + profInner(context, x + 1);
+  return QUERY_END(result);
+}
+
+// the profile records which query called which, and the self time
+// of each
+static void test1() {
+#if CHPL_QUERY_TIMING_AND_TRACE_ENABLED
+  Context ctx;
+  Context* context = &ctx;
+  context->setQueryProfileFlag(true);
+
+  assert(profOuter(context, 1) == 5);
+
+  std::ostringstream folded;
+  context->queryProfileFoldedStacks(folded);
+  std::string s = folded.str();
+  printf("%s", s.c_str());
+  assert(s.find("profOuter ") != std::string::npos);
+  assert(s.find("profOuter;profInner ") != std::string::npos);
+
+  std::ostringstream report;
+  context->queryProfileReport(report);
+  printf("%s", report.str().c_str());
+  assert(report.str().find("profInner") != std::string::npos);
+#endif
+}
+
+// nothing is recorded while the profile is off
+static void test2() {
+#if CHPL_QUERY_TIMING_AND_TRACE_ENABLED
+  Context ctx;
+  Context* context = &ctx;
+
+  assert(profOuter(context, 1) == 5);
+
+  std::ostringstream folded;
+  context->queryProfileFoldedStacks(folded);
+  assert(folded.str().empty());
+#endif
+}
+
+int main() {
+  test1();
+  test2();
+
+  return 0;
+}
@@ -28,6 +28,8 @@
 #include <sstream>
 #include <string>
 #include <iostream>
+#include <thread>
+#include <vector>
 
 using namespace chpl;
 
@@ -433,6 +435,39 @@ static void test4() {
   assert(d >= abc);
 }
 
+// unique strings from several threads at once
+static void test5() {
+  Context context;
+  Context* ctx = &context;
+
+  const int nThreads = 8;
+  const int nStrings = 5000;
+  std::vector<std::vector<const char*>> got(nThreads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < nThreads; t++) {
+    threads.emplace_back([ctx, t, &got]() {
+      for (int i = 0; i < nStrings; i++) {
+        // every thread gets the same strings, in a different order
+        int n = (i + t * 997) % nStrings;
+        std::string s = "str" + std::to_string(n);
+        got[t].push_back(ctx->uniqueCString(s.c_str()));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (int t = 0; t < nThreads; t++) {
+    for (int i = 0; i < nStrings; i++) {
+      int n = (i + t * 997) % nStrings;
+      std::string s = "str" + std::to_string(n);
+      assert(got[t][i] == ctx->uniqueCString(s.c_str()));
+      assert(s == got[t][i]);
+    }
+  }
+}
+
 
 int main(int argc, char** argv) {
   const char* inputFile = nullptr;
@@ -450,6 +485,7 @@ int main(int argc, char** argv) {
   test2();
   test3();
   test4();
+  test5();
 
   Context context;
   Context* ctx = &context;
@@ -23,6 +23,7 @@
 #include "chpl/libraries/LibraryFileWriter.h"
 #include "chpl/framework/Location.h"
 #include "chpl/framework/UniqueString.h"
+#include "chpl/resolution/scope-queries.h"
 #include "chpl/uast/Module.h"
 #include "chpl/util/filesystem.h"
 
@@ -152,6 +153,88 @@ static void testStrings() {
 }
 
 
+static void testStoreLoadScopes() {
+  printf("testStoreLoadScopes\n");
+
+  Context ctx;
+  Context* context = &ctx;
+  ErrorGuard guard(context);
+
+  auto libpath = UniqueString::get(context, output);
+  auto path = UniqueString::get(context, "scopes.chpl");
+  std::vector<UniqueString> paths;
+  paths.push_back(path);
+
+  parsing::setFileText(context, path,
+                       R""""(
+                         module M {
+                           var i: int;
+                           proc f() { }
+                           proc f(x: int) { }
+                           record R { var x: int; proc g() { } }
+                         }
+                       )"""");
+
+  const BuilderResult& parsed =
+    parsing::parseFileToBuilderResult(context, path, UniqueString());
+  const Module* parsedMod = parsed.singleModule();
+  assert(parsedMod != nullptr);
+
+  LibraryFileWriter writer(context, libpath.str());
+  writer.setSourcePaths(paths);
+  writer.writeAllSections();
+  assert(guard.realizeErrors() == 0);
+
+  const LibraryFile* lf = LibraryFile::load(context, libpath);
+  assert(lf != nullptr);
+
+  // the saved scopes should match the ones computed from the source
+  const AstNode* rec = nullptr;
+  for (auto child : parsedMod->children()) {
+    if (child->isRecord()) rec = child;
+  }
+  assert(rec != nullptr);
+
+  for (const AstNode* ast : {(const AstNode*) parsedMod, rec}) {
+    const resolution::Scope* s = resolution::scopeForId(context, ast->id());
+    const LibraryFile::ScopeDecls* decls = lf->loadScopeDecls(context,
+                                                              ast->id());
+    assert(s != nullptr && decls != nullptr);
+    assert(s->flags() == decls->flags);
+    assert((size_t) s->numDeclared() == decls->declared.size());
+
+    for (const auto& nameAndDecls : decls->declared) {
+      resolution::MatchingIdsWithName ids;
+      auto search = s->declared().find(nameAndDecls.first);
+      assert(search != s->declared().end());
+      search->second.gatherMatches(ids, 0,
+                                   resolution::IdAndFlags::FlagSet::empty());
+      assert((size_t) ids.numIds() == nameAndDecls.second.size());
+      for (int i = 0; i < ids.numIds(); i++) {
+        assert(ids.id(i) == nameAndDecls.second[i].id);
+        assert(ids.idAndFlags(i).flags() == nameAndDecls.second[i].flags);
+      }
+    }
+  }
+
+  // 'f' is declared twice
+  const LibraryFile::ScopeDecls* modDecls =
+    lf->loadScopeDecls(context, parsedMod->id());
+  bool foundF = false;
+  for (const auto& nameAndDecls : modDecls->declared) {
+    if (nameAndDecls.first == UniqueString::get(context, "f")) {
+      assert(nameAndDecls.second.size() == 2);
+      foundF = true;
+    }
+  }
+  assert(foundF);
+
+  // nothing is stored for IDs that are not scopes in the library
+  assert(lf->loadScopeDecls(context, ID()) == nullptr);
+  assert(lf->loadScopeDecls(context,
+                            ID(UniqueString::get(context, "N"))) == nullptr);
+}
+
 
 int main(int argc, char** argv) {
   // use the passed file if provided
@@ -187,5 +270,7 @@ int main(int argc, char** argv) {
                            }
                          )"""");
 
+  testStoreLoadScopes();
+
   return 0;
 }
@@ -784,6 +784,229 @@ static void test12() {
   assert(cDeclAttr==nullptr);
 }
 
+static void test13() {
+  printf("test13\n");
+  Context context;
+  Context* ctx = &context;
+
+  std::vector<UniqueString> paths;
+  std::vector<std::string> contents;
+  for (int i = 0; i < 8; i++) {
+    std::string path = ctx->tmpDir() + "/prefetch" + std::to_string(i) +
+                       ".chpl";
+    std::string text = "var x" + std::to_string(i) + ": int;\n";
+    FILE* fp = fopen(path.c_str(), "w");
+    assert(fp);
+    fputs(text.c_str(), fp);
+    fclose(fp);
+    paths.push_back(UniqueString::get(ctx, path));
+    contents.push_back(text);
+  }
+
+  // already stored contents are kept
+  setFileText(ctx, paths[0], "var y: int;\n");
+  contents[0] = "var y: int;\n";
+
+  // missing files are left alone
+  auto missing = UniqueString::get(ctx, ctx->tmpDir() + "/missing.chpl");
+  paths.push_back(missing);
+
+  prefetchFileTexts(ctx, paths, 4);
+
+  for (size_t i = 0; i < contents.size(); i++) {
+    assert(hasFileText(ctx, paths[i].str()));
+    assert(fileText(ctx, paths[i]).text() == contents[i]);
+  }
+  assert(!hasFileText(ctx, missing.str()));
+}
+
+static void test14() {
+  printf("test14\n");
+  // holds the source file and the cache for both Contexts below
+  Context outerContext;
+  std::string dir = outerContext.tmpDir();
+  std::string cacheDir = dir + "/cache";
+  std::string path = dir + "/cached.chpl";
+  std::string text = "module cached { var x: int; proc f() { return x; } }\n";
+  FILE* fp = fopen(path.c_str(), "w");
+  assert(fp);
+  fputs(text.c_str(), fp);
+  fclose(fp);
+
+  Context::Configuration config;
+  config.queryCacheDir = cacheDir;
+
+  // the first Context parses the file and saves it in the cache
+  Context context1(config);
+  Context* ctx1 = &context1;
+  auto path1 = UniqueString::get(ctx1, path);
+  auto& mods1 = parse(ctx1, path1, UniqueString());
+  assert(mods1.size() == 1);
+  auto parsedFiles1 = introspectParsedFiles(ctx1);
+  assert(std::find(parsedFiles1.begin(), parsedFiles1.end(), path1) !=
+         parsedFiles1.end());
+
+  // the second one loads it from the cache instead of parsing
+  Context::Configuration config2;
+  config2.queryCacheDir = cacheDir;
+  Context context2(config2);
+  Context* ctx2 = &context2;
+  auto path2 = UniqueString::get(ctx2, path);
+  auto& mods2 = parse(ctx2, path2, UniqueString());
+  assert(mods2.size() == 1);
+  assert(mods2[0]->completeMatch(mods1[0]));
+  assert(mods2[0]->id() == mods1[0]->id());
+  auto parsedFiles2 = introspectParsedFiles(ctx2);
+  assert(std::find(parsedFiles2.begin(), parsedFiles2.end(), path2) ==
+         parsedFiles2.end());
+
+  // IDs still map back to the source file
+  UniqueString idPath;
+  UniqueString idParentPath;
+  assert(ctx2->filePathForId(mods2[0]->id(), idPath, idParentPath));
+  assert(idPath == path2);
+  auto loc = locateId(ctx2, mods2[0]->id());
+  assert(loc.path() == path2);
+  assert(loc.firstLine() == 1);
+
+  // changing the contents makes the cached copy unused
+  Context::Configuration config3;
+  config3.queryCacheDir = cacheDir;
+  Context context3(config3);
+  Context* ctx3 = &context3;
+  auto path3 = UniqueString::get(ctx3, path);
+  setFileText(ctx3, path3, "module cached { var y: int; }\n");
+  auto& mods3 = parse(ctx3, path3, UniqueString());
+  assert(mods3.size() == 1);
+  assert(!mods3[0]->completeMatch(mods1[0]));
+}
+
+static void test15() {
+  printf("test15\n");
+  Context context;
+  Context* ctx = &context;
+  ErrorGuard guard(ctx);
+
+  std::vector<UniqueString> paths;
+  for (int i = 0; i < 6; i++) {
+    auto path = UniqueString::get(ctx, "prefetch" + std::to_string(i) +
+                                       ".chpl");
+    setFileText(ctx, path, "module prefetch" + std::to_string(i) +
+                           " { var x: int; }\n");
+    paths.push_back(path);
+  }
+  auto bad = UniqueString::get(ctx, "prefetchBad.chpl");
+  setFileText(ctx, bad, "module prefetchBad { var x: int = ; }\n");
+  paths.push_back(bad);
+
+  prefetchParses(ctx, paths, 4);
+
+  // the files are parsed, but the errors aren't reported yet
+  auto parsedFiles = introspectParsedFiles(ctx);
+  for (auto path : paths) {
+    assert(std::find(parsedFiles.begin(), parsedFiles.end(), path) !=
+           parsedFiles.end());
+  }
+  assert(guard.numErrors() == 0);
+
+  for (int i = 0; i < 6; i++) {
+    auto& br = parseFileToBuilderResult(ctx, paths[i], UniqueString());
+    assert(br.numTopLevelExpressions() == 1);
+    auto mod = br.topLevelExpression(0)->toModule();
+    assert(mod);
+    assert(mod->name().str() == "prefetch" + std::to_string(i));
+    assert(mod->id().symbolPath() == mod->name());
+  }
+  assert(guard.numErrors() == 0);
+
+  // using the parse reports its errors
+  parseFileToBuilderResult(ctx, bad, UniqueString());
+  assert(guard.realizeErrors() > 0);
+}
+
+static void test16() {
+  printf("test16\n");
+  Context context;
+  Context* ctx = &context;
+
+  auto path = UniqueString::get(ctx, "incr.chpl");
+  ctx->advanceToNextRevision(false);
+  setFileText(ctx, path, "module incr {\n"
+                         "  proc f() { return 1; }\n"
+                         "  proc g() { return 2; }\n"
+                         "}\n");
+  const Module* mod = parseOneModule(ctx, path);
+  const Function* f = mod->stmt(0)->toFunction();
+  const Function* g = mod->stmt(1)->toFunction();
+  assert(f && g);
+  ID fRet = f->stmt(0)->id();
+  ID gRet = g->stmt(0)->id();
+  const AstNode* oldFRet = idToAst(ctx, fRet);
+  const AstNode* oldGRet = idToAst(ctx, gRet);
+  assert(oldFRet == f->stmt(0));
+  assert(oldGRet == g->stmt(0));
+  assert(idToAst(ctx, f->id()) == f);
+  ID modId = mod->id();
+  assert(idToAst(ctx, modId) == mod);
+
+  // changing g leaves the uAST for f as it was
+  ctx->advanceToNextRevision(false);
+  setFileText(ctx, path, "module incr {\n"
+                         "  proc f() { return 1; }\n"
+                         "  proc g() { return 3; }\n"
+                         "}\n");
+  // (the old module and g are gone now, so don't look at them)
+  const Module* newMod = parseOneModule(ctx, path);
+  assert(newMod->stmt(0) == f);
+  assert(idToAst(ctx, f->id()) == f);
+  assert(idToAst(ctx, fRet) == oldFRet);
+  const AstNode* newGRet = idToAst(ctx, gRet);
+  assert(newGRet != nullptr && newGRet != oldGRet);
+  assert(newGRet == newMod->stmt(1)->toFunction()->stmt(0));
+  assert(idToAst(ctx, modId) == newMod);
+
+  // IDs that are no longer in the file don't find anything
+  ctx->advanceToNextRevision(false);
+  setFileText(ctx, path, "module incr {\n"
+                         "  proc f() { return 1; }\n"
+                         "}\n");
+  parseOneModule(ctx, path);
+  assert(idToAst(ctx, fRet) == oldFRet);
+  assert(idToAst(ctx, gRet) == nullptr);
+}
+
+// locations are stored compactly, including ones spanning many lines
+static void test17() {
+  printf("test17\n");
+  Context context;
+  Context* ctx = &context;
+
+  auto path = UniqueString::get(ctx, "lines.chpl");
+  std::string text = "module lines {\n"
+                     "  var a = 1;\n"
+                     "  var b = (1,\n";
+  for (int i = 0; i < 70000; i++) {
+    text += "\n";
+  }
+  text += "  2);\n"
+          "}\n";
+  setFileText(ctx, path, text);
+  const Module* mod = parseOneModule(ctx, path);
+  const AstNode* a = mod->stmt(0);
+  const AstNode* b = mod->stmt(1);
+
+  Location modLoc = locateAst(ctx, mod);
+  Location aLoc = locateAst(ctx, a);
+  Location bLoc = locateAst(ctx, b);
+  assert(modLoc.path() == path);
+  assert(modLoc.firstLine() == 1 && modLoc.lastLine() == 70005);
+  assert(aLoc.path() == path);
+  assert(aLoc.firstLine() == 2 && aLoc.lastLine() == 2);
+  assert(aLoc.firstColumn() == 3);
+  assert(bLoc.firstLine() == 3 && bLoc.lastLine() == 70004);
+  assert(bLoc.firstColumn() == 3);
+}
+
 int main() {
   test0();
   test1();
@@ -798,6 +1021,11 @@ int main() {
   test10();
   test11();
   test12();
+  test13();
+  test14();
+  test15();
+  test16();
+  test17();
 
   return 0;
 }
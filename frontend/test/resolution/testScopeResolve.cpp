@@ -1330,6 +1330,63 @@ static void test33() {
   assert(rSubSub.byAst(tSubSub2).toId() == x->id());
 }
 
+static void test34() {
+  printf("test34\n");
+  Context ctx;
+  Context* context = &ctx;
+
+  // lookups from several functions pass through N looking for a name
+  // that isn't there; make sure the cached answer follows changes
+  for (int rev = 0; rev < 2; rev++) {
+    context->advanceToNextRevision(false);
+    ErrorGuard guard(context);
+
+    auto path = UniqueString::get(context, "input.chpl");
+    std::string contents = R""""(
+        module M {
+          var y: int;
+   )"""";
+    if (rev == 1) {
+      contents += "var z: int;\n";
+    }
+    contents += R""""(
+        }
+        module N {
+          use M;
+          proc f() { var a = 1; }
+          proc g() { var b = 2; }
+        }
+     )"""";
+    setFileText(context, path, contents);
+
+    const ModuleVec& vec = parseToplevel(context, path);
+    auto y = findVariable(vec, "y");
+    auto a = findVariable(vec, "a");
+    auto b = findVariable(vec, "b");
+    assert(y && a && b);
+
+    auto yName = UniqueString::get(context, "y");
+    auto zName = UniqueString::get(context, "z");
+    for (auto var : {a, b}) {
+      const Scope* scope = scopeForId(context, var->id());
+      assert(scope);
+      auto ys = lookupNameInScope(context, scope, nullptr, nullptr, yName,
+                                  IDENTIFIER_LOOKUP_CONFIG);
+      assert(ys.numIds() == 1 && ys.firstId() == y->id());
+      auto zs = lookupNameInScope(context, scope, nullptr, nullptr, zName,
+                                  IDENTIFIER_LOOKUP_CONFIG);
+      if (rev == 0) {
+        assert(zs.numIds() == 0);
+      } else {
+        auto z = findVariable(vec, "z");
+        assert(z);
+        assert(zs.numIds() == 1 && zs.firstId() == z->id());
+      }
+    }
+    assert(guard.realizeErrors() == 0);
+  }
+}
+
 
 int main() {
   test1();
@@ -1367,6 +1424,7 @@ int main() {
   test32a();
   test32b();
   test33();
+  test34();
 
   return 0;
 }
@@ -0,0 +1,148 @@
+/*
+ * Copyright 2021-2026 Hewlett Packard Enterprise Development LP
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "test-common.h"
+
+#include "chpl/framework/Context.h"
+#include "chpl/parsing/Parser.h"
+#include "chpl/uast/AstArena.h"
+#include "chpl/uast/Builder.h"
+#include "chpl/uast/Module.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace chpl;
+using namespace uast;
+using namespace parsing;
+using uast::detail::AstArena;
+
+// Uses nest, and end with the heap as the place nodes come from
+static void test0() {
+  assert(AstArena::current() == nullptr);
+
+  AstArena* a = AstArena::create();
+  AstArena* b = AstArena::create();
+  {
+    AstArena::Use useA(a);
+    assert(AstArena::current() == a);
+    {
+      AstArena::Use useB(b);
+      assert(AstArena::current() == b);
+      {
+        AstArena::Use useHeap(nullptr);
+        assert(AstArena::current() == nullptr);
+      }
+      assert(AstArena::current() == b);
+    }
+    assert(AstArena::current() == a);
+  }
+  assert(AstArena::current() == nullptr);
+  a->release();
+  b->release();
+}
+
+// Builders are made one after another on a worker thread, finished and
+// destroyed in the order they were made on the main thread, and their
+// uAST is freed on a third thread.
+static void test1() {
+  Context context;
+  Context* ctx = &context;
+
+  const int n = 4;
+  std::vector<std::string> paths;
+  std::vector<std::string> texts;
+  for (int i = 0; i < n; i++) {
+    paths.push_back("arena" + std::to_string(i) + ".chpl");
+    texts.push_back("module arena" + std::to_string(i) +
+                    " { var x: int; proc f() { return x; } }\n");
+  }
+
+  std::vector<Parser::DeferredParse> parses(n);
+  bool workerLeftNoArena = false;
+  std::thread worker([&]() {
+    auto parser = Parser::createForTopLevelModule(ctx);
+    for (int i = 0; i < n; i++) {
+      parses[i] = parser.parseStringDeferred(paths[i].c_str(),
+                                             texts[i].c_str());
+    }
+    workerLeftNoArena = AstArena::current() == nullptr;
+  });
+  worker.join();
+  assert(workerLeftNoArena);
+
+  std::vector<BuilderResult> results;
+  auto parser = Parser::createForTopLevelModule(ctx);
+  for (int i = 0; i < n; i++) {
+    results.push_back(parser.finishParse(std::move(parses[i])));
+    assert(AstArena::current() == nullptr);
+  }
+  parses.clear();
+
+  for (int i = 0; i < n; i++) {
+    assert(results[i].numTopLevelExpressions() == 1);
+    auto mod = results[i].topLevelExpression(0)->toModule();
+    assert(mod);
+    assert(mod->name() == UniqueString::get(ctx, "arena" + std::to_string(i)));
+    assert(mod->numStmts() == 2);
+  }
+
+  // nodes made on the main thread now come from the heap
+  auto builder = Builder::createForTopLevelModule(ctx, "heap.chpl");
+  assert(AstArena::current() == nullptr);
+
+  std::thread freer([&]() {
+    results.clear();
+  });
+  freer.join();
+  assert(results.empty());
+}
+
+// A node may outlive the Builder and the BuilderResult it was made for
+static void test2() {
+  Context context;
+  Context* ctx = &context;
+
+  BuilderResult kept;
+  {
+    auto parser = Parser::createForTopLevelModule(ctx);
+    BuilderResult first = parser.parseString("first.chpl",
+                                             "module first { var y: int; }\n");
+    kept.swap(first);
+  }
+  assert(kept.numTopLevelExpressions() == 1);
+  auto mod = kept.topLevelExpression(0)->toModule();
+  assert(mod && mod->name() == UniqueString::get(ctx, "first"));
+
+  // parsing without an arena gives the same uAST
+  auto parser = Parser::createForTopLevelModule(ctx);
+  parser.setUseArena(false);
+  BuilderResult heap = parser.parseString("first.chpl",
+                                          "module first { var y: int; }\n");
+  assert(heap.topLevelExpression(0)->completeMatch(mod));
+}
+
+int main(int argc, char** argv) {
+  test0();
+  test1();
+  test2();
+
+  return 0;
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2026-2026 Hewlett Packard Enterprise Development LP
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "test-common.h"
+
+#include "chpl/util/hash.h"
+
+#include <set>
+
+using namespace chpl;
+
+static void testStrings() {
+  const char* str = "the quick brown fox jumps over the lazy dog";
+  std::string s = str;
+
+  // all the ways of hashing a string agree
+  assert(hash(str) == hash(s));
+  assert(hash(str, strlen(str)) == hash(s));
+
+  // every length, including ones that aren't a multiple of 8, and
+  // every position of a differing character, gives a different hash
+  std::set<size_t> seen;
+  for (size_t len = 0; len <= s.size(); len++) {
+    auto ok = seen.insert(hash(s.data(), len));
+    assert(ok.second);
+  }
+  for (size_t i = 0; i < s.size(); i++) {
+    std::string t = s;
+    t[i] = '_';
+    auto ok = seen.insert(hash(t));
+    assert(ok.second);
+  }
+
+  // trailing zero bytes matter
+  std::string zeros("ab\0\0", 4);
+  assert(hash(zeros.data(), 2) != hash(zeros.data(), 3));
+  assert(hash(zeros.data(), 3) != hash(zeros.data(), 4));
+}
+
+static void testCombine() {
+  // order matters
+  assert(hash_combine(1, 2) != hash_combine(2, 1));
+  assert(hash(1, 2) != hash(2, 1));
+  assert(hash(std::vector<int>{1, 2}) != hash(std::vector<int>{2, 1}));
+
+  // aligned pointers have low bits that are always 0; after mixing, the
+  // low bits of nearby ones should vary (as they do for a DenseMap)
+  std::set<size_t> lowBits;
+  for (uint64_t i = 0; i < 256; i++) {
+    lowBits.insert(hash_mix(0x7f0000001000 + i * 16) & 0xff);
+  }
+  assert(lowBits.size() > 128);
+}
+
+static void testUnorderedMap() {
+  // the same entries hash the same regardless of insertion order
+  // and bucket count
+  std::unordered_map<int, int> a;
+  std::unordered_map<int, int> b;
+  b.reserve(1000);
+  for (int i = 0; i < 100; i++) {
+    a[i] = i * 7;
+    b[99 - i] = (99 - i) * 7;
+  }
+  assert(hashUnorderedMap(a) == hashUnorderedMap(b));
+
+  // but the values matter, and so do the pairings of keys and values
+  b[3] = 0;
+  assert(hashUnorderedMap(a) != hashUnorderedMap(b));
+  std::unordered_map<int, int> c = {{1, 2}, {2, 1}};
+  std::unordered_map<int, int> d = {{1, 1}, {2, 2}};
+  assert(hashUnorderedMap(c) != hashUnorderedMap(d));
+}
+
+int main(int argc, char** argv) {
+  testStrings();
+  testCombine();
+  testUnorderedMap();
+
+  return 0;
+}
@@ -21,11 +21,19 @@
 #define CHPL_STB_IMAGE_WRITE_HELPER_H_
 
 #include "chpl-mem.h"
+#include "chpl-tasks.h"
+#include "chpl-thread-local-storage.h"
+
+#include <string.h>
 
 #define STBIW_MALLOC(sz)        chpl_mem_alloc(sz, 0, 0, 0)
 #define STBIW_REALLOC(p,newsz)  chpl_mem_realloc(p, newsz, 0, 0, 0)
 #define STBIW_FREE(p)           chpl_mem_free(p, 0, 0)
 
+#define STBI_MALLOC(sz)         chpl_mem_alloc(sz, 0, 0, 0)
+#define STBI_REALLOC(p,newsz)   chpl_mem_realloc(p, newsz, 0, 0, 0)
+#define STBI_FREE(p)            chpl_mem_free(p, 0, 0)
+
 #define STB_IMAGE_IMPLEMENTATION
 #define STBI_ONLY_PNG
 #define STBI_ONLY_JPEG
@@ -38,4 +46,268 @@
 
 #include "stb/stb_image_write.h"
 
+//
+// Faster codecs, used in place of stb where they can do the job.  They
+// have to be asked for, since they also need to be linked, e.g. with
+//
+//   --ccflags -DCHPL_IMAGE_USE_TURBOJPEG -lturbojpeg
+//   --ccflags -DCHPL_IMAGE_USE_SPNG -lspng
+//
+// libjpeg-turbo is used to decode and encode JPEGs with 1, 3 or 4
+// channels.  libspng is used to decode PNGs to 3 or 4 channels.
+// Anything else goes through stb.
+//
+#ifdef CHPL_IMAGE_USE_TURBOJPEG
+#include <turbojpeg.h>
+#endif
+#ifdef CHPL_IMAGE_USE_SPNG
+#include <spng.h>
+#endif
+
+#define CHPL_IMAGE_OK            0
+#define CHPL_IMAGE_ERR_DECODE    1   // not a PNG or JPEG we can read
+#define CHPL_IMAGE_ERR_TOO_SMALL 2   // the output buffer is too small
+#define CHPL_IMAGE_ERR_ENCODE    3
+
+#define CHPL_IMAGE_FORMAT_PNG    0
+#define CHPL_IMAGE_FORMAT_JPEG   1
+
+// Get the size and number of channels of an encoded image without
+// decoding it.  Returns 1 on success and 0 if the image can't be read.
+static inline
+int chpl_image_info(const unsigned char* data, int len,
+                    int* w, int* h, int* channels) {
+  return stbi_info_from_memory(data, len, w, h, channels);
+}
+
+#ifdef CHPL_IMAGE_USE_TURBOJPEG
+// tjhandles are expensive to make, so each thread keeps one of each
+static CHPL_TLS tjhandle chpl_image_tjDecompressor;
+static CHPL_TLS tjhandle chpl_image_tjCompressor;
+
+static inline int chpl_image_tjPixelFormat(int channels) {
+  switch (channels) {
+    case 1: return TJPF_GRAY;
+    case 3: return TJPF_RGB;
+    case 4: return TJPF_RGBA;
+    default: return -1;
+  }
+}
+#endif
+
+//
+// Decode an image into 'out', which has room for 'outSize' bytes, as
+// 8-bit samples with 'channels' (1 to 4) channels per pixel, and store
+// its size in 'w' and 'h'.  JPEGs and PNGs that a faster codec can
+// handle are decoded straight into 'out'; for the rest stb decodes into
+// a buffer of its own, which is then copied.  Returns one of the
+// CHPL_IMAGE_ codes.
+//
+static int chpl_image_decode_into(const unsigned char* data, int len,
+                                  int channels, unsigned char* out,
+                                  size_t outSize, int* w, int* h) {
+#ifdef CHPL_IMAGE_USE_TURBOJPEG
+  if (len >= 2 && data[0] == 0xFF && data[1] == 0xD8
+      && chpl_image_tjPixelFormat(channels) >= 0) {
+    int subsamp, colorspace;
+    tjhandle tj = chpl_image_tjDecompressor;
+    if (tj == NULL) {
+      tj = chpl_image_tjDecompressor = tjInitDecompress();
+    }
+    if (tj != NULL
+        && tjDecompressHeader3(tj, data, len, w, h, &subsamp,
+                               &colorspace) == 0) {
+      if ((size_t) *w * *h * channels > outSize) {
+        return CHPL_IMAGE_ERR_TOO_SMALL;
+      }
+      if (tjDecompress2(tj, data, len, out, *w, 0, *h,
+                        chpl_image_tjPixelFormat(channels), 0) == 0) {
+        return CHPL_IMAGE_OK;
+      }
+    }
+  }
+#endif
+
+#ifdef CHPL_IMAGE_USE_SPNG
+  if (len >= 8 && memcmp(data, "\x89PNG\r\n\x1a\n", 8) == 0
+      && (channels == 3 || channels == 4)) {
+    int fmt = (channels == 4) ? SPNG_FMT_RGBA8 : SPNG_FMT_RGB8;
+    spng_ctx* ctx = spng_ctx_new(0);
+    struct spng_ihdr ihdr;
+    size_t size;
+    int status = -1;
+    if (ctx != NULL
+        && spng_set_png_buffer(ctx, data, len) == 0
+        && spng_get_ihdr(ctx, &ihdr) == 0
+        && spng_decoded_image_size(ctx, fmt, &size) == 0) {
+      *w = (int) ihdr.width;
+      *h = (int) ihdr.height;
+      if (size > outSize) {
+        status = CHPL_IMAGE_ERR_TOO_SMALL;
+      } else if (spng_decode_image(ctx, out, size, fmt,
+                                   SPNG_DECODE_TRNS) == 0) {
+        status = CHPL_IMAGE_OK;
+      }
+    }
+    spng_ctx_free(ctx);
+    if (status >= 0) {
+      return status;
+    }
+  }
+#endif
+
+  int n;
+  unsigned char* pixels = stbi_load_from_memory(data, len, w, h, &n,
+                                                channels);
+  if (pixels == NULL) {
+    return CHPL_IMAGE_ERR_DECODE;
+  }
+  size_t size = (size_t) *w * *h * channels;
+  int status = CHPL_IMAGE_ERR_TOO_SMALL;
+  if (size <= outSize) {
+    memcpy(out, pixels, size);
+    status = CHPL_IMAGE_OK;
+  }
+  stbi_image_free(pixels);
+  return status;
+}
+
+typedef struct {
+  unsigned char* data;
+  size_t len;
+  size_t cap;
+} chpl_image_buffer_t;
+
+static void chpl_image_buffer_write(void* context, void* data, int size) {
+  chpl_image_buffer_t* b = (chpl_image_buffer_t*) context;
+  if (b->len + size > b->cap) {
+    size_t cap = (b->cap == 0) ? 4096 : 2 * b->cap;
+    while (cap < b->len + size) {
+      cap *= 2;
+    }
+    b->data = (unsigned char*) chpl_mem_realloc(b->data, cap, 0, 0, 0);
+    b->cap = cap;
+  }
+  memcpy(b->data + b->len, data, size);
+  b->len += size;
+}
+
+//
+// Encode w x h pixels of 'channels' 8-bit channels each as a PNG or a
+// JPEG (with 'quality' from 1 to 100).  The result is in a buffer
+// allocated with chpl_mem_alloc, which is stored in 'out' along with
+// its length in 'outLen'; the caller frees it.  Returns one of the
+// CHPL_IMAGE_ codes.
+//
+static int chpl_image_encode(const unsigned char* pixels, int w, int h,
+                             int channels, int format, int quality,
+                             unsigned char** out, size_t* outLen) {
+  *out = NULL;
+  *outLen = 0;
+
+#ifdef CHPL_IMAGE_USE_TURBOJPEG
+  if (format == CHPL_IMAGE_FORMAT_JPEG
+      && chpl_image_tjPixelFormat(channels) >= 0) {
+    int subsamp = (channels == 1) ? TJSAMP_GRAY : TJSAMP_444;
+    tjhandle tj = chpl_image_tjCompressor;
+    if (tj == NULL) {
+      tj = chpl_image_tjCompressor = tjInitCompress();
+    }
+    if (tj != NULL) {
+      // encode straight into our own buffer, which is large enough for
+      // any image of this size
+      unsigned long size = tjBufSize(w, h, subsamp);
+      unsigned char* buf = (unsigned char*) chpl_mem_alloc(size, 0, 0, 0);
+      if (tjCompress2(tj, pixels, w, 0, h, chpl_image_tjPixelFormat(channels),
+                      &buf, &size, subsamp, quality, TJFLAG_NOREALLOC) == 0) {
+        *out = buf;
+        *outLen = size;
+        return CHPL_IMAGE_OK;
+      }
+      chpl_mem_free(buf, 0, 0);
+    }
+  }
+#endif
+
+  chpl_image_buffer_t b = { NULL, 0, 0 };
+  int ok;
+  if (format == CHPL_IMAGE_FORMAT_JPEG) {
+    ok = stbi_write_jpg_to_func(chpl_image_buffer_write, &b, w, h, channels,
+                                pixels, quality);
+  } else {
+    ok = stbi_write_png_to_func(chpl_image_buffer_write, &b, w, h, channels,
+                                pixels, w * channels);
+  }
+  if (!ok) {
+    if (b.data != NULL) {
+      chpl_mem_free(b.data, 0, 0);
+    }
+    return CHPL_IMAGE_ERR_ENCODE;
+  }
+  *out = b.data;
+  *outLen = b.len;
+  return CHPL_IMAGE_OK;
+}
+
+//
+// Batches.  Each job is one image; the jobs are spread over tasks with
+// chpl_task_runPieces(), and each one's status is one of the
+// CHPL_IMAGE_ codes.  For decoding, 'out' is typically a slice of a
+// preallocated Chapel array, so that the pixels land where they will be
+// used.
+//
+typedef struct {
+  const unsigned char* data;
+  int len;
+  unsigned char* out;
+  size_t outSize;
+  int width;
+  int height;
+  int status;
+} chpl_image_decode_job_t;
+
+typedef struct {
+  const unsigned char* pixels;
+  int width;
+  int height;
+  unsigned char* out;
+  size_t outLen;
+  int status;
+} chpl_image_encode_job_t;
+
+typedef struct {
+  void* jobs;
+  int channels;
+  int format;
+  int quality;
+} chpl_image_batch_t;
+
+static void chpl_image_decode_piece(void* arg, int i) {
+  chpl_image_batch_t* b = (chpl_image_batch_t*) arg;
+  chpl_image_decode_job_t* j = &((chpl_image_decode_job_t*) b->jobs)[i];
+  j->status = chpl_image_decode_into(j->data, j->len, b->channels, j->out,
+                                     j->outSize, &j->width, &j->height);
+}
+
+static void chpl_image_encode_piece(void* arg, int i) {
+  chpl_image_batch_t* b = (chpl_image_batch_t*) arg;
+  chpl_image_encode_job_t* j = &((chpl_image_encode_job_t*) b->jobs)[i];
+  j->status = chpl_image_encode(j->pixels, j->width, j->height, b->channels,
+                                b->format, b->quality, &j->out, &j->outLen);
+}
+
+static inline
+void chpl_image_decode_batch(chpl_image_decode_job_t* jobs, int n,
+                             int channels) {
+  chpl_image_batch_t b = { jobs, channels, 0, 0 };
+  chpl_task_runPieces(n, chpl_image_decode_piece, &b);
+}
+
+static inline
+void chpl_image_encode_batch(chpl_image_encode_job_t* jobs, int n,
+                             int channels, int format, int quality) {
+  chpl_image_batch_t b = { jobs, channels, format, quality };
+  chpl_task_runPieces(n, chpl_image_encode_piece, &b);
+}
+
 #endif
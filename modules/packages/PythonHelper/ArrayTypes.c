@@ -219,7 +219,7 @@ chpl_ARRAY_TYPES(chpl_MAKE_LENGTH)
 // 3. Increment an internal counter for the number of exports.
 // 4. Set view->obj to exporter and increment view->obj.
 // 5. Return 0.
-#define chpl_MAKE_GET_BUFFER(DATATYPE, CHAPELDATATYPE, NAMESUFFIX, _0, _1, _2, SUPPORTSBUFFERS, FORMATSTRING) \
+#define chpl_MAKE_GET_BUFFER(DATATYPE, CHAPELDATATYPE, NAMESUFFIX, _0, _1, _2, SUPPORTSBUFFERS, FORMATSTRING, KIND) \
 static int Array##NAMESUFFIX##Object_bf_getbuffer(Array##NAMESUFFIX##Object* arr, Py_buffer* view, int flags) { \
   if (!SUPPORTSBUFFERS) { \
     PyErr_SetString(PyExc_BufferError, "This array does not support the buffer protocol"); \
@@ -271,7 +271,7 @@ static int Array##NAMESUFFIX##Object_bf_getbuffer(Array##NAMESUFFIX##Object* arr
 chpl_ARRAY_TYPES(chpl_MAKE_GET_BUFFER)
 #undef chpl_MAKE_GET_BUFFER
 
-#define chpl_MAKE_RELEASE_BUFFER(DATATYPE, CHAPELDATATYPE, NAMESUFFIX, _0, _1, _2, SUPPORTSBUFFERS, FORMATSTRING) \
+#define chpl_MAKE_RELEASE_BUFFER(DATATYPE, CHAPELDATATYPE, NAMESUFFIX, _0, _1, _2, SUPPORTSBUFFERS, FORMATSTRING, KIND) \
 static void Array##NAMESUFFIX##Object_bf_releasebuffer(Array##NAMESUFFIX##Object* arr, Py_buffer* view) { \
   arr->numExports--; \
   if ((intptr_t)view->internal & 0x1) { \
@@ -283,6 +283,110 @@ static void Array##NAMESUFFIX##Object_bf_releasebuffer(Array##NAMESUFFIX##Object
 chpl_ARRAY_TYPES(chpl_MAKE_RELEASE_BUFFER)
 #undef chpl_MAKE_RELEASE_BUFFER
 
+#if PY_BIG_ENDIAN
+#define chpl_NATIVE_BYTE_ORDER '>'
+#else
+#define chpl_NATIVE_BYTE_ORDER '<'
+#endif
+
+static PyObject* makeShapeTuple(Py_ssize_t ndim, Py_ssize_t* shape, Py_ssize_t size) {
+  PyObject* tup = PyTuple_New(ndim);
+  if (!tup) return NULL;
+  for (Py_ssize_t i = 0; i < ndim; i++) {
+    PyObject* dim = PyLong_FromSsize_t(shape ? shape[i] : size);
+    if (!dim) {
+      Py_CLEAR(tup);
+      return NULL;
+    }
+    PyTuple_SetItem(tup, i, dim); /* steals dim */
+  }
+  return tup;
+}
+
+#define chpl_MAKE_SHAPE(DATATYPE, CHAPELDATATYPE, NAMESUFFIX, ...) \
+static PyObject* Array##NAMESUFFIX##Object_get_shape(Array##NAMESUFFIX##Object* self, void* closure) { \
+  return makeShapeTuple(self->ndim, self->shape, self->size); \
+}
+chpl_ARRAY_TYPES(chpl_MAKE_SHAPE)
+#undef chpl_MAKE_SHAPE
+
+// https://numpy.org/doc/stable/reference/arrays.interface.html
+// The data is always C-contiguous, so 'strides' is left out. NumPy keeps a
+// reference to this object as the base of the arrays it makes from it.
+#define chpl_MAKE_ARRAY_INTERFACE(DATATYPE, CHAPELDATATYPE, NAMESUFFIX, _0, _1, _2, SUPPORTSBUFFERS, FORMATSTRING, KIND) \
+static PyObject* Array##NAMESUFFIX##Object_get_array_interface(Array##NAMESUFFIX##Object* self, void* closure) { \
+  if (!SUPPORTSBUFFERS) { \
+    PyErr_SetString(PyExc_AttributeError, "This array does not support __array_interface__"); \
+    return NULL; \
+  } \
+  char typestr[8]; \
+  snprintf(typestr, sizeof(typestr), "%c%c%d", \
+           sizeof(DATATYPE) == 1 ? '|' : chpl_NATIVE_BYTE_ORDER, \
+           KIND, (int)sizeof(DATATYPE)); \
+  PyObject* shape = makeShapeTuple(self->ndim, self->shape, self->size); \
+  if (!shape) return NULL; \
+  PyObject* ptr = PyLong_FromVoidPtr(self->data); \
+  if (!ptr) { \
+    Py_CLEAR(shape); \
+    return NULL; \
+  } \
+  /* data is (pointer, read-only flag) */ \
+  return Py_BuildValue("{s:N,s:s,s:(N,O),s:i}", \
+                       "shape", shape, \
+                       "typestr", typestr, \
+                       "data", ptr, Py_False, \
+                       "version", 3); \
+}
+chpl_ARRAY_TYPES(chpl_MAKE_ARRAY_INTERFACE)
+#undef chpl_MAKE_ARRAY_INTERFACE
+
+// Does a buffer format string describe a single native item of the given
+// kind? The size is checked separately against the buffer's itemsize, so
+// both native ('@') and standard ('=', '<', '>', '!') sizes are accepted.
+static chpl_bool bufferFormatMatches(const char* format, char kind) {
+  if (!format) format = "B"; /* NULL means unsigned bytes */
+  if (*format == '@' || *format == '=' || *format == chpl_NATIVE_BYTE_ORDER) {
+    format++;
+  } else if (*format == '<' || *format == '>' || *format == '!') {
+    return false; /* not in native byte order */
+  }
+  if (format[0] == '\0' || format[1] != '\0') return false;
+  switch (format[0]) {
+    case 'b': case 'h': case 'i': case 'l': case 'q': case 'n':
+      return kind == 'i';
+    case 'B': case 'H': case 'I': case 'L': case 'Q': case 'N':
+      return kind == 'u';
+    case 'e': case 'f': case 'd':
+      return kind == 'f';
+    case '?':
+      return kind == 'b';
+    default:
+      return false;
+  }
+}
+
+#define chpl_MAKE_GET_ARRAY_BUFFER(DATATYPE, CHAPELDATATYPE, NAMESUFFIX, _0, _1, _2, SUPPORTSBUFFERS, FORMATSTRING, KIND) \
+chpl_bool getArrayBuffer##NAMESUFFIX(PyObject* obj, Py_buffer* view, chpl_bool writable) { \
+  if (!SUPPORTSBUFFERS) { \
+    PyErr_SetString(PyExc_BufferError, "Cannot get a buffer of " CHAPELDATATYPE); \
+    return false; \
+  } \
+  int flags = PyBUF_C_CONTIGUOUS | PyBUF_FORMAT; \
+  if (writable) flags |= PyBUF_WRITABLE; \
+  if (PyObject_GetBuffer(obj, view, flags) < 0) return false; \
+  if (view->itemsize != sizeof(DATATYPE) || \
+      !bufferFormatMatches(view->format, KIND)) { \
+    PyErr_Format(PyExc_TypeError, \
+                 "buffer with format '%s' and item size %zd cannot be used as " CHAPELDATATYPE, \
+                 view->format ? view->format : "B", view->itemsize); \
+    PyBuffer_Release(view); \
+    return false; \
+  } \
+  return true; \
+}
+chpl_ARRAY_TYPES(chpl_MAKE_GET_ARRAY_BUFFER)
+#undef chpl_MAKE_GET_ARRAY_BUFFER
+
 
 #if PY_VERSION_HEX >= 0x030a0000 /* Python 3.10 */
 #define chpl_Py_TPFLAGS_SEQUENCE Py_TPFLAGS_SEQUENCE
@@ -303,7 +407,12 @@ chpl_ARRAY_TYPES(chpl_MAKE_RELEASE_BUFFER)
       {"ndim", Py_T_PYSSIZET, offsetof(Array##NAMESUFFIX##Object, ndim), Py_READONLY, PyDoc_STR("number of dimensions in the array")}, \
       {NULL} /* Sentinel */\
     }; \
-    /* TODO: expose shape as a `PyGetSetDef` */ \
+    /* the descriptors point into this, so it must outlive the type */ \
+    static PyGetSetDef getset[] = { \
+      {"shape", (getter) Array##NAMESUFFIX##Object_get_shape, NULL, PyDoc_STR("shape of the array"), NULL}, \
+      {"__array_interface__", (getter) Array##NAMESUFFIX##Object_get_array_interface, NULL, PyDoc_STR("NumPy array interface, exposing the data without copying"), NULL}, \
+      {NULL} /* Sentinel */ \
+    }; \
     PyType_Slot slots[] = { \
       {Py_tp_init, (void*) ArrayGenericObject_init}, \
       {Py_tp_dealloc, (void*) Array##NAMESUFFIX##Object_dealloc}, \
@@ -317,6 +426,7 @@ chpl_ARRAY_TYPES(chpl_MAKE_RELEASE_BUFFER)
       {Py_mp_length, (void*) Array##NAMESUFFIX##Object_length}, \
       {Py_tp_methods, (void*) methods}, \
       {Py_tp_members, (void*) members}, \
+      {Py_tp_getset, (void*) getset}, \
       {Py_bf_getbuffer, (void*) Array##NAMESUFFIX##Object_bf_getbuffer}, \
       {Py_bf_releasebuffer, (void*) Array##NAMESUFFIX##Object_bf_releasebuffer}, \
       {0, NULL} \
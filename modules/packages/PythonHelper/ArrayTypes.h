@@ -37,20 +37,21 @@
 // producing PyObject function
 // supports buffer protocol
 // format string
+// array interface type kind
 //
 #define chpl_ARRAY_TYPES(V) \
-  V(int64_t, "int(64)", I64, PyLong_Check, PyLong_AsLongLong, PyLong_FromLongLong, true, "q") \
-  V(uint64_t, "uint(64)", U64, PyLong_Check, PyLong_AsUnsignedLongLong, PyLong_FromUnsignedLongLong, true, "Q") \
-  V(int32_t, "int(32)", I32, PyLong_Check, PyLong_AsLong, PyLong_FromLong, true, "l") \
-  V(uint32_t, "uint(32)", U32, PyLong_Check, PyLong_AsUnsignedLong, PyLong_FromUnsignedLong, true, "L") \
-  V(int16_t, "int(16)", I16, PyLong_Check, PyLong_AsLong, PyLong_FromLong, true, "h") \
-  V(uint16_t, "uint(16)", U16, PyLong_Check, PyLong_AsUnsignedLong, PyLong_FromUnsignedLong, true, "H") \
-  V(int8_t, "int(8)", I8, PyLong_Check, PyLong_AsLong, PyLong_FromLong, true, "b") \
-  V(uint8_t, "uint(8)", U8, PyLong_Check, PyLong_AsUnsignedLong, PyLong_FromUnsignedLong, true, "B") \
-  V(_real64, "real(64)", R64, PyFloat_Check, PyFloat_AsDouble, PyFloat_FromDouble, true, "d") \
-  V(_real32, "real(32)", R32, PyFloat_Check, PyFloat_AsDouble, PyFloat_FromDouble, true, "f") \
-  V(chpl_bool, "bool", Bool, PyBool_Check, PyObject_IsTrue, PyBool_FromLong, true, "?") \
-  V(PyObject*, "array", A, (intptr_t), (PyObject*), (PyObject*), false, "P")
+  V(int64_t, "int(64)", I64, PyLong_Check, PyLong_AsLongLong, PyLong_FromLongLong, true, "q", 'i') \
+  V(uint64_t, "uint(64)", U64, PyLong_Check, PyLong_AsUnsignedLongLong, PyLong_FromUnsignedLongLong, true, "Q", 'u') \
+  V(int32_t, "int(32)", I32, PyLong_Check, PyLong_AsLong, PyLong_FromLong, true, "i", 'i') \
+  V(uint32_t, "uint(32)", U32, PyLong_Check, PyLong_AsUnsignedLong, PyLong_FromUnsignedLong, true, "I", 'u') \
+  V(int16_t, "int(16)", I16, PyLong_Check, PyLong_AsLong, PyLong_FromLong, true, "h", 'i') \
+  V(uint16_t, "uint(16)", U16, PyLong_Check, PyLong_AsUnsignedLong, PyLong_FromUnsignedLong, true, "H", 'u') \
+  V(int8_t, "int(8)", I8, PyLong_Check, PyLong_AsLong, PyLong_FromLong, true, "b", 'i') \
+  V(uint8_t, "uint(8)", U8, PyLong_Check, PyLong_AsUnsignedLong, PyLong_FromUnsignedLong, true, "B", 'u') \
+  V(_real64, "real(64)", R64, PyFloat_Check, PyFloat_AsDouble, PyFloat_FromDouble, true, "d", 'f') \
+  V(_real32, "real(32)", R32, PyFloat_Check, PyFloat_AsDouble, PyFloat_FromDouble, true, "f", 'f') \
+  V(chpl_bool, "bool", Bool, PyBool_Check, PyObject_IsTrue, PyBool_FromLong, true, "?", 'b') \
+  V(PyObject*, "array", A, (intptr_t), (PyObject*), (PyObject*), false, "P", 'O')
 
 
 #define chpl_MAKE_ARRAY_TYPES(DATATYPE, CHAPELDATATYPE, NAMESUFFIX, ...) \
@@ -70,4 +71,17 @@ chpl_bool createArrayTypes(void);
 chpl_ARRAY_TYPES(chpl_CREATE_ARRAY)
 #undef chpl_CREATE_ARRAY
 
+// Get a C-contiguous buffer of DATATYPE from any object that supports the
+// buffer protocol (a NumPy array, a memoryview, an Array object, ...), so it
+// can be wrapped as a Chapel array without copying. On success, 'view->buf'
+// holds 'view->len / sizeof(DATATYPE)' elements, and the buffer must be
+// released with PyBuffer_Release once the wrapping array is no longer used.
+// On failure, a Python exception is set and false is returned.
+#define chpl_GET_ARRAY_BUFFER(DATATYPE, CHAPELDATATYPE, NAMESUFFIX, ...) \
+  chpl_bool getArrayBuffer##NAMESUFFIX(PyObject* obj, \
+                                       Py_buffer* view, \
+                                       chpl_bool writable);
+chpl_ARRAY_TYPES(chpl_GET_ARRAY_BUFFER)
+#undef chpl_GET_ARRAY_BUFFER
+
 #endif
@@ -20,6 +20,8 @@
 
 #include "ZMQHelper/zmq_helper.h"
 
+#include <errno.h>
+
 // Used when the option specified for zmq_getsockopt would modify a char*,
 // due to c_strings in Chapel being const char*.
 int zmq_getsockopt_string_helper(void* s, int option, const char** res) {
@@ -38,3 +40,100 @@ int zmq_getsockopt_int_helper(void* s, int option, int* res) {
   int err = zmq_getsockopt(s, option, res, &intsize);
   return err;
 }
+
+// zmq calls this, possibly from one of its I/O threads, once it is done
+// with the data of a message that was sent without copying.
+static void zmq_chpl_free_fn(void* data, void* hint) {
+  chpl_free(data);
+}
+
+// Send 'size' bytes at 'data' without copying them.  'data' must have been
+// allocated by the Chapel allocator, and ownership of it passes to zmq,
+// which frees it when the message has been sent, or right away if the send
+// fails.
+int zmq_send_owned_helper(void* s, void* data, size_t size, int flags) {
+  zmq_msg_t msg;
+  if (zmq_msg_init_data(&msg, data, size, zmq_chpl_free_fn, NULL) != 0) {
+    chpl_free(data);
+    return -1;
+  }
+  int nbytes = zmq_msg_send(&msg, s, flags);
+  if (nbytes < 0) {
+    int err = zmq_errno();
+    zmq_msg_close(&msg);
+    errno = err;
+  }
+  return nbytes;
+}
+
+// Receive a message and return a pointer to its data, so that it can back a
+// Chapel bytes without being copied.  The data stays valid until the message
+// is passed to zmq_msg_release_helper.  'more' is set if more parts of a
+// multipart message follow.
+int zmq_msg_recv_helper(void* s, int flags, zmq_msg_t** msgOut,
+                        const char** data, size_t* size, int* more) {
+  zmq_msg_t* msg = (zmq_msg_t*)chpl_malloc(sizeof(zmq_msg_t));
+  zmq_msg_init(msg);
+  int nbytes = zmq_msg_recv(msg, s, flags);
+  if (nbytes < 0) {
+    int err = zmq_errno();
+    zmq_msg_close(msg);
+    chpl_free(msg);
+    errno = err;
+    *msgOut = NULL;
+    return -1;
+  }
+  *msgOut = msg;
+  *data = (const char*)zmq_msg_data(msg);
+  *size = zmq_msg_size(msg);
+  *more = zmq_msg_more(msg);
+  return nbytes;
+}
+
+void zmq_msg_release_helper(zmq_msg_t* msg) {
+  if (msg == NULL) return;
+  zmq_msg_close(msg);
+  chpl_free(msg);
+}
+
+// Send 'n' buffers as the parts of one multipart message, with one call
+// from Chapel.  If 'owned' is set, the buffers are sent without copying and
+// ownership of all of them passes to zmq, as for zmq_send_owned_helper,
+// whether or not the send succeeds.  Returns the number of parts sent,
+// which is less than 'n' on an error.
+int zmq_send_multipart_helper(void* s, void** datas, size_t* sizes, int n,
+                              int flags, int owned) {
+  int i;
+  for (i = 0; i < n; i++) {
+    int partFlags = (i < n - 1) ? (flags | ZMQ_SNDMORE) : flags;
+    int nbytes = owned ? zmq_send_owned_helper(s, datas[i], sizes[i], partFlags)
+                       : zmq_send(s, datas[i], sizes[i], partFlags);
+    if (nbytes < 0) break;
+  }
+  if (owned) {
+    // the part that failed was freed by zmq_send_owned_helper
+    for (int j = i + 1; j < n; j++) chpl_free(datas[j]);
+  }
+  return i;
+}
+
+// Receive the parts of a multipart message into 'msgs', up to 'maxParts'
+// of them, with one call from Chapel.  The messages must be initialized and
+// are left for the caller to close.  Returns the number received, or -1 if
+// the first receive fails.  If the message has more than 'maxParts' parts,
+// zmq_msg_more() of the last one received is still set, and the rest can
+// be received with another call.
+int zmq_recv_multipart_helper(void* s, zmq_msg_t* msgs, int maxParts,
+                              int flags) {
+  int n = 0;
+  while (n < maxParts) {
+    if (zmq_msg_recv(&msgs[n], s, flags) < 0) {
+      return n == 0 ? -1 : n;
+    }
+    n++;
+    if (!zmq_msg_more(&msgs[n-1])) break;
+    // once the first part arrived, the others are already here
+    flags &= ~ZMQ_DONTWAIT;
+  }
+  return n;
+}
@@ -30,4 +30,13 @@
 int zmq_getsockopt_string_helper(void* s, int option, const char** res);
 int zmq_getsockopt_int_helper(void* s, int option, int* res);
 
+int zmq_send_owned_helper(void* s, void* data, size_t size, int flags);
+int zmq_msg_recv_helper(void* s, int flags, zmq_msg_t** msgOut,
+                        const char** data, size_t* size, int* more);
+void zmq_msg_release_helper(zmq_msg_t* msg);
+int zmq_send_multipart_helper(void* s, void** datas, size_t* sizes, int n,
+                              int flags, int owned);
+int zmq_recv_multipart_helper(void* s, zmq_msg_t* msgs, int maxParts,
+                              int flags);
+
 #endif
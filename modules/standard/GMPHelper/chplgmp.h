@@ -28,18 +28,87 @@
 
 #include "chpl-comm-compiler-macros.h"
 #include "chpl-comm.h"
+#include "chpl-tasks.h"
+#include "chpl-thread-local-storage.h"
+#include "chplmemtrack.h"
+
+//
+// Limb buffers of up to CHPL_GMP_POOL_MAX_SIZE bytes are rounded up to a
+// power of two and, when freed, kept on a list per size for the thread
+// that freed them, up to CHPL_GMP_POOL_DEPTH of each.  BigInteger-heavy
+// code frees and reallocates temporaries of the same few sizes all the
+// time, so most allocations are then a pop from a list.  The pooled
+// blocks are still chpl_mem allocations, so any thread can free or
+// reallocate them.  The pool is bypassed when memory is being tracked,
+// so that the tracking stays accurate.
+//
+#define CHPL_GMP_POOL_MIN_SHIFT 5         // 32 bytes
+#define CHPL_GMP_POOL_NUM_SIZES 8         // up to 4 KiB
+#define CHPL_GMP_POOL_MAX_SIZE \
+  ((size_t) 1 << (CHPL_GMP_POOL_MIN_SHIFT + CHPL_GMP_POOL_NUM_SIZES - 1))
+#define CHPL_GMP_POOL_DEPTH 16
+
+#ifdef CHPL_TLS
+typedef struct {
+  int count[CHPL_GMP_POOL_NUM_SIZES];
+  void* blocks[CHPL_GMP_POOL_NUM_SIZES][CHPL_GMP_POOL_DEPTH];
+} chpl_gmp_pool_t;
+
+static CHPL_TLS chpl_gmp_pool_t chpl_gmp_pool;
+#endif
+
+// The pool size index for a request of 'size' bytes, or -1 if it's
+// too large for the pool.
+static inline int chpl_gmp_pool_index(size_t size) {
+  int i = 0;
+  if (size > CHPL_GMP_POOL_MAX_SIZE || chpl_memTrack) {
+    return -1;
+  }
+  while (((size_t) 1 << (CHPL_GMP_POOL_MIN_SHIFT + i)) < size) {
+    i++;
+  }
+  return i;
+}
+
+static inline size_t chpl_gmp_pool_size(int i) {
+  return (size_t) 1 << (CHPL_GMP_POOL_MIN_SHIFT + i);
+}
 
 // Need this workaround for some compilers until the Chapel
 // compiler moves away from representing all C fn pointers as void*
 static void* chpl_gmp_alloc(size_t size) {
-  return chpl_mem_alloc(size, CHPL_RT_MD_GMP, __LINE__, 0);
+  int i = chpl_gmp_pool_index(size);
+  if (i < 0) {
+    return chpl_mem_alloc(size, CHPL_RT_MD_GMP, __LINE__, 0);
+  }
+#ifdef CHPL_TLS
+  if (chpl_gmp_pool.count[i] > 0) {
+    return chpl_gmp_pool.blocks[i][--chpl_gmp_pool.count[i]];
+  }
+#endif
+  return chpl_mem_alloc(chpl_gmp_pool_size(i), CHPL_RT_MD_GMP, __LINE__, 0);
 }
 
 static void* chpl_gmp_realloc(void* ptr, size_t old_size, size_t new_size) {
-  return chpl_mem_realloc(ptr, new_size, CHPL_RT_MD_GMP, __LINE__, 0);
+  int oldIdx = chpl_gmp_pool_index(old_size);
+  int newIdx = chpl_gmp_pool_index(new_size);
+  if (oldIdx >= 0 && oldIdx == newIdx) {
+    // it already has room
+    return ptr;
+  }
+  return chpl_mem_realloc(ptr,
+                          (newIdx < 0) ? new_size : chpl_gmp_pool_size(newIdx),
+                          CHPL_RT_MD_GMP, __LINE__, 0);
 }
 
 static void chpl_gmp_free(void* ptr, size_t old_size) {
+#ifdef CHPL_TLS
+  int i = chpl_gmp_pool_index(old_size);
+  if (i >= 0 && chpl_gmp_pool.count[i] < CHPL_GMP_POOL_DEPTH) {
+    chpl_gmp_pool.blocks[i][chpl_gmp_pool.count[i]++] = ptr;
+    return;
+  }
+#endif
   return chpl_mem_free(ptr, __LINE__, 0);
 }
 
@@ -138,5 +207,221 @@ static inline int chpl_mpz_even_p(const mpz_t op) {
   return mpz_even_p(op);
 }
 
+//
+// Task-parallel kernels.  These spread their work over tasks with
+// chpl_task_runPieces().
+//
+static inline int chpl_gmp_par_width(void) {
+  return (int) chpl_task_getMaxPar();
+}
+
+// Operands with fewer limbs than this are multiplied with one mpz_mul.
+#define CHPL_GMP_PAR_MUL_MIN_LIMBS 4096
+
+typedef struct {
+  const mp_limb_t* limbs;     // of |a|
+  size_t size;                // of |a|, in limbs
+  size_t pieceSize;           // in limbs
+  const __mpz_struct* b;
+  mpz_t* partial;
+} chpl_gmp_mul_par_t;
+
+static void chpl_gmp_mul_piece(void* arg, int i) {
+  chpl_gmp_mul_par_t* m = (chpl_gmp_mul_par_t*) arg;
+  size_t lo = i * m->pieceSize;
+  size_t n = m->size - lo < m->pieceSize ? m->size - lo : m->pieceSize;
+  mpz_t piece;
+  mpz_roinit_n(piece, m->limbs + lo, n);
+  mpz_mul(m->partial[i], piece, m->b);
+}
+
+//
+// r = a * b.  When the larger operand is big enough, it is split into
+// pieces that are multiplied by the other operand in parallel, and the
+// shifted partial products are then added up.
+//
+static void chpl_gmp_mpz_mul_par(mpz_t r, const mpz_t a, const mpz_t b) {
+  if (mpz_size(a) < mpz_size(b)) {
+    const __mpz_struct* t = a;
+    a = b;
+    b = t;
+  }
+
+  size_t size = mpz_size(a);
+  int numPieces = chpl_gmp_par_width();
+  if (size / CHPL_GMP_PAR_MUL_MIN_LIMBS < (size_t) numPieces) {
+    numPieces = (int) (size / CHPL_GMP_PAR_MUL_MIN_LIMBS);
+  }
+  if (numPieces < 2 || mpz_size(b) < CHPL_GMP_PAR_MUL_MIN_LIMBS) {
+    mpz_mul(r, a, b);
+    return;
+  }
+
+  chpl_gmp_mul_par_t m;
+  m.limbs = mpz_limbs_read(a);
+  m.size = size;
+  m.pieceSize = (size + numPieces - 1) / numPieces;
+  m.b = b;
+  m.partial = (mpz_t*) chpl_mem_allocMany(numPieces, sizeof(mpz_t),
+                                          CHPL_RT_MD_GMP, __LINE__, 0);
+  for (int i = 0; i < numPieces; i++) {
+    mpz_init(m.partial[i]);
+  }
+
+  chpl_task_runPieces(numPieces, chpl_gmp_mul_piece, &m);
+
+  // r may be a or b, so build the result on the side
+  mpz_t sum;
+  mpz_init(sum);
+  for (int i = numPieces - 1; i >= 0; i--) {
+    mpz_mul_2exp(sum, sum, m.pieceSize * GMP_NUMB_BITS);
+    mpz_add(sum, sum, m.partial[i]);
+    mpz_clear(m.partial[i]);
+  }
+  chpl_mem_free(m.partial, __LINE__, 0);
+  if (mpz_sgn(a) < 0) {
+    mpz_neg(sum, sum);
+  }
+  mpz_swap(r, sum);
+  mpz_clear(sum);
+}
+
+typedef struct {
+  mpz_t* from;
+  mpz_t* to;
+  int64_t n;
+} chpl_gmp_prod_level_t;
+
+static void chpl_gmp_prod_pair(void* arg, int i) {
+  chpl_gmp_prod_level_t* l = (chpl_gmp_prod_level_t*) arg;
+  if (2 * (int64_t) i + 1 < l->n) {
+    mpz_mul(l->to[i], l->from[2 * i], l->from[2 * i + 1]);
+  } else {
+    mpz_set(l->to[i], l->from[2 * i]);
+  }
+}
+
+//
+// r = xs[0] * xs[1] * ... * xs[n-1], as a product tree.  The products
+// on each level are done in parallel, and once a level has a single
+// product left, that one uses chpl_gmp_mpz_mul_par().
+//
+static void chpl_gmp_mpz_product(mpz_t r, const mpz_t* xs, int64_t n) {
+  if (n <= 0) {
+    mpz_set_ui(r, 1);
+    return;
+  }
+
+  int64_t cap = (n + 1) / 2;
+  mpz_t* bufs[2];
+  for (int k = 0; k < 2; k++) {
+    bufs[k] = (mpz_t*) chpl_mem_allocMany(cap, sizeof(mpz_t),
+                                          CHPL_RT_MD_GMP, __LINE__, 0);
+    for (int64_t i = 0; i < cap; i++) {
+      mpz_init(bufs[k][i]);
+    }
+  }
+
+  chpl_gmp_prod_level_t l = { (mpz_t*) xs, bufs[0], n };
+  int cur = 0;
+  while (l.n > 1) {
+    l.to = bufs[cur];
+    if (l.n == 2) {
+      chpl_gmp_mpz_mul_par(l.to[0], l.from[0], l.from[1]);
+    } else {
+      chpl_task_runPieces((int) ((l.n + 1) / 2), chpl_gmp_prod_pair, &l);
+    }
+    l.from = l.to;
+    l.n = (l.n + 1) / 2;
+    cur = 1 - cur;
+  }
+
+  if (n == 1) {
+    mpz_set(r, xs[0]);
+  } else {
+    mpz_swap(r, l.from[0]);
+  }
+  for (int k = 0; k < 2; k++) {
+    for (int64_t i = 0; i < cap; i++) {
+      mpz_clear(bufs[k][i]);
+    }
+    chpl_mem_free(bufs[k], __LINE__, 0);
+  }
+}
+
+// r = lo * (lo+1) * ... * hi, split in halves until the pieces fit in a
+// limb, which makes the operands of each multiply about the same size.
+static void chpl_gmp_mpz_prod_range_ui(mpz_t r, unsigned long lo,
+                                       unsigned long hi) {
+  if (lo > hi) {
+    mpz_set_ui(r, 1);
+    return;
+  }
+  if (hi - lo < 8) {
+    mpz_set_ui(r, lo);
+    for (unsigned long k = lo + 1; k <= hi; k++) {
+      mpz_mul_ui(r, r, k);
+    }
+    return;
+  }
+  unsigned long mid = lo + (hi - lo) / 2;
+  mpz_t right;
+  mpz_init(right);
+  chpl_gmp_mpz_prod_range_ui(r, lo, mid);
+  chpl_gmp_mpz_prod_range_ui(right, mid + 1, hi);
+  mpz_mul(r, r, right);
+  mpz_clear(right);
+}
+
+// Below this, or with fewer than this many tasks, mpz_fac_ui() is used,
+// since its prime-swing algorithm beats a plain product on one core.
+#define CHPL_GMP_PAR_FAC_MIN_N 100000
+#define CHPL_GMP_PAR_FAC_MIN_TASKS 4
+
+typedef struct {
+  unsigned long n;
+  int numChunks;
+  mpz_t* chunks;
+} chpl_gmp_fac_par_t;
+
+static void chpl_gmp_fac_chunk(void* arg, int i) {
+  chpl_gmp_fac_par_t* f = (chpl_gmp_fac_par_t*) arg;
+  // the later ranges have bigger products, but with several chunks per
+  // task the claiming in chpl_task_runPieces() evens the load out
+  unsigned long per = f->n / f->numChunks;
+  unsigned long lo = 1 + i * per;
+  unsigned long hi = (i == f->numChunks - 1) ? f->n : lo + per - 1;
+  chpl_gmp_mpz_prod_range_ui(f->chunks[i], lo, hi);
+}
+
+//
+// r = n!, computed as products of ranges of 1..n in parallel, which are
+// then multiplied together with chpl_gmp_mpz_product().
+//
+static void chpl_gmp_mpz_fac_ui_par(mpz_t r, unsigned long n) {
+  int width = chpl_gmp_par_width();
+  if (n < CHPL_GMP_PAR_FAC_MIN_N || width < CHPL_GMP_PAR_FAC_MIN_TASKS) {
+    mpz_fac_ui(r, n);
+    return;
+  }
+
+  chpl_gmp_fac_par_t f;
+  f.n = n;
+  f.numChunks = 4 * width;
+  f.chunks = (mpz_t*) chpl_mem_allocMany(f.numChunks, sizeof(mpz_t),
+                                         CHPL_RT_MD_GMP, __LINE__, 0);
+  for (int i = 0; i < f.numChunks; i++) {
+    mpz_init(f.chunks[i]);
+  }
+
+  chpl_task_runPieces(f.numChunks, chpl_gmp_fac_chunk, &f);
+  chpl_gmp_mpz_product(r, (const mpz_t*) f.chunks, f.numChunks);
+
+  for (int i = 0; i < f.numChunks; i++) {
+    mpz_clear(f.chunks[i]);
+  }
+  chpl_mem_free(f.chunks, __LINE__, 0);
+}
+
 
 #endif
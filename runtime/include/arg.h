@@ -42,6 +42,8 @@ int32_t getArgNumLocalesPerNode(void);
 int32_t chpl_baseUniqueLocaleID(int32_t r);
 int _runInGDB(void);
 int _runInLLDB(void);
+int chpl_topoReportRequested(void);
+int chpl_profileRequested(void);
 int chpl_specify_locales_error(void);
 
 //
@@ -24,6 +24,7 @@
 #include "chpltypes.h"
 #include "chpl-comp-detect-macros.h"
 #include "chpl-tasks.h"
+#include "chpl-backoff.h"
 
 // g++ 4.8 and 4.9 appear to support standard atomics, but have errors
 // in their <atomic> header.  Also, gcc 4.8 is missing <stdatomic.h>.
@@ -290,8 +291,10 @@ static inline chpl_bool atomic_try_lock_spinlock_t(chpl_atomic_spinlock_t* lock)
 }
 
 static inline void atomic_lock_spinlock_t(chpl_atomic_spinlock_t* lock) {
+  chpl_backoff_t backoff;
+  chpl_backoff_init(&backoff);
   while(!atomic_try_lock_spinlock_t(lock)) {
-    chpl_task_yield();
+    chpl_backoff(&backoff);
   }
 }
 
@@ -299,6 +302,16 @@ static inline void atomic_unlock_spinlock_t(chpl_atomic_spinlock_t* lock) {
   atomic_store_explicit(lock, false, chpl_memory_order_release);
 }
 
+// A spinlock on a cache line of its own, for locks that would otherwise
+// share one with each other (in an array) or with data read often.  An
+// array of these on the heap has to be allocated with chpl_mem_memalign()
+// to get that alignment.
+typedef struct {
+  chpl_atomic_spinlock_t lock;
+  char pad[CHPL_CACHE_LINE_SIZE - sizeof(chpl_atomic_spinlock_t)];
+} __attribute__((aligned(CHPL_CACHE_LINE_SIZE)))
+  chpl_atomic_padded_spinlock_t;
+
 #ifdef __cplusplus
 }
 #endif
@@ -23,6 +23,7 @@
 
 #include "chpltypes.h"
 #include "chpl-tasks.h"
+#include "chpl-backoff.h"
 #include <pthread.h>
 
 // Locks based atomic implementation. Note that we use pthread mutexes instead
@@ -326,8 +327,10 @@ static inline chpl_bool atomic_try_lock_spinlock_t(chpl_atomic_spinlock_t* lock)
 }
 
 static inline void atomic_lock_spinlock_t(chpl_atomic_spinlock_t* lock) {
+  chpl_backoff_t backoff;
+  chpl_backoff_init(&backoff);
   while(!atomic_try_lock_spinlock_t(lock)) {
-    chpl_task_yield();
+    chpl_backoff(&backoff);
   }
 }
 
@@ -335,6 +338,16 @@ static inline void atomic_unlock_spinlock_t(chpl_atomic_spinlock_t* lock) {
   pthread_spin_unlock(lock);
 }
 
+// A spinlock on a cache line of its own, for locks that would otherwise
+// share one with each other (in an array) or with data read often.  An
+// array of these on the heap has to be allocated with chpl_mem_memalign()
+// to get that alignment.
+typedef struct {
+  chpl_atomic_spinlock_t lock;
+  char pad[CHPL_CACHE_LINE_SIZE - sizeof(chpl_atomic_spinlock_t)];
+} __attribute__((aligned(CHPL_CACHE_LINE_SIZE)))
+  chpl_atomic_padded_spinlock_t;
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,86 @@
+/*
+ * Copyright 2020-2026 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _chpl_backoff_h_
+#define _chpl_backoff_h_
+
+#include <stdint.h>
+
+#include "chpl-tasks.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Cache line size to pad to, to keep contended data from sharing a line
+// with other data.
+#if defined(__powerpc64__)
+#define CHPL_CACHE_LINE_SIZE 128
+#else
+#define CHPL_CACHE_LINE_SIZE 64
+#endif
+
+// Tell the processor we're in a spin-wait loop, so it can save power and
+// give its sibling hardware thread more of the core.
+static inline void chpl_cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  __asm__ __volatile__("pause");
+#elif defined(__aarch64__)
+  __asm__ __volatile__("yield");
+#elif defined(__powerpc64__)
+  __asm__ __volatile__("or 27,27,27");
+#else
+  (void)0;
+#endif
+}
+
+//
+// Exponential backoff for spin-wait loops, such as taking a spinlock:
+// each chpl_backoff() waits twice as many pauses as the one before, so
+// that waiters stop hammering a contended cache line.  Past a limit it
+// yields the task instead, since the holder may be another task on the
+// same thread.
+//
+#define CHPL_BACKOFF_MAX_SPINS 64
+
+typedef struct {
+  uint32_t spins;
+} chpl_backoff_t;
+
+static inline void chpl_backoff_init(chpl_backoff_t* b) {
+  b->spins = 1;
+}
+
+static inline void chpl_backoff(chpl_backoff_t* b) {
+  if (b->spins <= CHPL_BACKOFF_MAX_SPINS) {
+    for (uint32_t i = 0; i < b->spins; i++) {
+      chpl_cpu_relax();
+    }
+    b->spins *= 2;
+  } else {
+    chpl_task_yield();
+  }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _chpl_backoff_h_
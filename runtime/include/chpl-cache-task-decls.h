@@ -28,6 +28,7 @@ extern "C" {
 // This is the type of the task private data used by the cache
 typedef struct {
   int64_t last_acquire; // cache acquire barrier sets this
+  int skip_shared_cache; // remote writes set this, release barrier clears it
 } chpl_cache_taskPrvData_t;
 
 #ifdef __cplusplus
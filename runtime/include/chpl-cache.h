@@ -108,6 +108,13 @@ void chpl_cache_comm_get(void *addr, c_nodeid_t node, void* raddr,
                          size_t size, int32_t commID, int ln, int32_t fn);
 void chpl_cache_comm_prefetch(c_nodeid_t node, void* raddr,
                               size_t size, int32_t commID, int ln, int32_t fn);
+// Prefetch n remote addresses, all on 'node', each for 'size' bytes.
+// This starts the GETs without waiting for any of them. Callers with
+// addresses on several locales should group them by locale and call
+// this once per group.
+void chpl_cache_comm_prefetch_many(c_nodeid_t node, int32_t n,
+                                   void* const* raddrs, size_t size,
+                                   int32_t commID, int ln, int32_t fn);
 void  chpl_cache_comm_get_strd(
                    void *addr, void *dststr, c_nodeid_t node, void *raddr,
                    void *srcstr, void *count, int32_t strlevels,
@@ -132,6 +139,14 @@ int chpl_cache_pagesize(void);
 void chpl_cache_print(void);
 void chpl_cache_assert_released(void);
 void chpl_cache_print_stats(void);
+// Prints the per-call-site report if CHPL_RT_CACHE_SITE_STATS is set.
+void chpl_cache_print_site_stats(void);
+// Writes out any CHPL_RT_CACHE_TRACE records that are still buffered.
+void chpl_cache_flush_traces(void);
+// Runs a CHPL_RT_CACHE_TRACE file through the cache without communicating
+// and prints the resulting hits, misses, and bytes moved. Only call this
+// while no other tasks on this locale are using the cache.
+int chpl_cache_replay_trace(const char* path);
 // just stores 0s in the cache; here to exercise the data structures
 // returns 1 if the data was cached
 int chpl_cache_mock_get(c_nodeid_t node, uint64_t raddr, size_t size);
@@ -111,6 +111,29 @@ void chpl_gen_comm_prefetch(c_nodeid_t node, void* raddr,
   }
 }
 
+// Prefetch a batch of remote addresses on one locale, e.g. the
+// elements that a gather loop will read.
+static inline
+void chpl_gen_comm_prefetch_many(c_nodeid_t node, int32_t n,
+                                 void* const* raddrs, size_t size,
+                                 int32_t commID, int ln, int32_t fn)
+{
+  int32_t i;
+
+  if (chpl_nodeID == node) {
+    for( i = 0; i < n; i++ ) {
+      chpl_prefetch((unsigned char*)raddrs[i]);
+    }
+#ifdef HAS_CHPL_CACHE_FNS
+  } else if( chpl_cache_enabled() ) {
+    chpl_cache_comm_prefetch_many(node, n, raddrs, size, commID, ln, fn);
+#endif
+  } else {
+    // Can't do anything if we don't have a remote data cache
+    // and the data is remote.
+  }
+}
+
 
 static ___always_inline
 void chpl_gen_comm_put(void* addr, c_nodeid_t node, void* raddr,
@@ -23,6 +23,7 @@
 
 #include <stdarg.h>
 #include <stdio.h>
+#include <time.h>
 
 #include "chpl-atomics.h"
 #include "chpl-comm.h"
@@ -52,9 +53,14 @@ extern int chpl_comm_diags_print_unstable;
   MACRO(wait_nb) \
   MACRO(try_nb) \
   MACRO(amo) \
+  MACRO(amo_native) \
+  MACRO(amo_emulated) \
+  MACRO(amo_am) \
   MACRO(execute_on) \
   MACRO(execute_on_fast) \
   MACRO(execute_on_nb) \
+  MACRO(tci_steal) \
+  MACRO(tci_wait) \
   MACRO(cache_get_hits) \
   MACRO(cache_get_misses) \
   MACRO(cache_put_hits) \
@@ -64,7 +70,10 @@ extern int chpl_comm_diags_print_unstable;
   MACRO(cache_prefetch_unused) \
   MACRO(cache_prefetch_waited) \
   MACRO(cache_readahead_unused) \
-  MACRO(cache_readahead_waited)
+  MACRO(cache_readahead_waited) \
+  MACRO(cache_shared_hits) \
+  MACRO(cache_shared_misses) \
+  MACRO(cache_coalesced_put_bytes)
 
 typedef struct _chpl_commDiagnostics {
 #define _COMM_DIAGS_DECL(cdv) uint64_t cdv;
@@ -84,6 +93,54 @@ void chpl_comm_stopDiagnosticsHere(int32_t, int32_t);
 void chpl_comm_resetDiagnosticsHere(void);
 void chpl_comm_getDiagnosticsHere(chpl_commDiagnostics *cd);
 
+//
+// Optional latency and message size histograms, enabled by setting
+// CHPL_RT_COMM_DIAGS_HISTOGRAMS.  These are only recorded while comm
+// diagnostics are on.  Bucket i counts the ops whose latency in
+// nanoseconds (or size in bytes) v satisfies 2^(i-1) <= v < 2^i, with
+// bucket 0 holding v == 0.
+//
+extern int chpl_comm_diags_hist;
+
+#define CHPL_COMM_DIAGS_HIST_OPS_ALL(MACRO) \
+  MACRO(get) \
+  MACRO(get_nb) \
+  MACRO(put) \
+  MACRO(put_nb) \
+  MACRO(amo) \
+  MACRO(execute_on) \
+  MACRO(execute_on_fast) \
+  MACRO(execute_on_nb)
+
+typedef enum {
+#define _COMM_DIAGS_HIST_ENUM(op) chpl_comm_diags_hist_##op,
+  CHPL_COMM_DIAGS_HIST_OPS_ALL(_COMM_DIAGS_HIST_ENUM)
+#undef _COMM_DIAGS_HIST_ENUM
+  chpl_comm_diags_hist_num_ops
+} chpl_comm_diags_hist_op_t;
+
+#define CHPL_COMM_DIAGS_HIST_BUCKETS 64
+
+typedef struct _chpl_commHistograms {
+  uint64_t latency[chpl_comm_diags_hist_num_ops][CHPL_COMM_DIAGS_HIST_BUCKETS];
+  uint64_t size[chpl_comm_diags_hist_num_ops][CHPL_COMM_DIAGS_HIST_BUCKETS];
+} chpl_commHistograms;
+
+void chpl_comm_getHistogramsHere(chpl_commHistograms *ch);
+void chpl_comm_printHistogramsHere(void);
+
+//
+// Optional communication-pattern matrix, enabled by setting
+// CHPL_RT_COMM_DIAGS_MATRIX to a file name prefix.  Each locale counts
+// the ops and bytes it sends to every other locale, and at exit writes
+// its row of the matrix to <prefix>.<nodeID>.  Unlike the counters
+// above this is recorded for the whole run, not just while comm
+// diagnostics are on.
+//
+extern chpl_atomic_uint_least64_t* chpl_comm_diags_matrix;
+
+void chpl_comm_writeDiagsMatrixHere(void);
+
 
 ////////////////////
 //
@@ -97,12 +154,20 @@ typedef struct _chpl_atomic_commDiagnostics {
 
 extern chpl_atomic_commDiagnostics chpl_comm_diags_counters;
 
+void chpl_comm_diags_hist_init(void);
+void chpl_comm_diags_hist_reset(void);
+void chpl_comm_diags_matrix_init(void);
+void chpl_comm_diags_matrix_reset(void);
+void chpl_comm_diags_hist_record(chpl_comm_diags_hist_op_t, size_t, uint64_t);
+
 static inline
 void chpl_comm_diags_init(void) {
 #define _COMM_DIAGS_INIT(cdv) \
         atomic_init_uint_least64_t(&chpl_comm_diags_counters.cdv, 0);
   CHPL_COMM_DIAGS_VARS_ALL(_COMM_DIAGS_INIT);
 #undef _COMM_DIAGS_INIT
+  chpl_comm_diags_hist_init();
+  chpl_comm_diags_matrix_init();
 }
 
 static inline
@@ -180,6 +245,64 @@ extern chpl_bool chpl_task_getCommDiagsTemporarilyDisabled(void);
     }                                                                        \
   } while(0)
 
+//
+// Histogram recording.  The comm layer brackets an op with these:
+//   uint64_t t0 = chpl_comm_diags_hist_start();
+//   ...
+//   chpl_comm_diags_hist_end(put, size, t0);
+// A zero start time means we aren't recording, so the only cost when
+// histograms are off is the flag checks.
+//
+static inline
+uint64_t chpl_comm_diags_hist_now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static inline
+uint64_t chpl_comm_diags_hist_start(void) {
+  if (chpl_comm_diags_hist && chpl_comm_diagnostics &&
+      !chpl_task_getCommDiagsTemporarilyDisabled()) {
+    return chpl_comm_diags_hist_now();
+  }
+  return 0;
+}
+
+#define chpl_comm_diags_hist_end(_op, _size, _t0)                            \
+  do {                                                                       \
+    if ((_t0) != 0) {                                                        \
+      chpl_comm_diags_hist_record(chpl_comm_diags_hist_##_op, (_size), (_t0)); \
+    }                                                                        \
+  } while(0)
+
+//
+// Count one op of _size bytes to _node in the pattern matrix.  Row
+// entries are [2*node] for ops and [2*node+1] for bytes.
+//
+#define chpl_comm_diags_matrix_add(_node, _size)                             \
+  do {                                                                       \
+    if (chpl_comm_diags_matrix != NULL &&                                    \
+        !chpl_task_getCommDiagsTemporarilyDisabled()) {                      \
+      (void) atomic_fetch_add_explicit_uint_least64_t(                       \
+               &chpl_comm_diags_matrix[2 * (_node)], 1,                      \
+               chpl_memory_order_relaxed);                                   \
+      (void) atomic_fetch_add_explicit_uint_least64_t(                       \
+               &chpl_comm_diags_matrix[2 * (_node) + 1], (_size),            \
+               chpl_memory_order_relaxed);                                   \
+    }                                                                        \
+  } while(0)
+
+#define chpl_comm_diags_add(_ctr, _n)                                        \
+  do {                                                                       \
+    if (chpl_comm_diagnostics &&                                             \
+        !chpl_task_getCommDiagsTemporarilyDisabled()) {                      \
+      chpl_atomic_uint_least64_t* ctrAddr = &chpl_comm_diags_counters._ctr;       \
+      (void) atomic_fetch_add_explicit_uint_least64_t(ctrAddr, (_n),         \
+                                                      chpl_memory_order_relaxed); \
+    }                                                                        \
+  } while(0)
+
 #ifdef __cplusplus
 }
 #endif
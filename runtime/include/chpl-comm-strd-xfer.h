@@ -35,6 +35,7 @@
 #include "chpl-comm-callbacks.h"
 #include "chpl-comm-callbacks-internal.h"
 #include "chpl-mem.h"
+#include "chpl-mem-arena.h"
 #include "chpl-mem-desc.h"
 #include "chpl-tasks.h"
 
@@ -241,8 +242,8 @@ void put_strd_common(void* dstaddr_arg, size_t* dststrides, int32_t dstlocale,
       total=total*cnt[i+1];
 
     //displacement from the dstaddr and srcaddr start points
-    srcdisp=chpl_mem_allocMany(total,sizeof(int),CHPL_RT_MD_GETS_PUTS_STRIDES,0,0);
-    dstdisp=chpl_mem_allocMany(total,sizeof(int),CHPL_RT_MD_GETS_PUTS_STRIDES,0,0);
+    srcdisp=chpl_mem_arena_alloc(total*sizeof(int),CHPL_RT_MD_GETS_PUTS_STRIDES,0,0);
+    dstdisp=chpl_mem_arena_alloc(total*sizeof(int),CHPL_RT_MD_GETS_PUTS_STRIDES,0,0);
 
     for (j=0; j<total; j++) {
       carry=1;
@@ -270,8 +271,8 @@ void put_strd_common(void* dstaddr_arg, size_t* dststrides, int32_t dstlocale,
         }
       }
     } // for j
-    chpl_mem_free(srcdisp,0,0);
-    chpl_mem_free(dstdisp,0,0);
+    chpl_mem_arena_free(srcdisp,0,0);
+    chpl_mem_arena_free(dstdisp,0,0);
     break;
   }
 
@@ -390,8 +391,8 @@ void get_strd_common(void* dstaddr_arg, size_t* dststrides, int32_t srclocale,
       total=total*cnt[i+1];
 
     //displacement from the dstaddr and srcaddr start points
-    srcdisp=chpl_mem_allocMany(total,sizeof(int),CHPL_RT_MD_GETS_PUTS_STRIDES,0,0);
-    dstdisp=chpl_mem_allocMany(total,sizeof(int),CHPL_RT_MD_GETS_PUTS_STRIDES,0,0);
+    srcdisp=chpl_mem_arena_alloc(total*sizeof(int),CHPL_RT_MD_GETS_PUTS_STRIDES,0,0);
+    dstdisp=chpl_mem_arena_alloc(total*sizeof(int),CHPL_RT_MD_GETS_PUTS_STRIDES,0,0);
 
     for (j=0; j<total; j++) {
       carry=1;
@@ -419,8 +420,8 @@ void get_strd_common(void* dstaddr_arg, size_t* dststrides, int32_t srclocale,
         }
       }
     }
-    chpl_mem_free(srcdisp,0,0);
-    chpl_mem_free(dstdisp,0,0);
+    chpl_mem_arena_free(srcdisp,0,0);
+    chpl_mem_arena_free(dstdisp,0,0);
     break;
   }
 
@@ -523,8 +524,8 @@ void strd_common_call(void* dstaddr_arg, size_t* dststrides, int32_t srclocale,
       total=total*cnt[i+1];
 
     //displacement from the dstaddr and srcaddr start points
-    srcdisp=chpl_mem_allocMany(total,sizeof(int),CHPL_RT_MD_GETS_PUTS_STRIDES,0,0);
-    dstdisp=chpl_mem_allocMany(total,sizeof(int),CHPL_RT_MD_GETS_PUTS_STRIDES,0,0);
+    srcdisp=chpl_mem_arena_alloc(total*sizeof(int),CHPL_RT_MD_GETS_PUTS_STRIDES,0,0);
+    dstdisp=chpl_mem_arena_alloc(total*sizeof(int),CHPL_RT_MD_GETS_PUTS_STRIDES,0,0);
 
     for (j=0; j<total; j++) {
       carry=1;
@@ -549,8 +550,8 @@ void strd_common_call(void* dstaddr_arg, size_t* dststrides, int32_t srclocale,
         }
       }
     }
-    chpl_mem_free(srcdisp,0,0);
-    chpl_mem_free(dstdisp,0,0);
+    chpl_mem_arena_free(srcdisp,0,0);
+    chpl_mem_arena_free(dstdisp,0,0);
     break;
   }
 }
@@ -260,6 +260,19 @@ void chpl_comm_rollcall(void);
 //   touch the heap in an interleaved and parallel manner to improve
 //   NUMA affinity and speed up faulting in the memory.
 //
+// chpl_comm_regMemHeapTouchAsync():
+//   Like chpl_comm_regMemHeapTouch(), but returns once the touching
+//   threads are started, so the rest of startup can overlap with it.
+//   The memory may be used while they run.
+//
+// chpl_comm_regMemHeapTouchWait():
+//   Wait for a chpl_comm_regMemHeapTouchAsync() to finish.  This must
+//   be called before the heap is registered.  It does nothing if no
+//   touch is in progress.
+//
+// chpl_comm_regMemHeapTouchSeconds():
+//   How long touching the heap took, for startup timing reports.
+//
 // chpl_comm_regMemAllocThreshold():
 //   Allocations smaller than this should be done normally, by the
 //   memory layer.  Those at least this size may be done through this
@@ -303,6 +316,9 @@ size_t chpl_comm_regMemHeapPageSize(void) {
 }
 
 void chpl_comm_regMemHeapTouch(void* start, size_t size);
+void chpl_comm_regMemHeapTouchAsync(void* start, size_t size);
+void chpl_comm_regMemHeapTouchWait(void);
+double chpl_comm_regMemHeapTouchSeconds(void);
 
 #ifndef CHPL_COMM_IMPL_REG_MEM_ALLOC_THRESHOLD
   #define CHPL_COMM_IMPL_REG_MEM_ALLOC_THRESHOLD() SIZE_MAX
@@ -356,6 +372,37 @@ chpl_bool chpl_comm_regMemFree(void* p, size_t size) {
   return CHPL_COMM_IMPL_REG_MEM_FREE(p, size);
 }
 
+//
+// chpl_comm_regMemFreeNotify()
+//   Tell the comm layer that the memory layer is about to free some
+//   memory it allocated itself, so that the comm layer can drop any
+//   registrations it has cached for that memory.
+//
+#ifndef CHPL_COMM_IMPL_REG_MEM_FREE_NOTIFY
+#define CHPL_COMM_IMPL_REG_MEM_FREE_NOTIFY(p, size) return
+#endif
+static inline
+void chpl_comm_regMemFreeNotify(void* p, size_t size) {
+  CHPL_COMM_IMPL_REG_MEM_FREE_NOTIFY(p, size);
+}
+
+//
+// chpl_comm_regMemDevice()
+//   Can [addr, addr+size), which is in local GPU device memory, be the
+//   local side of a chpl_comm_put() to or chpl_comm_get() from
+//   [raddr, raddr+size) on node?  If not, the caller has to stage the
+//   transfer through host memory.  The GPU layer must tell the comm
+//   layer about device memory it frees, via chpl_comm_regMemFreeNotify().
+//
+#ifndef CHPL_COMM_IMPL_REG_MEM_DEVICE
+#define CHPL_COMM_IMPL_REG_MEM_DEVICE(addr, size, node, raddr) false
+#endif
+static inline
+chpl_bool chpl_comm_regMemDevice(void* addr, size_t size,
+                                 c_nodeid_t node, void* raddr) {
+  return CHPL_COMM_IMPL_REG_MEM_DEVICE(addr, size, node, raddr);
+}
+
 //
 // These routines are used by the Chapel runtime to broadcast the
 // locations of module-level ("global") variables to all locales
@@ -500,6 +547,31 @@ void chpl_comm_get_strd(void* dstaddr, size_t* dststrides, c_nodeid_t srcnode,
                         int32_t stridelevels, size_t elemSize, int32_t commID,
                         int ln, int32_t fn);
 
+//
+// Non-blocking versions of chpl_comm_put_strd() and chpl_comm_get_strd().
+// These return a single handle covering the whole strided transfer, for
+// use with chpl_comm_test_nb_complete() and friends, or NULL if the
+// transfer has already completed.  As with chpl_comm_put_nb() and
+// chpl_comm_get_nb(), neither the source nor the destination memory may
+// be touched before the handle completes.  The stride and count arrays
+// may be reused as soon as these return.
+//
+chpl_comm_nb_handle_t chpl_comm_put_strd_nb(void* dstaddr, size_t* dststrides,
+                                            c_nodeid_t dstnode,
+                                            void* srcaddr, size_t* srcstrides,
+                                            size_t* count,
+                                            int32_t stridelevels,
+                                            size_t elemSize, int32_t commID,
+                                            int ln, int32_t fn);
+
+chpl_comm_nb_handle_t chpl_comm_get_strd_nb(void* dstaddr, size_t* dststrides,
+                                            c_nodeid_t srcnode,
+                                            void* srcaddr, size_t* srcstrides,
+                                            size_t* count,
+                                            int32_t stridelevels,
+                                            size_t elemSize, int32_t commID,
+                                            int ln, int32_t fn);
+
 
 //
 // Unordered ops
@@ -21,6 +21,8 @@
 #ifndef _CHPL_DYNAMIC_LOADING_H_
 #define _CHPL_DYNAMIC_LOADING_H_
 
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -37,10 +39,45 @@ extern int CHPL_RTLD_LAZY;
 
 void* chpl_dlopen(const char* path, int mode);
 
+// Symbols found with chpl_dlsym are cached for each handle returned by
+// chpl_dlopen, so looking one up again doesn't go through dlsym.  The
+// cache is dropped when chpl_dlclose has been called as many times as
+// chpl_dlopen returned the handle.
 void* chpl_dlsym(void* handle, const char* symbol);
 
 int chpl_dlclose(void* handle);
 
+//
+// The dynamic ftable extension.  chpl_dlsym_index() looks up a symbol
+// like chpl_dlsym() but returns its index in a process-wide table of
+// procedure pointers instead, or -1 if it wasn't found.  Asking for the
+// same symbol of the same handle again returns the same index, and
+// indices are never reused.  A call through a symbol from a loaded
+// library is then chpl_dl_ftable_get(index), with no lookup or lock.
+// Once the library has been closed, its entries are NULL.
+//
+// The table is made of chunks that never move once allocated, so that
+// reading it needs no lock while it grows.
+//
+#define CHPL_DL_FTABLE_CHUNK_BITS 10
+#define CHPL_DL_FTABLE_CHUNK_SIZE (1 << CHPL_DL_FTABLE_CHUNK_BITS)
+#define CHPL_DL_FTABLE_MAX_CHUNKS 256
+
+extern void** chpl_dl_ftable_chunks[CHPL_DL_FTABLE_MAX_CHUNKS];
+
+int64_t chpl_dlsym_index(void* handle, const char* symbol);
+
+static inline
+void* chpl_dl_ftable_get(int64_t index) {
+  return chpl_dl_ftable_chunks[index >> CHPL_DL_FTABLE_CHUNK_BITS]
+                              [index & (CHPL_DL_FTABLE_CHUNK_SIZE - 1)];
+}
+
+// Return the chpl_ftable of a Chapel library opened with chpl_dlopen,
+// and store its number of entries in 'size', or return NULL if it
+// doesn't have one.  The result is cached with the handle's symbols.
+void** chpl_dl_get_ftable(void* handle, int64_t* size);
+
 const char* chpl_dlerror(void);
 
 #ifdef __cplusplus
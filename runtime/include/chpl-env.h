@@ -77,6 +77,13 @@ size_t chpl_env_rt_get_size(const char* ev, size_t dflt) {
 void chpl_env_set(const char*, const char*, int);
 void chpl_env_set_uint(const char*, uint64_t, int);
 
+//
+// If CHPL_RT_ENV_BUNDLE names an environment bundle written by the
+// launcher (see chpl_get_enviro_keys()), set the variables in it that
+// aren't set already.
+//
+void chpl_env_load_bundle(void);
+
 #ifdef __cplusplus
 }
 #endif
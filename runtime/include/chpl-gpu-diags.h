@@ -46,7 +46,8 @@ extern int chpl_gpu_diags_print_unstable;
   MACRO(kernel_launch) \
   MACRO(host_to_device) \
   MACRO(device_to_host) \
-  MACRO(device_to_device)
+  MACRO(device_to_device) \
+  MACRO(prefetch)
 
 
 typedef struct _chpl_gpuDiagnostics {
@@ -165,6 +166,12 @@ int chpl_gpu_diags_is_enabled(void) {
     "%s:%d: copy from device (%d) to device (%d), %zu bytes, commid %d",    \
     chpl_lookupFilename(fn), ln, src_device_id, dst_device_id, size, commid)
 
+#define chpl_gpu_diags_verbose_prefetch( \
+  ln, fn, dst_device_id, size) \
+    chpl_gpu_diags_verbose_printf(false, dst_device_id,   \
+    "%s:%d: prefetch of unified memory, %zu bytes",    \
+    chpl_lookupFilename(fn), ln, size)
+
 #define chpl_gpu_diags_incr(_ctr)                                           \
   do {                                                                       \
     if (chpl_gpu_diagnostics && chpl_gpu_diags_is_enabled()) {             \
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2020-2026 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at * *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _chpl_gpu_graph_h_
+#define _chpl_gpu_graph_h_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Capturing repeated sequences of kernel launches into CUDA/HIP graphs.
+//
+// A task brackets a piece of code that it runs many times (say, the body
+// of a time-stepping loop) with chpl_gpu_graph_begin/end. Within the
+// region, kernel launches on the task's stream are recorded rather than
+// launched right away. At the end of the region, if the launches match
+// the ones from the previous time through (same kernels, dimensions and
+// argument bytes), they are captured into a graph, which is launched
+// then and on every later pass that matches it. Otherwise they're
+// launched one by one, as usual.
+//
+// Since launches are deferred, host code in a region must not depend on
+// what its kernels have done yet. Anything else the runtime puts on the
+// stream in the meantime (copies, memsets, launches that can't be
+// deferred, ...) first launches what was deferred, and a pass where that
+// happens isn't captured. Only launches whose arguments are all by value
+// or by offload are deferred; ones with reductions, privatized instances
+// or host-registered arguments aren't.
+//
+// This is off unless CHPL_RT_GPU_GRAPHS is set, and needs a GPU runtime
+// that supports graphs. Regions do nothing without a stream per task.
+//
+
+// Begin and end a region. region_id identifies the region in the
+// program; regions nested in another one are ignored.
+void chpl_gpu_graph_begin(int64_t region_id);
+void chpl_gpu_graph_end(int64_t region_id);
+
+//
+// The rest is for chpl-gpu.c.
+//
+
+typedef struct chpl_gpu_graph_task_s chpl_gpu_graph_task_t;
+
+void chpl_gpu_graph_init(void);
+
+// Start or finish a region for the task whose graph state is *task.
+void chpl_gpu_graph_region_begin(chpl_gpu_graph_task_t** task,
+                                 int64_t region_id, int dev, void* stream);
+// Returns the stream it launched on, or NULL if nothing was launched.
+void* chpl_gpu_graph_region_end(chpl_gpu_graph_task_t* task,
+                                int64_t region_id);
+
+// Record a launch, instead of making it. Returns false if task isn't in a
+// region for dev and stream; then the caller launches as usual. params
+// points to n_params values of param_sizes[i] bytes each, which are
+// copied.
+bool chpl_gpu_graph_defer_launch(chpl_gpu_graph_task_t* task, int dev,
+                                 void* stream, void* function,
+                                 int grd_dim_x, int grd_dim_y, int grd_dim_z,
+                                 int blk_dim_x, int blk_dim_y, int blk_dim_z,
+                                 void* halt_flag, int ln, int32_t fn,
+                                 int n_params, void** params,
+                                 const size_t* param_sizes);
+
+// Launch whatever task has deferred. Returns the stream it launched on,
+// or NULL if nothing was pending.
+void* chpl_gpu_graph_flush(chpl_gpu_graph_task_t* task);
+
+// The task is ending: launch anything pending and free its state.
+// Returns like chpl_gpu_graph_flush.
+void* chpl_gpu_graph_task_end(chpl_gpu_graph_task_t** task);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -57,6 +57,15 @@ void chpl_gpu_impl_copy_host_to_device(void* dst, const void* src, size_t n,
                                        void* stream);
 void chpl_gpu_impl_copy_device_to_device(void* dst, const void* src, size_t n,
                                          void* stream);
+// Copy between two devices that may not have peer access to each other.
+// The vendor runtime stages it through the host if it has to.
+void chpl_gpu_impl_copy_peer(void* dst, int dst_dev, const void* src,
+                             int src_dev, size_t n, void* stream);
+// Copy height rows of width bytes, dpitch and spitch bytes apart, between
+// any combination of host and device memory.
+void chpl_gpu_impl_copy_2d(void* dst, size_t dpitch, const void* src,
+                           size_t spitch, size_t width, size_t height,
+                           void* stream);
 
 void* chpl_gpu_impl_comm_async(void *dst, void *src, size_t n);
 void chpl_gpu_impl_comm_wait(void *stream);
@@ -69,6 +78,19 @@ bool chpl_gpu_impl_is_host_ptr(const void* ptr);
 // TODO do we really need to expose this?
 size_t chpl_gpu_impl_get_alloc_size(void* ptr);
 
+bool chpl_gpu_impl_get_mem_region(const void* ptr,
+                                  chpl_gpu_mem_region_t* region);
+
+// Unified memory hints (see chpl_gpu_mem_prefetch). Since they are only
+// hints, devices that can't take them are quietly ignored. dev is a
+// logical device ID, or -1 for the host.
+bool chpl_gpu_impl_get_managed_range(const void* ptr, void** base,
+                                     size_t* size);
+void chpl_gpu_impl_mem_prefetch(const void* addr, size_t size, int dev,
+                                void* stream);
+void chpl_gpu_impl_mem_advise(const void* addr, size_t size,
+                              chpl_gpu_mem_advice_t advice, int dev);
+
 bool chpl_gpu_impl_can_access_peer(int dev1, int dev2);
 void chpl_gpu_impl_set_peer_access(int dev1, int dev2, bool enable);
 
@@ -81,6 +103,27 @@ void chpl_gpu_impl_stream_destroy(void* stream);
 bool chpl_gpu_impl_stream_ready(void* stream);
 void chpl_gpu_impl_stream_synchronize(void* stream);
 
+// Graphs of kernel launches (see chpl-gpu-graph.h). Launches made on a
+// stream between begin_capture and end_capture are recorded instead of
+// run; end_capture returns them as a graph that can be launched.
+bool chpl_gpu_impl_graph_supported(void);
+void chpl_gpu_impl_stream_begin_capture(void* stream);
+void* chpl_gpu_impl_stream_end_capture(void* stream);
+void chpl_gpu_impl_graph_launch(void* graph, void* stream);
+void chpl_gpu_impl_graph_destroy(void* graph);
+
+// Events, for timing kernels (see chpl-gpu-kernel-stats.h). event_create
+// returns NULL if there are no events. elapsed_ms waits for end.
+void* chpl_gpu_impl_event_create(void);
+void chpl_gpu_impl_event_destroy(void* event);
+void chpl_gpu_impl_event_record(void* event, void* stream);
+bool chpl_gpu_impl_event_done(void* event);
+double chpl_gpu_impl_event_elapsed_ms(void* start, void* end);
+
+// How many blocks of blk_size threads of the kernel fit on one
+// multiprocessor at once.
+int chpl_gpu_impl_max_active_blocks(void* function, int blk_size);
+
 void* chpl_gpu_impl_host_register(void* var, size_t size);
 void chpl_gpu_impl_host_unregister(void* var);
 
@@ -96,15 +139,57 @@ GPU_CUB_WRAP(DECL_ONE_REDUCE_IMPL, maxloc)
 
 #undef DECL_ONE_REDUCE_IMPL
 
+// Reduce each of r's variables' n partial results, all in one kernel.
+void chpl_gpu_impl_fused_reduce(const chpl_gpu_fused_reduce_t* r, int n,
+                                void* stream);
+
 #define DECL_ONE_SORT_IMPL(chpl_kind, data_type) \
 void chpl_gpu_impl_sort_##chpl_kind##_##data_type(data_type* data_in, \
                                                   data_type* data_out, \
                                                   int n, void* stream);
 GPU_CUB_WRAP(DECL_ONE_SORT_IMPL, keys)
-// TODO: GPU_SORT(DECL_ONE_SORT_IMPL, keysDesc/ DoubleBuffer/Pairs etc)
+// TODO: GPU_SORT(DECL_ONE_SORT_IMPL, keysDesc/ DoubleBuffer etc)
 
 #undef DECL_ONE_SORT_IMPL
 
+#define DECL_ONE_SORT_PAIRS_IMPL(chpl_kind, data_type) \
+void chpl_gpu_impl_sort_##chpl_kind##_##data_type(data_type* keys_in, \
+                                                  data_type* keys_out, \
+                                                  int64_t* vals_in, \
+                                                  int64_t* vals_out, \
+                                                  int n, void* stream);
+GPU_CUB_WRAP(DECL_ONE_SORT_PAIRS_IMPL, pairs)
+
+#undef DECL_ONE_SORT_PAIRS_IMPL
+
+#define DECL_ONE_SEGMENTED_SORT_IMPL(chpl_kind, data_type) \
+void chpl_gpu_impl_segmented_sort_##chpl_kind##_##data_type( \
+    data_type* data_in, data_type* data_out, int n, int n_segments, \
+    int* offsets, void* stream);
+GPU_CUB_WRAP(DECL_ONE_SEGMENTED_SORT_IMPL, keys)
+
+#undef DECL_ONE_SEGMENTED_SORT_IMPL
+
+#define DECL_ONE_SCAN_IMPL(chpl_kind, data_type) \
+void chpl_gpu_impl_##chpl_kind##_scan_##data_type(data_type* data_in, \
+                                                  data_type* data_out, \
+                                                  int n, void* stream);
+GPU_CUB_WRAP(DECL_ONE_SCAN_IMPL, exclusive)
+GPU_CUB_WRAP(DECL_ONE_SCAN_IMPL, inclusive)
+
+#undef DECL_ONE_SCAN_IMPL
+
+// n_selected is host memory, and is written asynchronously on stream
+#define DECL_ONE_SELECT_IMPL(chpl_kind, data_type) \
+void chpl_gpu_impl_select_##chpl_kind##_##data_type(data_type* data_in, \
+                                                    chpl_bool* flags, \
+                                                    data_type* data_out, \
+                                                    int n, int* n_selected, \
+                                                    void* stream);
+GPU_CUB_WRAP(DECL_ONE_SELECT_IMPL, flagged)
+
+#undef DECL_ONE_SELECT_IMPL
+
 void chpl_gpu_impl_name(int dev, char *resultBuffer, int bufferSize);
 
 int chpl_gpu_impl_query_attribute(int dev, int attribute);
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2020-2026 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _chpl_gpu_kernel_stats_h_
+#define _chpl_gpu_kernel_stats_h_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Per-kernel timing, for tuning launches without an external profiler.
+//
+// With CHPL_RT_GPU_KERNEL_STATS set, each kernel launch that isn't
+// deferred to a graph region (see chpl-gpu-graph.h) is bracketed with
+// events on its stream, and the time between them is added up per
+// source line of the kernel. Along with the times, each line gets the
+// block size it was last launched with and the occupancy that block size
+// allows: how many of a multiprocessor's threads can be resident at once,
+// as a fraction of the most it can hold. Timings are collected as their
+// events complete, so launches stay asynchronous.
+//
+// The bytes copied between host and device memory are counted too, per
+// direction. At exit, each locale prints its lines sorted by total time,
+// followed by the byte counts.
+//
+
+void chpl_gpu_kernel_stats_init(void);
+
+// Returns a token to pass to _end, or NULL if stats aren't being kept.
+void* chpl_gpu_kernel_stats_begin(void* stream);
+void chpl_gpu_kernel_stats_end(void* token, void* stream, void* function,
+                               int dev, int ln, int32_t fn,
+                               int64_t n_blocks, int blk_size);
+
+typedef enum {
+  CHPL_GPU_KERNEL_STATS_HOST_TO_DEVICE,
+  CHPL_GPU_KERNEL_STATS_DEVICE_TO_HOST,
+  CHPL_GPU_KERNEL_STATS_DEVICE_TO_DEVICE,
+  CHPL_GPU_KERNEL_STATS_NUM_DIRS
+} chpl_gpu_kernel_stats_dir_t;
+
+void chpl_gpu_kernel_stats_copy(chpl_gpu_kernel_stats_dir_t dir, size_t n);
+
+void chpl_gpu_kernel_stats_report(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2020-2026 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at * *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _chpl_gpu_mem_pool_h_
+#define _chpl_gpu_mem_pool_h_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// A caching allocator for GPU memory, one pool per device.
+//
+// Freed blocks go on size-binned free lists instead of back to the
+// driver. A block is tagged with the stream of the task that freed it,
+// and only that stream can reuse it (work on it may still be using the
+// memory) until the stream is synchronized, after which anyone can.
+//
+// CHPL_RT_GPU_MEM_POOL turns the pool on or off (on by default, except
+// for CPU-as-device), and CHPL_RT_GPU_MEM_POOL_LIMIT bounds the bytes
+// each device keeps cached (1G by default).
+//
+
+typedef struct chpl_gpu_mem_pool_stats_s {
+  uint64_t hits;          // allocations served from the free lists
+  uint64_t misses;        // allocations that went to the driver
+  uint64_t in_use_bytes;  // bytes in pool blocks that are allocated
+  uint64_t cached_bytes;  // bytes in pool blocks on the free lists
+  uint64_t trimmed_bytes; // bytes given back to the driver so far
+} chpl_gpu_mem_pool_stats_t;
+
+void chpl_gpu_mem_pool_init(void);
+
+// Allocate size bytes on device dev for stream, as array memory
+// (chpl_gpu_impl_mem_array_alloc) or not (chpl_gpu_impl_mem_alloc).
+void* chpl_gpu_mem_pool_alloc(int dev, size_t size, bool array, void* stream);
+
+// Put ptr back in its pool, tagged with stream (which belongs to device
+// dev). Returns false if ptr is not a pool block; then the caller frees
+// it as usual.
+bool chpl_gpu_mem_pool_free(void* ptr, int dev, void* stream);
+
+// stream on device dev has finished everything queued on it, so blocks
+// freed on it can go to anyone.
+void chpl_gpu_mem_pool_stream_done(int dev, void* stream);
+
+// Give the cached blocks on device dev (or all devices, if dev < 0)
+// back to the driver.
+void chpl_gpu_mem_pool_trim(int dev);
+
+// Get the counters for device dev, or the sum over all devices if dev < 0.
+void chpl_gpu_mem_pool_get_stats(int dev, chpl_gpu_mem_pool_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
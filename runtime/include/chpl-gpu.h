@@ -104,14 +104,32 @@ void* chpl_gpu_init_kernel_cfg_3d(const char* fn_name,
 void chpl_gpu_deinit_kernel_cfg(void* cfg);
 void chpl_gpu_arg_offload(void* cfg, void* arg, size_t size);
 void chpl_gpu_pid_offload(void* cfg, int64_t pid, size_t size);
-void chpl_gpu_arg_pass(void* cfg, void* arg);
+void chpl_gpu_arg_pass(void* cfg, void* arg, size_t size);
 void chpl_gpu_arg_reduce(void* cfg, void* arg, size_t elem_size,
-                         reduce_wrapper_fn_t wrapper);
+                         reduce_wrapper_fn_t wrapper, const char* final_fn);
 void chpl_gpu_arg_host_register(void* _cfg, void* arg, size_t size);
+void chpl_gpu_arg_prefetch(void* cfg, void* arg, size_t size);
 void chpl_gpu_launch_kernel(void* cfg);
 
 void* chpl_gpu_mem_array_alloc(size_t size, chpl_mem_descInt_t description,
                                    int32_t lineno, int32_t filename);
+
+// Hints for unified memory; they do nothing in other memory strategies.
+// dev is a sublocale, or -1 for the host.
+typedef enum {
+  CHPL_GPU_MEM_ADVISE_READ_MOSTLY,
+  CHPL_GPU_MEM_ADVISE_UNSET_READ_MOSTLY,
+  CHPL_GPU_MEM_ADVISE_PREFERRED_LOCATION,
+  CHPL_GPU_MEM_ADVISE_UNSET_PREFERRED_LOCATION,
+  CHPL_GPU_MEM_ADVISE_ACCESSED_BY,
+} chpl_gpu_mem_advice_t;
+
+// Start migrating [addr, addr+size) to dev, ordered with the task's other
+// GPU work.
+void chpl_gpu_mem_prefetch(void* addr, size_t size, int32_t dev,
+                           int32_t lineno, int32_t filename);
+void chpl_gpu_mem_advise(void* addr, size_t size,
+                         chpl_gpu_mem_advice_t advice, int32_t dev);
 void* chpl_gpu_mem_alloc(size_t size, chpl_mem_descInt_t description,
                          int32_t lineno, int32_t filename);
 void* chpl_gpu_mem_calloc(size_t number, size_t size,
@@ -174,6 +192,24 @@ unsigned int chpl_gpu_device_clock_rate(int32_t devNum);
 // TODO do we really need to expose this?
 size_t chpl_gpu_get_alloc_size(void* ptr);
 
+// The device allocation containing a pointer, described well enough for
+// a comm layer to register it with the network.
+typedef enum {
+  CHPL_GPU_MEM_REGION_CUDA,
+  CHPL_GPU_MEM_REGION_ROCM,
+} chpl_gpu_mem_region_kind_t;
+
+typedef struct {
+  chpl_gpu_mem_region_kind_t kind;
+  void* base;
+  size_t size;
+  int device;   // the vendor runtime's device number
+} chpl_gpu_mem_region_t;
+
+// Returns false if ptr isn't in device memory (pinned host memory
+// doesn't count).
+bool chpl_gpu_get_mem_region(const void* ptr, chpl_gpu_mem_region_t* region);
+
 bool chpl_gpu_can_access_peer(int dev1, int dev2);
 void chpl_gpu_set_peer_access(int dev1, int dev2, bool enable);
 
@@ -198,6 +234,56 @@ GPU_CUB_WRAP(DECL_ONE_SORT, keys);
 
 #undef DECL_ONE_SORT
 
+// Sort keys, carrying a value for each along with it. The values are
+// int64_t so that they can be indices into whatever the keys came from.
+#define DECL_ONE_SORT_PAIRS(chpl_kind, data_type) \
+void chpl_gpu_sort_##chpl_kind##_##data_type(data_type* keys_in, \
+                                             data_type* keys_out, \
+                                             int64_t* vals_in, \
+                                             int64_t* vals_out, \
+                                             int n);
+
+GPU_CUB_WRAP(DECL_ONE_SORT_PAIRS, pairs);
+
+#undef DECL_ONE_SORT_PAIRS
+
+// Sort each of n_segments segments of data_in on its own. Segment i is
+// [offsets[i], offsets[i+1]), so offsets has n_segments+1 elements and is
+// in device memory like the data.
+#define DECL_ONE_SEGMENTED_SORT(chpl_kind, data_type) \
+void chpl_gpu_segmented_sort_##chpl_kind##_##data_type(data_type* data_in, \
+                                                       data_type* data_out, \
+                                                       int n, int n_segments, \
+                                                       int* offsets);
+
+GPU_CUB_WRAP(DECL_ONE_SEGMENTED_SORT, keys);
+
+#undef DECL_ONE_SEGMENTED_SORT
+
+// Prefix sums. data_in and data_out may be the same.
+#define DECL_ONE_SCAN(chpl_kind, data_type) \
+void chpl_gpu_##chpl_kind##_scan_##data_type(data_type* data_in, \
+                                             data_type* data_out, \
+                                             int n);
+
+GPU_CUB_WRAP(DECL_ONE_SCAN, exclusive);
+GPU_CUB_WRAP(DECL_ONE_SCAN, inclusive);
+
+#undef DECL_ONE_SCAN
+
+// Stream compaction: copy the elements of data_in whose flag is set to the
+// front of data_out, in order, and set *n_selected to how many there were.
+// Unlike the other operations here, this waits for the result.
+#define DECL_ONE_SELECT(chpl_kind, data_type) \
+void chpl_gpu_select_##chpl_kind##_##data_type(data_type* data_in, \
+                                               chpl_bool* flags, \
+                                               data_type* data_out, \
+                                               int n, int* n_selected);
+
+GPU_CUB_WRAP(DECL_ONE_SELECT, flagged);
+
+#undef DECL_ONE_SELECT
+
 void chpl_gpu_name(int dev, char **result);
 
 extern const int CHPL_GPU_ATTRIBUTE__MAX_THREADS_PER_BLOCK;
@@ -0,0 +1,59 @@
+/*
+ * Copyright 2020-2026 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// A per-thread arena for the small, short-lived objects the tasking
+// and comm layers allocate on every task creation or remote fork, such
+// as argument bundle copies.  Each thread bump-allocates from its own
+// chunk.  An object may be freed from any thread; each chunk counts
+// its live objects, and is reset in O(1) by its owner when that count
+// drops to zero, or freed once the owner has moved on to a newer chunk.
+// Objects too large for a chunk come from chpl_mem_alloc() instead.
+//
+// Memory from chpl_mem_arena_alloc() must be returned with
+// chpl_mem_arena_free(), and never with chpl_mem_free() or realloc'd.
+//
+#ifndef _chpl_mem_arena_h_
+#define _chpl_mem_arena_h_
+
+#ifndef LAUNCHER
+
+#include <stddef.h>
+#include <stdint.h>
+#include "chpl-mem-desc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void chpl_mem_arena_init(void);
+
+void* chpl_mem_arena_alloc(size_t size, chpl_mem_descInt_t description,
+                           int32_t lineno, int32_t filename);
+
+void chpl_mem_arena_free(void* p, int32_t lineno, int32_t filename);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
+
+#endif // LAUNCHER
+
+#endif // _chpl_mem_arena_h_
@@ -51,6 +51,103 @@ chpl_bool chpl_mem_size_justifies_comm_alloc(size_t size) {
 }
 
 
+//
+// Size tiers for array memory not allocated by the comm layer.  Arrays
+// of at least chpl_mem_array_hugepageThreshold bytes are aligned to
+// 2 MiB and advised to use transparent huge pages; arrays of at least
+// chpl_mem_array_gigapageThreshold bytes are further aligned to 1 GiB.
+// A threshold of 0 disables its tier.  These come from
+// CHPL_RT_ARRAY_HUGEPAGE_THRESHOLD and CHPL_RT_ARRAY_GIGAPAGE_THRESHOLD,
+// and are both 0 when the heap already uses huge pages.
+//
+extern size_t chpl_mem_array_hugepageThreshold;
+extern size_t chpl_mem_array_gigapageThreshold;
+
+// Returns the alignment for an array of the given size, or 0 if it
+// isn't in a huge page tier.
+static inline
+size_t chpl_mem_array_hugepageAlign(size_t size) {
+  if (chpl_mem_array_gigapageThreshold != 0
+      && size >= chpl_mem_array_gigapageThreshold) {
+    return (size_t) 1 << 30;
+  }
+  if (chpl_mem_array_hugepageThreshold != 0
+      && size >= chpl_mem_array_hugepageThreshold) {
+    return (size_t) 2 << 20;
+  }
+  return 0;
+}
+
+// Advise, and count, the huge pages in a huge page tier array, and
+// uncount them when it is freed.
+void chpl_mem_array_hugepageAdvise(void* p, size_t size);
+void chpl_mem_array_hugepageRelease(void* p, size_t size);
+
+//
+// Arrays of at least chpl_mem_array_mapThreshold bytes (from
+// CHPL_RT_ARRAY_MREMAP_THRESHOLD) that the comm layer wouldn't allocate
+// get a mapping of their own, so that they can grow or shrink with
+// mremap() instead of being copied.  This is only done when the comm
+// layer neither has a registered heap nor allocates registered memory
+// itself, since memory mapped here would not be remotely accessible;
+// otherwise the threshold is 0, which disables it.
+//
+extern size_t chpl_mem_array_mapThreshold;
+
+static inline
+chpl_bool chpl_mem_array_isMapped(size_t size) {
+  return (chpl_mem_array_mapThreshold != 0
+          && size >= chpl_mem_array_mapThreshold
+          && !chpl_mem_size_justifies_comm_alloc(size));
+}
+
+void* chpl_mem_array_mapAlloc(size_t size);
+void* chpl_mem_array_mapRealloc(void* p, size_t oldSize, size_t newSize);
+void chpl_mem_array_mapFree(void* p, size_t size);
+
+//
+// Arrays of at least chpl_mem_array_firstTouchThreshold bytes (from
+// CHPL_RT_ARRAY_FIRST_TOUCH_THRESHOLD) that don't need the comm layer's
+// post-allocation step are first-touched right away by a team of
+// threads, spread across the NUMA domains in order so that each domain
+// gets an equal, contiguous share of the pages.  Arrays that do need
+// post-allocation are first-touched by our caller before that, as
+// always.  The threshold is 0, disabling this, by default.
+//
+extern size_t chpl_mem_array_firstTouchThreshold;
+
+void chpl_mem_array_firstTouch(void* p, size_t size);
+
+//
+// Where the pages of arrays of at least chpl_mem_array_placementThreshold
+// bytes go, from CHPL_RT_ARRAY_PLACEMENT:
+//   first-touch  wherever they're first touched (the default)
+//   interleave   round-robin across the NUMA domains
+//   block        one contiguous share per NUMA domain, in order
+//   sublocale    the NUMA domain of the sublocale allocating the array,
+//                or as for block if it isn't running on one
+// The policy is set when the array is allocated, before anything touches
+// it. The threshold comes from CHPL_RT_ARRAY_PLACEMENT_THRESHOLD.
+//
+typedef enum {
+  CHPL_MEM_ARRAY_PLACE_FIRST_TOUCH,
+  CHPL_MEM_ARRAY_PLACE_INTERLEAVE,
+  CHPL_MEM_ARRAY_PLACE_BLOCK,
+  CHPL_MEM_ARRAY_PLACE_SUBLOCALE
+} chpl_mem_array_placement_t;
+
+extern chpl_mem_array_placement_t chpl_mem_array_placement;
+extern size_t chpl_mem_array_placementThreshold;
+
+static inline
+chpl_bool chpl_mem_array_isPlaced(size_t size) {
+  return (chpl_mem_array_placement != CHPL_MEM_ARRAY_PLACE_FIRST_TOUCH
+          && size >= chpl_mem_array_placementThreshold);
+}
+
+void chpl_mem_array_place(void* p, size_t size, c_sublocid_t subloc);
+
+
 static inline
 void* chpl_mem_array_alloc(size_t nmemb, size_t eltSize,
                            c_sublocid_t subloc, chpl_bool* callPostAlloc,
@@ -87,11 +184,35 @@ void* chpl_mem_array_alloc(size_t nmemb, size_t eltSize,
                               lineno, filename);
     if (p != NULL) {
       *callPostAlloc = true;
+      if (chpl_mem_array_isPlaced(size)) {
+        chpl_mem_array_place(p, size, subloc);
+      }
     }
   }
 
   if (p == NULL) {
-    p = chpl_malloc(size);
+    const size_t align = chpl_mem_array_hugepageAlign(size);
+    if (chpl_mem_array_isMapped(size)) {
+      p = chpl_mem_array_mapAlloc(size);
+    } else if (align != 0) {
+      p = chpl_memalign(align, size);
+      if (p != NULL) {
+        chpl_mem_array_hugepageAdvise(p, size);
+      }
+    } else {
+      p = chpl_malloc(size);
+    }
+    if (p != NULL && chpl_mem_array_isPlaced(size)) {
+      chpl_mem_array_place(p, size, subloc);
+    } else if (p != NULL
+               && chpl_mem_array_firstTouchThreshold != 0
+               && size >= chpl_mem_array_firstTouchThreshold) {
+      chpl_mem_array_firstTouch(p, size);
+    }
+  }
+
+  if (p != NULL) {
+    chpl_memhook_count_alloc(size, size, CHPL_RT_MD_ARRAY_ELEMENTS);
   }
 
   if (haltOnOom) {
@@ -124,7 +245,8 @@ chpl_bool chpl_mem_array_supports_realloc(void* p, size_t oldNmemb, size_t newNm
                                           int32_t filename) {
   const size_t oldSize = oldNmemb * eltSize;
   const size_t newSize = newNmemb * eltSize;
-  return chpl_mem_size_justifies_comm_alloc(oldSize) == chpl_mem_size_justifies_comm_alloc(newSize);
+  return chpl_mem_size_justifies_comm_alloc(oldSize) == chpl_mem_size_justifies_comm_alloc(newSize)
+         && chpl_mem_array_isMapped(oldSize) == chpl_mem_array_isMapped(newSize);
 }
 
 static inline
@@ -163,13 +285,29 @@ void* chpl_mem_array_realloc(void* p, size_t oldNmemb, size_t newNmemb,
     }
   }
 
-  if (newp == NULL) {
+  if (newp == NULL
+      && (chpl_mem_array_isMapped(oldSize)
+          || chpl_mem_array_isMapped(newSize))) {
+    newp = chpl_mem_array_mapRealloc(p, oldSize, newSize);
+  } else if (newp == NULL) {
+    // Reallocation doesn't keep huge page alignment, but whatever
+    // huge pages fit in the new memory are still worth advising.
+    if (p != NULL && chpl_mem_array_hugepageAlign(oldSize) != 0) {
+      chpl_mem_array_hugepageRelease(p, oldSize);
+    }
     newp = chpl_realloc(p, newSize);
+    if (newp != NULL && chpl_mem_array_hugepageAlign(newSize) != 0) {
+      chpl_mem_array_hugepageAdvise(newp, newSize);
+    }
   }
 
   chpl_memhook_realloc_post(newp, oldp,
                             newSize, CHPL_RT_MD_ARRAY_ELEMENTS,
                             lineno, filename);
+  if (newp != NULL) {
+    chpl_memhook_count_free(oldSize);
+    chpl_memhook_count_alloc(newSize, newSize, CHPL_RT_MD_ARRAY_ELEMENTS);
+  }
 #ifdef HAS_GPU_LOCALE
   }
 #endif
@@ -209,12 +347,21 @@ void chpl_mem_array_free(void* p,
   //
   const size_t size = nmemb * eltSize;
   chpl_memhook_free_pre(p, size, lineno, filename);
+  chpl_memhook_count_free(size);
 
   if (chpl_mem_size_justifies_comm_alloc(size)
       && chpl_comm_regMemFree(p, size)) {
     return;
   }
 
+  chpl_comm_regMemFreeNotify(p, size);
+  if (chpl_mem_array_isMapped(size)) {
+    chpl_mem_array_mapFree(p, size);
+    return;
+  }
+  if (chpl_mem_array_hugepageAlign(size) != 0) {
+    chpl_mem_array_hugepageRelease(p, size);
+  }
   chpl_free(p);
 #ifdef HAS_GPU_LOCALE
   }
@@ -104,6 +104,7 @@ extern "C" {
   m(GPU_KERNEL_PARAM_BUFF, "array of pointers to kernel args",        true ), \
   m(GPU_KERNEL_PARAM_META, "metadata about kernel parameters",        true ), \
   m(ERROR_MSG,             "error message",                           true ), \
+  m(MEM_ARENA_CHUNK,       "mem layer transient object arena chunk",  false), \
   m(NUM,                   "*** this must be the last entry ***",     true )
 
 //
@@ -66,6 +66,8 @@ void chpl_memhook_malloc_pre(size_t number, size_t size,
                              int32_t lineno, int32_t filename) {
   if (CHPL_MEMHOOKS_ACTIVE)
     chpl_memhook_check_pre(number, size, description, lineno, filename);
+  if (chpl_memSample)
+    chpl_memsample_malloc(number * size, description, lineno, filename);
 }
 
 
@@ -115,6 +117,28 @@ void chpl_memhook_realloc_post(void* newMemAlloc, intptr_t oldMemAlloc,
                             lineno, filename);
 }
 
+
+//
+// Lightweight counters (CHPL_RT_MEM_COUNTERS).  These are called by the
+// allocation functions themselves rather than the hooks above, because
+// only they know how big a block will be considered when it is freed:
+// the exact size for arrays, the allocator's real size otherwise, or
+// 0 if the allocator can't tell us.
+//
+static inline
+void chpl_memhook_count_alloc(size_t bytes, size_t live,
+                              chpl_mem_descInt_t description) {
+  if (chpl_memCounters)
+    chpl_memcount_alloc(bytes, live, description);
+}
+
+
+static inline
+void chpl_memhook_count_free(size_t live) {
+  if (chpl_memCounters && live != 0)
+    chpl_memcount_free(live);
+}
+
 #ifdef __cplusplus
 } // end extern "C"
 #endif
@@ -74,6 +74,23 @@ void chpl_mem_exit(void);
 
 int chpl_mem_inited(void);
 
+//
+// Allocator control, for long-running programs that want to give
+// freed memory back to the system.  These are callable from Chapel.
+//   purge:    return unused dirty memory to the system now
+//   setDecay: set how long, in milliseconds, freed memory stays dirty
+//             (or, for the first argument only, in use but unneeded)
+//             before being returned; -1 means never, 0 immediately
+//   getStats: get the bytes the allocator has in active use and the
+//             bytes resident for it
+//   printStats: print those, per arena where the allocator has them
+// Each returns 0 on success, or -1 if the memory layer can't do it.
+//
+int chpl_mem_purge(void);
+int chpl_mem_setDecay(int64_t dirtyMs, int64_t muzzyMs);
+int chpl_mem_getStats(uint64_t* active, uint64_t* resident);
+int chpl_mem_printStats(void);
+
 extern void* chpl_gpu_memmove(void* dest, const void* src, size_t num);
 
 static inline
@@ -85,6 +102,9 @@ void* chpl_mem_allocMany(size_t number, size_t size,
   memAlloc = chpl_malloc(number*size);
   chpl_memhook_malloc_post(memAlloc, number, size, description,
                            lineno, filename);
+  if (memAlloc != NULL)
+    chpl_memhook_count_alloc(number*size, chpl_real_alloc_size(memAlloc),
+                             description);
   return memAlloc;
 }
 
@@ -103,6 +123,9 @@ void* chpl_mem_allocManyZero(size_t number, size_t size,
   memAlloc = chpl_calloc(number, size);
   chpl_memhook_malloc_post(memAlloc, number, size, description,
                            lineno, filename);
+  if (memAlloc != NULL)
+    chpl_memhook_count_alloc(number*size, chpl_real_alloc_size(memAlloc),
+                             description);
   return memAlloc;
 }
 
@@ -119,10 +142,13 @@ void* chpl_mem_realloc(void* memAlloc, size_t size,
                        int32_t lineno, int32_t filename) {
   void* newMemAlloc = NULL;
   intptr_t oldMemAlloc = (intptr_t) memAlloc;
+  size_t oldLive = (chpl_memCounters && memAlloc != NULL)
+                   ? chpl_real_alloc_size(memAlloc) : 0;
 
   chpl_memhook_realloc_pre(memAlloc, size, description,
                            lineno, filename);
   if (size == 0) {
+    chpl_memhook_count_free(oldLive);
     chpl_memhook_free_pre(memAlloc, 0, lineno, filename);
     chpl_free(memAlloc);
     return NULL;
@@ -130,6 +156,11 @@ void* chpl_mem_realloc(void* memAlloc, size_t size,
   newMemAlloc = chpl_realloc(memAlloc, size);
   chpl_memhook_realloc_post(newMemAlloc, oldMemAlloc,
                             size, description, lineno, filename);
+  if (newMemAlloc != NULL) {
+    chpl_memhook_count_free(oldLive);
+    chpl_memhook_count_alloc(size, chpl_real_alloc_size(newMemAlloc),
+                             description);
+  }
   return newMemAlloc;
 }
 
@@ -145,6 +176,9 @@ void* chpl_mem_memalign(size_t boundary, size_t size,
   chpl_memhook_malloc_pre(1, size, description, lineno, filename);
   memAlloc = chpl_memalign(boundary, size);
   chpl_memhook_malloc_post(memAlloc, 1, size, description, lineno, filename);
+  if (memAlloc != NULL)
+    chpl_memhook_count_alloc(size, chpl_real_alloc_size(memAlloc),
+                             description);
   return memAlloc;
 }
 
@@ -152,8 +186,10 @@ static inline
 void chpl_mem_free(void* memAlloc, int32_t lineno, int32_t filename) {
   // Use the real size of an allocation as the approximate size for memory
   // tracking so it can avoid grabbing a lock for allocations below a threshold
-  size_t approximateSize = CHPL_MEMHOOKS_ACTIVE ? chpl_real_alloc_size(memAlloc) : 0;
+  size_t approximateSize = (CHPL_MEMHOOKS_ACTIVE || chpl_memCounters)
+                           ? chpl_real_alloc_size(memAlloc) : 0;
   chpl_memhook_free_pre(memAlloc, approximateSize, lineno, filename);
+  chpl_memhook_count_free(approximateSize);
   chpl_free(memAlloc);
 }
 
@@ -196,6 +232,10 @@ void chpl_rt_free_c_string(c_string *s, int32_t lineno, int32_t filename)  {
 
 void chpl_mem_layerInit(void);
 void chpl_mem_layerExit(void);
+int chpl_mem_layerPurge(void);
+int chpl_mem_layerSetDecay(int64_t dirtyMs, int64_t muzzyMs);
+int chpl_mem_layerGetStats(uint64_t* active, uint64_t* resident);
+int chpl_mem_layerPrintStats(void);
 void* chpl_mem_layerAlloc(size_t, int32_t lineno, int32_t filename);
 void* chpl_mem_layerRealloc(void*, size_t, int32_t lineno, int32_t filename);
 void chpl_mem_layerFree(void*, int32_t lineno, int32_t filename);
@@ -0,0 +1,53 @@
+/*
+ * Copyright 2020-2026 Hewlett Packard Enterprise Development LP
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _chpl_perf_region_h_
+#define _chpl_perf_region_h_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Hardware-counter regions.
+//
+// With CHPL_RT_PERF_REGIONS set, code between chpl_perf_region_begin()
+// and chpl_perf_region_end() on a thread has its cycles, instructions
+// and last-level cache misses counted (with perf_event_open, on Linux)
+// along with its elapsed time, and the counts are added up by region
+// name.  Regions may nest, up to 16 deep on a thread; end closes the
+// innermost one.  At exit each locale prints a line per region, summed
+// over its threads.  DRAM traffic isn't something a thread can count
+// for itself, so it is estimated as a cache line per LLC miss.
+//
+// Without CHPL_RT_PERF_REGIONS, begin and end return right away.  Where
+// the counters can't be opened (no Linux, or perf_event_paranoid is
+// too strict) only time is recorded.
+//
+
+void chpl_perf_region_init(void);
+void chpl_perf_region_begin(const char* name);
+void chpl_perf_region_end(void);
+void chpl_perf_region_report(void);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
+
+#endif // _chpl_perf_region_h_
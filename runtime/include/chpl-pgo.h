@@ -0,0 +1,52 @@
+/*
+ * Copyright 2020-2026 Hewlett Packard Enterprise Development LP
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _chpl_pgo_h_
+#define _chpl_pgo_h_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Profile-guided optimization support.
+//
+// A program compiled with --profile-generate (and the LLVM back end)
+// carries LLVM's profile runtime, which writes the counters at exit.
+// By default every process would write the same default.profraw, so
+// instead each locale writes <prefix>-<locale>.profraw, where the
+// prefix is CHPL_RT_PGO_FILE (default "chpl-pgo").  The file name has
+// LLVM's %m pattern in it, so repeated training runs add their counts
+// to the same files rather than replacing them.  The files are merged
+// into one profile with
+//
+//   llvm-profdata merge -o prog.profdata chpl-pgo-*.profraw
+//
+// which is then passed to the compiler with --profile-use.  If
+// LLVM_PROFILE_FILE is set it is left to decide the names.  Programs
+// that aren't instrumented are not affected.
+//
+
+void chpl_pgo_init(void);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
+
+#endif // _chpl_pgo_h_
@@ -32,6 +32,11 @@ void chpl_privatization_init(void);
 
 void chpl_newPrivatizedClass(void*, int64_t);
 
+// Install n privatized objects at once: objs[i] gets pids[i]. This is for
+// installing a whole batch of them that arrived together, taking the lock
+// and growing the table only once.
+void chpl_newPrivatizedClasses(int64_t n, void** objs, const int64_t* pids);
+
 typedef struct chpl_privateObject_s {
   void* obj;
 } chpl_privateObject_t;
@@ -46,6 +51,11 @@ extern chpl_privateObject_t* chpl_privateObjects;
 
 void chpl_clearPrivatizedClass(int64_t);
 
+// Returns a pid whose object has been cleared, for the next privatized
+// object to use, or -1 if there isn't one. pids have to agree across
+// locales, so only the locale that hands out pids should call this.
+int64_t chpl_privatization_reusePid(void);
+
 int64_t chpl_numPrivatizedClasses(void);
 
 #ifdef __cplusplus
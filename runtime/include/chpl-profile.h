@@ -0,0 +1,52 @@
+/*
+ * Copyright 2020-2026 Hewlett Packard Enterprise Development LP
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _chpl_profile_h_
+#define _chpl_profile_h_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Sampling CPU profiler.
+//
+// Running with --profile (or CHPL_RT_PROFILE=true) samples the stacks
+// of whatever threads are using CPU, CHPL_RT_PROFILE_HZ times per
+// second of CPU time (default 100).  At exit each locale writes its
+// samples as folded stacks to <prefix>-<locale>.folded, where the
+// prefix is CHPL_RT_PROFILE_FILE (default "chpl-profile").  Each line
+// is a stack, outermost frame first and separated by ';', followed by
+// the number of samples that had it.  Chapel functions are shown by
+// their Chapel name and source position.  The files can be fed to
+// flamegraph.pl or speedscope as they are.
+//
+// Stacks are unwound with libunwind when the runtime is built with it;
+// without it, only the function that was running is known.  At most
+// CHPL_RT_PROFILE_MAX_SAMPLES samples (default 100000) are kept.
+//
+
+void chpl_profile_init(void);
+void chpl_profile_fini(void);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
+
+#endif // _chpl_profile_h_
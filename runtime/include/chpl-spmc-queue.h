@@ -0,0 +1,239 @@
+/*
+ * Copyright 2020-2026 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// A lock-free, chunked, single-producer/multi-consumer FIFO queue of
+// pointers.  One thread at a time may call chpl_spmc_queue_push_back();
+// any number may concurrently call chpl_spmc_queue_pop_front().
+//
+// Every element has a 64-bit position.  The producer publishes an
+// element by advancing the tail position, and a consumer claims one by
+// a compare-and-swap on the head position, so each element is popped
+// exactly once and in order.  Elements live in fixed-size chunks kept
+// on a list from oldest to newest.  Consumers count the elements they
+// have finished with in each chunk, and the producer recycles the
+// oldest chunk once all of its elements are done.  Chunks are never
+// returned to the allocator before the queue is destroyed, so a
+// consumer that is slow to find its chunk may see a recycled one but
+// never freed memory; it recognizes the right chunk by its base
+// position, which is unique over the life of the queue.
+//
+#ifndef _chpl_spmc_queue_h_
+#define _chpl_spmc_queue_h_
+
+#ifndef LAUNCHER
+
+#include <stddef.h>
+#include <stdint.h>
+#include "chpl-atomics.h"
+#include "chpl-mem.h"
+#include "chpl-mem-desc.h"
+#include "chpltypes.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CHPL_SPMC_QUEUE_CHUNK_SLOTS 256   // must be a power of 2
+
+typedef struct chpl_spmc_chunk_s {
+  chpl_atomic_uintptr_t next;           // struct chpl_spmc_chunk_s*
+  chpl_atomic_uint_least64_t base;      // position of slots[0]
+  chpl_atomic_uint_least64_t done;      // slots consumers are done with
+  void* slots[CHPL_SPMC_QUEUE_CHUNK_SLOTS];
+} chpl_spmc_chunk_t;
+
+typedef struct chpl_spmc_queue_s {
+  // Written by consumers.
+  chpl_atomic_uint_least64_t head;      // next position to pop
+  char pad0[64 - sizeof(chpl_atomic_uint_least64_t)];
+
+  // Written by the producer.
+  chpl_atomic_uint_least64_t tail;      // next position to push
+  chpl_atomic_uintptr_t first;          // oldest chunk in use
+  chpl_spmc_chunk_t* last;              // newest chunk in use
+  chpl_spmc_chunk_t* spare;             // recycled chunks, via next
+  chpl_mem_descInt_t desc;
+} chpl_spmc_queue_t;
+
+
+static inline
+chpl_spmc_chunk_t* chpl_spmc_queue_new_chunk(chpl_spmc_queue_t* q,
+                                             uint64_t base) {
+  chpl_spmc_chunk_t* c = q->spare;
+  if (c != NULL) {
+    q->spare = (chpl_spmc_chunk_t*) atomic_load_explicit_uintptr_t(
+                                      &c->next, chpl_memory_order_relaxed);
+  } else {
+    c = (chpl_spmc_chunk_t*) chpl_mem_alloc(sizeof(*c), q->desc, 0, 0);
+    atomic_init_uintptr_t(&c->next, (uintptr_t) NULL);
+    atomic_init_uint_least64_t(&c->base, base);
+    atomic_init_uint_least64_t(&c->done, 0);
+  }
+  atomic_store_explicit_uint_least64_t(&c->done, 0,
+                                       chpl_memory_order_relaxed);
+  atomic_store_explicit_uintptr_t(&c->next, (uintptr_t) NULL,
+                                  chpl_memory_order_relaxed);
+  atomic_store_explicit_uint_least64_t(&c->base, base,
+                                       chpl_memory_order_release);
+  return c;
+}
+
+
+static inline
+void chpl_spmc_queue_init(chpl_spmc_queue_t* q, chpl_mem_descInt_t desc) {
+  chpl_spmc_chunk_t* c;
+
+  q->desc = desc;
+  q->spare = NULL;
+  atomic_init_uint_least64_t(&q->head, 0);
+  atomic_init_uint_least64_t(&q->tail, 0);
+  c = chpl_spmc_queue_new_chunk(q, 0);
+  atomic_init_uintptr_t(&q->first, (uintptr_t) c);
+  q->last = c;
+}
+
+
+// Frees all chunks.  There must be no concurrent users.
+static inline
+void chpl_spmc_queue_destroy(chpl_spmc_queue_t* q) {
+  chpl_spmc_chunk_t* lists[2];
+
+  lists[0] = (chpl_spmc_chunk_t*) atomic_load_uintptr_t(&q->first);
+  lists[1] = q->spare;
+  for (int i = 0; i < 2; i++) {
+    chpl_spmc_chunk_t* c = lists[i];
+    while (c != NULL) {
+      chpl_spmc_chunk_t* next =
+        (chpl_spmc_chunk_t*) atomic_load_uintptr_t(&c->next);
+      chpl_mem_free(c, 0, 0);
+      c = next;
+    }
+  }
+  q->spare = NULL;
+  q->last = NULL;
+  atomic_store_uintptr_t(&q->first, (uintptr_t) NULL);
+}
+
+
+// Producer only.
+static inline
+void chpl_spmc_queue_push_back(chpl_spmc_queue_t* q, void* elt) {
+  uint64_t pos = atomic_load_explicit_uint_least64_t(
+                   &q->tail, chpl_memory_order_relaxed);
+  uint64_t slot = pos & (CHPL_SPMC_QUEUE_CHUNK_SLOTS - 1);
+  chpl_spmc_chunk_t* c = q->last;
+
+  if (pos > 0 && slot == 0) {
+    // The newest chunk is full.  Recycle any finished chunks at the
+    // front, then link a new one at the back.
+    chpl_spmc_chunk_t* f =
+      (chpl_spmc_chunk_t*) atomic_load_explicit_uintptr_t(
+                             &q->first, chpl_memory_order_relaxed);
+    while (f != c
+           && atomic_load_explicit_uint_least64_t(
+                &f->done, chpl_memory_order_acquire)
+              == CHPL_SPMC_QUEUE_CHUNK_SLOTS) {
+      chpl_spmc_chunk_t* next =
+        (chpl_spmc_chunk_t*) atomic_load_explicit_uintptr_t(
+                               &f->next, chpl_memory_order_relaxed);
+      atomic_store_explicit_uintptr_t(&q->first, (uintptr_t) next,
+                                      chpl_memory_order_release);
+      atomic_store_explicit_uintptr_t(&f->next, (uintptr_t) q->spare,
+                                      chpl_memory_order_relaxed);
+      q->spare = f;
+      f = next;
+    }
+
+    {
+      chpl_spmc_chunk_t* n = chpl_spmc_queue_new_chunk(q, pos);
+      atomic_store_explicit_uintptr_t(&c->next, (uintptr_t) n,
+                                      chpl_memory_order_release);
+      q->last = c = n;
+    }
+  }
+
+  c->slots[slot] = elt;
+  atomic_store_explicit_uint_least64_t(&q->tail, pos + 1,
+                                       chpl_memory_order_release);
+}
+
+
+// Any thread.  Returns NULL if the queue is empty.
+static inline
+void* chpl_spmc_queue_pop_front(chpl_spmc_queue_t* q) {
+  uint64_t pos = atomic_load_explicit_uint_least64_t(
+                   &q->head, chpl_memory_order_relaxed);
+  uint64_t base;
+  chpl_spmc_chunk_t* c;
+  void* elt;
+
+  // Claim a position.
+  do {
+    if (pos >= atomic_load_explicit_uint_least64_t(
+                 &q->tail, chpl_memory_order_acquire)) {
+      return NULL;
+    }
+  } while (!atomic_compare_exchange_weak_explicit_uint_least64_t(
+              &q->head, &pos, pos + 1,
+              chpl_memory_order_acquire, chpl_memory_order_relaxed));
+
+  // Find its chunk.  That chunk can't be recycled until we're done
+  // with it, but the ones before it can, so start over if we wander
+  // off the list.
+  base = pos & ~(uint64_t) (CHPL_SPMC_QUEUE_CHUNK_SLOTS - 1);
+  do {
+    c = (chpl_spmc_chunk_t*) atomic_load_explicit_uintptr_t(
+                               &q->first, chpl_memory_order_acquire);
+    while (c != NULL) {
+      uint64_t b = atomic_load_explicit_uint_least64_t(
+                     &c->base, chpl_memory_order_acquire);
+      if (b >= base)
+        break;
+      c = (chpl_spmc_chunk_t*) atomic_load_explicit_uintptr_t(
+                                 &c->next, chpl_memory_order_acquire);
+    }
+  } while (c == NULL
+           || atomic_load_explicit_uint_least64_t(
+                &c->base, chpl_memory_order_acquire) != base);
+
+  elt = c->slots[pos - base];
+  (void) atomic_fetch_add_explicit_uint_least64_t(&c->done, 1,
+                                                  chpl_memory_order_release);
+  return elt;
+}
+
+
+// Any thread.  A snapshot; may be stale by the time it returns.
+static inline
+chpl_bool chpl_spmc_queue_is_empty(chpl_spmc_queue_t* q) {
+  return atomic_load_explicit_uint_least64_t(&q->head,
+                                             chpl_memory_order_relaxed)
+         >= atomic_load_explicit_uint_least64_t(&q->tail,
+                                                chpl_memory_order_acquire);
+}
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
+
+#endif // LAUNCHER
+
+#endif // _chpl_spmc_queue_h_
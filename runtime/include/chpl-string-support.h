@@ -81,9 +81,18 @@ char* chpl_glom_strings(int numstrings, ...);
 chpl_bool string_contains(c_string x, c_string y);
 c_string string_copy(c_string x, int32_t lineno, int32_t filename);
 c_string string_concat(c_string x, c_string y, int32_t lineno, int32_t filename);
+c_string string_concat_many(int n, c_string* xs, int32_t lineno, int32_t filename);
 int string_index_of(c_string x, c_string y);
 c_string string_index(c_string x, int i, int32_t lineno, int32_t filename);
 c_string string_select(c_string x, int low, int high, int stride, int32_t lineno, int32_t filename);
+void string_select_into(char* result, c_string x, int low, int high, int stride);
+
+// The number of bytes string_select selects, for 1 <= low <= high.
+static inline
+int string_select_size(int low, int high, int stride) {
+  int abs_stride = stride > 0 ? stride : -stride;
+  return (high - low) / abs_stride + 1;
+}
 
 #ifdef __cplusplus
 }
@@ -38,7 +38,7 @@ struct chpl_chpl____wide_chpl_string_s;
 
 chpl_string chpl_wide_string_copy(struct chpl_chpl____wide_chpl_string_s* x, int32_t lineno, int32_t filename);
 
-#define CHPL_SHORT_STRING_SIZE 8
+#define CHPL_SHORT_STRING_SIZE 16
 
 typedef struct chpl__inPlaceBuffer_t {
   uint8_t data[CHPL_SHORT_STRING_SIZE];
@@ -47,6 +47,20 @@ typedef struct chpl__inPlaceBuffer_t {
 uint8_t* chpl__getInPlaceBufferData(chpl__inPlaceBuffer* buf);
 uint8_t* chpl__getInPlaceBufferDataForWrite(chpl__inPlaceBuffer* buf);
 
+// Small-string versions of the string copying helpers.  When the result
+// and its terminating NUL fit in 'buf' they are written there and nothing
+// is allocated; otherwise the result is allocated as usual.  The result
+// should only be freed when chpl__isInPlaceBufferData(buf, result) is false.
+static inline
+chpl_bool chpl__isInPlaceBufferData(chpl__inPlaceBuffer* buf, chpl_string s) {
+  return s == (chpl_string) buf->data;
+}
+
+chpl_string chpl_string_copy_inplace(chpl__inPlaceBuffer* buf, chpl_string x, int32_t lineno, int32_t filename);
+chpl_string chpl_string_concat_inplace(chpl__inPlaceBuffer* buf, chpl_string x, chpl_string y, int32_t lineno, int32_t filename);
+chpl_string chpl_string_select_inplace(chpl__inPlaceBuffer* buf, chpl_string x, int low, int high, int stride, int32_t lineno, int32_t filename);
+chpl_string chpl_wide_string_copy_inplace(chpl__inPlaceBuffer* buf, struct chpl_chpl____wide_chpl_string_s* x, int32_t lineno, int32_t filename);
+
 #ifdef __cplusplus
 }
 #endif
@@ -39,6 +39,7 @@ extern "C" {
 // chpl_task_getRequestedSubloc from here (well, actually chpl-tasks-impl-fns)
 typedef struct {
   void** streams;
+  struct chpl_gpu_graph_task_s* graph;  // see chpl-gpu-graph.h
 } chpl_gpu_taskPrvData_t;
 #endif
 
@@ -80,6 +81,9 @@ typedef struct chpl_task_bundle {
   chpl_fn_p requested_fn;
   chpl_taskID_t id;
   chpl_task_infoChapel_t infoChapel;
+  chpl_bool lightweight;        // body can't block; set by caller
+  chpl_bool argsInPlace;        // caller keeps bundle while task runs; ditto
+  uint64_t createTime;          // for task profiling; 0 when not profiling
   uint64_t payload[0];
 } chpl_task_bundle_t;
 
@@ -192,6 +196,23 @@ void chpl_task_addTask(
          int,                // line at which function begins
          int32_t);           // name of file containing function
 
+//
+// Bulk task creation.  chpl_task_addTasks adds n sibling tasks that
+// all call the same function, as if chpl_task_addTask were called on
+// each of n argument bundles.  The bundles are contiguous in memory,
+// each one arg_size bytes long, so the caller can build them all with
+// a single allocation.  Tasking layers can then amortize the per-task
+// setup and any locking across the whole batch.
+//
+void chpl_task_addTasks(
+         int,                // number of tasks
+         chpl_fn_int_t,      // function to call for each task
+         chpl_task_bundle_t*,// the n arguments, arg_size bytes apart
+         size_t,             // length of each argument
+         c_sublocid_t,       // desired sublocale
+         int,                // line at which function begins
+         int32_t);           // name of file containing function
+
 //
 // Call a chpl_ftable[] function in a task.
 //
@@ -293,6 +314,15 @@ void chpl_task_yield(void);
 //
 void chpl_task_sleep(double);
 
+//
+// Wait until at least one of the file descriptors is ready, like
+// poll() with no timeout, but let other tasks run in the meantime.
+// Returns what poll() would: the number of descriptors with revents
+// set, or -1 with errno set.
+//
+struct pollfd;
+int chpl_task_waitFds(struct pollfd* fds, int nfds);
+
 //
 // Get the current task's runtime-related per-task information.
 //
@@ -315,6 +345,26 @@ chpl_task_infoChapel_t* chpl_task_getInfoChapelInBundle(chpl_task_bundle_t* b)
   return &b->infoChapel;
 }
 
+// Say whether the task body provably cannot block, so that the
+// tasking layer may run it without a stack of its own.  Tasking
+// layers are free to ignore this.
+static inline
+void chpl_task_setLightweightInBundle(chpl_task_bundle_t* b, chpl_bool lw)
+{
+  b->lightweight = lw;
+}
+
+// Say whether the caller keeps the bundle alive and unchanged until the
+// task body returns, so that the tasking layer may use it where it is
+// instead of copying it.  The header may be read after the body returns,
+// so a layer that does this must copy the header first.  Tasking layers
+// are free to ignore this.
+static inline
+void chpl_task_setArgsInPlaceInBundle(chpl_task_bundle_t* b, chpl_bool ip)
+{
+  b->argsInPlace = ip;
+}
+
 
 //
 // Returns the maximum width of parallelism the tasking layer expects
@@ -405,6 +455,17 @@ uint32_t chpl_task_canMigrateThreads(void) {
 //
 void chpl_task_warnNumThreadsPerLocale(const char*);
 
+//
+// Call fn(arg, i) for each i in [0, n), using up to chpl_task_getMaxPar()
+// tasks including the calling one, and return when all calls are done.
+// This is for runtime and module C code that wants to spread work of its
+// own over tasks.  The calling task claims pieces like the others do,
+// so it only ever waits for pieces that are already running.  It is
+// common to all tasking implementations and so is implemented in
+// runtime/src/chpl-tasks.c.
+//
+void chpl_task_runPieces(int n, void (*fn)(void* arg, int i), void* arg);
+
 //
 // This gets any per-locale thread count specified in the environment.
 // It is common to all tasking implementations and so is implemented
@@ -96,6 +96,17 @@ int chpl_topo_bindLogAccCPUs(void);
 //
 int chpl_topo_getNumNumaDomains(void);
 
+//
+// Describe the level-"level" (1 for L1, and so on) data or unified cache
+// used by this locale's PUs: its size and line size in bytes, and how
+// many PUs share one of them.
+//
+// Returns 0 on success, 1 if there is no such cache or it's not known.
+// Sizes not known are set to 0.
+//
+int chpl_topo_getCacheInfo(int level, size_t* size, size_t* lineSize,
+                           int* sharingPUs);
+
 //
 // set the sublocale where the current thread is running
 //
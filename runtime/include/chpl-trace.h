@@ -0,0 +1,64 @@
+/*
+ * Copyright 2020-2026 Hewlett Packard Enterprise Development LP
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _chpl_trace_h_
+#define _chpl_trace_h_
+
+#include <stdint.h>
+#include "chpltypes.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Trace-event output, for viewing with Perfetto or chrome://tracing.
+//
+// With CHPL_RT_CHROME_TRACE=<prefix> set, each locale writes
+// <prefix>-<locale>.json.  The task and comm callbacks are used to
+// record task bodies as spans on the worker threads that ran them, and
+// puts, gets and executeOns as short slices with flow arrows to the
+// locale they went to.  GPU kernels, timed with events on their
+// streams, are spans on a track per device.
+//
+// Locale 0's file opens the JSON array and nobody closes it (the
+// format allows that), so the files for all locales can simply be
+// concatenated, locale 0 first:
+//
+//   cat <prefix>-*.json > all.json
+//
+// Times are microseconds of CLOCK_REALTIME, so locales line up as well
+// as their clocks do.
+//
+
+extern chpl_bool chpl_trace_enabled;
+
+void chpl_trace_init(void);
+void chpl_trace_fini(void);
+
+// A kernel that started at the given chpl_hrtimer_now() time and ran
+// for ms milliseconds.
+void chpl_trace_gpu_kernel(int dev, int ln, int32_t fn,
+                           double start, double ms);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
+
+#endif // _chpl_trace_h_
@@ -0,0 +1,122 @@
+/*
+ * Copyright 2020-2026 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Visual Debug binary record format
+//
+// This is shared with tools/chplvis, so it must not depend on anything
+// else in the runtime.
+//
+// A binary data file starts with the same text "ChplVdebug:" line as a
+// text one, with " binary" at the end.  Everything after that line is
+// a sequence of records, each one a chpl_vdebug_rec_hdr_t followed by
+// len bytes of payload.  Records are written in the byte order of the
+// machine that wrote them; chplvis reads them on the same kind of
+// machine.  Rare records (file and function tables, tags, pauses, the
+// end record, and so on) are VDEBUG_REC_TEXT, holding exactly the line
+// the text format would have, including the newline.  The per-event
+// records have fixed layouts.  Within a stretch between two tags,
+// event records from different threads can come in any order, so
+// readers must order them by time.
+//
+
+#ifndef _chpl_visual_debug_format_h_
+#define _chpl_visual_debug_format_h_
+
+#include <stdint.h>
+
+#define VDEBUG_BINARY_MARK " binary"
+
+typedef enum {
+  VDEBUG_REC_TEXT = 0,
+  VDEBUG_REC_TASK,          // "task"
+  VDEBUG_REC_BTASK,         // "Btask"
+  VDEBUG_REC_ETASK,         // "Etask"
+  VDEBUG_REC_COMM,          // sub is a chpl_vdebug_comm_kind_t
+  VDEBUG_REC_FORK,          // sub is a chpl_vdebug_fork_kind_t
+} chpl_vdebug_rec_kind_t;
+
+typedef enum {
+  VDEBUG_COMM_NB_PUT = 0,   // "nb_put"
+  VDEBUG_COMM_NB_GET,       // "nb_get"
+  VDEBUG_COMM_PUT,          // "put"
+  VDEBUG_COMM_GET,          // "get"
+  VDEBUG_COMM_ST_PUT,       // "st_put"
+  VDEBUG_COMM_ST_GET,       // "st_get"
+} chpl_vdebug_comm_kind_t;
+
+typedef enum {
+  VDEBUG_FORK = 0,          // "fork"
+  VDEBUG_FORK_NB,           // "fork_nb"
+  VDEBUG_FORK_FAST,         // "f_fork"
+} chpl_vdebug_fork_kind_t;
+
+typedef struct {
+  uint8_t  kind;            // chpl_vdebug_rec_kind_t
+  uint8_t  sub;
+  uint16_t len;             // bytes of payload that follow
+  int32_t  usec;            // event time, as from gettimeofday()
+  int64_t  sec;
+} chpl_vdebug_rec_hdr_t;
+
+typedef struct {
+  int32_t nid;
+  int32_t isExecuteOn;
+  int64_t taskId;
+  int64_t parentTaskId;
+  int32_t lineno;
+  int32_t fileno;
+  int32_t fid;
+  int32_t pad;
+} chpl_vdebug_rec_task_t;
+
+typedef struct {            // Btask and Etask
+  int32_t nid;
+  int32_t pad;
+  int64_t taskId;
+} chpl_vdebug_rec_task_state_t;
+
+typedef struct {
+  int32_t  nid;
+  int32_t  rnid;
+  int64_t  taskId;
+  uint64_t addr;
+  uint64_t raddr;
+  int64_t  elemSize;
+  int64_t  length;
+  int32_t  commID;
+  int32_t  lineno;
+  int32_t  fileno;
+  int32_t  pad;
+} chpl_vdebug_rec_comm_t;
+
+typedef struct {
+  int32_t  nid;
+  int32_t  rnid;
+  int32_t  subloc;
+  int32_t  fid;
+  uint64_t arg;
+  int64_t  argSize;
+  int64_t  taskId;
+  int32_t  lineno;
+  int32_t  fileno;
+} chpl_vdebug_rec_fork_t;
+
+#endif
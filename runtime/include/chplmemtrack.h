@@ -37,6 +37,13 @@ extern "C" {
 extern int chpl_memTrack;
 extern int chpl_verbose_mem;      // set via startVerboseMem
 
+// Mean bytes between allocation samples, or 0 if not sampling
+// (CHPL_RT_MEM_SAMPLE).
+extern size_t chpl_memSample;
+
+// Lightweight per-descriptor counters activated (CHPL_RT_MEM_COUNTERS)?
+extern int chpl_memCounters;
+
 ///// These entry points support the memory tracking functions provided by
 //    MemTracking.chpl, and may also be called directly from user code (or from
 //    a debugger).
@@ -51,6 +58,8 @@ void chpl_printMemAllocs(int64_t threshold,
                          int32_t lineno, int32_t filename);
 void chpl_printMemAllocsByDesc(c_string descString, int64_t threshold,
                                int32_t lineno, int32_t filename);
+void chpl_printMemCounters(int32_t lineno, int32_t filename);
+uint64_t chpl_memCountersHighWater(int32_t lineno, int32_t filename);
 void chpl_startVerboseMem(void);
 void chpl_stopVerboseMem(void);
 void chpl_startVerboseMemHere(void);
@@ -77,6 +86,18 @@ void chpl_track_realloc_post(void* newMemAlloc,
                              chpl_mem_descInt_t description,
                              int32_t lineno, int32_t filename);
 
+///// Sampling memory profiler: counts down allocated bytes and records
+//    an allocation when the count runs out.
+void chpl_memsample_malloc(size_t bytes, chpl_mem_descInt_t description,
+                           int32_t lineno, int32_t filename);
+
+///// Lightweight counters: 'bytes' is what was asked for, 'live' is
+//    what will be reported back to chpl_memcount_free() when it is
+//    freed, which is 0 if that won't be known.
+void chpl_memcount_alloc(size_t bytes, size_t live,
+                         chpl_mem_descInt_t description);
+void chpl_memcount_free(size_t live);
+
 static inline void chpl_track_gen_subloc_info(char* subloc_info,
                                               c_sublocid_t subloc) {
 #ifdef HAS_GPU_LOCALE
@@ -23,7 +23,9 @@
 
 #include "chpltypes.h"  // For _real64.
 
+#include <stdint.h>
 #include <sys/time.h>   // For struct timeval.
+#include <time.h>       // For clock_gettime().
 
 #ifdef __cplusplus
 extern "C" {
@@ -41,6 +43,45 @@ void chpl_timevalue_parts(_timevalue t, int32_t* seconds, int32_t* minutes, int3
 
 _real64 chpl_now_time(void);
 
+//
+// High-resolution monotonic timer.
+//
+// chpl_hrtimer_ticks() reads the cycle counter where there is a usable
+// one (an invariant TSC on x86, cntvct_el0 on aarch64), and otherwise
+// CLOCK_MONOTONIC in nanoseconds.  chpl_hrtimer_init() picks the
+// source and measures the tick rate against CLOCK_MONOTONIC; it is
+// called at the start of runtime init.  CHPL_RT_HRTIMER_CYCLES=false
+// forces CLOCK_MONOTONIC.
+//
+// chpl_hrtimer_now() is seconds since chpl_hrtimer_init().  Times from
+// different locales can be put on one timeline by adding each locale's
+// chpl_hrtimer_offset(), the CLOCK_REALTIME seconds at which its timer
+// started, so they line up as well as the nodes' clocks do.
+//
+extern chpl_bool chpl_hrtimer_useCycles;
+
+static inline
+uint64_t chpl_hrtimer_ticks(void) {
+  if (chpl_hrtimer_useCycles) {
+#if defined(__x86_64__)
+    return __builtin_ia32_rdtsc();
+#elif defined(__aarch64__)
+    uint64_t t;
+    __asm__ __volatile__("mrs %0, cntvct_el0" : "=r" (t));
+    return t;
+#endif
+  }
+
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+void chpl_hrtimer_init(void);
+double chpl_hrtimer_ticks_per_sec(void);
+double chpl_hrtimer_now(void);
+double chpl_hrtimer_offset(void);
+
 #endif // LAUNCHER
 
 #ifdef __cplusplus
@@ -37,4 +37,28 @@ void chpl_comm_impl_regMemHeapInfo(void** start_p, size_t* size_p);
 }
 #endif
 
+//
+// Network atomic operations.
+//
+#include "chpl-comm-native-atomics.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//
+// Unordered AMOs are done non-blocking; these hooks complete them.
+//
+#define CHPL_COMM_IMPL_UNORDERED_TASK_FENCE() \
+        chpl_comm_impl_unordered_task_fence()
+void chpl_comm_impl_unordered_task_fence(void);
+
+#define CHPL_COMM_IMPL_TASK_END() \
+        chpl_comm_impl_task_end()
+void chpl_comm_impl_task_end(void);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif // _chpl_comm_impl_h_
@@ -37,6 +37,15 @@ void chpl_comm_impl_regMemHeapInfo(void** start_p, size_t* size_p);
         chpl_comm_impl_regMemHeapPageSize()
 size_t chpl_comm_impl_regMemHeapPageSize(void);
 
+#define CHPL_COMM_IMPL_REG_MEM_FREE_NOTIFY(p, size) \
+        chpl_comm_impl_regMemFreeNotify(p, size)
+void chpl_comm_impl_regMemFreeNotify(void* p, size_t size);
+
+#define CHPL_COMM_IMPL_REG_MEM_DEVICE(addr, size, node, raddr) \
+        chpl_comm_impl_regMemDevice(addr, size, node, raddr)
+chpl_bool chpl_comm_impl_regMemDevice(void* addr, size_t size,
+                                      c_nodeid_t node, void* raddr);
+
 #ifdef __cplusplus
 }
 #endif
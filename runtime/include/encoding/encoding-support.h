@@ -31,6 +31,14 @@
 
 #include "utf8-decoder.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define CHPL_ENC_ASCII_SSE2 1
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define CHPL_ENC_ASCII_NEON 1
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -77,6 +85,77 @@ uint32_t chpl_enc_check_escape(const char* start, const char* end) {
  *
  * :returns: 0 if successful, -1 if illegal byte sequence
  */
+/* Returns the number of leading bytes of buf that are ASCII, checking
+   16 bytes at a time where the machine has vectors for it and a word at
+   a time otherwise.
+ */
+static inline
+ssize_t chpl_enc_ascii_prefix_len(const char* buf, ssize_t buflen)
+{
+  const unsigned char* p = (const unsigned char*) buf;
+  ssize_t i = 0;
+
+#if defined(CHPL_ENC_ASCII_SSE2)
+  for( ; i + 16 <= buflen; i += 16 ) {
+    int mask = _mm_movemask_epi8(_mm_loadu_si128((const __m128i*) (p + i)));
+    if( mask != 0 ) {
+      while( !(p[i] & 0x80) ) i++;
+      return i;
+    }
+  }
+#elif defined(CHPL_ENC_ASCII_NEON)
+  for( ; i + 16 <= buflen; i += 16 ) {
+    if( vmaxvq_u8(vld1q_u8(p + i)) & 0x80 ) break;
+  }
+#endif
+  for( ; i + 8 <= buflen; i += 8 ) {
+    uint64_t word;
+    memcpy(&word, p + i, sizeof(word));
+    if( word & UINT64_C(0x8080808080808080) ) break;
+  }
+  for( ; i < buflen; i++ ) {
+    if( p[i] & 0x80 ) break;
+  }
+  return i;
+}
+
+/* Checks the multi-byte UTF-8 sequence that starts at buf, whose first
+   byte is >= 0x80. Returns its length (2 to 4), or 0 if it is invalid
+   or doesn't fit in buflen. This accepts exactly what
+   chpl_enc_utf8_decode does; with allow_escape, it also accepts the
+   escaped bytes U+DC80 to U+DCFF like chpl_enc_check_escape.
+ */
+static inline
+int chpl_enc_utf8_seq_len(const char* buf, ssize_t buflen, bool allow_escape)
+{
+  const unsigned char* p = (const unsigned char*) buf;
+  unsigned char c = p[0];
+
+  if( c < 0xc2 ) {
+    return 0; // a continuation byte or an overlong 2-byte sequence
+  } else if( c < 0xe0 ) {
+    if( buflen < 2 || (p[1] & 0xc0) != 0x80 ) return 0;
+    return 2;
+  } else if( c < 0xf0 ) {
+    if( buflen < 3 || (p[1] & 0xc0) != 0x80 || (p[2] & 0xc0) != 0x80 )
+      return 0;
+    if( c == 0xe0 && p[1] < 0xa0 ) return 0; // overlong
+    if( c == 0xed && p[1] >= 0xa0 ) {
+      // a surrogate; only the escapes are OK
+      if( !allow_escape || (p[1] != 0xb2 && p[1] != 0xb3) ) return 0;
+    }
+    return 3;
+  } else if( c < 0xf5 ) {
+    if( buflen < 4 || (p[1] & 0xc0) != 0x80 || (p[2] & 0xc0) != 0x80 ||
+        (p[3] & 0xc0) != 0x80 )
+      return 0;
+    if( c == 0xf0 && p[1] < 0x90 ) return 0; // overlong
+    if( c == 0xf4 && p[1] >= 0x90 ) return 0; // past U+10FFFF
+    return 4;
+  }
+  return 0;
+}
+
 static inline
 int chpl_enc_decode_char_buf_utf8(int32_t* CHPL_ENC_RESTRICT chr,
                                   int* CHPL_ENC_RESTRICT nbytes,
@@ -210,21 +289,27 @@ int chpl_enc_decode_char_buf_wctype(int32_t* CHPL_ENC_RESTRICT chr,
  */
 static inline
 int chpl_enc_validate_buf(const char *buf, ssize_t buflen, int64_t *num_cp) {
-  int32_t cp;
-  int nbytes;
+  ssize_t offset = 0;
+  int64_t ncp = 0;
 
-  int offset = 0;
   *num_cp = 0;
   while (offset<buflen) {
-    // you can create a chapel string with a codepoint that represents an
-    // escaped byte, so the last argument is true
-    if (chpl_enc_decode_char_buf_utf8(&cp, &nbytes, buf+offset,
-                                      buflen-offset, true) != 0) {
-      return -1;  // invalid : return EILSEQ
+    // Skip runs of ASCII in bulk, then check one multi-byte sequence.
+    ssize_t n = chpl_enc_ascii_prefix_len(buf+offset, buflen-offset);
+    offset += n;
+    ncp += n;
+    if (offset<buflen) {
+      // you can create a chapel string with a codepoint that represents an
+      // escaped byte, so the last argument is true
+      int nbytes = chpl_enc_utf8_seq_len(buf+offset, buflen-offset, true);
+      if (nbytes == 0) {
+        return -1;  // invalid : return EILSEQ
+      }
+      offset += nbytes;
+      ncp += 1;
     }
-    offset += nbytes;
-    *num_cp += 1;
   }
+  *num_cp = ncp;
   return 0;  // valid
 }
 
@@ -45,5 +45,48 @@
   MACRO(chpl_kind, _real32)   \
   MACRO(chpl_kind, _real64);
 
+// Finishing several reductions with a single kernel (see
+// chpl_gpu_impl_fused_reduce). Each reduction variable's buffer holds a
+// partial result per block of the kernel that reduced into it, and the
+// final pass leaves the result in its first element.
+//
+// This file has no include guard (the macros above are fine to see twice),
+// so the types get one of their own.
+#ifndef CHPL_GPU_FUSED_REDUCE_MAX
+#define CHPL_GPU_FUSED_REDUCE_MAX 16
+
+typedef enum {
+  CHPL_GPU_REDUCE_OP_sum,
+  CHPL_GPU_REDUCE_OP_min,
+  CHPL_GPU_REDUCE_OP_max,
+} chpl_gpu_reduce_op_t;
+
+typedef enum {
+  CHPL_GPU_REDUCE_TYPE_chpl_bool,
+  CHPL_GPU_REDUCE_TYPE_int8_t,
+  CHPL_GPU_REDUCE_TYPE_int16_t,
+  CHPL_GPU_REDUCE_TYPE_int32_t,
+  CHPL_GPU_REDUCE_TYPE_int64_t,
+  CHPL_GPU_REDUCE_TYPE_uint8_t,
+  CHPL_GPU_REDUCE_TYPE_uint16_t,
+  CHPL_GPU_REDUCE_TYPE_uint32_t,
+  CHPL_GPU_REDUCE_TYPE_uint64_t,
+  CHPL_GPU_REDUCE_TYPE__real32,
+  CHPL_GPU_REDUCE_TYPE__real64,
+} chpl_gpu_reduce_type_t;
+
+typedef struct {
+  chpl_gpu_reduce_op_t op;
+  chpl_gpu_reduce_type_t type;
+  void* data;
+} chpl_gpu_fused_reduce_var_t;
+
+// passed to the kernel by value
+typedef struct {
+  int n_vars;
+  chpl_gpu_fused_reduce_var_t vars[CHPL_GPU_FUSED_REDUCE_MAX];
+} chpl_gpu_fused_reduce_t;
+#endif // CHPL_GPU_FUSED_REDUCE_MAX
+
 #endif // HAS_GPU_LOCALE
 
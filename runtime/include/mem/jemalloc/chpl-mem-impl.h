@@ -26,6 +26,9 @@
 
 #include "jemalloc/jemalloc.h"
 
+#include "chpl-thread-local-storage.h"
+#include "chpltypes.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -47,6 +50,15 @@ extern "C" {
 
 
 #define MALLOCX_NO_FLAGS 0
+
+// With per-NUMA-domain arenas (CHPL_RT_NUMA_ARENAS), each thread is
+// moved to an arena for its own domain the first time it allocates.
+// The thread state is 0 until then, 1 if the thread has no single
+// domain, and 2 + the domain otherwise.
+extern chpl_bool chpl_je_numa_arenas;
+extern CHPL_TLS_DECL(intptr_t, chpl_je_thread_arena_state);
+void chpl_je_bind_thread_arena(void);
+
 // Determine which arena to use. For large allocations (32 MiB) use a dedicated
 // arena to reduce fragmentation
 extern unsigned CHPL_JE_LG_ARENA;
@@ -54,6 +66,10 @@ static inline int CHPL_JE_MALLOCX_ARENA_FLAG(size_t size) {
   if (size >= ((size_t) 32 << 20)) {
     return MALLOCX_ARENA(CHPL_JE_LG_ARENA);
   }
+  if (chpl_je_numa_arenas
+      && (intptr_t) CHPL_TLS_GET(chpl_je_thread_arena_state) == 0) {
+    chpl_je_bind_thread_arena();
+  }
   return MALLOCX_NO_FLAGS;
 }
 
@@ -25,24 +25,45 @@
 
 #include <mimalloc.h>
 
+#include "chpl-thread-local-storage.h"
+#include "chpltypes.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// With per-NUMA-domain heaps (CHPL_RT_NUMA_ARENAS), each thread gets a
+// mimalloc heap in its own domain's arena the first time it allocates.
+// The thread state is 0 until then, 1 while that is in progress, and
+// 2 + the domain afterward.
+extern chpl_bool chpl_mi_numa_heaps;
+extern CHPL_TLS_DECL(intptr_t, chpl_mi_thread_heap_state);
+void chpl_mi_bind_thread_heap(void);
+
+static inline void chpl_mi_check_thread_heap(void) {
+  if (chpl_mi_numa_heaps
+      && (intptr_t) CHPL_TLS_GET(chpl_mi_thread_heap_state) == 0) {
+    chpl_mi_bind_thread_heap();
+  }
+}
+
 static inline void* chpl_calloc(size_t n, size_t size) {
+  chpl_mi_check_thread_heap();
   return mi_calloc(n, size);
 }
 
 static inline void* chpl_malloc(size_t size) {
+  chpl_mi_check_thread_heap();
   return mi_malloc(size);
 }
 
 static inline void* chpl_memalign(size_t boundary, size_t size) {
+  chpl_mi_check_thread_heap();
   return mi_memalign(boundary, size);
 }
 
 static inline void* chpl_realloc(void* ptr, size_t size) {
+  chpl_mi_check_thread_heap();
   return mi_realloc(ptr, size);
 }
 
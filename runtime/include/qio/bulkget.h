@@ -37,6 +37,14 @@ extern "C" {
 // under normal program flow.
 qbytes_t* bulk_get_bytes(int64_t src_locale, qbytes_t* src_addr);
 
+// Transfers bigger than this are split up so that several pieces are
+// in flight at once.
+extern ssize_t qio_bulk_xfer_chunk;
+
+// Fill [start, end) of buf from src_len bytes at src_addr on src_locale.
+qioerr bulk_get_buffer(int64_t src_locale, void* src_addr, int64_t src_len,
+                       qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end);
+
 qioerr bulk_put_buffer(int64_t dst_locale, void* dst_addr, int64_t dst_len,
                       qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end);
 
@@ -102,6 +102,16 @@ extern "C" {
 // how large is an iobuf?
 extern size_t qbytes_iobuf_size;
 
+// File offsets, lengths, and memory for O_DIRECT transfers are aligned
+// to this (it covers both 512-byte and 4k-sector devices).
+#define QIO_DIRECT_ALIGN 4096
+
+// how many direct I/O buffers to keep around for reuse
+extern size_t qbytes_direct_pool_max;
+
+// how many freed iobufs each thread keeps for reuse (at most 16)
+extern size_t qbytes_iobuf_pool_max;
+
 struct qbytes_s;
 
 // a free function
@@ -158,11 +168,17 @@ void qbytes_free_null(qbytes_t* b);
 void qbytes_free_munmap(qbytes_t* b);
 // free the data
 void qbytes_free_qio_free(qbytes_t* b);
+// return the data to the direct I/O buffer pool
+void qbytes_free_direct_iobuf(qbytes_t* b);
 
 void _qbytes_init_generic(qbytes_t* ret, void* give_data, int64_t len, qbytes_free_t free_function);
 qioerr qbytes_create_generic(qbytes_t** out, void* give_data, int64_t len, qbytes_free_t free_function);
 qioerr _qbytes_init_iobuf(qbytes_t* ret);
 qioerr qbytes_create_iobuf(qbytes_t** out);
+// Like qbytes_create_iobuf, but the data is aligned for direct I/O,
+// its length is a multiple of QIO_DIRECT_ALIGN, and it comes from
+// (and returns to) a pool of such buffers.
+qioerr qbytes_create_direct_iobuf(qbytes_t** out);
 qioerr _qbytes_init_calloc(qbytes_t* ret, int64_t len);
 
 // The caller is responsible for calling qbytes_release on the return value.
@@ -24,6 +24,7 @@
 #include "sys_basic.h"
 #include "bswap.h"
 #include "qbuffer.h"
+#include "chpl-external-array.h"
 #include "sys.h"
 #include "qio_style.h"
 #include "qio_error.h"
@@ -181,6 +182,9 @@ extern "C" {
 extern ssize_t qio_too_small_for_default_mmap;
 extern ssize_t qio_too_large_for_default_mmap;
 extern ssize_t qio_mmap_chunk_iobufs;
+extern ssize_t qio_uring_readahead_iobufs;
+extern int qio_uring_default;
+extern ssize_t qio_parallel_region_min;
 
 /* Wrap system calls readv, writev, preadv, pwritev
  * to take a buffer.
@@ -228,6 +232,11 @@ char* qio_chtype_to_string(qio_chtype_t type);
      -- noreuse -- pread/pwrite
      -- cached -- mmap for reads and writes
      -- force_readwrite
+     -- uring -- like pread/pwrite, but buffer fills and flushes are
+                 split into io_uring requests that run concurrently.
+                 Chosen by default in place of pread/pwrite when
+                 CHPL_RT_QIO_URING is set.  Falls back to pread/pwrite
+                 when the kernel has no io_uring.
  */
 
 #define QIO_HINT_AFTERCHTYPE 0x0010
@@ -238,13 +247,14 @@ typedef enum {
   QIO_METHOD_FREADFWRITE = 3*QIO_HINT_AFTERCHTYPE,
   QIO_METHOD_MMAP = 4*QIO_HINT_AFTERCHTYPE,
   QIO_METHOD_MEMORY = 5*QIO_HINT_AFTERCHTYPE,
+  QIO_METHOD_URING = 6*QIO_HINT_AFTERCHTYPE,
   //QIO_METHOD_LIBEVENT,
 } qio_method_t;
 #define QIO_METHODMASK 0x00f0
 #define QIO_HINT_AFTERMETHOD 0x0100
 #define QIO_METHOD_DEFAULT 0
 #define QIO_MIN_METHOD QIO_METHOD_READWRITE
-#define QIO_MAX_METHOD QIO_METHOD_MEMORY
+#define QIO_MAX_METHOD QIO_METHOD_URING
 
 enum {
   QIO_HINT_RANDOM       = QIO_HINT_AFTERMETHOD,
@@ -254,20 +264,25 @@ enum {
   QIO_HINT_CACHED       = QIO_HINT_BANDWIDTH<<1,
   QIO_HINT_PARALLEL     = QIO_HINT_CACHED<<1,
   QIO_HINT_DIRECT       = QIO_HINT_PARALLEL<<1,
-     // note -- if DIRECT is set, you must do aligned I/O;
-     // offset, request size must be 512-byte aligned, and
-     // user buffer must be page-aligned. This should more or
-     // less work the way you expect for a buffered channel,
-     // but you'll have to round out all files to a multiple of 512
-     // bytes. This library could help by turning off O_DIRECT when
-     // encountering improper alignment, but the linux open man page
-     // says:
+     // note -- if DIRECT is set, the file gets a second descriptor
+     // opened with O_DIRECT (file->direct_fd). Buffered channels
+     // allocate their buffers so that memory is aligned the same way
+     // as file offsets, and send the QIO_DIRECT_ALIGN-aligned middle of
+     // each transfer through direct_fd. An unaligned head or tail goes
+     // through the regular descriptor and so the page cache, which
+     // keeps the file length exact without padding or truncating.
+     // Unbuffered transfers use direct_fd only when the user buffer,
+     // offset, and length are all aligned. Files on a file system that
+     // refuses O_DIRECT just use the page cache. The linux open man
+     // page says:
 //Applications should avoid mixing O_DIRECT and normal I/O to the same file, and
 //especially to overlapping byte regions in the same file.  Even when the file
 //system correctly handles the coherency issues in this situation, overall I/O
 //throughput is likely to be slower than using either mode alone.  Likewise,
 //applications should avoid mixing mmap(2) of files with direct I/O to the same
 //files.
+     // Only the partial blocks at the ends of a transfer are mixed, and
+     // DIRECT files are never mmap'd.
 
   QIO_HINT_NOREUSE      = QIO_HINT_DIRECT<<1,
 
@@ -279,6 +294,18 @@ enum {
   // is opened within the qio implementation.  Otherwise, the user (or system)
   // has to close it.
   QIO_HINT_OWNED        = QIO_HINT_NOFAST<<1,
+
+  // On Lustre, write-behind data is only flushed up to stripe
+  // boundaries (the rest waits for more data or a flush), so channels
+  // writing disjoint parts of a shared file don't contend for the same
+  // OST extent locks. Elsewhere this does nothing.
+  QIO_HINT_STRIPE_ALIGN = QIO_HINT_OWNED<<1,
+
+  // Writing channels compress the data in blocks (see qio_compress.h).
+  // They must start at the beginning of the file and can't seek.
+  // Reading channels don't need this; they decompress any file written
+  // this way.
+  QIO_HINT_COMPRESS     = QIO_HINT_STRIPE_ALIGN<<1,
 };
 
 
@@ -339,6 +366,9 @@ char* qio_hints_to_string(qio_hint_t hint)
       case QIO_METHOD_MEMORY:
         strcat(buf, " memory"); ok = 1;
         break;
+      case QIO_METHOD_URING:
+        strcat(buf, " uring"); ok = 1;
+        break;
       // no default to get warned if any are added.
     }
   }
@@ -355,6 +385,8 @@ char* qio_hints_to_string(qio_hint_t hint)
   if( hint & QIO_HINT_NOREUSE ) strcat(buf, " noreuse");
   if( hint & QIO_HINT_NOFAST ) strcat(buf, " nofast");
   if( hint & QIO_HINT_OWNED ) strcat(buf, " owned");
+  if( hint & QIO_HINT_STRIPE_ALIGN ) strcat(buf, " stripe_align");
+  if( hint & QIO_HINT_COMPRESS ) strcat(buf, " compress");
 
   return qio_strdup(buf);
 }
@@ -372,6 +404,7 @@ typedef struct qio_file_s {
   // An (arguably) better solution is to put
   FILE* fp; // set if this file wraps a FILE*
   fd_t fd; // -1 if not set
+  fd_t direct_fd; // fd opened with O_DIRECT for QIO_HINT_DIRECT; -1 if not
   int use_fp; // we only default to FREADFWRITE if this and fp are set.
   qbuffer_t* buf; // NULL if not set.
                   // if set, fp==NULL, fd==-1, is memory-only file.
@@ -381,6 +414,8 @@ typedef struct qio_file_s {
 
   //void* fs_info; // Holds the filesystem information (as a user defined struct)
   void* file_info; // Holds the file information (as a user defined struct)
+  // how to call the plugin; set along with file_info (see qio_plugin_api.h)
+  const struct qio_plugin_fns_s* plugin_fns;
 
   qio_fdflag_t fdflags;
   bool closed;
@@ -389,6 +424,10 @@ typedef struct qio_file_s {
   int64_t initial_length;
   int64_t initial_pos;
 
+  // a qio_compress_codec_t; set if the file starts with a compressed
+  // file header or a compressing channel has written to it
+  int compress_codec;
+
   qbytes_t* mmap;
   // (note -- data in mmap'd region may change,
   //  but the mapping is fixed for the lifetime of
@@ -435,6 +474,12 @@ qioerr qio_readv(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer
 qioerr qio_writev(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, ssize_t* num_written);
 qioerr qio_preadv(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int64_t seek_to_offset, ssize_t* num_read);
 qioerr qio_pwritev(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int64_t seek_to_offset, ssize_t* num_written);
+// Like qio_preadv/qio_pwritev, but each buffer part is a separate
+// io_uring request and they are all in flight at once.  These fall back
+// to preadv/pwritev where io_uring is not available.
+qioerr qio_uring_preadv(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int64_t seek_to_offset, ssize_t* num_read);
+qioerr qio_uring_pwritev(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int64_t seek_to_offset, ssize_t* num_written);
+int qio_uring_available(void);
 
 // if fp is not null, fd is ignored; if fp is null, we use fd.
 // the QIO file takes ownership of fp or fd, closing it when the QIO file is closed.
@@ -460,6 +505,53 @@ qioerr qio_get_fp(qio_file_t* fl, FILE** out);
 qioerr qio_get_chunk(qio_file_t* fl, int64_t* len_out);
 qioerr qio_locales_for_region(qio_file_t* fl, off_t start, off_t end, const char*** locale_names_out, int64_t* num_locs_out);
 
+// One task's share of a parallel read; see qio_file_regions.
+typedef struct qio_region_s {
+  int64_t start;
+  int64_t end;
+  int64_t locale; // index of the locale that should read it; -1 if any
+} qio_region_t;
+
+// Split [start, end) of a file into regions for a parallel read by
+// nlocales locales running ntasks tasks each.  Region boundaries are
+// multiples of the file's chunk size (see qio_get_chunk), and regions
+// are at least qio_parallel_region_min bytes.  On Lustre, a region goes
+// to the locale for the stripe slot it starts in (slot mod nlocales),
+// so each locale keeps to the same OSTs.  Otherwise each locale gets a
+// contiguous run of regions, except plugin files get -1; ask
+// qio_locales_for_region about those.  Free *regions_out with qio_free.
+qioerr qio_file_regions(qio_file_t* fl, int64_t start, int64_t end, int64_t nlocales, int64_t ntasks, qio_region_t** regions_out, int64_t* nregions_out);
+
+// Map len bytes of a file starting at start, read-only, without going
+// through a channel.  *data_out points at byte start; *region_out holds
+// the mapping and unmaps it when its last reference is released.  The
+// region must lie within the file.  Hints are applied as for mmap'd
+// files (QIO_HINT_CACHED populates the mapping up front).
+qioerr qio_file_map_region(qio_file_t* file, int64_t start, int64_t len, qio_hint_t hints, qbytes_t** region_out, void** data_out);
+// Ask the OS to start reading in [ptr, ptr+len) of a mapped region.
+qioerr qio_mapped_region_prefetch(qbytes_t* region, void* ptr, int64_t len);
+// Map num_elts elements of elt_size bytes starting at file offset start
+// as an external array.  Its free function (chpl_free_external_array)
+// releases the mapping.  Writing to the elements is an error.
+qioerr qio_file_map_external_array(qio_file_t* file, int64_t start, uint64_t elt_size, uint64_t num_elts, qio_hint_t hints, chpl_external_array* arr_out);
+
+// One read for qio_file_pread_batch.
+typedef struct qio_pread_req_s {
+  int64_t offset;
+  int64_t len;
+  void* dst;
+  int64_t amt_read; // set to the bytes read; less than len only at EOF
+} qio_pread_req_t;
+
+// Read each request's range of the file into its dst, without going
+// through a channel, and return once they're all done.  The requests
+// are read in file order, and ranges that follow one another share a
+// preadv.  Files that would use io_uring (see choose_io_method) keep
+// several of those in flight at once, and ranges inside the file's
+// initial mapping are copied from it.  Returns EEOF if any request
+// was cut short by the end of the file.
+qioerr qio_file_pread_batch(qio_file_t* file, qio_pread_req_t* reqs, int64_t nreqs);
+
 // This can be called to run close and to check the return value.
 // That's important because some implementations (such as NFS)
 // actually write data on the close() call, so here's where we'll
@@ -731,6 +823,9 @@ typedef struct qio_channel_s {
 
   qio_style_t style;
   int64_t bufIoMax; // maximum single I/O to/from buffer
+  int64_t flush_align; // if > 0, write-behind only flushes up to file
+                       // offsets that are multiples of this
+  struct qio_compress_s* compress; // block compression stage, or NULL
 } qio_channel_t;
 
 
@@ -794,6 +889,11 @@ qioerr _qio_channel_init_file(qio_channel_t* ch, qio_file_t* file, qio_hint_t hi
 // maybe want to use INT64_MAX for end if it's not to be restricted.
 qioerr qio_channel_create(qio_channel_t** ch_out, qio_file_t* file, qio_hint_t hints, int readable, int writeable, int64_t start, int64_t end, qio_style_t* style, int64_t bufIoMax);
 
+// Create a reading channel for one region from qio_file_regions.  It is
+// hinted QIO_HINT_PARALLEL, and the OS is asked to start reading the
+// region ahead (POSIX_FADV_WILLNEED) unless the file is DIRECT.
+qioerr qio_region_channel_create(qio_channel_t** ch_out, qio_file_t* file, const qio_region_t* region, qio_hint_t hints, qio_style_t* style);
+
 qioerr qio_relative_path(const char** path_out, const char* cwd, const char* path);
 qioerr qio_shortest_path(qio_file_t* file, const char** path_out, const char* path_in);
 
@@ -1435,6 +1535,18 @@ qioerr qio_channel_revert(const int threadsafe, qio_channel_t* ch)
 
 qioerr qio_channel_seek(qio_channel_t* ch, int64_t start, int64_t end);
 
+// Move len bytes (or everything up to EOF, if len < 0) from the
+// reading channel src to the writing channel dst, and set *amt_out to
+// the number moved. Returns EEOF if src runs out before len bytes.
+// When both channels are plain buffered file descriptor channels, the
+// bytes go from one descriptor to the other in the kernel
+// (copy_file_range, sendfile or splice on Linux) without passing
+// through either channel's buffer; otherwise they're copied through
+// the buffers. Locks src and then dst.
+qioerr qio_channel_transfer(const int threadsafe, qio_channel_t* dst,
+                            qio_channel_t* src, int64_t len,
+                            int64_t* amt_out);
+
 void qio_channel_commit_unlocked(qio_channel_t* ch);
 
 // Only returns threading errors.
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2020-2026 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* A block compression stage that sits between a channel's qbuffer
+ * and the file.
+ *
+ * A compressed file starts with a 16-byte header:
+ *   6 bytes   magic "CHPLQZ"
+ *   1 byte    format version (1)
+ *   1 byte    codec (qio_compress_codec_t)
+ *   4 bytes   block size, little endian
+ *   4 bytes   reserved (zero)
+ * followed by blocks, each of which is
+ *   4 bytes   uncompressed length, little endian
+ *   4 bytes   stored length, little endian
+ *   data
+ * A block whose stored length equals its uncompressed length is stored
+ * without compression (that happens when it doesn't shrink). Every
+ * block but the ones before a flush holds exactly block size bytes.
+ *
+ * Writing channels with QIO_HINT_COMPRESS compress whole batches of
+ * blocks at a time, one block per thread, and then write the results
+ * in order. Files that start with the header are noticed when they are
+ * opened, and reading channels on them decompress as they read.
+ * Reading channels may seek; seeking backwards starts over from the
+ * first block, and blocks wholly before the position being read are
+ * skipped without being decompressed.
+ *
+ * The codecs available depend on the libraries the runtime is built
+ * with (QIO_HAS_ZSTD, QIO_HAS_LZ4, QIO_HAS_ZLIB).
+ */
+
+#ifndef _QIO_COMPRESS_H_
+#define _QIO_COMPRESS_H_
+
+#include "sys_basic.h"
+#include "qbuffer.h"
+#include "sys.h"
+#include "qio_error.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+  QIO_COMPRESS_NONE = 0,
+  QIO_COMPRESS_ZSTD = 1,
+  QIO_COMPRESS_LZ4 = 2,
+  QIO_COMPRESS_ZLIB = 3,
+} qio_compress_codec_t;
+
+#define QIO_COMPRESS_HEADER_SIZE 16
+#define QIO_COMPRESS_BLOCK_HEADER_SIZE 8
+
+// uncompressed bytes per block in files we write (256K)
+extern int64_t qio_compress_block_size;
+// how many blocks are compressed at once; -1 means read
+// CHPL_RT_QIO_COMPRESS_THREADS the first time it's needed
+extern int qio_compress_threads;
+// codec-specific level; 0 means the codec's default
+extern int qio_compress_level;
+
+typedef struct qio_compress_s qio_compress_t;
+
+// Is the codec compiled in?
+int qio_compress_codec_available(qio_compress_codec_t codec);
+
+// The codec used for new compressed files: CHPL_RT_QIO_COMPRESS
+// ("zstd", "lz4" or "zlib") if set, otherwise the first available of
+// zstd, lz4, zlib. Returns QIO_COMPRESS_NONE if none are compiled in.
+qio_compress_codec_t qio_compress_default_codec(void);
+
+// Check whether the file open on fd starts with a compressed file
+// header. Sets *codec_out to QIO_COMPRESS_NONE if it doesn't.
+qioerr qio_compress_detect(fd_t fd, int64_t length,
+                           qio_compress_codec_t* codec_out);
+
+// Create the state for a channel writing (writing != 0) or reading a
+// compressed file. Writers use codec; readers get the codec and block
+// size from the file header.
+qioerr qio_compress_create(qio_compress_t** z_out, qio_compress_codec_t codec,
+                           int writing);
+void qio_compress_destroy(qio_compress_t* z);
+
+// How many uncompressed bytes a writer should hand over at once
+// (outside of a flush) to keep all of its threads busy.
+int64_t qio_compress_batch_size(qio_compress_t* z);
+
+// Compress [start, end) of buf, which must begin at the uncompressed
+// offset where the last call left off, and write it at the end of the
+// compressed data in fd. Sets *num_written to the uncompressed bytes
+// consumed, which is all of them unless there is an error.
+qioerr qio_compress_write(qio_compress_t* z, fd_t fd, qbuffer_t* buf,
+                          qbuffer_iter_t start, qbuffer_iter_t end,
+                          ssize_t* num_written);
+
+// Fill [start, end) of buf with uncompressed data starting at the
+// uncompressed offset start.offset, reading fd as necessary. Like
+// preadv, it can return fewer bytes than asked for, and returns EEOF
+// with *num_read == 0 at the end of the data.
+qioerr qio_compress_read(qio_compress_t* z, fd_t fd, qbuffer_t* buf,
+                         qbuffer_iter_t start, qbuffer_iter_t end,
+                         ssize_t* num_read);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
+
+#endif
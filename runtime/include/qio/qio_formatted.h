@@ -191,6 +191,15 @@ qioerr qio_channel_read_svarint(const int threadsafe, qio_channel_t* restrict ch
 qioerr qio_channel_write_uvarint(const int threadsafe, qio_channel_t* restrict ch, uint64_t num);
 qioerr qio_channel_write_svarint(const int threadsafe, qio_channel_t* restrict ch, int64_t num);
 
+// Read or write count elements of eltsize (1, 2, 4 or 8) bytes each,
+// e.g. an array of a POD type, in one call. Elements in native order
+// are copied as a block; otherwise each element's bytes are swapped as
+// they go. Larger values made of several numbers (e.g. complex) should
+// be passed as more elements of the smaller size. Errors are like those
+// from qio_channel_read_amt/qio_channel_write_amt.
+qioerr qio_channel_write_array(const int threadsafe, const int byteorder, qio_channel_t* restrict ch, const void* restrict ptr, int64_t count, size_t eltsize);
+qioerr qio_channel_read_array(const int threadsafe, const int byteorder, qio_channel_t* restrict ch, void* restrict ptr, int64_t count, size_t eltsize);
+
 
 static inline
 qioerr qio_channel_read_int(const int threadsafe, const int byteorder, qio_channel_t* restrict ch, void* restrict ptr, size_t len, int issigned) {
@@ -444,9 +453,14 @@ qioerr qio_channel_read_char(const int threadsafe, qio_channel_t* restrict ch, i
   // TODO: This part can be refactored to use some of the functions in
   // encoding/encoding-support.h
 
+  // Fastest path: an ASCII character.
+  if( qio_space_in_ptr_diff(1, ch->cached_end, ch->cached_cur) &&
+      *(unsigned char*)ch->cached_cur < 0x80 ) {
+    *chr = *(unsigned char*)ch->cached_cur;
+    ch->cached_cur = qio_ptr_add(ch->cached_cur,1);
   // Fast path: an entire multi-byte sequence
   // is stored in the buffers.
-  if( qio_space_in_ptr_diff(4, ch->cached_end, ch->cached_cur) ) {
+  } else if( qio_space_in_ptr_diff(4, ch->cached_end, ch->cached_cur) ) {
     state = 0;
     while( 1 ) {
       chpl_enc_utf8_decode(&state,
@@ -730,6 +744,45 @@ void qio_conv_destroy(qio_conv_t* spec);
 void qio_conv_init(qio_conv_t* spec_out);
 qioerr qio_conv_parse(c_string fmt, size_t start, uint64_t* end_out, int scanning, qio_conv_t* spec_out, qio_style_t* style_out, int32_t lineno, int32_t filename);
 
+// A format string parsed once, so that code formatting with the same
+// string over and over doesn't pay to parse it each time. Entry k
+// holds what the k'th call to qio_conv_parse would produce when
+// walking the string from the start: convs[k], styles[k], and the
+// offset just past the conversion, ends[k]. If qio_conv_parse returns
+// an error, parsing stops there; that conversion is the last one and
+// its error is in err, so callers can report it at the same point as
+// they would have before. The literals in convs point into a private
+// copy of the format string, so the program doesn't depend on the
+// caller's string staying around.
+typedef struct qio_conv_prog_s {
+  qbytes_refcnt_t ref_cnt;
+  char* fmt;            // the copy of the format string
+  size_t fmt_len;
+  const char* key;      // the caller's pointer, for the cache
+  int scanning;
+  int64_t num_convs;
+  qio_conv_t* convs;
+  qio_style_t* styles;
+  uint64_t* ends;
+  qioerr err;
+} qio_conv_prog_t;
+
+// Parse the first len bytes of fmt (which must be followed by a NUL,
+// as for qio_conv_parse) into a new program with a reference count of
+// 1. Only returns an error if allocation fails.
+qioerr qio_conv_compile(c_string fmt, size_t len, int scanning, qio_conv_prog_t** prog_out);
+
+// Like qio_conv_compile, but first look in a small per-thread cache
+// keyed by (fmt, len, scanning), so a constant format string is only
+// parsed the first time through a loop. The bytes are compared too,
+// so a cached program is never used for a different string that
+// happens to be at the same address. The caller gets its own
+// reference and must release it.
+qioerr qio_conv_prog_lookup(c_string fmt, size_t len, int scanning, qio_conv_prog_t** prog_out);
+
+void qio_conv_prog_retain(qio_conv_prog_t* prog);
+void qio_conv_prog_release(qio_conv_prog_t* prog);
+
 // These error codes can be used by callers to qio_conv_parse
 qioerr qio_format_error_too_many_args(void);
 qioerr qio_format_error_too_few_args(void);
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2020-2026 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* A read-only plugin (see qio_plugin_api.h) for objects served over
+ * HTTP(S), such as S3-compatible object stores, using range requests.
+ *
+ * An object is read in blocks of qio_http_block_size bytes. Each
+ * channel keeps up to qio_http_parallel range GETs in flight at once
+ * (on one libcurl multi handle), fetching the block being read and the
+ * ones after it. Finished blocks go into an LRU cache shared by all
+ * channels on all objects and holding up to qio_http_cache_size bytes,
+ * so channels reading the same part of an object only fetch it once.
+ *
+ * qio_file_get_chunk reports the block size, so parallel readers can
+ * split a file on block boundaries.
+ *
+ * This needs the runtime to be built with libcurl (QIO_HAS_CURL);
+ * otherwise qio_file_open_http returns ENOSYS.
+ */
+
+#ifndef _QIO_HTTP_H_
+#define _QIO_HTTP_H_
+
+#include "sys_basic.h"
+#include "qio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// bytes per range request (4M)
+extern int64_t qio_http_block_size;
+// range requests each channel keeps in flight; -1 means read
+// CHPL_RT_QIO_HTTP_PARALLEL (default 8) the first time it's needed
+extern int qio_http_parallel;
+// bytes of blocks kept in the shared cache; -1 means read
+// CHPL_RT_QIO_HTTP_CACHE_SIZE (default 256M) the first time it's needed
+extern int64_t qio_http_cache_size;
+
+// Open url for reading. This asks the server for the object's length,
+// and fails if it doesn't give one.
+qioerr qio_file_open_http(qio_file_t** file_out, const char* url,
+                          const qio_style_t* style);
+
+// Drop every block in the shared cache that no channel is using.
+void qio_http_cache_clear(void);
+
+#ifdef __cplusplus
+} // end extern "C"
+#endif
+
+#endif
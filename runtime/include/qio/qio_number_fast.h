@@ -0,0 +1,142 @@
+/*
+ * Copyright 2020-2026 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _QIO_NUMBER_FAST_H_
+#define _QIO_NUMBER_FAST_H_
+
+// Locale-independent pieces of the fast paths for reading and writing
+// plain decimal numbers, shared by the qio formatted I/O routines and the
+// runtime's string casts (chplcast.c).
+
+#include "sys_basic.h"
+#include "bswap.h"
+
+#include <float.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static inline
+int _fast_is_space(unsigned char c)
+{
+  return c == ' ' || ('\t' <= c && c <= '\r');
+}
+
+// Are the 8 bytes of a little-endian word all ASCII digits?
+static inline
+int _fast_eight_digits(uint64_t w)
+{
+  return !(((w + UINT64_C(0x4646464646464646)) |
+            (w - UINT64_C(0x3030303030303030))) &
+           UINT64_C(0x8080808080808080));
+}
+
+// Converts 8 ASCII digits in a little-endian word (first digit in the
+// low byte) to their value, combining pairs, then quads, then halves.
+static inline
+uint64_t _fast_parse_eight_digits(uint64_t w)
+{
+  const uint64_t mask = UINT64_C(0x000000FF000000FF);
+  const uint64_t mul1 = UINT64_C(0x000F424000000064); // 100 + (1000000 << 32)
+  const uint64_t mul2 = UINT64_C(0x0000271000000001); // 1 + (10000 << 32)
+  w -= UINT64_C(0x3030303030303030);
+  w = (w * 10) + (w >> 8);
+  return (((w & mask) * mul1) + (((w >> 16) & mask) * mul2)) >> 32;
+}
+
+// Accumulates the digits at p into *val and returns how many there
+// were.  *val is only meaningful if the total stays below 20 digits.
+static inline
+size_t _fast_parse_digits(const unsigned char* p, const unsigned char* end, uint64_t* val)
+{
+  const unsigned char* start = p;
+  uint64_t v = *val;
+
+  while( end - p >= 8 ) {
+    uint64_t w;
+    memcpy(&w, p, sizeof(w));
+    w = le64toh(w);
+    if( ! _fast_eight_digits(w) ) break;
+    v = v * 100000000 + _fast_parse_eight_digits(w);
+    p += 8;
+  }
+  while( p < end && '0' <= *p && *p <= '9' ) {
+    v = v * 10 + (*p - '0');
+    p++;
+  }
+
+  *val = v;
+  return p - start;
+}
+
+// Clinger's fast path: when the mantissa and the power of 10 are both
+// exact doubles, a single multiply or divide is correctly rounded.
+// Returns false, leaving *num_out alone, when that isn't the case.
+static inline
+bool _fast_scale_pow10(uint64_t mantissa, int64_t exp10, double* num_out)
+{
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+  // Powers of 10 that are exact as doubles.
+  static const double exact_pow10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+  };
+  double num;
+
+  if( mantissa > (UINT64_C(1) << 53) || exp10 < -22 || exp10 > 22 )
+    return false;
+
+  num = (double) mantissa;
+  if( exp10 < 0 ) num /= exact_pow10[-exp10];
+  else num *= exact_pow10[exp10];
+  *num_out = num;
+  return true;
+#else
+  return false;
+#endif
+}
+
+// Writes the decimal digits of num to buf, which needs room for 20 bytes
+// and a NUL, and returns how many there are.
+static inline
+size_t _fast_format_u64(char* buf, uint64_t num)
+{
+  char tmp[20];
+  size_t n = 0;
+  size_t i;
+
+  do {
+    tmp[n++] = (char) ('0' + num % 10);
+    num /= 10;
+  } while( num != 0 );
+  for( i = 0; i < n; i++ ) buf[i] = tmp[n - 1 - i];
+  buf[n] = '\0';
+  return n;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
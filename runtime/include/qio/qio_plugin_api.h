@@ -52,6 +52,29 @@ syserr chpl_qio_get_locales_for_region(void* file, int64_t start, int64_t end, v
 
 // close a file
 syserr chpl_qio_file_close(void* file);
+
+// The functions qio calls for a plugin file, one per chpl_qio_ function
+// above. Files made with qio_file_init_plugin use the chpl_qio_ ones
+// (chpl_qio_plugin_fns); plugins written in C can supply their own with
+// qio_file_init_plugin_fns.
+typedef struct qio_plugin_fns_s {
+  syserr (*setup_plugin_channel)(void* file, void** plugin_ch, int64_t start, int64_t end, qio_channel_t* qio_ch);
+  syserr (*read_atleast)(void* plugin_ch, int64_t amt);
+  syserr (*write)(void* plugin_ch, int64_t amt);
+  syserr (*channel_close)(void* plugin_ch);
+  syserr (*filelength)(void* file, int64_t* length);
+  syserr (*getpath)(void* file, uint8_t** str, int64_t* len);
+  syserr (*fsync)(void* file);
+  syserr (*get_chunk)(void* file, int64_t* length);
+  syserr (*get_locales_for_region)(void* file, int64_t start, int64_t end, void **localeNamesPtr, int64_t* nLocales);
+  syserr (*file_close)(void* file);
+} qio_plugin_fns_t;
+
+extern const qio_plugin_fns_t chpl_qio_plugin_fns;
+
+qioerr qio_file_init_plugin_fns(qio_file_t** file_out, void* file_info,
+                                const qio_plugin_fns_t* fns, int fdflags,
+                                const qio_style_t* style);
 #ifdef __cplusplus
 }
 #endif
@@ -63,6 +63,20 @@ qioerr qio_proc_communicate(
 
 qioerr qio_send_signal(int64_t pid, int qio_sig);
 
+// Move up to len bytes (all of them, up to EOF, if len is negative)
+// from one file to another, e.g. from a subprocess's output pipe into
+// a file, or from a file into another subprocess's input. An offset
+// of -1 means to use (and advance) the descriptor's own position,
+// which is what pipes need; otherwise the data is read or written at
+// that offset. On Linux this uses splice() so the data doesn't pass
+// through user space when one side is a pipe; otherwise it is copied.
+// Waiting for a pipe lets other tasks run. Any channels on these files
+// must be flushed first, and channels on the written range opened
+// afterwards. Sets *amt_out to the number of bytes moved.
+qioerr qio_proc_splice(qio_file_t* from, int64_t from_offset,
+                       qio_file_t* to, int64_t to_offset,
+                       int64_t len, int64_t* amt_out);
+
 #ifdef __cplusplus
 } // end extern "C"
 #endif
@@ -142,6 +142,59 @@ int64_t qio_regex_replace(qio_regex_t* regex, const char* repl, int64_t repl_len
 //
 qioerr qio_regex_channel_match(const qio_regex_t* regex, const int threadsafe, struct qio_channel_s* ch, int64_t maxlen, int anchor, qio_bool can_discard, qio_bool keep_unmatched, qio_bool keep_whole_pattern, qio_regex_string_piece_t* submatch, int64_t nsubmatch);
 
+// A set of patterns matched all at once, so that finding which of N
+// patterns occur in some text takes one pass over it instead of N.
+// Patterns are numbered from 0 in the order they are added. Sets don't
+// report where the matches are or capture anything.
+typedef struct qio_regex_set_s {
+  void* set;
+} qio_regex_set_t;
+
+static inline
+qio_regex_set_t qio_regex_set_null(void)
+{
+  qio_regex_set_t ret;
+  ret.set = NULL;
+  return ret;
+}
+
+// Create an empty set. Every pattern uses options; anchor is one of
+// the QIO_REGEX_ANCHOR_ values. The set must be released by the caller.
+void qio_regex_set_create(const qio_regex_options_t* options, int anchor, qio_regex_set_t* set_out);
+
+// Add a pattern, which can't be done once the set is compiled.
+// Returns the pattern's index, or -1 if it didn't parse, in which
+// case *err_str is set to an error message that must be freed by the
+// caller (and was made with qio_malloc()).
+int64_t qio_regex_set_add(qio_regex_set_t* set, const char* pattern, int64_t pattern_len, const char** err_str);
+
+// Prepare the set for matching. Returns false if that failed
+// (e.g. it ran out of memory), in which case nothing ever matches.
+qio_bool qio_regex_set_compile(qio_regex_set_t* set);
+
+void qio_regex_set_retain(const qio_regex_set_t* set);
+void qio_regex_set_release(qio_regex_set_t* set);
+
+int64_t qio_regex_set_size(const qio_regex_set_t* set);
+
+// Match a compiled set against str. If matched is not NULL, it has an
+// element for every pattern and matched[i] is set to whether pattern
+// i matched. Returns true if any pattern matched.
+qio_bool qio_regex_set_match(const qio_regex_set_t* set, const char* str, int64_t str_len, qio_bool* matched);
+
+// Match a compiled set against the next maxlen bytes of ch (or up to
+// its end), reading them in place from the channel's buffer and
+// leaving the channel after them. Matches that span the read
+// boundaries are still found: when every pattern has a bounded length
+// and doesn't look at its surroundings (^, $, \b and the like) only a
+// few bytes around each boundary are copied. Other sets are matched
+// against a contiguous copy of the data.
+//
+// Returns ENOERR if any pattern matched, EFORMAT if none did, EEOF if
+// the channel was already at EOF, or an I/O error. matched is filled
+// in as for qio_regex_set_match.
+qioerr qio_regex_set_channel_match(const qio_regex_set_t* set, const int threadsafe, struct qio_channel_s* ch, int64_t maxlen, qio_bool* matched);
+
 #ifdef __cplusplus
 } // end extern "C"
 #endif
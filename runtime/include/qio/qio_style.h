@@ -190,6 +190,8 @@ typedef struct qio_style_s {
 
   // realfmt does not apply to integers.
   uint8_t realfmt; //0 -> print with %g; 1 -> print with %f; 2 -> print with %e
+                   //3 -> shortest digits that read back the same,
+                   //     laid out like %.17g; precision is ignored
 
   // Other data type choices
   //
@@ -178,6 +178,7 @@ qio_err_t sys_lstat(const char* path, struct stat* buf);
 qio_err_t sys_fstatfs(fd_t fd, sys_statfs_t* buf);
 
 qio_err_t sys_lustre_get_stripe_size(fd_t fd, int64_t* size_out);
+qio_err_t sys_lustre_get_stripe(fd_t fd, int64_t* size_out, int64_t* count_out);
 
 qio_err_t sys_mkstemp(char* template_, fd_t* fd_out);
 
@@ -60,11 +60,23 @@ typedef pthread_cond_t chpl_thread_condvar_t;
 //
 // Sync variables
 //
+// On Linux, waiters sleep on a futex word that is bumped on every
+// signal, which avoids the condvar's internal locking.  The futex
+// words and waiter counts are only changed with the lock held; the
+// counts let signalers skip the wake system call when nobody waits.
+//
 typedef struct {
   volatile chpl_bool  is_full;
   chpl_thread_mutex_t lock;
+#ifdef __linux__
+  volatile uint32_t signal_full;      // futex word: bumped when full
+  volatile uint32_t signal_empty;     // futex word: bumped when empty
+  uint32_t waiters_full;
+  uint32_t waiters_empty;
+#else
   chpl_thread_condvar_t signal_full;  // wait for full; signal this when full
   chpl_thread_condvar_t signal_empty; // wait for empty; signal this when empty
+#endif
   //  threadlayer_sync_aux_t tl_aux;
 } chpl_sync_aux_t;
 
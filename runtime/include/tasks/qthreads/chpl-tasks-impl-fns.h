@@ -73,6 +73,9 @@ typedef struct chpl_qthread_tls_s {
   // That would reduce the size of the task local storage,
   // but increase the size of executeOn bundles.
   chpl_task_infoRuntime_t infoRuntime;
+  // Task profiling (CHPL_RT_TASK_PROFILE) state.
+  uint64_t profBeginTime;
+  uint64_t profYields;
 } chpl_qthread_tls_t;
 
 extern pthread_t chpl_qthread_process_pthread;
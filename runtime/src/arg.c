@@ -35,14 +35,19 @@
 #include "chpl-comm-locales.h"
 
 #include <assert.h>
+#include <ctype.h>
+#include <dirent.h>
 #include <errno.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 
 static int gdbFlag = 0;
 static int lldbFlag = 0;
+static int topoReportFlag = 0;
+static int profileFlag = 0;
 
 
 typedef struct _flagType {
@@ -63,6 +68,8 @@ static const flagType flagList[] = {
   { "v", "", "verbose", "run program in verbose mode", 'g' },
   { "", "", "gdb", "run program in gdb", 'g' },
   { "", "", "lldb", "run program in lldb", 'g' },
+  { "", "", "topoReport", "print each locale's hardware topology", 'g' },
+  { "", "", "profile", "sample the program's stacks, see chpl-profile.h", 'g' },
   { "E", "<envVar>=<val>", "",
     "set the value of an environment variable", 'g' },
 
@@ -82,6 +89,14 @@ int _runInLLDB(void) {
   return lldbFlag;
 }
 
+int chpl_topoReportRequested(void) {
+  return topoReportFlag;
+}
+
+int chpl_profileRequested(void) {
+  return profileFlag;
+}
+
 
 static void defineEnvVar(const char* currentArg,
                          int32_t lineno, int32_t filename) {
@@ -244,6 +259,74 @@ void printHelpTable(void) {
 static int32_t _argNumLocales = 0;
 static int32_t _argNumLocalesPerNode = 1;
 
+// Map a co-locale suffix ("s", "numa", ...) to a CHPL_RT_COLOCALE_OBJ_TYPE
+// value, or NULL if it isn't one.
+static const char* colocaleObjType(const char* suffix) {
+  if (!strcmp(suffix, "s") || !strcmp(suffix, "socket")) {
+    return "socket";
+  } else if (!strcmp(suffix, "numa")) {
+    return "numa";
+  } else if (!strcmp(suffix, "llc")) {
+    return "cache";
+  } else if (!strcmp(suffix, "c") || !strcmp(suffix, "core")) {
+    return "core";
+  }
+  return NULL;
+}
+
+//
+// How many sockets or NUMA domains (t is "socket" or "numa") this node
+// has, from Linux's sysfs, or 0 if we can't tell. This runs in the
+// launcher, so it doesn't have hwloc to ask; the topology layer checks
+// the answer against the compute node's hwloc topology at startup.
+//
+static int countNodeObjs(const char* t) {
+  int count = 0;
+  DIR* dir;
+  struct dirent* ent;
+
+  if (!strcmp(t, "numa")) {
+    if ((dir = opendir("/sys/devices/system/node")) == NULL) return 0;
+    while ((ent = readdir(dir)) != NULL) {
+      if (!strncmp(ent->d_name, "node", 4) && isdigit(ent->d_name[4])) {
+        count++;
+      }
+    }
+    closedir(dir);
+    return count;
+  }
+
+  if (!strcmp(t, "socket")) {
+    // the distinct physical package ids among the CPUs
+    int ids[1024];
+    if ((dir = opendir("/sys/devices/system/cpu")) == NULL) return 0;
+    while ((ent = readdir(dir)) != NULL) {
+      char path[300];
+      FILE* f;
+      int id;
+      if (strncmp(ent->d_name, "cpu", 3) || !isdigit(ent->d_name[3])) {
+        continue;
+      }
+      snprintf(path, sizeof(path),
+               "/sys/devices/system/cpu/%s/topology/physical_package_id",
+               ent->d_name);
+      if ((f = fopen(path, "r")) == NULL) continue;
+      if (fscanf(f, "%d", &id) == 1) {
+        int i;
+        for (i = 0; i < count && ids[i] != id; i++);
+        if (i == count && count < (int)(sizeof(ids)/sizeof(ids[0]))) {
+          ids[count++] = id;
+        }
+      }
+      fclose(f);
+    }
+    closedir(dir);
+    return count;
+  }
+
+  return 0;
+}
+
 void parseNumLocales(const char* numPtr, int32_t lineno, int32_t filename) {
   int invalid;
   char invalidChars[2] = "\0\0";
@@ -255,7 +338,39 @@ void parseNumLocales(const char* numPtr, int32_t lineno, int32_t filename) {
     // parse locale expression of the form NxLt where L and t are optional
     *x = '\0';
     char *lpn = x+1;
-    if (*lpn != '\0') {
+    if (*lpn != '\0' && !isdigit(*lpn)) {
+      // Only a suffix: one co-locale per socket or NUMA domain, however
+      // many the node has. The launcher counts them and passes the count
+      // on in CHPL_RT_LOCALES_PER_NODE, which the program then uses.
+      const char *t = colocaleObjType(lpn);
+      if (t == NULL) {
+        char *message = chpl_glom_strings(3, "\"", lpn,
+                        "\" is not a valid suffix.");
+        chpl_error(message, lineno, filename);
+      }
+      if (strcmp(t, "socket") && strcmp(t, "numa")) {
+        char *message = chpl_glom_strings(3, "the number of co-locales "
+                        "must be given with the \"", lpn, "\" suffix.");
+        chpl_error(message, lineno, filename);
+      }
+      chpl_env_set("CHPL_RT_COLOCALE_OBJ_TYPE", t, 1);
+
+      if (chpl_env_rt_get_bool("COLOCALE_AUTO", false) &&
+          chpl_env_rt_get("LOCALES_PER_NODE", NULL)) {
+        _argNumLocalesPerNode =
+          (int32_t) chpl_env_rt_get_int("LOCALES_PER_NODE", 1);
+      } else {
+        _argNumLocalesPerNode = countNodeObjs(t);
+        if (_argNumLocalesPerNode < 1) {
+          char *message = chpl_glom_strings(3, "cannot count the ", t,
+                          "s on this node; give the number of co-locales.");
+          chpl_error(message, lineno, filename);
+        }
+        chpl_env_set_uint("CHPL_RT_LOCALES_PER_NODE",
+                          (uint64_t)_argNumLocalesPerNode, 1);
+        chpl_env_set("CHPL_RT_COLOCALE_AUTO", "true", 1);
+      }
+    } else if (*lpn != '\0') {
       // locales per node (L) was specified
       _argNumLocalesPerNode = c_string_to_int32_t_precise(lpn, &invalid,
                                                    invalidChars);
@@ -270,15 +385,8 @@ void parseNumLocales(const char* numPtr, int32_t lineno, int32_t filename) {
           chpl_error(message, lineno, filename);
         }
 
-        if (!strcmp(suffix, "s") || !strcmp(suffix, "socket")) {
-          t = "socket";
-        } else if (!strcmp(suffix, "numa")) {
-          t = "numa";
-        } else if (!strcmp(suffix, "llc")) {
-          t = "cache";
-        } else if (!strcmp(suffix, "c") || !strcmp(suffix, "core")) {
-          t = "core";
-        } else {
+        t = colocaleObjType(suffix);
+        if (t == NULL) {
           char *message = chpl_glom_strings(3, "\"", suffix,
                           "\" is not a valid suffix.");
           chpl_error(message, lineno, filename);
@@ -427,6 +535,16 @@ void parseArgs(chpl_bool isLauncher, chpl_parseArgsMode_t mode,
             break;
           }
 
+          if (strcmp(flag, "topoReport") == 0) {
+            topoReportFlag = 1;
+            break;
+          }
+
+          if (strcmp(flag, "profile") == 0) {
+            profileFlag = 1;
+            break;
+          }
+
           if (strcmp(flag, "help") == 0) {
             printHelp = 1;
             chpl_gen_main_arg.argv[chpl_gen_main_arg.argc] = "--help";
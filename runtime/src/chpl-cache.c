@@ -196,7 +196,13 @@ then by copying the newly gotten data out of the cache and into the request
 buffer.
 
 When processing GETs on adjacent memory locations, the cache triggers
-both synchronous and asynchronous read-ahead.
+both synchronous and asynchronous read-ahead. Each sequential access pattern
+is tracked as a readahead 'stream' with its own window, so several
+interleaved sequential scans can each read ahead. A stream's window starts
+small and doubles each time the program reaches the previous window, as long
+as none of the pages read ahead for it were evicted unused. When pages read
+ahead for a stream are evicted without being used, that stream's window
+is halved.
 
 When processing a PUT, we similarly check for the requested cache page in the
 pointer tree and use an unused page if not. We find a unused 'dirty entry' to
@@ -282,12 +288,18 @@ use.
 #include "chpl-comm-strd-xfer.h"
 #include "chpl-linefile-support.h"
 #include "sys.h" // sys_page_size()
+#include "chplsys.h" // chpl_getHeapPageSize()
+#include "chpl-topo.h"
 #include "chpl-comm-compiler-macros.h"
+#include "chpl-prefetch.h"
 #include "chpl-comm-no-warning-macros.h" // No warnings for chpl_comm_get etc.
 
 
+#include <stdlib.h> // qsort
 #include <string.h> // memcpy, memset, etc.
 #include <assert.h>
+#include <inttypes.h>
+#include <sys/mman.h> // madvise
 
 
 #ifdef HAS_CHPL_CACHE_FNS
@@ -306,42 +318,84 @@ use.
 // How many pending operations can we have at once?
 #define MAX_PENDING 32
 
+// The cache geometry (page size, line size, and number of pages) is
+// chosen once at program start, in chpl_cache_init(), and can be
+// adjusted with these environment variables:
+//
+//   CHPL_RT_CACHE_PAGE_SIZE       cache page size in bytes
+//   CHPL_RT_CACHE_LINES_PER_PAGE  number of cache lines in each page
+//   CHPL_RT_CACHE_ENTRIES         number of cache pages per pthread
+//
+// All of these must be powers of 2. Values out of range are adjusted
+// with a warning.
+
 // CACHEPAGE_BITS
 // Controls the cache page size - the cache manages items of this many bytes
 // but also includes facilities for partial pages (valid and dirty bits).
 //
-// Reasonable values for CACHEPAGE_BITS are between 6 and 12
-// (64 bytes and 4k bytes. CACHEPAGE_BITS should not be larger than the
-// page size) and it must currently be even.
-// Here we set it to 1k bytes (ie 2^10).
-#define CACHEPAGE_BITS 10
+// Allowed values for CACHEPAGE_BITS are between MIN_CACHEPAGE_BITS and
+// MAX_CACHEPAGE_BITS (64 bytes and 4k bytes. CACHEPAGE_BITS should not
+// be larger than the system page size).
+// By default we set it to 1k bytes (ie 2^10).
+#define MIN_CACHEPAGE_BITS 6
+#define MAX_CACHEPAGE_BITS 12
+#define DEFAULT_CACHEPAGE_BITS 10
+static int cachepage_bits = DEFAULT_CACHEPAGE_BITS;
+#define CACHEPAGE_BITS cachepage_bits
 #define CACHEPAGE_SIZE (1 << CACHEPAGE_BITS)
 #define CACHEPAGE_MASK (CACHEPAGE_SIZE-1)
+#define MAX_CACHEPAGE_SIZE (1 << MAX_CACHEPAGE_BITS)
 
 // CACHELINE_BITS
 // Controls the cache line size - that is, the minimum number of bytes
 // that are fetched for any 'get' operation.
 //
-// Reasonable values for CACHELINE_BITS are between 6 and CACHEPAGE_BITS.
-// Here we set it to 64 bytes (ie 2^6)
-#define CACHELINE_BITS 6
+// Allowed values for CACHELINE_BITS are between MIN_CACHELINE_BITS
+// and CACHEPAGE_BITS.
+// By default we set it to 64 bytes (ie 2^6)
+#define MIN_CACHELINE_BITS 6
+#define DEFAULT_CACHELINE_BITS 6
+static int cacheline_bits = DEFAULT_CACHELINE_BITS;
+#define CACHELINE_BITS cacheline_bits
 #define CACHELINE_SIZE (1 << CACHELINE_BITS)
 #define CACHELINE_MASK (CACHELINE_SIZE-1)
 
+// How many cache pages does each pthread's cache have?
+#define DEFAULT_CACHE_PAGES 1024
+#define MIN_CACHE_PAGES 64
+#define MAX_CACHE_PAGES (1 << 20)
+static int cache_pages_per_cache = DEFAULT_CACHE_PAGES;
+
 // What type can store the number of cache lines in a cache page?
 typedef int8_t line_per_page_t;
-// What type for a number of lines to read ahead?
-typedef int16_t readahead_distance_t;
+// What type for a number of bytes to read ahead?
+// (must be able to store +/- MAX_READAHEAD_PAGES*CACHEPAGE_SIZE)
+typedef int32_t readahead_distance_t;
 
 // used to compress top_index_list / bottom_index arrays
 // the entry pointer is entry_base + idx*sizeof(entry type)
 typedef int16_t entry_id_t;
 
 // When prefetching, what is the maximum number of pages
-// we are willing to prefetch? This is also the maximum
-// readahead window size for sequential access.
+// we are willing to prefetch?
 #define MAX_PAGES_PER_PREFETCH 2
 
+// What is the maximum readahead window size (in pages) for sequential
+// access? Each readahead stream starts with a small window and grows
+// it geometrically up to this size as long as the pages it reads ahead
+// are used (see the readahead stream functions below).
+// The window is also limited to a fraction of Ain.
+#define MAX_READAHEAD_PAGES 16
+
+// How many sequential access streams can we track at once?
+#define READAHEAD_STREAMS 8
+
+// Should dirty pages for the same node be written back together
+// (with unordered puts) when cleaning the cache at a release fence?
+// And how many pages at most should be written back in one batch?
+#define ENABLE_PUT_COALESCING 1
+#define MAX_COALESCED_DIRTY_PAGES 64
+
 // Should we enable sequential readahead?
 // For sequential access If we're reading
 #define ENABLE_READAHEAD 1
@@ -349,7 +403,12 @@ typedef int16_t entry_id_t;
 
 #define ENABLE_READAHEAD_TRIGGER_SEQUENTIAL 0
 
-#define MAX_SEQUENTIAL_READAHEAD_BYTES (MAX_PAGES_PER_PREFETCH*CACHEPAGE_SIZE)
+// Should cache hits on pages read ahead for a sequential stream
+// prefetch the next processor cache line of the page into the CPU
+// cache? CPU_CACHELINE_SIZE is the processor's line size, which is
+// not necessarily the same as CACHELINE_SIZE.
+#define ENABLE_HIT_CPU_PREFETCH 1
+#define CPU_CACHELINE_SIZE 64
 
 // These defines can enable different kinds of debugging output.
 
@@ -459,6 +518,7 @@ static long time_duration(const struct timespec* t1, const struct timespec* t2)
 
 // Forward Declarations.
 struct rdcache_s;
+struct cache_trace_s;
 
 
 //////////////// REMOTE DATA CACHE IMPLEMENTATION ////////////////////
@@ -476,6 +536,9 @@ struct rdcache_s;
 // How many uint64_t words do we need to create a bitmask for CACHE_LINES_PER_PAGE
 // ie, a mask recording a bit per cache line?
 #define CACHE_LINES_PER_PAGE_BITMASK_WORDS (((CACHEPAGE_SIZE/CACHELINE_SIZE)+63)/64)
+// And what is the most that could be needed for any allowed geometry?
+#define MAX_CACHE_LINES_PER_PAGE_BITMASK_WORDS \
+  (((MAX_CACHEPAGE_SIZE >> MIN_CACHELINE_BITS)+63)/64)
 
 // Storing a remote address (node number is separate).
 typedef uintptr_t raddr_t;
@@ -515,7 +578,8 @@ struct page_list_s {
 
 // this data structure manages dirty pages. It is allocated separately
 // from cache entries, so the majority of pages (which are clean) don't
-// have the big bitmap. ~150 bytes/dirty entry.
+// have the big bitmap. ~32 bytes/dirty entry plus the bitmap, which is
+// CACHEPAGE_BITMASK_WORDS words (~128 bytes for 1k pages).
 struct dirty_entry_s {
   // linked list of currently dirty pages
   struct dirty_entry_s* next;
@@ -523,7 +587,8 @@ struct dirty_entry_s {
   // which cache entry are we talking about here?
   struct cache_entry_s* entry;
   // Which of the page's bytes are dirty?
-  uint64_t dirty[CACHEPAGE_BITMASK_WORDS]; // ie we need to create a put for these bytes
+  // Points to CACHEPAGE_BITMASK_WORDS words allocated with the cache.
+  uint64_t* dirty; // ie we need to create a put for these bytes
 };
 
 #define QUEUE_FREE 0
@@ -570,6 +635,9 @@ struct cache_entry_s {
   // Readahead information.
   readahead_distance_t readahead_skip;
   readahead_distance_t readahead_len; // == 0 if this page doesn't trigger readahead.
+  // Which readahead stream triggered from or read ahead this page?
+  // 0 if none.
+  uint32_t readahead_stream;
   // These are the queue links. Am is LRU but Ain and Aout are FIFO
   struct cache_entry_s* next; // next entry in Ain/Aout/Am
   struct cache_entry_s* prev; // previous entry in An/Aout/Am
@@ -577,7 +645,7 @@ struct cache_entry_s {
   // This refers to CACHEPAGE_SIZE bytes of memory.
   unsigned char* page;
   // Which of the cache lines have we done 'get's for?
-  uint64_t valid_lines[CACHE_LINES_PER_PAGE_BITMASK_WORDS];
+  uint64_t valid_lines[MAX_CACHE_LINES_PER_PAGE_BITMASK_WORDS];
   // dirty info if this cache page is dirty, NULL otherwise.
   struct dirty_entry_s* dirty;
   // What is the minimum sequence number stored in this cache entry?
@@ -614,10 +682,67 @@ static int set_valid_lines(uint64_t* valid, uintptr_t skip, uintptr_t len)
 // Note skip/len are in line numbers, NOT byte offsets!
 static void unset_valid_lines(uint64_t* valid, uintptr_t skip, uintptr_t len)
 {
-  uint64_t myvalid[CACHE_LINES_PER_PAGE_BITMASK_WORDS];
+  uint64_t myvalid[MAX_CACHE_LINES_PER_PAGE_BITMASK_WORDS];
   unset_valids_for_skip_len(valid, myvalid, skip, len, CACHE_LINES_PER_PAGE_BITMASK_WORDS);
 }
 
+// Tracks one sequential access pattern so that it can have its own
+// readahead window.
+struct readahead_stream_s {
+  uint32_t id;            // 0 means this stream slot is not in use
+  c_nodeid_t node;
+  int window_pages;       // current readahead window size, in pages
+  int unused_pages;       // readahead pages evicted unused since the window
+                          // was last adjusted
+  cache_seqn_t last_use;  // for replacing the least recently used stream
+  uint64_t readahead_pages; // total pages read ahead for this stream
+  uint64_t wasted_pages;    // total pages read ahead but never used
+  int site;               // for per-call-site statistics, or NO_CACHE_SITE
+};
+
+// Shared per-locale cache tier.
+//
+// When CHPL_RT_CACHE_SHARED is set, full pages fetched on a demand miss
+// are also published to a read-only, direct-mapped table that is shared
+// by all of the per-pthread caches on this locale. Before starting a GET
+// for a miss, a per-pthread cache checks this table, so that tasks on
+// different pthreads reading the same remote data don't each have to
+// fetch it.
+//
+// Each slot is protected by a sequence lock. The slot version is odd
+// while the slot is being written. Readers copy the data out and then
+// check that the version did not change, so lookups never block.
+// A pthread that finds a slot busy just doesn't publish its page.
+//
+// Consistency works like the sequence numbers in the per-pthread caches.
+// There is a locale-wide epoch that each fence advances. Each per-pthread
+// cache records the epoch from its most recent fence, and a slot records
+// the epoch as of just before its GET started. A slot can only be used
+// by a pthread cache whose most recent fence did not come after that.
+// A task that writes remote data stops using the shared tier until its
+// next release fence, so that it can't read back its own stale data.
+
+// How many pages are in the shared tier (by default)?
+// CHPL_RT_CACHE_SHARED_ENTRIES adjusts it; it must be a power of 2.
+#define DEFAULT_SHARED_CACHE_PAGES 4096
+
+struct shared_cache_slot_s {
+  chpl_atomic_uint_least64_t version; // odd while being written
+  c_nodeid_t node;
+  raddr_t raddr;
+  uint64_t fill_epoch;
+  unsigned char* page;
+};
+
+struct shared_cache_s {
+  chpl_atomic_uint_least64_t epoch;
+  uint64_t nslots_mask; // number of slots - 1
+  struct shared_cache_slot_s* slots;
+};
+
+// NULL unless the shared tier is enabled
+static struct shared_cache_s* shared_cache = NULL;
+
 struct rdcache_s {
   // A 2Q cache.
   // See "2Q: A Low Overhead High Performance Buffer Management
@@ -635,6 +760,17 @@ struct rdcache_s {
   c_nodeid_t last_cache_miss_read_node;
   raddr_t last_cache_miss_read_addr;
 
+  // Sequential readahead streams and their windows.
+  int max_readahead_pages;
+  uint32_t next_readahead_stream_id;
+  struct readahead_stream_s readahead_streams[READAHEAD_STREAMS];
+
+  // The shared tier epoch as of the most recent fence on this cache.
+  uint64_t shared_epoch;
+
+  // Where to record operations, or NULL if not tracing.
+  struct cache_trace_s* trace;
+
   // Used with the lookup table. This is the number of bits
   // for the number of table slots.
   int table_bits;
@@ -761,6 +897,274 @@ uint32_t entry_to_offset(struct rdcache_s* tree, struct cache_entry_s* entry) {
   return (entry!=NULL)?offset:0;
 }
 
+// Allocate the memory for a per-pthread cache. It is aligned to (and
+// its size is rounded up to) the heap page size, so that it uses whole
+// huge pages when the heap is backed by them. Otherwise we ask for
+// transparent huge pages. When this thread is a fixed worker, the memory
+// is also placed on this thread's NUMA domain so that cache hits don't
+// have to cross sockets.
+static
+void* cache_alloc_storage(size_t* size_inout)
+{
+  size_t align = chpl_getHeapPageSize();
+  size_t size = *size_inout;
+  void* buffer;
+
+  if (align < 64) align = 64;
+  size = (size + align - 1) & ~(align - 1);
+
+  buffer = chpl_memalign(align, size);
+
+#ifdef MADV_HUGEPAGE
+  if (align == chpl_getSysPageSize()) {
+    // advisory only; ignore errors
+    (void) madvise(buffer, size, MADV_HUGEPAGE);
+  }
+#endif
+
+  if (chpl_env_rt_get_bool("CACHE_NUMA_LOCAL", true) &&
+      chpl_topo_getNumNumaDomains() > 1 &&
+      chpl_task_isFixedThread()) {
+    c_sublocid_t subloc = chpl_topo_getThreadLocality();
+    if (isActualSublocID(subloc))
+      chpl_topo_setMemLocality(buffer, size, true, subloc);
+  }
+
+  *size_inout = size;
+  return buffer;
+}
+
+// Replay support.
+//
+// While chpl_cache_replay_trace is running, the cache doesn't communicate.
+// GETs leave whatever was already in the page, PUTs are dropped, and every
+// operation is complete as soon as it is started. The wrappers below are
+// used for all of the communication the cache starts on its own, and they
+// count the bytes that would have been moved.
+static chpl_bool cache_simulating = false;
+static uint64_t cache_sim_bytes_got = 0;
+static uint64_t cache_sim_bytes_put = 0;
+
+static inline
+chpl_comm_nb_handle_t cache_comm_get_nb(void* addr, c_nodeid_t node,
+                                        void* raddr, size_t size,
+                                        int32_t commID, int ln, int32_t fn)
+{
+  if (cache_simulating) {
+    cache_sim_bytes_got += size;
+    return NULL;
+  }
+  return chpl_comm_get_nb(addr, node, raddr, size, commID, ln, fn);
+}
+
+static inline
+chpl_comm_nb_handle_t cache_comm_put_nb(void* addr, c_nodeid_t node,
+                                        void* raddr, size_t size,
+                                        int32_t commID, int ln, int32_t fn)
+{
+  if (cache_simulating) {
+    cache_sim_bytes_put += size;
+    return NULL;
+  }
+  return chpl_comm_put_nb(addr, node, raddr, size, commID, ln, fn);
+}
+
+static inline
+void cache_comm_put_unordered(void* addr, c_nodeid_t node,
+                              void* raddr, size_t size,
+                              int32_t commID, int ln, int32_t fn)
+{
+  if (cache_simulating) {
+    cache_sim_bytes_put += size;
+    return;
+  }
+  chpl_comm_put_unordered(addr, node, raddr, size, commID, ln, fn);
+}
+
+static inline
+void cache_comm_getput_unordered_task_fence(void)
+{
+  if (!cache_simulating)
+    chpl_comm_getput_unordered_task_fence();
+}
+
+static inline
+int cache_comm_test_nb_complete(chpl_comm_nb_handle_t h)
+{
+  return cache_simulating || chpl_comm_test_nb_complete(h);
+}
+
+static inline
+void cache_comm_wait_nb_some(chpl_comm_nb_handle_t* h, size_t nhandles)
+{
+  if (!cache_simulating)
+    chpl_comm_wait_nb_some(h, nhandles);
+}
+
+static inline
+void cache_comm_free_nb_handle(chpl_comm_nb_handle_t h)
+{
+  if (!cache_simulating)
+    chpl_comm_free_nb_handle(h);
+}
+
+static inline
+int cache_comm_addr_gettable(c_nodeid_t node, void* start, size_t len)
+{
+  return cache_simulating || chpl_comm_addr_gettable(node, start, len);
+}
+
+// Access traces.
+//
+// When CHPL_RT_CACHE_TRACE=<prefix> is set, each pthread's cache writes
+// the operations it is asked to do to the file <prefix>.<locale>.<n>,
+// where n counts the caches created on that locale. A trace can be run
+// back through the cache with chpl_cache_replay_trace to see how other
+// CHPL_RT_CACHE_* settings would have done on the same accesses.
+
+#define CACHE_TRACE_MAGIC "CHPLCTRC"
+#define CACHE_TRACE_VERSION 1
+// How many records are buffered before they are written out?
+#define CACHE_TRACE_BUFFER_RECORDS 4096
+
+enum {
+  CACHE_TRACE_GET = 1,
+  CACHE_TRACE_PUT,
+  CACHE_TRACE_PREFETCH,
+  CACHE_TRACE_ACQUIRE,
+  CACHE_TRACE_RELEASE,
+  CACHE_TRACE_INVALIDATE,
+};
+
+struct cache_trace_header_s {
+  char magic[8];
+  uint32_t version;
+  int32_t node; // the locale that recorded the trace
+};
+
+struct cache_trace_record_s {
+  uint32_t op;
+  int32_t node;
+  uint64_t raddr;
+  uint64_t size;
+};
+
+struct cache_trace_s {
+  FILE* file;
+  struct cache_trace_s* next; // in cache_traces
+  int n;
+  struct cache_trace_record_s records[CACHE_TRACE_BUFFER_RECORDS];
+};
+
+// NULL unless CHPL_RT_CACHE_TRACE is set
+static const char* cache_trace_prefix = NULL;
+// All of the open traces, so that they can be written out at exit
+// even if their pthreads are still running.
+static pthread_mutex_t cache_traces_mutex = PTHREAD_MUTEX_INITIALIZER;
+static struct cache_trace_s* cache_traces = NULL; // protected by the mutex
+static int cache_traces_created = 0; // protected by the mutex
+
+static
+void cache_trace_init(void)
+{
+  const char* prefix = chpl_env_rt_get("CACHE_TRACE", NULL);
+
+  if (prefix != NULL && prefix[0] != '\0')
+    cache_trace_prefix = prefix;
+}
+
+// Returns NULL if tracing is off or the file could not be opened.
+static
+struct cache_trace_s* cache_trace_create(void)
+{
+  struct cache_trace_header_s header;
+  struct cache_trace_s* t;
+  char name[1024];
+  FILE* f;
+
+  if (cache_trace_prefix == NULL || cache_simulating) return NULL;
+
+  pthread_mutex_lock(&cache_traces_mutex);
+  snprintf(name, sizeof(name), "%s.%d.%d",
+           cache_trace_prefix, (int) chpl_nodeID, cache_traces_created++);
+  pthread_mutex_unlock(&cache_traces_mutex);
+
+  f = fopen(name, "wb");
+  if (f == NULL) {
+    char msg[1100];
+    snprintf(msg, sizeof(msg), "could not open cache trace file %s", name);
+    chpl_warning(msg, 0, 0);
+    return NULL;
+  }
+
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, CACHE_TRACE_MAGIC, sizeof(header.magic));
+  header.version = CACHE_TRACE_VERSION;
+  header.node = chpl_nodeID;
+  fwrite(&header, sizeof(header), 1, f);
+
+  t = chpl_malloc(sizeof(struct cache_trace_s));
+  t->file = f;
+  t->n = 0;
+
+  pthread_mutex_lock(&cache_traces_mutex);
+  t->next = cache_traces;
+  cache_traces = t;
+  pthread_mutex_unlock(&cache_traces_mutex);
+
+  return t;
+}
+
+// Must be called with cache_traces_mutex held.
+static
+void cache_trace_write_out(struct cache_trace_s* t)
+{
+  if (t->n > 0)
+    fwrite(t->records, sizeof(struct cache_trace_record_s), t->n, t->file);
+  t->n = 0;
+}
+
+static
+void cache_trace_record(struct rdcache_s* cache, int op,
+                        c_nodeid_t node, raddr_t raddr, size_t size)
+{
+  struct cache_trace_s* t = cache->trace;
+  struct cache_trace_record_s* r;
+
+  if (t == NULL) return;
+
+  r = &t->records[t->n++];
+  r->op = op;
+  r->node = node;
+  r->raddr = raddr;
+  r->size = size;
+
+  if (t->n == CACHE_TRACE_BUFFER_RECORDS) {
+    pthread_mutex_lock(&cache_traces_mutex);
+    cache_trace_write_out(t);
+    pthread_mutex_unlock(&cache_traces_mutex);
+  }
+}
+
+static
+void cache_trace_destroy(struct cache_trace_s* t)
+{
+  struct cache_trace_s** cur;
+
+  pthread_mutex_lock(&cache_traces_mutex);
+  cache_trace_write_out(t);
+  for (cur = &cache_traces; *cur != NULL; cur = &(*cur)->next) {
+    if (*cur == t) {
+      *cur = t->next;
+      break;
+    }
+  }
+  pthread_mutex_unlock(&cache_traces_mutex);
+
+  fclose(t->file);
+  chpl_free(t);
+}
+
 static void check_line_aligned(void* ptr)
 {
   assert(((intptr_t) ptr) % 64 == 0);
@@ -781,6 +1185,7 @@ struct rdcache_s* cache_create(void) {
   struct page_list_s* page_list_entries = NULL;
   struct cache_entry_s *entries = NULL;
   struct dirty_entry_s *dirty_nodes = NULL;
+  uint64_t *dirty_bitmaps = NULL;
   uintptr_t offset;
 
   size_t total_size = 0;
@@ -791,7 +1196,8 @@ struct rdcache_s* cache_create(void) {
 
   // This used to grow based on the number of locales, but that
   // would mean increasing memory usage per node, which isn't acceptable.
-  cache_pages = 1024;
+  // It is set from CHPL_RT_CACHE_ENTRIES in cache_init_geometry().
+  cache_pages = cache_pages_per_cache;
 
   ain_pages = cache_pages / 4; // 2Q: "Kin should be 25% of page slots"
                                // but here we set it smaller so that
@@ -826,14 +1232,15 @@ struct rdcache_s* cache_create(void) {
   total_size += sizeof(struct page_list_s) * cache_pages;
   total_size += sizeof(struct cache_entry_s) * n_entries;
   total_size += sizeof(struct dirty_entry_s) * dirty_pages;
+  total_size += sizeof(uint64_t) * CACHEPAGE_BITMASK_WORDS * dirty_pages;
   total_size += sizeof(chpl_comm_nb_handle_t) * pending_len;
   total_size += sizeof(cache_seqn_t) * pending_len;
   // We allocate an extra page for alignment
   total_size += CACHEPAGE_SIZE + CACHEPAGE_SIZE * cache_pages;
 
   // Now, allocate it all in one go.
-  buffer = chpl_memalign(64, total_size);
   allocated_size = total_size;
+  buffer = cache_alloc_storage(&allocated_size);
 
   // Now divvy up the portions...
   total_size = 0;
@@ -853,6 +1260,9 @@ struct rdcache_s* cache_create(void) {
   // dirty entries
   dirty_nodes = (struct dirty_entry_s*) (buffer + total_size);
   total_size += sizeof(struct dirty_entry_s) * dirty_pages;
+  // dirty bitmaps
+  dirty_bitmaps = (uint64_t*) (buffer + total_size);
+  total_size += sizeof(uint64_t) * CACHEPAGE_BITMASK_WORDS * dirty_pages;
   // and the pending data area
   c->pending = (chpl_comm_nb_handle_t*) (buffer + total_size);
   total_size += sizeof(chpl_comm_nb_handle_t) * pending_len;
@@ -879,6 +1289,22 @@ struct rdcache_s* cache_create(void) {
   c->last_cache_miss_read_node = -1;
   c->last_cache_miss_read_addr = 0;
 
+  // Don't let a single readahead window take up too much of Ain,
+  // since then it would evict pages before they are used.
+  c->max_readahead_pages = MAX_READAHEAD_PAGES;
+  if (c->max_readahead_pages > ain_pages / 4)
+    c->max_readahead_pages = ain_pages / 4;
+  if (c->max_readahead_pages < 1)
+    c->max_readahead_pages = 1;
+  c->next_readahead_stream_id = 1;
+  memset(c->readahead_streams, 0, sizeof(c->readahead_streams));
+
+  // Tasks using this cache might have run a fence before it was created.
+  c->shared_epoch = shared_cache ?
+                    atomic_load_uint_least64_t(&shared_cache->epoch) : 0;
+
+  c->trace = cache_trace_create();
+
   c->max_pages = cache_pages;
   c->max_entries = n_entries;
 
@@ -938,6 +1364,7 @@ struct rdcache_s* cache_create(void) {
     dirty_nodes[i].next = next;
     dirty_nodes[i].prev = prev;
     dirty_nodes[i].entry = NULL;
+    dirty_nodes[i].dirty = dirty_bitmaps + i * CACHEPAGE_BITMASK_WORDS;
   }
   c->dirty_lru_tail = &dirty_nodes[dirty_pages-1];
 
@@ -962,25 +1389,232 @@ struct rdcache_s* cache_create(void) {
   return c;
 }
 
+// Per-call-site statistics.
+//
+// When CHPL_RT_CACHE_SITE_STATS is set, GETs through the cache record
+// hits, misses, and bytes for their source line, and readahead streams
+// record the pages they read ahead but that were never used for the
+// line that started them. The table is shared by all of the pthreads
+// on a locale. The report, sorted by misses, is printed at exit and by
+// chpl_cache_print_stats.
+
+// How many different source lines can we track?
+#define CACHE_SITE_STATS_SLOTS 4096
+// How many lines does the report print at most?
+#define CACHE_SITE_STATS_REPORT_LINES 40
+#define NO_CACHE_SITE (-1)
+#define CACHE_SITE_EMPTY UINT64_MAX
+
+struct cache_site_stats_s {
+  chpl_atomic_uint_least64_t key; // file and line, or CACHE_SITE_EMPTY
+  chpl_atomic_uint_least64_t hits;
+  chpl_atomic_uint_least64_t misses;
+  chpl_atomic_uint_least64_t bytes;
+  chpl_atomic_uint_least64_t readahead_wasted; // pages
+};
+
+// NULL unless CHPL_RT_CACHE_SITE_STATS is set
+static struct cache_site_stats_s* cache_site_stats = NULL;
+
+static
+void cache_site_stats_create(void)
+{
+  struct cache_site_stats_s* t;
+  int i;
+
+  if (!chpl_env_rt_get_bool("CACHE_SITE_STATS", false))
+    return;
+
+  t = chpl_malloc(CACHE_SITE_STATS_SLOTS * sizeof(struct cache_site_stats_s));
+  for (i = 0; i < CACHE_SITE_STATS_SLOTS; i++) {
+    atomic_init_uint_least64_t(&t[i].key, CACHE_SITE_EMPTY);
+    atomic_init_uint_least64_t(&t[i].hits, 0);
+    atomic_init_uint_least64_t(&t[i].misses, 0);
+    atomic_init_uint_least64_t(&t[i].bytes, 0);
+    atomic_init_uint_least64_t(&t[i].readahead_wasted, 0);
+  }
+
+  cache_site_stats = t;
+}
+
+// Returns the index of the table entry for this source line,
+// adding one if necessary, or NO_CACHE_SITE if there is no room
+// (or if site statistics are not enabled).
+static
+int cache_site(int ln, int32_t fn)
+{
+  uint64_t key = ((uint64_t) (uint32_t) fn << 32) | (uint32_t) ln;
+  uint64_t h = (key * 0x9E3779B97F4A7C15ULL) >> 32;
+  int i, idx;
+
+  if (cache_site_stats == NULL) return NO_CACHE_SITE;
+
+  for (i = 0; i < CACHE_SITE_STATS_SLOTS; i++) {
+    struct cache_site_stats_s* s;
+    uint64_t k;
+
+    idx = (h + i) & (CACHE_SITE_STATS_SLOTS - 1);
+    s = &cache_site_stats[idx];
+    k = atomic_load_explicit_uint_least64_t(&s->key, memory_order_relaxed);
+    if (k == CACHE_SITE_EMPTY) {
+      // try to claim this slot; if another pthread claimed it first,
+      // it might have claimed it for this line
+      if (atomic_compare_exchange_strong_uint_least64_t(&s->key, &k, key))
+        return idx;
+    }
+    if (k == key) return idx;
+  }
+
+  return NO_CACHE_SITE;
+}
+
+static inline
+void cache_site_add(chpl_atomic_uint_least64_t* ctr, uint64_t n)
+{
+  (void) atomic_fetch_add_explicit_uint_least64_t(ctr, n,
+                                                  memory_order_relaxed);
+}
+
+static
+void cache_site_record_get(int ln, int32_t fn, size_t size, int all_hits)
+{
+  int site = cache_site(ln, fn);
+  struct cache_site_stats_s* s;
+
+  if (site == NO_CACHE_SITE) return;
+
+  s = &cache_site_stats[site];
+  cache_site_add(all_hits ? &s->hits : &s->misses, 1);
+  cache_site_add(&s->bytes, size);
+}
+
+// Readahead streams.
+//
+// Each sequential access pattern that triggers readahead is tracked as a
+// 'stream' with its own readahead window. The pages a stream reads ahead
+// record the stream id. Each time the stream's readahead trigger fires
+// (meaning the program has reached the previous window) and none of its
+// pages have been evicted unused since the last time, the window doubles,
+// up to max_readahead_pages. When a page read ahead for the stream is
+// evicted without being used, the window is halved.
+
+// Returns NULL if no stream with that id is being tracked
+// (e.g. because it was replaced by another stream).
+static
+struct readahead_stream_s* find_readahead_stream(struct rdcache_s* cache,
+                                                 uint32_t id)
+{
+  int i;
+
+  if (id == 0) return NULL;
+
+  for (i = 0; i < READAHEAD_STREAMS; i++) {
+    if (cache->readahead_streams[i].id == id)
+      return &cache->readahead_streams[i];
+  }
+
+  return NULL;
+}
+
+// Find the stream with the passed id, or start tracking a new stream
+// (replacing the least recently used one) with a window of initial_pages.
+static
+struct readahead_stream_s* get_readahead_stream(struct rdcache_s* cache,
+                                                uint32_t id,
+                                                c_nodeid_t node,
+                                                int initial_pages,
+                                                int site)
+{
+  struct readahead_stream_s* s;
+  int i;
+
+  s = find_readahead_stream(cache, id);
+
+  if (s == NULL) {
+    s = &cache->readahead_streams[0];
+    for (i = 1; i < READAHEAD_STREAMS; i++) {
+      if (cache->readahead_streams[i].last_use < s->last_use)
+        s = &cache->readahead_streams[i];
+    }
+
+    s->id = cache->next_readahead_stream_id++;
+    if (cache->next_readahead_stream_id == 0)
+      cache->next_readahead_stream_id = 1; // 0 means no stream
+
+    if (initial_pages < 1) initial_pages = 1;
+    if (initial_pages > cache->max_readahead_pages)
+      initial_pages = cache->max_readahead_pages;
+
+    s->node = node;
+    s->window_pages = initial_pages;
+    s->unused_pages = 0;
+    s->readahead_pages = 0;
+    s->wasted_pages = 0;
+    s->site = site;
+  }
+
+  s->last_use = cache->next_request_number;
+
+  return s;
+}
+
+// Called when the readahead trigger for a stream fires.
+// Returns the window size in pages to use for the next readahead.
+static
+int adapt_readahead_window(struct rdcache_s* cache,
+                           struct readahead_stream_s* s)
+{
+  if (s->unused_pages == 0) {
+    s->window_pages *= 2;
+    if (s->window_pages > cache->max_readahead_pages)
+      s->window_pages = cache->max_readahead_pages;
+  }
+  s->unused_pages = 0;
+
+  return s->window_pages;
+}
+
+// Called when a page read ahead for a stream is evicted unused.
+static
+void readahead_stream_page_unused(struct rdcache_s* cache, uint32_t id)
+{
+  struct readahead_stream_s* s = find_readahead_stream(cache, id);
+
+  if (s == NULL) return;
+
+  // Only shrink once per window; later unused pages from the same
+  // window are most likely the same misprediction.
+  if (s->unused_pages == 0 && s->window_pages > 1)
+    s->window_pages /= 2;
+
+  s->unused_pages++;
+  s->wasted_pages++;
+
+  if (s->site != NO_CACHE_SITE)
+    cache_site_add(&cache_site_stats[s->site].readahead_wasted, 1);
+}
+
 // utility function to increment the counters for
 // unused prefetches and readaheads. By "unused", we
 // mean that the entry was prefetched or read ahead but
 // never accessed before being evicted. We zero out the
 // prefetch_diags_flags at the end so we don't double count this event.
 static
-void count_unused_prefetches(struct cache_entry_s* z)
+void count_unused_prefetches(struct rdcache_s* cache, struct cache_entry_s* z)
 {
   if((z->prefetch_diags_flags & ENTRY_FLAGS_PREFETCHED) != 0) {
     chpl_comm_diags_incr(cache_prefetch_unused);
   }
   if((z->prefetch_diags_flags & ENTRY_FLAGS_READAHEADED) != 0) {
     chpl_comm_diags_incr(cache_readahead_unused);
+    readahead_stream_page_unused(cache, z->readahead_stream);
   }
   z->prefetch_diags_flags = 0;
 }
 
 static
 void cache_destroy(struct rdcache_s *cache) {
+  if (cache->trace) cache_trace_destroy(cache->trace);
   chpl_free(cache);
 }
 
@@ -1090,6 +1724,99 @@ int hash_to_entry(uint64_t hash, unsigned int table_bits) {
   return (int) (h % TABLE_ENTRIES_PER_SLOT);
 }
 
+// Shared cache tier functions. See struct shared_cache_s.
+
+static inline
+struct shared_cache_slot_s* shared_cache_slot(c_nodeid_t node, raddr_t ra_page)
+{
+  return &shared_cache->slots[hash_raddr(ra_page, node) &
+                              shared_cache->nslots_mask];
+}
+
+// Starts a new epoch and returns it. Called from fences.
+static inline
+uint64_t shared_cache_new_epoch(void)
+{
+  return atomic_fetch_add_uint_least64_t(&shared_cache->epoch, 1) + 1;
+}
+
+// Copy bytes [skip, skip+len) of the shared copy of the page at
+// node:ra_page into dst, if the shared tier has a copy that was fetched
+// no earlier than min_epoch.
+// Returns 1 if it did so. If it returns 0, dst might have been
+// overwritten with other data.
+static
+int shared_cache_lookup(c_nodeid_t node, raddr_t ra_page, uint64_t min_epoch,
+                        unsigned char* dst, uintptr_t skip, uintptr_t len)
+{
+  struct shared_cache_slot_s* slot = shared_cache_slot(node, ra_page);
+  uint64_t v1, v2;
+
+  v1 = atomic_load_explicit_uint_least64_t(&slot->version,
+                                           memory_order_acquire);
+  if (v1 & 1)
+    return 0;
+
+  if (slot->node != node || slot->raddr != ra_page ||
+      slot->fill_epoch < min_epoch)
+    return 0;
+
+  chpl_memcpy(dst, slot->page + skip, len);
+
+  // don't allow the reads above to move after the version check
+  chpl_atomic_thread_fence(memory_order_acquire);
+  v2 = atomic_load_explicit_uint_least64_t(&slot->version,
+                                           memory_order_relaxed);
+  return v1 == v2;
+}
+
+// Called before starting the GET for a page that will be published
+// with shared_cache_publish. Returns 0 if the page can't be published.
+static
+int shared_cache_prepare_fill(c_nodeid_t node, raddr_t ra_page,
+                              uint64_t* version, uint64_t* fill_epoch)
+{
+  struct shared_cache_slot_s* slot = shared_cache_slot(node, ra_page);
+
+  *version = atomic_load_uint_least64_t(&slot->version);
+  *fill_epoch = atomic_load_uint_least64_t(&shared_cache->epoch);
+  return (*version & 1) == 0;
+}
+
+// Publish a full page that was fetched after shared_cache_prepare_fill.
+// Does nothing if the slot was written in the meantime.
+static
+void shared_cache_publish(c_nodeid_t node, raddr_t ra_page,
+                          const unsigned char* page,
+                          uint64_t version, uint64_t fill_epoch)
+{
+  struct shared_cache_slot_s* slot = shared_cache_slot(node, ra_page);
+  uint64_t expected = version;
+
+  if (!atomic_compare_exchange_strong_uint_least64_t(&slot->version,
+                                                     &expected, version + 1))
+    return;
+
+  // don't allow the writes below to move before the version update
+  chpl_atomic_thread_fence(memory_order_release);
+
+  slot->node = node;
+  slot->raddr = ra_page;
+  slot->fill_epoch = fill_epoch;
+  chpl_memcpy(slot->page, page, CACHEPAGE_SIZE);
+
+  atomic_store_explicit_uint_least64_t(&slot->version, version + 2,
+                                       memory_order_release);
+}
+
+// Called when a task writes remote data (through the cache or not).
+static inline
+void shared_cache_note_write(chpl_cache_taskPrvData_t* task_local)
+{
+  if (shared_cache && task_local)
+    task_local->skip_shared_cache = 1;
+}
+
 // Looks up raddr/node in the table and linked lists.
 // Returns an entry that is found to match.
 // If an entry is found, return it and:
@@ -1625,6 +2352,20 @@ static void use_dirty(struct rdcache_s* cache, struct dirty_entry_s* dirty)
   DOUBLE_PUSH_HEAD(cache, dirty, dirty_lru);
 }
 
+// Remove the dirty structure from an entry and put it back on its free
+// list. This has the effect of clearing the dirty bits.
+static void release_dirty(struct rdcache_s* cache, struct cache_entry_s* entry)
+{
+  struct dirty_entry_s* dirty = entry->dirty;
+
+  DOUBLE_REMOVE(cache, dirty, dirty_lru);
+  dirty->entry = NULL;
+  entry->dirty = NULL;
+  DOUBLE_PUSH_TAIL(cache, dirty, dirty_lru);
+  // ... and decrement the number of dirty pages.
+  cache->num_dirty_pages--;
+}
+
 
 static
 chpl_bool do_wait_for(struct rdcache_s* cache, cache_seqn_t sn);
@@ -1945,14 +2686,14 @@ chpl_bool do_wait_for(struct rdcache_s* cache, cache_seqn_t sn)
     // If the first entry's sequence number is earlier than sn
     // and that comm event isn't complete yet, then wait for some
     if (cache->pending_sequence_numbers[index] <= sn &&
-        !chpl_comm_test_nb_complete(cache->pending[index])) {
+        !cache_comm_test_nb_complete(cache->pending[index])) {
       // Wait for some requests
       last = cache->pending_last_entry;
       if (last < index) last = cache->pending_len - 1;
 
       // Wait for some requests to complete.
       // (this could cause a different task body to run)
-      chpl_comm_wait_nb_some(&cache->pending[index], last - index + 1);
+      cache_comm_wait_nb_some(&cache->pending[index], last - index + 1);
 
       // TODO: set 'waited=true' only if the time elapsed is sufficiently
       // long. The comms layer might need wait_nb_some to be called in order
@@ -1976,8 +2717,8 @@ chpl_bool do_wait_for(struct rdcache_s* cache, cache_seqn_t sn)
 
     // Whether we waited above or not, if the first entry's event
     // is already complete, then remove it from the queue.
-    if (chpl_comm_test_nb_complete(cache->pending[index])) {
-      chpl_comm_free_nb_handle(cache->pending[index]);
+    if (cache_comm_test_nb_complete(cache->pending[index])) {
+      cache_comm_free_nb_handle(cache->pending[index]);
       fifo_circleb_pop(&cache->pending_first_entry,
                        &cache->pending_last_entry,
                        cache->pending_len);
@@ -2136,7 +2877,7 @@ void flush_entry(struct rdcache_s* cache,
 
           // Note: chpl_comm_put_nb, pending_push can yield
           handle =
-            chpl_comm_put_nb(page+start, /*local addr*/
+            cache_comm_put_nb(page+start, /*local addr*/
                              entry->base.node,
                              (void*)(entry->base.raddr+start),
                              got_len /*size*/,
@@ -2158,14 +2899,7 @@ void flush_entry(struct rdcache_s* cache,
           // Move past this region of 1s in dirty bits.
           start = got_skip + got_len;
         }
-        // Now remove the dirty structure and put it back on its free list.
-        // This has the effect of clearing the dirty bits.
-        DOUBLE_REMOVE(cache, dirty, dirty_lru);
-        dirty->entry = NULL;
-        entry->dirty = NULL;
-        DOUBLE_PUSH_TAIL(cache, dirty, dirty_lru);
-        // ... and decrement the number of dirty pages.
-        cache->num_dirty_pages--;
+        release_dirty(cache, entry);
       }
     }
   }
@@ -2188,10 +2922,11 @@ void flush_entry(struct rdcache_s* cache,
 
   // If invalidating, clear valid bits.
   if( op & FLUSH_DO_INVALIDATE ) {
-    count_unused_prefetches(entry);
+    count_unused_prefetches(cache, entry);
     if( len == CACHEPAGE_SIZE ) {
       entry->readahead_skip = 0;
       entry->readahead_len = 0;
+      entry->readahead_stream = 0;
       entry->min_sequence_number = NO_SEQUENCE_NUMBER;
       entry->max_put_sequence_number = NO_SEQUENCE_NUMBER;
       entry->max_prefetch_sequence_number = NO_SEQUENCE_NUMBER;
@@ -2203,7 +2938,7 @@ void flush_entry(struct rdcache_s* cache,
 
   // If evicting, remove the page from the cache and put it on a free list.
   if( op & FLUSH_DO_EVICT ) {
-    count_unused_prefetches(entry);
+    count_unused_prefetches(cache, entry);
     // But, our entry no longer can have a page associated with it.
     page = entry->page;
     entry->page = NULL;
@@ -2289,6 +3024,7 @@ struct cache_entry_s* make_entry(struct rdcache_s* tree,
     bottom_match->entryReservedByTask = NULL;
     bottom_match->readahead_skip = 0;
     bottom_match->readahead_len = 0;
+    bottom_match->readahead_stream = 0;
     // Set the page to the one the caller already allocated
     bottom_match->page = page;
     // Clear the valid lines
@@ -2318,6 +3054,7 @@ struct cache_entry_s* make_entry(struct rdcache_s* tree,
     bottom_tmp->entryReservedByTask = NULL;
     bottom_tmp->readahead_skip = 0;
     bottom_tmp->readahead_len = 0;
+    bottom_tmp->readahead_stream = 0;
 
     bottom_tmp->next = NULL;
     bottom_tmp->prev = NULL;
@@ -2677,6 +3414,7 @@ int cache_get(struct rdcache_s* cache,
               unsigned char * addr,
               c_nodeid_t node, raddr_t raddr, size_t size,
               int sequential_readahead_length,
+              uint32_t readahead_stream,
               int32_t commID, int ln, int32_t fn);
 
 static
@@ -2688,6 +3426,7 @@ void cache_get_trigger_readahead(struct rdcache_s* cache,
                                  // skip < 0 -> reverse, >0 -> forward
                                  readahead_distance_t skip,
                                  readahead_distance_t len,
+                                 uint32_t readahead_stream,
                                  int32_t commID, int ln, int32_t fn)
 {
   // Handle prefetching.
@@ -2699,6 +3438,7 @@ void cache_get_trigger_readahead(struct rdcache_s* cache,
 
   int next_ra_length;
   int ok;
+  struct readahead_stream_s* stream;
   raddr_t prefetch_start, prefetch_end;
   size_t page_size = 0;
   uintptr_t request_page, request_len_page, prefetch_page, prefetch_len_page;
@@ -2715,17 +3455,28 @@ void cache_get_trigger_readahead(struct rdcache_s* cache,
   // If we are accessing a page that has a readahead condition,
   // trigger that readahead.
   if( ENABLE_READAHEAD && skip && ! is_congested(cache) ) {
-    next_ra_length = 2 * len;
+    // Find the stream this trigger belongs to (or start a new one)
+    // and compute the size of the window to read ahead now.
+    stream = get_readahead_stream(cache, readahead_stream, node,
+                                  len / CACHEPAGE_SIZE,
+                                  cache_site(ln, fn));
+    next_ra_length = adapt_readahead_window(cache, stream) * CACHEPAGE_SIZE;
 
-    if( next_ra_length > MAX_SEQUENTIAL_READAHEAD_BYTES )
-      next_ra_length = MAX_SEQUENTIAL_READAHEAD_BYTES;
+    prefetch_start = page_raddr + skip;
+    prefetch_end = prefetch_start + len;
+
+    // Resize the window. A forward window keeps its start, and
+    // a reverse window keeps its end.
+    if( skip > 0 ) {
+      prefetch_end = prefetch_start + next_ra_length;
+    } else if( prefetch_end > (raddr_t) next_ra_length ) {
+      prefetch_start = prefetch_end - next_ra_length;
+    }
+    len = prefetch_end - prefetch_start;
 
     if( skip < 0 )
       next_ra_length = - next_ra_length;
 
-    prefetch_start = page_raddr + skip;
-    prefetch_end = prefetch_start + len;
-
     ok = 0;
     // Assuming we have a request for raddr..raddr+len-1,
     // can we prefetch prefetch_addr..prefetch_addr+prefetch_len-1 ?
@@ -2736,7 +3487,7 @@ void cache_get_trigger_readahead(struct rdcache_s* cache,
 
     // Can we prefetch len bytes starting at prefetch_raddr?
     // If not, compute the smaller amount that we can prefetch.
-    if( !chpl_task_guardPagesInUse() && chpl_comm_addr_gettable(node, (void*)prefetch_start, len) ) {
+    if( !chpl_task_guardPagesInUse() && cache_comm_addr_gettable(node, (void*)prefetch_start, len) ) {
       ok = 1;
     }
 
@@ -2778,7 +3529,7 @@ void cache_get_trigger_readahead(struct rdcache_s* cache,
       cache_get(cache, task_local,
                 /* addr */ NULL /* means prefetch */,
                 node, prefetch_start, prefetch_end - prefetch_start,
-                next_ra_length,
+                next_ra_length, stream->id,
                 commID, ln, fn);
     } else {
       // We could not prefetch, so record a cache miss so
@@ -2890,7 +3641,8 @@ void cache_get_compute_readahead_extend(struct rdcache_s* cache,
 // This call handles only accesses within a page.
 // returns 1 if the request was a "hit"
 // sequential_readahead_length is non-zero when doing
-// a readahead.
+// a readahead, and in that case readahead_stream identifies
+// the stream doing the readahead.
 static
 int cache_get_in_page(struct rdcache_s* cache,
                       chpl_cache_taskPrvData_t* task_local,
@@ -2898,6 +3650,7 @@ int cache_get_in_page(struct rdcache_s* cache,
                       c_nodeid_t node, raddr_t raddr, size_t size,
                       raddr_t ra_first_page, raddr_t ra_last_page,
                       int sequential_readahead_length,
+                      uint32_t readahead_stream,
                       int32_t commID, int ln, int32_t fn)
 {
   struct cache_entry_s* entry;
@@ -2911,6 +3664,11 @@ int cache_get_in_page(struct rdcache_s* cache,
   int entry_after_acquire;
   chpl_comm_nb_handle_t handle;
   uintptr_t readahead_len, readahead_skip;
+  uint32_t trigger_stream;
+  int use_shared;
+  int shared_hit = 0;
+  int shared_fill = 0;
+  uint64_t shared_version = 0, shared_fill_epoch = 0;
 
   isprefetch = (addr == NULL);
   isreadahead = (sequential_readahead_length != 0 && isprefetch);
@@ -3005,6 +3763,17 @@ int cache_get_in_page(struct rdcache_s* cache,
 
       // Clear the prefetch flags to indicate that the data was used
       entry->prefetch_diags_flags = 0;
+
+      // A sequential stream will want the data after this next, so
+      // start bringing it into the CPU cache while we copy this out.
+      if( ENABLE_HIT_CPU_PREFETCH && entry->readahead_stream != 0 ) {
+        raddr_t next = round_down_to_mask(raddr - ra_page + size +
+                                          CPU_CACHELINE_SIZE - 1,
+                                          CPU_CACHELINE_SIZE - 1);
+        if( next < CACHEPAGE_SIZE )
+          chpl_prefetch(entry->page + next);
+      }
+
       // Copy the data out.
       chpl_memcpy(addr, entry->page + (raddr-ra_page), size);
 
@@ -3033,6 +3802,7 @@ int cache_get_in_page(struct rdcache_s* cache,
         // we're starting the readahead now.
         readahead_skip = entry->readahead_skip;
         readahead_len = entry->readahead_len;
+        trigger_stream = entry->readahead_stream;
         entry->readahead_skip = 0;
         entry->readahead_len = 0;
 
@@ -3045,6 +3815,7 @@ int cache_get_in_page(struct rdcache_s* cache,
                                     node, ra_page,
                                     raddr, size,
                                     readahead_skip, readahead_len,
+                                    trigger_stream,
                                     commID, ln, fn);
         return 1;
       }
@@ -3059,6 +3830,15 @@ int cache_get_in_page(struct rdcache_s* cache,
   // If we get here, the data was not available, so
   // Get ready to start a GET !
 
+  // With the shared tier, demand misses fetch the whole page so that
+  // it can be published for the other pthreads on this locale.
+  use_shared = (shared_cache != NULL && !cache_simulating && !isprefetch &&
+                !task_local->skip_shared_cache);
+  if (use_shared && !entry->dirty) {
+    ra_line = ra_page;
+    ra_line_end = ra_page + CACHEPAGE_SIZE;
+  }
+
   // If there was an intervening acquire fence preventing
   // us from using this cache line, we need to mark everything
   // as invalid and clear the min and max request numbers.
@@ -3078,6 +3858,25 @@ int cache_get_in_page(struct rdcache_s* cache,
   assert(entry->page && entry->entryReservedByTask == task_local);
   assert(entry->base.raddr == ra_page && entry->base.node == node);
 
+  // Check the shared tier before going to the network.
+  // (the lookup does not yield)
+  if (use_shared) {
+    shared_hit = shared_cache_lookup(node, ra_page, cache->shared_epoch,
+                                     entry->page + (ra_line-ra_page),
+                                     ra_line - ra_page,
+                                     ra_line_end - ra_line);
+    if (shared_hit) {
+      chpl_comm_diags_incr(cache_shared_hits);
+    } else {
+      chpl_comm_diags_incr(cache_shared_misses);
+      shared_fill = (ra_line == ra_page &&
+                     ra_line_end == ra_page + CACHEPAGE_SIZE &&
+                     shared_cache_prepare_fill(node, ra_page,
+                                               &shared_version,
+                                               &shared_fill_epoch));
+    }
+  }
+
   // Now we need to start a get into page.
   // We'll get within ra_page from ra_line to ra_line_end.
   INFO_PRINT(("%i chpl_comm_start_get(%p, %i, %p, %i)\n",
@@ -3087,11 +3886,15 @@ int cache_get_in_page(struct rdcache_s* cache,
 
   // Note: chpl_comm_get_nb could cause a different task body to run.
   // That should be OK because we marked entry as "reserved".
-  handle = chpl_comm_get_nb(entry->page + (ra_line-ra_page), /*local addr*/
-                            node, (void*) ra_line,
-                            ra_line_end - ra_line /*size*/,
-                            commID, ln, fn);
-  if (EXTRA_YIELDS) {
+  if (shared_hit) {
+    handle = NULL;
+  } else {
+    handle = cache_comm_get_nb(entry->page + (ra_line-ra_page), /*local addr*/
+                              node, (void*) ra_line,
+                              ra_line_end - ra_line /*size*/,
+                              commID, ln, fn);
+  }
+  if (EXTRA_YIELDS && !shared_hit) {
     TRACE_YIELD_PRINT(("%d: task %d cache %p yielding in cache_get_in_page "
                        "for chpl_comm_get_nb\n",
                        chpl_nodeID, (int) chpl_task_getId(), cache));
@@ -3131,8 +3934,16 @@ int cache_get_in_page(struct rdcache_s* cache,
 
   // Set the flag to indicate whether it was prefetched or readahead-ed
   if (isreadahead && !(entry->prefetch_diags_flags & ENTRY_FLAGS_READAHEADED)) {
+    struct readahead_stream_s* stream;
+
     entry->prefetch_diags_flags |= ENTRY_FLAGS_READAHEADED;
     chpl_comm_diags_incr(cache_num_page_readaheads);
+
+    // Remember which stream read ahead this page, so that we can
+    // adjust that stream's window if the page turns out to be unused.
+    entry->readahead_stream = readahead_stream;
+    stream = find_readahead_stream(cache, readahead_stream);
+    if (stream) stream->readahead_pages++;
   }
   if (isprefetch && !isreadahead && !(entry->prefetch_diags_flags & ENTRY_FLAGS_PREFETCHED)) {
     entry->prefetch_diags_flags |= ENTRY_FLAGS_PREFETCHED;
@@ -3143,8 +3954,8 @@ int cache_get_in_page(struct rdcache_s* cache,
   // if we are currently doing a readahead.
   if( ENABLE_READAHEAD ) {
     if( sequential_readahead_length > 0 && ra_page == ra_first_page ) {
-      // forward readahead
-      readahead_skip = size;
+      // forward readahead; the next window starts just after this one.
+      readahead_skip = ra_last_page + CACHEPAGE_SIZE - ra_first_page;
       readahead_len = sequential_readahead_length;
     }
     if( sequential_readahead_length < 0 && ra_page == ra_last_page ) {
@@ -3159,12 +3970,16 @@ int cache_get_in_page(struct rdcache_s* cache,
   // It could come from just above or from readahead start.
   if( ENABLE_READAHEAD && readahead_len ) {
 
-    INFO_PRINT(("%i saving for %i:%p skip %i len %i\n",
+    INFO_PRINT(("%i saving for %i:%p skip %i len %i stream %i\n",
                  (int) chpl_nodeID, (int) node, (void*) entry->base.raddr,
-                 (int) readahead_skip, (int) readahead_len));
+                 (int) readahead_skip, (int) readahead_len,
+                 (int) readahead_stream));
 
     entry->readahead_skip = readahead_skip;
     entry->readahead_len = readahead_len;
+    // A trigger set up by within-page detection has no stream yet;
+    // one is started when the trigger fires.
+    entry->readahead_stream = readahead_stream;
   }
 
   // Update the last read location on a miss
@@ -3192,8 +4007,9 @@ int cache_get_in_page(struct rdcache_s* cache,
     // If we're not prefetching... wait for the get to complete and copy it
     // back out of the cache.
 
-    chpl_comm_wait_nb_some(&handle, 1);
-    if (EXTRA_YIELDS) {
+    if (!shared_hit)
+      cache_comm_wait_nb_some(&handle, 1);
+    if (EXTRA_YIELDS && !shared_hit) {
       TRACE_YIELD_PRINT(("%d: task %d cache %p yielding in cache_get_in_page "
                          "for chpl_comm_wait_nb_some\n",
                          chpl_nodeID, (int) chpl_task_getId(), cache));
@@ -3208,6 +4024,10 @@ int cache_get_in_page(struct rdcache_s* cache,
     assert(entry->page && entry->entryReservedByTask == task_local);
     assert(entry->base.raddr == ra_page && entry->base.node == node);
 
+    if (shared_fill)
+      shared_cache_publish(node, ra_page, entry->page,
+                           shared_version, shared_fill_epoch);
+
     // Then, copy it out.
     chpl_memcpy(addr, entry->page + (raddr-ra_page), size);
 
@@ -3243,14 +4063,15 @@ int cache_get_in_page(struct rdcache_s* cache,
 
 // If addr == NULL, this will prefetch.
 // Returns 1 if all of the data was in the cache.
-// sequential_readahead_length is only non-zero when doing
-// readaheads.
+// sequential_readahead_length and readahead_stream are only non-zero
+// when doing readaheads.
 static
 int cache_get(struct rdcache_s* cache,
               chpl_cache_taskPrvData_t* task_local,
               unsigned char * addr,
               c_nodeid_t node, raddr_t raddr, size_t size,
               int sequential_readahead_length,
+              uint32_t readahead_stream,
               int32_t commID, int ln, int32_t fn)
 {
   raddr_t ra_first_page;
@@ -3266,6 +4087,7 @@ int cache_get(struct rdcache_s* cache,
 #endif
   int hit;
   int all_hits = 1;
+  raddr_t max_pages;
 
   INFO_PRINT(("%i cache_get addr %p from %i:%p len %i ra_len %i\n",
                (int) chpl_nodeID, addr, (int) node, (void*) raddr, (int) size, sequential_readahead_length));
@@ -3287,8 +4109,12 @@ int cache_get(struct rdcache_s* cache,
 
   // If the request is too large to reasonably fit in the cache, limit
   // the amount of data prefetched. (or do nothing?)
-  if( isprefetch && (ra_last_page-ra_first_page)/CACHEPAGE_SIZE+1 > MAX_PAGES_PER_PREFETCH ) {
-    ra_last_page = ra_first_page + CACHEPAGE_SIZE*MAX_PAGES_PER_PREFETCH;
+  // Readahead windows are already limited by the stream logic.
+  max_pages = (sequential_readahead_length != 0) ?
+              (raddr_t) cache->max_readahead_pages :
+              (raddr_t) MAX_PAGES_PER_PREFETCH;
+  if( isprefetch && (ra_last_page-ra_first_page)/CACHEPAGE_SIZE+1 > max_pages ) {
+    ra_last_page = ra_first_page + CACHEPAGE_SIZE*(max_pages-1);
   }
 
   // Try to find it in the cache. Go through one page at a time.
@@ -3309,6 +4135,7 @@ int cache_get(struct rdcache_s* cache,
                             node, requested_start, requested_size,
                             ra_first_page, ra_last_page,
                             sequential_readahead_length,
+                            readahead_stream,
                             commID, ln, fn);
 
     all_hits = all_hits && hit;
@@ -3616,6 +4443,83 @@ void cache_invalidate(struct rdcache_s* cache,
   }
 }
 
+// Write back the dirty pages for 'node' together, as a batch of
+// unordered puts that are completed with one task fence, instead
+// of with one non-blocking put per dirty region. This lets the comm
+// layer combine scattered writes to one node.
+//
+// Only entries that can be "lock"ed without waiting are included.
+// Returns 0 (having done nothing) if there are fewer than 2 such entries.
+static
+int cache_clean_dirty_coalesced(struct rdcache_s* cache,
+                                chpl_cache_taskPrvData_t* task_local,
+                                c_nodeid_t node)
+{
+  struct cache_entry_s* entries[MAX_COALESCED_DIRTY_PAGES];
+  struct dirty_entry_s* cur;
+  int n = 0;
+  int i;
+  uint64_t bytes = 0;
+
+  for( cur = cache->dirty_lru_head;
+       cur && cur->entry && n < MAX_COALESCED_DIRTY_PAGES;
+       cur = cur->next ) {
+    struct cache_entry_s* entry = cur->entry;
+
+    if( entry->base.node != node ) continue;
+    // Entries with pending puts are left to flush_entry, which waits
+    // for them before writing the page again.
+    if( entry->max_put_sequence_number > cache->completed_request_number )
+      continue;
+    if( !try_reserve_entry(cache, task_local, entry) ) continue;
+
+    entries[n++] = entry;
+  }
+
+  if( n < 2 ) {
+    for( i = 0; i < n; i++ ) unreserve_entry(cache, task_local, entries[i]);
+    return 0;
+  }
+
+  // Note: the puts and the task fence below can yield, but the
+  // entries are locked.
+  for( i = 0; i < n; i++ ) {
+    struct cache_entry_s* entry = entries[i];
+    uint64_t *dirty_bits = entry->dirty->dirty;
+    uintptr_t start = 0;
+    uintptr_t got_skip, got_len;
+
+    while( get_skip_len_for_valids(dirty_bits, start, &got_skip, &got_len,
+                                   CACHEPAGE_BITMASK_WORDS) ) {
+      DEBUG_PRINT(("chpl_comm_put_unordered(%p, %i, %p, %i)\n",
+             entry->page+got_skip, node,
+             (void*) (entry->base.raddr+got_skip), (int) got_len));
+
+      cache_comm_put_unordered(entry->page+got_skip, /*local addr*/
+                              node,
+                              (void*)(entry->base.raddr+got_skip),
+                              got_len /*size*/,
+                              CHPL_COMM_UNKNOWN_ID, -1, 0);
+      bytes += got_len;
+
+      // Move past this region of 1s in dirty bits.
+      start = got_skip + got_len;
+    }
+  }
+
+  cache_comm_getput_unordered_task_fence();
+  chpl_comm_diags_add(cache_coalesced_put_bytes, bytes);
+
+  for( i = 0; i < n; i++ ) {
+    assert(entries[i]->entryReservedByTask == task_local);
+    // The data is written, so any other task can reuse the dirty structure.
+    if( entries[i]->dirty ) release_dirty(cache, entries[i]);
+    unreserve_entry(cache, task_local, entries[i]);
+  }
+
+  return 1;
+}
+
 static
 void cache_clean_dirty(struct rdcache_s* cache,
                        chpl_cache_taskPrvData_t* task_local)
@@ -3631,6 +4535,10 @@ void cache_clean_dirty(struct rdcache_s* cache,
 
     victim = cur->entry;
 
+    if (ENABLE_PUT_COALESCING &&
+        cache_clean_dirty_coalesced(cache, task_local, victim->base.node))
+      continue;
+
     if (!try_reserve_entry(cache, task_local, victim)) {
       // couldn't reserve entry - yield and try the lookup again
       TRACE_YIELD_PRINT(("%d: task %d cache %p yielding in clean_dirty\n",
@@ -3753,6 +4661,152 @@ void chpl_cache_do_init(void)
   pthread_mutex_unlock(&is_inited_mutex);
 }
 
+// Returns log2(x) if x is a power of 2 and -1 otherwise.
+static
+int log2_if_pow2(int64_t x)
+{
+  int bits = 0;
+
+  if (x <= 0 || (x & (x - 1)) != 0) return -1;
+
+  while (((int64_t) 1 << bits) < x) bits++;
+
+  return bits;
+}
+
+static
+void cache_geometry_warning(const char* ev, int64_t got, int64_t using)
+{
+  char msg[200];
+
+  if (chpl_nodeID != 0) return;
+
+  snprintf(msg, sizeof(msg),
+           "CHPL_RT_%s=%" PRId64 " is not supported by --cache-remote; "
+           "using %" PRId64 " instead",
+           ev, got, using);
+  chpl_warning(msg, 0, 0);
+}
+
+// Set the cache page size, line size, and pages per cache from the
+// environment. This has to happen before any cache is created.
+static
+void cache_init_geometry(void)
+{
+  int64_t page_size, lines_per_page, entries;
+  int page_bits, lines_bits, entries_bits;
+  int max_page_bits;
+
+  // Don't allow cache pages larger than a system page, since readahead
+  // relies on being able to GET a whole cache page at a time.
+  max_page_bits = MAX_CACHEPAGE_BITS;
+  while (max_page_bits > MIN_CACHEPAGE_BITS &&
+         ((size_t) 1 << max_page_bits) > sys_page_size()) {
+    max_page_bits--;
+  }
+
+  page_size = (int64_t) chpl_env_rt_get_size("CACHE_PAGE_SIZE",
+                                             1 << DEFAULT_CACHEPAGE_BITS);
+  page_bits = log2_if_pow2(page_size);
+  if (page_bits < 0) {
+    page_bits = DEFAULT_CACHEPAGE_BITS;
+  } else if (page_bits < MIN_CACHEPAGE_BITS) {
+    page_bits = MIN_CACHEPAGE_BITS;
+  } else if (page_bits > max_page_bits) {
+    page_bits = max_page_bits;
+  }
+  if (page_size != ((int64_t) 1 << page_bits)) {
+    cache_geometry_warning("CACHE_PAGE_SIZE", page_size,
+                           (int64_t) 1 << page_bits);
+  }
+
+  // By default, keep the default line size as the page size changes.
+  lines_per_page = chpl_env_rt_get_int("CACHE_LINES_PER_PAGE",
+                                       (int64_t) 1 << (page_bits -
+                                                       DEFAULT_CACHELINE_BITS));
+  lines_bits = log2_if_pow2(lines_per_page);
+  if (lines_bits < 0) {
+    lines_bits = page_bits - DEFAULT_CACHELINE_BITS;
+  } else if (page_bits - lines_bits < MIN_CACHELINE_BITS) {
+    lines_bits = page_bits - MIN_CACHELINE_BITS;
+  }
+  if (lines_per_page != ((int64_t) 1 << lines_bits)) {
+    cache_geometry_warning("CACHE_LINES_PER_PAGE", lines_per_page,
+                           (int64_t) 1 << lines_bits);
+  }
+
+  // The lookup table size is computed from this, so it
+  // needs to be a power of 2.
+  entries = chpl_env_rt_get_int("CACHE_ENTRIES", DEFAULT_CACHE_PAGES);
+  entries_bits = log2_if_pow2(entries);
+  if (entries_bits < 0) {
+    entries_bits = log2_if_pow2(DEFAULT_CACHE_PAGES);
+    if (entries > 0) {
+      // round down to a power of 2
+      entries_bits = 0;
+      while (((int64_t) 1 << (entries_bits + 1)) <= entries) entries_bits++;
+    }
+  }
+  if (((int64_t) 1 << entries_bits) < MIN_CACHE_PAGES) {
+    entries_bits = log2_if_pow2(MIN_CACHE_PAGES);
+  } else if (((int64_t) 1 << entries_bits) > MAX_CACHE_PAGES) {
+    entries_bits = log2_if_pow2(MAX_CACHE_PAGES);
+  }
+  if (entries != ((int64_t) 1 << entries_bits)) {
+    cache_geometry_warning("CACHE_ENTRIES", entries,
+                           (int64_t) 1 << entries_bits);
+  }
+
+  cachepage_bits = page_bits;
+  cacheline_bits = page_bits - lines_bits;
+  cache_pages_per_cache = 1 << entries_bits;
+
+  assert(CACHEPAGE_BITMASK_WORDS <= MAX_CACHEPAGE_SIZE / 64);
+  assert(CACHE_LINES_PER_PAGE_BITMASK_WORDS <=
+         MAX_CACHE_LINES_PER_PAGE_BITMASK_WORDS);
+}
+
+// Set up the shared cache tier, if it was requested.
+static
+void shared_cache_create(void)
+{
+  struct shared_cache_s* s;
+  int64_t nslots;
+  int bits;
+  unsigned char* pages;
+  int64_t i;
+
+  if (!chpl_env_rt_get_bool("CACHE_SHARED", false))
+    return;
+
+  nslots = chpl_env_rt_get_int("CACHE_SHARED_ENTRIES",
+                               DEFAULT_SHARED_CACHE_PAGES);
+  if (nslots < 1) nslots = DEFAULT_SHARED_CACHE_PAGES;
+  // round down to a power of 2
+  bits = 0;
+  while (((int64_t) 1 << (bits + 1)) <= nslots) bits++;
+  if (nslots != ((int64_t) 1 << bits)) {
+    cache_geometry_warning("CACHE_SHARED_ENTRIES", nslots,
+                           (int64_t) 1 << bits);
+    nslots = (int64_t) 1 << bits;
+  }
+
+  s = chpl_malloc(sizeof(struct shared_cache_s));
+  s->slots = chpl_malloc(nslots * sizeof(struct shared_cache_slot_s));
+  pages = chpl_memalign(CACHEPAGE_SIZE, nslots * CACHEPAGE_SIZE);
+  s->nslots_mask = nslots - 1;
+  atomic_init_uint_least64_t(&s->epoch, 1);
+  for (i = 0; i < nslots; i++) {
+    atomic_init_uint_least64_t(&s->slots[i].version, 0);
+    s->slots[i].node = -1;
+    s->slots[i].raddr = 0;
+    s->slots[i].fill_epoch = 0;
+    s->slots[i].page = pages + i * CACHEPAGE_SIZE;
+  }
+
+  shared_cache = s;
+}
+
 // The implementation of functions in chpl-cache.h
 
 void chpl_cache_init(void) {
@@ -3766,6 +4820,10 @@ void chpl_cache_init(void) {
   }
 
   //printf("CACHE IS ENABLED\n");
+  cache_init_geometry();
+  shared_cache_create();
+  cache_site_stats_create();
+  cache_trace_init();
   chpl_cache_do_init();
 }
 
@@ -3775,6 +4833,29 @@ void chpl_cache_exit(void)
 }
 
 
+static
+void cache_fence(struct rdcache_s* cache,
+                 chpl_cache_taskPrvData_t* task_local,
+                 int acquire, int release)
+{
+  if( acquire ) {
+    task_local->last_acquire = cache->next_request_number;
+    cache->next_request_number++;
+  }
+
+  if( release ) {
+    cache_clean_dirty(cache, task_local);
+    wait_all(cache);
+  }
+
+  if( shared_cache ) {
+    // Start a new shared tier epoch after any writes have completed,
+    // so that this task can use the shared tier again after a release.
+    if( release ) task_local->skip_shared_cache = 0;
+    cache->shared_epoch = shared_cache_new_epoch();
+  }
+}
+
 void chpl_cache_fence(int acquire, int release, int ln, int32_t fn)
 {
   struct rdcache_s* cache = tls_cache_remote_data();
@@ -3793,20 +4874,16 @@ void chpl_cache_fence(int acquire, int release, int ln, int32_t fn)
                      chpl_nodeID, (int) chpl_task_getId(), acquire, release,
                      cache, chpl_lookupFilename(fn), ln));
 
+  if( acquire ) cache_trace_record(cache, CACHE_TRACE_ACQUIRE, 0, 0, 0);
+  if( release ) cache_trace_record(cache, CACHE_TRACE_RELEASE, 0, 0, 0);
+
 #ifdef DUMP
   DEBUG_PRINT(("%d: task %d before fence\n", chpl_nodeID, (int) chpl_task_getId()));
   chpl_cache_print();
 #endif
 
-  if( acquire ) {
-    task_local->last_acquire = cache->next_request_number;
-    cache->next_request_number++;
-  }
+  cache_fence(cache, task_local, acquire, release);
 
-  if( release ) {
-    cache_clean_dirty(cache, task_local);
-    wait_all(cache);
-  }
 #ifdef DUMP
   DEBUG_PRINT(("%d: task %d after fence\n", chpl_nodeID, (int) chpl_task_getId()));
   chpl_cache_print();
@@ -3827,6 +4904,7 @@ void chpl_cache_invalidate(c_nodeid_t node, void* raddr, size_t size,
                chpl_lookupFilename(fn), ln,
                (int)size, node, raddr));
 
+  cache_trace_record(cache, CACHE_TRACE_INVALIDATE, node, (raddr_t)raddr, size);
   cache_invalidate(cache, task_local, node, (raddr_t)raddr, size);
 }
 
@@ -3847,6 +4925,11 @@ void chpl_cache_comm_put(void* addr, c_nodeid_t node, void* raddr,
   chpl_cache_taskPrvData_t* task_local = task_private_cache_data();
   int all_hits;
 
+  shared_cache_note_write(task_local);
+
+  if (cache)
+    cache_trace_record(cache, CACHE_TRACE_PUT, node, (raddr_t)raddr, size);
+
   if (!cache || size_merits_direct_comm(cache, size)) {
     if (cache)
       cache_invalidate(cache, task_local, node, (raddr_t)raddr, size);
@@ -3895,6 +4978,9 @@ void chpl_cache_comm_get(void *addr, c_nodeid_t node, void* raddr,
   chpl_cache_taskPrvData_t* task_local = task_private_cache_data();
   int all_hits;
 
+  if (cache)
+    cache_trace_record(cache, CACHE_TRACE_GET, node, (raddr_t)raddr, size);
+
   if (!cache || size_merits_direct_comm(cache, size)) {
     if (cache)
       cache_invalidate(cache, task_local, node, (raddr_t)raddr, size);
@@ -3924,13 +5010,16 @@ void chpl_cache_comm_get(void *addr, c_nodeid_t node, void* raddr,
 
   all_hits = cache_get(cache, task_local,
                        addr, node, (raddr_t)raddr, size,
-                       0, commID, ln, fn);
+                       0, 0, commID, ln, fn);
 
   if (size != 0) {
     if (all_hits)
       chpl_comm_diags_incr(cache_get_hits);
     else
       chpl_comm_diags_incr(cache_get_misses);
+
+    if (cache_site_stats)
+      cache_site_record_get(ln, fn, size, all_hits);
   }
 
   return;
@@ -3947,16 +5036,65 @@ void chpl_cache_comm_prefetch(c_nodeid_t node, void* raddr,
 
   TRACE_PRINT(("%d: in chpl_cache_comm_prefetch\n", chpl_nodeID));
 
+  cache_trace_record(cache, CACHE_TRACE_PREFETCH, node, (raddr_t)raddr, size);
+
   chpl_comm_diags_verbose_rdma("prefetch", node, size, ln, fn, commID);
 
   // Always use the cache for prefetches.
   cache_get(cache, task_local,
             /* addr */ NULL, node, (raddr_t)raddr, size,
             /* sequential_readahead_length */ 0,
+            /* readahead_stream */ 0,
             CHPL_COMM_UNKNOWN_ID, ln, fn);
 
 }
 
+void chpl_cache_comm_prefetch_many(c_nodeid_t node, int32_t n,
+                                   void* const* raddrs, size_t size,
+                                   int32_t commID, int ln, int32_t fn)
+{
+  struct rdcache_s* cache = tls_cache_remote_data();
+  chpl_cache_taskPrvData_t* task_local = task_private_cache_data();
+  raddr_t last_page = 0;
+  unsigned int max_pages;
+  unsigned int npages = 0;
+  int32_t i;
+
+  // Do nothing if the cache is not yet inited
+  if (!cache || size == 0) return;
+
+  TRACE_PRINT(("%d: in chpl_cache_comm_prefetch_many %d addresses\n",
+               chpl_nodeID, (int) n));
+
+  // Don't prefetch so much at once that the later prefetches
+  // evict the earlier ones from Ain before they are used.
+  max_pages = cache->ain_max / 2;
+
+  for( i = 0; i < n && npages < max_pages; i++ ) {
+    raddr_t raddr = (raddr_t) raddrs[i];
+    raddr_t ra_page = round_down_to_mask(raddr, CACHEPAGE_MASK);
+
+    // Skip addresses on the page we just prefetched; gathers often
+    // have several nearby indices in a row.
+    if( i > 0 && ra_page == last_page &&
+        round_down_to_mask(raddr+size-1, CACHEPAGE_MASK) == ra_page )
+      continue;
+
+    chpl_comm_diags_verbose_rdma("prefetch", node, size, ln, fn, commID);
+    cache_trace_record(cache, CACHE_TRACE_PREFETCH, node, raddr, size);
+
+    // Each of these only starts the GET (or finds the data cached).
+    cache_get(cache, task_local,
+              /* addr */ NULL, node, raddr, size,
+              /* sequential_readahead_length */ 0,
+              /* readahead_stream */ 0,
+              CHPL_COMM_UNKNOWN_ID, ln, fn);
+
+    last_page = round_down_to_mask(raddr+size-1, CACHEPAGE_MASK);
+    npages += (last_page - ra_page) / CACHEPAGE_SIZE + 1;
+  }
+}
+
 struct cache_strd_callback_ctx {
   struct rdcache_s* cache;
   chpl_cache_taskPrvData_t* task_local;
@@ -3978,6 +5116,7 @@ void strd_invalidate_fn(void* addr,
   struct rdcache_s* cache = ctx->cache;
   chpl_cache_taskPrvData_t* task_local = ctx->task_local;
 
+  cache_trace_record(cache, CACHE_TRACE_INVALIDATE, node, (raddr_t)raddr, size);
   cache_invalidate(cache, task_local, node, (raddr_t)raddr, size);
 }
 
@@ -4046,6 +5185,8 @@ void chpl_cache_comm_put_strd(void *addr, void *dststr, c_nodeid_t node,
                               int32_t commID, int ln, int32_t fn) {
   TRACE_PRINT(("%d: in chpl_cache_comm_put_strd\n", chpl_nodeID));
 
+  shared_cache_note_write(task_private_cache_data());
+
   if (STRIDED_INVALIDATE_ALL) {
     // do a full fence - so that:
     // 1) any pending writes are completed (in case they were to the
@@ -4088,8 +5229,12 @@ void chpl_cache_comm_put_unordered(void* addr, c_nodeid_t node, void* raddr,
   struct rdcache_s* cache = tls_cache_remote_data();
   chpl_cache_taskPrvData_t* task_local = task_private_cache_data();
 
-  if (cache)
+  shared_cache_note_write(task_local);
+
+  if (cache) {
+    cache_trace_record(cache, CACHE_TRACE_INVALIDATE, node, (raddr_t)raddr, size);
     cache_invalidate(cache, task_local, node, (raddr_t)raddr, size);
+  }
 
   chpl_comm_put_unordered(addr, node, raddr, size, commID, ln, fn);
 
@@ -4110,8 +5255,10 @@ void chpl_cache_comm_get_unordered(void *addr, c_nodeid_t node, void* raddr,
   struct rdcache_s* cache = tls_cache_remote_data();
   chpl_cache_taskPrvData_t* task_local = task_private_cache_data();
 
-  if (cache)
+  if (cache) {
+    cache_trace_record(cache, CACHE_TRACE_INVALIDATE, node, (raddr_t)raddr, size);
     cache_invalidate(cache, task_local, node, (raddr_t)raddr, size);
+  }
 
   chpl_comm_get_unordered(addr, node, raddr, size, commID, ln, fn);
 
@@ -4135,7 +5282,13 @@ void chpl_cache_comm_getput_unordered(c_nodeid_t dstnode, void* dstaddr,
   struct rdcache_s* cache = tls_cache_remote_data();
   chpl_cache_taskPrvData_t* task_local = task_private_cache_data();
 
+  shared_cache_note_write(task_local);
+
   if (cache) {
+    cache_trace_record(cache, CACHE_TRACE_INVALIDATE,
+                       srcnode, (raddr_t)srcaddr, size);
+    cache_trace_record(cache, CACHE_TRACE_INVALIDATE,
+                       dstnode, (raddr_t)dstaddr, size);
     cache_invalidate(cache, task_local, srcnode, (raddr_t)srcaddr, size);
     cache_invalidate(cache, task_local, dstnode, (raddr_t)dstaddr, size);
   }
@@ -4252,6 +5405,89 @@ void chpl_cache_print_stats(void) {
          n_colliding_slots, n_full_slots, n_used_slots, table_slots,
          n_full_subslots, n_subslots,
          n_bottom_entries, cache->max_entries);
+
+  for (int i = 0; i < READAHEAD_STREAMS; i++) {
+    struct readahead_stream_s* stream = &cache->readahead_streams[i];
+    if (stream->id == 0)
+      continue;
+
+    printf("%d: task %d cache readahead stream %u "
+           "node=%i window=%i/%i pages "
+           "readahead=%llu wasted=%llu pages\n",
+           chpl_nodeID, (int) chpl_task_getId(),
+           (unsigned int) stream->id,
+           (int) stream->node,
+           stream->window_pages, cache->max_readahead_pages,
+           (unsigned long long) stream->readahead_pages,
+           (unsigned long long) stream->wasted_pages);
+  }
+
+  chpl_cache_print_site_stats();
+}
+
+struct cache_site_report_s {
+  uint64_t key;
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t bytes;
+  uint64_t readahead_wasted;
+};
+
+// sort by misses, then by unused readahead pages, most first
+static
+int cache_site_report_cmp(const void* a, const void* b)
+{
+  const struct cache_site_report_s* x = (const struct cache_site_report_s*) a;
+  const struct cache_site_report_s* y = (const struct cache_site_report_s*) b;
+
+  if (x->misses != y->misses) return (x->misses < y->misses) ? 1 : -1;
+  if (x->readahead_wasted != y->readahead_wasted)
+    return (x->readahead_wasted < y->readahead_wasted) ? 1 : -1;
+  return 0;
+}
+
+void chpl_cache_print_site_stats(void) {
+  struct cache_site_report_s* report;
+  int n = 0;
+  int i;
+
+  if (cache_site_stats == NULL) return;
+
+  report = chpl_malloc(CACHE_SITE_STATS_SLOTS *
+                       sizeof(struct cache_site_report_s));
+
+  for (i = 0; i < CACHE_SITE_STATS_SLOTS; i++) {
+    struct cache_site_stats_s* s = &cache_site_stats[i];
+    uint64_t key = atomic_load_uint_least64_t(&s->key);
+    if (key == CACHE_SITE_EMPTY) continue;
+
+    report[n].key = key;
+    report[n].hits = atomic_load_uint_least64_t(&s->hits);
+    report[n].misses = atomic_load_uint_least64_t(&s->misses);
+    report[n].bytes = atomic_load_uint_least64_t(&s->bytes);
+    report[n].readahead_wasted =
+      atomic_load_uint_least64_t(&s->readahead_wasted);
+    n++;
+  }
+
+  qsort(report, n, sizeof(struct cache_site_report_s), cache_site_report_cmp);
+
+  printf("%d: cache statistics by call site (%i sites, sorted by misses)\n",
+         chpl_nodeID, n);
+  for (i = 0; i < n && i < CACHE_SITE_STATS_REPORT_LINES; i++) {
+    int32_t fn = (int32_t) (uint32_t) (report[i].key >> 32);
+    int ln = (int) (uint32_t) report[i].key;
+
+    printf("%d:   %s:%d hits=%llu misses=%llu bytes=%llu "
+           "readahead_wasted=%llu pages\n",
+           chpl_nodeID, chpl_lookupFilename(fn), ln,
+           (unsigned long long) report[i].hits,
+           (unsigned long long) report[i].misses,
+           (unsigned long long) report[i].bytes,
+           (unsigned long long) report[i].readahead_wasted);
+  }
+
+  chpl_free(report);
 }
 
 // Returns 1 if the data was already cached
@@ -4282,5 +5518,156 @@ int chpl_cache_mock_get(c_nodeid_t node, uint64_t raddr, size_t size)
 }
 
 
+
+// Writes out the buffered records of every open trace.
+void chpl_cache_flush_traces(void)
+{
+  struct cache_trace_s* t;
+
+  pthread_mutex_lock(&cache_traces_mutex);
+  for (t = cache_traces; t != NULL; t = t->next) {
+    cache_trace_write_out(t);
+    fflush(t->file);
+  }
+  pthread_mutex_unlock(&cache_traces_mutex);
+}
+
+// Runs the operations in a trace written with CHPL_RT_CACHE_TRACE
+// through a new cache, using the current CHPL_RT_CACHE_* settings,
+// but without communicating. Prints what the cache would have done.
+// Returns 0 on success.
+int chpl_cache_replay_trace(const char* path)
+{
+  struct cache_trace_header_s header;
+  struct cache_trace_record_s r;
+  chpl_cache_taskPrvData_t task_local;
+  struct rdcache_s* cache;
+  unsigned char* scratch;
+  uint64_t records = 0;
+  uint64_t get_hits = 0, get_misses = 0;
+  uint64_t put_hits = 0, put_misses = 0;
+  uint64_t prefetches = 0, fences = 0;
+  uint64_t direct_bytes = 0;
+  char msg[1100];
+  FILE* f;
+
+  if (!chpl_cache_enabled())
+    chpl_internal_error("chpl_cache_replay_trace called without --cache-remote");
+
+  f = fopen(path, "rb");
+  if (f == NULL) {
+    snprintf(msg, sizeof(msg), "could not open cache trace file %s", path);
+    chpl_warning(msg, 0, 0);
+    return 1;
+  }
+
+  if (fread(&header, sizeof(header), 1, f) != 1 ||
+      memcmp(header.magic, CACHE_TRACE_MAGIC, sizeof(header.magic)) != 0 ||
+      header.version != CACHE_TRACE_VERSION) {
+    snprintf(msg, sizeof(msg), "%s is not a cache trace file", path);
+    chpl_warning(msg, 0, 0);
+    fclose(f);
+    return 1;
+  }
+
+  // The wrappers for the cache's own communication check this, so
+  // no other task on this locale should use the cache during a replay.
+  cache_simulating = true;
+  cache_sim_bytes_got = 0;
+  cache_sim_bytes_put = 0;
+
+  cache = cache_create();
+  memset(&task_local, 0, sizeof(task_local));
+  scratch = chpl_malloc(CACHEPAGE_SIZE);
+  memset(scratch, 0, CACHEPAGE_SIZE);
+
+  while (fread(&r, sizeof(r), 1, f) == 1) {
+    c_nodeid_t node = r.node;
+    raddr_t raddr = (raddr_t) r.raddr;
+    size_t size = (size_t) r.size;
+
+    records++;
+
+    // The cache never holds data for its own locale, so swap the
+    // recording locale's id with ours.
+    if (node == chpl_nodeID) node = header.node;
+    else if (node == header.node) node = chpl_nodeID;
+
+    switch (r.op) {
+      case CACHE_TRACE_GET:
+        if (size_merits_direct_comm(cache, size)) {
+          cache_invalidate(cache, &task_local, node, raddr, size);
+          direct_bytes += size;
+        } else if (size != 0) {
+          if (cache_get(cache, &task_local, scratch, node, raddr, size,
+                        0, 0, CHPL_COMM_UNKNOWN_ID, -1, 0))
+            get_hits++;
+          else
+            get_misses++;
+        }
+        break;
+      case CACHE_TRACE_PUT:
+        if (size_merits_direct_comm(cache, size)) {
+          cache_invalidate(cache, &task_local, node, raddr, size);
+          direct_bytes += size;
+        } else if (size != 0) {
+          if (cache_put(cache, &task_local, scratch, node, raddr, size,
+                        CHPL_COMM_UNKNOWN_ID, -1, 0))
+            put_hits++;
+          else
+            put_misses++;
+        }
+        break;
+      case CACHE_TRACE_PREFETCH:
+        cache_get(cache, &task_local, NULL, node, raddr, size,
+                  0, 0, CHPL_COMM_UNKNOWN_ID, -1, 0);
+        prefetches++;
+        break;
+      case CACHE_TRACE_ACQUIRE:
+        cache_fence(cache, &task_local, 1, 0);
+        fences++;
+        break;
+      case CACHE_TRACE_RELEASE:
+        cache_fence(cache, &task_local, 0, 1);
+        fences++;
+        break;
+      case CACHE_TRACE_INVALIDATE:
+        cache_invalidate(cache, &task_local, node, raddr, size);
+        break;
+      default:
+        snprintf(msg, sizeof(msg),
+                 "unknown operation %u in cache trace file %s",
+                 (unsigned) r.op, path);
+        chpl_warning(msg, 0, 0);
+        break;
+    }
+  }
+
+  // Account for the writes still in the cache at the end of the trace.
+  cache_fence(cache, &task_local, 0, 1);
+
+  printf("%s: %llu operations recorded on locale %d\n",
+         path, (unsigned long long) records, (int) header.node);
+  printf("  cache pages %d of %d bytes, readahead up to %d pages\n",
+         cache->max_pages, (int) CACHEPAGE_SIZE, cache->max_readahead_pages);
+  printf("  gets: %llu hits %llu misses\n",
+         (unsigned long long) get_hits, (unsigned long long) get_misses);
+  printf("  puts: %llu hits %llu misses\n",
+         (unsigned long long) put_hits, (unsigned long long) put_misses);
+  printf("  prefetches: %llu fences: %llu\n",
+         (unsigned long long) prefetches, (unsigned long long) fences);
+  printf("  bytes got %llu put %llu direct %llu\n",
+         (unsigned long long) cache_sim_bytes_got,
+         (unsigned long long) cache_sim_bytes_put,
+         (unsigned long long) direct_bytes);
+
+  chpl_free(scratch);
+  cache_destroy(cache);
+  cache_simulating = false;
+  fclose(f);
+
+  return 0;
+}
+
 #endif
 // end ifdef HAS_CHPL_CACHE_FNS
@@ -28,12 +28,18 @@
 #include "chpl-comm.h"
 #include "chpl-comm-diags.h"
 #include "chpl-comm-internal.h"
+#include "chpl-env.h"
+#include "chpl-mem.h"
 #include "chpl-mem-consistency.h"
+#include "chpl-thread-local-storage.h"
 #include "error.h"
 
+#include <inttypes.h>
+#include <pthread.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 int chpl_verbose_comm = 0;
 int chpl_verbose_comm_stacktrace = 0;
@@ -44,6 +50,162 @@ chpl_atomic_commDiagnostics chpl_comm_diags_counters;
 
 static pthread_once_t bcastPrintUnstable_once = PTHREAD_ONCE_INIT;
 
+int chpl_comm_diags_hist = 0;
+
+//
+// Histogram buckets are per-thread, so recording is just a couple of
+// unsynchronized increments.  Each thread's buckets are linked onto a
+// list the first time it records something, and the list is folded
+// into hist_totals when diagnostics are stopped.  Counts read while
+// diagnostics are still on may be slightly stale.
+//
+typedef struct hist_tl {
+  chpl_commHistograms h;
+  struct hist_tl* next;
+} hist_tl_t;
+
+static CHPL_TLS_DECL_INIT(hist_tl_t*, hist_tl);
+static hist_tl_t* hist_tl_list;
+static pthread_mutex_t hist_mutex = PTHREAD_MUTEX_INITIALIZER;
+static chpl_commHistograms hist_totals;
+
+static const char* hist_op_names[] = {
+#define _COMM_DIAGS_HIST_NAME(op) #op,
+  CHPL_COMM_DIAGS_HIST_OPS_ALL(_COMM_DIAGS_HIST_NAME)
+#undef _COMM_DIAGS_HIST_NAME
+};
+
+
+static inline
+int hist_bucket(uint64_t v) {
+  return (v == 0) ? 0 : 64 - __builtin_clzll(v);
+}
+
+
+void chpl_comm_diags_hist_init(void) {
+  CHPL_TLS_INIT(hist_tl);
+  chpl_comm_diags_hist = chpl_env_rt_get_bool("COMM_DIAGS_HISTOGRAMS", false);
+}
+
+
+void chpl_comm_diags_hist_record(chpl_comm_diags_hist_op_t op, size_t size,
+                                 uint64_t t0) {
+  hist_tl_t* tl = CHPL_TLS_GET(hist_tl);
+  if (tl == NULL) {
+    tl = chpl_mem_allocManyZero(1, sizeof(*tl),
+                                CHPL_RT_MD_COMM_PER_LOC_INFO, 0, 0);
+    pthread_mutex_lock(&hist_mutex);
+    tl->next = hist_tl_list;
+    hist_tl_list = tl;
+    pthread_mutex_unlock(&hist_mutex);
+    CHPL_TLS_SET(hist_tl, tl);
+  }
+
+  uint64_t t1 = chpl_comm_diags_hist_now();
+  uint64_t lat = (t1 > t0) ? t1 - t0 : 0;
+  int lb = hist_bucket(lat);
+  int sb = hist_bucket(size);
+  tl->h.latency[op][lb < CHPL_COMM_DIAGS_HIST_BUCKETS
+                    ? lb : CHPL_COMM_DIAGS_HIST_BUCKETS - 1]++;
+  tl->h.size[op][sb < CHPL_COMM_DIAGS_HIST_BUCKETS
+                 ? sb : CHPL_COMM_DIAGS_HIST_BUCKETS - 1]++;
+}
+
+
+//
+// Fold the per-thread buckets into dst.  If 'clear' is set, the
+// per-thread buckets are zeroed as they are consumed.
+//
+static
+void hist_merge(chpl_commHistograms* dst, chpl_bool clear) {
+  pthread_mutex_lock(&hist_mutex);
+  for (hist_tl_t* tl = hist_tl_list; tl != NULL; tl = tl->next) {
+    for (int op = 0; op < chpl_comm_diags_hist_num_ops; op++) {
+      for (int b = 0; b < CHPL_COMM_DIAGS_HIST_BUCKETS; b++) {
+        dst->latency[op][b] += tl->h.latency[op][b];
+        dst->size[op][b] += tl->h.size[op][b];
+      }
+    }
+    if (clear) {
+      memset(&tl->h, 0, sizeof(tl->h));
+    }
+  }
+  pthread_mutex_unlock(&hist_mutex);
+}
+
+
+chpl_atomic_uint_least64_t* chpl_comm_diags_matrix = NULL;
+static const char* matrix_prefix;
+
+
+void chpl_comm_diags_matrix_init(void) {
+  matrix_prefix = chpl_env_rt_get("COMM_DIAGS_MATRIX", NULL);
+  if (matrix_prefix == NULL || matrix_prefix[0] == '\0') {
+    return;
+  }
+
+  chpl_atomic_uint_least64_t* m =
+    chpl_mem_allocManyZero(2 * chpl_numNodes, sizeof(*m),
+                           CHPL_RT_MD_COMM_PER_LOC_INFO, 0, 0);
+  for (int i = 0; i < 2 * chpl_numNodes; i++) {
+    atomic_init_uint_least64_t(&m[i], 0);
+  }
+  chpl_comm_diags_matrix = m;
+}
+
+
+void chpl_comm_diags_matrix_reset(void) {
+  if (chpl_comm_diags_matrix == NULL) {
+    return;
+  }
+  for (int i = 0; i < 2 * chpl_numNodes; i++) {
+    atomic_store_uint_least64_t(&chpl_comm_diags_matrix[i], 0);
+  }
+}
+
+
+//
+// The row is written as two lines, ops then bytes, each with one
+// column per destination locale.  Concatenating the files for all
+// locales in nodeID order gives the dense matrices.
+//
+void chpl_comm_writeDiagsMatrixHere(void) {
+  if (chpl_comm_diags_matrix == NULL) {
+    return;
+  }
+
+  char name[1024];
+  snprintf(name, sizeof(name), "%s.%d", matrix_prefix, (int) chpl_nodeID);
+  FILE* f = fopen(name, "w");
+  if (f == NULL) {
+    char msg[1100];
+    snprintf(msg, sizeof(msg), "could not open comm matrix file %s", name);
+    chpl_warning(msg, 0, 0);
+    return;
+  }
+
+  for (int which = 0; which < 2; which++) {
+    fprintf(f, "%d %s", (int) chpl_nodeID, (which == 0) ? "ops" : "bytes");
+    for (int node = 0; node < chpl_numNodes; node++) {
+      fprintf(f, " %" PRIu64,
+              (uint64_t) atomic_load_uint_least64_t(
+                           &chpl_comm_diags_matrix[2 * node + which]));
+    }
+    fprintf(f, "\n");
+  }
+  fclose(f);
+}
+
+
+void chpl_comm_diags_hist_reset(void) {
+  pthread_mutex_lock(&hist_mutex);
+  for (hist_tl_t* tl = hist_tl_list; tl != NULL; tl = tl->next) {
+    memset(&tl->h, 0, sizeof(tl->h));
+  }
+  memset(&hist_totals, 0, sizeof(hist_totals));
+  pthread_mutex_unlock(&hist_mutex);
+}
+
 
 static
 void broadcast_print_unstable(void) {
@@ -143,6 +305,9 @@ void chpl_comm_stopDiagnostics(int32_t lineno, int32_t filename) {
     chpl_warning("comm diagnostics was never started", lineno, filename);
   }
   chpl_comm_diagnostics = 0;
+  if (chpl_comm_diags_hist) {
+    hist_merge(&hist_totals, true);
+  }
 
   chpl_bool prevDisabled = chpl_task_setCommDiagsTemporarilyDisabled(true);
   chpl_comm_bcast_rt_private(chpl_comm_diagnostics);
@@ -173,14 +338,54 @@ void chpl_comm_stopDiagnosticsHere(int32_t lineno, int32_t filename) {
     chpl_warning("comm diagnostics was never started", lineno, filename);
   }
   chpl_comm_diagnostics = 0;
+  if (chpl_comm_diags_hist) {
+    hist_merge(&hist_totals, true);
+  }
 }
 
 
 void chpl_comm_resetDiagnosticsHere(void) {
   chpl_comm_diags_reset();
+  chpl_comm_diags_hist_reset();
+  chpl_comm_diags_matrix_reset();
 }
 
 
 void chpl_comm_getDiagnosticsHere(chpl_commDiagnostics *cd) {
   chpl_comm_diags_copy(cd);
 }
+
+
+//
+// Only the locale that called chpl_comm_stopDiagnostics() folds its
+// per-thread buckets at that point, so include whatever is still
+// outstanding here as well.
+//
+void chpl_comm_getHistogramsHere(chpl_commHistograms *ch) {
+  pthread_mutex_lock(&hist_mutex);
+  *ch = hist_totals;
+  pthread_mutex_unlock(&hist_mutex);
+  hist_merge(ch, false);
+}
+
+
+void chpl_comm_printHistogramsHere(void) {
+  chpl_commHistograms ch;
+  chpl_comm_getHistogramsHere(&ch);
+
+  for (int op = 0; op < chpl_comm_diags_hist_num_ops; op++) {
+    for (int b = 0; b < CHPL_COMM_DIAGS_HIST_BUCKETS; b++) {
+      if (ch.latency[op][b] != 0) {
+        printf("%d: %s latency < 2^%d ns: %" PRIu64 "\n",
+               chpl_nodeID, hist_op_names[op], b, ch.latency[op][b]);
+      }
+    }
+    for (int b = 0; b < CHPL_COMM_DIAGS_HIST_BUCKETS; b++) {
+      if (ch.size[op][b] != 0) {
+        printf("%d: %s size < 2^%d bytes: %" PRIu64 "\n",
+               chpl_nodeID, hist_op_names[op], b, ch.size[op][b]);
+      }
+    }
+  }
+  fflush(stdout);
+}
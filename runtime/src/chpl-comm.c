@@ -33,6 +33,7 @@
 #include "chpl-env.h"
 #include "chpl-mem.h"
 #include "chpl-topo.h"
+#include "chpltimers.h"
 
 // Don't get warning macros for chpl_comm_get etc.
 #include "chpl-comm-no-warning-macros.h"
@@ -170,6 +171,7 @@ typedef struct {
   uintptr_t size;
   int tid;
   int nthreads;
+  double done; // when this thread finished, in seconds
 } memory_region;
 
 // Pin a thread a specific NUMA domain and cyclically touch pages to get
@@ -177,6 +179,8 @@ typedef struct {
 // Transparent Huge Pages (THP) are used, so we fault in regions in at least 2
 // MiB chunks to cover the most common THP size. We then touch the first
 // element of every system page or non-transparent huge page to fault in.
+// The touch is an atomic or-with-zero rather than a store, so that it can
+// run while the memory layer is already using the heap.
 static void *touch_thread(void *mem_region) {
   memory_region* mr = (memory_region*) mem_region;
 
@@ -191,12 +195,19 @@ static void *touch_thread(void *mem_region) {
   for (uintptr_t tr=mr->tid*touch_size; tr<aligned_size; tr+=mr->nthreads*touch_size) {
     // Iterate through all the page regions in the current region we're touching
     for (uintptr_t pr=tr; pr<tr+touch_size; pr+=page_size) {
-      aligned_start[pr] = 0;
+      (void) __atomic_fetch_or(&aligned_start[pr], 0, __ATOMIC_RELAXED);
     }
   }
+  mr->done = chpl_hrtimer_now();
   return NULL;
 }
 
+static int touchNumThreads;
+static pthread_t* touchThreads;
+static memory_region* touchRegions;
+static double touchStart;
+static double touchSecs;
+
 // Touch or fault-in a region of memory. Meant to be used on the registered
 // heap/segment for configurations that register a static heap.  We try to
 // touch the memory in an interleaved/cyclic fashion in parallel to improve
@@ -205,23 +216,59 @@ static void *touch_thread(void *mem_region) {
 // poor NUMA affinity with memory split evenly in massive chunks across NUMA
 // domains.
 void chpl_comm_regMemHeapTouch(void* start, uintptr_t size) {
+  chpl_comm_regMemHeapTouchAsync(start, size);
+  chpl_comm_regMemHeapTouchWait();
+}
+
+void chpl_comm_regMemHeapTouchAsync(void* start, uintptr_t size) {
   int nthreads = chpl_topo_getNumCPUsPhysical(true);
-  pthread_t thread_id[nthreads];
-  memory_region mem_regions[nthreads];
 
-  for (int tid=0; tid<nthreads; tid++) {
-    mem_regions[tid].start = start;
-    mem_regions[tid].size = size;
-    mem_regions[tid].tid = tid;
-    mem_regions[tid].nthreads = nthreads;
-    pthread_create(&thread_id[tid], NULL, touch_thread, (void *)&mem_regions[tid]);
+  if (touchThreads != NULL) {
+    chpl_internal_error("heap touch is already in progress");
   }
+  touchThreads = sys_malloc(nthreads * sizeof(touchThreads[0]));
+  touchRegions = sys_malloc(nthreads * sizeof(touchRegions[0]));
+  if (touchThreads == NULL || touchRegions == NULL) {
+    chpl_internal_error("cannot allocate heap touch threads");
+  }
+  touchNumThreads = nthreads;
+  touchStart = chpl_hrtimer_now();
 
   for (int tid=0; tid<nthreads; tid++) {
-    pthread_join(thread_id[tid], NULL);
+    touchRegions[tid].start = start;
+    touchRegions[tid].size = size;
+    touchRegions[tid].tid = tid;
+    touchRegions[tid].nthreads = nthreads;
+    touchRegions[tid].done = touchStart;
+    pthread_create(&touchThreads[tid], NULL, touch_thread,
+                   (void *)&touchRegions[tid]);
   }
 }
 
+void chpl_comm_regMemHeapTouchWait(void) {
+  if (touchThreads == NULL) {
+    return;
+  }
+
+  double done = touchStart;
+  for (int tid=0; tid<touchNumThreads; tid++) {
+    pthread_join(touchThreads[tid], NULL);
+    if (touchRegions[tid].done > done) {
+      done = touchRegions[tid].done;
+    }
+  }
+  touchSecs += done - touchStart;
+
+  sys_free(touchThreads);
+  sys_free(touchRegions);
+  touchThreads = NULL;
+  touchRegions = NULL;
+}
+
+double chpl_comm_regMemHeapTouchSeconds(void) {
+  return touchSecs;
+}
+
 void* chpl_get_global_serialize_table(int64_t idx) {
   return chpl_global_serialize_table[idx];
 }
@@ -20,24 +20,219 @@
 
 #include "chplrt.h"
 #include "chpl-dynamic-loading.h"
+#include "chpl-mem-sys.h"
 #include "chplcgfns.h"
 #include <dlfcn.h>
+#include <pthread.h>
+#include <string.h>
 
 int CHPL_RTLD_LAZY = RTLD_LAZY;
 
+void** chpl_dl_ftable_chunks[CHPL_DL_FTABLE_MAX_CHUNKS];
+
+//
+// Each handle from chpl_dlopen has an entry on dlLibs, with a hash table
+// of the symbols found in it so far.  All of this is protected by
+// dlLock.  Lookups are expected to be far more common than opening and
+// closing libraries, and once a call site has an ftable index it does
+// not look anything up, so one lock is enough.
+//
+#define DL_SYM_BUCKETS 64
+
+typedef struct dl_sym_s {
+  struct dl_sym_s* next;
+  void* addr;
+  int64_t index;                // in the ftable extension, or -1
+  char name[];
+} dl_sym_t;
+
+typedef struct dl_lib_s {
+  struct dl_lib_s* next;
+  void* handle;
+  int refs;                     // chpl_dlopen calls not yet closed
+  chpl_bool ftableFound;
+  void** ftable;
+  int64_t ftableSize;
+  dl_sym_t* syms[DL_SYM_BUCKETS];
+} dl_lib_t;
+
+static pthread_mutex_t dlLock = PTHREAD_MUTEX_INITIALIZER;
+static dl_lib_t* dlLibs;
+static int64_t dlFtableSize;
+
+static uint64_t dl_hash(const char* s) {
+  // FNV-1a
+  uint64_t h = 14695981039346656037ull;
+  for (; *s; s++) {
+    h = (h ^ (unsigned char) *s) * 1099511628211ull;
+  }
+  return h;
+}
+
+static dl_lib_t* dl_find_lib(void* handle) {
+  for (dl_lib_t* lib = dlLibs; lib != NULL; lib = lib->next) {
+    if (lib->handle == handle) {
+      return lib;
+    }
+  }
+  return NULL;
+}
+
+// Find 'symbol' in the library's cache, looking it up with dlsym and
+// adding it if it isn't there yet.  Misses aren't cached, so that
+// chpl_dlerror() describes them as usual.
+static dl_sym_t* dl_find_sym(dl_lib_t* lib, const char* symbol) {
+  dl_sym_t** bucket = &lib->syms[dl_hash(symbol) % DL_SYM_BUCKETS];
+  for (dl_sym_t* sym = *bucket; sym != NULL; sym = sym->next) {
+    if (strcmp(sym->name, symbol) == 0) {
+      return sym;
+    }
+  }
+
+  void* addr = dlsym(lib->handle, symbol);
+  size_t len = strlen(symbol);
+  dl_sym_t* sym;
+  if (addr == NULL || (sym = sys_malloc(sizeof(*sym) + len + 1)) == NULL) {
+    return NULL;
+  }
+  memcpy(sym->name, symbol, len + 1);
+  sym->addr = addr;
+  sym->index = -1;
+  sym->next = *bucket;
+  *bucket = sym;
+  return sym;
+}
+
+// Add 'addr' to the ftable extension and return its index, or -1 if the
+// table is full or can't grow.
+static int64_t dl_ftable_add(void* addr) {
+  int64_t index = dlFtableSize;
+  int64_t chunk = index >> CHPL_DL_FTABLE_CHUNK_BITS;
+  if (chunk >= CHPL_DL_FTABLE_MAX_CHUNKS) {
+    return -1;
+  }
+  if (chpl_dl_ftable_chunks[chunk] == NULL) {
+    void** mem = sys_calloc(CHPL_DL_FTABLE_CHUNK_SIZE, sizeof(void*));
+    if (mem == NULL) {
+      return -1;
+    }
+    chpl_dl_ftable_chunks[chunk] = mem;
+  }
+  chpl_dl_ftable_chunks[chunk][index & (CHPL_DL_FTABLE_CHUNK_SIZE - 1)] = addr;
+  dlFtableSize++;
+  return index;
+}
+
+static void dl_free_lib(dl_lib_t* lib) {
+  for (int i = 0; i < DL_SYM_BUCKETS; i++) {
+    dl_sym_t* sym = lib->syms[i];
+    while (sym != NULL) {
+      dl_sym_t* next = sym->next;
+      if (sym->index >= 0) {
+        chpl_dl_ftable_chunks[sym->index >> CHPL_DL_FTABLE_CHUNK_BITS]
+                             [sym->index & (CHPL_DL_FTABLE_CHUNK_SIZE - 1)]
+          = NULL;
+      }
+      sys_free(sym);
+      sym = next;
+    }
+  }
+  sys_free(lib);
+}
+
+
 void** chpl_get_ftable(void) {
   return (void**) chpl_ftable;
 }
 
 void* chpl_dlopen(const char* path, int mode) {
-  return dlopen(path, mode);
+  void* handle = dlopen(path, mode);
+  if (handle == NULL) {
+    return NULL;
+  }
+
+  // dlopen returns the same handle for a library that is already open,
+  // so count the opens to know when the last chpl_dlclose happens
+  pthread_mutex_lock(&dlLock);
+  dl_lib_t* lib = dl_find_lib(handle);
+  if (lib == NULL && (lib = sys_calloc(1, sizeof(*lib))) != NULL) {
+    lib->handle = handle;
+    lib->next = dlLibs;
+    dlLibs = lib;
+  }
+  if (lib != NULL) {
+    lib->refs++;
+  }
+  pthread_mutex_unlock(&dlLock);
+
+  return handle;
 }
 
 void* chpl_dlsym(void* handle, const char* symbol) {
-  return dlsym(handle, symbol);
+  pthread_mutex_lock(&dlLock);
+  dl_lib_t* lib = dl_find_lib(handle);
+  if (lib == NULL) {
+    // not from chpl_dlopen (e.g. RTLD_DEFAULT), so there is no cache
+    pthread_mutex_unlock(&dlLock);
+    return dlsym(handle, symbol);
+  }
+  dl_sym_t* sym = dl_find_sym(lib, symbol);
+  void* ret = (sym != NULL) ? sym->addr : NULL;
+  pthread_mutex_unlock(&dlLock);
+  return ret;
+}
+
+int64_t chpl_dlsym_index(void* handle, const char* symbol) {
+  int64_t ret = -1;
+  pthread_mutex_lock(&dlLock);
+  dl_lib_t* lib = dl_find_lib(handle);
+  dl_sym_t* sym = (lib != NULL) ? dl_find_sym(lib, symbol) : NULL;
+  if (sym != NULL) {
+    if (sym->index < 0) {
+      sym->index = dl_ftable_add(sym->addr);
+    }
+    ret = sym->index;
+  }
+  pthread_mutex_unlock(&dlLock);
+  return ret;
+}
+
+void** chpl_dl_get_ftable(void* handle, int64_t* size) {
+  void** ret = NULL;
+  *size = 0;
+  pthread_mutex_lock(&dlLock);
+  dl_lib_t* lib = dl_find_lib(handle);
+  if (lib != NULL) {
+    if (!lib->ftableFound) {
+      dl_sym_t* table = dl_find_sym(lib, "chpl_ftable");
+      dl_sym_t* tableSize = dl_find_sym(lib, "chpl_ftableSize");
+      if (table != NULL && tableSize != NULL) {
+        lib->ftable = (void**) table->addr;
+        lib->ftableSize = *(int64_t*) tableSize->addr;
+      }
+      lib->ftableFound = true;
+    }
+    ret = lib->ftable;
+    *size = lib->ftableSize;
+  }
+  pthread_mutex_unlock(&dlLock);
+  return ret;
 }
 
 int chpl_dlclose(void* handle) {
+  pthread_mutex_lock(&dlLock);
+  for (dl_lib_t** link = &dlLibs; *link != NULL; link = &(*link)->next) {
+    dl_lib_t* lib = *link;
+    if (lib->handle == handle) {
+      if (--lib->refs == 0) {
+        *link = lib->next;
+        dl_free_lib(lib);
+      }
+      break;
+    }
+  }
+  pthread_mutex_unlock(&dlLock);
+
   return dlclose(handle);
 }
 
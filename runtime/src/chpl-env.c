@@ -31,6 +31,7 @@
 #include <ctype.h>
 #include <inttypes.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -190,3 +191,47 @@ void chpl_env_set_uint(const char* evName, uint64_t evVal, int overwrite) {
   snprintf(buf, sizeof(buf), "%" PRIu64, evVal);
   chpl_env_set(evName, buf, overwrite);
 }
+
+
+//
+// The bundle is just the "name=value" strings, each followed by a '\0'.
+// Variables already in the environment win, so that anything the
+// system launcher sets per process isn't overridden.
+//
+void chpl_env_load_bundle(void) {
+  const char* path = chpl_env_rt_get("ENV_BUNDLE", NULL);
+  FILE* f;
+  char* buf;
+  long len;
+
+  if (path == NULL || path[0] == '\0') {
+    return;
+  }
+
+  if ((f = fopen(path, "r")) == NULL
+      || fseek(f, 0, SEEK_END) != 0
+      || (len = ftell(f)) < 0
+      || fseek(f, 0, SEEK_SET) != 0
+      || (buf = malloc(len + 1)) == NULL
+      || fread(buf, 1, len, f) != (size_t) len) {
+    char msg[200];
+    snprintf(msg, sizeof(msg), "cannot read environment bundle \"%s\"",
+             path);
+    chpl_error(msg, 0, 0);
+  }
+  fclose(f);
+  buf[len] = '\0';
+
+  for (char* ev = buf; ev < buf + len; ev += strlen(ev) + 1) {
+    char* eq = strchr(ev, '=');
+    if (eq == NULL || eq == ev) {
+      continue;
+    }
+    *eq = '\0';
+    if (getenv(ev) == NULL) {
+      chpl_env_set(ev, eq + 1, 0);
+    }
+  }
+
+  free(buf);
+}
@@ -0,0 +1,390 @@
+/*
+ * Copyright 2020-2026 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Graphs of repeated kernel launch sequences.
+//
+
+#include "chpl-gpu-graph.h"
+
+#include <string.h>
+
+#ifdef HAS_GPU_LOCALE
+
+#include "chplrt.h"
+#include "chpl-atomics.h"
+#include "chpl-env.h"
+#include "chpl-gpu.h"
+#include "chpl-gpu-impl.h"
+#include "chpl-mem.h"
+#include "error.h"
+
+#define GRAPH_HASH_SIZE 64
+// params are stored at this alignment in a sequence's bytes
+#define GRAPH_PARAM_ALIGN 16
+
+typedef struct {
+  void* function;
+  int grd_dim_x, grd_dim_y, grd_dim_z;
+  int blk_dim_x, blk_dim_y, blk_dim_z;
+  int ln;
+  int32_t fn;
+  int n_params;
+  size_t offset;  // of its param sizes, then its params, in the bytes
+} graph_launch;
+
+// A sequence of launches. Two sequences with equal launches and bytes
+// do exactly the same thing.
+typedef struct {
+  int n_launches;
+  int max_launches;
+  graph_launch* launches;
+  size_t n_bytes;
+  size_t max_bytes;
+  unsigned char* bytes;
+} graph_seq;
+
+typedef struct graph_region_s {
+  int64_t id;
+  int dev;
+  bool in_use;          // some task is in it
+  graph_seq last;       // the launches of the last pass through it
+  void* graph;          // an instantiated graph of last, or NULL
+  struct graph_region_s* next;
+} graph_region;
+
+struct chpl_gpu_graph_task_s {
+  int depth;            // of nested begins; 0 if not in a region
+  graph_region* region; // NULL if the region isn't ours to capture
+  int dev;
+  void* stream;
+  void* halt_flag;      // of the device's module, if the kernels have one
+  bool flushed;         // already launched some of this pass
+  graph_seq pending;
+  void** scratch;       // param pointers for launching one by one
+  int max_scratch;
+};
+
+static bool graph_enabled = false;
+static chpl_atomic_spinlock_t graph_lock;
+static graph_region* graph_regions[GRAPH_HASH_SIZE];
+
+void chpl_gpu_graph_init(void) {
+  graph_enabled = chpl_env_rt_get_bool("GPU_GRAPHS", false);
+  if (graph_enabled && !chpl_gpu_impl_graph_supported()) {
+    chpl_warning("CHPL_RT_GPU_GRAPHS is set, but this GPU runtime doesn't "
+                 "support graphs; ignoring it", 0, 0);
+    graph_enabled = false;
+  }
+  atomic_init_spinlock_t(&graph_lock);
+}
+
+static void seq_clear(graph_seq* seq) {
+  seq->n_launches = 0;
+  seq->n_bytes = 0;
+}
+
+static void seq_free(graph_seq* seq) {
+  if (seq->launches) chpl_mem_free(seq->launches, 0, 0);
+  if (seq->bytes) chpl_mem_free(seq->bytes, 0, 0);
+  memset(seq, 0, sizeof(*seq));
+}
+
+static bool seq_equal(const graph_seq* a, const graph_seq* b) {
+  return a->n_launches == b->n_launches &&
+         a->n_bytes == b->n_bytes &&
+         memcmp(a->launches, b->launches,
+                a->n_launches * sizeof(graph_launch)) == 0 &&
+         memcmp(a->bytes, b->bytes, a->n_bytes) == 0;
+}
+
+static void seq_copy(graph_seq* dst, const graph_seq* src) {
+  if (dst->max_launches < src->n_launches) {
+    dst->launches = chpl_mem_realloc(dst->launches,
+                                     src->n_launches * sizeof(graph_launch),
+                                     CHPL_RT_MD_GPU_UTIL, 0, 0);
+    dst->max_launches = src->n_launches;
+  }
+  if (dst->max_bytes < src->n_bytes) {
+    dst->bytes = chpl_mem_realloc(dst->bytes, src->n_bytes,
+                                  CHPL_RT_MD_GPU_UTIL, 0, 0);
+    dst->max_bytes = src->n_bytes;
+  }
+  if (src->n_launches > 0) {
+    memcpy(dst->launches, src->launches,
+           src->n_launches * sizeof(graph_launch));
+  }
+  if (src->n_bytes > 0) {
+    memcpy(dst->bytes, src->bytes, src->n_bytes);
+  }
+  dst->n_launches = src->n_launches;
+  dst->n_bytes = src->n_bytes;
+}
+
+static void* seq_reserve(graph_seq* seq, size_t n) {
+  n = (n + GRAPH_PARAM_ALIGN - 1) & ~(size_t)(GRAPH_PARAM_ALIGN - 1);
+  if (seq->n_bytes + n > seq->max_bytes) {
+    size_t max = seq->max_bytes ? 2*seq->max_bytes : 1024;
+    while (max < seq->n_bytes + n) max *= 2;
+    seq->bytes = chpl_mem_realloc(seq->bytes, max, CHPL_RT_MD_GPU_UTIL, 0, 0);
+    seq->max_bytes = max;
+  }
+  void* ret = seq->bytes + seq->n_bytes;
+  // zero the padding too, since sequences are compared bytewise
+  memset(ret, 0, n);
+  seq->n_bytes += n;
+  return ret;
+}
+
+static inline size_t region_hash(int64_t id, int dev) {
+  uint64_t h = ((uint64_t)id * UINT64_C(0x9E3779B97F4A7C15)) ^ (uint64_t)dev;
+  return (size_t)(h >> 32) % GRAPH_HASH_SIZE;
+}
+
+// Find or make the region, and claim it for the calling task. Returns
+// NULL if another task has it.
+static graph_region* region_claim(int64_t id, int dev) {
+  size_t h = region_hash(id, dev);
+  graph_region* r;
+
+  atomic_lock_spinlock_t(&graph_lock);
+  for (r = graph_regions[h]; r != NULL; r = r->next) {
+    if (r->id == id && r->dev == dev) break;
+  }
+  if (r == NULL) {
+    r = chpl_mem_calloc(1, sizeof(graph_region), CHPL_RT_MD_GPU_UTIL, 0, 0);
+    r->id = id;
+    r->dev = dev;
+    r->next = graph_regions[h];
+    graph_regions[h] = r;
+  }
+  if (r->in_use) {
+    r = NULL;
+  } else {
+    r->in_use = true;
+  }
+  atomic_unlock_spinlock_t(&graph_lock);
+
+  return r;
+}
+
+static void region_release(graph_region* r) {
+  atomic_lock_spinlock_t(&graph_lock);
+  r->in_use = false;
+  atomic_unlock_spinlock_t(&graph_lock);
+}
+
+void chpl_gpu_graph_region_begin(chpl_gpu_graph_task_t** task_p,
+                                 int64_t region_id, int dev, void* stream) {
+  if (!graph_enabled) return;
+
+  chpl_gpu_graph_task_t* task = *task_p;
+  if (task == NULL) {
+    task = chpl_mem_calloc(1, sizeof(chpl_gpu_graph_task_t),
+                           CHPL_RT_MD_GPU_UTIL, 0, 0);
+    *task_p = task;
+  }
+
+  if (task->depth++ > 0) return;
+
+  // a region begun while not on a GPU just counts nesting
+  task->region = dev >= 0 ? region_claim(region_id, dev) : NULL;
+  task->dev = dev;
+  task->stream = stream;
+  task->halt_flag = NULL;
+  task->flushed = false;
+  seq_clear(&task->pending);
+}
+
+bool chpl_gpu_graph_defer_launch(chpl_gpu_graph_task_t* task, int dev,
+                                 void* stream, void* function,
+                                 int grd_dim_x, int grd_dim_y, int grd_dim_z,
+                                 int blk_dim_x, int blk_dim_y, int blk_dim_z,
+                                 void* halt_flag, int ln, int32_t fn,
+                                 int n_params, void** params,
+                                 const size_t* param_sizes) {
+  if (task == NULL || task->depth == 0 || task->region == NULL ||
+      task->dev != dev || task->stream != stream) {
+    return false;
+  }
+
+  graph_seq* seq = &task->pending;
+  if (seq->n_launches == seq->max_launches) {
+    seq->max_launches = seq->max_launches ? 2*seq->max_launches : 16;
+    seq->launches = chpl_mem_realloc(seq->launches,
+                                     seq->max_launches * sizeof(graph_launch),
+                                     CHPL_RT_MD_GPU_UTIL, 0, 0);
+  }
+
+  graph_launch* l = &seq->launches[seq->n_launches++];
+  memset(l, 0, sizeof(*l));
+  l->function = function;
+  l->grd_dim_x = grd_dim_x;
+  l->grd_dim_y = grd_dim_y;
+  l->grd_dim_z = grd_dim_z;
+  l->blk_dim_x = blk_dim_x;
+  l->blk_dim_y = blk_dim_y;
+  l->blk_dim_z = blk_dim_z;
+  l->ln = ln;
+  l->fn = fn;
+  l->n_params = n_params;
+  l->offset = seq->n_bytes;
+
+  size_t* sizes = seq_reserve(seq, n_params * sizeof(size_t));
+  memcpy(sizes, param_sizes, n_params * sizeof(size_t));
+  for (int i = 0; i < n_params; i++) {
+    memcpy(seq_reserve(seq, param_sizes[i]), params[i], param_sizes[i]);
+  }
+
+  if (halt_flag != NULL) task->halt_flag = halt_flag;
+
+  return true;
+}
+
+// Launch the sequence's kernels one by one on the task's stream.
+static void launch_seq(chpl_gpu_graph_task_t* task, graph_seq* seq) {
+  for (int k = 0; k < seq->n_launches; k++) {
+    graph_launch* l = &seq->launches[k];
+
+    if (task->max_scratch < l->n_params) {
+      task->scratch = chpl_mem_realloc(task->scratch,
+                                       l->n_params * sizeof(void*),
+                                       CHPL_RT_MD_GPU_UTIL, 0, 0);
+      task->max_scratch = l->n_params;
+    }
+
+    // find each param the same way defer_launch laid them out
+    const size_t* sizes = (const size_t*)(seq->bytes + l->offset);
+    size_t off = l->offset +
+                 ((l->n_params * sizeof(size_t) + GRAPH_PARAM_ALIGN - 1) &
+                  ~(size_t)(GRAPH_PARAM_ALIGN - 1));
+    for (int i = 0; i < l->n_params; i++) {
+      task->scratch[i] = seq->bytes + off;
+      off += (sizes[i] + GRAPH_PARAM_ALIGN - 1) &
+             ~(size_t)(GRAPH_PARAM_ALIGN - 1);
+    }
+
+    chpl_gpu_impl_launch_kernel(l->function,
+                                l->grd_dim_x, l->grd_dim_y, l->grd_dim_z,
+                                l->blk_dim_x, l->blk_dim_y, l->blk_dim_z,
+                                task->stream, task->scratch);
+  }
+}
+
+static void set_halt_flag(chpl_gpu_graph_task_t* task) {
+  if (task->halt_flag == NULL) return;
+  int flag = 0;
+  chpl_gpu_impl_copy_host_to_device(task->halt_flag, &flag, sizeof(flag),
+                                    task->stream);
+}
+
+static void check_halt_flag(chpl_gpu_graph_task_t* task, graph_seq* seq) {
+  if (task->halt_flag == NULL) return;
+  int flag = 0;
+  chpl_gpu_impl_copy_device_to_host(&flag, task->halt_flag, sizeof(flag),
+                                    task->stream);
+  if (flag) {
+    // we can't tell which kernel it was; blame the first
+    chpl_error("halt reached in GPU kernel", seq->launches[0].ln,
+               seq->launches[0].fn);
+  }
+}
+
+void* chpl_gpu_graph_flush(chpl_gpu_graph_task_t* task) {
+  if (task == NULL || task->pending.n_launches == 0) return NULL;
+
+  chpl_gpu_impl_use_device(task->dev);
+  set_halt_flag(task);
+  launch_seq(task, &task->pending);
+  check_halt_flag(task, &task->pending);
+
+  seq_clear(&task->pending);
+  task->flushed = true;
+  return task->stream;
+}
+
+void* chpl_gpu_graph_region_end(chpl_gpu_graph_task_t* task,
+                                int64_t region_id) {
+  if (task == NULL || task->depth == 0) return NULL;
+  if (--task->depth > 0) return NULL;
+
+  graph_region* r = task->region;
+  task->region = NULL;
+  if (r == NULL) return NULL;
+
+  void* ret = NULL;
+  graph_seq* seq = &task->pending;
+  if (task->flushed) {
+    // this pass was interrupted, so it isn't what the region usually does
+    ret = chpl_gpu_graph_flush(task);
+  } else if (seq->n_launches > 0) {
+    chpl_gpu_impl_use_device(task->dev);
+    set_halt_flag(task);
+    if (seq_equal(seq, &r->last)) {
+      // the second time (at least) through with the same launches
+      if (r->graph == NULL) {
+        chpl_gpu_impl_stream_begin_capture(task->stream);
+        launch_seq(task, seq);
+        r->graph = chpl_gpu_impl_stream_end_capture(task->stream);
+      }
+      chpl_gpu_impl_graph_launch(r->graph, task->stream);
+    } else {
+      launch_seq(task, seq);
+      if (r->graph != NULL) {
+        chpl_gpu_impl_graph_destroy(r->graph);
+        r->graph = NULL;
+      }
+      seq_copy(&r->last, seq);
+    }
+    check_halt_flag(task, seq);
+    seq_clear(seq);
+    ret = task->stream;
+  }
+
+  region_release(r);
+  return ret;
+}
+
+void* chpl_gpu_graph_task_end(chpl_gpu_graph_task_t** task_p) {
+  chpl_gpu_graph_task_t* task = *task_p;
+  if (task == NULL) return NULL;
+
+  void* ret = chpl_gpu_graph_flush(task);
+  if (task->region != NULL) region_release(task->region);
+
+  seq_free(&task->pending);
+  if (task->scratch) chpl_mem_free(task->scratch, 0, 0);
+  chpl_mem_free(task, 0, 0);
+  *task_p = NULL;
+  return ret;
+}
+
+#else // HAS_GPU_LOCALE
+
+// Without GPU support there is nothing to capture; these let module code
+// mark regions unconditionally.
+
+void chpl_gpu_graph_begin(int64_t region_id) {
+}
+
+void chpl_gpu_graph_end(int64_t region_id) {
+}
+
+#endif // HAS_GPU_LOCALE
@@ -0,0 +1,279 @@
+/*
+ * Copyright 2020-2026 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Per-kernel timing and occupancy (see chpl-gpu-kernel-stats.h).
+//
+
+#include "chpl-gpu-kernel-stats.h"
+
+#ifdef HAS_GPU_LOCALE
+
+#include "chplrt.h"
+#include "chpl-atomics.h"
+#include "chpl-comm.h"
+#include "chpl-env.h"
+#include "chpl-gpu.h"
+#include "chpl-gpu-impl.h"
+#include "chpl-linefile-support.h"
+#include "chpl-mem.h"
+#include "chpl-trace.h"
+#include "chpltimers.h"
+#include "error.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// How many different source lines can we track?
+#define KSTATS_SITES 1024
+// How many launches can be waiting for their events?
+#define KSTATS_PENDING 4096
+// How many lines does the report print at most?
+#define KSTATS_REPORT_LINES 40
+#define KSTATS_SITE_EMPTY UINT64_MAX
+
+typedef struct {
+  uint64_t key;         // file and line, or KSTATS_SITE_EMPTY
+  uint64_t launches;
+  double total_ms;
+  double max_ms;
+  int64_t blocks;       // summed over its launches
+  int blk_size;         // of the last launch, and what the rest is for
+  void* function;
+  double occupancy;     // 0..1
+  int64_t capacity;     // blocks resident at once on the whole device
+} kstats_site;
+
+typedef struct {
+  void* start;
+  void* end;
+  int site;
+  double launched;      // chpl_hrtimer_now(), for the trace
+  int dev;
+  int ln;
+  int32_t fn;
+} kstats_pending;
+
+// Launches are timed if stats are being kept or kernels are being
+// traced (see chpl-trace.h); only the former prints a report.
+static bool kstats_enabled = false;
+static bool kstats_print = false;
+static chpl_atomic_spinlock_t kstats_lock;
+static kstats_site* kstats_sites;
+static kstats_pending kstats_queue[KSTATS_PENDING];
+static int kstats_head, kstats_count;
+static chpl_atomic_uint_least64_t kstats_bytes[CHPL_GPU_KERNEL_STATS_NUM_DIRS];
+
+void chpl_gpu_kernel_stats_init(void) {
+  for (int i = 0; i < CHPL_GPU_KERNEL_STATS_NUM_DIRS; i++) {
+    atomic_init_uint_least64_t(&kstats_bytes[i], 0);
+  }
+  kstats_print = chpl_env_rt_get_bool("GPU_KERNEL_STATS", false);
+  kstats_enabled = kstats_print || chpl_trace_enabled;
+  if (!kstats_enabled) return;
+
+  atomic_init_spinlock_t(&kstats_lock);
+  kstats_sites = chpl_mem_alloc(KSTATS_SITES * sizeof(kstats_site),
+                                CHPL_RT_MD_GPU_UTIL, 0, 0);
+  for (int i = 0; i < KSTATS_SITES; i++) {
+    kstats_sites[i].key = KSTATS_SITE_EMPTY;
+  }
+}
+
+// Returns the index of the entry for this source line, adding one if
+// necessary, or -1 if there is no room. Called with the lock held.
+static int kstats_site_index(int ln, int32_t fn) {
+  uint64_t key = ((uint64_t)(uint32_t)fn << 32) | (uint32_t)ln;
+  uint64_t h = (key * UINT64_C(0x9E3779B97F4A7C15)) >> 32;
+
+  for (int i = 0; i < KSTATS_SITES; i++) {
+    int idx = (h + i) & (KSTATS_SITES - 1);
+    kstats_site* s = &kstats_sites[idx];
+    if (s->key == key) return idx;
+    if (s->key == KSTATS_SITE_EMPTY) {
+      memset(s, 0, sizeof(*s));
+      s->key = key;
+      return idx;
+    }
+  }
+  return -1;
+}
+
+// Occupancy the block size allows, and how many blocks that puts on the
+// device at once.
+static void kstats_set_occupancy(kstats_site* s, void* function, int dev,
+                                 int blk_size) {
+  int per_sm = chpl_gpu_impl_max_active_blocks(function, blk_size);
+  int max_threads = chpl_gpu_impl_query_attribute(dev,
+                      CHPL_GPU_ATTRIBUTE__MAX_THREADS_PER_MULTIPROCESSOR);
+  int n_sms = chpl_gpu_impl_query_attribute(dev,
+                CHPL_GPU_ATTRIBUTE__MULTIPROCESSOR_COUNT);
+
+  s->function = function;
+  s->blk_size = blk_size;
+  s->occupancy = max_threads > 0 ? (double)per_sm*blk_size/max_threads : 0;
+  s->capacity = (int64_t)per_sm * n_sms;
+}
+
+// Account for the oldest pending launch, waiting for it if wait is set.
+// Returns false if it wasn't done (and wait wasn't set). Called with the
+// lock held.
+static bool kstats_retire_oldest(bool wait) {
+  kstats_pending* p = &kstats_queue[kstats_head];
+  if (!wait && !chpl_gpu_impl_event_done(p->end)) return false;
+
+  double ms = chpl_gpu_impl_event_elapsed_ms(p->start, p->end);
+  if (p->site >= 0) {
+    kstats_site* s = &kstats_sites[p->site];
+    s->total_ms += ms;
+    if (ms > s->max_ms) s->max_ms = ms;
+  }
+  if (chpl_trace_enabled) {
+    chpl_trace_gpu_kernel(p->dev, p->ln, p->fn, p->launched, ms);
+  }
+  chpl_gpu_impl_event_destroy(p->start);
+  chpl_gpu_impl_event_destroy(p->end);
+
+  kstats_head = (kstats_head + 1) % KSTATS_PENDING;
+  kstats_count--;
+  return true;
+}
+
+void* chpl_gpu_kernel_stats_begin(void* stream) {
+  if (!kstats_enabled) return NULL;
+
+  void* start = chpl_gpu_impl_event_create();
+  if (start != NULL) {
+    chpl_gpu_impl_event_record(start, stream);
+  }
+  return start;
+}
+
+void chpl_gpu_kernel_stats_end(void* token, void* stream, void* function,
+                               int dev, int ln, int32_t fn,
+                               int64_t n_blocks, int blk_size) {
+  if (token == NULL) return;
+
+  void* end = chpl_gpu_impl_event_create();
+  chpl_gpu_impl_event_record(end, stream);
+  double launched = chpl_hrtimer_now();
+
+  atomic_lock_spinlock_t(&kstats_lock);
+
+  int idx = kstats_site_index(ln, fn);
+  if (idx >= 0) {
+    kstats_site* s = &kstats_sites[idx];
+    s->launches++;
+    s->blocks += n_blocks;
+    if (s->blk_size != blk_size || s->function != function) {
+      kstats_set_occupancy(s, function, dev, blk_size);
+    }
+  }
+
+  // take care of what has finished, and make room if we have to
+  while (kstats_count > 0 && kstats_retire_oldest(false));
+  if (kstats_count == KSTATS_PENDING) {
+    kstats_retire_oldest(true);
+  }
+
+  kstats_pending* p = &kstats_queue[(kstats_head + kstats_count) %
+                                    KSTATS_PENDING];
+  p->start = token;
+  p->end = end;
+  p->site = idx;
+  p->launched = launched;
+  p->dev = dev;
+  p->ln = ln;
+  p->fn = fn;
+  kstats_count++;
+
+  atomic_unlock_spinlock_t(&kstats_lock);
+}
+
+void chpl_gpu_kernel_stats_copy(chpl_gpu_kernel_stats_dir_t dir, size_t n) {
+  if (!kstats_enabled) return;
+  (void) atomic_fetch_add_explicit_uint_least64_t(&kstats_bytes[dir], n,
+                                                  chpl_memory_order_relaxed);
+}
+
+// sort by total time, most first
+static int kstats_report_cmp(const void* a, const void* b) {
+  const kstats_site* x = (const kstats_site*)a;
+  const kstats_site* y = (const kstats_site*)b;
+  if (x->total_ms != y->total_ms) return (x->total_ms < y->total_ms) ? 1 : -1;
+  return 0;
+}
+
+void chpl_gpu_kernel_stats_report(void) {
+  if (!kstats_enabled) return;
+
+  atomic_lock_spinlock_t(&kstats_lock);
+  while (kstats_count > 0) {
+    kstats_retire_oldest(true);
+  }
+  if (!kstats_print) {
+    atomic_unlock_spinlock_t(&kstats_lock);
+    return;
+  }
+
+  kstats_site* report = chpl_mem_alloc(KSTATS_SITES * sizeof(kstats_site),
+                                       CHPL_RT_MD_GPU_UTIL, 0, 0);
+  int n = 0;
+  for (int i = 0; i < KSTATS_SITES; i++) {
+    if (kstats_sites[i].key != KSTATS_SITE_EMPTY) {
+      report[n++] = kstats_sites[i];
+    }
+  }
+  atomic_unlock_spinlock_t(&kstats_lock);
+
+  qsort(report, n, sizeof(kstats_site), kstats_report_cmp);
+
+  printf("%d: gpu kernel statistics (%d kernels, sorted by total time)\n",
+         chpl_nodeID, n);
+  for (int i = 0; i < n && i < KSTATS_REPORT_LINES; i++) {
+    kstats_site* s = &report[i];
+    int32_t fn = (int32_t)(uint32_t)(s->key >> 32);
+    int ln = (int)(uint32_t)s->key;
+    double avg_blocks = (double)s->blocks / s->launches;
+    // how full the device was, in units of what fits at once
+    double waves = s->capacity > 0 ? avg_blocks / s->capacity : 0;
+
+    printf("%d:   %s:%d launches=%llu total=%.3f ms avg=%.3f ms "
+           "max=%.3f ms block=%d occupancy=%.0f%% waves=%.2f\n",
+           chpl_nodeID, chpl_lookupFilename(fn), ln,
+           (unsigned long long)s->launches, s->total_ms,
+           s->total_ms / s->launches, s->max_ms, s->blk_size,
+           100*s->occupancy, waves);
+  }
+
+  printf("%d: gpu bytes copied: host_to_device=%llu device_to_host=%llu "
+         "device_to_device=%llu\n", chpl_nodeID,
+         (unsigned long long)atomic_load_uint_least64_t(
+           &kstats_bytes[CHPL_GPU_KERNEL_STATS_HOST_TO_DEVICE]),
+         (unsigned long long)atomic_load_uint_least64_t(
+           &kstats_bytes[CHPL_GPU_KERNEL_STATS_DEVICE_TO_HOST]),
+         (unsigned long long)atomic_load_uint_least64_t(
+           &kstats_bytes[CHPL_GPU_KERNEL_STATS_DEVICE_TO_DEVICE]));
+
+  chpl_mem_free(report, 0, 0);
+}
+
+#endif // HAS_GPU_LOCALE
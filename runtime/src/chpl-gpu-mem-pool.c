@@ -0,0 +1,304 @@
+/*
+ * Copyright 2020-2026 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Caching allocator for GPU memory.
+//
+
+#include "chpl-gpu-mem-pool.h"
+
+#include <string.h>
+
+#ifdef HAS_GPU_LOCALE
+
+#include "chplrt.h"
+#include "chpl-atomics.h"
+#include "chpl-comm.h"
+#include "chpl-env.h"
+#include "chpl-gpu.h"
+#include "chpl-gpu-impl.h"
+#include "chpl-mem.h"
+#include "error.h"
+
+// Sizes are rounded up to 4 bins per power of two, so a block is at most
+// 25% bigger than asked for. Anything bigger than the last bin skips the
+// pool.
+#define POOL_MIN_LG 9                  // smallest block is 512 bytes
+#define POOL_MAX_LG 47
+#define POOL_NBINS ((POOL_MAX_LG - POOL_MIN_LG + 1) * 4 + 1)
+#define POOL_HASH_SIZE 4096
+
+typedef struct pool_block_s {
+  void* ptr;
+  size_t size;
+  int array;
+  void* stream;  // freed on this stream and it may still be busy; or NULL
+  struct pool_block_s* next;   // in a free list
+  struct pool_block_s* hnext;  // in the table of allocated blocks
+} pool_block;
+
+typedef struct dev_pool_s {
+  chpl_atomic_spinlock_t lock;
+  pool_block* free_lists[2][POOL_NBINS];
+  pool_block* live[POOL_HASH_SIZE];
+  chpl_gpu_mem_pool_stats_t stats;
+} dev_pool;
+
+static bool pool_enabled = false;
+static size_t pool_limit = 0;
+static dev_pool* pools = NULL;
+
+void chpl_gpu_mem_pool_init(void) {
+#ifdef GPU_RUNTIME_CPU
+  pool_enabled = chpl_env_rt_get_bool("GPU_MEM_POOL", false);
+#else
+  pool_enabled = chpl_env_rt_get_bool("GPU_MEM_POOL", true);
+#endif
+  pool_limit = chpl_env_rt_get_size("GPU_MEM_POOL_LIMIT",
+                                    (size_t)1024*1024*1024);
+  if (!pool_enabled || chpl_gpu_num_devices <= 0) {
+    pool_enabled = false;
+    return;
+  }
+
+  pools = chpl_mem_calloc(chpl_gpu_num_devices, sizeof(dev_pool),
+                          CHPL_RT_MD_GPU_UTIL, 0, 0);
+  for (int i = 0; i < chpl_gpu_num_devices; i++) {
+    atomic_init_spinlock_t(&pools[i].lock);
+  }
+}
+
+// Returns the bin for size, and sets *bin_size to the size of its blocks;
+// -1 if size is too big to pool.
+static int pool_bin(size_t size, size_t* bin_size) {
+  if (size <= ((size_t)1 << POOL_MIN_LG)) {
+    *bin_size = (size_t)1 << POOL_MIN_LG;
+    return 0;
+  }
+
+  // 2^lg < size <= 2^(lg+1); round up to a multiple of 2^lg / 4
+  int lg = 63 - __builtin_clzll((unsigned long long)(size - 1));
+  if (lg > POOL_MAX_LG) return -1;
+  size_t step = ((size_t)1 << lg) / 4;
+  size_t rounded = (size + step - 1) / step * step;
+  *bin_size = rounded;
+  return (lg - POOL_MIN_LG) * 4 + (int)(rounded / step) - 4;
+}
+
+static inline size_t pool_hash(void* ptr) {
+  uintptr_t p = (uintptr_t) ptr >> POOL_MIN_LG;
+  return (size_t)((p * UINT64_C(0x9E3779B97F4A7C15)) >> 32) % POOL_HASH_SIZE;
+}
+
+static inline void pool_lock(dev_pool* pool) {
+  atomic_lock_spinlock_t(&pool->lock);
+}
+
+static inline void pool_unlock(dev_pool* pool) {
+  atomic_unlock_spinlock_t(&pool->lock);
+}
+
+void* chpl_gpu_mem_pool_alloc(int dev, size_t size, bool array,
+                              void* stream) {
+  size_t bin_size = 0;
+  int bin;
+
+  if (!pool_enabled || dev < 0 || dev >= chpl_gpu_num_devices ||
+      (bin = pool_bin(size, &bin_size)) < 0) {
+    return array ? chpl_gpu_impl_mem_array_alloc(size) :
+                   chpl_gpu_impl_mem_alloc(size);
+  }
+
+  dev_pool* pool = &pools[dev];
+  pool_block* b = NULL;
+
+  pool_lock(pool);
+  pool_block** p = &pool->free_lists[array][bin];
+  while (*p != NULL && (*p)->stream != NULL && (*p)->stream != stream) {
+    p = &(*p)->next;
+  }
+  if (*p != NULL) {
+    b = *p;
+    *p = b->next;
+    pool->stats.hits++;
+    pool->stats.cached_bytes -= b->size;
+  } else {
+    pool->stats.misses++;
+  }
+  pool_unlock(pool);
+
+  if (b == NULL) {
+    b = chpl_mem_alloc(sizeof(pool_block), CHPL_RT_MD_GPU_UTIL, 0, 0);
+    b->size = bin_size;
+    b->array = array;
+    b->ptr = array ? chpl_gpu_impl_mem_array_alloc(bin_size) :
+                     chpl_gpu_impl_mem_alloc(bin_size);
+  }
+  b->stream = NULL;
+  b->next = NULL;
+
+  pool_lock(pool);
+  size_t h = pool_hash(b->ptr);
+  b->hnext = pool->live[h];
+  pool->live[h] = b;
+  pool->stats.in_use_bytes += b->size;
+  pool_unlock(pool);
+
+  CHPL_GPU_DEBUG("GPU memory pool (subloc %d): %zu bytes at %p for %zu\n",
+                 dev, b->size, b->ptr, size);
+  return b->ptr;
+}
+
+// Frees blocks, which were taken off the free lists, for real.
+static void pool_release_list(dev_pool* pool, pool_block* b) {
+  while (b != NULL) {
+    pool_block* next = b->next;
+    chpl_comm_regMemFreeNotify(b->ptr, b->size);
+    chpl_gpu_impl_mem_free(b->ptr);
+    chpl_mem_free(b, 0, 0);
+    b = next;
+  }
+}
+
+bool chpl_gpu_mem_pool_free(void* ptr, int dev, void* stream) {
+  if (!pool_enabled || ptr == NULL) return false;
+
+  for (int i = 0; i < chpl_gpu_num_devices; i++) {
+    dev_pool* pool = &pools[i];
+    size_t h = pool_hash(ptr);
+    pool_block* b;
+
+    pool_lock(pool);
+    pool_block** p = &pool->live[h];
+    while (*p != NULL && (*p)->ptr != ptr) p = &(*p)->hnext;
+    if (*p == NULL) {
+      pool_unlock(pool);
+      continue;
+    }
+
+    b = *p;
+    *p = b->hnext;
+    pool->stats.in_use_bytes -= b->size;
+
+    // Keep it unless that would go over the limit. A block freed from
+    // another device's task has no stream here to order it by, so it
+    // goes back to the driver too.
+    if (i == dev && pool->stats.cached_bytes + b->size <= pool_limit) {
+      size_t bin_size;
+      int bin = pool_bin(b->size, &bin_size);
+      b->stream = stream;
+      b->next = pool->free_lists[b->array][bin];
+      pool->free_lists[b->array][bin] = b;
+      pool->stats.cached_bytes += b->size;
+      b = NULL;
+    } else {
+      pool->stats.trimmed_bytes += b->size;
+      b->next = NULL;
+    }
+    pool_unlock(pool);
+
+    pool_release_list(pool, b);
+    return true;
+  }
+
+  return false;
+}
+
+void chpl_gpu_mem_pool_stream_done(int dev, void* stream) {
+  if (!pool_enabled || stream == NULL || dev < 0 ||
+      dev >= chpl_gpu_num_devices) {
+    return;
+  }
+
+  dev_pool* pool = &pools[dev];
+  pool_lock(pool);
+  for (int a = 0; a < 2; a++) {
+    for (int bin = 0; bin < POOL_NBINS; bin++) {
+      for (pool_block* b = pool->free_lists[a][bin]; b != NULL; b = b->next) {
+        if (b->stream == stream) b->stream = NULL;
+      }
+    }
+  }
+  pool_unlock(pool);
+}
+
+void chpl_gpu_mem_pool_trim(int dev) {
+  if (!pool_enabled) return;
+
+  for (int i = 0; i < chpl_gpu_num_devices; i++) {
+    if (dev >= 0 && i != dev) continue;
+
+    dev_pool* pool = &pools[i];
+    pool_block* all = NULL;
+
+    pool_lock(pool);
+    for (int a = 0; a < 2; a++) {
+      for (int bin = 0; bin < POOL_NBINS; bin++) {
+        pool_block* b = pool->free_lists[a][bin];
+        while (b != NULL) {
+          pool_block* next = b->next;
+          b->next = all;
+          all = b;
+          b = next;
+        }
+        pool->free_lists[a][bin] = NULL;
+      }
+    }
+    pool->stats.trimmed_bytes += pool->stats.cached_bytes;
+    pool->stats.cached_bytes = 0;
+    pool_unlock(pool);
+
+    // (the driver's free synchronizes, so blocks still tagged with a
+    // stream are safe to free here)
+    pool_release_list(pool, all);
+  }
+}
+
+void chpl_gpu_mem_pool_get_stats(int dev, chpl_gpu_mem_pool_stats_t* stats) {
+  memset(stats, 0, sizeof(*stats));
+  if (!pool_enabled) return;
+
+  for (int i = 0; i < chpl_gpu_num_devices; i++) {
+    if (dev >= 0 && i != dev) continue;
+
+    dev_pool* pool = &pools[i];
+    pool_lock(pool);
+    stats->hits += pool->stats.hits;
+    stats->misses += pool->stats.misses;
+    stats->in_use_bytes += pool->stats.in_use_bytes;
+    stats->cached_bytes += pool->stats.cached_bytes;
+    stats->trimmed_bytes += pool->stats.trimmed_bytes;
+    pool_unlock(pool);
+  }
+}
+
+#else // HAS_GPU_LOCALE
+
+// Without GPU support there is nothing to pool; these let module code
+// call the trim and stats functions unconditionally.
+
+void chpl_gpu_mem_pool_trim(int dev) {
+}
+
+void chpl_gpu_mem_pool_get_stats(int dev, chpl_gpu_mem_pool_stats_t* stats) {
+  memset(stats, 0, sizeof(*stats));
+}
+
+#endif // HAS_GPU_LOCALE
@@ -21,6 +21,7 @@
 // section due to the fact that GpuDiagnostics module accesses it (and this
 // module can be used despite what locale model you're using).
 #include <stdbool.h>
+#include <string.h>
 bool chpl_gpu_debug = false;
 bool chpl_gpu_no_cpu_mode_warning = false;
 int chpl_gpu_num_devices = -1;
@@ -37,7 +38,11 @@ bool chpl_gpu_use_stream_per_task = true;
 #include "chpl-gpu.h"
 #include "chpl-gpu-impl.h"
 #include "chpl-gpu-diags.h"
+#include "chpl-gpu-mem-pool.h"
+#include "chpl-gpu-graph.h"
+#include "chpl-gpu-kernel-stats.h"
 #include "chpl-tasks.h"
+#include "chpltimers.h"
 #include "error.h"
 #include "chplcgfns.h"
 #include "chpl-linefile-support.h"
@@ -45,12 +50,48 @@ bool chpl_gpu_use_stream_per_task = true;
 #include "chpl-env.h"
 #include "chpl-comm-compiler-macros.h"
 #include "chpl-privatization.h"
+#include "chpl-comm-no-warning-macros.h" // staged strided transfers
 
 #include "gpu/chpl-gpu-reduce-util.h"
 
 #include <inttypes.h>
 
-static chpl_atomic_spinlock_t* priv_table_lock = NULL;
+static chpl_atomic_padded_spinlock_t* priv_table_lock = NULL;
+
+// pinned host buffers for staging strided transfers (see staging_get)
+static size_t staging_size = 0;
+static chpl_atomic_spinlock_t staging_lock;
+
+// for kernel configs cached per call site (see cfg_cache_get)
+static bool cfg_cache_enabled = false;
+static chpl_atomic_spinlock_t cfg_cache_lock;
+
+// finish a kernel's reductions together (see cfg_finalize_reductions)
+static bool fuse_reductions = false;
+
+// unified memory: prefetch array data args before launches, and prefer to
+// keep arrays on the device that allocated them
+static bool prefetch_args = false;
+static bool arrays_prefer_device = false;
+
+// How copies from one device to another on this node go, for each
+// (destination, source) pair. Direct copies need the destination to have
+// peer access to the source; the others are left to the vendor runtime's
+// peer copy, which stages them through the host.
+typedef enum {
+  PEER_PATH_STAGED = 0,
+  PEER_PATH_DIRECT
+} peer_path_t;
+static peer_path_t* peer_paths = NULL;
+static chpl_atomic_spinlock_t peer_lock;
+
+// Kernels with at most small_kernel_threads threads are often done sooner
+// than a blocking wait can put the thread to sleep and wake it back up,
+// so we poll for them for up to small_kernel_spin seconds first (see
+// spin_on_small_kernel). Off unless CHPL_RT_GPU_SMALL_KERNEL_SPIN_US is
+// set.
+static int64_t small_kernel_threads = 0;
+static double small_kernel_spin = 0;
 
 static void override_number_of_devices(void) {
   const char* env;
@@ -86,6 +127,36 @@ static void override_number_of_devices(void) {
   }
 }
 
+// Turn on peer access between every pair of devices that support it
+// (NVLink or a shared PCIe switch, usually), unless
+// CHPL_RT_GPU_AUTO_PEER_ACCESS is false. Either way, remember which pairs
+// can copy directly.
+static void setup_peer_access(void) {
+  int n = chpl_gpu_num_devices;
+
+  atomic_init_spinlock_t(&peer_lock);
+  if (n < 2) return;
+
+  peer_paths = chpl_mem_calloc(n*n, sizeof(peer_path_t),
+                               CHPL_RT_MD_GPU_UTIL, 0, 0);
+  if (!chpl_env_rt_get_bool("GPU_AUTO_PEER_ACCESS", true)) return;
+
+  for (int dst = 0; dst < n; dst++) {
+    for (int src = 0; src < n; src++) {
+      if (dst != src && chpl_gpu_impl_can_access_peer(dst, src)) {
+        chpl_gpu_impl_set_peer_access(dst, src, true);
+        peer_paths[dst*n + src] = PEER_PATH_DIRECT;
+      }
+    }
+  }
+  CHPL_GPU_DEBUG("Enabled peer access among %d devices\n", n);
+}
+
+static inline peer_path_t peer_path(int dst_dev, int src_dev) {
+  if (peer_paths == NULL) return PEER_PATH_STAGED;
+  return peer_paths[dst_dev*chpl_gpu_num_devices + src_dev];
+}
+
 static void find_and_setup_devices(int numAllDevices) {
 #ifndef GPU_RUNTIME_CPU
   // Collect PCI information about each available device.
@@ -150,13 +221,40 @@ void chpl_gpu_init(void) {
   override_number_of_devices();
 
   // TODO these should be freed
-  priv_table_lock = chpl_mem_alloc(chpl_gpu_num_devices *
-                                   sizeof(chpl_atomic_spinlock_t),
-                                   CHPL_RT_MD_GPU_UTIL, 0, 0);
+  priv_table_lock = chpl_mem_memalign(CHPL_CACHE_LINE_SIZE,
+                                      chpl_gpu_num_devices *
+                                      sizeof(chpl_atomic_padded_spinlock_t),
+                                      CHPL_RT_MD_GPU_UTIL, 0, 0);
 
   for (int i=0 ; i<chpl_gpu_num_devices ; i++) {
-    atomic_init_spinlock_t(&priv_table_lock[i]);
+    atomic_init_spinlock_t(&priv_table_lock[i].lock);
   }
+
+  chpl_gpu_mem_pool_init();
+
+  setup_peer_access();
+
+  atomic_init_spinlock_t(&cfg_cache_lock);
+  cfg_cache_enabled = chpl_env_rt_get_bool("GPU_CACHE_LAUNCH_CFGS", true);
+
+  chpl_gpu_graph_init();
+  chpl_gpu_kernel_stats_init();
+
+  fuse_reductions = chpl_env_rt_get_bool("GPU_FUSE_REDUCTIONS", true);
+
+  small_kernel_spin = chpl_env_rt_get_int("GPU_SMALL_KERNEL_SPIN_US", 0)/1e6;
+  small_kernel_threads = chpl_env_rt_get_int("GPU_SMALL_KERNEL_THREADS",
+                                             64*1024);
+
+#ifndef CHPL_GPU_MEM_STRATEGY_ARRAY_ON_DEVICE
+  prefetch_args = chpl_env_rt_get_bool("GPU_PREFETCH_ARGS", true);
+  arrays_prefer_device = chpl_env_rt_get_bool("GPU_ARRAYS_PREFER_DEVICE",
+                                              false);
+#endif
+
+  atomic_init_spinlock_t(&staging_lock);
+  staging_size = chpl_env_rt_get_size("GPU_COMM_STAGING_SIZE",
+                                      (size_t)4*1024*1024);
 }
 
 // With very limited and artificial benchmarking, we observed that yielding
@@ -194,6 +292,10 @@ void chpl_gpu_task_end(void) {
   chpl_gpu_taskPrvData_t* prvData = get_gpu_task_private_data();
   assert(prvData);
 
+  // launches still deferred by a graph region go out before the streams;
+  // waiting on them below covers the synchronization
+  chpl_gpu_graph_task_end(&prvData->graph);
+
   if (prvData->streams != NULL) {
     int i;
     for (i=0 ; i<chpl_gpu_num_devices ; i++) {
@@ -201,6 +303,7 @@ void chpl_gpu_task_end(void) {
         CHPL_GPU_DEBUG("Destroying stream %p (subloc %d)\n",
                        prvData->streams[i], i);
         wait_stream(prvData->streams[i]);
+        chpl_gpu_mem_pool_stream_done(i, prvData->streams[i]);
         chpl_gpu_impl_stream_destroy(prvData->streams[i]);
         prvData->streams[i] = NULL;
       }
@@ -220,18 +323,22 @@ void chpl_gpu_task_fence(void) {
   chpl_gpu_taskPrvData_t* prvData = get_gpu_task_private_data();
   assert(prvData);
 
+  chpl_gpu_graph_flush(prvData->graph);
+
   if (prvData->streams != NULL) {
     int i;
     for (i=0 ; i<chpl_gpu_num_devices ; i++) {
       if (prvData->streams[i] != NULL) {
         CHPL_GPU_DEBUG("Synchronizing stream %p (subloc %d)\n", prvData->streams[i], i);
         wait_stream(prvData->streams[i]);
+        chpl_gpu_mem_pool_stream_done(i, prvData->streams[i]);
       }
     }
   }
 }
 
-static void* get_stream(int dev) {
+// Like get_stream, but leaves launches deferred by a graph region alone.
+static void* get_stream_for_launch(int dev) {
   if (!has_stream_per_task()) return NULL;
 
   CHPL_GPU_START_TIMER(stream_time);
@@ -262,6 +369,48 @@ static void* get_stream(int dev) {
   return *stream;
 }
 
+// Synchronize with stream the way a kernel launch does, after launches
+// that didn't.
+static void sync_after_launch(void* stream) {
+#ifdef CHPL_GPU_MEM_STRATEGY_ARRAY_ON_DEVICE
+  if (chpl_gpu_sync_with_host) {
+    CHPL_GPU_DEBUG("Eagerly synchronizing stream %p\n", stream);
+    wait_stream(stream);
+  }
+#else
+  chpl_gpu_impl_synchronize();
+#endif
+}
+
+// Launch anything a graph region of this task has deferred, so that what
+// we're about to put on a stream (or free) is ordered after it.
+static void graph_flush(void) {
+  chpl_gpu_taskPrvData_t* prvData = get_gpu_task_private_data();
+  if (prvData == NULL || prvData->graph == NULL) return;
+
+  void* stream = chpl_gpu_graph_flush(prvData->graph);
+  if (stream != NULL) {
+    sync_after_launch(stream);
+  }
+}
+
+static void* get_stream(int dev) {
+  if (!has_stream_per_task()) return NULL;
+
+  graph_flush();
+  return get_stream_for_launch(dev);
+}
+
+// The task's stream for dev, if it has one (unlike get_stream, this
+// doesn't create one).
+static void* peek_stream(int dev) {
+  if (!has_stream_per_task() || dev < 0) return NULL;
+
+  chpl_gpu_taskPrvData_t* prvData = get_gpu_task_private_data();
+  if (prvData == NULL || prvData->streams == NULL) return NULL;
+  return prvData->streams[dev];
+}
+
 void chpl_gpu_support_module_finished_initializing(void) {
   // we can't use `CHPL_GPU_DEBUG` before the support module is finished
   // initializing. This call back is used to signal the runtime that that module
@@ -293,6 +442,9 @@ typedef struct reduce_var_s {
   size_t elem_size;
   void* buffer;
   reduce_wrapper_fn_t wrapper;
+  const char* final_fn;  // what the wrapper calls; NULL until the first use
+  bool fusable;          // can we finish it along with others?
+  chpl_gpu_fused_reduce_var_t fused;
 } reduce_var;
 
 typedef struct kernel_cfg_s {
@@ -325,6 +477,10 @@ typedef struct kernel_cfg_s {
   // later on we know what we need to free.
   bool* param_dyn_allocated;
 
+  // The size of each param's value. Graph regions (chpl-gpu-graph.h) keep
+  // copies of the params of the launches they defer.
+  size_t* param_sizes;
+
   // these are used while still collecting pids during kernel launch prologue
   int n_pids;
   int cur_pid;
@@ -341,22 +497,78 @@ typedef struct kernel_cfg_s {
 
   reduce_var* reduce_vars;
 
+  // array data args to prefetch before the launch (see chpl_gpu_arg_prefetch)
+  int n_prefetch;
+  void** prefetch_ptrs;
+
   // we need this in the config so that we can offload data using this stream,
   // and in the future allocate/deallocate on this stream, too
   void* stream;
 
   // the pointer to the (device) halt flag, set when halt() is reached.
   void* halt_flag;
+
+  // Configs can be kept per call site and reused (see cfg_cache_get). A
+  // cached config keeps its host-side arrays, the loaded function and the
+  // device buffers of its by-offload params, along with a host copy of
+  // what is in each buffer so that unchanged params needn't be copied.
+  struct cfg_site_s* site;   // NULL if this config isn't cached
+  void* last_stream;         // the stream of its previous launch
+  void* function;            // the loaded kernel, once known
+  size_t* offload_sizes;     // per param: size of its device buffer
+  void** offload_shadows;    // per param: host copy of the buffer
+  bool deferred;             // its last launch was left to a graph region
+  struct kernel_cfg_s* next_cached;
 } kernel_cfg;
 
+typedef struct cfg_site_s {
+  const char* fn_name;
+  int ln;
+  int32_t fn;
+  int dev;
+  int n_cached;
+  kernel_cfg* cached;
+  struct cfg_site_s* next;
+} cfg_site;
+
+#define CFG_CACHE_NBUCKETS 256
+// how many configs each call site keeps; more than one are needed when
+// several tasks launch the same kernel at once
+#define CFG_CACHE_PER_SITE 4
+
+static cfg_site* cfg_cache_sites[CFG_CACHE_NBUCKETS];
+
+// Is everything a launch queued done by the time launch_kernel returns?
+static inline bool launches_are_synchronous(void) {
+#ifdef CHPL_GPU_MEM_STRATEGY_ARRAY_ON_DEVICE
+  return chpl_gpu_sync_with_host;
+#else
+  return true;
+#endif
+}
+
+// Reset the parts of a config that are per launch.
+static void cfg_reset(kernel_cfg* cfg, void* stream) {
+  cfg->stream = stream;
+  cfg->cur_param = 0;
+  cfg->cur_pid = 0;
+  cfg->max_pid = -1;
+  cfg->priv_table_host = NULL;
+  cfg->priv_table_dev = NULL;
+  cfg->has_priv_table_lock = false;
+  cfg->cur_reduce_var = 0;
+  cfg->cur_host_registered_var = 0;
+  cfg->n_prefetch = 0;
+}
+
 static void cfg_init(kernel_cfg* cfg, const char* fn_name,
                      int n_params, int n_pids, int n_reduce_vars,
-                     int n_host_registered_vars, int ln, int32_t fn) {
+                     int n_host_registered_vars, int ln, int32_t fn,
+                     int dev, void* stream, cfg_site* site) {
 
   cfg->fn_name = fn_name;
 
-  cfg->dev = chpl_task_getRequestedSubloc();
-  cfg->stream = get_stream(cfg->dev);
+  cfg->dev = dev;
 
   cfg->ln = ln;
   cfg->fn = fn;
@@ -364,7 +576,6 @@ static void cfg_init(kernel_cfg* cfg, const char* fn_name,
   // +2 for the ln and fn arguments that we add to the end of the array
   // we pass an additional reduce buffer per reduce variable
   cfg->n_params = n_params+n_reduce_vars+2;
-  cfg->cur_param = 0;
 
   cfg->kernel_params = chpl_mem_alloc(cfg->n_params * sizeof(void **),
                                       CHPL_RT_MD_GPU_KERNEL_PARAM_BUFF, ln, fn);
@@ -375,36 +586,40 @@ static void cfg_init(kernel_cfg* cfg, const char* fn_name,
                                             ln, fn);
   assert(cfg->param_dyn_allocated);
 
+  cfg->param_sizes = chpl_mem_alloc(cfg->n_params * sizeof(size_t),
+                                    CHPL_RT_MD_GPU_KERNEL_PARAM_META, ln, fn);
+  cfg->param_sizes[cfg->n_params-2] = sizeof(cfg->ln);
+  cfg->param_sizes[cfg->n_params-1] = sizeof(cfg->fn);
+
   // add the ln and fn arguments to the end of the array These arguments only
   // make sense when the kernel lives inside of standard module code and
   // CHPL_DEVELOPER is not set since the generated kernel function will have two
   // extra formals to account for the line and file num.  If CHPL_DEVELOPER is
   // set, these arguments are dropped on the floor
-  cfg->kernel_params[cfg->n_params-2] = (void**)(&ln);
-  cfg->kernel_params[cfg->n_params-1] = (void**)(&fn);
+  cfg->kernel_params[cfg->n_params-2] = (void**)(&cfg->ln);
+  cfg->kernel_params[cfg->n_params-1] = (void**)(&cfg->fn);
 
-  cfg->param_dyn_allocated[cfg->n_params-2] = false;
-  cfg->param_dyn_allocated[cfg->n_params-1] = false;
+  for (int i=0 ; i<cfg->n_params ; i++) {
+    cfg->param_dyn_allocated[i] = false;
+  }
 
   cfg->n_pids = n_pids;
-  cfg->cur_pid = 0;
-  cfg->max_pid = -1;
   cfg->priv_insts = chpl_mem_alloc(cfg->n_pids * sizeof(priv_inst),
                                    CHPL_RT_MD_GPU_KERNEL_PARAM_BUFF, ln, fn);
 
-  cfg->priv_table_host = NULL;
-  cfg->priv_table_dev = NULL;
-
-  cfg->has_priv_table_lock = false;
-
   cfg->n_reduce_vars = n_reduce_vars;
-  cfg->cur_reduce_var = 0;
 
-  cfg->reduce_vars = chpl_mem_alloc(cfg->n_reduce_vars * sizeof(reduce_var),
-                                    CHPL_RT_MD_GPU_KERNEL_PARAM_BUFF, ln, fn);
+  cfg->reduce_vars = chpl_mem_calloc(cfg->n_reduce_vars, sizeof(reduce_var),
+                                     CHPL_RT_MD_GPU_KERNEL_PARAM_BUFF, ln, fn);
+
+  cfg->prefetch_ptrs = NULL;
+  if (prefetch_args) {
+    cfg->prefetch_ptrs = chpl_mem_alloc(cfg->n_params * sizeof(void*),
+                                        CHPL_RT_MD_GPU_KERNEL_PARAM_META,
+                                        ln, fn);
+  }
 
   cfg->n_host_registered = n_host_registered_vars;
-  cfg->cur_host_registered_var = 0;
   cfg->host_registered_var_boxes = chpl_mem_alloc(
     cfg->n_host_registered * sizeof(void*), CHPL_RT_MD_GPU_KERNEL_PARAM_BUFF,
     ln, fn);
@@ -419,6 +634,24 @@ static void cfg_init(kernel_cfg* cfg, const char* fn_name,
   }
 
   cfg->halt_flag = NULL;
+
+  cfg->site = site;
+  cfg->last_stream = NULL;
+  cfg->function = NULL;
+  cfg->offload_sizes = NULL;
+  cfg->offload_shadows = NULL;
+  cfg->deferred = false;
+  cfg->next_cached = NULL;
+  if (site != NULL) {
+    cfg->offload_sizes = chpl_mem_calloc(cfg->n_params, sizeof(size_t),
+                                         CHPL_RT_MD_GPU_KERNEL_PARAM_META,
+                                         ln, fn);
+    cfg->offload_shadows = chpl_mem_calloc(cfg->n_params, sizeof(void*),
+                                           CHPL_RT_MD_GPU_KERNEL_PARAM_META,
+                                           ln, fn);
+  }
+
+  cfg_reset(cfg, stream);
 }
 
 static void cfg_init_dims_1d(kernel_cfg* cfg, int64_t num_threads,
@@ -455,25 +688,65 @@ static void cfg_init_dims_3d(kernel_cfg* cfg,
   cfg->blk_dim_z = blk_dim_z;
 }
 
+static void cfg_free_offload_param(kernel_cfg* cfg, int i) {
+  chpl_gpu_mem_free(*(cfg->kernel_params[i]), cfg->ln, cfg->fn);
+  chpl_mem_free(cfg->kernel_params[i], cfg->ln, cfg->fn);
+  if (cfg->offload_shadows && cfg->offload_shadows[i]) {
+    chpl_mem_free(cfg->offload_shadows[i], cfg->ln, cfg->fn);
+    cfg->offload_shadows[i] = NULL;
+    cfg->offload_sizes[i] = 0;
+  }
+  cfg->param_dyn_allocated[i] = false;
+}
+
 static void cfg_deinit_params(kernel_cfg* cfg) {
   // free GPU memory allocated for kernel parameters
   for (int i=0 ; i<cfg->n_params ; i++) {
     if (cfg->param_dyn_allocated[i]) {
-      chpl_gpu_mem_free(*(cfg->kernel_params[i]), cfg->ln, cfg->fn);
-      chpl_mem_free(cfg->kernel_params[i], cfg->ln, cfg->fn);
+      cfg_free_offload_param(cfg, i);
     }
   }
 
+  if (cfg->offload_sizes) {
+    chpl_mem_free(cfg->offload_shadows, cfg->ln, cfg->fn);
+    chpl_mem_free(cfg->offload_sizes, cfg->ln, cfg->fn);
+    cfg->offload_shadows = NULL;
+    cfg->offload_sizes = NULL;
+  }
+
+  chpl_mem_free(cfg->param_sizes, cfg->ln, cfg->fn);
+  cfg->param_sizes = NULL;
+
   // deallocate these two in reverse order for ease of verbose mem debugging
   chpl_mem_free(cfg->param_dyn_allocated, cfg->ln, cfg->fn);
   chpl_mem_free(cfg->kernel_params, cfg->ln, cfg->fn);
+  cfg->param_dyn_allocated = NULL;
+  cfg->kernel_params = NULL;
 }
 
 static void cfg_add_offload_param(kernel_cfg* cfg, void* arg, size_t size) {
   const int i = cfg->cur_param;
   assert(i < cfg->n_params-2); // -2 because last two params are always ln and fn
 
+  if (cfg->param_dyn_allocated[i] && cfg->offload_sizes[i] == size) {
+    // A cached config whose previous launch is done: reuse the buffer, and
+    // skip the copy if the param hasn't changed. Kernels only read their
+    // by-offload params, so the buffer still holds what we last copied.
+    if (memcmp(cfg->offload_shadows[i], arg, size) != 0) {
+      graph_flush();
+      chpl_gpu_impl_copy_host_to_device(*(cfg->kernel_params[i]), arg, size,
+                                        cfg->stream);
+      memcpy(cfg->offload_shadows[i], arg, size);
+    }
+    cfg->cur_param++;
+    return;
+  }
+  if (cfg->param_dyn_allocated[i]) {
+    cfg_free_offload_param(cfg, i);
+  }
+
   cfg->param_dyn_allocated[i] = true;
+  cfg->param_sizes[i] = sizeof(void*);
 
   // the kernel_params array must store the addresses of things that will be
   // copied to the device memory before the kernel launch. For by-offload
@@ -489,18 +762,30 @@ static void cfg_add_offload_param(kernel_cfg* cfg, void* arg, size_t size) {
                                                       CHPL_RT_MD_GPU_KERNEL_ARG,
                                                       cfg->ln, cfg->fn);
 
+  graph_flush();
   chpl_gpu_impl_copy_host_to_device(*(cfg->kernel_params[i]), arg, size,
                                     cfg->stream);
 
+  if (cfg->site != NULL) {
+    cfg->offload_sizes[i] = size;
+    cfg->offload_shadows[i] = chpl_mem_alloc(size,
+                                             CHPL_RT_MD_GPU_KERNEL_PARAM_BUFF,
+                                             cfg->ln, cfg->fn);
+    memcpy(cfg->offload_shadows[i], arg, size);
+  }
+
   cfg->cur_param++;
 }
 
-static void cfg_add_direct_param(kernel_cfg* cfg, void* arg) {
+static void cfg_add_direct_param(kernel_cfg* cfg, void* arg, size_t size) {
   const int i = cfg->cur_param;
   assert(i < cfg->n_params-2); // -2 because last two params are always ln and fn
 
-  cfg->param_dyn_allocated[i] = false;
+  if (cfg->param_dyn_allocated[i]) {
+    cfg_free_offload_param(cfg, i);
+  }
   cfg->kernel_params[i] = arg;
+  cfg->param_sizes[i] = size;
 
   cfg->cur_param++;
 }
@@ -533,6 +818,7 @@ static void cfg_add_pid(kernel_cfg* cfg, int64_t pid, size_t size) {
 
     CHPL_GPU_DEBUG("\tprivatized device instance %p\n", dev_instance);
 
+    graph_flush();
     chpl_gpu_impl_copy_host_to_device(dev_instance,
                                       chpl_privateObjects[pid].obj,
                                       size,
@@ -617,10 +903,7 @@ static void cfg_finalize_priv_table(kernel_cfg *cfg) {
 
   CHPL_GPU_DEBUG("Global for the device table: %p\n", dev_global);
 
-  chpl_atomic_spinlock_t* lock = &(priv_table_lock[cfg->dev]);
-  while(!atomic_try_lock_spinlock_t(lock)) {
-    chpl_task_yield();
-  }
+  atomic_lock_spinlock_t(&(priv_table_lock[cfg->dev].lock));
 
   cfg->has_priv_table_lock = true;
 
@@ -676,15 +959,134 @@ static int cfg_get_halt_flag(kernel_cfg* cfg) {
   return halt_flag;
 }
 
+static void cfg_destroy(kernel_cfg* cfg) {
+  cfg_deinit_params(cfg);
+  chpl_mem_free(cfg->reduce_vars, cfg->ln, cfg->fn);
+  if (cfg->prefetch_ptrs) {
+    chpl_mem_free(cfg->prefetch_ptrs, cfg->ln, cfg->fn);
+  }
+  chpl_mem_free(cfg->priv_insts, cfg->ln, cfg->fn);
+  chpl_mem_free(cfg->host_registered_var_boxes, cfg->ln, cfg->fn);
+  chpl_mem_free(cfg->host_registered_vars, cfg->ln, cfg->fn);
+  chpl_mem_free(cfg->host_registered_vars_host_ptrs, cfg->ln, cfg->fn);
+  chpl_mem_free(cfg, cfg->ln, cfg->fn);
+}
+
+static inline size_t cfg_site_hash(const char* fn_name, int ln, int32_t fn,
+                                   int dev) {
+  uint64_t h = 1469598103934665603ULL;
+  for (const char* p = fn_name; *p; p++) {
+    h = (h ^ (unsigned char)*p) * 1099511628211ULL;
+  }
+  h = (h ^ (uint64_t)ln) * 1099511628211ULL;
+  h = (h ^ (uint64_t)fn) * 1099511628211ULL;
+  h = (h ^ (uint64_t)dev) * 1099511628211ULL;
+  return h % CFG_CACHE_NBUCKETS;
+}
+
+// Find (or make) the call site's entry, and take a config from it that
+// is safe to reuse on stream: one last launched on the same stream, or
+// any of them if launches don't leave work behind (and a graph region
+// didn't defer its last one). Returns the config,
+// or NULL after setting *site_out for a new one.
+static kernel_cfg* cfg_cache_get(const char* fn_name, int ln, int32_t fn,
+                                 int dev, void* stream, cfg_site** site_out) {
+  size_t h = cfg_site_hash(fn_name, ln, fn, dev);
+  kernel_cfg* cfg = NULL;
+  cfg_site* site;
+
+  atomic_lock_spinlock_t(&cfg_cache_lock);
+  for (site = cfg_cache_sites[h]; site != NULL; site = site->next) {
+    if (site->ln == ln && site->fn == fn && site->dev == dev &&
+        (site->fn_name == fn_name || strcmp(site->fn_name, fn_name) == 0)) {
+      break;
+    }
+  }
+  if (site == NULL) {
+    site = chpl_mem_calloc(1, sizeof(cfg_site), CHPL_RT_MD_GPU_UTIL, ln, fn);
+    site->fn_name = fn_name;
+    site->ln = ln;
+    site->fn = fn;
+    site->dev = dev;
+    site->next = cfg_cache_sites[h];
+    cfg_cache_sites[h] = site;
+  }
+
+  kernel_cfg** p = &site->cached;
+  while (*p != NULL && (*p)->last_stream != stream &&
+         (!launches_are_synchronous() || (*p)->deferred)) {
+    p = &(*p)->next_cached;
+  }
+  if (*p != NULL) {
+    cfg = *p;
+    *p = cfg->next_cached;
+    cfg->next_cached = NULL;
+    site->n_cached--;
+  }
+  atomic_unlock_spinlock_t(&cfg_cache_lock);
+
+  *site_out = site;
+  return cfg;
+}
+
+static void cfg_cache_put(kernel_cfg* cfg) {
+  cfg_site* site = cfg->site;
+  bool keep = false;
+
+  cfg->last_stream = cfg->stream;
+
+  atomic_lock_spinlock_t(&cfg_cache_lock);
+  if (site->n_cached < CFG_CACHE_PER_SITE) {
+    cfg->next_cached = site->cached;
+    site->cached = cfg;
+    site->n_cached++;
+    keep = true;
+  }
+  atomic_unlock_spinlock_t(&cfg_cache_lock);
+
+  if (!keep) cfg_destroy(cfg);
+}
+
+static kernel_cfg* cfg_get(const char* fn_name, int n_params, int n_pids,
+                           int n_reduce_vars, int n_host_registered_vars,
+                           int ln, int32_t fn) {
+  int dev = chpl_task_getRequestedSubloc();
+  void* stream = get_stream_for_launch(dev);
+  cfg_site* site = NULL;
+  kernel_cfg* cfg = NULL;
+
+  if (cfg_cache_enabled) {
+    cfg = cfg_cache_get(fn_name, ln, fn, dev, stream, &site);
+    if (cfg != NULL &&
+        (cfg->n_params != n_params+n_reduce_vars+2 || cfg->n_pids != n_pids ||
+         cfg->n_reduce_vars != n_reduce_vars ||
+         cfg->n_host_registered != n_host_registered_vars)) {
+      // shouldn't happen for one call site, but don't trust it
+      cfg_destroy(cfg);
+      cfg = NULL;
+    }
+    if (cfg != NULL) {
+      CHPL_GPU_DEBUG("Reusing cached kernel config %p for %s\n", cfg,
+                     fn_name);
+      cfg_reset(cfg, stream);
+      return cfg;
+    }
+  }
+
+  cfg = chpl_mem_alloc(sizeof(kernel_cfg), CHPL_RT_MD_GPU_KERNEL_PARAM_META,
+                       ln, fn);
+  cfg_init(cfg, fn_name, n_params, n_pids, n_reduce_vars,
+           n_host_registered_vars, ln, fn, dev, stream, site);
+  return cfg;
+}
+
 void* chpl_gpu_init_kernel_cfg(const char* fn_name, int64_t num_threads,
                                int blk_dim, int n_params, int n_pids,
                                int n_reduce_vars, int n_host_registered_vars,
                                int ln, int32_t fn) {
-  void* ret = chpl_mem_alloc(sizeof(kernel_cfg),
-                             CHPL_RT_MD_GPU_KERNEL_PARAM_META, ln, fn);
+  void* ret = cfg_get(fn_name, n_params, n_pids, n_reduce_vars,
+                      n_host_registered_vars, ln, fn);
 
-  cfg_init((kernel_cfg*)ret, fn_name, n_params, n_pids, n_reduce_vars,
-           n_host_registered_vars, ln, fn);
   cfg_init_dims_1d((kernel_cfg*)ret, num_threads, blk_dim);
 
   CHPL_GPU_DEBUG("Initialized kernel config for %s. num_threads=%"PRId64" blk_dim=%d"
@@ -702,11 +1104,9 @@ void* chpl_gpu_init_kernel_cfg_3d(const char* fn_name,
                                   int n_host_registered_vars, int ln,
                                   int32_t fn) {
 
-  void* ret = chpl_mem_alloc(sizeof(kernel_cfg),
-                             CHPL_RT_MD_GPU_KERNEL_PARAM_META, ln, fn);
+  void* ret = cfg_get(fn_name, n_params, n_pids, n_reduce_vars,
+                      n_host_registered_vars, ln, fn);
 
-  cfg_init((kernel_cfg*)ret, fn_name, n_params, n_pids, n_reduce_vars,
-           n_host_registered_vars, ln, fn);
   cfg_init_dims_3d((kernel_cfg*)ret,
                    grd_dim_x, grd_dim_y, grd_dim_z,
                    blk_dim_x, blk_dim_y, blk_dim_z);
@@ -722,7 +1122,7 @@ void chpl_gpu_deinit_kernel_cfg(void* _cfg) {
 
   // unlock the privatization table on the device
   if (cfg->has_priv_table_lock) {
-    atomic_unlock_spinlock_t(&(priv_table_lock[cfg->dev]));
+    atomic_unlock_spinlock_t(&(priv_table_lock[cfg->dev].lock));
   }
 
   // free GPU memory allocated for privatization
@@ -746,16 +1146,16 @@ void chpl_gpu_deinit_kernel_cfg(void* _cfg) {
   for (int i=0 ; i<cfg->n_reduce_vars ; i++) {
     chpl_gpu_mem_free(cfg->reduce_vars[i].buffer, cfg->ln, cfg->fn);
   }
-  chpl_mem_free(cfg->reduce_vars, cfg->ln, cfg->fn);
 
   for (int i=0 ; i<cfg->n_host_registered; i++) {
     chpl_gpu_impl_host_unregister(cfg->host_registered_vars_host_ptrs[i]);
   }
-  chpl_mem_free(cfg->host_registered_var_boxes, cfg->ln, cfg->fn);
-  chpl_mem_free(cfg->host_registered_vars, cfg->ln, cfg->fn);
-  chpl_mem_free(cfg->host_registered_vars_host_ptrs, cfg->ln, cfg->fn);
 
-  chpl_mem_free(cfg, ((kernel_cfg*)cfg)->ln, ((kernel_cfg*)cfg)->fn);
+  if (cfg->site != NULL) {
+    cfg_cache_put(cfg);
+  } else {
+    cfg_destroy(cfg);
+  }
   CHPL_GPU_DEBUG("Deinitialized kernel config\n");
 }
 
@@ -771,18 +1171,79 @@ void chpl_gpu_arg_offload(void* _cfg, void* arg, size_t size) {
   CHPL_GPU_DEBUG("\tAdded by-offload param (at %d): %p\n", cfg->cur_param, arg);
 }
 
-void chpl_gpu_arg_pass(void* _cfg, void* arg) {
+void chpl_gpu_arg_pass(void* _cfg, void* arg, size_t size) {
   kernel_cfg* cfg = (kernel_cfg*)_cfg;
-  cfg_add_direct_param(cfg, arg);
+  cfg_add_direct_param(cfg, arg, size);
   CHPL_GPU_DEBUG("\tAdded by-val param (at %d): %p\n", cfg->cur_param,  arg);
 }
 
+// Like chpl_gpu_arg_pass, for a pointer to array data (the compiler knows
+// which those are). With unified memory, prefetching the data to the
+// device first saves the kernel from faulting it over page by page.
+void chpl_gpu_arg_prefetch(void* _cfg, void* arg, size_t size) {
+  kernel_cfg* cfg = (kernel_cfg*)_cfg;
+  if (cfg->prefetch_ptrs != NULL && size == sizeof(void*)) {
+    cfg->prefetch_ptrs[cfg->n_prefetch++] = *(void**)arg;
+  }
+  chpl_gpu_arg_pass(_cfg, arg, size);
+}
+
+static void cfg_prefetch_args(kernel_cfg* cfg) {
+  void* bases[cfg->n_prefetch];
+  int n_bases = 0;
+
+  for (int i = 0; i < cfg->n_prefetch; i++) {
+    void* base;
+    size_t size;
+    if (!chpl_gpu_impl_get_managed_range(cfg->prefetch_ptrs[i], &base,
+                                         &size)) {
+      continue;
+    }
+
+    // several args can point into the same array
+    bool seen = false;
+    for (int j = 0; j < n_bases && !seen; j++) {
+      seen = (bases[j] == base);
+    }
+    if (seen) continue;
+    bases[n_bases++] = base;
+
+    CHPL_GPU_DEBUG("Prefetching %p (%zu bytes) to device %d\n", base, size,
+                   cfg->dev);
+    chpl_gpu_diags_verbose_prefetch(cfg->ln, cfg->fn, cfg->dev, size);
+    chpl_gpu_diags_incr(prefetch);
+    chpl_gpu_impl_mem_prefetch(base, size, cfg->dev, cfg->stream);
+  }
+}
+
+// Is final_fn one of the reductions a fused final pass can do? If so,
+// which one.
+static bool reduce_fn_kind(const char* final_fn,
+                           chpl_gpu_fused_reduce_var_t* v) {
+#define CHECK_ONE_REDUCE(kind, data_type) \
+  if (strcmp(final_fn, "chpl_gpu_" #kind "_reduce_" #data_type) == 0) { \
+    v->op = CHPL_GPU_REDUCE_OP_##kind; \
+    v->type = CHPL_GPU_REDUCE_TYPE_##data_type; \
+    return true; \
+  }
+
+  GPU_CUB_WRAP(CHECK_ONE_REDUCE, sum)
+  GPU_CUB_WRAP(CHECK_ONE_REDUCE, min)
+  GPU_CUB_WRAP(CHECK_ONE_REDUCE, max)
+
+#undef CHECK_ONE_REDUCE
+  return false;
+}
+
 void chpl_gpu_arg_reduce(void* _cfg, void* arg, size_t elem_size,
-                         reduce_wrapper_fn_t wrapper) {
+                         reduce_wrapper_fn_t wrapper, const char* final_fn) {
   kernel_cfg* cfg = (kernel_cfg*)_cfg;
   if (cfg_can_reduce(cfg)) {
+    // reductions read their results back, so they can't be deferred
+    graph_flush();
+
     // pass the argument normally
-    cfg_add_direct_param(cfg, arg);
+    cfg_add_direct_param(cfg, arg, elem_size);
 
     // create the reduction buffer
     const int i = cfg->cur_reduce_var;
@@ -794,13 +1255,20 @@ void chpl_gpu_arg_reduce(void* _cfg, void* arg, size_t elem_size,
     CHPL_GPU_DEBUG("Allocated reduction buffer: %p num elems:%d elem_size:%zu\n",
                    buf, cfg->grd_dim_x, elem_size);
 
-    cfg->reduce_vars[i].buffer = buf;
-    cfg->reduce_vars[i].outer_var = arg;
-    cfg->reduce_vars[i].elem_size = elem_size;
-    cfg->reduce_vars[i].wrapper = wrapper;
+    reduce_var* rv = &cfg->reduce_vars[i];
+    rv->buffer = buf;
+    rv->outer_var = arg;
+    rv->elem_size = elem_size;
+    rv->wrapper = wrapper;
+    if (rv->final_fn != final_fn) {
+      // a cached cfg keeps this from the last launch at the call site
+      rv->final_fn = final_fn;
+      rv->fusable = reduce_fn_kind(final_fn, &rv->fused);
+    }
 
     // pass the reduction buffer normally
-    cfg_add_direct_param((kernel_cfg*)cfg, &(cfg->reduce_vars[i].buffer));
+    cfg_add_direct_param((kernel_cfg*)cfg, &(cfg->reduce_vars[i].buffer),
+                         sizeof(void*));
 
     cfg->cur_reduce_var++;
 
@@ -817,14 +1285,31 @@ void chpl_gpu_arg_host_register(void* _cfg, void* arg, size_t size) {
 
   void *dev_arg = chpl_gpu_impl_host_register(arg, size);
   *(cfg->host_registered_vars[cfg->cur_host_registered_var]) = dev_arg;
-  cfg_add_direct_param(cfg, cfg->host_registered_vars[cfg->cur_host_registered_var]);
+  cfg_add_direct_param(cfg, cfg->host_registered_vars[cfg->cur_host_registered_var],
+                       sizeof(void*));
   cfg->host_registered_vars_host_ptrs[cfg->cur_host_registered_var] = arg;
   cfg->cur_host_registered_var += 1;
   CHPL_GPU_DEBUG("\tAdded ref intent param (at %d): %p\n", cfg->cur_param,  dev_arg);
 }
 
+// The kernel left a partial result per block in each reduction buffer.
+// Sums, mins and maxes are finished with one more kernel for all of
+// them, and anything else through its wrapper, one at a time.
 static void cfg_finalize_reductions(kernel_cfg* cfg) {
+  chpl_gpu_fused_reduce_t fused;
+  int fused_idx[CHPL_GPU_FUSED_REDUCE_MAX];
+  fused.n_vars = 0;
+
   for (int i=0 ; i<cfg->n_reduce_vars ; i++) {
+    reduce_var* rv = &cfg->reduce_vars[i];
+    if (fuse_reductions && rv->fusable &&
+        fused.n_vars < CHPL_GPU_FUSED_REDUCE_MAX) {
+      fused.vars[fused.n_vars] = rv->fused;
+      fused.vars[fused.n_vars].data = rv->buffer;
+      fused_idx[fused.n_vars++] = i;
+      continue;
+    }
+
     CHPL_GPU_DEBUG("Reduce %p into %p. Wrapper: %p\n",
                     cfg->reduce_vars[i].buffer,
                     cfg->reduce_vars[i].outer_var,
@@ -835,6 +1320,62 @@ static void cfg_finalize_reductions(kernel_cfg* cfg) {
                                 cfg->reduce_vars[i].outer_var,
                                 NULL); // no minloc/maxloc, yet
   }
+
+  if (fused.n_vars > 0) {
+    CHPL_GPU_DEBUG("Fused final pass for %d reductions\n", fused.n_vars);
+
+    int dev = chpl_task_getRequestedSubloc();
+    chpl_gpu_impl_use_device(dev);
+    void* stream = get_stream(dev);
+
+    chpl_gpu_impl_fused_reduce(&fused, cfg->grd_dim_x, stream);
+    for (int j=0 ; j<fused.n_vars ; j++) {
+      reduce_var* rv = &cfg->reduce_vars[fused_idx[j]];
+      chpl_gpu_impl_copy_device_to_host(rv->outer_var, rv->buffer,
+                                        rv->elem_size, stream);
+    }
+    wait_stream(stream);
+  }
+}
+
+static void spin_on_small_kernel(void* stream, int64_t n_threads) {
+  if (small_kernel_spin <= 0 || n_threads > small_kernel_threads) return;
+#ifdef CHPL_GPU_MEM_STRATEGY_ARRAY_ON_DEVICE
+  // nobody waits for the kernel right after the launch
+  if (!chpl_gpu_sync_with_host) return;
+#endif
+
+  double until = chpl_hrtimer_now() + small_kernel_spin;
+  while (!chpl_gpu_impl_stream_ready(stream) && chpl_hrtimer_now() < until);
+}
+
+// Leave the launch to the task's graph region (chpl-gpu-graph.h), if it
+// is in one and this is a launch it can take.
+static bool cfg_defer_launch(kernel_cfg* cfg, void* function,
+                             int grd_dim_x, int grd_dim_y, int grd_dim_z,
+                             int blk_dim_x, int blk_dim_y, int blk_dim_z) {
+  chpl_gpu_taskPrvData_t* prvData = get_gpu_task_private_data();
+  if (prvData == NULL || prvData->graph == NULL) return false;
+
+  // The device buffers of the params must stay put until the region
+  // launches, and nothing can need doing around the launch itself.
+  if (cfg->site == NULL || cfg->max_pid >= 0 || cfg->n_reduce_vars > 0 ||
+      cfg->n_host_registered > 0) {
+    return false;
+  }
+
+  if (!cfg->halt_flag) {
+    cfg_find_halt_flag(cfg);
+  }
+
+  return chpl_gpu_graph_defer_launch(prvData->graph, cfg->dev, cfg->stream,
+                                     function,
+                                     grd_dim_x, grd_dim_y, grd_dim_z,
+                                     blk_dim_x, blk_dim_y, blk_dim_z,
+                                     cfg->halt_flag, cfg->ln, cfg->fn,
+                                     cfg->n_params,
+                                     (void**)cfg->kernel_params,
+                                     cfg->param_sizes);
 }
 
 static void launch_kernel(const char* name,
@@ -852,7 +1393,11 @@ static void launch_kernel(const char* name,
   CHPL_GPU_DEBUG("Kernel configuration %p\n", cfg);
 
   CHPL_GPU_DEBUG("Loading function named %s\n", name);
-  void* function = chpl_gpu_impl_load_function(name);
+  void* function = cfg->function;
+  if (function == NULL) {
+    function = chpl_gpu_impl_load_function(name);
+    if (cfg->site != NULL) cfg->function = function;
+  }
   assert(function);
   CHPL_GPU_DEBUG("\tFunction Address: %p\n", function);
 
@@ -868,6 +1413,19 @@ static void launch_kernel(const char* name,
     CHPL_GPU_DEBUG("\t\tVal: %p\n", *(cfg->kernel_params[i]));
   }
 
+  cfg->deferred = false;
+  if (cfg_defer_launch(cfg, function, grd_dim_x, grd_dim_y, grd_dim_z,
+                       blk_dim_x, blk_dim_y, blk_dim_z)) {
+    CHPL_GPU_DEBUG("Deferred %s to the task's graph region\n", name);
+    cfg->deferred = true;
+    return;
+  }
+  graph_flush();
+
+  if (cfg->n_prefetch > 0) {
+    cfg_prefetch_args(cfg);
+  }
+
   cfg_finalize_priv_table(cfg);
 
   cfg_set_halt_flag(cfg, 0);
@@ -875,10 +1433,15 @@ static void launch_kernel(const char* name,
   CHPL_GPU_START_TIMER(kernel_time);
 
   CHPL_GPU_DEBUG("Calling impl's launcher %s\n", name);
+  void* stats = chpl_gpu_kernel_stats_begin(cfg->stream);
   chpl_gpu_impl_launch_kernel(function,
                               grd_dim_x, grd_dim_y, grd_dim_z,
                               blk_dim_x, blk_dim_y, blk_dim_z,
                               cfg->stream, (void**)(cfg->kernel_params));
+  chpl_gpu_kernel_stats_end(stats, cfg->stream, function, cfg->dev,
+                            cfg->ln, cfg->fn,
+                            (int64_t)grd_dim_x*grd_dim_y*grd_dim_z,
+                            blk_dim_x*blk_dim_y*blk_dim_z);
   CHPL_GPU_DEBUG("\tLauncher returned %s\n", name);
 
   if (cfg_get_halt_flag(cfg)) {
@@ -897,9 +1460,12 @@ static void launch_kernel(const char* name,
   CHPL_GPU_START_TIMER(teardown_time);
 
   // deinit them before synch as a (premature?) optimization
-  // Engin: note that we are not using stream-ordered allocators yet. So, I
-  // expect the following to serve as a synchronization unfortunately
-  cfg_deinit_params(cfg);
+  // These frees go to the memory pool (chpl-gpu-mem-pool.h), tagged with
+  // this stream, so they don't synchronize unless the pool is off or full.
+  // Cached configs keep their params for the next launch.
+  if (cfg->site == NULL) {
+    cfg_deinit_params(cfg);
+  }
 
   CHPL_GPU_STOP_TIMER(teardown_time);
 
@@ -909,17 +1475,34 @@ static void launch_kernel(const char* name,
       "Teardown: %Lf\n",
       name, load_time, prep_time, kernel_time, teardown_time);
 
-#ifdef CHPL_GPU_MEM_STRATEGY_ARRAY_ON_DEVICE
-  if (chpl_gpu_sync_with_host) {
-    CHPL_GPU_DEBUG("Eagerly synchronizing stream %p\n", cfg->stream);
-    wait_stream(cfg->stream);
-  }
-#else
-  chpl_gpu_impl_synchronize();
-#endif
+  spin_on_small_kernel(cfg->stream, (int64_t)grd_dim_x*grd_dim_y*grd_dim_z*
+                                    blk_dim_x*blk_dim_y*blk_dim_z);
+  sync_after_launch(cfg->stream);
+}
+
 
+void chpl_gpu_graph_begin(int64_t region_id) {
+  chpl_gpu_taskPrvData_t* prvData = get_gpu_task_private_data();
+  if (prvData == NULL) return;
+
+  int dev = chpl_task_getRequestedSubloc();
+  void* stream = NULL;
+  if (dev >= 0) {
+    chpl_gpu_impl_use_device(dev);
+    stream = get_stream_for_launch(dev);
+  }
+  chpl_gpu_graph_region_begin(&prvData->graph, region_id, dev, stream);
 }
 
+void chpl_gpu_graph_end(int64_t region_id) {
+  chpl_gpu_taskPrvData_t* prvData = get_gpu_task_private_data();
+  if (prvData == NULL || prvData->graph == NULL) return;
+
+  void* stream = chpl_gpu_graph_region_end(prvData->graph, region_id);
+  if (stream != NULL) {
+    sync_after_launch(stream);
+  }
+}
 
 inline void chpl_gpu_launch_kernel(void* _cfg) {
   kernel_cfg* cfg = (kernel_cfg*)_cfg;
@@ -963,10 +1546,37 @@ extern void chpl_gpu_comm_on_get(c_sublocid_t src_subloc, void* addr,
                                  void* raddr, size_t size);
 
 
+// Can the comm layer move data between local device memory and host
+// memory on another node without us staging it? If so, wait for
+// whatever the task has queued on the device first, since the network
+// won't.
+static bool comm_device_direct(c_sublocid_t dev, void* addr,
+                               c_nodeid_t node, void* raddr, size_t size) {
+#ifdef CHPL_GPU_MEM_STRATEGY_ARRAY_ON_DEVICE
+#ifdef HAS_CHPL_CACHE_FNS
+  // the remote cache would copy through the device pointer
+  if (chpl_cache_enabled()) return false;
+#endif
+  if (!chpl_comm_regMemDevice(addr, size, node, raddr)) return false;
+
+  chpl_gpu_impl_use_device(dev);
+  wait_stream(get_stream(dev));
+  return true;
+#else
+  return false;
+#endif
+}
+
 void chpl_gpu_comm_put(c_nodeid_t dst_node, c_sublocid_t dst_subloc, void *dst,
                        c_sublocid_t src_subloc, void *src,
                        size_t size, int32_t commID, int ln, int32_t fn)
 {
+  if (src_subloc >= 0 && dst_subloc < 0 &&
+      comm_device_direct(src_subloc, src, dst_node, dst, size)) {
+    chpl_comm_put(src, dst_node, dst, size, commID, ln, fn);
+    return;
+  }
+
   void* src_data = src;
   c_sublocid_t src_data_subloc = src_subloc;
   if (src_subloc >= 0) {
@@ -999,6 +1609,12 @@ void chpl_gpu_comm_get(c_sublocid_t dst_subloc, void *dst,
                        c_nodeid_t src_node, c_sublocid_t src_subloc, void *src,
                        size_t size, int32_t commID, int ln, int32_t fn)
 {
+  if (dst_subloc >= 0 && src_subloc < 0 &&
+      comm_device_direct(dst_subloc, dst, src_node, src, size)) {
+    chpl_comm_get(dst, src_node, src, size, commID, ln, fn);
+    return;
+  }
+
   void* dst_buff = dst;
   c_sublocid_t dst_buff_subloc = dst_subloc;
   if (dst_subloc >= 0) {
@@ -1026,6 +1642,285 @@ void chpl_gpu_comm_get(c_sublocid_t dst_subloc, void *dst,
   }
 }
 
+#ifdef CHPL_GPU_MEM_STRATEGY_ARRAY_ON_DEVICE
+//
+// Strided transfers where one side is local GPU memory go through 2D
+// copies (one per plane of the two innermost levels) instead of a copy
+// per row. If the other side is host memory on another locale, it is
+// staged through pinned buffers a sub-block at a time, with the comm
+// layer moving one sub-block while the GPU copies the previous one.
+//
+
+typedef struct staging_buf_s {
+  void* ptr;
+  struct staging_buf_s* next;
+} staging_buf;
+
+static staging_buf* staging_free = NULL;
+
+// Get a pinned buffer of staging_size bytes. They're kept for reuse.
+static staging_buf* staging_get(void) {
+  atomic_lock_spinlock_t(&staging_lock);
+  staging_buf* b = staging_free;
+  if (b != NULL) staging_free = b->next;
+  atomic_unlock_spinlock_t(&staging_lock);
+
+  if (b == NULL) {
+    b = chpl_mem_alloc(sizeof(staging_buf), CHPL_RT_MD_GPU_UTIL, 0, 0);
+    b->ptr = chpl_mem_alloc(staging_size, CHPL_RT_MD_GPU_UTIL, 0, 0);
+    chpl_gpu_impl_host_register(b->ptr, staging_size);
+  }
+  return b;
+}
+
+static void staging_put(staging_buf* b) {
+  atomic_lock_spinlock_t(&staging_lock);
+  b->next = staging_free;
+  staging_free = b;
+  atomic_unlock_spinlock_t(&staging_lock);
+}
+
+// Queue copies of a block of cnt[0] bytes times cnt[1] x ... x cnt[lvls]
+// rows, laid out with the byte strides dststr and srcstr.
+static void copy_strd_block(int8_t* dst, const size_t* dststr,
+                            const int8_t* src, const size_t* srcstr,
+                            const size_t* cnt, size_t lvls, void* stream) {
+  if (lvls == 0) {
+    chpl_gpu_impl_copy_2d(dst, cnt[0], src, cnt[0], cnt[0], 1, stream);
+  } else if (lvls == 1) {
+    chpl_gpu_impl_copy_2d(dst, dststr[0], src, srcstr[0], cnt[0], cnt[1],
+                          stream);
+  } else {
+    for (size_t i = 0; i < cnt[lvls]; i++) {
+      copy_strd_block(dst + i*dststr[lvls-1], dststr,
+                      src + i*srcstr[lvls-1], srcstr, cnt, lvls-1, stream);
+    }
+  }
+}
+
+static void host_comm_get_strd(void* dstaddr, size_t* dststrides,
+                               c_nodeid_t srcnode, void* srcaddr,
+                               size_t* srcstrides, size_t* count,
+                               int32_t lvls, size_t elemSize,
+                               int32_t commID, int ln, int32_t fn) {
+#ifdef HAS_CHPL_CACHE_FNS
+  if (chpl_cache_enabled()) {
+    chpl_cache_comm_get_strd(dstaddr, dststrides, srcnode, srcaddr,
+                             srcstrides, count, lvls, elemSize, commID, ln, fn);
+    return;
+  }
+#endif
+  chpl_comm_get_strd(dstaddr, dststrides, srcnode, srcaddr, srcstrides, count,
+                     lvls, elemSize, commID, ln, fn);
+}
+
+static void host_comm_put_strd(void* dstaddr, size_t* dststrides,
+                               c_nodeid_t dstnode, void* srcaddr,
+                               size_t* srcstrides, size_t* count,
+                               int32_t lvls, size_t elemSize,
+                               int32_t commID, int ln, int32_t fn) {
+#ifdef HAS_CHPL_CACHE_FNS
+  if (chpl_cache_enabled()) {
+    chpl_cache_comm_put_strd(dstaddr, dststrides, dstnode, srcaddr,
+                             srcstrides, count, lvls, elemSize, commID, ln, fn);
+    return;
+  }
+#endif
+  chpl_comm_put_strd(dstaddr, dststrides, dstnode, srcaddr, srcstrides, count,
+                     lvls, elemSize, commID, ln, fn);
+}
+
+#define STRD_MAX_LVLS 8
+
+// A strided transfer, in bytes, and how it splits into sub-blocks that
+// fit in a staging buffer.
+typedef struct {
+  size_t lvls;
+  size_t cnt[STRD_MAX_LVLS+1];  // cnt[0] in bytes
+  size_t dststr[STRD_MAX_LVLS];
+  size_t srcstr[STRD_MAX_LVLS];
+  size_t blk_lvls;   // a sub-block covers levels 0..blk_lvls
+  size_t blk_bytes;
+  size_t n_blks;     // the product of the counts of the levels above
+  // for the comm layer, which counts in elements: the sub-block's counts,
+  // and the strides of one packed in a staging buffer (in elements)
+  size_t blk_count[STRD_MAX_LVLS+1];
+  size_t packed_el[STRD_MAX_LVLS];
+  size_t packed[STRD_MAX_LVLS];    // the same, in bytes
+} strd_xfer;
+
+// Returns false if the transfer doesn't suit 2D copies.
+static bool strd_xfer_init(strd_xfer* x, size_t* dststrides,
+                           size_t* srcstrides, size_t* count,
+                           int32_t stridelevels, size_t elemSize) {
+  if (stridelevels < 0 || stridelevels > STRD_MAX_LVLS) return false;
+
+  x->lvls = (size_t)stridelevels;
+  x->cnt[0] = count[0] * elemSize;
+  for (size_t i = 0; i < x->lvls; i++) {
+    x->cnt[i+1] = count[i+1];
+    x->dststr[i] = dststrides[i] * elemSize;
+    x->srcstr[i] = srcstrides[i] * elemSize;
+  }
+
+  // rows of a 2D copy can't overlap
+  if (x->lvls > 0 && (x->dststr[0] < x->cnt[0] || x->srcstr[0] < x->cnt[0])) {
+    return false;
+  }
+
+  // the biggest sub-block that fits in a staging buffer
+  x->blk_lvls = 0;
+  x->blk_bytes = x->cnt[0];
+  while (x->blk_lvls < x->lvls &&
+         x->blk_bytes * x->cnt[x->blk_lvls+1] <= staging_size) {
+    x->blk_bytes *= x->cnt[x->blk_lvls+1];
+    x->blk_lvls++;
+  }
+  x->n_blks = 1;
+  for (size_t i = x->blk_lvls+1; i <= x->lvls; i++) {
+    x->n_blks *= x->cnt[i];
+  }
+
+  x->blk_count[0] = count[0];
+  for (size_t i = 0; i < x->blk_lvls; i++) {
+    x->blk_count[i+1] = count[i+1];
+    x->packed_el[i] = i == 0 ? count[0] : x->packed_el[i-1] * count[i];
+    x->packed[i] = x->packed_el[i] * elemSize;
+  }
+  return true;
+}
+
+// The byte offsets of sub-block b on the destination and source sides.
+static void strd_xfer_blk(strd_xfer* x, size_t b,
+                          size_t* dst_off, size_t* src_off) {
+  *dst_off = 0;
+  *src_off = 0;
+  for (size_t i = x->blk_lvls+1; i <= x->lvls; i++) {
+    size_t idx = b % x->cnt[i];
+    b /= x->cnt[i];
+    *dst_off += idx * x->dststr[i-1];
+    *src_off += idx * x->srcstr[i-1];
+  }
+}
+
+// Try to do a get_strd with 2D copies. Returns false if the caller should
+// do it the general way.
+static bool comm_get_strd_2d(c_sublocid_t dst_subloc, void* dstaddr,
+                             size_t* dststrides, c_nodeid_t srclocale,
+                             c_sublocid_t src_subloc, void* srcaddr,
+                             size_t* srcstrides, size_t* count,
+                             int32_t stridelevels, size_t elemSize,
+                             int32_t commID, int ln, int32_t fn) {
+  const bool local = (srclocale == chpl_nodeID);
+  // we can't read GPU memory on another locale directly
+  if (!local && (src_subloc >= 0 || dst_subloc < 0)) return false;
+
+  strd_xfer x;
+  if (!strd_xfer_init(&x, dststrides, srcstrides, count, stridelevels,
+                      elemSize)) {
+    return false;
+  }
+
+  const int dev = dst_subloc >= 0 ? dst_subloc : src_subloc;
+  chpl_gpu_impl_use_device(dev);
+  void* stream = get_stream(dev);
+
+  if (local) {
+    copy_strd_block((int8_t*)dstaddr, x.dststr, (int8_t*)srcaddr, x.srcstr,
+                    x.cnt, x.lvls, stream);
+    wait_stream(stream);
+    return true;
+  }
+
+  if (x.blk_bytes > staging_size) return false;
+
+  // Get sub-block b+1 while the GPU copies sub-block b in. A buffer isn't
+  // refilled until the copy out of it is done.
+  staging_buf* bufs[2] = { staging_get(), staging_get() };
+  size_t dst_off, src_off;
+
+  strd_xfer_blk(&x, 0, &dst_off, &src_off);
+  host_comm_get_strd(bufs[0]->ptr, x.packed_el, srclocale,
+                     (int8_t*)srcaddr + src_off, srcstrides, x.blk_count,
+                     x.blk_lvls, elemSize, commID, ln, fn);
+  for (size_t b = 0; b < x.n_blks; b++) {
+    copy_strd_block((int8_t*)dstaddr + dst_off, x.dststr,
+                    bufs[b%2]->ptr, x.packed, x.cnt, x.blk_lvls, stream);
+    if (b+1 < x.n_blks) {
+      strd_xfer_blk(&x, b+1, &dst_off, &src_off);
+      host_comm_get_strd(bufs[(b+1)%2]->ptr, x.packed_el, srclocale,
+                         (int8_t*)srcaddr + src_off, srcstrides, x.blk_count,
+                         x.blk_lvls, elemSize, commID, ln, fn);
+    }
+    wait_stream(stream);
+  }
+
+  staging_put(bufs[0]);
+  staging_put(bufs[1]);
+  return true;
+}
+
+// Like comm_get_strd_2d, for put_strd.
+static bool comm_put_strd_2d(c_sublocid_t src_subloc, void* dstaddr,
+                             size_t* dststrides, c_nodeid_t dstlocale,
+                             c_sublocid_t dst_subloc, void* srcaddr,
+                             size_t* srcstrides, size_t* count,
+                             int32_t stridelevels, size_t elemSize,
+                             int32_t commID, int ln, int32_t fn) {
+  const bool local = (dstlocale == chpl_nodeID);
+  // we can't write GPU memory on another locale directly
+  if (!local && (dst_subloc >= 0 || src_subloc < 0)) return false;
+
+  strd_xfer x;
+  if (!strd_xfer_init(&x, dststrides, srcstrides, count, stridelevels,
+                      elemSize)) {
+    return false;
+  }
+
+  const int dev = src_subloc >= 0 ? src_subloc : dst_subloc;
+  chpl_gpu_impl_use_device(dev);
+  void* stream = get_stream(dev);
+
+  if (local) {
+    copy_strd_block((int8_t*)dstaddr, x.dststr, (int8_t*)srcaddr, x.srcstr,
+                    x.cnt, x.lvls, stream);
+    wait_stream(stream);
+    return true;
+  }
+
+  if (x.blk_bytes > staging_size) return false;
+
+  // Copy sub-block b+1 out of the GPU while the comm layer puts sub-block
+  // b. A buffer isn't refilled until the put from it is done.
+  staging_buf* bufs[2] = { staging_get(), staging_get() };
+  size_t dst_off, src_off, next_dst_off, next_src_off;
+
+  strd_xfer_blk(&x, 0, &dst_off, &src_off);
+  copy_strd_block(bufs[0]->ptr, x.packed, (int8_t*)srcaddr + src_off,
+                  x.srcstr, x.cnt, x.blk_lvls, stream);
+  wait_stream(stream);
+  for (size_t b = 0; b < x.n_blks; b++) {
+    if (b+1 < x.n_blks) {
+      strd_xfer_blk(&x, b+1, &next_dst_off, &next_src_off);
+      copy_strd_block(bufs[(b+1)%2]->ptr, x.packed,
+                      (int8_t*)srcaddr + next_src_off, x.srcstr, x.cnt,
+                      x.blk_lvls, stream);
+    }
+    host_comm_put_strd((int8_t*)dstaddr + dst_off, dststrides, dstlocale,
+                       bufs[b%2]->ptr, x.packed_el, x.blk_count,
+                       x.blk_lvls, elemSize, commID, ln, fn);
+    if (b+1 < x.n_blks) {
+      wait_stream(stream);
+      dst_off = next_dst_off;
+    }
+  }
+
+  staging_put(bufs[0]);
+  staging_put(bufs[1]);
+  return true;
+}
+#endif // CHPL_GPU_MEM_STRATEGY_ARRAY_ON_DEVICE
+
 void chpl_gpu_comm_get_strd(c_sublocid_t dst_subloc,
                           void* dstaddr_arg, size_t* dststrides,
                           c_nodeid_t srclocale, c_sublocid_t src_subloc,
@@ -1036,6 +1931,14 @@ void chpl_gpu_comm_get_strd(c_sublocid_t dst_subloc,
   //
   // Note: This function differs from the original in chpl-comm-strd-xfer.h by
   // not supporting non-blocking communication calls.
+#ifdef CHPL_GPU_MEM_STRATEGY_ARRAY_ON_DEVICE
+  if (comm_get_strd_2d(dst_subloc, dstaddr_arg, dststrides, srclocale,
+                       src_subloc, srcaddr_arg, srcstrides, count,
+                       stridelevels, elemSize, commID, ln, fn)) {
+    return;
+  }
+#endif
+
   const size_t strlvls=(size_t)stridelevels;
   size_t i,j,k,t,total,off,x,carry;
 
@@ -1171,6 +2074,14 @@ void chpl_gpu_comm_put_strd(c_sublocid_t src_subloc,
   //
   // Note: This function differs from the original in chpl-comm-strd-xfer.h by
   // not supporting non-blocking communication calls.
+#ifdef CHPL_GPU_MEM_STRATEGY_ARRAY_ON_DEVICE
+  if (comm_put_strd_2d(src_subloc, dstaddr_arg, dststrides, dstlocale,
+                       dst_subloc, srcaddr_arg, srcstrides, count,
+                       stridelevels, elemSize, commID, ln, fn)) {
+    return;
+  }
+#endif
+
   const size_t strlvls=(size_t)stridelevels;
   size_t i,j,k,t,total,off,x,carry;
 
@@ -1378,9 +2289,16 @@ void chpl_gpu_copy_device_to_device(c_sublocid_t dst_dev, void* dst,
   chpl_gpu_diags_verbose_device_to_device_copy(ln, fn, dst_dev, src_dev, n,
                                                commID);
   chpl_gpu_diags_incr(device_to_device);
+  chpl_gpu_kernel_stats_copy(CHPL_GPU_KERNEL_STATS_DEVICE_TO_DEVICE, n);
 
   void* stream = get_stream(dst_dev);
-  chpl_gpu_impl_copy_device_to_device(dst, src, n, stream);
+  if (dst_dev != src_dev &&
+      peer_path(dst_dev, src_dev) == PEER_PATH_STAGED) {
+    chpl_gpu_impl_copy_peer(dst, dst_dev, src, src_dev, n, stream);
+  }
+  else {
+    chpl_gpu_impl_copy_device_to_device(dst, src, n, stream);
+  }
   if (dst_dev != src_dev) {
     // going to a device that maybe used by a different task, synchronize
     wait_stream(stream);
@@ -1406,6 +2324,7 @@ void chpl_gpu_copy_device_to_host(void* dst, c_sublocid_t src_dev,
 
   chpl_gpu_diags_verbose_device_to_host_copy(ln, fn, src_dev, n, commID);
   chpl_gpu_diags_incr(device_to_host);
+  chpl_gpu_kernel_stats_copy(CHPL_GPU_KERNEL_STATS_DEVICE_TO_HOST, n);
 
   chpl_gpu_impl_copy_device_to_host(dst, src, n, stream);
 
@@ -1427,6 +2346,7 @@ void chpl_gpu_copy_host_to_device(c_sublocid_t dst_dev, void* dst,
 
   chpl_gpu_diags_verbose_host_to_device_copy(ln, fn, dst_dev, n, commID);
   chpl_gpu_diags_incr(host_to_device);
+  chpl_gpu_kernel_stats_copy(CHPL_GPU_KERNEL_STATS_HOST_TO_DEVICE, n);
 
   chpl_gpu_impl_copy_host_to_device(dst, src, n, stream);
   if (chpl_gpu_sync_with_host) {
@@ -1453,6 +2373,10 @@ size_t chpl_gpu_get_alloc_size(void* ptr) {
   return chpl_gpu_impl_get_alloc_size(ptr);
 }
 
+bool chpl_gpu_get_mem_region(const void* ptr, chpl_gpu_mem_region_t* region) {
+  return chpl_gpu_impl_get_mem_region(ptr, region);
+}
+
 void* chpl_gpu_mem_alloc(size_t size, chpl_mem_descInt_t description,
                          int32_t lineno, int32_t filename) {
 
@@ -1461,10 +2385,12 @@ void* chpl_gpu_mem_alloc(size_t size, chpl_mem_descInt_t description,
 
   void *ptr = NULL;
   if (size > 0) {
-    chpl_gpu_impl_use_device(chpl_task_getRequestedSubloc());
+    int dev = chpl_task_getRequestedSubloc();
+    chpl_gpu_impl_use_device(dev);
 
     chpl_memhook_malloc_pre(1, size, description, lineno, filename);
-    ptr = chpl_gpu_impl_mem_alloc(size);
+    ptr = chpl_gpu_mem_pool_alloc(dev, size, /*array=*/false,
+                                  peek_stream(dev));
     chpl_memhook_malloc_post((void*)ptr, 1, size, description, lineno, filename);
 
     CHPL_GPU_DEBUG("chpl_gpu_mem_alloc returning %p\n", (void*)ptr);
@@ -1487,9 +2413,15 @@ void* chpl_gpu_mem_array_alloc(size_t size, chpl_mem_descInt_t description,
   void* ptr = 0;
   if (size > 0) {
     chpl_memhook_malloc_pre(1, size, description, lineno, filename);
-    ptr = chpl_gpu_impl_mem_array_alloc(size);
+    ptr = chpl_gpu_mem_pool_alloc(dev, size, /*array=*/true,
+                                  peek_stream(dev));
     chpl_memhook_malloc_post((void*)ptr, 1, size, description, lineno, filename);
 
+    if (arrays_prefer_device) {
+      chpl_gpu_impl_mem_advise(ptr, size,
+                               CHPL_GPU_MEM_ADVISE_PREFERRED_LOCATION, dev);
+    }
+
     CHPL_GPU_DEBUG("chpl_gpu_mem_array_alloc returning %p\n", (void*)ptr);
   }
   else {
@@ -1499,11 +2431,51 @@ void* chpl_gpu_mem_array_alloc(size_t size, chpl_mem_descInt_t description,
   return ptr;
 }
 
+void chpl_gpu_mem_prefetch(void* addr, size_t size, int32_t dev,
+                           int32_t lineno, int32_t filename) {
+#ifndef CHPL_GPU_MEM_STRATEGY_ARRAY_ON_DEVICE
+  if (addr == NULL || size == 0) return;
+
+  // it goes on the stream of the device we're running on, or on the one
+  // we're prefetching to if that's a device
+  int stream_dev = dev >= 0 ? dev : chpl_task_getRequestedSubloc();
+  if (stream_dev < 0) stream_dev = 0;
+
+  graph_flush();
+  chpl_gpu_impl_use_device(stream_dev);
+  chpl_gpu_diags_verbose_prefetch(lineno, filename, dev, size);
+  chpl_gpu_diags_incr(prefetch);
+  chpl_gpu_impl_mem_prefetch(addr, size, dev, get_stream(stream_dev));
+#endif
+}
+
+void chpl_gpu_mem_advise(void* addr, size_t size,
+                         chpl_gpu_mem_advice_t advice, int32_t dev) {
+#ifndef CHPL_GPU_MEM_STRATEGY_ARRAY_ON_DEVICE
+  if (addr == NULL || size == 0) return;
+
+  chpl_gpu_impl_mem_advise(addr, size, advice, dev);
+#endif
+}
+
 void chpl_gpu_mem_free(void* memAlloc, int32_t lineno, int32_t filename) {
   CHPL_GPU_DEBUG("chpl_gpu_mem_free is called. Ptr %p\n", memAlloc);
 
   chpl_memhook_free_pre(memAlloc, 0, lineno, filename);
-  chpl_gpu_impl_mem_free(memAlloc);
+  if (memAlloc != NULL) {
+    // deferred launches may still use it
+    graph_flush();
+  }
+  int dev = chpl_task_getRequestedSubloc();
+  if (!chpl_gpu_mem_pool_free(memAlloc, dev, peek_stream(dev))) {
+#ifdef CHPL_GPU_MEM_STRATEGY_ARRAY_ON_DEVICE
+    if (memAlloc != NULL) {
+      // the comm layer may have it registered
+      chpl_comm_regMemFreeNotify(memAlloc, chpl_gpu_get_alloc_size(memAlloc));
+    }
+#endif
+    chpl_gpu_impl_mem_free(memAlloc);
+  }
 
   CHPL_GPU_DEBUG("chpl_gpu_mem_free is returning\n");
 }
@@ -1531,7 +2503,8 @@ void* chpl_gpu_mem_calloc(size_t number, size_t size,
     chpl_gpu_impl_use_device(dev_id);
 
     chpl_memhook_malloc_pre(1, total_size, description, lineno, filename);
-    ptr = chpl_gpu_impl_mem_alloc(total_size);
+    ptr = chpl_gpu_mem_pool_alloc(dev_id, total_size, /*array=*/false,
+                                  peek_stream(dev_id));
     chpl_memhook_malloc_post((void*)ptr, 1, total_size, description, lineno, filename);
 
     chpl_gpu_impl_copy_host_to_device(ptr, host_mem, total_size, NULL);
@@ -1613,7 +2586,20 @@ bool chpl_gpu_can_access_peer(int dev1, int dev2) {
 }
 
 void chpl_gpu_set_peer_access(int dev1, int dev2, bool enable) {
-  chpl_gpu_impl_set_peer_access(dev1, dev2, enable);
+  if (peer_paths == NULL) {
+    chpl_gpu_impl_set_peer_access(dev1, dev2, enable);
+    return;
+  }
+
+  // the vendor runtimes complain about enabling what is already enabled
+  // (and the reverse), so only pass on changes
+  peer_path_t want = enable ? PEER_PATH_DIRECT : PEER_PATH_STAGED;
+  atomic_lock_spinlock_t(&peer_lock);
+  if (peer_paths[dev1*chpl_gpu_num_devices + dev2] != want) {
+    chpl_gpu_impl_set_peer_access(dev1, dev2, enable);
+    peer_paths[dev1*chpl_gpu_num_devices + dev2] = want;
+  }
+  atomic_unlock_spinlock_t(&peer_lock);
 }
 
 #define DEF_ONE_REDUCE(kind, data_type)\
@@ -1668,6 +2654,111 @@ GPU_CUB_WRAP(DEF_ONE_SORT, keys)
 
 #undef DEF_ONE_SORT
 
+#define DEF_ONE_SORT_PAIRS(chpl_kind, data_type)\
+void chpl_gpu_sort_##chpl_kind##_##data_type(data_type* keys_in, \
+                                             data_type* keys_out, \
+                                             int64_t* vals_in, \
+                                             int64_t* vals_out, \
+                                             int n) { \
+  CHPL_GPU_DEBUG("chpl_gpu_sort_" #chpl_kind "_" #data_type " called\n"); \
+  \
+  int dev = chpl_task_getRequestedSubloc(); \
+  chpl_gpu_impl_use_device(dev); \
+  void* stream = get_stream(dev); \
+  \
+  chpl_gpu_impl_sort_##chpl_kind##_##data_type(keys_in, keys_out, \
+                                               vals_in, vals_out, n, stream); \
+  \
+  if (chpl_gpu_sync_with_host) { \
+    CHPL_GPU_DEBUG("Eagerly synchronizing stream %p\n", stream); \
+    wait_stream(stream); \
+  } \
+  \
+  CHPL_GPU_DEBUG("chpl_gpu_sort_" #chpl_kind "_" #data_type " returned\n"); \
+}
+
+GPU_CUB_WRAP(DEF_ONE_SORT_PAIRS, pairs)
+
+#undef DEF_ONE_SORT_PAIRS
+
+#define DEF_ONE_SEGMENTED_SORT(chpl_kind, data_type)\
+void chpl_gpu_segmented_sort_##chpl_kind##_##data_type(data_type* data_in, \
+                                                       data_type* data_out, \
+                                                       int n, int n_segments, \
+                                                       int* offsets) { \
+  CHPL_GPU_DEBUG("chpl_gpu_segmented_sort_" #chpl_kind "_" #data_type \
+                 " called\n"); \
+  \
+  int dev = chpl_task_getRequestedSubloc(); \
+  chpl_gpu_impl_use_device(dev); \
+  void* stream = get_stream(dev); \
+  \
+  chpl_gpu_impl_segmented_sort_##chpl_kind##_##data_type(data_in, data_out, \
+                                                         n, n_segments, \
+                                                         offsets, stream); \
+  \
+  if (chpl_gpu_sync_with_host) { \
+    CHPL_GPU_DEBUG("Eagerly synchronizing stream %p\n", stream); \
+    wait_stream(stream); \
+  } \
+  \
+  CHPL_GPU_DEBUG("chpl_gpu_segmented_sort_" #chpl_kind "_" #data_type \
+                 " returned\n"); \
+}
+
+GPU_CUB_WRAP(DEF_ONE_SEGMENTED_SORT, keys)
+
+#undef DEF_ONE_SEGMENTED_SORT
+
+#define DEF_ONE_SCAN(chpl_kind, data_type)\
+void chpl_gpu_##chpl_kind##_scan_##data_type(data_type* data_in, \
+                                             data_type* data_out, \
+                                             int n) { \
+  CHPL_GPU_DEBUG("chpl_gpu_" #chpl_kind "_scan_" #data_type " called\n"); \
+  \
+  int dev = chpl_task_getRequestedSubloc(); \
+  chpl_gpu_impl_use_device(dev); \
+  void* stream = get_stream(dev); \
+  \
+  chpl_gpu_impl_##chpl_kind##_scan_##data_type(data_in, data_out, n, stream); \
+  \
+  if (chpl_gpu_sync_with_host) { \
+    CHPL_GPU_DEBUG("Eagerly synchronizing stream %p\n", stream); \
+    wait_stream(stream); \
+  } \
+  \
+  CHPL_GPU_DEBUG("chpl_gpu_" #chpl_kind "_scan_" #data_type " returned\n"); \
+}
+
+GPU_CUB_WRAP(DEF_ONE_SCAN, exclusive)
+GPU_CUB_WRAP(DEF_ONE_SCAN, inclusive)
+
+#undef DEF_ONE_SCAN
+
+// the caller needs the count to do anything with the result, so this
+// one always waits
+#define DEF_ONE_SELECT(chpl_kind, data_type)\
+void chpl_gpu_select_##chpl_kind##_##data_type(data_type* data_in, \
+                                               chpl_bool* flags, \
+                                               data_type* data_out, \
+                                               int n, int* n_selected) { \
+  CHPL_GPU_DEBUG("chpl_gpu_select_" #chpl_kind "_" #data_type " called\n"); \
+  \
+  int dev = chpl_task_getRequestedSubloc(); \
+  chpl_gpu_impl_use_device(dev); \
+  void* stream = get_stream(dev); \
+  \
+  chpl_gpu_impl_select_##chpl_kind##_##data_type(data_in, flags, data_out, \
+                                                 n, n_selected, stream); \
+  wait_stream(stream); \
+  \
+  CHPL_GPU_DEBUG("chpl_gpu_select_" #chpl_kind "_" #data_type " returned\n"); \
+}
+
+GPU_CUB_WRAP(DEF_ONE_SELECT, flagged)
+
+#undef DEF_ONE_SELECT
+
 void chpl_gpu_name(int dev, char **result) {
   const int BUFFER_SIZE = 0xFF;
   char* resultBuffer = (char *)chpl_mem_alloc(BUFFER_SIZE, CHPL_RT_MD_IO_BUFFER, __LINE__, 0);
@@ -26,17 +26,23 @@
 #include "chplcgfns.h"
 #include "chpl-cache.h"
 #include "chpl-comm.h"
+#include "chpl-env.h"
 #include "chplexit.h"
 #include "chplio.h"
 #include "chpl-gpu.h"
 #include "chpl-init.h"
 #include "chpl-mem.h"
 #include "chplmemtrack.h"
+#include "chpl-perf-region.h"
+#include "chpl-pgo.h"
 #include "chpl-privatization.h"
+#include "chpl-profile.h"
 #include "chpl-tasks.h"
 #include "chpl-topo.h"
+#include "chpl-trace.h"
 #include "chpl-linefile-support.h"
 #include "chplsys.h"
+#include "chpltimers.h"
 #include "config.h"
 #include "error.h"
 
@@ -48,6 +54,67 @@
 
 static const int32_t myFilename = CHPL_FILE_IDX_INTERNAL;
 
+//
+// Startup timing.  The phases are always timed; with
+// CHPL_RT_STARTUP_TIMING set, locale 0 prints them once the standard
+// modules are initialized.
+//
+typedef enum {
+  startup_topo,
+  startup_comm,
+  startup_mem,
+  startup_comm_post_mem,
+  startup_args,
+  startup_tasks,
+  startup_comm_post_task,
+  startup_gpu,
+  startup_rollcall,
+  startup_modules,
+  startup_num_phases
+} startup_phase_t;
+
+static const char* startupPhaseNames[startup_num_phases] = {
+  "topology",
+  "comm init",
+  "memory init",
+  "comm post-memory init",
+  "argument parsing",
+  "tasking init",
+  "comm post-tasking init",
+  "gpu init",
+  "rollcall and barrier",
+  "module init",
+};
+
+static double startupPhaseSecs[startup_num_phases];
+static double startupPhaseStart;
+
+static void startup_phase_done(startup_phase_t phase) {
+  double now = chpl_hrtimer_now();
+  startupPhaseSecs[phase] += now - startupPhaseStart;
+  startupPhaseStart = now;
+}
+
+static void startup_report(void) {
+  double total = 0.0;
+
+  if (chpl_nodeID != 0 || !chpl_env_rt_get_bool("STARTUP_TIMING", false)) {
+    return;
+  }
+
+  printf("startup timing (locale 0):\n");
+  for (int i = 0; i < startup_num_phases; i++) {
+    printf("  %-24s %10.6f s\n", startupPhaseNames[i], startupPhaseSecs[i]);
+    total += startupPhaseSecs[i];
+  }
+  printf("  %-24s %10.6f s\n", "total", total);
+  if (chpl_comm_regMemHeapTouchSeconds() > 0.0) {
+    printf("  %-24s %10.6f s (overlapped)\n", "heap pre-fault",
+           chpl_comm_regMemHeapTouchSeconds());
+  }
+  fflush(stdout);
+}
+
 chpl_main_argument chpl_gen_main_arg;
 
 char* chpl_executionCommand;
@@ -209,6 +276,9 @@ void chpl_rt_init(int argc, char* argv[]) {
   int runInGDB;
   int runInLLDB;
 
+  chpl_hrtimer_init();
+  startupPhaseStart = chpl_hrtimer_now();
+
   // Check that we can get the page size.
   assert( sys_page_size() > 0 );
 
@@ -219,6 +289,9 @@ void chpl_rt_init(int argc, char* argv[]) {
   // So that use of localtime_r is portable.
   tzset();
 
+  // Pick up the environment the launcher bundled up for us, if any.
+  chpl_env_load_bundle();
+
   //
   // Handle options that set the environment before doing any other
   // runtime initialization.
@@ -260,13 +333,17 @@ void chpl_rt_init(int argc, char* argv[]) {
 
   chpl_error_init();  // This does local-only initialization
   chpl_topo_pre_comm_init(NULL);
+  startup_phase_done(startup_topo);
   chpl_comm_init(&argc, &argv);
   chpl_topo_post_comm_init();
   chpl_comm_pre_mem_init();
+  startup_phase_done(startup_comm);
   chpl_mem_init();
+  startup_phase_done(startup_mem);
   chpl_comm_post_mem_init();
 
   chpl_comm_barrier("about to leave comm init code");
+  startup_phase_done(startup_comm_post_mem);
 
   CreateConfigVarTable();      // get ready to start tracking config vars
   chpl_gen_main_arg.argv = chpl_malloc(argc * sizeof(char*));
@@ -303,6 +380,8 @@ void chpl_rt_init(int argc, char* argv[]) {
     }
   }
 
+  startup_phase_done(startup_args);
+
   //
   // Initialize the task management layer.
   //
@@ -310,6 +389,7 @@ void chpl_rt_init(int argc, char* argv[]) {
 
   // Initialize privatization, needs to happen before hitting module init
   chpl_privatization_init();
+  startup_phase_done(startup_tasks);
 
   //
   // Some comm layer initialization has to wait until after the
@@ -319,10 +399,16 @@ void chpl_rt_init(int argc, char* argv[]) {
 #ifdef HAS_CHPL_CACHE_FNS
   chpl_cache_init();
 #endif
+  chpl_trace_init();
+  chpl_profile_init();
+  chpl_perf_region_init();
+  chpl_pgo_init();
+  startup_phase_done(startup_comm_post_task);
 
 #ifdef HAS_GPU_LOCALE
   chpl_gpu_init();
 #endif
+  startup_phase_done(startup_gpu);
   chpl_comm_rollcall();
 
   //
@@ -330,6 +416,7 @@ void chpl_rt_init(int argc, char* argv[]) {
   // running Chapel code.
   //
   chpl_comm_barrier("barrier before main");
+  startup_phase_done(startup_rollcall);
 }
 
 //
@@ -365,6 +452,9 @@ void chpl_std_module_init(void) {
     // the standard modules are initialized.
     //
     CHPL_TASK_STD_MODULES_INITIALIZED();
+
+    startup_phase_done(startup_modules);
+    startup_report();
   } else {
     //
     // On non-0 locales, just call the pre- and post-user-code hooks
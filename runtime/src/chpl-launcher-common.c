@@ -31,6 +31,7 @@
 #include "chplcgfns.h"
 #include "chpl-comm-launch.h"
 #include "chpl-comm-locales.h"
+#include "chpl-env.h"
 #include "chplexit.h"
 #include "chpllaunch.h"
 #include "chpl-mem.h"
@@ -575,12 +576,86 @@ int chpl_launch_using_system(char* command, char* argv0) {
   return chpl_doDryRun() ? 0 : system(command);
 }
 
+//
+// Environment bundles.  With CHPL_LAUNCHER_ENV_BUNDLE set to a path on
+// a file system the compute nodes share, the launcher writes the whole
+// environment there once and passes the program only the path (in
+// CHPL_RT_ENV_BUNDLE), instead of naming every variable on the system
+// launcher's command line.  The program loads the bundle at the start
+// of chpl_rt_init().  A few variables are forwarded as usual anyway,
+// because they matter before the program can load anything.
+//
+static const char* envBundleKeepPrefixes[] = {
+  "CHPL_RT_ENV_BUNDLE=", "LD_", "GASNET_", NULL
+};
+
+static chpl_bool env_key_is_modshare(const char* ev, int keyLen) {
+  return keyLen > 8 && strncmp(ev + keyLen - 9, "_modshare", 9) == 0;
+}
+
+static chpl_bool env_key_forwarded(const char* ev, int keyLen,
+                                   chpl_bool bundled) {
+  if (env_key_is_modshare(ev, keyLen)) {
+    return false;
+  }
+  if (!bundled) {
+    return true;
+  }
+  for (int i = 0; envBundleKeepPrefixes[i] != NULL; i++) {
+    if (strncmp(ev, envBundleKeepPrefixes[i],
+                strlen(envBundleKeepPrefixes[i])) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static chpl_bool write_env_bundle(void) {
+  const char* path = getenv("CHPL_LAUNCHER_ENV_BUNDLE");
+  char absPath[PATH_MAX];
+  FILE* f;
+
+  if (path == NULL || path[0] == '\0') {
+    return false;
+  }
+
+  if ((f = fopen(path, "w")) == NULL) {
+    char msg[PATH_MAX + 100];
+    snprintf(msg, sizeof(msg), "cannot create environment bundle \"%s\"",
+             path);
+    chpl_error(msg, 0, 0);
+  }
+  for (int i = 0; environ && environ[i]; i++) {
+    int keyLen = strstr(environ[i], "=") - environ[i];
+    if (env_key_is_modshare(environ[i], keyLen)
+        || strncmp(environ[i], "CHPL_RT_ENV_BUNDLE=", 19) == 0) {
+      continue;
+    }
+    fwrite(environ[i], 1, strlen(environ[i]) + 1, f);
+  }
+  if (fclose(f) != 0) {
+    char msg[PATH_MAX + 100];
+    snprintf(msg, sizeof(msg), "cannot write environment bundle \"%s\"",
+             path);
+    chpl_error(msg, 0, 0);
+  }
+
+  // The program may not start in our working directory.
+  if (realpath(path, absPath) != NULL) {
+    path = absPath;
+  }
+  chpl_env_set("CHPL_RT_ENV_BUNDLE", path, 1);
+  return true;
+}
+
 // This function returns a string containing a character-
 // separated list of environment variables that should be
 // forwarded.
 
 char* chpl_get_enviro_keys(char sep)
 {
+  chpl_bool bundled = write_env_bundle();
+
   // count the variables in environ, and how many characters in each name
   int numVars = 0;
   int numChars = 0;
@@ -588,8 +663,8 @@ char* chpl_get_enviro_keys(char sep)
     numVars++;
     int keyLen = strstr(environ[i], "=") - environ[i];
 
-    // if the key ends with _modshare, skip it
-    if (keyLen > 8 && strncmp(environ[i] + keyLen - 9, "_modshare", 9) == 0) {
+    // skip keys that end with _modshare, and those in the bundle
+    if (!env_key_forwarded(environ[i], keyLen, bundled)) {
       continue;
     }
     numVars++;
@@ -605,8 +680,8 @@ char* chpl_get_enviro_keys(char sep)
   for(int i = 0; environ && environ[i]; i++) {
 
     int keyLen = strstr(environ[i], "=") - environ[i];
-    // skip keys that end with _modshare
-    if (keyLen > 8 && strncmp(environ[i] + keyLen - 9, "_modshare", 9) == 0) {
+    // skip keys that end with _modshare, and those in the bundle
+    if (!env_key_forwarded(environ[i], keyLen, bundled)) {
       continue;
     }
     strncpy(buffer + bufferOffset, environ[i], keyLen);
@@ -0,0 +1,135 @@
+/*
+ * Copyright 2020-2026 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "chplrt.h"
+
+#include "chpl-atomics.h"
+#include "chpl-env.h"
+#include "chpl-mem.h"
+#include "chpl-mem-arena.h"
+#include "chpl-thread-local-storage.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+#define ARENA_CHUNK_SIZE ((size_t) 64 << 10)
+#define ARENA_ALIGN      ((size_t) 16)
+#define ARENA_HDR_SIZE   ARENA_ALIGN       // room for the owning chunk ptr
+#define ARENA_MAX_OBJ    (ARENA_CHUNK_SIZE / 8)
+
+//
+// A chunk's live count includes one reference held by the thread
+// that is allocating from it, so the count can only reach zero after
+// that thread has retired the chunk.
+//
+typedef struct {
+  chpl_atomic_uint_least64_t live;
+  size_t used;
+} arena_chunk_t;
+
+#define ARENA_DATA_OFFSET \
+  ((sizeof(arena_chunk_t) + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1))
+#define ARENA_DATA_SIZE (ARENA_CHUNK_SIZE - ARENA_DATA_OFFSET)
+
+static chpl_bool arenaEnabled = true;
+static CHPL_TLS_DECL(arena_chunk_t*, arenaChunk);
+
+
+void chpl_mem_arena_init(void) {
+  arenaEnabled = chpl_env_rt_get_bool("MEM_ARENA", true);
+  CHPL_TLS_INIT(arenaChunk);
+}
+
+
+static arena_chunk_t* arena_new_chunk(int32_t lineno, int32_t filename) {
+  arena_chunk_t* c;
+
+  c = (arena_chunk_t*) chpl_mem_alloc(ARENA_CHUNK_SIZE,
+                                      CHPL_RT_MD_MEM_ARENA_CHUNK,
+                                      lineno, filename);
+  atomic_init_uint_least64_t(&c->live, 1);
+  c->used = 0;
+  return c;
+}
+
+
+static inline void arena_chunk_release(arena_chunk_t* c) {
+  if (atomic_fetch_sub_explicit_uint_least64_t(&c->live, 1,
+                                               chpl_memory_order_acq_rel)
+      == 1) {
+    chpl_mem_free(c, 0, 0);
+  }
+}
+
+
+void* chpl_mem_arena_alloc(size_t size, chpl_mem_descInt_t description,
+                           int32_t lineno, int32_t filename) {
+  const size_t need = ARENA_HDR_SIZE
+                      + ((size + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1));
+  arena_chunk_t* c;
+  char* p;
+
+  if (!arenaEnabled || need > ARENA_MAX_OBJ) {
+    p = (char*) chpl_mem_alloc(ARENA_HDR_SIZE + size, description,
+                               lineno, filename);
+    *(arena_chunk_t**) p = NULL;
+    return p + ARENA_HDR_SIZE;
+  }
+
+  c = (arena_chunk_t*) CHPL_TLS_GET(arenaChunk);
+  if (c != NULL
+      && atomic_load_explicit_uint_least64_t(&c->live,
+                                             chpl_memory_order_acquire)
+         == 1) {
+    // Everything allocated from this chunk has been freed; start over.
+    c->used = 0;
+  }
+
+  if (c == NULL || c->used + need > ARENA_DATA_SIZE) {
+    if (c != NULL)
+      arena_chunk_release(c);
+    c = arena_new_chunk(lineno, filename);
+    CHPL_TLS_SET(arenaChunk, c);
+  }
+
+  (void) atomic_fetch_add_explicit_uint_least64_t(&c->live, 1,
+                                                  chpl_memory_order_relaxed);
+  p = (char*) c + ARENA_DATA_OFFSET + c->used;
+  c->used += need;
+  *(arena_chunk_t**) p = c;
+  return p + ARENA_HDR_SIZE;
+}
+
+
+void chpl_mem_arena_free(void* p, int32_t lineno, int32_t filename) {
+  char* base;
+  arena_chunk_t* c;
+
+  if (p == NULL)
+    return;
+
+  base = (char*) p - ARENA_HDR_SIZE;
+  c = *(arena_chunk_t**) base;
+  if (c == NULL)
+    chpl_mem_free(base, lineno, filename);
+  else
+    arena_chunk_release(c);
+}
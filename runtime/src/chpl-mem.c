@@ -21,31 +21,442 @@
 //
 // Shared code for different mem implementations in mem-*/chpl_*_mem.c
 //
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE // mremap
+#endif
+
 #include "chplrt.h"
 
+#include "chpl-atomics.h"
+#include "chpl-comm.h"
+#include "chpl-env.h"
 #include "chpl-mem.h"
+#include "chpl-mem-arena.h"
+#include "chpl-mem-array.h"
+#include "chpl-mem-sys.h"
+#include "chpl-tasks.h"
+#include "chpl-topo.h"
 #include "chpltypes.h"
 #include "error.h"
 #include "chplsys.h"
 
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <sys/mman.h> // madvise
+
 static int heapInitialized = 0;
 
+size_t chpl_mem_array_hugepageThreshold = 0;
+size_t chpl_mem_array_gigapageThreshold = 0;
+size_t chpl_mem_array_mapThreshold = 0;
+size_t chpl_mem_array_firstTouchThreshold = 0;
+chpl_mem_array_placement_t chpl_mem_array_placement =
+  CHPL_MEM_ARRAY_PLACE_FIRST_TOUCH;
+size_t chpl_mem_array_placementThreshold = 0;
+
+// Bytes of array memory currently advised to use huge pages, and the
+// most there has been at once.
+static chpl_atomic_uint_least64_t hugepageBytes;
+static chpl_atomic_uint_least64_t hugepageBytesPeak;
+
+
+static void initArrayHugepages(void) {
+  atomic_init_uint_least64_t(&hugepageBytes, 0);
+  atomic_init_uint_least64_t(&hugepageBytesPeak, 0);
+
+  // If the heap is already on huge pages there is nothing to gain.
+  if (chpl_getHeapPageSize() != chpl_getSysPageSize()) {
+    return;
+  }
+
+  chpl_mem_array_hugepageThreshold =
+    chpl_env_rt_get_size("ARRAY_HUGEPAGE_THRESHOLD", 0);
+  chpl_mem_array_gigapageThreshold =
+    chpl_env_rt_get_size("ARRAY_GIGAPAGE_THRESHOLD", 0);
+}
+
+
+static void initArrayMapping(void) {
+#ifdef MREMAP_MAYMOVE
+  void* heap_base;
+  size_t heap_size;
+
+  chpl_comm_regMemHeapInfo(&heap_base, &heap_size);
+  if (heap_base != NULL || chpl_comm_regMemAllocThreshold() != SIZE_MAX) {
+    return;
+  }
+
+  chpl_mem_array_mapThreshold =
+    chpl_env_rt_get_size("ARRAY_MREMAP_THRESHOLD", 0);
+#endif
+}
+
+
+static void initArrayPlacement(void) {
+  const char* policy = chpl_env_rt_get("ARRAY_PLACEMENT", "first-touch");
+
+  if (strcmp(policy, "first-touch") == 0) {
+    chpl_mem_array_placement = CHPL_MEM_ARRAY_PLACE_FIRST_TOUCH;
+  } else if (strcmp(policy, "interleave") == 0) {
+    chpl_mem_array_placement = CHPL_MEM_ARRAY_PLACE_INTERLEAVE;
+  } else if (strcmp(policy, "block") == 0) {
+    chpl_mem_array_placement = CHPL_MEM_ARRAY_PLACE_BLOCK;
+  } else if (strcmp(policy, "sublocale") == 0) {
+    chpl_mem_array_placement = CHPL_MEM_ARRAY_PLACE_SUBLOCALE;
+  } else {
+    char msg[200];
+    snprintf(msg, sizeof(msg),
+             "CHPL_RT_ARRAY_PLACEMENT must be first-touch, interleave, "
+             "block or sublocale, not \"%s\"; using first-touch", policy);
+    chpl_warning(msg, 0, 0);
+    chpl_mem_array_placement = CHPL_MEM_ARRAY_PLACE_FIRST_TOUCH;
+  }
+
+  // smaller than this, placing the pages isn't worth the system call
+  chpl_mem_array_placementThreshold =
+    chpl_env_rt_get_size("ARRAY_PLACEMENT_THRESHOLD", (size_t) 4 << 20);
+}
+
 
 void chpl_mem_init(void) {
   chpl_mem_layerInit();
   heapInitialized = 1;
+  initArrayHugepages();
+  initArrayMapping();
+  initArrayPlacement();
+  chpl_mem_array_firstTouchThreshold =
+    chpl_env_rt_get_size("ARRAY_FIRST_TOUCH_THRESHOLD", 0);
+  chpl_mem_arena_init();
 }
 
 
 void chpl_mem_exit(void) {
+  if (verbosity >= 2
+      && (chpl_mem_array_hugepageThreshold != 0
+          || chpl_mem_array_gigapageThreshold != 0)) {
+    printf("%d: array memory advised to use huge pages: %" PRIu64
+           " bytes peak, %" PRIu64 " bytes at exit\n",
+           (int) chpl_nodeID,
+           (uint64_t) atomic_load_uint_least64_t(&hugepageBytesPeak),
+           (uint64_t) atomic_load_uint_least64_t(&hugepageBytes));
+  }
   chpl_mem_layerExit();
 }
 
 
+// The whole 2 MiB pages within [p, p+size).
+static size_t hugepageSpan(void* p, size_t size, void** lo) {
+  const uintptr_t hp = (uintptr_t) 2 << 20;
+  const uintptr_t ulo = ((uintptr_t) p + hp - 1) & ~(hp - 1);
+  const uintptr_t uhi = ((uintptr_t) p + size) & ~(hp - 1);
+  *lo = (void*) ulo;
+  return (uhi > ulo) ? uhi - ulo : 0;
+}
+
+
+void chpl_mem_array_hugepageAdvise(void* p, size_t size) {
+#ifdef MADV_HUGEPAGE
+  void* lo;
+  const size_t span = hugepageSpan(p, size, &lo);
+  uint64_t cur;
+  uint64_t peak;
+
+  if (span == 0) {
+    return;
+  }
+
+  // advisory only; ignore errors
+  (void) madvise(lo, span, MADV_HUGEPAGE);
+
+  cur = atomic_fetch_add_uint_least64_t(&hugepageBytes, span) + span;
+  peak = atomic_load_uint_least64_t(&hugepageBytesPeak);
+  while (cur > peak
+         && !atomic_compare_exchange_weak_uint_least64_t(&hugepageBytesPeak,
+                                                         &peak, cur)) {
+  }
+#endif
+}
+
+
+void chpl_mem_array_hugepageRelease(void* p, size_t size) {
+#ifdef MADV_HUGEPAGE
+  void* lo;
+  const size_t span = hugepageSpan(p, size, &lo);
+
+  if (span != 0) {
+    (void) atomic_fetch_sub_uint_least64_t(&hugepageBytes, span);
+  }
+#endif
+}
+
+
+#ifdef MREMAP_MAYMOVE
+static size_t mapSize(size_t size) {
+  const size_t pgSize = chpl_getSysPageSize();
+  return (size + pgSize - 1) & ~(pgSize - 1);
+}
+#endif
+
+
+void* chpl_mem_array_mapAlloc(size_t size) {
+#ifdef MREMAP_MAYMOVE
+  void* p = mmap(NULL, mapSize(size), PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (p == MAP_FAILED) {
+    return NULL;
+  }
+  if (chpl_mem_array_hugepageAlign(size) != 0) {
+    chpl_mem_array_hugepageAdvise(p, size);
+  }
+  return p;
+#else
+  chpl_internal_error("array mapping is not supported");
+  return NULL;
+#endif
+}
+
+
+void chpl_mem_array_mapFree(void* p, size_t size) {
+#ifdef MREMAP_MAYMOVE
+  if (chpl_mem_array_hugepageAlign(size) != 0) {
+    chpl_mem_array_hugepageRelease(p, size);
+  }
+  (void) munmap(p, mapSize(size));
+#else
+  chpl_internal_error("array mapping is not supported");
+#endif
+}
+
+
+//
+// Resize an array that has, or will have, its own mapping.  If both
+// the old and new sizes are mapped this is a single mremap(); the
+// kernel moves the page tables rather than the data.  Otherwise the
+// array is changing tiers, and has to be copied.
+//
+void* chpl_mem_array_mapRealloc(void* p, size_t oldSize, size_t newSize) {
+#ifdef MREMAP_MAYMOVE
+  void* newp;
+
+  if (p == NULL) {
+    return chpl_mem_array_isMapped(newSize)
+           ? chpl_mem_array_mapAlloc(newSize)
+           : chpl_malloc(newSize);
+  }
+
+  if (chpl_mem_array_isMapped(oldSize) && chpl_mem_array_isMapped(newSize)) {
+    if (chpl_mem_array_hugepageAlign(oldSize) != 0) {
+      chpl_mem_array_hugepageRelease(p, oldSize);
+    }
+    newp = mremap(p, mapSize(oldSize), mapSize(newSize), MREMAP_MAYMOVE);
+    if (newp == MAP_FAILED) {
+      if (chpl_mem_array_hugepageAlign(oldSize) != 0) {
+        chpl_mem_array_hugepageAdvise(p, oldSize);
+      }
+      return NULL;
+    }
+    if (newp != p) {
+      chpl_comm_regMemFreeNotify(p, oldSize);
+    }
+    if (chpl_mem_array_hugepageAlign(newSize) != 0) {
+      chpl_mem_array_hugepageAdvise(newp, newSize);
+    }
+    return newp;
+  }
+
+  newp = chpl_mem_array_isMapped(newSize)
+         ? chpl_mem_array_mapAlloc(newSize)
+         : chpl_malloc(newSize);
+  if (newp == NULL) {
+    return NULL;
+  }
+  memcpy(newp, p, (oldSize < newSize) ? oldSize : newSize);
+  chpl_comm_regMemFreeNotify(p, oldSize);
+  if (chpl_mem_array_isMapped(oldSize)) {
+    chpl_mem_array_mapFree(p, oldSize);
+  } else {
+    if (chpl_mem_array_hugepageAlign(oldSize) != 0) {
+      chpl_mem_array_hugepageRelease(p, oldSize);
+    }
+    chpl_free(p);
+  }
+  return newp;
+#else
+  chpl_internal_error("array mapping is not supported");
+  return NULL;
+#endif
+}
+
+
+//
+// Parallel first touch.  The array is split into one subchunk per NUMA
+// domain, in order, and each subchunk into pieces of at least 2 MiB.
+// One thread per piece, up to the tasking layer's maximum parallelism,
+// touches its piece while running on the piece's domain.
+//
+typedef struct {
+  void* p;
+  size_t size;
+  c_sublocid_t subloc;
+} firstTouchPiece_t;
+
+static void* firstTouchThread(void* arg) {
+  firstTouchPiece_t* piece = (firstTouchPiece_t*) arg;
+  if (piece->subloc == c_sublocid_none) {
+    const size_t pgSize = chpl_getHeapPageSize();
+    for (size_t off = 0; off < piece->size; off += pgSize) {
+      ((volatile char*) piece->p)[off] = 0;
+    }
+  } else {
+    chpl_topo_touchMemFromSubloc(piece->p, piece->size, true, piece->subloc);
+  }
+  return NULL;
+}
+
+void chpl_mem_array_firstTouch(void* p, size_t size) {
+  const size_t minPiece = (size_t) 2 << 20;
+  const int numDomains = chpl_topo_getNumNumaDomains();
+  int perDomain;
+  int nPieces;
+  size_t* subchunkSizes;
+  firstTouchPiece_t* pieces;
+  pthread_t* threads;
+  char* base;
+  int d, i, n;
+
+  if (numDomains <= 0 || size < 2 * minPiece) {
+    return;
+  }
+
+  perDomain = (int) (chpl_task_getMaxPar() / numDomains);
+  if (perDomain < 1) {
+    perDomain = 1;
+  }
+  if ((size_t) perDomain * numDomains > size / minPiece) {
+    perDomain = (int) (size / minPiece / numDomains);
+    if (perDomain < 1) {
+      perDomain = 1;
+    }
+  }
+  nPieces = numDomains * perDomain;
+
+  subchunkSizes = sys_calloc(numDomains, sizeof(*subchunkSizes));
+  pieces = sys_calloc(nPieces, sizeof(*pieces));
+  threads = sys_calloc(nPieces, sizeof(*threads));
+  if (subchunkSizes == NULL || pieces == NULL || threads == NULL) {
+    sys_free(subchunkSizes);
+    sys_free(pieces);
+    sys_free(threads);
+    return;
+  }
+
+  if (numDomains > 1) {
+    chpl_topo_setMemSubchunkLocality(p, size, true, subchunkSizes);
+  } else {
+    subchunkSizes[0] = size;
+  }
+
+  // With more than one domain the subchunks are whole pages, starting
+  // from the first page entirely inside the array.
+  base = (char*) p;
+  if (numDomains > 1) {
+    const size_t pgSize = chpl_getHeapPageSize();
+    base = (char*) (((uintptr_t) p + pgSize - 1) & ~(pgSize - 1));
+  }
+
+  for (d = 0, n = 0; d < numDomains; d++) {
+    const size_t pieceSize = subchunkSizes[d] / perDomain;
+    for (i = 0; i < perDomain; i++, n++) {
+      pieces[n].p = base;
+      pieces[n].size = (i == perDomain - 1)
+                       ? subchunkSizes[d] - i * pieceSize
+                       : pieceSize;
+      pieces[n].subloc = (numDomains > 1) ? d : c_sublocid_none;
+      base += pieces[n].size;
+    }
+  }
+
+  for (n = 0; n < nPieces; n++) {
+    if (pthread_create(&threads[n], NULL, firstTouchThread, &pieces[n])
+        != 0) {
+      // Couldn't get a thread; do this piece ourselves.
+      firstTouchThread(&pieces[n]);
+      threads[n] = pthread_self();
+    }
+  }
+  for (n = 0; n < nPieces; n++) {
+    if (!pthread_equal(threads[n], pthread_self())) {
+      (void) pthread_join(threads[n], NULL);
+    }
+  }
+
+  sys_free(subchunkSizes);
+  sys_free(pieces);
+  sys_free(threads);
+}
+
+
+void chpl_mem_array_place(void* p, size_t size, c_sublocid_t subloc) {
+  const int numDomains = chpl_topo_getNumNumaDomains();
+  const size_t pgSize = chpl_getHeapPageSize();
+  char* lo = (char*) (((uintptr_t) p + pgSize - 1) & ~(pgSize - 1));
+  char* hi = (char*) (((uintptr_t) p + size) & ~(pgSize - 1));
+
+  if (numDomains <= 1 || hi <= lo) {
+    return;
+  }
+
+  switch (chpl_mem_array_placement) {
+  case CHPL_MEM_ARRAY_PLACE_INTERLEAVE:
+    chpl_topo_interleaveMemLocality(lo, hi - lo);
+    break;
+  case CHPL_MEM_ARRAY_PLACE_SUBLOCALE:
+    // without a usable sublocale, place it as for block
+    if (isActualSublocID(subloc) && subloc < numDomains) {
+      chpl_topo_setMemLocality(p, size, true, subloc);
+    } else {
+      chpl_topo_setMemSubchunkLocality(p, size, true, NULL);
+    }
+    break;
+  case CHPL_MEM_ARRAY_PLACE_BLOCK:
+    chpl_topo_setMemSubchunkLocality(p, size, true, NULL);
+    break;
+  case CHPL_MEM_ARRAY_PLACE_FIRST_TOUCH:
+    break;
+  }
+}
+
+
 int chpl_mem_inited(void) {
   return heapInitialized;
 }
 
+
+int chpl_mem_purge(void) {
+  return heapInitialized ? chpl_mem_layerPurge() : -1;
+}
+
+
+int chpl_mem_setDecay(int64_t dirtyMs, int64_t muzzyMs) {
+  if (dirtyMs < -1 || muzzyMs < -1) {
+    return -1;
+  }
+  return heapInitialized ? chpl_mem_layerSetDecay(dirtyMs, muzzyMs) : -1;
+}
+
+
+int chpl_mem_getStats(uint64_t* active, uint64_t* resident) {
+  *active = 0;
+  *resident = 0;
+  return heapInitialized ? chpl_mem_layerGetStats(active, resident) : -1;
+}
+
+
+int chpl_mem_printStats(void) {
+  return heapInitialized ? chpl_mem_layerPrintStats() : -1;
+}
+
 int chpl_posix_memalign_check_valid(size_t alignment) {
   size_t tmp;
   int power;
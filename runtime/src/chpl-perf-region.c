@@ -0,0 +1,305 @@
+/*
+ * Copyright 2020-2026 Hewlett Packard Enterprise Development LP
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Hardware-counter regions (see chpl-perf-region.h).
+//
+
+#include "chplrt.h"
+
+#include "chpl-comm.h"
+#include "chpl-env.h"
+#include "chpl-mem-sys.h"
+#include "chpl-perf-region.h"
+#include "chpl-thread-local-storage.h"
+#include "chpltimers.h"
+#include "error.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#define PERF_HAVE_COUNTERS
+#endif
+
+//
+// Each thread opens its own group of counters the first time it begins
+// a region, and keeps them running; a region's counts are the change
+// in the group's values between its begin and its end.  Reading the
+// group is one read() call.  The counts are scaled up by
+// enabled/running time in case the kernel had to multiplex them.
+//
+// Totals are kept per thread, so end doesn't need a lock except the
+// thread's own, which only the exit report contends.
+//
+
+#define PERF_NUM_COUNTERS 3     // cycles, instructions, LLC misses
+#define PERF_MAX_DEPTH 16
+#define PERF_MAX_REGIONS 64
+#define PERF_LINE_SIZE 64       // bytes moved per LLC miss, for DRAM
+
+typedef struct {
+  uint64_t v[PERF_NUM_COUNTERS];
+  double time;
+} perf_counts_t;
+
+typedef struct {
+  const char* name;
+  uint64_t calls;
+  perf_counts_t total;
+} perf_region_t;
+
+typedef struct perf_thread_s {
+  struct perf_thread_s* next;   // never changes once on the list
+  pthread_mutex_t lock;         // protects regions
+  int fd;                       // group leader, or -1
+  int depth;
+  struct {
+    int region;                 // index in regions, or -1 if no room
+    perf_counts_t start;
+  } stack[PERF_MAX_DEPTH];
+  int numRegions;
+  perf_region_t regions[PERF_MAX_REGIONS];
+} perf_thread_t;
+
+static chpl_bool perfEnabled = false;
+static chpl_bool perfWarned = false;
+static pthread_mutex_t perfLock = PTHREAD_MUTEX_INITIALIZER;
+static perf_thread_t* perfThreads;      // protected by perfLock
+static CHPL_TLS_DECL_INIT(perf_thread_t*, perfMyThread);
+
+
+void chpl_perf_region_init(void) {
+  CHPL_TLS_INIT(perfMyThread);
+  perfEnabled = chpl_env_rt_get_bool("PERF_REGIONS", false);
+}
+
+
+#ifdef PERF_HAVE_COUNTERS
+static int perf_open(uint64_t config, int group) {
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = config;
+  attr.disabled = (group == -1);
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP
+                     | PERF_FORMAT_TOTAL_TIME_ENABLED
+                     | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  return (int) syscall(__NR_perf_event_open, &attr, 0, -1, group, 0);
+}
+#endif
+
+static int perf_open_group(void) {
+#ifdef PERF_HAVE_COUNTERS
+  static const uint64_t configs[PERF_NUM_COUNTERS] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+  };
+  int fd = perf_open(configs[0], -1);
+  if (fd < 0) {
+    return -1;
+  }
+  for (int i = 1; i < PERF_NUM_COUNTERS; i++) {
+    if (perf_open(configs[i], fd) < 0) {
+      close(fd);
+      return -1;
+    }
+  }
+  ioctl(fd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  return fd;
+#else
+  return -1;
+#endif
+}
+
+static perf_thread_t* perf_my_thread(void) {
+  perf_thread_t* t = CHPL_TLS_GET(perfMyThread);
+  if (t == NULL) {
+    if ((t = sys_calloc(1, sizeof(*t))) == NULL) {
+      return NULL;
+    }
+    pthread_mutex_init(&t->lock, NULL);
+    if ((t->fd = perf_open_group()) < 0 && !perfWarned) {
+      perfWarned = true;
+      chpl_warning("could not open hardware counters for perf regions; "
+                   "only times will be recorded", 0, 0);
+    }
+    pthread_mutex_lock(&perfLock);
+    t->next = perfThreads;
+    perfThreads = t;
+    pthread_mutex_unlock(&perfLock);
+    CHPL_TLS_SET(perfMyThread, t);
+  }
+  return t;
+}
+
+static void perf_read(perf_thread_t* t, perf_counts_t* c) {
+  c->time = chpl_hrtimer_now();
+  memset(c->v, 0, sizeof(c->v));
+#ifdef PERF_HAVE_COUNTERS
+  if (t->fd >= 0) {
+    // nr, time_enabled, time_running, then the values
+    uint64_t buf[3 + PERF_NUM_COUNTERS];
+    if (read(t->fd, buf, sizeof(buf)) == (ssize_t) sizeof(buf)
+        && buf[0] == PERF_NUM_COUNTERS) {
+      double scale = (buf[2] > 0) ? (double) buf[1] / buf[2] : 1.0;
+      for (int i = 0; i < PERF_NUM_COUNTERS; i++) {
+        c->v[i] = (uint64_t) (buf[3 + i] * scale);
+      }
+    }
+  }
+#endif
+}
+
+// The name is copied, since the caller's may not outlive the region.
+static int perf_region_index(perf_thread_t* t, const char* name) {
+  char* copy;
+  for (int i = 0; i < t->numRegions; i++) {
+    if (strcmp(t->regions[i].name, name) == 0) {
+      return i;
+    }
+  }
+  if (t->numRegions == PERF_MAX_REGIONS
+      || (copy = sys_malloc(strlen(name) + 1)) == NULL) {
+    return -1;
+  }
+  strcpy(copy, name);
+  t->regions[t->numRegions].name = copy;
+  return t->numRegions++;
+}
+
+
+void chpl_perf_region_begin(const char* name) {
+  perf_thread_t* t;
+
+  if (!perfEnabled || (t = perf_my_thread()) == NULL) {
+    return;
+  }
+  if (t->depth >= PERF_MAX_DEPTH) {
+    t->depth++;   // so the matching end is ignored too
+    return;
+  }
+
+  pthread_mutex_lock(&t->lock);
+  t->stack[t->depth].region = perf_region_index(t, name);
+  pthread_mutex_unlock(&t->lock);
+  perf_read(t, &t->stack[t->depth].start);
+  t->depth++;
+}
+
+
+void chpl_perf_region_end(void) {
+  perf_thread_t* t;
+  perf_counts_t now;
+
+  if (!perfEnabled || (t = CHPL_TLS_GET(perfMyThread)) == NULL
+      || t->depth == 0) {
+    return;
+  }
+  if (--t->depth >= PERF_MAX_DEPTH) {
+    return;
+  }
+
+  perf_read(t, &now);
+  int r = t->stack[t->depth].region;
+  if (r < 0) {
+    return;
+  }
+  perf_counts_t* start = &t->stack[t->depth].start;
+  pthread_mutex_lock(&t->lock);
+  perf_region_t* reg = &t->regions[r];
+  reg->calls++;
+  reg->total.time += now.time - start->time;
+  for (int i = 0; i < PERF_NUM_COUNTERS; i++) {
+    reg->total.v[i] += now.v[i] - start->v[i];
+  }
+  pthread_mutex_unlock(&t->lock);
+}
+
+
+void chpl_perf_region_report(void) {
+  perf_region_t sum[PERF_MAX_REGIONS];
+  int nthreads[PERF_MAX_REGIONS];
+  int n = 0;
+  perf_thread_t* t;
+
+  if (!perfEnabled) {
+    return;
+  }
+
+  pthread_mutex_lock(&perfLock);
+  for (t = perfThreads; t != NULL; t = t->next) {
+    pthread_mutex_lock(&t->lock);
+    for (int i = 0; i < t->numRegions; i++) {
+      perf_region_t* reg = &t->regions[i];
+      int j;
+      if (reg->calls == 0) {
+        continue;
+      }
+      for (j = 0; j < n && strcmp(sum[j].name, reg->name) != 0; j++);
+      if (j == n) {
+        if (n == PERF_MAX_REGIONS) {
+          continue;
+        }
+        memset(&sum[n], 0, sizeof(sum[n]));
+        sum[n].name = reg->name;
+        nthreads[n] = 0;
+        n++;
+      }
+      sum[j].calls += reg->calls;
+      sum[j].total.time += reg->total.time;
+      for (int k = 0; k < PERF_NUM_COUNTERS; k++) {
+        sum[j].total.v[k] += reg->total.v[k];
+      }
+      nthreads[j]++;
+    }
+    pthread_mutex_unlock(&t->lock);
+  }
+  pthread_mutex_unlock(&perfLock);
+
+  for (int j = 0; j < n; j++) {
+    perf_region_t* s = &sum[j];
+    uint64_t cycles = s->total.v[0];
+    uint64_t instrs = s->total.v[1];
+    uint64_t misses = s->total.v[2];
+    // time is summed over threads, so this is bandwidth per thread-second
+    double dramMB = (double) misses * PERF_LINE_SIZE / 1e6;
+
+    printf("%d: perf region %s: calls=%llu threads=%d time=%.6f s "
+           "cycles=%llu instructions=%llu ipc=%.2f llc_misses=%llu "
+           "est_dram=%.1f MB (%.1f MB/s per thread)\n",
+           (int) chpl_nodeID, s->name, (unsigned long long) s->calls,
+           nthreads[j], s->total.time,
+           (unsigned long long) cycles, (unsigned long long) instrs,
+           cycles > 0 ? (double) instrs / cycles : 0.0,
+           (unsigned long long) misses, dramMB,
+           s->total.time > 0 ? dramMB / s->total.time : 0.0);
+  }
+}
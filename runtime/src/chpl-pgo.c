@@ -0,0 +1,55 @@
+/*
+ * Copyright 2020-2026 Hewlett Packard Enterprise Development LP
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Per-locale profile files for PGO (see chpl-pgo.h).
+//
+
+#include "chplrt.h"
+
+#include "chpl-comm.h"
+#include "chpl-env.h"
+#include "chpl-pgo.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+//
+// This is in LLVM's profile runtime, which is only linked into
+// instrumented programs.  It keeps the pointer it is given, so the
+// name must stay around until the counters are written at exit.
+//
+extern void __llvm_profile_set_filename(const char*) __attribute__((weak));
+
+static char pgoFilename[1024];
+
+
+void chpl_pgo_init(void) {
+  const char* prefix;
+
+  if (__llvm_profile_set_filename == NULL
+      || getenv("LLVM_PROFILE_FILE") != NULL) {
+    return;
+  }
+
+  prefix = chpl_env_rt_get("PGO_FILE", "chpl-pgo");
+  snprintf(pgoFilename, sizeof(pgoFilename), "%s-%d-%%m.profraw",
+           prefix, (int) chpl_nodeID);
+  __llvm_profile_set_filename(pgoFilename);
+}
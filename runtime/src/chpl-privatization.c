@@ -23,26 +23,47 @@
 #include "chpl-mem.h"
 #include "chpl-atomics.h"
 
+#include <sys/mman.h>
+
+// The table lives in address space reserved up front for
+// PRIV_RESERVED_PIDS entries, which the OS only backs with memory as
+// they're touched. So it never has to move, and readers (generated code
+// indexes chpl_privateObjects directly) never see a stale copy. If the
+// reservation can't be made, or a pid lands past it, we fall back to
+// growing the table by copying it, and leak the old copies to keep reads
+// lock-free.
+#define PRIV_RESERVED_PIDS ((int64_t)1 << 27)
+
 static int64_t chpl_capPrivateObjects = 0;
-static chpl_atomic_spinlock_t lock;
+static int64_t chpl_numPrivatePids = 0;  // one past the largest pid used
+// padded, since chpl_privateObjects next to it is read all the time
+static chpl_atomic_padded_spinlock_t lock;
+
+// pids whose objects have been cleared, for chpl_privatization_reusePid
+static int64_t* freePids = NULL;
+static int64_t numFreePids = 0;
+static int64_t capFreePids = 0;
 
 chpl_privateObject_t* chpl_privateObjects = NULL;
 
 void chpl_privatization_init(void) {
-  atomic_init_spinlock_t(&lock);
+  atomic_init_spinlock_t(&lock.lock);
+
+  void* table = mmap(NULL, PRIV_RESERVED_PIDS*sizeof(chpl_privateObject_t),
+                     PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (table != MAP_FAILED) {
+    chpl_privateObjects = (chpl_privateObject_t*)table;
+    chpl_capPrivateObjects = PRIV_RESERVED_PIDS;
+  }
 }
 
 static inline int64_t max(int64_t a, int64_t b) {
   return a > b ? a : b;
 }
 
-// Note that this function can be called in parallel and more notably it can be
-// called with non-monotonic pid's. e.g. this may be called with pid 27, and
-// then pid 2, so it has to ensure that the privatized array has at least pid+1
-// elements. Be __very__ careful if you have to update it.
-void chpl_newPrivatizedClass(void* v, int64_t pid) {
-  atomic_lock_spinlock_t(&lock);
-
+// Make sure the table has room for pid. Called with the lock held.
+static void ensurePrivatizedCapacity(int64_t pid) {
   // initialize array to a default size
   if (chpl_privateObjects == NULL) {
     chpl_capPrivateObjects = 2*max(pid, 4);
@@ -66,28 +87,87 @@ void chpl_newPrivatizedClass(void* v, int64_t pid) {
                   (oldCap)*sizeof(chpl_privateObject_t));
       chpl_privateObjects = tmp;
       // purposely leak old copies of chpl_privateObject to avoid the need to
-      // lock chpl_getPrivatizedClass; TODO: fix with lock free data structure
+      // lock chpl_getPrivatizedClass (this only happens past the reserved
+      // table, see PRIV_RESERVED_PIDS)
     }
   }
+}
+
+// Note that this function can be called in parallel and more notably it can be
+// called with non-monotonic pid's. e.g. this may be called with pid 27, and
+// then pid 2, so it has to ensure that the privatized array has at least pid+1
+// elements. Be __very__ careful if you have to update it.
+void chpl_newPrivatizedClass(void* v, int64_t pid) {
+  atomic_lock_spinlock_t(&lock.lock);
+
+  ensurePrivatizedCapacity(pid);
   chpl_privateObjects[pid].obj = v;
+  if (pid >= chpl_numPrivatePids) {
+    chpl_numPrivatePids = pid + 1;
+  }
 
-  atomic_unlock_spinlock_t(&lock);
+  atomic_unlock_spinlock_t(&lock.lock);
+}
+
+void chpl_newPrivatizedClasses(int64_t n, void** objs, const int64_t* pids) {
+  int64_t maxPid = -1;
+  for (int64_t i = 0; i < n; i++) {
+    maxPid = max(maxPid, pids[i]);
+  }
+  if (maxPid < 0) return;
+
+  atomic_lock_spinlock_t(&lock.lock);
+
+  // grow (at most) once, for the largest of them
+  ensurePrivatizedCapacity(maxPid);
+  for (int64_t i = 0; i < n; i++) {
+    chpl_privateObjects[pids[i]].obj = objs[i];
+  }
+  if (maxPid >= chpl_numPrivatePids) {
+    chpl_numPrivatePids = maxPid + 1;
+  }
+
+  atomic_unlock_spinlock_t(&lock.lock);
 }
 
 void chpl_clearPrivatizedClass(int64_t i) {
-  atomic_lock_spinlock_t(&lock);
+  atomic_lock_spinlock_t(&lock.lock);
+  if (chpl_privateObjects[i].obj == NULL) {
+    // already cleared, and already on the free list
+    atomic_unlock_spinlock_t(&lock.lock);
+    return;
+  }
   chpl_privateObjects[i].obj = NULL;
-  atomic_unlock_spinlock_t(&lock);
+
+  if (numFreePids == capFreePids) {
+    capFreePids = 2*max(capFreePids, 16);
+    freePids = chpl_mem_realloc(freePids, capFreePids*sizeof(int64_t),
+                                CHPL_RT_MD_COMM_PRV_OBJ_ARRAY, 0, 0);
+  }
+  freePids[numFreePids++] = i;
+  atomic_unlock_spinlock_t(&lock.lock);
+}
+
+int64_t chpl_privatization_reusePid(void) {
+  int64_t pid = -1;
+  atomic_lock_spinlock_t(&lock.lock);
+  // skip any that have been given a new object some other way
+  while (numFreePids > 0 && pid < 0) {
+    int64_t i = freePids[--numFreePids];
+    if (chpl_privateObjects[i].obj == NULL) pid = i;
+  }
+  atomic_unlock_spinlock_t(&lock.lock);
+  return pid;
 }
 
 // Used to check for leaks of privatized classes
 int64_t chpl_numPrivatizedClasses(void) {
   int64_t ret = 0;
-  atomic_lock_spinlock_t(&lock);
-  for (int64_t i = 0; i < chpl_capPrivateObjects; i++) {
+  atomic_lock_spinlock_t(&lock.lock);
+  for (int64_t i = 0; i < chpl_numPrivatePids; i++) {
     if (chpl_privateObjects[i].obj)
       ret++;
   }
-  atomic_unlock_spinlock_t(&lock);
+  atomic_unlock_spinlock_t(&lock.lock);
   return ret;
 }
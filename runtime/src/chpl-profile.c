@@ -0,0 +1,396 @@
+/*
+ * Copyright 2020-2026 Hewlett Packard Enterprise Development LP
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Sampling CPU profiler (see chpl-profile.h).
+//
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+// needed for dladdr and the ucontext registers on linux
+
+#include "chplrt.h"
+
+#include "arg.h"
+#include "chpl-atomics.h"
+#include "chpl-comm.h"
+#include "chpl-env.h"
+#include "chpl-linefile-support.h"
+#include "chpl-mem-sys.h"
+#include "chpl-profile.h"
+#include "chplcgfns.h"
+#include "error.h"
+
+#include <dlfcn.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <ucontext.h>
+
+#ifdef CHPL_DO_UNWIND
+// Necessary for instruct libunwind to use only the local unwind
+#define UNW_LOCAL_ONLY
+#include <libunwind.h>
+#endif
+
+//
+// SIGPROF comes from ITIMER_PROF, so it arrives at the rate the
+// process as a whole uses CPU and goes to a thread that is using it.
+// The handler claims the next slot in a preallocated array, which is
+// all it can safely do; everything else happens at exit.
+//
+
+#define PROF_DEPTH 32
+#define PROF_NAME_LEN 512
+
+typedef struct {
+  uint32_t depth;       // 0 until the handler has filled the sample in
+  void* pc[PROF_DEPTH]; // innermost first
+} prof_sample_t;
+
+typedef struct {
+  void* pc;
+  char* name;
+} prof_frame_t;
+
+typedef struct {
+  char* text;           // the frame names, joined with ';'
+  uint64_t count;
+} prof_stack_t;
+
+static prof_sample_t* profSamples;
+static uint64_t profMaxSamples;
+static chpl_atomic_uint_least64_t profNext;
+static int profRunning = 0;
+
+// C names of Chapel functions, sorted, as indices into chpl_funSymTable
+static int* profSymIdx;
+
+
+static void* prof_context_pc(void* uc) {
+#if defined(__linux__) && defined(__x86_64__)
+  return (void*) ((ucontext_t*) uc)->uc_mcontext.gregs[REG_RIP];
+#elif defined(__linux__) && defined(__aarch64__)
+  return (void*) ((ucontext_t*) uc)->uc_mcontext.pc;
+#elif defined(__APPLE__) && defined(__x86_64__)
+  return (void*) ((ucontext_t*) uc)->uc_mcontext->__ss.__rip;
+#elif defined(__APPLE__) && defined(__aarch64__)
+  return (void*) ((ucontext_t*) uc)->uc_mcontext->__ss.__pc;
+#else
+  return NULL;
+#endif
+}
+
+
+static void prof_handler(int sig, siginfo_t* si, void* uc) {
+  uint64_t i = atomic_fetch_add_uint_least64_t(&profNext, 1);
+  prof_sample_t* s;
+  int depth = 0;
+
+  if (i >= profMaxSamples) {
+    return;
+  }
+  s = &profSamples[i];
+#ifdef CHPL_DO_UNWIND
+  depth = unw_backtrace2(s->pc, PROF_DEPTH, (unw_context_t*) uc,
+                         UNW_INIT_SIGNAL_FRAME);
+#endif
+  if (depth <= 0) {
+    s->pc[0] = prof_context_pc(uc);
+    depth = (s->pc[0] != NULL);
+  }
+  __atomic_store_n(&s->depth, depth, __ATOMIC_RELEASE);
+}
+
+
+void chpl_profile_init(void) {
+  struct sigaction sa;
+  struct itimerval it;
+  int64_t hz;
+
+  if (!chpl_profileRequested() && !chpl_env_rt_get_bool("PROFILE", false)) {
+    return;
+  }
+
+  hz = chpl_env_rt_get_int("PROFILE_HZ", 100);
+  if (hz < 1) {
+    hz = 1;
+  } else if (hz > 1000000) {
+    hz = 1000000;
+  }
+  profMaxSamples = chpl_env_rt_get_uint("PROFILE_MAX_SAMPLES", 100000);
+  // only the pages samples land in are ever touched
+  if (profMaxSamples == 0
+      || (profSamples = sys_calloc(profMaxSamples,
+                                   sizeof(prof_sample_t))) == NULL) {
+    chpl_warning("could not allocate the profile sample buffer", 0, 0);
+    return;
+  }
+  atomic_init_uint_least64_t(&profNext, 0);
+
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_sigaction = prof_handler;
+  sa.sa_flags = SA_SIGINFO | SA_RESTART;
+  sigemptyset(&sa.sa_mask);
+  if (sigaction(SIGPROF, &sa, NULL) != 0) {
+    chpl_warning("could not install the SIGPROF handler for profiling", 0, 0);
+    return;
+  }
+
+  it.it_interval.tv_sec = (hz == 1) ? 1 : 0;
+  it.it_interval.tv_usec = (hz == 1) ? 0 : 1000000 / hz;
+  it.it_value = it.it_interval;
+  if (setitimer(ITIMER_PROF, &it, NULL) != 0) {
+    chpl_warning("could not start the profiling timer", 0, 0);
+    return;
+  }
+  profRunning = 1;
+}
+
+
+static int prof_sample_cmp(const void* a, const void* b) {
+  const prof_sample_t* x = (const prof_sample_t*) a;
+  const prof_sample_t* y = (const prof_sample_t*) b;
+  if (x->depth != y->depth) {
+    return (x->depth < y->depth) ? -1 : 1;
+  }
+  return memcmp(x->pc, y->pc, x->depth * sizeof(x->pc[0]));
+}
+
+static int prof_pc_cmp(const void* a, const void* b) {
+  uintptr_t x = (uintptr_t) ((const prof_frame_t*) a)->pc;
+  uintptr_t y = (uintptr_t) ((const prof_frame_t*) b)->pc;
+  return (x < y) ? -1 : (x > y);
+}
+
+static int prof_stack_cmp(const void* a, const void* b) {
+  return strcmp(((const prof_stack_t*) a)->text,
+                ((const prof_stack_t*) b)->text);
+}
+
+static int prof_sym_cmp(const void* a, const void* b) {
+  return strcmp(chpl_funSymTable[*(const int*) a],
+                chpl_funSymTable[*(const int*) b]);
+}
+
+static int prof_sym_find_cmp(const void* key, const void* b) {
+  return strcmp((const char*) key, chpl_funSymTable[*(const int*) b]);
+}
+
+// Name a frame: Chapel functions by their Chapel name and position,
+// anything else by its symbol, its object file, or its address.
+static char* prof_frame_name(void* pc) {
+  char buf[PROF_NAME_LEN];
+  const char* sym = NULL;
+  Dl_info info;
+  int* t;
+  int found = dladdr(pc, &info);
+
+#ifdef CHPL_DO_UNWIND
+  char cname[256];
+  unw_word_t off;
+  if (unw_get_proc_name_by_ip(unw_local_addr_space, (unw_word_t) pc,
+                              cname, sizeof(cname), &off, NULL) == 0) {
+    sym = cname;
+  }
+#endif
+  if (sym == NULL && found && info.dli_sname != NULL) {
+    sym = info.dli_sname;
+  }
+
+  if (sym != NULL && profSymIdx != NULL
+      && (t = bsearch(sym, profSymIdx, chpl_sizeSymTable / 2, sizeof(int),
+                      prof_sym_find_cmp)) != NULL) {
+    snprintf(buf, sizeof(buf), "%s (%s:%d)", chpl_funSymTable[*t + 1],
+             chpl_lookupFilename(chpl_filenumSymTable[*t]),
+             chpl_filenumSymTable[*t + 1]);
+  } else if (sym != NULL) {
+    snprintf(buf, sizeof(buf), "%s", sym);
+  } else if (found && info.dli_fname != NULL) {
+    const char* base = strrchr(info.dli_fname, '/');
+    snprintf(buf, sizeof(buf), "[%s]", base ? base + 1 : info.dli_fname);
+  } else {
+    snprintf(buf, sizeof(buf), "%p", pc);
+  }
+
+  // ';' separates frames in the folded format
+  for (char* p = buf; *p != '\0'; p++) {
+    if (*p == ';') *p = ':';
+  }
+  return strdup(buf);
+}
+
+
+void chpl_profile_fini(void) {
+  struct itimerval it;
+  const char* prefix;
+  char fname[1024];
+  uint64_t total, n, nFrames, nUnique, nStacks;
+  prof_frame_t* frames;
+  prof_stack_t* stacks;
+  FILE* f;
+
+  if (!profRunning) {
+    return;
+  }
+  profRunning = 0;
+
+  // Stop sampling.  A signal already on its way is ignored rather than
+  // getting SIGPROF's default action, which is to terminate.
+  memset(&it, 0, sizeof(it));
+  (void) setitimer(ITIMER_PROF, &it, NULL);
+  (void) signal(SIGPROF, SIG_IGN);
+
+  total = atomic_load_uint_least64_t(&profNext);
+  n = (total < profMaxSamples) ? total : profMaxSamples;
+
+  // Frames other than the innermost are return addresses; back them up
+  // into the call so they map to the caller's function.
+  nFrames = 0;
+  for (uint64_t i = 0; i < n; i++) {
+    prof_sample_t* s = &profSamples[i];
+    s->depth = __atomic_load_n(&s->depth, __ATOMIC_ACQUIRE);
+    for (uint32_t d = 1; d < s->depth; d++) {
+      s->pc[d] = (char*) s->pc[d] - 1;
+    }
+    nFrames += s->depth;
+  }
+  qsort(profSamples, n, sizeof(prof_sample_t), prof_sample_cmp);
+
+  if (chpl_sizeSymTable > 0
+      && (profSymIdx = sys_malloc((chpl_sizeSymTable / 2) * sizeof(int)))
+         != NULL) {
+    for (int t = 0; t < chpl_sizeSymTable / 2; t++) {
+      profSymIdx[t] = 2 * t;
+    }
+    qsort(profSymIdx, chpl_sizeSymTable / 2, sizeof(int), prof_sym_cmp);
+  }
+
+  // Name each distinct address once.
+  nUnique = 0;
+  frames = sys_malloc((nFrames > 0 ? nFrames : 1) * sizeof(prof_frame_t));
+  if (frames == NULL) {
+    chpl_warning("could not allocate memory to write the profile", 0, 0);
+    return;
+  }
+  for (uint64_t i = 0; i < n; i++) {
+    for (uint32_t d = 0; d < profSamples[i].depth; d++) {
+      frames[nUnique++].pc = profSamples[i].pc[d];
+    }
+  }
+  qsort(frames, nUnique, sizeof(prof_frame_t), prof_pc_cmp);
+  nFrames = nUnique;
+  nUnique = 0;
+  for (uint64_t i = 0; i < nFrames; i++) {
+    if (nUnique == 0 || frames[nUnique - 1].pc != frames[i].pc) {
+      frames[nUnique++].pc = frames[i].pc;
+    }
+  }
+  for (uint64_t i = 0; i < nUnique; i++) {
+    frames[i].name = prof_frame_name(frames[i].pc);
+  }
+
+  // Different addresses in one function should count as one frame, so
+  // the stacks are merged again by name.
+  nStacks = 0;
+  stacks = sys_malloc((n > 0 ? n : 1) * sizeof(prof_stack_t));
+  for (uint64_t i = 0; stacks != NULL && i < n; ) {
+    prof_sample_t* s = &profSamples[i];
+    uint64_t count = 1;
+    size_t len = 1;
+    char* text;
+    while (i + count < n && prof_sample_cmp(s, &profSamples[i + count]) == 0) {
+      count++;
+    }
+    i += count;
+    if (s->depth == 0) {
+      continue;
+    }
+    prof_frame_t* fr[PROF_DEPTH];
+    for (uint32_t d = 0; d < s->depth; d++) {
+      prof_frame_t key = { s->pc[d], NULL };
+      fr[d] = bsearch(&key, frames, nUnique, sizeof(prof_frame_t),
+                      prof_pc_cmp);
+      len += strlen(fr[d]->name) + 1;
+    }
+    if ((text = sys_malloc(len)) == NULL) {
+      continue;
+    }
+    text[0] = '\0';
+    for (int d = s->depth - 1; d >= 0; d--) {
+      strcat(text, fr[d]->name);
+      if (d > 0) strcat(text, ";");
+    }
+    stacks[nStacks].text = text;
+    stacks[nStacks].count = count;
+    nStacks++;
+  }
+  qsort(stacks, nStacks, sizeof(prof_stack_t), prof_stack_cmp);
+
+  prefix = chpl_env_rt_get("PROFILE_FILE", "chpl-profile");
+  snprintf(fname, sizeof(fname), "%s-%d.folded", prefix, (int) chpl_nodeID);
+  if ((f = fopen(fname, "w")) == NULL) {
+    char msg[1100];
+    snprintf(msg, sizeof(msg), "could not open profile file %s", fname);
+    chpl_warning(msg, 0, 0);
+  } else {
+    for (uint64_t i = 0; i < nStacks; ) {
+      uint64_t count = 0;
+      uint64_t j;
+      for (j = i; j < nStacks && prof_stack_cmp(&stacks[i], &stacks[j]) == 0;
+           j++) {
+        count += stacks[j].count;
+      }
+      fprintf(f, "%s %llu\n", stacks[i].text, (unsigned long long) count);
+      i = j;
+    }
+    fclose(f);
+  }
+
+  if (total > profMaxSamples) {
+    char msg[200];
+    snprintf(msg, sizeof(msg),
+             "profile dropped %llu of %llu samples; "
+             "see CHPL_RT_PROFILE_MAX_SAMPLES",
+             (unsigned long long) (total - profMaxSamples),
+             (unsigned long long) total);
+    chpl_warning(msg, 0, 0);
+  }
+
+  for (uint64_t i = 0; i < nStacks; i++) {
+    sys_free(stacks[i].text);
+  }
+  if (stacks != NULL) {
+    sys_free(stacks);
+  }
+  for (uint64_t i = 0; i < nUnique; i++) {
+    sys_free(frames[i].name);
+  }
+  sys_free(frames);
+  if (profSymIdx != NULL) {
+    sys_free(profSymIdx);
+    profSymIdx = NULL;
+  }
+  sys_free(profSamples);
+  profSamples = NULL;
+}
@@ -122,6 +122,46 @@ string_concat(c_string x, c_string y, int32_t lineno, int32_t filename) {
   return z;
 }
 
+// Concatenates n strings (NULLs are skipped) into one newly-allocated string
+// with a single allocation, instead of one per string_concat of a chain.
+// Returns NULL if all of them are NULL.
+c_string
+string_concat_many(int n, c_string* xs, int32_t lineno, int32_t filename) {
+  // remember the lengths of the first few, to not walk them twice
+  size_t lens[16];
+  size_t total = 0;
+  chpl_bool any = false;
+  char* z;
+  char* dst;
+  int i;
+
+  for (i = 0; i < n; i++) {
+    size_t len = 0;
+    if (xs[i] != NULL) {
+      len = strlen(xs[i]);
+      any = true;
+    }
+    if (i < 16) lens[i] = len;
+    total += len;
+  }
+  if (!any)
+    return NULL;
+
+  z = (char*)chpl_mem_allocMany(1, total + 1, CHPL_RT_MD_STR_CONCAT_DATA,
+                                lineno, filename);
+  dst = z;
+  for (i = 0; i < n; i++) {
+    size_t len;
+    if (xs[i] == NULL)
+      continue;
+    len = (i < 16) ? lens[i] : strlen(xs[i]);
+    memcpy(dst, xs[i], len);
+    dst += len;
+  }
+  *dst = '\0';
+  return z;
+}
+
 // Returns the index of the first occurrence of a substring within a string, or
 // 0 if the substring is not in the string.
 int string_index_of(c_string haystack, c_string needle) {
@@ -136,18 +176,27 @@ int string_index_of(c_string haystack, c_string needle) {
 c_string
 string_select(c_string x, int low, int high, int stride, int32_t lineno, int32_t filename) {
   char* result = NULL;
-  char* dst = NULL;
   int size;
-  c_string src;
 
   if (low  < 1) low = 1;
   if (high < low) return NULL;
 
-  size = high - low + 1;
+  size = string_select_size(low, high, stride);
   result = chpl_mem_allocMany(1, size + 1, CHPL_RT_MD_STR_SELECT_DATA,
                               lineno, filename);
-  src = stride > 0 ? x + low - 1 : x + high - 1;
-  dst = result;
+  string_select_into(result, x, low, high, stride);
+  return result;
+}
+
+// Writes the bytes string_select would return, and a terminating NUL, to
+// 'result', which must have room for string_select_size(low, high, stride)+1
+// bytes.  Here 1 <= low <= high.
+void
+string_select_into(char* result, c_string x, int low, int high, int stride) {
+  char* dst = result;
+  int size = high - low + 1;
+  c_string src = stride > 0 ? x + low - 1 : x + high - 1;
+
   if (stride == 1) {
     memcpy(result, src, size);
     dst = result + size;
@@ -164,7 +213,6 @@ string_select(c_string x, int low, int high, int stride, int32_t lineno, int32_t
   }
 
   *dst = '\0';
-  return result;
 }
 
 // Returns a string containing the character at the given index of the input
@@ -40,6 +40,67 @@ chpl_wide_string_copy(chpl____wide_chpl_string* x, int32_t lineno, int32_t filen
   return s;
 }
 
+chpl_string
+chpl_wide_string_copy_inplace(chpl__inPlaceBuffer* buf,
+                              chpl____wide_chpl_string* x,
+                              int32_t lineno, int32_t filename) {
+  if (x->addr == NULL) return NULL;
+  if (x->size > CHPL_SHORT_STRING_SIZE)
+    return chpl_wide_string_copy(x, lineno, filename);
+
+  chpl_gen_comm_get((void *)buf->data, chpl_rt_nodeFromLocaleID(x->locale),
+                    (void *)(x->addr), x->size, CHPL_COMM_UNKNOWN_ID,
+                    lineno, filename);
+  return (chpl_string) buf->data;
+}
+
+chpl_string
+chpl_string_copy_inplace(chpl__inPlaceBuffer* buf, chpl_string x,
+                         int32_t lineno, int32_t filename) {
+  size_t len;
+
+  if (x == NULL) return NULL;
+  len = strlen(x);
+  if (len >= CHPL_SHORT_STRING_SIZE)
+    return string_copy(x, lineno, filename);
+
+  memcpy(buf->data, x, len + 1);
+  return (chpl_string) buf->data;
+}
+
+chpl_string
+chpl_string_concat_inplace(chpl__inPlaceBuffer* buf,
+                           chpl_string x, chpl_string y,
+                           int32_t lineno, int32_t filename) {
+  size_t xlen;
+  size_t ylen;
+
+  if (x == NULL) return chpl_string_copy_inplace(buf, y, lineno, filename);
+  if (y == NULL) return chpl_string_copy_inplace(buf, x, lineno, filename);
+
+  xlen = strlen(x);
+  ylen = strlen(y);
+  if (xlen + ylen >= CHPL_SHORT_STRING_SIZE)
+    return string_concat(x, y, lineno, filename);
+
+  memcpy(buf->data, x, xlen);
+  memcpy(buf->data + xlen, y, ylen + 1);
+  return (chpl_string) buf->data;
+}
+
+chpl_string
+chpl_string_select_inplace(chpl__inPlaceBuffer* buf, chpl_string x,
+                           int low, int high, int stride,
+                           int32_t lineno, int32_t filename) {
+  if (low  < 1) low = 1;
+  if (high < low) return NULL;
+  if (string_select_size(low, high, stride) >= CHPL_SHORT_STRING_SIZE)
+    return string_select(x, low, high, stride, lineno, filename);
+
+  string_select_into((char*) buf->data, x, low, high, stride);
+  return (chpl_string) buf->data;
+}
+
 uint8_t* chpl__getInPlaceBufferData(chpl__inPlaceBuffer* buf) {
   return buf->data;
 }
@@ -23,8 +23,10 @@
 // tasks/<tasklayer>/tasks-<tasklayer>.c
 //
 #include "chplrt.h"
+#include "chpl-atomics.h"
 #include "chpl-comm.h"
 #include "chpl-env.h"
+#include "chpl-mem.h"
 #include "chpl-tasks.h"
 #include "chpl-topo.h"
 #include "error.h"
@@ -217,6 +219,84 @@ size_t chpl_task_getDefaultCallStackSize(void)
 }
 
 
+//
+// Support for chpl_task_runPieces().  The shared state is on the heap,
+// since tasks that find no pieces left may only start after the caller
+// has returned; whichever task is done with it last frees it.
+//
+typedef struct {
+  void (*fn)(void*, int);
+  void* arg;
+  int n;
+  chpl_atomic_int_least64_t next;   // next piece to claim
+  chpl_atomic_int_least64_t done;   // pieces finished
+  chpl_atomic_int_least64_t refs;   // tasks still using this
+} runPieces_t;
+
+typedef struct {
+  chpl_comm_on_bundle_t bundle;
+  runPieces_t* rp;
+} runPiecesTask_t;
+
+static void runPieces_release(runPieces_t* rp) {
+  if (atomic_fetch_sub_int_least64_t(&rp->refs, 1) == 1) {
+    atomic_destroy_int_least64_t(&rp->next);
+    atomic_destroy_int_least64_t(&rp->done);
+    atomic_destroy_int_least64_t(&rp->refs);
+    chpl_mem_free(rp, 0, 0);
+  }
+}
+
+static void runPieces_work(runPieces_t* rp) {
+  int64_t i;
+  while ((i = atomic_fetch_add_int_least64_t(&rp->next, 1)) < rp->n) {
+    rp->fn(rp->arg, (int) i);
+    atomic_fetch_add_int_least64_t(&rp->done, 1);
+  }
+}
+
+static void runPieces_wrapper(runPiecesTask_t* t) {
+  runPieces_work(t->rp);
+  runPieces_release(t->rp);
+}
+
+void chpl_task_runPieces(int n, void (*fn)(void*, int), void* arg) {
+  int numTasks = (int) chpl_task_getMaxPar();
+  if (numTasks > n) {
+    numTasks = n;
+  }
+  if (numTasks <= 1) {
+    for (int i = 0; i < n; i++) {
+      fn(arg, i);
+    }
+    return;
+  }
+
+  runPieces_t* rp = chpl_mem_alloc(sizeof(*rp), CHPL_RT_MD_TASK_LAYER_UNSPEC,
+                                   0, 0);
+  rp->fn = fn;
+  rp->arg = arg;
+  rp->n = n;
+  atomic_init_int_least64_t(&rp->next, 0);
+  atomic_init_int_least64_t(&rp->done, 0);
+  atomic_init_int_least64_t(&rp->refs, numTasks);
+
+  for (int t = 1; t < numTasks; t++) {
+    runPiecesTask_t task = { .bundle = { .kind = CHPL_ARG_BUNDLE_KIND_COMM },
+                             .rp     = rp };
+    chpl_task_startMovedTask(FID_NONE, (chpl_fn_p) runPieces_wrapper,
+                             &task, sizeof(task),
+                             c_sublocid_none, chpl_nullTaskID);
+  }
+
+  runPieces_work(rp);
+  while (atomic_load_int_least64_t(&rp->done) < n) {
+    chpl_task_yield();
+  }
+  runPieces_release(rp);
+}
+
+
 //
 // Support for task reporting on ^C.
 //
@@ -23,6 +23,7 @@
 #include "chplrt.h"
 
 #include "chpltimers.h"
+#include "chpl-env.h"
 
 #include <time.h>   // For struct tm.
 
@@ -56,3 +57,89 @@ void chpl_timevalue_parts(_timevalue t, int32_t* seconds, int32_t* minutes, int3
   if( yday ) *yday = localt.tm_yday;
   if( isdst ) *isdst = localt.tm_isdst;
 }
+
+
+#ifndef LAUNCHER
+
+chpl_bool chpl_hrtimer_useCycles = false;
+static uint64_t hrtimerTick0;
+static double hrtimerTicksPerSec = 1e9;
+static double hrtimerOffset;
+
+static double mono_secs(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static chpl_bool have_usable_cycle_counter(void) {
+#if defined(__x86_64__)
+  // The TSC has to tick at a constant rate through P- and C-state
+  // changes (CPUID 0x80000007, EDX bit 8), or it isn't a clock.
+  unsigned int eax, ebx, ecx, edx;
+  __asm__ __volatile__("cpuid"
+                       : "=a" (eax), "=b" (ebx), "=c" (ecx), "=d" (edx)
+                       : "a" (0x80000000));
+  if (eax < 0x80000007) {
+    return false;
+  }
+  __asm__ __volatile__("cpuid"
+                       : "=a" (eax), "=b" (ebx), "=c" (ecx), "=d" (edx)
+                       : "a" (0x80000007));
+  return (edx & (1 << 8)) != 0;
+#elif defined(__aarch64__)
+  return true;
+#else
+  return false;
+#endif
+}
+
+void chpl_hrtimer_init(void) {
+  struct timespec rt;
+
+  chpl_hrtimer_useCycles = have_usable_cycle_counter()
+                           && chpl_env_rt_get_bool("HRTIMER_CYCLES", true);
+
+  if (chpl_hrtimer_useCycles) {
+#if defined(__aarch64__)
+    uint64_t freq;
+    __asm__ __volatile__("mrs %0, cntfrq_el0" : "=r" (freq));
+    hrtimerTicksPerSec = (double) freq;
+#else
+    //
+    // Count ticks across a couple of milliseconds of CLOCK_MONOTONIC.
+    // That's good to a few parts in 10^5, and costs little next to the
+    // rest of startup.
+    //
+    double t0 = mono_secs();
+    uint64_t c0 = chpl_hrtimer_ticks();
+    double t1;
+    uint64_t c1;
+    do {
+      t1 = mono_secs();
+      c1 = chpl_hrtimer_ticks();
+    } while (t1 - t0 < 2e-3);
+    hrtimerTicksPerSec = (c1 - c0) / (t1 - t0);
+#endif
+  } else {
+    hrtimerTicksPerSec = 1e9;
+  }
+
+  hrtimerTick0 = chpl_hrtimer_ticks();
+  clock_gettime(CLOCK_REALTIME, &rt);
+  hrtimerOffset = rt.tv_sec + rt.tv_nsec * 1e-9;
+}
+
+double chpl_hrtimer_ticks_per_sec(void) {
+  return hrtimerTicksPerSec;
+}
+
+double chpl_hrtimer_now(void) {
+  return (chpl_hrtimer_ticks() - hrtimerTick0) / hrtimerTicksPerSec;
+}
+
+double chpl_hrtimer_offset(void) {
+  return hrtimerOffset;
+}
+
+#endif // LAUNCHER
@@ -0,0 +1,454 @@
+/*
+ * Copyright 2020-2026 Hewlett Packard Enterprise Development LP
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Trace-event output (see chpl-trace.h).
+//
+
+#include "chplrt.h"
+
+#include "chpl-atomics.h"
+#include "chpl-comm.h"
+#include "chpl-comm-callbacks.h"
+#include "chpl-env.h"
+#include "chpl-linefile-support.h"
+#include "chpl-mem-sys.h"
+#include "chpl-tasks-callbacks.h"
+#include "chpl-thread-local-storage.h"
+#include "chpl-trace.h"
+#include "chplcgfns.h"
+#include "chpltimers.h"
+#include "error.h"
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+//
+// Each thread formats its events into a buffer of its own, which is
+// written to the file when it fills up and at exit.  The buffer's lock
+// is only ever contended by the exit flush.
+//
+// A task's span is written as one complete ("X") event when it ends,
+// using the start time its begin callback pushed on the thread's stack
+// of running tasks.  A task that ends on a different thread than it
+// began on (qthreads can move them) just shows up as an instant.
+//
+
+#define TRACE_BUF_SIZE (64 * 1024)
+// names and file names are cut to TRACE_NAME_LEN, so events are rarely
+// longer; room for one is kept before formatting it
+#define TRACE_MAX_EVENT 1024
+#define TRACE_NAME_LEN 200
+#define TRACE_TASK_DEPTH 32
+
+// Thread IDs on the locale's track: worker threads count up from 1,
+// 0 is where comm from other locales lands, and GPUs come after.
+#define TRACE_REMOTE_TID 0
+#define TRACE_GPU_TID_BASE 1000000
+
+typedef struct {
+  uint64_t id;
+  double start;
+  chpl_fn_int_t fid;
+  int32_t filename;
+  int lineno;
+  int is_executeOn;
+} trace_task_t;
+
+typedef struct trace_thread_s {
+  struct trace_thread_s* next;  // never changes once on the list
+  pthread_mutex_t lock;
+  int tid;
+  int depth;
+  trace_task_t tasks[TRACE_TASK_DEPTH];
+  size_t used;
+  char buf[TRACE_BUF_SIZE];
+} trace_thread_t;
+
+chpl_bool chpl_trace_enabled = false;
+
+static pthread_mutex_t traceLock = PTHREAD_MUTEX_INITIALIZER;
+static FILE* traceFile;                 // protected by traceLock
+static trace_thread_t* traceThreads;    // protected by traceLock
+static int traceNumThreads;             // protected by traceLock
+static int traceMaxGpu = -1;            // protected by traceLock
+static int traceNumFuncs;
+static chpl_atomic_uint_least64_t traceFlowId;
+static CHPL_TLS_DECL_INIT(trace_thread_t*, traceMyThread);
+
+static const char* traceCommNames[chpl_comm_cb_num_event_kinds] = {
+  "put", "put_nb", "put_strd", "get", "get_nb", "get_strd",
+  "executeOn", "executeOn_nb", "executeOn_fast",
+};
+
+static void trace_task_begin(const chpl_task_cb_info_t* info);
+static void trace_task_end(const chpl_task_cb_info_t* info);
+static void trace_comm(const chpl_comm_cb_info_t* info);
+
+
+static inline double trace_us(double t) {
+  return (t + chpl_hrtimer_offset()) * 1e6;
+}
+
+// Copy s into buf without anything that would need escaping in JSON.
+static const char* trace_name(char* buf, const char* s) {
+  int i;
+  if (s == NULL) s = "";
+  for (i = 0; i < TRACE_NAME_LEN && s[i] != '\0'; i++) {
+    buf[i] = (s[i] == '"' || s[i] == '\\' || (unsigned char)s[i] < ' ')
+             ? '_' : s[i];
+  }
+  buf[i] = '\0';
+  return buf;
+}
+
+static const char* trace_func_name(char* buf, chpl_fn_int_t fid) {
+  return trace_name(buf, (fid >= 0 && fid < traceNumFuncs)
+                         ? chpl_finfo[fid].name : "task");
+}
+
+// Called with the thread's lock held.
+static void trace_write_out(trace_thread_t* t) {
+  pthread_mutex_lock(&traceLock);
+  if (traceFile != NULL && t->used > 0) {
+    fwrite(t->buf, 1, t->used, traceFile);
+  }
+  pthread_mutex_unlock(&traceLock);
+  t->used = 0;
+}
+
+static trace_thread_t* trace_my_thread(void) {
+  trace_thread_t* t = CHPL_TLS_GET(traceMyThread);
+  if (t == NULL) {
+    if ((t = sys_calloc(1, sizeof(*t))) == NULL) {
+      return NULL;
+    }
+    pthread_mutex_init(&t->lock, NULL);
+    pthread_mutex_lock(&traceLock);
+    t->tid = ++traceNumThreads;
+    t->next = traceThreads;
+    traceThreads = t;
+    pthread_mutex_unlock(&traceLock);
+    CHPL_TLS_SET(traceMyThread, t);
+  }
+  return t;
+}
+
+// Add one event to the thread's buffer.  Called with its lock held.
+// An event that doesn't fit in what is left of the buffer is formatted
+// again after flushing it, or written straight to the file if it is
+// longer than the whole buffer, so none are lost.
+static void trace_emit(trace_thread_t* t, const char* fmt, ...)
+  __attribute__((format(printf, 2, 3)));
+static void trace_emit(trace_thread_t* t, const char* fmt, ...) {
+  va_list ap;
+  int n;
+
+  if (t->used + TRACE_MAX_EVENT > TRACE_BUF_SIZE) {
+    trace_write_out(t);
+  }
+  va_start(ap, fmt);
+  n = vsnprintf(t->buf + t->used, TRACE_BUF_SIZE - t->used, fmt, ap);
+  va_end(ap);
+  if (n < 0) {
+    return;
+  }
+  if ((size_t) n < TRACE_BUF_SIZE - t->used) {
+    t->used += n;
+    return;
+  }
+
+  trace_write_out(t);
+  va_start(ap, fmt);
+  if (n < TRACE_BUF_SIZE) {
+    vsnprintf(t->buf, TRACE_BUF_SIZE, fmt, ap);
+    t->used = n;
+  } else {
+    pthread_mutex_lock(&traceLock);
+    if (traceFile != NULL) {
+      vfprintf(traceFile, fmt, ap);
+    }
+    pthread_mutex_unlock(&traceLock);
+  }
+  va_end(ap);
+}
+
+void chpl_trace_init(void) {
+  const char* prefix = chpl_env_rt_get("CHROME_TRACE", NULL);
+  char name[1024];
+  int i;
+
+  CHPL_TLS_INIT(traceMyThread);
+  if (prefix == NULL || prefix[0] == '\0') {
+    return;
+  }
+
+  snprintf(name, sizeof(name), "%s-%d.json", prefix, (int) chpl_nodeID);
+  if ((traceFile = fopen(name, "w")) == NULL) {
+    char msg[1100];
+    snprintf(msg, sizeof(msg), "could not open trace file %s", name);
+    chpl_warning(msg, 0, 0);
+    return;
+  }
+  if (chpl_nodeID == 0) {
+    fputs("[\n", traceFile);
+  }
+
+  for (traceNumFuncs = 0; chpl_finfo[traceNumFuncs].name != NULL;
+       traceNumFuncs++);
+  atomic_init_uint_least64_t(&traceFlowId, 0);
+
+  if (chpl_task_install_callback(chpl_task_cb_event_kind_begin,
+                                 chpl_task_cb_info_kind_full,
+                                 trace_task_begin) != 0
+      || chpl_task_install_callback(chpl_task_cb_event_kind_end,
+                                    chpl_task_cb_info_kind_id_only,
+                                    trace_task_end) != 0) {
+    chpl_warning("could not install task callbacks for tracing", 0, 0);
+  }
+  for (i = 0; i < chpl_comm_cb_num_event_kinds; i++) {
+    if (chpl_comm_install_callback((chpl_comm_cb_event_kind_t) i,
+                                   trace_comm) != 0) {
+      chpl_warning("could not install comm callbacks for tracing", 0, 0);
+      break;
+    }
+  }
+
+  chpl_trace_enabled = true;
+}
+
+
+void chpl_trace_fini(void) {
+  trace_thread_t* t;
+  int i;
+
+  if (!chpl_trace_enabled) {
+    return;
+  }
+  chpl_trace_enabled = false;
+
+  (void) chpl_task_uninstall_callback(chpl_task_cb_event_kind_begin,
+                                      trace_task_begin);
+  (void) chpl_task_uninstall_callback(chpl_task_cb_event_kind_end,
+                                      trace_task_end);
+  for (i = 0; i < chpl_comm_cb_num_event_kinds; i++) {
+    (void) chpl_comm_uninstall_callback((chpl_comm_cb_event_kind_t) i,
+                                        trace_comm);
+  }
+
+  // threads still running may add to their buffers, but nothing is
+  // written once the file is closed
+  pthread_mutex_lock(&traceLock);
+  t = traceThreads;
+  pthread_mutex_unlock(&traceLock);
+  for ( ; t != NULL; t = t->next) {
+    pthread_mutex_lock(&t->lock);
+    trace_write_out(t);
+    pthread_mutex_unlock(&t->lock);
+  }
+
+  pthread_mutex_lock(&traceLock);
+  fprintf(traceFile,
+          "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,"
+          "\"args\":{\"name\":\"locale %d\"}},\n"
+          "{\"name\":\"process_sort_index\",\"ph\":\"M\",\"pid\":%d,"
+          "\"args\":{\"sort_index\":%d}},\n"
+          "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,"
+          "\"args\":{\"name\":\"from other locales\"}},\n",
+          (int) chpl_nodeID, (int) chpl_nodeID,
+          (int) chpl_nodeID, (int) chpl_nodeID,
+          (int) chpl_nodeID, TRACE_REMOTE_TID);
+  for (i = 1; i <= traceNumThreads; i++) {
+    fprintf(traceFile,
+            "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,"
+            "\"args\":{\"name\":\"thread %d\"}},\n",
+            (int) chpl_nodeID, i, i);
+  }
+  for (i = 0; i <= traceMaxGpu; i++) {
+    fprintf(traceFile,
+            "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,"
+            "\"args\":{\"name\":\"gpu %d\"}},\n",
+            (int) chpl_nodeID, TRACE_GPU_TID_BASE + i, i);
+  }
+  fclose(traceFile);
+  traceFile = NULL;
+  pthread_mutex_unlock(&traceLock);
+}
+
+
+static void trace_task_begin(const chpl_task_cb_info_t* info) {
+  trace_thread_t* t;
+
+  if (!chpl_trace_enabled || (t = trace_my_thread()) == NULL) {
+    return;
+  }
+
+  pthread_mutex_lock(&t->lock);
+  if (t->depth < TRACE_TASK_DEPTH) {
+    trace_task_t* tk = &t->tasks[t->depth++];
+    tk->id = info->iu.full.id;
+    tk->start = chpl_hrtimer_now();
+    tk->fid = info->iu.full.fid;
+    tk->filename = info->iu.full.filename;
+    tk->lineno = info->iu.full.lineno;
+    tk->is_executeOn = info->iu.full.is_executeOn;
+  }
+  pthread_mutex_unlock(&t->lock);
+}
+
+
+static void trace_task_end(const chpl_task_cb_info_t* info) {
+  double now = chpl_hrtimer_now();
+  uint64_t id = info->iu.id_only.id;
+  char name[TRACE_NAME_LEN + 1];
+  char file[TRACE_NAME_LEN + 1];
+  trace_thread_t* t;
+  int i;
+
+  if (!chpl_trace_enabled || (t = trace_my_thread()) == NULL) {
+    return;
+  }
+
+  pthread_mutex_lock(&t->lock);
+  for (i = t->depth - 1; i >= 0 && t->tasks[i].id != id; i--);
+  if (i >= 0) {
+    trace_task_t* tk = &t->tasks[i];
+    trace_emit(t,
+               "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\","
+               "\"pid\":%d,\"tid\":%d,\"ts\":%.1f,\"dur\":%.1f,"
+               "\"args\":{\"id\":%llu,\"file\":\"%s\",\"line\":%d}},\n",
+               trace_func_name(name, tk->fid),
+               tk->is_executeOn ? "on" : "task",
+               (int) chpl_nodeID, t->tid, trace_us(tk->start),
+               (now - tk->start) * 1e6, (unsigned long long) id,
+               trace_name(file, chpl_lookupFilename(tk->filename)),
+               tk->lineno);
+    memmove(&t->tasks[i], &t->tasks[i + 1],
+            (t->depth - i - 1) * sizeof(t->tasks[0]));
+    t->depth--;
+  } else {
+    trace_emit(t,
+               "{\"name\":\"task end\",\"cat\":\"task\",\"ph\":\"i\","
+               "\"s\":\"t\",\"pid\":%d,\"tid\":%d,\"ts\":%.1f,"
+               "\"args\":{\"id\":%llu}},\n",
+               (int) chpl_nodeID, t->tid, trace_us(now),
+               (unsigned long long) id);
+  }
+  pthread_mutex_unlock(&t->lock);
+}
+
+
+//
+// Comm is only seen by the locale doing it, so that locale writes both
+// ends: a slice on its own thread and one on the other locale's
+// "from other locales" track, joined by a flow.
+//
+static void trace_comm(const chpl_comm_cb_info_t* info) {
+  double ts = trace_us(chpl_hrtimer_now());
+  const char* kind = traceCommNames[info->event_kind];
+  char file[TRACE_NAME_LEN + 1];
+  uint64_t flow;
+  size_t bytes;
+  int32_t fn;
+  int ln;
+  trace_thread_t* t;
+
+  if (!chpl_trace_enabled || (t = trace_my_thread()) == NULL) {
+    return;
+  }
+
+  switch (info->event_kind) {
+  case chpl_comm_cb_event_kind_put_strd:
+  case chpl_comm_cb_event_kind_get_strd:
+    bytes = info->iu.comm_strd.elemSize;
+    for (int i = 0; i <= info->iu.comm_strd.stridelevels; i++) {
+      bytes *= info->iu.comm_strd.count[i];
+    }
+    ln = info->iu.comm_strd.lineno;
+    fn = info->iu.comm_strd.filename;
+    break;
+  case chpl_comm_cb_event_kind_executeOn:
+  case chpl_comm_cb_event_kind_executeOn_nb:
+  case chpl_comm_cb_event_kind_executeOn_fast:
+    bytes = info->iu.executeOn.arg_size;
+    ln = info->iu.executeOn.lineno;
+    fn = info->iu.executeOn.filename;
+    break;
+  default:
+    bytes = info->iu.comm.size;
+    ln = info->iu.comm.lineno;
+    fn = info->iu.comm.filename;
+    break;
+  }
+
+  flow = ((uint64_t) chpl_nodeID << 40)
+         | atomic_fetch_add_uint_least64_t(&traceFlowId, 1);
+  trace_name(file, chpl_lookupFilename(fn));
+
+  pthread_mutex_lock(&t->lock);
+  trace_emit(t,
+             "{\"name\":\"%s\",\"cat\":\"comm\",\"ph\":\"X\",\"pid\":%d,"
+             "\"tid\":%d,\"ts\":%.1f,\"dur\":0,\"args\":{\"remote\":%d,"
+             "\"bytes\":%zu,\"file\":\"%s\",\"line\":%d}},\n"
+             "{\"name\":\"%s\",\"cat\":\"comm\",\"ph\":\"s\",\"id\":%llu,"
+             "\"pid\":%d,\"tid\":%d,\"ts\":%.1f},\n",
+             kind, (int) info->localNodeID, t->tid, ts,
+             (int) info->remoteNodeID, bytes, file, ln,
+             kind, (unsigned long long) flow,
+             (int) info->localNodeID, t->tid, ts);
+  trace_emit(t,
+             "{\"name\":\"%s\",\"cat\":\"comm\",\"ph\":\"X\",\"pid\":%d,"
+             "\"tid\":%d,\"ts\":%.1f,\"dur\":0,\"args\":{\"from\":%d,"
+             "\"bytes\":%zu}},\n"
+             "{\"name\":\"%s\",\"cat\":\"comm\",\"ph\":\"f\",\"bp\":\"e\","
+             "\"id\":%llu,\"pid\":%d,\"tid\":%d,\"ts\":%.1f},\n",
+             kind, (int) info->remoteNodeID, TRACE_REMOTE_TID, ts,
+             (int) info->localNodeID, bytes,
+             kind, (unsigned long long) flow,
+             (int) info->remoteNodeID, TRACE_REMOTE_TID, ts);
+  pthread_mutex_unlock(&t->lock);
+}
+
+
+void chpl_trace_gpu_kernel(int dev, int ln, int32_t fn,
+                           double start, double ms) {
+  char file[TRACE_NAME_LEN + 1];
+  trace_thread_t* t;
+
+  if (!chpl_trace_enabled || (t = trace_my_thread()) == NULL) {
+    return;
+  }
+
+  pthread_mutex_lock(&traceLock);
+  if (dev > traceMaxGpu) {
+    traceMaxGpu = dev;
+  }
+  pthread_mutex_unlock(&traceLock);
+
+  pthread_mutex_lock(&t->lock);
+  trace_name(file, chpl_lookupFilename(fn));
+  trace_emit(t,
+             "{\"name\":\"%s:%d\",\"cat\":\"gpu\",\"ph\":\"X\",\"pid\":%d,"
+             "\"tid\":%d,\"ts\":%.1f,\"dur\":%.1f},\n",
+             file, ln, (int) chpl_nodeID, TRACE_GPU_TID_BASE + dev,
+             trace_us(start), ms * 1e3);
+  pthread_mutex_unlock(&t->lock);
+}
@@ -23,8 +23,11 @@
 //
 
 #include "chpl-visual-debug.h"
+#include "chpl-visual-debug-format.h"
 #include "chplrt.h"
 #include "chpl-comm.h"
+#include "chpl-env.h"
+#include "chpl-mem-sys.h"
 #include "chpl-tasks.h"
 #include "chpl-tasks-callbacks.h"
 #include "chpl-comm-callbacks.h"
@@ -41,6 +44,7 @@
 #include <sys/stat.h>
 #include <sys/resource.h>
 #include <sys/param.h>
+#include <pthread.h>
 
 #include "chplcgfns.h"
 
@@ -87,6 +91,233 @@ int chpl_dprintf (int fd, const char * format, ...) {
   return -1;
 }
 
+//
+// Binary output (CHPL_RT_VDEBUG_FORMAT=binary, the default).  Each
+// thread appends records to its own buffer; full buffers are queued
+// for a flusher thread to write.  Before a text record (a tag, pause,
+// and so on) is queued, all the thread buffers are queued, so that
+// every event ends up on the right side of the tags around it.  See
+// chpl-visual-debug-format.h for the record layouts.
+//
+
+#define VDEBUG_BUF_SIZE (64 * 1024)
+
+typedef struct vdebug_buf_s {
+  struct vdebug_buf_s* next;    // in the write queue or free list
+  size_t used;
+  char data[VDEBUG_BUF_SIZE];
+} vdebug_buf_t;
+
+typedef struct vdebug_thread_s {
+  struct vdebug_thread_s* next; // never changes once on the list
+  pthread_mutex_t lock;
+  vdebug_buf_t* buf;
+} vdebug_thread_t;
+
+static int vdebugBinary = 0;
+static pthread_mutex_t vdebugLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t vdebugCond = PTHREAD_COND_INITIALIZER;
+static vdebug_thread_t* vdebugThreads;   // pushed on, never removed
+static vdebug_buf_t* vdebugQueueHead;
+static vdebug_buf_t* vdebugQueueTail;
+static vdebug_buf_t* vdebugFreeBufs;
+static pthread_t vdebugFlusher;
+static int vdebugFlusherRunning = 0;
+static int vdebugFlusherStop = 0;
+static __thread vdebug_thread_t* vdebugMyThread;
+
+static vdebug_buf_t* vdebug_get_buf (void) {
+  vdebug_buf_t* b;
+
+  pthread_mutex_lock(&vdebugLock);
+  if ((b = vdebugFreeBufs) != NULL)
+    vdebugFreeBufs = b->next;
+  pthread_mutex_unlock(&vdebugLock);
+
+  if (b == NULL && (b = sys_malloc(sizeof(*b))) == NULL)
+    return NULL;
+  b->next = NULL;
+  b->used = 0;
+  return b;
+}
+
+static void vdebug_enqueue (vdebug_buf_t* b) {
+  pthread_mutex_lock(&vdebugLock);
+  b->next = NULL;
+  if (vdebugQueueTail == NULL)
+    vdebugQueueHead = b;
+  else
+    vdebugQueueTail->next = b;
+  vdebugQueueTail = b;
+  pthread_cond_signal(&vdebugCond);
+  pthread_mutex_unlock(&vdebugLock);
+}
+
+static void* vdebug_flusher (void* arg) {
+  pthread_mutex_lock(&vdebugLock);
+  for (;;) {
+    vdebug_buf_t* b;
+    while (vdebugQueueHead == NULL && !vdebugFlusherStop)
+      pthread_cond_wait(&vdebugCond, &vdebugLock);
+    if ((b = vdebugQueueHead) == NULL)
+      break;
+    if ((vdebugQueueHead = b->next) == NULL)
+      vdebugQueueTail = NULL;
+    pthread_mutex_unlock(&vdebugLock);
+
+    for (size_t off = 0; off < b->used; ) {
+      ssize_t wrv = write(chpl_vdebug_fd, b->data + off, b->used - off);
+      if (wrv < 0) {
+        if (errno == EINTR) continue;
+        break;
+      }
+      off += wrv;
+    }
+
+    pthread_mutex_lock(&vdebugLock);
+    b->next = vdebugFreeBufs;
+    vdebugFreeBufs = b;
+  }
+  pthread_mutex_unlock(&vdebugLock);
+  return NULL;
+}
+
+static vdebug_thread_t* vdebug_my_thread (void) {
+  vdebug_thread_t* t = vdebugMyThread;
+  if (t == NULL) {
+    if ((t = sys_calloc(1, sizeof(*t))) == NULL)
+      return NULL;
+    pthread_mutex_init(&t->lock, NULL);
+    pthread_mutex_lock(&vdebugLock);
+    t->next = vdebugThreads;
+    vdebugThreads = t;
+    pthread_mutex_unlock(&vdebugLock);
+    vdebugMyThread = t;
+  }
+  return t;
+}
+
+static void vdebug_emit (chpl_vdebug_rec_kind_t kind, int sub,
+                         const struct timeval* tv,
+                         const void* payload, size_t len) {
+  vdebug_thread_t* t = vdebug_my_thread();
+  chpl_vdebug_rec_hdr_t hdr;
+
+  if (t == NULL)
+    return;
+
+  hdr.kind = kind;
+  hdr.sub = sub;
+  hdr.len = len;
+  hdr.usec = tv->tv_usec;
+  hdr.sec = tv->tv_sec;
+
+  pthread_mutex_lock(&t->lock);
+  if (t->buf != NULL && t->buf->used + sizeof(hdr) + len > VDEBUG_BUF_SIZE) {
+    vdebug_enqueue(t->buf);
+    t->buf = NULL;
+  }
+  if (t->buf == NULL)
+    t->buf = vdebug_get_buf();
+  if (t->buf != NULL) {
+    memcpy(t->buf->data + t->buf->used, &hdr, sizeof(hdr));
+    memcpy(t->buf->data + t->buf->used + sizeof(hdr), payload, len);
+    t->buf->used += sizeof(hdr) + len;
+  }
+  pthread_mutex_unlock(&t->lock);
+}
+
+// Queue everything the threads have buffered so far.
+static void vdebug_flush_threads (void) {
+  vdebug_thread_t* t;
+
+  pthread_mutex_lock(&vdebugLock);
+  t = vdebugThreads;
+  pthread_mutex_unlock(&vdebugLock);
+
+  for ( ; t != NULL; t = t->next) {
+    pthread_mutex_lock(&t->lock);
+    if (t->buf != NULL && t->buf->used > 0) {
+      vdebug_enqueue(t->buf);
+      t->buf = NULL;
+    }
+    pthread_mutex_unlock(&t->lock);
+  }
+}
+
+// Write a text record: directly in the text format, or queued behind
+// all the events so far in the binary one.
+static void vdebug_text (const char* format, ...)
+#ifdef __GNUC__
+      __attribute__ ((format (printf, 1, 2)))
+#endif
+   ;
+
+static void vdebug_text (const char* format, ...) {
+  char buffer[2048];
+  va_list ap;
+  int len;
+
+  va_start (ap, format);
+  len = vsnprintf (buffer, sizeof (buffer), format, ap);
+  va_end(ap);
+  if (len <= 0)
+    return;
+  if (len >= (int) sizeof (buffer))
+    len = sizeof (buffer) - 1;
+
+  if (!vdebugBinary) {
+    if (write (chpl_vdebug_fd, buffer, len) < 0) { /* nothing to do */ }
+  } else {
+    vdebug_buf_t* b;
+    chpl_vdebug_rec_hdr_t hdr = { VDEBUG_REC_TEXT, 0, len, 0, 0 };
+
+    vdebug_flush_threads();
+    if ((b = vdebug_get_buf()) == NULL)
+      return;
+    memcpy(b->data, &hdr, sizeof(hdr));
+    memcpy(b->data + sizeof(hdr), buffer, len);
+    b->used = sizeof(hdr) + len;
+    vdebug_enqueue(b);
+  }
+}
+
+static void vdebug_start_binary (void) {
+  const char* fmt = chpl_env_rt_get("VDEBUG_FORMAT", "binary");
+
+  vdebugBinary = (strcmp(fmt, "text") != 0);
+  if (vdebugBinary && strcmp(fmt, "binary") != 0) {
+    char msg[100];
+    snprintf(msg, sizeof(msg),
+             "CHPL_RT_VDEBUG_FORMAT must be \"binary\" or \"text\"");
+    chpl_warning(msg, 0, 0);
+  }
+  if (!vdebugBinary)
+    return;
+
+  vdebugFlusherStop = 0;
+  if (pthread_create(&vdebugFlusher, NULL, vdebug_flusher, NULL) == 0)
+    vdebugFlusherRunning = 1;
+  else
+    vdebugBinary = 0;
+}
+
+static void vdebug_stop_binary (void) {
+  if (!vdebugBinary)
+    return;
+
+  vdebug_flush_threads();
+  if (vdebugFlusherRunning) {
+    pthread_mutex_lock(&vdebugLock);
+    vdebugFlusherStop = 1;
+    pthread_cond_signal(&vdebugCond);
+    pthread_mutex_unlock(&vdebugLock);
+    pthread_join(vdebugFlusher, NULL);
+    vdebugFlusherRunning = 0;
+  }
+  vdebugBinary = 0;
+}
+
 static int chpl_make_vdebug_file (const char *rootname) {
     char fname[MAXPATHLEN];
     struct stat sb;
@@ -150,6 +381,8 @@ void chpl_vdebug_start (const char *fileroot, double now) {
   if (chpl_make_vdebug_file (rootname) < 0)
     return;
 
+  vdebug_start_binary();
+
   // Write initial information to the file, including resource time
   if ( getrusage (RUSAGE_SELF, &ru) < 0) {
     ru.ru_utime.tv_sec = 0;
@@ -158,37 +391,38 @@ void chpl_vdebug_start (const char *fileroot, double now) {
     ru.ru_stime.tv_usec = 0;
   }
   chpl_dprintf (chpl_vdebug_fd,
-                "ChplVdebug: ver 1.4 nodes %d nid %d tid %s seq %.3lf %lld.%06ld %ld.%06ld %ld.%06ld \n",
+                "ChplVdebug: ver 1.4 nodes %d nid %d tid %s seq %.3lf %lld.%06ld %ld.%06ld %ld.%06ld %s\n",
                 chpl_numNodes, chpl_nodeID, TID_STRING(buff, startTask), now,
                 (long long) tv.tv_sec, (long) tv.tv_usec,
                 (long) ru.ru_utime.tv_sec, (long) ru.ru_utime.tv_usec,
-                (long) ru.ru_stime.tv_sec, (long) ru.ru_stime.tv_usec  );
+                (long) ru.ru_stime.tv_sec, (long) ru.ru_stime.tv_usec,
+                vdebugBinary ? VDEBUG_BINARY_MARK : "");
 
   // Dump directory names, file names and function names
   if (chpl_nodeID == 0) {
     int ix;
     int numFIDnames;
 
-    chpl_dprintf (chpl_vdebug_fd, "CHPL_HOME: %s\n", CHPL_HOME);
-    chpl_dprintf (chpl_vdebug_fd, "DIR: %s\n", chpl_compileDirectory);
-    chpl_dprintf (chpl_vdebug_fd, "SAVEC: %s\n", chpl_saveCDir);
+    vdebug_text ("CHPL_HOME: %s\n", CHPL_HOME);
+    vdebug_text ("DIR: %s\n", chpl_compileDirectory);
+    vdebug_text ("SAVEC: %s\n", chpl_saveCDir);
 
-    chpl_dprintf (chpl_vdebug_fd, "Tablesize: %d\n", chpl_filenameTableSize);
+    vdebug_text ("Tablesize: %d\n", chpl_filenameTableSize);
     for (ix = 0; ix < chpl_filenameTableSize ; ix++) {
       if (chpl_filenameTable[ix][0] == 0) {
-        chpl_dprintf (chpl_vdebug_fd, "fname: 0 <unknown>\n");
+        vdebug_text ("fname: 0 <unknown>\n");
       } else if (chpl_filenameTable[ix][0] == '<' &&
                  chpl_filenameTable[ix][1] == 'c') {
-        chpl_dprintf (chpl_vdebug_fd, "fname: %d <command_line>\n", ix);
+        vdebug_text ("fname: %d <command_line>\n", ix);
       } else {
-        chpl_dprintf (chpl_vdebug_fd, "fname: %d %s\n", ix,
+        vdebug_text ("fname: %d %s\n", ix,
                       chpl_filenameTable[ix]);
       }
     }
     for (numFIDnames = 0; chpl_finfo[numFIDnames].name != NULL; numFIDnames++);
-    chpl_dprintf (chpl_vdebug_fd, "FIDNsize: %d\n", numFIDnames);
+    vdebug_text ("FIDNsize: %d\n", numFIDnames);
     for (ix = 0; ix < numFIDnames; ix++)
-      chpl_dprintf (chpl_vdebug_fd, "FIDname: %d %d %d %s\n", ix,
+      vdebug_text ("FIDname: %d %d %d %s\n", ix,
                     chpl_finfo[ix].lineno, chpl_finfo[ix].fileno,
                     chpl_finfo[ix].name);
   }
@@ -220,11 +454,12 @@ void chpl_vdebug_stop (void) {
       ru.ru_stime.tv_usec = 0;
     }
     // Generate the End record
-    chpl_dprintf (chpl_vdebug_fd, "End: %lld.%06ld %ld.%06ld %ld.%06ld %d %s\n",
-                  (long long) tv.tv_sec, (long) tv.tv_usec,
-                  (long) ru.ru_utime.tv_sec, (long) ru.ru_utime.tv_usec,
-                  (long) ru.ru_stime.tv_sec, (long) ru.ru_stime.tv_usec,
-                  chpl_nodeID, TID_STRING(buff, stopTask));
+    vdebug_text ("End: %lld.%06ld %ld.%06ld %ld.%06ld %d %s\n",
+                 (long long) tv.tv_sec, (long) tv.tv_usec,
+                 (long) ru.ru_utime.tv_sec, (long) ru.ru_utime.tv_usec,
+                 (long) ru.ru_stime.tv_sec, (long) ru.ru_stime.tv_usec,
+                 chpl_nodeID, TID_STRING(buff, stopTask));
+    vdebug_stop_binary();
     close (chpl_vdebug_fd);
   }
 }
@@ -240,14 +475,14 @@ void chpl_vdebug_mark (void) {
   chpl_taskID_t tagTask = chpl_task_getId();
   char buff[CHPL_TASK_ID_STRING_MAX_LEN];
   (void) gettimeofday (&tv, NULL);
-  chpl_dprintf (chpl_vdebug_fd, "VdbMark: %lld.%06ld %d %s\n",
-                (long long) tv.tv_sec, (long) tv.tv_usec, chpl_nodeID, TID_STRING(buff, tagTask) );
+  vdebug_text ("VdbMark: %lld.%06ld %d %s\n",
+               (long long) tv.tv_sec, (long) tv.tv_usec, chpl_nodeID, TID_STRING(buff, tagTask) );
 }
 
 // Record>  tname: tag# tagname
 
 void chpl_vdebug_tagname (const char* tagname, int tagno) {
-  chpl_dprintf (chpl_vdebug_fd, "tname: %d %s\n", tagno, tagname);
+  vdebug_text ("tname: %d %s\n", tagno, tagname);
 }
 
 // Record>  Tag: time.sec user.time sys.time nodeId taskId tag#
@@ -266,11 +501,11 @@ void chpl_vdebug_tag (int tagno) {
     ru.ru_stime.tv_sec = 0;
     ru.ru_stime.tv_usec = 0;
   }
-  chpl_dprintf (chpl_vdebug_fd, "Tag: %lld.%06ld %ld.%06ld %ld.%06ld %d %s %d\n",
-                (long long) tv.tv_sec, (long) tv.tv_usec,
-                (long) ru.ru_utime.tv_sec, (long) ru.ru_utime.tv_usec,
-                (long) ru.ru_stime.tv_sec, (long) ru.ru_stime.tv_usec,
-                chpl_nodeID, TID_STRING(buff, tagTask), tagno);
+  vdebug_text ("Tag: %lld.%06ld %ld.%06ld %ld.%06ld %d %s %d\n",
+               (long long) tv.tv_sec, (long) tv.tv_usec,
+               (long) ru.ru_utime.tv_sec, (long) ru.ru_utime.tv_usec,
+               (long) ru.ru_stime.tv_sec, (long) ru.ru_stime.tv_usec,
+               chpl_nodeID, TID_STRING(buff, tagTask), tagno);
   chpl_vdebug = 1;
 }
 
@@ -290,11 +525,11 @@ void chpl_vdebug_pause (int tagno) {
       ru.ru_stime.tv_sec = 0;
       ru.ru_stime.tv_usec = 0;
     }
-    chpl_dprintf (chpl_vdebug_fd, "Pause: %lld.%06ld %ld.%06ld %ld.%06ld %d %s %d\n",
-                  (long long) tv.tv_sec, (long) tv.tv_usec,
-                  (long) ru.ru_utime.tv_sec, (long) ru.ru_utime.tv_usec,
-                  (long) ru.ru_stime.tv_sec, (long) ru.ru_stime.tv_usec,
-                  chpl_nodeID, TID_STRING(buff, pauseTask), tagno);
+    vdebug_text ("Pause: %lld.%06ld %ld.%06ld %ld.%06ld %d %s %d\n",
+                 (long long) tv.tv_sec, (long) tv.tv_usec,
+                 (long) ru.ru_utime.tv_sec, (long) ru.ru_utime.tv_usec,
+                 (long) ru.ru_stime.tv_sec, (long) ru.ru_stime.tv_usec,
+                 chpl_nodeID, TID_STRING(buff, pauseTask), tagno);
     chpl_vdebug = 0;
   }
 }
@@ -316,6 +551,15 @@ void cb_comm_put_nb (const chpl_comm_cb_info_t *info) {
     chpl_taskID_t commTask = chpl_task_getId();
     char buff[CHPL_TASK_ID_STRING_MAX_LEN];
     (void) gettimeofday (&tv, NULL);
+    if (vdebugBinary) {
+      chpl_vdebug_rec_comm_t r = { info->localNodeID, info->remoteNodeID,
+                                    (int64_t) commTask,
+                                    (uint64_t) cm->addr, (uint64_t) cm->raddr,
+                                    1, (int64_t) cm->size, cm->commID, cm->lineno,
+                                    cm->filename, 0 };
+      vdebug_emit (VDEBUG_REC_COMM, VDEBUG_COMM_NB_PUT, &tv, &r, sizeof(r));
+      return;
+    }
     chpl_dprintf (chpl_vdebug_fd,
                   VDEBUG_GETPUT_FORMAT_STRING, "nb_put",
                   (long long) tv.tv_sec, (long) tv.tv_usec,  info->localNodeID,
@@ -337,6 +581,15 @@ void cb_comm_get_nb (const chpl_comm_cb_info_t *info) {
     chpl_taskID_t commTask = chpl_task_getId();
     char buff[CHPL_TASK_ID_STRING_MAX_LEN];
     (void) gettimeofday (&tv, NULL);
+    if (vdebugBinary) {
+      chpl_vdebug_rec_comm_t r = { info->localNodeID, info->remoteNodeID,
+                                    (int64_t) commTask,
+                                    (uint64_t) cm->addr, (uint64_t) cm->raddr,
+                                    1, (int64_t) cm->size, cm->commID, cm->lineno,
+                                    cm->filename, 0 };
+      vdebug_emit (VDEBUG_REC_COMM, VDEBUG_COMM_NB_GET, &tv, &r, sizeof(r));
+      return;
+    }
     chpl_dprintf (chpl_vdebug_fd,
                   VDEBUG_GETPUT_FORMAT_STRING, "nb_get",
                   (long long) tv.tv_sec, (long) tv.tv_usec,  info->localNodeID,
@@ -357,6 +610,15 @@ void cb_comm_put (const chpl_comm_cb_info_t *info) {
     chpl_taskID_t commTask = chpl_task_getId();
     char buff[CHPL_TASK_ID_STRING_MAX_LEN];
     (void) gettimeofday (&tv, NULL);
+    if (vdebugBinary) {
+      chpl_vdebug_rec_comm_t r = { info->localNodeID, info->remoteNodeID,
+                                    (int64_t) commTask,
+                                    (uint64_t) cm->addr, (uint64_t) cm->raddr,
+                                    1, (int64_t) cm->size, cm->commID, cm->lineno,
+                                    cm->filename, 0 };
+      vdebug_emit (VDEBUG_REC_COMM, VDEBUG_COMM_PUT, &tv, &r, sizeof(r));
+      return;
+    }
     chpl_dprintf (chpl_vdebug_fd,
                   VDEBUG_GETPUT_FORMAT_STRING, "put",
                   (long long) tv.tv_sec, (long) tv.tv_usec, info->localNodeID,
@@ -378,6 +640,15 @@ void cb_comm_get (const chpl_comm_cb_info_t *info) {
     chpl_taskID_t commTask = chpl_task_getId();
     char buff[CHPL_TASK_ID_STRING_MAX_LEN];
     (void) gettimeofday (&tv, NULL);
+    if (vdebugBinary) {
+      chpl_vdebug_rec_comm_t r = { info->localNodeID, info->remoteNodeID,
+                                    (int64_t) commTask,
+                                    (uint64_t) cm->addr, (uint64_t) cm->raddr,
+                                    1, (int64_t) cm->size, cm->commID, cm->lineno,
+                                    cm->filename, 0 };
+      vdebug_emit (VDEBUG_REC_COMM, VDEBUG_COMM_GET, &tv, &r, sizeof(r));
+      return;
+    }
     chpl_dprintf (chpl_vdebug_fd,
                   VDEBUG_GETPUT_FORMAT_STRING, "get",
                   (long long) tv.tv_sec, (long) tv.tv_usec,  info->localNodeID,
@@ -404,6 +675,15 @@ void cb_comm_put_strd (const chpl_comm_cb_info_t *info) {
       length *= cm->count[i];
     }
 
+    if (vdebugBinary) {
+      chpl_vdebug_rec_comm_t r = { info->localNodeID, info->remoteNodeID,
+                                    (int64_t) commTask,
+                                    (uint64_t) cm->srcaddr, (uint64_t) cm->dstaddr,
+                                    (int64_t) cm->elemSize, (int64_t) length, cm->commID, cm->lineno,
+                                    cm->filename, 0 };
+      vdebug_emit (VDEBUG_REC_COMM, VDEBUG_COMM_ST_PUT, &tv, &r, sizeof(r));
+      return;
+    }
     chpl_dprintf (chpl_vdebug_fd,
                   VDEBUG_GETPUT_FORMAT_STRING, "st_put",
                   (long long) tv.tv_sec, (long) tv.tv_usec,  info->localNodeID,
@@ -434,6 +714,15 @@ void cb_comm_get_strd (const chpl_comm_cb_info_t *info) {
       length *= cm->count[i];
     }
 
+    if (vdebugBinary) {
+      chpl_vdebug_rec_comm_t r = { info->localNodeID, info->remoteNodeID,
+                                    (int64_t) commTask,
+                                    (uint64_t) cm->dstaddr, (uint64_t) cm->srcaddr,
+                                    (int64_t) cm->elemSize, (int64_t) length, cm->commID, cm->lineno,
+                                    cm->filename, 0 };
+      vdebug_emit (VDEBUG_REC_COMM, VDEBUG_COMM_ST_GET, &tv, &r, sizeof(r));
+      return;
+    }
     chpl_dprintf (chpl_vdebug_fd,
                   VDEBUG_GETPUT_FORMAT_STRING, "st_get",
                   (long long) tv.tv_sec, (long) tv.tv_usec, info->localNodeID,
@@ -455,6 +744,15 @@ void cb_comm_executeOn (const chpl_comm_cb_info_t *info) {
     char buff[CHPL_TASK_ID_STRING_MAX_LEN];
     struct timeval tv;
     (void) gettimeofday (&tv, NULL);
+    if (vdebugBinary) {
+      chpl_vdebug_rec_fork_t r = { info->localNodeID, info->remoteNodeID,
+                                    cm->subloc, cm->fid, (uint64_t) cm->arg,
+                                    (int64_t) cm->arg_size,
+                                    (int64_t) executeOnTask, cm->lineno,
+                                    cm->filename };
+      vdebug_emit (VDEBUG_REC_FORK, VDEBUG_FORK, &tv, &r, sizeof(r));
+      return;
+    }
     chpl_dprintf (chpl_vdebug_fd,
                   "fork: %lld.%06ld %d %d %d %d %#lx %zd %s %d %d\n",
                   (long long) tv.tv_sec, (long) tv.tv_usec, info->localNodeID,
@@ -474,6 +772,15 @@ void  cb_comm_executeOn_nb (const chpl_comm_cb_info_t *info) {
     char buff[CHPL_TASK_ID_STRING_MAX_LEN];
     struct timeval tv;
     (void) gettimeofday (&tv, NULL);
+    if (vdebugBinary) {
+      chpl_vdebug_rec_fork_t r = { info->localNodeID, info->remoteNodeID,
+                                    cm->subloc, cm->fid, (uint64_t) cm->arg,
+                                    (int64_t) cm->arg_size,
+                                    (int64_t) executeOnTask, cm->lineno,
+                                    cm->filename };
+      vdebug_emit (VDEBUG_REC_FORK, VDEBUG_FORK_NB, &tv, &r, sizeof(r));
+      return;
+    }
     chpl_dprintf (chpl_vdebug_fd, "fork_nb: %lld.%06ld %d %d %d %d %#lx %zd %s %d %d\n",
                   (long long) tv.tv_sec, (long) tv.tv_usec, info->localNodeID,
                   info->remoteNodeID, cm->subloc, cm->fid, (unsigned long) cm->arg,
@@ -491,6 +798,15 @@ void cb_comm_executeOn_fast (const chpl_comm_cb_info_t *info) {
     char buff[CHPL_TASK_ID_STRING_MAX_LEN];
     struct timeval tv;
     (void) gettimeofday (&tv, NULL);
+    if (vdebugBinary) {
+      chpl_vdebug_rec_fork_t r = { info->localNodeID, info->remoteNodeID,
+                                    cm->subloc, cm->fid, (uint64_t) cm->arg,
+                                    (int64_t) cm->arg_size,
+                                    (int64_t) executeOnTask, cm->lineno,
+                                    cm->filename };
+      vdebug_emit (VDEBUG_REC_FORK, VDEBUG_FORK_FAST, &tv, &r, sizeof(r));
+      return;
+    }
     chpl_dprintf (chpl_vdebug_fd,
                   "f_fork: %lld.%06ld %d %d %d %d %#lx %zd %s %d %d\n",
                   (long long) tv.tv_sec, (long) tv.tv_usec, info->localNodeID,
@@ -608,6 +924,15 @@ void cb_task_create (const chpl_task_cb_info_t *info) {
     //         (int)info->event_kind, (int)info->nodeID,
     //        (info->iu.full.is_executeOn ? "O" : "L"), taskId, info->iu.full.id);
     (void)gettimeofday(&tv, NULL);
+    if (vdebugBinary) {
+      chpl_vdebug_rec_task_t r = { info->nodeID, info->iu.full.is_executeOn,
+                                   (int64_t) info->iu.full.id,
+                                   (int64_t) taskId, info->iu.full.lineno,
+                                   info->iu.full.filename, info->iu.full.fid,
+                                   0 };
+      vdebug_emit (VDEBUG_REC_TASK, 0, &tv, &r, sizeof(r));
+      return;
+    }
     chpl_dprintf (chpl_vdebug_fd, "task: %lld.%06ld %lld %ld %s %s %ld %d %d\n",
                   (long long) tv.tv_sec, (long) tv.tv_usec,
                   (long long) info->nodeID, (long int) info->iu.full.id,
@@ -626,6 +951,12 @@ void cb_task_begin (const chpl_task_cb_info_t *info) {
   if (!chpl_vdebug) return;
   if (chpl_vdebug_fd >= 0) {
     (void)gettimeofday(&tv, NULL);
+    if (vdebugBinary) {
+      chpl_vdebug_rec_task_state_t r = { info->nodeID, 0,
+                                         (int64_t) info->iu.full.id };
+      vdebug_emit (VDEBUG_REC_BTASK, 0, &tv, &r, sizeof(r));
+      return;
+    }
     chpl_dprintf (chpl_vdebug_fd, "Btask: %lld.%06ld %lld %lu\n",
                   (long long) tv.tv_sec, (long) tv.tv_usec,
                   (long long) info->nodeID, (unsigned long) info->iu.full.id);
@@ -640,6 +971,12 @@ void cb_task_end (const chpl_task_cb_info_t *info) {
   if (!chpl_vdebug) return;
   if (chpl_vdebug_fd >= 0) {
     (void)gettimeofday(&tv, NULL);
+    if (vdebugBinary) {
+      chpl_vdebug_rec_task_state_t r = { info->nodeID, 0,
+                                         (int64_t) info->iu.id_only.id };
+      vdebug_emit (VDEBUG_REC_ETASK, 0, &tv, &r, sizeof(r));
+      return;
+    }
     chpl_dprintf (chpl_vdebug_fd, "Etask: %lld.%06ld %lld %lu\n",
                   (long long) tv.tv_sec, (long) tv.tv_usec,
                   (long long) info->nodeID, (unsigned long) info->iu.id_only.id);
@@ -24,6 +24,7 @@
 #include "chpltypes.h"
 #include "chpl-mem.h"
 #include "error.h"
+#include "qio_number_fast.h"
 
 #include <ctype.h>
 #include <stdio.h>
@@ -54,6 +55,26 @@ static int illegalFirstUnsChar(char c) {
   return (c == '-');
 }
 
+// strtoull(str, endPtr, 10) for a str that starts with a digit, without
+// the locale and errno handling.  Like strtoull, it gives UINT64_MAX for
+// values that don't fit.
+static uint64_t parse_uint64_decimal(c_string str, char** endPtr) {
+  const unsigned char* p = (const unsigned char*) str;
+  const unsigned char* end = p + strlen(str);
+  uint64_t val = 0;
+  size_t ndigits;
+
+  while (p < end - 1 && *p == '0' && '0' <= p[1] && p[1] <= '9')
+    p++;
+  ndigits = _fast_parse_digits(p, end, &val);
+  if (ndigits > 19) {
+    // might not fit; let strtoull decide
+    return strtoull(str, endPtr, 10);
+  }
+  *endPtr = (char*) (p + ndigits);
+  return val;
+}
+
 /* Need to use this helper macro for PGI where doing otherwise causes
    spaces to disappear between the type name and the subsequent
    tokens */
@@ -101,7 +122,11 @@ static int illegalFirstUnsChar(char c) {
       *invalidCh = *str;                                                \
       return -1;                                                        \
     }                                                                   \
-    val = (_type(base, width))strtoull(str, &endPtr, numberBase);  \
+    if (numberBase == 10 && '0' <= str[0] && str[0] <= '9') {          \
+      val = (_type(base, width))parse_uint64_decimal(str, &endPtr);     \
+    } else {                                                            \
+      val = (_type(base, width))strtoull(str, &endPtr, numberBase);     \
+    }                                                                   \
     if (negative) {                                                     \
       val = -1*val;                                                     \
     }                                                                   \
@@ -141,6 +166,98 @@ chpl_bool c_string_to_chpl_bool(c_string str, chpl_bool* err, int lineno, int32_
 
 #define _real_type(base, width) _##base##width
 
+// Parses a plain decimal real ([+-]digits[.digits][e[+-]digits]) at the
+// start of str into a mantissa and a power of 10, and sets *numbytes to
+// its length.  Returns false for anything else, or anything sscanf might
+// read further (hex, inf, nan, a letter right after the number, too many
+// digits), so that the caller can fall back on sscanf.
+static chpl_bool parse_real_decimal(c_string str, uint64_t* mantissa,
+                                    int64_t* exp10, chpl_bool* negative,
+                                    int* numbytes) {
+  const unsigned char* start = (const unsigned char*) str;
+  const unsigned char* p = start;
+  const unsigned char* end = p + strlen(str);
+  size_t nint, nfrac = 0;
+
+  *mantissa = 0;
+  *exp10 = 0;
+  *negative = false;
+  if (*p == '-') {
+    *negative = true;
+    p++;
+  } else if (*p == '+') {
+    p++;
+  }
+  nint = _fast_parse_digits(p, end, mantissa);
+  p += nint;
+  if (*p == '.') {
+    p++;
+    nfrac = _fast_parse_digits(p, end, mantissa);
+    p += nfrac;
+  }
+  if (nint + nfrac == 0 || nint + nfrac > 19)
+    return false;
+  if (*p == 'e' || *p == 'E') {
+    uint64_t e = 0;
+    chpl_bool eneg = false;
+    size_t ne;
+    p++;
+    if (*p == '-') {
+      eneg = true;
+      p++;
+    } else if (*p == '+') {
+      p++;
+    }
+    ne = _fast_parse_digits(p, end, &e);
+    if (ne == 0 || ne > 4)
+      return false;
+    p += ne;
+    *exp10 = eneg ? -(int64_t) e : (int64_t) e;
+  }
+  if (*p == '.' || *p >= 0x80 || isalpha(*p))
+    return false;
+  *exp10 -= nfrac;
+  *numbytes = (int) (p - start);
+  return true;
+}
+
+static chpl_bool parse_real64_fast(c_string str, _real64* val, int* numbytes) {
+  uint64_t mantissa;
+  int64_t exp10;
+  chpl_bool negative;
+  double num;
+  if (!parse_real_decimal(str, &mantissa, &exp10, &negative, numbytes) ||
+      !_fast_scale_pow10(mantissa, exp10, &num))
+    return false;
+  *val = negative ? -num : num;
+  return true;
+}
+
+// The same for floats.  Rounding to double first and then to float could
+// round twice, so this uses float arithmetic, where the exact range is
+// smaller.
+static chpl_bool parse_real32_fast(c_string str, _real32* val, int* numbytes) {
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+  static const float exact_pow10f[] = {
+    1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+  };
+  uint64_t mantissa;
+  int64_t exp10;
+  chpl_bool negative;
+  float num;
+  if (!parse_real_decimal(str, &mantissa, &exp10, &negative, numbytes) ||
+      mantissa > (UINT64_C(1) << 24) || exp10 < -10 || exp10 > 10)
+    return false;
+  num = (float) mantissa;
+  if (exp10 < 0) num /= exact_pow10f[-exp10];
+  else num *= exact_pow10f[exp10];
+  *val = negative ? -num : num;
+  return true;
+#else
+  return false;
+#endif
+}
+
 #define _define_string_to_float_precise(base, width, format)            \
   _real_type(base, width) c_string_to_##base##width##_precise(c_string str, \
                                                               int* invalid,   \
@@ -150,9 +267,13 @@ chpl_bool c_string_to_chpl_bool(c_string str, chpl_bool* err, int lineno, int32_
     int numitems;                                                       \
     while (*str && isspace(*str))                                       \
       str++;                                                            \
-    numitems = sscanf(str, format"%n", &val, &numbytes);                \
-    if (scanningNCounts() && numitems == 2) {                           \
+    if (parse_##base##width##_fast(str, &val, &numbytes)) {             \
       numitems = 1;                                                     \
+    } else {                                                            \
+      numitems = sscanf(str, format"%n", &val, &numbytes);              \
+      if (scanningNCounts() && numitems == 2) {                         \
+        numitems = 1;                                                   \
+      }                                                                 \
     }                                                                   \
     if (numitems == 1) {                                                \
       while (str[numbytes] && isspace(str[numbytes]))                   \
@@ -371,25 +492,34 @@ _define_string_to_real_type(complex, 128)
 c_string
 integral_to_c_string(int64_t x, uint32_t size, chpl_bool isSigned, chpl_bool* err)
 {
-  char buffer[256];
-  const char* format = "";
+  char buffer[32];
+  uint64_t magnitude = 0;
+  chpl_bool negative = false;
   enum {UNSIGNED = 0<<16, SIGNED = 1<<16 };
   switch (SIGNED * isSigned + size)
   {
    default:
     *err = true;
-    break;
-
-   case UNSIGNED + 1: format = "%" PRIu8;  break;
-   case UNSIGNED + 2: format = "%" PRIu16; break;
-   case UNSIGNED + 4: format = "%" PRIu32; break;
-   case UNSIGNED + 8: format = "%" PRIu64; break;
-   case   SIGNED + 1: format = "%" PRId8;  break;
-   case   SIGNED + 2: format = "%" PRId16; break;
-   case   SIGNED + 4: format = "%" PRId32; break;
-   case   SIGNED + 8: format = "%" PRId64; break;
+    buffer[0] = '\0';
+    return string_copy(buffer, 0, 0);
+
+   // like the PRI* formats, the narrower sizes are printed as 32 bits
+   case UNSIGNED + 1:
+   case UNSIGNED + 2:
+   case UNSIGNED + 4: magnitude = (uint32_t) x; break;
+   case UNSIGNED + 8: magnitude = (uint64_t) x; break;
+   case   SIGNED + 1:
+   case   SIGNED + 2:
+   case   SIGNED + 4: x = (int32_t) x; break;
+   case   SIGNED + 8: break;
+  }
+  if (isSigned) {
+    negative = x < 0;
+    // negate as unsigned, so that INT64_MIN works
+    magnitude = negative ? -(uint64_t) x : (uint64_t) x;
   }
-  snprintf(buffer, sizeof(buffer), format, x);
+  buffer[0] = '-';
+  _fast_format_u64(buffer + negative, magnitude);
   return string_copy(buffer, 0, 0);
 }
 
@@ -422,6 +552,18 @@ real_to_c_string(_real64 x, chpl_bool isImag)
     } else {
       return string_copy(POSINFSTRING, 0, 0);
     }
+  } else if (fabs(x) < 1e6 && x == (_real64) (int64_t) x) {
+    // %lg prints integers of up to 6 digits as they are; write these out
+    // directly, ".0" included
+    char buffer[16];
+    int negative = signbit(x) != 0;
+    size_t len;
+
+    buffer[0] = '-';
+    len = negative + _fast_format_u64(buffer + negative,
+                                      (uint64_t) fabs(x));
+    memcpy(buffer + len, isImag ? ".0i" : ".0", isImag ? 4 : 3);
+    return string_copy(buffer, 0, 0);
   } else {
     char buffer[256];
     char* last;
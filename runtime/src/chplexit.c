@@ -21,11 +21,17 @@
 #include "chplrt.h"
 
 #include "chpl_rt_utils_static.h"
+#include "chpl-cache.h"
 #include "chpl-comm.h"
+#include "chpl-comm-diags.h"
+#include "chpl-gpu-kernel-stats.h"
 #include "chplexit.h"
 #include "chpl-mem.h"
 #include "chplmemtrack.h"
+#include "chpl-perf-region.h"
+#include "chpl-profile.h"
 #include "chpl-topo.h"
+#include "chpl-trace.h"
 #include "debugger.h"
 
 #include <stdio.h>
@@ -46,8 +52,19 @@ void chpl_finalize(int status, int all) {
   chpl_comm_pre_task_exit(all);
   if (all) {
     chpl_task_exit();
+#ifdef HAS_CHPL_CACHE_FNS
+    chpl_cache_print_site_stats();
+    chpl_cache_flush_traces();
+#endif
+#ifdef HAS_GPU_LOCALE
+    chpl_gpu_kernel_stats_report();
+#endif
+    chpl_perf_region_report();
+    chpl_comm_writeDiagsMatrixHere();
     chpl_reportMemInfo();
   }
+  chpl_profile_fini();
+  chpl_trace_fini();
   chpl_comm_exit(all, status);
   if (all) {
     chpl_mem_exit();
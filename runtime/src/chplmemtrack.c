@@ -29,7 +29,9 @@
 #include "chpl-comm.h"
 #include "chpl-comm-internal.h"
 #include "chplcgfns.h"
+#include "chpl-env.h"
 #include "chpl-linefile-support.h"
+#include "chpl-thread-local-storage.h"
 #include "config.h"
 #include "error.h"
 
@@ -43,9 +45,18 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <inttypes.h>
+#ifdef __GLIBC__
+#include <execinfo.h>
+#endif
 
 int chpl_verbose_mem = 0;
 int chpl_memTrack = 0;
+size_t chpl_memSample = 0;
+int chpl_memCounters = 0;
+
+static void memSampleInit(void);
+static void memSampleReport(void);
+static void memCountInit(void);
 
 static void
 printMemAllocs(chpl_mem_descInt_t description, int64_t threshold,
@@ -82,10 +93,6 @@ static int hashSizes[NUM_HASH_SIZE_INDICES] = { 1543, 3079, 6151, 12289, 24593,
                                                 196613, 393241, 786433, 1572869, 3145739,
                                                 6291469, 12582917, 25165843, 50331653,
                                                 100663319, 201326611, 402653189, 805306457 };
-static int hashSizeIndex = 0;
-static int hashSize = 0;
-
-static memTableEntry** memTable = NULL;
 
 static _Bool memStats = false;
 static _Bool memLeaksByType = false;
@@ -99,9 +106,6 @@ static c_string memLeaksLog = NULL;
 
 static size_t totalMem = 0;       /* total memory currently allocated */
 static size_t maxMem = 0;         /* maximum total memory during run  */
-static size_t totalAllocated = 0; /* total memory allocated */
-static size_t totalFreed = 0;     /* total memory freed */
-static size_t totalEntries = 0;     /* number of entries in hash table */
 
 
 // We can't use a sync var for concurrency control here.  The Qthreads
@@ -111,23 +115,46 @@ static size_t totalEntries = 0;     /* number of entries in hash table */
 // the tasking layer is shut down, ends up trying to create a qthread in
 // the terminated Qthreads library.  Chaos results.  We also cannot use
 // an atomic var, because with CHPL_ATOMICS=locks those are implemented
-// by means of sync vars.  So, we use a pthread mutex.  Note that this
-// is only safe if we cannot switch tasks on a pthread while holding the
-// mutex and then try to lock it recursively.  Currently that is the
-// case, since we do not yield while holding the mutex.
+// by means of sync vars.  So, we use pthread mutexes, and compiler
+// atomic builtins for the two counters that aren't under a mutex.  Note
+// that this is only safe if we cannot switch tasks on a pthread while
+// holding a mutex and then try to lock it recursively.  Currently that
+// is the case, since we do not yield while holding one.
+//
+// To keep threads from serializing on every tracked allocation and
+// free, the table is split into shards by address, each with its own
+// lock, hash table, and statistics.  The statistics are only summed
+// when they are reported.
 //
-static pthread_mutex_t memTrack_lockVar = PTHREAD_MUTEX_INITIALIZER;
+#define NUM_MEM_TABLE_SHARDS 64
+
+typedef struct {
+  pthread_mutex_t lock;
+  memTableEntry** table;
+  int hashSizeIndex;
+  int hashSize;
+  size_t entries;         /* number of entries in hash table */
+  size_t totalAllocated;  /* total memory allocated */
+  size_t totalFreed;      /* total memory freed */
+} __attribute__((aligned(64))) memTableShard;
+
+static memTableShard memShards[NUM_MEM_TABLE_SHARDS];
 
 static inline
-void memTrack_lock(void) {
-  (void) pthread_mutex_lock(&memTrack_lockVar);
+memTableShard* memTrack_shard(void* memAlloc) {
+  uint64_t h = (uint64_t) (uintptr_t) memAlloc * UINT64_C(0x9E3779B97F4A7C15);
+  return &memShards[h >> 58];  // top log2(NUM_MEM_TABLE_SHARDS) bits
 }
 
 static inline
-void memTrack_unlock(void) {
-  (void) pthread_mutex_unlock(&memTrack_lockVar);
+void memTrack_lock(memTableShard* shard) {
+  (void) pthread_mutex_lock(&shard->lock);
 }
 
+static inline
+void memTrack_unlock(memTableShard* shard) {
+  (void) pthread_mutex_unlock(&shard->lock);
+}
 
 
 void chpl_setMemFlags(void) {
@@ -181,10 +208,17 @@ void chpl_setMemFlags(void) {
     }
   }
 
+  memSampleInit();
+  memCountInit();
+
   if (local_memTrack) {
-    hashSizeIndex = 0;
-    hashSize = hashSizes[hashSizeIndex];
-    memTable = sys_calloc(hashSize, sizeof(memTableEntry*));
+    for (int i = 0; i < NUM_MEM_TABLE_SHARDS; i++) {
+      memTableShard* shard = &memShards[i];
+      (void) pthread_mutex_init(&shard->lock, NULL);
+      shard->hashSizeIndex = 0;
+      shard->hashSize = hashSizes[shard->hashSizeIndex];
+      shard->table = sys_calloc(shard->hashSize, sizeof(memTableEntry*));
+    }
     chpl_atomic_thread_fence(chpl_memory_order_release);
     chpl_memTrack = local_memTrack;
     chpl_atomic_thread_fence(chpl_memory_order_release);
@@ -204,37 +238,46 @@ static unsigned hash(void* memAlloc, int hashSize) {
 }
 
 
-static void increaseMemStat(size_t chunk, int32_t lineno, int32_t filename) {
-  totalMem += chunk;
-  totalAllocated += chunk;
-  if (memMax && (totalMem > memMax)) {
+//
+// The running total and its high water mark are the only statistics
+// shared across shards, because --memMax and the high water mark need
+// the total at the moment of each allocation.
+//
+static void increaseMemStat(memTableShard* shard, size_t chunk,
+                            int32_t lineno, int32_t filename) {
+  size_t now = __atomic_add_fetch(&totalMem, chunk, __ATOMIC_RELAXED);
+  size_t max = __atomic_load_n(&maxMem, __ATOMIC_RELAXED);
+  shard->totalAllocated += chunk;
+  if (memMax && (now > memMax)) {
     chpl_error("Exceeded memory limit", lineno, filename);
   }
-  if (totalMem > maxMem)
-    maxMem = totalMem;
+  while (now > max
+         && !__atomic_compare_exchange_n(&maxMem, &max, now, true,
+                                         __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    ;
 }
 
 
-static void decreaseMemStat(size_t chunk) {
-  totalMem -= chunk; // > totalMem ? 0 : totalMem - chunk;
-  totalFreed += chunk;
+static void decreaseMemStat(memTableShard* shard, size_t chunk) {
+  (void) __atomic_sub_fetch(&totalMem, chunk, __ATOMIC_RELAXED);
+  shard->totalFreed += chunk;
 }
 
-// assumes that the lock is held
+// assumes that the shard lock is held
 static void
-resizeTable(int direction) {
+resizeTable(memTableShard* shard, int direction) {
   memTableEntry** newMemTable = NULL;
   int newHashSizeIndex, newHashSize, newHashValue;
   int i;
   memTableEntry* me;
   memTableEntry* next;
 
-  newHashSizeIndex = hashSizeIndex + direction;
+  newHashSizeIndex = shard->hashSizeIndex + direction;
   newHashSize = hashSizes[newHashSizeIndex];
   newMemTable = sys_calloc(newHashSize, sizeof(memTableEntry*));
 
-  for (i = 0; i < hashSize; i++) {
-    for (me = memTable[i]; me != NULL; me = next) {
+  for (i = 0; i < shard->hashSize; i++) {
+    for (me = shard->table[i]; me != NULL; me = next) {
       next = me->nextInBucket;
       newHashValue = hash(me->memAlloc, newHashSize);
       me->nextInBucket = newMemTable[newHashValue];
@@ -242,22 +285,24 @@ resizeTable(int direction) {
     }
   }
 
-  sys_free(memTable);
-  memTable = newMemTable;
-  hashSize = newHashSize;
-  hashSizeIndex = newHashSizeIndex;
+  sys_free(shard->table);
+  shard->table = newMemTable;
+  shard->hashSize = newHashSize;
+  shard->hashSizeIndex = newHashSizeIndex;
 }
 
-// assumes that the lock is held
-static void addMemTableEntry(void *memAlloc, size_t number, size_t size,
+// assumes that the shard lock is held
+static void addMemTableEntry(memTableShard* shard,
+                             void *memAlloc, size_t number, size_t size,
                              c_sublocid_t subloc,
                              chpl_mem_descInt_t description, int32_t lineno,
                              int32_t filename) {
   unsigned hashValue;
   memTableEntry* memEntry;
 
-  if ((totalEntries+1)*2 > hashSize && hashSizeIndex < NUM_HASH_SIZE_INDICES-1)
-    resizeTable(1);
+  if ((shard->entries+1)*2 > shard->hashSize
+      && shard->hashSizeIndex < NUM_HASH_SIZE_INDICES-1)
+    resizeTable(shard, 1);
 
   memEntry = (memTableEntry*) sys_calloc(1, sizeof(memTableEntry));
   if (!memEntry) {
@@ -265,9 +310,9 @@ static void addMemTableEntry(void *memAlloc, size_t number, size_t size,
                lineno, filename);
   }
 
-  hashValue = hash(memAlloc, hashSize);
-  memEntry->nextInBucket = memTable[hashValue];
-  memTable[hashValue] = memEntry;
+  hashValue = hash(memAlloc, shard->hashSize);
+  memEntry->nextInBucket = shard->table[hashValue];
+  shard->table[hashValue] = memEntry;
   memEntry->subloc = subloc;
   memEntry->description = description;
   memEntry->memAlloc = memAlloc;
@@ -275,25 +320,26 @@ static void addMemTableEntry(void *memAlloc, size_t number, size_t size,
   memEntry->filename = filename;
   memEntry->number = number;
   memEntry->size = size;
-  increaseMemStat(number*size, lineno, filename);
-  totalEntries += 1;
+  increaseMemStat(shard, number*size, lineno, filename);
+  shard->entries += 1;
 }
 
 
-// assumes that the lock is held
-static memTableEntry* removeMemTableEntry(void* address) {
-  unsigned hashValue = hash(address, hashSize);
-  memTableEntry* thisBucketEntry = memTable[hashValue];
+// assumes that the shard lock is held
+static memTableEntry* removeMemTableEntry(memTableShard* shard,
+                                          void* address) {
+  unsigned hashValue = hash(address, shard->hashSize);
+  memTableEntry* thisBucketEntry = shard->table[hashValue];
   memTableEntry* deletedBucket = NULL;
 
   if (!thisBucketEntry)
     return NULL;
 
   if (thisBucketEntry->memAlloc == address) {
-    memTable[hashValue] = thisBucketEntry->nextInBucket;
+    shard->table[hashValue] = thisBucketEntry->nextInBucket;
     deletedBucket = thisBucketEntry;
   } else {
-    for (thisBucketEntry = memTable[hashValue];
+    for (thisBucketEntry = shard->table[hashValue];
          thisBucketEntry != NULL;
          thisBucketEntry = thisBucketEntry->nextInBucket) {
 
@@ -306,10 +352,10 @@ static memTableEntry* removeMemTableEntry(void* address) {
     }
   }
   if (deletedBucket) {
-    decreaseMemStat(deletedBucket->number * deletedBucket->size);
-    totalEntries -= 1;
-    if (totalEntries*8 < hashSize && hashSizeIndex > 0)
-      resizeTable(-1);
+    decreaseMemStat(shard, deletedBucket->number * deletedBucket->size);
+    shard->entries -= 1;
+    if (shard->entries*8 < shard->hashSize && shard->hashSizeIndex > 0)
+      resizeTable(shard, -1);
   }
   return deletedBucket;
 }
@@ -322,7 +368,7 @@ uint64_t chpl_memoryUsed(int32_t lineno, int32_t filename) {
     return 0;
   }
 
-  return (uint64_t)totalMem;
+  return (uint64_t)__atomic_load_n(&totalMem, __ATOMIC_RELAXED);
 }
 
 
@@ -353,18 +399,31 @@ void chpl_printMemAllocStats(int32_t lineno, int32_t filename) {
              nodeWidth, chpl_nodeID);
   }
 
+  //
+  // Merge the per-shard statistics.
+  //
+  size_t totalAllocated = 0;
+  size_t totalFreed = 0;
+
+  for (int i = 0; i < NUM_MEM_TABLE_SHARDS; i++) {
+    memTrack_lock(&memShards[i]);
+    totalAllocated += memShards[i].totalAllocated;
+    totalFreed += memShards[i].totalFreed;
+    memTrack_unlock(&memShards[i]);
+  }
+
   //
   // Take a pre-run through the descriptions and values to figure
   // out how long each line will need to be.
   //
-  static const struct {
+  const struct {
     const char* desc;
-    size_t* val;
+    size_t val;
   } descsVals[] = {
-    { "Allocated Now:", &totalMem },
-    { "Allocation High Water Mark:", &maxMem },
-    { "Sum of Allocations:", &totalAllocated },
-    { "Sum of Frees:", &totalFreed },
+    { "Allocated Now:", __atomic_load_n(&totalMem, __ATOMIC_RELAXED) },
+    { "Allocation High Water Mark:", __atomic_load_n(&maxMem, __ATOMIC_RELAXED) },
+    { "Sum of Allocations:", totalAllocated },
+    { "Sum of Frees:", totalFreed },
   };
   const int nDescsVals = sizeof(descsVals) / sizeof(descsVals[0]);
 
@@ -376,9 +435,9 @@ void chpl_printMemAllocStats(int32_t lineno, int32_t filename) {
     if (thisDescWidth > descWidth)
       descWidth = thisDescWidth;
     const int thisMemWidth =
-                (*descsVals[i].val == 0)
+                (descsVals[i].val == 0)
                 ? 1
-                : (int) lrint(ceil(log10((double) *descsVals[i].val)));
+                : (int) lrint(ceil(log10((double) descsVals[i].val)));
     if (thisMemWidth > memWidth)
       memWidth = thisMemWidth;
   }
@@ -390,19 +449,15 @@ void chpl_printMemAllocStats(int32_t lineno, int32_t filename) {
   char buf[4 * (strlen(prefixBuf) + 1 + descWidth + 1 + memWidth + 1) + 1];
   size_t len;
 
-  memTrack_lock();
-
   len = 0;
   for (int i = 0; i < nDescsVals; i++) {
     len += snprintf(buf + len, sizeof(buf) - len,
                     "%s %-*s %*zd\n",
                     prefixBuf,
                     descWidth, descsVals[i].desc,
-                    memWidth, *descsVals[i].val);
+                    memWidth, descsVals[i].val);
   }
 
-  memTrack_unlock();
-
   fputs(buf, memLogFile);
 }
 
@@ -430,15 +485,18 @@ static void printMemAllocsByType(_Bool forLeaks,
 
   table = (size_t*)sys_calloc(numEntries, 3*sizeof(size_t));
 
-  memTrack_lock();
-  for (i = 0; i < hashSize; i++) {
-    for (me = memTable[i]; me != NULL; me = me->nextInBucket) {
-      table[3*me->description] += me->number*me->size;
-      table[3*me->description+1] += 1;
-      table[3*me->description+2] = me->description;
+  for (int s = 0; s < NUM_MEM_TABLE_SHARDS; s++) {
+    memTableShard* shard = &memShards[s];
+    memTrack_lock(shard);
+    for (i = 0; i < shard->hashSize; i++) {
+      for (me = shard->table[i]; me != NULL; me = me->nextInBucket) {
+        table[3*me->description] += me->number*me->size;
+        table[3*me->description+1] += 1;
+        table[3*me->description+2] = me->description;
+      }
     }
+    memTrack_unlock(shard);
   }
-  memTrack_unlock();
 
   qsort(table, numEntries, 3*sizeof(size_t), memTableEntryCmp);
 
@@ -538,7 +596,8 @@ printMemAllocs(chpl_mem_descInt_t description, int64_t threshold,
 
   memTableEntry* memEntry;
   c_string memEntryFilename;
-  int n, i, j;
+  int n, i;
+  size_t cap;
   char* loc;
   memTableEntry* table;
 
@@ -549,43 +608,39 @@ printMemAllocs(chpl_mem_descInt_t description, int64_t threshold,
   }
 
   n = 0;
+  cap = 0;
+  table = NULL;
   filenameWidth = strlen("Allocated Memory (Bytes)");
 
-  memTrack_lock();
-  // compute the number of table elements to gather & the maximum widths
-  for (i = 0; i < hashSize; i++) {
-    for (memEntry = memTable[i]; memEntry != NULL; memEntry = memEntry->nextInBucket) {
-      size_t chunk = memEntry->number * memEntry->size;
-      if (chunk < threshold)
-        continue;
-      if (description != -1 && memEntry->description != description)
-        continue;
-      n += 1;
-      if (memEntry->filename) {
-        memEntryFilename = chpl_lookupFilename(memEntry->filename);
-        filenameLength = strlen(memEntryFilename);
-        if (filenameLength > filenameWidth)
-          filenameWidth = filenameLength;
+  // save the relevant memTable entries to 'table' to get a snapshot,
+  // one shard at a time, and compute the maximum widths
+  for (int s = 0; s < NUM_MEM_TABLE_SHARDS; s++) {
+    memTableShard* shard = &memShards[s];
+    memTrack_lock(shard);
+    for (i = 0; i < shard->hashSize; i++) {
+      for (memEntry = shard->table[i]; memEntry != NULL; memEntry = memEntry->nextInBucket) {
+        size_t chunk = memEntry->number * memEntry->size;
+        if (chunk < threshold)
+          continue;
+        if (description != -1 && memEntry->description != description)
+          continue;
+        if (n == cap) {
+          cap = (cap == 0) ? 1024 : 2 * cap;
+          table = (memTableEntry*)sys_realloc(table, cap*sizeof(memTableEntry));
+          if (!table)
+            chpl_error("out of memory printing memory table", lineno, filename);
+        }
+        table[n++] = *memEntry;
+        if (memEntry->filename) {
+          memEntryFilename = chpl_lookupFilename(memEntry->filename);
+          filenameLength = strlen(memEntryFilename);
+          if (filenameLength > filenameWidth)
+            filenameWidth = filenameLength;
+        }
       }
     }
+    memTrack_unlock(shard);
   }
-  // allocate the table
-  table = (memTableEntry*)sys_malloc(n*sizeof(memTableEntry));
-  if (!table)
-    chpl_error("out of memory printing memory table", lineno, filename);
-  // save the relevant memTable entries to 'table' to get a snapshot
-  j = 0;
-  for (i = 0; i < hashSize; i++) {
-    for (memEntry = memTable[i]; memEntry != NULL; memEntry = memEntry->nextInBucket) {
-      size_t chunk = memEntry->number * memEntry->size;
-      if (chunk < threshold)
-        continue;
-      if (description != -1 && memEntry->description != description)
-        continue;
-      table[j++] = *memEntry;
-    }
-  }
-  memTrack_unlock();
 
   totalWidth = filenameWidth+numberWidth*4+descWidth+20;
   const int headerWidth = strlen(" Memory Leaks ");
@@ -642,25 +697,494 @@ printMemAllocs(chpl_mem_descInt_t description, int64_t threshold,
 }
 
 
+//
+// Sampling memory profiler.
+//
+// Rather than recording every allocation, each thread counts down the
+// bytes it allocates from an exponentially distributed starting point
+// with mean chpl_memSample, and records the allocation that takes its
+// count to zero, so that on average one allocation is recorded per
+// chpl_memSample bytes and larger allocations are proportionately more
+// likely to be recorded.  Samples go into per-thread buffers with no
+// locking; the buffers are merged at exit.
+//
+// For each locale we write <prefix>.<node>.txt, an estimate of the
+// bytes and allocations by descriptor and source line, and with
+// CHPL_RT_MEM_SAMPLE_STACKS, <prefix>.<node>.heap, a pprof heap_v2
+// profile of the sampled stacks.  Frees are not tracked, so that
+// profile has allocation data only (pprof -sample_index=alloc_space).
+//
+#define MEM_SAMPLE_MAX_FRAMES 32
+
+typedef struct {
+  size_t size;
+  chpl_mem_descInt_t description;
+  int32_t lineno;
+  int32_t filename;
+  int nframes;
+  void* frames[MEM_SAMPLE_MAX_FRAMES];
+} memSample_t;
+
+typedef struct memSampleBuf_s {
+  int64_t countdown;               // bytes until the next sample
+  uint64_t rng;
+  size_t num;
+  size_t cap;
+  memSample_t* samples;
+  struct memSampleBuf_s* next;      // on memSampleBufs
+} memSampleBuf_t;
+
+static CHPL_TLS_DECL(memSampleBuf_t*, memSampleBuf);
+static memSampleBuf_t* memSampleBufs = NULL;
+static pthread_mutex_t memSampleBufsLock = PTHREAD_MUTEX_INITIALIZER;
+static chpl_bool memSampleStacks = false;
+static const char* memSamplePrefix = "chpl-memsample";
+
+
+static void memSampleInit(void) {
+  memSampleStacks = chpl_env_rt_get_bool("MEM_SAMPLE_STACKS", false);
+  memSamplePrefix = chpl_env_rt_get("MEM_SAMPLE_FILE", memSamplePrefix);
+  CHPL_TLS_INIT(memSampleBuf);
+  chpl_atomic_thread_fence(chpl_memory_order_release);
+  chpl_memSample = chpl_env_rt_get_size("MEM_SAMPLE", 0);
+}
+
+
+// The next bytes-until-sample count, drawn from an exponential
+// distribution with mean chpl_memSample.
+static int64_t memSampleNextCountdown(memSampleBuf_t* buf) {
+  double u;
+
+  // xorshift64*
+  buf->rng ^= buf->rng >> 12;
+  buf->rng ^= buf->rng << 25;
+  buf->rng ^= buf->rng >> 27;
+  u = ((buf->rng * UINT64_C(2685821657736338717)) >> 11)
+      * (1.0 / 9007199254740992.0);
+  return (int64_t) (-log(1.0 - u) * chpl_memSample) + 1;
+}
+
+
+static memSampleBuf_t* memSampleGetBuf(void) {
+  memSampleBuf_t* buf = (memSampleBuf_t*) CHPL_TLS_GET(memSampleBuf);
+
+  if (buf == NULL) {
+    if ((buf = (memSampleBuf_t*) sys_calloc(1, sizeof(*buf))) == NULL)
+      return NULL;
+    buf->rng = ((uint64_t) (uintptr_t) buf * UINT64_C(0x9E3779B97F4A7C15))
+               | 1;
+    buf->countdown = memSampleNextCountdown(buf);
+    CHPL_TLS_SET(memSampleBuf, buf);
+
+    (void) pthread_mutex_lock(&memSampleBufsLock);
+    buf->next = memSampleBufs;
+    memSampleBufs = buf;
+    (void) pthread_mutex_unlock(&memSampleBufsLock);
+  }
+  return buf;
+}
+
+
+void chpl_memsample_malloc(size_t bytes, chpl_mem_descInt_t description,
+                           int32_t lineno, int32_t filename) {
+  memSampleBuf_t* buf;
+  memSample_t* s;
+
+  if ((buf = memSampleGetBuf()) == NULL)
+    return;
+
+  buf->countdown -= (int64_t) bytes;
+  if (buf->countdown > 0)
+    return;
+  buf->countdown = memSampleNextCountdown(buf);
+
+  if (buf->num == buf->cap) {
+    size_t newCap = (buf->cap == 0) ? 1024 : 2 * buf->cap;
+    memSample_t* newSamples = sys_realloc(buf->samples,
+                                          newCap * sizeof(*newSamples));
+    if (newSamples == NULL)
+      return;
+    buf->samples = newSamples;
+    buf->cap = newCap;
+  }
+
+  s = &buf->samples[buf->num++];
+  s->size = bytes;
+  s->description = description;
+  s->lineno = lineno;
+  s->filename = filename;
+  s->nframes = 0;
+#ifdef __GLIBC__
+  if (memSampleStacks)
+    s->nframes = backtrace(s->frames, MEM_SAMPLE_MAX_FRAMES);
+#endif
+}
+
+
+static int memSampleCmpSite(const void* va, const void* vb) {
+  const memSample_t* a = *(const memSample_t* const*) va;
+  const memSample_t* b = *(const memSample_t* const*) vb;
+  if (a->description != b->description)
+    return (a->description < b->description) ? -1 : 1;
+  if (a->filename != b->filename)
+    return (a->filename < b->filename) ? -1 : 1;
+  if (a->lineno != b->lineno)
+    return (a->lineno < b->lineno) ? -1 : 1;
+  return 0;
+}
+
+
+static int memSampleCmpStack(const void* va, const void* vb) {
+  const memSample_t* a = *(const memSample_t* const*) va;
+  const memSample_t* b = *(const memSample_t* const*) vb;
+  if (a->nframes != b->nframes)
+    return (a->nframes < b->nframes) ? -1 : 1;
+  return memcmp(a->frames, b->frames, a->nframes * sizeof(a->frames[0]));
+}
+
+
+static FILE* memSampleOpen(const char* suffix) {
+  char name[1024];
+  FILE* f;
+
+  snprintf(name, sizeof(name), "%s.%" PRI_c_nodeid_t ".%s",
+           memSamplePrefix, chpl_nodeID, suffix);
+  if ((f = fopen(name, "w")) == NULL) {
+    char msg[1100];
+    snprintf(msg, sizeof(msg), "cannot write memory samples to %s", name);
+    chpl_warning(msg, 0, 0);
+  }
+  return f;
+}
+
+
+static void memSampleReport(void) {
+  memSampleBuf_t* buf;
+  memSample_t** all;
+  const size_t interval = chpl_memSample;
+  size_t num = 0;
+  size_t i, j;
+  FILE* f;
+
+  if (!chpl_memSample)
+    return;
+  chpl_memSample = 0;   // stop sampling
+
+  (void) pthread_mutex_lock(&memSampleBufsLock);
+  for (buf = memSampleBufs; buf != NULL; buf = buf->next)
+    num += buf->num;
+  if ((all = sys_malloc((num + 1) * sizeof(*all))) == NULL) {
+    (void) pthread_mutex_unlock(&memSampleBufsLock);
+    return;
+  }
+  num = 0;
+  for (buf = memSampleBufs; buf != NULL; buf = buf->next) {
+    for (i = 0; i < buf->num; i++)
+      all[num++] = &buf->samples[i];
+  }
+  (void) pthread_mutex_unlock(&memSampleBufsLock);
+
+  //
+  // By site.  Each sample of size s stands for 1 / (1 - e^(-s/N))
+  // allocations of that size, where N is the mean sampling interval.
+  //
+  if ((f = memSampleOpen("txt")) != NULL) {
+    const double N = (double) interval;
+    fprintf(f, "# sampled 1 in %zu bytes; estimated totals\n"
+               "# bytes allocs description location\n",
+            interval);
+    qsort(all, num, sizeof(*all), memSampleCmpSite);
+    for (i = 0; i < num; i = j) {
+      double estBytes = 0.0, estCount = 0.0;
+      for (j = i; j < num && memSampleCmpSite(&all[i], &all[j]) == 0; j++) {
+        double w = 1.0 / (1.0 - exp(-(double) all[j]->size / N));
+        estCount += w;
+        estBytes += w * all[j]->size;
+      }
+      fprintf(f, "%.0f %.0f %s %s:%" PRId32 "\n",
+              estBytes, estCount, chpl_mem_descString(all[i]->description),
+              (all[i]->filename ? chpl_lookupFilename(all[i]->filename)
+                                : "--"),
+              all[i]->lineno);
+    }
+    fclose(f);
+  }
+
+  //
+  // By stack, in pprof's legacy heap_v2 format, which does the same
+  // unsampling itself given the raw counts and the rate.
+  //
+  if (memSampleStacks && (f = memSampleOpen("heap")) != NULL) {
+    size_t totBytes = 0;
+    FILE* maps;
+    for (i = 0; i < num; i++)
+      totBytes += all[i]->size;
+    fprintf(f, "heap profile: 0: 0 [%zu: %zu] @ heap_v2/%zu\n",
+            num, totBytes, interval);
+    qsort(all, num, sizeof(*all), memSampleCmpStack);
+    for (i = 0; i < num; i = j) {
+      size_t bytes = 0;
+      int k;
+      for (j = i; j < num && memSampleCmpStack(&all[i], &all[j]) == 0; j++)
+        bytes += all[j]->size;
+      fprintf(f, "0: 0 [%zu: %zu] @", j - i, bytes);
+      for (k = 0; k < all[i]->nframes; k++)
+        fprintf(f, " %p", all[i]->frames[k]);
+      fprintf(f, "\n");
+    }
+    if ((maps = fopen("/proc/self/maps", "r")) != NULL) {
+      char line[4096];
+      fprintf(f, "\nMAPPED_LIBRARIES:\n");
+      while (fgets(line, sizeof(line), maps) != NULL)
+        fputs(line, f);
+      fclose(maps);
+    }
+    fclose(f);
+  }
+
+  sys_free(all);
+}
+
+
+//
+// Lightweight counters.
+//
+// Each thread counts the allocations and bytes allocated for each
+// descriptor, and the net change in live bytes, in a buffer of its own
+// that only it writes.  Those are read without stopping the writers
+// when the counters are reported, using relaxed atomic accesses, which
+// cost no more than plain ones.  The live byte change is folded into a
+// shared total once it reaches MEM_COUNT_FLUSH bytes either way, and
+// the high water mark is taken from that total, so it may be low by up
+// to MEM_COUNT_FLUSH bytes per thread.
+//
+// Live bytes are only known for blocks whose size will be known again
+// when they are freed, that is, arrays and, if the allocator can report
+// its block sizes, everything else.
+//
+#define MEM_COUNT_FLUSH ((int64_t) 1 << 20)
+
+typedef struct memCountBuf_s {
+  int64_t live;                     // net live bytes not yet flushed
+  int numDescs;
+  uint64_t* allocs;                 // by descriptor
+  uint64_t* bytes;                  // by descriptor
+  struct memCountBuf_s* next;       // on memCountBufs
+} memCountBuf_t;
+
+static CHPL_TLS_DECL(memCountBuf_t*, memCountBuf);
+static memCountBuf_t* memCountBufs = NULL;
+static pthread_mutex_t memCountBufsLock = PTHREAD_MUTEX_INITIALIZER;
+static int64_t memCountLive = 0;
+static int64_t memCountPeak = 0;
+
+
+static void memCountInit(void) {
+  CHPL_TLS_INIT(memCountBuf);
+  chpl_atomic_thread_fence(chpl_memory_order_release);
+  chpl_memCounters = chpl_env_rt_get_bool("MEM_COUNTERS", false);
+}
+
+
+static memCountBuf_t* memCountGetBuf(void) {
+  memCountBuf_t* buf = (memCountBuf_t*) CHPL_TLS_GET(memCountBuf);
+
+  if (buf == NULL) {
+    const int numDescs = CHPL_RT_MD_NUM + chpl_mem_numDescs;
+    if ((buf = (memCountBuf_t*) sys_calloc(1, sizeof(*buf))) == NULL)
+      return NULL;
+    buf->allocs = sys_calloc(2 * numDescs, sizeof(uint64_t));
+    if (buf->allocs == NULL) {
+      sys_free(buf);
+      return NULL;
+    }
+    buf->bytes = buf->allocs + numDescs;
+    buf->numDescs = numDescs;
+    CHPL_TLS_SET(memCountBuf, buf);
+
+    (void) pthread_mutex_lock(&memCountBufsLock);
+    buf->next = memCountBufs;
+    memCountBufs = buf;
+    (void) pthread_mutex_unlock(&memCountBufsLock);
+  }
+  return buf;
+}
+
+
+static inline void memCountAddLive(memCountBuf_t* buf, int64_t delta) {
+  int64_t live = buf->live + delta;
+
+  if (live >= MEM_COUNT_FLUSH || live <= -MEM_COUNT_FLUSH) {
+    int64_t now = __atomic_add_fetch(&memCountLive, live, __ATOMIC_RELAXED);
+    int64_t peak = __atomic_load_n(&memCountPeak, __ATOMIC_RELAXED);
+    while (now > peak
+           && !__atomic_compare_exchange_n(&memCountPeak, &peak, now, true,
+                                           __ATOMIC_RELAXED,
+                                           __ATOMIC_RELAXED))
+      ;
+    live = 0;
+  }
+  __atomic_store_n(&buf->live, live, __ATOMIC_RELAXED);
+}
+
+
+void chpl_memcount_alloc(size_t bytes, size_t live,
+                         chpl_mem_descInt_t description) {
+  memCountBuf_t* buf;
+
+  if ((buf = memCountGetBuf()) == NULL)
+    return;
+  if (description < 0 || description >= buf->numDescs)
+    description = CHPL_RT_MD_UNKNOWN;
+  __atomic_store_n(&buf->allocs[description], buf->allocs[description] + 1,
+                   __ATOMIC_RELAXED);
+  __atomic_store_n(&buf->bytes[description],
+                   buf->bytes[description] + bytes, __ATOMIC_RELAXED);
+  if (live != 0)
+    memCountAddLive(buf, (int64_t) live);
+}
+
+
+void chpl_memcount_free(size_t live) {
+  memCountBuf_t* buf;
+
+  if ((buf = memCountGetBuf()) == NULL)
+    return;
+  memCountAddLive(buf, -(int64_t) live);
+}
+
+
+// Merge the per-thread counters.  Returns the live byte count.
+static int64_t memCountMerge(uint64_t* allocs, uint64_t* bytes,
+                             int numDescs) {
+  memCountBuf_t* buf;
+  int64_t live = __atomic_load_n(&memCountLive, __ATOMIC_RELAXED);
+
+  (void) pthread_mutex_lock(&memCountBufsLock);
+  for (buf = memCountBufs; buf != NULL; buf = buf->next) {
+    live += __atomic_load_n(&buf->live, __ATOMIC_RELAXED);
+    for (int i = 0; allocs != NULL && i < numDescs; i++) {
+      allocs[i] += __atomic_load_n(&buf->allocs[i], __ATOMIC_RELAXED);
+      bytes[i] += __atomic_load_n(&buf->bytes[i], __ATOMIC_RELAXED);
+    }
+  }
+  (void) pthread_mutex_unlock(&memCountBufsLock);
+
+  // Blocks allocated before counting started can make this negative.
+  return (live < 0) ? 0 : live;
+}
+
+
+uint64_t chpl_memCountersHighWater(int32_t lineno, int32_t filename) {
+  int64_t live;
+  int64_t peak;
+
+  if (!chpl_memCounters) {
+    chpl_warning("invalid call to memCountersHighWater(); rerun with "
+                 "CHPL_RT_MEM_COUNTERS set",
+                 lineno, filename);
+    return 0;
+  }
+
+  live = memCountMerge(NULL, NULL, 0);
+  peak = __atomic_load_n(&memCountPeak, __ATOMIC_RELAXED);
+  return (uint64_t) ((live > peak) ? live : peak);
+}
+
+
+static int memCountCmp(const void* p1, const void* p2) {
+  const uint64_t b1 = ((const uint64_t*) p1)[1];
+  const uint64_t b2 = ((const uint64_t*) p2)[1];
+  return (b1 < b2) ? 1 : ((b1 > b2) ? -1 : 0);
+}
+
+
+void chpl_printMemCounters(int32_t lineno, int32_t filename) {
+  const int numDescs = CHPL_RT_MD_NUM + chpl_mem_numDescs;
+  const int nodeWidth = (int) lrint(ceil(log10((double) chpl_numNodes)));
+  char prefix[19 + nodeWidth + 1]; // room for "memCounters: node N"
+  uint64_t* counts;
+  uint64_t (*table)[3];
+  int64_t live;
+  int64_t peak;
+
+  if (!chpl_memCounters) {
+    chpl_warning("invalid call to printMemCounters(); rerun with "
+                 "CHPL_RT_MEM_COUNTERS set",
+                 lineno, filename);
+    return;
+  }
+
+  if (chpl_numNodes == 1) {
+    snprintf(prefix, sizeof(prefix), "memCounters:");
+  } else {
+    snprintf(prefix, sizeof(prefix), "memCounters: node %*d",
+             nodeWidth, chpl_nodeID);
+  }
+
+  counts = sys_calloc(2 * numDescs, sizeof(uint64_t));
+  table = sys_calloc(numDescs, sizeof(*table));
+  if (counts == NULL || table == NULL) {
+    sys_free(counts);
+    sys_free(table);
+    return;
+  }
+
+  live = memCountMerge(counts, counts + numDescs, numDescs);
+  peak = __atomic_load_n(&memCountPeak, __ATOMIC_RELAXED);
+  if (live > peak)
+    peak = live;
+
+  for (int i = 0; i < numDescs; i++) {
+    table[i][0] = counts[i];
+    table[i][1] = counts[numDescs + i];
+    table[i][2] = i;
+  }
+  qsort(table, numDescs, sizeof(*table), memCountCmp);
+
+  fprintf(memLogFile, "%s Live Bytes Now: %" PRId64 "\n", prefix, live);
+  fprintf(memLogFile, "%s Live Bytes High Water Mark: %" PRId64 "\n",
+          prefix, peak);
+  fprintf(memLogFile, "%s %-12s %-16s %s\n",
+          prefix, "Allocations", "Bytes", "Description");
+  for (int i = 0; i < numDescs; i++) {
+    if (table[i][0] == 0)
+      continue;
+    fprintf(memLogFile, "%s %-12" PRIu64 " %-16" PRIu64 " %s\n",
+            prefix, table[i][0], table[i][1],
+            chpl_mem_descString((chpl_mem_descInt_t) table[i][2]));
+  }
+
+  sys_free(counts);
+  sys_free(table);
+}
+
+
 void chpl_reportMemInfo(void) {
+  memSampleReport();
+
+  if (chpl_memCounters) {
+    chpl_printMemCounters(0, 0);
+  }
+
   if (memStats) {
     fprintf(memLogFile, "\n");
     chpl_printMemAllocStats(0, 0);
   }
   if (memLeaksByType) {
-    if (totalMem) {
+    if (__atomic_load_n(&totalMem, __ATOMIC_RELAXED)) {
       fprintf(memLogFile, "\n");
       printMemAllocsByType(true /* forLeaks */, 0, 0);
     }
   }
   if (memLeaksByDesc && strcmp(memLeaksByDesc, "")) {
-    if (totalMem) {
+    if (__atomic_load_n(&totalMem, __ATOMIC_RELAXED)) {
       fprintf(memLogFile, "\n");
       chpl_printMemAllocsByDesc(memLeaksByDesc, memThreshold, 0, 0);
     }
   }
   if (memLeaks) {
-    if (totalMem) {
+    if (__atomic_load_n(&totalMem, __ATOMIC_RELAXED)) {
       fprintf(memLogFile, "\n");
       printMemAllocs(-1, memThreshold, 0, 0);
     }
@@ -684,10 +1208,11 @@ void chpl_track_malloc(void* memAlloc, size_t number, size_t size,
   if (number * size > memThreshold) {
     c_sublocid_t subloc = chpl_task_getRequestedSubloc();
     if (chpl_memTrack && chpl_mem_descTrack(description)) {
-      memTrack_lock();
-      addMemTableEntry(memAlloc, number, size, subloc, description,
+      memTableShard* shard = memTrack_shard(memAlloc);
+      memTrack_lock(shard);
+      addMemTableEntry(shard, memAlloc, number, size, subloc, description,
                        lineno, filename);
-      memTrack_unlock();
+      memTrack_unlock(shard);
     }
     if (chpl_verbose_mem) {
       char subloc_info[16] = "";
@@ -717,8 +1242,9 @@ void chpl_track_free(void* memAlloc, size_t approximateSize, int32_t lineno,
     c_sublocid_t subloc = chpl_task_getRequestedSubloc();
     memTableEntry* memEntry = NULL;
     if (chpl_memTrack) {
-      memTrack_lock();
-      memEntry = removeMemTableEntry(memAlloc);
+      memTableShard* shard = memTrack_shard(memAlloc);
+      memTrack_lock(shard);
+      memEntry = removeMemTableEntry(shard, memAlloc);
       if (memEntry) {
         if (chpl_verbose_mem) {
           char subloc_info[16] = "";
@@ -732,7 +1258,7 @@ void chpl_track_free(void* memAlloc, size_t approximateSize, int32_t lineno,
         }
         sys_free(memEntry);
       }
-      memTrack_unlock();
+      memTrack_unlock(shard);
     } else if (chpl_verbose_mem && !memEntry) {
       char subloc_info[16] = "";
       chpl_track_gen_subloc_info(subloc_info, subloc);
@@ -750,14 +1276,13 @@ void chpl_track_realloc_pre(void* memAlloc, size_t size,
                          int32_t lineno, int32_t filename) {
   memTableEntry* memEntry = NULL;
 
-  if (chpl_memTrack && size > memThreshold) {
-    memTrack_lock();
-    if (memAlloc) {
-      memEntry = removeMemTableEntry(memAlloc);
-      if (memEntry)
-        sys_free(memEntry);
-    }
-    memTrack_unlock();
+  if (chpl_memTrack && size > memThreshold && memAlloc) {
+    memTableShard* shard = memTrack_shard(memAlloc);
+    memTrack_lock(shard);
+    memEntry = removeMemTableEntry(shard, memAlloc);
+    if (memEntry)
+      sys_free(memEntry);
+    memTrack_unlock(shard);
   }
 }
 
@@ -769,10 +1294,11 @@ void chpl_track_realloc_post(void* newMemAlloc,
   c_sublocid_t subloc = chpl_task_getRequestedSubloc();
   if (size > memThreshold) {
     if (chpl_memTrack && chpl_mem_descTrack(description)) {
-      memTrack_lock();
-      addMemTableEntry(newMemAlloc, 1, size, subloc,
+      memTableShard* shard = memTrack_shard(newMemAlloc);
+      memTrack_lock(shard);
+      addMemTableEntry(shard, newMemAlloc, 1, size, subloc,
                        description, lineno, filename);
-      memTrack_unlock();
+      memTrack_unlock(shard);
     }
     if (chpl_verbose_mem) {
       fprintf(memLogFile, "%" PRI_c_nodeid_t ": %s:%" PRId32
@@ -803,12 +1329,25 @@ void chpl_stopVerboseMemHere(void) {
   chpl_verbose_mem = 0;
 }
 
+//
+// These present the shards' buckets as one table, in shard order.  As
+// before, the caller is responsible for there being no concurrent
+// changes to the table while it walks it.
+//
 int chpl_memtable_size(void) {
-  return hashSize;
+  int size = 0;
+  for (int i = 0; i < NUM_MEM_TABLE_SHARDS; i++)
+    size += memShards[i].hashSize;
+  return size;
 }
 
 void* chpl_memtable_entry(int idx) {
-  return memTable[idx];
+  for (int i = 0; i < NUM_MEM_TABLE_SHARDS; i++) {
+    if (idx < memShards[i].hashSize)
+      return memShards[i].table[idx];
+    idx -= memShards[i].hashSize;
+  }
+  return NULL;
 }
 
 void* chpl_memtable_next_entry(void* entry) {
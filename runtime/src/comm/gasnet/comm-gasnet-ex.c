@@ -23,6 +23,7 @@
 #include "gasnet.h"
 #include "gasnet_vis.h"
 #include "gasnet_coll.h"
+#include "gasnet_ratomic.h"
 #include "chpl-comm.h"
 #include "chpl-comm-diags.h"
 #include "chpl-comm-callbacks.h"
@@ -32,6 +33,7 @@
 #include "chpl-env-gen.h"
 #include "chpl-exec.h"
 #include "chpl-mem.h"
+#include "chpl-mem-arena.h"
 #include "chplsys.h"
 #include "chpl-tasks.h"
 #include "chpl-topo.h"
@@ -60,6 +62,11 @@ static int reservedCore = -1;
 
 static chpl_bool defer_gasnet_progress_threads = false;
 
+// PUTs up to this size are initiated with GEX_FLAG_IMMEDIATE, backing
+// off (and yielding) rather than stalling in GASNet when resources are
+// short.
+static size_t immediate_put_max = 0;
+
 static gasnet_seginfo_t* seginfo_table = NULL;
 static uintptr_t segsize_request;
 static gex_Client_t      myclient;
@@ -223,14 +230,19 @@ typedef struct {
 } large_fork_task_t;
 
 typedef struct {
-  void*   ack;
+  void*      ack;   // acknowledgement object on our parent in the tree
+  c_nodeid_t root;  // node the broadcast started on
+} priv_bcast_hdr_t;
+
+typedef struct {
+  priv_bcast_hdr_t hdr;
   int     id;       // private broadcast table entry to update
   int     size;     // size of data
   char    data[0];  // data
 } priv_bcast_t;
 
 typedef struct {
-  void* ack;
+  priv_bcast_hdr_t hdr;
   int   id;       // private broadcast table entry to update
   int   size;     // size of data
   int   offset;   // offset of piece of data
@@ -257,6 +269,7 @@ typedef enum {
   FORK_NB_LARGE,        // non-blocking fork with a huge argument
   FORK_FAST,            // run the function in the handler (use with care)
   FORK_FAST_SMALL,      // run the function in the handler (use with care)
+  FORK_NB_BATCH,        // several coalesced non-blocking small forks
 
   SIGNAL,               // ack to a done_t via gasnet_AMReplyShortM()
   SIGNAL_LONG,          // ack to a done_t via gasnet_AMReplyLongM()
@@ -386,8 +399,8 @@ static void fork_large_wrapper(large_fork_task_t* f) {
   fid = lg->hdr.fid;
 
   // Allocate the bundle
-  arg = chpl_mem_allocMany(1, bundle_size_on_caller,
-                           CHPL_RT_MD_COMM_FRK_RCV_ARG, 0, 0);
+  arg = chpl_mem_arena_alloc(bundle_size_on_caller,
+                             CHPL_RT_MD_COMM_FRK_RCV_ARG, 0, 0);
 
   // GET the bundle data
   // TODO: This could get only the payload
@@ -401,7 +414,7 @@ static void fork_large_wrapper(large_fork_task_t* f) {
   GASNET_Safe(gasnet_AMRequestShort2(caller, SIGNAL, Arg0(ack), Arg1(ack)));
 
   // Free the bundle we just allocated.
-  chpl_mem_free(arg, 0, 0);
+  chpl_mem_arena_free(arg, 0, 0);
 }
 
 ////GASNET - can we send as much of user data as possible initially
@@ -436,10 +449,8 @@ static void AM_fork_nb(gasnet_token_t  token,
                            f->task_bundle.requestedSubloc, chpl_nullTaskID);
 }
 
-static void AM_fork_nb_small(gasnet_token_t  token,
-                             void           *buf,
-                             size_t          nbytes) {
-  small_fork_hdr_t *f = buf;
+static inline
+void start_fork_nb_small(small_fork_hdr_t *f, size_t nbytes) {
   small_fork_task_t task;
   chpl_comm_on_bundle_t *bptr = &task.bundle;
   size_t size;
@@ -452,6 +463,30 @@ static void AM_fork_nb_small(gasnet_token_t  token,
                            f->subloc, chpl_nullTaskID);
 }
 
+static void AM_fork_nb_small(gasnet_token_t  token,
+                             void           *buf,
+                             size_t          nbytes) {
+  start_fork_nb_small((small_fork_hdr_t*) buf, nbytes);
+}
+
+// Coalesced small forks are each a small_fork_hdr_t plus payload, with
+// the next one starting at the following 8-byte boundary.
+#define FORK_BATCH_ALIGN(n) (((n) + 7) & ~(size_t) 7)
+
+static void AM_fork_nb_batch(gasnet_token_t token, void* buf, size_t nbytes) {
+  char* p = (char*) buf;
+  char* end = p + nbytes;
+
+  while (p < end) {
+    special_fork_t tmp;
+    memcpy(&tmp.small, p, sizeof(small_fork_hdr_t));
+    size_t size = sizeof(small_fork_hdr_t) + tmp.small.payload_size;
+    memcpy(&tmp, p, size);
+    start_fork_nb_small(&tmp.small, size);
+    p += FORK_BATCH_ALIGN(size);
+  }
+}
+
 
 static void fork_nb_large_wrapper(large_fork_task_t* f) {
   large_fork_t *lg = &f->large;
@@ -467,8 +502,8 @@ static void fork_nb_large_wrapper(large_fork_task_t* f) {
   fid = lg->hdr.fid;
 
   // Allocate the bundle
-  arg = chpl_mem_allocMany(1, bundle_size_on_caller,
-                           CHPL_RT_MD_COMM_FRK_RCV_ARG, 0, 0);
+  arg = chpl_mem_arena_alloc(bundle_size_on_caller,
+                             CHPL_RT_MD_COMM_FRK_RCV_ARG, 0, 0);
 
   // GET the bundle data
   chpl_comm_get(arg, caller, arg_on_caller, bundle_size_on_caller,
@@ -483,7 +518,7 @@ static void fork_nb_large_wrapper(large_fork_task_t* f) {
   chpl_ftable_call(fid, arg);
 
   // Free the bundle we just allocated
-  chpl_mem_free(arg, 0, 0);
+  chpl_mem_arena_free(arg, 0, 0);
 }
 
 static void AM_fork_nb_large(gasnet_token_t token, void* buf, size_t nbytes) {
@@ -519,22 +554,138 @@ static void AM_signal_long(gasnet_token_t token, void *buf, size_t nbytes,
     done->flag = 1;
 }
 
+//
+// Private broadcasts are spread over a tree rooted at the broadcasting
+// node, with up to PRIV_BCAST_TREE_RADIX children per node.  A node
+// with children forwards the data to them from a task (AM handlers
+// can't initiate requests) and acks its parent only once its whole
+// subtree has acked, so the root just waits for its own children.
+//
+#define PRIV_BCAST_TREE_RADIX 8
+
+#define PRIV_BCAST_REL(root, node) \
+  (((node) - (root) + chpl_numNodes) % chpl_numNodes)
+#define PRIV_BCAST_NODE(root, rel) \
+  (((root) + (rel)) % chpl_numNodes)
+
+//
+// Return the number of children the given node has in the tree for a
+// broadcast from root, and the relative index of its first child.
+//
+static inline
+int priv_bcast_children(c_nodeid_t root, c_nodeid_t node,
+                        c_nodeid_t* firstRel) {
+  c_nodeid_t first = PRIV_BCAST_REL(root, node) * PRIV_BCAST_TREE_RADIX + 1;
+  if (first >= chpl_numNodes)
+    return 0;
+  *firstRel = first;
+  return (chpl_numNodes - first < PRIV_BCAST_TREE_RADIX)
+         ? chpl_numNodes - first
+         : PRIV_BCAST_TREE_RADIX;
+}
+
+static inline
+c_nodeid_t priv_bcast_parent(c_nodeid_t root, c_nodeid_t node) {
+  return PRIV_BCAST_NODE(root, (PRIV_BCAST_REL(root, node) - 1)
+                               / PRIV_BCAST_TREE_RADIX);
+}
+
+//
+// Send a private broadcast message to our children.  The message
+// header's ack must already point at an object expecting the replies.
+//
+static
+void priv_bcast_send_children(gex_AM_Index_t handler, void* msg,
+                              size_t msgSize) {
+  c_nodeid_t root = ((priv_bcast_hdr_t*) msg)->root;
+  c_nodeid_t firstRel;
+  int numChildren = priv_bcast_children(root, chpl_nodeID, &firstRel);
+  for (int i = 0; i < numChildren; i++) {
+    GASNET_Safe(gasnet_AMRequestMedium0(PRIV_BCAST_NODE(root, firstRel + i),
+                                        handler, msg, msgSize));
+  }
+}
+
+typedef struct {
+  chpl_comm_on_bundle_t bundle;
+  priv_bcast_hdr_t      hdr;     // as received from our parent
+  int                   id;
+  int                   size;
+  int                   offset;  // < 0 for a PRIV_BCAST message
+} priv_bcast_fwd_task_t;
+
+static void priv_bcast_fwd_wrapper(priv_bcast_fwd_task_t* t) {
+  c_nodeid_t root = t->hdr.root;
+  c_nodeid_t firstRel;
+  done_t done;
+
+  // Forward the data, which is already in our own table entry.
+  init_done_obj(&done, priv_bcast_children(root, chpl_nodeID, &firstRel));
+  if (t->offset < 0) {
+    size_t payloadSize = t->size + sizeof(priv_bcast_t);
+    priv_bcast_t* pbp = chpl_mem_allocMany(1, payloadSize, CHPL_RT_MD_COMM_PRV_BCAST_DATA, 0, 0);
+    pbp->hdr.ack = &done;
+    pbp->hdr.root = root;
+    pbp->id = t->id;
+    pbp->size = t->size;
+    chpl_memcpy(pbp->data, chpl_rt_priv_bcast_tab[t->id], t->size);
+    priv_bcast_send_children(PRIV_BCAST, pbp, payloadSize);
+    chpl_mem_free(pbp, 0, 0);
+  } else {
+    size_t payloadSize = t->size + sizeof(priv_bcast_large_t);
+    priv_bcast_large_t* pblp = chpl_mem_allocMany(1, payloadSize, CHPL_RT_MD_COMM_PRV_BCAST_DATA, 0, 0);
+    pblp->hdr.ack = &done;
+    pblp->hdr.root = root;
+    pblp->id = t->id;
+    pblp->size = t->size;
+    pblp->offset = t->offset;
+    chpl_memcpy(pblp->data, (char*)chpl_rt_priv_bcast_tab[t->id]+t->offset, t->size);
+    priv_bcast_send_children(PRIV_BCAST_LARGE, pblp, payloadSize);
+    chpl_mem_free(pblp, 0, 0);
+  }
+  wait_done_obj(&done, true);
+
+  // Our whole subtree has the data; tell our parent.
+  GASNET_Safe(gasnet_AMRequestShort2(priv_bcast_parent(root, chpl_nodeID),
+                                     SIGNAL,
+                                     Arg0(t->hdr.ack), Arg1(t->hdr.ack)));
+}
+
+//
+// Called by a private broadcast handler once it has stored the data.
+// Leaves ack right away; interior nodes start a task to forward.
+//
+static
+void priv_bcast_continue(gasnet_token_t token, priv_bcast_hdr_t* hdr,
+                         int id, int size, int offset) {
+  c_nodeid_t firstRel;
+  if (priv_bcast_children(hdr->root, chpl_nodeID, &firstRel) == 0) {
+    // Signal that the handler has completed
+    GASNET_Safe(gasnet_AMReplyShort2(token, SIGNAL,
+                                     Arg0(hdr->ack), Arg1(hdr->ack)));
+    return;
+  }
+
+  priv_bcast_fwd_task_t task = { .bundle = { .kind = CHPL_ARG_BUNDLE_KIND_COMM },
+                                 .hdr    = *hdr,
+                                 .id     = id,
+                                 .size   = size,
+                                 .offset = offset };
+  chpl_task_startMovedTask(FID_NONE, (chpl_fn_p)priv_bcast_fwd_wrapper,
+                           &task, sizeof(task),
+                           c_sublocid_none, chpl_nullTaskID);
+}
+
 static void AM_priv_bcast(gasnet_token_t token, void* buf, size_t nbytes) {
   priv_bcast_t* pbp = buf;
   chpl_memcpy(chpl_rt_priv_bcast_tab[pbp->id], pbp->data, pbp->size);
-
-  // Signal that the handler has completed
-  GASNET_Safe(gasnet_AMReplyShort2(token, SIGNAL,
-                                   Arg0(pbp->ack), Arg1(pbp->ack)));
+  priv_bcast_continue(token, &pbp->hdr, pbp->id, pbp->size, -1);
 }
 
 static void AM_priv_bcast_large(gasnet_token_t token, void* buf, size_t nbytes) {
   priv_bcast_large_t* pblp = buf;
   chpl_memcpy((char*)chpl_rt_priv_bcast_tab[pblp->id]+pblp->offset, pblp->data, pblp->size);
-
-  // Signal that the handler has completed
-  GASNET_Safe(gasnet_AMReplyShort2(token, SIGNAL,
-                                   Arg0(pblp->ack), Arg1(pblp->ack)));
+  priv_bcast_continue(token, &pblp->hdr, pblp->id, pblp->size, pblp->offset);
 }
 
 static void AM_free(gasnet_token_t token, gasnet_handlerarg_t a0, gasnet_handlerarg_t a1) {
@@ -582,6 +733,7 @@ static gex_AM_Entry_t ftable[] = {
   {FORK_NB_LARGE,    (gex_AM_Fn_t)AM_fork_nb_large,    GEX_FLAG_AM_REQUEST | GEX_FLAG_AM_MEDIUM, 0, NULL, "AM_fork_nb_large"    },
   {FORK_FAST,        (gex_AM_Fn_t)AM_fork_fast,        GEX_FLAG_AM_REQUEST | GEX_FLAG_AM_MEDIUM, 0, NULL, "AM_fork_fast"        },
   {FORK_FAST_SMALL,  (gex_AM_Fn_t)AM_fork_fast_small,  GEX_FLAG_AM_REQUEST | GEX_FLAG_AM_MEDIUM, 0, NULL, "AM_fork_fast_small"  },
+  {FORK_NB_BATCH,    (gex_AM_Fn_t)AM_fork_nb_batch,    GEX_FLAG_AM_REQUEST | GEX_FLAG_AM_MEDIUM, 0, NULL, "AM_fork_nb_batch"    },
   {SIGNAL,           (gex_AM_Fn_t)AM_signal,           GEX_FLAG_AM_REQREP  | GEX_FLAG_AM_SHORT,  2, NULL, "AM_signal"           },
   {SIGNAL_LONG,      (gex_AM_Fn_t)AM_signal_long,      GEX_FLAG_AM_REPLY   | GEX_FLAG_AM_LONG,   2, NULL, "AM_signal_long"      },
   {PRIV_BCAST,       (gex_AM_Fn_t)AM_priv_bcast,       GEX_FLAG_AM_REQUEST | GEX_FLAG_AM_MEDIUM, 0, NULL, "AM_priv_bcast"       },
@@ -738,7 +890,18 @@ int32_t chpl_comm_getMaxThreads(void) {
 // even though the tasking layer can implement it however it likes, as a
 // task or thread or whatever.
 //
-static volatile int pollingRunning;
+//
+// There can be more than one polling thread, so that AM handling (for
+// AM_fork and friends, especially) can keep up with heavy fan-in.  The
+// extras each get their own reserved core when progress cores are
+// dedicated.  Note that with more than one, the polling threads poll
+// concurrently instead of serializing through pollingLock; otherwise
+// there would be no point in having them.
+//
+#define MAX_POLLING_THREADS 8
+static int numPollingThreads = 1;
+static int pollingCores[MAX_POLLING_THREADS];
+static chpl_atomic_uint_least32_t pollingRunning;
 static volatile int pollingQuit;
 static chpl_bool pollingRequired = false;
 static chpl_atomic_spinlock_t pollingLock;
@@ -760,15 +923,180 @@ static inline void am_poll_try(void) {
 #endif
 }
 
+//
+// Wait for a non-blocking operation, letting other tasks run meanwhile
+// if we're configured to do that.
+//
+static inline
+void wait_event(gex_Event_t ev) {
+#ifndef CHPL_COMM_YIELD_TASK_WHILE_POLLING
+  gex_Event_Wait(ev);
+#else
+  while (gex_Event_Test(ev) != GASNET_OK) {
+    chpl_task_yield();
+  }
+#endif
+}
+
+//
+// A blocking PUT that won't stall inside GASNet waiting for resources.
+// If the PUT can't be initiated immediately we poll (and yield, if so
+// configured), doubling the number of rounds of that each time it fails
+// again, up to a limit.
+//
+#define IMMEDIATE_PUT_MAX_BACKOFF 64
+
+static inline
+void put_immediate(void* addr, c_nodeid_t node, void* raddr, size_t size) {
+  int backoff = 1;
+  while (gex_RMA_PutBlocking(myteam, node, raddr, addr, size,
+                             GEX_FLAG_IMMEDIATE) != 0) {
+    for (int i = 0; i < backoff; i++) {
+      am_poll_try();
+#ifdef CHPL_COMM_YIELD_TASK_WHILE_POLLING
+      chpl_task_yield();
+#endif
+    }
+    if (backoff < IMMEDIATE_PUT_MAX_BACKOFF) {
+      backoff *= 2;
+    }
+  }
+}
+
+//
+// Coalescing of non-blocking small forks.  When enabled, these are
+// packed into a per-destination buffer that is sent as a single
+// FORK_NB_BATCH AM when it fills up, when the polling thread finds it
+// has been waiting longer than the timeout, or at a barrier.  Enabling
+// this forces the polling thread to run, since nothing else would
+// guarantee that a partially full buffer is ever sent.
+//
+typedef struct {
+  chpl_atomic_spinlock_t lock;
+  size_t                 used;
+  uint64_t               first_ns;    // when the oldest entry was added
+  char*                  buf;
+} fork_coalesce_buf_t;
+
+static chpl_bool fork_coalesce = false;
+static uint64_t fork_coalesce_timeout_ns;
+static size_t fork_coalesce_buf_size;
+static fork_coalesce_buf_t* fork_coalesce_bufs;
+static chpl_atomic_uint_least32_t fork_coalesce_pending;
+
+#define FORK_COALESCE_MAX_BUF_SIZE 8192
+
+static inline
+uint64_t fork_coalesce_now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void setup_fork_coalesce(void) {
+  if (!fork_coalesce) return;
+
+  fork_coalesce_buf_size = gasnet_AMMaxMedium();
+  if (fork_coalesce_buf_size > FORK_COALESCE_MAX_BUF_SIZE) {
+    fork_coalesce_buf_size = FORK_COALESCE_MAX_BUF_SIZE;
+  }
+  fork_coalesce_bufs = (fork_coalesce_buf_t*)
+                       chpl_mem_allocManyZero(chpl_numNodes,
+                                              sizeof(*fork_coalesce_bufs),
+                                              CHPL_RT_MD_COMM_PER_LOC_INFO,
+                                              0, 0);
+  for (int i = 0; i < chpl_numNodes; i++) {
+    atomic_init_spinlock_t(&fork_coalesce_bufs[i].lock);
+  }
+  atomic_init_uint_least32_t(&fork_coalesce_pending, 0);
+}
+
+//
+// Send whatever is buffered for the given node.  If stale_ns is nonzero
+// only do so if the oldest entry has been waiting at least that long.
+//
+static void fork_coalesce_flush(c_nodeid_t node, uint64_t stale_ns) {
+  fork_coalesce_buf_t* b = &fork_coalesce_bufs[node];
+  char tmp[FORK_COALESCE_MAX_BUF_SIZE];
+  size_t used = 0;
+
+  atomic_lock_spinlock_t(&b->lock);
+  if (b->used > 0
+      && (stale_ns == 0
+          || fork_coalesce_now_ns() - b->first_ns >= stale_ns)) {
+    used = b->used;
+    memcpy(tmp, b->buf, used);
+    b->used = 0;
+    (void) atomic_fetch_sub_uint_least32_t(&fork_coalesce_pending, 1);
+  }
+  atomic_unlock_spinlock_t(&b->lock);
+
+  if (used > 0) {
+    GASNET_Safe(gasnet_AMRequestMedium0(node, FORK_NB_BATCH, tmp, used));
+  }
+}
+
+static void fork_coalesce_flush_all(uint64_t stale_ns) {
+  if (!fork_coalesce
+      || atomic_load_uint_least32_t(&fork_coalesce_pending) == 0) {
+    return;
+  }
+  for (int node = 0; node < chpl_numNodes; node++) {
+    if (fork_coalesce_bufs[node].used > 0) {
+      fork_coalesce_flush(node, stale_ns);
+    }
+  }
+}
+
+static void fork_coalesce_add(c_nodeid_t node, small_fork_hdr_t* f,
+                              size_t size) {
+  fork_coalesce_buf_t* b = &fork_coalesce_bufs[node];
+  const size_t ent_size = FORK_BATCH_ALIGN(size);
+
+  while (true) {
+    atomic_lock_spinlock_t(&b->lock);
+    if (b->buf == NULL) {
+      b->buf = chpl_mem_alloc(fork_coalesce_buf_size,
+                              CHPL_RT_MD_COMM_PER_LOC_INFO, 0, 0);
+    }
+    if (b->used + ent_size <= fork_coalesce_buf_size) {
+      break;
+    }
+    atomic_unlock_spinlock_t(&b->lock);
+    fork_coalesce_flush(node, 0);
+  }
+
+  if (b->used == 0) {
+    b->first_ns = fork_coalesce_now_ns();
+    (void) atomic_fetch_add_uint_least32_t(&fork_coalesce_pending, 1);
+  }
+  memcpy(b->buf + b->used, f, size);
+  b->used += ent_size;
+  chpl_bool full = (b->used + sizeof(special_fork_t) > fork_coalesce_buf_size);
+  atomic_unlock_spinlock_t(&b->lock);
+
+  if (full) {
+    fork_coalesce_flush(node, 0);
+  }
+}
+
 static void polling(void* x) {
-  pollingRunning = 1;
+  (void) atomic_fetch_add_uint_least32_t(&pollingRunning, 1);
 
   while (!pollingQuit) {
-    am_poll_try();
+    if (numPollingThreads > 1) {
+      (void) gasnet_AMPoll();
+    } else {
+      am_poll_try();
+    }
+    // Only the first polling thread sends stale coalesced forks.
+    if ((intptr_t) x == 0) {
+      fork_coalesce_flush_all(fork_coalesce_timeout_ns);
+    }
     chpl_task_yield();
   }
 
-  pollingRunning = 0;
+  (void) atomic_fetch_sub_uint_least32_t(&pollingRunning, 1);
 }
 
 static void setup_polling_pre_init(void) {
@@ -803,19 +1131,30 @@ static void setup_polling_post_init(void) {
 #else
   pollingRequired = true;
 #endif
+
+  fork_coalesce = chpl_env_rt_get_bool("COMM_GASNET_COALESCE_FORKS", false);
+  fork_coalesce_timeout_ns =
+    chpl_env_rt_get_int("COMM_GASNET_COALESCE_FORKS_TIMEOUT", 20) * 1000;
+  if (fork_coalesce) {
+    pollingRequired = true;
+  }
 }
 
 static void start_polling(void) {
   if (!pollingRequired) return;
 
-  pollingRunning = 0;
+  atomic_init_uint_least32_t(&pollingRunning, 0);
   pollingQuit = 0;
 
-  if (chpl_task_createCommTask(polling, NULL, reservedCore)) {
-    chpl_internal_error("unable to start external GASNet progress thread");
+  for (int i = 0; i < numPollingThreads; i++) {
+    if (chpl_task_createCommTask(polling, (void*) (intptr_t) i,
+                                 pollingCores[i])) {
+      chpl_internal_error("unable to start external GASNet progress thread");
+    }
   }
 
-  while (!pollingRunning) {
+  while (atomic_load_uint_least32_t(&pollingRunning)
+         < (uint_least32_t) numPollingThreads) {
     sched_yield();
   }
 }
@@ -826,7 +1165,7 @@ static void stop_polling(chpl_bool wait) {
   pollingQuit = 1;
 
   if (wait) {
-    while (pollingRunning) {
+    while (atomic_load_uint_least32_t(&pollingRunning) > 0) {
       sched_yield();
     }
   }
@@ -885,6 +1224,54 @@ static void set_num_comm_domains() {
 #endif
 }
 
+//
+// Atomic domains for the network atomics.  GASNet-EX only has these for
+// 32- and 64-bit types; see the network atomics interface, below, for
+// how we handle the others.
+//
+typedef enum {
+  ad_int32,
+  ad_uint32,
+  ad_int64,
+  ad_uint64,
+  ad_real32,
+  ad_real64,
+  ad_narrow,    // 32-bit words holding 8- and 16-bit atomics; never offloaded
+  ad_count
+} atomic_domain_idx_t;
+
+static gex_AD_t atomic_domains[ad_count];
+
+#define AD_REAL_OPS (GEX_OP_SET | GEX_OP_GET | GEX_OP_SWAP | GEX_OP_FCAS   \
+                     | GEX_OP_ADD | GEX_OP_FADD | GEX_OP_SUB | GEX_OP_FSUB \
+                     | GEX_OP_MIN | GEX_OP_FMIN | GEX_OP_MAX | GEX_OP_FMAX)
+#define AD_INT_OPS  (AD_REAL_OPS                                          \
+                     | GEX_OP_AND | GEX_OP_FAND | GEX_OP_OR | GEX_OP_FOR   \
+                     | GEX_OP_XOR | GEX_OP_FXOR)
+// No conduit offloads GEX_OP_MULT (ibv offloads no 32-bit type, and
+// ucx no MULT), so including it keeps this domain on GASNet-EX's
+// AM-based implementation, which does the ops with CPU atomics on the
+// target.  It is never actually used.
+#define AD_NARROW_OPS (GEX_OP_GET | GEX_OP_FCAS | GEX_OP_MULT)
+
+static void setup_atomic_domains(void) {
+  // gex_AD_Create() is collective over the team.
+  gex_AD_Create(&atomic_domains[ad_int32],  myteam, GEX_DT_I32, AD_INT_OPS,
+                GEX_NO_FLAGS);
+  gex_AD_Create(&atomic_domains[ad_uint32], myteam, GEX_DT_U32, AD_INT_OPS,
+                GEX_NO_FLAGS);
+  gex_AD_Create(&atomic_domains[ad_int64],  myteam, GEX_DT_I64, AD_INT_OPS,
+                GEX_NO_FLAGS);
+  gex_AD_Create(&atomic_domains[ad_uint64], myteam, GEX_DT_U64, AD_INT_OPS,
+                GEX_NO_FLAGS);
+  gex_AD_Create(&atomic_domains[ad_real32], myteam, GEX_DT_FLT, AD_REAL_OPS,
+                GEX_NO_FLAGS);
+  gex_AD_Create(&atomic_domains[ad_real64], myteam, GEX_DT_DBL, AD_REAL_OPS,
+                GEX_NO_FLAGS);
+  gex_AD_Create(&atomic_domains[ad_narrow], myteam, GEX_DT_U32, AD_NARROW_OPS,
+                GEX_NO_FLAGS);
+}
+
 void chpl_comm_init(int *argc_p, char ***argv_p) {
   // Initialize gasnet so that we can call gex_System_QueryHostInfo and
   // set the number of locales on our node which allows the rest of the
@@ -913,6 +1300,7 @@ void chpl_comm_init(int *argc_p, char ***argv_p) {
   setup_polling_pre_init();
 
   defer_gasnet_progress_threads = chpl_env_rt_get_bool("COMM_GASNET_DEFER_PROGRESS_THREADS", false);
+  immediate_put_max = chpl_env_rt_get_size("COMM_GASNET_IMMEDIATE_PUT_MAX", 512);
 
   gex_Flags_t flags = GEX_FLAG_USES_GASNET1 |
                       (defer_gasnet_progress_threads ? GEX_FLAG_DEFER_THREADS : 0);
@@ -933,10 +1321,25 @@ void chpl_comm_init(int *argc_p, char ***argv_p) {
 
 void chpl_comm_pre_mem_init(void) {
 
-  if (chpl_env_rt_get_bool("COMM_GASNET_DEDICATED_PROGRESS_CORE", false)) {
+  numPollingThreads = chpl_env_rt_get_int("COMM_GASNET_POLLING_THREADS", 1);
+  if (numPollingThreads < 1) {
+    numPollingThreads = 1;
+  } else if (numPollingThreads > MAX_POLLING_THREADS) {
+    numPollingThreads = MAX_POLLING_THREADS;
+  }
+
+  chpl_bool dedicated =
+    chpl_env_rt_get_bool("COMM_GASNET_DEDICATED_PROGRESS_CORE", false);
+  if (dedicated) {
     reservedCore = chpl_topo_reserveCPUPhysical();
   }
 
+  // The first polling thread shares the GASNet progress threads' core.
+  pollingCores[0] = reservedCore;
+  for (int i = 1; i < numPollingThreads; i++) {
+    pollingCores[i] = dedicated ? chpl_topo_reserveCPUPhysical() : -1;
+  }
+
   // Allocate and establish the GASNet shared memory segment
   // TODO: Should Chapel unconditionally request the largest available segment?
   segsize_request = gasnet_getMaxLocalSegmentSize();
@@ -990,6 +1393,7 @@ void chpl_comm_pre_mem_init(void) {
   gex_Event_Wait(gex_Coll_BroadcastNB(myteam, 0, seginfo_table, seginfo_table, sizeof(gasnet_seginfo_t), GEX_NO_FLAGS));
   chpl_comm_barrier("making sure everyone's done with the broadcast");
 #endif
+  setup_atomic_domains();
   gasnet_set_waitmode(GASNET_WAIT_BLOCK);
 }
 
@@ -1107,6 +1511,7 @@ static void start_gasnet_progress_threads(void) {
 }
 
 void chpl_comm_post_task_init(void) {
+  setup_fork_coalesce();
   start_polling();
   if (defer_gasnet_progress_threads) {
     start_gasnet_progress_threads();
@@ -1182,38 +1587,38 @@ wide_ptr_t* chpl_comm_broadcast_global_vars_helper(void) {
 }
 
 void chpl_comm_broadcast_private(int id, size_t size) {
-  int  node, offset;
+  int  offset;
   int  payloadSize = size + sizeof(priv_bcast_t);
-  done_t* done;
+  done_t done;
   int numOffsets=1;
+  c_nodeid_t firstRel;
+  int numChildren;
+
+  // We only send to our own children in the tree; their acks cover
+  // the rest of the nodes.
+  numChildren = priv_bcast_children(chpl_nodeID, chpl_nodeID, &firstRel);
+  if (numChildren == 0)
+    return;
 
-  // This can use the system allocator because it involves internode communication.
-  done = (done_t*) chpl_mem_allocManyZero(chpl_numNodes, sizeof(*done),
-                                          CHPL_RT_MD_COMM_FRK_DONE_FLAG,
-                                          0, 0);
   if (payloadSize <= gasnet_AMMaxMedium()) {
     priv_bcast_t* pbp = chpl_mem_allocMany(1, payloadSize, CHPL_RT_MD_COMM_PRV_BCAST_DATA, 0, 0);
     chpl_memcpy(pbp->data, chpl_rt_priv_bcast_tab[id], size);
+    pbp->hdr.ack = &done;
+    pbp->hdr.root = chpl_nodeID;
     pbp->id = id;
     pbp->size = size;
-    for (node = 0; node < chpl_numNodes; node++) {
-      if (node != chpl_nodeID) {
-        pbp->ack = &done[node];
-        init_done_obj(&done[node], 1);
-        GASNET_Safe(gasnet_AMRequestMedium0(node, PRIV_BCAST, pbp, payloadSize));
-      }
-    }
+    init_done_obj(&done, numChildren);
+    priv_bcast_send_children(PRIV_BCAST, pbp, payloadSize);
     chpl_mem_free(pbp, 0, 0);
   } else {
     size_t maxpayloadsize = gasnet_AMMaxMedium();
     size_t maxsize = maxpayloadsize - sizeof(priv_bcast_large_t);
     priv_bcast_large_t* pblp = chpl_mem_allocMany(1, maxpayloadsize, CHPL_RT_MD_COMM_PRV_BCAST_DATA, 0, 0);
+    pblp->hdr.ack = &done;
+    pblp->hdr.root = chpl_nodeID;
     pblp->id = id;
-    numOffsets = (size+maxsize)/maxsize;
-    for (node = 0; node < chpl_numNodes; node++) {
-      if (node != chpl_nodeID)
-        init_done_obj(&done[node], numOffsets);
-    }
+    numOffsets = (size+maxsize-1)/maxsize;
+    init_done_obj(&done, numChildren * numOffsets);
     for (offset = 0; offset < size; offset += maxsize) {
       size_t thissize = size - offset;
       if (thissize > maxsize)
@@ -1221,21 +1626,12 @@ void chpl_comm_broadcast_private(int id, size_t size) {
       pblp->offset = offset;
       pblp->size = thissize;
       chpl_memcpy(pblp->data, (char*)chpl_rt_priv_bcast_tab[id]+offset, thissize);
-      for (node = 0; node < chpl_numNodes; node++) {
-        if (node != chpl_nodeID) {
-          pblp->ack = &done[node];
-          GASNET_Safe(gasnet_AMRequestMedium0(node, PRIV_BCAST_LARGE, pblp, sizeof(priv_bcast_large_t)+thissize));
-        }
-      }
+      priv_bcast_send_children(PRIV_BCAST_LARGE, pblp, sizeof(priv_bcast_large_t)+thissize);
     }
     chpl_mem_free(pblp, 0, 0);
   }
-  // wait for the handlers to complete
-  for (node = 0; node < chpl_numNodes; node++) {
-    if (node != chpl_nodeID)
-      GASNET_BLOCKUNTIL(done[node].flag);
-  }
-  chpl_mem_free(done, 0, 0);
+  // wait for the subtrees to complete
+  GASNET_BLOCKUNTIL(done.flag);
 }
 
 void chpl_comm_impl_barrier(const char *msg) {
@@ -1251,6 +1647,11 @@ void chpl_comm_impl_barrier(const char *msg) {
   // satisfy; see chpl_comm.h.  This prevents us from monopolizing the
   // processor while waiting.
   //
+  // Send any coalesced forks first, since what we're synchronizing
+  // with might depend on them.
+  //
+  fork_coalesce_flush_all(0);
+
   gasnet_barrier_notify(id, 0);
   while ((retval = gasnet_barrier_try(id, 0)) == GASNET_ERR_NOT_READY) {
     chpl_task_yield();
@@ -1318,8 +1719,12 @@ void  chpl_comm_put(void* addr, c_nodeid_t node, void* raddr,
     if( remote_in_segment ) {
       // If it's in the remote segment, great, do a normal RMA Put.
       // GASNet will handle the local portion not being in the segment.
-      // TODO GEX convert to gex_RMA_PutNB with task-yield
-      gex_RMA_PutBlocking(myteam, node, raddr, addr, size, GEX_NO_FLAGS);
+      if (size <= immediate_put_max) {
+        put_immediate(addr, node, raddr, size);
+      } else {
+        wait_event(gex_RMA_PutNB(myteam, node, raddr, addr, size,
+                                 GEX_EVENT_DEFER, GEX_NO_FLAGS));
+      }
     } else {
       // If it's not in the remote segment, we need to send an
       // active message so that the other node will copy the data
@@ -1403,8 +1808,8 @@ void  chpl_comm_get(void* addr, c_nodeid_t node, void* raddr,
     if( remote_in_segment ) {
       // If it's in the remote segment, great, do a normal RMA Get.
       // GASNet will handle the local portion not being in the segment.
-      // TODO GEX convert to gex_RMA_GetNB with task-yield
-      gex_RMA_GetBlocking(myteam, addr, node, raddr, size, GEX_NO_FLAGS);
+      wait_event(gex_RMA_GetNB(myteam, addr, node, raddr, size,
+                               GEX_NO_FLAGS));
     } else {
       // If it's not in the remote segment, we need to send an
       // active message so that the other node will PUT back to us.
@@ -1525,8 +1930,9 @@ void  chpl_comm_get_strd(void* dstaddr, size_t* dststrides, c_nodeid_t srcnode_i
   }
 
   // TODO -- handle strided get for non-registered memory
-  // TODO GEX convert to NB with task-yield
-  gex_VIS_StridedGetBlocking(myteam, dstaddr, dststr, srcnode, srcaddr, srcstr, elemsz, cnt, strlvls, GEX_NO_FLAGS);
+  wait_event(gex_VIS_StridedGetNB(myteam, dstaddr, dststr, srcnode, srcaddr,
+                                  srcstr, elemsz, cnt, strlvls,
+                                  GEX_NO_FLAGS));
 }
 
 // See the comment for chpl_comm_get_strd().
@@ -1568,8 +1974,96 @@ void  chpl_comm_put_strd(void* dstaddr, size_t* dststrides, c_nodeid_t dstnode_i
   }
 
   // TODO -- handle strided put for non-registered memory
-  // TODO GEX convert to NB with task-yield
-  gex_VIS_StridedPutBlocking(myteam, dstnode, dstaddr, dststr, srcaddr, srcstr, elemsz, cnt, strlvls, GEX_NO_FLAGS);
+  wait_event(gex_VIS_StridedPutNB(myteam, dstnode, dstaddr, dststr, srcaddr,
+                                  srcstr, elemsz, cnt, strlvls,
+                                  GEX_NO_FLAGS));
+}
+
+// Non-blocking versions of the above.  GASNet-EX copies the stride and
+// count metadata at initiation, so our local arrays can go away as soon
+// as we return.
+chpl_comm_nb_handle_t chpl_comm_get_strd_nb(void* dstaddr, size_t* dststrides,
+                                            c_nodeid_t srcnode_id,
+                                            void* srcaddr, size_t* srcstrides,
+                                            size_t* count,
+                                            int32_t stridelevels,
+                                            size_t elemSize, int32_t commID,
+                                            int ln, int32_t fn) {
+  int i;
+  const size_t strlvls = (size_t)stridelevels;
+  const size_t strlvls_nz = strlvls == 0 ? 1 : strlvls;
+  const gasnet_node_t srcnode = (gasnet_node_t)srcnode_id;
+
+  ptrdiff_t dststr[strlvls_nz];
+  ptrdiff_t srcstr[strlvls_nz];
+  size_t cnt[strlvls_nz];
+  size_t elemsz = count[0] * elemSize;
+
+  for (i=0; i<strlvls; i++) {
+    srcstr[i] = srcstrides[i] * elemSize;
+    dststr[i] = dststrides[i] * elemSize;
+    cnt[i] = count[i+1];
+  }
+
+  if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_get_strd)) {
+    chpl_comm_cb_info_t cb_data =
+      {chpl_comm_cb_event_kind_get_strd, chpl_nodeID, srcnode_id,
+       .iu.comm_strd={srcaddr, srcstrides, dstaddr, dststrides, count,
+                      stridelevels, elemSize, commID, ln, fn}};
+    chpl_comm_do_callbacks (&cb_data);
+  }
+
+  chpl_comm_diags_verbose_rdmaStrd("get_nb", srcnode, ln, fn, commID);
+  if (chpl_nodeID != srcnode) {
+    chpl_comm_diags_incr(get_nb);
+  }
+
+  // TODO -- handle strided get for non-registered memory
+  return (chpl_comm_nb_handle_t)
+         gex_VIS_StridedGetNB(myteam, dstaddr, dststr, srcnode, srcaddr,
+                              srcstr, elemsz, cnt, strlvls, GEX_NO_FLAGS);
+}
+
+chpl_comm_nb_handle_t chpl_comm_put_strd_nb(void* dstaddr, size_t* dststrides,
+                                            c_nodeid_t dstnode_id,
+                                            void* srcaddr, size_t* srcstrides,
+                                            size_t* count,
+                                            int32_t stridelevels,
+                                            size_t elemSize, int32_t commID,
+                                            int ln, int32_t fn) {
+  int i;
+  const size_t strlvls = (size_t)stridelevels;
+  const size_t strlvls_nz = strlvls == 0 ? 1 : strlvls;
+  const gasnet_node_t dstnode = (gasnet_node_t)dstnode_id;
+
+  ptrdiff_t dststr[strlvls_nz];
+  ptrdiff_t srcstr[strlvls_nz];
+  size_t cnt[strlvls_nz];
+  size_t elemsz = count[0] * elemSize;
+
+  for (i=0; i<strlvls; i++) {
+    srcstr[i] = srcstrides[i] * elemSize;
+    dststr[i] = dststrides[i] * elemSize;
+    cnt[i] = count[i+1];
+  }
+
+  if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_put_strd)) {
+      chpl_comm_cb_info_t cb_data =
+        {chpl_comm_cb_event_kind_put_strd, chpl_nodeID, dstnode_id,
+         .iu.comm_strd={srcaddr, srcstrides, dstaddr, dststrides, count,
+                        stridelevels, elemSize, commID, ln, fn}};
+      chpl_comm_do_callbacks (&cb_data);
+  }
+
+  chpl_comm_diags_verbose_rdmaStrd("put_nb", dstnode, ln, fn, commID);
+  if (chpl_nodeID != dstnode) {
+    chpl_comm_diags_incr(put_nb);
+  }
+
+  // TODO -- handle strided put for non-registered memory
+  return (chpl_comm_nb_handle_t)
+         gex_VIS_StridedPutNB(myteam, dstnode, dstaddr, dststr, srcaddr,
+                              srcstr, elemsz, cnt, strlvls, GEX_NO_FLAGS);
 }
 
 #define MAX_UNORDERED_TRANS_SZ 1024
@@ -1687,8 +2181,12 @@ void  execute_on_common(c_nodeid_t node, c_sublocid_t subloc,
       // Copy in the payload
       memcpy(f + 1, arg + 1, payload_size);
 
-      // Send the AM
-      GASNET_Safe(gasnet_AMRequestMedium0(node, op, f, small_msg_size));
+      // Send the AM, or add it to the batch for this node
+      if (op == FORK_NB_SMALL && fork_coalesce) {
+        fork_coalesce_add(node, f, small_msg_size);
+      } else {
+        GASNET_Safe(gasnet_AMRequestMedium0(node, op, f, small_msg_size));
+      }
     } else {
       // Setup a small message pointing to arg
       // so the other side can GET from it
@@ -1810,3 +2308,281 @@ void  chpl_comm_execute_on_fast(c_nodeid_t node, c_sublocid_t subloc,
 }
 
 void chpl_comm_ensure_progress(void) { }
+
+
+////////////////////////////////////////
+//
+// Interface: network atomics
+//
+// These use the GASNet-EX atomic domains created at startup, which are
+// offloaded to the NIC on conduits whose hardware can do that and are
+// done by AM inside GASNet otherwise.  All AMOs go through an atomic
+// domain even when the target is on this node, so that they are
+// coherent with each other.
+//
+// GASNet-EX has no 8- or 16-bit atomic types, so for those we fetch
+// the aligned 32-bit word containing the target and then update it
+// with a compare-and-swap loop.  The CAS only succeeds if the whole
+// word is unchanged, so concurrent updates to neighboring bytes just
+// cause a retry.  Those neighboring bytes can also be written by plain
+// CPU stores, which a NIC's CAS may not be coherent with, so these go
+// through a domain of their own that is never offloaded (ad_narrow).
+//
+
+static inline
+gex_Flags_t amo_flags(chpl_memory_order order) {
+  switch (order) {
+  case chpl_memory_order_relaxed:
+    return GEX_NO_FLAGS;
+  case chpl_memory_order_consume:
+  case chpl_memory_order_acquire:
+    return GEX_FLAG_AD_ACQ;
+  case chpl_memory_order_release:
+    return GEX_FLAG_AD_REL;
+  default:
+    return GEX_FLAG_AD_ACQ | GEX_FLAG_AD_REL;
+  }
+}
+
+//
+// Do an AMO on a type GASNet-EX supports directly.  The _nbi variant is
+// for non-fetching unordered AMOs; those are completed by the unordered
+// task fence.
+//
+#define DEFN_AMO_NATIVE(fnType, Type, gexType, adIdx)                   \
+  static inline                                                         \
+  void amo_##fnType(c_nodeid_t node, void* object, gex_OP_t op,        \
+                    void* result, const void* opnd1, const void* opnd2, \
+                    gex_Flags_t flags) {                                \
+    Type o1 = 0, o2 = 0;                                                \
+    if (opnd1 != NULL) memcpy(&o1, opnd1, sizeof(Type));               \
+    if (opnd2 != NULL) memcpy(&o2, opnd2, sizeof(Type));               \
+    wait_event(gex_AD_OpNB_##gexType(atomic_domains[adIdx],            \
+                                     (Type*) result, (gex_Rank_t) node, \
+                                     object, op, o1, o2, flags));       \
+  }                                                                     \
+                                                                        \
+  static inline                                                         \
+  void amo_nbi_##fnType(c_nodeid_t node, void* object, gex_OP_t op,    \
+                        const void* opnd) {                             \
+    Type o1;                                                            \
+    memcpy(&o1, opnd, sizeof(Type));                                    \
+    (void) gex_AD_OpNBI_##gexType(atomic_domains[adIdx], NULL,         \
+                                  (gex_Rank_t) node, object, op,        \
+                                  o1, 0, GEX_NO_FLAGS);                 \
+  }
+
+DEFN_AMO_NATIVE(int32,  int32_t,  I32, ad_int32)
+DEFN_AMO_NATIVE(int64,  int64_t,  I64, ad_int64)
+DEFN_AMO_NATIVE(uint32, uint32_t, U32, ad_uint32)
+DEFN_AMO_NATIVE(uint64, uint64_t, U64, ad_uint64)
+DEFN_AMO_NATIVE(real32, _real32,  FLT, ad_real32)
+DEFN_AMO_NATIVE(real64, _real64,  DBL, ad_real64)
+
+//
+// Do an AMO on an 8- or 16-bit type, by CAS on the enclosing word.
+//
+#define DEFN_AMO_EMULATED(fnType, Type)                                 \
+  static                                                                \
+  void amo_##fnType(c_nodeid_t node, void* object, gex_OP_t op,        \
+                    void* result, const void* opnd1, const void* opnd2, \
+                    gex_Flags_t flags) {                                \
+    uint32_t* word = (uint32_t*) ((uintptr_t) object & ~(uintptr_t) 3); \
+    size_t off = (uintptr_t) object - (uintptr_t) word;                 \
+    Type o1 = 0, o2 = 0;                                                \
+    if (opnd1 != NULL) memcpy(&o1, opnd1, sizeof(Type));               \
+    if (opnd2 != NULL) memcpy(&o2, opnd2, sizeof(Type));               \
+                                                                        \
+    uint32_t oldWord;                                                   \
+    wait_event(gex_AD_OpNB_U32(atomic_domains[ad_narrow], &oldWord,    \
+                               (gex_Rank_t) node, word, GEX_OP_GET,     \
+                               0, 0, flags & GEX_FLAG_AD_ACQ));         \
+                                                                        \
+    Type cur;                                                           \
+    while (true) {                                                      \
+      memcpy(&cur, (char*) &oldWord + off, sizeof(Type));               \
+      Type val;                                                         \
+      switch (op) {                                                     \
+      case GEX_OP_GET:                                                  \
+        val = cur; break;                                               \
+      case GEX_OP_SET:                                                  \
+      case GEX_OP_SWAP:                                                 \
+        val = o1; break;                                                \
+      case GEX_OP_FCAS:                                                 \
+        val = (cur == o1) ? o2 : cur; break;                            \
+      case GEX_OP_AND:                                                  \
+      case GEX_OP_FAND:                                                 \
+        val = (Type) (cur & o1); break;                                 \
+      case GEX_OP_OR:                                                   \
+      case GEX_OP_FOR:                                                  \
+        val = (Type) (cur | o1); break;                                 \
+      case GEX_OP_XOR:                                                  \
+      case GEX_OP_FXOR:                                                 \
+        val = (Type) (cur ^ o1); break;                                 \
+      case GEX_OP_ADD:                                                  \
+      case GEX_OP_FADD:                                                 \
+        val = (Type) (cur + o1); break;                                 \
+      case GEX_OP_SUB:                                                  \
+      case GEX_OP_FSUB:                                                 \
+        val = (Type) (cur - o1); break;                                 \
+      case GEX_OP_MIN:                                                  \
+      case GEX_OP_FMIN:                                                 \
+        val = (o1 < cur) ? o1 : cur; break;                             \
+      case GEX_OP_MAX:                                                  \
+      case GEX_OP_FMAX:                                                 \
+        val = (o1 > cur) ? o1 : cur; break;                             \
+      default:                                                          \
+        chpl_internal_error("unexpected emulated AMO op");             \
+      }                                                                 \
+                                                                        \
+      if (val == cur && op != GEX_OP_SET && op != GEX_OP_SWAP) {        \
+        break; /* nothing to store */                                   \
+      }                                                                 \
+                                                                        \
+      uint32_t newWord = oldWord;                                       \
+      memcpy((char*) &newWord + off, &val, sizeof(Type));               \
+      uint32_t prevWord;                                                \
+      wait_event(gex_AD_OpNB_U32(atomic_domains[ad_narrow], &prevWord, \
+                                 (gex_Rank_t) node, word, GEX_OP_FCAS,  \
+                                 oldWord, newWord, flags));             \
+      if (prevWord == oldWord) {                                        \
+        break;                                                          \
+      }                                                                 \
+      oldWord = prevWord;                                               \
+    }                                                                   \
+                                                                        \
+    if (result != NULL) {                                               \
+      memcpy(result, &cur, sizeof(Type));                               \
+    }                                                                   \
+  }                                                                     \
+                                                                        \
+  static inline                                                         \
+  void amo_nbi_##fnType(c_nodeid_t node, void* object, gex_OP_t op,    \
+                        const void* opnd) {                             \
+    amo_##fnType(node, object, op, NULL, opnd, NULL, GEX_NO_FLAGS);    \
+  }
+
+DEFN_AMO_EMULATED(int8,   int8_t)
+DEFN_AMO_EMULATED(int16,  int16_t)
+DEFN_AMO_EMULATED(uint8,  uint8_t)
+DEFN_AMO_EMULATED(uint16, uint16_t)
+
+#define FOR_ALL_AMO_TYPES(M, ...)        \
+  M(int8,   int8_t,   ## __VA_ARGS__)    \
+  M(int16,  int16_t,  ## __VA_ARGS__)    \
+  M(int32,  int32_t,  ## __VA_ARGS__)    \
+  M(int64,  int64_t,  ## __VA_ARGS__)    \
+  M(uint8,  uint8_t,  ## __VA_ARGS__)    \
+  M(uint16, uint16_t, ## __VA_ARGS__)    \
+  M(uint32, uint32_t, ## __VA_ARGS__)    \
+  M(uint64, uint64_t, ## __VA_ARGS__)    \
+  M(real32, _real32,  ## __VA_ARGS__)    \
+  M(real64, _real64,  ## __VA_ARGS__)
+
+#define FOR_INT_AMO_TYPES(M, ...)        \
+  M(int8,   int8_t,   ## __VA_ARGS__)    \
+  M(int16,  int16_t,  ## __VA_ARGS__)    \
+  M(int32,  int32_t,  ## __VA_ARGS__)    \
+  M(int64,  int64_t,  ## __VA_ARGS__)    \
+  M(uint8,  uint8_t,  ## __VA_ARGS__)    \
+  M(uint16, uint16_t, ## __VA_ARGS__)    \
+  M(uint32, uint32_t, ## __VA_ARGS__)    \
+  M(uint64, uint64_t, ## __VA_ARGS__)
+
+#define DEFN_CHPL_COMM_ATOMIC_WRITE(fnType, Type)                       \
+  void chpl_comm_atomic_write_##fnType                                  \
+         (void* desired, c_nodeid_t node, void* object,                 \
+          chpl_memory_order order, int ln, int32_t fn) {                \
+    chpl_comm_diags_verbose_amo("amo write", node, ln, fn);             \
+    chpl_comm_diags_incr(amo);                                          \
+    amo_##fnType(node, object, GEX_OP_SET, NULL, desired, NULL,         \
+                 amo_flags(order));                                     \
+  }
+
+#define DEFN_CHPL_COMM_ATOMIC_READ(fnType, Type)                        \
+  void chpl_comm_atomic_read_##fnType                                   \
+         (void* result, c_nodeid_t node, void* object,                  \
+          chpl_memory_order order, int ln, int32_t fn) {                \
+    chpl_comm_diags_verbose_amo("amo read", node, ln, fn);              \
+    chpl_comm_diags_incr(amo);                                          \
+    amo_##fnType(node, object, GEX_OP_GET, result, NULL, NULL,          \
+                 amo_flags(order));                                     \
+  }
+
+#define DEFN_CHPL_COMM_ATOMIC_XCHG(fnType, Type)                        \
+  void chpl_comm_atomic_xchg_##fnType                                   \
+         (void* desired, c_nodeid_t node, void* object, void* result,   \
+          chpl_memory_order order, int ln, int32_t fn) {                \
+    chpl_comm_diags_verbose_amo("amo xchg", node, ln, fn);              \
+    chpl_comm_diags_incr(amo);                                          \
+    amo_##fnType(node, object, GEX_OP_SWAP, result, desired, NULL,      \
+                 amo_flags(order));                                     \
+  }
+
+#define DEFN_CHPL_COMM_ATOMIC_CMPXCHG(fnType, Type)                     \
+  void chpl_comm_atomic_cmpxchg_##fnType                                \
+         (void* expected, void* desired, c_nodeid_t node, void* object, \
+          chpl_bool32* result, chpl_memory_order succ,                  \
+          chpl_memory_order fail, int ln, int32_t fn) {                 \
+    chpl_comm_diags_verbose_amo("amo cmpxchg", node, ln, fn);           \
+    chpl_comm_diags_incr(amo);                                          \
+    Type old_value;                                                     \
+    Type old_expected;                                                  \
+    memcpy(&old_expected, expected, sizeof(Type));                      \
+    amo_##fnType(node, object, GEX_OP_FCAS, &old_value, &old_expected,  \
+                 desired, amo_flags(succ) | amo_flags(fail));           \
+    *result = (chpl_bool32)(old_value == old_expected);                 \
+    if (!*result) memcpy(expected, &old_value, sizeof(Type));           \
+  }
+
+#define DEFN_CHPL_COMM_ATOMIC_BINARY(fnType, Type, fnOp, gexOp, gexFOp)  \
+  void chpl_comm_atomic_##fnOp##_##fnType                               \
+         (void* opnd, c_nodeid_t node, void* object,                    \
+          chpl_memory_order order, int ln, int32_t fn) {                \
+    chpl_comm_diags_verbose_amo("amo " #fnOp, node, ln, fn);            \
+    chpl_comm_diags_incr(amo);                                          \
+    amo_##fnType(node, object, gexOp, NULL, opnd, NULL,                 \
+                 amo_flags(order));                                     \
+  }                                                                     \
+                                                                        \
+  void chpl_comm_atomic_##fnOp##_unordered_##fnType                     \
+         (void* opnd, c_nodeid_t node, void* object,                    \
+          int ln, int32_t fn) {                                         \
+    chpl_comm_diags_verbose_amo("amo unord_" #fnOp, node, ln, fn);      \
+    chpl_comm_diags_incr(amo);                                          \
+    amo_nbi_##fnType(node, object, gexOp, opnd);                        \
+  }                                                                     \
+                                                                        \
+  void chpl_comm_atomic_fetch_##fnOp##_##fnType                         \
+         (void* opnd, c_nodeid_t node, void* object, void* result,      \
+          chpl_memory_order order, int ln, int32_t fn) {                \
+    chpl_comm_diags_verbose_amo("amo fetch_" #fnOp, node, ln, fn);      \
+    chpl_comm_diags_incr(amo);                                          \
+    amo_##fnType(node, object, gexFOp, result, opnd, NULL,              \
+                 amo_flags(order));                                     \
+  }
+
+FOR_ALL_AMO_TYPES(DEFN_CHPL_COMM_ATOMIC_WRITE)
+FOR_ALL_AMO_TYPES(DEFN_CHPL_COMM_ATOMIC_READ)
+FOR_ALL_AMO_TYPES(DEFN_CHPL_COMM_ATOMIC_XCHG)
+FOR_ALL_AMO_TYPES(DEFN_CHPL_COMM_ATOMIC_CMPXCHG)
+
+FOR_INT_AMO_TYPES(DEFN_CHPL_COMM_ATOMIC_BINARY, and, GEX_OP_AND, GEX_OP_FAND)
+FOR_INT_AMO_TYPES(DEFN_CHPL_COMM_ATOMIC_BINARY, or,  GEX_OP_OR,  GEX_OP_FOR)
+FOR_INT_AMO_TYPES(DEFN_CHPL_COMM_ATOMIC_BINARY, xor, GEX_OP_XOR, GEX_OP_FXOR)
+FOR_ALL_AMO_TYPES(DEFN_CHPL_COMM_ATOMIC_BINARY, add, GEX_OP_ADD, GEX_OP_FADD)
+FOR_ALL_AMO_TYPES(DEFN_CHPL_COMM_ATOMIC_BINARY, sub, GEX_OP_SUB, GEX_OP_FSUB)
+FOR_ALL_AMO_TYPES(DEFN_CHPL_COMM_ATOMIC_BINARY, min, GEX_OP_MIN, GEX_OP_FMIN)
+FOR_ALL_AMO_TYPES(DEFN_CHPL_COMM_ATOMIC_BINARY, max, GEX_OP_MAX, GEX_OP_FMAX)
+
+void chpl_comm_atomic_unordered_task_fence(void) {
+  gex_NBI_Wait(GEX_EC_AMO, GEX_NO_FLAGS);
+}
+
+void chpl_comm_impl_unordered_task_fence(void) {
+  chpl_comm_atomic_unordered_task_fence();
+}
+
+void chpl_comm_impl_task_end(void) {
+  chpl_comm_atomic_unordered_task_fence();
+}
@@ -294,6 +294,32 @@ void  chpl_comm_get_strd(void* dstaddr_arg, size_t* dststrides, c_nodeid_t srcno
                   commID, ln, fn);
 }
 
+chpl_comm_nb_handle_t chpl_comm_put_strd_nb(void* dstaddr, size_t* dststrides,
+                                            c_nodeid_t dstnode,
+                                            void* srcaddr, size_t* srcstrides,
+                                            size_t* count,
+                                            int32_t stridelevels,
+                                            size_t elemSize, int32_t commID,
+                                            int ln, int32_t fn)
+{
+  chpl_comm_put_strd(dstaddr, dststrides, dstnode, srcaddr, srcstrides,
+                     count, stridelevels, elemSize, commID, ln, fn);
+  return NULL;
+}
+
+chpl_comm_nb_handle_t chpl_comm_get_strd_nb(void* dstaddr, size_t* dststrides,
+                                            c_nodeid_t srcnode,
+                                            void* srcaddr, size_t* srcstrides,
+                                            size_t* count,
+                                            int32_t stridelevels,
+                                            size_t elemSize, int32_t commID,
+                                            int ln, int32_t fn)
+{
+  chpl_comm_get_strd(dstaddr, dststrides, srcnode, srcaddr, srcstrides,
+                     count, stridelevels, elemSize, commID, ln, fn);
+  return NULL;
+}
+
 void chpl_comm_getput_unordered(c_nodeid_t dstnode, void* dstaddr,
                                 c_nodeid_t srcnode, void* srcaddr,
                                 size_t size, int32_t commID,
@@ -303,6 +303,42 @@ size_t chpl_comm_ofi_hp_gethugepagesize(void);
 chpl_bool chpl_comm_ofi_hp_supported(void);
 
 
+//
+// Shared-memory transport for co-locales
+//
+
+struct chpl_comm_ofi_shm_heap_t {
+  char* remoteStart;            // the heap's address in its own locale
+  char* localStart;             // where we have it mapped, or NULL
+  size_t size;
+};
+
+// by node, or NULL if no co-locale's heap is mapped
+extern struct chpl_comm_ofi_shm_heap_t* chpl_comm_ofi_shm_heaps;
+
+void* chpl_comm_ofi_shm_create_heap(size_t);
+void chpl_comm_ofi_shm_attach(void);
+void chpl_comm_ofi_shm_fini(void);
+
+//
+// Returns where [raddr, raddr + size) on 'node' is mapped here if it is
+// in the heap of a co-locale, or NULL if it has to be reached over the
+// network.
+//
+static inline
+void* chpl_comm_ofi_shm_addr(c_nodeid_t node, void* raddr, size_t size) {
+  struct chpl_comm_ofi_shm_heap_t* h;
+  if (chpl_comm_ofi_shm_heaps == NULL
+      || (h = &chpl_comm_ofi_shm_heaps[node])->localStart == NULL
+      || (char*) raddr < h->remoteStart
+      || size > h->size
+      || (size_t) ((char*) raddr - h->remoteStart) > h->size - size) {
+    return NULL;
+  }
+  return h->localStart + ((char*) raddr - h->remoteStart);
+}
+
+
 //
 // Other/utility
 //
@@ -0,0 +1,194 @@
+/*
+ * Copyright 2020-2026 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// PMIx-based out-of-band support for the OFI-based Chapel comm layer.
+//
+// Gathers use PMIx_Fence() with PMIX_COLLECT_DATA, so the server does a
+// single collective exchange and the PMIx_Get() calls that follow are
+// satisfied from the client's local copy of the job's data, rather
+// than each being a round trip to the server as with PMI2 KVS gets.
+// Values are byte objects, so unlike PMI2 they need neither encoding
+// nor chunking.
+//
+
+#include "chplrt.h"
+#include "chpl-env-gen.h"
+
+#include "chpl-comm.h"
+#include "chpl-mem.h"
+#include "chpl-mem-sys.h"
+#include "chpl-gen-includes.h"
+#include "chplsys.h"
+#include "error.h"
+
+#include <assert.h>
+#include <pmix.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "comm-ofi-internal.h"
+
+
+#define PMIX_CHK(expr) CHK_EQ_TYPED(expr, PMIX_SUCCESS, int, "d")
+
+static pmix_proc_t myProc;
+static pmix_proc_t allProcs;  // wildcard rank in our namespace
+
+
+static uint32_t get_job_uint32(const pmix_proc_t* proc, const char* key) {
+  pmix_value_t* val;
+  uint32_t ret;
+
+  PMIX_CHK(PMIx_Get(proc, key, NULL, 0, &val));
+  switch (val->type) {
+  case PMIX_UINT32: ret = val->data.uint32; break;
+  case PMIX_UINT16: ret = val->data.uint16; break;
+  default:
+    INTERNAL_ERROR_V("unexpected PMIx type %d for %s", (int) val->type, key);
+  }
+  PMIX_VALUE_RELEASE(val);
+  return ret;
+}
+
+
+void chpl_comm_ofi_oob_init(void) {
+  PMIX_CHK(PMIx_Init(&myProc, NULL, 0));
+
+  PMIX_PROC_CONSTRUCT(&allProcs);
+  memcpy(allProcs.nspace, myProc.nspace, sizeof(allProcs.nspace));
+  allProcs.rank = PMIX_RANK_WILDCARD;
+
+  chpl_nodeID = (c_nodeid_t) myProc.rank;
+  chpl_numNodes = (int32_t) get_job_uint32(&allProcs, PMIX_JOB_SIZE);
+
+  chpl_comm_oob = "PMIx";
+  DBG_PRINTF(DBG_OOB, "OOB %s init: node %" PRI_c_nodeid_t " of %" PRId32,
+             chpl_comm_oob, chpl_nodeID, chpl_numNodes);
+}
+
+
+void chpl_comm_ofi_oob_fini(void) {
+  if (PMIx_Initialized()) {
+    DBG_PRINTF(DBG_OOB, "OOB finalize");
+    PMIX_CHK(PMIx_Finalize(NULL, 0));
+  }
+}
+
+
+void chpl_comm_ofi_oob_barrier(void) {
+  DBG_PRINTF(DBG_OOB, "OOB barrier");
+  PMIX_CHK(PMIx_Fence(&allProcs, 1, NULL, 0));
+}
+
+
+//
+// Publish our value under key, then fence, collecting the data.
+//
+static void put_and_fence(const char* key, const void* mine, size_t size) {
+  if (mine != NULL) {
+    pmix_value_t val;
+    PMIX_VALUE_CONSTRUCT(&val);
+    val.type = PMIX_BYTE_OBJECT;
+    val.data.bo.bytes = (char*) mine;
+    val.data.bo.size = size;
+    PMIX_CHK(PMIx_Put(PMIX_GLOBAL, key, &val));
+  }
+  PMIX_CHK(PMIx_Commit());
+
+  pmix_info_t info;
+  bool collect = true;
+  PMIX_INFO_CONSTRUCT(&info);
+  PMIX_INFO_LOAD(&info, PMIX_COLLECT_DATA, &collect, PMIX_BOOL);
+  PMIX_CHK(PMIx_Fence(&allProcs, 1, &info, 1));
+  PMIX_INFO_DESTRUCT(&info);
+}
+
+
+static void get_from(int node, const char* key, void* buf, size_t size) {
+  pmix_proc_t proc;
+  pmix_value_t* val;
+
+  PMIX_PROC_CONSTRUCT(&proc);
+  memcpy(proc.nspace, myProc.nspace, sizeof(proc.nspace));
+  proc.rank = node;
+
+  PMIX_CHK(PMIx_Get(&proc, key, NULL, 0, &val));
+  CHK_TRUE(val->type == PMIX_BYTE_OBJECT && val->data.bo.size == size);
+  memcpy(buf, val->data.bo.bytes, size);
+  PMIX_VALUE_RELEASE(val);
+}
+
+
+void chpl_comm_ofi_oob_allgather(const void* mine, void* all, size_t size) {
+  DBG_PRINTF(DBG_OOB, "OOB allgather: %zd", size);
+
+  //
+  // PMIx values can't be replaced reliably once committed, so every
+  // collective gets a key of its own.
+  //
+  char key[PMIX_MAX_KEYLEN + 1];
+  static int key_cntr;
+  key_cntr++;
+  CHK_TRUE(snprintf(key, sizeof(key), "chpl.ag.%d", key_cntr)
+           < sizeof(key));
+
+  put_and_fence(key, mine, size);
+
+  for (int node = 0; node < chpl_numNodes; node++) {
+    if (node == chpl_nodeID) {
+      memcpy((char*) all + node * size, mine, size);
+    } else {
+      get_from(node, key, (char*) all + node * size, size);
+    }
+  }
+}
+
+
+void chpl_comm_ofi_oob_bcast(void* buf, size_t size) {
+  DBG_PRINTF(DBG_OOB, "OOB bcast: %zd", size);
+
+  char key[PMIX_MAX_KEYLEN + 1];
+  static int key_cntr;
+  key_cntr++;
+  CHK_TRUE(snprintf(key, sizeof(key), "chpl.bc.%d", key_cntr)
+           < sizeof(key));
+
+  put_and_fence(key, (chpl_nodeID == 0) ? buf : NULL, size);
+
+  if (chpl_nodeID != 0) {
+    get_from(0, key, buf, size);
+  }
+}
+
+
+int chpl_comm_ofi_oob_locales_on_node(int *rank) {
+  int count = (int) get_job_uint32(&allProcs, PMIX_LOCAL_SIZE);
+  if (rank != NULL) {
+    *rank = (int) get_job_uint32(&myProc, PMIX_LOCAL_RANK);
+  }
+  DBG_PRINTF(DBG_OOB, "PMIx OOB locales on node: %d", count);
+  if (rank != NULL) {
+    DBG_PRINTF(DBG_OOB, "PMIx OOB local rank: %d", *rank);
+  }
+  return count;
+}
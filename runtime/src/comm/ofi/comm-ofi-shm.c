@@ -0,0 +1,180 @@
+/*
+ * Copyright 2020-2026 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Shared-memory transport for co-locales in the OFI-based Chapel comm
+// layer.
+//
+// With CHPL_RT_COMM_OFI_SHM_COLOCALES set and more than one locale on a
+// node, a fixed heap on regular pages is created as a POSIX shared
+// memory object instead of private memory.  Once the comm layer is up,
+// every locale maps the heaps of the other locales on its node, after
+// which the objects are unlinked so that nothing is left behind in
+// /dev/shm.  PUTs and GETs whose remote side is in a mapped heap are
+// then copies, with no network traffic.  AMOs still go through the NIC,
+// since CPU atomics aren't atomic with respect to the NIC's.
+//
+
+#include "chplrt.h"
+
+#include "chpl-comm.h"
+#include "chpl-env.h"
+#include "comm-ofi-internal.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifndef HOST_NAME_MAX
+#define HOST_NAME_MAX 255
+#endif
+
+struct chpl_comm_ofi_shm_heap_t* chpl_comm_ofi_shm_heaps;
+
+static chpl_bool shmRequested;
+static char shmName[64];
+static void* shmStart;
+static size_t shmSize;
+
+struct shmInfo_t {
+  char host[HOST_NAME_MAX + 1];
+  char name[64];
+  void* start;
+  size_t size;
+};
+
+
+void* chpl_comm_ofi_shm_create_heap(size_t size) {
+  shmRequested = chpl_env_rt_get_bool("COMM_OFI_SHM_COLOCALES", false);
+  if (!shmRequested || chpl_get_num_locales_on_node() <= 1) {
+    return NULL;
+  }
+
+  snprintf(shmName, sizeof(shmName), "/chpl-heap-%d", (int) getpid());
+  int fd = shm_open(shmName, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+  if (fd < 0) {
+    return NULL;
+  }
+
+  //
+  // Reserve the space now.  /dev/shm is often smaller than memory, and
+  // running out later would mean a SIGBUS while touching the heap.
+  //
+  void* start = MAP_FAILED;
+  if (posix_fallocate(fd, 0, size) == 0) {
+    start = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  close(fd);
+  if (start == MAP_FAILED) {
+    shm_unlink(shmName);
+    return NULL;
+  }
+
+  shmStart = start;
+  shmSize = size;
+  return start;
+}
+
+
+void chpl_comm_ofi_shm_attach(void) {
+  //
+  // This is collective, so it depends only on the setting, which is the
+  // same everywhere, not on whether this locale made a shared heap.
+  //
+  if (!chpl_env_rt_get_bool("COMM_OFI_SHM_COLOCALES", false)) {
+    return;
+  }
+
+  struct shmInfo_t me;
+  memset(&me, 0, sizeof(me));
+  if (gethostname(me.host, sizeof(me.host) - 1) != 0) {
+    me.host[0] = '\0';
+  }
+  if (shmStart != NULL) {
+    strcpy(me.name, shmName);
+    me.start = shmStart;
+    me.size = shmSize;
+  }
+
+  struct shmInfo_t* all;
+  CHPL_CALLOC(all, chpl_numNodes);
+  chpl_comm_ofi_oob_allgather(&me, all, sizeof(me));
+
+  struct chpl_comm_ofi_shm_heap_t* heaps;
+  int numMapped = 0;
+  CHPL_CALLOC(heaps, chpl_numNodes);
+  for (int i = 0; i < chpl_numNodes; i++) {
+    if (i == chpl_nodeID || all[i].start == NULL || me.host[0] == '\0'
+        || strcmp(all[i].host, me.host) != 0) {
+      continue;
+    }
+    int fd = shm_open(all[i].name, O_RDWR, 0);
+    if (fd < 0) {
+      continue;
+    }
+    void* p = mmap(NULL, all[i].size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                   fd, 0);
+    close(fd);
+    if (p != MAP_FAILED) {
+      heaps[i].remoteStart = all[i].start;
+      heaps[i].localStart = p;
+      heaps[i].size = all[i].size;
+      numMapped++;
+    }
+  }
+  CHPL_FREE(all);
+
+  // everyone has mapped what they're going to, so the names can go
+  chpl_comm_ofi_oob_barrier();
+  if (shmStart != NULL) {
+    shm_unlink(shmName);
+  }
+
+  if (numMapped > 0) {
+    chpl_comm_ofi_shm_heaps = heaps;
+    if (verbosity >= 2) {
+      printf("COMM=ofi: locale %d reaches %d co-locale heap%s "
+             "through shared memory\n",
+             (int) chpl_nodeID, numMapped, (numMapped == 1) ? "" : "s");
+    }
+  } else {
+    CHPL_FREE(heaps);
+  }
+}
+
+
+void chpl_comm_ofi_shm_fini(void) {
+  struct chpl_comm_ofi_shm_heap_t* heaps = chpl_comm_ofi_shm_heaps;
+  if (heaps == NULL) {
+    return;
+  }
+  chpl_comm_ofi_shm_heaps = NULL;
+  for (int i = 0; i < chpl_numNodes; i++) {
+    if (heaps[i].localStart != NULL) {
+      (void) munmap(heaps[i].localStart, heaps[i].size);
+    }
+  }
+  CHPL_FREE(heaps);
+}
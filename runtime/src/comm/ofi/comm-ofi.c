@@ -47,6 +47,15 @@
 
 #include "comm-ofi-internal.h"
 
+//
+// With a real GPU runtime we can let the network read and write device
+// memory directly (GPUDirect RDMA and the like), if the provider can.
+//
+#if defined(HAS_GPU_LOCALE) && !defined(GPU_RUNTIME_CPU)
+#define CHPL_COMM_OFI_HMEM
+#include "chpl-gpu.h"
+#endif
+
 // Don't get warning macros for chpl_comm_get etc
 #include "chpl-comm-no-warning-macros.h"
 
@@ -111,9 +120,14 @@ int chpl_comm_ofi_abort_on_error;
 //
 // This is used as the API version to request in fi_getinfo(). We don't support
 // versions older than this and requesting an older version allows using
-// different versions at build and user compile time.
+// different versions at build and user compile time.  Registering device
+// memory (FI_HMEM, fi_mr_attr.iface) needs 1.10.
 //
+#ifdef CHPL_COMM_OFI_HMEM
+#define COMM_OFI_FI_VERSION FI_VERSION(1, 10)
+#else
 #define COMM_OFI_FI_VERSION FI_VERSION(1, 9)
+#endif
 
 
 ////////////////////////////////////////
@@ -134,14 +148,15 @@ number of endpoints the hardware can support vs. the number of
 threads). Some providers also support scalable endpoints, in which a
 single endpoint uses multiple transmit and/or receive contexts.
 Ignoring scalable endpoints for a moment, the transmit endpoints are
-stored in the table tciTab below. The receive endpoint is stored in a
-separate global variable ofi_rxEp. Each endpoint must have an
+stored in the table tciTab below. The receive endpoints, one per AM
+handler, are stored in a separate table rciTab. Each endpoint must have an
 associated address vector (AV) that contains the addresses for
 communication over that endpoint. For Chapel the addresses are the same
 for all endpoints, thus it is possible to share the same AV across all
 endpoints so as to reduce overhead. When a single AV is shared this way
 it is stored in ofi_av and all of the address vectors in the tciTab
-refer to this one as does ofi_rxAv.
+refer to this one as does ofi_rxAv, which is used by all the receive
+endpoints.
 
 When AVs are not shared between endpoints ofi_av is NULL and new address
 vectors are created for the entries in tciTab and ofi_rxAv.
@@ -151,23 +166,22 @@ and the tciTab entries are used to hold the state for the transmit
 contexts. All tciTab entries refer to ofi_av, even on platforms that do
 not support AV sharing, because there is only one(scalable) transmit
 endpoint. ofi_rxAv refers to ofi_av if AVs can be shared, otherwise it
-refers to its own AV.
+refers to its own AV. In the latter case we only support a single
+receive endpoint (and thus a single AM handler).
+
+Every node publishes the addresses of all of its receive endpoints, so
+the address tables have numRxCtxs entries per node. Each tx context
+always targets the same receive endpoint index on every remote node
+(rxIdx below), which spreads the incoming AM traffic over the handlers
+there while keeping the operations from any one tx context ordered.
 */
 
 static struct fid_av*   ofi_av = NULL;      // shared address vector
 static fi_addr_t*       ofi_addrs = NULL;   // remote endpoint addresses
-static struct fid_ep*   ofi_rxEp;           // receive endpoint
-static struct fid_cq*   ofi_rxCQ;           // receive endpoint CQ
-static struct fid_cntr* ofi_rxCntr;         // receive endpoint counter
-static uint64_t         ofi_rxCount;        // # messages already received.
-static void*            ofi_rxBuffer;       // receive buffer for new messages
-static void*            ofi_rxEnd;          // first byte after buffer
 static struct fid_av*   ofi_rxAv;           // address vector
 static fi_addr_t*       ofi_rxAddrs = NULL; // table of remote endpoint
                                             // addresses
 
-#define rxAddr(tcip, n) (tcip->addrs[n])
-
 //
 // Transmit support.
 //
@@ -181,12 +195,33 @@ static chpl_bool envUseAmRxCntr;        // env: AMH uses receive counters
 static chpl_bool envInjectRMA;          // env: inject RMA messages
 static chpl_bool envInjectAMO;          // env: inject AMO messages
 static chpl_bool envInjectAM;           // env: inject AM messages
+static chpl_bool envAmAggregation;      // env: aggregate small AM requests
+static double envAmAggregationTimeout;  // env: max AM aggregation delay (s)
+static int envExecOnLZSlots;            // env: large executeOn LZ slots
+static size_t envExecOnLZSlotSize;      // env: large executeOn LZ slot size
 static chpl_bool envUseDedicatedAmhCores;  // env: use dedicated AM cores
+static chpl_bool envProgressThread;     // env: use a progress thread
+static chpl_bool progressThreadRunning;  // progress thread is in use
 static const char* envExpectedProvider; // env: provider we should select
 
 static size_t numTxCtxs;
 static size_t numRxCtxs;
 
+struct perRxCtxInfo_t {
+  struct fid_ep* rxEp;          // receive endpoint
+  struct fid_cq* rxCQ;          // receive endpoint CQ
+  struct fid_cntr* rxCntr;      // receive endpoint counter
+  uint64_t rxCount;             // # messages already received.
+  void* rxBuffer;               // receive buffer for new messages
+  void* rxEnd;                  // first byte after buffer
+  void* amLZs[2];               // AM request landing zones
+  struct iovec iov_reqs[2];
+  struct fi_msg msg_reqs[2];
+  int msg_i;                    // landing zone currently being filled
+};
+
+static struct perRxCtxInfo_t* rciTab;
+
 struct perTxCtxInfo_t {
   chpl_atomic_bool allocated;        // true: in use; false: available
   chpl_bool bound;              // true: bound to an owner (usually a thread)
@@ -205,11 +240,40 @@ struct perTxCtxInfo_t {
   uint64_t numTxnsSent;         // number of transactions ever initiated
   void* putVisBitmap;           // nodes needing forced RMA store visibility
   void* amoVisBitmap;           // nodes needing forced AMO store visibility
+  int rxIdx;                    // remote receive endpoint index we target
+  chpl_atomic_bool progressLock; // bound ctx: held by owner or progress thd
 };
 
+//
+// With CHPL_RT_COMM_OFI_LAZY_AV set, remote addresses are only inserted
+// into the address vectors the first time a node is targeted, rather
+// than for every node at startup.  Entries not inserted yet are
+// FI_ADDR_NOTAVAIL, and the gathered names are kept until fini.
+//
+static chpl_bool envLazyAv;             // env: insert AV entries on demand
+static char* lazyAvNames;               // gathered [node][rx ep] names
+static size_t lazyAvNameLen;
+static pthread_mutex_t lazyAvLock = PTHREAD_MUTEX_INITIALIZER;
+
+static fi_addr_t lazyAvInsert(struct perTxCtxInfo_t*, c_nodeid_t);
+
+static inline
+fi_addr_t tciRxAddr(struct perTxCtxInfo_t* tcip, c_nodeid_t node) {
+  fi_addr_t addr = __atomic_load_n(&tcip->addrs[node * numRxCtxs
+                                                + tcip->rxIdx],
+                                   __ATOMIC_ACQUIRE);
+  if (addr == FI_ADDR_NOTAVAIL) {
+    addr = lazyAvInsert(tcip, node);
+  }
+  return addr;
+}
+
+#define rxAddr(tcip, n) tciRxAddr(tcip, n)
+
 static int tciTabLen;
 static struct perTxCtxInfo_t* tciTab;
 static chpl_bool tciTabBindTxCtxs;
+static chpl_atomic_uint_least32_t tciHomeNext; // next thread's home entry
 
 static size_t txCQLen;
 
@@ -237,6 +301,62 @@ static memTab_t* memTabMap;
 
 static struct fid_mr* ofiMrTab[MAX_MEM_REGIONS];
 
+//
+// Registration cache for local buffers outside the regions above.
+//
+struct mrCacheEntry {
+  char* addr;                   // page-aligned start, NULL if slot unused
+  size_t size;                  // page-aligned size (device: whole alloc)
+  struct fid_mr* mr;
+  void* desc;
+  uint64_t lastUse;             // LRU tick
+  int refs;                     // transactions currently using this
+  chpl_bool stale;              // memory freed; close when refs drops to 0
+};
+
+static int envMrCacheEntries;           // env: # registration cache entries
+static size_t envMrCacheMinSize;        // env: min size to cache
+static struct mrCacheEntry* mrCache;    // NULL if cache disabled
+static int mrCacheCount;                // # slots in use
+static uint64_t mrCacheTick;
+static uint64_t mrCacheNextKey = MAX_MEM_REGIONS;
+static pthread_mutex_t mrCacheLock = PTHREAD_MUTEX_INITIALIZER;
+
+//
+// Device memory as the local side of RMA.  The provider has to have
+// FI_HMEM, and we keep the registrations (of whole device allocations)
+// in the registration cache above.
+//
+static chpl_bool envDeviceRMA;          // env: use FI_HMEM if we can
+static chpl_bool haveDeviceRMA;         // we can
+
+//
+// Striping support.  On nodes with several NICs we can open a separate
+// "rail" (fabric, domain, endpoint) on each of the others, and split
+// large transfers between them and our primary, NUMA-nearest, NIC.
+// Small transfers always use the primary.
+//
+#define MAX_STRIPE_RAILS 8
+
+struct stripeRail_t {
+  struct fi_info* info;
+  struct fid_fabric* fabric;
+  struct fid_domain* domain;
+  struct fid_av* av;
+  struct fid_ep* ep;
+  struct fid_cq* cq;
+  fi_addr_t* addrs;             // remote endpoint addresses, per node
+  struct fid_mr* mrTab[MAX_MEM_REGIONS];
+  void* descTab[MAX_MEM_REGIONS];
+  uint64_t* keyMap;             // remote keys, [node][memTab index]
+  pthread_mutex_t lock;         // serializes use of ep and cq
+};
+
+static int envStripeNics;               // env: max # NICs to stripe over
+static size_t envStripeMinSize;         // env: min transfer size to stripe
+static struct stripeRail_t stripeRails[MAX_STRIPE_RAILS];
+static int numStripeRails;              // # rails besides the primary
+
 static chpl_bool  envUseCxiHybridMR;
 //
 // Messaging (AM) support.
@@ -251,20 +371,14 @@ struct amRequest_execOn_t {
 
 struct amRequest_execOnLrg_t {
   chpl_comm_on_bundle_t hdr;
-  void* pPayload;                 // addr of arg payload on initiator node
+  void* pPayload;                 // addr of arg payload on initiator node,
+                                  // or of LZ slot on target if pSlotFree
+  void* pSlotFree;                // initiator's LZ slot free flag, or NULL
 };
 
-#define NUM_AM_HANDLERS 1
-static int numAmHandlers = NUM_AM_HANDLERS;
-static int reservedCPUs[NUM_AM_HANDLERS];
-
-//
-// AM request landing zones.
-//
-static void* amLZs[2];
-static struct iovec ofi_iov_reqs[2];
-static struct fi_msg ofi_msg_reqs[2];
-static int ofi_msg_i;
+#define MAX_AM_HANDLERS 8
+static int numAmHandlers = 1;
+static int reservedCPUs[MAX_AM_HANDLERS];
 
 //
 // These are the major modes in which we can operate in order to
@@ -379,6 +493,7 @@ typedef struct nb_handle {
   chpl_bool reported;        // operation has been reported as complete
   chpl_atomic_bool complete; // operation has completed
   void *mrAddr;              // memory region address for unlocalizing
+  struct mrCacheEntry* mrEnt; // registration cache entry, if used
   void *addr;                // address corresponding to memory region
   size_t size;               // if > 0 then address is a target
   struct nb_handle *next;
@@ -398,6 +513,9 @@ static chpl_bool tciAllocTabEntry(struct perTxCtxInfo_t*);
 static void tciFree(struct perTxCtxInfo_t*);
 static void waitForCQSpace(struct perTxCtxInfo_t*, size_t);
 static void ofi_put(const void*, c_nodeid_t, void*, size_t);
+static void ofi_put_multi(const void*, size_t, int, const c_nodeid_t*,
+                          void* const*);
+#define PUT_MULTI_MAX 64
 static nb_handle_t ofi_put_nb(nb_handle_t, const void*, c_nodeid_t, void*,
                               size_t);
 static void ofi_put_lowLevel(const void*, void*, c_nodeid_t,
@@ -919,10 +1037,18 @@ chpl_comm_taskPrvData_t* get_comm_taskPrvdata(void) {
 #define MAX_CHAINED_PUT_LEN MAX_TXNS_IN_FLIGHT
 #define MAX_CHAINED_GET_LEN MAX_TXNS_IN_FLIGHT
 
+//
+// Size of an aggregated AM request (see amAggregate()), and the number
+// of destinations a task can aggregate AM requests for at once.
+//
+#define MAX_AM_AGG_LEN 2048
+#define MAX_AM_AGG_DESTS 8
+
 enum BuffType {
   amo_nf_buff = 1 << 0,
   get_buff    = 1 << 1,
-  put_buff    = 1 << 2
+  put_buff    = 1 << 2,
+  am_buff     = 1 << 3
 };
 
 // Per task information about non-fetching AMO buffers
@@ -964,6 +1090,21 @@ typedef struct {
   void*         local_mr_v[MAX_CHAINED_PUT_LEN];
 } put_buff_task_info_t;
 
+// Per task information about aggregated AM request buffers
+typedef struct {
+  c_nodeid_t    node;
+  int           cnt;              // number of requests in buf
+  size_t        len;              // bytes of requests after the header
+  uint64_t      buf[MAX_AM_AGG_LEN / sizeof(uint64_t)];
+} am_buff_dest_t;
+
+typedef struct {
+  chpl_bool       new;
+  int             vi;             // number of requests in all dests
+  double          firstTime;      // when the oldest request was buffered
+  am_buff_dest_t  dest_v[MAX_AM_AGG_DESTS];
+} am_buff_task_info_t;
+
 // Acquire a task local buffer, initializing if needed
 static inline
 void* task_local_buff_acquire(enum BuffType t) {
@@ -985,6 +1126,7 @@ void* task_local_buff_acquire(enum BuffType t) {
   DEFINE_INIT(amo_nf_buff_task_info_t, amo_nf_buff);
   DEFINE_INIT(get_buff_task_info_t, get_buff);
   DEFINE_INIT(put_buff_task_info_t, put_buff);
+  DEFINE_INIT(am_buff_task_info_t, am_buff);
 
 #undef DEFINE_INIT
   return NULL;
@@ -993,6 +1135,7 @@ void* task_local_buff_acquire(enum BuffType t) {
 static void amo_nf_buff_task_info_flush(amo_nf_buff_task_info_t* info);
 static void get_buff_task_info_flush(get_buff_task_info_t* info);
 static void put_buff_task_info_flush(put_buff_task_info_t* info);
+static void am_buff_task_info_flush(am_buff_task_info_t* info);
 
 // Flush one or more task local buffers
 static inline
@@ -1012,6 +1155,7 @@ void task_local_buff_flush(enum BuffType t) {
                amo_nf_buff_task_info_flush);
   DEFINE_FLUSH(get_buff_task_info_t, get_buff, get_buff_task_info_flush);
   DEFINE_FLUSH(put_buff_task_info_t, put_buff, put_buff_task_info_flush);
+  DEFINE_FLUSH(am_buff_task_info_t, am_buff, am_buff_task_info_flush);
 
 #undef DEFINE_FLUSH
 }
@@ -1036,6 +1180,7 @@ void task_local_buff_end(enum BuffType t) {
              amo_nf_buff_task_info_flush);
   DEFINE_END(get_buff_task_info_t, get_buff, get_buff_task_info_flush);
   DEFINE_END(put_buff_task_info_t, put_buff, put_buff_task_info_flush);
+  DEFINE_END(am_buff_task_info_t, am_buff, am_buff_task_info_flush);
 
 #undef END
 }
@@ -1060,6 +1205,10 @@ static void init_ofiForMem(void);
 static void init_ofiForRma(void);
 static void init_ofiForAms(void);
 static void init_ofiConnections(void);
+static void init_ofiExecOnLZs(void);
+static void init_ofiStripeRails(void);
+static void fini_ofiStripeRails(void);
+static void fini_ofiExecOnLZs(void);
 
 static void init_bar(void);
 
@@ -1109,6 +1258,16 @@ void chpl_comm_init(int *argc_p, char ***argv_p) {
   }
 
   envUseCxiHybridMR = chpl_env_rt_get_bool("COMM_OFI_CXI_HYBRID_MR", true);
+  envMrCacheEntries = chpl_env_rt_get_int("COMM_OFI_MR_CACHE_ENTRIES", 16);
+  envMrCacheMinSize = chpl_env_rt_get_size("COMM_OFI_MR_CACHE_MIN_SIZE",
+                                           (size_t) 64 << 10);
+  envDeviceRMA = chpl_env_rt_get_bool("COMM_OFI_DEVICE_RMA", true);
+  envStripeNics = chpl_env_rt_get_int("COMM_OFI_STRIPE_NICS", 1);
+  if (envStripeNics > MAX_STRIPE_RAILS + 1) {
+    envStripeNics = MAX_STRIPE_RAILS + 1;
+  }
+  envStripeMinSize = chpl_env_rt_get_size("COMM_OFI_STRIPE_MIN_SIZE",
+                                          (size_t) 1 << 20);
 
   // TODO: default to false to workaround non-blocking ofi issue
   // these should be changed back to true when that is fixed
@@ -1119,9 +1278,30 @@ void chpl_comm_init(int *argc_p, char ***argv_p) {
   }
   envInjectAMO = chpl_env_rt_get_bool("COMM_OFI_INJECT_AMO", false);
   envInjectAM = chpl_env_rt_get_bool("COMM_OFI_INJECT_AM", false);
+  envAmAggregation = chpl_env_rt_get_bool("COMM_OFI_AM_AGGREGATION", false);
+  envAmAggregationTimeout =
+    chpl_env_rt_get_int("COMM_OFI_AM_AGGREGATION_TIMEOUT", 100) * 1.0e-6;
+  envExecOnLZSlots = chpl_env_rt_get_int("COMM_OFI_EXEC_ON_LZ_SLOTS", 2);
+  envExecOnLZSlotSize = chpl_env_rt_get_size("COMM_OFI_EXEC_ON_LZ_SLOT_SIZE",
+                                             (size_t) 4 << 10);
 
   envUseDedicatedAmhCores = chpl_env_rt_get_bool(
                                   "COMM_OFI_DEDICATED_AMH_CORES", false);
+  envProgressThread = chpl_env_rt_get_bool("COMM_OFI_PROGRESS_THREAD", false);
+  envLazyAv = chpl_env_rt_get_bool("COMM_OFI_LAZY_AV", false);
+  numAmHandlers = chpl_env_rt_get_int("COMM_OFI_NUM_AM_HANDLERS", 1);
+  if (numAmHandlers < 1) {
+    numAmHandlers = 1;
+  } else if (numAmHandlers > MAX_AM_HANDLERS) {
+    numAmHandlers = MAX_AM_HANDLERS;
+    if (chpl_nodeID == 0) {
+      char msg[100];
+      snprintf(msg, sizeof(msg),
+               "CHPL_RT_COMM_OFI_NUM_AM_HANDLERS limited to %d",
+               MAX_AM_HANDLERS);
+      chpl_warning(msg, 0, 0);
+    }
+  }
   envExpectedProvider = chpl_env_rt_get("COMM_OFI_EXPECTED_PROVIDER", NULL);
   //
   // The user can specify the provider by setting either the Chapel
@@ -1204,6 +1384,7 @@ void chpl_comm_post_task_init(void) {
   if (chpl_numNodes == 1) {
     // We might need to create the heap even if there is only one locale.
     chpl_comm_regMemHeapInfo(NULL, NULL);
+    chpl_comm_regMemHeapTouchWait();
   } else {
     init_ofi();
     init_bar();
@@ -1234,8 +1415,11 @@ void init_ofi(void) {
 
   init_ofiExchangeAvInfo();
   init_ofiForMem();
+  chpl_comm_ofi_shm_attach();
+  init_ofiStripeRails();
   init_ofiForRma();
   init_ofiForAms();
+  init_ofiExecOnLZs();
 
   CHPL_CALLOC(orderDummy, 1);
   CHK_TRUE(mrGetDesc(&orderDummyMRDesc, orderDummy, sizeof(*orderDummy)));
@@ -1249,7 +1433,7 @@ void init_ofi(void) {
 
   DBG_PRINTF(DBG_CFG,
              "AM config: recv buf size %zd MiB, %s, responses use %s",
-             ofi_iov_reqs[ofi_msg_i].iov_len / (1L << 20),
+             rciTab[0].iov_reqs[0].iov_len / (1L << 20),
              "explicit polling",
              (tciTab[tciTabLen - 1].txCntr == NULL) ? "CQ" : "counter");
   if (ofi_txEpScal != NULL) {
@@ -1748,7 +1932,8 @@ chpl_bool canBindTxCtxs(struct fi_info* info) {
   size_t numWorkerTxCtxs = ((envPreferScalableTxEp
                           && dom_attr->max_ep_tx_ctx > 1)
                          ? dom_attr->max_ep_tx_ctx
-                         : epCount) - 1 - numAmHandlers;
+                         : epCount) - 1 - numAmHandlers
+                         - (numAmHandlers - 1); // extra rx endpoints
 
   if (envCommConcurrency > 0 && envCommConcurrency < numWorkerTxCtxs) {
     numWorkerTxCtxs = envCommConcurrency;
@@ -2113,6 +2298,32 @@ void init_ofiFabricDomain(void) {
                  { findDlvrCmpltProv, isDlvrCmpltProv, NULL }, };
   size_t capTryLen = sizeof(capTry) / sizeof(capTry[0]);
 
+#ifdef CHPL_COMM_OFI_HMEM
+  //
+  // If we might use it, first see if a good provider can also do
+  // RMA on device memory.  Don't settle for a less-good one to get that.
+  //
+  if (ofi_info == NULL && envDeviceRMA && chpl_numNodes > 1) {
+    struct fi_info* hmemHints = fi_dupinfo(hints);
+    hmemHints->caps |= FI_HMEM;
+    hmemHints->domain_attr->mr_mode |= FI_MR_HMEM;
+    for (int i = 0; ofi_info == NULL && i < capTryLen; i++) {
+      struct fi_info* info = NULL;
+      enum mcmMode_t mcmm;
+      if ((*capTry[i].fnFind)(&info, &mcmm, hmemHints,
+                              true /*inputIsHints*/)) {
+        ofi_info = info;
+        mcmMode = mcmm;
+      } else if (info != NULL) {
+        fi_freeinfo(info);
+      }
+    }
+    fi_freeinfo(hmemHints);
+    DBG_PRINTF_NODE0(DBG_PROV, "** %s provider with FI_HMEM",
+                     (ofi_info == NULL) ? "no" : "found");
+  }
+#endif
+
   if (ofi_info == NULL) {
     // Search for a good provider.
     for (int i = 0; ofi_info == NULL && i < capTryLen; i++) {
@@ -2215,12 +2426,17 @@ void init_ofiFabricDomain(void) {
 //
 // Reserve cores for the AM handler(s).
 //
+static int progressThreadCPU = -1;
+
 static
 void init_ofiReserveCores(void) {
   for (int i = 0; i < numAmHandlers; i++) {
     reservedCPUs[i] = envUseDedicatedAmhCores ?
       chpl_topo_reserveCPUPhysical() : -1;
   }
+  if (envProgressThread) {
+    progressThreadCPU = chpl_topo_reserveCPUPhysical();
+  }
 }
 
 
@@ -2540,12 +2756,36 @@ void init_ofiEp(void) {
     ofi_info->ep_attr->tx_ctx_cnt = numTxCtxs;
   }
 
-  CHK_TRUE(ofi_info->domain_attr->max_ep_rx_ctx >= numAmHandlers);
+  //
+  // Each AM handler has its own receive endpoint, and all of those
+  // have to share one AV.  If AVs can't be shared (EFA), fall back to
+  // a single AM handler.  The tx contexts set aside for the others
+  // then simply go to the workers.
+  //
+  if (numAmHandlers > 1 && providerInUse(provType_efa)) {
+    if (chpl_nodeID == 0) {
+      chpl_warning("multiple AM handlers need a shareable address vector; "
+                   "using 1", 0, 0);
+    }
+    numAmHandlers = 1;
+  }
+  if (numAmHandlers > 1
+      && (ofi_info->domain_attr->mr_mode & FI_MR_ENDPOINT) != 0) {
+    if (chpl_nodeID == 0) {
+      chpl_warning("multiple AM handlers are not supported with "
+                   "FI_MR_ENDPOINT; using 1", 0, 0);
+    }
+    numAmHandlers = 1;
+  }
+
+  CHK_TRUE(ofi_info->domain_attr->max_ep_rx_ctx >= 1);
   numRxCtxs = numAmHandlers;
+  CHPL_CALLOC(rciTab, numRxCtxs);
 
   tciTabLen = numTxCtxs;
   CHK_TRUE(tciTabLen > 0);
   CHPL_CALLOC(tciTab, tciTabLen);
+  atomic_init_uint_least32_t(&tciHomeNext, 0);
 
   // Use "hybrid" MR mode for the cxi provider if it's available
 
@@ -2589,7 +2829,8 @@ void init_ofiEp(void) {
   //
   struct fi_av_attr avAttr = (struct fi_av_attr)
                              { .type = FI_AV_TABLE,
-                               .count = chpl_numNodes * 2 /* AM, RMA+AMO */,
+                               .count = chpl_numNodes * numRxCtxs
+                                        * 2 /* AM, RMA+AMO */,
                                .name = NULL,
                                .rx_ctx_bits = 0, };
   if (provCtl_sizeAvsByNumEps) {
@@ -2697,22 +2938,26 @@ void init_ofiEp(void) {
              { .events = FI_CNTR_EVENTS_COMP,
                .wait_obj = FI_WAIT_UNSPEC, };
 
-  OFI_CHK(fi_endpoint(ofi_domain, ofi_info, &ofi_rxEp, NULL));
-  OFI_CHK(fi_ep_bind(ofi_rxEp, &ofi_rxAv->fid, 0));
-  OFI_CHK(fi_cq_open(ofi_domain, &cqAttr, &ofi_rxCQ, &ofi_rxCQ));
-  int cqFlags = FI_TRANSMIT | FI_RECV;
-  if (envUseAmRxCntr) {
-    DBG_PRINTF(DBG_TCIPS, "AM handler using rx completion counter");
-    OFI_CHK(fi_cntr_open(ofi_domain, &cntrAttr, &ofi_rxCntr, &ofi_rxCntr));
-    OFI_CHK(fi_ep_bind(ofi_rxEp, &ofi_rxCntr->fid, FI_RECV));
-    cqFlags |= FI_SELECTIVE_COMPLETION;
-  } else {
-    DBG_PRINTF(DBG_TCIPS, "AM handler using rx completion queue");
-  }
+  for (int i = 0; i < numRxCtxs; i++) {
+    struct perRxCtxInfo_t* rcip = &rciTab[i];
+    OFI_CHK(fi_endpoint(ofi_domain, ofi_info, &rcip->rxEp, NULL));
+    OFI_CHK(fi_ep_bind(rcip->rxEp, &ofi_rxAv->fid, 0));
+    OFI_CHK(fi_cq_open(ofi_domain, &cqAttr, &rcip->rxCQ, &rcip->rxCQ));
+    int cqFlags = FI_TRANSMIT | FI_RECV;
+    if (envUseAmRxCntr) {
+      DBG_PRINTF(DBG_TCIPS, "AM handler using rx completion counter");
+      OFI_CHK(fi_cntr_open(ofi_domain, &cntrAttr, &rcip->rxCntr,
+                           &rcip->rxCntr));
+      OFI_CHK(fi_ep_bind(rcip->rxEp, &rcip->rxCntr->fid, FI_RECV));
+      cqFlags |= FI_SELECTIVE_COMPLETION;
+    } else {
+      DBG_PRINTF(DBG_TCIPS, "AM handler using rx completion queue");
+    }
 
-  OFI_CHK(fi_ep_bind(ofi_rxEp, &ofi_rxCQ->fid, cqFlags));
+    OFI_CHK(fi_ep_bind(rcip->rxEp, &rcip->rxCQ->fid, cqFlags));
 
-  OFI_CHK(fi_enable(ofi_rxEp));
+    OFI_CHK(fi_enable(rcip->rxEp));
+  }
 }
 
 
@@ -2723,7 +2968,9 @@ void init_ofiEpTxCtx(int i, chpl_bool isAMHandler,
                      struct fi_cntr_attr* cntrAttr) {
   struct perTxCtxInfo_t* tcip = &tciTab[i];
   atomic_init_bool(&tcip->allocated, false);
+  atomic_init_bool(&tcip->progressLock, false);
   tcip->bound = false;
+  tcip->rxIdx = i % numRxCtxs;
 
   if (ofi_txEpScal == NULL) {
     //
@@ -2793,6 +3040,46 @@ void insertAddrs(struct fid_av* av, char *addrs, size_t numAddrs,
 }
 
 
+static
+void lazyAddrs(size_t numAddrs, fi_addr_t **fi_addrs_p) {
+  fi_addr_t *fi_addrs;
+  CHPL_CALLOC(fi_addrs, numAddrs);
+  for (size_t i = 0; i < numAddrs; i++) {
+    fi_addrs[i] = FI_ADDR_NOTAVAIL;
+  }
+  *fi_addrs_p = fi_addrs;
+}
+
+
+//
+// Insert all of a node's receive endpoints into tcip's address vector.
+// Several tx contexts can share an AV and its table, and the provider
+// may not serialize AV updates against other calls, so this is done
+// under a lock.
+//
+static
+fi_addr_t lazyAvInsert(struct perTxCtxInfo_t* tcip, c_nodeid_t node) {
+  fi_addr_t* entry = &tcip->addrs[node * numRxCtxs];
+
+  CHK_TRUE(lazyAvNames != NULL);
+  PTHREAD_CHK(pthread_mutex_lock(&lazyAvLock));
+  if (entry[tcip->rxIdx] == FI_ADDR_NOTAVAIL) {
+    fi_addr_t fi_addrs[numRxCtxs];
+    CHK_TRUE(fi_av_insert(tcip->av,
+                          lazyAvNames + node * numRxCtxs * lazyAvNameLen,
+                          numRxCtxs, fi_addrs, 0, NULL) == numRxCtxs);
+    DBG_PRINTF(DBG_CFG_AV, "lazy AV insert: node %d, %zd endpoint(s)",
+               (int) node, numRxCtxs);
+    for (size_t i = 0; i < numRxCtxs; i++) {
+      __atomic_store_n(&entry[i], fi_addrs[i], __ATOMIC_RELEASE);
+    }
+  }
+  PTHREAD_CHK(pthread_mutex_unlock(&lazyAvLock));
+
+  return entry[tcip->rxIdx];
+}
+
+
 static
 void init_ofiExchangeAvInfo(void) {
   //
@@ -2808,7 +3095,7 @@ void init_ofiExchangeAvInfo(void) {
     // Sanity-check our same-address-length assumption.
     //
     size_t len = 0;
-    OFI_CHK_1(fi_getname(&ofi_rxEp->fid, NULL, &len), -FI_ETOOSMALL);
+    OFI_CHK_1(fi_getname(&rciTab[0].rxEp->fid, NULL, &len), -FI_ETOOSMALL);
 
     size_t* lens;
     CHPL_CALLOC(lens, chpl_numNodes);
@@ -2824,11 +3111,21 @@ void init_ofiExchangeAvInfo(void) {
   char* addrs;
   size_t my_addr_len = 0;
 
-  OFI_CHK_1(fi_getname(&ofi_rxEp->fid, NULL, &my_addr_len), -FI_ETOOSMALL);
+  OFI_CHK_1(fi_getname(&rciTab[0].rxEp->fid, NULL, &my_addr_len),
+            -FI_ETOOSMALL);
 
-  CHPL_CALLOC_SZ(my_addr, my_addr_len, 1);
-  OFI_CHK(fi_getname(&ofi_rxEp->fid, my_addr, &my_addr_len));
-  CHPL_CALLOC_SZ(addrs, chpl_numNodes, my_addr_len);
+  //
+  // We publish the names of all our receive endpoints together, so the
+  // gathered table is laid out [node][rx endpoint].
+  //
+  CHPL_CALLOC_SZ(my_addr, numRxCtxs, my_addr_len);
+  for (int i = 0; i < numRxCtxs; i++) {
+    size_t len = my_addr_len;
+    OFI_CHK(fi_getname(&rciTab[i].rxEp->fid, my_addr + i * my_addr_len,
+                       &len));
+    CHK_TRUE(len == my_addr_len);
+  }
+  CHPL_CALLOC_SZ(addrs, chpl_numNodes * numRxCtxs, my_addr_len);
   if (DBG_TEST_MASK(DBG_CFG_AV)) {
     char nameBuf[128];
     size_t nameLen;
@@ -2838,7 +3135,7 @@ void init_ofiExchangeAvInfo(void) {
                (int) nameLen, nameBuf,
                (nameLen <= sizeof(nameBuf)) ? "" : "[...]");
   }
-  chpl_comm_ofi_oob_allgather(my_addr, addrs, my_addr_len);
+  chpl_comm_ofi_oob_allgather(my_addr, addrs, numRxCtxs * my_addr_len);
 
   //
   // Insert the addresses into the address vector and build up a vector
@@ -2850,9 +3147,16 @@ void init_ofiExchangeAvInfo(void) {
   // Only when the provider cannot support scalable EPs and we have
   // multiple actual endpoints are the AVs individualized to those.
   //
-  size_t numAddrs = chpl_numNodes;
+  // In lazy mode a separate receive-side AV is still filled in now,
+  // but the transmit-side AVs only get entries as nodes are targeted.
+  //
+  size_t numAddrs = chpl_numNodes * numRxCtxs;
   if (ofi_av != NULL) {
-    insertAddrs(ofi_av, addrs, numAddrs, &ofi_addrs);
+    if (envLazyAv) {
+      lazyAddrs(numAddrs, &ofi_addrs);
+    } else {
+      insertAddrs(ofi_av, addrs, numAddrs, &ofi_addrs);
+    }
   }
   if (ofi_rxAv != ofi_av) {
     insertAddrs(ofi_rxAv, addrs, numAddrs, &ofi_rxAddrs);
@@ -2861,6 +3165,8 @@ void init_ofiExchangeAvInfo(void) {
     if (ofi_av != NULL) {
       tciTab[i].av = ofi_av;
       tciTab[i].addrs = ofi_addrs;
+    } else if (envLazyAv) {
+      lazyAddrs(numAddrs, &tciTab[i].addrs);
     } else {
       insertAddrs(tciTab[i].av, addrs, numAddrs, &tciTab[i].addrs);
     }
@@ -2868,7 +3174,12 @@ void init_ofiExchangeAvInfo(void) {
     assert(tciTab[i].addrs != NULL);
   }
   CHPL_FREE(my_addr);
-  CHPL_FREE(addrs);
+  if (envLazyAv) {
+    lazyAvNames = addrs;
+    lazyAvNameLen = my_addr_len;
+  } else {
+    CHPL_FREE(addrs);
+  }
 }
 
 
@@ -2880,6 +3191,9 @@ void init_ofiForMem(void) {
   size_t fixedHeapSize;
   chpl_comm_impl_regMemHeapInfo(&fixedHeapStart, &fixedHeapSize);
 
+  // The background heap touch has to finish before we register.
+  chpl_comm_regMemHeapTouchWait();
+
   //
   // We default to scalable registration if none of the settings that
   // force basic registration are present, but the user can override
@@ -2945,7 +3259,7 @@ void init_ofiForMem(void) {
                       memTab[i].addr, memTab[i].size,
                       bufAcc, 0, (prov_key ? 0 : i), 0, &ofiMrTab[i], NULL));
     if ((ofi_info->domain_attr->mr_mode & FI_MR_ENDPOINT) != 0) {
-      OFI_CHK(fi_mr_bind(ofiMrTab[i], &ofi_rxEp->fid, 0));
+      OFI_CHK(fi_mr_bind(ofiMrTab[i], &rciTab[0].rxEp->fid, 0));
       OFI_CHK(fi_mr_enable(ofiMrTab[i]));
     }
     memTab[i].desc = fi_mr_desc(ofiMrTab[i]);
@@ -2963,6 +3277,27 @@ void init_ofiForMem(void) {
     CHPL_CALLOC(memTabMap, chpl_numNodes);
     chpl_comm_ofi_oob_allgather(&memTab, memTabMap, sizeof(memTabMap[0]));
   }
+
+  //
+  // With basic registration, local buffers outside the regions above
+  // have to be bounced.  For large ones, cache registrations instead.
+  // These are local-only, so we don't need to share them, but with
+  // FI_MR_ENDPOINT they'd also have to be bound, so skip that case.
+  //
+  if (!scalableMemReg
+      && envMrCacheEntries > 0
+      && (ofi_info->domain_attr->mr_mode & FI_MR_ENDPOINT) == 0) {
+    CHPL_CALLOC(mrCache, envMrCacheEntries);
+    DBG_PRINTF(DBG_MR, "MR cache: %d entries, min size %#zx",
+               envMrCacheEntries, envMrCacheMinSize);
+  }
+
+#ifdef CHPL_COMM_OFI_HMEM
+  haveDeviceRMA = (envDeviceRMA
+                   && mrCache != NULL
+                   && (ofi_info->caps & FI_HMEM) != 0);
+  DBG_PRINTF_NODE0(DBG_MR, "device RMA: %s", haveDeviceRMA ? "yes" : "no");
+#endif
 }
 
 
@@ -3100,19 +3435,199 @@ chpl_bool nextMemMapEntry(void** pAddr, size_t* pSize,
 }
 
 
-static int isAtomicValid(enum fi_datatype);
+//
+// Open a striping rail on each NIC, other than the primary one, that
+// the provider we chose offers.  Each rail registers the same memory
+// regions as the primary domain, so the same memTab index works for
+// locating a remote address on any rail; only the keys differ.
+//
+static
+chpl_bool openStripeRail(struct stripeRail_t* rail, struct fi_info* info) {
+  memset(rail, 0, sizeof(*rail));
+  rail->info = fi_dupinfo(info);
+  if (fi_fabric(info->fabric_attr, &rail->fabric, NULL) != FI_SUCCESS
+      || fi_domain(rail->fabric, info, &rail->domain, NULL) != FI_SUCCESS) {
+    DBG_PRINTF(DBG_CFG, "stripe rail %s: cannot open domain",
+               info->domain_attr->name);
+    if (rail->fabric != NULL) {
+      OFI_CHK(fi_close(&rail->fabric->fid));
+    }
+    fi_freeinfo(rail->info);
+    return false;
+  }
+
+  struct fi_av_attr avAttr = (struct fi_av_attr)
+                             { .type = FI_AV_TABLE,
+                               .count = chpl_numNodes, };
+  OFI_CHK(fi_av_open(rail->domain, &avAttr, &rail->av, NULL));
+  struct fi_cq_attr cqAttr = (struct fi_cq_attr)
+                             { .format = FI_CQ_FORMAT_CONTEXT,
+                               .size = info->tx_attr->size,
+                               .wait_obj = FI_WAIT_NONE, };
+  OFI_CHK(fi_cq_open(rail->domain, &cqAttr, &rail->cq, NULL));
+  OFI_CHK(fi_endpoint(rail->domain, info, &rail->ep, NULL));
+  OFI_CHK(fi_ep_bind(rail->ep, &rail->av->fid, 0));
+  OFI_CHK(fi_ep_bind(rail->ep, &rail->cq->fid, FI_TRANSMIT | FI_RECV));
+  OFI_CHK(fi_enable(rail->ep));
+
+  const chpl_bool prov_key =
+    ((info->domain_attr->mr_mode & FI_MR_PROV_KEY) != 0);
+  const uint64_t bufAcc = (FI_REMOTE_READ | FI_REMOTE_WRITE
+                           | FI_READ | FI_WRITE);
+  for (int i = 0; i < memTabCount; i++) {
+    OFI_CHK(fi_mr_reg(rail->domain,
+                      memTab[i].addr, memTab[i].size,
+                      bufAcc, 0, (prov_key ? 0 : i), 0, &rail->mrTab[i],
+                      NULL));
+    rail->descTab[i] = fi_mr_desc(rail->mrTab[i]);
+  }
+
+  PTHREAD_CHK(pthread_mutex_init(&rail->lock, NULL));
+  DBG_PRINTF(DBG_CFG, "stripe rail %s opened", info->domain_attr->name);
+  return true;
+}
+
 
 static
-void init_ofiForRma(void) {
+void closeStripeRail(struct stripeRail_t* rail) {
+  for (int i = 0; i < memTabCount; i++) {
+    OFI_CHK(fi_close(&rail->mrTab[i]->fid));
+  }
+  OFI_CHK(fi_close(&rail->ep->fid));
+  OFI_CHK(fi_close(&rail->cq->fid));
+  OFI_CHK(fi_close(&rail->av->fid));
+  OFI_CHK(fi_close(&rail->domain->fid));
+  OFI_CHK(fi_close(&rail->fabric->fid));
+  fi_freeinfo(rail->info);
+  if (rail->addrs != NULL) {
+    CHPL_FREE(rail->addrs);
+  }
+  if (rail->keyMap != NULL) {
+    CHPL_FREE(rail->keyMap);
+  }
+  PTHREAD_CHK(pthread_mutex_destroy(&rail->lock));
+}
+
+
+static
+void init_ofiStripeRails(void) {
+  if (envStripeNics <= 1 || chpl_numNodes <= 1) {
+    return;
+  }
+
+  //
+  // Rails complete PUTs with delivery-complete semantics, so that the
+  // parts of a striped PUT are all visible when it returns no matter
+  // what MCM mode the primary uses.  Keep this simple: no endpoint-
+  // bound MRs on the rails.
+  //
+  int numLocal = 0;
+  if ((ofi_info->domain_attr->mr_mode & FI_MR_ENDPOINT) == 0) {
+    struct fi_info* hints = fi_dupinfo(ofi_info);
+    free(hints->domain_attr->name);
+    hints->domain_attr->name = NULL;
+    free(hints->fabric_attr->name);
+    hints->fabric_attr->name = NULL;
+    hints->caps = FI_RMA | FI_READ | FI_WRITE
+                  | FI_REMOTE_READ | FI_REMOTE_WRITE;
+    hints->tx_attr->op_flags = FI_DELIVERY_COMPLETE;
+    hints->rx_attr->op_flags = 0;
+
+    struct fi_info* infoList = NULL;
+    int ret;
+    OFI_CHK_2(fi_getinfo(COMM_OFI_FI_VERSION, NULL, NULL, 0, hints,
+                         &infoList),
+              ret, -FI_ENODATA);
+    fi_freeinfo(hints);
+
+    for (struct fi_info* info = infoList;
+         info != NULL && numLocal < envStripeNics - 1;
+         info = info->next) {
+      chpl_bool seen =
+        (strcmp(info->domain_attr->name, ofi_info->domain_attr->name) == 0);
+      for (int i = 0; !seen && i < numLocal; i++) {
+        seen = (strcmp(info->domain_attr->name,
+                       stripeRails[i].info->domain_attr->name) == 0);
+      }
+      if (!seen && openStripeRail(&stripeRails[numLocal], info)) {
+        numLocal++;
+      }
+    }
+    if (infoList != NULL) {
+      fi_freeinfo(infoList);
+    }
+  }
+
   //
-  // We need to make an initial call to isAtomicValid() to let it
-  // initialize its internals.  The datatype here doesn't matter.
+  // Every node has to use the same number of rails.
   //
-  (void) isAtomicValid(FI_INT32);
+  int* numsLocal;
+  CHPL_CALLOC(numsLocal, chpl_numNodes);
+  chpl_comm_ofi_oob_allgather(&numLocal, numsLocal, sizeof(numLocal));
+  numStripeRails = numLocal;
+  for (int i = 0; i < chpl_numNodes; i++) {
+    if (numsLocal[i] < numStripeRails) {
+      numStripeRails = numsLocal[i];
+    }
+  }
+  CHPL_FREE(numsLocal);
+  for (int r = numStripeRails; r < numLocal; r++) {
+    closeStripeRail(&stripeRails[r]);
+  }
+
+  for (int r = 0; r < numStripeRails; r++) {
+    struct stripeRail_t* rail = &stripeRails[r];
+
+    size_t nameLen = 0;
+    OFI_CHK_1(fi_getname(&rail->ep->fid, NULL, &nameLen), -FI_ETOOSMALL);
+    char* myName;
+    char* names;
+    CHPL_CALLOC_SZ(myName, 1, nameLen);
+    CHPL_CALLOC_SZ(names, chpl_numNodes, nameLen);
+    OFI_CHK(fi_getname(&rail->ep->fid, myName, &nameLen));
+    chpl_comm_ofi_oob_allgather(myName, names, nameLen);
+    CHPL_CALLOC(rail->addrs, chpl_numNodes);
+    CHK_TRUE(fi_av_insert(rail->av, names, chpl_numNodes, rail->addrs, 0,
+                          NULL)
+             == chpl_numNodes);
+    CHPL_FREE(names);
+    CHPL_FREE(myName);
+
+    uint64_t myKeys[MAX_MEM_REGIONS] = { 0 };
+    for (int i = 0; i < memTabCount; i++) {
+      myKeys[i] = fi_mr_key(rail->mrTab[i]);
+    }
+    CHPL_CALLOC(rail->keyMap, chpl_numNodes * MAX_MEM_REGIONS);
+    chpl_comm_ofi_oob_allgather(myKeys, rail->keyMap, sizeof(myKeys));
+  }
+
+  if (numStripeRails > 0 && chpl_nodeID == 0 && verbosity >= 2) {
+    printf("COMM=ofi: striping transfers >= %zd bytes over %d NICs\n",
+           envStripeMinSize, numStripeRails + 1);
+  }
+}
+
+
+static
+void fini_ofiStripeRails(void) {
+  for (int r = 0; r < numStripeRails; r++) {
+    closeStripeRail(&stripeRails[r]);
+  }
+  numStripeRails = 0;
+}
+
+
+static void init_amoCaps(void);
+
+static
+void init_ofiForRma(void) {
+  init_amoCaps();
 }
 
 
 static void init_amHandling(void);
+static void init_progressThread(void);
+static void fini_progressThread(void);
 
 static
 void init_ofiForAms(void) {
@@ -3140,7 +3655,10 @@ void init_ofiForAms(void) {
                chpl_snprintf_KMG_z(buf, sizeof(buf), amLZSize), amLZSize);
 #endif
 
-  amLZSize /= 2;
+  //
+  // The total is divided among the AM handlers' receive endpoints.
+  //
+  amLZSize /= 2 * numRxCtxs;
 
   //
   // Set the minimum multi-receive buffer space.  Make it big enough to
@@ -3148,17 +3666,24 @@ void init_ofiForAms(void) {
   // than 10% of the buffer size.  Some providers don't have fi_setopt()
   // for some ep types, so allow this to fail in that case.  But note
   // that if it does fail and we get overruns we'll die or, worse yet,
-  // silently compute wrong results.
+  // silently compute wrong results.  Aggregated AM requests can be
+  // larger than any single one.
   //
   {
-    size_t sz = chpl_numNodes * tciTabLen * sizeof(struct amRequest_execOn_t);
+    size_t maxReqSize = sizeof(struct amRequest_execOn_t);
+    if (envAmAggregation && maxReqSize < MAX_AM_AGG_LEN) {
+      maxReqSize = MAX_AM_AGG_LEN;
+    }
+    size_t sz = chpl_numNodes * tciTabLen * maxReqSize;
     if (sz > amLZSize / 10) {
         sz = amLZSize / 10;
     }
     int ret;
-    OFI_CHK_2(fi_setopt(&ofi_rxEp->fid, FI_OPT_ENDPOINT,
-                        FI_OPT_MIN_MULTI_RECV, &sz, sizeof(sz)),
-              ret, -FI_ENOSYS);
+    for (int i = 0; i < numRxCtxs; i++) {
+      OFI_CHK_2(fi_setopt(&rciTab[i].rxEp->fid, FI_OPT_ENDPOINT,
+                          FI_OPT_MIN_MULTI_RECV, &sz, sizeof(sz)),
+                ret, -FI_ENOSYS);
+    }
     DBG_PRINTF(DBG_AM_BUF, "FI_OPT_MIN_MULTI_RECV %zd", sz);
   }
 
@@ -3187,41 +3712,39 @@ void init_ofiForAms(void) {
   // its arguments, so in either case there are no lingering dependencies on
   // the message buffer.
   //
-  CHPL_CALLOC_SZ(amLZs[0], 1, amLZSize);
-  CHPL_CALLOC_SZ(amLZs[1], 1, amLZSize);
-
-  ofi_iov_reqs[0] = (struct iovec) { .iov_base = amLZs[0],
-                                     .iov_len = amLZSize, };
-  ofi_iov_reqs[1] = (struct iovec) { .iov_base = amLZs[1],
-                                     .iov_len = amLZSize, };
-  ofi_msg_reqs[0] = (struct fi_msg) { .msg_iov = &ofi_iov_reqs[0],
-                                      .desc = NULL,
-                                      .iov_count = 1,
-                                      .addr = FI_ADDR_UNSPEC,
-                                      .context = txnTrkEncodeId(__LINE__),
-                                      .data = 0x0, };
-  ofi_msg_reqs[1] = (struct fi_msg) { .msg_iov = &ofi_iov_reqs[1],
-                                      .desc = NULL,
-                                      .iov_count = 1,
-                                      .addr = FI_ADDR_UNSPEC,
-                                      .context = txnTrkEncodeId(__LINE__),
-                                      .data = 0x0, };
-  ofi_rxCount = 0;
-  ofi_msg_i = 0;
-  ofi_rxBuffer = ofi_msg_reqs[0].msg_iov->iov_base;
-  ofi_rxEnd = (void *) ((char *) ofi_rxBuffer +
-              ofi_msg_reqs[0].msg_iov->iov_len);
-
-  for (int i = 0; i < 2; i++) {
-    memset(ofi_msg_reqs[i].msg_iov->iov_base, '\0',
-           ofi_msg_reqs[i].msg_iov->iov_len);
-    OFI_CHK(fi_recvmsg(ofi_rxEp, &ofi_msg_reqs[i], FI_MULTI_RECV));
-    DBG_PRINTF(DBG_AM_BUF,
-             "post fi_recvmsg(AMLZs %p, len %#zx)",
-              ofi_msg_reqs[i].msg_iov->iov_base,
-              ofi_msg_reqs[i].msg_iov->iov_len);
+  for (int r = 0; r < numRxCtxs; r++) {
+    struct perRxCtxInfo_t* rcip = &rciTab[r];
+
+    for (int i = 0; i < 2; i++) {
+      CHPL_CALLOC_SZ(rcip->amLZs[i], 1, amLZSize);
+      rcip->iov_reqs[i] = (struct iovec) { .iov_base = rcip->amLZs[i],
+                                           .iov_len = amLZSize, };
+      rcip->msg_reqs[i] = (struct fi_msg)
+                          { .msg_iov = &rcip->iov_reqs[i],
+                            .desc = NULL,
+                            .iov_count = 1,
+                            .addr = FI_ADDR_UNSPEC,
+                            .context = txnTrkEncodeId(__LINE__),
+                            .data = 0x0, };
+    }
+    rcip->rxCount = 0;
+    rcip->msg_i = 0;
+    rcip->rxBuffer = rcip->msg_reqs[0].msg_iov->iov_base;
+    rcip->rxEnd = (void *) ((char *) rcip->rxBuffer +
+                  rcip->msg_reqs[0].msg_iov->iov_len);
+
+    for (int i = 0; i < 2; i++) {
+      memset(rcip->msg_reqs[i].msg_iov->iov_base, '\0',
+             rcip->msg_reqs[i].msg_iov->iov_len);
+      OFI_CHK(fi_recvmsg(rcip->rxEp, &rcip->msg_reqs[i], FI_MULTI_RECV));
+      DBG_PRINTF(DBG_AM_BUF,
+               "post fi_recvmsg(rx %d AMLZs %p, len %#zx)",
+                r, rcip->msg_reqs[i].msg_iov->iov_base,
+                rcip->msg_reqs[i].msg_iov->iov_len);
+    }
   }
   init_amHandling();
+  init_progressThread();
 }
 
 
@@ -3343,12 +3866,27 @@ void init_broadcast_private(void) {
 void chpl_comm_broadcast_private(int id, size_t size) {
   DBG_PRINTF(DBG_IFACE_SETUP, "%s(%d, %zd)", __func__, id, size);
 
+  //
+  // Overlap the PUTs in batches rather than doing them one at a time,
+  // so that broadcast time on large jobs is bounded by injection rate
+  // rather than by the sum of the round trip latencies.
+  //
+  c_nodeid_t nodes[PUT_MULTI_MAX];
+  void* raddrs[PUT_MULTI_MAX];
+  int n = 0;
   for (int i = 0; i < chpl_numNodes; i++) {
     if (i != chpl_nodeID) {
-      (void) ofi_put(chpl_rt_priv_bcast_tab[id], i,
-                     chplPrivBcastTabMap[i][id], size);
+      nodes[n] = i;
+      raddrs[n] = chplPrivBcastTabMap[i][id];
+      if (++n == PUT_MULTI_MAX) {
+        ofi_put_multi(chpl_rt_priv_bcast_tab[id], size, n, nodes, raddrs);
+        n = 0;
+      }
     }
   }
+  if (n > 0) {
+    ofi_put_multi(chpl_rt_priv_bcast_tab[id], size, n, nodes, raddrs);
+  }
 }
 
 
@@ -3378,6 +3916,7 @@ void chpl_comm_pre_task_exit(int all) {
     }
 
     chpl_comm_barrier("chpl_comm_pre_task_exit");
+    fini_progressThread();
     fini_amHandling();
   }
 }
@@ -3426,6 +3965,8 @@ void fini_ofi(void) {
   if (chpl_numNodes <= 1)
     return;
 
+  chpl_comm_ofi_shm_fini();
+
   for (int i = 0; i < memTabCount; i++) {
     OFI_CHK(fi_close(&ofiMrTab[i]->fid));
   }
@@ -3434,10 +3975,21 @@ void fini_ofi(void) {
     CHPL_FREE(memTabMap);
   }
 
-  OFI_CHK(fi_close(&ofi_rxEp->fid));
-  OFI_CHK(fi_close(&ofi_rxCQ->fid));
-  if (ofi_rxCntr != NULL) {
-    OFI_CHK(fi_close(&ofi_rxCntr->fid));
+  if (mrCache != NULL) {
+    for (int i = 0; i < envMrCacheEntries; i++) {
+      if (mrCache[i].addr != NULL) {
+        OFI_CHK(fi_close(&mrCache[i].mr->fid));
+      }
+    }
+    CHPL_FREE(mrCache);
+  }
+
+  for (int i = 0; i < numRxCtxs; i++) {
+    OFI_CHK(fi_close(&rciTab[i].rxEp->fid));
+    OFI_CHK(fi_close(&rciTab[i].rxCQ->fid));
+    if (rciTab[i].rxCntr != NULL) {
+      OFI_CHK(fi_close(&rciTab[i].rxCntr->fid));
+    }
   }
 
   for (int i = 0; i < tciTabLen; i++) {
@@ -3475,14 +4027,24 @@ void fini_ofi(void) {
   if (ofi_addrs != NULL) {
     CHPL_FREE(ofi_addrs);
   }
+  if (lazyAvNames != NULL) {
+    CHPL_FREE(lazyAvNames);
+  }
+
+  fini_ofiStripeRails();
 
   OFI_CHK(fi_close(&ofi_domain->fid));
   OFI_CHK(fi_close(&ofi_fabric->fid));
 
   fi_freeinfo(ofi_info);
 
-  CHPL_FREE(amLZs[1]);
-  CHPL_FREE(amLZs[0]);
+  for (int i = 0; i < numRxCtxs; i++) {
+    CHPL_FREE(rciTab[i].amLZs[1]);
+    CHPL_FREE(rciTab[i].amLZs[0]);
+  }
+  CHPL_FREE(rciTab);
+
+  fini_ofiExecOnLZs();
 
 }
 
@@ -3684,7 +4246,9 @@ void init_fixedHeap(void) {
                      chpl_snprintf_KMG_z(buf, sizeof(buf), size), size);
         }
 #endif
-      if (!useTHP) {
+      if (!useTHP && (start = chpl_comm_ofi_shm_create_heap(size)) != NULL) {
+        // shared with the co-locales on this node (see comm-ofi-shm.c)
+      } else if (!useTHP) {
         CHK_SYS_MEMALIGN(start, page_size, size);
       } else {
         CHK_SYS_MMAP(start, size, PROT_READ | PROT_WRITE,
@@ -3713,7 +4277,17 @@ void init_fixedHeap(void) {
       }
     }
 
-    chpl_comm_regMemHeapTouch(start, size);
+    //
+    // Fault the heap in.  By default this is done in the background,
+    // overlapped with the rest of startup; we wait for it before the
+    // heap is registered, in init_ofiForMem() or (with one locale)
+    // at the end of chpl_comm_post_task_init().
+    //
+    if (chpl_env_rt_get_bool("COMM_OFI_HEAP_TOUCH_BACKGROUND", true)) {
+      chpl_comm_regMemHeapTouchAsync(start, size);
+    } else {
+      chpl_comm_regMemHeapTouch(start, size);
+    }
 
 #ifdef CHPL_COMM_DEBUG
     if (DBG_TEST_MASK(DBG_HEAP)) {
@@ -3820,63 +4394,299 @@ chpl_bool mrGetDesc(void** pDesc, void* addr, size_t size) {
 }
 
 
-static inline
-void* mrLocalize(void** pDesc, const void* addr, size_t size,
-                 chpl_bool isSource, const char* what) {
-  void* mrAddr = (void*) addr;
-  if (mrAddr == NULL) {
-    *pDesc = NULL;
-  } else if (!mrGetDesc(pDesc, mrAddr, size)) {
-    mrAddr = allocBounceBuf(size);
-    DBG_PRINTF(DBG_MR_BB, "%s BB: %p", what, mrAddr);
-    CHK_TRUE(mrGetDesc(pDesc, mrAddr, size));
-    if (isSource) {
-      memcpy(mrAddr, addr, size);
-    }
-  }
-  return mrAddr;
+//
+// Registration cache.  Entries are LRU-replaced, and are reference
+// counted so that we never close a registration some transaction is
+// still using.  The memory layer tells us when array memory is freed
+// (chpl_comm_regMemFreeNotify()), and we drop any entries covering it
+// then, since the pages could be unmapped and the virtual addresses
+// reused for different physical memory.
+//
+static
+void mrCacheCloseEntry(struct mrCacheEntry* e) {
+  DBG_PRINTF(DBG_MR, "MR cache close %p, %#zx", e->addr, e->size);
+  OFI_CHK(fi_close(&e->mr->fid));
+  e->addr = NULL;
+  mrCacheCount--;
 }
 
 
-static inline
-void* mrLocalizeSource(void** pDesc, const void* addr, size_t size,
-                       const char* what) {
-  return mrLocalize(pDesc, addr, size, true /*isSource*/, what);
+#ifdef CHPL_COMM_OFI_HMEM
+static
+int mrCacheRegDevice(struct fid_mr** pMr, char** pStart, char** pEnd,
+                     uint64_t key) {
+  chpl_gpu_mem_region_t rgn;
+  if (!chpl_gpu_get_mem_region(*pStart, &rgn)) {
+    return -FI_EINVAL;
+  }
+
+  struct iovec iov = { .iov_base = rgn.base, .iov_len = rgn.size };
+  struct fi_mr_attr attr = { .mr_iov = &iov,
+                             .iov_count = 1,
+                             .access = FI_SEND | FI_READ | FI_WRITE,
+                             .requested_key = key, };
+  if (rgn.kind == CHPL_GPU_MEM_REGION_CUDA) {
+    attr.iface = FI_HMEM_CUDA;
+    attr.device.cuda = rgn.device;
+  } else {
+    attr.iface = FI_HMEM_ROCR;
+  }
+  *pStart = (char*) rgn.base;
+  *pEnd = (char*) rgn.base + rgn.size;
+  return fi_mr_regattr(ofi_domain, &attr, 0, pMr);
 }
+#endif
 
 
-static inline
-void* mrLocalizeTarget(void** pDesc, const void* addr, size_t size,
-                       const char* what) {
-  return mrLocalize(pDesc, addr, size, false /*isSource*/, what);
+//
+// Find or make a cache entry covering [start, end).  For device memory
+// we register the whole allocation containing it.  The entry returned
+// in *pEnt holds a reference that the caller gives back by passing that
+// same entry to mrCacheRelease().
+//
+static
+chpl_bool mrCacheGet(void** pDesc, struct mrCacheEntry** pEnt,
+                     char* start, char* end, chpl_bool isDevice) {
+  struct mrCacheEntry* victim = NULL;
+  chpl_bool found = false;
+
+  PTHREAD_CHK(pthread_mutex_lock(&mrCacheLock));
+  for (int i = 0; i < envMrCacheEntries; i++) {
+    struct mrCacheEntry* e = &mrCache[i];
+    if (e->addr == NULL) {
+      if (victim == NULL || victim->addr != NULL) {
+        victim = e;
+      }
+    } else if (!e->stale
+               && start >= e->addr && end <= e->addr + e->size) {
+      e->refs++;
+      e->lastUse = ++mrCacheTick;
+      *pDesc = e->desc;
+      *pEnt = e;
+      found = true;
+      break;
+    } else if (e->refs == 0
+               && (victim == NULL
+                   || (victim->addr != NULL
+                       && e->lastUse < victim->lastUse))) {
+      victim = e;
+    }
+  }
+
+  if (!found && victim != NULL) {
+    if (victim->addr != NULL) {
+      mrCacheCloseEntry(victim);
+    }
+    const chpl_bool prov_key =
+      ((ofi_info->domain_attr->mr_mode & FI_MR_PROV_KEY) != 0);
+    const uint64_t key = prov_key ? 0 : mrCacheNextKey++;
+    struct fid_mr* mr;
+    int rc;
+#ifdef CHPL_COMM_OFI_HMEM
+    if (isDevice) {
+      rc = mrCacheRegDevice(&mr, &start, &end, key);
+    } else
+#endif
+    {
+      rc = fi_mr_reg(ofi_domain, start, end - start,
+                     FI_SEND | FI_READ | FI_WRITE, 0, key, 0, &mr, NULL);
+    }
+    if (rc == 0) {
+      *victim = (struct mrCacheEntry) { .addr = start,
+                                        .size = end - start,
+                                        .mr = mr,
+                                        .desc = fi_mr_desc(mr),
+                                        .lastUse = ++mrCacheTick,
+                                        .refs = 1,
+                                        .stale = false, };
+      mrCacheCount++;
+      *pDesc = victim->desc;
+      *pEnt = victim;
+      found = true;
+      DBG_PRINTF(DBG_MR, "MR cache reg %p, %#zx%s", start, end - start,
+                 isDevice ? " (device)" : "");
+    } else {
+      DBG_PRINTF(DBG_MR, "MR cache fi_mr_reg(%p, %#zx%s) failed: %s",
+                 start, end - start, isDevice ? ", device" : "",
+                 fi_strerror(-rc));
+    }
+  }
+  PTHREAD_CHK(pthread_mutex_unlock(&mrCacheLock));
+
+  return found;
 }
 
 
-static inline
-void mrUnLocalizeSource(void* mrAddr, const void* addr) {
-  if (mrAddr != NULL && mrAddr != addr) {
-    freeBounceBuf(mrAddr);
+static
+chpl_bool mrCacheGetDesc(void** pDesc, struct mrCacheEntry** pEnt,
+                         void* addr, size_t size) {
+  if (mrCache == NULL || size < envMrCacheMinSize) {
+    return false;
   }
+
+  const uintptr_t pgSize = chpl_getSysPageSize();
+  char* start = (char*) ((uintptr_t) addr & ~(pgSize - 1));
+  char* end = (char*) (((uintptr_t) addr + size + pgSize - 1)
+                       & ~(pgSize - 1));
+  return mrCacheGet(pDesc, pEnt, start, end, false /*isDevice*/);
 }
 
 
+//
+// Is addr in device memory?  If so, get a descriptor for it.  We can't
+// bounce device memory, so failing to register it is fatal; the GPU
+// layer only hands us device memory chpl_comm_impl_regMemDevice() said
+// yes to, so that shouldn't happen unless the cache is entirely in use.
+//
 static inline
-void mrUnLocalizeTarget(void* mrAddr, void* addr, size_t size) {
-  if (mrAddr != NULL && mrAddr != addr) {
-    memcpy(addr, mrAddr, size);
-    freeBounceBuf(mrAddr);
+chpl_bool mrCacheGetDeviceDesc(void** pDesc, struct mrCacheEntry** pEnt,
+                               void* addr, size_t size) {
+#ifdef CHPL_COMM_OFI_HMEM
+  if (!haveDeviceRMA || !chpl_gpu_is_device_ptr(addr)) {
+    return false;
   }
+  if (!mrCacheGet(pDesc, pEnt, (char*) addr, (char*) addr + size,
+                  true /*isDevice*/)) {
+    INTERNAL_ERROR_V("cannot register device memory %p, %#zx", addr, size);
+  }
+  return true;
+#else
+  return false;
+#endif
 }
 
 
-static inline
-chpl_bool mrGetKey(uint64_t* pKey, uint64_t* pOff,
-                   int iNode, void* addr, size_t size) {
-  uint64_t key;
-  uint64_t off;
+//
+// Drop the reference mrCacheGet() took on this entry.  It must be the
+// entry mrCacheGet() returned: a stale entry and a fresh one can cover
+// the same range, and releasing the wrong one could close an MR that
+// is still in use.
+//
+static
+void mrCacheRelease(struct mrCacheEntry* e) {
+  PTHREAD_CHK(pthread_mutex_lock(&mrCacheLock));
+  if (--e->refs == 0 && e->stale) {
+    mrCacheCloseEntry(e);
+  }
+  PTHREAD_CHK(pthread_mutex_unlock(&mrCacheLock));
+}
 
-  if (scalableMemReg) {
-    key = 0;
+
+chpl_bool chpl_comm_impl_regMemDevice(void* addr, size_t size,
+                                      c_nodeid_t node, void* raddr) {
+  //
+  // The remote side has to be directly accessible, since doing the RMA
+  // from there instead (see amRequestRmaPut()) would bounce our side.
+  //
+  if (!haveDeviceRMA || node == chpl_nodeID
+      || !mrGetKey(NULL, NULL, node, raddr, size)) {
+    return false;
+  }
+
+  void* desc;
+  struct mrCacheEntry* ent;
+  if (!mrCacheGet(&desc, &ent, (char*) addr, (char*) addr + size,
+                  true /*isDevice*/)) {
+    return false;
+  }
+  mrCacheRelease(ent);
+  return true;
+}
+
+
+void chpl_comm_impl_regMemFreeNotify(void* p, size_t size) {
+  if (mrCache == NULL || mrCacheCount == 0) {
+    return;
+  }
+
+  char* start = (char*) p;
+  char* end = start + size;
+  PTHREAD_CHK(pthread_mutex_lock(&mrCacheLock));
+  for (int i = 0; i < envMrCacheEntries; i++) {
+    struct mrCacheEntry* e = &mrCache[i];
+    if (e->addr != NULL && e->addr < end && start < e->addr + e->size) {
+      if (e->refs == 0) {
+        mrCacheCloseEntry(e);
+      } else {
+        e->stale = true;
+      }
+    }
+  }
+  PTHREAD_CHK(pthread_mutex_unlock(&mrCacheLock));
+}
+
+
+//
+// If this uses a registration cache entry, it is returned in *pMrEnt
+// and must be passed to the matching mrUnLocalize*() call.
+//
+static inline
+void* mrLocalize(void** pDesc, struct mrCacheEntry** pMrEnt,
+                 const void* addr, size_t size,
+                 chpl_bool isSource, const char* what) {
+  void* mrAddr = (void*) addr;
+  *pMrEnt = NULL;
+  if (mrAddr == NULL) {
+    *pDesc = NULL;
+  } else if (!mrGetDesc(pDesc, mrAddr, size)
+             && !mrCacheGetDeviceDesc(pDesc, pMrEnt, mrAddr, size)
+             && !mrCacheGetDesc(pDesc, pMrEnt, mrAddr, size)) {
+    mrAddr = allocBounceBuf(size);
+    DBG_PRINTF(DBG_MR_BB, "%s BB: %p", what, mrAddr);
+    CHK_TRUE(mrGetDesc(pDesc, mrAddr, size));
+    if (isSource) {
+      memcpy(mrAddr, addr, size);
+    }
+  }
+  return mrAddr;
+}
+
+
+static inline
+void* mrLocalizeSource(void** pDesc, struct mrCacheEntry** pMrEnt,
+                       const void* addr, size_t size, const char* what) {
+  return mrLocalize(pDesc, pMrEnt, addr, size, true /*isSource*/, what);
+}
+
+
+static inline
+void* mrLocalizeTarget(void** pDesc, struct mrCacheEntry** pMrEnt,
+                       const void* addr, size_t size, const char* what) {
+  return mrLocalize(pDesc, pMrEnt, addr, size, false /*isSource*/, what);
+}
+
+
+static inline
+void mrUnLocalizeSource(void* mrAddr, const void* addr,
+                        struct mrCacheEntry* mrEnt) {
+  if (mrAddr != NULL && mrAddr != addr) {
+    freeBounceBuf(mrAddr);
+  } else if (mrEnt != NULL) {
+    mrCacheRelease(mrEnt);
+  }
+}
+
+
+static inline
+void mrUnLocalizeTarget(void* mrAddr, void* addr, size_t size,
+                        struct mrCacheEntry* mrEnt) {
+  if (mrAddr != NULL && mrAddr != addr) {
+    memcpy(addr, mrAddr, size);
+    freeBounceBuf(mrAddr);
+  } else if (mrEnt != NULL) {
+    mrCacheRelease(mrEnt);
+  }
+}
+
+
+static inline
+chpl_bool mrGetKey(uint64_t* pKey, uint64_t* pOff,
+                   int iNode, void* addr, size_t size) {
+  uint64_t key;
+  uint64_t off;
+
+  if (scalableMemReg) {
+    key = 0;
     off = (uint64_t) addr;
   } else {
     struct memEntry* mr;
@@ -4048,7 +4858,7 @@ void mcmReleaseAllNodes(struct bitmap_t* b1, struct bitmap_t* b2,
 void chpl_comm_impl_unordered_task_fence(void) {
   DBG_PRINTF(DBG_IFACE_MCM, "%s()", __func__);
 
-  task_local_buff_end(get_buff | put_buff | amo_nf_buff);
+  task_local_buff_end(get_buff | put_buff | amo_nf_buff | am_buff);
 }
 
 
@@ -4064,7 +4874,7 @@ void chpl_comm_impl_task_create(void) {
 void chpl_comm_impl_task_end(void) {
   DBG_PRINTF(DBG_IFACE_MCM, "%s()", __func__);
 
-  task_local_buff_end(get_buff | put_buff | amo_nf_buff);
+  task_local_buff_end(get_buff | put_buff | amo_nf_buff | am_buff);
   retireDelayedAmDone(true /*taskIsEnding*/);
   forceMemFxVisAllNodes_noTcip(true /*checkPuts*/, true /*checkAmos*/);
 }
@@ -4085,6 +4895,7 @@ typedef enum {
   am_opFree,                               // free some memory
   am_opNop,                                // do nothing; for MCM & liveness
   am_opShutdown,                           // signal main process for shutdown
+  am_opBatch,                              // several aggregated requests
 } amOp_t;
 
 static inline
@@ -4156,6 +4967,16 @@ struct amRequest_free_t {
   void* p;                      // address to free, on AM target node
 };
 
+//
+// An aggregated AM request.  The header is followed by 'len' bytes of
+// other requests, each padded to a multiple of 8 bytes.  This is not
+// in the amRequest_t union because it is larger than any other request.
+//
+struct amRequest_batch_t {
+  struct amRequest_base_t b;
+  uint32_t len;                 // bytes of requests following the header
+};
+
 typedef union {
   struct amRequest_base_t b;
   struct amRequest_execOn_t xo;      // present only to set the max req size
@@ -4194,6 +5015,9 @@ static void amRequestFAMOResult(c_nodeid_t, chpl_amo_datum_t*,
                                 enum fi_datatype, void*, size_t, amDone_t*);
 static void amRequestFree(c_nodeid_t, void*);
 static void amRequestNop(c_nodeid_t, chpl_bool, struct perTxCtxInfo_t*);
+static chpl_bool amAggregate(c_nodeid_t, amRequest_t*, size_t);
+static chpl_bool amAggregateAMO(c_nodeid_t, void*, const void*,
+                                int, enum fi_datatype, size_t);
 static void amRequestCommon(c_nodeid_t, amRequest_t*, size_t,
                             chpl_bool, struct perTxCtxInfo_t*);
 static void amWaitForDone(amDone_t*);
@@ -4219,7 +5043,10 @@ void chpl_comm_execute_on(c_nodeid_t node, c_sublocid_t subloc,
   chpl_comm_diags_verbose_executeOn("", node, ln, fn);
   chpl_comm_diags_incr(execute_on);
 
+  chpl_comm_diags_matrix_add(node, argSize);
+  uint64_t t0 = chpl_comm_diags_hist_start();
   amRequestExecOn(node, subloc, fid, arg, argSize, false, true);
+  chpl_comm_diags_hist_end(execute_on, argSize, t0);
 }
 
 
@@ -4243,7 +5070,10 @@ void chpl_comm_execute_on_nb(c_nodeid_t node, c_sublocid_t subloc,
   chpl_comm_diags_verbose_executeOn("non-blocking", node, ln, fn);
   chpl_comm_diags_incr(execute_on_nb);
 
+  chpl_comm_diags_matrix_add(node, argSize);
+  uint64_t t0 = chpl_comm_diags_hist_start();
   amRequestExecOn(node, subloc, fid, arg, argSize, false, false);
+  chpl_comm_diags_hist_end(execute_on_nb, argSize, t0);
 }
 
 
@@ -4267,7 +5097,115 @@ void chpl_comm_execute_on_fast(c_nodeid_t node, c_sublocid_t subloc,
   chpl_comm_diags_verbose_executeOn("fast", node, ln, fn);
   chpl_comm_diags_incr(execute_on_fast);
 
+  chpl_comm_diags_matrix_add(node, argSize);
+  uint64_t t0 = chpl_comm_diags_hist_start();
   amRequestExecOn(node, subloc, fid, arg, argSize, true, true);
+  chpl_comm_diags_hist_end(execute_on_fast, argSize, t0);
+}
+
+
+//
+// Large executeOn landing zones.  Each node sets aside a few slots for
+// every source node.  A source can PUT the payload of a large
+// executeOn straight into one of these slots, instead of making the
+// target GET it back after the AM arrives.  Each source keeps a free
+// flag per slot.  The target sets the flag with an amPutDone() once it
+// has copied the payload out, and the source clears it when it claims
+// the slot.  If no slot is free, or the payload doesn't fit in one, we
+// just fall back to having the target GET the payload.
+//
+static char* xolLZ;             // our landing zone, [srcNode][slot]
+static char** xolLZMap;         // everyone's xolLZ
+static amDone_t* xolSlotFree;   // free flags, [dstNode][slot]
+static chpl_atomic_bool* xolDstLock; // serializes slot claims per dstNode
+
+static
+void init_ofiExecOnLZs(void) {
+  if (envExecOnLZSlots <= 0
+      || envExecOnLZSlotSize <= sizeof(amRequest_t)) {
+    return;
+  }
+
+  //
+  // The payload PUT has to be visible on the target by the time the AM
+  // pointing at it is.  Without delivery-complete that relies on the
+  // PUT and the AM going out on the same tx context, so only do this
+  // if tx contexts are bound.
+  //
+  if (mcmMode != mcmm_dlvrCmplt && !tciTabBindTxCtxs) {
+    return;
+  }
+
+  const size_t numSlots = (size_t) chpl_numNodes * envExecOnLZSlots;
+  CHPL_CALLOC_SZ(xolLZ, numSlots, envExecOnLZSlotSize);
+  chpl_bool ok = mrGetKey(NULL, NULL, chpl_nodeID, xolLZ,
+                          numSlots * envExecOnLZSlotSize);
+
+  //
+  // Either everyone does this or no one does.
+  //
+  chpl_bool* oks;
+  CHPL_CALLOC(oks, chpl_numNodes);
+  chpl_comm_ofi_oob_allgather(&ok, oks, sizeof(ok));
+  for (int i = 0; i < chpl_numNodes; i++) {
+    ok = ok && oks[i];
+  }
+  CHPL_FREE(oks);
+  if (!ok) {
+    DBG_PRINTF(DBG_CFG, "executeOn LZs not in registered memory; disabled");
+    CHPL_FREE(xolLZ);
+    xolLZ = NULL;
+    return;
+  }
+
+  CHPL_CALLOC(xolLZMap, chpl_numNodes);
+  chpl_comm_ofi_oob_allgather(&xolLZ, xolLZMap, sizeof(xolLZ));
+
+  CHPL_CALLOC(xolSlotFree, numSlots);
+  for (size_t i = 0; i < numSlots; i++) {
+    xolSlotFree[i] = 1;
+  }
+  CHPL_CALLOC(xolDstLock, chpl_numNodes);
+  for (int i = 0; i < chpl_numNodes; i++) {
+    atomic_init_bool(&xolDstLock[i], false);
+  }
+
+  DBG_PRINTF(DBG_CFG, "executeOn LZs: %d slots of %zd bytes per node",
+             envExecOnLZSlots, envExecOnLZSlotSize);
+}
+
+
+//
+// Claim a free landing zone slot on the given node, returning its
+// index.  Returns -1 if there isn't one right now.
+//
+static inline
+int xolClaimSlot(c_nodeid_t node) {
+  if (atomic_exchange_bool(&xolDstLock[node], true)) {
+    return -1;
+  }
+  int slot = -1;
+  volatile amDone_t* flags = &xolSlotFree[(size_t) node * envExecOnLZSlots];
+  for (int i = 0; i < envExecOnLZSlots; i++) {
+    if (flags[i] != 0) {
+      flags[i] = 0;
+      slot = i;
+      break;
+    }
+  }
+  atomic_store_bool(&xolDstLock[node], false);
+  return slot;
+}
+
+
+static
+void fini_ofiExecOnLZs(void) {
+  if (xolLZ != NULL) {
+    CHPL_FREE(xolLZ);
+    CHPL_FREE(xolLZMap);
+    CHPL_FREE(xolSlotFree);
+    CHPL_FREE(xolDstLock);
+  }
 }
 
 
@@ -4308,11 +5246,32 @@ void amRequestExecOn(c_nodeid_t node, c_sublocid_t subloc,
     //
     arg->kind = am_opExecOnLrg;
     amRequest_t req = { .xol = { .hdr = *arg,
-                                 .pPayload = &arg->payload, }, };
+                                 .pPayload = &arg->payload,
+                                 .pSlotFree = NULL, }, };
+
+    //
+    // If we can, put the payload directly into a landing zone slot on
+    // the target.  Then there's nothing for the target to retrieve and
+    // nothing for us to keep around.
+    //
+    size_t payloadSize = argSize - offsetof(chpl_comm_on_bundle_t, payload);
+    int slot = -1;
+    if (xolLZ != NULL && payloadSize <= envExecOnLZSlotSize) {
+      slot = xolClaimSlot(node);
+    }
+    if (slot >= 0) {
+      const size_t idx = (size_t) chpl_nodeID * envExecOnLZSlots + slot;
+      char* lz = xolLZMap[node] + idx * envExecOnLZSlotSize;
+      ofi_put(&arg->payload, node, lz, payloadSize);
+      req.xol.pPayload = lz;
+      req.xol.pSlotFree = &xolSlotFree[(size_t) node * envExecOnLZSlots
+                                       + slot];
+      amRequestCommon(node, &req, sizeof(req.xol), blocking, NULL);
+      return;
+    }
 
     chpl_bool heapCopyArg = !blocking || !mrGetLocalKey(arg, argSize);
     if (heapCopyArg) {
-      size_t payloadSize = argSize - offsetof(chpl_comm_on_bundle_t, payload);
       req.xol.pPayload = allocBounceBuf(payloadSize);
       memcpy(req.xol.pPayload, &arg->payload, payloadSize);
     }
@@ -4357,7 +5316,7 @@ void amRequestRmaPut(c_nodeid_t node, void* addr, void* raddr, size_t size) {
                                .size = size, }, };
   amRequestCommon(node, &req, sizeof(req.rma), true /*blocking*/, NULL);
 
-  mrUnLocalizeSource(myAddr, addr);
+  mrUnLocalizeSource(myAddr, addr, NULL);
 }
 
 
@@ -4382,7 +5341,7 @@ void amRequestRmaGet(c_nodeid_t node, void* addr, void* raddr, size_t size) {
                                .size = size, }, };
   amRequestCommon(node, &req, sizeof(req.rma), true /*blocking*/, NULL);
 
-  mrUnLocalizeTarget(myAddr, addr, size);
+  mrUnLocalizeTarget(myAddr, addr, size, NULL);
 }
 
 
@@ -4459,7 +5418,7 @@ void amRequestAMO(c_nodeid_t node, void* object,
   // neither of those require anything from the common code.
   //
   amRequestCommon(node, &req, sizeof(req.amo), blocking, tcip);
-  mrUnLocalizeTarget(myResult, result, size);
+  mrUnLocalizeTarget(myResult, result, size, NULL);
   tciFree(tcip);
 }
 
@@ -4506,6 +5465,9 @@ void amRequestFree(c_nodeid_t node, void* p) {
   amRequest_t req = { .free = { .b = { .op = am_opFree,
                                        .node = chpl_nodeID, },
                                 .p = p, }, };
+  if (amAggregate(node, &req, sizeof(req.free))) {
+    return;
+  }
   amRequestCommon(node, &req, sizeof(req.free), false, NULL);
 }
 
@@ -4527,6 +5489,159 @@ void amRequestShutdown(c_nodeid_t node) {
   amRequestCommon(node, &req, sizeof(req.b), false, NULL);
 }
 
+//
+// AM request aggregation
+//
+// With CHPL_RT_COMM_OFI_AM_AGGREGATION set, a task buffers the small AM
+// requests whose completion nothing can wait for except a task or
+// unordered-op fence: non-fetching unordered AMOs done by the target
+// CPU, and frees of copies we made on other nodes.  These are kept in
+// per-destination task-local buffers and sent several at a time as one
+// am_opBatch request.  A destination's buffer is sent when it is full,
+// when the task needs its slot for another destination, when the oldest
+// request the task has buffered is older than the aggregation timeout
+// (checked when requests are added), and at the fences that flush the
+// other task-local buffers.
+//
+
+#define AM_AGG_REQ_SIZE(sz) (((sz) + sizeof(uint64_t) - 1) \
+                             & ~(sizeof(uint64_t) - 1))
+#define AM_AGG_MAX_PAYLOAD (MAX_AM_AGG_LEN \
+                            - AM_AGG_REQ_SIZE(sizeof(struct amRequest_batch_t)))
+
+static inline
+char* am_buff_dest_payload(am_buff_dest_t* d) {
+  return (char*) d->buf + AM_AGG_REQ_SIZE(sizeof(struct amRequest_batch_t));
+}
+
+static
+void am_buff_dest_flush(am_buff_task_info_t* info, am_buff_dest_t* d) {
+  if (d->cnt == 0) {
+    return;
+  }
+
+  struct amRequest_batch_t* batch = (struct amRequest_batch_t*) d->buf;
+  *batch = (struct amRequest_batch_t) { .b = { .op = am_opBatch,
+                                               .node = chpl_nodeID, },
+                                        .len = (uint32_t) d->len, };
+  size_t payloadOff = am_buff_dest_payload(d) - (char*) d->buf;
+
+  DBG_PRINTF(DBG_AM | DBG_AM_SEND,
+             "AM batch to %d: %d reqs, %zd bytes",
+             (int) d->node, d->cnt, d->len);
+  amRequestCommon(d->node, (amRequest_t*) batch, payloadOff + d->len,
+                  false /*blocking*/, NULL);
+
+  info->vi -= d->cnt;
+  d->cnt = 0;
+  d->len = 0;
+}
+
+static
+void am_buff_task_info_flush(am_buff_task_info_t* info) {
+  for (int i = 0; i < MAX_AM_AGG_DESTS; i++) {
+    am_buff_dest_flush(info, &info->dest_v[i]);
+  }
+  info->vi = 0;
+}
+
+//
+// Buffer an AM request for the given node if we can.  Returns true if
+// the request was buffered, and false if the caller should send it.
+//
+static
+chpl_bool amAggregate(c_nodeid_t node, amRequest_t* req, size_t reqSize) {
+  if (!envAmAggregation || AM_AGG_REQ_SIZE(reqSize) > AM_AGG_MAX_PAYLOAD) {
+    return false;
+  }
+
+  am_buff_task_info_t* info = task_local_buff_acquire(am_buff);
+  if (info == NULL) {
+    return false;
+  }
+
+  if (info->new) {
+    for (int i = 0; i < MAX_AM_AGG_DESTS; i++) {
+      info->dest_v[i].node = -1;
+    }
+    info->new = false;
+  }
+
+  //
+  // Find this node's buffer.  Failing that use an empty one, or else
+  // send the fullest one and take it over.
+  //
+  am_buff_dest_t* d = NULL;
+  am_buff_dest_t* fullest = &info->dest_v[0];
+  for (int i = 0; i < MAX_AM_AGG_DESTS; i++) {
+    am_buff_dest_t* di = &info->dest_v[i];
+    if (di->node == node) {
+      d = di;
+      break;
+    }
+    if (d == NULL && di->cnt == 0) {
+      d = di;
+    }
+    if (di->len > fullest->len) {
+      fullest = di;
+    }
+  }
+  if (d == NULL) {
+    am_buff_dest_flush(info, fullest);
+    d = fullest;
+  }
+  d->node = node;
+
+  size_t itemSize = AM_AGG_REQ_SIZE(reqSize);
+  if (d->len + itemSize > AM_AGG_MAX_PAYLOAD) {
+    am_buff_dest_flush(info, d);
+  }
+
+  char* p = am_buff_dest_payload(d) + d->len;
+  memcpy(p, req, reqSize);
+  memset(p + reqSize, 0, itemSize - reqSize);
+  d->len += itemSize;
+  d->cnt++;
+
+  if (info->vi++ == 0) {
+    info->firstTime = chpl_comm_ofi_time_get();
+  } else if (chpl_comm_ofi_time_get() - info->firstTime
+             > envAmAggregationTimeout) {
+    am_buff_task_info_flush(info);
+  }
+
+  return true;
+}
+
+//
+// Buffer a non-fetching unordered AMO to be done by the target's CPU.
+//
+static
+chpl_bool amAggregateAMO(c_nodeid_t node, void* object, const void* opnd,
+                         int ofiOp, enum fi_datatype ofiType, size_t size) {
+  if (!envAmAggregation) {
+    return false;
+  }
+
+  amRequest_t req = { .amo = { .b = { .op = am_opAMO,
+                                      .node = chpl_nodeID,
+                                      .pAmDone = NULL, },
+                               .ofiOp = ofiOp,
+                               .ofiType = ofiType,
+                               .size = size,
+                               .obj = object,
+                               .result = NULL, }, };
+  if (opnd != NULL) {
+    memcpy(&req.amo.opnd, opnd, size);
+  }
+
+#ifdef CHPL_COMM_DEBUG
+  am_debugPrep(&req);
+#endif
+
+  return amAggregate(node, &req, sizeof(req.amo));
+}
+
 
 typedef void (amReqFn_t)(c_nodeid_t node,
                          amRequest_t* req, size_t reqSize, void* mrDesc,
@@ -4570,7 +5685,9 @@ void amRequestCommon(c_nodeid_t node,
   }
 
   void* mrDesc;
-  amRequest_t* myReq = mrLocalizeSource(&mrDesc, req, reqSize, "AM req");
+  struct mrCacheEntry* mrEnt;
+  amRequest_t* myReq = mrLocalizeSource(&mrDesc, &mrEnt, req, reqSize,
+                                        "AM req");
 
   amReqFn_selector(node, myReq, reqSize, mrDesc, blocking, myTcip);
 
@@ -4578,11 +5695,12 @@ void amRequestCommon(c_nodeid_t node,
     tciFree(myTcip);
   }
 
-  mrUnLocalizeSource(myReq, req);
+  mrUnLocalizeSource(myReq, req, mrEnt);
 
   if (blocking) {
     amWaitForDone(pAmDone);
-    mrUnLocalizeSource(pAmDone, &amDone); // don't need or want target copyout
+    // don't need or want target copyout
+    mrUnLocalizeSource(pAmDone, &amDone, NULL);
   }
 }
 
@@ -4865,9 +5983,9 @@ static pthread_cond_t amStartStopCond = PTHREAD_COND_INITIALIZER;
 static pthread_mutex_t amStartStopMutex = PTHREAD_MUTEX_INITIALIZER;
 
 static void amHandler(void*);
-static void processRxAmReq(void);
-static void processRxAmReqCQ(void);
-static void processRxAmReqCntr(void);
+static void processRxAmReq(struct perRxCtxInfo_t*);
+static void processRxAmReqCQ(struct perRxCtxInfo_t*);
+static void processRxAmReqCntr(struct perRxCtxInfo_t*);
 static void amHandleExecOn(chpl_comm_on_bundle_t*);
 static void amWrapExecOnBody(void*);
 static void amHandleExecOnLrg(chpl_comm_on_bundle_t*);
@@ -4900,7 +6018,8 @@ void init_amHandling(void) {
   atomic_init_bool(&amHandlersExit, false);
   PTHREAD_CHK(pthread_mutex_lock(&amStartStopMutex));
   for (int i = 0; i < numAmHandlers; i++) {
-    CHK_TRUE(chpl_task_createCommTask(amHandler, NULL, reservedCPUs[i]) == 0);
+    CHK_TRUE(chpl_task_createCommTask(amHandler, (void*) (intptr_t) i,
+                                      reservedCPUs[i]) == 0);
   }
   PTHREAD_CHK(pthread_cond_wait(&amStartStopCond, &amStartStopMutex));
   PTHREAD_CHK(pthread_mutex_unlock(&amStartStopMutex));
@@ -4918,9 +6037,11 @@ void fini_amHandling(void) {
   //
   PTHREAD_CHK(pthread_mutex_lock(&amStartStopMutex));
   atomic_store_bool(&amHandlersExit, true);
-  // AM handler may be waiting on the receive counter. Break it out.
-  if (ofi_rxCntr != NULL) {
-    OFI_CHK(fi_cntr_add(ofi_rxCntr, 1));
+  // AM handlers may be waiting on their receive counters. Break them out.
+  for (int i = 0; i < numRxCtxs; i++) {
+    if (rciTab[i].rxCntr != NULL) {
+      OFI_CHK(fi_cntr_add(rciTab[i].rxCntr, 1));
+    }
   }
 
   PTHREAD_CHK(pthread_cond_wait(&amStartStopCond, &amStartStopMutex));
@@ -4934,16 +6055,19 @@ void fini_amHandling(void) {
 // The AM handler runs this.
 //
 static __thread struct perTxCtxInfo_t* amTcip;
+static __thread struct perRxCtxInfo_t* amRcip;
 
 static
-void amHandler(void* argNil) {
+void amHandler(void* arg) {
+  const int handlerIdx = (int) (intptr_t) arg;
   struct perTxCtxInfo_t* tcip;
   CHK_TRUE((tcip = tciAllocForAmHandler()) != NULL);
   amTcip = tcip;
+  amRcip = &rciTab[handlerIdx];
 
   isAmHandler = true;
 
-  DBG_PRINTF(DBG_AM, "AM handler running");
+  DBG_PRINTF(DBG_AM, "AM handler %d running", handlerIdx);
 
   //
   // Count this AM handler thread as running.  The creator thread
@@ -4962,9 +6086,9 @@ void amHandler(void* argNil) {
     chpl_bool hadRxEvent, hadTxEvent;
     amCheckRxTxCmpls(&hadRxEvent, &hadTxEvent, tcip);
     if (hadRxEvent) {
-      processRxAmReq();
+      processRxAmReq(amRcip);
     }
-    if (amDoLivenessChecks) {
+    if (amDoLivenessChecks && handlerIdx == 0) {
       amCheckLiveness();
     }
   }
@@ -4990,6 +6114,126 @@ void amHandler(void* argNil) {
   DBG_PRINTF(DBG_AM, "AM handler done");
 }
 
+
+//
+// Progress thread.  With manual-progress providers, completions for a
+// task's nonblocking operations only advance when that task's thread
+// calls into comm, so a task that goes off to compute can leave its
+// operations stalled.  Optionally, a dedicated thread (on a reserved
+// core, if possible) drives progress on the bound worker tx contexts
+// while their owners aren't using them.  It polls often when it finds
+// work and backs off exponentially when it doesn't.
+//
+#define PROGRESS_MIN_SLEEP_NS 1000
+#define PROGRESS_MAX_SLEEP_NS 1000000
+
+static chpl_atomic_bool progressThreadExit;
+static pthread_mutex_t progressStartStopMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t progressStartStopCond = PTHREAD_COND_INITIALIZER;
+static chpl_bool progressThreadActive;
+
+static
+void progressThread(void* argNil) {
+  DBG_PRINTF(DBG_AM, "progress thread running");
+
+  PTHREAD_CHK(pthread_mutex_lock(&progressStartStopMutex));
+  progressThreadActive = true;
+  PTHREAD_CHK(pthread_cond_signal(&progressStartStopCond));
+  PTHREAD_CHK(pthread_mutex_unlock(&progressStartStopMutex));
+
+  const int numWorkerTxCtxs = tciTabLen - numAmHandlers;
+  long sleepNs = PROGRESS_MIN_SLEEP_NS;
+
+  while (!atomic_load_bool(&progressThreadExit)) {
+    chpl_bool hadWork = false;
+    for (int i = 0; i < numWorkerTxCtxs; i++) {
+      struct perTxCtxInfo_t* tcip = &tciTab[i];
+      if (!tcip->bound || tcip->numTxnsOut == 0
+          || atomic_exchange_bool(&tcip->progressLock, true)) {
+        continue;
+      }
+      const uint64_t before = tcip->numTxnsOut;
+      if (before > 0) {
+        (*tcip->checkTxCmplsFn)(tcip);
+        if (tcip->numTxnsOut != before) {
+          hadWork = true;
+        }
+      }
+      atomic_store_bool(&tcip->progressLock, false);
+    }
+
+    if (hadWork) {
+      sleepNs = PROGRESS_MIN_SLEEP_NS;
+      sched_yield();
+    } else {
+      struct timespec ts = { .tv_sec = 0, .tv_nsec = sleepNs };
+      (void) nanosleep(&ts, NULL);
+      if ((sleepNs *= 2) > PROGRESS_MAX_SLEEP_NS) {
+        sleepNs = PROGRESS_MAX_SLEEP_NS;
+      }
+    }
+  }
+
+  PTHREAD_CHK(pthread_mutex_lock(&progressStartStopMutex));
+  progressThreadActive = false;
+  PTHREAD_CHK(pthread_cond_signal(&progressStartStopCond));
+  PTHREAD_CHK(pthread_mutex_unlock(&progressStartStopMutex));
+
+  DBG_PRINTF(DBG_AM, "progress thread done");
+}
+
+
+static
+void init_progressThread(void) {
+  if (!envProgressThread || chpl_numNodes <= 1) {
+    return;
+  }
+
+  //
+  // Only manual-progress providers need this, and without bound tx
+  // contexts operations don't outlive the calls that start them anyway.
+  //
+  if (ofi_info->domain_attr->data_progress != FI_PROGRESS_MANUAL
+      || !tciTabBindTxCtxs) {
+    DBG_PRINTF(DBG_CFG, "progress thread not needed");
+    return;
+  }
+
+  //
+  // This has to be set before any bound tx contexts are in use, so that
+  // their owners always take turns with the progress thread.
+  //
+  progressThreadRunning = true;
+  atomic_init_bool(&progressThreadExit, false);
+  PTHREAD_CHK(pthread_mutex_lock(&progressStartStopMutex));
+  CHK_TRUE(chpl_task_createCommTask(progressThread, NULL,
+                                    progressThreadCPU) == 0);
+  while (!progressThreadActive) {
+    PTHREAD_CHK(pthread_cond_wait(&progressStartStopCond,
+                                  &progressStartStopMutex));
+  }
+  PTHREAD_CHK(pthread_mutex_unlock(&progressStartStopMutex));
+}
+
+
+static
+void fini_progressThread(void) {
+  if (!progressThreadRunning) {
+    return;
+  }
+
+  PTHREAD_CHK(pthread_mutex_lock(&progressStartStopMutex));
+  atomic_store_bool(&progressThreadExit, true);
+  while (progressThreadActive) {
+    PTHREAD_CHK(pthread_cond_wait(&progressStartStopCond,
+                                  &progressStartStopMutex));
+  }
+  PTHREAD_CHK(pthread_mutex_unlock(&progressStartStopMutex));
+  atomic_destroy_bool(&progressThreadExit);
+}
+
+static size_t amHandleBatch(struct amRequest_batch_t*);
+
 static
 size_t handleAmReq(amRequest_t *req) {
   size_t size = 0;
@@ -5060,6 +6304,10 @@ size_t handleAmReq(amRequest_t *req) {
       size = sizeof(req->b);
       break;
 
+    case am_opBatch:
+      size = amHandleBatch((struct amRequest_batch_t*) req);
+      break;
+
     default:
       INTERNAL_ERROR_V("unexpected AM op %d", (int) req->b.op);
       break;
@@ -5067,19 +6315,43 @@ size_t handleAmReq(amRequest_t *req) {
   return size;
 }
 
+//
+// Handle the requests in an aggregated AM request, returning the size
+// of the whole thing.
+//
 static
-void processRxAmReqCntr(void) {
+size_t amHandleBatch(struct amRequest_batch_t* batch) {
+  char* p = (char*) batch + AM_AGG_REQ_SIZE(sizeof(*batch));
+  char* end = p + batch->len;
+
+  DBG_PRINTF(DBG_AM | DBG_AM_RECV,
+             "rx AM batch from %d, %" PRIu32 " bytes",
+             (int) batch->b.node, batch->len);
+  while (p < end) {
+    amRequest_t* req = (amRequest_t*) p;
+    CHK_TRUE(req->b.op == am_opAMO || req->b.op == am_opFree);
+    DBG_PRINTF(DBG_AM | DBG_AM_RECV,
+               "rx AM req: %s",
+               am_reqStr(chpl_nodeID, req, 0));
+    p += AM_AGG_REQ_SIZE(handleAmReq(req));
+  }
+
+  return (end - (char*) batch);
+}
+
+static
+void processRxAmReqCntr(struct perRxCtxInfo_t* rcip) {
   //
   // Process requests received on the AM request endpoint.
   //
 
-  OFI_CHK(fi_cntr_wait(ofi_rxCntr, ofi_rxCount+1, -1));
-  uint64_t todo = fi_cntr_read(ofi_rxCntr) - ofi_rxCount;
+  OFI_CHK(fi_cntr_wait(rcip->rxCntr, rcip->rxCount+1, -1));
+  uint64_t todo = fi_cntr_read(rcip->rxCntr) - rcip->rxCount;
   if (atomic_load_bool(&amHandlersExit)) {
     return;
   }
   if (todo == 0) {
-    uint64_t errors = fi_cntr_readerr(ofi_rxCntr);
+    uint64_t errors = fi_cntr_readerr(rcip->rxCntr);
     if (errors > 0) {
       INTERNAL_ERROR_V("error count %" PRIu64, errors);
     }
@@ -5089,20 +6361,20 @@ void processRxAmReqCntr(void) {
   for (int i = 0; i < todo; i++) {
     // skip any padding and look for the next message
 
-    char *ptr = ofi_rxBuffer;
+    char *ptr = rcip->rxBuffer;
     // limit how far we'll look for the message in the buffer
     char *horizon = ptr + 2 * sizeof(amRequest_t);
-    if (horizon > (char *) ofi_rxEnd) {
-      horizon = (char *) ofi_rxEnd;
+    if (horizon > (char *) rcip->rxEnd) {
+      horizon = (char *) rcip->rxEnd;
     }
     for (; ptr < horizon && *ptr == '\0'; ptr++); // do nothing
     if (ptr >= horizon) {
 
       // look in the other buffer
-      int other = 1 - ofi_msg_i;
-      ptr = ofi_msg_reqs[other].msg_iov->iov_base;
-      void *rxEnd = (void *) ((char *) ofi_msg_reqs[other].msg_iov->iov_base +
-                            ofi_msg_reqs[other].msg_iov->iov_len);
+      int other = 1 - rcip->msg_i;
+      ptr = rcip->msg_reqs[other].msg_iov->iov_base;
+      void *rxEnd = (void *) ((char *) rcip->msg_reqs[other].msg_iov->iov_base +
+                            rcip->msg_reqs[other].msg_iov->iov_len);
       horizon = ptr + 2 * sizeof(amRequest_t);
       if (horizon > (char *) rxEnd) {
         horizon = (char *) rxEnd;
@@ -5112,58 +6384,58 @@ void processRxAmReqCntr(void) {
       for (; ptr < horizon && *ptr == '\0'; ptr++); // do nothing
       CHK_TRUE(ptr < horizon);
       // found it. zero and repost current buffer, switch to other
-      memset(ofi_msg_reqs[ofi_msg_i].msg_iov->iov_base, '\0',
-             ofi_msg_reqs[ofi_msg_i].msg_iov->iov_len);
-      OFI_CHK(fi_recvmsg(ofi_rxEp, &ofi_msg_reqs[ofi_msg_i], FI_MULTI_RECV));
-      ofi_msg_i = other;
-      ofi_rxEnd = rxEnd;
+      memset(rcip->msg_reqs[rcip->msg_i].msg_iov->iov_base, '\0',
+             rcip->msg_reqs[rcip->msg_i].msg_iov->iov_len);
+      OFI_CHK(fi_recvmsg(rcip->rxEp, &rcip->msg_reqs[rcip->msg_i], FI_MULTI_RECV));
+      rcip->msg_i = other;
+      rcip->rxEnd = rxEnd;
     }
 
-    ofi_rxBuffer = ptr;
+    rcip->rxBuffer = ptr;
 
     //
     // This event is for an inbound AM request.  Handle it.
     //
-    amRequest_t* req = (amRequest_t*) ofi_rxBuffer;
+    amRequest_t* req = (amRequest_t*) rcip->rxBuffer;
     DBG_PRINTF(DBG_AM_BUF,
                "CQ rx AM req @ buffer offset %zd seqId %s",
-               (char*) req - (char*) ofi_iov_reqs[ofi_msg_i].iov_base,
+               (char*) req - (char*) rcip->iov_reqs[rcip->msg_i].iov_base,
                am_seqIdStr(req));
     DBG_PRINTF(DBG_AM | DBG_AM_RECV,
                "rx AM req: %s",
                am_reqStr(chpl_nodeID, req, 0));
     size = handleAmReq(req);
-    ofi_rxBuffer = (void *) ((char *) ofi_rxBuffer +  size);
+    rcip->rxBuffer = (void *) ((char *) rcip->rxBuffer +  size);
   }
-  ofi_rxCount += todo;
+  rcip->rxCount += todo;
 }
 
 //
 // Post a receive buffer.
 //
 static
-chpl_bool postBuffer(int i) {
+chpl_bool postBuffer(struct perRxCtxInfo_t* rcip, int i) {
   chpl_bool posted = true;
   int rc;
-  OFI_CHK_2(fi_recvmsg(ofi_rxEp, &ofi_msg_reqs[i], FI_MULTI_RECV), rc,
+  OFI_CHK_2(fi_recvmsg(rcip->rxEp, &rcip->msg_reqs[i], FI_MULTI_RECV), rc,
             -FI_EAGAIN);
   if (rc == -FI_EAGAIN) {
     DBG_PRINTF(DBG_AM_BUF,
                "(re)post fi_recvmsg(AMLZs %p, len %#zx) returned EAGAIN",
-               ofi_msg_reqs[i].msg_iov->iov_base,
-               ofi_msg_reqs[i].msg_iov->iov_len);
+               rcip->msg_reqs[i].msg_iov->iov_base,
+               rcip->msg_reqs[i].msg_iov->iov_len);
     posted = false;
   } else {
     DBG_PRINTF(DBG_AM_BUF,
                "(re)post fi_recvmsg(AMLZs %p, len %#zx) succeeded",
-               ofi_msg_reqs[i].msg_iov->iov_base,
-               ofi_msg_reqs[i].msg_iov->iov_len);
+               rcip->msg_reqs[i].msg_iov->iov_base,
+               rcip->msg_reqs[i].msg_iov->iov_len);
   }
   return posted;
 }
 
 static
-void processRxAmReqCQ(void) {
+void processRxAmReqCQ(struct perRxCtxInfo_t* rcip) {
   //
   // Process requests received on the AM request endpoint.
   //
@@ -5172,11 +6444,11 @@ void processRxAmReqCQ(void) {
   ssize_t ret;
   chpl_bool post = false;
   do {
-    CHK_TRUE((ret = fi_cq_read(ofi_rxCQ, cqes, maxEvents)) > 0
+    CHK_TRUE((ret = fi_cq_read(rcip->rxCQ, cqes, maxEvents)) > 0
              || ret == -FI_EAGAIN
              || ret == -FI_EAVAIL);
     if (ret == -FI_EAVAIL) {
-      reportCQError(ofi_rxCQ);
+      reportCQError(rcip->rxCQ);
     }
 
     //
@@ -5185,7 +6457,7 @@ void processRxAmReqCQ(void) {
     //
     if (post) {
       DBG_PRINTF(DBG_AM_BUF, "post pending\n");
-      if (postBuffer(1-ofi_msg_i) == true) {
+      if (postBuffer(rcip, 1-rcip->msg_i) == true) {
         post = false;
       }
     }
@@ -5200,7 +6472,7 @@ void processRxAmReqCQ(void) {
         amRequest_t* req = (amRequest_t*) cqes[i].buf;
         DBG_PRINTF(DBG_AM_BUF,
                    "CQ rx AM req @ buffer offset %zd, sz %zd, seqId %s %s",
-                   (char*) req - (char*) ofi_iov_reqs[ofi_msg_i].iov_base,
+                   (char*) req - (char*) rcip->iov_reqs[rcip->msg_i].iov_base,
                    cqes[i].len, am_seqIdStr(req),
                    (cqes[i].flags & FI_MULTI_RECV) ? "FI_MULTI_RECV" : "");
         DBG_PRINTF(DBG_AM | DBG_AM_RECV,
@@ -5214,7 +6486,7 @@ void processRxAmReqCQ(void) {
         // buffer. Repost this one.
         //
 
-        if (postBuffer(ofi_msg_i) == false) {
+        if (postBuffer(rcip, rcip->msg_i) == false) {
           //
           // Buffer was not posted due to FI_EAGAIN. Go around the outer loop
           // again which will call fi_cq_read to progress the endpoint and
@@ -5222,7 +6494,7 @@ void processRxAmReqCQ(void) {
           //
           post = true;
         }
-        ofi_msg_i = 1-ofi_msg_i;
+        rcip->msg_i = 1-rcip->msg_i;
       }
       CHK_TRUE((cqes[i].flags & ~(FI_MSG | FI_RECV | FI_MULTI_RECV)) == 0);
     }
@@ -5230,11 +6502,11 @@ void processRxAmReqCQ(void) {
 }
 
 static
-void processRxAmReq(void) {
-  if (ofi_rxCntr == NULL) {
-    processRxAmReqCQ();
+void processRxAmReq(struct perRxCtxInfo_t* rcip) {
+  if (rcip->rxCntr == NULL) {
+    processRxAmReqCQ(rcip);
   } else {
-    processRxAmReqCntr();
+    processRxAmReqCntr(rcip);
   }
 }
 
@@ -5295,20 +6567,29 @@ void amWrapExecOnLrgBody(struct amRequest_execOnLrg_t* xol) {
 
   size_t payloadSize = comm->argSize
                        - offsetof(chpl_comm_on_bundle_t, payload);
-  CHK_TRUE(mrGetKey(NULL, NULL, node, xol->pPayload, payloadSize));
-  ofi_get(&bundle->payload, node, xol->pPayload, payloadSize);
+  if (xol->pSlotFree != NULL) {
+    //
+    // The initiator already put the payload in one of our landing zone
+    // slots.  Copy it out and tell them the slot is free again.
+    //
+    memcpy(&bundle->payload, xol->pPayload, payloadSize);
+    amPutDone(node, (amDone_t*) xol->pSlotFree);
+  } else {
+    CHK_TRUE(mrGetKey(NULL, NULL, node, xol->pPayload, payloadSize));
+    ofi_get(&bundle->payload, node, xol->pPayload, payloadSize);
 
-  //
-  // Iff this is a nonblocking executeOn, now that we have the payload
-  // we can free the copy of it on the initiating side.  In the blocking
-  // case the initiator will free it if that is necessary, since they
-  // have to wait for the whole executeOn to complete anyway.  We save
-  // some time here by not waiting for a network response.  Either we or
-  // someone else will consume that completion later.  In the meantime
-  // we can go ahead with the executeOn body.
-  //
-  if (comm->pAmDone == NULL) {
-    amRequestFree(node, xol->pPayload);
+    //
+    // Iff this is a nonblocking executeOn, now that we have the payload
+    // we can free the copy of it on the initiating side.  In the
+    // blocking case the initiator will free it if that is necessary,
+    // since they have to wait for the whole executeOn to complete
+    // anyway.  We save some time here by not waiting for a network
+    // response.  Either we or someone else will consume that completion
+    // later.  In the meantime we can go ahead with the executeOn body.
+    //
+    if (comm->pAmDone == NULL) {
+      amRequestFree(node, xol->pPayload);
+    }
   }
 
   //
@@ -5520,6 +6801,7 @@ void nb_handle_init(nb_handle_t h) {
   h->reported = false;
   atomic_init_bool(&h->complete, false);
   h->mrAddr = NULL;
+  h->mrEnt = NULL;
   h->addr = NULL;
   h->size = 0;
   h->next = NULL;
@@ -5530,6 +6812,17 @@ void nb_handle_destroy(nb_handle_t h) {
   atomic_destroy_bool(&h->complete);
 }
 
+// For an operation that finished without going through the fabric.
+// A NULL handle means the operation is complete.
+static inline
+nb_handle_t nb_handle_completed(nb_handle_t h) {
+  if (h != NULL) {
+    atomic_store_bool(&h->complete, true);
+    h->reported = true;
+  }
+  return h;
+}
+
 /*
  * put_prologue
  *
@@ -5566,6 +6859,7 @@ chpl_bool put_prologue(void* addr, c_nodeid_t node, void* raddr, size_t size,
   }
 
   chpl_comm_diags_verbose_rdma("put", node, size, ln, fn, commID);
+  chpl_comm_diags_matrix_add(node, size);
   return true;
 }
 
@@ -5590,8 +6884,10 @@ chpl_comm_nb_handle_t chpl_comm_put_nb(void* addr, c_nodeid_t node,
 
   nb_handle_t handle = NULL;
   if (put_prologue(addr, node, raddr, size, commID, ln, fn)) {
+    uint64_t t0 = chpl_comm_diags_hist_start();
     handle = ofi_put_nb(handle, addr, node, raddr, size);
     chpl_comm_diags_incr(put_nb);
+    chpl_comm_diags_hist_end(put_nb, size, t0);
   }
   return (chpl_comm_nb_handle_t) handle;
 }
@@ -5632,6 +6928,7 @@ chpl_bool get_prologue(void* addr, c_nodeid_t node, void* raddr, size_t size,
   }
 
   chpl_comm_diags_verbose_rdma("get", node, size, ln, fn, commID);
+  chpl_comm_diags_matrix_add(node, size);
   return true;
 }
 
@@ -5640,8 +6937,10 @@ chpl_comm_nb_handle_t chpl_comm_get_nb(void* addr, c_nodeid_t node,
                                        int32_t commID, int ln, int32_t fn) {
   nb_handle_t handle = NULL;
   if (get_prologue(addr, node, raddr, size, commID, ln, fn)) {
+    uint64_t t0 = chpl_comm_diags_hist_start();
     handle = ofi_get_nb(handle, addr, node, raddr, size);
     chpl_comm_diags_incr(get_nb);
+    chpl_comm_diags_hist_end(get_nb, size, t0);
   }
   return (chpl_comm_nb_handle_t) handle;
 }
@@ -5707,9 +7006,9 @@ chpl_bool check_complete(nb_handle_t *handles, size_t nhandles,
             // if a suboperation just completed then unlocalize mr
             if ((p != handle) && (!p->reported) && (p->mrAddr != NULL)) {
               if (p->size) {
-                mrUnLocalizeTarget(p->mrAddr, p->addr, p->size);
+                mrUnLocalizeTarget(p->mrAddr, p->addr, p->size, p->mrEnt);
               } else {
-                mrUnLocalizeSource(p->mrAddr, p->addr);
+                mrUnLocalizeSource(p->mrAddr, p->addr, p->mrEnt);
               }
               p->mrAddr = NULL;
             }
@@ -5721,9 +7020,10 @@ chpl_bool check_complete(nb_handle_t *handles, size_t nhandles,
         // mark top handle as complete and unlocalize its mr
         completed = true;
         if (handle->size) {
-          mrUnLocalizeTarget(handle->mrAddr, handle->addr, handle->size);
+          mrUnLocalizeTarget(handle->mrAddr, handle->addr, handle->size,
+                             handle->mrEnt);
         } else {
-          mrUnLocalizeSource(handle->mrAddr, handle->addr);
+          mrUnLocalizeSource(handle->mrAddr, handle->addr, handle->mrEnt);
         }
         handle->mrAddr = NULL;
         handle->reported = true;
@@ -5765,37 +7065,212 @@ int chpl_comm_try_nb_some(chpl_comm_nb_handle_t* h, size_t nhandles) {
   return try_nb_some((nb_handle_t *) h, nhandles);
 }
 
-void chpl_comm_free_nb_handle(chpl_comm_nb_handle_t h) {
-  nb_handle_t handle = (nb_handle_t) h;
-  nb_handle_t next;
-  for (; handle != NULL; handle = next) {
-    next = handle->next;
-    nb_handle_destroy(handle);
-    chpl_mem_free(handle, 0, 0);
+void chpl_comm_free_nb_handle(chpl_comm_nb_handle_t h) {
+  nb_handle_t handle = (nb_handle_t) h;
+  nb_handle_t next;
+  for (; handle != NULL; handle = next) {
+    next = handle->next;
+    nb_handle_destroy(handle);
+    chpl_mem_free(handle, 0, 0);
+  }
+}
+
+void chpl_comm_put(void* addr, c_nodeid_t node, void* raddr,
+                   size_t size, int32_t commID, int ln, int32_t fn) {
+  DBG_PRINTF(DBG_IFACE,
+             "%s(%p, %d, %p, %zd, %d)", __func__,
+             addr, (int) node, raddr, size, (int) commID);
+
+  if (put_prologue(addr, node, raddr, size, commID, ln, fn)) {
+    uint64_t t0 = chpl_comm_diags_hist_start();
+    ofi_put(addr, node, raddr, size);
+    chpl_comm_diags_incr(put);
+    chpl_comm_diags_hist_end(put, size, t0);
+  }
+}
+
+void chpl_comm_get(void* addr, int32_t node, void* raddr,
+                   size_t size, int32_t commID, int ln, int32_t fn) {
+  DBG_PRINTF(DBG_IFACE,
+             "%s(%p, %d, %p, %zd, %d)", __func__,
+             addr, (int) node, raddr, size, (int) commID);
+
+  if (get_prologue(addr, node, raddr, size, commID, ln, fn)) {
+    uint64_t t0 = chpl_comm_diags_hist_start();
+    ofi_get(addr, node, raddr, size);
+    chpl_comm_diags_incr(get);
+    chpl_comm_diags_hist_end(get, size, t0);
+  }
+}
+
+
+/*
+ * strd_nb_common
+ *
+ * Initiates all the contiguous chunks of a remote strided transfer and
+ * returns a single handle for them.  Each chunk's handle list (more than
+ * one handle if the chunk is larger than the fabric's max message size)
+ * is appended to the previous one's, and since check_complete() etc.
+ * treat a handle list as one operation, the result works with all the
+ * usual non-blocking interface functions.
+ */
+static
+nb_handle_t strd_nb_common(chpl_bool isPut, c_nodeid_t node,
+                           void* dstaddr, size_t* dststrides,
+                           void* srcaddr, size_t* srcstrides,
+                           size_t* count, int32_t stridelevels,
+                           size_t elemSize) {
+  const size_t chunkSize = count[0] * elemSize;
+  if (chunkSize == 0) {
+    return NULL;
+  }
+  for (int l = 1; l <= stridelevels; l++) {
+    if (count[l] == 0) {
+      return NULL;
+    }
+  }
+
+  size_t idx[stridelevels + 1];
+  memset(idx, 0, sizeof(idx));
+  nb_handle_t first = NULL;
+  nb_handle_t last = NULL;
+
+  while (true) {
+    char* dst = (char*) dstaddr;
+    char* src = (char*) srcaddr;
+    for (int l = 0; l < stridelevels; l++) {
+      dst += idx[l] * dststrides[l] * elemSize;
+      src += idx[l] * srcstrides[l] * elemSize;
+    }
+
+    nb_handle_t h = isPut
+                    ? ofi_put_nb(NULL, src, node, dst, chunkSize)
+                    : ofi_get_nb(NULL, dst, node, src, chunkSize);
+    if (isPut) {
+      chpl_comm_diags_incr(put_nb);
+    } else {
+      chpl_comm_diags_incr(get_nb);
+    }
+    if (h != NULL) {
+      if (last == NULL) {
+        first = h;
+      } else {
+        last->next = h;
+      }
+      for (last = h; last->next != NULL; last = last->next)
+        ;
+    }
+
+    int l;
+    for (l = 0; l < stridelevels && ++idx[l] == count[l + 1]; l++) {
+      idx[l] = 0;
+    }
+    if (l == stridelevels) {
+      break;
+    }
+  }
+
+  return first;
+}
+
+
+chpl_comm_nb_handle_t chpl_comm_put_strd_nb(void* dstaddr_arg,
+                                            size_t* dststrides,
+                                            c_nodeid_t dstnode,
+                                            void* srcaddr_arg,
+                                            size_t* srcstrides,
+                                            size_t* count,
+                                            int32_t stridelevels,
+                                            size_t elemSize, int32_t commID,
+                                            int ln, int32_t fn) {
+  DBG_PRINTF(DBG_IFACE,
+             "%s(%p, %p, %d, %p, %p, %p, %d, %zd, %d)", __func__,
+             dstaddr_arg, dststrides, (int) dstnode, srcaddr_arg, srcstrides,
+             count, (int) stridelevels, elemSize, (int) commID);
+
+  if (dstnode == chpl_nodeID) {
+    put_strd_common(dstaddr_arg, dststrides,
+                    dstnode,
+                    srcaddr_arg, srcstrides,
+                    count, stridelevels, elemSize,
+                    1, NULL,
+                    commID, ln, fn);
+    return NULL;
+  }
+
+  retireDelayedAmDone(false /*taskIsEnding*/);
+
+  if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_put_strd)) {
+      chpl_comm_cb_info_t cb_data =
+        {chpl_comm_cb_event_kind_put_strd, chpl_nodeID, dstnode,
+         .iu.comm_strd={srcaddr_arg, srcstrides, dstaddr_arg, dststrides,
+                        count, stridelevels, elemSize, commID, ln, fn}};
+      chpl_comm_do_callbacks (&cb_data);
   }
+
+  chpl_comm_diags_verbose_rdmaStrd("put", dstnode, ln, fn, commID);
+  return (chpl_comm_nb_handle_t)
+         strd_nb_common(true /*isPut*/, dstnode, dstaddr_arg, dststrides,
+                        srcaddr_arg, srcstrides, count, stridelevels,
+                        elemSize);
 }
 
-void chpl_comm_put(void* addr, c_nodeid_t node, void* raddr,
-                   size_t size, int32_t commID, int ln, int32_t fn) {
+
+chpl_comm_nb_handle_t chpl_comm_get_strd_nb(void* dstaddr_arg,
+                                            size_t* dststrides,
+                                            c_nodeid_t srcnode,
+                                            void* srcaddr_arg,
+                                            size_t* srcstrides,
+                                            size_t* count,
+                                            int32_t stridelevels,
+                                            size_t elemSize, int32_t commID,
+                                            int ln, int32_t fn) {
   DBG_PRINTF(DBG_IFACE,
-             "%s(%p, %d, %p, %zd, %d)", __func__,
-             addr, (int) node, raddr, size, (int) commID);
+             "%s(%p, %p, %d, %p, %p, %p, %d, %zd, %d)", __func__,
+             dstaddr_arg, dststrides, (int) srcnode, srcaddr_arg, srcstrides,
+             count, (int) stridelevels, elemSize, (int) commID);
 
-  if (put_prologue(addr, node, raddr, size, commID, ln, fn)) {
-    ofi_put(addr, node, raddr, size);
-    chpl_comm_diags_incr(put);
+  if (srcnode == chpl_nodeID) {
+    get_strd_common(dstaddr_arg, dststrides,
+                    srcnode,
+                    srcaddr_arg, srcstrides,
+                    count, stridelevels, elemSize,
+                    1, NULL,
+                    commID, ln, fn);
+    return NULL;
+  }
+
+  retireDelayedAmDone(false /*taskIsEnding*/);
+
+  if (chpl_comm_have_callbacks(chpl_comm_cb_event_kind_get_strd)) {
+      chpl_comm_cb_info_t cb_data =
+        {chpl_comm_cb_event_kind_get_strd, chpl_nodeID, srcnode,
+         .iu.comm_strd={srcaddr_arg, srcstrides, dstaddr_arg, dststrides,
+                        count, stridelevels, elemSize, commID, ln, fn}};
+      chpl_comm_do_callbacks (&cb_data);
   }
+
+  chpl_comm_diags_verbose_rdmaStrd("get", srcnode, ln, fn, commID);
+  return (chpl_comm_nb_handle_t)
+         strd_nb_common(false /*isPut*/, srcnode, dstaddr_arg, dststrides,
+                        srcaddr_arg, srcstrides, count, stridelevels,
+                        elemSize);
 }
 
-void chpl_comm_get(void* addr, int32_t node, void* raddr,
-                   size_t size, int32_t commID, int ln, int32_t fn) {
-  DBG_PRINTF(DBG_IFACE,
-             "%s(%p, %d, %p, %zd, %d)", __func__,
-             addr, (int) node, raddr, size, (int) commID);
 
-  if (get_prologue(addr, node, raddr, size, commID, ln, fn)) {
-    ofi_get(addr, node, raddr, size);
-    chpl_comm_diags_incr(get);
+//
+// The blocking strided transfers just start the non-blocking ones and
+// wait for them, so that all the chunks are in flight at once instead
+// of one at a time.
+//
+static inline
+void strd_wait(chpl_comm_nb_handle_t h) {
+  nb_handle_t handle = (nb_handle_t) h;
+  if (handle != NULL) {
+    do {
+      wait_nb_some(&handle, 1);
+    } while (!test_nb_complete(handle));
+    chpl_comm_free_nb_handle(h);
   }
 }
 
@@ -5805,17 +7280,10 @@ void chpl_comm_put_strd(void* dstaddr_arg, size_t* dststrides,
                         void* srcaddr_arg, size_t* srcstrides,
                         size_t* count, int32_t stridelevels, size_t elemSize,
                         int32_t commID, int ln, int32_t fn) {
-  DBG_PRINTF(DBG_IFACE,
-             "%s(%p, %p, %d, %p, %p, %p, %d, %zd, %d)", __func__,
-             dstaddr_arg, dststrides, (int) dstnode, srcaddr_arg, srcstrides,
-             count, (int) stridelevels, elemSize, (int) commID);
-
-  put_strd_common(dstaddr_arg, dststrides,
-                  dstnode,
-                  srcaddr_arg, srcstrides,
-                  count, stridelevels, elemSize,
-                  1, NULL,
-                  commID, ln, fn);
+  strd_wait(chpl_comm_put_strd_nb(dstaddr_arg, dststrides, dstnode,
+                                  srcaddr_arg, srcstrides,
+                                  count, stridelevels, elemSize,
+                                  commID, ln, fn));
 }
 
 
@@ -5824,17 +7292,10 @@ void chpl_comm_get_strd(void* dstaddr_arg, size_t* dststrides,
                         void* srcaddr_arg, size_t* srcstrides, size_t* count,
                         int32_t stridelevels, size_t elemSize,
                         int32_t commID, int ln, int32_t fn) {
-  DBG_PRINTF(DBG_IFACE,
-             "%s(%p, %p, %d, %p, %p, %p, %d, %zd, %d)", __func__,
-             dstaddr_arg, dststrides, (int) srcnode, srcaddr_arg, srcstrides,
-             count, (int) stridelevels, elemSize, (int) commID);
-
-  get_strd_common(dstaddr_arg, dststrides,
-                  srcnode,
-                  srcaddr_arg, srcstrides,
-                  count, stridelevels, elemSize,
-                  1, NULL,
-                  commID, ln, fn);
+  strd_wait(chpl_comm_get_strd_nb(dstaddr_arg, dststrides, srcnode,
+                                  srcaddr_arg, srcstrides,
+                                  count, stridelevels, elemSize,
+                                  commID, ln, fn));
 }
 
 
@@ -5913,6 +7374,7 @@ void chpl_comm_get_unordered(void* addr, c_nodeid_t node, void* raddr,
 
   chpl_comm_diags_verbose_rdma("unordered get", node, size, ln, fn, commID);
   chpl_comm_diags_incr(get);
+  chpl_comm_diags_matrix_add(node, size);
 
   do_remote_get_buff(addr, node, raddr, size);
 }
@@ -5951,6 +7413,7 @@ void chpl_comm_put_unordered(void* addr, c_nodeid_t node, void* raddr,
 
   chpl_comm_diags_verbose_rdma("unordered put", node, size, ln, fn, commID);
   chpl_comm_diags_incr(put);
+  chpl_comm_diags_matrix_add(node, size);
 
   do_remote_put_buff(addr, node, raddr, size);
 }
@@ -5989,6 +7452,30 @@ static struct perTxCtxInfo_t* tciAllocCommon(chpl_bool);
 static struct perTxCtxInfo_t* findFreeTciTabEntry(chpl_bool);
 
 static __thread struct perTxCtxInfo_t* _ttcip;
+static __thread int _ttciHome = -1;     // preferred unbound worker tciTab[]
+static __thread int _ttcipDepth;        // nesting of bound tciAlloc()s
+
+//
+// When there's a progress thread, it and the owner of a bound worker tx
+// context take turns using it.  The owner holds it from its outermost
+// tciAlloc() to the matching tciFree(), and the progress thread only
+// ever tries for it.
+//
+static inline
+void tciBoundAcquire(struct perTxCtxInfo_t* tcip) {
+  if (progressThreadRunning && !isAmHandler && _ttcipDepth++ == 0) {
+    while (atomic_exchange_bool(&tcip->progressLock, true)) {
+      local_yield();
+    }
+  }
+}
+
+static inline
+void tciBoundRelease(struct perTxCtxInfo_t* tcip) {
+  if (progressThreadRunning && !isAmHandler && --_ttcipDepth == 0) {
+    atomic_store_bool(&tcip->progressLock, false);
+  }
+}
 
 
 static inline
@@ -6012,6 +7499,7 @@ struct perTxCtxInfo_t* tciAllocCommon(chpl_bool bindToAmHandler) {
     //
     if (_ttcip->bound) {
       DBG_PRINTF(DBG_TCIPS, "realloc bound tciTab[%td]", _ttcip - tciTab);
+      tciBoundAcquire(_ttcip);
       return _ttcip;
     }
 
@@ -6039,6 +7527,9 @@ struct perTxCtxInfo_t* tciAllocCommon(chpl_bool bindToAmHandler) {
   }
   DBG_PRINTF(DBG_TCIPS, "alloc%s tciTab[%td] %p",
              _ttcip->bound ? " bound" : "", _ttcip - tciTab, _ttcip);
+  if (_ttcip->bound) {
+    tciBoundAcquire(_ttcip);
+  }
   return _ttcip;
 }
 
@@ -6057,27 +7548,42 @@ struct perTxCtxInfo_t* findFreeTciTabEntry(chpl_bool bindToAmHandler) {
 
   if (bindToAmHandler) {
     //
-    // AM handlers use tciTab[numWorkerTxCtxs .. tciTabLen - 1].  For
-    // now we only support a single AM handler, so this is simple.  If
-    // we ever have more, the CHK_FALSE will force us to revisit this.
+    // AM handlers use tciTab[numWorkerTxCtxs .. tciTabLen - 1].  There
+    // is exactly one entry per handler, so one of them must be free.
     //
-    tcip = &tciTab[numWorkerTxCtxs];
-    CHK_TRUE(tciAllocTabEntry(tcip));
-    return tcip;
+    for (int i = numWorkerTxCtxs; i < tciTabLen; i++) {
+      tcip = &tciTab[i];
+      if (tciAllocTabEntry(tcip)) {
+        return tcip;
+      }
+    }
+    CHK_TRUE(false);
+    return NULL;
   }
 
   //
-  // Workers use tciTab[0 .. numWorkerTxCtxs - 1].  Search forever for
-  // an entry we can use.  Give up (and kill the program) only if we
-  // discover they're all bound, because if that's true we can predict
-  // we'll never find a free one.
+  // Workers use tciTab[0 .. numWorkerTxCtxs - 1].  Each thread has a
+  // home entry, handed out round-robin, so that threads don't all
+  // contend for the same entries.  Try that first, then steal the
+  // next free one after it.  Search forever for an entry we can use.
+  // Give up (and kill the program) only if we discover they're all
+  // bound, because if that's true we can predict we'll never find a
+  // free one.
   //
-  static __thread int last_iw = 0;
+  if (_ttciHome < 0) {
+    _ttciHome = atomic_fetch_add_uint_least32_t(&tciHomeNext, 1)
+                % numWorkerTxCtxs;
+  }
+
+  if (tciAllocTabEntry(&tciTab[_ttciHome])) {
+    return &tciTab[_ttciHome];
+  }
+
   tcip = NULL;
 
   do {
-    int iw = last_iw;
-    chpl_bool allBound = true;
+    int iw = _ttciHome;
+    chpl_bool allBound = tciTab[iw].bound;
 
     do {
       if (++iw >= numWorkerTxCtxs)
@@ -6086,25 +7592,32 @@ struct perTxCtxInfo_t* findFreeTciTabEntry(chpl_bool bindToAmHandler) {
       if (tciAllocTabEntry(&tciTab[iw])) {
         tcip = &tciTab[iw];
       }
-    } while (tcip == NULL && iw != last_iw);
+    } while (tcip == NULL && iw != _ttciHome);
 
     if (tcip == NULL) {
       CHK_FALSE(allBound);
+      chpl_comm_diags_incr(tci_wait);
       local_yield();
     }
   } while (tcip == NULL);
 
+  if (tcip != &tciTab[_ttciHome]) {
+    chpl_comm_diags_incr(tci_steal);
+  }
   return tcip;
 }
 
 
 //
 // This returns true if you successfully allocated the given tciTab
-// entry and false otherwise.
+// entry and false otherwise.  Look before we leap, so that scanning
+// busy entries doesn't bounce their cache lines around.
 //
 static inline
 chpl_bool tciAllocTabEntry(struct perTxCtxInfo_t* tcip) {
-  return(!atomic_exchange_bool(&tcip->allocated, true));
+  return(!atomic_load_explicit_bool(&tcip->allocated,
+                                    chpl_memory_order_relaxed)
+         && !atomic_exchange_bool(&tcip->allocated, true));
 }
 
 
@@ -6118,6 +7631,8 @@ void tciFree(struct perTxCtxInfo_t* tcip) {
     waitForAllTxnsComplete(tcip);
     forceMemFxVisAllNodes(true, true, -1, tcip);
     atomic_store_bool(&tcip->allocated, false);
+  } else {
+    tciBoundRelease(tcip);
   }
 }
 
@@ -6144,6 +7659,149 @@ typedef void (rmaPutFn_t)(nb_handle_t handle, void* myAddr, void* mrDesc,
 
 static rmaPutFn_t rmaPutFn_selector;
 
+static
+void stripeRailProgress(struct stripeRail_t* rail) {
+  struct fi_cq_entry cqes[16];
+  ssize_t ret;
+  while ((ret = fi_cq_read(rail->cq, cqes, sizeof(cqes) / sizeof(cqes[0])))
+         > 0) {
+    for (ssize_t i = 0; i < ret; i++) {
+      atomic_store_explicit_bool((chpl_atomic_bool*) cqes[i].op_context,
+                                 true, chpl_memory_order_release);
+    }
+  }
+  if (ret == -FI_EAVAIL) {
+    reportCQError(rail->cq);
+  }
+  CHK_TRUE(ret == -FI_EAGAIN || ret == -FI_EAVAIL);
+}
+
+
+/*
+ * ofi_stripe
+ *
+ * Blocking PUT or GET split across the primary NIC and the striping
+ * rails.  Returns false, having done nothing, if the transfer isn't
+ * eligible: both sides must be in the registered regions, because the
+ * rails can't bounce or use the registration cache.
+ */
+static
+chpl_bool ofi_stripe(chpl_bool isPut, void* addr, c_nodeid_t node,
+                     void* raddr, size_t size) {
+  int locIdx = 0;
+  int remIdx = 0;
+  if (!scalableMemReg) {
+    struct memEntry* locMr = getMemEntry(&memTab, addr, size);
+    struct memEntry* remMr = getMemEntry(&memTabMap[node], raddr, size);
+    if (locMr == NULL || remMr == NULL) {
+      return false;
+    }
+    locIdx = locMr - &memTab[0];
+    remIdx = remMr - &memTabMap[node][0];
+  }
+
+  const int numParts = numStripeRails + 1;
+  size_t partSize = (size + numParts - 1) / numParts;
+  for (int r = 0; r < numStripeRails; r++) {
+    if (partSize > stripeRails[r].info->ep_attr->max_msg_size) {
+      return false;
+    }
+  }
+
+  //
+  // The rails aren't ordered with respect to the primary, so first
+  // make sure anything we've already done to this node is visible.
+  //
+  struct perTxCtxInfo_t* tcip;
+  CHK_TRUE((tcip = tciAlloc()) != NULL);
+  if (tcip->bound) {
+    forceMemFxVisOneNode(node, true /*checkPuts*/, true /*checkAmos*/, tcip);
+  }
+  tciFree(tcip);
+
+  DBG_PRINTF(DBG_RMA | (isPut ? DBG_RMA_WRITE : DBG_RMA_READ),
+             "stripe %s %d:%p %s %p, size %zd, %d parts",
+             isPut ? "PUT" : "GET", (int) node, raddr,
+             isPut ? "<=" : "=>", addr, size, numParts);
+
+  //
+  // Start the rail parts, then do the first part ourselves on the
+  // primary NIC while they proceed.
+  //
+  chpl_atomic_bool done[MAX_STRIPE_RAILS];
+  for (int r = 0; r < numStripeRails; r++) {
+    struct stripeRail_t* rail = &stripeRails[r];
+    size_t off = (r + 1) * partSize;
+    size_t len = (off >= size) ? 0 : (size - off < partSize)
+                                      ? size - off : partSize;
+    atomic_init_bool(&done[r], len == 0);
+    if (len == 0) {
+      continue;
+    }
+
+    uint64_t key = scalableMemReg
+                   ? 0 : rail->keyMap[node * MAX_MEM_REGIONS + remIdx];
+    uint64_t rOff = (uint64_t) raddr + off
+                    - (scalableMemReg ? 0 : memTabMap[node][remIdx].base);
+    struct iovec iov = { .iov_base = (char*) addr + off, .iov_len = len };
+    struct fi_rma_iov rma_iov = { .addr = rOff, .len = len, .key = key };
+    void* desc = scalableMemReg ? NULL : rail->descTab[locIdx];
+    struct fi_msg_rma msg = { .msg_iov = &iov,
+                              .desc = &desc,
+                              .iov_count = 1,
+                              .addr = rail->addrs[node],
+                              .rma_iov = &rma_iov,
+                              .rma_iov_count = 1,
+                              .context = &done[r],
+                              .data = 0, };
+
+    PTHREAD_CHK(pthread_mutex_lock(&rail->lock));
+    ssize_t ret;
+    do {
+      ret = isPut
+            ? fi_writemsg(rail->ep, &msg,
+                          FI_COMPLETION | FI_DELIVERY_COMPLETE)
+            : fi_readmsg(rail->ep, &msg, FI_COMPLETION);
+      if (ret == -FI_EAGAIN) {
+        stripeRailProgress(rail);
+      }
+    } while (ret == -FI_EAGAIN);
+    OFI_CHK(ret);
+    PTHREAD_CHK(pthread_mutex_unlock(&rail->lock));
+  }
+
+  nb_handle handle_struct;
+  nb_handle_t handle = &handle_struct;
+  nb_handle_init(handle);
+  handle = isPut
+           ? ofi_put_nb(handle, addr, node, raddr, partSize)
+           : ofi_get_nb(handle, addr, node, raddr, partSize);
+  do {
+    wait_nb_some(&handle, 1);
+  } while (!test_nb_complete(handle));
+  if (handle->next != NULL) {
+    chpl_comm_free_nb_handle(handle->next);
+  }
+  nb_handle_destroy(handle);
+
+  for (int r = 0; r < numStripeRails; r++) {
+    struct stripeRail_t* rail = &stripeRails[r];
+    while (!atomic_load_explicit_bool(&done[r], chpl_memory_order_acquire)) {
+      if (pthread_mutex_trylock(&rail->lock) == 0) {
+        stripeRailProgress(rail);
+        PTHREAD_CHK(pthread_mutex_unlock(&rail->lock));
+      }
+      if (!atomic_load_explicit_bool(&done[r], chpl_memory_order_acquire)) {
+        local_yield();
+      }
+    }
+    atomic_destroy_bool(&done[r]);
+  }
+
+  return true;
+}
+
+
 /*
  * ofi_put
  *
@@ -6154,6 +7812,17 @@ static rmaPutFn_t rmaPutFn_selector;
 static inline
 void ofi_put(const void* addr, c_nodeid_t node, void* raddr, size_t size) {
 
+  void* shmAddr = chpl_comm_ofi_shm_addr(node, raddr, size);
+  if (shmAddr != NULL) {
+    memcpy(shmAddr, addr, size);
+    return;
+  }
+
+  if (numStripeRails > 0 && size >= envStripeMinSize
+      && ofi_stripe(true /*isPut*/, (void*) addr, node, raddr, size)) {
+    return;
+  }
+
   // Allocate the handle on the stack to avoid malloc overhead
   nb_handle handle_struct;
   nb_handle_t handle = &handle_struct;
@@ -6170,6 +7839,37 @@ void ofi_put(const void* addr, c_nodeid_t node, void* raddr, size_t size) {
   nb_handle_destroy(handle);
 }
 
+/*
+ * ofi_put_multi
+ *
+ * Blocking PUT of the same source to up to PUT_MULTI_MAX targets.  All
+ * the PUTs are initiated before we wait for any of them, so their
+ * round trips overlap instead of being serialized.
+ */
+static
+void ofi_put_multi(const void* addr, size_t size, int n,
+                   const c_nodeid_t* nodes, void* const* raddrs) {
+  nb_handle handle_structs[PUT_MULTI_MAX];
+  nb_handle_t handles[PUT_MULTI_MAX];
+
+  CHK_TRUE(n <= PUT_MULTI_MAX);
+  for (int i = 0; i < n; i++) {
+    nb_handle_init(&handle_structs[i]);
+    handles[i] = ofi_put_nb(&handle_structs[i], addr, nodes[i], raddrs[i],
+                            size);
+  }
+
+  for (int i = 0; i < n; i++) {
+    do {
+      wait_nb_some(&handles[i], 1);
+    } while (!test_nb_complete(handles[i]));
+    if (handles[i]->next != NULL) {
+      chpl_comm_free_nb_handle(handles[i]->next);
+    }
+    nb_handle_destroy(handles[i]);
+  }
+}
+
 /*
  * ofi_put_nb
  *
@@ -6187,6 +7887,12 @@ nb_handle_t ofi_put_nb(nb_handle_t handle, const void* addr, c_nodeid_t node,
   nb_handle_t prev = NULL;
   nb_handle_t first = NULL;
 
+  void* shmAddr = chpl_comm_ofi_shm_addr(node, raddr, size);
+  if (shmAddr != NULL) {
+    memcpy(shmAddr, addr, size);
+    return nb_handle_completed(handle);
+  }
+
   if (size > ofi_info->ep_attr->max_msg_size) {
     DBG_PRINTF(DBG_RMA | DBG_RMA_WRITE,
                "splitting large PUT %d:%p <= %p, size %zd",
@@ -6233,13 +7939,15 @@ nb_handle_t ofi_put_nb(nb_handle_t handle, const void* addr, c_nodeid_t node,
       }
 
       void* mrDesc;
-      void* myAddr = mrLocalizeSource(&mrDesc, (const void *) src,
+      struct mrCacheEntry* mrEnt;
+      void* myAddr = mrLocalizeSource(&mrDesc, &mrEnt, (const void *) src,
                                       chunkSize, "PUT src");
 
       rmaPutFn_selector(handle, myAddr, mrDesc, node, mrRaddr,
                         mrKey, chunkSize, tcip);
 
       handle->mrAddr = myAddr;
+      handle->mrEnt = mrEnt;
       handle->addr = src;
     } else {
       amRequestRmaPut(node, (void *) src, (void *) dest, size);
@@ -6562,6 +8270,17 @@ static rmaGetFn_t rmaGetFn_selector;
 static inline
 void ofi_get(void* addr, c_nodeid_t node, void* raddr, size_t size) {
 
+  void* shmAddr = chpl_comm_ofi_shm_addr(node, raddr, size);
+  if (shmAddr != NULL) {
+    memcpy(addr, shmAddr, size);
+    return;
+  }
+
+  if (numStripeRails > 0 && size >= envStripeMinSize
+      && ofi_stripe(false /*isPut*/, addr, node, raddr, size)) {
+    return;
+  }
+
   // Allocate the handle on the stack to avoid malloc overhead
   nb_handle handle_struct;
   nb_handle_t handle = &handle_struct;
@@ -6587,6 +8306,12 @@ nb_handle_t ofi_get_nb(nb_handle_t handle, void* addr, c_nodeid_t node,
   nb_handle_t prev = NULL;
   nb_handle_t first = NULL;
 
+  void* shmAddr = chpl_comm_ofi_shm_addr(node, raddr, size);
+  if (shmAddr != NULL) {
+    memcpy(addr, shmAddr, size);
+    return nb_handle_completed(handle);
+  }
+
   if (size > ofi_info->ep_attr->max_msg_size) {
     DBG_PRINTF(DBG_RMA | DBG_RMA_READ,
                "splitting large GET %d:%p <= %p, size %zd",
@@ -6633,13 +8358,15 @@ nb_handle_t ofi_get_nb(nb_handle_t handle, void* addr, c_nodeid_t node,
       }
 
       void* mrDesc;
-      void* myAddr = mrLocalizeTarget(&mrDesc, (const void *) dest,
+      struct mrCacheEntry* mrEnt;
+      void* myAddr = mrLocalizeTarget(&mrDesc, &mrEnt, (const void *) dest,
                                       chunkSize, "GET tgt");
 
       rmaGetFn_selector(handle, myAddr, mrDesc, node, mrRaddr,
                         mrKey, chunkSize, tcip);
 
       handle->mrAddr = myAddr;
+      handle->mrEnt = mrEnt;
       handle->addr = dest;
       handle->size = size;
     } else {
@@ -6996,13 +8723,19 @@ chpl_comm_nb_handle_t ofi_amo(c_nodeid_t node, uint64_t object, uint64_t mrKey,
   // just as fast to simply make the calls.
   //
   void* mrDescOpnd;
-  void* myOpnd = mrLocalizeSource(&mrDescOpnd, opnd, size, "AMO operand");
+  struct mrCacheEntry* mrEntOpnd;
+  void* myOpnd = mrLocalizeSource(&mrDescOpnd, &mrEntOpnd, opnd, size,
+                                  "AMO operand");
 
   void* mrDescCmpr;
-  void* myCmpr = mrLocalizeSource(&mrDescCmpr, cmpr, size, "AMO comparand");
+  struct mrCacheEntry* mrEntCmpr;
+  void* myCmpr = mrLocalizeSource(&mrDescCmpr, &mrEntCmpr, cmpr, size,
+                                  "AMO comparand");
 
   void* mrDescRes;
-  void* myRes = mrLocalizeTarget(&mrDescRes, result, size, "AMO result");
+  struct mrCacheEntry* mrEntRes;
+  void* myRes = mrLocalizeTarget(&mrDescRes, &mrEntRes, result, size,
+                                 "AMO result");
 
   struct perTxCtxInfo_t* tcip;
   CHK_TRUE((tcip = tciAlloc()) != NULL);
@@ -7036,9 +8769,9 @@ chpl_comm_nb_handle_t ofi_amo(c_nodeid_t node, uint64_t object, uint64_t mrKey,
 
   tciFree(tcip);
 
-  mrUnLocalizeTarget(myRes, result, size);
-  mrUnLocalizeSource(myCmpr, cmpr);
-  mrUnLocalizeSource(myOpnd, opnd);
+  mrUnLocalizeTarget(myRes, result, size, mrEntRes);
+  mrUnLocalizeSource(myCmpr, cmpr, mrEntCmpr);
+  mrUnLocalizeSource(myOpnd, opnd, mrEntOpnd);
 
   return ret;
 }
@@ -7392,9 +9125,11 @@ void amCheckRxTxCmpls(chpl_bool* pHadRxEvent, chpl_bool* pHadTxEvent,
   // progressing the receive checkpoint so that handshakes are received).
   // Inbound operations will be handled by the main loop. Also, avoid CPU
   // monopolization even if we had events, because we can't actually tell.
+  // Each AM handler progresses only its own receive endpoint.
 
+  struct perRxCtxInfo_t* rcip = (amRcip != NULL) ? amRcip : &rciTab[0];
   sched_yield();
-  int rc = fi_cq_read(ofi_rxCQ, NULL, 0);
+  int rc = fi_cq_read(rcip->rxCQ, NULL, 0);
   if (rc == 0) {
     if (pHadRxEvent != NULL) {
       *pHadRxEvent = true;
@@ -7919,7 +9654,7 @@ DEFN_IFACE_AMO_SUB(real64, FI_DOUBLE, _real64,  NEGATE_U_OR_R)
 void chpl_comm_atomic_unordered_task_fence(void) {
   DBG_PRINTF(DBG_IFACE_MCM, "%s()", __func__);
 
-  task_local_buff_flush(amo_nf_buff);
+  task_local_buff_flush(amo_nf_buff | am_buff);
 }
 
 
@@ -7927,134 +9662,251 @@ void chpl_comm_atomic_unordered_task_fence(void) {
 // internal AMO utilities
 //
 
-#define my_valid(typ, op) \
-  (fi_atomicvalid(ep, typ, op, &count) == 0 && count > 0)
-#define my_fetch_valid(typ, op) \
-  (fi_fetch_atomicvalid(ep, typ, op, &count) == 0 && count > 0)
-#define my_compare_valid(typ, op) \
-  (fi_compare_atomicvalid(ep, typ, op, &count) == 0 && count > 0)
+//
+// Network AMO capability table.  At startup we ask the provider which
+// (datatype, op) pairs it can do natively, for each of the non-fetching,
+// fetching, and compare flavors.  Then, per datatype, we decide whether
+// AMOs on that type go over the network at all.  This has to be an
+// all-or-nothing choice per type, because AMOs done by the NIC are not
+// atomic with respect to ones done by the CPU (that is, via AM) on the
+// same object.  But a type doesn't need every op to be native: if the
+// provider can do compare-and-swap on an unsigned integer of the same
+// size, any missing op can be emulated with a fetch/compute/CSWAP loop
+// that stays entirely on the NIC.
+//
+#define AMO_CAP_NF    ((uint8_t) 1 << 0)  // non-fetching
+#define AMO_CAP_FETCH ((uint8_t) 1 << 1)  // fetching
+#define AMO_CAP_CMP   ((uint8_t) 1 << 2)  // compare
+
+static uint8_t amoCapTab[FI_DATATYPE_LAST][FI_ATOMIC_OP_LAST];
+static chpl_bool amoValidByType[FI_DATATYPE_LAST];
+
+static inline
+enum fi_datatype amoUintType(size_t size) {
+  switch (size) {
+  case 1: return FI_UINT8;
+  case 2: return FI_UINT16;
+  case 4: return FI_UINT32;
+  default: return FI_UINT64;
+  }
+}
+
+static inline
+size_t amoTypeSize(enum fi_datatype ofiType) {
+  switch (ofiType) {
+  case FI_INT8:   case FI_UINT8:  return 1;
+  case FI_INT16:  case FI_UINT16: return 2;
+  case FI_INT32:  case FI_UINT32: case FI_FLOAT: return 4;
+  case FI_INT64:  case FI_UINT64: case FI_DOUBLE: return 8;
+  default: return 0;  // not a type Chapel does AMOs on
+  }
+}
+
+static inline
+chpl_bool amoCanEmulate(enum fi_datatype ofiType) {
+  const size_t size = amoTypeSize(ofiType);
+  return (size > 0
+          && (amoCapTab[amoUintType(size)][FI_CSWAP] & AMO_CAP_CMP) != 0);
+}
+
+static
+uint8_t computeAmoCaps(struct fid_domain* dom,
+                       enum fi_datatype ofiType, enum fi_op ofiOp) {
+  struct fi_atomic_attr attr;
+  uint8_t caps = 0;
+  if (ofiOp != FI_ATOMIC_READ && ofiOp != FI_CSWAP
+      && fi_query_atomic(dom, ofiType, ofiOp, &attr, 0) == 0
+      && attr.count > 0) {
+    caps |= AMO_CAP_NF;
+  }
+  if (ofiOp != FI_CSWAP
+      && fi_query_atomic(dom, ofiType, ofiOp, &attr, FI_FETCH_ATOMIC) == 0
+      && attr.count > 0) {
+    caps |= AMO_CAP_FETCH;
+  }
+  if (ofiOp == FI_CSWAP
+      && fi_query_atomic(dom, ofiType, ofiOp, &attr, FI_COMPARE_ATOMIC) == 0
+      && attr.count > 0) {
+    caps |= AMO_CAP_CMP;
+  }
+  return caps;
+}
 
 static
-int computeAtomicValid(enum fi_datatype ofiType) {
+chpl_bool computeAtomicValid(enum fi_datatype ofiType) {
+  if (amoTypeSize(ofiType) == 0) {
+    return false;
+  }
+
   //
-  // At least one provider (ofi_rxm) segfaults if the endpoint given to
-  // fi*atomicvalid() entirely lacks atomic caps.  The man page isn't
-  // clear on whether this should work, so just avoid that situation.
+  // These are the ops Chapel needs, in the flavors it needs them.  The
+  // bitwise ones only matter for integral types.
   //
-  if ((ofi_info->tx_attr->caps & FI_ATOMIC) == 0) {
-    return 0;
-  }
-
-  struct fid_ep* ep = tciTab[0].txCtx; // assume same answer for all endpoints
-  size_t count;                        // ignored
-
-  // For integral types, all operations matter.
-  if (ofiType == FI_INT8
-      || ofiType == FI_UINT8
-      || ofiType == FI_INT16
-      || ofiType == FI_UINT16
-      || ofiType == FI_INT32
-      || ofiType == FI_UINT32
-      || ofiType == FI_INT64
-      || ofiType == FI_UINT64) {
-    return (   my_valid(ofiType, FI_SUM)
-            && my_valid(ofiType, FI_BOR)
-            && my_valid(ofiType, FI_BAND)
-            && my_valid(ofiType, FI_BXOR)
-            && my_valid(ofiType, FI_MIN)
-            && my_valid(ofiType, FI_MAX)
-            && my_valid(ofiType, FI_ATOMIC_WRITE)
-            && my_fetch_valid(ofiType, FI_SUM)
-            && my_fetch_valid(ofiType, FI_BOR)
-            && my_fetch_valid(ofiType, FI_BAND)
-            && my_fetch_valid(ofiType, FI_BXOR)
-            && my_fetch_valid(ofiType, FI_MIN)
-            && my_fetch_valid(ofiType, FI_MAX)
-            && my_fetch_valid(ofiType, FI_ATOMIC_READ)
-            && my_fetch_valid(ofiType, FI_ATOMIC_WRITE)
-            && my_compare_valid(ofiType, FI_CSWAP));
-  }
-
-  //
-  // For real types, only sum, min, max, read, write, and cswap matter.
-  //
-  return (   my_valid(ofiType, FI_SUM)
-          && my_valid(ofiType, FI_MIN)
-          && my_valid(ofiType, FI_MAX)
-          && my_valid(ofiType, FI_ATOMIC_WRITE)
-          && my_fetch_valid(ofiType, FI_SUM)
-          && my_fetch_valid(ofiType, FI_MIN)
-          && my_fetch_valid(ofiType, FI_MAX)
-          && my_fetch_valid(ofiType, FI_ATOMIC_READ)
-          && my_fetch_valid(ofiType, FI_ATOMIC_WRITE)
-          && my_compare_valid(ofiType, FI_CSWAP));
+  static const struct { enum fi_op op; uint8_t need; chpl_bool intOnly; }
+    reqs[] = { { FI_SUM,          AMO_CAP_NF | AMO_CAP_FETCH, false },
+               { FI_BOR,          AMO_CAP_NF | AMO_CAP_FETCH, true  },
+               { FI_BAND,         AMO_CAP_NF | AMO_CAP_FETCH, true  },
+               { FI_BXOR,         AMO_CAP_NF | AMO_CAP_FETCH, true  },
+               { FI_MIN,          AMO_CAP_NF | AMO_CAP_FETCH, false },
+               { FI_MAX,          AMO_CAP_NF | AMO_CAP_FETCH, false },
+               { FI_ATOMIC_WRITE, AMO_CAP_NF | AMO_CAP_FETCH, false },
+               { FI_ATOMIC_READ,  AMO_CAP_FETCH,              false },
+               { FI_CSWAP,        AMO_CAP_CMP,                false }, };
+  const chpl_bool isReal = (ofiType == FI_FLOAT || ofiType == FI_DOUBLE);
 
+  chpl_bool allNative = true;
+  for (int i = 0; i < sizeof(reqs) / sizeof(reqs[0]); i++) {
+    if (reqs[i].intOnly && isReal) {
+      continue;
+    }
+    if ((amoCapTab[ofiType][reqs[i].op] & reqs[i].need) != reqs[i].need) {
+      allNative = false;
+    }
+  }
+  return allNative || amoCanEmulate(ofiType);
 }
 
 static
-int isAtomicValid(enum fi_datatype ofiType) {
-  static chpl_bool inited = false;
-  static int validByType[FI_DATATYPE_LAST];
+void init_amoCaps(void) {
+  //
+  // At least one provider (ofi_rxm) segfaults if the endpoint given to
+  // fi*atomicvalid() entirely lacks atomic caps.  The man page isn't
+  // clear on whether fi_query_atomic() is any better, so just avoid
+  // that situation.
+  //
+  if ((ofi_info->tx_attr->caps & FI_ATOMIC) == 0) {
+    return;
+  }
 
-  if (!inited) {
-    for (enum fi_datatype t = 0; t < FI_DATATYPE_LAST; t++) {
-      validByType[t]  = computeAtomicValid(t);
+  for (enum fi_datatype t = 0; t < FI_DATATYPE_LAST; t++) {
+    for (enum fi_op op = 0; op < FI_ATOMIC_OP_LAST; op++) {
+      amoCapTab[t][op] = computeAmoCaps(ofi_domain, t, op);
     }
-    inited = true;
+  }
+  for (enum fi_datatype t = 0; t < FI_DATATYPE_LAST; t++) {
+    amoValidByType[t] = computeAtomicValid(t);
+  }
+
 #ifdef CHPL_COMM_DEBUG
-    // Print a table of valid ops and types for debugging.
-    if (DBG_TEST_MASK(DBG_CFG_AMO) && (chpl_nodeID == 0) &&
-        (ofi_info->tx_attr->caps & FI_ATOMIC)) {
-      char buf[1024];
-      int offset;
-
-      DBG_PRINTF(DBG_CFG_AMO, "'+' denotes fetch supported.");
-      DBG_PRINTF(DBG_CFG_AMO, "'*' denotes compare supported.");
-      struct fid_ep* ep = tciTab[0].txCtx; // assume same answer for all
-                                           // endpoints
-
-      for (enum fi_datatype t = 0; t < FI_DATATYPE_LAST; t++) {
-        offset = 0;
-        offset += snprintf(buf + offset, sizeof(buf) - offset, "%s: ",
-                      fi_tostr(&t, FI_TYPE_ATOMIC_TYPE));
-        for (enum fi_op op = 0; op < FI_ATOMIC_OP_LAST; op++) {
-          size_t count; // needed by macros below
-          int valid = my_valid(t, op);
-          int fetch = my_fetch_valid(t, op);
-          int compare = my_compare_valid(t, op);
-          if (valid || fetch || compare) {
-            char suffix[3];
-            char *s = suffix;
-            if (fetch) {
-              *s++ = '+';
-            }
-            if (compare) {
-              *s++ = '*';
-            }
-            *s = '\0';
-            const char *sep = " ";
-            if (op == FI_ATOMIC_OP_LAST - 1) {
-              sep = "";
-            }
-            offset += snprintf(buf + offset, sizeof(buf) - offset, "%s%s%s",
-                            fi_tostr(&op, FI_TYPE_ATOMIC_OP), suffix, sep);
+  // Print a table of valid ops and types for debugging.
+  if (DBG_TEST_MASK(DBG_CFG_AMO) && (chpl_nodeID == 0)) {
+    char buf[1024];
+    int offset;
+
+    DBG_PRINTF(DBG_CFG_AMO, "'+' denotes fetch supported.");
+    DBG_PRINTF(DBG_CFG_AMO, "'*' denotes compare supported.");
+
+    for (enum fi_datatype t = 0; t < FI_DATATYPE_LAST; t++) {
+      offset = 0;
+      offset += snprintf(buf + offset, sizeof(buf) - offset, "%s: ",
+                    fi_tostr(&t, FI_TYPE_ATOMIC_TYPE));
+      for (enum fi_op op = 0; op < FI_ATOMIC_OP_LAST; op++) {
+        const uint8_t caps = amoCapTab[t][op];
+        if (caps != 0) {
+          char suffix[3];
+          char *s = suffix;
+          if ((caps & AMO_CAP_FETCH) != 0) {
+            *s++ = '+';
+          }
+          if ((caps & AMO_CAP_CMP) != 0) {
+            *s++ = '*';
           }
+          *s = '\0';
+          const char *sep = " ";
+          if (op == FI_ATOMIC_OP_LAST - 1) {
+            sep = "";
+          }
+          offset += snprintf(buf + offset, sizeof(buf) - offset, "%s%s%s",
+                          fi_tostr(&op, FI_TYPE_ATOMIC_OP), suffix, sep);
         }
-        DBG_PRINTF(DBG_CFG_AMO, "%s", buf);
-      }
-      for (enum fi_datatype t = 0; t < FI_DATATYPE_LAST; t++) {
-        DBG_PRINTF(DBG_CFG_AMO, "%s: %s", fi_tostr(&t, FI_TYPE_ATOMIC_TYPE),
-                   validByType[t] ? "valid" : "invalid");
       }
+      DBG_PRINTF(DBG_CFG_AMO, "%s", buf);
     }
+    for (enum fi_datatype t = 0; t < FI_DATATYPE_LAST; t++) {
+      DBG_PRINTF(DBG_CFG_AMO, "%s: %s", fi_tostr(&t, FI_TYPE_ATOMIC_TYPE),
+                 !amoValidByType[t] ? "invalid"
+                 : amoCanEmulate(t) ? "valid (emulation available)"
+                 : "valid");
+    }
+  }
 #endif
+}
+
+static inline
+int isAtomicValid(enum fi_datatype ofiType) {
+  return amoValidByType[ofiType];
+}
+
+
+//
+// Does a network AMO whose type is known to be valid, natively if the
+// provider can do that op in that flavor and otherwise by emulating it
+// with an unsigned-integer CSWAP loop.  This is blocking.
+//
+static
+void ofi_amo_emul(c_nodeid_t node, uint64_t object, uint64_t mrKey,
+                  const void* opnd, const void* cmpr, void* result,
+                  enum fi_op ofiOp, enum fi_datatype ofiType, size_t size) {
+  const enum fi_datatype uType = amoUintType(size);
+  chpl_amo_datum_t zero = { 0 };
+  chpl_amo_datum_t old, new, seen;
+
+  //
+  // A CSWAP of 0 for 0 gets us the current value without changing it.
+  //
+  (void) ofi_amo(node, object, mrKey, &zero, &zero, &old,
+                 FI_CSWAP, uType, size);
+  if (ofiOp != FI_ATOMIC_READ) {
+    while (true) {
+      if (ofiOp == FI_CSWAP) {
+        if (memcmp(&old, cmpr, size) != 0) {
+          break;
+        }
+        memcpy(&new, opnd, size);
+      } else {
+        new = old;
+        doCpuAMO(&new, opnd, NULL, NULL, ofiOp, ofiType, size);
+      }
+      (void) ofi_amo(node, object, mrKey, &new, &old, &seen,
+                     FI_CSWAP, uType, size);
+      if (memcmp(&seen, &old, size) == 0) {
+        break;
+      }
+      old = seen;
+    }
+  }
+
+  if (result != NULL) {
+    memcpy(result, &old, size);
   }
-  return validByType[ofiType];
 }
 
-#undef my_valid
-#undef my_fetch_valid
-#undef my_compare_valid
+static inline
+void ofi_amo_any(c_nodeid_t node, uint64_t object, uint64_t mrKey,
+                 const void* opnd, const void* cmpr, void* result,
+                 enum fi_op ofiOp, enum fi_datatype ofiType, size_t size) {
+  const uint8_t caps = amoCapTab[ofiType][ofiOp];
+  const uint8_t need = (ofiOp == FI_CSWAP) ? AMO_CAP_CMP
+                       : (result != NULL) ? AMO_CAP_FETCH
+                       : AMO_CAP_NF;
+  if ((caps & need) != 0) {
+    chpl_comm_diags_incr(amo_native);
+    ofi_amo(node, object, mrKey, opnd, cmpr, result, ofiOp, ofiType, size);
+  } else if (need == AMO_CAP_NF && (caps & AMO_CAP_FETCH) != 0) {
+    //
+    // Only the fetching flavor is native.  Use that and drop the result.
+    //
+    chpl_amo_datum_t dummy;
+    chpl_comm_diags_incr(amo_native);
+    ofi_amo(node, object, mrKey, opnd, cmpr, &dummy, ofiOp, ofiType, size);
+  } else {
+    DBG_PRINTF(DBG_AMO, "emulating AMO op %d type %d with CSWAP",
+               (int) ofiOp, (int) ofiType);
+    chpl_comm_diags_incr(amo_emulated);
+    ofi_amo_emul(node, object, mrKey, opnd, cmpr, result,
+                 ofiOp, ofiType, size);
+  }
+}
 
 
 static inline
@@ -8068,6 +9920,10 @@ void doAMO(c_nodeid_t node, void* object,
 
   retireDelayedAmDone(false /*taskIsEnding*/);
 
+  if (node != chpl_nodeID) {
+    chpl_comm_diags_matrix_add(node, size);
+  }
+  uint64_t t0 = chpl_comm_diags_hist_start();
   uint64_t mrKey;
   uint64_t mrRaddr;
   if (!isAtomicValid(ofiType)
@@ -8082,17 +9938,19 @@ void doAMO(c_nodeid_t node, void* object,
       }
       doCpuAMO(object, opnd, cmpr, result, ofiOp, ofiType, size);
     } else {
+      chpl_comm_diags_incr(amo_am);
       amRequestAMO(node, object, opnd, cmpr, result,
                    ofiOp, ofiType, size);
     }
   } else {
     //
     // The type is supported for network atomics and the object address
-    // is remotely accessible.  Do the AMO natively.
+    // is remotely accessible.  Do the AMO on the network.
     //
-    ofi_amo(node, mrRaddr, mrKey, opnd, cmpr, result,
-            ofiOp, ofiType, size);
+    ofi_amo_any(node, mrRaddr, mrKey, opnd, cmpr, result,
+                ofiOp, ofiType, size);
   }
+  chpl_comm_diags_hist_end(amo, size, t0);
 }
 
 
@@ -8360,12 +10218,25 @@ void do_remote_amo_nf_buff(void* opnd, c_nodeid_t node,
     if (node == chpl_nodeID) {
       doCpuAMO(object, opnd, NULL, NULL, ofiOp, ofiType, size);
     } else {
-      amRequestAMO(node, object, opnd, NULL, NULL,
-                   ofiOp, ofiType, size);
+      chpl_comm_diags_incr(amo_am);
+      if (!amAggregateAMO(node, object, opnd, ofiOp, ofiType, size)) {
+        amRequestAMO(node, object, opnd, NULL, NULL,
+                     ofiOp, ofiType, size);
+      }
     }
     return;
   }
 
+  //
+  // Only ops the provider can do natively without fetching can be
+  // buffered.  Anything else is done right away.
+  //
+  if ((amoCapTab[ofiType][ofiOp] & AMO_CAP_NF) == 0) {
+    ofi_amo_any(node, mrRaddr, mrKey, opnd, NULL, NULL, ofiOp, ofiType, size);
+    return;
+  }
+
+  chpl_comm_diags_incr(amo_native);
   amo_nf_buff_task_info_t* info = task_local_buff_acquire(amo_nf_buff);
   if (info == NULL) {
     ofi_amo(node, mrRaddr, mrKey, opnd, NULL, NULL, ofiOp, ofiType, size);
@@ -8453,9 +10324,10 @@ int32_t chpl_comm_getMaxThreads(void) {
 // doing so, in case the PUTs need to be done via AM for some reason
 // (unregistered memory, e.g.).
 //
-// TODO: vectorize the child PUTs.
+// The child release PUTs are all initiated before we wait for any of
+// them, so a parent's fan-out costs roughly one round trip.
 //
-#define BAR_TREE_NUM_CHILDREN 64
+#define BAR_TREE_NUM_CHILDREN PUT_MULTI_MAX
 
 typedef struct {
   volatile int child_notify[BAR_TREE_NUM_CHILDREN];
@@ -8557,13 +10429,14 @@ void chpl_comm_impl_barrier(const char *msg) {
   // Release our children.
   //
   if (bar_numChildren > 0) {
+    c_nodeid_t children[BAR_TREE_NUM_CHILDREN];
+    void* raddrs[BAR_TREE_NUM_CHILDREN];
     for (int i = 0; i < bar_numChildren; i++) {
-      c_nodeid_t child = bar_childFirst + i;
-      DBG_PRINTF(DBG_BARRIER, "BAR release child %d", (int) child);
-      ofi_put(&one, child,
-              (void*) &bar_infoMap[child]->parent_release,
-              sizeof(one));
+      children[i] = bar_childFirst + i;
+      raddrs[i] = (void*) &bar_infoMap[children[i]]->parent_release;
+      DBG_PRINTF(DBG_BARRIER, "BAR release child %d", (int) children[i]);
     }
+    ofi_put_multi(&one, sizeof(one), bar_numChildren, children, raddrs);
   }
 
   DBG_PRINTF(DBG_BARRIER, "barrier '%s' done via PUTs",
@@ -8839,6 +10712,7 @@ const char* am_opName(amOp_t op) {
   case am_opFree: return "opFree";
   case am_opNop: return "opNop";
   case am_opShutdown: return "opShutdown";
+  case am_opBatch: return "opBatch";
   default: return "op???";
   }
 }
@@ -69,6 +69,7 @@
 #include "chplexit.h"
 #include "chpl-format.h"
 #include "chpl-mem.h"
+#include "chpl-mem-arena.h"
 #include "chpl-mem-desc.h"
 #include "chpl-mem-sys.h"
 #include "chplsys.h"
@@ -260,6 +261,7 @@ static uint64_t debug_stats_flag = 0;
         MACRO(regMemRealloc_cnt)                                        \
         MACRO(regMemPostRealloc_cnt)                                    \
         MACRO(regMemFree_cnt)                                           \
+        MACRO(regMem_heapChunk_cnt)                                     \
         MACRO(regMem_bCast_cnt)                                         \
         MACRO(regMem_locks)                                             \
         MACRO(regMem_lock_nsecs)                                        \
@@ -535,6 +537,24 @@ static size_t hugepage_size;
 // Yield during comm
 static chpl_bool yield_during_comm;
 
+//
+// Dynamic heap extension chunks.  The memory layer asks for dynamic
+// heap extensions of whatever size it needs at the moment.  Giving
+// each of those its own registered region can use up the region table
+// (and the NIC's MDDs) in a long-running job that keeps allocating.
+// So instead we register the heap in chunks that start at
+// heap_chunk_min bytes and double each time up to heap_chunk_max, and
+// carve the extensions out of the current chunk.  A heap_chunk_max of
+// 0 turns this off.
+//
+static size_t heap_chunk_min;
+static size_t heap_chunk_max;
+static size_t heap_chunk_next;
+static char*  heap_chunk_base;
+static size_t heap_chunk_size;
+static size_t heap_chunk_used;
+static pthread_mutex_t heap_chunk_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 //
 // Memory region support.
 //
@@ -1473,6 +1493,7 @@ static void      post_rdma_and_wait(c_nodeid_t, gni_post_descriptor_t*,
                                     chpl_bool);
 static chpl_bool can_task_yield(void);
 static void      local_yield(void);
+static chpl_bool should_yield_during_comm(chpl_bool);
 
 
 //
@@ -1724,26 +1745,63 @@ typedef struct {
   mem_region_t*      remote_mr_v[MAX_CHAINED_AMO_LEN];
 } amo_nf_buff_task_info_t;
 
-// Per task information about GET buffers
+//
+// A chained transaction posted from a task local GET or PUT buffer.
+// We don't wait for these to complete until we need to reuse the
+// buffer they came from, or the task fences.  The descriptors have to
+// stay put until then, so they live here with the buffer.
+//
+typedef struct {
+  chpl_bool             active;
+#if HAVE_GNI_FMA_CHAIN_TRANSACTIONS
+  int                   cdi;
+  chpl_atomic_bool      done;
+  gni_post_descriptor_t pd;
+  union {
+    gni_ct_get_post_descriptor_t get[MAX_CHAINED_GET_LEN - 1];
+    gni_ct_put_post_descriptor_t put[MAX_CHAINED_PUT_LEN - 1];
+  } pdc;
+#endif
+} buff_chain_t;
+
+//
+// The GET and PUT buffers have two banks, so that a task can fill one
+// while the chained transaction from the other is in flight.
+//
+#define NUM_BUFF_BANKS 2
+
 typedef struct {
-  int           vi;
   void*         tgt_addr_v[MAX_CHAINED_GET_LEN];
   c_nodeid_t    locale_v[MAX_CHAINED_GET_LEN];
   mem_region_t* remote_mr_v[MAX_CHAINED_GET_LEN];
   void*         src_addr_v[MAX_CHAINED_GET_LEN];
   size_t        size_v[MAX_CHAINED_GET_LEN];
   mem_region_t* local_mr_v[MAX_CHAINED_GET_LEN];
+  buff_chain_t  chain;
+} get_buff_bank_t;
+
+// Per task information about GET buffers
+typedef struct {
+  int             vi;     // entries used in the current bank
+  int             cur;    // current bank
+  get_buff_bank_t bank[NUM_BUFF_BANKS];
 } get_buff_task_info_t;
 
-// Per task information about PUT buffers
 typedef struct {
-  int           vi;
   void*         tgt_addr_v[MAX_CHAINED_PUT_LEN];
   c_nodeid_t    locale_v[MAX_CHAINED_PUT_LEN];
   void*         src_addr_v[MAX_CHAINED_PUT_LEN];
   char          src_v[MAX_CHAINED_PUT_LEN][MAX_UNORDERED_TRANS_SZ];
   size_t        size_v[MAX_CHAINED_PUT_LEN];
   mem_region_t* remote_mr_v[MAX_CHAINED_PUT_LEN];
+  buff_chain_t  chain;
+} put_buff_bank_t;
+
+// Per task information about PUT buffers
+typedef struct {
+  int             vi;     // entries used in the current bank
+  int             cur;    // current bank
+  put_buff_bank_t bank[NUM_BUFF_BANKS];
 } put_buff_task_info_t;
 
 // Acquire a task local buffer, initializing if needed
@@ -1759,7 +1817,7 @@ void* task_local_buff_acquire(enum BuffType t) {
       prvData->TLS_NAME = chpl_mem_alloc(sizeof(TYPE),                        \
                                          CHPL_RT_MD_COMM_PER_LOC_INFO, 0, 0); \
       info = prvData->TLS_NAME;                                               \
-      info->vi = 0;                                                           \
+      memset(info, 0, sizeof(TYPE));                                          \
     }                                                                         \
     return info;                                                              \
   }
@@ -1785,7 +1843,7 @@ void task_local_buff_flush(enum BuffType t) {
 #define DEFINE_FLUSH(TYPE, TLS_NAME, FLUSH_NAME)                              \
   if (t & TLS_NAME) {                                                         \
     TYPE* info = prvData->TLS_NAME;                                           \
-    if (info != NULL && info->vi > 0) {                                       \
+    if (info != NULL) {                                                       \
       FLUSH_NAME(info);                                                       \
     }                                                                         \
   }
@@ -1806,7 +1864,7 @@ void task_local_buff_end(enum BuffType t) {
 #define DEFINE_END(TYPE, TLS_NAME, FLUSH_NAME)                                \
   if (t & TLS_NAME) {                                                         \
     TYPE* info = prvData->TLS_NAME;                                           \
-    if (info != NULL && info->vi > 0) {                                       \
+    if (info != NULL) {                                                       \
       FLUSH_NAME(info);                                                       \
       chpl_mem_free(info, 0, 0);                                              \
       prvData->TLS_NAME = NULL;                                               \
@@ -1905,6 +1963,14 @@ void chpl_comm_init(int *argc_p, char ***argv_p) {
   // We can reach 16k memory regions on Aries.
   max_mem_regions = chpl_env_rt_get_int("COMM_UGNI_MAX_MEM_REGIONS", 16384);
 
+  heap_chunk_min = chpl_env_rt_get_size("COMM_UGNI_HEAP_CHUNK_MIN",
+                                        (size_t) 64 << 20);
+  heap_chunk_max = chpl_env_rt_get_size("COMM_UGNI_HEAP_CHUNK_MAX",
+                                        (size_t) 1 << 30);
+  if (heap_chunk_min > heap_chunk_max)
+    heap_chunk_min = heap_chunk_max;
+  heap_chunk_next = heap_chunk_min;
+
   // Do extent MR checks to help catch subtle implementation bugs, but only
   // when the cache is off. Our extent MR tracking is based on our allocation
   // size, but the cache can read past an allocation to the end of a page
@@ -3414,11 +3480,12 @@ static void issue_out_of_mem_regions_warning(void)
   chpl_warning(buf, 0, 0);
 }
 
+static void* regMemAllocCommon(size_t, chpl_mem_descInt_t, int, int32_t);
+static void* heap_chunk_alloc(size_t, int, int32_t);
+
 void* chpl_comm_impl_regMemAlloc(size_t size,
                                  chpl_mem_descInt_t desc, int ln, int32_t fn)
 {
-  int mr_i;
-  mem_region_t* mr;
   void* p;
 
   if (get_hugepage_size() == 0)
@@ -3426,6 +3493,85 @@ void* chpl_comm_impl_regMemAlloc(size_t size,
 
   PERFSTATS_INC(regMemAlloc_cnt);
 
+  if (desc == CHPL_RT_MD_MEM_HEAP_SPACE
+      && heap_chunk_max > 0
+      && can_register_memory
+      && (p = heap_chunk_alloc(size, ln, fn)) != NULL) {
+    return p;
+  }
+
+  return regMemAllocCommon(size, desc, ln, fn);
+}
+
+
+//
+// Carve a dynamic heap extension out of the current heap chunk,
+// getting and registering a new chunk if there isn't room.  Returns
+// NULL if the caller should get a separate region instead.
+//
+static
+void* heap_chunk_alloc(size_t size, int ln, int32_t fn)
+{
+  const size_t hps = get_hugepage_size();
+  void* p;
+
+  size = ALIGN_UP(size, hps);
+  if (size > heap_chunk_max)
+    return NULL;
+
+  pthread_mutex_lock(&heap_chunk_mutex);
+
+  if (heap_chunk_size - heap_chunk_used < size) {
+    size_t chunk_size = ALIGN_UP(heap_chunk_next, hps);
+    if (chunk_size < size)
+      chunk_size = size;
+
+    //
+    // If we're running low on region table entries, don't bother
+    // growing gradually.
+    //
+    if (atomic_load_int_least32_t(&mreg_free_cnt) < max_mem_regions / 16)
+      chunk_size = ALIGN_UP(heap_chunk_max, hps);
+
+    char* chunk = regMemAllocCommon(chunk_size, CHPL_RT_MD_MEM_HEAP_SPACE,
+                                    ln, fn);
+    if (chunk == NULL) {
+      pthread_mutex_unlock(&heap_chunk_mutex);
+      return NULL;
+    }
+    chpl_comm_impl_regMemPostAlloc(chunk, chunk_size);
+    PERFSTATS_INC(regMem_heapChunk_cnt);
+
+    DBG_P_LP(DBGF_MEMREG,
+             "heap_chunk_alloc(%#zx): new chunk %p, %#zx "
+             "(%#zx left in old one)",
+             size, chunk, chunk_size, heap_chunk_size - heap_chunk_used);
+
+    heap_chunk_base = chunk;
+    heap_chunk_size = chunk_size;
+    heap_chunk_used = 0;
+    heap_chunk_next = (chunk_size < heap_chunk_max / 2)
+                      ? 2 * chunk_size
+                      : heap_chunk_max;
+  }
+
+  p = heap_chunk_base + heap_chunk_used;
+  heap_chunk_used += size;
+
+  pthread_mutex_unlock(&heap_chunk_mutex);
+
+  return p;
+}
+
+
+static
+void* regMemAllocCommon(size_t size,
+                        chpl_mem_descInt_t desc, int ln, int32_t fn)
+{
+  int mr_i;
+  mem_region_t* mr;
+  void* p;
+
   //
   // Do we have room for another registered memory region?
   //
@@ -3520,6 +3666,17 @@ void chpl_comm_impl_regMemPostAlloc(void* p, size_t size)
            "chpl_comm_impl_regMemPostAlloc(%p, %#zx)",
            p, size);
 
+  //
+  // Dynamic heap extensions carved out of a heap chunk are already
+  // registered, along with the rest of the chunk.
+  //
+  if (heap_chunk_max > 0
+      && (mr = mreg_for_addr(p, mem_regions)) != NULL
+      && (mr_mregs_supplement[mr - mem_regions->mregs].desc
+          == CHPL_RT_MD_MEM_HEAP_SPACE)) {
+    return;
+  }
+
   //
   // Find the memory region table entry for this memory.
   //
@@ -4325,9 +4482,8 @@ void fork_call_wrapper_large(fork_large_call_info_t* lc)
 
   // Build a new bundle out of the header we got in the request to us
   // plus the payload copied from the initiating side.
-  chpl_comm_on_bundle_t* bundle = chpl_mem_alloc(comm->size,
-                                                 CHPL_RT_MD_COMM_FRK_RCV_INFO,
-                                                 0, 0);
+  chpl_comm_on_bundle_t* bundle =
+    chpl_mem_arena_alloc(comm->size, CHPL_RT_MD_COMM_FRK_RCV_INFO, 0, 0);
   *bundle = lc->hdr;
 
   size_t payload_size = comm->size - offsetof(chpl_comm_on_bundle_t, payload);
@@ -4346,7 +4502,7 @@ void fork_call_wrapper_large(fork_large_call_info_t* lc)
   chpl_ftable_call(bundle->comm.fid, bundle);
 
   // Free the bundle we just allocated.
-  chpl_mem_free(bundle, 0, 0);
+  chpl_mem_arena_free(bundle, 0, 0);
 
   if (blocking) {
     // Blocking forks need to notify the caller that the
@@ -5716,21 +5872,104 @@ void chpl_comm_get(void* addr, c_nodeid_t locale, void* raddr,
   do_remote_get(addr, locale, raddr, size, may_proxy_true);
 }
 
+//
+// Wait for the chained transaction from a GET or PUT buffer bank to
+// complete, if there is one in flight.
+//
+static inline
+void buff_chain_wait(buff_chain_t* bc) {
+  if (!bc->active)
+    return;
+
+#if HAVE_GNI_FMA_CHAIN_TRANSACTIONS
+  chpl_bool do_yield = should_yield_during_comm(true);
+  while (!atomic_load_explicit_bool(&bc->done, chpl_memory_order_acquire)) {
+    if (do_yield) {
+      local_yield();
+    }
+    consume_all_outstanding_cq_events(bc->cdi);
+  }
+#endif
+
+  bc->active = false;
+}
+
+
 /*
  *** START OF BUFFERED PUT OPERATIONS ***
  *
  * Support for buffered PUT operations. We internally buffer PUT operations and
  * then initiate them with chained transactions for increased transaction rate.
+ * We only wait for a chain to complete when we need its bank again, or at a
+ * fence.
  */
 
-// Flush buffered PUTs for the specified task info and reset the counter.
+//
+// Initiate the buffered PUTs in the current bank and switch to the
+// other one, waiting for it to be free.  Everything in the bank is
+// known to be NIC-registered and small, so no proxying is needed.
+//
+static
+void put_buff_task_info_post(put_buff_task_info_t* info) {
+  put_buff_bank_t* bk = &info->bank[info->cur];
+  const int n = info->vi;
+
+  if (n == 0)
+    return;
+
+#if HAVE_GNI_FMA_CHAIN_TRANSACTIONS
+  buff_chain_t* bc = &bk->chain;
+
+  for (int vi = 0; vi < n; vi++) {
+    if (vi == 0) {
+      bc->pd = (gni_post_descriptor_t) { 0 };
+      bc->pd.next_descr      = NULL;
+      bc->pd.type            = GNI_POST_FMA_PUT;
+      bc->pd.cq_mode         = GNI_CQMODE_GLOBAL_EVENT;
+      bc->pd.dlvr_mode       = GNI_DLVMODE_PERFORMANCE;
+      bc->pd.local_addr      = (uint64_t) (intptr_t) bk->src_addr_v[vi];
+      bc->pd.remote_addr     = (uint64_t) (intptr_t) bk->tgt_addr_v[vi];
+      bc->pd.remote_mem_hndl = bk->remote_mr_v[vi]->mdh;
+      bc->pd.length          = bk->size_v[vi];
+    } else {
+      gni_ct_put_post_descriptor_t* pdc = &bc->pdc.put[vi - 1];
+      if (vi == 1)
+        bc->pd.next_descr = pdc;
+      else
+        bc->pdc.put[vi - 2].next_descr = pdc;
+
+      *pdc                 = (gni_ct_put_post_descriptor_t) { 0 };
+      pdc->next_descr      = NULL;
+      pdc->local_addr      = (uint64_t) (intptr_t) bk->src_addr_v[vi];
+      pdc->remote_addr     = (uint64_t) (intptr_t) bk->tgt_addr_v[vi];
+      pdc->remote_mem_hndl = bk->remote_mr_v[vi]->mdh;
+      pdc->length          = bk->size_v[vi];
+    }
+
+    PERFSTATS_INC(put_cnt);
+    PERFSTATS_ADD(put_byte_cnt, bk->size_v[vi]);
+  }
+
+  atomic_store_bool(&bc->done, false);
+  bc->pd.post_id = (uint64_t) (intptr_t) &bc->done;
+  bc->cdi = post_fma_ct(bk->locale_v, &bc->pd);
+  bc->active = true;
+#else
+  do_remote_put_V(n, bk->src_addr_v, bk->locale_v, bk->tgt_addr_v,
+                  bk->size_v, bk->remote_mr_v, may_proxy_true);
+#endif
+
+  info->vi = 0;
+  info->cur = (info->cur + 1) % NUM_BUFF_BANKS;
+  buff_chain_wait(&info->bank[info->cur].chain);
+}
+
+// Flush buffered PUTs for the specified task info, and wait for them.
 static inline
 void put_buff_task_info_flush(put_buff_task_info_t* info) {
-  if (info->vi > 0) {
-    do_remote_put_V(info->vi, info->src_addr_v, info->locale_v,
-                    info->tgt_addr_v, info->size_v,
-                    info->remote_mr_v, may_proxy_true);
-    info->vi = 0;
+  put_buff_task_info_post(info);
+  for (int i = 0; i < NUM_BUFF_BANKS; i++) {
+    buff_chain_wait(&info->bank[i].chain);
   }
 }
 
@@ -5752,18 +5991,19 @@ void do_remote_put_buff(void* src_addr, c_nodeid_t locale, void* tgt_addr,
     return;
   }
 
+  put_buff_bank_t* bk = &info->bank[info->cur];
   int vi = info->vi;
-  memcpy(&info->src_v[vi], src_addr, size);
-  info->src_addr_v[vi] = &info->src_v[vi];
-  info->locale_v[vi] = locale;
-  info->tgt_addr_v[vi] = tgt_addr;
-  info->size_v[vi] = size;
-  info->remote_mr_v[vi] = remote_mr;
+  memcpy(&bk->src_v[vi], src_addr, size);
+  bk->src_addr_v[vi] = &bk->src_v[vi];
+  bk->locale_v[vi] = locale;
+  bk->tgt_addr_v[vi] = tgt_addr;
+  bk->size_v[vi] = size;
+  bk->remote_mr_v[vi] = remote_mr;
   info->vi++;
 
-  // flush if buffers are full
+  // initiate if the bank is full
   if (info->vi == MAX_CHAINED_PUT_LEN) {
-    put_buff_task_info_flush(info);
+    put_buff_task_info_post(info);
   }
 }
 /*** END OF BUFFERED PUT OPERATIONS ***/
@@ -5774,16 +6014,78 @@ void do_remote_put_buff(void* src_addr, c_nodeid_t locale, void* tgt_addr,
  *
  * Support for buffered GET operations. We internally buffer GET operations and
  * then initiate them with chained transactions for increased transaction rate.
+ * As with PUTs, we only wait for a chain to complete when we need its bank
+ * again, or at a fence.
  */
 
-// Flush buffered GETs for the specified task info and reset the counter.
+//
+// Initiate the buffered GETs in the current bank and switch to the
+// other one, waiting for it to be free.
+//
+static
+void get_buff_task_info_post(get_buff_task_info_t* info) {
+  get_buff_bank_t* bk = &info->bank[info->cur];
+  const int n = info->vi;
+
+  if (n == 0)
+    return;
+
+#if HAVE_GNI_FMA_CHAIN_TRANSACTIONS
+  buff_chain_t* bc = &bk->chain;
+
+  for (int vi = 0; vi < n; vi++) {
+    if (vi == 0) {
+      bc->pd = (gni_post_descriptor_t) { 0 };
+      bc->pd.next_descr      = NULL;
+      bc->pd.type            = GNI_POST_FMA_GET;
+      bc->pd.cq_mode         = GNI_CQMODE_GLOBAL_EVENT;
+      bc->pd.dlvr_mode       = GNI_DLVMODE_PERFORMANCE;
+      bc->pd.local_addr      = (uint64_t) (intptr_t) bk->tgt_addr_v[vi];
+      bc->pd.remote_addr     = (uint64_t) (intptr_t) bk->src_addr_v[vi];
+      bc->pd.local_mem_hndl  = bk->local_mr_v[vi]->mdh;
+      bc->pd.remote_mem_hndl = bk->remote_mr_v[vi]->mdh;
+      bc->pd.length          = bk->size_v[vi];
+    } else {
+      gni_ct_get_post_descriptor_t* pdc = &bc->pdc.get[vi - 1];
+      if (vi == 1)
+        bc->pd.next_descr = pdc;
+      else
+        bc->pdc.get[vi - 2].next_descr = pdc;
+
+      *pdc                 = (gni_ct_get_post_descriptor_t) { 0 };
+      pdc->next_descr      = NULL;
+      pdc->local_addr      = (uint64_t) (intptr_t) bk->tgt_addr_v[vi];
+      pdc->remote_addr     = (uint64_t) (intptr_t) bk->src_addr_v[vi];
+      pdc->local_mem_hndl  = bk->local_mr_v[vi]->mdh;
+      pdc->remote_mem_hndl = bk->remote_mr_v[vi]->mdh;
+      pdc->length          = bk->size_v[vi];
+    }
+
+    PERFSTATS_INC(get_cnt);
+    PERFSTATS_ADD(get_byte_cnt, bk->size_v[vi]);
+  }
+
+  atomic_store_bool(&bc->done, false);
+  bc->pd.post_id = (uint64_t) (intptr_t) &bc->done;
+  bc->cdi = post_fma_ct(bk->locale_v, &bc->pd);
+  bc->active = true;
+#else
+  do_remote_get_V(n, bk->tgt_addr_v, bk->locale_v, bk->remote_mr_v,
+                  bk->src_addr_v, bk->size_v, bk->local_mr_v,
+                  may_proxy_true);
+#endif
+
+  info->vi = 0;
+  info->cur = (info->cur + 1) % NUM_BUFF_BANKS;
+  buff_chain_wait(&info->bank[info->cur].chain);
+}
+
+// Flush buffered GETs for the specified task info, and wait for them.
 static inline
 void get_buff_task_info_flush(get_buff_task_info_t* info) {
-  if (info->vi > 0) {
-    do_remote_get_V(info->vi, info->tgt_addr_v, info->locale_v,
-                    info->remote_mr_v, info->src_addr_v, info->size_v,
-                    info->local_mr_v, may_proxy_true);
-    info->vi = 0;
+  get_buff_task_info_post(info);
+  for (int i = 0; i < NUM_BUFF_BANKS; i++) {
+    buff_chain_wait(&info->bank[i].chain);
   }
 }
 
@@ -5816,18 +6118,19 @@ void do_remote_get_buff(void* tgt_addr, c_nodeid_t locale, void* src_addr,
     return;
   }
 
+  get_buff_bank_t* bk = &info->bank[info->cur];
   int vi = info->vi;
-  info->tgt_addr_v[vi] = tgt_addr;
-  info->locale_v[vi] = locale;
-  info->remote_mr_v[vi] = remote_mr;
-  info->src_addr_v[vi] = src_addr;
-  info->size_v[vi] = size;
-  info->local_mr_v[vi] = local_mr;
+  bk->tgt_addr_v[vi] = tgt_addr;
+  bk->locale_v[vi] = locale;
+  bk->remote_mr_v[vi] = remote_mr;
+  bk->src_addr_v[vi] = src_addr;
+  bk->size_v[vi] = size;
+  bk->local_mr_v[vi] = local_mr;
   info->vi++;
 
-  // flush if buffers are full
+  // initiate if the bank is full
   if (info->vi == MAX_CHAINED_GET_LEN) {
-    get_buff_task_info_flush(info);
+    get_buff_task_info_post(info);
   }
 }
 /*** END OF BUFFERED GET OPERATIONS ***/
@@ -6135,6 +6438,44 @@ void chpl_comm_get_strd(void* dstaddr_arg, size_t* dststrides,
 }
 
 
+//
+// Non-blocking strided interface.  These just do the blocking versions,
+// in the same way as our contiguous non-blocking GET and PUT do.
+//
+chpl_comm_nb_handle_t chpl_comm_put_strd_nb(void* dstaddr_arg,
+                                            size_t* dststrides,
+                                            c_nodeid_t dstlocale,
+                                            void* srcaddr_arg,
+                                            size_t* srcstrides,
+                                            size_t* count,
+                                            int32_t stridelevels,
+                                            size_t elemSize, int32_t commID,
+                                            int ln, int32_t fn)
+{
+  chpl_comm_put_strd(dstaddr_arg, dststrides, dstlocale,
+                     srcaddr_arg, srcstrides, count, stridelevels, elemSize,
+                     commID, ln, fn);
+  return NULL;
+}
+
+
+chpl_comm_nb_handle_t chpl_comm_get_strd_nb(void* dstaddr_arg,
+                                            size_t* dststrides,
+                                            c_nodeid_t srclocale,
+                                            void* srcaddr_arg,
+                                            size_t* srcstrides,
+                                            size_t* count,
+                                            int32_t stridelevels,
+                                            size_t elemSize, int32_t commID,
+                                            int ln, int32_t fn)
+{
+  chpl_comm_get_strd(dstaddr_arg, dststrides, srclocale,
+                     srcaddr_arg, srcstrides, count, stridelevels, elemSize,
+                     commID, ln, fn);
+  return NULL;
+}
+
+
 //
 // Non-blocking get interface
 //
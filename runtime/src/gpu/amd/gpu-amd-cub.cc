@@ -85,6 +85,68 @@ GPU_DEV_CUB_WRAP(DEF_ONE_REDUCE_RET_VAL_IDX, ArgMax, maxloc)
 
 #undef DEF_ONE_REDUCE_RET_VAL_IDX
 
+// The final pass for several reductions at once: block i of the kernel
+// reduces variable i's partial results in place.
+#define FUSED_REDUCE_BLOCK 256
+
+template <typename T, typename Op>
+__device__ static void fused_reduce_one(T* data, int n, Op op) {
+  typedef hipcub::BlockReduce<T, FUSED_REDUCE_BLOCK> BlockReduce;
+  __shared__ typename BlockReduce::TempStorage temp_storage;
+  T acc = data[threadIdx.x < n ? threadIdx.x : 0];
+  for (int i = threadIdx.x + FUSED_REDUCE_BLOCK; i < n;
+       i += FUSED_REDUCE_BLOCK) {
+    acc = op(acc, data[i]);
+  }
+  T res = BlockReduce(temp_storage).Reduce(acc, op,
+                                           n < FUSED_REDUCE_BLOCK ?
+                                           n : FUSED_REDUCE_BLOCK);
+  if (threadIdx.x == 0) {
+    data[0] = res;
+  }
+}
+
+template <typename T>
+__device__ static void fused_reduce_var(T* data, int n,
+                                        chpl_gpu_reduce_op_t op) {
+  switch (op) {
+    case CHPL_GPU_REDUCE_OP_sum: fused_reduce_one(data, n, hipcub::Sum()); break;
+    case CHPL_GPU_REDUCE_OP_min: fused_reduce_one(data, n, hipcub::Min()); break;
+    case CHPL_GPU_REDUCE_OP_max: fused_reduce_one(data, n, hipcub::Max()); break;
+  }
+}
+
+__global__ static void fused_reduce_kernel(chpl_gpu_fused_reduce_t r, int n) {
+  const chpl_gpu_fused_reduce_var_t v = r.vars[blockIdx.x];
+  switch (v.type) {
+#define FUSED_REDUCE_CASE(data_type) \
+    case CHPL_GPU_REDUCE_TYPE_##data_type: \
+      fused_reduce_var((data_type*)v.data, n, v.op); \
+      break;
+    FUSED_REDUCE_CASE(chpl_bool)
+    FUSED_REDUCE_CASE(int8_t)
+    FUSED_REDUCE_CASE(int16_t)
+    FUSED_REDUCE_CASE(int32_t)
+    FUSED_REDUCE_CASE(int64_t)
+    FUSED_REDUCE_CASE(uint8_t)
+    FUSED_REDUCE_CASE(uint16_t)
+    FUSED_REDUCE_CASE(uint32_t)
+    FUSED_REDUCE_CASE(uint64_t)
+    FUSED_REDUCE_CASE(_real32)
+    FUSED_REDUCE_CASE(_real64)
+#undef FUSED_REDUCE_CASE
+  }
+}
+
+void chpl_gpu_impl_fused_reduce(const chpl_gpu_fused_reduce_t* r, int n,
+                                void* stream) {
+  fused_reduce_kernel<<<r->n_vars, FUSED_REDUCE_BLOCK, 0, (hipStream_t)stream>>>(
+    *r, n);
+  ROCM_CALL(hipGetLastError());
+}
+
+#undef FUSED_REDUCE_BLOCK
+
 #define DEF_ONE_SORT(cub_kind, chpl_kind, data_type) \
 void chpl_gpu_impl_sort_##chpl_kind##_##data_type(data_type* data_in, \
                                                   data_type* data_out, \
@@ -107,5 +169,99 @@ GPU_DEV_CUB_WRAP(DEF_ONE_SORT, SortKeys, keys)
 
 #undef DEF_ONE_SORT
 
+#define DEF_ONE_SORT_PAIRS(cub_kind, chpl_kind, data_type) \
+void chpl_gpu_impl_sort_##chpl_kind##_##data_type(data_type* keys_in, \
+                                                  data_type* keys_out, \
+                                                  int64_t* vals_in, \
+                                                  int64_t* vals_out, \
+                                                  int n, void* stream) {\
+  void* temp = NULL; \
+  size_t temp_bytes = 0; \
+  ROCM_CALL(hipcub::DeviceRadixSort::cub_kind(temp, temp_bytes, keys_in, keys_out,\
+                                 vals_in, vals_out, n, /*beginBit*/0, \
+                                 /*endBit*/ sizeof(data_type)*8,\
+                                 (hipStream_t)stream)); \
+  ROCM_CALL(hipMalloc(&temp, temp_bytes)); \
+  ROCM_CALL(hipcub::DeviceRadixSort::cub_kind(temp, temp_bytes, keys_in, keys_out,\
+                                 vals_in, vals_out, n, /*beginBit*/0, \
+                                 /*endBit*/ sizeof(data_type)*8,\
+                                 (hipStream_t)stream)); \
+  ROCM_CALL(hipFree(temp)); \
+}
+
+GPU_DEV_CUB_WRAP(DEF_ONE_SORT_PAIRS, SortPairs, pairs)
+
+#undef DEF_ONE_SORT_PAIRS
+
+#define DEF_ONE_SEGMENTED_SORT(cub_kind, chpl_kind, data_type) \
+void chpl_gpu_impl_segmented_sort_##chpl_kind##_##data_type( \
+    data_type* data_in, data_type* data_out, int n, int n_segments, \
+    int* offsets, void* stream) { \
+  void* temp = NULL; \
+  size_t temp_bytes = 0; \
+  ROCM_CALL(hipcub::DeviceSegmentedRadixSort::cub_kind(temp, temp_bytes, \
+                                 data_in, data_out, n, n_segments, \
+                                 offsets, offsets+1, /*beginBit*/0, \
+                                 /*endBit*/ sizeof(data_type)*8,\
+                                 (hipStream_t)stream)); \
+  ROCM_CALL(hipMalloc(&temp, temp_bytes)); \
+  ROCM_CALL(hipcub::DeviceSegmentedRadixSort::cub_kind(temp, temp_bytes, \
+                                 data_in, data_out, n, n_segments, \
+                                 offsets, offsets+1, /*beginBit*/0, \
+                                 /*endBit*/ sizeof(data_type)*8,\
+                                 (hipStream_t)stream)); \
+  ROCM_CALL(hipFree(temp)); \
+}
+
+GPU_DEV_CUB_WRAP(DEF_ONE_SEGMENTED_SORT, SortKeys, keys)
+
+#undef DEF_ONE_SEGMENTED_SORT
+
+#define DEF_ONE_SCAN(cub_kind, chpl_kind, data_type) \
+void chpl_gpu_impl_##chpl_kind##_scan_##data_type(data_type* data_in, \
+                                                  data_type* data_out, \
+                                                  int n, void* stream) {\
+  void* temp = NULL; \
+  size_t temp_bytes = 0; \
+  ROCM_CALL(hipcub::DeviceScan::cub_kind(temp, temp_bytes, data_in, data_out, n, \
+                                 (hipStream_t)stream)); \
+  ROCM_CALL(hipMalloc(&temp, temp_bytes)); \
+  ROCM_CALL(hipcub::DeviceScan::cub_kind(temp, temp_bytes, data_in, data_out, n, \
+                                 (hipStream_t)stream)); \
+  ROCM_CALL(hipFree(temp)); \
+}
+
+GPU_DEV_CUB_WRAP(DEF_ONE_SCAN, ExclusiveSum, exclusive)
+GPU_DEV_CUB_WRAP(DEF_ONE_SCAN, InclusiveSum, inclusive)
+
+#undef DEF_ONE_SCAN
+
+#define DEF_ONE_SELECT(cub_kind, chpl_kind, data_type) \
+void chpl_gpu_impl_select_##chpl_kind##_##data_type(data_type* data_in, \
+                                                    chpl_bool* flags, \
+                                                    data_type* data_out, \
+                                                    int n, int* n_selected, \
+                                                    void* stream) {\
+  int* result; \
+  ROCM_CALL(hipMalloc(&result, sizeof(int))); \
+  void* temp = NULL; \
+  size_t temp_bytes = 0; \
+  ROCM_CALL(hipcub::DeviceSelect::cub_kind(temp, temp_bytes, data_in, flags, \
+                                           data_out, result, n, \
+                                           (hipStream_t)stream)); \
+  ROCM_CALL(hipMalloc(&temp, temp_bytes)); \
+  ROCM_CALL(hipcub::DeviceSelect::cub_kind(temp, temp_bytes, data_in, flags, \
+                                           data_out, result, n, \
+                                           (hipStream_t)stream)); \
+  ROCM_CALL(hipMemcpyDtoHAsync(n_selected, result, sizeof(int), \
+                               (hipStream_t)stream)); \
+  ROCM_CALL(hipFree(result)); \
+  ROCM_CALL(hipFree(temp)); \
+}
+
+GPU_DEV_CUB_WRAP(DEF_ONE_SELECT, Flagged, flagged)
+
+#undef DEF_ONE_SELECT
+
 #endif // HAS_GPU_LOCALE
 
@@ -354,6 +354,20 @@ void chpl_gpu_impl_copy_device_to_device(void* dst, const void* src, size_t n,
                                (hipStream_t)stream));
 }
 
+void chpl_gpu_impl_copy_peer(void* dst, int dst_dev, const void* src,
+                             int src_dev, size_t n, void* stream) {
+  ROCM_CALL(hipMemcpyPeerAsync(dst, dev_lid_to_pid(dst_dev), src,
+                               dev_lid_to_pid(src_dev), n,
+                               (hipStream_t)stream));
+}
+
+void chpl_gpu_impl_copy_2d(void* dst, size_t dpitch, const void* src,
+                           size_t spitch, size_t width, size_t height,
+                           void* stream) {
+  ROCM_CALL(hipMemcpy2DAsync(dst, dpitch, src, spitch, width, height,
+                             hipMemcpyDefault, (hipStream_t)stream));
+}
+
 
 void* chpl_gpu_impl_comm_async(void *dst, void *src, size_t n) {
   hipStream_t stream;
@@ -437,6 +451,117 @@ size_t chpl_gpu_impl_get_alloc_size(void* ptr) {
   return size;
 }
 
+bool chpl_gpu_impl_get_mem_region(const void* ptr,
+                                  chpl_gpu_mem_region_t* region) {
+  hipPointerAttribute_t res;
+  if (hipPointerGetAttributes(&res, (hipDeviceptr_t)ptr) != hipSuccess) {
+    return false;
+  }
+#if ROCM_VERSION_MAJOR >= 6
+  if (res.type != hipMemoryTypeDevice) return false;
+#else
+  if (res.memoryType != hipMemoryTypeDevice) return false;
+#endif
+
+  hipDeviceptr_t base;
+  size_t size;
+  ROCM_CALL(hipMemGetAddressRange(&base, &size, (hipDeviceptr_t)ptr));
+
+  region->kind = CHPL_GPU_MEM_REGION_ROCM;
+  region->base = (void*)base;
+  region->size = size;
+  region->device = res.device;
+  return true;
+}
+
+void* chpl_gpu_impl_event_create(void) {
+  hipEvent_t event;
+  ROCM_CALL(hipEventCreate(&event));
+  return (void*)event;
+}
+
+void chpl_gpu_impl_event_destroy(void* event) {
+  ROCM_CALL(hipEventDestroy((hipEvent_t)event));
+}
+
+void chpl_gpu_impl_event_record(void* event, void* stream) {
+  ROCM_CALL(hipEventRecord((hipEvent_t)event, (hipStream_t)stream));
+}
+
+bool chpl_gpu_impl_event_done(void* event) {
+  return hipEventQuery((hipEvent_t)event) == hipSuccess;
+}
+
+double chpl_gpu_impl_event_elapsed_ms(void* start, void* end) {
+  float ms;
+  ROCM_CALL(hipEventSynchronize((hipEvent_t)end));
+  ROCM_CALL(hipEventElapsedTime(&ms, (hipEvent_t)start, (hipEvent_t)end));
+  return ms;
+}
+
+int chpl_gpu_impl_max_active_blocks(void* function, int blk_size) {
+  int n;
+  ROCM_CALL(hipModuleOccupancyMaxActiveBlocksPerMultiprocessor(&n,
+                                                  (hipFunction_t)function,
+                                                  blk_size, 0));
+  return n;
+}
+
+bool chpl_gpu_impl_get_managed_range(const void* ptr, void** base,
+                                     size_t* size) {
+  hipPointerAttribute_t res;
+  if (hipPointerGetAttributes(&res, (hipDeviceptr_t)ptr) != hipSuccess ||
+      !res.isManaged) {
+    return false;
+  }
+
+  hipDeviceptr_t b;
+  if (hipMemGetAddressRange(&b, size, (hipDeviceptr_t)ptr) != hipSuccess) {
+    return false;
+  }
+  *base = (void*)b;
+  return true;
+}
+
+static int um_location(int dev_lid) {
+  return dev_lid < 0 ? hipCpuDeviceId : dev_lid_to_pid(dev_lid);
+}
+
+void chpl_gpu_impl_mem_prefetch(const void* addr, size_t size, int dev_lid,
+                                void* stream) {
+  hipError_t ret = hipMemPrefetchAsync(addr, size, um_location(dev_lid),
+                                       (hipStream_t)stream);
+  if (ret != hipSuccess) {
+    CHPL_GPU_DEBUG("hipMemPrefetchAsync(%p, %zu) failed: %d\n", addr, size,
+                   (int)ret);
+  }
+}
+
+void chpl_gpu_impl_mem_advise(const void* addr, size_t size,
+                              chpl_gpu_mem_advice_t advice, int dev_lid) {
+  hipMemoryAdvise hip_advice;
+  switch (advice) {
+    case CHPL_GPU_MEM_ADVISE_READ_MOSTLY:
+      hip_advice = hipMemAdviseSetReadMostly; break;
+    case CHPL_GPU_MEM_ADVISE_UNSET_READ_MOSTLY:
+      hip_advice = hipMemAdviseUnsetReadMostly; break;
+    case CHPL_GPU_MEM_ADVISE_PREFERRED_LOCATION:
+      hip_advice = hipMemAdviseSetPreferredLocation; break;
+    case CHPL_GPU_MEM_ADVISE_UNSET_PREFERRED_LOCATION:
+      hip_advice = hipMemAdviseUnsetPreferredLocation; break;
+    case CHPL_GPU_MEM_ADVISE_ACCESSED_BY:
+      hip_advice = hipMemAdviseSetAccessedBy; break;
+    default:
+      return;
+  }
+  hipError_t ret = hipMemAdvise(addr, size, hip_advice,
+                                um_location(dev_lid));
+  if (ret != hipSuccess) {
+    CHPL_GPU_DEBUG("hipMemAdvise(%p, %zu, %d) failed: %d\n", addr, size,
+                   (int)advice, (int)ret);
+  }
+}
+
 unsigned int chpl_gpu_device_clock_rate(int32_t devNum) {
   return (unsigned int)deviceClockRates[devNum];
 }
@@ -497,6 +622,32 @@ void chpl_gpu_impl_stream_synchronize(void* stream) {
   }
 }
 
+bool chpl_gpu_impl_graph_supported(void) {
+  return true;
+}
+
+void chpl_gpu_impl_stream_begin_capture(void* stream) {
+  ROCM_CALL(hipStreamBeginCapture((hipStream_t)stream,
+                                  hipStreamCaptureModeThreadLocal));
+}
+
+void* chpl_gpu_impl_stream_end_capture(void* stream) {
+  hipGraph_t graph;
+  hipGraphExec_t exec;
+  ROCM_CALL(hipStreamEndCapture((hipStream_t)stream, &graph));
+  ROCM_CALL(hipGraphInstantiate(&exec, graph, NULL, NULL, 0));
+  ROCM_CALL(hipGraphDestroy(graph));
+  return (void*) exec;
+}
+
+void chpl_gpu_impl_graph_launch(void* graph, void* stream) {
+  ROCM_CALL(hipGraphLaunch((hipGraphExec_t)graph, (hipStream_t)stream));
+}
+
+void chpl_gpu_impl_graph_destroy(void* graph) {
+  ROCM_CALL(hipGraphExecDestroy((hipGraphExec_t)graph));
+}
+
 void* chpl_gpu_impl_host_register(void* var, size_t size) {
   ROCM_CALL(hipHostRegister(var, size, hipHostRegisterPortable));
   void *dev_var;
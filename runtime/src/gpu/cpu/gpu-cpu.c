@@ -29,14 +29,91 @@
 #include "chpl-tasks.h"
 #include "error.h"
 #include "chplcgfns.h"
+#include "chpl-env.h"
 
 #include <assert.h>
+#include <pthread.h>
 #include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Without a GPU, "device" memory is host memory, and the bulk operations
+// on it (memsets and copies of whole arrays, mostly) are split across up
+// to cpu_threads threads once they are big enough to be worth starting
+// threads for. CHPL_RT_GPU_CPU_THREADS sets the number of threads; it
+// defaults to the tasking layer's parallelism, and 1 turns this off.
+#define CPU_PARALLEL_MIN_BYTES ((size_t)16*1024*1024)
+#define CPU_PARALLEL_MAX_THREADS 64
+
+static int cpu_threads = 1;
+
+typedef struct {
+  char* dst;
+  const char* src;      // NULL for a memset
+  uint8_t val;
+  size_t n;
+} cpu_bulk_job_t;
+
+static void* cpu_bulk_run(void* arg) {
+  cpu_bulk_job_t* job = (cpu_bulk_job_t*)arg;
+  if (job->src != NULL) {
+    memcpy(job->dst, job->src, job->n);
+  }
+  else {
+    memset(job->dst, job->val, job->n);
+  }
+  return NULL;
+}
 
+// Copy n bytes from src to dst, or set them to val if src is NULL. The
+// caller's thread does the first share; if a thread can't be started,
+// its share is done here too.
+static void cpu_bulk(void* dst, const void* src, uint8_t val, size_t n) {
+  int nthreads = cpu_threads;
+  if (n < CPU_PARALLEL_MIN_BYTES || nthreads <= 1) {
+    nthreads = 1;
+  }
+
+  cpu_bulk_job_t jobs[CPU_PARALLEL_MAX_THREADS];
+  pthread_t threads[CPU_PARALLEL_MAX_THREADS];
+  bool started[CPU_PARALLEL_MAX_THREADS];
+
+  // shares are multiples of a page, so threads don't share lines
+  size_t share = (n / nthreads + 4095) & ~(size_t)4095;
+  for (int t = 0; t < nthreads; t++) {
+    size_t begin = t*share < n ? t*share : n;
+    size_t end = begin + share < n ? begin + share : n;
+    jobs[t].dst = (char*)dst + begin;
+    jobs[t].src = src != NULL ? (const char*)src + begin : NULL;
+    jobs[t].val = val;
+    jobs[t].n = end - begin;
+    started[t] = false;
+  }
+
+  for (int t = 1; t < nthreads; t++) {
+    if (jobs[t].n > 0) {
+      started[t] = pthread_create(&threads[t], NULL,
+                                  cpu_bulk_run, &jobs[t]) == 0;
+    }
+  }
+  cpu_bulk_run(&jobs[0]);
+  for (int t = 1; t < nthreads; t++) {
+    if (started[t]) pthread_join(threads[t], NULL);
+    else cpu_bulk_run(&jobs[t]);
+  }
+}
 
 void chpl_gpu_impl_begin_init(int* num_all_devices) {
   CHPL_GPU_DEBUG("Initializing none GPU layer.\n");
   *num_all_devices = 1;
+
+  int64_t nthreads = chpl_env_rt_get_int("GPU_CPU_THREADS",
+                                         chpl_task_getMaxPar());
+  if (nthreads < 1) nthreads = 1;
+  if (nthreads > CPU_PARALLEL_MAX_THREADS) {
+    nthreads = CPU_PARALLEL_MAX_THREADS;
+  }
+  cpu_threads = (int)nthreads;
 }
 
 void chpl_gpu_impl_collect_topo_addr_info(chpl_topo_pci_addr_t* into,
@@ -59,6 +136,37 @@ bool chpl_gpu_impl_is_host_ptr(const void* ptr) {
   return true;
 }
 
+void* chpl_gpu_impl_event_create(void) {
+  return NULL;
+}
+
+void chpl_gpu_impl_event_destroy(void* event) {}
+
+void chpl_gpu_impl_event_record(void* event, void* stream) {}
+
+bool chpl_gpu_impl_event_done(void* event) {
+  return true;
+}
+
+double chpl_gpu_impl_event_elapsed_ms(void* start, void* end) {
+  return 0;
+}
+
+int chpl_gpu_impl_max_active_blocks(void* function, int blk_size) {
+  return 0;
+}
+
+bool chpl_gpu_impl_get_managed_range(const void* ptr, void** base,
+                                     size_t* size) {
+  return false;
+}
+
+void chpl_gpu_impl_mem_prefetch(const void* addr, size_t size, int dev,
+                                void* stream) {}
+
+void chpl_gpu_impl_mem_advise(const void* addr, size_t size,
+                              chpl_gpu_mem_advice_t advice, int dev) {}
+
 void* chpl_gpu_impl_load_function(const char* kernel_name) {
   return (void*)1; // we don't want to return NULL here to avoid an assertion
 }
@@ -72,22 +180,36 @@ void chpl_gpu_impl_launch_kernel(void* kernel,
 
 void* chpl_gpu_impl_memset(void* addr, const uint8_t val, size_t n,
                            void* stream) {
-  return memset(addr, val, n);
+  cpu_bulk(addr, NULL, val, n);
+  return addr;
 }
 
 void chpl_gpu_impl_copy_device_to_host(void* dst, const void* src, size_t n,
                                        void* stream) {
-  chpl_memcpy(dst, src, n);
+  cpu_bulk(dst, src, 0, n);
 }
 
 void chpl_gpu_impl_copy_host_to_device(void* dst, const void* src, size_t n,
                                        void* stream) {
-  chpl_memcpy(dst, src, n);
+  cpu_bulk(dst, src, 0, n);
 }
 
 void chpl_gpu_impl_copy_device_to_device(void* dst, const void* src, size_t n,
                                          void* stream) {
-  chpl_memcpy(dst, src, n);
+  cpu_bulk(dst, src, 0, n);
+}
+
+void chpl_gpu_impl_copy_peer(void* dst, int dst_dev, const void* src,
+                             int src_dev, size_t n, void* stream) {
+  cpu_bulk(dst, src, 0, n);
+}
+
+void chpl_gpu_impl_copy_2d(void* dst, size_t dpitch, const void* src,
+                           size_t spitch, size_t width, size_t height,
+                           void* stream) {
+  for (size_t i = 0; i < height; i++) {
+    chpl_memcpy((char*)dst + i*dpitch, (const char*)src + i*spitch, width);
+  }
 }
 
 void* chpl_gpu_impl_comm_async(void *dst, void *src, size_t n) {
@@ -121,6 +243,11 @@ size_t chpl_gpu_impl_get_alloc_size(void* ptr) {
   return -1;
 }
 
+bool chpl_gpu_impl_get_mem_region(const void* ptr,
+                                  chpl_gpu_mem_region_t* region) {
+  return false;
+}
+
 unsigned int chpl_gpu_device_clock_rate(int32_t devNum) {
   return -1;
 }
@@ -156,6 +283,23 @@ bool chpl_gpu_impl_stream_ready(void* stream) {
 void chpl_gpu_impl_stream_synchronize(void* stream) {
 }
 
+bool chpl_gpu_impl_graph_supported(void) {
+  return false;
+}
+
+void chpl_gpu_impl_stream_begin_capture(void* stream) {
+}
+
+void* chpl_gpu_impl_stream_end_capture(void* stream) {
+  return NULL;
+}
+
+void chpl_gpu_impl_graph_launch(void* graph, void* stream) {
+}
+
+void chpl_gpu_impl_graph_destroy(void* graph) {
+}
+
 #define DEF_ONE_REDUCE_RET_VAL(impl_kind, chpl_kind, data_type) \
 void chpl_gpu_impl_##chpl_kind##_reduce_##data_type(data_type* data, int n,\
                                                     data_type* val, int* idx,\
@@ -177,6 +321,9 @@ GPU_DEV_CUB_WRAP(DEF_ONE_REDUCE_RET_VAL_IDX, ArgMax, maxloc)
 
 #undef DEF_ONE_REDUCE_RET_VAL_IDX
 
+void chpl_gpu_impl_fused_reduce(const chpl_gpu_fused_reduce_t* r, int n,
+                                void* stream) {}
+
 #define DEF_ONE_SORT(cub_kind, chpl_kind, data_type) \
 void chpl_gpu_impl_sort_##chpl_kind##_##data_type(data_type* data_in, \
                                                   data_type* data_out, \
@@ -189,6 +336,115 @@ void chpl_gpu_impl_host_unregister(void* var) { }
 
 #undef DEF_ONE_SORT
 
+// "Device" memory is host memory here, so the sorts, scans and selects
+// below just do the work. The sorts are stable, like the radix sorts the
+// GPU implementations use: ties are broken by original position.
+#define DEF_ONE_POS_CMP(chpl_kind, data_type) \
+typedef struct { \
+  data_type key; \
+  int64_t pos; \
+  int64_t val; \
+} pos_##data_type; \
+static int pos_cmp_##data_type(const void* a, const void* b) { \
+  const pos_##data_type* x = (const pos_##data_type*)a; \
+  const pos_##data_type* y = (const pos_##data_type*)b; \
+  if (x->key < y->key) return -1; \
+  if (y->key < x->key) return 1; \
+  return (x->pos > y->pos) - (x->pos < y->pos); \
+}
+
+GPU_CUB_WRAP(DEF_ONE_POS_CMP, unused)
+
+#undef DEF_ONE_POS_CMP
+
+#define DEF_ONE_SORT_PAIRS(cub_kind, chpl_kind, data_type) \
+void chpl_gpu_impl_sort_##chpl_kind##_##data_type(data_type* keys_in, \
+                                                  data_type* keys_out, \
+                                                  int64_t* vals_in, \
+                                                  int64_t* vals_out, \
+                                                  int n, void* stream) { \
+  if (n <= 0) return; \
+  pos_##data_type* tmp = chpl_mem_alloc(n * sizeof(pos_##data_type), \
+                                        CHPL_RT_MD_GPU_KERNEL_ARG, 0, 0); \
+  for (int i = 0; i < n; i++) { \
+    tmp[i].key = keys_in[i]; \
+    tmp[i].pos = i; \
+    tmp[i].val = vals_in ? vals_in[i] : 0; \
+  } \
+  qsort(tmp, n, sizeof(pos_##data_type), pos_cmp_##data_type); \
+  for (int i = 0; i < n; i++) { \
+    keys_out[i] = tmp[i].key; \
+    if (vals_out) vals_out[i] = tmp[i].val; \
+  } \
+  chpl_mem_free(tmp, 0, 0); \
+}
+
+GPU_DEV_CUB_WRAP(DEF_ONE_SORT_PAIRS, SortPairs, pairs)
+
+#undef DEF_ONE_SORT_PAIRS
+
+#define DEF_ONE_SEGMENTED_SORT(cub_kind, chpl_kind, data_type) \
+void chpl_gpu_impl_segmented_sort_##chpl_kind##_##data_type( \
+    data_type* data_in, data_type* data_out, int n, int n_segments, \
+    int* offsets, void* stream) { \
+  if (data_out != data_in) { \
+    memmove(data_out, data_in, n * sizeof(data_type)); \
+  } \
+  for (int s = 0; s < n_segments; s++) { \
+    int len = offsets[s+1] - offsets[s]; \
+    if (len > 1) { \
+      chpl_gpu_impl_sort_pairs_##data_type(data_out + offsets[s], \
+                                           data_out + offsets[s], \
+                                           NULL, NULL, len, stream); \
+    } \
+  } \
+}
+
+GPU_DEV_CUB_WRAP(DEF_ONE_SEGMENTED_SORT, SortKeys, keys)
+
+#undef DEF_ONE_SEGMENTED_SORT
+
+#define DEF_ONE_SCAN(cub_kind, chpl_kind, data_type, include_self) \
+void chpl_gpu_impl_##chpl_kind##_scan_##data_type(data_type* data_in, \
+                                                  data_type* data_out, \
+                                                  int n, void* stream) { \
+  data_type acc = 0; \
+  for (int i = 0; i < n; i++) { \
+    data_type cur = data_in[i]; \
+    if (include_self) acc += cur; \
+    data_out[i] = acc; \
+    if (!include_self) acc += cur; \
+  } \
+}
+#define DEF_ONE_EXCLUSIVE_SCAN(cub_kind, chpl_kind, data_type) \
+  DEF_ONE_SCAN(cub_kind, chpl_kind, data_type, 0)
+#define DEF_ONE_INCLUSIVE_SCAN(cub_kind, chpl_kind, data_type) \
+  DEF_ONE_SCAN(cub_kind, chpl_kind, data_type, 1)
+
+GPU_DEV_CUB_WRAP(DEF_ONE_EXCLUSIVE_SCAN, ExclusiveSum, exclusive)
+GPU_DEV_CUB_WRAP(DEF_ONE_INCLUSIVE_SCAN, InclusiveSum, inclusive)
+
+#undef DEF_ONE_EXCLUSIVE_SCAN
+#undef DEF_ONE_INCLUSIVE_SCAN
+#undef DEF_ONE_SCAN
+
+#define DEF_ONE_SELECT(cub_kind, chpl_kind, data_type) \
+void chpl_gpu_impl_select_##chpl_kind##_##data_type(data_type* data_in, \
+                                                    chpl_bool* flags, \
+                                                    data_type* data_out, \
+                                                    int n, int* n_selected, \
+                                                    void* stream) { \
+  int j = 0; \
+  for (int i = 0; i < n; i++) { \
+    if (flags[i]) data_out[j++] = data_in[i]; \
+  } \
+  *n_selected = j; \
+}
+
+GPU_DEV_CUB_WRAP(DEF_ONE_SELECT, Flagged, flagged)
+
+#undef DEF_ONE_SELECT
+
 void chpl_gpu_impl_name(int dev, char *resultBuffer, int bufferSize) {
   strcpy(resultBuffer, "chapel-cpu-as-device-gpu");
 }
@@ -38,6 +38,7 @@
 #include <cuda.h>
 #include <cuda_runtime.h>
 #include <assert.h>
+#include <string.h>
 #include <stdbool.h>
 
 
@@ -286,6 +287,30 @@ void chpl_gpu_impl_copy_device_to_device(void* dst, const void* src, size_t n,
                               (CUstream)stream))
 }
 
+void chpl_gpu_impl_copy_peer(void* dst, int dst_dev, const void* src,
+                             int src_dev, size_t n, void* stream) {
+  CUDA_CALL(cuMemcpyPeerAsync((CUdeviceptr)dst, chpl_gpu_primary_ctx[dst_dev],
+                              (CUdeviceptr)src, chpl_gpu_primary_ctx[src_dev],
+                              n, (CUstream)stream));
+}
+
+void chpl_gpu_impl_copy_2d(void* dst, size_t dpitch, const void* src,
+                           size_t spitch, size_t width, size_t height,
+                           void* stream) {
+  CUDA_MEMCPY2D m;
+  memset(&m, 0, sizeof(m));
+  // with unified addressing the driver works out which side is which
+  m.srcMemoryType = CU_MEMORYTYPE_UNIFIED;
+  m.srcDevice = (CUdeviceptr)src;
+  m.srcPitch = spitch;
+  m.dstMemoryType = CU_MEMORYTYPE_UNIFIED;
+  m.dstDevice = (CUdeviceptr)dst;
+  m.dstPitch = dpitch;
+  m.WidthInBytes = width;
+  m.Height = height;
+  CUDA_CALL(cuMemcpy2DAsync(&m, (CUstream)stream));
+}
+
 
 void* chpl_gpu_impl_comm_async(void *dst, void *src, size_t n) {
   CUstream stream;
@@ -372,6 +397,118 @@ size_t chpl_gpu_impl_get_alloc_size(void* ptr) {
   return chpl_gpu_common_get_alloc_size(ptr);
 }
 
+bool chpl_gpu_impl_get_mem_region(const void* ptr,
+                                  chpl_gpu_mem_region_t* region) {
+  unsigned int type;
+  if (cuPointerGetAttribute(&type, CU_POINTER_ATTRIBUTE_MEMORY_TYPE,
+                            (CUdeviceptr)ptr) != CUDA_SUCCESS ||
+      type != CU_MEMORYTYPE_DEVICE) {
+    return false;
+  }
+
+  int ordinal;
+  CUdeviceptr base;
+  size_t size;
+  CUDA_CALL(cuPointerGetAttribute(&ordinal,
+                                  CU_POINTER_ATTRIBUTE_DEVICE_ORDINAL,
+                                  (CUdeviceptr)ptr));
+  CUDA_CALL(cuMemGetAddressRange(&base, &size, (CUdeviceptr)ptr));
+
+  region->kind = CHPL_GPU_MEM_REGION_CUDA;
+  region->base = (void*)base;
+  region->size = size;
+  region->device = ordinal;
+  return true;
+}
+
+void* chpl_gpu_impl_event_create(void) {
+  CUevent event;
+  CUDA_CALL(cuEventCreate(&event, CU_EVENT_DEFAULT));
+  return (void*)event;
+}
+
+void chpl_gpu_impl_event_destroy(void* event) {
+  CUDA_CALL(cuEventDestroy((CUevent)event));
+}
+
+void chpl_gpu_impl_event_record(void* event, void* stream) {
+  CUDA_CALL(cuEventRecord((CUevent)event, (CUstream)stream));
+}
+
+bool chpl_gpu_impl_event_done(void* event) {
+  return cuEventQuery((CUevent)event) == CUDA_SUCCESS;
+}
+
+double chpl_gpu_impl_event_elapsed_ms(void* start, void* end) {
+  float ms;
+  CUDA_CALL(cuEventSynchronize((CUevent)end));
+  CUDA_CALL(cuEventElapsedTime(&ms, (CUevent)start, (CUevent)end));
+  return ms;
+}
+
+int chpl_gpu_impl_max_active_blocks(void* function, int blk_size) {
+  int n;
+  CUDA_CALL(cuOccupancyMaxActiveBlocksPerMultiprocessor(&n,
+                                                        (CUfunction)function,
+                                                        blk_size, 0));
+  return n;
+}
+
+bool chpl_gpu_impl_get_managed_range(const void* ptr, void** base,
+                                     size_t* size) {
+  unsigned int managed = 0;
+  if (cuPointerGetAttribute(&managed, CU_POINTER_ATTRIBUTE_IS_MANAGED,
+                            (CUdeviceptr)ptr) != CUDA_SUCCESS || !managed) {
+    return false;
+  }
+
+  CUdeviceptr b;
+  if (cuMemGetAddressRange(&b, size, (CUdeviceptr)ptr) != CUDA_SUCCESS) {
+    return false;
+  }
+  *base = (void*)b;
+  return true;
+}
+
+static CUdevice um_location(int dev_lid) {
+  return dev_lid < 0 ? CU_DEVICE_CPU : chpl_gpu_devices[dev_lid];
+}
+
+void chpl_gpu_impl_mem_prefetch(const void* addr, size_t size, int dev_lid,
+                                void* stream) {
+  CUresult ret = cuMemPrefetchAsync((CUdeviceptr)addr, size,
+                                    um_location(dev_lid), (CUstream)stream);
+  if (ret != CUDA_SUCCESS) {
+    CHPL_GPU_DEBUG("cuMemPrefetchAsync(%p, %zu) failed: %d\n", addr, size,
+                   (int)ret);
+  }
+}
+
+void chpl_gpu_impl_mem_advise(const void* addr, size_t size,
+                              chpl_gpu_mem_advice_t advice, int dev_lid) {
+  CUmem_advise cu_advice;
+  switch (advice) {
+    case CHPL_GPU_MEM_ADVISE_READ_MOSTLY:
+      cu_advice = CU_MEM_ADVISE_SET_READ_MOSTLY; break;
+    case CHPL_GPU_MEM_ADVISE_UNSET_READ_MOSTLY:
+      cu_advice = CU_MEM_ADVISE_UNSET_READ_MOSTLY; break;
+    case CHPL_GPU_MEM_ADVISE_PREFERRED_LOCATION:
+      cu_advice = CU_MEM_ADVISE_SET_PREFERRED_LOCATION; break;
+    case CHPL_GPU_MEM_ADVISE_UNSET_PREFERRED_LOCATION:
+      cu_advice = CU_MEM_ADVISE_UNSET_PREFERRED_LOCATION; break;
+    case CHPL_GPU_MEM_ADVISE_ACCESSED_BY:
+      cu_advice = CU_MEM_ADVISE_SET_ACCESSED_BY; break;
+    default:
+      return;
+  }
+  CUresult ret = cuMemAdvise((CUdeviceptr)addr, size, cu_advice,
+                             um_location(dev_lid));
+  if (ret != CUDA_SUCCESS) {
+    CHPL_GPU_DEBUG("cuMemAdvise(%p, %zu, %d) failed: %d\n", addr, size,
+                   (int)advice, (int)ret);
+  }
+}
+
 unsigned int chpl_gpu_device_clock_rate(int32_t devNum) {
   return (unsigned int)deviceClockRates[devNum];
 }
@@ -425,6 +562,32 @@ void chpl_gpu_impl_stream_synchronize(void* stream) {
   }
 }
 
+bool chpl_gpu_impl_graph_supported(void) {
+  return true;
+}
+
+void chpl_gpu_impl_stream_begin_capture(void* stream) {
+  CUDA_CALL(cuStreamBeginCapture((CUstream)stream,
+                                 CU_STREAM_CAPTURE_MODE_THREAD_LOCAL));
+}
+
+void* chpl_gpu_impl_stream_end_capture(void* stream) {
+  CUgraph graph;
+  CUgraphExec exec;
+  CUDA_CALL(cuStreamEndCapture((CUstream)stream, &graph));
+  CUDA_CALL(cuGraphInstantiateWithFlags(&exec, graph, 0));
+  CUDA_CALL(cuGraphDestroy(graph));
+  return (void*) exec;
+}
+
+void chpl_gpu_impl_graph_launch(void* graph, void* stream) {
+  CUDA_CALL(cuGraphLaunch((CUgraphExec)graph, (CUstream)stream));
+}
+
+void chpl_gpu_impl_graph_destroy(void* graph) {
+  CUDA_CALL(cuGraphExecDestroy((CUgraphExec)graph));
+}
+
 void* chpl_gpu_impl_host_register(void* var, size_t size) {
   CUDA_CALL(cuMemHostRegister(var, size, CU_MEMHOSTREGISTER_PORTABLE));
   return var;
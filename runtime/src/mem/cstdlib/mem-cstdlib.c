@@ -24,6 +24,9 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
 
 #include "chpl-comm.h"
 #include "chpl-mem.h"
@@ -45,3 +48,28 @@ void chpl_mem_layerInit(void) {
 
 
 void chpl_mem_layerExit(void) { }
+
+
+int chpl_mem_layerPurge(void) {
+#ifdef __GLIBC__
+  (void) malloc_trim(0);
+  return 0;
+#else
+  return -1;
+#endif
+}
+
+
+int chpl_mem_layerSetDecay(int64_t dirtyMs, int64_t muzzyMs) {
+  return -1;
+}
+
+
+int chpl_mem_layerGetStats(uint64_t* active, uint64_t* resident) {
+  return -1;
+}
+
+
+int chpl_mem_layerPrintStats(void) {
+  return -1;
+}
@@ -20,6 +20,7 @@
 
 #include "chplrt.h"
 
+#include <inttypes.h>
 #include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -31,6 +32,8 @@
 #include "chpl-linefile-support.h"
 #include "chpl-mem.h"
 #include "chpl-mem-desc.h"
+#include "chpl-mem-sys.h"
+#include "chpl-tasks.h"
 #include "chpl-topo.h"
 #include "chplcgfns.h"
 #include "chplmemtrack.h"
@@ -66,6 +69,28 @@ static struct shared_heap {
   pthread_mutex_t alloc_lock;
 } heap;
 
+//
+// Per-NUMA-domain arenas.  With a fixed heap and more than one NUMA
+// domain, CHPL_RT_NUMA_ARENAS splits the heap into one slice per
+// domain and the small-allocation arenas into one set per domain
+// (arena a belongs to domain a % numDomains).  An arena's extents
+// come from its domain's slice and are localized to that domain as
+// they are handed out, and threads fixed to a domain are moved onto
+// one of its arenas.  Large allocations still share one arena; its
+// extents come from the allocating thread's slice when it has one.
+//
+chpl_bool chpl_je_numa_arenas = false;
+CHPL_TLS_DECL(intptr_t, chpl_je_thread_arena_state);
+
+static struct numa_slice {
+  void* base;
+  size_t size;
+  size_t cur_offset;
+  unsigned next_arena;  // for spreading threads over the domain's arenas
+} *numa_slices;
+static int numa_num_domains;
+static unsigned numa_arenas_per_domain;
+
 
 #if defined(USE_JE_CHUNK_HOOKS) || defined(USE_JE_EXTENT_HOOKS)
 // compute aligned index into our shared heap, alignment must be a power of 2
@@ -225,6 +250,57 @@ static bool chunk_merge(void *chunk_a, size_t size_a, void *chunk_b, size_t size
 #ifdef USE_JE_EXTENT_HOOKS
 
 
+// Carve an extent out of the region [base, base+region_size), whose
+// first *cur_offset bytes are already in use.  Returns NULL if it
+// doesn't fit.  Assumes heap.alloc_lock is held.
+static void* carve_extent(void* base, size_t region_size, size_t* cur_offset,
+                          void* new_addr, size_t size, size_t alignment) {
+  void* extent_base;
+  size_t cur_heap_size;
+
+  // compute our current aligned pointer into the region
+  //
+  //   jemalloc 5.3.0 man: "The alignment parameter is always a power of two at least as large as the page size."
+  extent_base = alignHelper(base, *cur_offset, alignment);
+
+  // jemalloc 5.3.0 man: " If new_addr is not NULL, the returned pointer must be new_addr on success or NULL on error."
+  if (new_addr && new_addr != extent_base) {
+    return NULL;
+  }
+
+  cur_heap_size = (uintptr_t)extent_base - (uintptr_t)base;
+
+  // If there's not enough space in the region for this allocation, return NULL
+  if (cur_heap_size > region_size || size > region_size - cur_heap_size) {
+    return NULL;
+  }
+
+  // Update the current pointer, now that we've past any early returns.
+  *cur_offset = cur_heap_size + size;
+
+  return extent_base;
+}
+
+// The NUMA domain whose heap slice an arena's extents come from.
+static int numa_extent_domain(unsigned arena_ind) {
+  if (arena_ind == CHPL_JE_LG_ARENA) {
+    intptr_t state = (intptr_t) CHPL_TLS_GET(chpl_je_thread_arena_state);
+    int d, best;
+    if (state >= 2) {
+      return (int) (state - 2);
+    }
+    // The calling thread has no domain; use the slice with the most room.
+    for (d = 1, best = 0; d < numa_num_domains; d++) {
+      if (numa_slices[d].size - numa_slices[d].cur_offset
+          > numa_slices[best].size - numa_slices[best].cur_offset) {
+        best = d;
+      }
+    }
+    return best;
+  }
+  return (int) (arena_ind % numa_num_domains);
+}
+
 // Our extent replacement hook for allocations (Essentially a replacement for
 // mmap/sbrk.) Grab memory out of the fixed shared heap or get an extension
 // chunk, and give it to jemalloc.
@@ -235,41 +311,61 @@ static void* extent_alloc(
 
   void* cur_extent_base = NULL;
 
-  if (heap.type == FIXED) {
+  if (heap.type == FIXED && chpl_je_numa_arenas) {
     //
-    // Get more space out of the fixed heap.
+    // Get more space out of a NUMA domain's slice of the fixed heap.
     //
-    size_t cur_heap_size;
+    int domain = numa_extent_domain(arena_ind);
 
-    // this function can be called concurrently and it looks like jemalloc
-    // doesn't call it inside a lock, so we need to protect it ourselves
     pthread_mutex_lock(&heap.alloc_lock);
-
-    // compute our current aligned pointer into the shared heap
-    //
-    //   jemalloc 5.3.0 man: "The alignment parameter is always a power of two at least as large as the page size."
-    cur_extent_base = alignHelper(heap.base, heap.cur_offset, alignment);
-
-    // jemalloc 5.3.0 man: " If new_addr is not NULL, the returned pointer must be new_addr on success or NULL on error."
-    if (new_addr && new_addr != cur_extent_base) {
-      pthread_mutex_unlock(&heap.alloc_lock);
-      return NULL;
+    cur_extent_base = carve_extent(numa_slices[domain].base,
+                                   numa_slices[domain].size,
+                                   &numa_slices[domain].cur_offset,
+                                   new_addr, size, alignment);
+
+    // If our slice is used up, borrow from another rather than failing.
+    if (cur_extent_base == NULL && new_addr == NULL) {
+      for (int d = 0; d < numa_num_domains; d++) {
+        if (d == domain) {
+          continue;
+        }
+        cur_extent_base = carve_extent(numa_slices[d].base,
+                                       numa_slices[d].size,
+                                       &numa_slices[d].cur_offset,
+                                       new_addr, size, alignment);
+        if (cur_extent_base != NULL) {
+          domain = d;
+          break;
+        }
+      }
     }
+    pthread_mutex_unlock(&heap.alloc_lock);
 
-    cur_heap_size = (uintptr_t)cur_extent_base - (uintptr_t)heap.base;
-
-    // If there's not enough space on the heap for this allocation, return NULL
-    if (size > heap.size - cur_heap_size) {
-      pthread_mutex_unlock(&heap.alloc_lock);
+    if (cur_extent_base == NULL) {
       return NULL;
     }
 
-    // Update the current pointer, now that we've past any early returns.
-    heap.cur_offset = cur_heap_size + size;
+    if (interleave_mem && arena_ind == CHPL_JE_LG_ARENA) {
+      chpl_topo_interleaveMemLocality(cur_extent_base, size);
+    } else {
+      chpl_topo_setMemLocality(cur_extent_base, size, true, domain);
+    }
+  } else if (heap.type == FIXED) {
+    //
+    // Get more space out of the fixed heap.
+    //
 
-    // now that cur_heap_offset is updated, we can unlock
+    // this function can be called concurrently and it looks like jemalloc
+    // doesn't call it inside a lock, so we need to protect it ourselves
+    pthread_mutex_lock(&heap.alloc_lock);
+    cur_extent_base = carve_extent(heap.base, heap.size, &heap.cur_offset,
+                                   new_addr, size, alignment);
     pthread_mutex_unlock(&heap.alloc_lock);
 
+    if (cur_extent_base == NULL) {
+      return NULL;
+    }
+
     if (interleave_mem && arena_ind == CHPL_JE_LG_ARENA) {
       chpl_topo_interleaveMemLocality(cur_extent_base, size);
     }
@@ -429,6 +525,58 @@ static void initialize_arenas(void) {
   set_arena(0);
 }
 
+// Move the calling thread onto one of its NUMA domain's arenas, if it
+// is a tasking layer thread fixed to one domain.
+void chpl_je_bind_thread_arena(void) {
+  intptr_t state = 1;
+
+  CHPL_TLS_SET(chpl_je_thread_arena_state, state);
+  if (chpl_task_isFixedThread()) {
+    c_sublocid_t d = chpl_topo_getThreadLocality();
+    if (isActualSublocID(d) && d < numa_num_domains) {
+      unsigned i;
+      pthread_mutex_lock(&heap.alloc_lock);
+      i = numa_slices[d].next_arena++ % numa_arenas_per_domain;
+      pthread_mutex_unlock(&heap.alloc_lock);
+      set_arena(d + i * numa_num_domains);
+      state = 2 + d;
+      CHPL_TLS_SET(chpl_je_thread_arena_state, state);
+    }
+  }
+}
+
+// Split the fixed heap into per-NUMA-domain slices, if requested and
+// there is more than one domain with at least one arena each.
+static void numa_arenas_init(void) {
+  size_t pgSize = chpl_comm_regMemHeapPageSize();
+  size_t slice_size;
+  int d;
+
+  numa_num_domains = chpl_topo_getNumNumaDomains();
+  if (numa_num_domains <= 1
+      || CHPL_JE_LG_ARENA < (unsigned) numa_num_domains) {
+    return;
+  }
+  numa_arenas_per_domain = CHPL_JE_LG_ARENA / numa_num_domains;
+
+  numa_slices = sys_calloc(numa_num_domains, sizeof(*numa_slices));
+  if (numa_slices == NULL) {
+    chpl_internal_error("cannot allocate NUMA heap slices");
+  }
+  slice_size = (heap.size / numa_num_domains) & ~(pgSize - 1);
+  for (d = 0; d < numa_num_domains; d++) {
+    numa_slices[d].base = (char*) heap.base + d * slice_size;
+    numa_slices[d].size = (d == numa_num_domains - 1)
+                          ? heap.size - d * slice_size
+                          : slice_size;
+    numa_slices[d].cur_offset = 0;
+    numa_slices[d].next_arena = 0;
+  }
+
+  CHPL_TLS_INIT(chpl_je_thread_arena_state);
+  chpl_je_numa_arenas = true;
+}
+
 #ifdef USE_JE_EXTENT_HOOKS
 // the memory of new_hooks must last beyond the call to replaceChunkHooks
 static extent_hooks_t new_hooks = {
@@ -643,6 +791,11 @@ void chpl_mem_layerInit(void) {
     if (pthread_mutex_init(&heap.alloc_lock, NULL) != 0) {
       chpl_internal_error("cannot init chunk_alloc lock");
     }
+#ifdef USE_JE_EXTENT_HOOKS
+    if (chpl_env_rt_get_bool("NUMA_ARENAS", false)) {
+      numa_arenas_init();
+    }
+#endif
     initializeSharedHeap();
   } else if (chpl_comm_regMemAllocThreshold() < SIZE_MAX) {
     heap.type = DYNAMIC;
@@ -668,3 +821,121 @@ void chpl_mem_layerExit(void) {
     (void) pthread_mutex_destroy(&heap.alloc_lock);
   }
 }
+
+
+// *** Allocator control *** //
+
+// the number of arenas, including any created after startup
+static unsigned get_num_all_arenas(void) {
+  return get_unsigned_mallctl_value("arenas.narenas");
+}
+
+int chpl_mem_layerPurge(void) {
+  unsigned narenas = get_num_all_arenas();
+  char path[128];
+  int ret = 0;
+
+  for (unsigned arena = 0; arena < narenas; arena++) {
+    snprintf(path, sizeof(path), "arena.%u.purge", arena);
+    if (CHPL_JE_MALLCTL(path, NULL, NULL, NULL, 0) != 0) {
+      ret = -1;
+    }
+  }
+  return ret;
+}
+
+int chpl_mem_layerSetDecay(int64_t dirtyMs, int64_t muzzyMs) {
+#if JEMALLOC_VERSION_MAJOR >= 5
+  const ssize_t decay[2] = { (ssize_t) dirtyMs, (ssize_t) muzzyMs };
+  const char* const kinds[2] = { "dirty", "muzzy" };
+  unsigned narenas = get_num_all_arenas();
+  char path[128];
+  int ret = 0;
+
+  for (int k = 0; k < 2; k++) {
+    // the default for arenas created later, then each existing one
+    snprintf(path, sizeof(path), "arenas.%s_decay_ms", kinds[k]);
+    if (CHPL_JE_MALLCTL(path, NULL, NULL, (void*) &decay[k],
+                        sizeof(decay[k])) != 0) {
+      ret = -1;
+    }
+    for (unsigned arena = 0; arena < narenas; arena++) {
+      snprintf(path, sizeof(path), "arena.%u.%s_decay_ms", arena, kinds[k]);
+      if (CHPL_JE_MALLCTL(path, NULL, NULL, (void*) &decay[k],
+                          sizeof(decay[k])) != 0) {
+        ret = -1;
+      }
+    }
+  }
+  return ret;
+#else
+  return -1;
+#endif
+}
+
+// refresh jemalloc's cached statistics
+static int refresh_stats(void) {
+  uint64_t epoch = 1;
+  size_t sz = sizeof(epoch);
+  return CHPL_JE_MALLCTL("epoch", &epoch, &sz, &epoch, sz) == 0 ? 0 : -1;
+}
+
+int chpl_mem_layerGetStats(uint64_t* active, uint64_t* resident) {
+  size_t value;
+  size_t sz = sizeof(value);
+
+  if (refresh_stats() != 0) {
+    return -1;
+  }
+  if (CHPL_JE_MALLCTL("stats.active", &value, &sz, NULL, 0) != 0) {
+    return -1;
+  }
+  *active = value;
+  if (CHPL_JE_MALLCTL("stats.resident", &value, &sz, NULL, 0) != 0) {
+    return -1;
+  }
+  *resident = value;
+  return 0;
+}
+
+int chpl_mem_layerPrintStats(void) {
+  unsigned narenas = get_num_all_arenas();
+  size_t page = get_size_t_mallctl_value("arenas.page");
+  uint64_t active, resident;
+  char path[128];
+
+  if (chpl_mem_layerGetStats(&active, &resident) != 0) {
+    return -1;
+  }
+  printf("%d: jemalloc: %" PRIu64 " bytes active, %" PRIu64
+         " bytes resident\n",
+         (int) chpl_nodeID, active, resident);
+
+  for (unsigned arena = 0; arena < narenas; arena++) {
+    size_t pactive, pdirty, pmuzzy = 0, aresident = 0;
+    size_t sz = sizeof(size_t);
+
+    snprintf(path, sizeof(path), "stats.arenas.%u.pactive", arena);
+    if (CHPL_JE_MALLCTL(path, &pactive, &sz, NULL, 0) != 0) {
+      continue;
+    }
+    snprintf(path, sizeof(path), "stats.arenas.%u.pdirty", arena);
+    if (CHPL_JE_MALLCTL(path, &pdirty, &sz, NULL, 0) != 0) {
+      pdirty = 0;
+    }
+#if JEMALLOC_VERSION_MAJOR >= 5
+    snprintf(path, sizeof(path), "stats.arenas.%u.pmuzzy", arena);
+    (void) CHPL_JE_MALLCTL(path, &pmuzzy, &sz, NULL, 0);
+    snprintf(path, sizeof(path), "stats.arenas.%u.resident", arena);
+    (void) CHPL_JE_MALLCTL(path, &aresident, &sz, NULL, 0);
+#endif
+    if (pactive == 0 && pdirty == 0 && pmuzzy == 0) {
+      continue;
+    }
+    printf("%d: jemalloc arena %u: %zu bytes active, %zu dirty, "
+           "%zu muzzy, %zu resident\n",
+           (int) chpl_nodeID, arena, pactive * page, pdirty * page,
+           pmuzzy * page, aresident);
+  }
+  return 0;
+}
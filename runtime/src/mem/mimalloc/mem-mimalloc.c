@@ -20,28 +20,200 @@
 
 #include "chplrt.h"
 
+#include <inttypes.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
 
 #include "chpl-comm.h"
+#include "chpl-env.h"
 #include "chpl-mem.h"
+#include "chpl-mem-sys.h"
+#include "chpl-tasks.h"
+#include "chpl-topo.h"
 #include "chplmemtrack.h"
 #include "chpltypes.h"
 #include "error.h"
 
+//
+// Registered heap support.  When the comm layer provides a fixed heap
+// we hand it to mimalloc as arenas and forbid mimalloc from getting
+// memory from the OS, so that everything we allocate is registered.
+// The memory is marked pinned so that mimalloc never decommits it.
+//
+// By default the whole heap is one arena that every thread's default
+// heap shares.  With CHPL_RT_NUMA_ARENAS and more than one NUMA domain,
+// the heap is split into one exclusive arena per domain instead, and
+// each thread gets its own mimalloc heap in its domain's arena the
+// first time it allocates.  Threads that aren't fixed to one domain
+// are spread across the domains round-robin.
+//
+
+// mimalloc arenas are made of 32 MiB (MI_ARENA_BLOCK_SIZE) blocks and
+// must be aligned to that.
+#define MI_ARENA_ALIGN ((size_t) 32 << 20)
+
+chpl_bool chpl_mi_numa_heaps = false;
+CHPL_TLS_DECL(intptr_t, chpl_mi_thread_heap_state);
+
+static int numa_num_domains;
+static mi_arena_id_t* numa_arenas;
+static int numa_next_domain;
+static pthread_mutex_t numa_lock = PTHREAD_MUTEX_INITIALIZER;
+
+
+// Give mimalloc [base, base+size) as an arena, trimmed to its alignment.
+static chpl_bool add_arena(void* base, size_t size, int domain,
+                           chpl_bool exclusive, mi_arena_id_t* arena_id) {
+  uintptr_t lo = ((uintptr_t) base + MI_ARENA_ALIGN - 1)
+                 & ~(MI_ARENA_ALIGN - 1);
+  uintptr_t hi = ((uintptr_t) base + size) & ~(MI_ARENA_ALIGN - 1);
+
+  if (hi <= lo) {
+    return false;
+  }
+  if (domain >= 0) {
+    chpl_topo_setMemLocality((void*) lo, hi - lo, true, domain);
+  }
+  return mi_manage_os_memory_ex((void*) lo, hi - lo,
+                                true /*is_committed*/, true /*is_large*/,
+                                false /*is_zero*/, -1 /*numa_node*/,
+                                exclusive, arena_id);
+}
+
+
+// Split the heap into per-NUMA-domain arenas, if requested and there
+// is more than one domain with room for an arena each.
+static chpl_bool numa_heaps_init(void* start, size_t size) {
+  size_t slice_size;
+  int d;
+
+  if (!chpl_env_rt_get_bool("NUMA_ARENAS", false)) {
+    return false;
+  }
+  numa_num_domains = chpl_topo_getNumNumaDomains();
+  if (numa_num_domains <= 1) {
+    return false;
+  }
+  slice_size = (size / numa_num_domains) & ~(MI_ARENA_ALIGN - 1);
+  if (slice_size < 2 * MI_ARENA_ALIGN) {
+    return false;
+  }
+
+  numa_arenas = sys_calloc(numa_num_domains, sizeof(*numa_arenas));
+  if (numa_arenas == NULL) {
+    chpl_internal_error("cannot allocate NUMA arena table");
+  }
+  for (d = 0; d < numa_num_domains; d++) {
+    size_t this_size = (d == numa_num_domains - 1)
+                       ? size - d * slice_size
+                       : slice_size;
+    if (!add_arena((char*) start + d * slice_size, this_size, d,
+                   true, &numa_arenas[d])) {
+      chpl_internal_error("cannot give mimalloc a NUMA slice of the heap");
+    }
+  }
+
+  CHPL_TLS_INIT(chpl_mi_thread_heap_state);
+  chpl_mi_numa_heaps = true;
+  return true;
+}
+
+
+// Give the calling thread a mimalloc heap in its NUMA domain's arena.
+void chpl_mi_bind_thread_heap(void) {
+  c_sublocid_t d = c_sublocid_none;
+  mi_heap_t* heap;
+  intptr_t state;
+
+  state = 1;
+  CHPL_TLS_SET(chpl_mi_thread_heap_state, state);
+
+  if (chpl_task_isFixedThread()) {
+    d = chpl_topo_getThreadLocality();
+  }
+  if (!isActualSublocID(d) || d >= numa_num_domains) {
+    pthread_mutex_lock(&numa_lock);
+    d = numa_next_domain++ % numa_num_domains;
+    pthread_mutex_unlock(&numa_lock);
+  }
+
+  if ((heap = mi_heap_new_in_arena(numa_arenas[d])) == NULL) {
+    chpl_internal_error("cannot create mimalloc heap in NUMA arena");
+  }
+  (void) mi_heap_set_default(heap);
+  state = 2 + d;
+  CHPL_TLS_SET(chpl_mi_thread_heap_state, state);
+}
+
+
 void chpl_mem_layerInit(void) {
   void* start;
   size_t size;
 
   chpl_comm_regMemHeapInfo(&start, &size);
-  if (start || size) {
+  if (start == NULL && size == 0) {
+    return;
+  }
+  if (start == NULL || size == 0) {
     chpl_error("Your CHPL_MEM setting doesn't support the registered heap "
                "required by your CHPL_COMM setting. You'll need to change one "
                "of these configurations.", 0, 0);
   }
+
+  mi_option_enable(mi_option_disallow_os_alloc);
+  mi_option_set(mi_option_purge_delay, -1);
+
+  if (!numa_heaps_init(start, size)) {
+    if (!add_arena(start, size, -1, false, NULL)) {
+      chpl_error("The registered heap is too small for CHPL_MEM=mimalloc.",
+                 0, 0);
+    }
+  }
 }
 
 
 void chpl_mem_layerExit(void) { }
+
+
+// mimalloc keeps its memory in per-thread heaps, and can only collect
+// the calling thread's along with any abandoned by exited threads.
+int chpl_mem_layerPurge(void) {
+  mi_collect(true);
+  return 0;
+}
+
+
+// mimalloc has a single purge delay and no muzzy state.  With a
+// registered heap nothing is ever purged, so leave that alone.
+int chpl_mem_layerSetDecay(int64_t dirtyMs, int64_t muzzyMs) {
+  if (mi_option_is_enabled(mi_option_disallow_os_alloc)) {
+    return -1;
+  }
+  mi_option_set(mi_option_purge_delay, (long) dirtyMs);
+  return 0;
+}
+
+
+int chpl_mem_layerGetStats(uint64_t* active, uint64_t* resident) {
+  size_t current_rss, peak_rss, current_commit, peak_commit;
+
+  mi_process_info(NULL, NULL, NULL, &current_rss, &peak_rss,
+                  &current_commit, &peak_commit, NULL);
+  *active = current_commit;
+  *resident = current_rss;
+  return 0;
+}
+
+
+int chpl_mem_layerPrintStats(void) {
+  uint64_t active, resident;
+
+  (void) chpl_mem_layerGetStats(&active, &resident);
+  printf("%d: mimalloc: %" PRIu64 " bytes committed, %" PRIu64
+         " bytes resident\n",
+         (int) chpl_nodeID, active, resident);
+  return 0;
+}
@@ -25,6 +25,120 @@
 
 #include "bulkget.h"
 
+// Transfers are split into pieces of at most this many bytes, and up
+// to BULK_PIPELINE_DEPTH of them are in flight at once.
+ssize_t qio_bulk_xfer_chunk = 256*1024;
+
+#define BULK_PIPELINE_DEPTH 8
+
+typedef struct {
+  chpl_comm_nb_handle_t h[BULK_PIPELINE_DEPTH];
+  size_t n;
+} bulk_pipeline_t;
+
+// With the remote cache on, go through it (one blocking transfer at
+// a time) so the transfers see and update the same data it does.
+static inline
+int bulk_use_nb(int64_t locale)
+{
+  if( locale == chpl_nodeID ) return 0;
+#ifdef HAS_CHPL_CACHE_FNS
+  if( chpl_cache_enabled() ) return 0;
+#endif
+  return 1;
+}
+
+// Free any completed handles and pack the rest at the front.
+static
+void bulk_pipeline_reap(bulk_pipeline_t* p)
+{
+  size_t i, j;
+
+  j = 0;
+  for( i = 0; i < p->n; i++ ) {
+    if( chpl_comm_test_nb_complete(p->h[i]) ) {
+      chpl_comm_free_nb_handle(p->h[i]);
+    } else {
+      p->h[j++] = p->h[i];
+    }
+  }
+  p->n = j;
+}
+
+// Wait until there is room for another transfer.
+static
+void bulk_pipeline_make_room(bulk_pipeline_t* p)
+{
+  while( p->n == BULK_PIPELINE_DEPTH ) {
+    chpl_comm_wait_nb_some(p->h, p->n);
+    bulk_pipeline_reap(p);
+  }
+}
+
+static
+void bulk_pipeline_add(bulk_pipeline_t* p, chpl_comm_nb_handle_t h)
+{
+  // A NULL handle means the transfer was already done.
+  if( h != NULL ) p->h[p->n++] = h;
+}
+
+static
+void bulk_pipeline_drain(bulk_pipeline_t* p)
+{
+  while( p->n > 0 ) {
+    chpl_comm_wait_nb_some(p->h, p->n);
+    bulk_pipeline_reap(p);
+  }
+}
+
+// Get len bytes from src_locale in pieces, keeping several in flight.
+static
+void bulk_get(bulk_pipeline_t* p, void* dst, int64_t src_locale,
+              void* src, size_t len)
+{
+  size_t off;
+
+  if( !bulk_use_nb(src_locale) ) {
+    chpl_gen_comm_get(dst, src_locale, src, len,
+                      CHPL_COMM_UNKNOWN_ID, -1, CHPL_FILE_IDX_INTERNAL);
+    return;
+  }
+
+  for( off = 0; off < len; off += qio_bulk_xfer_chunk ) {
+    size_t amt = len - off;
+    if( amt > (size_t) qio_bulk_xfer_chunk ) amt = qio_bulk_xfer_chunk;
+    bulk_pipeline_make_room(p);
+    bulk_pipeline_add(p, chpl_comm_get_nb(PTR_ADDBYTES(dst, off),
+                                          src_locale, PTR_ADDBYTES(src, off),
+                                          amt, CHPL_COMM_UNKNOWN_ID,
+                                          -1, CHPL_FILE_IDX_INTERNAL));
+  }
+}
+
+// Put len bytes to dst_locale in pieces, keeping several in flight.
+static
+void bulk_put(bulk_pipeline_t* p, void* src, int64_t dst_locale,
+              void* dst, size_t len)
+{
+  size_t off;
+
+  if( !bulk_use_nb(dst_locale) ) {
+    chpl_gen_comm_put(src, dst_locale, dst, len,
+                      CHPL_COMM_UNKNOWN_ID, -1, CHPL_FILE_IDX_INTERNAL);
+    return;
+  }
+
+  for( off = 0; off < len; off += qio_bulk_xfer_chunk ) {
+    size_t amt = len - off;
+    if( amt > (size_t) qio_bulk_xfer_chunk ) amt = qio_bulk_xfer_chunk;
+    bulk_pipeline_make_room(p);
+    bulk_pipeline_add(p, chpl_comm_put_nb(PTR_ADDBYTES(src, off),
+                                          dst_locale, PTR_ADDBYTES(dst, off),
+                                          amt, CHPL_COMM_UNKNOWN_ID,
+                                          -1, CHPL_FILE_IDX_INTERNAL));
+  }
+}
+
 // The initial ref count in the return qbytes buffer is 1.
 // The caller is responsible for calling qbytes_release on it when done.
 qbytes_t* bulk_get_bytes(int64_t src_locale, qbytes_t* src_addr)
@@ -34,6 +148,9 @@ qbytes_t* bulk_get_bytes(int64_t src_locale, qbytes_t* src_addr)
   int64_t src_len;
   void* src_data;
   qioerr err;
+  bulk_pipeline_t p;
+
+  p.n = 0;
 
   // Zero-initialize tmp.
   memset(&tmp, 0, sizeof(qbytes_t));
@@ -48,20 +165,60 @@ qbytes_t* bulk_get_bytes(int64_t src_locale, qbytes_t* src_addr)
   err = qbytes_create_calloc(&ret, src_len);
   if( err ) return NULL;
 
-  // TODO -- note -- technically, this should be gasnet_get_bulk,
-  // since we don't want to require src/dst to have a particular alignment.
-
   // Next, get the data itself.
   if( src_data ) {
-    chpl_gen_comm_get(ret->data, src_locale, src_data,
-                      sizeof(uint8_t) * src_len,
-                      CHPL_COMM_UNKNOWN_ID, -1, CHPL_FILE_IDX_INTERNAL);
+    bulk_get(&p, ret->data, src_locale, src_data, sizeof(uint8_t) * src_len);
+    bulk_pipeline_drain(&p);
   }
 
   // Great! All done.
   return ret;
 }
 
+qioerr bulk_get_buffer(int64_t src_locale, void* src_addr, int64_t src_len,
+                       qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end)
+{
+  int64_t num_bytes = qbuffer_iter_num_bytes(start, end);
+  ssize_t num_parts = qbuffer_iter_num_parts(start, end);
+  struct iovec* iov = NULL;
+  size_t iovcnt;
+  size_t i,j;
+  MAYBE_STACK_SPACE(struct iovec, iov_onstack);
+  qioerr err;
+  bulk_pipeline_t p;
+
+  p.n = 0;
+
+  if( num_bytes < 0 || num_parts < 0 || start.offset < buf->offset_start || end.offset > buf->offset_end )  QIO_RETURN_CONSTANT_ERROR(EINVAL, "range outside of buffer");
+
+  MAYBE_STACK_ALLOC(struct iovec, num_parts, iov, iov_onstack);
+  if( ! iov ) return QIO_ENOMEM;
+
+  err = qbuffer_to_iov(buf, start, end, num_parts, iov, NULL, &iovcnt);
+  if( err ) goto error;
+
+  j = 0;
+  for( i = 0; i < iovcnt; i++ ) {
+    if( j + iov[i].iov_len > src_len ) {
+      QIO_GET_CONSTANT_ERROR(err, EMSGSIZE, "not enough data");
+      goto error;
+    }
+
+    bulk_get(&p, iov[i].iov_base, src_locale, PTR_ADDBYTES(src_addr, j),
+             sizeof(uint8_t)*iov[i].iov_len);
+
+    j += iov[i].iov_len;
+  }
+
+  err = 0;
+
+error:
+  // Nothing can be returned while gets into buf are still going.
+  bulk_pipeline_drain(&p);
+  MAYBE_STACK_FREE(iov, iov_onstack);
+  return err;
+}
+
 qioerr bulk_put_buffer(int64_t dst_locale, void* dst_addr, int64_t dst_len,
                       qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end)
 {
@@ -72,6 +229,9 @@ qioerr bulk_put_buffer(int64_t dst_locale, void* dst_addr, int64_t dst_len,
   size_t i,j;
   MAYBE_STACK_SPACE(struct iovec, iov_onstack);
   qioerr err;
+  bulk_pipeline_t p;
+
+  p.n = 0;
 
   if( num_bytes < 0 || num_parts < 0 || start.offset < buf->offset_start || end.offset > buf->offset_end )  QIO_RETURN_CONSTANT_ERROR(EINVAL, "range outside of buffer");
 
@@ -83,27 +243,22 @@ qioerr bulk_put_buffer(int64_t dst_locale, void* dst_addr, int64_t dst_len,
 
   j = 0;
   for( i = 0; i < iovcnt; i++ ) {
-    if( j + iov[i].iov_len > dst_len ) goto error_nospace;
-    //chpl_memcpy(PTR_ADDBYTES(ptr, j), iov[i].iov_base, iov[i].iov_len);
+    if( j + iov[i].iov_len > dst_len ) {
+      QIO_GET_CONSTANT_ERROR(err, EMSGSIZE, "no space in buffer");
+      goto error;
+    }
 
-    // TODO -- note -- technically, this should be gasnet_put_bulk,
-    // since we don't want to require src/dst to have a particular alignment.
-    chpl_gen_comm_put( iov[i].iov_base,
-                       dst_locale,
-                       PTR_ADDBYTES(dst_addr, j),
-                       sizeof(uint8_t)*iov[i].iov_len,
-                       CHPL_COMM_UNKNOWN_ID, -1, CHPL_FILE_IDX_INTERNAL);
+    bulk_put(&p, iov[i].iov_base, dst_locale, PTR_ADDBYTES(dst_addr, j),
+             sizeof(uint8_t)*iov[i].iov_len);
 
     j += iov[i].iov_len;
   }
 
-  MAYBE_STACK_FREE(iov, iov_onstack);
-  return 0;
+  err = 0;
 
-error_nospace:
-  QIO_RETURN_CONSTANT_ERROR(EMSGSIZE, "no space in buffer");
 error:
+  // The caller may change buf once we return, so finish the puts.
+  bulk_pipeline_drain(&p);
   MAYBE_STACK_FREE(iov, iov_onstack);
   return err;
 }
-
@@ -29,8 +29,10 @@
 #include "error.h"
 
 #include "sys.h"
+#include "chpl-thread-local-storage.h"
 
 #include <limits.h>
+#include <pthread.h>
 #include <sys/mman.h>
 
 #include <ctype.h>
@@ -41,6 +43,12 @@
 // but we can't know page size at compile time
 size_t qbytes_iobuf_size = 64*1024;
 
+// how many freed direct I/O buffers to keep for reuse
+size_t qbytes_direct_pool_max = 64;
+
+// how many freed iobufs each thread keeps for reuse
+size_t qbytes_iobuf_pool_max = 8;
+
 // prototypes.
 
 void qbytes_free_iobuf(qbytes_t* b);
@@ -86,9 +94,134 @@ void qbytes_free_qio_free(qbytes_t* b) {
   qio_free(b->data);
   _qbytes_free_qbytes(b);
 }
+
+// Channels allocate an iobuf for every buffer's worth of data they
+// move and free it soon after, and programs that open and close a lot
+// of short channels do that over and over.  So each thread keeps a few
+// freed iobufs to hand out again, which needs no locking.  An iobuf
+// goes back to the cache of whichever thread frees it.  Every buffer in
+// a cache has the same size, so if qbytes_iobuf_size changes the cache
+// is drained the next time it is used.  Buffers cached by a thread that
+// exits are not returned to the allocator; the runtime's threads
+// normally last as long as the program does.
+#define QBYTES_IOBUF_POOL_SLOTS 16
+
+#ifdef CHPL_TLS
+typedef struct qbytes_iobuf_pool_s {
+  size_t size; // size of the buffers in it
+  size_t len;
+  void* data[QBYTES_IOBUF_POOL_SLOTS];
+} qbytes_iobuf_pool_t;
+
+static CHPL_TLS_DECL(qbytes_iobuf_pool_t, qbytes_iobuf_pool);
+
+static
+void qbytes_iobuf_pool_drain(qbytes_iobuf_pool_t* p, size_t size)
+{
+  while( p->len > 0 )
+    qio_free(p->data[--p->len]);
+  p->size = size;
+}
+#endif
+
+static
+void* qbytes_iobuf_pool_get(size_t size)
+{
+#ifdef CHPL_TLS
+  qbytes_iobuf_pool_t* p = &qbytes_iobuf_pool;
+
+  if( p->size != size ) qbytes_iobuf_pool_drain(p, size);
+  if( p->len > 0 ) return p->data[--p->len];
+#endif
+  return NULL;
+}
+
+static
+void qbytes_iobuf_pool_put(void* data, size_t size)
+{
+#ifdef CHPL_TLS
+  qbytes_iobuf_pool_t* p = &qbytes_iobuf_pool;
+  size_t max = qbytes_iobuf_pool_max;
+
+  if( max > QBYTES_IOBUF_POOL_SLOTS ) max = QBYTES_IOBUF_POOL_SLOTS;
+  if( p->size != size ) qbytes_iobuf_pool_drain(p, size);
+  if( p->len < max ) {
+    p->data[p->len++] = data;
+    return;
+  }
+#endif
+  qio_free(data);
+}
+
 void qbytes_free_iobuf(qbytes_t* b) {
-  // iobuf is just something to be freed with free()
-  qbytes_free_qio_free(b);
+  // iobuf is just something to be freed with free(),
+  // but keep it around in case another one is needed soon
+  qbytes_iobuf_pool_put(b->data, b->len);
+  _qbytes_free_qbytes(b);
+}
+
+// Buffers for direct I/O are aligned to QIO_DIRECT_ALIGN and are kept
+// in a pool when freed, so that channels doing a lot of direct I/O don't
+// keep going back to the allocator for aligned memory.  Every buffer in
+// the pool has the same size, so if qbytes_iobuf_size changes the pool
+// is drained.
+static pthread_mutex_t qbytes_direct_pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static void** qbytes_direct_pool = NULL;
+static size_t qbytes_direct_pool_len = 0;
+static size_t qbytes_direct_pool_size = 0; // size of the buffers in it
+
+static
+size_t qbytes_direct_iobuf_size(void)
+{
+  return (qbytes_iobuf_size + QIO_DIRECT_ALIGN - 1) & ~(size_t)(QIO_DIRECT_ALIGN - 1);
+}
+
+static
+void* qbytes_direct_pool_get(size_t size)
+{
+  void* data = NULL;
+
+  pthread_mutex_lock(&qbytes_direct_pool_lock);
+  if( qbytes_direct_pool_size != size ) {
+    while( qbytes_direct_pool_len > 0 )
+      qio_free(qbytes_direct_pool[--qbytes_direct_pool_len]);
+    qbytes_direct_pool_size = size;
+  } else if( qbytes_direct_pool_len > 0 ) {
+    data = qbytes_direct_pool[--qbytes_direct_pool_len];
+  }
+  pthread_mutex_unlock(&qbytes_direct_pool_lock);
+
+  if( data == NULL ) {
+    size_t align = sys_page_size();
+    if( align < QIO_DIRECT_ALIGN ) align = QIO_DIRECT_ALIGN;
+    data = qio_memalign(align, size);
+  }
+
+  return data;
+}
+
+static
+void qbytes_direct_pool_put(void* data, size_t size)
+{
+  pthread_mutex_lock(&qbytes_direct_pool_lock);
+  if( qbytes_direct_pool_size == size &&
+      qbytes_direct_pool_len < qbytes_direct_pool_max ) {
+    if( qbytes_direct_pool == NULL ) {
+      qbytes_direct_pool = (void**) qio_malloc(qbytes_direct_pool_max * sizeof(void*));
+    }
+    if( qbytes_direct_pool != NULL ) {
+      qbytes_direct_pool[qbytes_direct_pool_len++] = data;
+      data = NULL;
+    }
+  }
+  pthread_mutex_unlock(&qbytes_direct_pool_lock);
+
+  if( data ) qio_free(data);
+}
+
+void qbytes_free_direct_iobuf(qbytes_t* b) {
+  qbytes_direct_pool_put(b->data, b->len);
+  _qbytes_free_qbytes(b);
 }
 
 void debug_print_bytes(qbytes_t* b)
@@ -152,10 +285,13 @@ qioerr _qbytes_init_iobuf(qbytes_t* ret)
   // qbytes_iobuf_size is generally >= page size. However in
   // some testing configurations, it is very small (e.g. 5 bytes).
   size_t page_size = sys_page_size();
-  if (qbytes_iobuf_size >= page_size)
-    data = qio_memalign(page_size, qbytes_iobuf_size);
-  else
-    data = qio_malloc(qbytes_iobuf_size);
+  data = qbytes_iobuf_pool_get(qbytes_iobuf_size);
+  if (data == NULL) {
+    if (qbytes_iobuf_size >= page_size)
+      data = qio_memalign(page_size, qbytes_iobuf_size);
+    else
+      data = qio_malloc(qbytes_iobuf_size);
+  }
 
   if( !data ) return QIO_ENOMEM;
   memset(data, 0, qbytes_iobuf_size);
@@ -167,6 +303,33 @@ qioerr _qbytes_init_iobuf(qbytes_t* ret)
 }
 
 
+qioerr qbytes_create_direct_iobuf(qbytes_t** out)
+{
+  qbytes_t* ret = NULL;
+  size_t size = qbytes_direct_iobuf_size();
+  void* data;
+
+  ret = (qbytes_t*) qio_calloc(1, sizeof(qbytes_t));
+  if( ! ret ) {
+    *out = NULL;
+    return QIO_ENOMEM;
+  }
+
+  data = qbytes_direct_pool_get(size);
+  if( ! data ) {
+    qio_free(ret);
+    *out = NULL;
+    return QIO_ENOMEM;
+  }
+  memset(data, 0, size);
+
+  // The ref count in ret is initially 1.
+  _qbytes_init_generic(ret, data, size, qbytes_free_direct_iobuf);
+
+  *out = ret;
+  return 0;
+}
+
 qioerr qbytes_create_iobuf(qbytes_t** out)
 {
   qbytes_t* ret = NULL;
@@ -545,7 +708,7 @@ void qbuffer_trim_back(qbuffer_t* buf, int64_t remove_bytes)
         qbytes_t* bytes = qbp->bytes;
         // starts entirely after new_end, remove the chunk.
         // Remove it from the deque
-        deque_pop_front(sizeof(qbuffer_part_t), &buf->deque);
+        deque_pop_back(sizeof(qbuffer_part_t), &buf->deque);
         // release the bytes.
         qbytes_release(bytes);
       } else {
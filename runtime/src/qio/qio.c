@@ -34,11 +34,13 @@
 
 #ifndef CHPL_RT_UNIT_TEST
 #include "chplrt.h"
+#include "chpl-env.h"
 #endif
 
 #include "qio.h"
 #include "qbuffer.h"
 #include "qio_plugin_api.h"
+#include "qio_compress.h"
 
 #include "error.h"
 
@@ -58,6 +60,23 @@
 #include <sys/stat.h>
 
 #include <assert.h>
+#include <pthread.h>
+
+#include "chpl-thread-local-storage.h"
+
+#ifdef __linux__
+#include <sys/sendfile.h>
+#include <sys/syscall.h>
+#endif
+
+#if defined(__linux__) && defined(CHPL_TLS)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#include <linux/io_uring.h>
+#define QIO_HAS_URING 1
+#endif
+#endif
 
 // Default to using close-on-exec for systems that support it.
 #ifdef O_CLOEXEC
@@ -82,6 +101,7 @@
 #endif
 
 static qioerr open_flags_for_string(const char* s, int *flags_out);
+static qio_err_t sys_open(const char* pathname, int flags, mode_t mode, fd_t* fd_out);
 static void _qio_buffered_advance_cached_leave_bits(qio_channel_t* ch);
 
 // A few global variables that control which I/O strategy is used.
@@ -104,6 +124,17 @@ ssize_t qio_write_unbuffered_threshold = 32*1024;
 // can avoid buffering by calling pread/fread/read directly
 ssize_t qio_read_unbuffered_threshold = 32*1024;
 
+// with io_uring, buffered reads fill at least this many iobufs at a
+// time so that several requests are in flight at once (1M)
+ssize_t qio_uring_readahead_iobufs = 16;
+
+// regions made by qio_file_regions are at least this long (1M)
+ssize_t qio_parallel_region_min = 1024*1024;
+
+// whether to choose io_uring instead of pread/pwrite when no method is
+// hinted; -1 means read CHPL_RT_QIO_URING the first time it's needed
+int qio_uring_default = -1;
+
 #ifdef _chplrt_H_
 qioerr qio_lock(qio_lock_t* x) {
   // recursive mutex based on glibc pthreads implementation
@@ -149,6 +180,19 @@ void qio_unlock(qio_lock_t* x) {
 #include "qio_plugin_api_dummy.c"
 #endif
 
+const qio_plugin_fns_t chpl_qio_plugin_fns = {
+  chpl_qio_setup_plugin_channel,
+  chpl_qio_read_atleast,
+  chpl_qio_write,
+  chpl_qio_channel_close,
+  chpl_qio_filelength,
+  chpl_qio_getpath,
+  chpl_qio_fsync,
+  chpl_qio_get_chunk,
+  chpl_qio_get_locales_for_region,
+  chpl_qio_file_close,
+};
+
 qioerr qio_readv(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, ssize_t* num_read)
 {
   ssize_t nread = 0;
@@ -410,6 +454,380 @@ error:
   return err;
 }
 
+// io_uring support.  Each thread gets its own ring, created the first
+// time it does io_uring I/O.  Only that thread touches it, so it needs
+// no locking.  A task can't switch threads during a call, so the call
+// always uses its own thread's ring.  Rings live until the program
+// exits.  We use the raw system calls rather than liburing.
+#ifdef QIO_HAS_URING
+
+#ifndef IORING_FEAT_SINGLE_MMAP
+#define IORING_FEAT_SINGLE_MMAP (1U << 0)
+#endif
+
+// requests in flight per ring
+#define QIO_URING_DEPTH 32
+
+typedef struct qio_uring_s {
+  int state; // 0 not set up yet, 1 usable, -1 unavailable
+  int fd;
+  unsigned entries;
+  unsigned* sq_tail;
+  unsigned* sq_mask;
+  unsigned* sq_array;
+  struct io_uring_sqe* sqes;
+  unsigned* cq_head;
+  unsigned* cq_tail;
+  unsigned* cq_mask;
+  struct io_uring_cqe* cqes;
+  void* sq_ring;
+  size_t sq_ring_size;
+  void* cq_ring;
+  size_t cq_ring_size;
+  size_t sqes_size;
+} qio_uring_t;
+
+static CHPL_TLS_DECL(qio_uring_t, qio_uring_ring);
+
+static
+void qio_uring_teardown(qio_uring_t* r)
+{
+  if( r->sqes ) munmap(r->sqes, r->sqes_size);
+  if( r->cq_ring && r->cq_ring != r->sq_ring )
+    munmap(r->cq_ring, r->cq_ring_size);
+  if( r->sq_ring ) munmap(r->sq_ring, r->sq_ring_size);
+  close(r->fd);
+  r->sqes = NULL;
+  r->cq_ring = NULL;
+  r->sq_ring = NULL;
+  r->state = -1;
+}
+
+static
+qio_uring_t* qio_uring_get(void)
+{
+  qio_uring_t* r = &qio_uring_ring;
+  struct io_uring_params p;
+  void* m;
+
+  if( r->state != 0 ) return r->state > 0 ? r : NULL;
+
+  r->state = -1;
+
+  memset(&p, 0, sizeof(p));
+  // ENOSYS before Linux 5.1; EPERM if disabled by io_uring_disabled.
+  r->fd = (int) syscall(__NR_io_uring_setup, QIO_URING_DEPTH, &p);
+  if( r->fd < 0 ) return NULL;
+
+  r->sq_ring_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+  r->cq_ring_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+  if( p.features & IORING_FEAT_SINGLE_MMAP ) {
+    if( r->cq_ring_size > r->sq_ring_size )
+      r->sq_ring_size = r->cq_ring_size;
+    r->cq_ring_size = r->sq_ring_size;
+  }
+
+  m = mmap(NULL, r->sq_ring_size, PROT_READ|PROT_WRITE,
+           MAP_SHARED|MAP_POPULATE, r->fd, IORING_OFF_SQ_RING);
+  if( m == MAP_FAILED ) goto error;
+  r->sq_ring = m;
+
+  if( p.features & IORING_FEAT_SINGLE_MMAP ) {
+    r->cq_ring = r->sq_ring;
+  } else {
+    m = mmap(NULL, r->cq_ring_size, PROT_READ|PROT_WRITE,
+             MAP_SHARED|MAP_POPULATE, r->fd, IORING_OFF_CQ_RING);
+    if( m == MAP_FAILED ) goto error;
+    r->cq_ring = m;
+  }
+
+  r->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+  m = mmap(NULL, r->sqes_size, PROT_READ|PROT_WRITE,
+           MAP_SHARED|MAP_POPULATE, r->fd, IORING_OFF_SQES);
+  if( m == MAP_FAILED ) goto error;
+  r->sqes = (struct io_uring_sqe*) m;
+
+  r->entries = p.sq_entries;
+  if( r->entries > QIO_URING_DEPTH ) r->entries = QIO_URING_DEPTH;
+  r->sq_tail = (unsigned*) qio_ptr_add(r->sq_ring, p.sq_off.tail);
+  r->sq_mask = (unsigned*) qio_ptr_add(r->sq_ring, p.sq_off.ring_mask);
+  r->sq_array = (unsigned*) qio_ptr_add(r->sq_ring, p.sq_off.array);
+  r->cq_head = (unsigned*) qio_ptr_add(r->cq_ring, p.cq_off.head);
+  r->cq_tail = (unsigned*) qio_ptr_add(r->cq_ring, p.cq_off.tail);
+  r->cq_mask = (unsigned*) qio_ptr_add(r->cq_ring, p.cq_off.ring_mask);
+  r->cqes = (struct io_uring_cqe*) qio_ptr_add(r->cq_ring, p.cq_off.cqes);
+
+  r->state = 1;
+  return r;
+
+error:
+  qio_uring_teardown(r);
+  return NULL;
+}
+
+// Submit up to a ring's worth of requests and wait for all of them.
+// Request i transfers iovcnt[i] iovecs (1 if iovcnt is NULL), taken in
+// order from iov, at file offset offsets[i].  Stores each request's
+// result (bytes or -errno) in res.  Returns 0, or an errno if the ring
+// itself failed with nothing left in flight.
+static
+int qio_uring_submit_wait(qio_uring_t* r, int writing, fd_t fd,
+                          const struct iovec* iov, const int* iovcnt,
+                          const off_t* offsets, int n, int32_t* res)
+{
+  unsigned tail = *r->sq_tail;
+  unsigned head;
+  unsigned ctail;
+  int submitted = 0;
+  int reaped = 0;
+  int rc;
+  int i;
+
+  for( i = 0; i < n; i++ ) {
+    unsigned idx = (tail + i) & *r->sq_mask;
+    struct io_uring_sqe* sqe = &r->sqes[idx];
+    int cnt = iovcnt ? iovcnt[i] : 1;
+
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = writing ? IORING_OP_WRITEV : IORING_OP_READV;
+    sqe->fd = fd;
+    sqe->addr = (uint64_t) (uintptr_t) iov;
+    sqe->len = cnt;
+    sqe->off = offsets[i];
+    sqe->user_data = i;
+    r->sq_array[idx] = idx;
+    iov += cnt;
+  }
+  __atomic_store_n(r->sq_tail, tail + n, __ATOMIC_RELEASE);
+
+  while( reaped < n ) {
+    rc = (int) syscall(__NR_io_uring_enter, r->fd, n - submitted, n - reaped,
+                       IORING_ENTER_GETEVENTS, NULL, 0);
+    if( rc < 0 ) {
+      int e = errno;
+      if( e != EINTR && e != EAGAIN && e != EBUSY &&
+          submitted == reaped ) {
+        // Nothing of ours is in flight, so nothing can still write
+        // into the caller's memory; give up on this ring.
+        qio_uring_teardown(r);
+        return e;
+      }
+      rc = 0;
+    }
+    submitted += rc;
+
+    head = *r->cq_head;
+    ctail = __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE);
+    while( head != ctail ) {
+      struct io_uring_cqe* cqe = &r->cqes[head & *r->cq_mask];
+      res[cqe->user_data] = cqe->res;
+      head++;
+      reaped++;
+    }
+    __atomic_store_n(r->cq_head, head, __ATOMIC_RELEASE);
+  }
+
+  return 0;
+}
+
+// Read or write the iovecs at consecutive offsets, keeping up to a
+// ring's worth in flight.  Like preadv/pwritev, the count covers only
+// the leading run of complete transfers, so a short or failed one ends
+// it and the caller retries from there.
+static
+qio_err_t qio_uring_rw(int writing, fd_t fd, const struct iovec* iov,
+                       int iovcnt, off_t offset, ssize_t* num_out)
+{
+  int32_t res[QIO_URING_DEPTH];
+  off_t offsets[QIO_URING_DEPTH];
+  qio_uring_t* r = qio_uring_get();
+  ssize_t total = 0;
+  ssize_t got;
+  qio_err_t err = 0;
+  int i, j, n;
+  off_t at;
+
+  for( i = 0; i < iovcnt; i += n ) {
+    n = iovcnt - i;
+
+    if( r == NULL || r->state <= 0 || n == 1 ) {
+      // No ring, or nothing to overlap; finish synchronously.
+      got = 0;
+      if( writing )
+        err = sys_pwritev(fd, &iov[i], n, offset + total, &got);
+      else
+        err = sys_preadv(fd, &iov[i], n, offset + total, &got);
+      if( err == EEOF ) err = 0;
+      total += got;
+      if( total > 0 ) err = 0;
+      break;
+    }
+
+    if( n > (int) r->entries ) n = r->entries;
+
+    at = offset + total;
+    for( j = 0; j < n; j++ ) {
+      offsets[j] = at;
+      at += iov[i + j].iov_len;
+    }
+
+    if( qio_uring_submit_wait(r, writing, fd, &iov[i], NULL, offsets, n,
+                              res) != 0 ) {
+      // The ring broke; redo this batch without it.
+      n = 0;
+      continue;
+    }
+
+    for( j = 0; j < n; j++ ) {
+      if( res[j] < 0 ) {
+        if( total == 0 ) err = -res[j];
+        break;
+      }
+      total += res[j];
+      if( (size_t) res[j] != iov[i + j].iov_len ) break;
+    }
+    if( j < n ) break;
+  }
+
+  if( !writing && err == 0 && total == 0 &&
+      sys_iov_total_bytes(iov, iovcnt) != 0 ) err = EEOF;
+
+  *num_out = total;
+  return err;
+}
+
+static int qio_uring_status = 0; // 0 unknown, 1 available, -1 not
+
+int qio_uring_available(void)
+{
+  if( qio_uring_status == 0 )
+    qio_uring_status = qio_uring_get() ? 1 : -1;
+  return qio_uring_status > 0;
+}
+
+#else
+
+int qio_uring_available(void)
+{
+  return 0;
+}
+
+#endif
+
+// preadv/pwritev on a given descriptor, optionally with io_uring.
+static
+qioerr qio_prwv_fd(int writing, int uring, fd_t fd, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int64_t seek_to_offset, ssize_t* num_out)
+{
+  ssize_t num = 0;
+  int64_t num_bytes = qbuffer_iter_num_bytes(start, end);
+  ssize_t num_parts = qbuffer_iter_num_parts(start, end);
+  struct iovec* iov = NULL;
+  size_t iovcnt;
+  MAYBE_STACK_SPACE(struct iovec, iov_onstack);
+  qioerr err;
+
+  if( num_bytes < 0 || num_parts < 0 || num_parts > INT_MAX ) {
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "range outside of buffer");
+  }
+
+  if( fd == -1 ) {
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "invalid file descriptor");
+  }
+
+  STARTING_SLOW_SYSCALL;
+
+  MAYBE_STACK_ALLOC(struct iovec, num_parts, iov, iov_onstack);
+  if( ! iov ) {
+    err = QIO_ENOMEM;
+    goto error;
+  }
+
+  err = qbuffer_to_iov(buf, start, end, num_parts, iov, NULL, &iovcnt);
+  if( err ) goto error;
+
+#ifdef QIO_HAS_URING
+  if( uring )
+    err = qio_int_to_err(qio_uring_rw(writing, fd, iov, iovcnt, seek_to_offset, &num));
+  else
+#endif
+  if( writing )
+    err = qio_int_to_err(sys_pwritev(fd, iov, iovcnt, seek_to_offset, &num));
+  else
+    err = qio_int_to_err(sys_preadv(fd, iov, iovcnt, seek_to_offset, &num));
+
+error:
+  MAYBE_STACK_FREE(iov, iov_onstack);
+
+  *num_out = num;
+
+  DONE_SLOW_SYSCALL;
+
+  return err;
+}
+
+qioerr qio_uring_preadv(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int64_t seek_to_offset, ssize_t* num_read)
+{
+  return qio_prwv_fd(0, 1, file->fd, buf, start, end, seek_to_offset, num_read);
+}
+
+qioerr qio_uring_pwritev(qio_file_t* file, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int64_t seek_to_offset, ssize_t* num_written)
+{
+  return qio_prwv_fd(1, 1, file->fd, buf, start, end, seek_to_offset, num_written);
+}
+
+#define QIO_DIRECT_FLOOR(x) ((x) & ~(int64_t) (QIO_DIRECT_ALIGN - 1))
+#define QIO_DIRECT_CEIL(x) QIO_DIRECT_FLOOR((x) + QIO_DIRECT_ALIGN - 1)
+
+static inline
+int _qio_channel_is_direct(qio_channel_t* ch)
+{
+  return (ch->hints & QIO_HINT_DIRECT) && ch->file && ch->file->direct_fd != -1;
+}
+
+// Read or write [start,end) of a QIO_HINT_DIRECT channel's buffer.  The
+// aligned middle goes through the O_DIRECT descriptor and an unaligned
+// head or tail through the regular one.  Like preadv/pwritev this may
+// do less than asked; the caller continues from where it stopped.
+static
+qioerr _qio_direct_prwv(qio_channel_t* ch, int writing, qbuffer_iter_t start, qbuffer_iter_t end, ssize_t* num_out)
+{
+  qio_file_t* file = ch->file;
+  int uring = (ch->hints & QIO_METHODMASK) == QIO_METHOD_URING;
+  int64_t lo = QIO_DIRECT_CEIL(start.offset);
+  int64_t hi = QIO_DIRECT_FLOOR(end.offset);
+  fd_t fd = file->fd;
+  qioerr err;
+
+  if( lo < hi ) {
+    if( start.offset < lo ) {
+      end = qbuffer_iter_at(&ch->buf, lo);
+    } else {
+      end = qbuffer_iter_at(&ch->buf, hi);
+      fd = file->direct_fd;
+    }
+  }
+
+  err = qio_prwv_fd(writing, uring, fd, &ch->buf, start, end, start.offset, num_out);
+  if( err && qio_err_to_int(err) == EINVAL && fd != file->fd ) {
+    // Some of the memory wasn't aligned to match after all (e.g. bytes
+    // put into the buffer by reference), so use the page cache for it.
+    err = qio_prwv_fd(writing, uring, file->fd, &ch->buf, start, end, start.offset, num_out);
+  }
+
+  return err;
+}
+
+// The descriptor for an unbuffered pread/pwrite: the O_DIRECT one if the
+// channel wants direct I/O and everything is aligned, else the usual one.
+static inline
+fd_t _qio_fd_for_transfer(qio_channel_t* ch, const void* ptr, int64_t offset, ssize_t len)
+{
+  if( _qio_channel_is_direct(ch) &&
+      (((intptr_t) ptr | offset | len) & (QIO_DIRECT_ALIGN - 1)) == 0 )
+    return ch->file->direct_fd;
+  return ch->file->fd;
+}
+
 qioerr qio_recv(fd_t sockfd, qbuffer_t* buf, qbuffer_iter_t start, qbuffer_iter_t end, int flags,
               sys_sockaddr_t* src_addr_out, /* can be NULL */
               void* ancillary_out, socklen_t* ancillary_len_inout, /* can be NULL */
@@ -521,6 +939,19 @@ error:
   return err;
 }
 
+static
+int use_uring_by_default(void)
+{
+  if( qio_uring_default < 0 ) {
+#ifndef CHPL_RT_UNIT_TEST
+    qio_uring_default = chpl_env_rt_get_bool("QIO_URING", false);
+#else
+    qio_uring_default = 0;
+#endif
+  }
+  return qio_uring_default && qio_uring_available();
+}
+
 static
 qio_hint_t choose_io_method(qio_file_t* file, qio_hint_t hints, qio_hint_t default_hints, int64_t file_size, int reading, int writing, int isfilestar)
 {
@@ -556,11 +987,13 @@ qio_hint_t choose_io_method(qio_file_t* file, qio_hint_t hints, qio_hint_t defau
                   (qbytes_iobuf_size & 4095) == 0);
           if (file->mmap != NULL)
             mmap_ok = true;
-          if (hints & QIO_HINT_NOREUSE)
+          if (hints & (QIO_HINT_NOREUSE|QIO_HINT_DIRECT))
             mmap_ok = false;
 
           if (mmap_ok)
             method = QIO_METHOD_MMAP;
+          else if (use_uring_by_default())
+            method = QIO_METHOD_URING;
           else
             method = QIO_METHOD_PREADPWRITE;
         } else {
@@ -570,6 +1003,22 @@ qio_hint_t choose_io_method(qio_file_t* file, qio_hint_t hints, qio_hint_t defau
     } else {
       // method already chosen in hints.
     }
+
+    // io_uring needs offsets and a kernel that has it; otherwise fall
+    // back to what we'd use without it.
+    if( method == QIO_METHOD_URING ) {
+      if( !(fdflags & QIO_FDFLAG_SEEKABLE) )
+        method = QIO_METHOD_READWRITE;
+      else if( !qio_uring_available() )
+        method = QIO_METHOD_PREADPWRITE;
+    }
+
+    // The compression stage does its own pread/pwrite calls, and the
+    // buffer can't be the file's data as it would be with mmap.
+    if( (file->compress_codec != QIO_COMPRESS_NONE ||
+         (ret & QIO_HINT_COMPRESS)) &&
+        (fdflags & QIO_FDFLAG_SEEKABLE) )
+      method = QIO_METHOD_PREADPWRITE;
   }
 
   // Always use fread/fwrite with FILE*
@@ -598,18 +1047,23 @@ qioerr qio_fadvise_for_hints(qio_file_t* file)
   qioerr err;
 
   if( file->hints & QIO_HINT_DIRECT ) {
-    int rc;
-    long arg;
-    // Set O_DIRECT on our fd.
-    err = qio_int_to_err(sys_fcntl(file->fd, F_GETFL, &rc));
-    if( err ) return err;
-
-    arg = rc;
-#ifdef O_DIRECT
-    arg |= O_DIRECT;
+    err = 0;
+#if defined(O_DIRECT) && defined(__linux__)
+    if( file->fd != -1 ) {
+      char path[64];
+      int rc;
+      // Reopen the file to get a second open file description, so that
+      // O_DIRECT only applies to what we send through direct_fd.  If the
+      // file system refuses O_DIRECT, everything uses the page cache.
+      err = qio_int_to_err(sys_fcntl(file->fd, F_GETFL, &rc));
+      if( err ) return err;
+      snprintf(path, sizeof(path), "/proc/self/fd/%i", (int) file->fd);
+      if( sys_open(path, (rc & O_ACCMODE) | O_DIRECT | QIO_OCLOEXEC, 0,
+                   &file->direct_fd) ) {
+        file->direct_fd = -1;
+      }
+    }
 #endif
-    err = qio_int_to_err(sys_fcntl_long(file->fd, F_SETFL, arg, &rc));
-    if( err ) return err;
   } else {
     err = 0;
 #if (_XOPEN_SOURCE >= 600 || _POSIX_C_SOURCE >= 200112L)
@@ -830,6 +1284,7 @@ qioerr qio_file_init(qio_file_t** file_out, FILE* fp, fd_t fd, qio_hint_t iohint
   DO_INIT_REFCNT(file);
   file->fp = fp;
   file->fd = fd;
+  file->direct_fd = -1;
   file->use_fp = usefilestar;
   file->buf = NULL;
   file->fdflags = fdflags;
@@ -837,6 +1292,16 @@ qioerr qio_file_init(qio_file_t** file_out, FILE* fp, fd_t fd, qio_hint_t iohint
   file->initial_length = initial_length;
   file->initial_pos = initial_pos;
   file->file_info = NULL; // Dont have anything so set it to NULL
+  file->plugin_fns = NULL;
+
+  // Notice files written by compressing channels.
+  file->compress_codec = QIO_COMPRESS_NONE;
+  if( seekable && ftype == S_IFREG && (fdflags & QIO_FDFLAG_READABLE) ) {
+    qio_compress_codec_t codec = QIO_COMPRESS_NONE;
+    err = qio_compress_detect(fd, initial_length, &codec);
+    if( err ) goto error;
+    file->compress_codec = codec;
+  }
 
   hinted_type = (qio_chtype_t) (iohints & QIO_METHODMASK);
 
@@ -869,12 +1334,21 @@ qioerr qio_file_init(qio_file_t** file_out, FILE* fp, fd_t fd, qio_hint_t iohint
   return 0;
 
 error:
+  if( file->direct_fd >= 0 ) sys_close(file->direct_fd);
   qio_free(file);
   *file_out = NULL;
   return err;
 }
 
 qioerr qio_file_init_plugin(qio_file_t** file_out, void* file_info, int fdflags, const qio_style_t* style)
+{
+  return qio_file_init_plugin_fns(file_out, file_info, &chpl_qio_plugin_fns,
+                                  fdflags, style);
+}
+
+qioerr qio_file_init_plugin_fns(qio_file_t** file_out, void* file_info,
+                                const qio_plugin_fns_t* fns, int fdflags,
+                                const qio_style_t* style)
 {
   off_t initial_pos = 0;
   int64_t initial_length = 0;
@@ -889,7 +1363,7 @@ qioerr qio_file_init_plugin(qio_file_t** file_out, void* file_info, int fdflags,
   }
 
   if (seekable) {
-    err = chpl_qio_filelength(file_info, &initial_length);
+    err = fns->filelength(file_info, &initial_length);
     // Disregard errors in case it is not seekable (and if we need seek to get the
     // length). If we can't get the length, we'll set initial_pos below anyways.
     if (err) initial_length = 0;
@@ -913,6 +1387,7 @@ qioerr qio_file_init_plugin(qio_file_t** file_out, void* file_info, int fdflags,
   DO_INIT_REFCNT(file);
   file->fp = NULL;
   file->fd = -1;
+  file->direct_fd = -1;
   file->use_fp = 0;
   file->buf = NULL;
   file->fdflags = (qio_fdflag_t) fdflags;
@@ -920,6 +1395,7 @@ qioerr qio_file_init_plugin(qio_file_t** file_out, void* file_info, int fdflags,
   file->initial_length = initial_length;
   file->initial_pos = initial_pos;
   file->file_info  = file_info;
+  file->plugin_fns = fns;
 
   file->hints = choose_io_method(file, iohints, 0, initial_length,
                                  (fdflags & QIO_FDFLAG_READABLE) > 0,
@@ -986,7 +1462,7 @@ qioerr _qio_file_do_close(qio_file_t* f)
 
   if (f->file_info) {
     if (f->hints & QIO_HINT_OWNED)  // Should always be true
-      err = chpl_qio_file_close(f->file_info);
+      err = f->plugin_fns->file_close(f->file_info);
     f->hints &= ~QIO_HINT_OWNED;
   }
 
@@ -1007,6 +1483,13 @@ qioerr _qio_file_do_close(qio_file_t* f)
     f->fd = -1;
   }
 
+  if( f->direct_fd >= 0 ) {
+    // We opened this one ourselves, so always close it.
+    newerr = qio_int_to_err(sys_close(f->direct_fd));
+    if( !err ) err = newerr;
+    f->direct_fd = -1;
+  }
+
   f->closed = true;
 
   qio_unlock(& f->lock);
@@ -1033,7 +1516,7 @@ qioerr qio_file_sync(qio_file_t* f)
   } else if( f->fd >= 0 ) {
     err = qio_int_to_err(sys_fsync(f->fd));
   } else if( f->file_info ) {
-    err = chpl_qio_fsync(f->file_info);
+    err = f->plugin_fns->fsync(f->file_info);
   }
 
   return err;
@@ -1193,6 +1676,7 @@ qioerr qio_file_open_mem_ext(qio_file_t** file_out, qbuffer_t* buf, qio_fdflag_t
   DO_INIT_REFCNT(file); // initialized to 1.
   file->fp = NULL;
   file->fd = -1;
+  file->direct_fd = -1;
   file->fdflags = fdflags;
   file->closed = false;
   file->hints = choose_io_method(file, iohints, 0, qbuffer_len(file->buf),
@@ -1309,7 +1793,7 @@ qioerr qio_file_path(qio_file_t* f, const char** string_out)
   if (f->fd != -1)
     return qio_file_path_for_fd(f->fd, string_out);
   else if (f->file_info != NULL)
-    return chpl_qio_getpath(f->file_info, (uint8_t**) string_out, &len);
+    return f->plugin_fns->getpath(f->file_info, (uint8_t**) string_out, &len);
   else
     QIO_RETURN_CONSTANT_ERROR(ENOSYS, "no fd or plugin");
 }
@@ -1332,7 +1816,7 @@ qioerr qio_file_length(qio_file_t* f, int64_t *len_out)
     err = qio_int_to_err(sys_fstat(f->fd, &stats));
     *len_out = stats.st_size;
   } else if (f->file_info) {
-    err = chpl_qio_filelength(f->file_info, len_out);
+    err = f->plugin_fns->filelength(f->file_info, len_out);
   } else {
     QIO_RETURN_CONSTANT_ERROR(ENOSYS, "no fd or plugin");
   }
@@ -1402,10 +1886,32 @@ qioerr _qio_channel_init_file_internal(qio_channel_t* ch, qio_file_t* file, qio_
   ch->start_pos = start;
   ch->end_pos = end;
 
+  // Set up the compression stage, if necessary
+  if( file->file_info == NULL && writeable && (use_hints & QIO_HINT_COMPRESS) ) {
+    qio_compress_codec_t codec = qio_compress_default_codec();
+    if( readable )
+      QIO_RETURN_CONSTANT_ERROR(EINVAL, "compressing channels cannot read");
+    if( !(file->fdflags & QIO_FDFLAG_SEEKABLE) )
+      QIO_RETURN_CONSTANT_ERROR(EINVAL, "compressing channels need a seekable file");
+    if( start + file->initial_pos != 0 )
+      QIO_RETURN_CONSTANT_ERROR(EINVAL, "compressing channels must start at the beginning of the file");
+    if( codec == QIO_COMPRESS_NONE )
+      QIO_RETURN_CONSTANT_ERROR(ENOSYS, "no compression codec available");
+    err = qio_compress_create(&ch->compress, codec, 1);
+    if( err ) return err;
+    file->compress_codec = codec;
+  } else if( file->file_info == NULL && readable &&
+             file->compress_codec != QIO_COMPRESS_NONE ) {
+    err = qio_compress_create(&ch->compress,
+                              (qio_compress_codec_t) file->compress_codec, 0);
+    if( err ) return err;
+  }
+
   // Setup any plugin channel, if necessary
   if (file->file_info != NULL) {
     void* chan_info = NULL;
-    err = chpl_qio_setup_plugin_channel(file->file_info, &chan_info, start, end, ch);
+    err = file->plugin_fns->setup_plugin_channel(file->file_info, &chan_info,
+                                                 start, end, ch);
     if (err) return err;
     ch->chan_info = chan_info;
   }
@@ -1565,6 +2071,25 @@ qioerr _qio_channel_init_file(qio_channel_t* ch, qio_file_t* file, qio_hint_t hi
   } else {
     ch->bufIoMax = 64 * 1024; // use a reasonable default
   }
+
+  ch->flush_align = 0;
+#ifdef SYS_HAS_LLAPI
+  if( (ch->hints & QIO_HINT_STRIPE_ALIGN) && writeable && !file->file_info &&
+      ((ch->hints & QIO_METHODMASK) == QIO_METHOD_PREADPWRITE ||
+       (ch->hints & QIO_METHODMASK) == QIO_METHOD_URING) ) {
+    int ftype = 0;
+    if( qio_get_fs_type(file, &ftype) == 0 && ftype == FTYPE_LUSTRE ) {
+      int64_t stripe_size = 0;
+      if( sys_lustre_get_stripe_size(file->fd, &stripe_size) == 0 &&
+          stripe_size > 0 ) {
+        ch->flush_align = stripe_size;
+      }
+    }
+  }
+#endif
+  // Compress whole batches of blocks at a time.
+  if( ch->compress && writeable )
+    ch->flush_align = qio_compress_batch_size(ch->compress);
   //_qio_buffered_setup_cached(ch);
 
   return 0;
@@ -1827,7 +2352,10 @@ qioerr _qio_channel_final_flush_unlocked(qio_channel_t* ch)
 
   // Close plugin structure if any
   if (ch->chan_info != NULL)
-    chpl_qio_channel_close(ch->chan_info);
+    ch->file->plugin_fns->channel_close(ch->chan_info);
+
+  qio_compress_destroy(ch->compress);
+  ch->compress = NULL;
 
   if( !destroyed_buffer && qbuffer_is_initialized(&ch->buf) ) {
     // Destroy the buffer.
@@ -1948,16 +2476,26 @@ qioerr _buffered_allocate_bufferspace(qio_channel_t* ch, int64_t amt, int64_t ma
   int64_t left = amt;
   int64_t max_left = max_amt;
   int64_t uselen;
+  int64_t skip;
+  int direct = _qio_channel_is_direct(ch);
   qbytes_t* tmp;
   qioerr err;
 
   // allocate some space!
   while( left > 0 ) {
-    err = qbytes_create_iobuf(&tmp);
+    skip = 0;
+    if( direct ) {
+      err = qbytes_create_direct_iobuf(&tmp);
+      // Start as far into the aligned buffer as the file offset is into
+      // its block, so memory and file offsets are aligned alike.
+      skip = qbuffer_end_offset(&ch->buf) & (QIO_DIRECT_ALIGN - 1);
+    } else {
+      err = qbytes_create_iobuf(&tmp);
+    }
     if( err ) goto error;
-    uselen = tmp->len;
+    uselen = tmp->len - skip;
     if( uselen > max_left ) uselen = max_left;
-    err = qbuffer_append(&ch->buf, tmp, 0, uselen);
+    err = qbuffer_append(&ch->buf, tmp, skip, uselen);
     // qbuffer_append retains tmp, so we can release our local reference.
     // If there was an error, then it is not retained anywhere, so it is
     // reclaimed here.
@@ -2245,6 +2783,7 @@ qioerr _buffered_read_atleast(qio_channel_t* ch, int64_t amt)
   ssize_t num_read;
   int64_t left = amt;
   int64_t max_amt;
+  int64_t need;
   int return_eof = 0;
   qioerr err;
   qio_method_t method = (qio_method_t) (ch->hints & QIO_METHODMASK);
@@ -2265,7 +2804,16 @@ qioerr _buffered_read_atleast(qio_channel_t* ch, int64_t amt)
   }
 
   if (ch->chan_info) {
-    return chpl_qio_read_atleast(ch->chan_info, amt);
+    return ch->file->plugin_fns->read_atleast(ch->chan_info, amt);
+  }
+
+  // With io_uring, read ahead so that several iobufs are being filled
+  // at once.  Running out of file in the read-ahead part isn't EOF.
+  need = amt;
+  if( method == QIO_METHOD_URING ) {
+    int64_t ra = qio_uring_readahead_iobufs * (int64_t) qbytes_iobuf_size;
+    if( ra > max_amt ) ra = max_amt;
+    if( amt < ra ) amt = ra;
   }
 
   //printf("Allocating bufferspace %lli\n", (long long int) amt);
@@ -2284,12 +2832,24 @@ qioerr _buffered_read_atleast(qio_channel_t* ch, int64_t amt)
 
     QIO_GET_CONSTANT_ERROR(err, EINVAL, "read method not implemented");
     num_read = 0;
-    switch (method) {
+    if( ch->compress ) {
+      err = qio_compress_read(ch->compress, ch->file->fd, &ch->buf,
+                              read_start, read_end, &num_read);
+    } else switch (method) {
       case QIO_METHOD_READWRITE:
         err = qio_readv(ch->file, &ch->buf, read_start, read_end, &num_read);
         break;
       case QIO_METHOD_PREADPWRITE:
-        err = qio_preadv(ch->file, &ch->buf, read_start, read_end, read_start.offset, &num_read);
+        if( _qio_channel_is_direct(ch) )
+          err = _qio_direct_prwv(ch, 0, read_start, read_end, &num_read);
+        else
+          err = qio_preadv(ch->file, &ch->buf, read_start, read_end, read_start.offset, &num_read);
+        break;
+      case QIO_METHOD_URING:
+        if( _qio_channel_is_direct(ch) )
+          err = _qio_direct_prwv(ch, 0, read_start, read_end, &num_read);
+        else
+          err = qio_uring_preadv(ch->file, &ch->buf, read_start, read_end, read_start.offset, &num_read);
         break;
       case QIO_METHOD_FREADFWRITE:
         err = qio_freadv(ch->file->fp, &ch->buf, read_start, read_end, &num_read);
@@ -2313,6 +2873,8 @@ qioerr _buffered_read_atleast(qio_channel_t* ch, int64_t amt)
 
   ch->av_end = read_start.offset;
 
+  if( err && qio_err_to_int(err) == EEOF && amt - left >= need ) err = 0;
+
   if( err ) return err;
 
   if( return_eof ) return QIO_EEOF;
@@ -2673,7 +3235,13 @@ qioerr _qio_buffered_behind(qio_channel_t* ch, int flushall)
   write_start = qbuffer_begin(&ch->buf); // buffer start offset iter
   write_end = _av_start_iter(ch); // buffer iterator to av_start
 
-  if( !flushall && !qbuffer_iter_at_part_end(&ch->buf, &write_end)) {
+  if( !flushall && ch->flush_align > 0 ) {
+    // Only write whole stripes; move write_end back to the last
+    // stripe boundary.
+    int64_t aligned = write_end.offset - write_end.offset % ch->flush_align;
+    if( aligned <= write_start.offset ) write_end = write_start;
+    else write_end = qbuffer_iter_at(&ch->buf, aligned);
+  } else if( !flushall && !qbuffer_iter_at_part_end(&ch->buf, &write_end)) {
     // Move write_end back to the start of the chunk
     // we're working on.
     qbuffer_iter_floor_part(&ch->buf, &write_end);
@@ -2692,15 +3260,16 @@ qioerr _qio_buffered_behind(qio_channel_t* ch, int flushall)
   //debug_print_qbuffer(&ch->buf);
 
   if (ch->chan_info && (ch->flags & QIO_FDFLAG_WRITEABLE)) {
-    return chpl_qio_write(ch->chan_info, nbytes);
-  }
-
-  if(ch->hints & QIO_HINT_DIRECT) {
-    // Round out the data to write to the end of the current chunk.
-    qbuffer_iter_ceil_part(&ch->buf, &write_end);
+    return ch->file->plugin_fns->write(ch->chan_info, nbytes);
   }
 
-  if(ch->flags & QIO_FDFLAG_WRITEABLE) {
+  if( ch->compress && (ch->flags & QIO_FDFLAG_WRITEABLE) ) {
+    num_written = 0;
+    err = qio_compress_write(ch->compress, ch->file->fd, &ch->buf,
+                             write_start, write_end, &num_written);
+    qbuffer_iter_advance(&ch->buf, &write_start, num_written);
+    if( err ) goto error;
+  } else if(ch->flags & QIO_FDFLAG_WRITEABLE) {
     while( qbuffer_iter_num_bytes(write_start, write_end) > 0 ) {
       QIO_GET_CONSTANT_ERROR(err, EINVAL, "write method not implemented");
       num_written = 0;
@@ -2709,7 +3278,16 @@ qioerr _qio_buffered_behind(qio_channel_t* ch, int flushall)
           err = qio_writev(ch->file, &ch->buf, write_start, write_end, &num_written);
           break;
         case QIO_METHOD_PREADPWRITE:
-          err = qio_pwritev(ch->file, &ch->buf, write_start, write_end, write_start.offset, &num_written);
+          if( _qio_channel_is_direct(ch) )
+            err = _qio_direct_prwv(ch, 1, write_start, write_end, &num_written);
+          else
+            err = qio_pwritev(ch->file, &ch->buf, write_start, write_end, write_start.offset, &num_written);
+          break;
+        case QIO_METHOD_URING:
+          if( _qio_channel_is_direct(ch) )
+            err = _qio_direct_prwv(ch, 1, write_start, write_end, &num_written);
+          else
+            err = qio_uring_pwritev(ch->file, &ch->buf, write_start, write_end, write_start.offset, &num_written);
           break;
         case QIO_METHOD_FREADFWRITE:
           err = qio_fwritev(ch->file->fp, &ch->buf, write_start, write_end, &num_written);
@@ -2825,8 +3403,14 @@ qioerr _qio_buffered_read(qio_channel_t* ch, void* ptr, ssize_t len, ssize_t* am
     method != QIO_METHOD_MMAP &&             // we aren't using mmap
     method != QIO_METHOD_MEMORY &&           // we aren't using mem
     ch->mark_cur == 0 &&                     // not waiting for a commit/revert
-    ch->chan_info == NULL                    // there is no IO plugin
+    ch->chan_info == NULL &&                 // there is no IO plugin
+    ch->compress == NULL                     // the file isn't compressed
   ) {
+    // The buffer gives the channel position below, so make sure it
+    // exists (it doesn't yet if this is the first read).
+    err = _qio_channel_needbuffer_unlocked(ch);
+    if( err ) return err;
+
     // copy out what remains in the buffer before making a system call
     gotlen = qio_ptr_diff(ch->cached_end, ch->cached_cur);
 
@@ -2866,7 +3450,10 @@ qioerr _qio_buffered_read(qio_channel_t* ch, void* ptr, ssize_t len, ssize_t* am
                                &num_read));
           break;
         case QIO_METHOD_PREADPWRITE:
-          err = qio_int_to_err(sys_pread(ch->file->fd, ptr, remaining,
+        case QIO_METHOD_URING:
+          err = qio_int_to_err(sys_pread(_qio_fd_for_transfer(ch, ptr,
+                               _right_mark_start(ch), remaining),
+                               ptr, remaining,
                                _right_mark_start(ch), &num_read));
           break;
         case QIO_METHOD_FREADFWRITE:
@@ -3004,7 +3591,8 @@ qioerr _qio_buffered_write(qio_channel_t* ch, const void* ptr, ssize_t len, ssiz
     method != QIO_METHOD_MMAP &&             // we aren't using mmap
     method != QIO_METHOD_MEMORY &&           // we aren't using mem
     ch->mark_cur == 0 &&                     // not waiting for a commit/revert
-    ch->chan_info == NULL                    // there is no IO plugin
+    ch->chan_info == NULL &&                 // there is no IO plugin
+    ch->flush_align == 0                     // not keeping writes to stripes
   ) {
     // flush the write-behind portion of the buffer before attempting to write more
     err = _qio_channel_flush_qio_unlocked(ch);
@@ -3018,7 +3606,8 @@ qioerr _qio_buffered_write(qio_channel_t* ch, const void* ptr, ssize_t len, ssiz
           err = qio_int_to_err(sys_write(ch->file->fd, ptr, remaining, &num_written));
           break;
         case QIO_METHOD_PREADPWRITE:
-          err = qio_int_to_err(sys_pwrite(ch->file->fd, ptr, remaining, _right_mark_start(ch), &num_written));
+        case QIO_METHOD_URING:
+          err = qio_int_to_err(sys_pwrite(_qio_fd_for_transfer(ch, ptr, _right_mark_start(ch), remaining), ptr, remaining, _right_mark_start(ch), &num_written));
           break;
         case QIO_METHOD_FREADFWRITE:
           if( ch->file->fp ) {
@@ -3142,7 +3731,8 @@ qioerr _qio_unbuffered_write(qio_channel_t* ch, const void* ptr, ssize_t len_in,
         case QIO_METHOD_MMAP: // mmap uses pread/pwrite when we're
                               // outside the mmap'd region.
         case QIO_METHOD_PREADPWRITE:
-          err = qio_int_to_err(sys_pwrite(ch->file->fd, ptr, len, _right_mark_start(ch), &num_written));
+        case QIO_METHOD_URING:
+          err = qio_int_to_err(sys_pwrite(_qio_fd_for_transfer(ch, ptr, _right_mark_start(ch), len), ptr, len, _right_mark_start(ch), &num_written));
           break;
         case QIO_METHOD_FREADFWRITE:
           if( ch->file->fp ) {
@@ -3220,7 +3810,8 @@ qioerr _qio_unbuffered_read(qio_channel_t* ch, void* ptr, ssize_t len_in, ssize_
   len = len_in;
 
   if( ch->file->mmap &&
-      (method == QIO_METHOD_PREADPWRITE || method == QIO_METHOD_MMAP) &&
+      (method == QIO_METHOD_PREADPWRITE || method == QIO_METHOD_MMAP ||
+       method == QIO_METHOD_URING) &&
       _right_mark_start(ch) + len <= ch->file->mmap->len) {
     // As long as we're using an I/O method that seeks on every read,
     // copy the data out of the mmap.
@@ -3236,7 +3827,8 @@ qioerr _qio_unbuffered_read(qio_channel_t* ch, void* ptr, ssize_t len_in, ssize_
           break;
         case QIO_METHOD_MMAP:
         case QIO_METHOD_PREADPWRITE:
-          err = qio_int_to_err(sys_pread(ch->file->fd, ptr, len, _right_mark_start(ch), &num_read));
+        case QIO_METHOD_URING:
+          err = qio_int_to_err(sys_pread(_qio_fd_for_transfer(ch, ptr, _right_mark_start(ch), len), ptr, len, _right_mark_start(ch), &num_read));
           break;
         case QIO_METHOD_FREADFWRITE:
           if( ch->file->fp ) {
@@ -4127,6 +4719,53 @@ qioerr qio_channel_advance(const int threadsafe, qio_channel_t* ch, int64_t nbyt
   return err;
 }
 
+// Empty the buffer of a channel with no marks and start it over at
+// start, as though it had just been created for [start, end).
+// The caller must have called _qio_buffered_advance_cached.
+static
+qioerr _qio_channel_reposition_unlocked(qio_channel_t* ch,
+                                        int64_t start, int64_t end)
+{
+  qioerr err;
+
+  // Zero the available region
+  if (ch->flags & QIO_FDFLAG_READABLE)
+    _set_right_mark_start(ch, ch->av_end);
+  else
+    ch->av_end = ch->mark_stack[0];
+
+  _qio_buffered_behind(ch, /* flush everything */ true);
+
+  // Make sure the buffer is empty - since we ran buffered_behind,
+  // we can just discard any allocated memory.
+  int64_t trim_bytes = qbuffer_end_offset(&ch->buf) -
+                       qbuffer_start_offset(&ch->buf);
+
+  qbuffer_trim_back(&ch->buf, trim_bytes);
+
+  assert(qbuffer_start_offset(&ch->buf) == qbuffer_end_offset(&ch->buf));
+
+  // Set the new start_pos
+  qbuffer_reposition(&ch->buf, start);
+  ch->start_pos = start;
+  ch->end_pos = end;
+
+  // Update av_start and av_end
+  _set_right_mark_start(ch, start);
+  ch->av_end = start;
+
+  // update the file with start_pos.
+  err = qio_lock(&ch->file->lock);
+  if (err) return err;
+  if( ch->start_pos > ch->file->max_initial_position ) {
+    ch->file->max_initial_position = ch->start_pos;
+  }
+  qio_unlock(&ch->file->lock);
+
+  // Use file->mmap if possible
+  return _qio_channel_setup_file_mmap(ch);
+}
+
 qioerr qio_channel_seek(qio_channel_t* ch, int64_t start, int64_t end)
 {
   qioerr err;
@@ -4145,6 +4784,9 @@ qioerr qio_channel_seek(qio_channel_t* ch, int64_t start, int64_t end)
   if (ch->mark_cur != 0)
     QIO_RETURN_CONSTANT_ERROR(EINVAL, "reset not supported for marked channel");
 
+  if (ch->compress != NULL && (ch->flags & QIO_FDFLAG_WRITEABLE))
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "seek not supported for compressing channel");
+
   int writing = 0;
   if (ch->flags & QIO_FDFLAG_READABLE)
     writing = 0;
@@ -4177,44 +4819,8 @@ qioerr qio_channel_seek(qio_channel_t* ch, int64_t start, int64_t end)
   }
 
   if (do_setstart == false) {
-    // Zero the available region
-    if (writing)
-      ch->av_end = old_av_start;
-    else
-      _set_right_mark_start(ch, old_av_end);
-
-    _qio_buffered_behind(ch, /* flush everything */ true);
-
-    // Make sure the buffer is empty - since we ran buffered_behind,
-    // we can just discard any allocated memory.
-    int64_t trim_bytes = qbuffer_end_offset(&ch->buf) -
-                         qbuffer_start_offset(&ch->buf);
-
-    qbuffer_trim_back(&ch->buf, trim_bytes);
-
-    assert(qbuffer_start_offset(&ch->buf) == qbuffer_end_offset(&ch->buf));
-
-    // Set the new start_pos
-    qbuffer_reposition(&ch->buf, start);
-    ch->start_pos = start;
-    ch->end_pos = end;
-
-    // Update av_start and av_end
-    _set_right_mark_start(ch, start);
-    ch->av_end = start;
-
-    // update the file with start_pos.
-    err = qio_lock(&ch->file->lock);
+    err = _qio_channel_reposition_unlocked(ch, start, end);
     if (err) return err;
-    if( ch->start_pos > ch->file->max_initial_position ) {
-      ch->file->max_initial_position = ch->start_pos;
-    }
-    qio_unlock(&ch->file->lock);
-
-    // Use file->mmap if possible
-    err = _qio_channel_setup_file_mmap(ch);
-    if (err) return err;
-
   } else {
     // Just change the buffer start.
 
@@ -4233,6 +4839,290 @@ qioerr qio_channel_seek(qio_channel_t* ch, int64_t start, int64_t end)
 }
 
 
+// Can the channel's data go straight to or from its file descriptor?
+static
+int _qio_channel_can_transfer_fd(qio_channel_t* ch)
+{
+  qio_method_t method = (qio_method_t) (ch->hints & QIO_METHODMASK);
+
+  if( ch->file == NULL || ch->file->fd < 0 || ch->file->fp != NULL ||
+      ch->file->file_info != NULL || ch->chan_info != NULL ) return 0;
+  if( ch->compress != NULL || ch->mark_cur != 0 ) return 0;
+  if( ! _use_buffered(ch, 0) || ! qbuffer_is_initialized(&ch->buf) ) return 0;
+
+  return method == QIO_METHOD_READWRITE ||
+         method == QIO_METHOD_PREADPWRITE ||
+         method == QIO_METHOD_URING;
+}
+
+#ifdef __linux__
+static
+int _qio_fd_kind(fd_t fd)
+{
+  struct stat st;
+  if( fstat(fd, &st) != 0 ) return 0;
+  return st.st_mode & S_IFMT;
+}
+#endif
+
+// Move up to len bytes from one descriptor to another in the kernel,
+// with copy_file_range, sendfile or splice depending on what the two
+// are. A NULL offset means to use (and advance) the descriptor's own
+// position. Sets *moved_out to the bytes moved; stopping short of len
+// means EOF on from, or that the kernel can't do the rest (in which
+// case *unsupported is set and the caller should copy the rest itself).
+static
+qioerr _qio_fd_transfer(fd_t from, int64_t* from_off,
+                        fd_t to, int64_t* to_off,
+                        int64_t len, int64_t* moved_out, int* unsupported)
+{
+  int64_t moved = 0;
+
+  *moved_out = 0;
+  *unsupported = 1;
+
+#ifdef __linux__
+  {
+    const int64_t chunk = 64*1024*1024;
+    int from_kind = _qio_fd_kind(from);
+    int to_kind = _qio_fd_kind(to);
+    enum { USE_NONE, USE_COPY_FILE_RANGE, USE_SENDFILE, USE_SPLICE } how;
+
+    if( from_kind == S_IFIFO || to_kind == S_IFIFO ) {
+      how = USE_SPLICE;
+#ifdef __NR_copy_file_range
+    } else if( from_kind == S_IFREG && to_kind == S_IFREG ) {
+      how = USE_COPY_FILE_RANGE;
+#endif
+    } else if( from_kind == S_IFREG && to_off == NULL ) {
+      // sendfile always writes at the destination's own position.
+      how = USE_SENDFILE;
+    } else {
+      how = USE_NONE;
+    }
+
+    if( how == USE_NONE ) return 0;
+
+    *unsupported = 0;
+    while( moved < len ) {
+      int64_t want = len - moved;
+      loff_t in = from_off ? *from_off : 0;
+      loff_t out = to_off ? *to_off : 0;
+      ssize_t got;
+
+      if( want > chunk ) want = chunk;
+
+      if( how == USE_SPLICE ) {
+        got = splice(from, (from_off && from_kind != S_IFIFO) ? &in : NULL,
+                     to, (to_off && to_kind != S_IFIFO) ? &out : NULL,
+                     want, SPLICE_F_MOVE);
+      } else if( how == USE_SENDFILE ) {
+        off_t in_off = in;
+        got = sendfile(to, from, from_off ? &in_off : NULL, want);
+        in = in_off;
+#ifdef __NR_copy_file_range
+      } else {
+        got = syscall(__NR_copy_file_range, from, from_off ? &in : NULL,
+                      to, to_off ? &out : NULL, want, 0);
+#endif
+      }
+
+      if( got < 0 ) {
+        int e = errno;
+        if( e == EINTR ) continue;
+        if( e == EINVAL || e == ENOSYS || e == EXDEV || e == EOPNOTSUPP ||
+            e == EAGAIN || e == EBADF ) {
+          // e.g. a file system or descriptor the kernel can't do this
+          // for, or a non-blocking pipe that isn't ready.
+          *unsupported = 1;
+          break;
+        }
+        *moved_out = moved;
+        return qio_int_to_err(e);
+      }
+      if( got == 0 ) break; // EOF
+
+      if( from_off ) *from_off += got;
+      if( to_off ) *to_off += got;
+      moved += got;
+    }
+  }
+#else
+  (void) from; (void) from_off; (void) to; (void) to_off; (void) len;
+#endif
+
+  *moved_out = moved;
+  return 0;
+}
+
+// Copy up to len bytes through buf, stopping early at EOF on src.
+static
+qioerr _qio_channel_copy_buffered(qio_channel_t* dst, qio_channel_t* src,
+                                  int64_t len, char* buf, ssize_t bufsz,
+                                  int64_t* moved_out)
+{
+  qioerr err = 0;
+  int64_t moved = 0;
+
+  while( moved < len ) {
+    ssize_t want = bufsz;
+    ssize_t got = 0;
+    qioerr werr;
+
+    if( want > len - moved ) want = len - moved;
+    err = qio_channel_read(false, src, buf, want, &got);
+    if( got > 0 ) {
+      werr = qio_channel_write_amt(false, dst, buf, got);
+      if( werr ) {
+        err = werr;
+        break;
+      }
+      moved += got;
+    }
+    if( err ) break;
+  }
+
+  *moved_out = moved;
+  return err;
+}
+
+qioerr qio_channel_transfer(const int threadsafe, qio_channel_t* dst,
+                            qio_channel_t* src, int64_t len,
+                            int64_t* amt_out)
+{
+  qioerr err = 0;
+  int64_t moved = 0;
+  int64_t n = 0;
+  char* buf = NULL;
+  ssize_t bufsz = qbytes_iobuf_size;
+
+  *amt_out = 0;
+
+  if( src == dst ||
+      ! (src->flags & QIO_FDFLAG_READABLE) ||
+      ! (dst->flags & QIO_FDFLAG_WRITEABLE) )
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "transfer needs a reading and a writing channel");
+
+  if( len < 0 ) len = INT64_MAX;
+
+  if( threadsafe ) {
+    // Take the locks in address order, so that transfers going opposite
+    // ways between the same two channels can't deadlock.
+    qio_channel_t* first = (src < dst) ? src : dst;
+    qio_channel_t* second = (src < dst) ? dst : src;
+    err = qio_lock(&first->lock);
+    if( err ) return err;
+    err = qio_lock(&second->lock);
+    if( err ) {
+      qio_unlock(&first->lock);
+      return err;
+    }
+  }
+
+  // Make sure both channels have their buffers, so that we know
+  // where they are.
+  if( _use_buffered(src, 0) ) err = _qio_channel_needbuffer_unlocked(src);
+  if( !err && _use_buffered(dst, 0) ) err = _qio_channel_needbuffer_unlocked(dst);
+  if( err ) goto done;
+
+  buf = (char*) qio_malloc(bufsz);
+  if( ! buf ) {
+    err = QIO_ENOMEM;
+    goto done;
+  }
+
+  if( _qio_channel_can_transfer_fd(src) && _qio_channel_can_transfer_fd(dst) ) {
+    int src_stream = (src->hints & QIO_METHODMASK) == QIO_METHOD_READWRITE;
+    int dst_stream = (dst->hints & QIO_METHODMASK) == QIO_METHOD_READWRITE;
+    int unsupported = 0;
+    int64_t src_pos, dst_pos, want;
+
+    src->bit_buffer = 0;
+    src->bit_buffer_bits = 0;
+    _qio_buffered_advance_cached(src);
+
+    // Data a stream has already read can't be read again from the
+    // descriptor, so pass it on first. Positional sources just drop
+    // their buffer below.
+    while( src_stream && moved < len &&
+           src->av_end > _right_mark_start(src) ) {
+      qbuffer_iter_t start = _right_mark_start_iter(src);
+      qbuffer_iter_t end = _av_end_iter(src);
+      qbytes_t* bytes;
+      int64_t skip;
+      int64_t part;
+
+      qbuffer_iter_get(start, end, &bytes, &skip, &part);
+      if( part > src->av_end - start.offset )
+        part = src->av_end - start.offset;
+      if( part > len - moved ) part = len - moved;
+      err = qio_channel_write_amt(false, dst,
+                                  qio_ptr_add(bytes->data, skip), part);
+      if( err ) goto done;
+      _add_right_mark_start(src, part);
+      moved += part;
+    }
+
+    err = _qio_channel_flush_unlocked(dst);
+    if( err ) goto done;
+
+    src_pos = qio_channel_offset_unlocked(src);
+    dst_pos = qio_channel_offset_unlocked(dst);
+    want = len - moved;
+    if( want > src->end_pos - src_pos ) want = src->end_pos - src_pos;
+    if( want > dst->end_pos - dst_pos ) want = dst->end_pos - dst_pos;
+
+    if( want > 0 ) {
+      int64_t from_off = src_pos;
+      int64_t to_off = dst_pos;
+
+      err = _qio_fd_transfer(src->file->fd, src_stream ? NULL : &from_off,
+                             dst->file->fd, dst_stream ? NULL : &to_off,
+                             want, &n, &unsupported);
+      if( n > 0 || ! src_stream ) {
+        // Start both channels over after what the kernel moved.
+        qioerr rerr;
+        rerr = _qio_channel_reposition_unlocked(src, src_pos + n,
+                                                src->end_pos);
+        if( !err ) err = rerr;
+        _qio_buffered_advance_cached(dst);
+        rerr = _qio_channel_reposition_unlocked(dst, dst_pos + n,
+                                                dst->end_pos);
+        if( !err ) err = rerr;
+      }
+      moved += n;
+      if( err ) goto done;
+      if( ! unsupported && n < want ) goto done; // EOF on the source
+    }
+  }
+
+  // Anything left goes through the channel buffers.
+  if( moved < len ) {
+    err = _qio_channel_copy_buffered(dst, src, len - moved, buf, bufsz, &n);
+    moved += n;
+  }
+
+done:
+  qio_free(buf);
+
+  // Running out of data is fine when asked to go to EOF.
+  if( qio_err_to_int(err) == EEOF && len == INT64_MAX ) err = 0;
+  else if( !err && moved < len && len != INT64_MAX )
+    QIO_GET_CONSTANT_ERROR(err, EEOF, "transfer reached EOF");
+
+  _qio_channel_set_error_unlocked(src, err);
+  if( qio_err_to_int(err) != EEOF ) _qio_channel_set_error_unlocked(dst, err);
+
+  if( threadsafe ) {
+    qio_unlock(&dst->lock);
+    qio_unlock(&src->lock);
+  }
+
+  *amt_out = moved;
+  return err;
+}
+
+
 /* Handle I/O of bits at a time */
 void _qio_channel_write_bits_cached_realign(qio_channel_t* restrict ch, uint64_t v, int8_t nbits)
 {
@@ -4684,7 +5574,7 @@ qioerr qio_get_chunk(qio_file_t* fl, int64_t* len_out)
   sys_statfs_t s;
 
   if (fl->file_info) {
-    err = chpl_qio_get_chunk(fl->file_info, len_out);
+    err = fl->plugin_fns->get_chunk(fl->file_info, len_out);
   } else {
     fd = fl->fd;
     if (fl->fp) fd = fileno(fl->fp);
@@ -4717,7 +5607,8 @@ qioerr qio_locales_for_region(qio_file_t* fl, off_t start, off_t end, const char
   qioerr err = 0;
   if (fl->file_info) {
     void* tmp = NULL;
-    err = chpl_qio_get_locales_for_region(fl->file_info, start, end, &tmp, num_locs_out);
+    err = fl->plugin_fns->get_locales_for_region(fl->file_info, start, end,
+                                                 &tmp, num_locs_out);
     *loc_names_out = (const char**) tmp;
     return err;
   } else {
@@ -4725,3 +5616,531 @@ qioerr qio_locales_for_region(qio_file_t* fl, off_t start, off_t end, const char
     QIO_RETURN_CONSTANT_ERROR(ENOSYS, "Unable to get locale for specified region of file");
   }
 }
+
+qioerr qio_file_regions(qio_file_t* fl, int64_t start, int64_t end, int64_t nlocales, int64_t ntasks, qio_region_t** regions_out, int64_t* nregions_out)
+{
+  qioerr err = 0;
+  int64_t chunk = 0;
+  int64_t stripe_count = 0;
+  int64_t want, size, base, n, i;
+  int lustre = 0;
+  qio_region_t* regions;
+
+  *regions_out = NULL;
+  *nregions_out = 0;
+
+  if( end < start )
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "region ends before it starts");
+  if( end == start ) return 0;
+  if( nlocales < 1 ) nlocales = 1;
+  if( ntasks < 1 ) ntasks = 1;
+
+  err = qio_get_chunk(fl, &chunk);
+  if( err || chunk <= 0 ) chunk = qbytes_iobuf_size;
+
+#ifdef SYS_HAS_LLAPI
+  if( !fl->file_info ) {
+    int ftype = 0;
+    err = qio_get_fs_type(fl, &ftype);
+    if( !err && ftype == FTYPE_LUSTRE ) {
+      int64_t stripe_size = 0;
+      fd_t fd = fl->fp ? fileno(fl->fp) : fl->fd;
+      if( sys_lustre_get_stripe(fd, &stripe_size, &stripe_count) == 0 &&
+          stripe_size > 0 && stripe_count > 1 ) {
+        chunk = stripe_size;
+        lustre = 1;
+      }
+    }
+  }
+#endif
+
+  // An even share for each task, in whole chunks.
+  want = nlocales * ntasks;
+  size = (end - start + want - 1) / want;
+  if( size < qio_parallel_region_min ) size = qio_parallel_region_min;
+  size = ((size + chunk - 1) / chunk) * chunk;
+  // If every region covered a whole number of stripe rounds, they
+  // would all start on the same stripe, and so go to the same locale.
+  if( lustre && (size / chunk) % stripe_count == 0 ) size += chunk;
+
+  // Boundaries are at multiples of size from the chunk containing start.
+  base = start - start % chunk;
+  n = (end - base + size - 1) / size;
+
+  regions = (qio_region_t*) qio_calloc(n, sizeof(qio_region_t));
+  if( !regions ) return QIO_ENOMEM;
+
+  for( i = 0; i < n; i++ ) {
+    regions[i].start = (i == 0) ? start : base + i * size;
+    regions[i].end = base + (i + 1) * size;
+    if( regions[i].end > end ) regions[i].end = end;
+
+    if( lustre ) {
+      // the locale for the stripe slot where the region starts
+      regions[i].locale = ((regions[i].start / chunk) % stripe_count) % nlocales;
+    } else if( fl->file_info ) {
+      // see qio_locales_for_region
+      regions[i].locale = -1;
+    } else {
+      // contiguous runs of regions per locale
+      regions[i].locale = i * nlocales / n;
+    }
+  }
+
+  *regions_out = regions;
+  *nregions_out = n;
+  return 0;
+}
+
+qioerr qio_region_channel_create(qio_channel_t** ch_out, qio_file_t* file, const qio_region_t* region, qio_hint_t hints, qio_style_t* style)
+{
+#ifdef POSIX_FADV_WILLNEED
+  // Start reading the region ahead, unless it's meant to bypass the
+  // page cache.  This is only advice, so ignore any error.
+  if( !file->file_info && file->fd != -1 &&
+      !((hints | file->hints) & QIO_HINT_DIRECT) ) {
+    (void) sys_posix_fadvise(file->fd, region->start,
+                             region->end - region->start,
+                             POSIX_FADV_WILLNEED);
+  }
+#endif
+
+  return qio_channel_create(ch_out, file, hints | QIO_HINT_PARALLEL,
+                            1, 0, region->start, region->end, style, 0);
+}
+
+qioerr qio_file_map_region(qio_file_t* file, int64_t start, int64_t len, qio_hint_t hints, qbytes_t** region_out, void** data_out)
+{
+  int64_t skip;
+  int64_t maplen;
+  int populate = 0;
+  struct stat stats;
+  void* data;
+  qioerr err;
+
+  *region_out = NULL;
+  *data_out = NULL;
+
+  if( start < 0 || len <= 0 )
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "invalid region to map");
+  if( file->fd == -1 || file->file_info || file->buf )
+    QIO_RETURN_CONSTANT_ERROR(ENOTSUP, "file does not support mapping");
+  if( !(file->fdflags & QIO_FDFLAG_READABLE) )
+    QIO_RETURN_CONSTANT_ERROR(EBADF, "file is not readable");
+
+  // Touching a mapped page past the end of the file raises SIGBUS,
+  // so don't hand out such pages.
+  err = qio_int_to_err(sys_fstat(file->fd, &stats));
+  if( err ) return err;
+  if( start + len > stats.st_size )
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "region to map extends past end of file");
+
+  // mmap needs a page-aligned file offset.
+  skip = start % sys_page_size();
+  maplen = len + skip;
+
+  // This check is (only) important for 32-bit systems.
+  if( maplen > SSIZE_MAX ) return QIO_ENOMEM;
+
+#ifdef MAP_POPULATE
+  if( hints & QIO_HINT_CACHED ) populate = MAP_POPULATE;
+#endif
+
+  err = qio_int_to_err(sys_mmap(NULL, maplen, PROT_READ, MAP_SHARED|populate,
+                                file->fd, start - skip, &data));
+  if( err ) return err;
+
+  err = qio_madvise_for_hints(data, maplen, hints);
+  if( err ) {
+    sys_munmap(data, maplen);
+    return err;
+  }
+
+  err = qbytes_create_generic(region_out, data, maplen, qbytes_free_munmap);
+  if( err ) {
+    sys_munmap(data, maplen);
+    return err;
+  }
+
+  *data_out = qio_ptr_add(data, skip);
+  return 0;
+}
+
+qioerr qio_mapped_region_prefetch(qbytes_t* region, void* ptr, int64_t len)
+{
+  intptr_t page = sys_page_size();
+  intptr_t lo = (intptr_t) ptr;
+  intptr_t hi = lo + len;
+  intptr_t base = (intptr_t) region->data;
+
+  if( lo < base ) lo = base;
+  if( hi > base + region->len ) hi = base + region->len;
+  if( hi <= lo ) return 0;
+  lo -= (lo - base) % page;
+
+#ifdef POSIX_MADV_WILLNEED
+  return qio_int_to_err(sys_posix_madvise((void*) lo, hi - lo,
+                                          POSIX_MADV_WILLNEED));
+#else
+  return 0;
+#endif
+}
+
+// Mapped regions handed out as external arrays.  The array's free
+// function only gets the element pointer, so keep a list to find the
+// region from it.  There shouldn't be many of these at once.
+typedef struct qio_mapped_array_s {
+  void* elts;
+  qbytes_t* region;
+  struct qio_mapped_array_s* next;
+} qio_mapped_array_t;
+
+static pthread_mutex_t qio_mapped_arrays_lock = PTHREAD_MUTEX_INITIALIZER;
+static qio_mapped_array_t* qio_mapped_arrays = NULL;
+
+static
+void qio_mapped_array_free(void* elts)
+{
+  qio_mapped_array_t** p;
+  qio_mapped_array_t* found = NULL;
+
+  pthread_mutex_lock(&qio_mapped_arrays_lock);
+  for( p = &qio_mapped_arrays; *p != NULL; p = &(*p)->next ) {
+    if( (*p)->elts == elts ) {
+      found = *p;
+      *p = found->next;
+      break;
+    }
+  }
+  pthread_mutex_unlock(&qio_mapped_arrays_lock);
+
+  if( found ) {
+    qbytes_release(found->region);
+    qio_free(found);
+  }
+}
+
+qioerr qio_file_map_external_array(qio_file_t* file, int64_t start, uint64_t elt_size, uint64_t num_elts, qio_hint_t hints, chpl_external_array* arr_out)
+{
+  qio_mapped_array_t* entry;
+  qbytes_t* region;
+  void* data;
+  qioerr err;
+
+  arr_out->elts = NULL;
+  arr_out->num_elts = 0;
+  arr_out->freer = NULL;
+
+  if( elt_size == 0 || num_elts == 0 || num_elts > INT64_MAX / elt_size )
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "invalid array size to map");
+
+  entry = (qio_mapped_array_t*) qio_malloc(sizeof(qio_mapped_array_t));
+  if( !entry ) return QIO_ENOMEM;
+
+  err = qio_file_map_region(file, start, elt_size * num_elts, hints,
+                            &region, &data);
+  if( err ) {
+    qio_free(entry);
+    return err;
+  }
+
+  entry->elts = data;
+  entry->region = region;
+  pthread_mutex_lock(&qio_mapped_arrays_lock);
+  entry->next = qio_mapped_arrays;
+  qio_mapped_arrays = entry;
+  pthread_mutex_unlock(&qio_mapped_arrays_lock);
+
+  arr_out->elts = data;
+  arr_out->num_elts = num_elts;
+  arr_out->freer = (void*) qio_mapped_array_free;
+  return 0;
+}
+
+// Requests that are adjacent in the file share one preadv, of at most
+// this many iovecs.
+#define QIO_PREAD_BATCH_MAX_IOV 1024
+
+typedef struct {
+  int64_t offset;
+  int64_t len;   // bytes in all of its iovecs
+  int64_t got;   // bytes read so far
+  int first;     // index of its first iovec
+  int cnt;       // number of iovecs
+  qioerr err;
+} qio_pread_group_t;
+
+typedef struct {
+  int64_t offset;
+  int64_t idx;
+} qio_pread_key_t;
+
+// Sort n keys by offset with an LSD radix sort, 8 bits at a time,
+// skipping digits that are the same in every key.  tmp has room for n
+// keys.  Returns whichever of keys and tmp holds the result.
+static
+qio_pread_key_t* _qio_pread_sort(qio_pread_key_t* keys, qio_pread_key_t* tmp, int64_t n)
+{
+  uint64_t max = 0;
+  int sorted = 1;
+  int64_t count[256];
+  int64_t i, sum;
+  int shift, d;
+
+  for( i = 0; i < n; i++ ) {
+    if( (uint64_t) keys[i].offset > max ) max = keys[i].offset;
+    if( i > 0 && keys[i].offset < keys[i-1].offset ) sorted = 0;
+  }
+  if( sorted ) return keys;
+
+  for( shift = 0; shift < 64 && (max >> shift) != 0; shift += 8 ) {
+    qio_pread_key_t* swap;
+
+    memset(count, 0, sizeof(count));
+    for( i = 0; i < n; i++ ) count[(keys[i].offset >> shift) & 0xff]++;
+    if( count[(keys[0].offset >> shift) & 0xff] == n ) continue;
+
+    sum = 0;
+    for( d = 0; d < 256; d++ ) {
+      int64_t c = count[d];
+      count[d] = sum;
+      sum += c;
+    }
+    for( i = 0; i < n; i++ ) tmp[count[(keys[i].offset >> shift) & 0xff]++] = keys[i];
+
+    swap = keys;
+    keys = tmp;
+    tmp = swap;
+  }
+
+  return keys;
+}
+
+// Read the rest of a group (from g->got on) with preadv, stopping at
+// end of file.  Uses up the group's iovecs.
+static
+void _qio_pread_group_finish(fd_t fd, struct iovec* iov, qio_pread_group_t* g)
+{
+  struct iovec* v = iov + g->first;
+  int cnt = g->cnt;
+  int64_t skip = g->got;
+
+  while( g->got < g->len && !g->err ) {
+    ssize_t n = 0;
+    qioerr err;
+
+    // drop what has already been filled
+    while( cnt > 0 && skip >= (int64_t) v->iov_len ) {
+      skip -= v->iov_len;
+      v++;
+      cnt--;
+    }
+    v->iov_base = qio_ptr_add(v->iov_base, skip);
+    v->iov_len -= skip;
+
+    err = qio_int_to_err(sys_preadv(fd, v, cnt, g->offset + g->got, &n));
+    if( err && qio_err_to_int(err) == EINTR ) {
+      skip = 0;
+      continue;
+    }
+    if( err && qio_err_to_int(err) == EEOF ) break;
+    if( err ) {
+      g->err = err;
+      break;
+    }
+    g->got += n;
+    skip = n;
+  }
+}
+
+qioerr qio_file_pread_batch(qio_file_t* file, qio_pread_req_t* reqs, int64_t nreqs)
+{
+  qio_pread_req_t** sorted = NULL;
+  qio_pread_key_t* keys = NULL;
+  qio_pread_key_t* keys_tmp = NULL;
+  qio_pread_key_t* order;
+  qio_pread_req_t** iovreq = NULL;
+  struct iovec* iov = NULL;
+  qio_pread_group_t* groups = NULL;
+  qio_pread_group_t* g;
+  qbytes_t* mapped = NULL;
+  qio_method_t method;
+  int64_t ngroups = 0;
+  int64_t niov = 0;
+  int64_t i, k;
+  qioerr err = 0;
+
+  if( nreqs < 0 ) QIO_RETURN_CONSTANT_ERROR(EINVAL, "invalid number of reads");
+  if( file->file_info )
+    QIO_RETURN_CONSTANT_ERROR(ENOTSUP, "batch reads not supported for plugin files");
+  if( file->compress_codec != QIO_COMPRESS_NONE )
+    QIO_RETURN_CONSTANT_ERROR(ENOTSUP, "batch reads not supported for compressed files");
+  if( !(file->fdflags & QIO_FDFLAG_READABLE) )
+    QIO_RETURN_CONSTANT_ERROR(EBADF, "file is not readable");
+
+  for( i = 0; i < nreqs; i++ ) {
+    if( reqs[i].offset < 0 || reqs[i].len < 0 )
+      QIO_RETURN_CONSTANT_ERROR(EINVAL, "invalid range to read");
+    reqs[i].amt_read = 0;
+  }
+  if( nreqs == 0 ) return 0;
+
+  // Visit the requests in file order.
+  sorted = (qio_pread_req_t**) qio_malloc(nreqs * sizeof(qio_pread_req_t*));
+  keys = (qio_pread_key_t*) qio_malloc(nreqs * sizeof(qio_pread_key_t));
+  keys_tmp = (qio_pread_key_t*) qio_malloc(nreqs * sizeof(qio_pread_key_t));
+  if( !sorted || !keys || !keys_tmp ) {
+    err = QIO_ENOMEM;
+    goto done;
+  }
+  for( i = 0; i < nreqs; i++ ) {
+    keys[i].offset = reqs[i].offset;
+    keys[i].idx = i;
+  }
+  order = _qio_pread_sort(keys, keys_tmp, nreqs);
+  for( i = 0; i < nreqs; i++ ) sorted[i] = &reqs[order[i].idx];
+  qio_free(keys_tmp);
+  qio_free(keys);
+  keys_tmp = NULL;
+  keys = NULL;
+
+  if( file->buf ) {
+    // memory file
+    err = qio_lock(&file->lock);
+    if( err ) goto done;
+    for( i = 0; i < nreqs && !err; i++ ) {
+      qio_pread_req_t* r = sorted[i];
+      int64_t end = qbuffer_end_offset(file->buf);
+      int64_t amt = r->len;
+      qbuffer_iter_t start, stop;
+      if( r->offset >= end || amt == 0 ) continue;
+      if( amt > end - r->offset ) amt = end - r->offset;
+      start = qbuffer_iter_at(file->buf, r->offset);
+      stop = start;
+      qbuffer_iter_advance(file->buf, &stop, amt);
+      err = qbuffer_copyout(file->buf, start, stop, r->dst, amt);
+      if( !err ) r->amt_read = amt;
+    }
+    qio_unlock(&file->lock);
+    goto done;
+  }
+
+  if( file->fd == -1 ) {
+    QIO_GET_CONSTANT_ERROR(err, EINVAL, "invalid file descriptor");
+    goto done;
+  }
+
+  method = (qio_method_t) (choose_io_method(file, file->hints, 0,
+                                            file->initial_length, 1, 0,
+                                            0) & QIO_METHODMASK);
+  if( method == QIO_METHOD_MMAP ) mapped = file->mmap;
+
+  iov = (struct iovec*) qio_malloc(nreqs * sizeof(struct iovec));
+  iovreq = (qio_pread_req_t**) qio_malloc(nreqs * sizeof(qio_pread_req_t*));
+  groups = (qio_pread_group_t*) qio_malloc(nreqs * sizeof(qio_pread_group_t));
+  if( !iov || !iovreq || !groups ) {
+    err = QIO_ENOMEM;
+    goto done;
+  }
+
+  // Copy what's already mapped; group the rest into runs of adjacent
+  // ranges.
+  for( i = 0; i < nreqs; i++ ) {
+    qio_pread_req_t* r = sorted[i];
+    if( r->len == 0 ) continue;
+
+    if( mapped && r->offset + r->len <= mapped->len ) {
+      qio_memcpy(r->dst, qio_ptr_add(mapped->data, r->offset), r->len);
+      r->amt_read = r->len;
+      continue;
+    }
+
+    g = ngroups > 0 ? &groups[ngroups-1] : NULL;
+    if( g == NULL || g->offset + g->len != r->offset ||
+        g->cnt == QIO_PREAD_BATCH_MAX_IOV ) {
+      g = &groups[ngroups++];
+      g->offset = r->offset;
+      g->len = 0;
+      g->got = 0;
+      g->first = niov;
+      g->cnt = 0;
+      g->err = 0;
+    }
+    iov[niov].iov_base = r->dst;
+    iov[niov].iov_len = r->len;
+    iovreq[niov] = r;
+    niov++;
+    g->cnt++;
+    g->len += r->len;
+  }
+
+  STARTING_SLOW_SYSCALL;
+
+#ifdef QIO_HAS_URING
+  if( method == QIO_METHOD_URING && ngroups > 1 ) {
+    // Keep a ring's worth of groups in flight.
+    qio_uring_t* ring = qio_uring_get();
+    int32_t res[QIO_URING_DEPTH];
+    off_t offsets[QIO_URING_DEPTH];
+    int cnts[QIO_URING_DEPTH];
+    int64_t n;
+
+    for( i = 0; ring && ring->state > 0 && i < ngroups; i += n ) {
+      n = ngroups - i;
+      if( n > (int64_t) ring->entries ) n = ring->entries;
+      for( k = 0; k < n; k++ ) {
+        offsets[k] = groups[i+k].offset;
+        cnts[k] = groups[i+k].cnt;
+      }
+      // If the ring breaks, the rest is read below.
+      if( qio_uring_submit_wait(ring, 0, file->fd, &iov[groups[i].first],
+                                cnts, offsets, n, res) != 0 )
+        break;
+      for( k = 0; k < n; k++ ) {
+        if( res[k] >= 0 )
+          groups[i+k].got = res[k];
+        else if( res[k] != -EINTR && res[k] != -EAGAIN )
+          groups[i+k].err = qio_int_to_err(-res[k]);
+      }
+    }
+  }
+#endif
+
+  // Finish any groups that came up short, or read them all if
+  // io_uring isn't in use.
+  for( i = 0; i < ngroups; i++ ) {
+    _qio_pread_group_finish(file->fd, iov, &groups[i]);
+  }
+
+  DONE_SLOW_SYSCALL;
+
+  for( i = 0; i < ngroups; i++ ) {
+    int64_t left = groups[i].got;
+    g = &groups[i];
+    for( k = g->first; k < g->first + g->cnt; k++ ) {
+      int64_t amt = iovreq[k]->len;
+      if( amt > left ) amt = left;
+      iovreq[k]->amt_read = amt;
+      left -= amt;
+    }
+    if( g->err && !err ) err = g->err;
+  }
+
+done:
+  if( !err ) {
+    for( i = 0; i < nreqs; i++ ) {
+      if( reqs[i].amt_read < reqs[i].len ) {
+        err = QIO_EEOF;
+        break;
+      }
+    }
+  }
+
+  qio_free(groups);
+  qio_free(iovreq);
+  qio_free(iov);
+  qio_free(keys_tmp);
+  qio_free(keys);
+  qio_free(sorted);
+  return err;
+}
@@ -0,0 +1,660 @@
+/*
+ * Copyright 2020-2026 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "sys_basic.h"
+
+#ifndef CHPL_RT_UNIT_TEST
+#include "chplrt.h"
+#include "chpl-env.h"
+#include "error.h"
+#endif
+
+#include "qio_compress.h"
+#include "bswap.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <string.h>
+#include <strings.h>
+
+#ifdef QIO_HAS_ZSTD
+#include <zstd.h>
+#endif
+#ifdef QIO_HAS_LZ4
+#include <lz4.h>
+#endif
+#ifdef QIO_HAS_ZLIB
+#include <zlib.h>
+#endif
+
+int64_t qio_compress_block_size = 256*1024;
+int qio_compress_threads = -1;
+int qio_compress_level = 0;
+
+static const char qio_compress_magic[6] = { 'C', 'H', 'P', 'L', 'Q', 'Z' };
+#define QIO_COMPRESS_VERSION 1
+// readers refuse headers claiming bigger blocks than this
+#define QIO_COMPRESS_MAX_BLOCK (1024*1024*1024)
+
+struct qio_compress_s {
+  qio_compress_codec_t codec;
+  int writing;
+  int level;
+  int nthreads;
+  int64_t block_size; // readers get it from the header
+  int header_done;    // header written (writers) or read (readers)
+
+  // file offset of the next block and its uncompressed offset
+  int64_t phys_offset;
+  int64_t raw_offset;
+
+  // writers: uncompressed input and compressed output of a batch
+  // readers: the current block, uncompressed, and as stored
+  void* in;
+  size_t in_cap;
+  void* out;
+  size_t out_cap;
+
+  // readers: uncompressed offset and length of the block in 'in'
+  int64_t cur_start;
+  int64_t cur_len;
+};
+
+int qio_compress_codec_available(qio_compress_codec_t codec)
+{
+  switch (codec) {
+    case QIO_COMPRESS_ZSTD:
+#ifdef QIO_HAS_ZSTD
+      return 1;
+#else
+      return 0;
+#endif
+    case QIO_COMPRESS_LZ4:
+#ifdef QIO_HAS_LZ4
+      return 1;
+#else
+      return 0;
+#endif
+    case QIO_COMPRESS_ZLIB:
+#ifdef QIO_HAS_ZLIB
+      return 1;
+#else
+      return 0;
+#endif
+    case QIO_COMPRESS_NONE:
+      return 0;
+  }
+  return 0;
+}
+
+qio_compress_codec_t qio_compress_default_codec(void)
+{
+  qio_compress_codec_t order[3] = { QIO_COMPRESS_ZSTD, QIO_COMPRESS_LZ4,
+                                    QIO_COMPRESS_ZLIB };
+  int i;
+#ifndef CHPL_RT_UNIT_TEST
+  const char* name = chpl_env_rt_get("QIO_COMPRESS", NULL);
+  if( name != NULL ) {
+    qio_compress_codec_t want = QIO_COMPRESS_NONE;
+    if( strcasecmp(name, "zstd") == 0 ) want = QIO_COMPRESS_ZSTD;
+    else if( strcasecmp(name, "lz4") == 0 ) want = QIO_COMPRESS_LZ4;
+    else if( strcasecmp(name, "zlib") == 0 ) want = QIO_COMPRESS_ZLIB;
+
+    if( qio_compress_codec_available(want) ) return want;
+    chpl_warning("CHPL_RT_QIO_COMPRESS names a codec that is not available;"
+                 " using the default", 0, 0);
+  }
+#endif
+  for( i = 0; i < 3; i++ ) {
+    if( qio_compress_codec_available(order[i]) ) return order[i];
+  }
+  return QIO_COMPRESS_NONE;
+}
+
+static
+int qio_compress_get_threads(void)
+{
+  if( qio_compress_threads < 0 ) {
+#ifndef CHPL_RT_UNIT_TEST
+    qio_compress_threads = chpl_env_rt_get_int("QIO_COMPRESS_THREADS", 4);
+#else
+    qio_compress_threads = 4;
+#endif
+    if( qio_compress_threads < 1 ) qio_compress_threads = 1;
+  }
+  return qio_compress_threads;
+}
+
+static
+size_t _codec_bound(qio_compress_codec_t codec, size_t n)
+{
+  switch (codec) {
+#ifdef QIO_HAS_ZSTD
+    case QIO_COMPRESS_ZSTD:
+      return ZSTD_compressBound(n);
+#endif
+#ifdef QIO_HAS_LZ4
+    case QIO_COMPRESS_LZ4:
+      return LZ4_compressBound((int) n);
+#endif
+#ifdef QIO_HAS_ZLIB
+    case QIO_COMPRESS_ZLIB:
+      return compressBound(n);
+#endif
+    default:
+      return n;
+  }
+}
+
+// Returns the compressed length, or 0 if the codec failed
+// (in which case the block is stored).
+static
+size_t _codec_compress(qio_compress_codec_t codec, int level,
+                       void* dst, size_t dst_cap,
+                       const void* src, size_t n)
+{
+  switch (codec) {
+#ifdef QIO_HAS_ZSTD
+    case QIO_COMPRESS_ZSTD:
+    {
+      size_t got = ZSTD_compress(dst, dst_cap, src, n,
+                                 level ? level : ZSTD_CLEVEL_DEFAULT);
+      return ZSTD_isError(got) ? 0 : got;
+    }
+#endif
+#ifdef QIO_HAS_LZ4
+    case QIO_COMPRESS_LZ4:
+    {
+      // for lz4, the level is the acceleration
+      int got = LZ4_compress_fast((const char*) src, (char*) dst, (int) n,
+                                  (int) dst_cap, level > 0 ? level : 1);
+      return got > 0 ? (size_t) got : 0;
+    }
+#endif
+#ifdef QIO_HAS_ZLIB
+    case QIO_COMPRESS_ZLIB:
+    {
+      uLongf got = dst_cap;
+      if( compress2((Bytef*) dst, &got, (const Bytef*) src, n,
+                    level ? level : Z_DEFAULT_COMPRESSION) != Z_OK )
+        return 0;
+      return got;
+    }
+#endif
+    default:
+      return 0;
+  }
+}
+
+static
+qioerr _codec_decompress(qio_compress_codec_t codec,
+                         void* dst, size_t dst_len,
+                         const void* src, size_t n)
+{
+  int ok = 0;
+
+  switch (codec) {
+#ifdef QIO_HAS_ZSTD
+    case QIO_COMPRESS_ZSTD:
+    {
+      size_t got = ZSTD_decompress(dst, dst_len, src, n);
+      ok = !ZSTD_isError(got) && got == dst_len;
+      break;
+    }
+#endif
+#ifdef QIO_HAS_LZ4
+    case QIO_COMPRESS_LZ4:
+    {
+      int got = LZ4_decompress_safe((const char*) src, (char*) dst,
+                                    (int) n, (int) dst_len);
+      ok = got >= 0 && (size_t) got == dst_len;
+      break;
+    }
+#endif
+#ifdef QIO_HAS_ZLIB
+    case QIO_COMPRESS_ZLIB:
+    {
+      uLongf got = dst_len;
+      ok = uncompress((Bytef*) dst, &got, (const Bytef*) src, n) == Z_OK &&
+           got == dst_len;
+      break;
+    }
+#endif
+    default:
+      QIO_RETURN_CONSTANT_ERROR(ENOSYS, "compression codec not available");
+  }
+
+  if( !ok ) QIO_RETURN_CONSTANT_ERROR(EFORMAT, "corrupt compressed block");
+  return 0;
+}
+
+static
+qioerr _grow(void** ptr, size_t* cap, size_t need)
+{
+  void* p;
+
+  if( *cap >= need ) return 0;
+  p = qio_malloc(need);
+  if( !p ) return QIO_ENOMEM;
+  qio_free(*ptr);
+  *ptr = p;
+  *cap = need;
+  return 0;
+}
+
+// Read up to len bytes at offset, stopping early only at end of file.
+static
+qioerr _pread_full(fd_t fd, void* ptr, size_t len, int64_t offset,
+                   size_t* got_out)
+{
+  size_t got = 0;
+  qioerr err = 0;
+
+  while( got < len ) {
+    ssize_t n = 0;
+    err = qio_int_to_err(sys_pread(fd, PTR_ADDBYTES(ptr, got), len - got,
+                                   offset + got, &n));
+    if( err && qio_err_to_int(err) == EINTR ) {
+      err = 0;
+      continue;
+    }
+    if( err ) break;
+    if( n == 0 ) break;
+    got += n;
+  }
+
+  *got_out = got;
+  return err;
+}
+
+static
+qioerr _pwrite_full(fd_t fd, const void* ptr, size_t len, int64_t offset)
+{
+  size_t done = 0;
+  qioerr err = 0;
+
+  while( done < len ) {
+    ssize_t n = 0;
+    err = qio_int_to_err(sys_pwrite(fd, PTR_ADDBYTES(ptr, done), len - done,
+                                    offset + done, &n));
+    if( err && qio_err_to_int(err) == EINTR ) {
+      err = 0;
+      continue;
+    }
+    if( err ) break;
+    done += n;
+  }
+
+  return err;
+}
+
+qioerr qio_compress_detect(fd_t fd, int64_t length,
+                           qio_compress_codec_t* codec_out)
+{
+  unsigned char hdr[QIO_COMPRESS_HEADER_SIZE];
+  size_t got = 0;
+  qioerr err;
+
+  *codec_out = QIO_COMPRESS_NONE;
+  if( length < QIO_COMPRESS_HEADER_SIZE ) return 0;
+
+  err = _pread_full(fd, hdr, sizeof(hdr), 0, &got);
+  if( err ) return err;
+
+  if( got == sizeof(hdr) &&
+      memcmp(hdr, qio_compress_magic, sizeof(qio_compress_magic)) == 0 &&
+      hdr[6] == QIO_COMPRESS_VERSION &&
+      hdr[7] > QIO_COMPRESS_NONE && hdr[7] <= QIO_COMPRESS_ZLIB ) {
+    *codec_out = (qio_compress_codec_t) hdr[7];
+  }
+
+  return 0;
+}
+
+qioerr qio_compress_create(qio_compress_t** z_out, qio_compress_codec_t codec,
+                           int writing)
+{
+  qio_compress_t* z;
+
+  *z_out = NULL;
+
+  if( !qio_compress_codec_available(codec) )
+    QIO_RETURN_CONSTANT_ERROR(ENOSYS, "compression codec not available");
+
+  z = (qio_compress_t*) qio_calloc(1, sizeof(qio_compress_t));
+  if( !z ) return QIO_ENOMEM;
+
+  z->codec = codec;
+  z->writing = writing;
+  z->level = qio_compress_level;
+  z->nthreads = writing ? qio_compress_get_threads() : 1;
+  z->block_size = writing ? qio_compress_block_size : 0;
+  if( writing && (z->block_size <= 0 ||
+                  z->block_size > QIO_COMPRESS_MAX_BLOCK) ) {
+    qio_free(z);
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "invalid compression block size");
+  }
+  z->phys_offset = QIO_COMPRESS_HEADER_SIZE;
+
+  *z_out = z;
+  return 0;
+}
+
+void qio_compress_destroy(qio_compress_t* z)
+{
+  if( !z ) return;
+  qio_free(z->in);
+  qio_free(z->out);
+  qio_free(z);
+}
+
+int64_t qio_compress_batch_size(qio_compress_t* z)
+{
+  return z->block_size * z->nthreads;
+}
+
+typedef struct {
+  qio_compress_t* z;
+  size_t n;         // uncompressed bytes in the batch
+  size_t stride;    // bytes of 'out' per block
+  int64_t nblocks;
+  int64_t first;    // this worker does first, first+step, ...
+  int64_t step;
+} qio_compress_job_t;
+
+static
+void* _compress_blocks(void* arg)
+{
+  qio_compress_job_t* job = (qio_compress_job_t*) arg;
+  qio_compress_t* z = job->z;
+  int64_t i;
+
+  for( i = job->first; i < job->nblocks; i += job->step ) {
+    const unsigned char* src = (const unsigned char*) z->in +
+                               i * z->block_size;
+    unsigned char* dst = (unsigned char*) z->out + i * job->stride;
+    size_t raw = job->n - i * z->block_size;
+    size_t stored;
+    uint32_t le;
+
+    if( raw > (size_t) z->block_size ) raw = z->block_size;
+
+    stored = _codec_compress(z->codec, z->level,
+                             dst + QIO_COMPRESS_BLOCK_HEADER_SIZE,
+                             job->stride - QIO_COMPRESS_BLOCK_HEADER_SIZE,
+                             src, raw);
+    if( stored == 0 || stored >= raw ) {
+      memcpy(dst + QIO_COMPRESS_BLOCK_HEADER_SIZE, src, raw);
+      stored = raw;
+    }
+
+    le = htole32((uint32_t) raw);
+    memcpy(dst, &le, 4);
+    le = htole32((uint32_t) stored);
+    memcpy(dst + 4, &le, 4);
+  }
+
+  return NULL;
+}
+
+qioerr qio_compress_write(qio_compress_t* z, fd_t fd, qbuffer_t* buf,
+                          qbuffer_iter_t start, qbuffer_iter_t end,
+                          ssize_t* num_written)
+{
+  int64_t n = qbuffer_iter_num_bytes(start, end);
+  int64_t nblocks;
+  int64_t nthreads;
+  int64_t t;
+  size_t stride;
+  size_t total;
+  qio_compress_job_t jobs_onstack[8];
+  qio_compress_job_t* jobs = jobs_onstack;
+  pthread_t threads_onstack[8];
+  pthread_t* threads = threads_onstack;
+  char started_onstack[8];
+  char* started = started_onstack;
+  qioerr err;
+
+  *num_written = 0;
+  if( n <= 0 ) return 0;
+
+  if( start.offset != z->raw_offset )
+    QIO_RETURN_CONSTANT_ERROR(EINVAL,
+                              "compressed channels must write sequentially");
+
+  if( !z->header_done ) {
+    unsigned char hdr[QIO_COMPRESS_HEADER_SIZE];
+    uint32_t le = htole32((uint32_t) z->block_size);
+    memset(hdr, 0, sizeof(hdr));
+    memcpy(hdr, qio_compress_magic, sizeof(qio_compress_magic));
+    hdr[6] = QIO_COMPRESS_VERSION;
+    hdr[7] = (unsigned char) z->codec;
+    memcpy(hdr + 8, &le, 4);
+    err = _pwrite_full(fd, hdr, sizeof(hdr), 0);
+    if( err ) return err;
+    z->header_done = 1;
+  }
+
+  err = _grow(&z->in, &z->in_cap, n);
+  if( err ) return err;
+  err = qbuffer_copyout(buf, start, end, z->in, n);
+  if( err ) return err;
+
+  nblocks = (n + z->block_size - 1) / z->block_size;
+  stride = QIO_COMPRESS_BLOCK_HEADER_SIZE +
+           _codec_bound(z->codec, z->block_size);
+  err = _grow(&z->out, &z->out_cap, nblocks * stride);
+  if( err ) return err;
+
+  nthreads = z->nthreads;
+  if( nthreads > nblocks ) nthreads = nblocks;
+  if( nthreads > 8 ) {
+    jobs = (qio_compress_job_t*) qio_malloc(nthreads * sizeof(*jobs));
+    threads = (pthread_t*) qio_malloc(nthreads * sizeof(*threads));
+    started = (char*) qio_malloc(nthreads);
+    if( !jobs || !threads || !started ) {
+      // do it all on this thread
+      if( jobs ) qio_free(jobs);
+      if( threads ) qio_free(threads);
+      if( started ) qio_free(started);
+      jobs = jobs_onstack;
+      threads = threads_onstack;
+      started = started_onstack;
+      nthreads = 1;
+    }
+  }
+
+  for( t = 0; t < nthreads; t++ ) {
+    jobs[t].z = z;
+    jobs[t].n = n;
+    jobs[t].stride = stride;
+    jobs[t].nblocks = nblocks;
+    jobs[t].first = t;
+    jobs[t].step = nthreads;
+    started[t] = 0;
+  }
+
+  // Hand out all but the first share; if a thread can't be started,
+  // its share is done here instead.
+  for( t = 1; t < nthreads; t++ ) {
+    started[t] = pthread_create(&threads[t], NULL,
+                                _compress_blocks, &jobs[t]) == 0;
+  }
+  _compress_blocks(&jobs[0]);
+  for( t = 1; t < nthreads; t++ ) {
+    if( started[t] ) pthread_join(threads[t], NULL);
+    else _compress_blocks(&jobs[t]);
+  }
+
+  if( jobs != jobs_onstack ) {
+    qio_free(jobs);
+    qio_free(threads);
+    qio_free(started);
+  }
+
+  // Pack the blocks together. Each one moves no later than
+  // where it is, so going in order never overwrites one not yet moved.
+  total = 0;
+  for( t = 0; t < nblocks; t++ ) {
+    unsigned char* src = (unsigned char*) z->out + t * stride;
+    uint32_t le;
+    size_t len;
+    memcpy(&le, src + 4, 4);
+    len = QIO_COMPRESS_BLOCK_HEADER_SIZE + le32toh(le);
+    if( total != t * stride )
+      memmove((unsigned char*) z->out + total, src, len);
+    total += len;
+  }
+
+  err = _pwrite_full(fd, z->out, total, z->phys_offset);
+  if( err ) return err;
+
+  z->phys_offset += total;
+  z->raw_offset += n;
+  *num_written = n;
+  return 0;
+}
+
+static
+qioerr _read_header(qio_compress_t* z, fd_t fd)
+{
+  unsigned char hdr[QIO_COMPRESS_HEADER_SIZE];
+  size_t got = 0;
+  uint32_t le;
+  qioerr err;
+
+  err = _pread_full(fd, hdr, sizeof(hdr), 0, &got);
+  if( err ) return err;
+
+  if( got != sizeof(hdr) ||
+      memcmp(hdr, qio_compress_magic, sizeof(qio_compress_magic)) != 0 ||
+      hdr[6] != QIO_COMPRESS_VERSION || hdr[7] != z->codec )
+    QIO_RETURN_CONSTANT_ERROR(EFORMAT, "bad compressed file header");
+
+  memcpy(&le, hdr + 8, 4);
+  z->block_size = le32toh(le);
+  if( z->block_size <= 0 || z->block_size > QIO_COMPRESS_MAX_BLOCK )
+    QIO_RETURN_CONSTANT_ERROR(EFORMAT, "bad compressed file header");
+
+  z->header_done = 1;
+  z->phys_offset = QIO_COMPRESS_HEADER_SIZE;
+  z->raw_offset = 0;
+  z->cur_start = 0;
+  z->cur_len = 0;
+  return 0;
+}
+
+qioerr qio_compress_read(qio_compress_t* z, fd_t fd, qbuffer_t* buf,
+                         qbuffer_iter_t start, qbuffer_iter_t end,
+                         ssize_t* num_read)
+{
+  int64_t off = start.offset;
+  int64_t amt;
+  qbuffer_iter_t copy_end;
+  qioerr err;
+
+  *num_read = 0;
+
+  if( !z->header_done ) {
+    err = _read_header(z, fd);
+    if( err ) return err;
+  }
+
+  // Start over from the first block to go backwards.
+  if( off < z->cur_start ) {
+    z->phys_offset = QIO_COMPRESS_HEADER_SIZE;
+    z->raw_offset = 0;
+    z->cur_start = 0;
+    z->cur_len = 0;
+  }
+
+  while( off >= z->cur_start + z->cur_len ) {
+    unsigned char bhdr[QIO_COMPRESS_BLOCK_HEADER_SIZE];
+    uint32_t le;
+    int64_t raw_len;
+    int64_t stored_len;
+    size_t got = 0;
+
+    err = _pread_full(fd, bhdr, sizeof(bhdr), z->phys_offset, &got);
+    if( err ) return err;
+    if( got == 0 ) return QIO_EEOF;
+    if( got != sizeof(bhdr) )
+      QIO_RETURN_CONSTANT_ERROR(EFORMAT, "truncated compressed block");
+
+    memcpy(&le, bhdr, 4);
+    raw_len = le32toh(le);
+    memcpy(&le, bhdr + 4, 4);
+    stored_len = le32toh(le);
+    if( raw_len == 0 || raw_len > z->block_size || stored_len > raw_len )
+      QIO_RETURN_CONSTANT_ERROR(EFORMAT, "corrupt compressed block");
+
+    if( off >= z->raw_offset + raw_len ) {
+      // Not needed; skip it without reading the data.
+      z->phys_offset += QIO_COMPRESS_BLOCK_HEADER_SIZE + stored_len;
+      z->raw_offset += raw_len;
+      z->cur_start = z->raw_offset;
+      z->cur_len = 0;
+      continue;
+    }
+
+    err = _grow(&z->in, &z->in_cap, raw_len);
+    if( err ) return err;
+
+    if( stored_len == raw_len ) {
+      err = _pread_full(fd, z->in, raw_len,
+                        z->phys_offset + QIO_COMPRESS_BLOCK_HEADER_SIZE, &got);
+    } else {
+      err = _grow(&z->out, &z->out_cap, stored_len);
+      if( err ) return err;
+      err = _pread_full(fd, z->out, stored_len,
+                        z->phys_offset + QIO_COMPRESS_BLOCK_HEADER_SIZE, &got);
+    }
+    if( err ) return err;
+    if( (int64_t) got != stored_len )
+      QIO_RETURN_CONSTANT_ERROR(EFORMAT, "truncated compressed block");
+
+    if( stored_len != raw_len ) {
+      err = _codec_decompress(z->codec, z->in, raw_len, z->out, stored_len);
+      if( err ) return err;
+    }
+
+    z->cur_start = z->raw_offset;
+    z->cur_len = raw_len;
+    z->phys_offset += QIO_COMPRESS_BLOCK_HEADER_SIZE + stored_len;
+    z->raw_offset += raw_len;
+  }
+
+  amt = z->cur_start + z->cur_len - off;
+  if( amt > qbuffer_iter_num_bytes(start, end) )
+    amt = qbuffer_iter_num_bytes(start, end);
+
+  copy_end = start;
+  qbuffer_iter_advance(buf, &copy_end, amt);
+  err = qbuffer_copyin(buf, start, copy_end,
+                       PTR_ADDBYTES(z->in, off - z->cur_start), amt);
+  if( err ) return err;
+
+  *num_read = amt;
+  return 0;
+}
@@ -24,9 +24,12 @@
 #endif
 
 #include "qio_formatted.h"
+#include "qio_number_fast.h"
+#include "chpl-thread-local-storage.h"
 
 #include <limits.h>
 #include <ctype.h>
+#include <float.h>
 
 #ifdef HAS_WCTYPE_H
 #include <wctype.h>
@@ -131,6 +134,125 @@ qioerr qio_channel_write_svarint(const int threadsafe, qio_channel_t* restrict c
   return qio_channel_write_uvarint(threadsafe, ch, u_num);
 }
 
+// Does data in byteorder need its bytes swapped on this machine?
+static inline
+int _qio_byteorder_swaps(const int byteorder)
+{
+  const int big_host = (htobe16(1) == 1);
+  if( byteorder == QIO_BIG ) return ! big_host;
+  if( byteorder == QIO_LITTLE ) return big_host;
+  return 0;
+}
+
+// Copy n elements of eltsize bytes from src to dst, swapping the bytes
+// of each. Either pointer may be unaligned, and they may be the same.
+// (htobe/htole is a swap for whichever order differs from the host.)
+#define QIO_SWAP_ELTS(BITS) \
+  { \
+    const int big_host = (htobe16(1) == 1); \
+    for( i = 0; i < n; i++ ) { \
+      uint##BITS##_t v; \
+      memcpy(&v, s + i*sizeof(v), sizeof(v)); \
+      v = big_host ? htole##BITS(v) : htobe##BITS(v); \
+      memcpy(d + i*sizeof(v), &v, sizeof(v)); \
+    } \
+  }
+
+static
+void _qio_swap_elts(void* dst, const void* src, size_t n, size_t eltsize)
+{
+  unsigned char* d = (unsigned char*) dst;
+  const unsigned char* s = (const unsigned char*) src;
+  size_t i;
+
+  switch( eltsize ) {
+    case 2: QIO_SWAP_ELTS(16); break;
+    case 4: QIO_SWAP_ELTS(32); break;
+    case 8: QIO_SWAP_ELTS(64); break;
+    default: if( dst != src ) memmove(dst, src, n*eltsize); break;
+  }
+}
+
+#undef QIO_SWAP_ELTS
+
+qioerr qio_channel_write_array(const int threadsafe, const int byteorder, qio_channel_t* restrict ch, const void* restrict ptr, int64_t count, size_t eltsize)
+{
+  const unsigned char* src = (const unsigned char*) ptr;
+  qioerr err = 0;
+
+  if( eltsize != 1 && eltsize != 2 && eltsize != 4 && eltsize != 8 )
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "bad element size");
+  if( count < 0 || count > SSIZE_MAX / (int64_t) eltsize )
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "bad element count");
+
+  // Without swapping it's just bytes, and qio_channel_write_amt
+  // already skips the buffer for large writes.
+  if( eltsize == 1 || ! _qio_byteorder_swaps(byteorder) )
+    return qio_channel_write_amt(threadsafe, ch, ptr, count * eltsize);
+
+  if( threadsafe ) {
+    err = qio_lock(&ch->lock);
+    if( err ) return err;
+  }
+
+  while( count > 0 ) {
+    int64_t room = qio_ptr_diff(ch->cached_end, ch->cached_cur);
+    int64_t n;
+
+    if( ch->cached_cur != NULL && room >= (int64_t) eltsize ) {
+      // Swap straight into the buffer.
+      n = room / eltsize;
+      if( n > count ) n = count;
+      _qio_swap_elts(ch->cached_cur, src, n, eltsize);
+      ch->cached_cur = qio_ptr_add(ch->cached_cur, n*eltsize);
+      err = _qio_channel_post_cached_write(ch);
+    } else {
+      // Make room by writing some through the slow path, which sets
+      // the buffer up again.
+      unsigned char tmp[1024];
+      ssize_t amt_written = 0;
+
+      n = sizeof(tmp) / eltsize;
+      if( n > count ) n = count;
+      _qio_swap_elts(tmp, src, n, eltsize);
+      err = _qio_slow_write(ch, tmp, n*eltsize, &amt_written);
+      if( err == 0 && amt_written != (ssize_t) (n*eltsize) ) err = QIO_ESHORT;
+      _qio_channel_set_error_unlocked(ch, err);
+    }
+    if( err ) break;
+
+    src += n*eltsize;
+    count -= n;
+  }
+
+  if( threadsafe ) {
+    qio_unlock(&ch->lock);
+  }
+
+  return err;
+}
+
+qioerr qio_channel_read_array(const int threadsafe, const int byteorder, qio_channel_t* restrict ch, void* restrict ptr, int64_t count, size_t eltsize)
+{
+  qioerr err;
+
+  if( eltsize != 1 && eltsize != 2 && eltsize != 4 && eltsize != 8 )
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "bad element size");
+  if( count < 0 || count > SSIZE_MAX / (int64_t) eltsize )
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "bad element count");
+  if( count == 0 ) return 0;
+
+  // Read the bytes directly into place (large reads skip the buffer)
+  // and then swap them there.
+  err = qio_channel_read_amt(threadsafe, ch, ptr, count * eltsize);
+  if( err && err != QIO_ESHORT ) return err;
+
+  if( eltsize != 1 && _qio_byteorder_swaps(byteorder) )
+    _qio_swap_elts(ptr, ptr, count, eltsize);
+
+  return err;
+}
+
 
 
 static
@@ -149,6 +271,18 @@ qioerr _peek_until_byte(qio_channel_t* restrict ch, uint8_t term_byte, int64_t*
   if( err ) return err;
 
   while( 1 ) {
+    // Search whatever is already buffered with memchr, which is
+    // vectorized; only go byte-at-a-time to refill the buffer.
+    if( qio_space_in_ptr_diff(1, ch->cached_end, ch->cached_cur) ) {
+      void* found = memchr(ch->cached_cur, term_byte,
+                           qio_ptr_diff(ch->cached_end, ch->cached_cur));
+      if( found ) {
+        ch->cached_cur = qio_ptr_add(found, 1);
+        byte = term_byte;
+        break;
+      }
+      ch->cached_cur = ch->cached_end;
+    }
     err = qio_channel_read_uint8(false, ch, &byte);
     if( err ) break;
     if( byte == term_byte ) break;
@@ -2345,6 +2479,27 @@ int32_t qio_skip_json_value_unlocked(qio_channel_t* restrict ch)
   }
 }
 
+// Returns the first '"' or '\\' in [p, end), or end if there is none.
+// Checks a word at a time.
+static inline
+const char* _json_find_quote_or_backslash(const char* p, const char* end)
+{
+  const uint64_t ones = UINT64_C(0x0101010101010101);
+  const uint64_t highs = UINT64_C(0x8080808080808080);
+
+  while( end - p >= 8 ) {
+    uint64_t w, q, b;
+    memcpy(&w, p, sizeof(w));
+    q = w ^ (ones * '"');
+    b = w ^ (ones * '\\');
+    // Is any byte of q or b zero?
+    if( (((q - ones) & ~q) | ((b - ones) & ~b)) & highs ) break;
+    p += 8;
+  }
+  while( p < end && *p != '"' && *p != '\\' ) p++;
+  return p;
+}
+
 // Read and skip an arbitrary JSON string, assuming the leading "
 // has already been read. Returns 0 on success, or a negative
 // error code.
@@ -2353,6 +2508,13 @@ int32_t qio_skip_json_string_unlocked(qio_channel_t* restrict ch)
   int32_t c;
 
   while( true ) {
+    // Pass over buffered characters other than " and \ in bulk.
+    if( qio_space_in_ptr_diff(1, ch->cached_end, ch->cached_cur) ) {
+      ch->cached_cur = (void*) _json_find_quote_or_backslash(
+                                 (const char*) ch->cached_cur,
+                                 (const char*) ch->cached_end);
+    }
+
     c = qio_channel_read_byte(false, ch);
     if( c < 0 ) return c;
 
@@ -2721,6 +2883,127 @@ error:
   return err;
 }
 
+// Fast paths for plain decimal numbers that lie entirely within the
+// channel's buffer.  They parse in place and return false, consuming
+// nothing, on anything else (other bases, inf/nan, too many digits, a
+// number running into the end of the buffer, ...), in which case the
+// caller falls back on _peek_number_unlocked and strtoull/strtod.  The
+// digit parsing itself is in qio_number_fast.h, shared with chplcast.c.
+
+static inline
+unsigned char _fast_lower(unsigned char c)
+{
+  return ('A' <= c && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+// Could c follow a number without _peek_number_unlocked reading further
+// or reporting an error?
+static inline
+int _fast_number_ends(unsigned char c, char point_char)
+{
+  if( c >= 0x80 ) return 0; // might be an encoding error
+  if( ('0' <= c && c <= '9') ||
+      ('a' <= _fast_lower(c) && _fast_lower(c) <= 'z') ) return 0;
+  return c != (unsigned char) point_char;
+}
+
+static
+bool _scan_int_fast(qio_channel_t* restrict ch, const number_reading_state_t* restrict st, int issigned, unsigned long long int* restrict num_out, int* restrict sign_out)
+{
+  const unsigned char* p = (const unsigned char*) ch->cached_cur;
+  const unsigned char* end = (const unsigned char*) ch->cached_end;
+  uint64_t num = 0;
+  int sign = 1;
+  size_t ndigits;
+
+  if( st->base != 0 && st->base != 10 ) return false;
+
+  while( p < end && _fast_is_space(*p) ) p++;
+  if( p == end || *p >= 0x80 ) return false;
+
+  if( _fast_lower(*p) == (unsigned char) st->positive_char ) {
+    p++;
+  } else if( _fast_lower(*p) == (unsigned char) st->negative_char ) {
+    if( ! issigned ) return false;
+    sign = -1;
+    p++;
+  }
+
+  ndigits = _fast_parse_digits(p, end, &num);
+  if( ndigits == 0 || ndigits > 19 ) return false;
+  p += ndigits;
+  if( p == end || ! _fast_number_ends(*p, st->point_char) ) return false;
+
+  ch->cached_cur = (void*) p;
+  *num_out = num;
+  *sign_out = sign;
+  return true;
+}
+
+static
+bool _scan_float_fast(qio_channel_t* restrict ch, const number_reading_state_t* restrict st, double* restrict num_out)
+{
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+  const unsigned char* p = (const unsigned char*) ch->cached_cur;
+  const unsigned char* end = (const unsigned char*) ch->cached_end;
+  uint64_t mantissa = 0;
+  int64_t exp10 = 0;
+  size_t nint;
+  size_t nfrac = 0;
+  bool neg = false;
+  double num;
+
+  if( st->base != 0 && st->base != 10 ) return false;
+
+  while( p < end && _fast_is_space(*p) ) p++;
+  if( p == end || *p >= 0x80 ) return false;
+
+  if( _fast_lower(*p) == (unsigned char) st->positive_char ) {
+    p++;
+  } else if( _fast_lower(*p) == (unsigned char) st->negative_char ) {
+    neg = true;
+    p++;
+  }
+
+  nint = _fast_parse_digits(p, end, &mantissa);
+  p += nint;
+  if( p < end && _fast_lower(*p) == (unsigned char) st->point_char ) {
+    p++;
+    nfrac = _fast_parse_digits(p, end, &mantissa);
+    p += nfrac;
+  }
+  if( nint + nfrac == 0 || nint + nfrac > 19 ) return false;
+
+  if( p < end && _fast_lower(*p) == (unsigned char) st->exponent_char ) {
+    uint64_t e = 0;
+    bool eneg = false;
+    size_t ne;
+
+    p++;
+    if( p < end && _fast_lower(*p) == (unsigned char) st->negative_char ) {
+      eneg = true;
+      p++;
+    } else if( p < end &&
+               _fast_lower(*p) == (unsigned char) st->positive_char ) {
+      p++;
+    }
+    ne = _fast_parse_digits(p, end, &e);
+    if( ne == 0 || ne > 4 ) return false;
+    p += ne;
+    exp10 = eneg ? -(int64_t) e : (int64_t) e;
+  }
+  if( p == end || ! _fast_number_ends(*p, st->point_char) ) return false;
+
+  if( ! _fast_scale_pow10(mantissa, exp10 - (int64_t) nfrac, &num) )
+    return false;
+
+  ch->cached_cur = (void*) p;
+  *num_out = neg ? -num : num;
+  return true;
+#else
+  return false;
+#endif
+}
 
 qioerr qio_channel_scan_int(const int threadsafe, qio_channel_t* restrict ch, void* restrict out, size_t len, int issigned)
 {
@@ -2760,6 +3043,11 @@ qioerr qio_channel_scan_int(const int threadsafe, qio_channel_t* restrict ch, vo
   st.positive_char = tolower(style->positive_char);
   st.negative_char = tolower(style->negative_char);
 
+  if( _scan_int_fast(ch, &st, issigned, &num, &sign) ) {
+    err = 0;
+    goto error; // just store the number
+  }
+
   err = _peek_number_unlocked(ch, &st, &amount);
   if( qio_err_to_int(err) == EEOF && st.end > 0 ) err = 0; // we tolerate EOF if there's data.
   if( err ) goto error;
@@ -2922,6 +3210,11 @@ qioerr qio_channel_scan_float_or_imag(const int threadsafe, qio_channel_t* restr
   st.allow_i_after = needs_i;
   st.i_char = style->i_char;
 
+  if( ! needs_i && _scan_float_fast(ch, &st, &num) ) {
+    err = 0;
+    goto error; // just store the number
+  }
+
   err = _peek_number_unlocked(ch, &st, &amount);
   if( qio_err_to_int(err) == EEOF && st.end > 0 ) err = 0; // we tolerate EOF if there's data.
   if( err ) goto error;
@@ -3062,6 +3355,38 @@ qioerr qio_channel_scan_imag(const int threadsafe, qio_channel_t* restrict ch, v
   return qio_channel_scan_float_or_imag(false, ch, out, len, true);
 }
 
+static const char _two_digits[201] =
+  "00010203040506070809"
+  "10111213141516171819"
+  "20212223242526272829"
+  "30313233343536373839"
+  "40414243444546474849"
+  "50515253545556575859"
+  "60616263646566676869"
+  "70717273747576777879"
+  "80818283848586878889"
+  "90919293949596979899";
+
+// _ltoa_convert for base 10, two digits per division.
+static inline int _ltoa_convert_dec(char *tmp, int tmplen, uint64_t num)
+{
+  int at = tmplen-1;
+  tmp[at] = '\0';
+  while( num >= 100 ) {
+    int r = (num % 100) * 2;
+    num /= 100;
+    tmp[--at] = _two_digits[r+1];
+    tmp[--at] = _two_digits[r];
+  }
+  if( num >= 10 ) {
+    tmp[--at] = _two_digits[num*2+1];
+    tmp[--at] = _two_digits[num*2];
+  } else {
+    tmp[--at] = '0' + num;
+  }
+  return at;
+}
+
 // core of ltoa for arbitrary base.
 // Fills in tmp from right to left
 // Returns the number of positions in tmp to skip to get to number.
@@ -3113,7 +3438,7 @@ int _ltoa(char* restrict dst, size_t size, uint64_t num, int isnegative,
   else if( base == 8 )
     tmp_skip = _ltoa_convert(tmp, sizeof(tmp), num, 8, 0);
   else if( base == 10 )
-    tmp_skip = _ltoa_convert(tmp, sizeof(tmp), num, 10, 0);
+    tmp_skip = _ltoa_convert_dec(tmp, sizeof(tmp), num);
   else if( base == 16 )
     tmp_skip = _ltoa_convert(tmp, sizeof(tmp), num, 16, style->uppercase);
   else
@@ -3248,6 +3573,271 @@ static int _find_prec(char *buf, int len){
   return last_dig;
 }
 
+// Shortest round-trip digits for doubles, using Grisu2 (Loitsch,
+// "Printing Floating-Point Numbers Quickly and Accurately with
+// Integers", PLDI 2010).  The digits always read back as the same
+// double, and are the shortest such digits in nearly all cases.
+
+typedef struct {
+  uint64_t f;
+  int e;
+} _diy_fp_t;
+
+// Normalized 10^k for k = -348, -340, ..., 340.
+static const _diy_fp_t _cached_pow10[] = {
+  { UINT64_C(0xfa8fd5a0081c0288), -1220 }, { UINT64_C(0xbaaee17fa23ebf76), -1193 },
+  { UINT64_C(0x8b16fb203055ac76), -1166 }, { UINT64_C(0xcf42894a5dce35ea), -1140 },
+  { UINT64_C(0x9a6bb0aa55653b2d), -1113 }, { UINT64_C(0xe61acf033d1a45df), -1087 },
+  { UINT64_C(0xab70fe17c79ac6ca), -1060 }, { UINT64_C(0xff77b1fcbebcdc4f), -1034 },
+  { UINT64_C(0xbe5691ef416bd60c), -1007 }, { UINT64_C(0x8dd01fad907ffc3c),  -980 },
+  { UINT64_C(0xd3515c2831559a83),  -954 }, { UINT64_C(0x9d71ac8fada6c9b5),  -927 },
+  { UINT64_C(0xea9c227723ee8bcb),  -901 }, { UINT64_C(0xaecc49914078536d),  -874 },
+  { UINT64_C(0x823c12795db6ce57),  -847 }, { UINT64_C(0xc21094364dfb5637),  -821 },
+  { UINT64_C(0x9096ea6f3848984f),  -794 }, { UINT64_C(0xd77485cb25823ac7),  -768 },
+  { UINT64_C(0xa086cfcd97bf97f4),  -741 }, { UINT64_C(0xef340a98172aace5),  -715 },
+  { UINT64_C(0xb23867fb2a35b28e),  -688 }, { UINT64_C(0x84c8d4dfd2c63f3b),  -661 },
+  { UINT64_C(0xc5dd44271ad3cdba),  -635 }, { UINT64_C(0x936b9fcebb25c996),  -608 },
+  { UINT64_C(0xdbac6c247d62a584),  -582 }, { UINT64_C(0xa3ab66580d5fdaf6),  -555 },
+  { UINT64_C(0xf3e2f893dec3f126),  -529 }, { UINT64_C(0xb5b5ada8aaff80b8),  -502 },
+  { UINT64_C(0x87625f056c7c4a8b),  -475 }, { UINT64_C(0xc9bcff6034c13053),  -449 },
+  { UINT64_C(0x964e858c91ba2655),  -422 }, { UINT64_C(0xdff9772470297ebd),  -396 },
+  { UINT64_C(0xa6dfbd9fb8e5b88f),  -369 }, { UINT64_C(0xf8a95fcf88747d94),  -343 },
+  { UINT64_C(0xb94470938fa89bcf),  -316 }, { UINT64_C(0x8a08f0f8bf0f156b),  -289 },
+  { UINT64_C(0xcdb02555653131b6),  -263 }, { UINT64_C(0x993fe2c6d07b7fac),  -236 },
+  { UINT64_C(0xe45c10c42a2b3b06),  -210 }, { UINT64_C(0xaa242499697392d3),  -183 },
+  { UINT64_C(0xfd87b5f28300ca0e),  -157 }, { UINT64_C(0xbce5086492111aeb),  -130 },
+  { UINT64_C(0x8cbccc096f5088cc),  -103 }, { UINT64_C(0xd1b71758e219652c),   -77 },
+  { UINT64_C(0x9c40000000000000),   -50 }, { UINT64_C(0xe8d4a51000000000),   -24 },
+  { UINT64_C(0xad78ebc5ac620000),     3 }, { UINT64_C(0x813f3978f8940984),    30 },
+  { UINT64_C(0xc097ce7bc90715b3),    56 }, { UINT64_C(0x8f7e32ce7bea5c70),    83 },
+  { UINT64_C(0xd5d238a4abe98068),   109 }, { UINT64_C(0x9f4f2726179a2245),   136 },
+  { UINT64_C(0xed63a231d4c4fb27),   162 }, { UINT64_C(0xb0de65388cc8ada8),   189 },
+  { UINT64_C(0x83c7088e1aab65db),   216 }, { UINT64_C(0xc45d1df942711d9a),   242 },
+  { UINT64_C(0x924d692ca61be758),   269 }, { UINT64_C(0xda01ee641a708dea),   295 },
+  { UINT64_C(0xa26da3999aef774a),   322 }, { UINT64_C(0xf209787bb47d6b85),   348 },
+  { UINT64_C(0xb454e4a179dd1877),   375 }, { UINT64_C(0x865b86925b9bc5c2),   402 },
+  { UINT64_C(0xc83553c5c8965d3d),   428 }, { UINT64_C(0x952ab45cfa97a0b3),   455 },
+  { UINT64_C(0xde469fbd99a05fe3),   481 }, { UINT64_C(0xa59bc234db398c25),   508 },
+  { UINT64_C(0xf6c69a72a3989f5c),   534 }, { UINT64_C(0xb7dcbf5354e9bece),   561 },
+  { UINT64_C(0x88fcf317f22241e2),   588 }, { UINT64_C(0xcc20ce9bd35c78a5),   614 },
+  { UINT64_C(0x98165af37b2153df),   641 }, { UINT64_C(0xe2a0b5dc971f303a),   667 },
+  { UINT64_C(0xa8d9d1535ce3b396),   694 }, { UINT64_C(0xfb9b7cd9a4a7443c),   720 },
+  { UINT64_C(0xbb764c4ca7a44410),   747 }, { UINT64_C(0x8bab8eefb6409c1a),   774 },
+  { UINT64_C(0xd01fef10a657842c),   800 }, { UINT64_C(0x9b10a4e5e9913129),   827 },
+  { UINT64_C(0xe7109bfba19c0c9d),   853 }, { UINT64_C(0xac2820d9623bf429),   880 },
+  { UINT64_C(0x80444b5e7aa7cf85),   907 }, { UINT64_C(0xbf21e44003acdd2d),   933 },
+  { UINT64_C(0x8e679c2f5e44ff8f),   960 }, { UINT64_C(0xd433179d9c8cb841),   986 },
+  { UINT64_C(0x9e19db92b4e31ba9),  1013 }, { UINT64_C(0xeb96bf6ebadf77d9),  1039 },
+  { UINT64_C(0xaf87023b9bf0ee6b),  1066 },
+};
+
+static const uint64_t _pow10_u64[] = {
+  UINT64_C(1), UINT64_C(10), UINT64_C(100), UINT64_C(1000),
+  UINT64_C(10000), UINT64_C(100000), UINT64_C(1000000),
+  UINT64_C(10000000), UINT64_C(100000000), UINT64_C(1000000000),
+  UINT64_C(10000000000), UINT64_C(100000000000),
+  UINT64_C(1000000000000), UINT64_C(10000000000000),
+  UINT64_C(100000000000000), UINT64_C(1000000000000000),
+  UINT64_C(10000000000000000), UINT64_C(100000000000000000),
+  UINT64_C(1000000000000000000), UINT64_C(10000000000000000000)
+};
+
+#define DP_SIGNIFICAND_BITS 52
+#define DP_HIDDEN_BIT (UINT64_C(1) << DP_SIGNIFICAND_BITS)
+
+// Rounded upper 64 bits of the product.
+static inline _diy_fp_t _diy_fp_mul(_diy_fp_t x, _diy_fp_t y)
+{
+  const uint64_t m32 = UINT64_C(0xFFFFFFFF);
+  uint64_t a = x.f >> 32, b = x.f & m32;
+  uint64_t c = y.f >> 32, d = y.f & m32;
+  uint64_t ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+  uint64_t tmp = (bd >> 32) + (ad & m32) + (bc & m32);
+  _diy_fp_t r;
+  tmp += UINT64_C(1) << 31;
+  r.f = ac + (ad >> 32) + (bc >> 32) + (tmp >> 32);
+  r.e = x.e + y.e + 64;
+  return r;
+}
+
+static inline _diy_fp_t _diy_fp_normalize(_diy_fp_t x)
+{
+  while( !(x.f & (UINT64_C(1) << 63)) ) {
+    x.f <<= 1;
+    x.e--;
+  }
+  return x;
+}
+
+static inline void _grisu_round(char* digits, int len, uint64_t delta,
+                                uint64_t rest, uint64_t ten_kappa,
+                                uint64_t wp_w)
+{
+  while( rest < wp_w && delta - rest >= ten_kappa &&
+         (rest + ten_kappa < wp_w ||
+          wp_w - rest > rest + ten_kappa - wp_w) ) {
+    digits[len - 1]--;
+    rest += ten_kappa;
+  }
+}
+
+// Generates the digits of Mp, stopping once they're within delta of it.
+static void _grisu_digit_gen(_diy_fp_t w, _diy_fp_t mp, uint64_t delta,
+                             char* digits, int* len, int* k)
+{
+  _diy_fp_t one;
+  uint64_t wp_w = mp.f - w.f;
+  uint32_t p1;
+  uint64_t p2;
+  int kappa;
+
+  one.f = UINT64_C(1) << -mp.e;
+  one.e = mp.e;
+  p1 = (uint32_t) (mp.f >> -one.e);
+  p2 = mp.f & (one.f - 1);
+
+  kappa = 1;
+  while( kappa < 10 && p1 >= _pow10_u64[kappa] ) kappa++;
+
+  *len = 0;
+  while( kappa > 0 ) {
+    uint32_t d = p1 / _pow10_u64[kappa-1];
+    uint64_t tmp;
+    p1 %= _pow10_u64[kappa-1];
+    if( d || *len ) digits[(*len)++] = '0' + d;
+    kappa--;
+    tmp = ((uint64_t) p1 << -one.e) + p2;
+    if( tmp <= delta ) {
+      *k += kappa;
+      _grisu_round(digits, *len, delta, tmp,
+                   _pow10_u64[kappa] << -one.e, wp_w);
+      return;
+    }
+  }
+
+  while( 1 ) {
+    char d;
+    p2 *= 10;
+    delta *= 10;
+    d = (char) (p2 >> -one.e);
+    if( d || *len ) digits[(*len)++] = '0' + d;
+    p2 &= one.f - 1;
+    kappa--;
+    if( p2 < delta ) {
+      *k += kappa;
+      _grisu_round(digits, *len, delta, p2, one.f,
+                   wp_w * (-kappa < 20 ? _pow10_u64[-kappa] : 0));
+      return;
+    }
+  }
+}
+
+// num must be finite and > 0.  Stores at most 18 digits in digits;
+// num is about digits * 10^(*k).
+static void _grisu2(double num, char* digits, int* len, int* k)
+{
+  uint64_t bits;
+  int biased_e;
+  _diy_fp_t v, plus, minus, c_mk, w, wp, wm;
+  double dk;
+  int ck;
+  int index;
+
+  memcpy(&bits, &num, sizeof(bits));
+  biased_e = (int) ((bits >> DP_SIGNIFICAND_BITS) & 0x7FF);
+  v.f = bits & (DP_HIDDEN_BIT - 1);
+  if( biased_e ) {
+    v.f += DP_HIDDEN_BIT;
+    v.e = biased_e - 1075;
+  } else {
+    v.e = -1074;
+  }
+
+  // The boundaries halfway to the neighboring doubles.
+  plus.f = (v.f << 1) + 1;
+  plus.e = v.e - 1;
+  while( !(plus.f & (DP_HIDDEN_BIT << 1)) ) {
+    plus.f <<= 1;
+    plus.e--;
+  }
+  plus.f <<= 64 - DP_SIGNIFICAND_BITS - 2;
+  plus.e -= 64 - DP_SIGNIFICAND_BITS - 2;
+  if( v.f == DP_HIDDEN_BIT ) {
+    minus.f = (v.f << 2) - 1;
+    minus.e = v.e - 2;
+  } else {
+    minus.f = (v.f << 1) - 1;
+    minus.e = v.e - 1;
+  }
+  minus.f <<= minus.e - plus.e;
+  minus.e = plus.e;
+
+  // Pick a cached power putting the scaled exponent in [-60, -32].
+  dk = (-61 - plus.e) * 0.30102999566398114 + 347;
+  ck = (int) dk;
+  if( dk - ck > 0.0 ) ck++;
+  index = (ck >> 3) + 1;
+  *k = -(-348 + index * 8);
+  c_mk = _cached_pow10[index];
+
+  w = _diy_fp_mul(_diy_fp_normalize(v), c_mk);
+  wp = _diy_fp_mul(plus, c_mk);
+  wm = _diy_fp_mul(minus, c_mk);
+  wm.f++;
+  wp.f--;
+  _grisu_digit_gen(w, wp, wp.f - wm.f, digits, len, k);
+}
+
+// Lays out len digits, meaning digits * 10^k, the way %g would: fixed
+// notation if the decimal exponent is in [-4, max_fixed_exp) and
+// exponential otherwise, with no trailing zeros after a point.
+// out must have room for 32 bytes.  Returns the number of bytes used.
+static int _ftoa_layout_digits(char* out, const char* digits, int len,
+                               int k, int max_fixed_exp, int uppercase)
+{
+  int exp10 = len + k - 1;
+  int n = 0;
+  int i;
+
+  if( -4 <= exp10 && exp10 < max_fixed_exp ) {
+    if( exp10 < 0 ) {
+      out[n++] = '0';
+      out[n++] = '.';
+      for( i = exp10 + 1; i < 0; i++ ) out[n++] = '0';
+      memcpy(out + n, digits, len);
+      n += len;
+    } else if( len <= exp10 + 1 ) {
+      memcpy(out + n, digits, len);
+      n += len;
+      for( i = len; i <= exp10; i++ ) out[n++] = '0';
+    } else {
+      memcpy(out + n, digits, exp10 + 1);
+      n += exp10 + 1;
+      out[n++] = '.';
+      memcpy(out + n, digits + exp10 + 1, len - exp10 - 1);
+      n += len - exp10 - 1;
+    }
+  } else {
+    int ex = exp10 < 0 ? -exp10 : exp10;
+    out[n++] = digits[0];
+    if( len > 1 ) {
+      out[n++] = '.';
+      memcpy(out + n, digits + 1, len - 1);
+      n += len - 1;
+    }
+    out[n++] = uppercase ? 'E' : 'e';
+    out[n++] = exp10 < 0 ? '-' : '+';
+    if( ex >= 100 ) {
+      out[n++] = '0' + ex / 100;
+      ex %= 100;
+    }
+    out[n++] = _two_digits[ex*2];
+    out[n++] = _two_digits[ex*2+1];
+  }
+
+  return n;
+}
+
 // Converts num to a string in buf, returns the number
 // of bytes that would be used if space permits (not including null)
 // or -1 on error
@@ -3262,7 +3852,7 @@ static int _find_prec(char *buf, int len){
 // num is the number to be converted
 // buf and buf_sz are the output buffer
 // base is the numeric base (10 or 16 only)
-// realfmt is style->realfmt; 0->%g, 1->%f, 2->%e
+// realfmt is style->realfmt; 0->%g, 1->%f, 2->%e, 3->shortest round-trip
 // precision is the number of digits after . for %f or %e or
 //   the number of significant digits
 // uppercase indicates hex digits or exponent character should be uppercase
@@ -3295,6 +3885,41 @@ int _ftoa_core(char* buf, size_t buf_sz, double num,
 
   *skip = 0;
 
+  // Lay out the shortest round-trip digits ourselves for realfmt 3, and
+  // for default %g when they'd be what %g prints anyway.  For a normal
+  // double, digits that read back as num with at most 6 significant
+  // digits lie within half an ulp of it, so they're its correct
+  // rounding to 6 digits.  %g regardless prints 6-digit integer parts
+  // as exponents (see below), so fixed notation stops at 10^5.  (%G
+  // keeps the snprintf path, whose _find_prec trimming differs.)
+  if( base == 10 && isfinite(num) && num >= 0 &&
+      (realfmt == 3 || (realfmt == 0 && precision < 0 && !uppercase)) ) {
+    char digits[32];
+    char tmp[32];
+    int len = 1;
+    int k = 0;
+
+    digits[0] = '0';
+    if( num > 0 ) _grisu2(num, digits, &len, &k);
+
+    if( realfmt == 3 || num == 0 || (num >= DBL_MIN && len <= 6) ) {
+      got = _ftoa_layout_digits(tmp, digits, len, k,
+                                (realfmt == 3) ? 17 : 5, uppercase);
+      if( buf_sz > 0 ) {
+        size_t n = ((size_t) got < buf_sz) ? (size_t) got : buf_sz - 1;
+        memcpy(buf, tmp, n);
+        buf[n] = '\0';
+      }
+      return got;
+    }
+  }
+
+  // Anything else realfmt 3 gets, e.g. inf or nan, is printed like %g.
+  if( realfmt == 3 ) {
+    realfmt = 0;
+    precision = -1;
+  }
+
   if( base == 16 ) {
     if( precision < 0 ) {
       if( uppercase ) {
@@ -4046,6 +4671,22 @@ qioerr qio_channel_skip_past_newline(const int threadsafe, qio_channel_t* restri
   }
 
   while( 1 ) {
+    // Skip buffered ASCII with memchr.  Stop at anything else so that
+    // qio_channel_read_char still reports bad encodings.
+    if( ! skipOnlyWs &&
+        qio_space_in_ptr_diff(1, ch->cached_end, ch->cached_cur) ) {
+      size_t n = chpl_enc_ascii_prefix_len(ch->cached_cur,
+                                           qio_ptr_diff(ch->cached_end,
+                                                        ch->cached_cur));
+      void* nl = memchr(ch->cached_cur, '\n', n);
+      if( nl ) {
+        ch->cached_cur = qio_ptr_add(nl, 1);
+        c = '\n';
+        err = 0;
+        break;
+      }
+      ch->cached_cur = qio_ptr_add(ch->cached_cur, n);
+    }
     lastpos = qio_channel_offset_unlocked(ch);
     err = qio_channel_read_char(threadsafe, ch, &c);
     if( err  || c == '\n' ) break;
@@ -4466,6 +5107,35 @@ static qioerr qio_channel_read_chars_impl(qio_channel_t* restrict ch, char* rest
   ssize_t codepoint_sz = 0;
 
   while (nBytes < maxBytes && nCodepoints < maxCodepoints) {
+    // copy runs of ASCII and whole valid sequences out of ch->cached
+    // in bulk; anything else is left to the byte-at-a-time loop below
+    // so that errors are reported the same way.
+    while (state == 0 && nBytes < maxBytes && nCodepoints < maxCodepoints &&
+           qio_space_in_ptr_diff(1, ch->cached_end, ch->cached_cur)) {
+      ssize_t avail = qio_ptr_diff(ch->cached_end, ch->cached_cur);
+      ssize_t room = avail;
+      ssize_t n;
+      int seqlen;
+
+      if (room > maxBytes - nBytes) room = maxBytes - nBytes;
+      if (room > maxCodepoints - nCodepoints)
+        room = maxCodepoints - nCodepoints;
+
+      n = chpl_enc_ascii_prefix_len(ch->cached_cur, room);
+      memcpy(buf + nBytes, ch->cached_cur, n);
+      ch->cached_cur = qio_ptr_add(ch->cached_cur, n);
+      nBytes += n;
+      nCodepoints += n;
+      if (n == room) continue;
+
+      seqlen = chpl_enc_utf8_seq_len(ch->cached_cur, avail - n, false);
+      if (seqlen == 0 || nBytes + seqlen > maxBytes) break;
+      memcpy(buf + nBytes, ch->cached_cur, seqlen);
+      ch->cached_cur = qio_ptr_add(ch->cached_cur, seqlen);
+      nBytes += seqlen;
+      nCodepoints++;
+    }
+
     // decode as many full codepoints as are present in ch->cached
     while (nBytes+4 <= maxBytes && nCodepoints < maxCodepoints &&
            qio_space_in_ptr_diff(4, ch->cached_end, ch->cached_cur)) {
@@ -5208,6 +5878,152 @@ done:
   return err;
 }
 
+static
+void _qio_conv_prog_free(qio_conv_prog_t* prog)
+{
+  int64_t k;
+
+  for( k = 0; k < prog->num_convs; k++ ) {
+    qio_conv_destroy(&prog->convs[k]);
+  }
+  qio_free(prog->convs);
+  qio_free(prog->styles);
+  qio_free(prog->ends);
+  qio_free(prog->fmt);
+  DO_DESTROY_REFCNT(prog);
+  qio_free(prog);
+}
+
+void qio_conv_prog_retain(qio_conv_prog_t* prog)
+{
+  DO_RETAIN(prog);
+}
+
+void qio_conv_prog_release(qio_conv_prog_t* prog)
+{
+  DO_RELEASE(prog, _qio_conv_prog_free);
+}
+
+qioerr qio_conv_compile(c_string fmt, size_t len, int scanning,
+                        qio_conv_prog_t** prog_out)
+{
+  qio_conv_prog_t* prog;
+  int64_t max = 0;
+  size_t i;
+
+  *prog_out = NULL;
+
+  prog = (qio_conv_prog_t*) qio_calloc(1, sizeof(qio_conv_prog_t));
+  if( ! prog ) return QIO_ENOMEM;
+  DO_INIT_REFCNT(prog);
+  prog->key = fmt;
+  prog->fmt_len = len;
+  prog->scanning = scanning;
+
+  prog->fmt = (char*) qio_malloc(len + 1);
+  if( ! prog->fmt ) goto error;
+  memcpy(prog->fmt, fmt, len);
+  prog->fmt[len] = '\0';
+
+  for( i = 0; i < len; ) {
+    uint64_t end = i;
+    qioerr err;
+
+    if( prog->num_convs == max ) {
+      int64_t newmax = max ? 2*max : 8;
+      qio_conv_t* convs;
+      qio_style_t* styles;
+      uint64_t* ends;
+
+      convs = (qio_conv_t*) qio_realloc(prog->convs, newmax*sizeof(qio_conv_t));
+      if( ! convs ) goto error;
+      prog->convs = convs;
+      styles = (qio_style_t*) qio_realloc(prog->styles, newmax*sizeof(qio_style_t));
+      if( ! styles ) goto error;
+      prog->styles = styles;
+      ends = (uint64_t*) qio_realloc(prog->ends, newmax*sizeof(uint64_t));
+      if( ! ends ) goto error;
+      prog->ends = ends;
+      max = newmax;
+    }
+
+    err = qio_conv_parse(prog->fmt, i, &end, scanning,
+                         &prog->convs[prog->num_convs],
+                         &prog->styles[prog->num_convs], 0, 0);
+    prog->ends[prog->num_convs] = end;
+    prog->num_convs++;
+
+    if( err ) {
+      prog->err = err;
+      break;
+    }
+    // qio_conv_parse always makes progress before the NUL,
+    // but a NUL inside the string would stop it.
+    if( end <= i ) break;
+    i = end;
+  }
+
+  *prog_out = prog;
+  return 0;
+
+error:
+  _qio_conv_prog_free(prog);
+  return QIO_ENOMEM;
+}
+
+// The per-thread cache of compiled format strings is direct mapped;
+// a new string simply replaces whatever was in its slot. Each program
+// in it holds a reference for the cache, so one that's evicted while
+// a caller is still using it (possibly on another thread, if the task
+// has moved) lives until the caller releases it.
+#define QIO_CONV_CACHE_SLOTS 64
+
+#ifdef CHPL_TLS
+typedef struct qio_conv_cache_s {
+  qio_conv_prog_t* slots[QIO_CONV_CACHE_SLOTS];
+} qio_conv_cache_t;
+
+static CHPL_TLS_DECL(qio_conv_cache_t, qio_conv_cache);
+#endif
+
+qioerr qio_conv_prog_lookup(c_string fmt, size_t len, int scanning,
+                            qio_conv_prog_t** prog_out)
+{
+#ifdef CHPL_TLS
+  qio_conv_prog_t** slot;
+  qio_conv_prog_t* prog;
+  uint64_t h;
+  qioerr err;
+
+  h = ((uint64_t)(uintptr_t) fmt ^ ((uint64_t) len << 1) ^ (scanning != 0)) *
+      UINT64_C(0x9E3779B97F4A7C15);
+  slot = &qio_conv_cache.slots[h >> 58]; // 64 slots
+
+  prog = *slot;
+  if( prog && prog->key == fmt && prog->fmt_len == len &&
+      prog->scanning == scanning && memcmp(prog->fmt, fmt, len) == 0 ) {
+    qio_conv_prog_retain(prog);
+    *prog_out = prog;
+    return 0;
+  }
+
+  err = qio_conv_compile(fmt, len, scanning, &prog);
+  if( err ) {
+    *prog_out = NULL;
+    return err;
+  }
+
+  // one reference for the cache and one for the caller.
+  qio_conv_prog_retain(prog);
+  qio_conv_prog_release(*slot);
+  *slot = prog;
+  *prog_out = prog;
+  return 0;
+#else
+  return qio_conv_compile(fmt, len, scanning, prog_out);
+#endif
+}
+
 qioerr qio_format_error_too_many_args(void)
 {
   qioerr err;
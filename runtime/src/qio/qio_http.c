@@ -0,0 +1,726 @@
+/*
+ * Copyright 2020-2026 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "sys_basic.h"
+
+#ifndef CHPL_RT_UNIT_TEST
+#include "chplrt.h"
+#include "chpl-env.h"
+#endif
+
+#include "qio_http.h"
+#include "qio_plugin_api.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <string.h>
+
+#ifdef QIO_HAS_CURL
+#include <curl/curl.h>
+#endif
+
+int64_t qio_http_block_size = 4*1024*1024;
+int qio_http_parallel = -1;
+int64_t qio_http_cache_size = -1;
+
+#ifdef QIO_HAS_CURL
+
+// One block of an object, in the shared cache or on its way there.
+typedef struct qio_http_block_s {
+  uint64_t file_id;
+  int64_t index;
+  char* data;
+  int64_t len;
+  int users; // channels holding on to it; it stays cached while > 0
+  struct qio_http_block_s* hash_next;
+  struct qio_http_block_s* lru_prev; // more recently used
+  struct qio_http_block_s* lru_next; // less recently used
+} qio_http_block_t;
+
+typedef struct qio_http_file_s {
+  char* url;
+  int64_t length;
+  int64_t block_size;
+  uint64_t id; // names this object's blocks in the cache
+} qio_http_file_t;
+
+// A channel's window of blocks: ones being fetched, and ones it has
+// and hasn't gotten past yet.
+typedef struct qio_http_slot_s {
+  int used;
+  int64_t index;
+  CURL* easy;               // non-NULL while the request is running
+  qio_http_block_t* block;  // being filled, or done and held
+  int64_t got;
+  qioerr err;               // set if the request failed
+  char range[64];
+} qio_http_slot_t;
+
+typedef struct qio_http_channel_s {
+  qio_http_file_t* file;
+  qio_channel_t* ch;
+  CURLM* multi;
+  int nslots;
+  qio_http_slot_t* slots;
+} qio_http_channel_t;
+
+#define QIO_HTTP_HASH_SIZE 1024
+
+static pthread_mutex_t qio_http_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static qio_http_block_t* qio_http_hash[QIO_HTTP_HASH_SIZE];
+static qio_http_block_t* qio_http_lru_head;
+static qio_http_block_t* qio_http_lru_tail;
+static int64_t qio_http_cached_bytes;
+static uint64_t qio_http_next_file_id = 1;
+
+static pthread_once_t qio_http_curl_once = PTHREAD_ONCE_INIT;
+static CURLcode qio_http_curl_init_result;
+
+static
+void _qio_http_curl_init(void)
+{
+  qio_http_curl_init_result = curl_global_init(CURL_GLOBAL_DEFAULT);
+}
+
+static
+int qio_http_get_parallel(void)
+{
+  if( qio_http_parallel < 0 ) {
+#ifndef CHPL_RT_UNIT_TEST
+    qio_http_parallel = chpl_env_rt_get_int("QIO_HTTP_PARALLEL", 8);
+#else
+    qio_http_parallel = 8;
+#endif
+    if( qio_http_parallel < 1 ) qio_http_parallel = 1;
+  }
+  return qio_http_parallel;
+}
+
+// call with the cache lock held
+static
+int64_t qio_http_get_cache_size(void)
+{
+  if( qio_http_cache_size < 0 ) {
+#ifndef CHPL_RT_UNIT_TEST
+    qio_http_cache_size = chpl_env_rt_get_size("QIO_HTTP_CACHE_SIZE",
+                                               256*1024*1024);
+#else
+    qio_http_cache_size = 256*1024*1024;
+#endif
+  }
+  return qio_http_cache_size;
+}
+
+static
+qio_http_block_t** _qio_http_bucket(uint64_t file_id, int64_t index)
+{
+  uint64_t h = (file_id * UINT64_C(0x9E3779B97F4A7C15)) ^
+               ((uint64_t) index * UINT64_C(0xC2B2AE3D27D4EB4F));
+  return &qio_http_hash[(h >> 32) % QIO_HTTP_HASH_SIZE];
+}
+
+static
+void _qio_http_block_free(qio_http_block_t* b)
+{
+  if( !b ) return;
+  qio_free(b->data);
+  qio_free(b);
+}
+
+// The rest of the cache functions need the cache lock held.
+
+static
+void _qio_http_lru_unlink(qio_http_block_t* b)
+{
+  if( b->lru_prev ) b->lru_prev->lru_next = b->lru_next;
+  else qio_http_lru_head = b->lru_next;
+  if( b->lru_next ) b->lru_next->lru_prev = b->lru_prev;
+  else qio_http_lru_tail = b->lru_prev;
+  b->lru_prev = b->lru_next = NULL;
+}
+
+static
+void _qio_http_lru_push(qio_http_block_t* b)
+{
+  b->lru_prev = NULL;
+  b->lru_next = qio_http_lru_head;
+  if( qio_http_lru_head ) qio_http_lru_head->lru_prev = b;
+  else qio_http_lru_tail = b;
+  qio_http_lru_head = b;
+}
+
+static
+void _qio_http_cache_remove(qio_http_block_t* b)
+{
+  qio_http_block_t** p = _qio_http_bucket(b->file_id, b->index);
+  while( *p != b ) p = &(*p)->hash_next;
+  *p = b->hash_next;
+  _qio_http_lru_unlink(b);
+  qio_http_cached_bytes -= b->len;
+}
+
+// Evict unused blocks, least recently used first, until the cache holds
+// no more than limit bytes or everything left is in use.
+static
+void _qio_http_cache_evict(int64_t limit)
+{
+  qio_http_block_t* b = qio_http_lru_tail;
+  while( b && qio_http_cached_bytes > limit ) {
+    qio_http_block_t* prev = b->lru_prev;
+    if( b->users == 0 ) {
+      _qio_http_cache_remove(b);
+      _qio_http_block_free(b);
+    }
+    b = prev;
+  }
+}
+
+static
+qio_http_block_t* _qio_http_cache_find(uint64_t file_id, int64_t index)
+{
+  qio_http_block_t* b = *_qio_http_bucket(file_id, index);
+  while( b && (b->file_id != file_id || b->index != index) ) b = b->hash_next;
+  return b;
+}
+
+// Returns the cached block, which the caller must release, or NULL.
+static
+qio_http_block_t* qio_http_cache_get(uint64_t file_id, int64_t index)
+{
+  qio_http_block_t* b;
+
+  pthread_mutex_lock(&qio_http_cache_lock);
+  b = _qio_http_cache_find(file_id, index);
+  if( b ) {
+    b->users++;
+    _qio_http_lru_unlink(b);
+    _qio_http_lru_push(b);
+  }
+  pthread_mutex_unlock(&qio_http_cache_lock);
+  return b;
+}
+
+// Add a freshly fetched block, which the caller holds. If another
+// channel got there first, frees b and returns (and holds) that one.
+static
+qio_http_block_t* qio_http_cache_put(qio_http_block_t* b)
+{
+  qio_http_block_t* got;
+
+  pthread_mutex_lock(&qio_http_cache_lock);
+  got = _qio_http_cache_find(b->file_id, b->index);
+  if( got ) {
+    got->users++;
+    _qio_http_lru_unlink(got);
+    _qio_http_lru_push(got);
+  } else {
+    qio_http_block_t** p = _qio_http_bucket(b->file_id, b->index);
+    b->hash_next = *p;
+    *p = b;
+    _qio_http_lru_push(b);
+    b->users = 1;
+    qio_http_cached_bytes += b->len;
+    _qio_http_cache_evict(qio_http_get_cache_size());
+  }
+  pthread_mutex_unlock(&qio_http_cache_lock);
+
+  if( got ) _qio_http_block_free(b);
+  return got ? got : b;
+}
+
+static
+void qio_http_cache_release(qio_http_block_t* b)
+{
+  pthread_mutex_lock(&qio_http_cache_lock);
+  b->users--;
+  if( b->users == 0 ) _qio_http_cache_evict(qio_http_get_cache_size());
+  pthread_mutex_unlock(&qio_http_cache_lock);
+}
+
+// Drop the blocks of a file that is being closed.
+static
+void qio_http_cache_drop_file(uint64_t file_id)
+{
+  qio_http_block_t* b;
+
+  pthread_mutex_lock(&qio_http_cache_lock);
+  b = qio_http_lru_head;
+  while( b ) {
+    qio_http_block_t* next = b->lru_next;
+    if( b->file_id == file_id && b->users == 0 ) {
+      _qio_http_cache_remove(b);
+      _qio_http_block_free(b);
+    }
+    b = next;
+  }
+  pthread_mutex_unlock(&qio_http_cache_lock);
+}
+
+void qio_http_cache_clear(void)
+{
+  pthread_mutex_lock(&qio_http_cache_lock);
+  _qio_http_cache_evict(0);
+  pthread_mutex_unlock(&qio_http_cache_lock);
+}
+
+static
+qioerr _qio_http_status_err(long code)
+{
+  switch (code) {
+    case 401:
+    case 403:
+      QIO_RETURN_CONSTANT_ERROR(EACCES, "HTTP server denied access");
+    case 404:
+    case 410:
+      QIO_RETURN_CONSTANT_ERROR(ENOENT, "HTTP object not found");
+    case 416:
+      QIO_RETURN_CONSTANT_ERROR(EEOF, "HTTP range not satisfiable");
+  }
+  QIO_RETURN_CONSTANT_ERROR(EIO, "HTTP request failed");
+}
+
+static
+void _qio_http_easy_common(CURL* easy, const char* url)
+{
+  curl_easy_setopt(easy, CURLOPT_URL, url);
+  curl_easy_setopt(easy, CURLOPT_FOLLOWLOCATION, 1L);
+  curl_easy_setopt(easy, CURLOPT_NOSIGNAL, 1L);
+}
+
+static
+size_t _qio_http_write_cb(char* data, size_t size, size_t nmemb, void* arg)
+{
+  qio_http_slot_t* s = (qio_http_slot_t*) arg;
+  size_t n = size * nmemb;
+
+  // Stop if the server sends more than we asked for (e.g. the whole
+  // object, because it ignored the range).
+  if( s->got + (int64_t) n > s->block->len ) return 0;
+  memcpy(s->block->data + s->got, data, n);
+  s->got += n;
+  return n;
+}
+
+static
+void _qio_http_slot_clear(qio_http_channel_t* hc, qio_http_slot_t* s)
+{
+  if( s->easy ) {
+    curl_multi_remove_handle(hc->multi, s->easy);
+    curl_easy_cleanup(s->easy);
+    s->easy = NULL;
+    _qio_http_block_free(s->block);
+  } else if( s->block ) {
+    qio_http_cache_release(s->block);
+  }
+  s->block = NULL;
+  s->used = 0;
+  s->err = 0;
+}
+
+static
+qioerr _qio_http_slot_start(qio_http_channel_t* hc, qio_http_slot_t* s,
+                            int64_t index)
+{
+  qio_http_file_t* hf = hc->file;
+  int64_t start = index * hf->block_size;
+  int64_t len = hf->length - start;
+  qio_http_block_t* b;
+
+  if( len > hf->block_size ) len = hf->block_size;
+
+  s->used = 1;
+  s->index = index;
+  s->got = 0;
+  s->err = 0;
+
+  b = qio_http_cache_get(hf->id, index);
+  if( b ) {
+    s->block = b;
+    return 0;
+  }
+
+  b = (qio_http_block_t*) qio_calloc(1, sizeof(qio_http_block_t));
+  if( b ) b->data = (char*) qio_malloc(len);
+  if( !b || !b->data ) {
+    _qio_http_block_free(b);
+    s->used = 0;
+    return QIO_ENOMEM;
+  }
+  b->file_id = hf->id;
+  b->index = index;
+  b->len = len;
+  s->block = b;
+
+  s->easy = curl_easy_init();
+  if( !s->easy ) {
+    _qio_http_slot_clear(hc, s);
+    QIO_RETURN_CONSTANT_ERROR(ENOMEM, "could not create HTTP request");
+  }
+  snprintf(s->range, sizeof(s->range), "%lld-%lld",
+           (long long) start, (long long) (start + len - 1));
+  _qio_http_easy_common(s->easy, hf->url);
+  curl_easy_setopt(s->easy, CURLOPT_RANGE, s->range);
+  curl_easy_setopt(s->easy, CURLOPT_WRITEFUNCTION, _qio_http_write_cb);
+  curl_easy_setopt(s->easy, CURLOPT_WRITEDATA, s);
+  if( curl_multi_add_handle(hc->multi, s->easy) != CURLM_OK ) {
+    _qio_http_slot_clear(hc, s);
+    QIO_RETURN_CONSTANT_ERROR(EIO, "could not start HTTP request");
+  }
+  return 0;
+}
+
+static
+void _qio_http_slot_finished(qio_http_channel_t* hc, qio_http_slot_t* s,
+                             CURLcode result)
+{
+  qio_http_file_t* hf = hc->file;
+  long code = 0;
+  qioerr err = 0;
+
+  curl_easy_getinfo(s->easy, CURLINFO_RESPONSE_CODE, &code);
+
+  if( code >= 400 ) {
+    err = _qio_http_status_err(code);
+  } else if( code == 200 && s->block->len != hf->length ) {
+    QIO_GET_CONSTANT_ERROR(err, ENOTSUP,
+                           "HTTP server does not support range requests");
+  } else if( result != CURLE_OK || (code != 206 && code != 200) ) {
+    QIO_GET_CONSTANT_ERROR(err, EIO, "HTTP request failed");
+  } else if( s->got != s->block->len ) {
+    QIO_GET_CONSTANT_ERROR(err, EIO, "HTTP response was short");
+  }
+
+  curl_multi_remove_handle(hc->multi, s->easy);
+  curl_easy_cleanup(s->easy);
+  s->easy = NULL;
+
+  if( err ) {
+    _qio_http_block_free(s->block);
+    s->block = NULL;
+    s->err = err;
+  } else {
+    s->block = qio_http_cache_put(s->block);
+  }
+}
+
+// Let the running requests make progress without waiting.
+static
+void _qio_http_progress(qio_http_channel_t* hc)
+{
+  int running = 0;
+  int left = 0;
+  CURLMsg* msg;
+
+  curl_multi_perform(hc->multi, &running);
+  while( (msg = curl_multi_info_read(hc->multi, &left)) ) {
+    if( msg->msg == CURLMSG_DONE ) {
+      for( int i = 0; i < hc->nslots; i++ ) {
+        qio_http_slot_t* s = &hc->slots[i];
+        if( s->used && s->easy == msg->easy_handle ) {
+          _qio_http_slot_finished(hc, s, msg->data.result);
+          break;
+        }
+      }
+    }
+  }
+}
+
+static
+qio_http_slot_t* _qio_http_find_slot(qio_http_channel_t* hc, int64_t index)
+{
+  for( int i = 0; i < hc->nslots; i++ ) {
+    if( hc->slots[i].used && hc->slots[i].index == index )
+      return &hc->slots[i];
+  }
+  return NULL;
+}
+
+// Wait until block index is here, starting requests for it and for
+// the blocks after it (up to one per slot) along the way.
+static
+qioerr _qio_http_need_block(qio_http_channel_t* hc, int64_t index,
+                            int64_t end, qio_http_block_t** block_out)
+{
+  qio_http_file_t* hf = hc->file;
+  int64_t last = (end - 1) / hf->block_size;
+  qio_http_slot_t* want;
+  qioerr err = 0;
+
+  // Forget the blocks that we've gotten past (or skipped over).
+  for( int i = 0; i < hc->nslots; i++ ) {
+    qio_http_slot_t* s = &hc->slots[i];
+    if( s->used && (s->index < index || s->index >= index + hc->nslots) )
+      _qio_http_slot_clear(hc, s);
+  }
+
+  for( int64_t k = index; k < index + hc->nslots && k <= last; k++ ) {
+    if( _qio_http_find_slot(hc, k) ) continue;
+    for( int i = 0; i < hc->nslots; i++ ) {
+      if( !hc->slots[i].used ) {
+        err = _qio_http_slot_start(hc, &hc->slots[i], k);
+        break;
+      }
+    }
+    if( err ) break;
+  }
+
+  want = _qio_http_find_slot(hc, index);
+  if( !want ) return err ? err : QIO_ENOMEM;
+
+  while( 1 ) {
+    _qio_http_progress(hc);
+    if( !want->easy ) break;
+    if( curl_multi_poll(hc->multi, NULL, 0, 1000, NULL) != CURLM_OK ) {
+      QIO_RETURN_CONSTANT_ERROR(EIO, "waiting for HTTP requests failed");
+    }
+  }
+
+  if( want->err ) {
+    // Report it, and try again if we're asked for it again.
+    err = want->err;
+    _qio_http_slot_clear(hc, want);
+    return err;
+  }
+
+  *block_out = want->block;
+  return 0;
+}
+
+static
+syserr qio_http_setup_plugin_channel(void* file, void** plugin_ch,
+                                     int64_t start, int64_t end,
+                                     qio_channel_t* qio_ch)
+{
+  qio_http_channel_t* hc;
+
+  if( qio_ch->flags & QIO_FDFLAG_WRITEABLE )
+    QIO_RETURN_CONSTANT_ERROR(EACCES, "HTTP files are read-only");
+
+  hc = (qio_http_channel_t*) qio_calloc(1, sizeof(qio_http_channel_t));
+  if( !hc ) return QIO_ENOMEM;
+  hc->file = (qio_http_file_t*) file;
+  hc->ch = qio_ch;
+  hc->nslots = qio_http_get_parallel();
+  hc->slots = (qio_http_slot_t*) qio_calloc(hc->nslots,
+                                            sizeof(qio_http_slot_t));
+  hc->multi = curl_multi_init();
+  if( !hc->slots || !hc->multi ) {
+    if( hc->multi ) curl_multi_cleanup(hc->multi);
+    qio_free(hc->slots);
+    qio_free(hc);
+    return QIO_ENOMEM;
+  }
+
+  *plugin_ch = hc;
+  return 0;
+}
+
+static
+syserr qio_http_read_atleast(void* plugin_ch, int64_t amt)
+{
+  qio_http_channel_t* hc = (qio_http_channel_t*) plugin_ch;
+  int64_t bs = hc->file->block_size;
+  int64_t end = hc->file->length;
+  int64_t total = 0;
+  qioerr err = 0;
+
+  if( amt <= 0 ) return QIO_EEOF;
+
+  while( total < amt ) {
+    qio_http_block_t* b = NULL;
+    void* ptr = NULL;
+    ssize_t len = 0;
+    int64_t offset = 0;
+    int64_t skip;
+
+    err = qio_channel_get_allocated_ptr_unlocked(hc->ch, amt - total,
+                                                 &ptr, &len, &offset);
+    if( err ) return err;
+    if( offset >= end ) return QIO_EEOF;
+
+    err = _qio_http_need_block(hc, offset / bs, end, &b);
+    if( err ) return err;
+
+    skip = offset - (offset / bs) * bs;
+    if( skip >= b->len ) return QIO_EEOF;
+    if( len > b->len - skip ) len = b->len - skip;
+    memcpy(ptr, b->data + skip, len);
+    qio_channel_advance_available_end_unlocked(hc->ch, len);
+    total += len;
+  }
+
+  return 0;
+}
+
+static
+syserr qio_http_write(void* plugin_ch, int64_t amt)
+{
+  QIO_RETURN_CONSTANT_ERROR(EBADF, "HTTP files are read-only");
+}
+
+static
+syserr qio_http_channel_close(void* plugin_ch)
+{
+  qio_http_channel_t* hc = (qio_http_channel_t*) plugin_ch;
+
+  for( int i = 0; i < hc->nslots; i++ ) {
+    if( hc->slots[i].used ) _qio_http_slot_clear(hc, &hc->slots[i]);
+  }
+  curl_multi_cleanup(hc->multi);
+  qio_free(hc->slots);
+  qio_free(hc);
+  return 0;
+}
+
+static
+syserr qio_http_filelength(void* file, int64_t* length)
+{
+  *length = ((qio_http_file_t*) file)->length;
+  return 0;
+}
+
+static
+syserr qio_http_getpath(void* file, uint8_t** str, int64_t* len)
+{
+  char* path = qio_strdup(((qio_http_file_t*) file)->url);
+  if( !path ) return QIO_ENOMEM;
+  *str = (uint8_t*) path;
+  *len = strlen(path);
+  return 0;
+}
+
+static
+syserr qio_http_fsync(void* file)
+{
+  return 0;
+}
+
+static
+syserr qio_http_get_chunk(void* file, int64_t* length)
+{
+  *length = ((qio_http_file_t*) file)->block_size;
+  return 0;
+}
+
+static
+syserr qio_http_get_locales_for_region(void* file, int64_t start, int64_t end,
+                                       void **localeNamesPtr,
+                                       int64_t* nLocales)
+{
+  *nLocales = 0;
+  QIO_RETURN_CONSTANT_ERROR(ENOSYS, "HTTP files have no locality");
+}
+
+static
+syserr qio_http_file_close(void* file)
+{
+  qio_http_file_t* hf = (qio_http_file_t*) file;
+
+  qio_http_cache_drop_file(hf->id);
+  qio_free(hf->url);
+  qio_free(hf);
+  return 0;
+}
+
+static const qio_plugin_fns_t qio_http_plugin_fns = {
+  qio_http_setup_plugin_channel,
+  qio_http_read_atleast,
+  qio_http_write,
+  qio_http_channel_close,
+  qio_http_filelength,
+  qio_http_getpath,
+  qio_http_fsync,
+  qio_http_get_chunk,
+  qio_http_get_locales_for_region,
+  qio_http_file_close,
+};
+
+qioerr qio_file_open_http(qio_file_t** file_out, const char* url,
+                          const qio_style_t* style)
+{
+  qio_http_file_t* hf;
+  CURL* easy;
+  CURLcode res;
+  long code = 0;
+  curl_off_t length = -1;
+  qioerr err;
+
+  *file_out = NULL;
+
+  pthread_once(&qio_http_curl_once, _qio_http_curl_init);
+  if( qio_http_curl_init_result != CURLE_OK )
+    QIO_RETURN_CONSTANT_ERROR(EIO, "could not initialize libcurl");
+
+  // Ask for the length.
+  easy = curl_easy_init();
+  if( !easy ) QIO_RETURN_CONSTANT_ERROR(ENOMEM, "could not create HTTP request");
+  _qio_http_easy_common(easy, url);
+  curl_easy_setopt(easy, CURLOPT_NOBODY, 1L);
+  res = curl_easy_perform(easy);
+  if( res == CURLE_OK ) {
+    curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &code);
+    curl_easy_getinfo(easy, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &length);
+  }
+  curl_easy_cleanup(easy);
+
+  if( res != CURLE_OK )
+    QIO_RETURN_CONSTANT_ERROR(EIO, "could not reach HTTP server");
+  if( code >= 400 ) return _qio_http_status_err(code);
+  if( length < 0 )
+    QIO_RETURN_CONSTANT_ERROR(ENOTSUP, "HTTP server did not give a length");
+
+  hf = (qio_http_file_t*) qio_calloc(1, sizeof(qio_http_file_t));
+  if( !hf ) return QIO_ENOMEM;
+  hf->url = qio_strdup(url);
+  if( !hf->url ) {
+    qio_free(hf);
+    return QIO_ENOMEM;
+  }
+  hf->length = length;
+  hf->block_size = qio_http_block_size > 0 ? qio_http_block_size : 4*1024*1024;
+  pthread_mutex_lock(&qio_http_cache_lock);
+  hf->id = qio_http_next_file_id++;
+  pthread_mutex_unlock(&qio_http_cache_lock);
+
+  err = qio_file_init_plugin_fns(file_out, hf, &qio_http_plugin_fns,
+                                 QIO_FDFLAG_READABLE | QIO_FDFLAG_SEEKABLE,
+                                 style);
+  if( err ) qio_http_file_close(hf);
+  return err;
+}
+
+#else
+
+void qio_http_cache_clear(void)
+{
+}
+
+qioerr qio_file_open_http(qio_file_t** file_out, const char* url,
+                          const qio_style_t* style)
+{
+  *file_out = NULL;
+  QIO_RETURN_CONSTANT_ERROR(ENOSYS, "not built with HTTP support (libcurl)");
+}
+
+#endif
@@ -18,6 +18,11 @@
  * limitations under the License.
  */
 
+#ifndef _GNU_SOURCE
+// get splice
+#define _GNU_SOURCE
+#endif
+
 #include "sys_basic.h"
 
 #ifndef CHPL_RT_UNIT_TEST
@@ -30,12 +35,18 @@
 
 #include "qio_popen.h"
 
-#include <sys/select.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/wait.h>
+#include <poll.h>
 #include <unistd.h>
 #include <spawn.h>
 
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/syscall.h>
+#endif
+
 #include <pthread.h>
 
 // current environment variables
@@ -390,6 +401,16 @@ qioerr qio_openproc(const char** argv,
 }
 
 
+#if defined(__linux__) && defined(SYS_pidfd_open)
+// A pidfd becomes readable when the process exits, which lets a
+// blocking waitpid wait for it along with everything else.
+#define QIO_HAS_PIDFD 1
+static int qio_pidfd_open(pid_t pid)
+{
+  return (int) syscall(SYS_pidfd_open, pid, 0);
+}
+#endif
+
 // waitpid
 qioerr qio_waitpid(int64_t pid,
                    int blocking, int* done, int* exitcode)
@@ -397,6 +418,9 @@ qioerr qio_waitpid(int64_t pid,
   int status = 0;
   int flags = 0;
   pid_t got;
+#ifdef QIO_HAS_PIDFD
+  int pidfd = -2; // not opened yet
+#endif
 
   flags |= WNOHANG;
 
@@ -409,9 +433,28 @@ qioerr qio_waitpid(int64_t pid,
     if ( ! blocking ) {
       break;
     }
+    if ( got != 0 ) {
+      break;
+    }
+#ifdef QIO_HAS_PIDFD
+    // Without pidfds (older kernels) just keep yielding.
+    if ( pidfd == -2 ) pidfd = qio_pidfd_open((pid_t) pid);
+    if ( pidfd >= 0 ) {
+      struct pollfd p;
+      p.fd = pidfd;
+      p.events = POLLIN;
+      p.revents = 0;
+      (void) chpl_task_waitFds(&p, 1);
+      continue;
+    }
+#endif
     chpl_task_yield();
   } while (got == 0);
 
+#ifdef QIO_HAS_PIDFD
+  if ( pidfd >= 0 ) close(pidfd);
+#endif
+
   // Check for error
   if( got == -1 ) {
     return qio_int_to_err(errno);
@@ -451,8 +494,8 @@ qioerr qio_proc_communicate(
   bool input_ready;
   bool output_ready;
   bool error_ready;
-  fd_set rfds, wfds, efds;
-  int nfds = 1;
+  struct pollfd pfds[3];
+  int nfds;
 
   int input_fd = -1;
   int output_fd = -1;
@@ -497,15 +540,12 @@ qioerr qio_proc_communicate(
 
   if( input ) {
     input_fd = input->file->fd;
-    if( nfds <= input_fd ) nfds = input_fd + 1;
   }
   if( output ) {
     output_fd = output->file->fd;
-    if( nfds <= output_fd ) nfds = output_fd + 1;
   }
   if( error ) {
     error_fd = error->file->fd;
-    if( nfds <= error_fd ) nfds = error_fd + 1;
   }
 
   // Adjust all three pipes to be non-blocking.
@@ -548,52 +588,55 @@ qioerr qio_proc_communicate(
 
   while( do_input || do_output || do_error ) {
 
-    // Now call select to wait for one of the descriptors to
-    // become ready.
-
-    FD_ZERO(&rfds);
-    FD_ZERO(&wfds);
-    FD_ZERO(&efds);
+    // Wait for one of the descriptors to become ready. This lets
+    // other tasks run in the meantime rather than spinning.
+    // Hangups and errors count as ready, so that the read or
+    // write notices them.
 
+    nfds = 0;
     if( do_input && input_fd != -1 ) {
-      FD_SET(input_fd, &wfds);
-      FD_SET(input_fd, &efds);
+      pfds[nfds].fd = input_fd;
+      pfds[nfds].events = POLLOUT;
+      pfds[nfds].revents = 0;
+      nfds++;
     }
     if( do_output && output_fd != -1 ) {
-      FD_SET(output_fd, &rfds);
-      FD_SET(output_fd, &efds);
+      pfds[nfds].fd = output_fd;
+      pfds[nfds].events = POLLIN;
+      pfds[nfds].revents = 0;
+      nfds++;
     }
     if( do_error && error_fd != -1 ) {
-      FD_SET(error_fd, &rfds);
-      FD_SET(error_fd, &efds);
+      pfds[nfds].fd = error_fd;
+      pfds[nfds].events = POLLIN;
+      pfds[nfds].revents = 0;
+      nfds++;
     }
 
     input_ready = false;
     output_ready = false;
     error_ready = false;
 
-    // Run select to wait for something
-    if( do_input || do_output || do_error ) {
-      // TODO -- use sys_select so threading can interact
-      struct timeval t;
-      t.tv_sec = 0;
-      t.tv_usec = 10;
-      rc = select(nfds, &rfds, &wfds, &efds, &t);
-      if (rc > 0) {
-        // read ready file descriptors
-        input_ready = input_fd != -1 && FD_ISSET(input_fd, &wfds);
-        output_ready = output_fd != -1 && FD_ISSET(output_fd, &rfds);
-        error_ready = error_fd != -1 && FD_ISSET(error_fd, &rfds);
-      }
-      // Ignore EAGAIN and EINTR
-      if (rc == EAGAIN || rc == EINTR) rc = 0;
-    }
+    if( nfds == 0 ) break;
 
+    rc = chpl_task_waitFds(pfds, nfds);
     if( rc == -1 ) {
+      if( errno == EAGAIN || errno == EINTR ) continue;
       err = qio_int_to_err(errno);
       break;
     }
 
+    nfds = 0;
+    if( do_input && input_fd != -1 ) {
+      input_ready = pfds[nfds++].revents != 0;
+    }
+    if( do_output && output_fd != -1 ) {
+      output_ready = pfds[nfds++].revents != 0;
+    }
+    if( do_error && error_fd != -1 ) {
+      error_ready = pfds[nfds++].revents != 0;
+    }
+
     if( do_input && input_ready ) {
       err = _qio_channel_flush_qio_unlocked(input);
       if( !err ) {
@@ -641,8 +684,6 @@ qioerr qio_proc_communicate(
       if( qio_err_to_int(err) == EAGAIN ) err = 0;
       if( err ) break;
     }
-
-    chpl_task_yield();
   }
 
   // we could close the file descriptors at this point,
@@ -674,6 +715,156 @@ qioerr qio_proc_communicate(
   return err;
 }
 
+static
+bool qio_fd_is_pipe(int fd)
+{
+  struct stat st;
+  if( fstat(fd, &st) != 0 ) return false;
+  return S_ISFIFO(st.st_mode) || S_ISSOCK(st.st_mode);
+}
+
+// Wait until fd is ready for events, if it's a pipe (anything else is
+// always ready). Returns an error only if the wait itself failed.
+static
+qioerr qio_splice_wait(int fd, bool is_pipe, short events)
+{
+  struct pollfd p;
+
+  if( ! is_pipe ) return 0;
+
+  p.fd = fd;
+  p.events = events;
+  p.revents = 0;
+  if( chpl_task_waitFds(&p, 1) == -1 && errno != EINTR && errno != EAGAIN )
+    return qio_int_to_err(errno);
+  return 0;
+}
+
+qioerr qio_proc_splice(qio_file_t* from, int64_t from_offset,
+                       qio_file_t* to, int64_t to_offset,
+                       int64_t len, int64_t* amt_out)
+{
+  const size_t chunk = 1024*1024;
+  qioerr err = 0;
+  int64_t moved = 0;
+  int from_fd = from ? from->fd : -1;
+  int to_fd = to ? to->fd : -1;
+  bool from_pipe;
+  bool to_pipe;
+  char* buf = NULL;
+  size_t bufsz = 0;
+#ifdef __linux__
+  bool use_splice = true;
+#endif
+
+  *amt_out = 0;
+
+  if( from_fd == -1 || to_fd == -1 )
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "qio_proc_splice needs files with descriptors");
+
+  from_pipe = qio_fd_is_pipe(from_fd);
+  to_pipe = qio_fd_is_pipe(to_fd);
+
+  while( len < 0 || moved < len ) {
+    size_t want = chunk;
+    ssize_t got;
+
+    if( len >= 0 && (uint64_t) (len - moved) < want ) want = len - moved;
+
+#ifdef __linux__
+    if( use_splice ) {
+      loff_t inoff = from_offset + moved;
+      loff_t outoff = to_offset + moved;
+
+      got = splice(from_fd, from_offset >= 0 ? &inoff : NULL,
+                   to_fd, to_offset >= 0 ? &outoff : NULL,
+                   want, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+      if( got > 0 ) {
+        moved += got;
+        continue;
+      }
+      if( got == 0 ) break; // EOF
+      if( errno == EINTR ) continue;
+      if( errno == EAGAIN ) {
+        // Wait for whichever side isn't ready.
+        struct pollfd p[2];
+        int n = 0;
+        if( from_pipe ) {
+          p[n].fd = from_fd; p[n].events = POLLIN; p[n].revents = 0; n++;
+        }
+        if( to_pipe ) {
+          p[n].fd = to_fd; p[n].events = POLLOUT; p[n].revents = 0; n++;
+        }
+        if( n > 0 && poll(p, n, 0) >= 0 ) {
+          for( int i = 0; i < n; i++ ) {
+            if( p[i].revents == 0 ) {
+              err = qio_splice_wait(p[i].fd, true, p[i].events);
+              break;
+            }
+          }
+        }
+        if( err ) break;
+        continue;
+      }
+      if( errno == EINVAL || errno == ENOSYS ) {
+        // Neither is a pipe, or the file system doesn't support it.
+        use_splice = false;
+        continue;
+      }
+      err = qio_int_to_err(errno);
+      break;
+    }
+#endif
+
+    // Copy it through a buffer instead.
+    if( buf == NULL ) {
+      bufsz = 64*1024;
+      buf = (char*) qio_malloc(bufsz);
+      if( ! buf ) {
+        err = QIO_ENOMEM;
+        break;
+      }
+    }
+    if( want > bufsz ) want = bufsz;
+
+    err = qio_splice_wait(from_fd, from_pipe, POLLIN);
+    if( err ) break;
+    if( from_offset >= 0 ) got = pread(from_fd, buf, want, from_offset + moved);
+    else got = read(from_fd, buf, want);
+    if( got == 0 ) break; // EOF
+    if( got < 0 ) {
+      if( errno == EINTR || errno == EAGAIN ) continue;
+      err = qio_int_to_err(errno);
+      break;
+    }
+
+    {
+      ssize_t done = 0;
+      while( done < got ) {
+        ssize_t put;
+        err = qio_splice_wait(to_fd, to_pipe, POLLOUT);
+        if( err ) break;
+        if( to_offset >= 0 )
+          put = pwrite(to_fd, buf + done, got - done, to_offset + moved + done);
+        else
+          put = write(to_fd, buf + done, got - done);
+        if( put < 0 ) {
+          if( errno == EINTR || errno == EAGAIN ) continue;
+          err = qio_int_to_err(errno);
+          break;
+        }
+        done += put;
+      }
+      moved += done;
+    }
+    if( err ) break;
+  }
+
+  qio_free(buf);
+  *amt_out = moved;
+  return err;
+}
+
 // Send a signal to the specified pid
 qioerr qio_send_signal(int64_t pid, int sig)
 {
@@ -41,6 +41,10 @@
 #undef printf
 
 #include "re2/re2.h"
+#include "re2/set.h"
+
+#include <string>
+#include <vector>
 
 using namespace re2;
 
@@ -826,3 +830,329 @@ markerror:
 
   return err;
 }
+
+struct re_set_t {
+  RE2::Set set;
+  qbytes_refcnt_t ref_cnt;
+  optionFlags_t optionFlags;
+  bool compiled;
+  bool ok;
+  int64_t size;
+  // The longest match any of the patterns can have, which is how much
+  // has to be kept across a boundary when matching a channel in pieces.
+  // -1 means the set can't be matched in pieces and needs the whole
+  // text at once.
+  int64_t window;
+
+  re_set_t(optionFlags_t optionFlags, RE2::Anchor anchor)
+    : set(flags_to_re2_opts(optionFlags), anchor),
+      optionFlags(optionFlags),
+      compiled(false),
+      ok(false),
+      size(0),
+      window(anchor == RE2::UNANCHORED ? 0 : -1)
+  {
+    DO_INIT_REFCNT(this);
+  }
+};
+
+static
+void re_set_free(re_set_t* rs)
+{
+  delete rs;
+}
+
+// Could the pattern match differently depending on the bytes around
+// the text it's matched against? That's the case for ^, $, and the
+// \A \z \b \B assertions. This errs on the side of saying yes.
+static
+bool pattern_needs_context(const char* p, int64_t len)
+{
+  bool in_class = false;
+
+  for (int64_t i = 0; i < len; i++) {
+    char c = p[i];
+    if (c == '\\') {
+      if (i + 1 < len && !in_class) {
+        char e = p[i+1];
+        if (e == 'A' || e == 'z' || e == 'b' || e == 'B') return true;
+      }
+      i++; // pass the escaped character
+    } else if (in_class) {
+      if (c == ']') in_class = false;
+    } else if (c == '[') {
+      in_class = true;
+      // a ] first in the class (maybe after ^) doesn't end it
+      if (i + 1 < len && p[i+1] == '^') i++;
+      if (i + 1 < len && p[i+1] == ']') i++;
+    } else if (c == '^' || c == '$') {
+      return true;
+    }
+  }
+  return false;
+}
+
+void qio_regex_set_create(const qio_regex_options_t* options, int anchor,
+                          qio_regex_set_t* set_out)
+{
+  RE2::Anchor ranchor = RE2::UNANCHORED;
+
+  if( anchor == QIO_REGEX_ANCHOR_UNANCHORED ) ranchor = RE2::UNANCHORED;
+  else if( anchor == QIO_REGEX_ANCHOR_START ) ranchor = RE2::ANCHOR_START;
+  else if( anchor == QIO_REGEX_ANCHOR_BOTH ) ranchor = RE2::ANCHOR_BOTH;
+
+  set_out->set = (void*) new re_set_t(qio_re_options_to_flags(options),
+                                      ranchor);
+}
+
+int64_t qio_regex_set_add(qio_regex_set_t* set, const char* pattern,
+                          int64_t pattern_len, const char** err_str)
+{
+  re_set_t* rs = (re_set_t*) set->set;
+  optionFlags_t flags;
+  std::string s;
+  std::string error;
+  int idx;
+
+  *err_str = NULL;
+
+  if (!rs || rs->compiled) {
+    *err_str = qio_strdup("cannot add to a compiled regex set");
+    return -1;
+  }
+
+  // Add the same prefix as qio_regex_create_compile does.
+  flags = rs->optionFlags;
+  if (!(flags & OPTION_FLAG_POSIX) && !(flags & OPTION_FLAG_LITERAL)) {
+    if (flags & OPTION_FLAG_MULTILINE) s += "(?m)";
+    if (flags & OPTION_FLAG_NONGREEDY) s += "(?U)";
+  }
+  s.append(pattern, pattern_len);
+
+  idx = rs->set.Add(StringPiece(s), &error);
+  if (idx < 0) {
+    *err_str = qio_strdup(error.c_str());
+    return -1;
+  }
+  rs->size = idx + 1;
+
+  if (rs->window >= 0) {
+    // Work out how much of the text a match can cover.
+    RE2 re(s, flags_to_re2_opts(flags));
+    int64_t maxlen = re.ok() ? re.max_match_length_bytes() : -1;
+
+    if (maxlen < 0 ||
+        (!(flags & OPTION_FLAG_LITERAL) &&
+         pattern_needs_context(pattern, pattern_len))) {
+      rs->window = -1;
+    } else if (maxlen > rs->window) {
+      rs->window = maxlen;
+    }
+  }
+
+  return idx;
+}
+
+qio_bool qio_regex_set_compile(qio_regex_set_t* set)
+{
+  re_set_t* rs = (re_set_t*) set->set;
+  if (!rs) return false;
+  if (!rs->compiled) {
+    rs->compiled = true;
+    rs->ok = rs->set.Compile();
+  }
+  return rs->ok;
+}
+
+void qio_regex_set_retain(const qio_regex_set_t* set)
+{
+  re_set_t* rs = (re_set_t*) set->set;
+  DO_RETAIN(rs);
+}
+
+void qio_regex_set_release(qio_regex_set_t* set)
+{
+  re_set_t* rs = (re_set_t*) set->set;
+  DO_RELEASE(rs, re_set_free);
+  set->set = NULL;
+}
+
+int64_t qio_regex_set_size(const qio_regex_set_t* set)
+{
+  re_set_t* rs = (re_set_t*) set->set;
+  return rs ? rs->size : 0;
+}
+
+// Match text, marking the patterns that matched in hits and counting
+// the new ones in *nhit. Returns ENOMEM if the DFA ran out of memory.
+static
+qioerr re_set_scan(re_set_t* rs, const StringPiece& text,
+                   std::vector<int>& v, std::vector<char>& hits,
+                   int64_t* nhit)
+{
+  RE2::Set::ErrorInfo info;
+
+  if (rs->set.Match(text, &v, &info)) {
+    for (int idx : v) {
+      if (!hits[idx]) {
+        hits[idx] = 1;
+        (*nhit)++;
+      }
+    }
+  } else if (info.kind == RE2::Set::kOutOfMemory) {
+    return QIO_ENOMEM;
+  }
+  return 0;
+}
+
+qio_bool qio_regex_set_match(const qio_regex_set_t* set, const char* str,
+                             int64_t str_len, qio_bool* matched)
+{
+  re_set_t* rs = (re_set_t*) set->set;
+  std::vector<int> v;
+  bool ret;
+
+  if (matched) {
+    for (int64_t i = 0; i < qio_regex_set_size(set); i++) matched[i] = false;
+  }
+  if (!rs || !rs->ok) return false;
+
+  ret = rs->set.Match(StringPiece(str, str_len), matched ? &v : NULL);
+  if (ret && matched) {
+    for (int idx : v) matched[idx] = true;
+  }
+  return ret;
+}
+
+qioerr qio_regex_set_channel_match(const qio_regex_set_t* set,
+                                   const int threadsafe,
+                                   struct qio_channel_s* ch,
+                                   int64_t maxlen, qio_bool* matched)
+{
+  re_set_t* rs = (re_set_t*) set->set;
+  qioerr err = 0;
+  int64_t size = qio_regex_set_size(set);
+  int64_t remaining = maxlen;
+  int64_t nhit = 0;
+  bool started = false;
+  bool atEOF = false;
+  std::vector<int> v;
+  std::vector<char> hits(size, 0);
+  // In pieces, the last window-1 bytes seen; otherwise, all of them.
+  std::string saved;
+  std::string stitch;
+  char* tmp = NULL;
+  const int64_t tmp_size = 64*1024;
+
+  if (matched) {
+    for (int64_t i = 0; i < size; i++) matched[i] = false;
+  }
+
+  if (!rs || !rs->ok)
+    QIO_RETURN_CONSTANT_ERROR(EINVAL, "invalid regex set");
+
+  if( threadsafe ) {
+    err = qio_lock(&ch->lock);
+    if( err ) {
+      return err;
+    }
+  }
+
+  while (remaining > 0) {
+    void* start = NULL;
+    void* end = NULL;
+    const char* data;
+    int64_t n;
+    bool peeked = true;
+
+    err = qio_channel_require_read(false, ch, 1);
+    if (qio_err_to_int(err) == EEOF) {
+      atEOF = !started;
+      err = 0;
+      break;
+    }
+    if (err) break;
+
+    err = qio_channel_begin_peek_cached(false, ch, &start, &end);
+    if (err) break;
+    n = qio_ptr_diff(end, start);
+    data = (const char*) start;
+    if (n <= 0) {
+      // Nothing to look at in place, so read some.
+      ssize_t got = 0;
+      peeked = false;
+      if (!tmp) {
+        tmp = (char*) qio_malloc(tmp_size);
+        if (!tmp) {
+          err = QIO_ENOMEM;
+          break;
+        }
+      }
+      n = (remaining < tmp_size) ? remaining : tmp_size;
+      err = qio_channel_read(false, ch, tmp, n, &got);
+      if (qio_err_to_int(err) == EEOF && got > 0) err = 0;
+      if (err) break;
+      n = got;
+      data = tmp;
+    } else if (n > remaining) {
+      n = remaining;
+    }
+    started = true;
+    remaining -= n;
+
+    if (rs->window < 0) {
+      saved.append(data, n);
+    } else if (nhit < size) {
+      err = re_set_scan(rs, StringPiece(data, n), v, hits, &nhit);
+
+      if (!err && rs->window > 1) {
+        // Anything matching across the boundary before data is no
+        // longer than window, so it's in the window-1 bytes on either
+        // side of it. (If data is shorter than that, a match that also
+        // crosses the next boundary is found there.)
+        size_t keep = rs->window - 1;
+        size_t head = ((size_t) n < keep) ? (size_t) n : keep;
+        if (!saved.empty()) {
+          stitch.assign(saved);
+          stitch.append(data, head);
+          err = re_set_scan(rs, StringPiece(stitch), v, hits, &nhit);
+        }
+        if ((size_t) n >= keep) {
+          saved.assign(data + n - keep, keep);
+        } else {
+          saved.append(data, n);
+          if (saved.size() > keep) saved.erase(0, saved.size() - keep);
+        }
+      }
+    }
+
+    if (peeked) {
+      qio_channel_end_peek_cached(false, ch, qio_ptr_add(start, n));
+    }
+    if (err) break;
+  }
+
+  if (!err && rs->window < 0 && started) {
+    err = re_set_scan(rs, StringPiece(saved), v, hits, &nhit);
+  }
+
+  if( threadsafe ) {
+    qio_unlock(&ch->lock);
+  }
+
+  qio_free(tmp);
+
+  if (matched) {
+    for (int64_t i = 0; i < size; i++) matched[i] = hits[i] != 0;
+  }
+
+  if (err == 0 && nhit == 0) {
+    if (atEOF) {
+      err = QIO_EEOF;
+    } else {
+      QIO_GET_CONSTANT_ERROR(err, EFORMAT, "no match");
+    }
+  }
+
+  return err;
+}
@@ -669,7 +669,7 @@ qio_err_t sys_lstat(const char* path, struct stat* buf)
 }
 
 #ifdef SYS_HAS_LLAPI
-qio_err_t sys_lustre_get_stripe_size(fd_t fd, int64_t* size_out)
+qio_err_t sys_lustre_get_stripe(fd_t fd, int64_t* size_out, int64_t* count_out)
 {
   struct lov_user_md_v1 *lum;
   size_t lum_size = sizeof(*lum) + LOV_MAX_STRIPE_COUNT * sizeof(struct lov_user_ost_data_v1);
@@ -684,9 +684,11 @@ qio_err_t sys_lustre_get_stripe_size(fd_t fd, int64_t* size_out)
   STARTING_SLOW_SYSCALL;
   rc = ioctl(fd, LL_IOC_LOV_GETSTRIPE, lum);
   *size_out = lum->lmm_stripe_size;
+  *count_out = lum->lmm_stripe_count;
 
   if (rc < 0)  {
     *size_out = 0;
+    *count_out = 0;
     err = errno;
   }
   DONE_SLOW_SYSCALL;
@@ -696,12 +698,18 @@ qio_err_t sys_lustre_get_stripe_size(fd_t fd, int64_t* size_out)
   return err;
 }
 #else
-qio_err_t sys_lustre_get_stripe_size(fd_t fd, int64_t* size_out)
+qio_err_t sys_lustre_get_stripe(fd_t fd, int64_t* size_out, int64_t* count_out)
 {
   return ENOSYS;
 }
 #endif
 
+qio_err_t sys_lustre_get_stripe_size(fd_t fd, int64_t* size_out)
+{
+  int64_t count;
+  return sys_lustre_get_stripe(fd, size_out, &count);
+}
+
 // TAKZ - on Mac, the types in the statfs structure become signed or unsigned
 // based upon whether or not they have 64 bit inodes. This leads to some rather
 // messy error handling and checking, since we want to avoid overflow in the
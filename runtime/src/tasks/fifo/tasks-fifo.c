@@ -31,6 +31,7 @@
 #include "chplexit.h"
 #include "chpl-locale-model.h"
 #include "chpl-mem.h"
+#include "chpl-mem-arena.h"
 #include "chpl-tasks.h"
 #include "chpl-tasks-callbacks-internal.h"
 #include "chpl-topo.h"
@@ -44,13 +45,22 @@
 #include <inttypes.h>
 #include <errno.h>
 #include <sys/time.h>
+#include <time.h>
 #include <sys/mman.h>
 #include <unistd.h>
 #include <math.h>
+#include <poll.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
 
 
 //
-// task pool: linked list of tasks
+// task pool: a bounded lock-free MPMC ring of task pointers, with a
+// linked list behind it, under threading_lock, for when the ring is
+// full.  Once the list is in use new tasks go there too until it has
+// drained, so tasks still start in roughly the order they were added.
 //
 typedef struct task_pool_struct* task_pool_p;
 
@@ -59,8 +69,7 @@ typedef struct {
 } chpl_task_prvDataImpl_t;
 
 typedef struct task_pool_struct {
-  task_pool_p      next;         // double-link pointers for pool
-  task_pool_p      prev;
+  task_pool_p      next;         // link pointer for overflow list
 
   chpl_task_prvDataImpl_t chpl_data;
 
@@ -77,16 +86,31 @@ typedef struct {
 
 static chpl_bool        initialized = false;
 
-static chpl_thread_mutex_t threading_lock;     // critical section lock
-static chpl_thread_mutex_t task_id_lock;       // critical section lock
-static volatile task_pool_p
-                           task_pool_head;     // head of task pool
-static volatile task_pool_p
-                           task_pool_tail;     // tail of task pool
+#define TASK_RING_SIZE 1024                    // must be a power of 2
 
-static int                 queued_task_cnt;    // number of tasks in task pool
-static int                 idle_thread_cnt;    // number of threads looking
+typedef struct {
+  chpl_atomic_uint_least64_t seq;              // ring position this is for
+  task_pool_p ptask;
+} task_ring_cell_t;
+
+static chpl_thread_mutex_t threading_lock;     // overflow list, thread creation
+static task_ring_cell_t    task_ring[TASK_RING_SIZE];
+static chpl_atomic_uint_least64_t
+                           task_ring_enq_pos;  // next ring position to fill
+static chpl_atomic_uint_least64_t
+                           task_ring_deq_pos;  // next ring position to empty
+static task_pool_p         task_pool_head;     // head of overflow list
+static task_pool_p         task_pool_tail;     // tail of overflow list
+static chpl_atomic_int_least32_t
+                           overflow_task_cnt;  // number of tasks in list
+
+static chpl_atomic_int_least32_t
+                           queued_task_cnt;    // number of tasks in task pool
+static chpl_atomic_int_least32_t
+                           idle_thread_cnt;    // number of threads looking
                                                //   for work
+static chpl_atomic_uint_least64_t
+                           next_task_id;       // see get_next_task_id()
 
 static chpl_bool do_taskReport = false;
 static chpl_thread_mutex_t taskTable_lock;     // critical section lock
@@ -97,7 +121,7 @@ static chpl_fn_p comm_task_fn;
 // Internal functions.
 //
 static void                    enqueue_task(task_pool_p);
-static void                    dequeue_task(task_pool_p);
+static task_pool_p             dequeue_task(void);
 static void                    comm_task_wrapper(void*);
 static void                    taskCallBody(chpl_fn_int_t, chpl_fn_p,
                                             void*, size_t,
@@ -115,10 +139,12 @@ static task_pool_p             add_to_task_pool(chpl_fn_int_t, chpl_fn_p,
                                                 void*, size_t,
                                                 chpl_bool, int, int32_t);
 
+#ifndef __linux__
 //
 // Condition variable methods
 //
 static void chpl_thread_condvar_init(chpl_thread_condvar_t* cv);
+#endif
 
 //
 // Sync variable methods
@@ -175,6 +201,72 @@ void chpl_sync_waitEmptyAndLock(chpl_sync_aux_t *s,
   sync_wait_and_lock(s, false, lineno, filename);
 }
 
+#ifdef __linux__
+
+//
+// Suspend on the futex word for the state we're waiting for.  The
+// word is sampled under the lock, so a signal between unlocking and
+// sleeping changes it and the wait returns at once.
+//
+static chpl_bool chpl_thread_sync_suspend(chpl_sync_aux_t *s,
+                                   struct timeval *deadline) {
+  volatile uint32_t* word;
+  uint32_t* waiters;
+  uint32_t seq;
+  struct timespec ts;
+  int rc;
+
+  if (s->is_full) {
+    word = &s->signal_empty;
+    waiters = &s->waiters_empty;
+  } else {
+    word = &s->signal_full;
+    waiters = &s->waiters_full;
+  }
+
+  seq = *word;
+  (*waiters)++;
+  chpl_thread_mutexUnlock(&s->lock);
+
+  if (deadline == NULL) {
+    rc = syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, seq,
+                 NULL, NULL, 0);
+  } else {
+    ts.tv_sec  = deadline->tv_sec;
+    ts.tv_nsec = deadline->tv_usec * 1000UL;
+    rc = syscall(SYS_futex, word,
+                 FUTEX_WAIT_BITSET_PRIVATE | FUTEX_CLOCK_REALTIME, seq,
+                 &ts, NULL, FUTEX_BITSET_MATCH_ANY);
+  }
+
+  chpl_thread_mutexLock(&s->lock);
+  (*waiters)--;
+
+  return (rc == -1 && errno == ETIMEDOUT);
+}
+
+static void chpl_thread_sync_awaken(chpl_sync_aux_t *s) {
+  volatile uint32_t* word;
+  uint32_t waiters;
+
+  if (s->is_full) {
+    word = &s->signal_full;
+    waiters = s->waiters_full;
+  } else {
+    word = &s->signal_empty;
+    waiters = s->waiters_empty;
+  }
+
+  (*word)++;
+  if (waiters > 0) {
+    if (syscall(SYS_futex, word, FUTEX_WAKE_PRIVATE, 1,
+                NULL, NULL, 0) == -1)
+      chpl_internal_error("futex wake failed");
+  }
+}
+
+#else // !__linux__
+
 static chpl_bool chpl_thread_sync_suspend(chpl_sync_aux_t *s,
                                    struct timeval *deadline) {
   chpl_thread_condvar_t* cond;
@@ -199,6 +291,8 @@ static void chpl_thread_sync_awaken(chpl_sync_aux_t *s) {
     chpl_internal_error("pthread_cond_signal() failed");
 }
 
+#endif // __linux__
+
 void chpl_sync_markAndSignalFull(chpl_sync_aux_t *s) {
   s->is_full = true;
   chpl_thread_sync_awaken(s);
@@ -216,6 +310,23 @@ chpl_bool chpl_sync_isFull(void *val_ptr,
   return s->is_full;
 }
 
+#ifdef __linux__
+
+void chpl_sync_initAux(chpl_sync_aux_t *s) {
+  s->is_full = false;
+  chpl_thread_mutexInit(&s->lock);
+  s->signal_full = 0;
+  s->signal_empty = 0;
+  s->waiters_full = 0;
+  s->waiters_empty = 0;
+}
+
+void chpl_sync_destroyAux(chpl_sync_aux_t *s) {
+  chpl_thread_mutexDestroy(&s->lock);
+}
+
+#else // !__linux__
+
 static void chpl_thread_condvar_init(chpl_thread_condvar_t* cv) {
   if (pthread_cond_init((pthread_cond_t*) cv, NULL))
     chpl_internal_error("pthread_cond_init() failed");
@@ -244,6 +355,8 @@ void chpl_sync_destroyAux(chpl_sync_aux_t *s) {
   chpl_thread_mutexDestroy(&s->lock);
 }
 
+#endif // __linux__
+
 static void setup_main_thread_private_data(void)
 {
   thread_private_data_t* tp;
@@ -278,10 +391,17 @@ static void setup_main_thread_private_data(void)
 
 void chpl_task_init(void) {
   chpl_thread_mutexInit(&threading_lock);
-  chpl_thread_mutexInit(&task_id_lock);
-  queued_task_cnt = 0;
-  idle_thread_cnt = 0;
+  for (int i = 0; i < TASK_RING_SIZE; i++) {
+    atomic_init_uint_least64_t(&task_ring[i].seq, i);
+    task_ring[i].ptask = NULL;
+  }
+  atomic_init_uint_least64_t(&task_ring_enq_pos, 0);
+  atomic_init_uint_least64_t(&task_ring_deq_pos, 0);
   task_pool_head = task_pool_tail = NULL;
+  atomic_init_int_least32_t(&overflow_task_cnt, 0);
+  atomic_init_int_least32_t(&queued_task_cnt, 0);
+  atomic_init_int_least32_t(&idle_thread_cnt, 0);
+  atomic_init_uint_least64_t(&next_task_id, chpl_nullTaskID + 1);
 
   chpl_thread_init(thread_begin, thread_end);
 
@@ -447,45 +567,130 @@ static void comm_task_wrapper(void* arg) {
 }
 
 
+//
+// Push and pop tasks on the ring.  Each cell's sequence number says
+// whether it is ready to be filled (seq == pos) or emptied
+// (seq == pos + 1) for a given ring position, so producers and
+// consumers only contend on the position counters.
+//
+static inline
+chpl_bool task_ring_push(task_pool_p ptask) {
+  uint_least64_t pos;
+  task_ring_cell_t* cell;
+
+  pos = atomic_load_explicit_uint_least64_t(&task_ring_enq_pos,
+                                            chpl_memory_order_relaxed);
+  while (true) {
+    uint_least64_t seq;
+    int64_t diff;
+
+    cell = &task_ring[pos & (TASK_RING_SIZE - 1)];
+    seq = atomic_load_explicit_uint_least64_t(&cell->seq,
+                                              chpl_memory_order_acquire);
+    diff = (int64_t) seq - (int64_t) pos;
+    if (diff == 0) {
+      if (atomic_compare_exchange_weak_explicit_uint_least64_t(
+            &task_ring_enq_pos, &pos, pos + 1,
+            chpl_memory_order_relaxed, chpl_memory_order_relaxed))
+        break;
+    } else if (diff < 0) {
+      return false;                     // full
+    } else {
+      pos = atomic_load_explicit_uint_least64_t(&task_ring_enq_pos,
+                                                chpl_memory_order_relaxed);
+    }
+  }
+
+  cell->ptask = ptask;
+  atomic_store_explicit_uint_least64_t(&cell->seq, pos + 1,
+                                       chpl_memory_order_release);
+  return true;
+}
+
+
+static inline
+task_pool_p task_ring_pop(void) {
+  uint_least64_t pos;
+  task_ring_cell_t* cell;
+  task_pool_p ptask;
+
+  pos = atomic_load_explicit_uint_least64_t(&task_ring_deq_pos,
+                                            chpl_memory_order_relaxed);
+  while (true) {
+    uint_least64_t seq;
+    int64_t diff;
+
+    cell = &task_ring[pos & (TASK_RING_SIZE - 1)];
+    seq = atomic_load_explicit_uint_least64_t(&cell->seq,
+                                              chpl_memory_order_acquire);
+    diff = (int64_t) seq - (int64_t) (pos + 1);
+    if (diff == 0) {
+      if (atomic_compare_exchange_weak_explicit_uint_least64_t(
+            &task_ring_deq_pos, &pos, pos + 1,
+            chpl_memory_order_relaxed, chpl_memory_order_relaxed))
+        break;
+    } else if (diff < 0) {
+      return NULL;                      // empty
+    } else {
+      pos = atomic_load_explicit_uint_least64_t(&task_ring_deq_pos,
+                                                chpl_memory_order_relaxed);
+    }
+  }
+
+  ptask = cell->ptask;
+  atomic_store_explicit_uint_least64_t(&cell->seq, pos + TASK_RING_SIZE,
+                                       chpl_memory_order_release);
+  return ptask;
+}
+
+
 //
 // Enqueue and dequeue tasks from the pool.
 //
 static inline
 void enqueue_task(task_pool_p ptask) {
-  queued_task_cnt++;
+  (void) atomic_fetch_add_int_least32_t(&queued_task_cnt, 1);
+
+  if (atomic_load_int_least32_t(&overflow_task_cnt) == 0
+      && task_ring_push(ptask))
+    return;
 
   //
-  // Add to pool.
+  // The ring is full, or was recently; add to the overflow list.
   //
+  chpl_thread_mutexLock(&threading_lock);
+  ptask->next = NULL;
   if (task_pool_tail)
     task_pool_tail->next = ptask;
   else
     task_pool_head = ptask;
-  ptask->prev = task_pool_tail;
   task_pool_tail = ptask;
+  (void) atomic_fetch_add_int_least32_t(&overflow_task_cnt, 1);
+  chpl_thread_mutexUnlock(&threading_lock);
 }
 
 
 static inline
-void dequeue_task(task_pool_p ptask) {
-  assert(queued_task_cnt > 0);
-  queued_task_cnt--;
+task_pool_p dequeue_task(void) {
+  task_pool_p ptask;
 
-  //
-  // Remove from pool.
-  //
-  if (ptask == task_pool_head) {
-    if ((task_pool_head = task_pool_head->next) == NULL)
-      task_pool_tail = NULL;
-    else
-      task_pool_head->prev = NULL;
+  if ((ptask = task_ring_pop()) == NULL
+      && atomic_load_int_least32_t(&overflow_task_cnt) > 0) {
+    chpl_thread_mutexLock(&threading_lock);
+    if ((ptask = task_pool_head) != NULL) {
+      if ((task_pool_head = ptask->next) == NULL)
+        task_pool_tail = NULL;
+      (void) atomic_fetch_sub_int_least32_t(&overflow_task_cnt, 1);
+    }
+    chpl_thread_mutexUnlock(&threading_lock);
   }
-  else {
-    if ((ptask->prev->next = ptask->next) == NULL)
-      task_pool_tail = ptask->prev;
-    else
-      ptask->next->prev = ptask->prev;
+
+  if (ptask != NULL) {
+    assert(atomic_load_int_least32_t(&queued_task_cnt) > 0);
+    (void) atomic_fetch_sub_int_least32_t(&queued_task_cnt, 1);
   }
+
+  return ptask;
 }
 
 
@@ -497,14 +702,24 @@ void chpl_task_addTask(chpl_fn_int_t fid,
 
   arg->kind = CHPL_ARG_BUNDLE_KIND_TASK;
 
-  // begin critical section
-  chpl_thread_mutexLock(&threading_lock);
-
   (void) add_to_task_pool(fid, chpl_ftable[fid], arg, arg_size,
                           false, lineno, filename);
+}
 
-  // end critical section
-  chpl_thread_mutexUnlock(&threading_lock);
+
+void chpl_task_addTasks(int n, chpl_fn_int_t fid,
+                        chpl_task_bundle_t* args, size_t arg_size,
+                        c_sublocid_t subloc,
+                        int lineno, int32_t filename) {
+  assert(subloc == c_sublocid_none);
+
+  for (int i = 0; i < n; i++) {
+    chpl_task_bundle_t* arg =
+      (chpl_task_bundle_t*) ((char*) args + i * arg_size);
+    arg->kind = CHPL_ARG_BUNDLE_KIND_TASK;
+    (void) add_to_task_pool(fid, chpl_ftable[fid], arg, arg_size,
+                            false, lineno, filename);
+  }
 }
 
 
@@ -521,14 +736,8 @@ void taskCallBody(chpl_fn_int_t fid, chpl_fn_p fp,
                   void* arg, size_t arg_size,
                   c_sublocid_t subloc,
                   int lineno, int32_t filename) {
-  // begin critical section
-  chpl_thread_mutexLock(&threading_lock);
-
   (void) add_to_task_pool(fid, fp, arg, arg_size, true,
                           lineno, filename);
-
-  // end critical section
-  chpl_thread_mutexUnlock(&threading_lock);
 }
 
 
@@ -587,28 +796,43 @@ void chpl_task_yield(void) {
 }
 
 
+//
+// The timer wheel qthreads parks sleeping tasks on exists to free their
+// workers while they sleep.  Here a task keeps its thread until it ends
+// no matter what, so there is nothing to free, and the task can simply
+// block instead of yielding until its deadline.
+//
 void chpl_task_sleep(double secs) {
-  struct timeval deadline;
-  struct timeval now;
+  struct timespec req;
+  struct timespec rem;
 
-  //
-  // Figure out when this task can proceed again, and until then, keep
-  // yielding.
-  //
-  gettimeofday(&deadline, NULL);
-  deadline.tv_usec += (suseconds_t) lround((secs - trunc(secs)) * 1.0e6);
-  if (deadline.tv_usec > 1000000) {
-    deadline.tv_sec++;
-    deadline.tv_usec -= 1000000;
+  if (secs <= 0) {
+    chpl_task_yield();
+    return;
+  }
+
+  req.tv_sec = (time_t) trunc(secs);
+  req.tv_nsec = (long) lround((secs - trunc(secs)) * 1.0e9);
+  if (req.tv_nsec >= 1000000000) {
+    req.tv_sec++;
+    req.tv_nsec -= 1000000000;
+  }
+
+  while (nanosleep(&req, &rem) == -1 && errno == EINTR) {
+    req = rem;
   }
-  deadline.tv_sec += (time_t) trunc(secs);
+}
+
+
+// Every task has a thread of its own, so it can just block.
+int chpl_task_waitFds(struct pollfd* fds, int nfds) {
+  int rc;
 
   do {
-    chpl_task_yield();
-    gettimeofday(&now, NULL);
-  } while (now.tv_sec < deadline.tv_sec
-           || (now.tv_sec == deadline.tv_sec
-               && now.tv_usec < deadline.tv_usec));
+    rc = poll(fds, (nfds_t) nfds, -1);
+  } while (rc == -1 && errno == EINTR);
+
+  return rc;
 }
 
 uint32_t chpl_task_getMaxPar(void) {
@@ -654,15 +878,7 @@ chpl_bool chpl_task_guardPagesInUse(void) {
 // Get a new task ID.
 //
 static chpl_taskID_t get_next_task_id(void) {
-  static chpl_taskID_t       id = chpl_nullTaskID + 1;
-
-  chpl_taskID_t              next_id;
-
-  chpl_thread_mutexLock(&task_id_lock);
-  next_id = id++;
-  chpl_thread_mutexUnlock(&task_id_lock);
-
-  return next_id;
+  return (chpl_taskID_t) atomic_fetch_add_uint_least64_t(&next_task_id, 1);
 }
 
 
@@ -704,12 +920,23 @@ task_pool_p get_current_ptask(chpl_bool must_be_task) {
 //
 static void report_all_tasks(void) {
   task_pool_p pendingTask = task_pool_head;
+  uint_least64_t pos, end;
 
   printf("Task report\n");
   printf("--------------------------------\n");
 
   // print out pending tasks
   printf("Pending tasks:\n");
+  pos = atomic_load_uint_least64_t(&task_ring_deq_pos);
+  end = atomic_load_uint_least64_t(&task_ring_enq_pos);
+  for ( ; pos < end; pos++) {
+    task_ring_cell_t* cell = &task_ring[pos & (TASK_RING_SIZE - 1)];
+    if (atomic_load_uint_least64_t(&cell->seq) == pos + 1) {
+      printf("- %s:%d\n",
+             chpl_lookupFilename(cell->ptask->taskBundle->filename),
+             cell->ptask->taskBundle->lineno);
+    }
+  }
   while (pendingTask != NULL) {
     printf("- %s:%d\n", chpl_lookupFilename(pendingTask->taskBundle->filename),
            pendingTask->taskBundle->lineno);
@@ -767,38 +994,25 @@ thread_begin(void* ptask_void) {
     // that were waiting on the signal, but since there was a performance
     // impact from keeping it as a hybrid as opposed to merely yielding,
     // it was decided that we would return to the simple yield case.
-    while (!task_pool_head) {
-      do {
-        chpl_thread_yield();
-      } while (!task_pool_head);
+    while (atomic_load_explicit_int_least32_t(&queued_task_cnt,
+                                              chpl_memory_order_relaxed)
+           == 0) {
+      chpl_thread_yield();
     }
 
     //
-    // Just now the pool had at least one task in it.  Lock and see if
-    // there's something still there.
+    // Just now the pool had at least one task in it.  See if there's
+    // something still there.
     //
-    chpl_thread_mutexLock(&threading_lock);
-    if (!task_pool_head) {
-      chpl_thread_mutexUnlock(&threading_lock);
+    if ((ptask = dequeue_task()) == NULL)
       continue;
-    }
 
     //
-    // We've found a task to run.
+    // We've found a task to run.  Mark it active in the task-table
+    // (structure in ChapelRuntime that keeps track of currently running
+    // tasks for task-reports on deadlock or Ctrl+C).
     //
-
-    //
-    // start new task; remove task from pool also add to task to task-table
-    // (structure in ChapelRuntime that keeps track of currently running tasks
-    // for task-reports on deadlock or Ctrl+C).
-    //
-    ptask = task_pool_head;
-    idle_thread_cnt--;
-
-    dequeue_task(ptask);
-
-    // end critical section
-    chpl_thread_mutexUnlock(&threading_lock);
+    (void) atomic_fetch_sub_int_least32_t(&idle_thread_cnt, 1);
 
     tp->ptask = ptask;
 
@@ -831,18 +1045,12 @@ thread_begin(void* ptask_void) {
     }
 
     tp->ptask = NULL;
-    chpl_mem_free(ptask, 0, 0);
-
-    // begin critical section
-    chpl_thread_mutexLock(&threading_lock);
+    chpl_mem_arena_free(ptask, 0, 0);
 
     //
     // finished task; increment idle count
     //
-    idle_thread_cnt++;
-
-    // end critical section
-    chpl_thread_mutexUnlock(&threading_lock);
+    (void) atomic_fetch_add_int_least32_t(&idle_thread_cnt, 1);
   }
 }
 
@@ -866,11 +1074,17 @@ static void thread_end(void)
 // Launch another thread, if it seems useful to do so and we can.
 //
 static void maybe_add_thread(void) {
-  static chpl_bool warning_issued = false;
+  static volatile chpl_bool warning_issued = false;
+
+  if (warning_issued || !chpl_thread_canCreate())
+    return;
+
+  // begin critical section
+  chpl_thread_mutexLock(&threading_lock);
 
   if (!warning_issued && chpl_thread_canCreate()) {
     if (chpl_thread_create(NULL) == 0) {
-      idle_thread_cnt++;
+      (void) atomic_fetch_add_int_least32_t(&idle_thread_cnt, 1);
     }
     else {
       int32_t max_threads = chpl_thread_getMaxThreads();
@@ -890,12 +1104,14 @@ static void maybe_add_thread(void) {
       warning_issued = true;
     }
   }
+
+  // end critical section
+  chpl_thread_mutexUnlock(&threading_lock);
 }
 
 
 // create a task from the given function pointer and arguments
 // and append it to the end of the task pool
-// assumes threading_lock has already been acquired!
 static inline
 task_pool_p add_to_task_pool(chpl_fn_int_t fid, chpl_fn_p fp,
                              void* a, size_t a_size,
@@ -913,15 +1129,15 @@ task_pool_p add_to_task_pool(chpl_fn_int_t fid, chpl_fn_p fp,
   // could be either a comm or a task one.
   //
   assert(a_size >= chpl_argBundleSizeofHdr(a));
-  ptask = (task_pool_p) chpl_mem_alloc(offsetof(task_pool_t, bundle) + a_size,
-                                       CHPL_RT_MD_TASK_ARG_AND_POOL_DESC,
-                                       lineno, filename);
+  ptask = (task_pool_p) chpl_mem_arena_alloc(offsetof(task_pool_t, bundle)
+                                             + a_size,
+                                             CHPL_RT_MD_TASK_ARG_AND_POOL_DESC,
+                                             lineno, filename);
 
   memcpy(&ptask->bundle, a, a_size);
   ptask->taskBundle = chpl_argBundleTaskArgBundle(&ptask->bundle);
 
   ptask->next                   = NULL;
-  ptask->prev                   = NULL;
   ptask->chpl_data              = pv;
 
   *ptask->taskBundle =
@@ -934,10 +1150,10 @@ task_pool_p add_to_task_pool(chpl_fn_int_t fid, chpl_fn_p fp,
       .requested_fn    = fp,
       .id              = get_next_task_id(),
       .infoChapel      = ptask->taskBundle->infoChapel,// retain; set by caller
+      .lightweight     = false,
+      .argsInPlace     = false,
     };
 
-  enqueue_task(ptask);
-
   chpl_task_do_callbacks(chpl_task_cb_event_kind_create,
                          ptask->taskBundle->requested_fid,
                          ptask->taskBundle->filename,
@@ -954,9 +1170,14 @@ task_pool_p add_to_task_pool(chpl_fn_int_t fid, chpl_fn_p fp,
     chpl_thread_mutexUnlock(&taskTable_lock);
   }
 
+  // Only now can a thread pick it up, since the create callback and
+  // task-table entry must come before it starts.
+  enqueue_task(ptask);
+
   // If we now have more tasks than threads to run them on, try to start
   // another thread
-  if (queued_task_cnt > idle_thread_cnt) {
+  if (atomic_load_int_least32_t(&queued_task_cnt)
+      > atomic_load_int_least32_t(&idle_thread_cnt)) {
     maybe_add_thread();
   }
 
@@ -42,6 +42,7 @@
 #include "chplexit.h"
 #include "chpl-locale-model.h"
 #include "chpl-mem.h"
+#include "chpl-mem-sys.h"
 #include "chplsys.h"
 #include "chpl-linefile-support.h"
 #include "chpl-tasks.h"
@@ -56,15 +57,21 @@
 
 #include <assert.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <inttypes.h>
 #include <pthread.h>
 #include <sched.h>
 #include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/time.h>
 #include <unistd.h>
 #include <math.h>
+#include <poll.h>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
 
 #ifdef DEBUG
 // note: format arg 'f' must be a string constant
@@ -133,6 +140,11 @@ static void profile_print(void)
     fprintf(stderr, "sync isFull: %lu\n", (unsigned long)profile_sync_isFull);
     fprintf(stderr, "sync initAux: %lu\n", (unsigned long)profile_sync_initAux);
     fprintf(stderr, "sync destroyAux: %lu\n", (unsigned long)profile_sync_destroyAux);
+    /* Idle workers */
+    fprintf(stderr, "idle spin ns: %zu\n", qthread_readstate(SPIN_NS));
+    fprintf(stderr, "idle interval ns: %zu\n", qthread_readstate(IDLE_NS));
+    fprintf(stderr, "idle spin wakeups: %zu\n", qthread_readstate(SPIN_WAKEUPS));
+    fprintf(stderr, "idle spin parks: %zu\n", qthread_readstate(SPIN_PARKS));
 }
 #else
 # define PROFILE_INCR(counter,count)
@@ -193,10 +205,146 @@ chpl_qthread_tls_t *chpl_qthread_comm_task_tls = NULL;
 static aligned_t exit_ret = 0;
 
 static chpl_bool guardPagesInUse = true;
+static chpl_bool workStealingInUse = false;
+
+// Moved tasks (remote on-bodies and comm layer AM work) whose payload
+// is at most this many bytes are spawned into the workers' priority
+// lane, so that short RPC-like bodies don't wait behind long-running
+// compute tasks.  Negative disables this.
+static int64_t movedTaskPrioritySize = 64;
+
+//
+// Per-task profiling, enabled by CHPL_RT_TASK_PROFILE.  Each worker
+// accumulates into its own row of per-task-function stats, so that
+// recording needs no synchronization.  The rows are summed and
+// reported at exit, along with per-worker totals.
+//
+typedef struct {
+    uint64_t tasks;
+    uint64_t latencySum, latencyMax;   // spawn to start, ns
+    uint64_t runSum, runMax;           // start to end, ns
+    uint64_t yields;                   // yields and sync suspensions
+} task_prof_t;
+
+static chpl_bool taskProfile = false;
+static int taskProfNumFids;
+static int taskProfNumWorkers;
+static task_prof_t* taskProfStats;     // [worker][fid]
+
+static inline uint64_t task_prof_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static inline void task_prof_countYield(void)
+{
+    if (taskProfile) {
+        chpl_qthread_tls_t* tls = chpl_qthread_get_tasklocal();
+        if (tls != NULL)
+            tls->profYields++;
+    }
+}
+
+static void task_prof_begin(chpl_qthread_tls_t* tls)
+{
+    tls->profBeginTime = task_prof_now();
+    tls->profYields = 0;
+}
+
+static void task_prof_end(chpl_qthread_tls_t* tls,
+                          chpl_task_bundle_t* bundle)
+{
+    chpl_fn_int_t fid = bundle->requested_fid;
+    int worker = (int) qthread_worker_unique(NULL);
+    uint64_t now;
+    uint64_t latency, run;
+    task_prof_t* p;
+
+    if (fid < 0 || fid >= taskProfNumFids || bundle->createTime == 0
+        || worker < 0 || worker >= taskProfNumWorkers)
+        return;
+
+    now = task_prof_now();
+    latency = tls->profBeginTime - bundle->createTime;
+    run = now - tls->profBeginTime;
+
+    p = &taskProfStats[(size_t) worker * taskProfNumFids + fid];
+    p->tasks++;
+    p->latencySum += latency;
+    if (latency > p->latencyMax)
+        p->latencyMax = latency;
+    p->runSum += run;
+    if (run > p->runMax)
+        p->runMax = run;
+    p->yields += tls->profYields;
+}
+
+static void task_prof_init(void)
+{
+    taskProfile = chpl_env_rt_get_bool("TASK_PROFILE", false);
+    if (!taskProfile)
+        return;
+
+    for (taskProfNumFids = 0; chpl_finfo[taskProfNumFids].name != NULL;
+         taskProfNumFids++);
+    taskProfNumWorkers = (int) qthread_num_workers();
+    taskProfStats = chpl_calloc((size_t) taskProfNumWorkers * taskProfNumFids,
+                                sizeof(*taskProfStats));
+}
+
+static void task_prof_report(void)
+{
+    const double us = 1.0e3;
+
+    if (!taskProfile)
+        return;
+
+    for (int fid = 0; fid < taskProfNumFids; fid++) {
+        task_prof_t sum = { 0 };
+        for (int w = 0; w < taskProfNumWorkers; w++) {
+            task_prof_t* p =
+              &taskProfStats[(size_t) w * taskProfNumFids + fid];
+            sum.tasks += p->tasks;
+            sum.latencySum += p->latencySum;
+            if (p->latencyMax > sum.latencyMax)
+                sum.latencyMax = p->latencyMax;
+            sum.runSum += p->runSum;
+            if (p->runMax > sum.runMax)
+                sum.runMax = p->runMax;
+            sum.yields += p->yields;
+        }
+        if (sum.tasks == 0)
+            continue;
+        printf("%d: task profile: %s (%s:%d): %" PRIu64 " tasks, "
+               "start latency avg %.3f max %.3f us, "
+               "run avg %.3f max %.3f us, %" PRIu64 " yields\n",
+               (int) chpl_nodeID, chpl_finfo[fid].name,
+               chpl_lookupFilename(chpl_finfo[fid].fileno),
+               chpl_finfo[fid].lineno, sum.tasks,
+               sum.latencySum / us / sum.tasks, sum.latencyMax / us,
+               sum.runSum / us / sum.tasks, sum.runMax / us, sum.yields);
+    }
+
+    for (int w = 0; w < taskProfNumWorkers; w++) {
+        uint64_t tasks = 0;
+        uint64_t run = 0;
+        for (int fid = 0; fid < taskProfNumFids; fid++) {
+            task_prof_t* p =
+              &taskProfStats[(size_t) w * taskProfNumFids + fid];
+            tasks += p->tasks;
+            run += p->runSum;
+        }
+        printf("%d: task profile: worker %d: %" PRIu64 " tasks, "
+               "busy %.3f us\n", (int) chpl_nodeID, w, tasks, run / us);
+    }
+}
 
 void chpl_task_yield(void)
 {
     PROFILE_INCR(profile_task_yield,1);
+    task_prof_countYield();
     if (qthread_shep() == NO_SHEPHERD) {
         sched_yield();
     } else {
@@ -228,6 +376,7 @@ void chpl_sync_waitFullAndLock(chpl_sync_aux_t *s,
     chpl_sync_lock(s);
     while (s->is_full == 0) {
         chpl_sync_unlock(s);
+        task_prof_countYield();
         qthread_readFE(NULL, &(s->signal_full));
         chpl_sync_lock(s);
     }
@@ -242,6 +391,7 @@ void chpl_sync_waitEmptyAndLock(chpl_sync_aux_t *s,
     chpl_sync_lock(s);
     while (s->is_full != 0) {
         chpl_sync_unlock(s);
+        task_prof_countYield();
         qthread_readFE(NULL, &(s->signal_empty));
         chpl_sync_lock(s);
     }
@@ -445,12 +595,151 @@ static int32_t chpl_qt_getenv_num_workers(void) {
 }
 
 
+//
+// Startup autotuning (CHPL_RT_TASKS_AUTOTUNE).  Before Qthreads is
+// started, run two brief probes on plain pthreads, once with a thread
+// per core and once with a thread per PU: a STREAM-like triad giving
+// memory bandwidth, and a stream of tiny work items handed out through
+// a shared counter, standing in for task spawn throughput.  Use a
+// thread per PU only if that clearly helps bandwidth without hurting
+// throughput, since our default of a worker per core is otherwise the
+// better choice.
+//
+#define AUTOTUNE_ARRAY_ELTS  (4 * 1024 * 1024)   // per array, all threads
+#define AUTOTUNE_TRIAD_REPS  4
+#define AUTOTUNE_SPAWN_ITEMS (1 << 20)
+
+typedef struct {
+    pthread_barrier_t *barrier;
+    double            *a, *b, *c;
+    size_t             n;
+    size_t            *next;            // shared spawn-probe counter
+    volatile size_t    sink;
+} autotune_arg_t;
+
+static void *autotune_worker(void *arg)
+{
+    autotune_arg_t *p = (autotune_arg_t *) arg;
+    size_t sum = 0;
+
+    for (size_t i = 0; i < p->n; i++) {
+        p->a[i] = 0.0;
+        p->b[i] = 1.0;
+        p->c[i] = 2.0;
+    }
+
+    (void) pthread_barrier_wait(p->barrier);
+    for (int r = 0; r < AUTOTUNE_TRIAD_REPS; r++) {
+        for (size_t i = 0; i < p->n; i++)
+            p->a[i] = p->b[i] + 3.0 * p->c[i];
+    }
+
+    (void) pthread_barrier_wait(p->barrier);
+    (void) pthread_barrier_wait(p->barrier);
+    while (__atomic_fetch_add(p->next, 1, __ATOMIC_RELAXED)
+           < AUTOTUNE_SPAWN_ITEMS) {
+        sum += (size_t) p->a[sum % p->n];
+    }
+    p->sink = sum;
+
+    (void) pthread_barrier_wait(p->barrier);
+    return NULL;
+}
+
+static double autotune_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1.0e-9;
+}
+
+// Run both probes with nthreads threads, returning bandwidth in GB/s
+// and work items per microsecond.
+static void autotune_probe(int nthreads, double *gbps, double *itemsPerUs)
+{
+    pthread_barrier_t barrier;
+    pthread_t *threads;
+    autotune_arg_t *args;
+    double *mem;
+    size_t per = AUTOTUNE_ARRAY_ELTS / nthreads;
+    size_t next = 0;
+    double t0, t1, t2;
+
+    threads = chpl_malloc(nthreads * sizeof(*threads));
+    args = chpl_malloc(nthreads * sizeof(*args));
+    mem = chpl_malloc(3 * per * nthreads * sizeof(*mem));
+    (void) pthread_barrier_init(&barrier, NULL, nthreads + 1);
+
+    for (int i = 0; i < nthreads; i++) {
+        args[i].barrier = &barrier;
+        args[i].a = mem + (3 * i + 0) * per;
+        args[i].b = mem + (3 * i + 1) * per;
+        args[i].c = mem + (3 * i + 2) * per;
+        args[i].n = per;
+        args[i].next = &next;
+        if (pthread_create(&threads[i], NULL, autotune_worker, &args[i]))
+            chpl_internal_error("could not create autotuning thread");
+    }
+
+    (void) pthread_barrier_wait(&barrier);
+    t0 = autotune_now();
+    (void) pthread_barrier_wait(&barrier);
+    t1 = autotune_now();
+    (void) pthread_barrier_wait(&barrier);
+    (void) pthread_barrier_wait(&barrier);
+    t2 = autotune_now();
+
+    for (int i = 0; i < nthreads; i++)
+        (void) pthread_join(threads[i], NULL);
+
+    *gbps = (3.0 * sizeof(double) * per * nthreads * AUTOTUNE_TRIAD_REPS)
+            / (t1 - t0) * 1.0e-9;
+    *itemsPerUs = AUTOTUNE_SPAWN_ITEMS / (t2 - t1) * 1.0e-6;
+
+    (void) pthread_barrier_destroy(&barrier);
+    chpl_free(mem);
+    chpl_free(args);
+    chpl_free(threads);
+}
+
+// Choose the number of workers, logging the decision.
+static int32_t autotuneParallelism(void)
+{
+    int32_t numCores = chpl_topo_getNumCPUsPhysical(true);
+    int32_t numPUs = chpl_topo_getNumCPUsLogical(true);
+    double coreGBps, coreItems, puGBps, puItems;
+    int32_t hwpar;
+
+    if (numPUs <= numCores || chpl_topo_isOversubscribed()) {
+        printf("%d: QTHREADS: autotune: %d workers (one per core; "
+               "no SMT to choose from)\n", (int) chpl_nodeID, (int) numCores);
+        return numCores;
+    }
+
+    autotune_probe(numCores, &coreGBps, &coreItems);
+    autotune_probe(numPUs, &puGBps, &puItems);
+
+    if (puGBps > 1.05 * coreGBps && puItems > 0.9 * coreItems) {
+        hwpar = numPUs;
+    } else {
+        hwpar = numCores;
+    }
+
+    printf("%d: QTHREADS: autotune: per core %.1f GB/s, %.1f items/us; "
+           "per PU %.1f GB/s, %.1f items/us; chose %d workers (one per %s). "
+           "Set CHPL_RT_NUM_THREADS_PER_LOCALE=%d to keep this.\n",
+           (int) chpl_nodeID, coreGBps, coreItems, puGBps, puItems,
+           (int) hwpar, (hwpar == numPUs) ? "PU" : "core", (int) hwpar);
+    return hwpar;
+}
+
 // Setup the amount of hardware parallelism, limited to maxThreads.
 static void setupAvailableParallelism(int32_t maxThreads) {
     int32_t   numThreadsPerLocale;
     int32_t   qtEnvThreads;
     chpl_bool noMultithread;
     int32_t   hwpar;
+    chpl_bool autotuned = false;
     char      newenv_workers[QT_ENV_S] = { 0 };
 
     // Experience has shown that Qthreads generally performs best with
@@ -491,6 +780,11 @@ static void setupAvailableParallelism(int32_t maxThreads) {
     else if (qtEnvThreads != 0) {
         hwpar = qtEnvThreads;
     }
+    // User did not set chapel or qthreads vars, but asked us to measure
+    else if (chpl_env_rt_get_bool("TASKS_AUTOTUNE", false)) {
+        hwpar = autotuneParallelism();
+        autotuned = true;
+    }
     // User did not set chapel or qthreads vars -- our default
     else {
         hwpar = chpl_topo_getNumCPUsPhysical(true);
@@ -551,6 +845,23 @@ static void setupAvailableParallelism(int32_t maxThreads) {
         if (CHPL_QTHREAD_SCHEDULER_ONE_WORKER_PER_SHEPHERD) {
             chpl_qt_setenv("NUM_SHEPHERDS", newenv_workers, 1);
             chpl_qt_setenv("NUM_WORKERS_PER_SHEPHERD", "1", 1);
+        } else if (autotuned
+                   && !CHPL_QTHREAD_TOPOLOGY_BINDERS
+                   && chpl_topo_getNumNumaDomains() > 1
+                   && hwpar % chpl_topo_getNumNumaDomains() == 0) {
+            // Give each NUMA domain a shepherd of its own, so that
+            // workers sharing a queue also share memory.
+            int numNumaDomains = chpl_topo_getNumNumaDomains();
+            char newenv_wps[QT_ENV_S] = { 0 };
+            char newenv_sheps[QT_ENV_S] = { 0 };
+            snprintf(newenv_sheps, sizeof(newenv_sheps), "%i", numNumaDomains);
+            snprintf(newenv_wps, sizeof(newenv_wps), "%i",
+                     (int) hwpar / numNumaDomains);
+            chpl_qt_setenv("NUM_SHEPHERDS", newenv_sheps, 1);
+            chpl_qt_setenv("NUM_WORKERS_PER_SHEPHERD", newenv_wps, 1);
+            printf("%d: QTHREADS: autotune: %s shepherds of %s workers, "
+                   "one per NUMA domain\n",
+                   (int) chpl_nodeID, newenv_sheps, newenv_wps);
         } else {
             chpl_qt_setenv("HWPAR", newenv_workers, 1);
         }
@@ -680,11 +991,36 @@ static void setupWorkStealing(void) {
     // try working stealing out by setting {QT,QTHREAD}_STEAL_RATIO. Also note
     // that not all schedulers support work stealing, but it doesn't hurt to
     // set this env var for those configs anyways.
-    chpl_qt_setenv("STEAL_RATIO", "0", 0);
+    //
+    // CHPL_RT_WORK_STEALING turns on the NUMA-aware stealing in the distrib
+    // scheduler instead. Steals from shepherds in the same NUMA domain (L3
+    // first) are preferred, and steals across domains are only attempted on
+    // every {QT,QTHREAD}_STEAL_REMOTE_RATIO-th try. This has no effect with
+    // the nemesis scheduler used by default for the flat locale model, or
+    // any other scheduler with one worker per shepherd, since those never
+    // steal; build with CHPL_QTHREAD_SCHEDULER=distrib to use it.
+    workStealingInUse = chpl_env_rt_get_bool("WORK_STEALING", false);
+    if (workStealingInUse && CHPL_QTHREAD_SCHEDULER_ONE_WORKER_PER_SHEPHERD) {
+        if (chpl_nodeID == 0) {
+            chpl_warning("CHPL_RT_WORK_STEALING has no effect with this "
+                         "Qthreads scheduler; it needs "
+                         "CHPL_QTHREAD_SCHEDULER=distrib", 0, 0);
+        }
+        workStealingInUse = false;
+    }
+    chpl_qt_setenv("STEAL_RATIO", workStealingInUse ? "8" : "0", 0);
 }
 
 static void setupSpinWaiting(void) {
   const char *crayPlatform = "cray-x";
+
+  // Unless the user asked for a fixed spin count, have idle workers
+  // learn how long to spin before parking.  The spin counts below are
+  // then only used by schedulers without adaptive spinning.
+  if (chpl_qt_getenv_str("SPINCOUNT") == NULL) {
+    chpl_qt_setenv("SPIN_ADAPTIVE", "1", 0);
+  }
+
   if (chpl_topo_isOversubscribed()) {
     chpl_qt_setenv("SPINCOUNT", "300", 0);
   } else if (strncmp(crayPlatform, CHPL_TARGET_PLATFORM, strlen(crayPlatform)) == 0) {
@@ -817,6 +1153,11 @@ void chpl_task_init(void)
     // QT_NUM_WORKERS_PER_SHEPHERD in which case we don't impose any limits on
     // the number of threads qthreads creates beforehand
     assert(0 == commMaxThreads || qthread_num_workers() < commMaxThreads);
+
+    movedTaskPrioritySize =
+      chpl_env_rt_get_int("MOVED_TASK_PRIORITY_SIZE", movedTaskPrioritySize);
+
+    task_prof_init();
 }
 
 void chpl_task_exit(void)
@@ -825,6 +1166,14 @@ void chpl_task_exit(void)
     profile_print();
 #endif /* CHAPEL_PROFILE */
 
+    task_prof_report();
+
+    if (workStealingInUse && verbosity >= 2) {
+        printf("%d: qthreads steals: %zu local, %zu remote\n",
+               (int) chpl_nodeID, qthread_readstate(LOCAL_STEALS),
+               qthread_readstate(REMOTE_STEALS));
+    }
+
     if (qthread_shep() == NO_SHEPHERD) {
         /* sometimes, tasking is told to shutdown even though it hasn't been
          * told to start yet */
@@ -860,6 +1209,7 @@ static aligned_t chapel_wrapper(void *arg)
     chpl_qthread_tls_t    *tls = chpl_qthread_get_tasklocal();
     chpl_task_bundle_t *bundle = chpl_argBundleTaskArgBundle(arg);
     chpl_qthread_tls_t      pv = {.bundle = bundle};
+    chpl_task_bundle_t     hdr;
 
     *tls = pv;
 
@@ -868,8 +1218,51 @@ static aligned_t chapel_wrapper(void *arg)
     // "Migrate" to ourself to mark the task as unstealable
     qthread_migrate_to(qthread_shep());
 
+    if (taskProfile)
+        task_prof_begin(tls);
+
+    // An in-place bundle belongs to our spawner, which may be done with
+    // it as soon as the body returns.
+    if (bundle->argsInPlace) {
+        hdr = *bundle;
+        (bundle->requested_fn)(arg);
+        bundle = &hdr;
+        tls->bundle = bundle;
+    } else {
+        (bundle->requested_fn)(arg);
+    }
+
+    if (taskProfile)
+        task_prof_end(tls, bundle);
+
+    wrap_callbacks(chpl_task_cb_event_kind_end, bundle);
+
+    return 0;
+}
+
+//
+// Wrapper for lightweight tasks.  These run to completion on the
+// worker's own stack, so there is nothing to migrate and the task
+// cannot be stolen once it has started.
+//
+static aligned_t chapel_simple_wrapper(void *arg)
+{
+    chpl_qthread_tls_t    *tls = chpl_qthread_get_tasklocal();
+    chpl_task_bundle_t *bundle = chpl_argBundleTaskArgBundle(arg);
+    chpl_qthread_tls_t      pv = {.bundle = bundle};
+
+    *tls = pv;
+
+    wrap_callbacks(chpl_task_cb_event_kind_begin, bundle);
+
+    if (taskProfile)
+        task_prof_begin(tls);
+
     (bundle->requested_fn)(arg);
 
+    if (taskProfile)
+        task_prof_end(tls, bundle);
+
     wrap_callbacks(chpl_task_cb_event_kind_end, bundle);
 
     return 0;
@@ -986,25 +1379,15 @@ int chpl_task_createCommTask(chpl_fn_p fn,
     return rc;
 }
 
-void chpl_task_addTask(chpl_fn_int_t       fid,
-                       chpl_task_bundle_t *arg,
-                       size_t              arg_size,
-                       c_sublocid_t        full_subloc,
-                       int                 lineno,
-                       int32_t             filename)
+static inline void addTaskBody(chpl_fn_int_t       fid,
+                               chpl_fn_p           requested_fn,
+                               chpl_task_bundle_t *arg,
+                               size_t              arg_size,
+                               c_sublocid_t        full_subloc,
+                               c_sublocid_t        execution_subloc,
+                               int                 lineno,
+                               int32_t             filename)
 {
-    chpl_fn_p requested_fn = chpl_ftable[fid];
-
-    // We allow using c_sublocid_none to represent the CPU in the gpu locale
-    // model. This isn't currently used by the numa (or other locale) models.
-    assert(isActualSublocID(full_subloc) || full_subloc == c_sublocid_none ||
-        !strcmp(CHPL_LOCALE_MODEL, "gpu"));
-
-    PROFILE_INCR(profile_task_addTask,1);
-
-    c_sublocid_t execution_subloc =
-      chpl_localeModel_sublocToExecutionSubloc(full_subloc);
-
     *arg = (chpl_task_bundle_t)
            { .kind            = CHPL_ARG_BUNDLE_KIND_TASK,
              .is_executeOn    = false,
@@ -1015,11 +1398,28 @@ void chpl_task_addTask(chpl_fn_int_t       fid,
              .requested_fn    = requested_fn,
              .id              = chpl_nullTaskID,
              .infoChapel      = arg->infoChapel, // retain; set by caller
+             .lightweight     = arg->lightweight, // ditto
+             .argsInPlace     = arg->argsInPlace, // ditto
+             .createTime      = taskProfile ? task_prof_now() : 0,
            };
 
     wrap_callbacks(chpl_task_cb_event_kind_create, arg);
 
-    if (execution_subloc == c_sublocid_none) {
+    if (arg->lightweight) {
+        qthread_spawn(chapel_simple_wrapper, arg, arg_size, NULL, 0, NULL,
+                      (execution_subloc == c_sublocid_none)
+                      ? NO_SHEPHERD
+                      : (qthread_shepherd_id_t) execution_subloc,
+                      QTHREAD_SPAWN_SIMPLE);
+    } else if (arg->argsInPlace) {
+        // no copy: qthreads is handed the caller's bundle itself
+        if (execution_subloc == c_sublocid_none) {
+            qthread_fork(chapel_wrapper, arg, NULL);
+        } else {
+            qthread_fork_to(chapel_wrapper, arg, NULL,
+                            (qthread_shepherd_id_t) execution_subloc);
+        }
+    } else if (execution_subloc == c_sublocid_none) {
         qthread_fork_copyargs(chapel_wrapper, arg, arg_size, NULL);
     } else {
         qthread_fork_copyargs_to(chapel_wrapper, arg, arg_size, NULL,
@@ -1027,9 +1427,59 @@ void chpl_task_addTask(chpl_fn_int_t       fid,
     }
 }
 
+void chpl_task_addTask(chpl_fn_int_t       fid,
+                       chpl_task_bundle_t *arg,
+                       size_t              arg_size,
+                       c_sublocid_t        full_subloc,
+                       int                 lineno,
+                       int32_t             filename)
+{
+    // We allow using c_sublocid_none to represent the CPU in the gpu locale
+    // model. This isn't currently used by the numa (or other locale) models.
+    assert(isActualSublocID(full_subloc) || full_subloc == c_sublocid_none ||
+        !strcmp(CHPL_LOCALE_MODEL, "gpu"));
+
+    PROFILE_INCR(profile_task_addTask,1);
+
+    addTaskBody(fid, chpl_ftable[fid], arg, arg_size, full_subloc,
+                chpl_localeModel_sublocToExecutionSubloc(full_subloc),
+                lineno, filename);
+}
+
+//
+// Qthreads already recycles task descriptors and stacks through its
+// per-worker memory pools, and copies small arguments into the
+// descriptor itself, so there is no separate allocation per task here.
+// What we save is the per-task lookups and locale model translation.
+//
+void chpl_task_addTasks(int                 n,
+                        chpl_fn_int_t       fid,
+                        chpl_task_bundle_t *args,
+                        size_t              arg_size,
+                        c_sublocid_t        full_subloc,
+                        int                 lineno,
+                        int32_t             filename)
+{
+    assert(isActualSublocID(full_subloc) || full_subloc == c_sublocid_none ||
+        !strcmp(CHPL_LOCALE_MODEL, "gpu"));
+
+    PROFILE_INCR(profile_task_addTask,n);
+
+    chpl_fn_p requested_fn = chpl_ftable[fid];
+    c_sublocid_t execution_subloc =
+      chpl_localeModel_sublocToExecutionSubloc(full_subloc);
+    for (int i = 0; i < n; i++) {
+        chpl_task_bundle_t *arg =
+          (chpl_task_bundle_t *) ((char *) args + i * arg_size);
+        addTaskBody(fid, requested_fn, arg, arg_size, full_subloc,
+                    execution_subloc, lineno, filename);
+    }
+}
+
 static inline void taskCallBody(chpl_fn_int_t fid, chpl_fn_p fp,
                                 void *arg, size_t arg_size,
                                 c_sublocid_t full_subloc,
+                                chpl_bool priority,
                                 int lineno, int32_t filename)
 {
     chpl_task_bundle_t *bundle = chpl_argBundleTaskArgBundle(arg);
@@ -1046,11 +1496,20 @@ static inline void taskCallBody(chpl_fn_int_t fid, chpl_fn_p fp,
                 .requested_fn    = fp,
                 .id              = chpl_nullTaskID,
                 .infoChapel      = bundle->infoChapel, // retain; set by caller
+                .lightweight     = false,
+                .argsInPlace     = false,
+                .createTime      = taskProfile ? task_prof_now() : 0,
               };
 
     wrap_callbacks(chpl_task_cb_event_kind_create, bundle);
 
-    if (execution_subloc < 0) {
+    if (priority) {
+        qthread_spawn(chapel_wrapper, arg, arg_size, NULL, 0, NULL,
+                      (execution_subloc < 0)
+                      ? NO_SHEPHERD
+                      : (qthread_shepherd_id_t) execution_subloc,
+                      QTHREAD_SPAWN_LOCAL_PRIORITY);
+    } else if (execution_subloc < 0) {
         qthread_fork_copyargs(chapel_wrapper, arg, arg_size, NULL);
     } else {
         qthread_fork_copyargs_to(chapel_wrapper, arg, arg_size, NULL,
@@ -1065,7 +1524,8 @@ void chpl_task_taskCallFTable(chpl_fn_int_t fid,
 {
     PROFILE_INCR(profile_task_taskCallFTable,1);
 
-    taskCallBody(fid, chpl_ftable[fid], arg, arg_size, subloc, lineno, filename);
+    taskCallBody(fid, chpl_ftable[fid], arg, arg_size, subloc, false,
+                 lineno, filename);
 }
 
 void chpl_task_startMovedTask(chpl_fn_int_t       fid,
@@ -1085,7 +1545,13 @@ void chpl_task_startMovedTask(chpl_fn_int_t       fid,
 
     PROFILE_INCR(profile_task_startMovedTask,1);
 
-    taskCallBody(fid, fp, arg, arg_size, subloc, 0, CHPL_FILE_IDX_UNKNOWN);
+    chpl_bool priority =
+      movedTaskPrioritySize >= 0
+      && arg_size - chpl_argBundleSizeofHdr(arg)
+         <= (size_t) movedTaskPrioritySize;
+
+    taskCallBody(fid, fp, arg, arg_size, subloc, priority,
+                 0, CHPL_FILE_IDX_UNKNOWN);
 }
 
 //
@@ -1132,8 +1598,183 @@ char* chpl_task_idToString(char* buff, size_t size, chpl_taskID_t id) {
     return NULL;
 }
 
+//
+// Sleeping tasks.  Rather than yielding until its time is up, a
+// sleeping task puts itself on a hierarchical timer wheel and blocks
+// on an FEB word of its own, which frees its worker.  A service
+// thread, started on first use, advances the wheel one tick at a time
+// while anything is on it and sleeps otherwise.  The tasks expiring
+// at each tick are woken by one short qthread that fills their words.
+//
+// The wheel has SLEEP_WHEEL0_SLOTS slots of one tick each, then
+// SLEEP_WHEEL1_SLOTS slots of SLEEP_WHEEL0_SLOTS ticks each whose
+// entries are cascaded down as the first level wraps, and an overflow
+// list for anything further out, re-sorted as the second level wraps.
+// Sleeps of less than a couple of ticks just yield, as before.
+//
+#define SLEEP_TICK_NS        1000000   // 1 ms
+#define SLEEP_WHEEL0_BITS    8
+#define SLEEP_WHEEL0_SLOTS   (1 << SLEEP_WHEEL0_BITS)
+#define SLEEP_WHEEL1_BITS    6
+#define SLEEP_WHEEL1_SLOTS   (1 << SLEEP_WHEEL1_BITS)
+
+typedef struct sleeper_s {
+    struct sleeper_s *next;
+    uint64_t          expiry;           // tick at which to wake
+    aligned_t         feb;              // filled to wake the task
+} sleeper_t;
+
+static pthread_once_t   sleepOnce = PTHREAD_ONCE_INIT;
+static pthread_mutex_t  sleepLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t   sleepCond;      // signaled when first task sleeps
+static uint64_t         sleepTick;      // last tick processed
+static size_t           sleepCount;     // number of tasks on the wheel
+static sleeper_t       *sleepWheel0[SLEEP_WHEEL0_SLOTS];
+static sleeper_t       *sleepWheel1[SLEEP_WHEEL1_SLOTS];
+static sleeper_t       *sleepOverflow;
+
+static inline uint64_t sleep_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// Assumes sleepLock is held.
+static void sleep_insert(sleeper_t *s)
+{
+    uint64_t delta = (s->expiry > sleepTick) ? s->expiry - sleepTick : 0;
+    sleeper_t **slot;
+
+    if (delta == 0) {
+        s->expiry = sleepTick + 1;
+        delta = 1;
+    }
+    if (delta < SLEEP_WHEEL0_SLOTS) {
+        slot = &sleepWheel0[s->expiry & (SLEEP_WHEEL0_SLOTS - 1)];
+    } else if (delta < (uint64_t) (SLEEP_WHEEL1_SLOTS - 1)
+                       * SLEEP_WHEEL0_SLOTS) {
+        slot = &sleepWheel1[(s->expiry >> SLEEP_WHEEL0_BITS)
+                            & (SLEEP_WHEEL1_SLOTS - 1)];
+    } else {
+        slot = &sleepOverflow;
+    }
+    s->next = *slot;
+    *slot = s;
+}
+
+// Re-insert everything on a list, relative to the current tick.
+// Assumes sleepLock is held.
+static void sleep_reinsert(sleeper_t **list)
+{
+    sleeper_t *s = *list;
+    *list = NULL;
+    while (s != NULL) {
+        sleeper_t *next = s->next;
+        sleep_insert(s);
+        s = next;
+    }
+}
+
+// Wake everything on a list of expired sleepers.
+static aligned_t sleep_wake(void *arg)
+{
+    sleeper_t *s = *(sleeper_t **) arg;
+    while (s != NULL) {
+        sleeper_t *next = s->next;   // s goes away once its task runs
+        qthread_fill(&s->feb);
+        s = next;
+    }
+    return 0;
+}
+
+static void *sleep_service(void *junk)
+{
+    pthread_mutex_lock(&sleepLock);
+    while (true) {
+        sleeper_t *expired = NULL;
+        uint64_t nowTick;
+
+        if (sleepCount == 0) {
+            pthread_cond_wait(&sleepCond, &sleepLock);
+            continue;
+        }
+
+        pthread_mutex_unlock(&sleepLock);
+        {
+            struct timespec ts = { 0, SLEEP_TICK_NS };
+            nanosleep(&ts, NULL);
+        }
+        pthread_mutex_lock(&sleepLock);
+
+        nowTick = sleep_now_ns() / SLEEP_TICK_NS;
+        while (sleepTick < nowTick) {
+            uint64_t t = ++sleepTick;
+            sleeper_t **slot;
+
+            if ((t & (SLEEP_WHEEL0_SLOTS - 1)) == 0) {
+                uint64_t t1 = t >> SLEEP_WHEEL0_BITS;
+                if ((t1 & (SLEEP_WHEEL1_SLOTS - 1)) == 0)
+                    sleep_reinsert(&sleepOverflow);
+                sleep_reinsert(&sleepWheel1[t1 & (SLEEP_WHEEL1_SLOTS - 1)]);
+            }
+
+            slot = &sleepWheel0[t & (SLEEP_WHEEL0_SLOTS - 1)];
+            while (*slot != NULL) {
+                sleeper_t *s = *slot;
+                *slot = s->next;
+                s->next = expired;
+                expired = s;
+                sleepCount--;
+            }
+        }
+
+        if (expired != NULL) {
+            pthread_mutex_unlock(&sleepLock);
+            qthread_fork_copyargs(sleep_wake, &expired, sizeof(expired), NULL);
+            pthread_mutex_lock(&sleepLock);
+        }
+    }
+    return NULL;
+}
+
+static void sleep_service_start(void)
+{
+    pthread_t thread;
+
+    if (pthread_cond_init(&sleepCond, NULL))
+        chpl_internal_error("pthread_cond_init() failed");
+    sleepTick = sleep_now_ns() / SLEEP_TICK_NS;
+    if (pthread_create(&thread, NULL, sleep_service, NULL)
+        || pthread_detach(thread))
+        chpl_internal_error("could not start sleep service thread");
+}
+
 void chpl_task_sleep(double secs)
 {
+    if (qthread_shep() != NO_SHEPHERD && secs * 1.0e9 >= 2 * SLEEP_TICK_NS) {
+        uint64_t deadline = sleep_now_ns() + (uint64_t) (secs * 1.0e9);
+        sleeper_t s;
+
+        (void) pthread_once(&sleepOnce, sleep_service_start);
+
+        qthread_empty(&s.feb);
+        s.expiry = (deadline + SLEEP_TICK_NS - 1) / SLEEP_TICK_NS;
+
+        pthread_mutex_lock(&sleepLock);
+        sleep_insert(&s);
+        if (sleepCount++ == 0)
+            pthread_cond_signal(&sleepCond);
+        pthread_mutex_unlock(&sleepLock);
+
+        qthread_readFF(NULL, &s.feb);
+
+        // The tick may have run out a little early; finish up by yielding.
+        while (sleep_now_ns() < deadline)
+            qthread_yield();
+        return;
+    }
+
     if (qthread_shep() == NO_SHEPHERD) {
         struct timeval deadline;
         struct timeval now;
@@ -1167,6 +1808,195 @@ void chpl_task_sleep(double secs)
     }
 }
 
+//
+// Tasks waiting for file descriptors.  Like sleeping tasks, a waiting
+// task blocks on an FEB word of its own, freeing its worker.  A
+// service thread, started on first use, polls for all of the waiting
+// tasks at once, plus a wakeup descriptor that tells it about new
+// ones.  The tasks whose descriptors become ready are woken by one
+// short qthread, as for sleepers.
+//
+typedef struct fd_waiter_s {
+    struct fd_waiter_s *next;
+    struct pollfd      *fds;
+    int                 nfds;
+    int                 result;         // poll() result for this task
+    aligned_t           feb;            // filled to wake the task
+} fd_waiter_t;
+
+static pthread_once_t   fdWaitOnce = PTHREAD_ONCE_INIT;
+static pthread_mutex_t  fdWaitLock = PTHREAD_MUTEX_INITIALIZER;
+static fd_waiter_t     *fdWaiters;      // not yet being polled for
+static int              fdWakeRead = -1;
+static int              fdWakeWrite = -1;
+
+static void fd_wait_notify(void)
+{
+    uint64_t one = 1;
+    ssize_t rc;
+    do {
+        rc = write(fdWakeWrite, &one, (fdWakeRead == fdWakeWrite)
+                                      ? sizeof(one) : 1);
+    } while (rc == -1 && errno == EINTR);
+}
+
+static void fd_wait_drain(void)
+{
+    uint64_t buf[8];
+    while (read(fdWakeRead, buf, sizeof(buf)) > 0)
+        ;
+}
+
+static aligned_t fd_wake(void *arg)
+{
+    fd_waiter_t *w = *(fd_waiter_t **) arg;
+    while (w != NULL) {
+        fd_waiter_t *next = w->next;    // w goes away once its task runs
+        qthread_fill(&w->feb);
+        w = next;
+    }
+    return 0;
+}
+
+static void *fd_wait_service(void *junk)
+{
+    fd_waiter_t   *polling = NULL;      // the ones in pfds, in order
+    struct pollfd *pfds = NULL;
+    size_t         npfds = 0;
+    size_t         maxpfds = 0;
+
+    while (true) {
+        fd_waiter_t  *ready = NULL;
+        fd_waiter_t **wp;
+        size_t        k;
+
+        // Take on any new waiters and rebuild the poll set.
+        pthread_mutex_lock(&fdWaitLock);
+        while (fdWaiters != NULL) {
+            fd_waiter_t *w = fdWaiters;
+            fdWaiters = w->next;
+            w->next = polling;
+            polling = w;
+        }
+        pthread_mutex_unlock(&fdWaitLock);
+
+        npfds = 1;
+        for (fd_waiter_t *w = polling; w != NULL; w = w->next)
+            npfds += w->nfds;
+        if (npfds > maxpfds) {
+            maxpfds = 2 * npfds;
+            // This thread isn't a task, so use the system allocator.
+            pfds = (struct pollfd *) sys_realloc(pfds,
+                                                 maxpfds * sizeof(*pfds));
+            if (pfds == NULL)
+                chpl_internal_error("out of memory in fd wait service");
+        }
+        pfds[0].fd = fdWakeRead;
+        pfds[0].events = POLLIN;
+        pfds[0].revents = 0;
+        k = 1;
+        for (fd_waiter_t *w = polling; w != NULL; w = w->next) {
+            memcpy(&pfds[k], w->fds, w->nfds * sizeof(*pfds));
+            k += w->nfds;
+        }
+
+        if (poll(pfds, (nfds_t) npfds, -1) == -1) {
+            if (errno != EINTR && errno != EAGAIN)
+                chpl_internal_error("poll() failed in fd wait service");
+            continue;
+        }
+
+        if (pfds[0].revents != 0)
+            fd_wait_drain();
+
+        // Hand back the results for the tasks with anything ready.
+        k = 1;
+        wp = &polling;
+        while (*wp != NULL) {
+            fd_waiter_t *w = *wp;
+            int nready = 0;
+            for (int i = 0; i < w->nfds; i++) {
+                w->fds[i].revents = pfds[k + i].revents;
+                if (pfds[k + i].revents != 0)
+                    nready++;
+            }
+            k += w->nfds;
+            if (nready > 0) {
+                w->result = nready;
+                *wp = w->next;
+                w->next = ready;
+                ready = w;
+            } else {
+                wp = &w->next;
+            }
+        }
+
+        if (ready != NULL)
+            qthread_fork_copyargs(fd_wake, &ready, sizeof(ready), NULL);
+    }
+    return NULL;
+}
+
+static void fd_wait_service_start(void)
+{
+    pthread_t thread;
+
+#ifdef __linux__
+    fdWakeRead = fdWakeWrite = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fdWakeRead == -1)
+#endif
+    {
+        int p[2];
+        if (pipe(p) != 0
+            || fcntl(p[0], F_SETFL, O_NONBLOCK) != 0
+            || fcntl(p[1], F_SETFL, O_NONBLOCK) != 0)
+            chpl_internal_error("could not create fd wait service wakeup");
+        fdWakeRead = p[0];
+        fdWakeWrite = p[1];
+    }
+
+    if (pthread_create(&thread, NULL, fd_wait_service, NULL)
+        || pthread_detach(thread))
+        chpl_internal_error("could not start fd wait service thread");
+}
+
+int chpl_task_waitFds(struct pollfd *fds, int nfds)
+{
+    fd_waiter_t w;
+    int rc;
+
+    // Don't bother the service if something is ready already, or if
+    // there's no task to park.
+    do {
+        rc = poll(fds, (nfds_t) nfds, 0);
+    } while (rc == -1 && errno == EINTR);
+    if (rc != 0 || nfds <= 0)
+        return rc;
+
+    if (qthread_shep() == NO_SHEPHERD) {
+        do {
+            rc = poll(fds, (nfds_t) nfds, -1);
+        } while (rc == -1 && errno == EINTR);
+        return rc;
+    }
+
+    (void) pthread_once(&fdWaitOnce, fd_wait_service_start);
+
+    qthread_empty(&w.feb);
+    w.fds = fds;
+    w.nfds = nfds;
+    w.result = 0;
+
+    pthread_mutex_lock(&fdWaitLock);
+    w.next = fdWaiters;
+    fdWaiters = &w;
+    pthread_mutex_unlock(&fdWaitLock);
+    fd_wait_notify();
+
+    qthread_readFF(NULL, &w.feb);
+    return w.result;
+}
+
 uint32_t chpl_task_getMaxPar(void) {
     //
     // We assume here that the caller (in the LocaleModel module code)
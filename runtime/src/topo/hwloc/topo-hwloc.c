@@ -30,6 +30,7 @@
 #include "chplsys.h"
 #include "chpl-topo.h"
 #include "chpl-comm.h"
+#include "arg.h"
 #include "chpltypes.h"
 #include "error.h"
 #include "chpl-mem-sys.h"
@@ -651,6 +652,19 @@ static void partitionResources(void) {
         _DBG_P("getting our root object");
         int numCores = hwloc_get_nbobjs_by_type(topology, HWLOC_OBJ_CORE);
         int numObjs = hwloc_get_nbobjs_by_type(topology, myRootType);
+        if (numObjs != numPartitions &&
+            chpl_env_rt_get_bool("COLOCALE_AUTO", false)) {
+          // the launcher counted them on a different kind of node
+          char msg[200];
+          snprintf(msg, sizeof(msg),
+                   "Co-locales were sized for %d %s(s) per node, but this "
+                   "node has %d", numPartitions, objTypeString(myRootType),
+                   numObjs);
+          if (numObjs < numPartitions) {
+            chpl_error(msg, 0, 0);
+          }
+          chpl_warning(msg, 0, 0);
+        }
         if (numObjs < numPartitions) {
           char msg[200];
           snprintf(msg, sizeof(msg), "Node only has %d %s(s)", numObjs,
@@ -845,6 +859,25 @@ static void partitionResources(void) {
 
 #undef NEXT_OBJ
 
+static void printTopoReport(void) {
+  char buf[1024];
+
+  hwloc_bitmap_list_snprintf(buf, sizeof(buf), physAccSet);
+  printf("%d: topology: %d core(s) (%s), %d PU(s), %d NUMA domain(s)\n",
+         chpl_nodeID, chpl_topo_getNumCPUsPhysical(true),
+         buf, chpl_topo_getNumCPUsLogical(true), numNumaDomains);
+
+  for (int level = 1; level <= 5; level++) {
+    size_t size, lineSize;
+    int sharingPUs;
+    if (chpl_topo_getCacheInfo(level, &size, &lineSize, &sharingPUs) == 0) {
+      printf("%d: topology: L%d cache %zu KiB, %zu-byte lines, "
+             "shared by %d PU(s)\n",
+             chpl_nodeID, level, size / 1024, lineSize, sharingPUs);
+    }
+  }
+}
+
 void chpl_topo_post_args_init(void) {
   char buf[1024];
   if (verbosity >= 2) {
@@ -857,6 +890,9 @@ void chpl_topo_post_args_init(void) {
       putchar('\n');
     }
   }
+  if (chpl_topoReportRequested()) {
+    printTopoReport();
+  }
 }
 
 //
@@ -895,6 +931,40 @@ int chpl_topo_getNumNumaDomains(void) {
 }
 
 
+int chpl_topo_getCacheInfo(int level, size_t* size, size_t* lineSize,
+                           int* sharingPUs) {
+  hwloc_obj_type_t type;
+  *size = 0;
+  *lineSize = 0;
+  *sharingPUs = 0;
+
+  switch (level) {
+  case 1: type = HWLOC_OBJ_L1CACHE; break;
+  case 2: type = HWLOC_OBJ_L2CACHE; break;
+  case 3: type = HWLOC_OBJ_L3CACHE; break;
+  case 4: type = HWLOC_OBJ_L4CACHE; break;
+  case 5: type = HWLOC_OBJ_L5CACHE; break;
+  default: return 1;
+  }
+
+  // the first one that one of our PUs uses
+  hwloc_obj_t obj = NULL;
+  while ((obj = hwloc_get_next_obj_by_type(topology, type, obj)) != NULL) {
+    if (hwloc_bitmap_intersects(obj->cpuset, logAccSet)) {
+      break;
+    }
+  }
+  if (obj == NULL) {
+    return 1;
+  }
+
+  *size = obj->attr->cache.size;
+  *lineSize = obj->attr->cache.linesize;
+  *sharingPUs = hwloc_bitmap_weight(obj->cpuset);
+  return 0;
+}
+
+
 void chpl_topo_setThreadLocality(c_sublocid_t subloc) {
   hwloc_cpuset_t cpuset;
   int flags;
@@ -1033,8 +1103,9 @@ void chpl_topo_touchMemFromSubloc(void* p, size_t size, chpl_bool onlyInside,
 
   CHK_ERR_ERRNO((cpuset = hwloc_bitmap_alloc()) != NULL);
 
+  // Save our current binding, so we can restore it afterward.
   flags = HWLOC_CPUBIND_THREAD;
-  CHK_ERR_ERRNO(hwloc_set_cpubind(topology, cpuset, flags) == 0);
+  CHK_ERR_ERRNO(hwloc_get_cpubind(topology, cpuset, flags) == 0);
 
   chpl_topo_setThreadLocality(subloc);
 
@@ -23,16 +23,33 @@
 //
 #include "chplrt.h"
 
+#include "arg.h"
 #include "chplsys.h"
+#include "chpl-comm.h"
 #include "chpl-topo.h"
 #include "chpltypes.h"
 #include "error.h"
 
 #include <stdint.h>
+#include <stdio.h>
+#include <unistd.h>
 
 void chpl_topo_pre_comm_init(char *accessiblePUsMask) { }
 void chpl_topo_post_comm_init(void) { }
-void chpl_topo_post_args_init(void) { }
+void chpl_topo_post_args_init(void) {
+  if (chpl_topoReportRequested()) {
+    printf("%d: topology: %d PU(s), no further information without hwloc\n",
+           chpl_nodeID, chpl_topo_getNumCPUsLogical(true));
+    for (int level = 1; level <= 4; level++) {
+      size_t size, lineSize;
+      int sharingPUs;
+      if (chpl_topo_getCacheInfo(level, &size, &lineSize, &sharingPUs) == 0) {
+        printf("%d: topology: L%d cache %zu KiB, %zu-byte lines\n",
+               chpl_nodeID, level, size / 1024, lineSize);
+      }
+    }
+  }
+}
 
 void chpl_topo_exit(void) { }
 
@@ -76,6 +93,44 @@ int chpl_topo_getNumNumaDomains(void) {
 }
 
 
+//
+// Without hwloc all we have is what sysconf() knows, where it knows it.
+// It doesn't say which PUs share a cache.
+//
+int chpl_topo_getCacheInfo(int level, size_t* size, size_t* lineSize,
+                           int* sharingPUs) {
+  long sz = -1, line = -1;
+
+  switch (level) {
+#ifdef _SC_LEVEL1_DCACHE_SIZE
+  case 1:
+    sz = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+    line = sysconf(_SC_LEVEL1_DCACHE_LINESIZE);
+    break;
+  case 2:
+    sz = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    line = sysconf(_SC_LEVEL2_CACHE_LINESIZE);
+    break;
+  case 3:
+    sz = sysconf(_SC_LEVEL3_CACHE_SIZE);
+    line = sysconf(_SC_LEVEL3_CACHE_LINESIZE);
+    break;
+  case 4:
+    sz = sysconf(_SC_LEVEL4_CACHE_SIZE);
+    line = sysconf(_SC_LEVEL4_CACHE_LINESIZE);
+    break;
+#endif
+  default:
+    break;
+  }
+
+  *size = sz > 0 ? (size_t)sz : 0;
+  *lineSize = line > 0 ? (size_t)line : 0;
+  *sharingPUs = 0;
+  return *size > 0 ? 0 : 1;
+}
+
+
 void chpl_topo_setThreadLocality(c_sublocid_t subloc) { }
 
 
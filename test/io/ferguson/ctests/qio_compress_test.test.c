@@ -0,0 +1,129 @@
+#include "qio.h"
+#include "qio_compress.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+unsigned char data_at(int64_t offset)
+{
+  // compressible, but not too much
+  return 'a' + ((offset * 7 + offset / 1000) % 8) + (offset % 97 == 0);
+}
+
+void fill_testdata(int64_t start, int64_t len, unsigned char* data)
+{
+  int64_t k;
+  for( k = 0; k < len; k++ ) {
+    data[k] = data_at(start+k);
+  }
+}
+
+void check_compress(int64_t len, int64_t blocksz, int nthreads)
+{
+  const char* filename = "test.bin";
+  qio_file_t* f;
+  qio_channel_t* ch;
+  unsigned char* expect;
+  unsigned char* got;
+  int64_t offset;
+  int64_t k;
+  qioerr err;
+  int64_t seeks[6];
+
+  qio_compress_block_size = blocksz;
+  qio_compress_threads = nthreads;
+
+  expect = (unsigned char*) qio_malloc(len + 1);
+  got = (unsigned char*) qio_malloc(len + 1);
+  fill_testdata(0, len, expect);
+
+  unlink(filename);
+
+  // Write in uneven pieces with a flush halfway through, so that
+  // there's a short block in the middle.
+  err = qio_file_open_access(&f, filename, "w", QIO_HINT_COMPRESS, NULL);
+  assert(!err);
+  err = qio_channel_create(&ch, f, 0, 0, 1, 0, INT64_MAX, NULL, 0);
+  assert(!err);
+  for( offset = 0; offset < len; ) {
+    int64_t amt = 1 + (offset * 31) % 100000;
+    if( offset + amt > len ) amt = len - offset;
+    err = qio_channel_write_amt(true, ch, expect + offset, amt);
+    assert(!err);
+    if( offset < len/2 && offset + amt >= len/2 ) {
+      err = qio_channel_flush(true, ch);
+      assert(!err);
+    }
+    offset += amt;
+  }
+  err = qio_channel_close(true, ch);
+  assert(!err);
+  qio_channel_release(ch);
+
+  // Compressing channels can't read or start in the middle.
+  err = qio_channel_create(&ch, f, 0, 0, 1, 10, INT64_MAX, NULL, 0);
+  assert(qio_err_to_int(err) == EINVAL);
+  qio_file_release(f);
+
+  // Read it back in different uneven pieces.
+  err = qio_file_open_access(&f, filename, "r", 0, NULL);
+  assert(!err);
+  assert(f->compress_codec != QIO_COMPRESS_NONE);
+  assert(qio_file_length(f, &k) == 0 && k < len);
+  err = qio_channel_create(&ch, f, 0, 1, 0, 0, INT64_MAX, NULL, 0);
+  assert(!err);
+  memset(got, 0, len);
+  for( offset = 0; offset < len; ) {
+    int64_t amt = 1 + (offset * 17) % 70000;
+    if( offset + amt > len ) amt = len - offset;
+    err = qio_channel_read_amt(true, ch, got + offset, amt);
+    assert(!err);
+    offset += amt;
+  }
+  assert(memcmp(got, expect, len) == 0);
+  err = qio_channel_read_amt(true, ch, got, 1);
+  assert(qio_err_to_int(err) == EEOF);
+
+  // Seek backwards and forwards.
+  seeks[0] = len / 3;
+  seeks[1] = 5;
+  seeks[2] = len - 10;
+  seeks[3] = blocksz;
+  seeks[4] = blocksz - 1;
+  seeks[5] = 0;
+  for( k = 0; k < 6; k++ ) {
+    if( seeks[k] < 0 || seeks[k] + 10 > len ) continue;
+    err = qio_channel_seek(ch, seeks[k], INT64_MAX);
+    assert(!err);
+    err = qio_channel_read_amt(true, ch, got, 10);
+    assert(!err);
+    assert(memcmp(got, expect + seeks[k], 10) == 0);
+  }
+  qio_channel_release(ch);
+
+  // A reader starting in the middle.
+  err = qio_channel_create(&ch, f, 0, 1, 0, len / 2 + 3, INT64_MAX, NULL, 0);
+  assert(!err);
+  err = qio_channel_read_amt(true, ch, got, len - (len / 2 + 3));
+  assert(!err);
+  assert(memcmp(got, expect + len / 2 + 3, len - (len / 2 + 3)) == 0);
+  qio_channel_release(ch);
+
+  qio_file_release(f);
+  unlink(filename);
+
+  qio_free(expect);
+  qio_free(got);
+}
+
+int main(int argc, char** argv)
+{
+  check_compress(3*1024*1024 + 12345, 256*1024, 4);
+  check_compress(1000000, 4096, 3);
+  check_compress(100, 64*1024, 1);
+
+  printf("qio_compress_test PASS\n");
+
+  return 0;
+}
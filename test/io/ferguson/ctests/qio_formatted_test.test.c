@@ -395,7 +395,7 @@ void test_printscan_float(void)
   qio_channel_t* writing;
   qio_channel_t* reading;
 
-#define NSTYLES 9
+#define NSTYLES 10
   qio_style_t styles[NSTYLES];
 
   const char* zero[] = { // writing 0
@@ -408,6 +408,7 @@ void test_printscan_float(void)
                         "0.0000", // %g, 4 significant digits
                         "0.0000", // %f, showpoint, precision 4
                         "0.0000e+00", // %e, showpoint, precision 4
+                        "0", // shortest round-trip
                        };
 
   const char* one[] = { // writing 1
@@ -420,6 +421,7 @@ void test_printscan_float(void)
                         "1.0000", // %g, 4 significant digits
                         "1.0000", // %f, showpoint, precision 4
                         "1.0000e+00", // %e, showpoint, precision 4
+                        "1", // shortest round-trip
                        };
 
   const char* pos[] = { // writing 11.25
@@ -432,6 +434,7 @@ void test_printscan_float(void)
                         "11.25", // %g, 4 significant digits
                         "11.2500", // %f, showpoint, precision 4
                         "1.1250e+01", // %e, showpoint, precision 4
+                        "11.25", // shortest round-trip
                        };
 
   const char* neg[] = { // writing -11.25
@@ -444,6 +447,7 @@ void test_printscan_float(void)
                         "-11.25", // %g, 4 significant digits
                         "-11.2500", // %f, showpoint, precision 4
                         "-1.1250e+01", // %e, showpoint, precision 4
+                        "-11.25", // shortest round-trip
                        };
 
   const char* plusinf[] = { // writing +infinity
@@ -456,6 +460,7 @@ void test_printscan_float(void)
                         "inf", // %g, 4 significant digits
                         "inf", // %f, showpoint, precision 4
                         "inf", // %e, showpoint, precision 4
+                        "inf", // shortest round-trip
                        };
   const char* minusinf[] = { // writing +infinity
                         "-inf", // default style
@@ -467,6 +472,7 @@ void test_printscan_float(void)
                         "-inf", // %g, 4 significant digits
                         "-inf", // %f, showpoint, precision 4
                         "-inf", // %e, showpoint, precision 4
+                        "-inf", // shortest round-trip
                        };
   const char* nan[] = { // writing nan
                         "nan", // default style
@@ -478,6 +484,7 @@ void test_printscan_float(void)
                         "nan", // %g, 4 significant digits
                         "nan", // %f, showpoint, precision 4
                         "nan", // %e, showpoint, precision 4
+                        "nan", // shortest round-trip
                        };
   const char* nnan[] = { // writing nan
                         "nan", // default style
@@ -489,6 +496,7 @@ void test_printscan_float(void)
                         "nan", // %g, 4 significant digits
                         "nan", // %f, showpoint, precision 4
                         "nan", // %e, showpoint, precision 4
+                        "nan", // shortest round-trip
                        };
   const char* x[] = { // writing 1.125e+300
                         "1.125e+300", // default style
@@ -505,6 +513,7 @@ void test_printscan_float(void)
                         "1.125e+300", // %g, 4 significant digits
                         "1124999999999999984717009863215819639889402******************************************************************************************************************************************************************************************************************************************************************.0000", // %f, showpoint, precision 4
                         "1.1250e+300", // %e, showpoint, precision 4
+                        "1.125e+300", // shortest round-trip
                        };
   const char* y[] = { // writing 6.125e-300,
                         "6.125e-300", // default style
@@ -516,6 +525,7 @@ void test_printscan_float(void)
                         "6.125e-300", // %g, 4 significant digits
                         "0.0000", // %f, showpoint, precision 4
                         "6.1250e-300", // %e, showpoint, precision 4
+                        "6.125e-300", // shortest round-trip
                        };
   const char* large[] = { // writing 1.7206679531457315e+308
                         "1.72067e+308", // default style
@@ -532,6 +542,7 @@ void test_printscan_float(void)
                         "1.721e+308", // %g, 4 significant digits
                         "1720667953145731543457459681945095582860664**************************************************************************************************************************************************************************************************************************************************************************.0000", // %f, showpoint, precision 4
                         "1.7207e+308", // %e, showpoint, precision 4
+                        "1.7206679531457315e+308", // shortest round-trip
                        };
   const char* small[] = { // writing 4.2594736637394926356874e-308
                         "4.25947e-308", // default style
@@ -543,6 +554,7 @@ void test_printscan_float(void)
                         "4.259e-308", // %g, 4 significant digits
                         "0.0000", // %f, showpoint, precision 4
                         "4.2595e-308", // %e, showpoint, precision 4
+                        "4.2594736637394926e-308", // shortest round-trip
                        };
   double mynan = NAN; // 0.0*(1.0/0.0);
   double posnan = copysign(mynan, 1.0);
@@ -607,6 +619,8 @@ void test_printscan_float(void)
   styles[8].precision = 4;
   styles[8].realfmt = 2;
 
+  // 9 has shortest round-trip
+  styles[9].realfmt = 3;
 
   // Open a temporary file.
   err = qio_file_open_tmp(&f, 0, NULL);
@@ -1492,6 +1506,241 @@ void test_quoted_string_maxlength(void)
   if( verbose ) printf("PASS: quoted max length\n");
 }
 
+// Bulk array reads and writes must match element-at-a-time ones.
+void test_array(void)
+{
+  int64_t counts[] = {7, 100003};
+  size_t sizes[] = {1, 2, 4, 8};
+  int orders[] = {QIO_NATIVE, QIO_BIG, QIO_LITTLE};
+  int64_t maxcount = 100003;
+  unsigned char* data = (unsigned char*) qio_malloc(8*maxcount);
+  unsigned char* got = (unsigned char*) qio_malloc(8*maxcount + 1);
+  unsigned char* expect = (unsigned char*) qio_malloc(8*maxcount);
+  qioerr err;
+  int64_t k;
+
+  if( verbose ) printf("Testing array read/write\n");
+
+  for( k = 0; k < 8*maxcount; k++ ) data[k] = (unsigned char) (k * 131 + k / 7);
+
+  for( int c = 0; c < 2; c++ ) {
+    for( int z = 0; z < 4; z++ ) {
+      for( int o = 0; o < 3; o++ ) {
+        int64_t count = counts[c];
+        size_t eltsize = sizes[z];
+        int byteorder = orders[o];
+        qio_file_t* f;
+        qio_channel_t* ch;
+
+        // What element-at-a-time writes produce.
+        err = qio_file_open_tmp(&f, 0, NULL);
+        assert(!err);
+        err = qio_channel_create(&ch, f, QIO_CH_BUFFERED, 0, 1, 0, INT64_MAX, NULL, 0);
+        assert(!err);
+        for( k = 0; k < count; k++ ) {
+          err = qio_channel_write_int(true, byteorder, ch, data + k*eltsize, eltsize, 0);
+          assert(!err);
+        }
+        qio_channel_release(ch);
+        err = qio_channel_create(&ch, f, QIO_CH_BUFFERED, 1, 0, 0, INT64_MAX, NULL, 0);
+        assert(!err);
+        err = qio_channel_read_amt(true, ch, expect, count*eltsize);
+        assert(!err);
+        qio_channel_release(ch);
+
+        // An odd start so the buffer isn't aligned.
+        err = qio_channel_create(&ch, f, QIO_CH_BUFFERED, 0, 1, 0, INT64_MAX, NULL, 0);
+        assert(!err);
+        err = qio_channel_write_uint8(true, ch, 0xff);
+        assert(!err);
+        err = qio_channel_write_array(true, byteorder, ch, data, count, eltsize);
+        assert(!err);
+        qio_channel_release(ch);
+        err = qio_channel_create(&ch, f, QIO_CH_BUFFERED, 1, 0, 0, INT64_MAX, NULL, 0);
+        assert(!err);
+        err = qio_channel_read_amt(true, ch, got, 1 + count*eltsize);
+        assert(!err);
+        assert(got[0] == 0xff);
+        assert(memcmp(got + 1, expect, count*eltsize) == 0);
+        qio_channel_release(ch);
+
+        err = qio_channel_create(&ch, f, QIO_CH_BUFFERED, 1, 0, 1, INT64_MAX, NULL, 0);
+        assert(!err);
+        memset(got, 0, count*eltsize);
+        err = qio_channel_read_array(true, byteorder, ch, got, count, eltsize);
+        assert(!err);
+        assert(memcmp(got, data, count*eltsize) == 0);
+        err = qio_channel_read_array(true, byteorder, ch, got, 1, eltsize);
+        assert(qio_err_to_int(err) == EEOF);
+        qio_channel_release(ch);
+
+        qio_file_release(f);
+      }
+    }
+  }
+
+  err = qio_channel_write_array(true, QIO_BIG, NULL, data, 1, 3);
+  assert(qio_err_to_int(err) == EINVAL);
+
+  qio_free(data);
+  qio_free(got);
+  qio_free(expect);
+}
+
+void test_read_chars(void)
+{
+  const char* piece = "plain ascii text, h\xC3\xA9llo \xE2\x82\xAC \xF0\xA4\xAD\xA2 ";
+  size_t piecelen = strlen(piece);
+  int reps = 40;
+  size_t len = piecelen * reps;
+  char* text = (char*) qio_malloc(len + 1);
+  char* got = (char*) qio_malloc(len + 1);
+  int64_t ncp;
+  ssize_t maxes[] = {1, 3, 4, 17, 1000000};
+  qio_file_t* f;
+  qio_channel_t* ch;
+  qioerr err;
+
+  if( verbose ) printf("Testing read_chars\n");
+
+  for( int k = 0; k < reps; k++ ) memcpy(text + k*piecelen, piece, piecelen);
+  text[len] = '\0';
+  assert(chpl_enc_validate_buf(text, len, &ncp) == 0);
+
+  err = qio_file_open_tmp(&f, 0, NULL);
+  assert(!err);
+  err = qio_channel_create(&ch, f, QIO_CH_BUFFERED, 0, 1, 0, INT64_MAX, NULL, 0);
+  assert(!err);
+  err = qio_channel_write_amt(true, ch, text, len);
+  assert(!err);
+  // an invalid sequence, then a truncated one
+  err = qio_channel_write_amt(true, ch, "ab\xC0\x80z\xE2\x82", 7);
+  assert(!err);
+  qio_channel_release(ch);
+
+  for( int b = 0; b < 5; b++ ) {
+    for( int c = 0; c < 5; c++ ) {
+      ssize_t nBytes = 0;
+      int64_t nCodepoints = 0;
+      ssize_t gotBytes, gotCodepoints;
+      char tail[8];
+
+      err = qio_channel_create(&ch, f, QIO_CH_BUFFERED, 1, 0, 0, INT64_MAX, NULL, 0);
+      assert(!err);
+      while( nBytes < (ssize_t) len ) {
+        ssize_t maxBytes = maxes[b];
+        if( maxBytes > (ssize_t) len - nBytes ) maxBytes = len - nBytes;
+        err = qio_channel_read_chars(true, ch, got + nBytes, maxBytes,
+                                     maxes[c], &gotBytes, &gotCodepoints);
+        assert(!err);
+        assert(gotBytes <= maxBytes && gotCodepoints <= maxes[c]);
+        // only a codepoint that doesn't fit stops it early
+        assert(gotBytes > maxBytes - 4 || gotCodepoints == maxes[c]);
+        if( maxBytes >= 4 ) assert(gotCodepoints > 0);
+        if( gotBytes == 0 ) break;
+        nBytes += gotBytes;
+        nCodepoints += gotCodepoints;
+      }
+      if( nBytes < (ssize_t) len ) {
+        // maxBytes of 1 or 3 can't hold the codepoint at nBytes
+        assert(maxes[b] < 4);
+        qio_channel_release(ch);
+        continue;
+      }
+      assert(memcmp(got, text, len) == 0);
+      assert(nCodepoints == ncp);
+
+      err = qio_channel_read_chars(true, ch, tail, 8, 8,
+                                   &gotBytes, &gotCodepoints);
+      assert(qio_err_to_int(err) == EILSEQ);
+      assert(gotCodepoints == 2 && memcmp(tail, "ab", 2) == 0);
+      qio_channel_release(ch);
+    }
+  }
+
+  qio_file_release(f);
+  qio_free(text);
+  qio_free(got);
+}
+
+void test_conv_prog(void)
+{
+  const char* fmts[] = {
+    "x=%i y=%5.2dr\n  %s%%%{###.##}",
+    "%{/a+b/i}%{   %xu}",
+    "%q",           // bad conversion, parsing stops there
+    "",
+    NULL
+  };
+  char copy[64];
+  int scanning;
+  int k;
+
+  for( scanning = 0; scanning < 2; scanning++ ) {
+    for( k = 0; fmts[k]; k++ ) {
+      const char* fmt = fmts[k];
+      size_t len = strlen(fmt);
+      qio_conv_prog_t* prog = NULL;
+      qio_conv_prog_t* again = NULL;
+      size_t i = 0;
+      int64_t n = 0;
+      qioerr err;
+
+      err = qio_conv_prog_lookup(fmt, len, scanning, &prog);
+      assert(!err);
+
+      // It should match parsing the string one conversion at a time.
+      while( i < len ) {
+        qio_conv_t spec;
+        qio_style_t style;
+        uint64_t end = 0;
+
+        err = qio_conv_parse(fmt, i, &end, scanning, &spec, &style, 0, 0);
+        assert(n < prog->num_convs);
+        assert(prog->ends[n] == end);
+        assert(prog->convs[n].argType == spec.argType);
+        assert(prog->convs[n].literal_length == spec.literal_length);
+        if( spec.literal_length ) {
+          assert(0 == memcmp(prog->convs[n].literal, spec.literal,
+                             spec.literal_length));
+        }
+        assert(0 == memcmp(&prog->styles[n], &style, sizeof(style)));
+        n++;
+        if( err ) {
+          assert(prog->err);
+          break;
+        }
+        i = end;
+      }
+      assert(n == prog->num_convs);
+
+      // The second time, it comes from the cache...
+      err = qio_conv_prog_lookup(fmt, len, scanning, &again);
+      assert(!err);
+      assert(again == prog);
+      qio_conv_prog_release(again);
+
+      // ...but not for a different string at the same address.
+      assert(len < sizeof(copy));
+      memcpy(copy, fmt, len + 1);
+      err = qio_conv_prog_lookup(copy, len, scanning, &again);
+      assert(!err);
+      if( len > 0 ) {
+        copy[0] = (copy[0] == 'x') ? 'y' : 'x';
+        qio_conv_prog_release(again);
+        err = qio_conv_prog_lookup(copy, len, scanning, &again);
+        assert(!err);
+        assert(again->fmt[0] == copy[0]);
+      }
+      qio_conv_prog_release(again);
+
+      qio_conv_prog_release(prog);
+    }
+  }
+
+  if( verbose ) printf("PASS: compiled format strings\n");
+}
+
 int main(int argc, char** argv)
 {
   int sizes[] = {qbytes_iobuf_size, 64, 1, 2, 0};
@@ -1531,8 +1780,14 @@ int main(int argc, char** argv)
     test_scanmatch();
 
     test_quoted_string_maxlength();
+
+    test_read_chars();
   }
 
+  test_conv_prog();
+
+  test_array();
+
   printf("qio_formatted_test PASS\n");
 
   return 0;
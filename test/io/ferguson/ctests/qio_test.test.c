@@ -315,7 +315,7 @@ void check_channels(void)
   int unbounded;
   char reopen;
   char seek;
-  qio_hint_t hints[] = {QIO_METHOD_DEFAULT, QIO_METHOD_READWRITE, QIO_METHOD_PREADPWRITE, QIO_METHOD_FREADFWRITE, QIO_METHOD_MEMORY, QIO_METHOD_MMAP, QIO_METHOD_MMAP|QIO_HINT_PARALLEL, QIO_METHOD_PREADPWRITE | QIO_HINT_NOFAST};
+  qio_hint_t hints[] = {QIO_METHOD_DEFAULT, QIO_METHOD_READWRITE, QIO_METHOD_PREADPWRITE, QIO_METHOD_FREADFWRITE, QIO_METHOD_MEMORY, QIO_METHOD_MMAP, QIO_METHOD_MMAP|QIO_HINT_PARALLEL, QIO_METHOD_PREADPWRITE | QIO_HINT_NOFAST, QIO_METHOD_URING, QIO_METHOD_PREADPWRITE | QIO_HINT_DIRECT};
   int nhints = sizeof(hints)/sizeof(qio_hint_t);
   int file_hint, ch_hint;
 
@@ -420,6 +420,84 @@ void check_paths(void)
 
 }
 
+// Check qio_file_pread_batch with each way of reading.
+void check_pread_batch(void)
+{
+  qio_hint_t hints[] = {QIO_METHOD_PREADPWRITE, QIO_METHOD_URING,
+                        QIO_METHOD_MMAP|QIO_HINT_PARALLEL, QIO_METHOD_MEMORY};
+  int64_t len = 1024*1024;
+  int64_t nreqs = 1000;
+  unsigned char* data = (unsigned char*) qio_malloc(len);
+  unsigned char* got = (unsigned char*) qio_malloc(nreqs * 64);
+  qio_pread_req_t* reqs =
+    (qio_pread_req_t*) qio_malloc(nreqs * sizeof(qio_pread_req_t));
+  ssize_t amt_written;
+  qio_channel_t* writing;
+  qio_file_t* f;
+  qioerr err;
+  int64_t i;
+  int h;
+
+  fill_testdata(0, len, data);
+
+  for( h = 0; h < (int) (sizeof(hints)/sizeof(hints[0])); h++ ) {
+    if( hints[h] == QIO_METHOD_MEMORY ) {
+      err = qio_file_open_mem(&f, NULL, NULL);
+      assert(!err);
+    } else {
+      err = qio_file_open_tmp(&f, hints[h], NULL);
+      assert(!err);
+    }
+    err = qio_channel_create(&writing, f, 0, 0, 1, 0, INT64_MAX, NULL, 0);
+    assert(!err);
+    err = qio_channel_write(true, writing, data, len, &amt_written);
+    assert(!err);
+    assert(amt_written == len);
+    qio_channel_release(writing);
+    if( hints[h] != QIO_METHOD_MEMORY ) {
+      // reopen so that the initial mapping covers the data
+      int fd;
+      qio_file_t* ro;
+      err = qio_get_fd(f, &fd);
+      assert(!err);
+      err = qio_file_init(&ro, NULL, dup(fd), hints[h], NULL, 0);
+      assert(!err);
+      qio_file_release(f);
+      f = ro;
+    }
+
+    // Scattered reads, with every fourth one following the one before,
+    // and the last running past the end of the file.
+    for( i = 0; i < nreqs; i++ ) {
+      if( i % 4 == 1 ) reqs[i].offset = reqs[i-1].offset + reqs[i-1].len;
+      else reqs[i].offset = (i * 7919) % (len - 64);
+      reqs[i].len = 1 + i % 64;
+      reqs[i].dst = got + 64*i;
+    }
+    reqs[nreqs-1].offset = len - 10;
+    reqs[nreqs-1].len = 20;
+
+    memset(got, 0, nreqs * 64);
+    err = qio_file_pread_batch(f, reqs, nreqs);
+    assert(qio_err_to_int(err) == EEOF);
+    for( i = 0; i < nreqs - 1; i++ ) {
+      assert(reqs[i].amt_read == reqs[i].len);
+      assert(0 == memcmp(got + 64*i, data + reqs[i].offset, reqs[i].len));
+    }
+    assert(reqs[nreqs-1].amt_read == 10);
+    assert(0 == memcmp(got + 64*(nreqs-1), data + len - 10, 10));
+
+    err = qio_file_pread_batch(f, reqs, nreqs - 1);
+    assert(!err);
+
+    qio_file_release(f);
+  }
+
+  qio_free(reqs);
+  qio_free(got);
+  qio_free(data);
+}
+
 int main(int argc, char** argv)
 {
 
@@ -433,6 +511,8 @@ int main(int argc, char** argv)
 
   check_paths();
 
+  check_pread_batch();
+
   check_channels();
 
 
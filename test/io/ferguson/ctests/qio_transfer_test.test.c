@@ -0,0 +1,271 @@
+#include "qio.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+unsigned char data_at(int64_t offset)
+{
+  return 'a' + ((offset * 7 + offset / 1000) % 26);
+}
+
+void fill_testdata(int64_t start, int64_t len, unsigned char* data)
+{
+  int64_t k;
+  for( k = 0; k < len; k++ ) {
+    data[k] = data_at(start+k);
+  }
+}
+
+void write_testfile(const char* filename, int64_t len)
+{
+  unsigned char* data = (unsigned char*) qio_malloc(len);
+  FILE* fp;
+
+  fill_testdata(0, len, data);
+  fp = fopen(filename, "w");
+  assert(fp);
+  assert(fwrite(data, 1, len, fp) == (size_t) len);
+  fclose(fp);
+  qio_free(data);
+}
+
+// Read part of src, write a prefix to dst, transfer, and then make sure
+// both channels carry on from the right places.
+void check_file_to_file(int64_t len, int64_t skip, int64_t amt,
+                        qio_hint_t src_hints, qio_hint_t dst_hints)
+{
+  const char* srcname = "transfer_src.bin";
+  const char* dstname = "transfer_dst.bin";
+  qio_file_t* fin;
+  qio_file_t* fout;
+  qio_channel_t* src;
+  qio_channel_t* dst;
+  unsigned char* got;
+  unsigned char prefix[5] = {'H', 'E', 'L', 'L', 'O'};
+  int64_t expect_moved;
+  int64_t moved = -1;
+  int64_t k;
+  qioerr err;
+
+  write_testfile(srcname, len);
+  unlink(dstname);
+
+  got = (unsigned char*) qio_malloc(len + 16);
+
+  err = qio_file_open_access(&fin, srcname, "r", 0, NULL);
+  assert(!err);
+  err = qio_file_open_access(&fout, dstname, "w", 0, NULL);
+  assert(!err);
+  err = qio_channel_create(&src, fin, src_hints, 1, 0, 0, INT64_MAX, NULL, 0);
+  assert(!err);
+  err = qio_channel_create(&dst, fout, dst_hints, 0, 1, 0, INT64_MAX, NULL, 0);
+  assert(!err);
+
+  err = qio_channel_read_amt(true, src, got, skip);
+  assert(!err);
+  err = qio_channel_write_amt(true, dst, prefix, sizeof(prefix));
+  assert(!err);
+
+  expect_moved = amt;
+  if( amt < 0 || skip + amt > len ) expect_moved = len - skip;
+
+  err = qio_channel_transfer(true, dst, src, amt, &moved);
+  if( amt >= 0 && skip + amt > len ) assert(qio_err_to_int(err) == EEOF);
+  else assert(!err);
+  assert(moved == expect_moved);
+
+  // Both channels pick up where the transfer left off.
+  if( skip + moved < len ) {
+    err = qio_channel_read_amt(true, src, got, 1);
+    assert(!err);
+    assert(got[0] == data_at(skip + moved));
+  }
+  err = qio_channel_write_amt(true, dst, prefix, sizeof(prefix));
+  assert(!err);
+
+  qio_channel_release(src);
+  err = qio_channel_close(true, dst);
+  assert(!err);
+  qio_channel_release(dst);
+  qio_file_release(fin);
+  qio_file_release(fout);
+
+  err = qio_file_open_access(&fout, dstname, "r", 0, NULL);
+  assert(!err);
+  err = qio_channel_create(&dst, fout, 0, 1, 0, 0, INT64_MAX, NULL, 0);
+  assert(!err);
+  memset(got, 0, len + 16);
+  err = qio_channel_read_amt(true, dst, got, moved + 2*sizeof(prefix));
+  assert(!err);
+  assert(memcmp(got, prefix, sizeof(prefix)) == 0);
+  for( k = 0; k < moved; k++ ) {
+    assert(got[sizeof(prefix) + k] == data_at(skip + k));
+  }
+  assert(memcmp(got + sizeof(prefix) + moved, prefix, sizeof(prefix)) == 0);
+  err = qio_channel_read_amt(true, dst, got, 1);
+  assert(qio_err_to_int(err) == EEOF);
+  qio_channel_release(dst);
+  qio_file_release(fout);
+
+  unlink(srcname);
+  unlink(dstname);
+  qio_free(got);
+}
+
+// A file into a pipe, and the pipe (with some of it already read
+// into the channel's buffer) into a file.
+void check_pipes(int64_t len)
+{
+  const char* srcname = "transfer_src.bin";
+  const char* dstname = "transfer_dst.bin";
+  int p[2];
+  qio_file_t* fin;
+  qio_file_t* fout;
+  qio_file_t* pw;
+  qio_file_t* pr;
+  qio_channel_t* src;
+  qio_channel_t* dst;
+  unsigned char* got;
+  int64_t moved = -1;
+  int64_t k;
+  qioerr err;
+
+  // it all has to fit in the pipe
+  assert(len < 32*1024);
+
+  write_testfile(srcname, len);
+  unlink(dstname);
+  got = (unsigned char*) qio_malloc(len);
+
+  assert(pipe(p) == 0);
+  err = qio_file_init(&pw, NULL, p[1], QIO_HINT_OWNED, NULL, 0);
+  assert(!err);
+  err = qio_file_init(&pr, NULL, p[0], QIO_HINT_OWNED, NULL, 0);
+  assert(!err);
+
+  err = qio_file_open_access(&fin, srcname, "r", 0, NULL);
+  assert(!err);
+  err = qio_channel_create(&src, fin, 0, 1, 0, 0, INT64_MAX, NULL, 0);
+  assert(!err);
+  err = qio_channel_create(&dst, pw, 0, 0, 1, 0, INT64_MAX, NULL, 0);
+  assert(!err);
+  err = qio_channel_transfer(true, dst, src, -1, &moved);
+  assert(!err);
+  assert(moved == len);
+  qio_channel_release(src);
+  qio_file_release(fin);
+  err = qio_channel_close(true, dst);
+  assert(!err);
+  qio_channel_release(dst);
+  qio_file_release(pw);
+
+  err = qio_channel_create(&src, pr, 0, 1, 0, 0, INT64_MAX, NULL, 0);
+  assert(!err);
+  err = qio_file_open_access(&fout, dstname, "w", 0, NULL);
+  assert(!err);
+  err = qio_channel_create(&dst, fout, 0, 0, 1, 0, INT64_MAX, NULL, 0);
+  assert(!err);
+  err = qio_channel_read_amt(true, src, got, 10);
+  assert(!err);
+  err = qio_channel_transfer(true, dst, src, -1, &moved);
+  assert(!err);
+  assert(moved == len - 10);
+  qio_channel_release(src);
+  qio_file_release(pr);
+  err = qio_channel_close(true, dst);
+  assert(!err);
+  qio_channel_release(dst);
+  qio_file_release(fout);
+
+  err = qio_file_open_access(&fout, dstname, "r", 0, NULL);
+  assert(!err);
+  err = qio_channel_create(&src, fout, 0, 1, 0, 0, INT64_MAX, NULL, 0);
+  assert(!err);
+  err = qio_channel_read_amt(true, src, got, len - 10);
+  assert(!err);
+  for( k = 0; k < len - 10; k++ ) {
+    assert(got[k] == data_at(10 + k));
+  }
+  qio_channel_release(src);
+  qio_file_release(fout);
+
+  unlink(srcname);
+  unlink(dstname);
+  qio_free(got);
+}
+
+// Memory files always go through the buffers.
+void check_memory(int64_t len)
+{
+  qio_file_t* fin;
+  qio_file_t* fout;
+  qio_channel_t* src;
+  qio_channel_t* dst;
+  unsigned char* data;
+  unsigned char* got;
+  int64_t moved = -1;
+  qioerr err;
+
+  data = (unsigned char*) qio_malloc(len);
+  got = (unsigned char*) qio_malloc(len);
+  fill_testdata(0, len, data);
+
+  err = qio_file_open_mem(&fin, NULL, NULL);
+  assert(!err);
+  err = qio_file_open_mem(&fout, NULL, NULL);
+  assert(!err);
+  err = qio_channel_create(&dst, fin, 0, 0, 1, 0, INT64_MAX, NULL, 0);
+  assert(!err);
+  err = qio_channel_write_amt(true, dst, data, len);
+  assert(!err);
+  err = qio_channel_close(true, dst);
+  assert(!err);
+  qio_channel_release(dst);
+
+  err = qio_channel_create(&src, fin, 0, 1, 0, 0, INT64_MAX, NULL, 0);
+  assert(!err);
+  err = qio_channel_create(&dst, fout, 0, 0, 1, 0, INT64_MAX, NULL, 0);
+  assert(!err);
+  err = qio_channel_transfer(true, dst, src, len + 100, &moved);
+  assert(qio_err_to_int(err) == EEOF);
+  assert(moved == len);
+  qio_channel_release(src);
+  err = qio_channel_close(true, dst);
+  assert(!err);
+  qio_channel_release(dst);
+
+  err = qio_channel_create(&src, fout, 0, 1, 0, 0, INT64_MAX, NULL, 0);
+  assert(!err);
+  err = qio_channel_read_amt(true, src, got, len);
+  assert(!err);
+  assert(memcmp(got, data, len) == 0);
+  qio_channel_release(src);
+
+  qio_file_release(fin);
+  qio_file_release(fout);
+  qio_free(data);
+  qio_free(got);
+}
+
+int main(int argc, char** argv)
+{
+  qio_hint_t hints[] = {0, QIO_METHOD_READWRITE, QIO_METHOD_PREADPWRITE};
+  int i, j;
+
+  for( i = 0; i < 3; i++ ) {
+    for( j = 0; j < 3; j++ ) {
+      check_file_to_file(3*1024*1024 + 17, 1000, -1, hints[i], hints[j]);
+      check_file_to_file(3*1024*1024 + 17, 70000, 1000000, hints[i], hints[j]);
+      check_file_to_file(100000, 10, 200000, hints[i], hints[j]);
+    }
+  }
+  check_file_to_file(100000, 0, 0, QIO_METHOD_MMAP, 0);
+  check_file_to_file(100000, 5, 5000, QIO_METHOD_MMAP, 0);
+  check_pipes(20000);
+  check_memory(300000);
+
+  printf("qio_transfer_test PASS\n");
+
+  return 0;
+}
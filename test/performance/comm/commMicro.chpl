@@ -0,0 +1,206 @@
+//
+// Microbenchmarks for the runtime comm interface.  This measures the
+// latency and bandwidth of chpl_comm_put()/chpl_comm_get() (ordered,
+// unordered, and non-blocking), remote atomics, execute_on, and
+// strided transfers, sweeping message sizes and tasks per locale.  It
+// calls the runtime interface directly, so it works the same way for
+// every CHPL_COMM setting and can be used to compare them or to catch
+// regressions when the underlying network library is upgraded.
+//
+// With --printCSV=true the results are written to stdout as CSV, one
+// line per measurement.  With --printTiming=true they are written in
+// a form suitable for perfkeys.
+//
+use CTypes, Time;
+
+config const minSize = 8;
+config const maxSize = 1024;
+config const maxTasks = 2;
+config const iters = 10;
+config const printCSV = false;
+config const printTiming = false;
+
+extern type chpl_comm_nb_handle_t;
+
+extern proc chpl_comm_put(addr: c_ptr(void), node: int(32),
+                          raddr: c_ptr(void), size: c_size_t,
+                          commID: int(32), ln: c_int, fn: int(32));
+extern proc chpl_comm_get(addr: c_ptr(void), node: int(32),
+                          raddr: c_ptr(void), size: c_size_t,
+                          commID: int(32), ln: c_int, fn: int(32));
+extern proc chpl_comm_put_unordered(addr: c_ptr(void), node: int(32),
+                                    raddr: c_ptr(void), size: c_size_t,
+                                    commID: int(32), ln: c_int, fn: int(32));
+extern proc chpl_comm_get_unordered(addr: c_ptr(void), node: int(32),
+                                    raddr: c_ptr(void), size: c_size_t,
+                                    commID: int(32), ln: c_int, fn: int(32));
+extern proc chpl_comm_getput_unordered_task_fence();
+extern proc chpl_comm_put_nb(addr: c_ptr(void), node: int(32),
+                             raddr: c_ptr(void), size: c_size_t,
+                             commID: int(32), ln: c_int,
+                             fn: int(32)): chpl_comm_nb_handle_t;
+extern proc chpl_comm_get_nb(addr: c_ptr(void), node: int(32),
+                             raddr: c_ptr(void), size: c_size_t,
+                             commID: int(32), ln: c_int,
+                             fn: int(32)): chpl_comm_nb_handle_t;
+extern proc chpl_comm_wait_nb_some(h: c_ptr(chpl_comm_nb_handle_t),
+                                   nhandles: c_size_t);
+extern proc chpl_comm_free_nb_handle(h: chpl_comm_nb_handle_t);
+
+const tgt = Locales[numLocales-1];
+const tgtNode = tgt.id: int(32);
+
+// Each task gets its own maxSize-byte piece of these.
+var lbuf: [0..#maxSize*maxTasks] uint(8);
+const lbase = c_ptrTo(lbuf[0]);
+var rbase: c_ptr(uint(8));
+on tgt do rbase = allocate(uint(8), (maxSize*maxTasks): c_size_t,
+                           clear=true);
+
+class Counter {
+  var a: atomic int;
+}
+var ctr: owned Counter?;
+on tgt do ctr = new Counter();
+
+class Mat {
+  const rows, cols: int;
+  var A: [0..#rows, 0..#cols] real;
+}
+const matRows = 64;
+var rmat: owned Mat?;
+on tgt do rmat = new Mat(matRows, max(1, maxSize / numBytes(real)));
+
+if printCSV then
+  writeln("op,mode,size,tasks,usPerOp,MiBPerSec");
+
+proc report(op: string, mode: string, size: int, nTasks: int, t: real) {
+  const usPerOp = t * 1e6 / iters;
+  const mibPerSec = if t > 0 then (nTasks * iters * size) / t / 2.0**20
+                    else 0.0;
+  if printCSV then
+    writeln(op, ",", mode, ",", size, ",", nTasks, ",", usPerOp, ",",
+            mibPerSec);
+  if printTiming then
+    writeln(op, " ", mode, " size=", size, " tasks=", nTasks, ": ",
+            usPerOp, " us/op, ", mibPerSec, " MiB/s");
+}
+
+//
+// Contiguous PUT or GET, in one of the ordering modes.
+//
+proc rdma(param isPut: bool, param mode: string, size: int, nTasks: int) {
+  var sw: stopwatch;
+  sw.start();
+  coforall tid in 0..#nTasks {
+    const l = (lbase + tid*maxSize): c_ptr(void);
+    const r = (rbase + tid*maxSize): c_ptr(void);
+    const sz = size: c_size_t;
+    for 1..iters {
+      if mode == "ordered" {
+        if isPut then chpl_comm_put(l, tgtNode, r, sz, -1, 0, 0);
+                 else chpl_comm_get(l, tgtNode, r, sz, -1, 0, 0);
+      } else if mode == "unordered" {
+        if isPut then chpl_comm_put_unordered(l, tgtNode, r, sz, -1, 0, 0);
+                 else chpl_comm_get_unordered(l, tgtNode, r, sz, -1, 0, 0);
+      } else {
+        var h = if isPut then chpl_comm_put_nb(l, tgtNode, r, sz, -1, 0, 0)
+                         else chpl_comm_get_nb(l, tgtNode, r, sz, -1, 0, 0);
+        chpl_comm_wait_nb_some(c_ptrTo(h), 1);
+        chpl_comm_free_nb_handle(h);
+      }
+    }
+    if mode == "unordered" then
+      chpl_comm_getput_unordered_task_fence();
+  }
+  sw.stop();
+  report(if isPut then "put" else "get", mode, size, nTasks, sw.elapsed());
+}
+
+//
+// Remote atomic add, non-fetching or fetching.
+//
+proc amo(param fetching: bool, nTasks: int) {
+  var sw: stopwatch;
+  const c = ctr.borrow()!;
+  sw.start();
+  coforall 0..#nTasks {
+    for 1..iters {
+      if fetching then c.a.fetchAdd(1);
+                  else c.a.add(1);
+    }
+  }
+  sw.stop();
+  report("amo", if fetching then "fetchAdd" else "add", numBytes(int),
+         nTasks, sw.elapsed());
+}
+
+//
+// Remote execution, blocking or not.
+//
+proc executeOn(param blocking: bool, nTasks: int) {
+  var sw: stopwatch;
+  sw.start();
+  coforall 0..#nTasks {
+    if blocking {
+      for 1..iters do on tgt do ;
+    } else {
+      sync for 1..iters do begin on tgt do ;
+    }
+  }
+  sw.stop();
+  report("execute_on", if blocking then "blocking" else "nb", 0, nTasks,
+         sw.elapsed());
+}
+
+//
+// Strided GET and PUT of a matRows x (size/8) block of a remote matrix.
+//
+proc strided(size: int) {
+  const cols = max(1, size / numBytes(real));
+  const m = rmat.borrow()!;
+  var L: [0..#matRows, 0..#cols] real;
+  var sw: stopwatch;
+
+  sw.start();
+  for 1..iters do L = m.A[.., 0..#cols];
+  sw.stop();
+  report("get_strd", "ordered", matRows * cols * numBytes(real), 1,
+         sw.elapsed());
+
+  sw.clear();
+  sw.start();
+  for 1..iters do m.A[.., 0..#cols] = L;
+  sw.stop();
+  report("put_strd", "ordered", matRows * cols * numBytes(real), 1,
+         sw.elapsed());
+}
+
+var size = minSize;
+while size <= maxSize {
+  var nTasks = 1;
+  while nTasks <= maxTasks {
+    rdma(true, "ordered", size, nTasks);
+    rdma(false, "ordered", size, nTasks);
+    rdma(true, "unordered", size, nTasks);
+    rdma(false, "unordered", size, nTasks);
+    rdma(true, "nb", size, nTasks);
+    rdma(false, "nb", size, nTasks);
+    nTasks *= 2;
+  }
+  strided(size);
+  size *= 2;
+}
+
+var nTasks = 1;
+while nTasks <= maxTasks {
+  amo(false, nTasks);
+  amo(true, nTasks);
+  executeOn(true, nTasks);
+  executeOn(false, nTasks);
+  nTasks *= 2;
+}
+
+on tgt do deallocate(rbase);
+
+writeln("commMicro: done");
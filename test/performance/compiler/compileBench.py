@@ -0,0 +1,203 @@
+#!/usr/bin/env python3
+
+"""
+Compile a fixed corpus of programs with chpl, record how long each
+compiler pass and frontend query took, the peak RSS of the compile and the
+size of the generated executable, and check them against a baseline.
+
+The corpus is in corpus/ next to this script:
+
+    hello.chpl      what every compile pays for
+    stencil.chpl    a Block-distributed Jacobi stencil
+    distSort.chpl   sorting a distributed array
+    stdlibApp.chpl  heavy use of the standard library
+
+Pass times come from --print-passes-json and frontend query times from
+--dyno-query-profile (which are only recorded by compilers built with
+query timing enabled).  Each run appends one JSON object, with the median
+of each measurement over --trials compiles, to the --history file, one
+object per line.  If --baseline names an existing file, the totals, the
+peak RSS, the executable size and every pass that took at least
+--min-seconds are compared with it, and the script exits with status 1 if
+any got worse by more than --threshold.  With --update-baseline the
+results of this run become the new baseline.
+"""
+
+import argparse
+import collections
+import json
+import os
+import shutil
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+
+CORPUS = os.path.join(os.path.dirname(os.path.abspath(__file__)), "corpus")
+PROGRAMS = ("hello", "stencil", "distSort", "stdlibApp")
+# how many of the slowest queries to keep per program
+TOP_QUERIES = 20
+SCALARS = ("wallSeconds", "compilerSeconds", "peakRssBytes", "exeBytes")
+
+
+def max_rss_bytes(rusage):
+    # ru_maxrss is in KiB on Linux but in bytes on macOS
+    if sys.platform == "darwin":
+        return rusage.ru_maxrss
+    return rusage.ru_maxrss * 1024
+
+
+def read_query_profile(path):
+    """Sum the self time of each query in the folded stacks, in seconds."""
+    totals = collections.Counter()
+    if not os.path.exists(path):
+        return {}
+    with open(path) as f:
+        for line in f:
+            stack, _, micros = line.rstrip("\n").rpartition(" ")
+            if stack:
+                totals[stack.split(";")[-1]] += int(micros)
+    return {name: us / 1e6 for name, us in totals.most_common(TOP_QUERIES)}
+
+
+def compile_once(chpl, program, compopts):
+    tmp = tempfile.mkdtemp(prefix="compileBench-")
+    try:
+        exe = os.path.join(tmp, program)
+        passes = os.path.join(tmp, "passes.json")
+        queries = os.path.join(tmp, "queries.folded")
+        cmd = [chpl, os.path.join(CORPUS, program + ".chpl"), "-o", exe,
+               "--print-passes-json", passes,
+               "--dyno-query-profile", queries] + compopts
+
+        start = time.time()
+        proc = subprocess.Popen(cmd, stdout=subprocess.DEVNULL)
+        # wait4 gives the peak RSS of the compile, including the processes
+        # the driver waits for
+        _, status, rusage = os.wait4(proc.pid, 0)
+        wall = time.time() - start
+        if status != 0:
+            raise RuntimeError("'{}' failed".format(" ".join(cmd)))
+
+        with open(passes) as f:
+            report = json.load(f)
+        passSeconds = collections.Counter()
+        for p in report["passes"]:
+            passSeconds[p["name"]] += p["seconds"]
+
+        return {"wallSeconds": wall,
+                "compilerSeconds": report["totalSeconds"],
+                "peakRssBytes": max_rss_bytes(rusage),
+                "exeBytes": os.path.getsize(exe),
+                "passSeconds": dict(passSeconds),
+                "querySeconds": read_query_profile(queries)}
+    finally:
+        shutil.rmtree(tmp, ignore_errors=True)
+
+
+def median_of(dicts):
+    keys = set()
+    for d in dicts:
+        keys.update(d)
+    return {k: statistics.median(d.get(k, 0.0) for d in dicts) for k in keys}
+
+
+def measure(chpl, program, compopts, trials):
+    runs = [compile_once(chpl, program, compopts) for _ in range(trials)]
+    result = {s: statistics.median(r[s] for r in runs) for s in SCALARS}
+    result["passSeconds"] = median_of([r["passSeconds"] for r in runs])
+    result["querySeconds"] = median_of([r["querySeconds"] for r in runs])
+    return result
+
+
+def regressions(results, baseline, threshold, min_seconds):
+    found = []
+
+    def check(what, old, new):
+        if old > 0 and (new - old) / old > threshold:
+            found.append((what, old, new, (new - old) / old))
+
+    for program, base in sorted(baseline.items()):
+        if program not in results:
+            continue
+        new = results[program]
+        for s in SCALARS:
+            check("{} {}".format(program, s), base[s], new[s])
+        for name, old in sorted(base["passSeconds"].items()):
+            if old >= min_seconds and name in new["passSeconds"]:
+                check("{} pass {}".format(program, name), old,
+                      new["passSeconds"][name])
+    return found
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+        formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--chpl", default="chpl",
+                        help="the compiler to measure (default: %(default)s)")
+    parser.add_argument("--compopts", default="",
+                        help="more options for chpl, e.g. '--fast'")
+    parser.add_argument("--programs", default=",".join(PROGRAMS),
+                        help="comma-separated programs from the corpus "
+                             "(default: %(default)s)")
+    parser.add_argument("--trials", type=int, default=3,
+                        help="compiles to take the median of "
+                             "(default: %(default)s)")
+    parser.add_argument("--history", default="compileBench-history.json",
+                        help="file to append the results to "
+                             "(default: %(default)s)")
+    parser.add_argument("--baseline", default=None,
+                        help="JSON file with the results to compare with")
+    parser.add_argument("--threshold", type=float, default=0.10,
+                        help="fraction by which a result may get worse "
+                             "before it is reported (default: %(default)s)")
+    parser.add_argument("--min-seconds", type=float, default=0.1,
+                        help="only compare passes that took at least this "
+                             "long in the baseline (default: %(default)s)")
+    parser.add_argument("--update-baseline", action="store_true",
+                        help="write this run's results to --baseline")
+    args = parser.parse_args()
+
+    results = {}
+    for program in args.programs.split(","):
+        results[program] = measure(args.chpl, program, args.compopts.split(),
+                                   max(1, args.trials))
+        r = results[program]
+        print("{}: {:.2f} s, {:.0f} MiB peak RSS, {:.1f} MiB executable".format(
+              program, r["wallSeconds"], r["peakRssBytes"] / 2.0**20,
+              r["exeBytes"] / 2.0**20))
+
+    record = {"time": time.strftime("%Y-%m-%dT%H:%M:%S"),
+              "chpl": args.chpl,
+              "compopts": args.compopts,
+              "results": results}
+    with open(args.history, "a") as f:
+        f.write(json.dumps(record, sort_keys=True) + "\n")
+
+    status = 0
+    if args.baseline and os.path.exists(args.baseline):
+        with open(args.baseline) as f:
+            baseline = json.load(f)["results"]
+        found = regressions(results, baseline, args.threshold,
+                            args.min_seconds)
+        for what, old, new, change in found:
+            print("REGRESSION {}: {:.3f} -> {:.3f} ({:+.1%})".format(
+                  what, old, new, change))
+        if found:
+            status = 1
+        else:
+            print("no regressions against {}".format(args.baseline))
+
+    if args.update_baseline:
+        if not args.baseline:
+            parser.error("--update-baseline needs --baseline")
+        with open(args.baseline, "w") as f:
+            json.dump(record, f, indent=2, sort_keys=True)
+            f.write("\n")
+
+    return status
+
+
+if __name__ == "__main__":
+    sys.exit(main())
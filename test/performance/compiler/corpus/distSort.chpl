@@ -0,0 +1,11 @@
+// Sorting a Block-distributed array of random values.
+use BlockDist, Random, Sort;
+
+config const n = 10000;
+config const seed = 42;
+
+var A = blockDist.createArray(0..#n, int);
+fillRandom(A, seed);
+sort(A);
+
+writeln("sorted: ", isSorted(A));
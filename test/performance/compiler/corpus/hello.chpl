@@ -0,0 +1,2 @@
+// The smallest program: what every compile pays for.
+writeln("Hello, world!");
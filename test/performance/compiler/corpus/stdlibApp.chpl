@@ -0,0 +1,40 @@
+// Word counting that leans on the standard library: strings, map, set,
+// list, sorting, formatted I/O and JSON.
+use IO, JSON, List, Map, Math, Set, Sort;
+
+config const text = "the quick brown fox jumps over the lazy dog " +
+                    "and the dog sleeps while the fox runs";
+
+record wordCount {
+  var word: string;
+  var count: int;
+}
+
+var counts: map(string, int);
+var letters: set(string);
+for w in text.split() {
+  if counts.contains(w) then counts[w] += 1;
+                        else counts.add(w, 1);
+  for c in w do letters.add(c);
+}
+
+var pairs = [w in counts.keysToArray()] (-counts[w], w);
+sort(pairs);
+
+var top: list(wordCount);
+for (negCount, w) in pairs[0..#min(5, pairs.size)] do
+  top.pushBack(new wordCount(w, -negCount));
+
+for wc in top do
+  writef("%-8s %i\n", wc.word, wc.count);
+writeln("distinct letters: ", letters.size);
+const total = + reduce [(c, w) in pairs] -c;
+writef("entropy: %.3dr bits\n",
+       + reduce [(c, w) in pairs]
+           ((-c): real / total) * log2(total: real / (-c)));
+
+var f = openMemFile();
+f.writer(serializer=new jsonSerializer(), locking=false).write(top);
+const back = f.reader(deserializer=new jsonDeserializer(),
+                      locking=false).read(list(wordCount));
+writeln("json round trip: ", back == top);
@@ -0,0 +1,21 @@
+// A Jacobi stencil over a Block-distributed 2D array.
+use BlockDist;
+
+config const n = 64;
+config const iters = 10;
+
+const Space = {0..n+1, 0..n+1};
+const Inner = {1..n, 1..n};
+const D = blockDist.createDomain(Space);
+const DInner = D[Inner];
+
+var A, B: [D] real;
+A[0, 0..n+1] = 1.0;
+
+for 1..iters {
+  forall (i, j) in DInner do
+    B[i, j] = (A[i-1, j] + A[i+1, j] + A[i, j-1] + A[i, j+1]) / 4;
+  A[DInner] = B[DInner];
+}
+
+writef("sum = %.6dr\n", + reduce A);
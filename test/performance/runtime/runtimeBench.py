@@ -0,0 +1,159 @@
+#!/usr/bin/env python3
+
+"""
+Run the runtime microbenchmarks, record the results, and check them
+against a baseline.
+
+runtimeMicro has to be compiled first, e.g.
+
+    chpl --fast --cache-remote runtimeMicro.chpl
+
+Each run appends one JSON object (the time, the git revision if there is
+one, and the median of each measurement over --trials runs) to the
+--history file, one object per line, so that results can be followed over
+time.  If --baseline names an existing file, every measurement is compared
+with the one in it, and the script exits with status 1 if any got worse by
+more than --threshold.  With --update-baseline the results of this run
+become the new baseline.
+"""
+
+import argparse
+import json
+import os
+import statistics
+import subprocess
+import sys
+import time
+
+# For these, less is better; for the others, more is.
+LOWER_IS_BETTER = ("usPerOp",)
+METRICS = ("usPerOp", "MiBPerSec")
+
+
+def key_of(result):
+    return "{} {} size={}".format(result["op"], result["mode"], result["size"])
+
+
+def run_once(exe, exec_opts, num_locales):
+    cmd = [exe, "--printJSON=true"] + exec_opts
+    if num_locales is not None:
+        cmd += ["-nl", str(num_locales)]
+    out = subprocess.run(cmd, check=True, stdout=subprocess.PIPE,
+                         universal_newlines=True).stdout
+    results = {}
+    for line in out.splitlines():
+        if line.startswith("{"):
+            result = json.loads(line)
+            results[key_of(result)] = result
+    return results
+
+
+def run(exe, exec_opts, num_locales, trials):
+    runs = [run_once(exe, exec_opts, num_locales) for _ in range(trials)]
+    medians = {}
+    for key, first in runs[0].items():
+        entry = {"op": first["op"], "mode": first["mode"],
+                 "size": first["size"]}
+        for metric in METRICS:
+            entry[metric] = statistics.median(r[key][metric]
+                                              for r in runs if key in r)
+        medians[key] = entry
+    return medians
+
+
+def git_revision():
+    try:
+        return subprocess.run(["git", "rev-parse", "HEAD"], check=True,
+                              stdout=subprocess.PIPE,
+                              stderr=subprocess.DEVNULL,
+                              universal_newlines=True).stdout.strip()
+    except (OSError, subprocess.CalledProcessError):
+        return None
+
+
+def regressions(results, baseline, threshold):
+    found = []
+    for key, base in sorted(baseline.items()):
+        if key not in results:
+            continue
+        for metric in METRICS:
+            old = base[metric]
+            new = results[key][metric]
+            if old <= 0:
+                continue
+            change = (new - old) / old
+            if metric in LOWER_IS_BETTER:
+                worse = change > threshold
+            else:
+                worse = -change > threshold
+            if worse:
+                found.append((key, metric, old, new, change))
+    return found
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+        formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--exe", default="./runtimeMicro",
+                        help="the compiled runtimeMicro (default: %(default)s)")
+    parser.add_argument("--exec-opts", default="",
+                        help="more options for runtimeMicro, e.g. "
+                             "'--iters=100000 --maxSize=65536'")
+    parser.add_argument("--num-locales", type=int, default=None,
+                        help="run on this many locales (needed for the "
+                             "remote cache measurements)")
+    parser.add_argument("--trials", type=int, default=3,
+                        help="runs to take the median of "
+                             "(default: %(default)s)")
+    parser.add_argument("--history", default="runtimeMicro-history.json",
+                        help="file to append the results to "
+                             "(default: %(default)s)")
+    parser.add_argument("--baseline", default=None,
+                        help="JSON file with the results to compare with")
+    parser.add_argument("--threshold", type=float, default=0.10,
+                        help="fraction by which a result may get worse "
+                             "before it is reported (default: %(default)s)")
+    parser.add_argument("--update-baseline", action="store_true",
+                        help="write this run's results to --baseline")
+    args = parser.parse_args()
+
+    results = run(args.exe, args.exec_opts.split(), args.num_locales,
+                  max(1, args.trials))
+
+    record = {"time": time.strftime("%Y-%m-%dT%H:%M:%S"),
+              "revision": git_revision(),
+              "execOpts": args.exec_opts,
+              "numLocales": args.num_locales,
+              "results": results}
+    with open(args.history, "a") as f:
+        f.write(json.dumps(record, sort_keys=True) + "\n")
+
+    for key, result in sorted(results.items()):
+        print("{}: {:.3f} us/op, {:.1f} MiB/s".format(key, result["usPerOp"],
+                                                     result["MiBPerSec"]))
+
+    status = 0
+    if args.baseline and os.path.exists(args.baseline):
+        with open(args.baseline) as f:
+            baseline = json.load(f)["results"]
+        found = regressions(results, baseline, args.threshold)
+        for key, metric, old, new, change in found:
+            print("REGRESSION {} {}: {:.3f} -> {:.3f} ({:+.1%})".format(
+                  key, metric, old, new, change))
+        if found:
+            status = 1
+        else:
+            print("no regressions against {}".format(args.baseline))
+
+    if args.update_baseline:
+        if not args.baseline:
+            parser.error("--update-baseline needs --baseline")
+        with open(args.baseline, "w") as f:
+            json.dump(record, f, indent=2, sort_keys=True)
+            f.write("\n")
+
+    return status
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,191 @@
+//
+// Microbenchmarks for runtime primitives: task spawn, sync variable
+// handoff, chpl_mem_alloc()/free() by size, qio write and read
+// throughput, remote cache hits and misses, and GPU kernel launch
+// overhead.  The remote cache measurements need more than one locale
+// (and --cache-remote to mean anything), and the GPU one needs a GPU
+// locale; otherwise they are skipped.
+//
+// With --printJSON=true the results are written to stdout as JSON, one
+// object per line, for runtimeBench.py to record and compare against a
+// baseline.  With --printCSV=true they are written as CSV, and with
+// --printTiming=true in a form suitable for perfkeys.
+//
+use CTypes, IO, Time;
+
+config const minSize = 8;
+config const maxSize = 4096;
+config const iters = 1000;
+config const printJSON = false;
+config const printCSV = false;
+config const printTiming = false;
+
+if printCSV then
+  writeln("op,mode,size,usPerOp,MiBPerSec");
+
+// 'size' is the number of bytes each op moves, or 0 if it is not about
+// moving bytes.
+proc report(op: string, mode: string, size: int, t: real) {
+  const usPerOp = t * 1e6 / iters;
+  const mibPerSec = if t > 0 then (iters * size) / t / 2.0**20 else 0.0;
+  if printJSON then
+    writeln('{"op": "', op, '", "mode": "', mode, '", "size": ', size,
+            ', "usPerOp": ', usPerOp, ', "MiBPerSec": ', mibPerSec, '}');
+  if printCSV then
+    writeln(op, ",", mode, ",", size, ",", usPerOp, ",", mibPerSec);
+  if printTiming then
+    writeln(op, " ", mode, " size=", size, ": ", usPerOp, " us/op, ",
+            mibPerSec, " MiB/s");
+}
+
+//
+// Spawning a task with begin and waiting for all of them.
+//
+proc taskSpawn() {
+  var count: atomic int;
+  var sw: stopwatch;
+  sw.start();
+  sync {
+    for 1..iters do
+      begin count.add(1);
+  }
+  sw.stop();
+  report("task", "begin", 0, sw.elapsed());
+}
+
+//
+// Passing a value to another task and back through sync variables.
+//
+proc syncHandoff() {
+  var ping, pong: sync int;
+  var sw: stopwatch;
+  sw.start();
+  cobegin with (ref ping, ref pong) {
+    for i in 1..iters {
+      ping.writeEF(i);
+      pong.readFE();
+    }
+    for 1..iters do
+      pong.writeEF(ping.readFE());
+  }
+  sw.stop();
+  report("sync", "roundtrip", 0, sw.elapsed());
+}
+
+//
+// Allocating and freeing a block, which goes to chpl_mem_alloc().
+//
+proc memAlloc(size: int) {
+  var sw: stopwatch;
+  sw.start();
+  for 1..iters {
+    var p = allocate(uint(8), size: c_size_t);
+    deallocate(p);
+  }
+  sw.stop();
+  report("mem", "alloc", size, sw.elapsed());
+}
+
+//
+// Writing and then reading back a memory file, size bytes at a time,
+// which measures the qio buffering rather than a file system.
+//
+proc qioThroughput(size: int) {
+  var buf: [0..#size] uint(8) = 1;
+  var f = openMemFile();
+  var sw: stopwatch;
+
+  {
+    var w = f.writer(locking=false);
+    sw.start();
+    for 1..iters do
+      w.writeBinary(buf);
+    w.flush();
+    sw.stop();
+    w.close();
+  }
+  report("qio", "write", size, sw.elapsed());
+
+  sw.clear();
+  {
+    var r = f.reader(locking=false);
+    sw.start();
+    for 1..iters do
+      r.readBinary(buf);
+    sw.stop();
+    r.close();
+  }
+  report("qio", "read", size, sw.elapsed());
+
+  f.close();
+}
+
+//
+// Reading remote ints: the same one over and over, which the remote
+// cache can keep, and ones on different pages, which it can't.
+//
+class Ints {
+  const n: int;
+  var A: [0..#n] int;
+}
+
+// ints between the reads that should miss, 8 KiB apart
+const missStride = 1024;
+const missReads = 1024;
+
+proc remoteCache() {
+  if numLocales == 1 then return;
+
+  var r: owned Ints?;
+  on Locales[numLocales-1] do r = new Ints(missStride * missReads);
+  const ref A = r!.A;
+  var sum = 0;
+  var sw: stopwatch;
+
+  sw.start();
+  for 1..iters do
+    sum += A[0];
+  sw.stop();
+  report("cache", "hit", numBytes(int), sw.elapsed());
+
+  sw.clear();
+  sw.start();
+  for i in 0..#iters do
+    sum += A[(i % missReads) * missStride];
+  sw.stop();
+  report("cache", "miss", numBytes(int), sw.elapsed());
+
+  if sum != 0 then halt("unexpected remote values");
+}
+
+//
+// Launching a one-thread kernel and waiting for it.
+//
+proc gpuLaunch() {
+  if here.gpus.size == 0 then return;
+
+  on here.gpus[0] {
+    var A: [0..#1] int;
+    var sw: stopwatch;
+    sw.start();
+    for 1..iters do
+      foreach i in A.domain do A[i] += 1;
+    sw.stop();
+    report("gpu", "launch", 0, sw.elapsed());
+  }
+}
+
+taskSpawn();
+syncHandoff();
+
+var size = minSize;
+while size <= maxSize {
+  memAlloc(size);
+  qioThroughput(size);
+  size *= 2;
+}
+
+remoteCache();
+gpuLaunch();
+
+writeln("runtimeMicro: done");
@@ -6,6 +6,7 @@
 
 #include "re2/re2.h"
 #include <limits>
+#include <string>
 
 #define KEEP_NONE          0
 #define KEEP_UNMATCHED     (1 << 0)
@@ -439,6 +440,112 @@ void check_re_channels(void)
   }
 }
 
+// Match sets of patterns against channels, with some of the matches
+// straddling the boundaries between the channel's buffers, and check
+// that the answers are the same as matching the whole string at once.
+void check_set_channel(const char** patterns, int npatterns,
+                       const char* data, int64_t len, int64_t maxlen,
+                       qio_hint_t hints)
+{
+  qio_regex_options_t options;
+  qio_regex_set_t set;
+  qio_file_t* f;
+  qio_channel_t* ch;
+  qio_bool got[16];
+  qio_bool expect[16];
+  qioerr err;
+  int64_t k;
+  bool any;
+
+  qio_regex_init_default_options(&options);
+  options.utf8 = false;
+  qio_regex_set_create(&options, QIO_REGEX_ANCHOR_UNANCHORED, &set);
+  for( int i = 0; i < npatterns; i++ ) {
+    const char* err_str = NULL;
+    k = qio_regex_set_add(&set, patterns[i], strlen(patterns[i]), &err_str);
+    assert(k == i && err_str == NULL);
+  }
+  assert(qio_regex_set_compile(&set));
+  assert(qio_regex_set_size(&set) == npatterns);
+
+  any = qio_regex_set_match(&set, data,
+                            maxlen < len ? maxlen : len, expect);
+
+  if( (hints & QIO_METHODMASK) == QIO_METHOD_MEMORY ) {
+    err = qio_file_open_mem_ext(&f, NULL, (qio_fdflag_t)
+                                (QIO_FDFLAG_READABLE | QIO_FDFLAG_WRITEABLE |
+                                 QIO_FDFLAG_SEEKABLE), hints, NULL);
+  } else {
+    unlink("set_test.data");
+    err = qio_file_open_access(&f, "set_test.data", "w+", hints, NULL);
+  }
+  assert(!err);
+  err = qio_channel_create(&ch, f, hints, 0, 1, 0, INT64_MAX, NULL, 0);
+  assert(!err);
+  err = qio_channel_write_amt(true, ch, data, len);
+  assert(!err);
+  qio_channel_release(ch);
+
+  err = qio_channel_create(&ch, f, hints, 1, 0, 0, INT64_MAX, NULL, 0);
+  assert(!err);
+  err = qio_regex_set_channel_match(&set, true, ch, maxlen, got);
+  if( any ) assert(!err);
+  else assert(qio_err_to_int(err) == EFORMAT);
+  for( int i = 0; i < npatterns; i++ ) {
+    assert(got[i] == expect[i]);
+  }
+  // It leaves the channel after what it looked at.
+  assert(qio_channel_offset_unlocked(ch) == (maxlen < len ? maxlen : len));
+  err = qio_regex_set_channel_match(&set, true, ch, maxlen, got);
+  if( maxlen >= len ) assert(qio_err_to_int(err) == EEOF);
+  qio_channel_release(ch);
+
+  qio_file_release(f);
+  unlink("set_test.data");
+  qio_regex_set_release(&set);
+}
+
+void check_set_channels(void)
+{
+  // Bounded patterns that don't look around them
+  // are matched in pieces; the others aren't.
+  const char* bounded[] = {"disk full", "timeout after [0-9]{3}ms",
+                           "x{3}y", "never here", "ab|cd"};
+  const char* unbounded[] = {"disk full", "^line 0: ", "boot$",
+                             "timeout after [0-9]+ms", "\\bfull\\b", "never"};
+  qio_hint_t hints[] = {QIO_METHOD_DEFAULT, QIO_METHOD_PREADPWRITE,
+                        QIO_METHOD_MEMORY, QIO_METHOD_MMAP};
+  int64_t maxlens[] = {INT64_MAX, 4096 + 3, 100};
+  std::string data;
+  int64_t lens[3];
+
+  for( int i = 0; data.size() < 3*qbytes_iobuf_size; i++ ) {
+    char line[64];
+    snprintf(line, sizeof(line), "line %d: all is well\n", i);
+    data += line;
+  }
+  // Put matches across the first and second buffer boundaries.
+  data.replace(qbytes_iobuf_size - 4, 9, "disk full");
+  data.replace(2*qbytes_iobuf_size - 10, 19, "timeout after 123ms");
+  data.replace(2*qbytes_iobuf_size + 100, 4, "xxxy");
+  data += "boot";
+
+  lens[0] = data.size();
+  lens[1] = qbytes_iobuf_size + 2;  // cuts "disk full" short
+  lens[2] = 3;
+
+  for( int h = 0; h < 4; h++ ) {
+    for( int l = 0; l < 3; l++ ) {
+      for( int m = 0; m < 3; m++ ) {
+        check_set_channel(bounded, 5, data.c_str(), lens[l], maxlens[m],
+                          hints[h]);
+        check_set_channel(unbounded, 6, data.c_str(), lens[l], maxlens[m],
+                          hints[h]);
+      }
+    }
+  }
+}
+
 int main(int argc, char** argv)
 {
   // use smaller mmap chunks for testing.
@@ -449,6 +556,7 @@ int main(int argc, char** argv)
 
   assert(RE2::FullMatch("hello", "h.*o"));
   check_re_channels();
+  check_set_channels();
   return 0;
 }
 
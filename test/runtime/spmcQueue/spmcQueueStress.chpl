@@ -0,0 +1,52 @@
+// Stress the runtime's single-producer/multi-consumer queue
+// (chpl-spmc-queue.h): one task pushes n elements while numConsumers
+// tasks pop them. Every element must be popped exactly once, and each
+// consumer must see the elements it pops in the order they were pushed.
+// n is many times the queue's chunk size, so chunks are recycled while
+// consumers are still looking for theirs.
+
+require "spmcStress.h";
+
+extern proc spmcInit();
+extern proc spmcDestroy();
+extern proc spmcPush(i: int);
+extern proc spmcPop(): int;
+
+config const n = 300000;
+config const numConsumers = 4;
+
+var seen: [0..<n] atomic int;
+var outOfOrder: atomic int;
+var pushedAll: atomic bool;
+
+spmcInit();
+
+cobegin {
+  {
+    for i in 0..<n do spmcPush(i);
+    pushedAll.write(true);
+  }
+  coforall 1..numConsumers {
+    var last = -1;
+    while true {
+      // if everything was pushed before a pop found the queue empty,
+      // there is nothing left to pop
+      const done = pushedAll.read();
+      const i = spmcPop();
+      if i < 0 {
+        if done then break;
+        currentTask.yieldExecution();
+        continue;
+      }
+      if i <= last then outOfOrder.add(1);
+      last = i;
+      seen[i].add(1);
+    }
+  }
+}
+
+spmcDestroy();
+
+const notOnce = + reduce [s in seen] (s.read() != 1):int;
+writeln("elements not popped exactly once: ", notOnce);
+writeln("elements popped out of order: ", outOfOrder.read());
@@ -0,0 +1,25 @@
+// Wrappers that let spmcQueueStress.chpl drive one chpl_spmc_queue_t,
+// passing the element i as the (non-NULL) pointer i+1.
+
+#include <stdint.h>
+#include "chpl-spmc-queue.h"
+
+static chpl_spmc_queue_t spmcQ;
+
+static inline void spmcInit(void) {
+  chpl_spmc_queue_init(&spmcQ, CHPL_RT_MD_TASK_LAYER_UNSPEC);
+}
+
+static inline void spmcDestroy(void) {
+  chpl_spmc_queue_destroy(&spmcQ);
+}
+
+static inline void spmcPush(int64_t i) {
+  chpl_spmc_queue_push_back(&spmcQ, (void*) (intptr_t) (i + 1));
+}
+
+// Returns -1 if the queue is empty.
+static inline int64_t spmcPop(void) {
+  void* p = chpl_spmc_queue_pop_front(&spmcQ);
+  return p == NULL ? -1 : (int64_t) (intptr_t) p - 1;
+}
@@ -67,6 +67,9 @@ void INTERNAL qt_affinity_set(qthread_worker_t *me,
  * is provided by the physical layer, set all distances to `10`. This routine
  * is only called once to set up all shepherds.
  *
+ * The binders layer uses the SHEP_DIST_* values below, which the distrib
+ * scheduler uses to limit stealing across NUMA domains.
+ *
  * TODO: document interpretation of distance values and significance of default
  *       value of `10`. What is the correlation between values from different
  *       physical layers?
@@ -75,6 +78,10 @@ void INTERNAL qt_affinity_set(qthread_worker_t *me,
 int qt_affinity_gendists(qthread_shepherd_t *sheps,
                          qthread_shepherd_id_t nshepherds);
 
+#define SHEP_DIST_L3 10   /* share an L3 cache */
+#define SHEP_DIST_NUMA 20 /* share a NUMA domain */
+#define SHEP_DIST_FAR 30  /* different NUMA domains */
+
 #ifdef USE_HWLOC_MEM_AFFINITY
 void INTERNAL *qt_affinity_alloc(size_t bytes);
 void INTERNAL *qt_affinity_alloc_onnode(size_t bytes, int node);
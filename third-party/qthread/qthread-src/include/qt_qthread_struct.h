@@ -34,7 +34,7 @@
 #define QTHREAD_TEAM_WATCHER (1 << 8)
 #define QTHREAD_BIG_STRUCT (1 << 9)
 #define QTHREAD_NETWORK (1 << 12)
-#define QTHREAD_RESERVED_FLAG3 (1 << 13)
+#define QTHREAD_PRIORITY (1 << 13)
 #define QTHREAD_RESERVED_FLAG2 (1 << 14)
 #define QTHREAD_RESERVED_FLAG1 (1 << 15)
 
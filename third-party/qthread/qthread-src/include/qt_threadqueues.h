@@ -37,6 +37,16 @@ qthread_t INTERNAL *qt_scheduler_get_thread(qt_threadqueue_t *q,
 void INTERNAL qthread_steal_stat(void);
 void INTERNAL qthread_steal_enable(void);
 void INTERNAL qthread_steal_disable(void);
+size_t INTERNAL qt_threadqueue_steal_count(int remote);
+
+/* Adaptive idle spinning statistics; zero where not supported. */
+enum qt_spin_stat {
+  SPIN_STAT_SPIN_NS,  /* average learned spin time */
+  SPIN_STAT_IDLE_NS,  /* average learned idle interval */
+  SPIN_STAT_WAKEUPS,  /* idle intervals ended while spinning */
+  SPIN_STAT_PARKS     /* idle intervals ended after parking */
+};
+size_t INTERNAL qt_threadqueue_spin_stat(enum qt_spin_stat which);
 void INTERNAL qthread_cas_steal_stat(void);
 
 /* Functions for work stealing functionality */
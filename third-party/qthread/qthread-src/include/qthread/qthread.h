@@ -376,7 +376,13 @@ enum introspective_state {
   CURRENT_WORKER,
   CURRENT_UNIQUE_WORKER,
   CURRENT_TEAM,
-  PARENT_TEAM
+  PARENT_TEAM,
+  LOCAL_STEALS,
+  REMOTE_STEALS,
+  SPIN_NS,
+  IDLE_NS,
+  SPIN_WAKEUPS,
+  SPIN_PARKS
 };
 
 size_t qthread_readstate(const enum introspective_state type);
@@ -6,9 +6,14 @@
 #error HWLOC version unrecognized
 #endif
 
+#include <limits.h>
+#include <string.h>
+
 #include "qt_affinity.h"
 #include "qt_alloc.h"
+#include "qt_asserts.h"
 #include "qt_envariables.h"
+#include "shufflesheps.h"
 
 hwloc_topology_t topology = NULL;
 
@@ -207,22 +212,59 @@ void INTERNAL qt_affinity_set(qthread_worker_t *me,
     topology, workers.binds[me->packed_worker_id], HWLOC_CPUBIND_THREAD);
 }
 
+// The cpuset a shepherd's workers are bound to.  The caller frees it.
+static hwloc_cpuset_t shep_cpuset(size_t shep, qthread_shepherd_id_t nsheps) {
+  if (sheps.binds) { return hwloc_bitmap_dup(sheps.binds[shep]); }
+  hwloc_cpuset_t set = hwloc_bitmap_alloc();
+  int wps = workers.num / nsheps;
+  for (int w = shep * wps; w < (shep + 1) * wps; w++) {
+    hwloc_bitmap_or(set, set, workers.binds[w]);
+  }
+  return set;
+}
+
+// Distance between two shepherds, from the smallest part of the
+// topology containing both: SHEP_DIST_L3 if they share an L3 cache,
+// SHEP_DIST_NUMA if they share a NUMA domain, SHEP_DIST_FAR otherwise.
+static unsigned int shep_distance(hwloc_const_cpuset_t a,
+                                  hwloc_const_cpuset_t b) {
+  hwloc_cpuset_t both = hwloc_bitmap_alloc();
+  hwloc_bitmap_or(both, a, b);
+  hwloc_obj_t obj = hwloc_get_obj_covering_cpuset(topology, both);
+  hwloc_bitmap_free(both);
+  if (obj == NULL) { return SHEP_DIST_FAR; }
+  for (hwloc_obj_t o = obj; o != NULL; o = o->parent) {
+    if (o->type == HWLOC_OBJ_L3CACHE) { return SHEP_DIST_L3; }
+  }
+  if (obj->nodeset != NULL && hwloc_bitmap_weight(obj->nodeset) == 1) {
+    return SHEP_DIST_NUMA;
+  }
+  return SHEP_DIST_FAR;
+}
+
 int INTERNAL qt_affinity_gendists(qthread_shepherd_t *sheps,
                                   qthread_shepherd_id_t nshepherds) {
+  hwloc_cpuset_t *sets = qt_malloc(sizeof(hwloc_cpuset_t) * nshepherds);
   for (size_t i = 0; i < nshepherds; ++i) {
     sheps[i].node = i;
     sheps[i].sorted_sheplist =
       qt_calloc(nshepherds - 1, sizeof(qthread_shepherd_id_t));
     sheps[i].shep_dists = qt_calloc(nshepherds, sizeof(unsigned int));
+    sets[i] = shep_cpuset(i, nshepherds);
   }
   for (size_t i = 0; i < nshepherds; ++i) {
     for (size_t j = 0, k = 0; j < nshepherds; ++j) {
       if (j != i) {
-        sheps[i].shep_dists[j] = 10;
+        sheps[i].shep_dists[j] = shep_distance(sets[i], sets[j]);
         sheps[i].sorted_sheplist[k++] = j;
       }
     }
+    if (nshepherds > 1) {
+      sort_sheps(sheps[i].shep_dists, sheps[i].sorted_sheplist, nshepherds);
+    }
   }
+  for (size_t i = 0; i < nshepherds; ++i) { hwloc_bitmap_free(sets[i]); }
+  qt_free(sets);
 
   return QTHREAD_SUCCESS;
 }
@@ -1354,6 +1354,18 @@ size_t API_FUNC qthread_readstate(const enum introspective_state type) {
         return 0;
       }
 
+    case LOCAL_STEALS: return qt_threadqueue_steal_count(0);
+
+    case REMOTE_STEALS: return qt_threadqueue_steal_count(1);
+
+    case SPIN_NS: return qt_threadqueue_spin_stat(SPIN_STAT_SPIN_NS);
+
+    case IDLE_NS: return qt_threadqueue_spin_stat(SPIN_STAT_IDLE_NS);
+
+    case SPIN_WAKEUPS: return qt_threadqueue_spin_stat(SPIN_STAT_WAKEUPS);
+
+    case SPIN_PARKS: return qt_threadqueue_spin_stat(SPIN_STAT_PARKS);
+
     default: return (size_t)(-1);
   }
 }
@@ -1883,6 +1895,9 @@ int API_FUNC qthread_spawn(qthread_f f,
   if (feature_flag & QTHREAD_SPAWN_SIMPLE) {
     atomic_fetch_or_explicit(&t->flags, QTHREAD_SIMPLE, memory_order_relaxed);
   }
+  if (feature_flag & QTHREAD_SPAWN_LOCAL_PRIORITY) {
+    atomic_fetch_or_explicit(&t->flags, QTHREAD_PRIORITY, memory_order_relaxed);
+  }
   /* Step 4: Prepare the return value location (if necessary) */
   if (ret) {
     int test = QTHREAD_SUCCESS;
@@ -9,6 +9,7 @@
 #include "qthread/qthread.h"
 
 /* Internal Headers */
+#include "qt_affinity.h"
 #include "qt_alloc.h"
 #include "qt_asserts.h"
 #include "qt_envariables.h"
@@ -31,6 +32,11 @@ int max_backoff;
 int spinloop_backoff;
 int condwait_backoff;
 int steal_ratio;
+int steal_remote_ratio;
+
+/* Steal counters, split by whether the victim is in our NUMA domain */
+static _Atomic uint64_t steals_local;
+static _Atomic uint64_t steals_remote;
 
 typedef struct qt_threadqueue_node_s qt_threadqueue_node_t;
 
@@ -179,6 +185,7 @@ static void qt_threadqueue_subsystem_shutdown(void) {
 
 void INTERNAL qt_threadqueue_subsystem_init(void) {
   steal_ratio = qt_internal_get_env_num("STEAL_RATIO", 8, 0);
+  steal_remote_ratio = qt_internal_get_env_num("STEAL_REMOTE_RATIO", 4, 1);
   condwait_backoff = qt_internal_get_env_num("CONDWAIT_BACKOFF", 2048, 0);
   atomic_store_explicit(&finalizing, 0, memory_order_relaxed);
   generic_threadqueue_pools.queues =
@@ -386,6 +393,51 @@ qthread_t INTERNAL *qt_threadqueue_dequeue_specific(qt_threadqueue_t *q,
 
 inline int square(int x) { return x * x; }
 
+// Try to steal from other shepherds, nearest first.  Shepherds in our own
+// NUMA domain are tried every time we get here; ones in other domains only
+// every QT_STEAL_REMOTE_RATIO-th time, so that tasks spawned for
+// NUMA-local data tend to stay there.  Without distance information all
+// shepherds look local.
+static qt_threadqueue_node_t *qt_threadqueue_steal(int numsteals) {
+  qthread_shepherd_t *me = qthread_internal_getshep();
+  qthread_shepherd_id_t const nsheps = qlib->nshepherds;
+  qt_threadqueue_node_t *node;
+
+  if (me == NULL || me->sorted_sheplist == NULL || me->shep_dists == NULL) {
+    for (qthread_shepherd_id_t i = 0; i < nsheps; i++) {
+      node = qt_threadqueue_dequeue_head(qlib->shepherds[i].ready);
+      if (node) {
+        atomic_fetch_add_explicit(&steals_local, 1, memory_order_relaxed);
+        return node;
+      }
+    }
+    return NULL;
+  }
+
+  int const try_remote = (numsteals % steal_remote_ratio == 0);
+  for (qthread_shepherd_id_t i = 0; i + 1 < nsheps; i++) {
+    qthread_shepherd_id_t victim = me->sorted_sheplist[i];
+    int const remote = me->shep_dists[victim] > SHEP_DIST_NUMA;
+    if (remote && !try_remote) { break; }
+    node = qt_threadqueue_dequeue_head(qlib->shepherds[victim].ready);
+    if (node) {
+      atomic_fetch_add_explicit(
+        remote ? &steals_remote : &steals_local, 1, memory_order_relaxed);
+      return node;
+    }
+  }
+  return NULL;
+}
+
+size_t INTERNAL qt_threadqueue_steal_count(int remote) {
+  return (size_t)atomic_load_explicit(remote ? &steals_remote : &steals_local,
+                                      memory_order_relaxed);
+}
+
+size_t INTERNAL qt_threadqueue_spin_stat(enum qt_spin_stat which) {
+  return 0;
+}
+
 // We try and dequeue locally, if that fails we should do some stealing
 qthread_t INTERNAL *qt_scheduler_get_thread(qt_threadqueue_t *qe,
                                             uint_fast8_t active) {
@@ -397,14 +449,11 @@ qthread_t INTERNAL *qt_scheduler_get_thread(qt_threadqueue_t *qe,
 
     // If we've done QT_STEAL_RATIO waits on local queue, try to steal
     if (!node && steal_ratio > 0 && numwaits % steal_ratio == 0) {
-      for (int i = 0; i < qlib->nshepherds; i++) {
-        qt_threadqueue_t *victim_queue = qlib->shepherds[i].ready;
-        node = qt_threadqueue_dequeue_head(victim_queue);
-        if (node) {
-          t = node->value;
-          free_tqnode(node);
-          return t;
-        }
+      node = qt_threadqueue_steal(numwaits / steal_ratio);
+      if (node) {
+        t = node->value;
+        free_tqnode(node);
+        return t;
       }
     }
 
@@ -4,6 +4,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/types.h>
+#include <time.h>
 
 /* API Headers */
 #include "qthread/qthread.h"
@@ -29,6 +30,20 @@
 int num_spins_before_condwait;
 #define DEFAULT_SPINCOUNT 300000
 
+/* With QT_SPIN_ADAPTIVE, an idle worker spins for a time learned from
+ * its recent idle intervals and then parks, instead of using a fixed
+ * spin count.  If wake-ups typically come within half the maximum spin
+ * time, we spin for twice the average interval; otherwise waiting is
+ * usually long enough that parking costs little, so we spin only
+ * briefly. */
+static int spin_adaptive;
+static uint64_t spin_max_ns;
+#define DEFAULT_SPIN_MAX_NS 200000
+#define SPIN_EWMA_SHIFT 3 /* new interval weight is 1/8 */
+#define SPIN_CHECK_INTERVAL 64 /* spins between clock reads */
+static _Atomic aligned_t spin_wakeups = 0;
+static _Atomic aligned_t spin_parks = 0;
+
 typedef struct qt_threadqueue_node_s qt_threadqueue_node_t;
 
 /* Data Structures */
@@ -54,6 +69,9 @@ typedef struct {
 
 struct _qt_threadqueue {
   alignas(CACHELINE_WIDTH) NEMESIS_queue q;
+  /* Tasks spawned with QTHREAD_SPAWN_LOCAL_PRIORITY go here, and the
+   * worker empties this lane before looking at the normal one. */
+  alignas(CACHELINE_WIDTH) NEMESIS_queue prio;
   /* the following is for estimating a queue's "busy" level, and is not
    * guaranteed accurate (that would be a race condition) */
   _Atomic saligned_t advisory_queuelen;
@@ -61,6 +79,9 @@ struct _qt_threadqueue {
   uint32_t frustration;
   QTHREAD_COND_DECL(trigger);
 #endif
+  /* adaptive spinning state; only touched by the queue's one worker */
+  uint64_t spin_ns;
+  uint64_t avg_idle_ns;
 } /* qt_threadqueue_t */;
 
 /* Memory Management */
@@ -80,6 +101,9 @@ static void qt_threadqueue_subsystem_shutdown(void) {
 void INTERNAL qt_threadqueue_subsystem_init(void) {
   num_spins_before_condwait =
     qt_internal_get_env_num("SPINCOUNT", DEFAULT_SPINCOUNT, 0);
+  spin_adaptive = qt_internal_get_env_bool("SPIN_ADAPTIVE", 0);
+  spin_max_ns =
+    qt_internal_get_env_num("SPIN_MAX_NS", DEFAULT_SPIN_MAX_NS, 0);
 
   generic_threadqueue_pools.queues = qt_mpool_create_aligned(
     sizeof(qt_threadqueue_t), _Alignof(qt_threadqueue_t));
@@ -98,12 +122,18 @@ qt_threadqueue_t INTERNAL *qt_threadqueue_new(void) {
   atomic_init(&q->q.head, NULL);
   atomic_init(&q->q.tail, NULL);
   q->q.shadow_head = NULL;
+  atomic_init(&q->prio.head, NULL);
+  atomic_init(&q->prio.tail, NULL);
+  q->prio.shadow_head = NULL;
   q->advisory_queuelen = 0;
   q->q.nemesis_advisory_queuelen = 0; // redundant
+  q->prio.nemesis_advisory_queuelen = 0;
 #ifdef QTHREAD_CONDWAIT_BLOCKING_QUEUE
   q->frustration = 0;
   QTHREAD_COND_INIT(q->trigger);
 #endif /* ifdef QTHREAD_CONDWAIT_BLOCKING_QUEUE */
+  q->spin_ns = spin_max_ns / 4;
+  q->avg_idle_ns = spin_max_ns / 8;
 
   return q;
 }
@@ -173,7 +203,8 @@ qt_internal_NEMESIS_dequeue_st(NEMESIS_queue *q) {
 void INTERNAL qt_threadqueue_free(qt_threadqueue_t *q) {
   assert(q);
   while (1) {
-    qt_threadqueue_node_t *node = qt_internal_NEMESIS_dequeue_st(&q->q);
+    qt_threadqueue_node_t *node = qt_internal_NEMESIS_dequeue_st(&q->prio);
+    if (node == NULL) { node = qt_internal_NEMESIS_dequeue_st(&q->q); }
     if (node) {
       qthread_t *retval = node->thread;
       assert(atomic_load_explicit(&node->next, memory_order_relaxed) == NULL);
@@ -222,10 +253,14 @@ void INTERNAL qt_threadqueue_enqueue(qt_threadqueue_t *restrict q,
   node->thread = t;
   atomic_store_explicit(&node->next, NULL, memory_order_release);
 
-  prev = qt_internal_atomic_swap_ptr((void **)&(q->q.tail), node);
+  NEMESIS_queue *nq =
+    (atomic_load_explicit(&t->flags, memory_order_relaxed) & QTHREAD_PRIORITY)
+      ? &q->prio
+      : &q->q;
+  prev = qt_internal_atomic_swap_ptr((void **)&(nq->tail), node);
 
   if (prev == NULL) {
-    atomic_store_explicit(&q->q.head, node, memory_order_relaxed);
+    atomic_store_explicit(&nq->head, node, memory_order_relaxed);
   } else {
     atomic_store_explicit(&prev->next, node, memory_order_relaxed);
   }
@@ -256,28 +291,109 @@ ssize_t INTERNAL qt_threadqueue_advisory_queuelen(qt_threadqueue_t *q) {
   return atomic_load_explicit(&q->advisory_queuelen, memory_order_relaxed);
 }
 
+static inline int qt_threadqueue_looks_empty(qt_threadqueue_t *q) {
+  return q->q.shadow_head == NULL &&
+         atomic_load_explicit(&q->q.head, memory_order_relaxed) == NULL &&
+         q->prio.shadow_head == NULL &&
+         atomic_load_explicit(&q->prio.head, memory_order_relaxed) == NULL;
+}
+
+static inline qt_threadqueue_node_t *
+qt_threadqueue_dequeue_node(qt_threadqueue_t *q) {
+  qt_threadqueue_node_t *node = qt_internal_NEMESIS_dequeue(&q->prio);
+  if (node == NULL) { node = qt_internal_NEMESIS_dequeue(&q->q); }
+  return node;
+}
+
+static inline uint64_t spin_now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/* Wait for work, spinning for the learned time and then parking, and
+ * fold the length of this idle interval into what we've learned. */
+static void qt_threadqueue_wait_adaptive(qt_threadqueue_t *q) {
+  uint64_t start = spin_now_ns();
+  uint64_t deadline = start + q->spin_ns;
+  uint64_t now = start;
+  int parked = 0;
+
+  while (qt_threadqueue_looks_empty(q)) {
+    for (int i = 0; i < SPIN_CHECK_INTERVAL && qt_threadqueue_looks_empty(q);
+         i++) {
+      SPINLOCK_BODY();
+    }
+    now = spin_now_ns();
+    if (now < deadline) { continue; }
+#ifdef QTHREAD_CONDWAIT_BLOCKING_QUEUE
+    /* The enqueuer checks frustration after its enqueue; we check the
+     * queue after setting it.  With the fence, one of us sees the
+     * other, so the wake-up can't be lost. */
+    QTHREAD_COND_LOCK(q->trigger);
+    q->frustration = 1;
+    MACHINE_FENCE;
+    if (qt_threadqueue_looks_empty(q)) {
+      parked = 1;
+      QTHREAD_COND_WAIT(q->trigger);
+    }
+    QTHREAD_COND_UNLOCK(q->trigger);
+#else
+    SPINLOCK_BODY();
+#endif /* ifdef QTHREAD_CONDWAIT_BLOCKING_QUEUE */
+  }
+  if (parked) { now = spin_now_ns(); }
+
+  uint64_t idle = now - start;
+  q->avg_idle_ns = q->avg_idle_ns - (q->avg_idle_ns >> SPIN_EWMA_SHIFT) +
+                   (idle >> SPIN_EWMA_SHIFT);
+  q->spin_ns = (2 * q->avg_idle_ns <= spin_max_ns) ? 2 * q->avg_idle_ns
+                                                   : spin_max_ns / 16;
+  atomic_fetch_add_explicit(
+    parked ? &spin_parks : &spin_wakeups, 1, memory_order_relaxed);
+}
+
+size_t INTERNAL qt_threadqueue_spin_stat(enum qt_spin_stat which) {
+  if (which == SPIN_STAT_WAKEUPS) {
+    return (size_t)atomic_load_explicit(&spin_wakeups, memory_order_relaxed);
+  }
+  if (which == SPIN_STAT_PARKS) {
+    return (size_t)atomic_load_explicit(&spin_parks, memory_order_relaxed);
+  }
+
+  /* averages over the shepherds' queues */
+  uint64_t sum = 0;
+  for (qthread_shepherd_id_t i = 0; i < qlib->nshepherds; i++) {
+    qt_threadqueue_t *q = qlib->shepherds[i].ready;
+    sum += (which == SPIN_STAT_SPIN_NS) ? q->spin_ns : q->avg_idle_ns;
+  }
+  return qlib->nshepherds ? (size_t)(sum / qlib->nshepherds) : 0;
+}
+
 qthread_t INTERNAL *qt_scheduler_get_thread(qt_threadqueue_t *q,
                                             uint_fast8_t Q_UNUSED(active)) {
 #ifdef QTHREAD_CONDWAIT_BLOCKING_QUEUE
   int i;
 #endif /* QTHREAD_CONDWAIT_BLOCKING_QUEUE */
 
-  qt_threadqueue_node_t *node = qt_internal_NEMESIS_dequeue(&q->q);
+  qt_threadqueue_node_t *node = qt_threadqueue_dequeue_node(q);
   qthread_t *retval;
 
+  if (node == NULL && spin_adaptive) {
+    qt_threadqueue_wait_adaptive(q);
+    node = qt_threadqueue_dequeue_node(q);
+  }
+
   if (node == NULL) {
 #ifdef QTHREAD_CONDWAIT_BLOCKING_QUEUE
     i = num_spins_before_condwait;
-    while (q->q.shadow_head == NULL &&
-           atomic_load_explicit(&q->q.head, memory_order_relaxed) == NULL &&
-           i > 0) {
+    while (qt_threadqueue_looks_empty(q) && i > 0) {
       SPINLOCK_BODY();
       i--;
     }
 #endif /* QTHREAD_CONDWAIT_BLOCKING_QUEUE */
 
-    while (q->q.shadow_head == NULL &&
-           atomic_load_explicit(&q->q.head, memory_order_relaxed) == NULL) {
+    while (qt_threadqueue_looks_empty(q)) {
 #ifndef QTHREAD_CONDWAIT_BLOCKING_QUEUE
       SPINLOCK_BODY();
 #else
@@ -288,7 +404,7 @@ qthread_t INTERNAL *qt_scheduler_get_thread(qt_threadqueue_t *q,
       }
 #endif /* ifdef USE_HARD_POLLING */
     }
-    node = qt_internal_NEMESIS_dequeue(&q->q);
+    node = qt_threadqueue_dequeue_node(q);
   }
   assert(node);
   assert(atomic_load_explicit(&node->next, memory_order_relaxed) == NULL);
@@ -299,7 +415,8 @@ qthread_t INTERNAL *qt_scheduler_get_thread(qt_threadqueue_t *q,
   return retval;
 }
 
-/* walk queue removing all tasks matching this description */
+/* walk queue removing all tasks matching this description; the priority
+ * lane is not filtered */
 void INTERNAL qt_threadqueue_filter(qt_threadqueue_t *q,
                                     qt_threadqueue_filter_f f) {
   NEMESIS_queue tmp;
@@ -376,6 +493,8 @@ void INTERNAL qthread_steal_stat(void) {}
 
 void INTERNAL qthread_cas_steal_stat(void) {}
 
+size_t INTERNAL qt_threadqueue_steal_count(int remote) { return 0; }
+
 qthread_t INTERNAL *qt_threadqueue_dequeue_specific(qt_threadqueue_t *q,
                                                     void *value) {
   return NULL;
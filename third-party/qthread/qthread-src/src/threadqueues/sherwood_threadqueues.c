@@ -9,6 +9,7 @@
 #include "qthread/qthread.h"
 
 /* Internal Headers */
+#include "qt_affinity.h"
 #include "qt_alloc.h"
 #include "qt_asserts.h"
 #include "qt_envariables.h"
@@ -45,6 +46,8 @@ struct _qt_threadqueue {
 } /* qt_threadqueue_t */;
 
 static aligned_t steal_disable = 0;
+static _Atomic uint64_t steals_local;
+static _Atomic uint64_t steals_remote;
 static long steal_chunksize = 0;
 
 // Forward declarations
@@ -485,6 +488,13 @@ qthread_steal(qthread_shepherd_t *thief_shepherd) {
                                   memory_order_relaxed)) {
       stolen = qt_threadqueue_dequeue_steal(myqueue, victim_queue);
       if (stolen) {
+        unsigned int dist = (thief_shepherd->shep_dists == NULL)
+                              ? 0
+                              : thief_shepherd->shep_dists[sorted_sheplist[i]];
+        atomic_fetch_add_explicit(dist > SHEP_DIST_NUMA ? &steals_remote
+                                                        : &steals_local,
+                                  1,
+                                  memory_order_relaxed);
         qt_threadqueue_node_t *surplus = stolen->next;
         if (surplus) {
           stolen->next = NULL;
@@ -627,6 +637,15 @@ qthread_t INTERNAL *qt_threadqueue_dequeue_specific(qt_threadqueue_t *q,
   return (t);
 }
 
+size_t INTERNAL qt_threadqueue_steal_count(int remote) {
+  return (size_t)atomic_load_explicit(remote ? &steals_remote : &steals_local,
+                                      memory_order_relaxed);
+}
+
+size_t INTERNAL qt_threadqueue_spin_stat(enum qt_spin_stat which) {
+  return 0;
+}
+
 void INTERNAL qthread_steal_enable(void) { steal_disable = 0; }
 
 void INTERNAL qthread_steal_disable(void) { steal_disable = 1; }
@@ -160,6 +160,7 @@ struct AstNodeObject : public PythonClassWithContext<AstNodeObject, const chpl::
 };
 
 using QualifiedTypeTuple = std::tuple<const char*, Nilable<const chpl::types::Type*>, Nilable<const chpl::types::Param*>>;
+using NodeAndQualifiedTypeTuple = std::tuple<const chpl::uast::AstNode*, QualifiedTypeTuple>;
 
 struct ChapelTypeObject  : public PythonClassWithContext<ChapelTypeObject, const chpl::types::Type*> {
   static constexpr const char* QualifiedName = "chapel.ChapelType";
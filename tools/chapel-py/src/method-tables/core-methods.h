@@ -75,6 +75,24 @@ CLASS_BEGIN(Context)
 
          auto prepareToGc = std::get<0>(args);
          node->advanceToNextRevision(prepareToGc))
+  METHOD(Context, collect_garbage, "Remove query results not used in the given number of most recent revisions",
+         void(int),
+
+         auto keepRevisions = std::get<0>(args);
+         node->collectGarbage(keepRevisions > 0 ? keepRevisions : 1))
+  METHOD(Context, types_for_nodes, "Get the type of each of the given AST nodes, as with AstNode.type, in one call",
+         std::vector<std::optional<QualifiedTypeTuple>>(std::vector<const chpl::uast::AstNode*>),
+
+         std::vector<std::optional<QualifiedTypeTuple>> toReturn;
+         for (auto astNode : std::get<0>(args)) {
+           auto& qt = typeForNode(node, astNode);
+           if (qt.isUnknown()) {
+             toReturn.push_back({});
+           } else {
+             toReturn.push_back(std::make_tuple(intentToString(qt.kind()), qt.type(), qt.param()));
+           }
+         }
+         return toReturn)
   METHOD(Context, get_file_text, "Get the text of the file at the given path",
          std::string(chpl::UniqueString), return parsing::fileText(node, std::get<0>(args)).text())
   METHOD(Context, get_compiler_version, "Get the version of the Chapel compiler",
@@ -78,6 +78,26 @@ CLASS_BEGIN(AstNode)
                }
 
                return std::make_tuple(intentToString(qt.kind()), qt.type(), qt.param()))
+  METHOD(AstNode, types_in_subtree, "Get the types of the nodes in this subtree that have one of the given tags (as returned by 'tag'), or of all nodes if no tags are given. Nodes with unknown types are left out. This is faster than calling 'type' on each node.",
+         std::vector<NodeAndQualifiedTypeTuple>(std::vector<std::string>),
+
+         auto& tagNames = std::get<0>(args);
+         std::vector<bool> wantTag;
+         if (!tagNames.empty()) {
+           wantTag.resize(asttags::NUM_AST_TAGS, false);
+           for (int t = 0; t < asttags::NUM_AST_TAGS; t++) {
+             auto name = asttags::tagToString((asttags::AstTag) t);
+             for (auto& tagName : tagNames) {
+               if (tagName == name) wantTag[t] = true;
+             }
+           }
+         }
+
+         std::vector<NodeAndQualifiedTypeTuple> toReturn;
+         for (auto& [n, qt] : typesInSubtree(context, node, wantTag)) {
+           toReturn.emplace_back(n, std::make_tuple(intentToString(qt.kind()), qt.type(), qt.param()));
+         }
+         return toReturn)
   PLAIN_GETTER(AstNode, called_fn, "Get the function being invoked by this node",
                Nilable<const chpl::uast::AstNode*>, return calledFnForNode(context, node))
   PLAIN_GETTER(AstNode, resolve, "Perform resolution on code surrounding this node to determine its type and other information.",
@@ -291,6 +291,95 @@ std::vector<int> const& actualOrderForNode(Context* context, const AstNode* node
   return QUERY_END(res);
 }
 
+namespace {
+
+// Walks a subtree, gathering the types of the nodes with the requested
+// tags. This finds the same results as resolveResultsForNode would for
+// each node, but resolves each enclosing function or module only once,
+// and only if a requested node needs it.
+struct SubtreeTypeGatherer {
+  struct Enclosing {
+    const AstNode* ast;
+    const resolution::ResolutionResultByPostorderID* results = nullptr;
+    bool resolved = false;
+  };
+
+  Context* context;
+  const std::vector<bool>& wantTag; // empty means every tag
+  std::vector<Enclosing> enclosing; // innermost last
+  std::vector<std::tuple<const AstNode*, QualifiedType>> found;
+
+  SubtreeTypeGatherer(Context* context, const std::vector<bool>& wantTag)
+    : context(context), wantTag(wantTag) {}
+
+  const resolution::ResolutionResultByPostorderID* resultsFor(Enclosing& e) {
+    if (!e.resolved) {
+      e.resolved = true;
+      if (auto fn = e.ast->toFunction()) {
+        if (auto resolvedFn =
+              resolution::resolveConcreteFunction(context, fn->id())) {
+          e.results = &resolvedFn->resolutionById();
+        }
+      } else if (auto mod = e.ast->toModule()) {
+        e.results = &resolution::resolveModule(context, mod->id());
+      }
+    }
+    return e.results;
+  }
+
+  void gather(const AstNode* node) {
+    for (auto it = enclosing.rbegin(); it != enclosing.rend(); ++it) {
+      auto results = resultsFor(*it);
+      if (!results) continue;
+      if (auto rr = results->byAstOrNull(node)) {
+        if (!rr->type().isUnknown()) {
+          found.emplace_back(node, rr->type());
+        }
+        return;
+      }
+    }
+  }
+
+  void enterEnclosing(const AstNode* node) {
+    if (node->isFunction() || node->isModule()) {
+      enclosing.push_back(Enclosing{node});
+    }
+  }
+
+  void visit(const AstNode* node) {
+    size_t depth = enclosing.size();
+    enterEnclosing(node);
+    if (wantTag.empty() || wantTag[node->tag()]) {
+      gather(node);
+    }
+    for (auto child : node->children()) {
+      visit(child);
+    }
+    enclosing.resize(depth);
+  }
+};
+
+} // end anonymous namespace
+
+std::vector<std::tuple<const AstNode*, QualifiedType>>
+typesInSubtree(Context* context, const AstNode* root,
+               const std::vector<bool>& wantTag) {
+  SubtreeTypeGatherer gatherer(context, wantTag);
+
+  // the functions and modules around 'root' may hold its results
+  std::vector<const AstNode*> parents;
+  for (auto p = parsing::parentAst(context, root); p;
+       p = parsing::parentAst(context, p)) {
+    parents.push_back(p);
+  }
+  for (auto it = parents.rbegin(); it != parents.rend(); ++it) {
+    gatherer.enterEnclosing(*it);
+  }
+
+  gatherer.visit(root);
+  return std::move(gatherer.found);
+}
+
 
 static inline ID parseAndGetSymbolIdFromTopLevelModule(Context* context,
                                                        const char* modName,
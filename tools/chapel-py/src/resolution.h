@@ -39,6 +39,13 @@ calledFnForNode(chpl::Context* context, const chpl::uast::AstNode* node);
 std::vector<int> const&
 actualOrderForNode(chpl::Context* context, const chpl::uast::AstNode* node);
 
+/* Get the types of the nodes in the subtree rooted at 'root' whose tags
+   are set in 'wantTag' (or of every node, if it's empty), leaving out
+   nodes whose type is unknown. */
+std::vector<std::tuple<const chpl::uast::AstNode*, chpl::types::QualifiedType>>
+typesInSubtree(chpl::Context* context, const chpl::uast::AstNode* root,
+               const std::vector<bool>& wantTag);
+
 std::vector<const chpl::uast::Function*> const&
 findTestFunctionsForModule(chpl::Context* context, const chpl::uast::Module* mod);
 
@@ -23,6 +23,7 @@
 #include <cstring>
 #include <ios>
 #include <iostream>
+#include <iterator>
 #include <fstream>
 #include <limits>
 #include <regex>
@@ -30,6 +31,7 @@
 #include <queue>
 #include <iomanip>
 #include <ctime>
+#include <sstream>
 
 #include "arg.h"
 #include "arg-helpers.h"
@@ -70,6 +72,8 @@ std::string fDocsAuthor = "";
 std::string fDocsCommentLabel = "/*";
 std::vector<std::string> cmdLineModPaths;
 bool fDocsProcessUsedModules = false;
+bool fDocsIncremental = false;
+int fDocsThreads = 1;
 std::string fDocsSphinxDir = "";
 bool fDocsTextOnly = false;
 bool fDocsHTML = true;
@@ -254,6 +258,8 @@ ArgumentDescription docs_arg_desc[] = {
  {"comment-style", ' ', "<indicator>", "Only includes comments that start with <indicator>", "P", &fDocsCommentLabel, NULL, NULL},
  {"module-dir", 'M', "<directory>", "Add directory to module search path", "P", NULL, NULL, addModulePath},
  {"process-used-modules", ' ', NULL, "Also parse and document 'use'd modules", "F", &fDocsProcessUsedModules, NULL, NULL},
+ {"incremental", ' ', NULL, "[Don't] skip modules whose source hasn't changed since the last run, using a .chpldoc-cache file in the output directory (off by default)", "N", &fDocsIncremental, "CHPLDOC_INCREMENTAL", NULL},
+ {"threads", ' ', "<n>", "Parse the source files using <n> threads", "I", &fDocsThreads, "CHPLDOC_THREADS", NULL},
  {"save-sphinx",  ' ', "<directory>", "Save generated Sphinx project in directory", "P", &fDocsSphinxDir, NULL, NULL},
  {"text-only", ' ', NULL, "Generate text documentation only", "F", &fDocsTextOnly, NULL, NULL},
  {"html", ' ', NULL, "[Don't] generate html documentation (on by default)", "N", &fDocsHTML, NULL, NULL},
@@ -1358,6 +1364,50 @@ struct RstSignatureVisitor {
   void exit(const AstNode* a) {}
 };
 
+static std::string moduleOutputExtension() {
+  return fDocsTextOnly ? ".txt" : ".rst";
+}
+
+/**
+ The incremental output cache, used with --incremental. It maps each
+ generated file to a key for the source file it was generated from and
+ the options that affect its contents, so that a module whose key hasn't
+ changed since the last run doesn't need to be documented again. It is saved as a file in the
+ directory of generated files, so it only helps when that directory is
+ kept between runs (with --text-only or --save-sphinx). A skipped module
+ isn't visited at all, so any warnings about its docs are not reported
+ again; that is why the cache is opt-in.
+ */
+static const char* docsCacheFileName = ".chpldoc-cache";
+static std::unordered_map<std::string, std::string> docsCache;
+
+static void readDocsCache(const std::string& dir) {
+  std::ifstream ifs(dir + "/" + docsCacheFileName);
+  std::string key, outpath;
+  // each line is the key, a space, and the path of the generated file
+  while (ifs >> key && std::getline(ifs >> std::ws, outpath)) {
+    docsCache[outpath] = key;
+  }
+}
+
+static void writeDocsCache(const std::string& dir) {
+  std::ofstream ofs(dir + "/" + docsCacheFileName, std::ios::out);
+  for (const auto& entry : docsCache) {
+    ofs << entry.second << " " << entry.first << "\n";
+  }
+}
+
+static std::string docsCacheKey(Context* context, UniqueString filePath) {
+  const FileContents& contents = fileText(context, filePath);
+  if (contents.error() != nullptr) return "";
+
+  std::string key = fileHashToHex(hashString(contents.text()));
+  key += " " + chpl::getVersion();
+  key += " " + fDocsCommentLabel;
+  key += " " + moduleOutputExtension();
+  return fileHashToHex(hashString(key));
+}
+
 /**
  Stores the rst docs result of an AstNode and its children.
  `doc` looks like: (using Python's triple quote syntax)
@@ -1405,8 +1455,7 @@ struct RstResult {
   void mark(const Context *c) const {}
 
   void outputModule(std::string outDir, std::string name, int indentPerDepth) {
-    std::string ext = fDocsTextOnly ? ".txt" : ".rst";
-    auto outpath = outDir + "/" + name + ext;
+    auto outpath = outDir + "/" + name + moduleOutputExtension();
 
     std::error_code err = makeDir(outDir, true);
 
@@ -1417,8 +1466,23 @@ struct RstResult {
         return;
       }
     }
+
+    std::ostringstream oss;
+    output(oss, indentPerDepth);
+    std::string contents = oss.str();
+
+    // Leave the file alone if it wouldn't change, so that its timestamp
+    // doesn't make sphinx-build think it has to rebuild the page.
+    std::ifstream ifs(outpath, std::ios::in | std::ios::binary);
+    if (ifs) {
+      std::string old((std::istreambuf_iterator<char>(ifs)),
+                      std::istreambuf_iterator<char>());
+      if (old == contents) return;
+    }
+    ifs.close();
+
     std::ofstream ofs = std::ofstream(outpath, std::ios::out);
-    output(ofs, indentPerDepth);
+    ofs << contents;
   }
 
   void output(std::ostream& os, int indentPerDepth) {
@@ -2489,6 +2553,14 @@ int main(int argc, char** argv) {
     commandLineModulePaths.push_back(uPath);
   }
 
+  if (fDocsThreads > 1) {
+    // lex and parse the files in parallel before the modules are visited
+    prefetchParses(gContext, commandLineModulePaths, fDocsThreads);
+    if (fDocsProcessUsedModules) {
+      prefetchModuleSearchPath(gContext, fDocsThreads);
+    }
+  }
+
   // compute the main module
   ID mainModule;
   std::vector<ID> commandLineModuleIDs;
@@ -2544,35 +2616,61 @@ int main(int argc, char** argv) {
   // exit if there were fatal errors in the processing done so far
   erroHandler->printAndExitIfError(gContext);
 
+  if (fDocsIncremental) {
+    readDocsCache(outputDir_);
+  }
+
   for (auto id : gather.modules) {
-    if (auto& r = rstDoc(gContext, id, 1)) {
-        // given a module ID we can get the path to the file that we parsed
-        UniqueString filePath;
-        UniqueString parentSymbol;
-        gContext->filePathForId(id, filePath, parentSymbol);
-        std::string moduleName = id.symbolName(gContext).str();
-        std::string parentPath;
-        auto pathVec = id.expandSymbolPath(gContext, id.symbolPath());
-        // remove last entry
-        pathVec.pop_back();
-        for (auto path : pathVec) {
-          for (int i = 0; i <= path.second; i++) {
-            if (path.first != id.symbolName(gContext)) {
-              parentPath += unescapeStringId(path.first.str()) + "/";
-            }
-          }
-        }
-        std::string docsWorkingDir_ = filenameFromModuleName(filePath.c_str(), outputDir_);
-        std::string outdir = docsWorkingDir_;
-        // TODO: This is an ugly hack to handle included module paths
-        if (parentSymbol.isEmpty()) {
-          outdir += "/" + parentPath;
+    // given a module ID we can get the path to the file that we parsed
+    UniqueString filePath;
+    UniqueString parentSymbol;
+    gContext->filePathForId(id, filePath, parentSymbol);
+    std::string moduleName = id.symbolName(gContext).str();
+    std::string parentPath;
+    auto pathVec = id.expandSymbolPath(gContext, id.symbolPath());
+    // remove last entry
+    pathVec.pop_back();
+    for (auto path : pathVec) {
+      for (int i = 0; i <= path.second; i++) {
+        if (path.first != id.symbolName(gContext)) {
+          parentPath += unescapeStringId(path.first.str()) + "/";
         }
+      }
+    }
+    std::string docsWorkingDir_ = filenameFromModuleName(filePath.c_str(), outputDir_);
+    std::string outdir = docsWorkingDir_;
+    // TODO: This is an ugly hack to handle included module paths
+    if (parentSymbol.isEmpty()) {
+      outdir += "/" + parentPath;
+    }
+
+    // with --incremental, skip the module if its source is the same as
+    // when its docs were generated (this also skips any warnings about
+    // its docs)
+    std::string outpath = outdir + "/" + moduleName + moduleOutputExtension();
+    std::string key;
+    if (fDocsIncremental) {
+      key = docsCacheKey(gContext, filePath);
+      auto it = docsCache.find(outpath);
+      if (!key.empty() && it != docsCache.end() && it->second == key &&
+          llvm::sys::fs::exists(outpath)) {
+        continue;
+      }
+      docsCache.erase(outpath);
+    }
 
-        // need to check for a parent module in the path and add it to the directory structure if it exists
-        r->outputModule(outdir, moduleName, indentPerDepth);
-     }
-   }
+    if (auto& r = rstDoc(gContext, id, 1)) {
+      // need to check for a parent module in the path and add it to the directory structure if it exists
+      r->outputModule(outdir, moduleName, indentPerDepth);
+      if (!key.empty()) {
+        docsCache[outpath] = key;
+      }
+    }
+  }
+
+  if (fDocsIncremental) {
+    writeDocsCache(outputDir_);
+  }
 
   // chpldoc-specific warnings could've been issued, make sure they're printed.
   erroHandler->printAndExitIfError(gContext);
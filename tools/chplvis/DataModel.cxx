@@ -19,6 +19,7 @@
  */
 
 #include "DataModel.h"
+#include "chpl-visual-debug-format.h"
 
 // FLTK includes
 #include <FL/fl_ask.H>
@@ -32,11 +33,16 @@
 #include <time.h>
 #include <assert.h>
 #include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 
 // C++ Libraries
+#include <algorithm>
 #include <set>
+#include <string>
+#include <vector>
 
 #ifndef MAXPATHLEN
 #define MAXPATHLEN 2048
@@ -47,6 +53,214 @@
 #define EXPECTED_VMAJOR 1
 #define EXPECTED_VMINOR 4
 
+// Reads the records that follow the first line of a data file, giving
+// each one back as the line the text format would have for it.  In a
+// binary file the event records between two text records can be in
+// any order, so they are put in time order first.
+
+class RecordReader {
+  public:
+    RecordReader(FILE *f, bool isBinary) : data(f), binary(isBinary), next(0) {}
+    bool getLine(char *line, int maxLen);
+
+  private:
+    struct record {
+      long sec;
+      long usec;
+      std::string text;
+      bool operator< (const record &r) const
+        { return sec < r.sec || (sec == r.sec && usec < r.usec); }
+    };
+
+    FILE *data;
+    bool binary;
+    std::vector<record> records;
+    size_t next;
+
+    bool refill();
+    bool decode(const chpl_vdebug_rec_hdr_t &hdr, const char *payload,
+                std::string &text);
+};
+
+bool RecordReader::getLine(char *line, int maxLen)
+{
+  if (!binary)
+    return fgets(line, maxLen, data) == line;
+  if (next == records.size() && !refill())
+    return false;
+  snprintf(line, maxLen, "%s", records[next++].text.c_str());
+  return true;
+}
+
+bool RecordReader::refill()
+{
+  chpl_vdebug_rec_hdr_t hdr;
+  std::vector<char> payload;
+
+  records.clear();
+  next = 0;
+  while (fread(&hdr, sizeof(hdr), 1, data) == 1) {
+    payload.resize(hdr.len + 1);
+    if (hdr.len > 0 && fread(&payload[0], hdr.len, 1, data) != 1)
+      break;
+    payload[hdr.len] = 0;
+
+    record r;
+    r.sec = hdr.sec;
+    r.usec = hdr.usec;
+    if (hdr.kind == VDEBUG_REC_TEXT) {
+      std::stable_sort(records.begin(), records.end());
+      r.text.assign(&payload[0], hdr.len);
+      records.push_back(r);
+      return true;
+    }
+    if (decode(hdr, &payload[0], r.text))
+      records.push_back(r);
+  }
+  std::stable_sort(records.begin(), records.end());
+  return !records.empty();
+}
+
+bool RecordReader::decode(const chpl_vdebug_rec_hdr_t &hdr, const char *payload,
+                          std::string &text)
+{
+  static const char *commNames[] =
+    { "nb_put", "nb_get", "put", "get", "st_put", "st_get" };
+  static const char *forkNames[] = { "fork", "fork_nb", "f_fork" };
+  char line[MAX_LINE_LEN];
+
+  switch (hdr.kind) {
+    case VDEBUG_REC_TASK: {
+      chpl_vdebug_rec_task_t t;
+      if (hdr.len != sizeof(t)) return false;
+      memcpy(&t, payload, sizeof(t));
+      snprintf(line, sizeof(line), "task: %lld.%06ld %d %lld %lld %s %d %d %d\n",
+               (long long) hdr.sec, (long) hdr.usec, t.nid,
+               (long long) t.taskId, (long long) t.parentTaskId,
+               t.isExecuteOn ? "O" : "L", t.lineno, t.fileno, t.fid);
+      break;
+    }
+
+    case VDEBUG_REC_BTASK:
+    case VDEBUG_REC_ETASK: {
+      chpl_vdebug_rec_task_state_t t;
+      if (hdr.len != sizeof(t)) return false;
+      memcpy(&t, payload, sizeof(t));
+      snprintf(line, sizeof(line), "%s: %lld.%06ld %d %lld\n",
+               hdr.kind == VDEBUG_REC_BTASK ? "Btask" : "Etask",
+               (long long) hdr.sec, (long) hdr.usec, t.nid,
+               (long long) t.taskId);
+      break;
+    }
+
+    case VDEBUG_REC_COMM: {
+      chpl_vdebug_rec_comm_t c;
+      if (hdr.len != sizeof(c) || hdr.sub > VDEBUG_COMM_ST_GET) return false;
+      memcpy(&c, payload, sizeof(c));
+      snprintf(line, sizeof(line),
+               "%s: %lld.%06ld %d %d %lld %#llx %#llx %lld %lld %d %d %d\n",
+               commNames[hdr.sub], (long long) hdr.sec, (long) hdr.usec,
+               c.nid, c.rnid, (long long) c.taskId,
+               (unsigned long long) c.addr, (unsigned long long) c.raddr,
+               (long long) c.elemSize, (long long) c.length,
+               c.commID, c.lineno, c.fileno);
+      break;
+    }
+
+    case VDEBUG_REC_FORK: {
+      chpl_vdebug_rec_fork_t f;
+      if (hdr.len != sizeof(f) || hdr.sub > VDEBUG_FORK_FAST) return false;
+      memcpy(&f, payload, sizeof(f));
+      snprintf(line, sizeof(line),
+               "%s: %lld.%06ld %d %d %d %d %#llx %lld %lld %d %d\n",
+               forkNames[hdr.sub], (long long) hdr.sec, (long) hdr.usec,
+               f.nid, f.rnid, f.subloc, f.fid, (unsigned long long) f.arg,
+               (long long) f.argSize, (long long) f.taskId,
+               f.lineno, f.fileno);
+      break;
+    }
+
+    default:
+      return false;
+  }
+
+  text = line;
+  return true;
+}
+
+// The state shared by the threads reading locale files
+
+struct fileLoader {
+  DataModel *dm;
+  const char *baseName;
+  int namesize;
+  double seq;
+  int numFiles;
+  std::vector<Event *> *events;
+  int *tags;
+  int *ok;
+  int nextFile;    // taken with __sync_fetch_and_add
+};
+
+void *DataModel::LoadFileThread (void *arg)
+{
+  fileLoader *fl = (fileLoader *)arg;
+  char fname[fl->namesize+15];
+  int i;
+
+  while ((i = __sync_fetch_and_add(&fl->nextFile, 1)) < fl->numFiles) {
+    snprintf (fname, fl->namesize+15, "%.*s%d", fl->namesize, fl->baseName, i);
+    fl->ok[i] = fl->dm->LoadFile(fname, i, fl->seq, fl->events[i], fl->tags[i]);
+  }
+  return NULL;
+}
+
+// Time-sorted events for stable_sort
+
+struct eventTimeLess {
+  bool operator() (Event *lh, Event *rh) const { return *lh < *rh; }
+};
+
+void DataModel::MergeFiles (std::vector<Event *> *perLocale)
+{
+  std::vector<size_t> pos(numLocales, 0);
+  std::vector<Event *> timed;
+  bool more = true;
+
+  // Every file is a Start followed by stretches of timed events, each
+  // ended by a Tag, Pause or End.  Take those one stretch at a time.
+  while (more) {
+    Event *first = NULL;
+
+    for (int i = 0; i < numLocales; i++) {
+      if (pos[i] < perLocale[i].size() && perLocale[i][pos[i]]->Ekind() <= Ev_end) {
+        Event *ev = perLocale[i][pos[i]++];
+        if (first == NULL) {
+          first = ev;
+        } else if (ev->Ekind() != first->Ekind()
+                   || (ev->Ekind() == Ev_tag
+                       && ((E_tag *)ev)->tagNo() != ((E_tag *)first)->tagNo())) {
+          fprintf (stderr, "Internal error, event mismatch. locale %d\n", i);
+          printf ("newEvent: "); ev->print();
+          printf ("expected: "); first->print();
+        }
+        theEvents.push_back(ev);
+      }
+    }
+
+    timed.clear();
+    more = false;
+    for (int i = 0; i < numLocales; i++) {
+      while (pos[i] < perLocale[i].size() && perLocale[i][pos[i]]->Ekind() > Ev_end)
+        timed.push_back(perLocale[i][pos[i]++]);
+      if (pos[i] < perLocale[i].size())
+        more = true;
+    }
+    std::stable_sort(timed.begin(), timed.end(), eventTimeLess());
+    theEvents.insert(theEvents.end(), timed.begin(), timed.end());
+  }
+}
+
 void DataModel::newList()
 {
   curEvent = theEvents.begin();
@@ -155,7 +369,6 @@ int DataModel::LoadData(const char * filename, bool fromArgv)
     return 0;
   }
 
-  char fname[namesize+15];
   // printf ("LoadData: nlocalse = %d, fnum = %d seq = %.3lf\n", nlocales, fnum, seq);
 
   // Set the number of locales.
@@ -165,32 +378,63 @@ int DataModel::LoadData(const char * filename, bool fromArgv)
   mainTID = tid;
   mainTask.taskRec = new E_task (0, 0, 0, tid, 0, 0, -1, -1);
 
-  // Debug
   std::list<Event *>::iterator itr;
 
+  // File 0 has the file, function and tag name tables the others
+  // need, so it goes first.  The rest are read in parallel.
+  std::vector<std::vector<Event *> > perLocale(nlocales);
+  std::vector<int> fileTags(nlocales, 0);
+  std::vector<int> fileOk(nlocales, 0);
+  fileLoader loader;
+  loader.dm = this;
+  loader.baseName = fullfilename;
+  loader.namesize = namesize;
+  loader.seq = seq;
+  loader.numFiles = nlocales;
+  loader.events = &perLocale[0];
+  loader.tags = &fileTags[0];
+  loader.ok = &fileOk[0];
+  loader.nextFile = 0;
+
+  loader.numFiles = 1;
+  (void)LoadFileThread(&loader);
+  if (fileOk[0] && nlocales > 1) {
+    long nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+    if (nthreads < 1)
+      nthreads = 1;
+    if (nthreads > nlocales - 1)
+      nthreads = nlocales - 1;
+    std::vector<pthread_t> threads(nthreads);
+    loader.numFiles = nlocales;
+    loader.nextFile = 1;
+    int started = 0;
+    for (int i = 0; i < nthreads; i++) {
+      if (pthread_create(&threads[started], NULL, LoadFileThread, &loader) == 0)
+        started++;
+    }
+    (void)LoadFileThread(&loader);    // Help out, and cover failed creates
+    for (int i = 0; i < started; i++)
+      pthread_join(threads[i], NULL);
+  }
+
+  int newNumTags = 0;
   for (int i = 0; i < nlocales; i++) {
-    snprintf (fname, namesize+15, "%.*s%d", namesize, fullfilename, i);
-    if (!LoadFile(fname, i, seq)) {
+    if (!fileOk[i]) {
+      char fname[namesize+15];
+      snprintf (fname, namesize+15, "%.*s%d", namesize, fullfilename, i);
       if (!fromArgv)
         fl_message ("Error processing data from %s", fname);
       else
-        fl_message ("Error processing data from %s\n", fname);
+        printf ("Error processing data from %s\n", fname);
       numLocales = -1;
       return 0;
     }
-    // Debug
-    /*
-
-    printf ("\nAfter file %s\n", fname);
-    itr = theEvents.begin();
-    while (itr != theEvents.end()) {
-      (*itr)->print();
-      itr++;
-    }
-    printf ("---------------\n");
-    */
-
+    if (fileTags[i] > newNumTags)
+      newNumTags = fileTags[i];
   }
+  numTags = newNumTags;
+
+  MergeFiles(&perLocale[0]);
 
   // Build data structures, taglist: comms/tag
 
@@ -796,7 +1040,8 @@ int DataModel::LoadData(const char * filename, bool fromArgv)
 
 // Load the data in the current file
 
-int DataModel::LoadFile (const char *fileToOpen, int index, double seq)
+int DataModel::LoadFile (const char *fileToOpen, int index, double seq,
+                         std::vector<Event *> &events, int &fileTags)
 {
   FILE *data = fopen(fileToOpen, "r");
   char line[MAX_LINE_LEN];
@@ -833,6 +1078,8 @@ int DataModel::LoadFile (const char *fileToOpen, int index, double seq)
     return 0;
   }
 
+  RecordReader reader(data, strstr(line, VDEBUG_BINARY_MARK "\n") != NULL);
+
   // Verify the data
 
   if (floc != numLocales || findex != index || fabs(seq-fseq) > .01 || VerMinor != EXPECTED_VMINOR) {
@@ -846,23 +1093,16 @@ int DataModel::LoadFile (const char *fileToOpen, int index, double seq)
   if (findex != 0)
     (void)vdbTids.insert(vdbTid);
 
-  // Create a start event with starting user/sys times.
-  std::list<Event *>::iterator itr = theEvents.begin();
-
   // Other initializations
-  numTags = 0;
+  fileTags = 0;
 
-  // Now read the rest of the file
+  // Create a start event with starting user/sys times.
   Event *newEvent = new E_start(e_sec, e_usec, findex, u_sec, u_usec, s_sec, s_usec);
-  if (itr == theEvents.end()) {
-    theEvents.push_front(newEvent);
-  } else {
-    // Move past existing start events
-    while ((*itr)->Ekind() == Ev_start) { itr++; }
-    theEvents.insert(itr,newEvent);
-  }
+  events.push_back(newEvent);
 
-  while ( fgets(line, MAX_LINE_LEN, data) == line ) {
+  // Now read the rest of the file
+
+  while ( reader.getLine(line, MAX_LINE_LEN) ) {
     // Common Data
     char *linedata;
     long linelen;
@@ -1128,8 +1368,8 @@ int DataModel::LoadFile (const char *fileToOpen, int index, double seq)
         } else {
           newEvent = new E_tag(sec, usec, nid, u_sec, u_usec, s_sec, s_usec, tagId,
                                tagNames[tagId], vdbTid);
-          if (tagId >= numTags)
-            numTags = tagId+1;
+          if (tagId >= fileTags)
+            fileTags = tagId+1;
           if (nid == 0) {
             nid0vdbtask = 0;
           }
@@ -1179,73 +1419,16 @@ int DataModel::LoadFile (const char *fileToOpen, int index, double seq)
         /* Do nothing */ ;
     }
 
-    //  Add the newEvent to the list, group Starts, Tags, Resumes and Ends together.
-    if (newEvent) {
-      if (theEvents.empty()) {
-        theEvents.push_front (newEvent);
-      } else if (itr == theEvents.end()) {
-        theEvents.insert(itr, newEvent);
-      } else {
-        if (newEvent->Ekind() <= Ev_end) {
-          // Group together
-          while (itr != theEvents.end()
-                 && (*itr)->Ekind() != newEvent->Ekind())
-            itr++;
-          if (itr == theEvents.end() || (*itr)->Ekind() != newEvent->Ekind()) {
-            fprintf (stderr, "Internal error, event mismatch. file '%s'\n", fileToOpen); \
-            printf ("newEvent: "); newEvent->print();
-            if (itr != theEvents.end()) {
-               printf ("itr: "); (*itr)->print();
-            } else {
-               printf ("At end of list\n");
-            }
-          } else {
-            // More complicated ... move past proper kinds ...
-            E_tag *tp = NULL;
-            if (newEvent->Ekind() == Ev_start || newEvent->Ekind() == Ev_end) {
-              // Just find the end of the group
-              while (itr != theEvents.end() && (*itr)->Ekind() == newEvent->Ekind())
-                itr++;
-            } else {
-              // Need to move past them only if they have the same tag!
-              if (newEvent->Ekind() == Ev_tag) {
-                // Work with tags
-                tp = (E_tag *)newEvent;
-                while (itr != theEvents.end()
-                       && (*itr)->Ekind() == Ev_tag
-                       && ((E_tag *)(*itr))->tagNo() == tp->tagNo())
-                  itr++;
-              } else {
-                // Work with pauses
-                E_pause *rp = (E_pause *)newEvent;
-                while (itr != theEvents.end()
-                       && (*itr)->Ekind() == Ev_pause
-                       && ((E_pause *)(*itr))->tagId() == rp->tagId())
-                  itr++;
-              }
-            }
-            /*std::list<Event*>::iterator newElem = */ theEvents.insert (itr, newEvent);
-            //      if (tp != NULL && tp->nodeId() == 0) {
-            //        tagVec[tp->tagNo()-1] = newElem;
-            //      }
-          }
-        } else {
-          // Insert by time
-          while (itr != theEvents.end() &&
-                 (*itr)->Ekind() > Ev_end &&
-                 **itr < *newEvent)
-            itr++;
-          theEvents.insert (itr, newEvent);
-        }
-      }
-    }
+    // MergeFiles puts the events in their place
+    if (newEvent)
+      events.push_back(newEvent);
   }
 
   // Remove any task or Btask records that are in the vdbTids db.
-  itr = theEvents.begin();
-  while (itr != theEvents.end()) {
+  size_t keep = 0;
+  for (size_t ix = 0; ix < events.size(); ix++) {
     bool doErase = false;
-    Event *ev = *itr;
+    Event *ev = events[ix];
     // ev->print();
     if (ev->nodeId() == findex) {
       switch (ev->Ekind()) {
@@ -1262,14 +1445,11 @@ int DataModel::LoadFile (const char *fileToOpen, int index, double seq)
         default:
           break;
       }
-      if (doErase)
-        itr = theEvents.erase(itr);
-      else
-        itr++;
-    } else {
-      itr++;
     }
+    if (!doErase)
+      events[keep++] = ev;
   }
+  events.resize(keep);
 
   if (nErrs) fprintf(stderr, "%d errors in data file '%s'.\n", nErrs, fileToOpen);
 
@@ -1278,9 +1458,10 @@ int DataModel::LoadFile (const char *fileToOpen, int index, double seq)
   //         fileToOpen, ignoreFork, ignoreTask);
   //  }
 
-  if ( !feof(data) ) return 0;
+  int atEnd = feof(data);
+  fclose(data);
 
-  return 1;
+  return atEnd ? 1 : 0;
 }
 
 // Get the task data by task Id and locale.
@@ -35,9 +35,8 @@
 // This is the class that reads the files as generated by runtime/src/chpl-visual-debug.c
 // in the Chapel runtime.
 //
-// Initially the data files are in ascii.  To turn these into binary data files,
-// both this class and runtime/src/chpl-visual-debug.c need to be modified to
-// write (chpl-visual-debug.c) and read (this class) in binary.
+// The data files are either text or binary (see TextDataFormat.txt).  The
+// files are read in parallel, one locale per thread, and then merged.
 
 // Support Structs used by DataModel
 
@@ -164,7 +163,17 @@ class DataModel {
 
   // Utility routines
 
-  int LoadFile (const char *filename, int index, double seq);
+  // Reads one locale's file into events, in file order, with the
+  // VisualDebug tasks filtered out.  fileTags is set to the number of
+  // tags seen.  Files other than -0 may be read in parallel.
+  int LoadFile (const char *filename, int index, double seq,
+                std::vector<Event *> &events, int &fileTags);
+
+  static void *LoadFileThread (void *arg);
+
+  // Moves the events of all locales into theEvents, grouping Starts,
+  // Tags, Pauses and Ends and putting the rest in time order.
+  void MergeFiles (std::vector<Event *> *perLocale);
 
   void newList ();
 